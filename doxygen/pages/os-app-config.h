@@ -274,6 +274,15 @@
  * If your application is very active with random allocation, be sure
  * tolerates restarts due to fragmentation.
  *
+ * For bounded allocation times, redefine it to
+ * `os::memory::segregated_fit`, which finds free chunks via
+ * a bitmap of power of two size classes and coalesces them
+ * on deallocation.
+ *
+ * For hard real-time applications, redefine it to
+ * `os::memory::tlsf`, which guarantees constant time allocations
+ * and deallocations, and can also manage multiple memory regions.
+ *
  * @par Default
  *   The default memory manager is `os::memory::first_fit_top`.
  */
@@ -331,6 +340,68 @@
  */
 #define OS_INTEGER_RTOS_CRITICAL_SECTION_INTERRUPT_PRIORITY
 
+/**
+ * @brief Enable the signals from the zero latency interrupts.
+ *
+ * @details
+ * Interrupts with priorities above
+ * `OS_INTEGER_RTOS_CRITICAL_SECTION_INTERRUPT_PRIORITY` are never
+ * delayed by the kernel, but cannot call RTOS functions. With this
+ * option they can raise signals with `os::rtos::zero_latency::raise()`,
+ * a single atomic operation; the bound semaphores, event flags,
+ * thread flags or functions are serviced later, by
+ * `os_rtos_zero_latency_drain_handler()`, called from a kernel aware
+ * interrupt pended by `os_rtos_zero_latency_pend_hook()`, and by the
+ * system tick.
+ *
+ * Requires `OS_INTEGER_RTOS_CRITICAL_SECTION_INTERRUPT_PRIORITY`,
+ * thus ARMv7-M or higher.
+ *
+ * @par Default
+ *   Not enabled.
+ */
+#define OS_INCLUDE_RTOS_ZERO_LATENCY_INTERRUPTS
+
+/**
+ * @brief Coalesce the context switch requests of interrupt handlers.
+ *
+ * @details
+ * Inside the interrupt handlers that instantiate an
+ * `os::rtos::interrupts::handler_scope`, the threads made ready by
+ * posts to semaphores, event flags, message queues, etc, are only
+ * linked to the ready list, and a single context switch is
+ * requested when the outermost handler exits.
+ *
+ * The other handlers (and threads) request the context switch
+ * for each thread made ready, as usual.
+ *
+ * Not available with `OS_USE_RTOS_PORT_SCHEDULER`.
+ *
+ * @par Default
+ *   Not enabled.
+ */
+#define OS_INCLUDE_RTOS_ISR_RESCHEDULE_COALESCING
+
+/**
+ * @brief Keep the scheduler lock state in the kernel.
+ *
+ * @details
+ * Instead of calling the port, `scheduler::lock()`, `unlock()`
+ * and `locked(state)`, thus all `scheduler::critical_section`
+ * objects, only change a kernel variable, without disabling the
+ * interrupts. Nested sections keep the previous state on their
+ * stacks; a context switch requested while the scheduler is
+ * locked is remembered and requested again by the outermost
+ * unlock, so the port is called only when threads were made
+ * ready meanwhile.
+ *
+ * Not available with `OS_USE_RTOS_PORT_SCHEDULER` or with SMP.
+ *
+ * @par Default
+ *   Not enabled.
+ */
+#define OS_USE_RTOS_SCHEDULER_LOCK_NESTING
+
 /**
  * @brief Define the default thread stack size, in bytes.
  */
@@ -402,229 +473,2035 @@
 #define OS_INCLUDE_RTOS_STATISTICS_THREAD_CONTEXT_SWITCHES
 
 /**
- * @brief Add a user defined storage to each thread.
+ * @brief Include the critical sections instrumentation.
+ *
+ * @details
+ * Measure, with the high resolution clock, how long the
+ * interrupts critical sections keep the interrupts masked and
+ * how long the scheduler critical sections keep the scheduler locked.
+ * Only the outermost sections are measured; for each place in the
+ * code, identified by the return address, the count, the maximum
+ * and a histogram of the durations are kept.
+ *
+ * The latency from the system tick to the entry in the
+ * tick interrupt handler is also measured.
+ *
+ * The results are available via
+ * `interrupts::statistics::critical_sections()`,
+ * `scheduler::statistics::critical_sections()` and
+ * `interrupts::statistics::latency()`, and can be displayed via
+ * `trace` with the `dump_critical_sections()` functions.
+ *
+ * Since the tick interrupt is delayed while the interrupts are
+ * masked, interrupts critical sections longer than one tick
+ * may be undervalued by whole ticks.
+ *
+ * @par Default
+ *  Disabled.
+ *
+ * @see OS_INTEGER_RTOS_STATISTICS_CRITICAL_SITES
  */
-#define OS_INCLUDE_RTOS_CUSTOM_THREAD_USER_STORAGE
+#define OS_INCLUDE_RTOS_STATISTICS_CRITICAL_SECTIONS
 
 /**
- * @brief Extend the message size to 16 bits.
+ * @brief Define the number of critical section sites kept.
  *
  * @details
- * For embedded applications the message queues are
- * optimised for small messages, up to 256 bytes.
+ * Separate tables are used for the interrupts and for the
+ * scheduler critical sections; the sites that do not fit
+ * are only counted.
  *
- * If larger messages are needed, this option extends the
- * message size to 65536 bytes.
+ * @par Default
+ *  16
+ */
+#define OS_INTEGER_RTOS_STATISTICS_CRITICAL_SITES           (16)
+
+/**
+ * @brief Include the timeouts latency statistics.
+ *
+ * @details
+ * Add support to record, for each clock, two histograms measured
+ * with `hrclock`: the lateness of the timer callbacks and of the
+ * thread timeouts, from the node time stamp to the moment the
+ * clock interrupt dispatched it, and the delay from the dispatch
+ * of a thread timeout to the moment the woken thread actually
+ * runs.
+ *
+ * The statistics can be read with `clock::latency_statistics()`.
  *
  * @par Default
- *  False (short messages).
+ *  Disabled.
  */
-#define OS_BOOL_RTOS_MESSAGE_QUEUE_SIZE_16BITS  (false)
+#define OS_INCLUDE_RTOS_STATISTICS_CLOCK_LATENCY
 
 /**
- * @brief Push down the idle thread priority.
+ * @brief Include the threads profiler.
+ *
+ * @details
+ * Add support to record, for each thread, a histogram of the
+ * running slices durations, the worst-case latency from ready to
+ * running, the number of preemptions and the time blocked
+ * on the synchronisation objects (separately for the first 4
+ * objects and in total).
+ *
+ * A snapshot of all threads can be copied into a caller
+ * array, for example by a low priority thread displaying
+ * a `top` like view.
+ *
+ * Requires both @ref OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES
+ * and @ref OS_INCLUDE_RTOS_STATISTICS_THREAD_CONTEXT_SWITCHES.
+ *
+ * The RAM overhead is about 300 bytes for each thread; the time
+ * overhead is one more high resolution clock read when a thread
+ * is resumed, plus a few arithmetic operations on each context
+ * switch.
+ *
+ * @see os::rtos::scheduler::statistics::threads_profile()
+ * @see os::rtos::thread::statistics::snapshot()
+ *
+ * @par Default
+ * Disable. Do not include the threads profiler.
+ */
+#define OS_INCLUDE_RTOS_STATISTICS_THREAD_PROFILE
+
+/**
+ * @brief Include the per thread hardware event counts.
+ *
+ * @details
+ * Add support to accumulate, for each thread, the Cortex-M DWT
+ * profiling counters (additional instruction cycles, exception
+ * overhead, sleep, load/store and folded instructions) and,
+ * on Armv8.1-M cores with a PMU, the data cache read misses,
+ * to tell which threads are memory bound.
+ *
+ * The counters are sampled on each context switch and on each
+ * system tick, and the differences are added to the running
+ * thread. The DWT counters have only 8 bits, so, if more than
+ * 255 events occur between samples, the values are lower bounds.
+ * The counts not available on the current core are zero.
+ *
+ * Requires @ref OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES.
+ *
+ * @see os::rtos::thread::statistics::snapshot()
+ *
+ * @par Default
+ * Disable. Do not count the hardware events.
+ */
+#define OS_INCLUDE_RTOS_STATISTICS_THREAD_EVENTS
+
+/**
+ * @brief Include the recommended stack sizes.
+ *
+ * @details
+ * The peak stack usage found by the idle thread scan is kept
+ * for each thread function and name, also after the threads are
+ * destroyed, in a table of `OS_INTEGER_RTOS_STATISTICS_STACK_SITES`
+ * entries; `os::rtos::scheduler::statistics::dump_stack_sites()`
+ * prints the recommended size for each of them.
+ *
+ * Requires @ref OS_INCLUDE_RTOS_THREAD_STACK_SCAN.
+ *
+ * @par Default
+ * Disable. Do not include the recommended stack sizes.
+ *
+ * @see OS_INTEGER_RTOS_STATISTICS_STACK_MARGIN_PERCENT
+ */
+#define OS_INCLUDE_RTOS_STATISTICS_STACK_SITES
+
+/**
+ * @brief Define the number of thread functions with recorded stacks.
+ *
+ * @par Default
+ *  16
+ */
+#define OS_INTEGER_RTOS_STATISTICS_STACK_SITES              (16)
+
+/**
+ * @brief Define the margin added to the peak stack usage.
+ *
+ * @details
+ * In percents of the peak usage, for the recommended sizes.
+ *
+ * @par Default
+ *  25
+ */
+#define OS_INTEGER_RTOS_STATISTICS_STACK_MARGIN_PERCENT     (25)
+
+/**
+ * @brief Include the CPU load accounting.
+ *
+ * @details
+ * Add support to compute the CPU load from the time spent in
+ * the idle thread, sampled every 100 ms from the system tick and
+ * averaged over 1 s and 10 s; the idle thread also accumulates
+ * the time spent waiting for interrupts.
+ *
+ * Requires @ref OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES and
+ * the native scheduler.
+ *
+ * @see os::rtos::scheduler::statistics::cpu_load()
+ * @see os::rtos::scheduler::statistics::dump_cpu_load()
+ *
+ * @par Default
+ * Disable. Do not include the CPU load accounting.
+ */
+#define OS_INCLUDE_RTOS_STATISTICS_CPU_LOAD
+
+/**
+ * @brief Include the frequency scaling governor.
+ *
+ * @details
+ * On each CPU load sample, a governor selects an operating point
+ * from an application table, and the frequency is changed by
+ * `os_rtos_dvfs_set_frequency_hook()`, followed by a re-timing
+ * of the high resolution clock. Higher frequencies are set from
+ * the system tick, lower ones from the idle thread.
+ *
+ * Requires @ref OS_INCLUDE_RTOS_STATISTICS_CPU_LOAD and
+ * @ref OS_USE_RTOS_CLOCK_RETIMING.
+ *
+ * @see os::rtos::dvfs::start()
+ * @see os::rtos::dvfs::ondemand_governor
+ *
+ * @par Default
+ * Disable. Do not include the frequency scaling governor.
+ */
+#define OS_INCLUDE_RTOS_DVFS
+
+/**
+ * @brief Include the threads execution budget monitor.
+ *
+ * @details
+ * A thread may declare with `thread::budget()` how many CPU cycles
+ * each of its activations is expected to use; the activations
+ * start with `thread::budget_restart()`, and automatically when
+ * the thread returns from `periodic::wait_next_period()` or
+ * `this_thread::wait_next_period()`.
+ *
+ * The thread is charged with the same cycles as
+ * `thread::statistics::cpu_cycles()`, and the budget is checked
+ * on each clock tick and when the thread is switched out; on the
+ * first overrun of an activation, the overruns counter is
+ * incremented and the handler is called, from the interrupt
+ * context, so it may raise an event flag or post a semaphore.
+ *
+ * The time overhead is a comparison on each tick and on each
+ * context switch.
+ *
+ * Requires @ref OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES.
+ *
+ * @par Default
+ *  Disabled.
+ */
+#define OS_INCLUDE_RTOS_THREAD_BUDGET
+
+/**
+ * @brief Enable the thread notifications.
+ *
+ * @details
+ * Add to each thread a 32-bit notification value, updated by
+ * `thread::notify()` (set bits, increment, overwrite), and taken
+ * by the thread itself with `this_thread::notify_wait()` and its
+ * try/timed variants.
+ *
+ * For the common case of an interrupt waking a single thread,
+ * this is cheaper than a semaphore and needs no separate object.
+ *
+ * @par Default
+ *   Not enabled.
+ */
+#define OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS
+
+/**
+ * @brief Wake-up only the event flags waiters that are satisfied.
+ *
+ * @details
+ * By default `event_flags::raise()` resumes all the waiting threads,
+ * and each one checks again its mask. With this option the threads
+ * waiting in `wait()` and `timed_wait()` are kept in a separate
+ * list, together with their masks and modes, and `raise()` resumes
+ * only those whose condition is met, so many threads waiting for
+ * different bits of the same object are not woken by every raise.
+ *
+ * The wait sets and the coroutines waiting for the flags are still
+ * all resumed.
+ *
+ * Each event flags object grows by one waiting list.
+ *
+ * @par Default
+ *   Not enabled.
+ */
+#define OS_INCLUDE_RTOS_EVENT_FLAGS_MASKED_WAKEUP
+
+/**
+ * @brief Include the mutex priority inheritance statistics.
+ *
+ * @details
+ * Record the longest chain of owners boosted by a single lock
+ * and the number of chains truncated at
+ * @ref OS_INTEGER_RTOS_MUTEX_INHERIT_MAX_DEPTH, to check the
+ * worst case of the lock hierarchies.
+ *
+ * @see os::rtos::mutex::inherit_max_depth()
+ * @see os::rtos::mutex::inherit_capped()
+ *
+ * @par Default
+ * Disable. Do not include the inheritance statistics.
+ */
+#define OS_INCLUDE_RTOS_STATISTICS_MUTEX_INHERIT
+
+/**
+ * @brief Include the memory resources usage statistics.
+ *
+ * @details
+ * Add to all memory resources a histogram of the request sizes,
+ * the peak number of allocated chunks, the lowest free size, the
+ * failed requests and the size of the largest free chunk, used to
+ * compute a fragmentation index. The extra data is printed by
+ * `trace_print_statistics()` and can be obtained as a structure,
+ * to size the arenas from real usage.
+ *
+ * @see os::rtos::memory::memory_resource::snapshot()
+ * @see os::rtos::memory::memory_resource::fragmentation()
+ *
+ * @par Default
+ * Disable. Do not include the memory statistics.
+ */
+#define OS_INCLUDE_RTOS_STATISTICS_MEMORY
+
+/**
+ * @brief Record the heap events in the binary trace.
+ *
+ * @details
+ * `memory_resource::allocate()`, `allocate_zeroed()`,
+ * `reallocate()` and `deallocate()` store, for each request, a
+ * record with the memory resource, the block address, the size,
+ * the call site and the timestamp in the binary trace ring
+ * (@ref OS_USE_TRACE_BINARY), so host tools can replay the heap
+ * behaviour of the application with different allocators.
+ *
+ * Requires `TRACE` and @ref OS_USE_TRACE_BINARY; otherwise the
+ * records are discarded.
+ *
+ * @par Default
+ *  Disabled.
+ */
+#define OS_INCLUDE_RTOS_MEMORY_TRACE_EVENTS
+
+/**
+ * @brief Include the memory pressure callbacks.
+ *
+ * @details
+ * Add to memory resources a list of shrinkers, functions provided
+ * by caches that can release memory on request. When an
+ * allocation fails, the shrinkers are called before the out of
+ * memory handler, and, if they released something, the
+ * allocation is retried.
+ *
+ * With a non zero `low_water_mark()`, `allocate()` also calls
+ * them when the free memory drops below the mark, so caches
+ * shrink before the heap is exhausted.
+ *
+ * @par Default
+ *  Disabled.
+ */
+#define OS_INCLUDE_RTOS_MEMORY_RECLAIM
+
+/**
+ * @brief Include per memory resource locking.
+ *
+ * @details
+ * The synchronized allocators (`memory::allocator_typed` and the
+ * default `memory::allocator`) lock the scheduler while using their
+ * memory resource. With this option, a memory resource can be
+ * given a mutex, with `memory_resource::locker()`, and the
+ * allocators lock only that mutex; threads that do not use that
+ * memory resource are no longer delayed by the others' heap walks.
+ *
+ * Memory resources without a mutex still lock the scheduler.
+ *
+ * @par Default
+ *  Disabled.
+ */
+#define OS_INCLUDE_RTOS_MEMORY_RESOURCE_LOCKING
+
+/**
+ * @brief Include the per-thread allocation caches.
+ *
+ * @details
+ * Add to each thread a cache of small blocks, in four power of
+ * two size classes, from 16 to 128 bytes. The blocks are
+ * allocated from the application memory resource in batches of 4,
+ * and returned in batches when there are more than 8 free blocks
+ * in a class, or when the thread is destroyed.
+ *
+ * `operator new()`/`operator delete()` and `malloc()`/`free()` use
+ * the cache of the current thread, and lock the scheduler only
+ * when the cache must be refilled or flushed, or for blocks
+ * larger than the largest class.
+ *
+ * All blocks get a header of `alignof(std::max_align_t)` bytes,
+ * and the size of the blocks kept by the caches is available
+ * as `cached_bytes()` in the memory resource statistics.
+ *
+ * The application memory resource must not be changed after
+ * the scheduler is started.
+ *
+ * @par Default
+ * Disable. Allocate directly from the application memory resource.
+ */
+#define OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE
+
+/**
+ * @brief Include the lazily allocated per-thread newlib reentrancy
+ *  structures.
+ *
+ * @details
+ * Threads do not get a `struct _reent` when created; it is
+ * allocated from a static pool on the first call of
+ * `thread::newlib_reent()`, or of `__getreent()` for the newlib
+ * builds with `__DYNAMIC_REENT__`, and is returned to the
+ * pool, after `_reclaim_reent()`, when the thread is destroyed.
+ *
+ * On context switches, `_impure_ptr` is set to the structure
+ * of the new thread, if it has one, or to the global structure
+ * otherwise, so the threads that never use the stdio functions
+ * do not need the RAM, but also share the global state.
+ *
+ * When the pool is exhausted, the threads
+ * continue to use the global structure.
+ *
+ * Not available with SMP or with a port scheduler.
+ *
+ * @par Default
+ * Disable. All threads share the global structure.
+ *
+ * @see OS_INTEGER_RTOS_THREAD_NEWLIB_REENT_POOL_SIZE
+ */
+#define OS_INCLUDE_RTOS_THREAD_NEWLIB_REENT
+
+/**
+ * @brief Define the number of newlib reentrancy structures.
+ *
+ * @par Default
+ *  4
+ */
+#define OS_INTEGER_RTOS_THREAD_NEWLIB_REENT_POOL_SIZE       (4)
+
+/**
+ * @brief Include the thread local storage slots.
+ *
+ * @details
+ * Each thread gets an array of `OS_INTEGER_RTOS_THREAD_LOCAL_SLOTS`
+ * pointers; the keys that select the slots are allocated with
+ * `this_thread::local_key_create()`, for all threads at once.
+ *
+ * On context switches, the scheduler sets a global pointer to
+ * the array of the new thread, so `this_thread::local_slot()`
+ * is an inline access to the array, without the call to
+ * `this_thread::thread()`.
+ *
+ * Not available with SMP or with a port scheduler.
+ *
+ * @par Default
+ * Disable.
+ *
+ * @see OS_INTEGER_RTOS_THREAD_LOCAL_SLOTS
+ */
+#define OS_INCLUDE_RTOS_THREAD_LOCAL_SLOTS
+
+/**
+ * @brief Define the number of thread local storage slots.
+ *
+ * @details
+ * Each slot adds a pointer to all threads; the maximum is 32.
+ *
+ * @par Default
+ *  4
+ */
+#define OS_INTEGER_RTOS_THREAD_LOCAL_SLOTS                  (4)
+
+/**
+ * @brief Include the incremental stack scan in the idle thread.
+ *
+ * @details
+ * On each iteration, the idle thread checks a few words
+ * of one thread stack, taking the threads in turn, and keeps
+ * the maximum usage per thread, available as
+ * `thread::stack::high_water_mark()`, without the long
+ * scan done by `thread::stack::available()`.
+ *
+ * When a new maximum leaves less than
+ * `OS_INTEGER_RTOS_THREAD_STACK_WARNING_PERCENT` of the stack
+ * unused, `os_rtos_stack_warning_hook()` is called.
+ *
+ * @par Default
+ *  Disabled.
+ *
+ * @see OS_INTEGER_RTOS_THREAD_STACK_SCAN_WORDS
+ * @see OS_INTEGER_RTOS_THREAD_STACK_WARNING_PERCENT
+ */
+#define OS_INCLUDE_RTOS_THREAD_STACK_SCAN
+
+/**
+ * @brief Define the number of stack words checked on each idle iteration.
+ *
+ * @par Default
+ *  16
+ */
+#define OS_INTEGER_RTOS_THREAD_STACK_SCAN_WORDS             (16)
+
+/**
+ * @brief Define the stack usage warning level.
+ *
+ * @details
+ * The percent of the stack size that should remain unused.
+ * If 0, the warning hook is never called.
+ *
+ * @par Default
+ *  10
+ */
+#define OS_INTEGER_RTOS_THREAD_STACK_WARNING_PERCENT        (10)
+
+/**
+ * @brief Fill free memory with zeros during idle time.
+ *
+ * @details
+ * On each iteration, the idle thread fills with zeros
+ * `OS_INTEGER_RTOS_IDLE_ZERO_FREE_BYTES` of the free memory of
+ * the application memory resource, via `memory_resource::zero_free()`.
+ * Memory managers that keep track of it, like `first_fit_top`,
+ * can then return blocks from `allocate_zeroed()`, used by
+ * `calloc()`, without filling them again.
+ *
+ * @par Default
+ *  Disabled.
+ *
+ * @see OS_INTEGER_RTOS_IDLE_ZERO_FREE_BYTES
+ */
+#define OS_INCLUDE_RTOS_IDLE_ZERO_FREE_MEMORY
+
+/**
+ * @brief Define the number of bytes filled with zeros on each
+ *  idle iteration.
+ *
+ * @details
+ * The bytes are filled with the scheduler locked.
+ *
+ * @par Default
+ *  256
+ */
+#define OS_INTEGER_RTOS_IDLE_ZERO_FREE_BYTES                (256)
+
+/**
+ * @brief Include the allocation hot-site profiler.
+ *
+ * @details
+ * `operator new()`, `operator delete()`, `malloc()`, `free()`
+ * and the related functions record one in
+ * `OS_INTEGER_RTOS_MEMORY_PROFILER_SAMPLE_RATE` allocations,
+ * aggregated by the caller return address in a fixed size table;
+ * the lifetime of the sampled blocks is measured with the high
+ * resolution clock.
+ *
+ * The results are printed by
+ * `os::rtos::memory::profiler::trace_print()`.
+ *
+ * The profiler uses only static storage; it never allocates.
+ *
+ * @par Default
+ *  Disabled.
+ *
+ * @see OS_INTEGER_RTOS_MEMORY_PROFILER_SITES
+ * @see OS_INTEGER_RTOS_MEMORY_PROFILER_BLOCKS
+ * @see OS_INTEGER_RTOS_MEMORY_PROFILER_SAMPLE_RATE
+ */
+#define OS_INCLUDE_RTOS_MEMORY_PROFILER
+
+/**
+ * @brief Define the number of allocation sites recorded by the profiler.
+ *
+ * @details
+ * Must be a power of 2. Samples from new sites, after the table
+ * is full, are counted as dropped.
+ *
+ * @par Default
+ *  64
+ */
+#define OS_INTEGER_RTOS_MEMORY_PROFILER_SITES               (64)
+
+/**
+ * @brief Define the number of sampled blocks tracked for lifetimes.
+ *
+ * @details
+ * Must be a power of 2. When all are in use, the lifetime of the
+ * new samples is not measured.
+ *
+ * @par Default
+ *  64
+ */
+#define OS_INTEGER_RTOS_MEMORY_PROFILER_BLOCKS              (64)
+
+/**
+ * @brief Define the profiler sampling rate.
+ *
+ * @details
+ * One allocation in this many is recorded; use 1 to record all.
+ *
+ * @par Default
+ *  16
+ */
+#define OS_INTEGER_RTOS_MEMORY_PROFILER_SAMPLE_RATE         (16)
+
+/**
+ * @brief Include the statistical PC sampling profiler.
+ *
+ * @details
+ * A periodic high priority interrupt records the interrupted
+ * program counter and the running thread in a ring of
+ * `OS_INTEGER_RTOS_PROFILER_SAMPLES` entries; the samples are
+ * drained by `os::rtos::profiler::drain()` or printed by
+ * `os::rtos::profiler::trace_print()`, and aggregated on the host.
+ *
+ * The timer is not configured by the profiler; on Cortex-M, its
+ * vector can point to `os_rtos_profiler_sample_isr()`, with the
+ * interrupt cleared by `os_rtos_profiler_acknowledge_hook()`.
+ *
+ * @par Default
+ *  Disabled.
+ *
+ * @see OS_INTEGER_RTOS_PROFILER_SAMPLES
+ */
+#define OS_INCLUDE_RTOS_PROFILER
+
+/**
+ * @brief Define the number of samples in the profiler ring.
+ *
+ * @details
+ * Must be a power of 2. Samples taken when the ring is full are
+ * counted as dropped.
+ *
+ * @par Default
+ *  256
+ */
+#define OS_INTEGER_RTOS_PROFILER_SAMPLES                    (256)
+
+/**
+ * @brief Include the registry of named objects.
+ *
+ * @details
+ * The named threads, mutexes, condition variables, semaphores,
+ * event flags, message queues, memory pools and timers are
+ * entered in a hash table of `OS_INTEGER_RTOS_OBJECT_REGISTRY_SIZE`
+ * entries, and can be found with `os::rtos::registry::find()`
+ * by name and type, in constant time.
+ *
+ * @par Default
+ *  Disabled.
+ *
+ * @see OS_INTEGER_RTOS_OBJECT_REGISTRY_SIZE
+ */
+#define OS_INCLUDE_RTOS_OBJECT_REGISTRY
+
+/**
+ * @brief Define the number of entries in the registry of named objects.
+ *
+ * @details
+ * Must be a power of 2. When the table is full, the new objects
+ * are not registered; keep it at about twice the number of
+ * named objects, to keep the probe sequences short.
+ *
+ * @par Default
+ *  64
+ */
+#define OS_INTEGER_RTOS_OBJECT_REGISTRY_SIZE                (64)
+
+/**
+ * @brief Include support for thread stacks taken from pools.
+ *
+ * @details
+ * Threads with the `th_stack_pool` attribute take their stacks
+ * from a `stack_pool` of fixed size blocks, filled with the magic
+ * word only once, when the pool is constructed. When the thread
+ * is destroyed, only the used part of the stack is filled again
+ * and the block is returned to the pool at once.
+ *
+ * If the pool is empty, the terminated threads not yet
+ * destroyed by the idle thread are destroyed by the creator.
+ *
+ * @par Default
+ *  Disabled.
+ */
+#define OS_INCLUDE_RTOS_THREAD_STACK_POOL
+
+/**
+ * @brief Destroy the terminated threads from a service thread.
+ *
+ * @details
+ * By default, the terminated threads are destroyed by the
+ * idle thread, so the cleanup waits for the system to become idle.
+ * With this option, a separate thread, woken up by each thread
+ * exit, destroys them as they terminate, at a configurable
+ * priority, and the idle thread no longer does it.
+ *
+ * @par Default
+ *  Disabled.
+ *
+ * @see OS_INTEGER_RTOS_THREAD_REAPER_PRIORITY
+ * @see OS_INTEGER_RTOS_THREAD_REAPER_STACK_SIZE_BYTES
+ */
+#define OS_INCLUDE_RTOS_THREAD_REAPER
+
+/**
+ * @brief Define the priority of the reaper thread.
+ *
+ * @par Default
+ *  `thread::priority::low`
+ */
+#define OS_INTEGER_RTOS_THREAD_REAPER_PRIORITY              (os::rtos::thread::priority::low)
+
+/**
+ * @brief Define the **reaper** thread stack size.
+ *
+ * @note Ignored for synthetic platforms.
+ */
+#define OS_INTEGER_RTOS_THREAD_REAPER_STACK_SIZE_BYTES
+
+/**
+ * @brief Add a user defined storage to each thread.
+ */
+#define OS_INCLUDE_RTOS_CUSTOM_THREAD_USER_STORAGE
+
+/**
+ * @brief Inline the trivial C API wrappers.
+ *
+ * @details
+ * Most C API functions just forward the call to the
+ * C++ method. With this option, for the translation units
+ * compiled as C++, `<cmsis-plus/rtos/os-c-api.h>` also provides
+ * inline definitions of the wrappers used on the hot paths
+ * (scheduler lock, critical sections, thread flags, clocks,
+ * timers, mutexes, condition variables, semaphores, memory pools,
+ * message queues and event flags), so the extra call and return
+ * are avoided without LTO.
+ *
+ * The definitions use the GNU `extern inline` semantics, thus the
+ * out-of-line functions are still exported and used for the
+ * calls which are not inlined, or when taking their address,
+ * and for the translation units compiled as C.
+ */
+#define OS_INCLUDE_RTOS_C_API_INLINES
+
+/**
+ * @brief Extend the message size to 16 bits.
+ *
+ * @details
+ * For embedded applications the message queues are
+ * optimised for small messages, up to 256 bytes.
+ *
+ * If larger messages are needed, this option extends the
+ * message size to 65536 bytes.
+ *
+ * @par Default
+ *  False (short messages).
+ */
+#define OS_BOOL_RTOS_MESSAGE_QUEUE_SIZE_16BITS  (false)
+
+/**
+ * @brief Push down the idle thread priority.
+ *
+ * @details
+ * Normally the applications should not create threads with
+ * the idle priority.
+ *
+ * However, some applications, like the ARM CMSIS RTOS validator,
+ * need to test the behaviour of idle threads. For such cases,
+ * to guarantee that the idle thread is the lowest priority
+ * thread, its priority can be lowered one additional step.
+ *
+ * @par Default
+ *  False (the idle thread has the idle priority).
+ */
+#define OS_BOOL_RTOS_THREAD_IDLE_PRIORITY_BELOW_IDLE (false)
+
+/**
+ * @brief Force the stack trace to start with a 0x0.
+ *
+ * @details
+ * This option has no functional consequences, it is only
+ * cosmetic, affecting how a debugger displays the stack trace.
+ *
+ * If your debugger has difficulties to properly display the
+ * thread stack trace, enable this option and the stack will
+ * always start with a 0x0.
+ *
+ * @par Default
+ *  False (the stack trace starts with the first function).
+ */
+#define OS_BOOL_RTOS_PORT_CONTEXT_CREATE_ZERO_LR (false)
+
+/**
+ * @brief Default definition for the preemption flag.
+ *
+ * @details
+ * This option sets the initial value of the
+ * `scheduler::preemptive()` flag. It can be changed
+ * at any time.
+ *
+ * @par Default
+ *  True (preemption is enabled).
+ */
+#define OS_BOOL_RTOS_SCHEDULER_PREEMPTIVE (true)
+
+/**
+ * @brief Run the scheduler on several cores.
+ *
+ * @details
+ * Each core has its own running thread and its own ready list;
+ * threads are assigned to a core when created, via the
+ * `th_core` attribute; they move to another core only by
+ * `thread::affinity()` or by the load balancer, within the
+ * cores allowed by the `th_affinity` mask.
+ *
+ * The interrupts critical sections also take a recursive
+ * kernel spin lock, so the kernel structures are protected
+ * across cores. When a thread is resumed on another core and
+ * has a higher priority than the thread running there, that
+ * core is interrupted to reschedule.
+ *
+ * All cores but the boot one get their own idle thread.
+ *
+ * The port must implement `port::core::id()`, `port::core::start()`
+ * and `port::core::reschedule()`, and use the per core
+ * `scheduler::current_threads_[]` when switching contexts.
+ * Not available with `OS_USE_RTOS_PORT_SCHEDULER`.
+ *
+ * The scheduler lock (`scheduler::critical_section`) is global,
+ * it disables preemption on all cores.
+ *
+ * @par Default
+ *  Disabled (single core).
+ *
+ * @see OS_INTEGER_RTOS_SMP_CORES
+ * @see OS_INTEGER_RTOS_SMP_BALANCE_PERIOD_TICKS
+ */
+#define OS_INCLUDE_RTOS_SMP
+
+/**
+ * @brief Define the number of cores used by the scheduler.
+ *
+ * @par Default
+ *  2
+ */
+#define OS_INTEGER_RTOS_SMP_CORES                           (2)
+
+/**
+ * @brief Define the period of the load balancing between cores.
+ *
+ * @details
+ * With `OS_INCLUDE_RTOS_SMP` and
+ * `OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES`, the idle threads
+ * compare the CPU cycles used on each core, at most once a
+ * period, and may move one thread from the busiest core to
+ * the least busy one, if its `th_affinity` allows it.
+ *
+ * @par Default
+ *  100 ticks
+ */
+#define OS_INTEGER_RTOS_SMP_BALANCE_PERIOD_TICKS            (100)
+
+/**
+ * @brief Use a bitmap indexed array of lists for the ready threads.
+ *
+ * @details
+ * By default the ready threads are kept in a single list, ordered
+ * by priorities, and making a thread ready requires a partial list
+ * traversal, which grows with the number of ready threads.
+ *
+ * With this option, each priority level has its own FIFO list
+ * and a bit in a bitmap, and inserting a thread or retrieving the
+ * highest priority thread are constant time operations, with
+ * the cost of one list head for each of the 256 possible
+ * priorities.
+ *
+ * @note Not used when the scheduler is provided by the port
+ * (`OS_USE_RTOS_PORT_SCHEDULER`).
+ *
+ * @par Default
+ *  Use a single list ordered by priorities.
+ */
+#define OS_USE_RTOS_READY_LIST_BITMAP
+
+/**
+ * @brief Split the lists of waiting threads in priority buckets.
+ *
+ * @details
+ * By default the threads waiting for synchronisation objects
+ * (semaphores, mutexes, condition variables, event flags, memory
+ * pools and message queues) are kept in a single list, ordered
+ * by priorities, and linking a new thread requires a partial
+ * list traversal.
+ *
+ * With this option, each list is split in 16 priority ordered
+ * buckets, one for each group of priorities with the same upper
+ * bits, plus a bitmap with the non-empty buckets. For threads
+ * using the standard priorities, both waiting and resuming
+ * are constant time operations, while the order of the
+ * waiting threads (FIFO within the same priority) is preserved.
+ *
+ * The RAM overhead is 15 list heads and one word for each
+ * waiting list.
+ *
+ * @par Default
+ *  Use a single list ordered by priorities.
+ */
+#define OS_USE_RTOS_WAITING_LIST_BUCKETS
+
+/**
+ * @brief Use 16-bit links in the intrusive lists.
+ *
+ * @details
+ * By default each list node (`utils::static_double_list_links`)
+ * stores two pointers. With this option the node stores two
+ * 16-bit indices instead, relative to
+ * @ref OS_INTEGER_UTILS_LISTS_COMPACT_BASE, in 2 bytes units,
+ * halving the size of all list heads and nodes, in all system
+ * objects (threads, mutexes, semaphores, timers, etc).
+ *
+ * All objects with list nodes, including those on the thread
+ * stacks, must be in the 128 KB of RAM above the base; this is
+ * checked by assertions.
+ *
+ * The price is a few instructions to convert the links to
+ * pointers and back, on each list operation.
+ *
+ * For the smallest objects, combine it with
+ * @ref OS_EXCLUDE_RTOS_OBJECT_NAMES; the attributes stored in
+ * the objects are already 8 or 16-bit wide.
+ *
+ * @par Default
+ *  Use regular pointers.
+ */
+#define OS_INCLUDE_UTILS_LISTS_COMPACT
+
+/**
+ * @brief Define the base address of the compact list links.
+ *
+ * @details
+ * Usually the start of the RAM where the system objects
+ * and the thread stacks are allocated.
+ *
+ * @par Default
+ *  0x20000000 (the Cortex-M SRAM region).
+ */
+#define OS_INTEGER_UTILS_LISTS_COMPACT_BASE (0x20000000)
+
+/**
+ * @brief Keep the system and real time clocks time stamps in timer wheels.
+ *
+ * @details
+ * By default the time stamps of the sleeping threads, of the
+ * timeouts and of the timers are kept in a list ordered by time
+ * stamps, and linking a new node requires a partial list
+ * traversal.
+ *
+ * With this option, the `sysclock` and `rtclock` steady lists are
+ * kept in hierarchical timer wheels, with 4 levels of
+ * `2^OS_INTEGER_RTOS_CLOCK_TIMER_WHEEL_SLOT_BITS` slots each;
+ * linking and unlinking nodes are constant time and each clock
+ * tick processes only the slot of the current time stamp.
+ * Nodes with the same time stamp are still processed in the
+ * order they were linked.
+ *
+ * The `hrclock` list and the `rtclock` adjusted list are not
+ * affected.
+ *
+ * The RAM overhead is one list head for each slot, for each
+ * of the two clocks.
+ *
+ * @par Default
+ *  Use lists ordered by time stamps.
+ *
+ * @see OS_INTEGER_RTOS_CLOCK_TIMER_WHEEL_SLOT_BITS
+ */
+#define OS_USE_RTOS_CLOCK_TIMER_WHEEL
+
+/**
+ * @brief Define the number of bits used to index the timer wheels slots.
+ *
+ * @details
+ * Each level of the timer wheels has `2^N` slots, and the
+ * 4 levels cover `2^(4*N)` clock ticks; nodes beyond
+ * this range are kept in the highest level and
+ * are cascaded again when it rolls over.
+ *
+ * @par Default
+ *  5 (32 slots per level).
+ *
+ * @see OS_USE_RTOS_CLOCK_TIMER_WHEEL
+ */
+#define OS_INTEGER_RTOS_CLOCK_TIMER_WHEEL_SLOT_BITS         (5)
+
+/**
+ * @brief Do not enter sleep in the idle thread.
+ *
+ * @details
+ * Very fast debuggers need direct access to a RAM buffer, which
+ * in turn need the clock that powers the bus where the RAM is
+ * connected to be permanently on.
+ *
+ * Unfortunately, most devices disable this clock when entering
+ * even the shallow sleep mode, disabling the debugger access to
+ * the device.
+ *
+ * To prevent this, usually for the debug configurations,
+ * it is possible to exclude the code that puts the device to sleep.
+ */
+#define OS_EXCLUDE_RTOS_IDLE_SLEEP
+
+/**
+ * @brief Let the idle thread sleep without the system tick.
+ *
+ * @details
+ * By default the idle thread waits for the next interrupt, and
+ * it is awaken at least by each system tick, even if no time stamp
+ * is due for a long time.
+ *
+ * With this option, when the application power saving mode hook
+ * did not sleep, the idle thread computes the number of ticks
+ * up to the earliest deadline of the `sysclock` and `hrclock`
+ * lists and calls `os_rtos_idle_tickless_sleep_hook()`, which must
+ * reprogram the tick source, sleep, and return the number
+ * of ticks actually slept; the clocks are then
+ * updated with `clock::update_for_slept_time()`.
+ *
+ * The default hook does nothing and returns 0, so the
+ * application or the port must provide a functional one.
+ *
+ * @par Default
+ *  Sleep only until the next tick.
+ *
+ * @see OS_INTEGER_RTOS_TICKLESS_IDLE_MIN_TICKS
+ */
+#define OS_USE_RTOS_TICKLESS_IDLE
+
+/**
+ * @brief Extend a free-running hardware counter for `hrclock`.
+ *
+ * @details
+ * By default `hrclock.now()` adds the cycles since the last tick,
+ * read from the SysTick down counter, to a count incremented by the
+ * SysTick interrupt, in an interrupts critical section.
+ *
+ * With this option, the port provides
+ * `port::clock_highres::free_running_cycles()`, a free-running
+ * 32-bit up counter at the `hrclock` input frequency, like the
+ * DWT CYCCNT or a spare timer; it is extended to 64 bits by the
+ * SysTick interrupt, which publishes the extended value under
+ * a sequence lock, so `now()` is lock-free and never tears,
+ * even close to a tick.
+ *
+ * The counter must keep counting during sleep, and must be
+ * observed at least once per wrap period, so tickless idle
+ * sleeps must be shorter than 2^32 cycles; the slept time is
+ * taken from the counter.
+ *
+ * @par Default
+ *  Use the SysTick counter.
+ */
+#define OS_USE_RTOS_HIGHRES_FREE_RUNNING_COUNTER
+
+/**
+ * @brief Wake `hrclock` sleeps with a compare match interrupt.
+ *
+ * @details
+ * By default the `hrclock` time stamps are checked only by
+ * the SysTick interrupt, so `hrclock.sleep_for()` and the timed
+ * waits on `hrclock` resolve to whole ticks.
+ *
+ * With this option, the port provides
+ * `port::clock_highres::arm_compare()` and
+ * `port::clock_highres::disarm_compare()`, which program a
+ * hardware compare match, and calls `os_highres_compare_handler()`
+ * from its interrupt. When the earliest `hrclock` deadline falls
+ * before the next tick, the compare match is armed for it, so
+ * short sleeps, like 50 µs, block with cycle resolution instead
+ * of spinning.
+ *
+ * @par Default
+ *  Disabled.
+ */
+#define OS_USE_RTOS_HIGHRES_COMPARE_MATCH
+
+/**
+ * @brief Support changing the core clock frequency at run time.
+ *
+ * @details
+ * After changing the frequency of the clock driving the SysTick,
+ * for example to save power under light load, the application
+ * calls `hrclock.retime()` with the new frequency. The port
+ * reprograms the SysTick so `sysclock` keeps its tick rate
+ * (and `clock_systick::ticks_cast()` stays valid), and the
+ * pending `hrclock` time stamps are rescaled, so the remaining
+ * durations are kept in seconds.
+ *
+ * The port must implement `port::clock_systick::retime()`.
+ *
+ * @par Default
+ *  Disabled.
+ */
+#define OS_USE_RTOS_CLOCK_RETIMING
+
+/**
+ * @brief Define the minimum number of ticks for a tickless sleep.
+ *
+ * @details
+ * For shorter durations, the overhead of reprogramming the
+ * timers is not worth it, and the idle thread waits for the
+ * next interrupt as usual.
+ *
+ * @par Default
+ *  2
+ *
+ * @see OS_USE_RTOS_TICKLESS_IDLE
+ */
+#define OS_INTEGER_RTOS_TICKLESS_IDLE_MIN_TICKS             (2)
+
+/**
+ * @brief Define the max length of a priority inheritance chain.
+ *
+ * @details
+ * When a thread blocks on a `mutex::protocol::inherit` mutex,
+ * the owner is boosted and, if the owner is itself blocked on
+ * such a mutex, the boost is propagated to the next owner, up
+ * to this number of owners; this bounds the time spent in the
+ * scheduler critical section by a single lock.
+ *
+ * @par Default
+ *  8
+ *
+ * @see OS_INCLUDE_RTOS_STATISTICS_MUTEX_INHERIT
+ */
+#define OS_INTEGER_RTOS_MUTEX_INHERIT_MAX_DEPTH             (8)
+
+/**
+ * @brief Define the number of lists used by `wait_on_address()`.
+ *
+ * @details
+ * The threads waiting on addresses are kept in lists selected
+ * by a hash of the address; more lists mean fewer threads
+ * waiting on other addresses to skip when waking up.
+ * Must be a power of 2.
+ *
+ * @par Default
+ *  8
+ */
+#define OS_INTEGER_RTOS_WAIT_ADDRESS_BUCKETS                (8)
+
+/**
+ * @brief Include the deferred procedure calls service.
+ *
+ * @details
+ * Create a worker thread that executes the functions posted
+ * by interrupt handlers with `deferred::post()`, so the handlers
+ * can leave the heavy processing to a thread, without each driver
+ * having its own thread and stack.
+ *
+ * The calls are kept in a lock-free queue and executed in batches,
+ * in the order they were posted; when the queue is empty the
+ * worker is suspended. Statistics with the maximum queue depth
+ * and the call latencies are available via `deferred::statistics()`.
+ *
+ * @par Default
+ *  Disabled.
+ *
+ * @see OS_INTEGER_RTOS_DEFERRED_QUEUE_SIZE
+ * @see OS_INTEGER_RTOS_DEFERRED_PRIORITY
+ * @see OS_INTEGER_RTOS_DEFERRED_STACK_SIZE_BYTES
+ */
+#define OS_INCLUDE_RTOS_DEFERRED
+
+/**
+ * @brief Enable the RTOS event tracing hooks.
+ *
+ * @details
+ * The scheduler, the thread functions, the semaphores, mutexes,
+ * message queues and event flags, the timers and the SysTick
+ * handler call the `os_rtos_trace_*()` hooks, which record compact
+ * binary events for a timeline viewer. Without a backend, the hooks
+ * are weak empty functions.
+ *
+ * @par Default
+ *  Disabled.
+ *
+ * @see OS_USE_TRACE_SEGGER_SYSTEMVIEW
+ */
+#define OS_INCLUDE_RTOS_TRACE_EVENTS
+
+/**
+ * @brief Define the number of deferred calls that can be pending.
+ *
+ * @details
+ * Must be a power of 2. When the queue is full, `deferred::post()`
+ * fails with `EWOULDBLOCK`.
+ *
+ * @par Default
+ *  16
+ */
+#define OS_INTEGER_RTOS_DEFERRED_QUEUE_SIZE                 (16)
+
+/**
+ * @brief Define the priority of the deferred calls worker thread.
+ *
+ * @par Default
+ *  `thread::priority::high`
+ */
+#define OS_INTEGER_RTOS_DEFERRED_PRIORITY                   (os::rtos::thread::priority::high)
+
+/**
+ * @brief Define the **deferred** worker thread stack size.
+ *
+ * @note Ignored for synthetic platforms.
+ */
+#define OS_INTEGER_RTOS_DEFERRED_STACK_SIZE_BYTES
+
+/**
+ * @brief Include support for high resolution callouts.
+ *
+ * @details
+ * The callouts are short functions called directly from the
+ * interrupt handler of a dedicated hardware timer, at a
+ * given high resolution clock time stamp, for example to start
+ * an ADC conversion a few microseconds later.
+ *
+ * They do not use the clock timer lists and the SysTick;
+ * the pending callouts are kept in a small sorted array, and
+ * the hardware timer is programmed for the earliest one.
+ *
+ * The port must implement `port::callout_timer::arm()` and
+ * `port::callout_timer::disarm()` and call `os_callout_handler()`
+ * from the timer interrupt handler.
+ *
+ * @par Default
+ *  Disabled.
+ *
+ * @see OS_INTEGER_RTOS_CALLOUTS_SIZE
+ */
+#define OS_INCLUDE_RTOS_CALLOUTS
+
+/**
+ * @brief Define the number of callouts that can be pending.
+ *
+ * @details
+ * When all entries are used, `callout::schedule()` fails
+ * with `EWOULDBLOCK`.
+ *
+ * @par Default
+ *  8
+ */
+#define OS_INTEGER_RTOS_CALLOUTS_SIZE                       (8)
+
+/**
+ * @brief Dispatch the timer callbacks from a daemon thread.
+ *
+ * @details
+ * By default the timer callbacks are called from the clock
+ * interrupt, so long callbacks delay all other timeouts.
+ * With this option the clock interrupt only moves the expired
+ * timers to a pending list, in constant time, and a daemon thread
+ * calls all due callbacks in one batch.
+ *
+ * If a periodic timer expires again before its previous callback
+ * was called, the call is not queued twice, but the timer
+ * overrun counter, returned by `timer::overruns()`, is incremented.
+ *
+ * Not used with `OS_USE_RTOS_PORT_TIMER`.
+ *
+ * @par Default
+ *  Disabled.
+ *
+ * @see OS_INTEGER_RTOS_TIMER_DAEMON_PRIORITY
+ * @see OS_INTEGER_RTOS_TIMER_DAEMON_STACK_SIZE_BYTES
+ */
+#define OS_INCLUDE_RTOS_TIMER_DAEMON
+
+/**
+ * @brief Define the priority of the timer daemon thread.
+ *
+ * @par Default
+ *  `thread::priority::above_normal`
+ */
+#define OS_INTEGER_RTOS_TIMER_DAEMON_PRIORITY               (os::rtos::thread::priority::above_normal)
+
+/**
+ * @brief Define the **timer daemon** thread stack size.
+ *
+ * @note Ignored for synthetic platforms.
+ */
+#define OS_INTEGER_RTOS_TIMER_DAEMON_STACK_SIZE_BYTES
+
+/**
+ * @brief Allow timeouts to expire late, to share wakeups.
+ *
+ * @details
+ * With this option, `timer::start()` accepts a slack, and
+ * `thread::timer_slack()` sets a slack for all sleeps and timed
+ * waits of a thread. A timeout with slack is moved, within the
+ * slack, to the time stamp of an already scheduled timeout, or
+ * up to a round time stamp, so that several timeouts expire on
+ * the same interrupt, and a tickless clock stays asleep longer.
+ *
+ * @par Default
+ *  Disabled.
+ */
+#define OS_INCLUDE_RTOS_TIMER_SLACK
+
+/**
+ * @brief Include the earliest deadline first scheduling class.
+ *
+ * @details
+ * Threads created with a non zero `th_deadline` attribute form
+ * a separate scheduling class, which runs at a single priority
+ * level (`OS_INTEGER_RTOS_SCHEDULER_EDF_PRIORITY`); at this
+ * level the ready threads are ordered by absolute deadline,
+ * and run ahead of the fixed priority threads of the same
+ * priority.
+ *
+ * Periodic threads call `this_thread::wait_next_period()` at the
+ * end of each job; this advances the deadline and counts
+ * the missed deadlines.
+ *
+ * The admission control helpers in `scheduler::edf` keep
+ * the total utilisation of the class, based on the `th_budget`
+ * attributes.
+ *
+ * Not used with `OS_USE_RTOS_PORT_SCHEDULER`.
+ *
+ * @par Default
+ *  Disabled.
+ *
+ * @see OS_INTEGER_RTOS_SCHEDULER_EDF_PRIORITY
+ */
+#define OS_INCLUDE_RTOS_SCHEDULER_EDF
+
+/**
+ * @brief Define the priority of the EDF scheduling class.
+ *
+ * @details
+ * Above all the fixed priority threads used for control loops,
+ * and below the system threads that must not be delayed, like
+ * the deferred calls thread.
+ *
+ * @par Default
+ *  `thread::priority::high`
+ */
+#define OS_INTEGER_RTOS_SCHEDULER_EDF_PRIORITY              (os::rtos::thread::priority::high)
+
+/**
+ * @brief Include round robin time slicing.
+ *
+ * @details
+ * By default, each scheduler run puts the running thread behind
+ * the other ready threads of the same priority, so the rotation
+ * depends on how often the scheduler runs, and a thread
+ * preempted by an interrupt loses its turn.
+ *
+ * With this option, each thread has a budget of ticks, consumed
+ * by the clock interrupt only while the thread is running and
+ * other threads of the same priority are ready; only when the
+ * budget is exhausted, or when the thread yields, it goes behind
+ * its peers. A thread preempted by a higher priority one resumes
+ * ahead of its peers, with the remaining budget.
+ *
+ * The quantum is set by the `th_quantum` thread attribute, or,
+ * if 0, by the priority class, via `scheduler::quantum()`.
+ *
+ * Not used with `OS_USE_RTOS_PORT_SCHEDULER`.
+ *
+ * @par Default
+ *  Disabled.
+ *
+ * @see OS_INTEGER_RTOS_SCHEDULER_QUANTUM_TICKS
+ */
+#define OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING
+
+/**
+ * @brief Define the default time slice, in ticks.
+ *
+ * @details
+ * Used for the priority classes without an explicit quantum.
+ *
+ * @par Default
+ *  10
+ */
+#define OS_INTEGER_RTOS_SCHEDULER_QUANTUM_TICKS             (10)
+
+/**
+ * @brief Include per thread preemption thresholds.
+ *
+ * @details
+ * A thread created with a `th_preemption_threshold` above its
+ * priority, while running, is preempted only by threads with
+ * priorities above the threshold. Groups of threads that share
+ * data can use a common threshold instead of mutexes, and,
+ * since they do not preempt each other, fewer context switches
+ * are performed.
+ *
+ * Not used with `OS_USE_RTOS_PORT_SCHEDULER`.
+ *
+ * @par Default
+ *  Disabled.
+ */
+#define OS_INCLUDE_RTOS_SCHEDULER_PREEMPTION_THRESHOLD
+
+/**
+ * @brief Include the directed yield.
+ *
+ * @details
+ * Add `this_thread::handoff(thread&)`, which switches directly
+ * to a given ready thread, without going through the top of the
+ * ready list; for request/response exchanges between threads,
+ * the server starts working immediately, whatever its priority.
+ *
+ * Not used with `OS_USE_RTOS_PORT_SCHEDULER`.
+ *
+ * @par Default
+ *  Disabled.
+ */
+#define OS_INCLUDE_RTOS_SCHEDULER_HANDOFF
+
+/**
+ * @brief Define the section of the kernel hot paths.
+ *
+ * @details
+ * The functions executed on each context switch and on each
+ * tick (the thread switch, the SysTick handler with the clocks
+ * timestamps check, the thread resume and the ready, waiting
+ * and timestamps list operations) are placed in this section,
+ * for example `".itcm_text"` or `".ramfunc"`, instead of `.text`.
+ *
+ * The linker script must place the section in a zero wait state
+ * memory (ITCM or SRAM), with the load address in flash, and
+ * list it in the data regions array, so the startup code copies it
+ * with the initialised data (see
+ * @ref OS_INCLUDE_STARTUP_INIT_MULTIPLE_RAM_SECTIONS):
+ *
+ * @code{.unparsed}
+ * .itcm_text : ALIGN(4)
+ * {
+ *   __itcm_text_start = . ;
+ *   *(.itcm_text .itcm_text.*)
+ *   . = ALIGN(4) ;
+ *   __itcm_text_end = . ;
+ * } >ITCM AT>FLASH
+ * @endcode
+ *
+ * The calls between flash and the section are out of the
+ * direct branch range on most devices; GNU ld inserts the
+ * long branch veneers.
+ *
+ * The context switch handler (PendSV) is part of the port, which
+ * should use the same section.
+ *
+ * @par Default
+ *  Undefined, the functions stay in `.text`.
+ */
+#define OS_STRING_RTOS_HOT_SECTION ".itcm_text"
+
+/**
+ * @brief Exclude the recursive mutexes from the kernel.
+ *
+ * @details
+ * The relock and the unlock count tests are compiled out
+ * (see `os::rtos::features::mutex_recursive`); creating a
+ * mutex with `mutex::type::recursive` throws `ENOTSUP`.
+ *
+ * @par Default
+ *  Recursive mutexes are supported.
+ */
+#define OS_EXCLUDE_RTOS_MUTEX_RECURSIVE
+
+/**
+ * @brief Exclude the robust mutexes from the kernel.
+ *
+ * @details
+ * The owner dead, consistent and recoverable members and
+ * their tests are compiled out; creating a mutex with
+ * `mutex::robustness::robust` throws `ENOTSUP` and
+ * `mutex::consistent()` returns `ENOTSUP`.
+ *
+ * @par Default
+ *  Robust mutexes are supported.
+ */
+#define OS_EXCLUDE_RTOS_MUTEX_ROBUST
+
+/**
+ * @brief Exclude the priority ceiling (protect) protocol from the kernel.
+ *
+ * @details
+ * The priority ceiling members and the protect protocol
+ * code are compiled out; creating a mutex with
+ * `mutex::protocol::protect` throws `ENOTSUP`, and
+ * `mutex::prio_ceiling()` returns `thread::priority::highest`,
+ * or `ENOTSUP` when setting it.
+ *
+ * The priority inheritance protocol is not affected.
+ *
+ * @par Default
+ *  The priority protect protocol is supported.
+ */
+#define OS_EXCLUDE_RTOS_MUTEX_PRIORITY_CEILING
+
+/**
+ * @brief Exclude the thread interruption (cancellation) from the kernel.
+ *
+ * @details
+ * The interrupted flag is removed from the threads;
+ * `thread::interrupt()` does nothing and
+ * `thread::interrupted()` always returns `false`, so the
+ * blocking calls are never cut short with `EINTR`.
+ *
+ * @par Default
+ *  Threads can be interrupted.
+ */
+#define OS_EXCLUDE_RTOS_THREAD_CANCELLATION
+
+/**
+ * @brief Exclude the names of the system objects.
+ *
+ * @details
+ * The name pointer is removed from all named objects, saving
+ * one word per object; the names passed to the constructors
+ * are ignored and `name()` returns `"-"`.
+ *
+ * @par Default
+ *  Objects keep their names.
+ */
+#define OS_EXCLUDE_RTOS_OBJECT_NAMES
+
+/**
+ * @}
+ */
+
+// ----------------------------------------------------------------------------
+/**
+ * @ingroup cmsis-plus-app-config-startup
+ * @{
+ */
+
+/**
+ * @brief Initialise multiple RAM sections.
+ */
+#define OS_INCLUDE_STARTUP_INIT_MULTIPLE_RAM_SECTIONS
+
+/**
+ * @brief Initialise some data regions from LZ4 compressed images.
+ *
+ * @details
+ * The regions listed in the linker script as triplets of image
+ * address, region begin and region end addresses, between
+ * `__data_compressed_regions_array_start` and
+ * `__data_compressed_regions_array_end`, are decompressed
+ * directly into RAM, after the regular data regions.
+ *
+ * The convention is:
+ * - the compressed output sections are `NOLOAD` in RAM, and are
+ *   not included in the regular data regions;
+ * - each image is a raw LZ4 block, in an input section like
+ *   `.data_lz4.<name>`, placed last in flash, so adding it does
+ *   not move the other flash content;
+ * - after a first link, the post-link tool
+ *   (`scripts/lz4-data-image.py`) compresses the content of each
+ *   region, extracted with `objcopy -O binary --only-section`,
+ *   and the object files created from the images with
+ *   `objcopy -I binary` are added to the second link.
+ */
+#define OS_INCLUDE_STARTUP_COMPRESSED_DATA
+
+/**
+ * @brief Clear some BSS regions only after the scheduler starts.
+ *
+ * @details
+ * Large regions not used by the static constructors, listed in the
+ * linker script as pairs of begin/end addresses between
+ * `__bss_deferred_regions_array_start` and
+ * `__bss_deferred_regions_array_end`, and not included in the
+ * regular BSS regions, are cleared by the main thread, right before
+ * `os_main()`, instead of during the reset sequence.
+ */
+#define OS_INCLUDE_STARTUP_DEFERRED_BSS
+
+/**
+ * @brief Run some static constructors only after the scheduler starts.
+ *
+ * @details
+ * The static objects marked with `OS_STARTUP_DEFERRED_INIT(order)`
+ * get init priorities from 60000 up, and the compiler places
+ * their constructors in `.init_array.6xxxx` sections. The linker
+ * script must collect these sections, before the regular
+ * `.init_array.*`, in a separate array:
+ *
+ * @code{.ld}
+ * PROVIDE_HIDDEN (__init_array_deferred_start = .);
+ * KEEP(*(SORT(.init_array.6*)))
+ * PROVIDE_HIDDEN (__init_array_deferred_end = .);
+ * @endcode
+ *
+ * These constructors are not executed before `main()`; the idle
+ * thread runs them, one on each iteration, so the threads
+ * running the application are not delayed. The idle thread stack
+ * must be large enough for them.
+ *
+ * Before the first use of such an object, the application can
+ * call `os_startup_complete_deferred_init()`, which runs all the
+ * remaining constructors. For objects used only by a few
+ * functions, a function-local static is an alternative, it is
+ * constructed lazily, on first use.
+ */
+#define OS_INCLUDE_STARTUP_DEFERRED_INIT_ARRAY
+
+/**
+ * @brief Enable guard checks for .bss and .data sections.
+ *
+ * @details
+ * Sometimes mistakes in the liner script prevent the .bss area
+ * to be initialised to zero, and/or the .data area to be fully
+ * initialised with content from flash.
+ *
+ * To validate that the start-up properly initialised these areas,
+ * some guard words are defined at the begin/end of the .bss and
+ * .data areas, and are explicitly checked.
+ *
+ * @note This option is available only if DEBUG is also defined.
+ */
+#define OS_BOOL_STARTUP_GUARD_CHECKS (true)
+
+/**
+ * @brief Always initialise the hardware FPU.
+ */
+#define OS_INCLUDE_STARTUP_INIT_FP
+
+/**
+ * @brief Make the application a fully semihosted application.
+ *
+ * @details
+ * When writing test applications it is necessary to use some
+ * of the resources available from the host system (STDOUT/STDERR,
+ * file system, time, exit code, etc).
+ *
+ * This requires the entire behaviour of the system calls to be
+ * changed and most calls to be forwarded to the host. The
+ * application is transformed into a 'fully semihosted' application.
+ *
+ * One major difference from a regular embedded application is that
+ * a fully semihosted test application does not run in an endless
+ * loop, but terminates, and the test result must be passed back
+ * to the host system, via the exit code and optionally via a
+ * detailed status file.
+ */
+#define OS_USE_SEMIHOSTING_SYSCALLS
+
+/**
+ * @brief Define the maximum number of semihosting open files.
+ *
+ * @details
+ * The implementation of the semihosting file support requires
+ * an array of open files, to keep track of the host files.
+ *
+ * To simplify the implementation and avoid dynamic allocations, a static
+ * array is used. This option defines the size of this array.
+ *
+ * @par Default
+ *  20.
+ */
+#define OS_INTEGER_SEMIHOSTING_MAX_OPEN_FILES (20)
+
+/**
+ * @brief Buffer the semihosting file transfers.
+ *
+ * @details
+ * Each semihosting call halts the core, so, with this option,
+ * for host files (not for the terminal), small writes are
+ * collected in a per file buffer
+ * (@ref OS_INTEGER_SEMIHOSTING_BUFFER_SIZE) and sent with
+ * a single host call, and small reads are served from a
+ * read-ahead in the same buffer. Large transfers go directly
+ * to the host. `writev()` merges the small elements in the buffer.
+ *
+ * The buffer is flushed before changing the transfer direction,
+ * on `lseek()`, `fstat()`, `fsync()`, `close()` and on exit;
+ * the errors of the deferred writes are reported by these calls.
+ */
+#define OS_USE_SEMIHOSTING_SYSCALLS_BUFFERED
+
+/**
+ * @brief Define the size of the semihosting file buffers.
+ *
+ * @details
+ * Each of the @ref OS_INTEGER_SEMIHOSTING_MAX_OPEN_FILES
+ * entries has such a buffer.
+ *
+ * @par Default
+ *  256.
+ */
+#define OS_INTEGER_SEMIHOSTING_BUFFER_SIZE (256)
+
+/**
+ * @brief Include definitions for the standard POSIX system calls.
+ *
+ * @todo update after POSIX I/O is updated.
+ */
+#define OS_INCLUDE_STANDARD_POSIX_FUNCTIONS
+
+/**
+ * @brief Include definitions for the newlib system calls.
+ *
+ * @todo update after POSIX I/O is updated.
+ */
+#define OS_INCLUDE_NEWLIB_POSIX_FUNCTIONS
+
+/**
+ * @brief Disable setting MSP during startup.
+ *
+ * @details
+ * On Cortex-M, during startup, the MSP register is set to the stack
+ * pointer available in the first word pointed by VTOR.
+ * Some platforms run custom firmware (like Nordic's soft radio)
+ * that take control of VTOR and set it to a location which does
+ * point to the valid interrupt stack. It is perfectly acceptable
+ * to not reset MSP, and leave it to the location where it reached
+ * before switching to PSP, just that some stack space is wasted.
+ */
+#define OS_DISABLE_CORTEXM_SET_MSP_VIA_VTOR
+
+/**
+ * @}
+ */
+
+// ----------------------------------------------------------------------------
+/**
+ * @ingroup cmsis-plus-app-config-lib
+ * @{
+ */
+
+/**
+ * @brief Use a very lite atexit().
+ *
+ * @details
+ * The standard `atexit()` maintains a generic registry
+ * to keep track of the actions to be performed at exit.
+ * As storage, this uses an
+ * initial static buffer plus a series of dynamically allocated
+ * blocks.
+ * For very tight configurations
+ * this might be problematic, and a lite, always static version is provided.
+ * Please note that this version supports actions
+ * registered via atexit() and `__cxa_atexit()` (the destructors of
+ * static objects); dso handles are ignored, and when exception
+ * are enabled, this options is ignored.
+ * The storage is a static array, configured via
+ * `OS_INTEGER_ATEXIT_ARRAY_SIZE`, followed by chunks taken from a
+ * dedicated static pool, configured via `OS_INTEGER_ATEXIT_CHUNK_SIZE`
+ * and `OS_INTEGER_ATEXIT_POOL_CHUNKS`.
+ */
+#define OS_INCLUDE_ATEXIT_STATIC
+
+/**
+ * @brief Define the size of the `atexit()` array.
+ *
+ * @details
+ * To simplify the implementation and avoid dynamic allocations, a static
+ * array is used. This option defines the size of this array.
+ */
+#define OS_INTEGER_ATEXIT_ARRAY_SIZE (3)
+
+/**
+ * @brief Define the size of the `atexit()` pool chunks.
+ *
+ * @details
+ * When the static array is full, the next functions are
+ * stored in chunks taken from a dedicated static pool, so that
+ * first-use initialisations of function-local static objects do not
+ * allocate from the heap. This option defines the number of functions
+ * in a chunk.
+ *
+ * Valid only with `OS_INCLUDE_ATEXIT_STATIC`.
+ */
+#define OS_INTEGER_ATEXIT_CHUNK_SIZE (8)
+
+/**
+ * @brief Define the number of chunks in the `atexit()` pool.
+ *
+ * @details
+ * Use 0 to have only the static array.
+ *
+ * Valid only with `OS_INCLUDE_ATEXIT_STATIC`.
+ */
+#define OS_INTEGER_ATEXIT_POOL_CHUNKS (2)
+
+/**
+ * @brief Do not register functions to be called at exit.
  *
  * @details
- * Normally the applications should not create threads with
- * the idle priority.
+ * For applications which never exit, the `atexit()` registry
+ * is useless; with this option, `atexit()` and `__cxa_atexit()`
+ * (used to register the destructors of static objects) do nothing,
+ * so first-use initialisations of function-local static objects
+ * neither lock the scheduler nor allocate memory.
  *
- * However, some applications, like the ARM CMSIS RTOS validator,
- * need to test the behaviour of idle threads. For such cases,
- * to guarantee that the idle thread is the lowest priority
- * thread, its priority can be lowered one additional step.
+ * Please note that, if the application does exit, the registered
+ * functions and the destructors of static objects are not called.
  *
- * @par Default
- *  False (the idle thread has the idle priority).
+ * Takes precedence over `OS_INCLUDE_ATEXIT_STATIC`.
  */
-#define OS_BOOL_RTOS_THREAD_IDLE_PRIORITY_BELOW_IDLE (false)
+#define OS_EXCLUDE_ATEXIT_REGISTRATION
 
 /**
- * @brief Force the stack trace to start with a 0x0.
+ * @brief Replace the library memory functions.
  *
  * @details
- * This option has no functional consequences, it is only
- * cosmetic, affecting how a debugger displays the stack trace.
+ * Make `memcpy()`, `memmove()` and `memset()` aliases of the
+ * functions in `src/libc/string`, selected by the architecture:
+ * - on Cortex-M55/M85 (Helium), vector loops of 16 bytes,
+ *   with predicated tails;
+ * - on Cortex-M3/M4/M7, bursts of 32 bytes with `LDRD`/`STRD`
+ *   after aligning the destination, and word loads from
+ *   unaligned sources.
  *
- * If your debugger has difficulties to properly display the
- * thread stack trace, enable this option and the stack will
- * always start with a 0x0.
+ * The functions are always available as `os_libc_memcpy()` &
+ * co.; `test/memory-bench` compares them with the toolchain ones.
  *
  * @par Default
- *  False (the stack trace starts with the first function).
+ * Disabled. Use the toolchain functions.
  */
-#define OS_BOOL_RTOS_PORT_CONTEXT_CREATE_ZERO_LR (false)
+#define OS_INCLUDE_LIBC_OPTIMISED_MEMORY_FUNCTIONS
 
 /**
- * @brief Default definition for the preemption flag.
+ * @brief Define the maximum size of a directory name.
+ */
+#define OS_INTEGER_DIRENT_NAME_MAX  (256)
+
+/**
+ * @brief Enable the path lookup cache of the mounted file systems.
  *
  * @details
- * This option sets the initial value of the
- * `scheduler::preemptive()` flag. It can be changed
- * at any time.
- *
- * @par Default
- *  True (preemption is enabled).
+ * Keep a small table with the results of recent `stat()`
+ * calls, including negative results, so that repeated lookups of the
+ * same path do not reach the file system implementation.
+ * The entries of a file system are invalidated each time it is
+ * modified.
  */
-#define OS_BOOL_RTOS_SCHEDULER_PREEMPTIVE (true)
+#define OS_INCLUDE_POSIX_IO_PATH_CACHE
 
 /**
- * @brief Do not enter sleep in the idle thread.
+ * @brief Define the number of entries in the path lookup cache.
  *
  * @details
- * Very fast debuggers need direct access to a RAM buffer, which
- * in turn need the clock that powers the bus where the RAM is
- * connected to be permanently on.
- *
- * Unfortunately, most devices disable this clock when entering
- * even the shallow sleep mode, disabling the debugger access to
- * the device.
+ * Only valid if `OS_INCLUDE_POSIX_IO_PATH_CACHE` is defined.
+ */
+#define OS_INTEGER_POSIX_IO_PATH_CACHE_SIZE (8)
+
+/**
+ * @brief Define the longest path stored in the path lookup cache.
  *
- * To prevent this, usually for the debug configurations,
- * it is possible to exclude the code that puts the device to sleep.
+ * @details
+ * Longer paths are not cached.
+ * Only valid if `OS_INCLUDE_POSIX_IO_PATH_CACHE` is defined.
  */
-#define OS_EXCLUDE_RTOS_IDLE_SLEEP
+#define OS_INTEGER_POSIX_IO_PATH_CACHE_PATH_MAX (48)
 
 /**
- * @}
+ * @brief Define the size of the path stored in each directory.
+ *
+ * @details
+ * The path is used by `directory::read_entries()` to stat() the
+ * entries; for longer paths the attributes are not available.
  */
+#define OS_INTEGER_POSIX_IO_DIRECTORY_PATH_MAX (64)
 
-// ----------------------------------------------------------------------------
 /**
- * @ingroup cmsis-plus-app-config-startup
- * @{
+ * @brief Define the buffer alignment required for direct transfers.
+ *
+ * @details
+ * With `O_DIRECT`, the cached block devices pass the whole blocks
+ * with buffers aligned to this value directly to the driver; the
+ * other transfers still go through the cache.
  */
+#define OS_INTEGER_POSIX_IO_DIRECT_ALIGNMENT (4)
 
 /**
- * @brief Initialise multiple RAM sections.
+ * @brief Enable the group commit of concurrent `fsync()` calls.
+ *
+ * @details
+ * The files whose implementation provides `do_fsync_writeback()`
+ * are written back under the file system lock, then the device
+ * flush is shared by all threads calling `fsync()` meanwhile.
  */
-#define OS_INCLUDE_STARTUP_INIT_MULTIPLE_RAM_SECTIONS
+#define OS_INCLUDE_POSIX_IO_GROUP_COMMIT
 
 /**
- * @brief Enable guard checks for .bss and .data sections.
+ * @brief Define the default group commit window, in ticks.
  *
  * @details
- * Sometimes mistakes in the liner script prevent the .bss area
- * to be initialised to zero, and/or the .data area to be fully
- * initialised with content from flash.
+ * The time the first `fsync()` caller waits for others to join,
+ * before flushing the device. With 0, only the calls arriving
+ * during a flush are merged into the next one.
+ * Only valid if `OS_INCLUDE_POSIX_IO_GROUP_COMMIT` is defined.
+ */
+#define OS_INTEGER_POSIX_IO_GROUP_COMMIT_WINDOW_TICKS (0)
+
+/**
+ * @brief Define the maximum number of asynchronous I/O operations.
  *
- * To validate that the start-up properly initialised these areas,
- * some guard words are defined at the begin/end of the .bss and
- * .data areas, and are explicitly checked.
+ * @details
+ * The operations in progress, or completed but not yet collected
+ * with `aio_return()`. Beyond this, `aio_read()` and `aio_write()`
+ * fail with EAGAIN.
+ */
+#define OS_INTEGER_POSIX_IO_AIO_MAX (8)
+
+/**
+ * @brief Define the number of asynchronous I/O worker threads.
  *
- * @note This option is available only if DEBUG is also defined.
+ * @details
+ * The workers serve the devices without asynchronous transfers;
+ * they are created at the first request which needs them.
  */
-#define OS_BOOL_STARTUP_GUARD_CHECKS (true)
+#define OS_INTEGER_POSIX_IO_AIO_THREADS (2)
 
 /**
- * @brief Always initialise the hardware FPU.
+ * @brief Define the stack size of the asynchronous I/O workers.
  */
-#define OS_INCLUDE_STARTUP_INIT_FP
+#define OS_INTEGER_POSIX_IO_AIO_STACK_SIZE_BYTES (2048)
 
 /**
- * @brief Make the application a fully semihosted application.
+ * @brief Define the size of the buffer used by `sendfile()`.
  *
  * @details
- * When writing test applications it is necessary to use some
- * of the resources available from the host system (STDOUT/STDERR,
- * file system, time, exit code, etc).
+ * The buffer is allocated for each call, from the default memory
+ * resource, only if the input content cannot be exposed directly.
+ */
+#define OS_INTEGER_POSIX_IO_SENDFILE_BUFFER_SIZE (512)
+
+/**
+ * @brief Define the default size of the `posix::stream` buffers.
  *
- * This requires the entire behaviour of the system calls to be
- * changed and most calls to be forwarded to the host. The
- * application is transformed into a 'fully semihosted' application.
+ * @details
+ * Used only when `fstat()` does not return `st_blksize`.
+ */
+#define OS_INTEGER_POSIX_IO_STREAM_BUFFER_SIZE (128)
+
+/**
+ * @brief Define the size of the local array used by
+ * `posix::stream::printf()`.
  *
- * One major difference from a regular embedded application is that
- * a fully semihosted test application does not run in an endless
- * loop, but terminates, and the test result must be passed back
- * to the host system, via the exit code and optionally via a
- * detailed status file.
+ * @details
+ * Longer output is formatted in a temporary buffer, allocated from
+ * the default memory resource.
  */
-#define OS_USE_SEMIHOSTING_SYSCALLS
+#define OS_INTEGER_POSIX_IO_STREAM_PRINTF_TMP_ARRAY_SIZE (128)
 
 /**
- * @brief Define the maximum number of semihosting open files.
+ * @brief Define the number of per-thread line buffers of a stream.
  *
  * @details
- * The implementation of the semihosting file support requires
- * an array of open files, to keep track of the host files.
+ * Used by the streams with `buffering::thread_line`; a buffer is
+ * taken only while a thread has a partial line. When all are taken,
+ * the other threads use the shared stream buffer. Use 0 to disable.
+ */
+#define OS_INTEGER_POSIX_IO_STREAM_THREAD_LINES (4)
+
+/**
+ * @brief Define the size of the per-thread line buffers.
  *
- * To simplify the implementation and avoid dynamic allocations, a static
- * array is used. This option defines the size of this array.
+ * @details
+ * Longer lines are written in several parts.
+ */
+#define OS_INTEGER_POSIX_IO_STREAM_THREAD_LINE_SIZE (80)
+
+/**
+ * @brief Define the max number of buffers in a chain sent by copy.
  *
- * @par Default
- *  20.
+ * @details
+ * Used by `socket::send_buffers()` when the stack cannot take the
+ * buffers and the chain is sent with `sendmsg()`; longer chains
+ * fail with EMSGSIZE.
  */
-#define OS_INTEGER_SEMIHOSTING_MAX_OPEN_FILES (20)
+#define OS_INTEGER_POSIX_IO_SOCKET_SEND_IOV_MAX (8)
 
 /**
- * @brief Include definitions for the standard POSIX system calls.
+ * @brief Define the number of buckets in the devices registry.
  *
- * @todo update after POSIX I/O is updated.
+ * @details
+ * The devices are hashed by name; with about as many buckets as
+ * devices, the lookup in `open()` takes a constant time.
  */
-#define OS_INCLUDE_STANDARD_POSIX_FUNCTIONS
+#define OS_INTEGER_POSIX_IO_DEVICE_REGISTRY_BUCKETS (16)
 
 /**
- * @brief Include definitions for the newlib system calls.
+ * @brief Define the stack size of the flash translation layer thread.
  *
- * @todo update after POSIX I/O is updated.
+ * @details
+ * Each `block_device_flash` has a background thread, which erases
+ * ahead and collects the units; the stack is part of the object.
  */
-#define OS_INCLUDE_NEWLIB_POSIX_FUNCTIONS
+#define OS_INTEGER_POSIX_IO_FLASH_STACK_SIZE_BYTES (2048)
 
 /**
- * @brief Disable setting MSP during startup.
+ * @brief Keep I/O statistics for each object.
  *
  * @details
- * On Cortex-M, during startup, the MSP register is set to the stack
- * pointer available in the first word pointed by VTOR.
- * Some platforms run custom firmware (like Nordic's soft radio)
- * that take control of VTOR and set it to a location which does
- * point to the valid interrupt stack. It is perfectly acceptable
- * to not reset MSP, and leave it to the location where it reached
- * before switching to PSP, just that some stack space is wasted.
+ * Count the bytes, the calls, the errors and the duration of the
+ * read and write operations, measured with `clock_highres`; they are
+ * available with `io::statistics()` and, for all open descriptors,
+ * with `file_descriptors_manager::statistics()`.
  */
-#define OS_DISABLE_CORTEXM_SET_MSP_VIA_VTOR
+#define OS_INCLUDE_POSIX_IO_STATISTICS
 
 /**
- * @}
+ * @brief Define the receive timeout of the buffered serial devices.
+ *
+ * @details
+ * The number of bit periods the line must be idle before the driver
+ * signals `rx_timeout`, configured in `open()` when the driver
+ * supports it; the readers are woken up once per frame, with what
+ * was received so far. Zero leaves the driver default.
  */
+#define OS_INTEGER_POSIX_DRIVER_SERIAL_RX_TIMEOUT_BITS (30)
 
-// ----------------------------------------------------------------------------
 /**
- * @ingroup cmsis-plus-app-config-lib
- * @{
+ * @brief Define the largest USB mass storage transfer.
+ *
+ * @details
+ * Longer reads and writes are split in SCSI commands of at most
+ * this many bytes, rounded down to whole blocks.
  */
+#define OS_INTEGER_POSIX_DRIVER_USB_MSC_TRANSFER_SIZE (64 * 1024)
 
 /**
- * @brief Use a very lite atexit().
+ * @brief Define the longest send polled by the USART wrapper.
  *
  * @details
- * The standard `atexit()` maintains a generic registry
- * to keep track of the actions to be performed at exit.
- * As storage, this uses an
- * initial static buffer plus a series of dynamically allocated
- * blocks.
- * For very tight configurations
- * this might be problematic, and a lite, always static version is provided.
- * Please note that this version supports only simple actions
- * registered via atexit(); more general cxa or dso handles are not
- * supported, and when exception are enabled, this options is ignored.
- * The size of the static array is configured via
- * `OS_INTEGER_ATEXIT_ARRAY_SIZE`.
+ * `usart_wrapper::send_wait()` busy waits for messages up to this
+ * many bytes, and suspends the thread for longer ones.
  */
-#define OS_INCLUDE_ATEXIT_STATIC
+#define OS_INTEGER_DRIVER_USART_WRAPPER_POLL_BYTES (16)
 
 /**
- * @brief Define the size of the `atexit()` array.
+ * @brief Define the max number of DMA channels per engine.
  *
  * @details
- * To simplify the implementation and avoid dynamic allocations, a static
- * array is used. This option defines the size of this array.
+ * The size of the channel tables in `driver::Dma`; at most 32.
  */
-#define OS_INTEGER_ATEXIT_ARRAY_SIZE (3)
+#define OS_INTEGER_DRIVER_DMA_CHANNELS (16)
 
 /**
- * @brief Define the maximum size of a directory name.
+ * @brief Define the shortest copy offloaded to the DMA.
+ *
+ * @details
+ * `driver::dma::memcpy()` copies shorter blocks with the CPU.
  */
-#define OS_INTEGER_DIRENT_NAME_MAX  (256)
+#define OS_INTEGER_DRIVER_DMA_MEMCPY_THRESHOLD (512)
 
 
 /**
@@ -720,6 +2597,27 @@
  */
 #define OS_USE_TRACE_ITM
 
+/**
+ * @brief Enable the ITM timestamps.
+ *
+ * @details
+ * If the debugger enabled the ITM, `trace::initialize()` also
+ * enables the local and global timestamps, the synchronisation
+ * packets and the forwarding of the DWT packets, used by
+ * `os::trace::itm::watch_data()`.
+ */
+#define OS_USE_TRACE_ITM_TIMESTAMPS
+
+/**
+ * @brief Send the RTOS events to the ITM.
+ *
+ * @details
+ * Implement the RTOS event tracing hooks with compact packets
+ * sent to the @ref OS_INTEGER_TRACE_ITM_RTOS_PORT stimulus port.
+ * Requires @ref OS_INCLUDE_RTOS_TRACE_EVENTS.
+ */
+#define OS_USE_TRACE_ITM_RTOS_EVENTS
+
 /**
  * @brief Forward trace messages via the semihosting debug channel.
  *
@@ -768,6 +2666,24 @@
  */
 #define OS_USE_TRACE_SEMIHOSTING_STDOUT
 
+/**
+ * @brief Buffer the semihosting trace messages.
+ *
+ * @details
+ * Each semihosting call halts the core, usually for milliseconds,
+ * so, with this option, the trace messages of both semihosting
+ * channels are collected in a ring buffer
+ * (@ref OS_INTEGER_TRACE_SEMIHOSTING_BUFFER_SIZE) and sent in
+ * large chunks, one host call for each, when a line ends with the
+ * buffer filled above @ref OS_INTEGER_TRACE_SEMIHOSTING_FLUSH_THRESHOLD,
+ * when the buffer is full, from the idle thread, and on
+ * `trace::flush()`.
+ *
+ * Messages may be delayed, so, before a breakpoint or a reset,
+ * call `trace::flush()`; `exit()` does it.
+ */
+#define OS_USE_TRACE_SEMIHOSTING_BUFFERED
+
 /**
  * @brief Forward trace messages via the POSIX STDOUT stream.
  *
@@ -797,6 +2713,86 @@
  */
 #define OS_USE_TRACE_SEGGER_RTT
 
+/**
+ * @brief Enable the binary trace ring.
+ *
+ * @details
+ * `os::trace::binary::log()` stores the format pointer, a timestamp
+ * and the raw arguments in a RAM ring, without formatting them;
+ * the records are formatted later by `os::trace::binary::drain()`,
+ * or on the host.
+ *
+ * @see OS_INTEGER_TRACE_BINARY_BUFFER_WORDS
+ */
+#define OS_USE_TRACE_BINARY
+
+/**
+ * @brief Intern the binary trace format strings.
+ *
+ * @details
+ * `OS_TRACE_LOG()` places the format strings, together with a
+ * compile time signature of the argument types, in the `.trace_fmt`
+ * section, and stores only their address in the ring. The section
+ * must not be loaded on the target; add to the linker script:
+ *
+ * @code{.ld}
+ * .trace_fmt 0 (INFO) : { KEEP(*(.trace_fmt .trace_fmt.*)) }
+ * @endcode
+ *
+ * so the addresses become small offsets, resolved on the host
+ * from the ELF file; `drain()` writes them as `@0x<id>`.
+ *
+ * Without this definition, `OS_TRACE_LOG()` is the same as
+ * `os::trace::binary::log()`.
+ *
+ * @see OS_USE_TRACE_BINARY
+ */
+#define OS_USE_TRACE_BINARY_INTERNED
+
+/**
+ * @brief Enable the cycle counting probes.
+ *
+ * @details
+ * `OS_PROBE_SCOPE("name")` measures the cycles from its
+ * definition to the end of the enclosing scope, and accumulates
+ * the count, minimum, maximum and total in a static record, with
+ * a pointer to it in the `.os_probes` sections;
+ * `os::trace::probe::trace_print()` prints all of them. The linker
+ * script must keep the pointers together, between
+ * `__os_probes_start` and `__os_probes_end`.
+ *
+ * Without this definition, `OS_PROBE_SCOPE()` expands to nothing.
+ */
+#define OS_USE_TRACE_PROBES
+
+/**
+ * @brief Record the RTOS events with SEGGER SystemView.
+ *
+ * @details
+ * Implement the RTOS event tracing hooks with the SEGGER SystemView
+ * target library, which sends the records over RTT. Requires
+ * @ref OS_INCLUDE_RTOS_TRACE_EVENTS and the SystemView sources.
+ */
+#define OS_USE_TRACE_SEGGER_SYSTEMVIEW
+
+/**
+ * @brief Filter the RTOS and POSIX I/O trace messages at run time.
+ *
+ * @details
+ * The trace messages compiled in by the `OS_TRACE_RTOS_*` and
+ * `OS_TRACE_POSIX_IO_*` definitions are written only if their
+ * category is enabled in the `os::trace::categories()` mask
+ * (also available as `os_trace_categories`, to be changed from
+ * the debugger); a disabled message costs one load and one
+ * predicted branch, and its arguments are not evaluated.
+ *
+ * A debug build can so keep all messages compiled in, and enable
+ * them only for the subsystem under investigation.
+ *
+ * @see OS_INTEGER_TRACE_CATEGORIES
+ */
+#define OS_USE_TRACE_CATEGORIES
+
 /**
  * @brief Enable trace messages for RTOS clocks functions.
  */
@@ -827,6 +2823,27 @@
  */
 #define OS_TRACE_RTOS_MQUEUE
 
+/**
+ * @brief Enable trace messages for RTOS single producer, single
+ *  consumer channels functions.
+ */
+#define OS_TRACE_RTOS_SPSC
+
+/**
+ * @brief Enable trace messages for RTOS stack pools functions.
+ */
+#define OS_TRACE_RTOS_STACK_POOL
+
+/**
+ * @brief Enable trace messages for RTOS wait sets functions.
+ */
+#define OS_TRACE_RTOS_WAIT_SET
+
+/**
+ * @brief Enable trace messages for RTOS executors functions.
+ */
+#define OS_TRACE_RTOS_EXECUTOR
+
 /**
  * @brief Enable trace messages for RTOS mutex functions.
  */
@@ -928,6 +2945,25 @@
  */
 #define OS_INTEGER_TRACE_ITM_STIMULUS_PORT  (0)
 
+/**
+ * @brief Define the ITM stimulus port used for the RTOS events.
+ *
+ * @par Default
+ *  1.
+ */
+#define OS_INTEGER_TRACE_ITM_RTOS_PORT  (1)
+
+/**
+ * @brief Define the ITM stimulus port used for the user counters.
+ *
+ * @details
+ * Written by `os::trace::itm::counter()`.
+ *
+ * @par Default
+ *  2.
+ */
+#define OS_INTEGER_TRACE_ITM_COUNTERS_PORT  (2)
+
 /**
  * @brief Define the semihosting debug buffer size.
  *
@@ -940,6 +2976,54 @@
  */
 #define OS_INTEGER_TRACE_SEMIHOSTING_BUFF_ARRAY_SIZE (16)
 
+/**
+ * @brief Define the size of the buffered semihosting trace ring.
+ *
+ * @details
+ * Used by @ref OS_USE_TRACE_SEMIHOSTING_BUFFERED. Two bytes are
+ * reserved; a power of 2 is recommended.
+ *
+ * @par Default
+ *  1024.
+ */
+#define OS_INTEGER_TRACE_SEMIHOSTING_BUFFER_SIZE (1024)
+
+/**
+ * @brief Define the fill level that triggers a flush at line end.
+ *
+ * @details
+ * Used by @ref OS_USE_TRACE_SEMIHOSTING_BUFFERED. Lower values make
+ * the messages appear sooner, with more host calls.
+ *
+ * @par Default
+ *  Half of @ref OS_INTEGER_TRACE_SEMIHOSTING_BUFFER_SIZE.
+ */
+#define OS_INTEGER_TRACE_SEMIHOSTING_FLUSH_THRESHOLD (512)
+
+/**
+ * @brief Define the initial mask of trace categories.
+ *
+ * @details
+ * Used by @ref OS_USE_TRACE_CATEGORIES; a combination of
+ * `os::trace::category` bits.
+ *
+ * @par Default
+ *  0 (all disabled).
+ */
+#define OS_INTEGER_TRACE_CATEGORIES (0)
+
+/**
+ * @brief Define the size of the binary trace ring, in words.
+ *
+ * @details
+ * Each record takes 3 words plus one for each argument.
+ * Must be a power of 2.
+ *
+ * @par Default
+ *  1024.
+ */
+#define OS_INTEGER_TRACE_BINARY_BUFFER_WORDS (1024)
+
 /**
  * @}
  */
@@ -0,0 +1,247 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_CORTEXM_CACHE_H_
+#define CMSIS_PLUS_CORTEXM_CACHE_H_
+
+// ----------------------------------------------------------------------------
+
+#ifdef __cplusplus
+
+#include <cstddef>
+#include <cstdint>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    namespace memory
+    {
+      class memory_resource;
+    } /* namespace memory */
+  } /* namespace rtos */
+
+  namespace cortexm
+  {
+    /**
+     * @brief Data cache maintenance.
+     *
+     * @details
+     * On devices without data cache (or with the cache disabled)
+     * the functions do nothing, so the drivers can call them
+     * unconditionally on their DMA paths.
+     */
+    namespace cache
+    {
+      // ----------------------------------------------------------------------
+
+      /**
+       * @brief The size of a data cache line (Cortex-M7).
+       */
+      constexpr std::size_t line_size_bytes = 32;
+
+      /**
+       * @brief Round an address down to the start of its cache line.
+       * @param [in] addr Address.
+       * @return The address of the cache line.
+       */
+      constexpr std::uintptr_t
+      align_down (std::uintptr_t addr)
+      {
+        return addr & ~(static_cast<std::uintptr_t> (line_size_bytes) - 1);
+      }
+
+      /**
+       * @brief Round a size up to a multiple of the cache line.
+       * @param [in] nbyte Number of bytes.
+       * @return The number of bytes of the covering cache lines.
+       */
+      constexpr std::size_t
+      align_up (std::size_t nbyte)
+      {
+        return (nbyte + line_size_bytes - 1) & ~(line_size_bytes - 1);
+      }
+
+      /**
+       * @brief Check if a range has whole cache lines.
+       * @param [in] addr Start address.
+       * @param [in] nbyte Number of bytes.
+       * @retval true The range starts and ends on cache line boundaries.
+       * @retval false The range shares cache lines with other data.
+       */
+      bool
+      is_aligned (const void* addr, std::size_t nbyte) noexcept;
+
+      /**
+       * @brief Write back the cache lines covering a range.
+       * @param [in] addr Start address.
+       * @param [in] nbyte Number of bytes.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      clean (const void* addr, std::size_t nbyte) noexcept;
+
+      /**
+       * @brief Discard the cache lines covering a range.
+       * @param [in] addr Start address.
+       * @param [in] nbyte Number of bytes.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      invalidate (void* addr, std::size_t nbyte) noexcept;
+
+      /**
+       * @brief Write back and discard the cache lines covering a range.
+       * @param [in] addr Start address.
+       * @param [in] nbyte Number of bytes.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      clean_invalidate (void* addr, std::size_t nbyte) noexcept;
+
+      /**
+       * @brief Allocate a buffer for DMA transfers.
+       * @param [in] nbyte Number of bytes.
+       * @param [in] res Pointer to memory resource; `nullptr` for
+       *  the default resource.
+       * @return Pointer to the buffer, or `nullptr`.
+       */
+      void*
+      allocate_dma_buffer (std::size_t nbyte,
+                           rtos::memory::memory_resource* res = nullptr);
+
+      /**
+       * @brief Deallocate a buffer for DMA transfers.
+       * @param [in] addr Pointer to the buffer.
+       * @param [in] nbyte Number of bytes, as allocated.
+       * @param [in] res Pointer to memory resource; `nullptr` for
+       *  the default resource.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      deallocate_dma_buffer (void* addr, std::size_t nbyte,
+                             rtos::memory::memory_resource* res = nullptr);
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @brief Statically allocated buffer for DMA transfers.
+       * @tparam N Number of bytes.
+       *
+       * @details
+       * The storage is aligned to the cache line, and its size
+       * rounded up, so maintaining the cache for the buffer does
+       * not affect the neighbouring variables.
+       */
+      template<std::size_t N>
+        class alignas(line_size_bytes) dma_buffer
+        {
+        public:
+
+          /**
+           * @brief Get the storage.
+           * @par Parameters
+           *  None.
+           * @return Pointer to the first byte.
+           */
+          uint8_t*
+          data (void) noexcept;
+
+          /**
+           * @brief Get the buffer size.
+           * @par Parameters
+           *  None.
+           * @return The number of bytes requested.
+           */
+          static constexpr std::size_t
+          size (void) noexcept;
+
+        protected:
+
+          /**
+           * @cond ignore
+           */
+
+          uint8_t storage_[align_up (N)];
+
+          /**
+           * @endcond
+           */
+        };
+
+    // ------------------------------------------------------------------------
+    } /* namespace cache */
+  } /* namespace cortexm */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace cortexm
+  {
+    namespace cache
+    {
+      // ----------------------------------------------------------------------
+
+      inline bool
+      is_aligned (const void* addr, std::size_t nbyte) noexcept
+      {
+        return ((reinterpret_cast<std::uintptr_t> (addr) | nbyte)
+            & (line_size_bytes - 1)) == 0;
+      }
+
+      template<std::size_t N>
+        inline uint8_t*
+        dma_buffer<N>::data (void) noexcept
+        {
+          return storage_;
+        }
+
+      template<std::size_t N>
+        constexpr std::size_t
+        dma_buffer<N>::size (void) noexcept
+        {
+          return N;
+        }
+
+    // ------------------------------------------------------------------------
+    } /* namespace cache */
+  } /* namespace cortexm */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_CORTEXM_CACHE_H_ */
@@ -0,0 +1,256 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_DIAG_PROBE_H_
+#define CMSIS_PLUS_DIAG_PROBE_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#include <cstdint>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace trace
+  {
+    /**
+     * @brief Cycle counting probes namespace.
+     * @ingroup cmsis-plus-diag
+     * @details
+     * Named scoped probes, defined with `OS_PROBE_SCOPE("name")`,
+     * measure the cycles spent from the definition to the end of
+     * the enclosing scope, and accumulate the count, minimum,
+     * maximum and total cycles in statically allocated records;
+     * pointers to the records are placed in the `.os_probes`
+     * sections, so that `trace_print()` can find all of them without
+     * any registration.
+     *
+     * The linker script must keep the pointers together, for
+     * example in `.rodata`:
+     *
+     * @code{.ld}
+     * __os_probes_start = .;
+     * KEEP(*(.os_probes .os_probes.*))
+     * __os_probes_end = .;
+     * @endcode
+     *
+     * The cycles are counted by the DWT `CYCCNT` where available.
+     *
+     * Enabled by `OS_USE_TRACE_PROBES`; otherwise the macro
+     * expands to nothing.
+     */
+    namespace probe
+    {
+      // ----------------------------------------------------------------------
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+      /**
+       * @brief Probe record.
+       */
+      typedef struct probe_s
+      {
+        /**
+         * @brief Name of the probe.
+         */
+        const char* name;
+
+        /**
+         * @brief Number of measurements.
+         */
+        uint32_t count;
+
+        /**
+         * @brief Minimum number of cycles.
+         */
+        uint32_t min;
+
+        /**
+         * @brief Maximum number of cycles.
+         */
+        uint32_t max;
+
+        /**
+         * @brief Sum of all measurements, in cycles.
+         */
+        uint64_t total;
+
+      } probe_t;
+
+#pragma GCC diagnostic pop
+
+      /**
+       * @brief Enable the cycle counter.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      initialize (void);
+
+      /**
+       * @brief Get the current cycle counter.
+       * @par Parameters
+       *  None.
+       * @return The DWT cycle counter, where available, or 0;
+       *  weak, applications can redefine it.
+       */
+      uint32_t
+      cycles (void);
+
+      /**
+       * @brief Accumulate a measurement.
+       * @param [in] p Reference to the probe record.
+       * @param [in] cycles Number of cycles.
+       * @par Returns
+       *  Nothing.
+       * @note Can be invoked from Interrupt Service Routines.
+       */
+      void
+      update (probe_t& p, uint32_t cycles);
+
+      /**
+       * @brief Clear all probe records.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      reset (void);
+
+      /**
+       * @brief Print all probe records on the trace channel.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      trace_print (void);
+
+      // ----------------------------------------------------------------------
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+      /**
+       * @brief Measure the cycles until the end of the scope.
+       */
+      class scope
+      {
+      public:
+
+        /**
+         * @brief Start a measurement.
+         * @param [in] p Reference to the probe record.
+         */
+        inline __attribute__((always_inline))
+        scope (probe_t& p) :
+            probe_ (p), //
+            start_ (cycles ())
+        {
+        }
+
+        /**
+         * @brief Stop the measurement and accumulate it.
+         */
+        inline __attribute__((always_inline))
+        ~scope ()
+        {
+          update (probe_, cycles () - start_);
+        }
+
+        scope (const scope&) = delete;
+        scope (scope&&) = delete;
+        scope&
+        operator= (const scope&) = delete;
+        scope&
+        operator= (scope&&) = delete;
+
+      private:
+
+        probe_t& probe_;
+        uint32_t start_;
+      };
+
+#pragma GCC diagnostic pop
+
+    } /* namespace probe */
+  } /* namespace trace */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#define OS_PROBE_CONCAT_(a, b) OS_PROBE_CONCAT__(a, b)
+#define OS_PROBE_CONCAT__(a, b) a ## b
+#define OS_PROBE_SECTION_(n) OS_PROBE_SECTION__(n)
+#define OS_PROBE_SECTION__(n) ".os_probes." #n
+
+/**
+ * @brief Measure the cycles until the end of the enclosing scope.
+ * @param [in] name String literal with the probe name.
+ * @details
+ * One pointer section per use, to avoid conflicts between the COMDAT
+ * sections of inline functions and the sections of normal functions.
+ *
+ * @note GCC ignores the section attribute in template instances,
+ *  where the records are not found by `trace_print()`.
+ */
+#if defined(OS_USE_TRACE_PROBES)
+
+#define OS_PROBE_SCOPE(name) \
+  static ::os::trace::probe::probe_t OS_PROBE_CONCAT_(os_probe_, __LINE__) = \
+    { name, 0, UINT32_MAX, 0, 0 }; \
+  static ::os::trace::probe::probe_t* const \
+  OS_PROBE_CONCAT_(os_probe_ptr_, __LINE__) \
+    __attribute__((section (OS_PROBE_SECTION_(__COUNTER__)), used)) = \
+      &OS_PROBE_CONCAT_(os_probe_, __LINE__); \
+  ::os::trace::probe::scope OS_PROBE_CONCAT_(os_probe_scope_, __LINE__) \
+    { OS_PROBE_CONCAT_(os_probe_, __LINE__) }
+
+#else
+
+#define OS_PROBE_SCOPE(name)
+
+#endif /* defined(OS_USE_TRACE_PROBES) */
+
+#endif /* __cplusplus */
+
+// ----------------------------------------------------------------------------
+
+#endif /* CMSIS_PLUS_DIAG_PROBE_H_ */
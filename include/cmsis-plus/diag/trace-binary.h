@@ -0,0 +1,385 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_DIAG_TRACE_BINARY_H_
+#define CMSIS_PLUS_DIAG_TRACE_BINARY_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+
+// ----------------------------------------------------------------------------
+
+#if !defined(OS_INTEGER_TRACE_BINARY_BUFFER_WORDS)
+#define OS_INTEGER_TRACE_BINARY_BUFFER_WORDS (1024)
+#endif
+
+namespace os
+{
+  namespace trace
+  {
+    /**
+     * @brief Binary trace namespace.
+     * @ingroup cmsis-plus-diag
+     * @details
+     * Deferred formatting trace. `log()` stores only the format
+     * string pointer, a timestamp and the raw arguments in a RAM
+     * ring, which costs a few dozen cycles; the messages are
+     * formatted later, by `drain()`, usually called from a low
+     * priority thread, or on the host, by a debugger script
+     * reading the `os_trace_binary_ring` structure and resolving
+     * the format pointers from the ELF file.
+     *
+     * The arguments are stored as machine words, so only integer,
+     * character and pointer conversions are supported; `%s`
+     * arguments must point to persistent strings.
+     *
+     * Enabled by `TRACE` and `OS_USE_TRACE_BINARY`; otherwise
+     * all functions are inlined to empty bodies.
+     */
+    namespace binary
+    {
+      // ----------------------------------------------------------------------
+
+      using word_t = uintptr_t;
+
+      /// Max number of arguments of a record.
+      constexpr std::size_t max_args = 4;
+
+#if defined(TRACE) && defined(OS_USE_TRACE_BINARY)
+
+      /**
+       * @brief Enable the timestamp counter.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      initialize (void);
+
+      /**
+       * @brief Get the current timestamp.
+       * @par Parameters
+       *  None.
+       * @return The DWT cycle counter, where available, or 0;
+       *  weak, applications can redefine it.
+       */
+      uint32_t
+      timestamp (void);
+
+      /**
+       * @brief Store a record in the ring.
+       * @param [in] format Pointer to persistent format string.
+       * @param [in] args Pointer to array of arguments.
+       * @param [in] nargs Number of arguments (up to `max_args`).
+       * @par Returns
+       *  Nothing.
+       * @note Can be invoked from Interrupt Service Routines.
+       */
+      void
+      record (const char* format, const word_t* args, std::size_t nargs);
+
+      /**
+       * @brief Format the stored records and write them.
+       * @param [in] max_records Max number of records to drain.
+       * @return The number of records written.
+       */
+      std::size_t
+      drain (std::size_t max_records = SIZE_MAX);
+
+      /**
+       * @brief Get the number of records lost because the ring was full.
+       * @par Parameters
+       *  None.
+       * @return The number of lost records.
+       */
+      uint32_t
+      dropped (void);
+
+      /**
+       * @brief Store a record with an interned format in the ring.
+       * @param [in] format Pointer to the format in the `.trace_fmt`
+       *  section.
+       * @param [in] args Pointer to array of arguments.
+       * @param [in] nargs Number of arguments (up to `max_args`).
+       * @par Returns
+       *  Nothing.
+       * @note Can be invoked from Interrupt Service Routines.
+       */
+      void
+      record_interned (const char* format, const word_t* args,
+                       std::size_t nargs);
+
+#else
+
+      inline void __attribute__((always_inline))
+      initialize (void)
+      {
+      }
+
+      inline uint32_t __attribute__((always_inline))
+      timestamp (void)
+      {
+        return 0;
+      }
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+      inline void __attribute__((always_inline))
+      record (const char* format, const word_t* args, std::size_t nargs)
+      {
+      }
+
+      inline std::size_t __attribute__((always_inline))
+      drain (std::size_t max_records = SIZE_MAX)
+      {
+        return 0;
+      }
+
+      inline void __attribute__((always_inline))
+      record_interned (const char* format, const word_t* args,
+                       std::size_t nargs)
+      {
+      }
+
+#pragma GCC diagnostic pop
+
+      inline uint32_t __attribute__((always_inline))
+      dropped (void)
+      {
+        return 0;
+      }
+
+#endif
+
+      // ----------------------------------------------------------------------
+
+      template<typename T>
+        inline typename std::enable_if<std::is_pointer<T>::value, word_t>::type
+        __attribute__((always_inline))
+        to_word (T value)
+        {
+          return reinterpret_cast<word_t> (value);
+        }
+
+      template<typename T>
+        inline typename std::enable_if<!std::is_pointer<T>::value, word_t>::type
+        __attribute__((always_inline))
+        to_word (T value)
+        {
+          return static_cast<word_t> (value);
+        }
+
+      /**
+       * @brief Log a message, without formatting it.
+       * @param [in] format Pointer to persistent format string.
+       * @param [in] args Integer or pointer arguments.
+       * @par Returns
+       *  Nothing.
+       */
+      inline void __attribute__((always_inline))
+      log (const char* format)
+      {
+        record (format, nullptr, 0);
+      }
+
+      template<typename ... Args>
+        inline void __attribute__((always_inline))
+        log (const char* format, Args ... args)
+        {
+          static_assert(sizeof...(Args) <= max_args, "Too many arguments");
+
+          const word_t words[] =
+            { to_word (args)... };
+          record (format, words, sizeof...(Args));
+        }
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @brief Argument type codes, stored in the interned signatures.
+       */
+      enum arg_type
+        : uint32_t
+          {
+            arg_signed = 1, //
+        arg_unsigned = 2, //
+        arg_char = 3, //
+        arg_pointer = 4, //
+        arg_string = 5
+      };
+
+      template<typename T>
+        constexpr uint32_t
+        arg_code (void)
+        {
+          using pointee_t = typename std::remove_cv<
+          typename std::remove_pointer<T>::type>::type;
+
+          return std::is_pointer<T>::value ?
+              (std::is_same<pointee_t, char>::value ?
+                  arg_string : arg_pointer) :
+              std::is_same<T, char>::value ? arg_char :
+              std::is_signed<T>::value ? arg_signed : arg_unsigned;
+        }
+
+      /**
+       * @brief Compile time signature of the argument types.
+       * @details
+       * The number of arguments in the low 4 bits, followed
+       * by the `arg_type` of each argument, 4 bits each.
+       */
+      template<typename ... Args>
+        struct signature;
+
+      template<>
+        struct signature<>
+        {
+          static constexpr uint32_t types = 0;
+          static constexpr uint32_t value = 0;
+        };
+
+      template<typename T, typename ... Rest>
+        struct signature<T, Rest...>
+        {
+          static_assert(std::is_integral<T>::value || std::is_enum<T>::value
+                            || std::is_pointer<T>::value,
+                        "Only integer and pointer arguments are supported");
+
+          static constexpr uint32_t types = arg_code<T> ()
+              | (signature<Rest...>::types << 4);
+          static constexpr uint32_t value = (1 + sizeof...(Rest))
+              | (types << 4);
+        };
+
+      // Only used in decltype(), to deduce the decayed argument types.
+      template<typename ... Args>
+        signature<Args...>
+        signature_of (Args ... args);
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+      /**
+       * @brief Interned format, as stored in the `.trace_fmt` section.
+       */
+      template<std::size_t N>
+        struct interned
+        {
+          uint32_t types;
+          char format[N];
+        };
+
+#pragma GCC diagnostic pop
+
+      /**
+       * @brief Log a message with an interned format.
+       * @param [in] format Pointer to the format in the `.trace_fmt`
+       *  section; never dereferenced on the target.
+       * @param [in] args Integer or pointer arguments.
+       * @par Returns
+       *  Nothing.
+       */
+      inline void __attribute__((always_inline))
+      log_interned (const char* format)
+      {
+        record_interned (format, nullptr, 0);
+      }
+
+      template<typename ... Args>
+        inline void __attribute__((always_inline))
+        log_interned (const char* format, Args ... args)
+        {
+          static_assert(sizeof...(Args) <= max_args, "Too many arguments");
+
+          const word_t words[] =
+            { to_word (args)... };
+          record_interned (format, words, sizeof...(Args));
+        }
+
+    } /* namespace binary */
+  } /* namespace trace */
+} /* namespace os */
+
+/**
+ * @brief Log a message with a compile time interned format.
+ * @param [in] fmt String literal with the format.
+ * @param [in] ... Integer or pointer arguments, up to 4.
+ * @details
+ * With `OS_USE_TRACE_BINARY_INTERNED`, the format and the signature
+ * of the argument types are placed in the non-loaded `.trace_fmt`
+ * section, and only the address, used as an ID, is stored in
+ * the ring.
+ *
+ * @note GCC ignores the section attribute in template instances,
+ *  where the formats remain in `.rodata`.
+ */
+#if defined(TRACE) && defined(OS_USE_TRACE_BINARY) \
+    && defined(OS_USE_TRACE_BINARY_INTERNED)
+
+// One section per use, to avoid conflicts between the COMDAT
+// sections of inline functions and the sections of normal functions.
+#define OS_TRACE_FMT_SECTION_(n) OS_TRACE_FMT_SECTION__(n)
+#define OS_TRACE_FMT_SECTION__(n) ".trace_fmt." #n
+
+#define OS_TRACE_LOG(fmt, ...) \
+  do \
+    { \
+      using os_trace_sig_ = \
+        decltype (::os::trace::binary::signature_of (__VA_ARGS__)); \
+      static const ::os::trace::binary::interned<sizeof(fmt)> os_trace_fmt_ \
+        __attribute__((section (OS_TRACE_FMT_SECTION_(__COUNTER__)), \
+            used)) = \
+          { os_trace_sig_::value, fmt }; \
+      ::os::trace::binary::log_interned (os_trace_fmt_.format, \
+                                         ##__VA_ARGS__); \
+    } \
+  while (0)
+
+#else
+
+#define OS_TRACE_LOG(fmt, ...) \
+  ::os::trace::binary::log (fmt, ##__VA_ARGS__)
+
+#endif
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_DIAG_TRACE_BINARY_H_ */
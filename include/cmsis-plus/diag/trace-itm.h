@@ -0,0 +1,212 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_DIAG_TRACE_ITM_H_
+#define CMSIS_PLUS_DIAG_TRACE_ITM_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#include <cstdint>
+#include <cstddef>
+
+// ----------------------------------------------------------------------------
+
+#if !defined(OS_INTEGER_TRACE_ITM_STIMULUS_PORT)
+#define OS_INTEGER_TRACE_ITM_STIMULUS_PORT     (0)
+#endif
+
+#if !defined(OS_INTEGER_TRACE_ITM_RTOS_PORT)
+#define OS_INTEGER_TRACE_ITM_RTOS_PORT         (1)
+#endif
+
+#if !defined(OS_INTEGER_TRACE_ITM_COUNTERS_PORT)
+#define OS_INTEGER_TRACE_ITM_COUNTERS_PORT     (2)
+#endif
+
+namespace os
+{
+  namespace trace
+  {
+    /**
+     * @brief ITM channels namespace.
+     * @ingroup cmsis-plus-diag
+     * @details
+     * Direct access to the ITM stimulus ports, with 8, 16 and 32-bit
+     * writes, so separate sources go to separate ports, and each
+     * packet is timestamped by the ITM, without RAM buffering.
+     *
+     * By default:
+     * - the `trace::printf()` text goes to
+     *   `OS_INTEGER_TRACE_ITM_STIMULUS_PORT`;
+     * - the RTOS events to `OS_INTEGER_TRACE_ITM_RTOS_PORT`;
+     * - the user counters to `OS_INTEGER_TRACE_ITM_COUNTERS_PORT`.
+     *
+     * Available with `TRACE` and `OS_USE_TRACE_ITM` on ARMv7-M;
+     * otherwise all functions are inlined to empty bodies.
+     */
+    namespace itm
+    {
+      // ----------------------------------------------------------------------
+
+      using port_t = uint8_t;
+
+      constexpr port_t text_port = OS_INTEGER_TRACE_ITM_STIMULUS_PORT;
+      constexpr port_t rtos_port = OS_INTEGER_TRACE_ITM_RTOS_PORT;
+      constexpr port_t counters_port = OS_INTEGER_TRACE_ITM_COUNTERS_PORT;
+
+#if defined(TRACE) && defined(OS_USE_TRACE_ITM) && defined(__ARM_EABI__)
+
+      /**
+       * @brief Check if the ITM and the stimulus port are enabled.
+       * @param [in] port Stimulus port (0-31).
+       * @retval true The port is enabled by the debugger.
+       * @retval false The writes to the port are discarded.
+       */
+      bool
+      is_enabled (port_t port);
+
+      /**
+       * @brief Write a byte to a stimulus port.
+       * @param [in] port Stimulus port (0-31).
+       * @param [in] value Value to write.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      write_u8 (port_t port, uint8_t value);
+
+      /**
+       * @brief Write a half word to a stimulus port.
+       * @param [in] port Stimulus port (0-31).
+       * @param [in] value Value to write.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      write_u16 (port_t port, uint16_t value);
+
+      /**
+       * @brief Write a word to a stimulus port.
+       * @param [in] port Stimulus port (0-31).
+       * @param [in] value Value to write.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      write_u32 (port_t port, uint32_t value);
+
+      /**
+       * @brief Write a buffer to a stimulus port, a word at a time.
+       * @param [in] port Stimulus port (0-31).
+       * @param [in] buf Pointer to bytes.
+       * @param [in] nbyte Number of bytes.
+       * @return The number of bytes written.
+       */
+      std::size_t
+      write (port_t port, const void* buf, std::size_t nbyte);
+
+      /**
+       * @brief Send a DWT data trace packet on each access to a word.
+       * @param [in] comparator DWT comparator (0-3).
+       * @param [in] address Address of the watched word, or `nullptr`
+       *  to disable the comparator.
+       * @retval true The comparator was configured.
+       * @retval false The comparator is not implemented.
+       */
+      bool
+      watch_data (std::size_t comparator, const volatile void* address);
+
+#else
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+      inline bool __attribute__((always_inline))
+      is_enabled (port_t port)
+      {
+        return false;
+      }
+
+      inline void __attribute__((always_inline))
+      write_u8 (port_t port, uint8_t value)
+      {
+      }
+
+      inline void __attribute__((always_inline))
+      write_u16 (port_t port, uint16_t value)
+      {
+      }
+
+      inline void __attribute__((always_inline))
+      write_u32 (port_t port, uint32_t value)
+      {
+      }
+
+      inline std::size_t __attribute__((always_inline))
+      write (port_t port, const void* buf, std::size_t nbyte)
+      {
+        return nbyte;
+      }
+
+      inline bool __attribute__((always_inline))
+      watch_data (std::size_t comparator, const volatile void* address)
+      {
+        return false;
+      }
+
+#pragma GCC diagnostic pop
+
+#endif
+
+      /**
+       * @brief Write a user counter value.
+       * @param [in] value Counter value.
+       * @par Returns
+       *  Nothing.
+       */
+      inline void __attribute__((always_inline))
+      counter (uint32_t value)
+      {
+        write_u32 (counters_port, value);
+      }
+
+    } /* namespace itm */
+  } /* namespace trace */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_DIAG_TRACE_ITM_H_ */
@@ -30,6 +30,10 @@
 
 // ----------------------------------------------------------------------------
 
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
 #if defined(__cplusplus)
 #include <cstdint>
 #include <cstddef>
@@ -432,4 +436,184 @@ trace_dump_args (int argc, char* argv[])
 
 // ----------------------------------------------------------------------------
 
+#if defined(__cplusplus)
+
+#if defined(TRACE) && defined(OS_USE_TRACE_CATEGORIES)
+extern "C"
+{
+  /**
+   * @brief The enabled trace categories.
+   * @details
+   * Exported with C linkage, so it can be also changed
+   * from the debugger.
+   */
+  extern volatile uint32_t os_trace_categories;
+}
+#endif
+
+namespace os
+{
+  namespace trace
+  {
+    // ------------------------------------------------------------------------
+
+    /**
+     * @brief Type of a mask of trace categories.
+     */
+    using categories_t = uint32_t;
+
+    /**
+     * @brief Trace categories.
+     * @details
+     * One bit for each RTOS or POSIX I/O subsystem; the related
+     * `OS_TRACE_RTOS_*` and `OS_TRACE_POSIX_IO_*` macros share
+     * the same category (for example all list traces are in
+     * `rtos_lists`).
+     */
+    namespace category
+    {
+      enum
+        : categories_t
+          {
+            none = 0, //
+        rtos_clocks = 1UL << 0, //
+        rtos_clocks_tick = 1UL << 1, //
+        rtos_condvar = 1UL << 2, //
+        rtos_evflags = 1UL << 3, //
+        rtos_executor = 1UL << 4, //
+        rtos_lists = 1UL << 5, //
+        rtos_mempool = 1UL << 6, //
+        rtos_mqueue = 1UL << 7, //
+        rtos_mutex = 1UL << 8, //
+        rtos_scheduler = 1UL << 9, //
+        rtos_semaphore = 1UL << 10, //
+        rtos_spsc = 1UL << 11, //
+        rtos_stack_pool = 1UL << 12, //
+        rtos_thread = 1UL << 13, //
+        rtos_thread_context = 1UL << 14, //
+        rtos_thread_flags = 1UL << 15, //
+        rtos_timer = 1UL << 16, //
+        rtos_wait_set = 1UL << 17, //
+        posix_io_block_device = 1UL << 18, //
+        posix_io_char_device = 1UL << 19, //
+        posix_io_device = 1UL << 20, //
+        posix_io_directory = 1UL << 21, //
+        posix_io_event_poll = 1UL << 22, //
+        posix_io_file = 1UL << 23, //
+        posix_io_file_system = 1UL << 24, //
+        posix_io_io = 1UL << 25, //
+        posix_io_net_stack = 1UL << 26, //
+        posix_io_socket = 1UL << 27, //
+        posix_io_stream = 1UL << 28, //
+        posix_io_tty = 1UL << 29, //
+        all = 0xFFFFFFFFUL
+      };
+    } /* namespace category */
+
+#if defined(TRACE) && defined(OS_USE_TRACE_CATEGORIES)
+
+    /**
+     * @brief Check if any of the trace categories is enabled.
+     * @param [in] mask Mask of categories.
+     * @retval true At least one category is enabled.
+     * @retval false None of the categories is enabled.
+     * @details
+     * One load and a branch predicted as not taken.
+     */
+    inline bool
+    __attribute__((always_inline))
+    is_enabled (categories_t mask)
+    {
+      return __builtin_expect ((os_trace_categories & mask) != 0, 0);
+    }
+
+    /**
+     * @brief Get the enabled trace categories.
+     * @par Parameters
+     *  None.
+     * @return Mask of categories.
+     */
+    inline categories_t
+    __attribute__((always_inline))
+    categories (void)
+    {
+      return os_trace_categories;
+    }
+
+    /**
+     * @brief Set the enabled trace categories.
+     * @param [in] mask Mask of categories.
+     * @return The previous mask.
+     */
+    inline categories_t
+    __attribute__((always_inline))
+    categories (categories_t mask)
+    {
+      categories_t prev = os_trace_categories;
+      os_trace_categories = mask;
+      return prev;
+    }
+
+#else
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+    inline bool
+    __attribute__((always_inline))
+    is_enabled (categories_t mask)
+    {
+      return true;
+    }
+
+    inline categories_t
+    __attribute__((always_inline))
+    categories (void)
+    {
+      return category::all;
+    }
+
+    inline categories_t
+    __attribute__((always_inline))
+    categories (categories_t mask)
+    {
+      return category::all;
+    }
+
+#pragma GCC diagnostic pop
+
+#endif /* defined(TRACE) && defined(OS_USE_TRACE_CATEGORIES) */
+
+  } /* namespace trace */
+} /* namespace os */
+
+/**
+ * @brief Write a formatted string to the trace device, if the
+ *  category is enabled.
+ * @param [in] cat Name of the category, like `rtos_lists`.
+ * @param [in] ... The format and the arguments.
+ * @details
+ * With `OS_USE_TRACE_CATEGORIES`, the arguments are not evaluated
+ * when the category is disabled; without it, the same as
+ * `os::trace::printf()`, limited only by the compile time
+ * `OS_TRACE_*` definitions.
+ */
+#if defined(TRACE) && defined(OS_USE_TRACE_CATEGORIES)
+#define OS_TRACE_PRINTF(cat, ...) \
+  do \
+    { \
+      if (::os::trace::is_enabled (::os::trace::category::cat)) \
+        { \
+          ::os::trace::printf (__VA_ARGS__); \
+        } \
+    } \
+  while (false)
+#else
+#define OS_TRACE_PRINTF(cat, ...) ::os::trace::printf (__VA_ARGS__)
+#endif
+
+#endif /* defined(__cplusplus) */
+
+// ----------------------------------------------------------------------------
+
 #endif /* CMSIS_PLUS_DIAG_TRACE_H_ */
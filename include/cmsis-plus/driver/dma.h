@@ -0,0 +1,404 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_DRIVER_DMA_H_
+#define CMSIS_PLUS_DRIVER_DMA_H_
+
+// ----------------------------------------------------------------------------
+
+#ifdef __cplusplus
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#include <cmsis-plus/driver/common.h>
+
+#include <cstddef>
+
+// ----------------------------------------------------------------------------
+
+#if !defined(OS_INTEGER_DRIVER_DMA_CHANNELS)
+#define OS_INTEGER_DRIVER_DMA_CHANNELS (16)
+#endif
+
+#if !defined(OS_INTEGER_DRIVER_DMA_MEMCPY_THRESHOLD)
+#define OS_INTEGER_DRIVER_DMA_MEMCPY_THRESHOLD (512)
+#endif
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace driver
+  {
+    namespace dma
+    {
+      // ----------------------------------------------------------------------
+
+      using channel_t = uint8_t;
+      using request_t = uint32_t;
+      using flags_t = uint32_t;
+
+      ///< Returned by allocate() when no channel is available.
+      constexpr channel_t CHANNEL_NONE = 0xFF;
+
+      ///< The request line of memory to memory transfers.
+      constexpr request_t REQUEST_MEMORY = 0;
+
+      // ----- Descriptor flags -----
+
+      ///< Do not increment the source address (peripheral register).
+      constexpr flags_t FLAG_SRC_FIXED = (1UL << 0);
+      ///< Do not increment the destination address (peripheral register).
+      constexpr flags_t FLAG_DST_FIXED = (1UL << 1);
+
+      constexpr uint32_t FLAG_WIDTH_Pos = 4;
+      constexpr flags_t FLAG_WIDTH_Msk = (3UL << FLAG_WIDTH_Pos);
+      ///< Move bytes (default).
+      constexpr flags_t FLAG_WIDTH_8 = (0UL << FLAG_WIDTH_Pos);
+      ///< Move half words.
+      constexpr flags_t FLAG_WIDTH_16 = (1UL << FLAG_WIDTH_Pos);
+      ///< Move words.
+      constexpr flags_t FLAG_WIDTH_32 = (2UL << FLAG_WIDTH_Pos);
+
+      ///< Signal Event::block_complete after this descriptor.
+      constexpr flags_t FLAG_SIGNAL = (1UL << 8);
+
+      /**
+       * @brief DMA Events
+       */
+      enum Event
+        : event_t
+          {
+            //
+
+        ///< All descriptors of the chain were transferred
+        transfer_complete = (1UL << 0),
+
+        ///< A descriptor with FLAG_SIGNAL was transferred
+        block_complete = (1UL << 1),
+
+        ///< Bus error; the transfer was stopped
+        transfer_error = (1UL << 2),
+      };
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @brief Scatter-gather descriptor.
+       * @details
+       * The chain is processed in order, following the `next`
+       * links, until `nullptr`. Descriptors must not be changed
+       * until the transfer completes or is aborted; engines without
+       * hardware scatter-gather are expected to walk the chain from
+       * their interrupt.
+       */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+      struct descriptor
+      {
+        descriptor* next;
+        const void* src;
+        void* dst;
+        /// Number of items, of the width given in flags.
+        std::size_t num;
+        flags_t flags;
+      };
+
+#pragma GCC diagnostic pop
+
+      // ----------------------------------------------------------------------
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+      /**
+       * @brief DMA Driver Capabilities.
+       */
+      class Capabilities
+      {
+      public:
+
+        ///< Number of channels
+        uint8_t channels;
+
+        ///< Supports memory to memory transfers
+        bool memory_to_memory :1;
+
+        ///< Walks descriptor chains in hardware
+        bool scatter_gather :1;
+      };
+
+#pragma GCC diagnostic pop
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @brief Make the data cache coherent before a DMA read.
+       * @param [in] addr Start address.
+       * @param [in] nbyte Number of bytes.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      clean_cache (const void* addr, std::size_t nbyte) noexcept;
+
+      /**
+       * @brief Discard the cached copy after a DMA write.
+       * @param [in] addr Start address.
+       * @param [in] nbyte Number of bytes.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      invalidate_cache (void* addr, std::size_t nbyte) noexcept;
+
+    } /* namespace dma */
+
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Generic DMA engine.
+     * @details
+     * Peripheral drivers allocate channels from the engine and
+     * submit descriptor chains, instead of programming the DMA
+     * controller themselves.
+     */
+    class Dma
+    {
+    public:
+
+      // ----------------------------------------------------------------------
+
+      Dma () noexcept;
+
+      Dma (const Dma&) = delete;
+
+      Dma (Dma&&) = delete;
+
+      Dma&
+      operator= (const Dma&) = delete;
+
+      Dma&
+      operator= (Dma&&) = delete;
+
+      virtual
+      ~Dma () noexcept;
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @brief       Get driver capabilities.
+       * @return      Capabilities.
+       */
+      const dma::Capabilities&
+      get_capabilities (void) noexcept;
+
+      /**
+       * @brief       Allocate a channel.
+       * @param [in] request Peripheral request line.
+       * @return      The channel, or CHANNEL_NONE.
+       */
+      dma::channel_t
+      allocate (dma::request_t request = dma::REQUEST_MEMORY) noexcept;
+
+      /**
+       * @brief       Release a channel.
+       * @param [in] ch Channel.
+       * @return      none
+       */
+      void
+      release (dma::channel_t ch) noexcept;
+
+      /**
+       * @brief       Register channel event callback.
+       * @param [in] ch Channel.
+       * @param [in] cb_func  Pointer to function.
+       * @param [in] cb_object Pointer to object passed to function.
+       * @param [in] deferred Call it from the deferred calls worker
+       *  thread instead of the interrupt.
+       * @return      none
+       */
+      void
+      register_callback (dma::channel_t ch, signal_event_t cb_func,
+                         const void* cb_object = nullptr,
+                         bool deferred = false) noexcept;
+
+      /**
+       * @brief       Start a transfer.
+       * @param [in] ch Channel.
+       * @param [in] chain Pointer to the first descriptor.
+       * @return      Execution status.
+       */
+      return_t
+      start (dma::channel_t ch, const dma::descriptor* chain) noexcept;
+
+      /**
+       * @brief       Abort the transfer.
+       * @param [in] ch Channel.
+       * @return      Execution status.
+       */
+      return_t
+      abort (dma::channel_t ch) noexcept;
+
+      /**
+       * @brief       Get the number of items left in the current
+       *  descriptor.
+       * @param [in] ch Channel.
+       * @return      Number of items.
+       */
+      std::size_t
+      get_remaining (dma::channel_t ch) noexcept;
+
+      /**
+       * @brief       Copy memory and wait for the copy to complete.
+       * @param [out] dst Destination.
+       * @param [in] src Source.
+       * @param [in] nbyte Number of bytes.
+       * @return      Execution status.
+       */
+      return_t
+      copy (void* dst, const void* src, std::size_t nbyte) noexcept;
+
+      /**
+       * @brief       Signal channel events.
+       * @param [in] ch Channel.
+       * @param [in] event Event notification mask.
+       * @return      none
+       */
+      void
+      signal_event (dma::channel_t ch, event_t event) noexcept;
+
+    protected:
+
+      // ----- To be implemented by derived classes -----
+
+      virtual const dma::Capabilities&
+      do_get_capabilities (void) noexcept = 0;
+
+      // Returns any error to refuse the channel for this request.
+      virtual return_t
+      do_open_channel (dma::channel_t ch, dma::request_t request) noexcept = 0;
+
+      virtual void
+      do_close_channel (dma::channel_t ch) noexcept = 0;
+
+      virtual return_t
+      do_start (dma::channel_t ch, const dma::descriptor* chain) noexcept = 0;
+
+      virtual return_t
+      do_abort (dma::channel_t ch) noexcept = 0;
+
+      virtual std::size_t
+      do_get_remaining (dma::channel_t ch) noexcept = 0;
+
+    private:
+
+      static void
+      deferred_event_ (void* args);
+
+      static void
+      copy_complete_ (const void* object, event_t event);
+
+      struct channel_state
+      {
+        Dma* dma;
+        signal_event_t cb_func;
+        const void* cb_object;
+        // Events accumulated until the deferred call runs.
+        volatile event_t pending;
+        dma::channel_t ch;
+        bool deferred;
+      };
+
+      /// One bit for each allocated channel.
+      uint32_t allocated_ = 0;
+
+      channel_state channels_[OS_INTEGER_DRIVER_DMA_CHANNELS];
+
+      static_assert(OS_INTEGER_DRIVER_DMA_CHANNELS <= 32,
+          "The allocation mask has 32 bits");
+    };
+
+#pragma GCC diagnostic pop
+
+    namespace dma
+    {
+      /**
+       * @brief       Set the engine used by memcpy().
+       * @param [in] engine Pointer to engine, or `nullptr`.
+       * @return      none
+       */
+      void
+      set_memcpy_engine (Dma* engine) noexcept;
+
+      /**
+       * @brief       Copy memory, with the DMA for large blocks.
+       * @param [out] dst Destination.
+       * @param [in] src Source.
+       * @param [in] nbyte Number of bytes.
+       * @return      dst.
+       */
+      void*
+      memcpy (void* dst, const void* src, std::size_t nbyte) noexcept;
+    } /* namespace dma */
+
+    // ------------------------------------------------------------------------
+    // ----- Definitions -----
+
+    inline const dma::Capabilities&
+    Dma::get_capabilities (void) noexcept
+    {
+      return do_get_capabilities ();
+    }
+
+    inline return_t
+    Dma::abort (dma::channel_t ch) noexcept
+    {
+      return do_abort (ch);
+    }
+
+    inline std::size_t
+    Dma::get_remaining (dma::channel_t ch) noexcept
+    {
+      return do_get_remaining (ch);
+    }
+
+  } /* namespace driver */
+} /* namespace os */
+
+#endif /* __cplusplus */
+
+// ----------------------------------------------------------------------------
+
+#endif /* CMSIS_PLUS_DRIVER_DMA_H_ */
@@ -182,6 +182,10 @@ namespace os
       ///< Smart Card NACK generation; arg: 0=disabled, 1=enabled
       constexpr config_t SMART_CARD_NACK = (0x14UL << CONFIG_Pos);
 
+      ///< Set receive (idle line) timeout, signalled by Event::rx_timeout;
+      ///< arg = number of bit periods without a new character, 0=disabled
+      constexpr config_t RX_TIMEOUT = (0x1CUL << CONFIG_Pos);
+
       // --------------------------------------------------------------------
       // ----- Commands -----
 
@@ -207,6 +211,9 @@ namespace os
         ///< Abort @ref Serial::transfer()
         abort_transfer = (0x1AUL << CONFIG_Pos),
 
+        ///< Make the next @ref Serial::receive() circular (optional)
+        enable_rx_circular = (0x1BUL << CONFIG_Pos),
+
         ///< Disable Transmitter
         disable_tx = (0x25UL << CONFIG_Pos),
 
@@ -214,7 +221,10 @@ namespace os
         disable_rx = (0x26UL << CONFIG_Pos),
 
         ///< Disable Continuous Break transmission;
-        disable_break = (0x27UL << CONFIG_Pos)
+        disable_break = (0x27UL << CONFIG_Pos),
+
+        ///< Return to one-shot @ref Serial::receive()
+        disable_rx_circular = (0x2BUL << CONFIG_Pos)
       };
 
       // --------------------------------------------------------------------
@@ -409,7 +419,7 @@ namespace os
         ///< Receive data overflow
         rx_overflow = (1UL << 5),
 
-        ///< Receive character timeout (optional)
+        ///< Receive character timeout, the line was idle (optional)
         rx_timeout = (1UL << 6),
 
         ///< Break detected on receive
@@ -432,6 +442,9 @@ namespace os
 
         ///< RI  state changed (optional)
         ri = (1UL << 13),
+
+        ///< Half of the circular receive buffer filled (optional)
+        rx_half_complete = (1UL << 14),
       };
 
       // ====================================================================
@@ -511,6 +524,16 @@ namespace os
 
         ///< Signal RI change event.
         bool event_ri :1;
+
+        // Bits beyond this point are reserved in ARM CMSIS and
+        // read as zero from wrapped drivers.
+
+        ///< Circular receive: Control::enable_rx_circular,
+        ///< rx_half_complete and a get_rx_count() that wraps.
+        bool rx_circular :1;
+
+        ///< Transfers with DMA; the buffers need data cache maintenance.
+        bool dma :1;
       };
 
 #pragma GCC diagnostic pop
@@ -550,11 +573,14 @@ namespace os
        * @brief       Register event callback.
        * @param [in] cb_func  Pointer to function.
        * @param [in] cb_object Pointer to object passed to function.
+       * @param [in] coalesce Accumulate the events and deliver them
+       *  once, from the deferred calls worker thread.
        * @return      Execution status
        */
       void
       register_callback (signal_event_t cb_func,
-                         const void* cb_object = nullptr) noexcept;
+                         const void* cb_object = nullptr,
+                         bool coalesce = false) noexcept;
 
       // --------------------------------------------------------------------
 
@@ -602,7 +628,8 @@ namespace os
 
       /**
        * @brief       Get received bytes count.
-       * @return      number of bytes received
+       * @return      number of bytes received; for a circular receive,
+       *  the current write position in the buffer (it wraps to 0).
        */
       std::size_t
       get_rx_count (void) noexcept;
@@ -696,6 +723,14 @@ namespace os
       virtual serial::Modem_status&
       do_get_modem_status (void) noexcept = 0;
 
+    private:
+
+      void
+      internal_coalesce_event_ (event_t event) noexcept;
+
+      static void
+      internal_deliver_events_ (void* args);
+
     protected:
 
       /// Pointer to static function that implements the callback.
@@ -704,6 +739,12 @@ namespace os
       /// Pointer to object instance associated with this driver.
       const void* cb_object_;
 
+      /// Events accumulated until the deferred call runs.
+      volatile event_t pending_events_;
+
+      /// Deliver the events from the deferred calls worker.
+      bool coalesce_;
+
       serial::Status status_;
       serial::Modem_status modem_status_;
 
@@ -842,6 +883,11 @@ namespace os
     {
       if (cb_func_ != nullptr)
         {
+          if (coalesce_)
+            {
+              internal_coalesce_event_ (event);
+              return;
+            }
           // Forward event to registered callback.
           cb_func_ (cb_object_, event);
         }
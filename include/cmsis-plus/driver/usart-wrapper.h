@@ -28,10 +28,20 @@
 #ifndef CMSIS_PLUS_DRIVER_USART_WRAPPER_H_
 #define CMSIS_PLUS_DRIVER_USART_WRAPPER_H_
 
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
 #include <cmsis-plus/driver/serial.h>
 
 // ----------------------------------------------------------------------------
 
+#if !defined(OS_INTEGER_DRIVER_USART_WRAPPER_POLL_BYTES)
+#define OS_INTEGER_DRIVER_USART_WRAPPER_POLL_BYTES (16)
+#endif
+
+// ----------------------------------------------------------------------------
+
 extern "C"
 {
   // Avoid to include <Driver_USART.h>
@@ -43,6 +53,11 @@ extern "C"
 
 namespace os
 {
+  namespace rtos
+  {
+    class thread;
+  } /* namespace rtos */
+
   namespace driver
   {
     // ======================================================================
@@ -77,6 +92,39 @@ namespace os
 
       // --------------------------------------------------------------------
 
+      /**
+       * @brief       Send and wait for the send to complete.
+       * @param [in] data  Pointer to buffer with data to send.
+       * @param [in] num   Number of data items to send.
+       * @return      Execution status.
+       */
+      return_t
+      send_wait (const void* data, std::size_t num) noexcept;
+
+      /**
+       * @brief       Receive and wait for the receive to complete.
+       * @param [out] data  Pointer to buffer for data to receive.
+       * @param [in] num   Number of data items to receive.
+       * @return      Execution status.
+       */
+      return_t
+      receive_wait (void* data, std::size_t num) noexcept;
+
+      /**
+       * @brief       Signal serial events.
+       * @param [in]  event Event notification mask.
+       * @return      none
+       *
+       * @details
+       * Must be called by the C callback passed to the constructor,
+       * instead of `Serial::signal_event()`, to wake up the threads
+       * waiting in `send_wait()` or `receive_wait()`.
+       */
+      void
+      signal_event (event_t event) noexcept;
+
+      // --------------------------------------------------------------------
+
     protected:
 
       virtual const Version&
@@ -131,6 +179,13 @@ namespace os
       /// Initialize() is now delayed just before PowerControl(FULL).
       ARM_USART_SignalEvent_t c_cb_func_;
 
+      /// The threads waiting in send_wait() and receive_wait().
+      rtos::thread* volatile tx_waiter_ = nullptr;
+      rtos::thread* volatile rx_waiter_ = nullptr;
+
+      /// The receive events received while waiting.
+      volatile event_t rx_events_ = 0;
+
       // Attempts to somehow use && failed, since the Keil driver
       // functions return temporary objects. So the only portable
       // solution was to copy these objects here and return
@@ -181,6 +181,56 @@ namespace os
         (*signal_endpoint_event_t) (const void* object, endpoint_t ep_addr,
                                     event_t event);
 
+        // ==================================================================
+        // ----- USB Device Queued Transfers -----
+
+        struct transfer_request;
+
+        typedef void
+        (*signal_transfer_complete_t) (const void* object,
+                                       transfer_request* request);
+
+        ///< Number of endpoint queues, both directions.
+        constexpr std::size_t ENDPOINT_QUEUES = 2 * (ENDPOINT_NUMBER_MASK + 1);
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+        /**
+         * @brief Transfer queued with Device::submit_transfer().
+         *
+         * @details
+         * From submit until the completion callback, the request and
+         * its buffer belong to the driver; the callback hands both back,
+         * with the actual count and the status. Requests can be chained
+         * with `next` and submitted at once.
+         */
+        struct transfer_request
+        {
+          ///< Next request in the chain or queue.
+          transfer_request* next;
+
+          ///< Buffer to read into or write from.
+          uint8_t* data;
+
+          ///< Number of bytes to transfer; 0 for a zero length packet.
+          std::size_t num;
+
+          ///< Number of bytes transferred, set at completion.
+          std::size_t count;
+
+          ///< RETURN_OK, or the error, set at completion.
+          return_t status;
+
+          ///< Called at completion, usually in an interrupt context.
+          signal_transfer_complete_t cb_func;
+
+          ///< Object passed to the callback.
+          const void* cb_object;
+        };
+
+#pragma GCC diagnostic pop
+
       } /* namespace device */
 
       // ====================================================================
@@ -216,15 +266,19 @@ namespace os
          * @brief       Register device event callback.
          * @param [in]   cb_func  Pointer to function.
          * @param [in] cb_object Pointer to object passed to the function.
+         * @param [in] coalesce Accumulate the events and deliver them
+         *  once, from the deferred calls worker thread.
          * @return      Execution status.
          */
         void
         register_device_callback (device::signal_device_event_t cb_func,
-                                  const void* cb_object = nullptr) noexcept;
+                                  const void* cb_object = nullptr,
+                                  bool coalesce = false) noexcept;
 
         void
         register_endpoint_callback (device::signal_endpoint_event_t cb_func,
-                                    const void* cb_object = nullptr) noexcept;
+                                    const void* cb_object = nullptr,
+                                    bool coalesce = false) noexcept;
 
         // ------------------------------------------------------------------
 
@@ -354,6 +408,28 @@ namespace os
         return_t
         abort_transfer (endpoint_t ep_addr) noexcept;
 
+        /**
+         * @brief       Queue transfers on USB Endpoint.
+         * @param [in]   ep_addr  Endpoint Address
+         *                - ep_addr.0..3: Address
+         *                - ep_addr.7:    Direction
+         * @param [in]   request  Pointer to a chain of requests.
+         * @return      Execution status.
+         */
+        return_t
+        submit_transfer (endpoint_t ep_addr,
+                         device::transfer_request* request) noexcept;
+
+        /**
+         * @brief       Abort all queued transfers on USB Endpoint.
+         * @param [in]   ep_addr  Endpoint Address
+         *                - ep_addr.0..3: Address
+         *                - ep_addr.7:    Direction
+         * @return      Execution status.
+         */
+        return_t
+        abort_transfers (endpoint_t ep_addr) noexcept;
+
         /**
          * @brief       Signal device events.
          * @param [in]  event
@@ -421,6 +497,26 @@ namespace os
 
       private:
 
+        static std::size_t
+        queue_index (endpoint_t ep_addr) noexcept;
+
+        bool
+        complete_queued_transfer (endpoint_t ep_addr) noexcept;
+
+        void
+        complete_requests (device::transfer_request* list, return_t status)
+            noexcept;
+
+        void
+        internal_post_events_ (void) noexcept;
+
+        static void
+        internal_deliver_events_ (void* args);
+
+        /// Queued transfers, the first one is in progress.
+        device::transfer_request* queue_head_[device::ENDPOINT_QUEUES];
+        device::transfer_request* queue_tail_[device::ENDPOINT_QUEUES];
+
         /// Pointer to static function that implements the device callback.
         device::signal_device_event_t cb_device_func_;
 
@@ -433,6 +529,20 @@ namespace os
         /// Pointer to object instance associated with the endpoint callback.
         const void* cb_endpoint_object_;
 
+        /// Events accumulated until the deferred call runs.
+        volatile event_t pending_device_events_;
+        volatile event_t pending_endpoint_events_[device::ENDPOINT_QUEUES];
+
+        /// One bit for each queue index with pending events.
+        volatile uint32_t pending_endpoints_;
+
+        /// Deliver the events from the deferred calls worker.
+        bool coalesce_device_;
+        bool coalesce_endpoint_;
+
+        static_assert(device::ENDPOINT_QUEUES <= 32,
+            "The pending mask has 32 bits");
+
       protected:
 
         device::Status status_;
@@ -200,6 +200,92 @@ namespace os
         typedef void
         (*signal_pipe_event_t) (const void* object, pipe_t pipe, event_t event);
 
+        // ==================================================================
+        // ----- USB Host Packet Information -----
+
+        // For compatibility with ARM CMSIS, the values should be
+        // exactly these.
+
+        constexpr uint32_t PACKET_TOKEN_Pos = 0;
+        constexpr uint32_t PACKET_TOKEN_Msk = (0x0FUL << PACKET_TOKEN_Pos);
+
+        ///< SETUP Packet
+        constexpr uint32_t PACKET_SETUP = (0x01UL << PACKET_TOKEN_Pos);
+
+        ///< OUT Packet
+        constexpr uint32_t PACKET_OUT = (0x02UL << PACKET_TOKEN_Pos);
+
+        ///< IN Packet
+        constexpr uint32_t PACKET_IN = (0x03UL << PACKET_TOKEN_Pos);
+
+        ///< PING Packet
+        constexpr uint32_t PACKET_PING = (0x04UL << PACKET_TOKEN_Pos);
+
+        constexpr uint32_t PACKET_DATA_Pos = 4;
+        constexpr uint32_t PACKET_DATA_Msk = (0x0FUL << PACKET_DATA_Pos);
+
+        ///< DATA0 PID
+        constexpr uint32_t PACKET_DATA0 = (0x01UL << PACKET_DATA_Pos);
+
+        ///< DATA1 PID
+        constexpr uint32_t PACKET_DATA1 = (0x02UL << PACKET_DATA_Pos);
+
+        // ==================================================================
+        // ----- USB Host Queued Transfers -----
+
+        struct transfer_request;
+
+        typedef void
+        (*signal_transfer_complete_t) (const void* object,
+                                       transfer_request* request);
+
+        ///< Number of pipes that can have queued transfers at the same time.
+        constexpr std::size_t PIPE_QUEUES = 8;
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+        /**
+         * @brief Transfer queued with Host::submit_transfer().
+         *
+         * @details
+         * From submit until the completion callback, the request and
+         * its buffer belong to the driver; the callback hands both back,
+         * with the actual count, the status and the pipe event. Requests
+         * can be chained with `next` and submitted at once.
+         */
+        struct transfer_request
+        {
+          ///< Next request in the chain or queue.
+          transfer_request* next;
+
+          ///< Packet information (PACKET_xxx).
+          uint32_t packet;
+
+          ///< Buffer to read into or write from.
+          uint8_t* data;
+
+          ///< Number of bytes to transfer.
+          std::size_t num;
+
+          ///< Number of bytes transferred, set at completion.
+          std::size_t count;
+
+          ///< RETURN_OK, or the error, set at completion.
+          return_t status;
+
+          ///< The pipe event that completed the request, or 0.
+          event_t event;
+
+          ///< Called at completion, usually in an interrupt context.
+          signal_transfer_complete_t cb_func;
+
+          ///< Object passed to the callback.
+          const void* cb_object;
+        };
+
+#pragma GCC diagnostic pop
+
       } /* namespace host */
 
       // ====================================================================
@@ -292,6 +378,16 @@ namespace os
         return_t
         abort_transfer (pipe_t pipe) noexcept;
 
+        // Queue a chain of requests on the pipe; several can be
+        // in flight, the driver is fed from the pipe interrupt.
+        return_t
+        submit_transfer (pipe_t pipe, host::transfer_request* request)
+            noexcept;
+
+        // Complete all queued requests with ERROR.
+        return_t
+        abort_transfers (pipe_t pipe) noexcept;
+
         uint16_t
         get_frame_number (void) noexcept;
 
@@ -355,6 +451,22 @@ namespace os
 
       private:
 
+        std::size_t
+        find_queue (pipe_t pipe) const noexcept;
+
+        bool
+        complete_queued_transfer (pipe_t pipe, event_t event) noexcept;
+
+        void
+        complete_requests (host::transfer_request* list, return_t status,
+                           event_t event) noexcept;
+
+        /// Pipes with queued transfers (0 for free slots); the first
+        /// request of each queue is in progress.
+        pipe_t queue_pipe_[host::PIPE_QUEUES];
+        host::transfer_request* queue_head_[host::PIPE_QUEUES];
+        host::transfer_request* queue_tail_[host::PIPE_QUEUES];
+
         /// Pointer to static function that implements the port callback.
         host::signal_port_event_t cb_port_func_;
 
@@ -158,6 +158,48 @@ private:
 
 public:
 
+  /**
+   * @brief Scoped attributes for the new threads.
+   *
+   * @details
+   * A µOS++ extension; while an instance exists, the threads
+   * created by the same thread use its attributes, for example
+   * a stack size and a stack pool (`th_stack_pool`), instead
+   * of the defaults. The instances can be nested; the attributes
+   * must live as long as the instance.
+   */
+  class scoped_attributes
+  {
+  public:
+
+    explicit
+    scoped_attributes (const os::rtos::thread::attributes& attr) noexcept;
+
+    ~scoped_attributes () noexcept;
+
+    scoped_attributes (const scoped_attributes&) = delete;
+    scoped_attributes&
+    operator= (const scoped_attributes&) = delete;
+
+    /**
+     * @brief Get the attributes for the threads created by the
+     *  current thread.
+     * @return The attributes of the innermost instance of the
+     *  current thread, or the default attributes.
+     */
+    static const os::rtos::thread::attributes&
+    current (void) noexcept;
+
+  private:
+
+    const os::rtos::thread::attributes& attr_;
+    os::rtos::thread* owner_;
+    scoped_attributes* previous_;
+
+    // All instances, of all threads, with the most recent first.
+    static scoped_attributes* top_;
+  };
+
 };
 
 // Enforce the copyable requirement.
@@ -376,7 +418,8 @@ template<typename Callable_T, typename ... Args_T>
       { new os::rtos::thread (
           reinterpret_cast<os::rtos::thread::func_t> (&run_function_object<
               Function_object> ),
-          reinterpret_cast<os::rtos::thread::func_args_t> (funct_obj)) };
+          reinterpret_cast<os::rtos::thread::func_args_t> (funct_obj),
+          scoped_attributes::current ()) };
 
     // The deleter, to be used during destruction.
     function_object_deleter_ =
@@ -463,6 +506,18 @@ namespace this_thread
 
       if (rel_time > duration<Rep_T, Period_T>::zero ())
         {
+#if defined(OS_USE_RTOS_HIGHRES_COMPARE_MATCH)
+          // Shorter than a tick, use the precise hrclock sleep.
+          if (std::is_same<clock, os::estd::chrono::systick_clock>::value
+              && rel_time < typename clock::duration (1))
+            {
+              os::estd::chrono::high_resolution_clock::sleep_for (
+                  static_cast<uint64_t> (os::estd::chrono::ceil<nanoseconds> (
+                      rel_time).count ()));
+              return;
+            }
+#endif /* defined(OS_USE_RTOS_HIGHRES_COMPARE_MATCH) */
+
           sleep_rep d = static_cast<sleep_rep> (os::estd::chrono::ceil<
               typename clock::duration> (rel_time).count ());
 
@@ -214,15 +214,41 @@ extern "C"
   typedef os_mempool_t osPool;
   typedef os_mempool_attr_t osPoolAttr;
 
-  typedef os_mqueue_t osMessageQ;
-  typedef os_mqueue_attr_t osMessageQAttr;
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+  /*
+   * Legacy message queues pass only one word, in FIFO order, thus
+   * a specialised queue is used, without the priority lists and the
+   * copies of the generic message queues.
+   */
+  typedef struct os_message_queue_s
+  {
+    os_internal_threads_waiting_list_t put_list;
+    os_internal_threads_waiting_list_t get_list;
+    const char* name;
+    uintptr_t* buffer;
+    size_t items;
+    size_t head;
+    size_t count;
+  } os_message_queue_t;
 
+  /*
+   * The mail queue combines the pool with a queue of pointers
+   * to the pool blocks; since there are no more mails than blocks,
+   * putting a mail never waits.
+   */
   typedef struct os_mail_queue_s
   {
     os_mempool_t pool;
-    os_mqueue_t queue;
+    os_message_queue_t queue;
   } os_mail_queue_t;
 
+#pragma GCC diagnostic pop
+
+  typedef os_message_queue_t osMessageQ;
+  typedef os_mqueue_attr_t osMessageQAttr;
+
   typedef os_mail_queue_t osMailQ;
 
   /**
@@ -1077,7 +1103,7 @@ struct { \
 const osMessageQDef_t os_messageQ_def_##name = { \
     #name, \
     (items), \
-    sizeof (void*), \
+    sizeof (uintptr_t), \
     0, \
     0, \
     &os_messageQ_##name.data \
@@ -1086,15 +1112,13 @@ const osMessageQDef_t os_messageQ_def_##name = { \
 struct { \
     osMessageQ data; \
     struct { \
-      void* queue[items]; \
-      os_mqueue_index_t links[2 * items]; \
-      os_mqueue_prio_t prios[items]; \
+      uintptr_t queue[items]; \
     } storage; \
 } os_messageQ_##name; \
 const osMessageQDef_t os_messageQ_def_##name = { \
     #name, \
     (items), \
-    sizeof (void*), \
+    sizeof (uintptr_t), \
     &os_messageQ_##name.storage, \
     sizeof(os_messageQ_##name.storage), \
     &os_messageQ_##name.data \
@@ -1188,16 +1212,14 @@ struct { \
       type pool[items]; \
     } pool_storage; \
     struct { \
-      void* queue[items]; \
-      os_mqueue_index_t links[2 * items]; \
-      os_mqueue_prio_t prios[items]; \
+      uintptr_t queue[items]; \
     } queue_storage; \
 } os_mailQ_##name; \
 const osMailQDef_t os_mailQ_def_##name = { \
     #name, \
     (items), \
     sizeof (type), \
-    sizeof (void*), \
+    sizeof (uintptr_t), \
     0, \
     0, \
     0, \
@@ -1211,16 +1233,14 @@ struct { \
       type pool[items]; \
     } pool_storage; \
     struct { \
-      void* queue[items]; \
-      os_mqueue_index_t links[2 * items]; \
-      os_mqueue_prio_t prios[items]; \
+      uintptr_t queue[items]; \
     } queue_storage; \
 } os_mailQ_##name; \
 const osMailQDef_t os_mailQ_def_##name = { \
     #name, \
     (items), \
     sizeof (type), \
-    sizeof (void*), \
+    sizeof (uintptr_t), \
     &os_mailQ_##name.pool_storage, \
     sizeof(os_mailQ_##name.pool_storage), \
     &os_mailQ_##name.queue_storage, \
@@ -58,6 +58,12 @@ namespace os
      * The only drawback is that the maximum number of objects must be
      * known before the first allocations, but usually this is
      * not a problem.
+     *
+     * The free blocks are kept in a lock-free list, so
+     * `allocate()` and `deallocate()` need no lock, and can be
+     * invoked from interrupts of any priority, for example to
+     * get DMA buffers; only the statistics are not updated
+     * atomically.
      */
     class block_pool : public rtos::memory::memory_resource
     {
@@ -195,6 +201,20 @@ namespace os
       virtual void
       do_reset (void) noexcept override;
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY)
+
+      /**
+       * @brief Implementation of the function to get the largest
+       *  free chunk.
+       * @par Parameters
+       *  None.
+       * @return Number of bytes.
+       */
+      virtual std::size_t
+      do_largest_free_chunk (void) const noexcept override;
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY) */
+
       /**
        * @}
        */
@@ -212,9 +232,9 @@ namespace os
       void* pool_addr_ = nullptr;
 
       /**
-       * @brief Pointer to the first free block, or nullptr.
+       * @brief The list of free blocks.
        */
-      void* volatile first_ = nullptr;
+      rtos::internal::lock_free_block_list free_list_;
 
       /**
        * @brief The number of blocks in the pool.
@@ -187,6 +187,16 @@ namespace os
       void*
       internal_align_ (chunk_t* chunk, std::size_t bytes, std::size_t alignment);
 
+      /**
+       * @brief Internal function to find a chunk for an over-aligned block.
+       * @param [in] bytes Bytes to allocate.
+       * @param [in] alignment Power of two, larger than `max_align`.
+       * @return Pointer to chunk, already removed from the free list,
+       *  or `nullptr`.
+       */
+      chunk_t*
+      internal_find_aligned_ (std::size_t bytes, std::size_t alignment);
+
       /**
        * @brief Implementation of the memory allocator.
        * @param [in] bytes Number of bytes to allocate.
@@ -196,6 +206,15 @@ namespace os
       virtual void*
       do_allocate (std::size_t bytes, std::size_t alignment) override;
 
+      /**
+       * @brief Implementation of the zeroed memory allocator.
+       * @param [in] bytes Number of bytes to allocate.
+       * @param [in] alignment Alignment constraint (power of 2).
+       * @return Pointer to newly allocated block, or `nullptr`.
+       */
+      virtual void*
+      do_allocate_zeroed (std::size_t bytes, std::size_t alignment) override;
+
       /**
        * @brief Implementation of the memory deallocator.
        * @param [in] addr Address of a previously allocated block to free.
@@ -208,6 +227,18 @@ namespace os
       do_deallocate (void* addr, std::size_t bytes, std::size_t alignment)
           noexcept override;
 
+      /**
+       * @brief Implementation of the memory reallocator.
+       * @param [in] addr Address of the block to resize.
+       * @param [in] old_bytes Current size of the block (may be 0 if unknown).
+       * @param [in] new_bytes Number of bytes required.
+       * @param [in] alignment Alignment constraint (power of 2).
+       * @return Pointer to the resized block, or `nullptr`.
+       */
+      virtual void*
+      do_reallocate (void* addr, std::size_t old_bytes, std::size_t new_bytes,
+                     std::size_t alignment) override;
+
       /**
        * @brief Implementation of the function to get max size.
        * @par Parameters
@@ -217,6 +248,15 @@ namespace os
       virtual std::size_t
       do_max_size (void) const noexcept override;
 
+      /**
+       * @brief Implementation of the function to fill free memory
+       *  with zeros.
+       * @param [in] bytes Maximum number of bytes to fill.
+       * @return Number of bytes filled.
+       */
+      virtual std::size_t
+      do_zero_free (std::size_t bytes) noexcept override;
+
       /**
        * @brief Implementation of the function to reset the memory manager.
        * @par Parameters
@@ -227,6 +267,20 @@ namespace os
       virtual void
       do_reset (void) noexcept override;
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY)
+
+      /**
+       * @brief Implementation of the function to get the largest
+       *  free chunk.
+       * @par Parameters
+       *  None.
+       * @return Number of bytes.
+       */
+      virtual std::size_t
+      do_largest_free_chunk (void) const noexcept override;
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY) */
+
       /**
        * @}
        */
@@ -263,6 +317,15 @@ namespace os
 
       chunk_t* free_list_ = nullptr;
 
+      // The memory between the first chunk header and this address
+      // is known to be zero; it is extended by do_zero_free()
+      // and lowered by allocations.
+      char* zero_end_ = nullptr;
+
+      // True if the payload of the last allocated chunk was
+      // entirely in the zero area.
+      bool last_zeroed_ = false;
+
       /**
        * @endcond
        */
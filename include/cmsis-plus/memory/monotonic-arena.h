@@ -0,0 +1,497 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_MEMORY_MONOTONIC_ARENA_H_
+#define CMSIS_PLUS_MEMORY_MONOTONIC_ARENA_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#include <cmsis-plus/rtos/os.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace memory
+  {
+
+    // ========================================================================
+
+    /**
+     * @brief Memory resource implementing a monotonic
+     *  allocation policy, with bulk release.
+     * @ingroup cmsis-plus-rtos-memres
+     * @headerfile monotonic-arena.h <cmsis-plus/memory/monotonic-arena.h>
+     *
+     * @details
+     * Blocks are allocated by advancing a pointer in the current
+     * buffer; there is no per-block header and deallocation does
+     * nothing. When the current buffer is exhausted, a new one is
+     * obtained from the upstream memory resource, at least twice as
+     * large as the previous one, and chained to the list of buffers.
+     *
+     * All memory is reclaimed at once by `release()`, which returns
+     * the chained buffers to the upstream resource and restarts from
+     * the initial buffer.
+     *
+     * This memory manager is ideal for scratch memory used while
+     * processing a request, when many short lived objects are
+     * created and all are discarded at the end; it is similar to the
+     * C++17 `std::pmr::monotonic_buffer_resource`.
+     *
+     * @note The class is not thread safe; when shared between
+     *  threads, use it via the synchronised allocators.
+     */
+    class monotonic_arena : public rtos::memory::memory_resource
+    {
+    public:
+
+      /**
+       * @brief The smallest buffer requested from the upstream resource.
+       */
+      static constexpr std::size_t min_buffer_bytes = 256;
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+      /**
+       * @brief Construct a memory resource object instance.
+       * @param [in] addr Begin of the initial buffer, or `nullptr`.
+       * @param [in] bytes Size of the initial buffer, in bytes.
+       * @param [in] upstream Pointer to the memory resource used
+       *  to get more buffers. Default the RTOS system memory manager.
+       */
+      monotonic_arena (void* addr, std::size_t bytes,
+                       rtos::memory::memory_resource* upstream =
+                           rtos::memory::get_default_resource ());
+
+      /**
+       * @brief Construct a named memory resource object instance.
+       * @param [in] name Pointer to name.
+       * @param [in] addr Begin of the initial buffer, or `nullptr`.
+       * @param [in] bytes Size of the initial buffer, in bytes.
+       * @param [in] upstream Pointer to the memory resource used
+       *  to get more buffers. Default the RTOS system memory manager.
+       */
+      monotonic_arena (const char* name, void* addr, std::size_t bytes,
+                       rtos::memory::memory_resource* upstream =
+                           rtos::memory::get_default_resource ());
+
+    protected:
+
+      /**
+       * @brief Construct a named memory resource object instance.
+       * @param [in] name
+       */
+      monotonic_arena (const char* name);
+
+    public:
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      monotonic_arena (const monotonic_arena&) = delete;
+      monotonic_arena (monotonic_arena&&) = delete;
+      monotonic_arena&
+      operator= (const monotonic_arena&) = delete;
+      monotonic_arena&
+      operator= (monotonic_arena&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @brief Destruct the memory resource object instance.
+       */
+      virtual
+      ~monotonic_arena () override;
+
+      /**
+       * @}
+       */
+
+    public:
+
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+      /**
+       * @brief Release all allocated memory at once.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      release (void) noexcept;
+
+      /**
+       * @brief Get the upstream memory resource.
+       * @par Parameters
+       *  None.
+       * @return Pointer to memory resource.
+       */
+      rtos::memory::memory_resource*
+      upstream_resource (void) const noexcept;
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+      // A 'buffer' is a block obtained from the upstream resource;
+      // it starts with this header, followed by the allocated blocks.
+      typedef struct buffer_s
+      {
+        // The next (older) buffer, or nullptr.
+        struct buffer_s* next;
+
+        // The size of the buffer, as requested from upstream,
+        // including this header.
+        std::size_t bytes;
+      } buffer_t;
+
+#pragma GCC diagnostic pop
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @name Private Member Functions
+       * @{
+       */
+
+      /**
+       * @brief Internal function to construct the memory resource.
+       * @param [in] addr Begin of the initial buffer.
+       * @param [in] bytes Size of the initial buffer, in bytes.
+       * @param [in] upstream Pointer to upstream memory resource.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_construct_ (void* addr, std::size_t bytes,
+                           rtos::memory::memory_resource* upstream);
+
+      /**
+       * @brief Internal function to get a new buffer from upstream.
+       * @param [in] bytes Bytes to allocate.
+       * @param [in] alignment Power of two.
+       * @retval true The new buffer is the current one.
+       * @retval false The upstream resource failed.
+       */
+      bool
+      internal_grow_ (std::size_t bytes, std::size_t alignment);
+
+      /**
+       * @brief Implementation of the memory allocator.
+       * @param [in] bytes Number of bytes to allocate.
+       * @param [in] alignment Alignment constraint (power of 2).
+       * @return Pointer to newly allocated block, or `nullptr`.
+       */
+      virtual void*
+      do_allocate (std::size_t bytes, std::size_t alignment) override;
+
+      /**
+       * @brief Implementation of the memory deallocator.
+       * @param [in] addr Address of a previously allocated block to free.
+       * @param [in] bytes Number of bytes to deallocate (may be 0 if unknown).
+       * @param [in] alignment Alignment constraint (power of 2).
+       * @par Returns
+       *  Nothing.
+       */
+      virtual void
+      do_deallocate (void* addr, std::size_t bytes, std::size_t alignment)
+          noexcept override;
+
+      /**
+       * @brief Implementation of the function to get max size.
+       * @par Parameters
+       *  None.
+       * @return Integer with size in bytes, or 0 if unknown.
+       */
+      virtual std::size_t
+      do_max_size (void) const noexcept override;
+
+      /**
+       * @brief Implementation of the function to reset the memory manager.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      virtual void
+      do_reset (void) noexcept override;
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY)
+
+      /**
+       * @brief Implementation of the function to get the largest
+       *  free chunk.
+       * @par Parameters
+       *  None.
+       * @return Number of bytes.
+       */
+      virtual std::size_t
+      do_largest_free_chunk (void) const noexcept override;
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY) */
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      void* initial_addr_ = nullptr;
+      std::size_t initial_bytes_ = 0;
+
+      rtos::memory::memory_resource* upstream_ = nullptr;
+
+      // The list of buffers obtained from upstream, newest first.
+      buffer_t* buffers_ = nullptr;
+
+      // The first free byte in the current buffer and the
+      // number of bytes up to its end.
+      char* current_ = nullptr;
+      std::size_t remaining_ = 0;
+
+      // The size of the next buffer requested from upstream.
+      std::size_t next_bytes_ = 0;
+
+      /**
+       * @endcond
+       */
+
+    };
+
+    // ========================================================================
+
+    /**
+     * @brief Memory resource implementing a monotonic
+     *  allocation policy, using an internal initial buffer.
+     * @ingroup cmsis-plus-rtos-memres
+     * @headerfile monotonic-arena.h <cmsis-plus/memory/monotonic-arena.h>
+     *
+     * @details
+     * This class template is a convenience class that includes
+     * an array of chars to be used as the initial buffer.
+     *
+     * The common use case it to define statically allocated memory
+     * managers, sized for the usual requests, and let the rare large
+     * ones get extra buffers from upstream.
+     */
+    template<std::size_t N>
+      class monotonic_arena_inclusive : public monotonic_arena
+      {
+      public:
+
+        /**
+         * @brief Local constant based on template definition.
+         */
+        static const std::size_t bytes = N;
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a memory resource object instance.
+         * @param [in] upstream Pointer to the memory resource used
+         *  to get more buffers. Default the RTOS system memory manager.
+         */
+        monotonic_arena_inclusive (rtos::memory::memory_resource* upstream =
+                                       rtos::memory::get_default_resource ());
+
+        /**
+         * @brief Construct a named memory resource object instance.
+         * @param [in] name Pointer to name.
+         * @param [in] upstream Pointer to the memory resource used
+         *  to get more buffers. Default the RTOS system memory manager.
+         */
+        monotonic_arena_inclusive (const char* name,
+                                   rtos::memory::memory_resource* upstream =
+                                       rtos::memory::get_default_resource ());
+
+      public:
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        monotonic_arena_inclusive (const monotonic_arena_inclusive&) = delete;
+        monotonic_arena_inclusive (monotonic_arena_inclusive&&) = delete;
+        monotonic_arena_inclusive&
+        operator= (const monotonic_arena_inclusive&) = delete;
+        monotonic_arena_inclusive&
+        operator= (monotonic_arena_inclusive&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the memory resource object instance.
+         */
+        virtual
+        ~monotonic_arena_inclusive ();
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        /**
+         * @brief The initial buffer is an array of bytes.
+         */
+        char arena_[bytes];
+
+        /**
+         * @endcond
+         */
+
+      };
+
+  // --------------------------------------------------------------------------
+  } /* namespace memory */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace memory
+  {
+
+    // ========================================================================
+
+    inline
+    monotonic_arena::monotonic_arena (const char* name) :
+        rtos::memory::memory_resource
+          { name }
+    {
+      ;
+    }
+
+    inline
+    monotonic_arena::monotonic_arena (void* addr, std::size_t bytes,
+                                      rtos::memory::memory_resource* upstream) :
+        monotonic_arena
+          { nullptr, addr, bytes, upstream }
+    {
+      ;
+    }
+
+    inline
+    monotonic_arena::monotonic_arena (const char* name, void* addr,
+                                      std::size_t bytes,
+                                      rtos::memory::memory_resource* upstream) :
+        rtos::memory::memory_resource
+          { name }
+    {
+      trace::printf ("%s(%p,%u,%p) @%p %s\n", __func__, addr, bytes, upstream,
+                     this, this->name ());
+
+      internal_construct_ (addr, bytes, upstream);
+    }
+
+    inline rtos::memory::memory_resource*
+    monotonic_arena::upstream_resource (void) const noexcept
+    {
+      return upstream_;
+    }
+
+    // ========================================================================
+
+    template<std::size_t N>
+      inline
+      monotonic_arena_inclusive<N>::monotonic_arena_inclusive (
+          rtos::memory::memory_resource* upstream) :
+          monotonic_arena_inclusive (nullptr, upstream)
+      {
+        ;
+      }
+
+    template<std::size_t N>
+      inline
+      monotonic_arena_inclusive<N>::monotonic_arena_inclusive (
+          const char* name, rtos::memory::memory_resource* upstream) :
+          monotonic_arena
+            { name }
+      {
+        trace::printf ("%s(%p) @%p %s\n", __func__, upstream, this,
+                       this->name ());
+
+        internal_construct_ (&arena_[0], bytes, upstream);
+      }
+
+    template<std::size_t N>
+      monotonic_arena_inclusive<N>::~monotonic_arena_inclusive ()
+      {
+        trace::printf ("%s() @%p %s\n", __func__, this, this->name ());
+      }
+
+  // --------------------------------------------------------------------------
+
+  } /* namespace memory */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_MEMORY_MONOTONIC_ARENA_H_ */
@@ -0,0 +1,665 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_MEMORY_MULTI_REGION_H_
+#define CMSIS_PLUS_MEMORY_MULTI_REGION_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#include <cmsis-plus/rtos/os.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace memory
+  {
+
+    // ========================================================================
+
+    /**
+     * @brief Memory resource routing allocations to several
+     *  memory regions.
+     * @ingroup cmsis-plus-rtos-memres
+     * @headerfile multi-region.h <cmsis-plus/memory/multi-region.h>
+     *
+     * @details
+     * Each region is a separate memory area, like the tightly coupled
+     * memory, the internal SRAM or the external SDRAM, managed by its
+     * own memory resource (the backend). The regions are defined by
+     * an array provided by the application, in the order of
+     * preference.
+     *
+     * Allocations carry a placement hint, a bit mask of the
+     * classes of memory acceptable; the block is allocated from
+     * the first region serving one of these classes, and not limited
+     * to smaller blocks, which has free space. If none is found, and
+     * the hint is not `strict`, all other regions are tried, in order
+     * (the fallback chain).
+     *
+     * Plain `allocate()` calls use the default hint, so by limiting
+     * the block size served by the fast regions, large buffers go to
+     * the large regions. To route by hint the allocations done via
+     * the standard mechanisms, use `placement_resource` views,
+     * for example as the RTOS system resource, to have the thread
+     * stacks and the system objects in TCM.
+     *
+     * Deallocations are routed by address.
+     *
+     * The backends should have no out of memory handler, since a
+     * failure in one region is not final; the handler of this
+     * object is called when all regions failed.
+     *
+     * @note The class is not thread safe, use it with the same
+     *  locks as any other memory resource.
+     */
+    class multi_region : public rtos::memory::memory_resource
+    {
+    public:
+
+      /**
+       * @brief Type of variables holding placement hints.
+       */
+      using hint_t = uint32_t;
+
+      /**
+       * @brief Placement hints.
+       * @details
+       * The application may use any other bits, except the
+       * most significant one.
+       */
+      struct hint
+      {
+        enum
+          : hint_t
+            {
+              /**
+               * Fast memory, like the tightly coupled memory.
+               */
+              fast = 1u << 0,
+
+              /**
+               * Normal memory, like the internal SRAM.
+               */
+              normal = 1u << 1,
+
+              /**
+               * Large and slow memory, like the external SDRAM.
+               */
+              bulk = 1u << 2,
+
+              /**
+               * Any memory.
+               */
+              any = 0x7FFFFFFFu,
+
+              /**
+               * Do not fall back to unmatched regions.
+               */
+              strict = 0x80000000u
+        };
+      }; /* struct hint */
+
+      /**
+       * @brief Memory region definition.
+       */
+      typedef struct region_s
+      {
+        /**
+         * @brief Pointer to the memory resource managing the region.
+         */
+        rtos::memory::memory_resource* resource;
+
+        /**
+         * @brief Begin of the region, used to route deallocations.
+         */
+        void* addr;
+
+        /**
+         * @brief Size of the region, in bytes.
+         */
+        std::size_t bytes;
+
+        /**
+         * @brief Mask of placement hints served by this region.
+         */
+        hint_t hints;
+
+        /**
+         * @brief Largest block allocated when matching the hint,
+         *  or 0 for no limit.
+         */
+        std::size_t max_block_bytes;
+
+        /**
+         * @brief Number of allocations served as a fallback.
+         */
+        std::size_t fallbacks;
+
+        /**
+         * @brief Number of allocations that failed in this region.
+         */
+        std::size_t failures;
+
+      } region_t;
+
+      /**
+       * @brief A memory resource allocating with a placement hint.
+       * @headerfile multi-region.h <cmsis-plus/memory/multi-region.h>
+       *
+       * @details
+       * All requests are forwarded to the `multi_region` object,
+       * with the given placement hint.
+       */
+      class placement_resource : public rtos::memory::memory_resource
+      {
+      public:
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a memory resource object instance.
+         * @param [in] owner Reference to the multi region resource.
+         * @param [in] hint The placement hint.
+         */
+        placement_resource (multi_region& owner, hint_t hint);
+
+        /**
+         * @brief Construct a named memory resource object instance.
+         * @param [in] name Pointer to name.
+         * @param [in] owner Reference to the multi region resource.
+         * @param [in] hint The placement hint.
+         */
+        placement_resource (const char* name, multi_region& owner,
+                            hint_t hint);
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        placement_resource (const placement_resource&) = delete;
+        placement_resource (placement_resource&&) = delete;
+        placement_resource&
+        operator= (const placement_resource&) = delete;
+        placement_resource&
+        operator= (placement_resource&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the memory resource object instance.
+         */
+        virtual
+        ~placement_resource () override;
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @name Private Member Functions
+         * @{
+         */
+
+        /**
+         * @brief Implementation of the memory allocator.
+         * @param [in] bytes Number of bytes to allocate.
+         * @param [in] alignment Alignment constraint (power of 2).
+         * @return Pointer to newly allocated block, or `nullptr`.
+         */
+        virtual void*
+        do_allocate (std::size_t bytes, std::size_t alignment) override;
+
+        /**
+         * @brief Implementation of the memory deallocator.
+         * @param [in] addr Address of a previously allocated block to free.
+         * @param [in] bytes Number of bytes to deallocate (may be 0 if unknown).
+         * @param [in] alignment Alignment constraint (power of 2).
+         * @par Returns
+         *  Nothing.
+         */
+        virtual void
+        do_deallocate (void* addr, std::size_t bytes, std::size_t alignment)
+            noexcept override;
+
+        /**
+         * @brief Implementation of the memory reallocator.
+         * @param [in] addr Address of the block to resize.
+         * @param [in] old_bytes Current size of the block (may be 0 if unknown).
+         * @param [in] new_bytes Number of bytes required.
+         * @param [in] alignment Alignment constraint (power of 2).
+         * @return Pointer to the resized block, or `nullptr`.
+         */
+        virtual void*
+        do_reallocate (void* addr, std::size_t old_bytes,
+                       std::size_t new_bytes, std::size_t alignment) override;
+
+        /**
+         * @brief Implementation of the function to get max size.
+         * @par Parameters
+         *  None.
+         * @return Integer with size in bytes, or 0 if unknown.
+         */
+        virtual std::size_t
+        do_max_size (void) const noexcept override;
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        multi_region& owner_;
+        hint_t hint_;
+
+        /**
+         * @endcond
+         */
+      };
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+      /**
+       * @brief Construct a memory resource object instance.
+       * @param [in] regions Pointer to array of regions.
+       * @param [in] count Number of regions.
+       * @param [in] default_hint Hint used by `allocate()`.
+       */
+      multi_region (region_t* regions, std::size_t count,
+                    hint_t default_hint = hint::any);
+
+      /**
+       * @brief Construct a named memory resource object instance.
+       * @param [in] name Pointer to name.
+       * @param [in] regions Pointer to array of regions.
+       * @param [in] count Number of regions.
+       * @param [in] default_hint Hint used by `allocate()`.
+       */
+      multi_region (const char* name, region_t* regions, std::size_t count,
+                    hint_t default_hint = hint::any);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      multi_region (const multi_region&) = delete;
+      multi_region (multi_region&&) = delete;
+      multi_region&
+      operator= (const multi_region&) = delete;
+      multi_region&
+      operator= (multi_region&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @brief Destruct the memory resource object instance.
+       */
+      virtual
+      ~multi_region () override;
+
+      /**
+       * @}
+       */
+
+    public:
+
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+      /**
+       * @brief Allocate a memory block with a placement hint.
+       * @param [in] bytes Number of bytes to allocate.
+       * @param [in] placement The placement hint.
+       * @param [in] alignment Alignment constraint (power of 2).
+       * @return Pointer to newly allocated block, or `nullptr`.
+       */
+      void*
+      allocate_placed (std::size_t bytes, hint_t placement,
+                       std::size_t alignment = max_align);
+
+      /**
+       * @brief Get the number of regions.
+       * @par Parameters
+       *  None.
+       * @return Number of regions.
+       */
+      std::size_t
+      regions (void) const noexcept;
+
+      /**
+       * @brief Get a region definition.
+       * @param [in] index Index of the region.
+       * @return Reference to region, with the statistics.
+       */
+      const region_t&
+      region (std::size_t index) const noexcept;
+
+      /**
+       * @brief Find the region containing an address.
+       * @param [in] addr Address.
+       * @return Pointer to region, or `nullptr`.
+       */
+      region_t*
+      find_region (const void* addr) const noexcept;
+
+      /**
+       * @brief Print the usage statistics of all regions.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      trace_print_regions (void);
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @name Private Member Functions
+       * @{
+       */
+
+      /**
+       * @brief Internal function to allocate from the regions.
+       * @param [in] bytes Number of bytes to allocate.
+       * @param [in] alignment Alignment constraint (power of 2).
+       * @param [in] placement The placement hint.
+       * @param [in] zeroed True if the block must be zero.
+       * @return Pointer to newly allocated block, or `nullptr`.
+       */
+      void*
+      internal_allocate_ (std::size_t bytes, std::size_t alignment,
+                          hint_t placement, bool zeroed);
+
+      /**
+       * @brief Internal function to check if a region matches a request.
+       * @param [in] region Reference to region.
+       * @param [in] bytes Number of bytes to allocate.
+       * @param [in] classes Mask of requested memory classes.
+       * @retval true The region serves the request.
+       * @retval false The region is used only as a fallback.
+       */
+      static bool
+      internal_matches_ (const region_t& region, std::size_t bytes,
+                         hint_t classes) noexcept;
+
+      /**
+       * @brief Internal function to try one region.
+       * @param [in] region Reference to region.
+       * @param [in] bytes Number of bytes to allocate.
+       * @param [in] alignment Alignment constraint (power of 2).
+       * @param [in] zeroed True if the block must be zero.
+       * @return Pointer to newly allocated block, or `nullptr`.
+       */
+      void*
+      internal_try_ (region_t& region, std::size_t bytes,
+                     std::size_t alignment, bool zeroed);
+
+      /**
+       * @brief Internal function to add the statistics of all regions.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_update_statistics_ (void) noexcept;
+
+      /**
+       * @brief Implementation of the memory allocator.
+       * @param [in] bytes Number of bytes to allocate.
+       * @param [in] alignment Alignment constraint (power of 2).
+       * @return Pointer to newly allocated block, or `nullptr`.
+       */
+      virtual void*
+      do_allocate (std::size_t bytes, std::size_t alignment) override;
+
+      /**
+       * @brief Implementation of the zeroed memory allocator.
+       * @param [in] bytes Number of bytes to allocate.
+       * @param [in] alignment Alignment constraint (power of 2).
+       * @return Pointer to newly allocated block, or `nullptr`.
+       */
+      virtual void*
+      do_allocate_zeroed (std::size_t bytes, std::size_t alignment) override;
+
+      /**
+       * @brief Implementation of the memory deallocator.
+       * @param [in] addr Address of a previously allocated block to free.
+       * @param [in] bytes Number of bytes to deallocate (may be 0 if unknown).
+       * @param [in] alignment Alignment constraint (power of 2).
+       * @par Returns
+       *  Nothing.
+       */
+      virtual void
+      do_deallocate (void* addr, std::size_t bytes, std::size_t alignment)
+          noexcept override;
+
+      /**
+       * @brief Implementation of the memory reallocator.
+       * @param [in] addr Address of the block to resize.
+       * @param [in] old_bytes Current size of the block (may be 0 if unknown).
+       * @param [in] new_bytes Number of bytes required.
+       * @param [in] alignment Alignment constraint (power of 2).
+       * @return Pointer to the resized block, or `nullptr`.
+       */
+      virtual void*
+      do_reallocate (void* addr, std::size_t old_bytes, std::size_t new_bytes,
+                     std::size_t alignment) override;
+
+      /**
+       * @brief Implementation of the function to get max size.
+       * @par Parameters
+       *  None.
+       * @return Integer with size in bytes, or 0 if unknown.
+       */
+      virtual std::size_t
+      do_max_size (void) const noexcept override;
+
+      /**
+       * @brief Implementation of the function to fill free memory
+       *  with zeros.
+       * @param [in] bytes Maximum number of bytes to fill.
+       * @return Number of bytes filled.
+       */
+      virtual std::size_t
+      do_zero_free (std::size_t bytes) noexcept override;
+
+      /**
+       * @brief Implementation of the function to reset the memory manager.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      virtual void
+      do_reset (void) noexcept override;
+
+      /**
+       * @brief Implementation of the function to coalesce free blocks.
+       * @par Parameters
+       *  None.
+       * @retval true if the operation resulted in larger blocks.
+       * @retval false if the operation was ineffective.
+       */
+      virtual bool
+      do_coalesce (void) noexcept override;
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY)
+
+      /**
+       * @brief Implementation of the function to get the largest
+       *  free chunk.
+       * @par Parameters
+       *  None.
+       * @return Number of bytes.
+       */
+      virtual std::size_t
+      do_largest_free_chunk (void) const noexcept override;
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY) */
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      region_t* regions_ = nullptr;
+      std::size_t count_ = 0;
+
+      hint_t default_hint_ = hint::any;
+
+      /**
+       * @endcond
+       */
+
+    };
+
+  // --------------------------------------------------------------------------
+  } /* namespace memory */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace memory
+  {
+
+    // ========================================================================
+
+    inline
+    multi_region::placement_resource::placement_resource (multi_region& owner,
+                                                          hint_t hint) :
+        placement_resource
+          { nullptr, owner, hint }
+    {
+      ;
+    }
+
+    inline
+    multi_region::placement_resource::placement_resource (const char* name,
+                                                          multi_region& owner,
+                                                          hint_t hint) :
+        rtos::memory::memory_resource
+          { name }, //
+        owner_ (owner), //
+        hint_ (hint)
+    {
+      trace::printf ("%s(%p,0x%X) @%p %s\n", __func__, &owner, hint, this,
+                     this->name ());
+    }
+
+    // ========================================================================
+
+    inline
+    multi_region::multi_region (region_t* regions, std::size_t count,
+                                hint_t default_hint) :
+        multi_region
+          { nullptr, regions, count, default_hint }
+    {
+      ;
+    }
+
+    inline void*
+    multi_region::allocate_placed (std::size_t bytes, hint_t placement,
+                                   std::size_t alignment)
+    {
+      ++allocations_;
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY)
+      void* addr = internal_allocate_ (bytes, alignment, placement, false);
+      internal_record_request_ (bytes, addr);
+      return addr;
+#else
+      return internal_allocate_ (bytes, alignment, placement, false);
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY) */
+    }
+
+    inline bool
+    multi_region::internal_matches_ (const region_t& region,
+                                     std::size_t bytes,
+                                     hint_t classes) noexcept
+    {
+      return ((region.hints & classes) != 0)
+          && (region.max_block_bytes == 0 || bytes <= region.max_block_bytes);
+    }
+
+    inline std::size_t
+    multi_region::regions (void) const noexcept
+    {
+      return count_;
+    }
+
+    inline const multi_region::region_t&
+    multi_region::region (std::size_t index) const noexcept
+    {
+      assert(index < count_);
+      return regions_[index];
+    }
+
+  // --------------------------------------------------------------------------
+
+  } /* namespace memory */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_MEMORY_MULTI_REGION_H_ */
@@ -0,0 +1,669 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_MEMORY_SEGREGATED_FIT_H_
+#define CMSIS_PLUS_MEMORY_SEGREGATED_FIT_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#include <cmsis-plus/rtos/os.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace memory
+  {
+
+    // ========================================================================
+
+    /**
+     * @brief Memory resource implementing the segregated fit
+     *  allocation policy, using an existing arena.
+     * @ingroup cmsis-plus-rtos-memres
+     * @headerfile segregated-fit.h <cmsis-plus/memory/segregated-fit.h>
+     *
+     * @details
+     * The free chunks are kept in separate lists, one for each
+     * power of two size class, with a bitmap of the non-empty
+     * lists, so finding a free chunk large enough is a constant
+     * time operation, regardless of the number of free chunks.
+     *
+     * Each chunk has a header with its size and flags, and the free
+     * chunks also have a footer with the size (boundary tags),
+     * so freed chunks are immediately coalesced with their
+     * free neighbours, also in constant time.
+     */
+    class segregated_fit : public rtos::memory::memory_resource
+    {
+    public:
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+      /**
+       * @brief Construct a memory resource object instance.
+       * @param [in] addr Begin of allocator arena.
+       * @param [in] bytes Size of allocator arena, in bytes.
+       */
+      segregated_fit (void* addr, std::size_t bytes);
+
+      /**
+       * @brief Construct a named memory resource object instance.
+       * @param [in] name Pointer to name.
+       * @param [in] addr Begin of allocator arena.
+       * @param [in] bytes Size of allocator arena, in bytes.
+       */
+      segregated_fit (const char* name, void* addr, std::size_t bytes);
+
+    protected:
+
+      /**
+       * @brief Default constructor. Construct a memory resource
+       *  object instance.
+       */
+      segregated_fit () = default;
+
+      /**
+       * @brief Construct a named memory resource object instance.
+       * @param [in] name
+       */
+      segregated_fit (const char* name);
+
+    public:
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      segregated_fit (const segregated_fit&) = delete;
+      segregated_fit (segregated_fit&&) = delete;
+      segregated_fit&
+      operator= (const segregated_fit&) = delete;
+      segregated_fit&
+      operator= (segregated_fit&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @brief Destruct the memory resource object instance.
+       */
+      virtual
+      ~segregated_fit () override;
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+      // A 'chunk' is where the user block resides; it starts with
+      // a header, followed by the payload.
+      typedef struct chunk_s
+      {
+        // The chunk size, in bytes, plus the flags in the lower bits;
+        // the next chunk starts exactly after this number of bytes.
+        // This is the only overhead that applies to all allocated blocks.
+        std::size_t head;
+
+        // For allocated chunks, here, or at the next address that
+        // satisfies the required alignment, starts the payload.
+        // When the chunk is free, instead of the payload, here are
+        // the links in the size class list; the last word of a
+        // free chunk is a copy of its size (the footer).
+        struct chunk_s* next;
+        struct chunk_s* prev;
+      } chunk_t;
+
+#pragma GCC diagnostic pop
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @name Private Member Functions
+       * @{
+       */
+
+      /**
+       * @brief Internal function to construct the memory resource.
+       * @param [in] addr Begin of allocator arena.
+       * @param [in] bytes Size of allocator arena, in bytes.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_construct_ (void* addr, std::size_t bytes);
+
+      /**
+       * @brief Internal function to reset the memory resource.
+       * @par Parameters
+       *  None.
+       */
+      void
+      internal_reset_ (void) noexcept;
+
+      /**
+       * @brief Internal function to get the size class of a chunk.
+       * @param [in] size Chunk size, in bytes.
+       * @return The index of the free list.
+       */
+      static std::size_t
+      internal_class_ (std::size_t size) noexcept;
+
+      /**
+       * @brief Internal function to add a free chunk to its list.
+       * @param [in] chunk Pointer to chunk.
+       * @param [in] size Chunk size, in bytes.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_link_ (chunk_t* chunk, std::size_t size) noexcept;
+
+      /**
+       * @brief Internal function to remove a free chunk from its list.
+       * @param [in] chunk Pointer to chunk.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_unlink_ (chunk_t* chunk) noexcept;
+
+      /**
+       * @brief Internal function to find a free chunk.
+       * @param [in] size Chunk size, in bytes.
+       * @return Pointer to chunk, or `nullptr`.
+       */
+      chunk_t*
+      internal_find_ (std::size_t size) noexcept;
+
+      /**
+       * @brief Internal function to align a chunk.
+       * @param [in] chunk Pointer to chunk.
+       * @param [in] bytes Bytes to allocate.
+       * @param [in] alignment Power of two.
+       * @return Pointer to aligned payload.
+       */
+      void*
+      internal_align_ (chunk_t* chunk, std::size_t bytes, std::size_t alignment);
+
+      /**
+       * @brief Implementation of the memory allocator.
+       * @param [in] bytes Number of bytes to allocate.
+       * @param [in] alignment Alignment constraint (power of 2).
+       * @return Pointer to newly allocated block, or `nullptr`.
+       */
+      virtual void*
+      do_allocate (std::size_t bytes, std::size_t alignment) override;
+
+      /**
+       * @brief Implementation of the memory deallocator.
+       * @param [in] addr Address of a previously allocated block to free.
+       * @param [in] bytes Number of bytes to deallocate (may be 0 if unknown).
+       * @param [in] alignment Alignment constraint (power of 2).
+       * @par Returns
+       *  Nothing.
+       */
+      virtual void
+      do_deallocate (void* addr, std::size_t bytes, std::size_t alignment)
+          noexcept override;
+
+      /**
+       * @brief Implementation of the function to get max size.
+       * @par Parameters
+       *  None.
+       * @return Integer with size in bytes, or 0 if unknown.
+       */
+      virtual std::size_t
+      do_max_size (void) const noexcept override;
+
+      /**
+       * @brief Implementation of the function to coalesce free blocks.
+       * @par Parameters
+       *  None.
+       * @retval true if the operation resulted in larger blocks.
+       * @retval false if the operation was ineffective.
+       */
+      virtual bool
+      do_coalesce (void) noexcept override;
+
+      /**
+       * @brief Implementation of the function to reset the memory manager.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      virtual void
+      do_reset (void) noexcept override;
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY)
+
+      /**
+       * @brief Implementation of the function to get the largest
+       *  free chunk.
+       * @par Parameters
+       *  None.
+       * @return Number of bytes.
+       */
+      virtual std::size_t
+      do_largest_free_chunk (void) const noexcept override;
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY) */
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      // Offset of payload inside the chunk.
+      static constexpr std::size_t chunk_offset = offsetof(chunk_t, next);
+      static constexpr std::size_t chunk_align = sizeof(void*);
+      // Room for the header, the two links and the footer.
+      static constexpr std::size_t chunk_minsize = sizeof(chunk_t)
+          + sizeof(std::size_t);
+
+      // Flags in the chunk header.
+      static constexpr std::size_t chunk_used = 1;
+      static constexpr std::size_t chunk_prev_used = 2;
+      static constexpr std::size_t chunk_flags = chunk_used | chunk_prev_used;
+
+      // One class for each bit of the chunk size.
+      static constexpr std::size_t classes = sizeof(std::size_t) * 8;
+
+      // Extra padding from chunk to block.
+      static constexpr std::size_t
+      calc_block_padding (std::size_t block_align)
+      {
+        return os::rtos::memory::max (block_align, chunk_align) - chunk_align;
+      }
+
+      void* arena_addr_ = nullptr;
+      // No need for arena_size_bytes_, use total_bytes_.
+
+      // One bit for each non-empty free list.
+      std::size_t bitmap_ = 0;
+
+      // The free lists, one for each size class.
+      chunk_t* free_lists_[classes];
+
+      /**
+       * @endcond
+       */
+
+    };
+
+    // ========================================================================
+
+    /**
+     * @brief Memory resource implementing the segregated fit
+     *  allocation policy, using an internal arena.
+     * @ingroup cmsis-plus-rtos-memres
+     * @headerfile segregated-fit.h <cmsis-plus/memory/segregated-fit.h>
+     *
+     * @details
+     * This class template is a convenience class that includes
+     * an array of chars to be used as the allocation arena.
+     *
+     * The common use case it to define statically allocated memory managers.
+     */
+    template<std::size_t N>
+      class segregated_fit_inclusive : public segregated_fit
+      {
+      public:
+
+        /**
+         * @brief Local constant based on template definition.
+         */
+        static const std::size_t bytes = N;
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a memory resource object instance.
+         * @par Parameters
+         *  None.
+         */
+        segregated_fit_inclusive (void);
+
+        /**
+         * @brief Construct a named memory resource object instance.
+         * @param [in] name Pointer to name.
+         */
+        segregated_fit_inclusive (const char* name);
+
+      public:
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        segregated_fit_inclusive (const segregated_fit_inclusive&) = delete;
+        segregated_fit_inclusive (segregated_fit_inclusive&&) = delete;
+        segregated_fit_inclusive&
+        operator= (const segregated_fit_inclusive&) = delete;
+        segregated_fit_inclusive&
+        operator= (segregated_fit_inclusive&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the memory resource object instance.
+         */
+        virtual
+        ~segregated_fit_inclusive ();
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        /**
+         * @brief The allocation arena is an array of bytes.
+         */
+        char arena_[bytes];
+
+        /**
+         * @endcond
+         */
+
+      };
+
+    // ========================================================================
+
+    /**
+     * @brief Memory resource implementing the segregated fit
+     *  allocation policy, using a dynamically allocated arena.
+     * @ingroup cmsis-plus-rtos-memres
+     * @headerfile segregated-fit.h <cmsis-plus/memory/segregated-fit.h>
+     *
+     * @details
+     * This class template is a convenience class that allocates
+     * an array of chars to be used as the allocation arena.
+     *
+     * The common use case it to define dynamically allocated memory managers.
+     */
+    template<typename A = os::rtos::memory::allocator<char>>
+      class segregated_fit_allocated : public segregated_fit
+      {
+      public:
+
+        /**
+         * @brief Standard allocator type definition.
+         */
+        using value_type = char;
+
+        /**
+         * @brief Standard allocator type definition.
+         */
+        using allocator_type = A;
+
+        /**
+         * @brief Standard allocator traits definition.
+         */
+        using allocator_traits = std::allocator_traits<A>;
+
+        // It is recommended to have the same type, but at least the types
+        // should have the same size.
+        static_assert(sizeof(value_type) == sizeof(typename allocator_traits::value_type),
+            "The allocator must be parametrised with a type of same size.");
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a memory resource object instance.
+         * @param [in] bytes The size of the allocation arena.
+         * @param [in] allocator Reference to allocator. Default a
+         * local temporary instance.
+         */
+        segregated_fit_allocated (std::size_t bytes,
+                                 const allocator_type& allocator =
+                                     allocator_type ());
+
+        /**
+         * @brief Construct a named memory resource object instance.
+         * @param [in] name Pointer to name.
+         * @param [in] bytes The size of the allocation arena.
+         * @param [in] allocator Reference to allocator. Default a
+         * local temporary instance.
+         */
+        segregated_fit_allocated (const char* name, std::size_t bytes,
+                                 const allocator_type& allocator =
+                                     allocator_type ());
+
+      public:
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        segregated_fit_allocated (const segregated_fit_allocated&) = delete;
+        segregated_fit_allocated (segregated_fit_allocated&&) = delete;
+        segregated_fit_allocated&
+        operator= (const segregated_fit_allocated&) = delete;
+        segregated_fit_allocated&
+        operator= (segregated_fit_allocated&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the memory resource object instance.
+         */
+        virtual
+        ~segregated_fit_allocated ();
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        /**
+         * @brief Pointer to allocator.
+         * @details
+         * The allocator is remembered because deallocation
+         * must be performed during destruction. A more automated
+         * solution using a unique_ptr<> would require more RAM
+         * and is considered not justified.
+         */
+        allocator_type* allocator_ = nullptr;
+
+        /**
+         * @endcond
+         */
+
+      };
+
+  // --------------------------------------------------------------------------
+  } /* namespace memory */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace memory
+  {
+
+    // ========================================================================
+
+    inline
+    segregated_fit::segregated_fit (const char* name) :
+        rtos::memory::memory_resource
+          { name }
+    {
+      ;
+    }
+
+    inline
+    segregated_fit::segregated_fit (void* addr, std::size_t bytes) :
+        segregated_fit
+          { nullptr, addr, bytes }
+    {
+      ;
+    }
+
+    inline
+    segregated_fit::segregated_fit (const char* name, void* addr,
+                                  std::size_t bytes) :
+        rtos::memory::memory_resource
+          { name }
+    {
+      trace::printf ("%s(%p,%u) @%p %s\n", __func__, addr, bytes, this,
+                     this->name ());
+
+      internal_construct_ (addr, bytes);
+    }
+
+    // ========================================================================
+
+    template<std::size_t N>
+      inline
+      segregated_fit_inclusive<N>::segregated_fit_inclusive () :
+          segregated_fit_inclusive (nullptr)
+      {
+        ;
+      }
+
+    template<std::size_t N>
+      inline
+      segregated_fit_inclusive<N>::segregated_fit_inclusive (const char* name) :
+          segregated_fit
+            { name }
+      {
+        trace::printf ("%s() @%p %s\n", __func__, this, this->name ());
+
+        internal_construct_ (&arena_[0], bytes);
+      }
+
+    template<std::size_t N>
+      segregated_fit_inclusive<N>::~segregated_fit_inclusive ()
+      {
+        trace::printf ("%s() @%p %s\n", __func__, this, this->name ());
+      }
+
+    // ========================================================================
+
+    template<typename A>
+      inline
+      segregated_fit_allocated<A>::segregated_fit_allocated (
+          std::size_t bytes, const allocator_type& allocator) :
+          segregated_fit_allocated (nullptr, bytes, allocator)
+      {
+        ;
+      }
+
+    template<typename A>
+      segregated_fit_allocated<A>::segregated_fit_allocated (
+          const char* name, std::size_t bytes, const allocator_type& allocator) :
+          segregated_fit
+            { name }
+      {
+        trace::printf ("%s(%u) @%p %s\n", __func__, bytes, this, this->name ());
+
+        // Remember the allocator, it'll be used by the destructor.
+        allocator_ =
+            static_cast<allocator_type*> (&const_cast<allocator_type&> (allocator));
+
+        void* addr = allocator_->allocate (bytes);
+        if (addr == nullptr)
+          {
+            estd::__throw_bad_alloc ();
+          }
+
+        internal_construct_ (addr, bytes);
+      }
+
+    template<typename A>
+      segregated_fit_allocated<A>::~segregated_fit_allocated ()
+      {
+        trace::printf ("%s() @%p %s\n", __func__, this, this->name ());
+
+        // Skip in case a derived class did the deallocation.
+        if (allocator_ != nullptr)
+          {
+            allocator_->deallocate (
+                static_cast<typename allocator_traits::pointer> (arena_addr_),
+                total_bytes_);
+
+            // Prevent another deallocation.
+            allocator_ = nullptr;
+          }
+      }
+
+  // --------------------------------------------------------------------------
+
+  } /* namespace memory */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_MEMORY_SEGREGATED_FIT_H_ */
@@ -0,0 +1,433 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_MEMORY_SLAB_H_
+#define CMSIS_PLUS_MEMORY_SLAB_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#include <cmsis-plus/rtos/os.h>
+
+#include <new>
+#include <utility>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace memory
+  {
+
+    // ========================================================================
+
+    /**
+     * @brief Fixed capacity allocator of objects of a given type.
+     * @ingroup cmsis-plus-rtos-memres
+     * @headerfile slab.h <cmsis-plus/memory/slab.h>
+     * @tparam T Type of the objects.
+     * @tparam N Number of objects.
+     *
+     * @details
+     * The storage for _N_ objects is included in the slab object,
+     * and the layout is fully computed at compile time; there is
+     * no per-object header and no dependency on any memory resource,
+     * so slabs can be used before the free store is initialised.
+     *
+     * The free blocks are kept in a two level bitmap: one bit for
+     * each block, and one summary bit for each non-empty bitmap word;
+     * two _count trailing zeros_ find a free block, so both
+     * allocation and deallocation are O(1).
+     *
+     * The interface is compatible with the standard allocators
+     * for single objects, and `new_object()`/`delete_object()` also
+     * construct and destruct them.
+     *
+     * @note The class is not thread safe, the caller must provide
+     *  the locks, if needed.
+     */
+    template<typename T, std::size_t N>
+      class slab
+      {
+      public:
+
+        /**
+         * @brief Standard allocator type definition.
+         */
+        using value_type = T;
+
+        /**
+         * @brief Type of the bitmap words.
+         */
+        using bitmap_t = uint32_t;
+
+        /**
+         * @brief Number of bits in a bitmap word.
+         */
+        static constexpr std::size_t bitmap_bits = sizeof(bitmap_t) * 8;
+
+        /**
+         * @brief The number of blocks.
+         */
+        static constexpr std::size_t blocks = N;
+
+        /**
+         * @brief The largest number of blocks, limited by the summary word.
+         */
+        static constexpr std::size_t max_blocks = bitmap_bits * bitmap_bits;
+
+        static_assert(N > 0, "Slab capacity must be > 0.");
+        static_assert(N <= max_blocks, "Slab capacity too large.");
+
+        /**
+         * @brief The number of bitmap words.
+         */
+        static constexpr std::size_t words = (N + bitmap_bits - 1)
+            / bitmap_bits;
+
+        /**
+         * @brief The size of a block, in bytes.
+         */
+        static constexpr std::size_t block_bytes =
+            sizeof(typename std::aligned_storage<sizeof(T), alignof(T)>::type);
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a slab with all blocks free.
+         * @par Parameters
+         *  None.
+         */
+        slab () noexcept;
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        slab (const slab&) = delete;
+        slab (slab&&) = delete;
+        slab&
+        operator= (const slab&) = delete;
+        slab&
+        operator= (slab&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the slab.
+         * @details
+         * The objects still allocated are not destructed.
+         */
+        ~slab () = default;
+
+        /**
+         * @}
+         */
+
+      public:
+
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+        /**
+         * @brief Allocate storage for one object.
+         * @param [in] n Number of objects, must be 1.
+         * @return Pointer to uninitialised storage, or `nullptr`
+         *  if the slab is full.
+         */
+        value_type*
+        allocate (std::size_t n = 1) noexcept;
+
+        /**
+         * @brief Deallocate the storage of one object.
+         * @param [in] addr Pointer returned by `allocate()`.
+         * @param [in] n Number of objects, must be 1.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        deallocate (value_type* addr, std::size_t n = 1) noexcept;
+
+        /**
+         * @brief Allocate and construct an object.
+         * @param [in] args Arguments passed to the constructor.
+         * @return Pointer to object, or `nullptr` if the slab is full.
+         */
+        template<typename ... Args>
+          value_type*
+          new_object (Args&&... args);
+
+        /**
+         * @brief Destruct and deallocate an object.
+         * @param [in] addr Pointer returned by `new_object()`.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        delete_object (value_type* addr);
+
+        /**
+         * @brief Check if an address belongs to the slab.
+         * @param [in] addr Address.
+         * @retval true The address is inside the storage.
+         * @retval false The address is outside the storage.
+         */
+        bool
+        owns (const void* addr) const noexcept;
+
+        /**
+         * @brief Get the number of allocated blocks.
+         * @par Parameters
+         *  None.
+         * @return Number of blocks.
+         */
+        std::size_t
+        allocated (void) const noexcept;
+
+        /**
+         * @brief Check if all blocks are allocated.
+         * @par Parameters
+         *  None.
+         * @retval true No more blocks are available.
+         * @retval false There are free blocks.
+         */
+        bool
+        full (void) const noexcept;
+
+        /**
+         * @brief Check if all blocks are free.
+         * @par Parameters
+         *  None.
+         * @retval true No blocks are allocated.
+         * @retval false There are allocated blocks.
+         */
+        bool
+        empty (void) const noexcept;
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        /**
+         * @brief The storage, an array of objects.
+         */
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type arena_[N];
+
+        /**
+         * @brief One bit for each free block.
+         */
+        bitmap_t bitmap_[words];
+
+        /**
+         * @brief One bit for each non-zero bitmap word.
+         */
+        bitmap_t summary_;
+
+        std::size_t allocated_ = 0;
+
+        /**
+         * @endcond
+         */
+      };
+
+  // --------------------------------------------------------------------------
+  } /* namespace memory */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace memory
+  {
+
+    // ========================================================================
+
+    /**
+     * @details
+     * Set one bit for each block; the unused bits of the last
+     * word remain zero, so they are never allocated.
+     */
+    template<typename T, std::size_t N>
+      slab<T, N>::slab () noexcept
+      {
+        summary_ = 0;
+        for (std::size_t w = 0; w < words; ++w)
+          {
+            std::size_t bits = N - w * bitmap_bits;
+            if (bits >= bitmap_bits)
+              {
+                bitmap_[w] = ~static_cast<bitmap_t> (0);
+              }
+            else
+              {
+                bitmap_[w] = (static_cast<bitmap_t> (1) << bits) - 1;
+              }
+            summary_ |= static_cast<bitmap_t> (1) << w;
+          }
+      }
+
+    /**
+     * @details
+     * The lowest free block is returned, which keeps the
+     * allocated objects close together.
+     */
+    template<typename T, std::size_t N>
+      typename slab<T, N>::value_type*
+      slab<T, N>::allocate (std::size_t n) noexcept
+      {
+        assert(n == 1);
+        if (n != 1 || summary_ == 0)
+          {
+            return nullptr;
+          }
+
+        std::size_t w = static_cast<std::size_t> (__builtin_ctz (summary_));
+        std::size_t b = static_cast<std::size_t> (__builtin_ctz (bitmap_[w]));
+
+        bitmap_[w] &= ~(static_cast<bitmap_t> (1) << b);
+        if (bitmap_[w] == 0)
+          {
+            summary_ &= ~(static_cast<bitmap_t> (1) << w);
+          }
+        ++allocated_;
+
+        return reinterpret_cast<value_type*> (&arena_[w * bitmap_bits + b]);
+      }
+
+    /**
+     * @details
+     * The block index is computed from the address.
+     */
+#pragma GCC diagnostic push
+// Needed because 'n' is used only in assertions.
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+    template<typename T, std::size_t N>
+      void
+      slab<T, N>::deallocate (value_type* addr, std::size_t n) noexcept
+      {
+        assert(n == 1);
+        assert(owns (addr));
+
+        std::size_t i =
+            static_cast<std::size_t> (reinterpret_cast<char*> (addr)
+                - reinterpret_cast<char*> (&arena_[0])) / block_bytes;
+        assert(i < N);
+
+        std::size_t w = i / bitmap_bits;
+        bitmap_t mask = static_cast<bitmap_t> (1) << (i % bitmap_bits);
+
+        // Deallocating a free block is an error.
+        assert((bitmap_[w] & mask) == 0);
+
+        bitmap_[w] |= mask;
+        summary_ |= static_cast<bitmap_t> (1) << w;
+        --allocated_;
+      }
+#pragma GCC diagnostic pop
+
+    template<typename T, std::size_t N>
+      template<typename ... Args>
+        typename slab<T, N>::value_type*
+        slab<T, N>::new_object (Args&&... args)
+        {
+          void* addr = allocate ();
+          if (addr == nullptr)
+            {
+              return nullptr;
+            }
+          return new (addr) value_type (std::forward<Args>(args)...);
+        }
+
+    template<typename T, std::size_t N>
+      void
+      slab<T, N>::delete_object (value_type* addr)
+      {
+        if (addr == nullptr)
+          {
+            return;
+          }
+        addr->~value_type ();
+        deallocate (addr);
+      }
+
+    template<typename T, std::size_t N>
+      inline bool
+      slab<T, N>::owns (const void* addr) const noexcept
+      {
+        const char* p = static_cast<const char*> (addr);
+        const char* begin = reinterpret_cast<const char*> (&arena_[0]);
+        return (p >= begin) && (p < begin + sizeof(arena_));
+      }
+
+    template<typename T, std::size_t N>
+      inline std::size_t
+      slab<T, N>::allocated (void) const noexcept
+      {
+        return allocated_;
+      }
+
+    template<typename T, std::size_t N>
+      inline bool
+      slab<T, N>::full (void) const noexcept
+      {
+        return summary_ == 0;
+      }
+
+    template<typename T, std::size_t N>
+      inline bool
+      slab<T, N>::empty (void) const noexcept
+      {
+        return allocated_ == 0;
+      }
+
+  // --------------------------------------------------------------------------
+
+  } /* namespace memory */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_MEMORY_SLAB_H_ */
@@ -0,0 +1,746 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_MEMORY_TLSF_H_
+#define CMSIS_PLUS_MEMORY_TLSF_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#include <cmsis-plus/rtos/os.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace memory
+  {
+
+    // ========================================================================
+
+    /**
+     * @brief Memory resource implementing the two level
+     *  segregated fit (TLSF) allocation policy, using an existing arena.
+     * @ingroup cmsis-plus-rtos-memres
+     * @headerfile tlsf.h <cmsis-plus/memory/tlsf.h>
+     *
+     * @details
+     * The free chunks are kept in lists indexed on two levels;
+     * the first level is the power of two size class, and the
+     * second level divides each class in linear ranges.
+     * Bitmaps of the non-empty lists are kept for both levels.
+     *
+     * The requested size is rounded up to the next range, so
+     * any chunk in the first non-empty list above it is large
+     * enough; both allocation and deallocation take a bounded
+     * time, regardless of the number of free chunks, which makes
+     * this memory resource suitable for real-time applications.
+     *
+     * Each chunk has a header with its size and flags, and the free
+     * chunks also have a footer with the size (boundary tags),
+     * so freed chunks are immediately coalesced with their
+     * free neighbours.
+     *
+     * Additional discontiguous memory regions can be added to the
+     * arena with `add_region()`.
+     */
+    class tlsf : public rtos::memory::memory_resource
+    {
+    public:
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+      /**
+       * @brief Construct a memory resource object instance.
+       * @param [in] addr Begin of allocator arena.
+       * @param [in] bytes Size of allocator arena, in bytes.
+       */
+      tlsf (void* addr, std::size_t bytes);
+
+      /**
+       * @brief Construct a named memory resource object instance.
+       * @param [in] name Pointer to name.
+       * @param [in] addr Begin of allocator arena.
+       * @param [in] bytes Size of allocator arena, in bytes.
+       */
+      tlsf (const char* name, void* addr, std::size_t bytes);
+
+    protected:
+
+      /**
+       * @brief Default constructor. Construct a memory resource
+       *  object instance.
+       */
+      tlsf () = default;
+
+      /**
+       * @brief Construct a named memory resource object instance.
+       * @param [in] name
+       */
+      tlsf (const char* name);
+
+    public:
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      tlsf (const tlsf&) = delete;
+      tlsf (tlsf&&) = delete;
+      tlsf&
+      operator= (const tlsf&) = delete;
+      tlsf&
+      operator= (tlsf&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @brief Destruct the memory resource object instance.
+       */
+      virtual
+      ~tlsf () override;
+
+      /**
+       * @}
+       */
+
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+      /**
+       * @brief Add a memory region to the arena.
+       * @param [in] addr Begin of the memory region.
+       * @param [in] bytes Size of the memory region, in bytes.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      add_region (void* addr, std::size_t bytes);
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+      // A 'chunk' is where the user block resides; it starts with
+      // a header, followed by the payload.
+      typedef struct chunk_s
+      {
+        // The chunk size, in bytes, plus the flags in the lower bits;
+        // the next chunk starts exactly after this number of bytes.
+        // This is the only overhead that applies to all allocated blocks.
+        std::size_t head;
+
+        // For allocated chunks, here, or at the next address that
+        // satisfies the required alignment, starts the payload.
+        // When the chunk is free, instead of the payload, here are
+        // the links in the size class list; the last word of a
+        // free chunk is a copy of its size (the footer).
+        struct chunk_s* next;
+        struct chunk_s* prev;
+      } chunk_t;
+
+      // A 'region' is a contiguous area of memory; it starts with
+      // this header, followed by the chunks and an end marker.
+      typedef struct region_s
+      {
+        // The next region, or nullptr.
+        struct region_s* next;
+
+        // The region size, in bytes, including this header.
+        std::size_t bytes;
+      } region_t;
+
+#pragma GCC diagnostic pop
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @name Private Member Functions
+       * @{
+       */
+
+      /**
+       * @brief Internal function to construct the memory resource.
+       * @param [in] addr Begin of allocator arena.
+       * @param [in] bytes Size of allocator arena, in bytes.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_construct_ (void* addr, std::size_t bytes);
+
+      /**
+       * @brief Internal function to reset the memory resource.
+       * @par Parameters
+       *  None.
+       */
+      void
+      internal_reset_ (void) noexcept;
+
+      /**
+       * @brief Internal function to initialise a memory region.
+       * @param [in] region Pointer to region.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_init_region_ (region_t* region) noexcept;
+
+      /**
+       * @brief Internal function to get the list indices of a chunk.
+       * @param [in] size Chunk size, in bytes.
+       * @param [out] fl First level index.
+       * @param [out] sl Second level index.
+       * @par Returns
+       *  Nothing.
+       */
+      static void
+      internal_mapping_ (std::size_t size, std::size_t& fl, std::size_t& sl)
+          noexcept;
+
+      /**
+       * @brief Internal function to add a free chunk to its list.
+       * @param [in] chunk Pointer to chunk.
+       * @param [in] size Chunk size, in bytes.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_link_ (chunk_t* chunk, std::size_t size) noexcept;
+
+      /**
+       * @brief Internal function to remove a free chunk from its list.
+       * @param [in] chunk Pointer to chunk.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_unlink_ (chunk_t* chunk) noexcept;
+
+      /**
+       * @brief Internal function to find a free chunk.
+       * @param [in] size Chunk size, in bytes.
+       * @return Pointer to chunk, or `nullptr`.
+       */
+      chunk_t*
+      internal_find_ (std::size_t size) noexcept;
+
+      /**
+       * @brief Internal function to find a free chunk in the list
+       *  of the given size.
+       * @param [in] size Chunk size, in bytes.
+       * @return Pointer to chunk, or `nullptr`.
+       */
+      chunk_t*
+      internal_find_exact_ (std::size_t size) noexcept;
+
+      /**
+       * @brief Internal function to align a chunk.
+       * @param [in] chunk Pointer to chunk.
+       * @param [in] bytes Bytes to allocate.
+       * @param [in] alignment Power of two.
+       * @return Pointer to aligned payload.
+       */
+      void*
+      internal_align_ (chunk_t* chunk, std::size_t bytes, std::size_t alignment);
+
+      /**
+       * @brief Implementation of the memory allocator.
+       * @param [in] bytes Number of bytes to allocate.
+       * @param [in] alignment Alignment constraint (power of 2).
+       * @return Pointer to newly allocated block, or `nullptr`.
+       */
+      virtual void*
+      do_allocate (std::size_t bytes, std::size_t alignment) override;
+
+      /**
+       * @brief Implementation of the memory deallocator.
+       * @param [in] addr Address of a previously allocated block to free.
+       * @param [in] bytes Number of bytes to deallocate (may be 0 if unknown).
+       * @param [in] alignment Alignment constraint (power of 2).
+       * @par Returns
+       *  Nothing.
+       */
+      virtual void
+      do_deallocate (void* addr, std::size_t bytes, std::size_t alignment)
+          noexcept override;
+
+      /**
+       * @brief Implementation of the function to get max size.
+       * @par Parameters
+       *  None.
+       * @return Integer with size in bytes, or 0 if unknown.
+       */
+      virtual std::size_t
+      do_max_size (void) const noexcept override;
+
+      /**
+       * @brief Implementation of the function to coalesce free blocks.
+       * @par Parameters
+       *  None.
+       * @retval true if the operation resulted in larger blocks.
+       * @retval false if the operation was ineffective.
+       */
+      virtual bool
+      do_coalesce (void) noexcept override;
+
+      /**
+       * @brief Implementation of the function to reset the memory manager.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      virtual void
+      do_reset (void) noexcept override;
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY)
+
+      /**
+       * @brief Implementation of the function to get the largest
+       *  free chunk.
+       * @par Parameters
+       *  None.
+       * @return Number of bytes.
+       */
+      virtual std::size_t
+      do_largest_free_chunk (void) const noexcept override;
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY) */
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      // Offset of payload inside the chunk.
+      static constexpr std::size_t chunk_offset = offsetof(chunk_t, next);
+      static constexpr std::size_t chunk_align = sizeof(void*);
+      // Room for the header, the two links and the footer.
+      static constexpr std::size_t chunk_minsize = sizeof(chunk_t)
+          + sizeof(std::size_t);
+
+      // Flags in the chunk header.
+      static constexpr std::size_t chunk_used = 1;
+      static constexpr std::size_t chunk_prev_used = 2;
+      static constexpr std::size_t chunk_flags = chunk_used | chunk_prev_used;
+
+      // The number of second level lists is a power of two.
+      static constexpr std::size_t sl_index_bits = 4;
+      static constexpr std::size_t sl_index_count = 1u << sl_index_bits;
+
+      // The first level list 0 keeps the chunks smaller than this; the
+      // other ones are power of two classes, up to 4 GB chunks.
+      static constexpr std::size_t small_size = sl_index_count;
+      static constexpr std::size_t fl_index_max =
+          (sizeof(std::size_t) * 8 < 32) ? sizeof(std::size_t) * 8 : 32;
+      static constexpr std::size_t fl_index_count = fl_index_max
+          - sl_index_bits + 1;
+
+      // Extra padding from chunk to block.
+      static constexpr std::size_t
+      calc_block_padding (std::size_t block_align)
+      {
+        return os::rtos::memory::max (block_align, chunk_align) - chunk_align;
+      }
+
+      void* arena_addr_ = nullptr;
+      // The size of the first region, total_bytes_ includes all regions.
+      std::size_t arena_bytes_ = 0;
+
+      // The list of regions, the last one is the first region.
+      region_t* regions_ = nullptr;
+
+      // One bit for each first level with non-empty lists.
+      std::size_t fl_bitmap_ = 0;
+
+      // One bit for each non-empty second level list.
+      uint32_t sl_bitmaps_[fl_index_count];
+
+      // The free lists, in two levels.
+      chunk_t* free_lists_[fl_index_count][sl_index_count];
+
+      /**
+       * @endcond
+       */
+
+    };
+
+    // ========================================================================
+
+    /**
+     * @brief Memory resource implementing the two level
+     *  segregated fit (TLSF) allocation policy, using an internal arena.
+     * @ingroup cmsis-plus-rtos-memres
+     * @headerfile tlsf.h <cmsis-plus/memory/tlsf.h>
+     *
+     * @details
+     * This class template is a convenience class that includes
+     * an array of chars to be used as the allocation arena.
+     *
+     * The common use case it to define statically allocated memory managers.
+     */
+    template<std::size_t N>
+      class tlsf_inclusive : public tlsf
+      {
+      public:
+
+        /**
+         * @brief Local constant based on template definition.
+         */
+        static const std::size_t bytes = N;
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a memory resource object instance.
+         * @par Parameters
+         *  None.
+         */
+        tlsf_inclusive (void);
+
+        /**
+         * @brief Construct a named memory resource object instance.
+         * @param [in] name Pointer to name.
+         */
+        tlsf_inclusive (const char* name);
+
+      public:
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        tlsf_inclusive (const tlsf_inclusive&) = delete;
+        tlsf_inclusive (tlsf_inclusive&&) = delete;
+        tlsf_inclusive&
+        operator= (const tlsf_inclusive&) = delete;
+        tlsf_inclusive&
+        operator= (tlsf_inclusive&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the memory resource object instance.
+         */
+        virtual
+        ~tlsf_inclusive ();
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        /**
+         * @brief The allocation arena is an array of bytes.
+         */
+        char arena_[bytes];
+
+        /**
+         * @endcond
+         */
+
+      };
+
+    // ========================================================================
+
+    /**
+     * @brief Memory resource implementing the two level
+     *  segregated fit (TLSF) allocation policy, using a dynamically allocated arena.
+     * @ingroup cmsis-plus-rtos-memres
+     * @headerfile tlsf.h <cmsis-plus/memory/tlsf.h>
+     *
+     * @details
+     * This class template is a convenience class that allocates
+     * an array of chars to be used as the allocation arena.
+     *
+     * The common use case it to define dynamically allocated memory managers.
+     */
+    template<typename A = os::rtos::memory::allocator<char>>
+      class tlsf_allocated : public tlsf
+      {
+      public:
+
+        /**
+         * @brief Standard allocator type definition.
+         */
+        using value_type = char;
+
+        /**
+         * @brief Standard allocator type definition.
+         */
+        using allocator_type = A;
+
+        /**
+         * @brief Standard allocator traits definition.
+         */
+        using allocator_traits = std::allocator_traits<A>;
+
+        // It is recommended to have the same type, but at least the types
+        // should have the same size.
+        static_assert(sizeof(value_type) == sizeof(typename allocator_traits::value_type),
+            "The allocator must be parametrised with a type of same size.");
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a memory resource object instance.
+         * @param [in] bytes The size of the allocation arena.
+         * @param [in] allocator Reference to allocator. Default a
+         * local temporary instance.
+         */
+        tlsf_allocated (std::size_t bytes,
+                                 const allocator_type& allocator =
+                                     allocator_type ());
+
+        /**
+         * @brief Construct a named memory resource object instance.
+         * @param [in] name Pointer to name.
+         * @param [in] bytes The size of the allocation arena.
+         * @param [in] allocator Reference to allocator. Default a
+         * local temporary instance.
+         */
+        tlsf_allocated (const char* name, std::size_t bytes,
+                                 const allocator_type& allocator =
+                                     allocator_type ());
+
+      public:
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        tlsf_allocated (const tlsf_allocated&) = delete;
+        tlsf_allocated (tlsf_allocated&&) = delete;
+        tlsf_allocated&
+        operator= (const tlsf_allocated&) = delete;
+        tlsf_allocated&
+        operator= (tlsf_allocated&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the memory resource object instance.
+         */
+        virtual
+        ~tlsf_allocated ();
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        /**
+         * @brief Pointer to allocator.
+         * @details
+         * The allocator is remembered because deallocation
+         * must be performed during destruction. A more automated
+         * solution using a unique_ptr<> would require more RAM
+         * and is considered not justified.
+         */
+        allocator_type* allocator_ = nullptr;
+
+        /**
+         * @endcond
+         */
+
+      };
+
+  // --------------------------------------------------------------------------
+  } /* namespace memory */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace memory
+  {
+
+    // ========================================================================
+
+    inline
+    tlsf::tlsf (const char* name) :
+        rtos::memory::memory_resource
+          { name }
+    {
+      ;
+    }
+
+    inline
+    tlsf::tlsf (void* addr, std::size_t bytes) :
+        tlsf
+          { nullptr, addr, bytes }
+    {
+      ;
+    }
+
+    inline
+    tlsf::tlsf (const char* name, void* addr,
+                                  std::size_t bytes) :
+        rtos::memory::memory_resource
+          { name }
+    {
+      trace::printf ("%s(%p,%u) @%p %s\n", __func__, addr, bytes, this,
+                     this->name ());
+
+      internal_construct_ (addr, bytes);
+    }
+
+    // ========================================================================
+
+    template<std::size_t N>
+      inline
+      tlsf_inclusive<N>::tlsf_inclusive () :
+          tlsf_inclusive (nullptr)
+      {
+        ;
+      }
+
+    template<std::size_t N>
+      inline
+      tlsf_inclusive<N>::tlsf_inclusive (const char* name) :
+          tlsf
+            { name }
+      {
+        trace::printf ("%s() @%p %s\n", __func__, this, this->name ());
+
+        internal_construct_ (&arena_[0], bytes);
+      }
+
+    template<std::size_t N>
+      tlsf_inclusive<N>::~tlsf_inclusive ()
+      {
+        trace::printf ("%s() @%p %s\n", __func__, this, this->name ());
+      }
+
+    // ========================================================================
+
+    template<typename A>
+      inline
+      tlsf_allocated<A>::tlsf_allocated (
+          std::size_t bytes, const allocator_type& allocator) :
+          tlsf_allocated (nullptr, bytes, allocator)
+      {
+        ;
+      }
+
+    template<typename A>
+      tlsf_allocated<A>::tlsf_allocated (
+          const char* name, std::size_t bytes, const allocator_type& allocator) :
+          tlsf
+            { name }
+      {
+        trace::printf ("%s(%u) @%p %s\n", __func__, bytes, this, this->name ());
+
+        // Remember the allocator, it'll be used by the destructor.
+        allocator_ =
+            static_cast<allocator_type*> (&const_cast<allocator_type&> (allocator));
+
+        void* addr = allocator_->allocate (bytes);
+        if (addr == nullptr)
+          {
+            estd::__throw_bad_alloc ();
+          }
+
+        internal_construct_ (addr, bytes);
+      }
+
+    template<typename A>
+      tlsf_allocated<A>::~tlsf_allocated ()
+      {
+        trace::printf ("%s() @%p %s\n", __func__, this, this->name ());
+
+        // Skip in case a derived class did the deallocation.
+        if (allocator_ != nullptr)
+          {
+            allocator_->deallocate (
+                static_cast<typename allocator_traits::pointer> (arena_addr_),
+                arena_bytes_);
+
+            // Prevent another deallocation.
+            allocator_ = nullptr;
+          }
+      }
+
+  // --------------------------------------------------------------------------
+
+  } /* namespace memory */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_MEMORY_TLSF_H_ */
@@ -0,0 +1,214 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_POSIX_DRIVER_BLOCK_DEVICE_USB_MSC_H_
+#define CMSIS_PLUS_POSIX_DRIVER_BLOCK_DEVICE_USB_MSC_H_
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/posix-io/block-device.h>
+#include <cmsis-plus/driver/usb-host.h>
+
+// ----------------------------------------------------------------------------
+
+#if !defined(OS_INTEGER_POSIX_DRIVER_USB_MSC_TRANSFER_SIZE)
+#define OS_INTEGER_POSIX_DRIVER_USB_MSC_TRANSFER_SIZE (64 * 1024)
+#endif
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief USB mass storage block device implementation.
+     * @headerfile block-device-usb-msc.h <cmsis-plus/posix-driver/block-device-usb-msc.h>
+     * @ingroup cmsis-plus-posix-io-driver
+     *
+     * @details
+     * Bulk-Only Transport with SCSI commands, over the bulk pipes
+     * of an enumerated USB stick; the enumeration itself is left
+     * to the application.
+     *
+     * Each command is submitted as a single pipeline of queued
+     * transfers (command, data and status), and multi-block reads
+     * and writes use one command for up to
+     * `OS_INTEGER_POSIX_DRIVER_USB_MSC_TRANSFER_SIZE` bytes.
+     *
+     * To be used with `block_device_implementable`.
+     */
+    class block_device_usb_msc_impl : public block_device_impl
+    {
+      // ----------------------------------------------------------------------
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      block_device_usb_msc_impl (driver::usb::Host& host,
+                                 driver::usb::pipe_t bulk_in,
+                                 driver::usb::pipe_t bulk_out,
+                                 uint8_t lun = 0);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      block_device_usb_msc_impl (const block_device_usb_msc_impl&) = delete;
+      block_device_usb_msc_impl (block_device_usb_msc_impl&&) = delete;
+      block_device_usb_msc_impl&
+      operator= (const block_device_usb_msc_impl&) = delete;
+      block_device_usb_msc_impl&
+      operator= (block_device_usb_msc_impl&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      virtual
+      ~block_device_usb_msc_impl () override;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      virtual int
+      do_vioctl (int request, std::va_list args) override;
+
+      virtual int
+      do_vopen (const char* path, int oflag, std::va_list args) override;
+
+      virtual ssize_t
+      do_read_block (void* buf, blknum_t blknum, std::size_t nblocks) override;
+
+      virtual ssize_t
+      do_write_block (const void* buf, blknum_t blknum, std::size_t nblocks)
+          override;
+
+      virtual void
+      do_sync (void) override;
+
+      virtual int
+      do_close (void) override;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      ssize_t
+      internal_command_ (const uint8_t* cdb, std::size_t cdb_len, void* data,
+                         std::size_t data_len, bool is_in);
+
+      ssize_t
+      internal_transfer_ (void* buf, blknum_t blknum, std::size_t nblocks,
+                          bool is_write);
+
+      static void
+      internal_complete_ (const void* object,
+                          driver::usb::host::transfer_request* request);
+
+      /**
+       * @endcond
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      driver::usb::Host& host_;
+      driver::usb::pipe_t bulk_in_;
+      driver::usb::pipe_t bulk_out_;
+      uint8_t lun_;
+
+      uint32_t tag_ = 0;
+
+      // Posted once for each completed transfer of a command.
+      rtos::semaphore_counting done_sem_
+        { "msc", 3, 0 };
+
+      // Command, data and status stages.
+      driver::usb::host::transfer_request stages_[3];
+
+      // Command Block Wrapper and Command Status Wrapper.
+      alignas(4) uint8_t cbw_[31];
+      alignas(4) uint8_t csw_[13];
+
+      // Replies to the small commands (capacity, sense).
+      alignas(4) uint8_t reply_[18];
+
+      /**
+       * @endcond
+       */
+    };
+
+#pragma GCC diagnostic pop
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_POSIX_DRIVER_BLOCK_DEVICE_USB_MSC_H_ */
@@ -60,6 +60,11 @@ namespace os
          */
         using value_type = T;
 
+        /**
+         * @brief Accesses must be done in a critical section.
+         */
+        static constexpr bool is_lock_free = false;
+
         /**
          * @name Constructors & Destructor
          * @{
@@ -185,183 +190,1208 @@ namespace os
         std::size_t const high_water_mark_;
         std::size_t const low_water_mark_;
 
-        // The following are volatile because they can be updated on
-        // different threads or even on interrupts.
+        // The following are volatile because they can be updated on
+        // different threads or even on interrupts.
+
+        // Actual length: [0 - size].
+        std::size_t volatile len_;
+
+        // Next free position to push, at the back.
+        value_type* volatile back_;
+
+        // First used position to pop, at the front.
+        value_type* volatile front_;
+
+        /**
+         * @endcond
+         */
+
+      };
+    // ========================================================================
+
+    /**
+     * @brief Circular buffer of bytes.
+     * @headerfile circular-buffer.h <cmsis-plus/posix-driver/circular-buffer.h>
+     * @ingroup cmsis-plus-posix-io-utils
+     */
+    using circular_buffer_bytes = circular_buffer<uint8_t>;
+
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Lock-free single producer, single consumer circular buffer
+     *  class template.
+     * @headerfile circular-buffer.h <cmsis-plus/posix-driver/circular-buffer.h>
+     * @ingroup cmsis-plus-posix-io-utils
+     *
+     * @details
+     * Same interface as `circular_buffer`, but with separate back and
+     * front indices, each written by one side only, with
+     * acquire/release ordering. One producer (usually an interrupt
+     * handler) may push and advance the back while one consumer (a
+     * thread) pops and advances the front, without critical sections.
+     *
+     * Bulk push and pop use at most two `memcpy()` calls.
+     *
+     * `clear()` must not run concurrently with any other access.
+     * There is no `retreat_back()`, the producer cannot take back
+     * elements the consumer may already see.
+     */
+    template<typename T>
+      class spsc_circular_buffer
+      {
+        // ----------------------------------------------------------------------
+
+      public:
+
+        /**
+         * @brief Standard type definition.
+         */
+        using value_type = T;
+
+        /**
+         * @brief Accesses need no critical section.
+         */
+        static constexpr bool is_lock_free = true;
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+      public:
+
+        spsc_circular_buffer (value_type* buf, std::size_t size,
+                              std::size_t high_water_mark,
+                              std::size_t low_water_mark = 0);
+
+        spsc_circular_buffer (value_type* buf, std::size_t size);
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        spsc_circular_buffer (const spsc_circular_buffer&) = delete;
+        spsc_circular_buffer (spsc_circular_buffer&&) = delete;
+        spsc_circular_buffer&
+        operator= (const spsc_circular_buffer&) = delete;
+        spsc_circular_buffer&
+        operator= (spsc_circular_buffer&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        ~spsc_circular_buffer ();
+
+        /**
+         * @}
+         */
+
+        // --------------------------------------------------------------------
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+      public:
+
+        void
+        clear (void);
+
+        // Producer side.
+        std::size_t
+        push_back (value_type v);
+
+        std::size_t
+        push_back (const value_type* buf, std::size_t count);
+
+        std::size_t
+        advance_back (std::size_t count);
+
+        std::size_t
+        back_contiguous_buffer (value_type** ppbuf);
+
+        // Consumer side.
+        std::size_t
+        pop_front (value_type* buf);
+
+        std::size_t
+        pop_front (value_type* buf, std::size_t size);
+
+        std::size_t
+        advance_front (std::size_t count);
+
+        std::size_t
+        front_contiguous_buffer (value_type** ppbuf);
+
+        // Either side; the result may be stale by the time it is used.
+        bool
+        empty (void) const;
+
+        bool
+        full (void) const;
+
+        bool
+        above_high_water_mark (void) const;
+
+        bool
+        below_high_water_mark (void) const;
+
+        bool
+        above_low_water_mark (void) const;
+
+        bool
+        below_low_water_mark (void) const;
+
+        std::size_t
+        length (void) const;
+
+        std::size_t
+        size (void) const;
+
+        void
+        dump (void);
+
+        /**
+         * @}
+         */
+
+        // --------------------------------------------------------------------
+      private:
+
+        /**
+         * @cond ignore
+         */
+
+        // Indices run in [0, 2 * size), to tell full from empty
+        // without wasting an element, for any size.
+        std::size_t
+        wrap_ (std::size_t index) const;
+
+        std::size_t
+        offset_ (std::size_t index) const;
+
+        std::size_t
+        distance_ (std::size_t back, std::size_t front) const;
+
+        value_type* const buf_;
+        std::size_t const size_;
+        std::size_t const high_water_mark_;
+        std::size_t const low_water_mark_;
+
+        // Written only by the producer.
+        std::size_t back_;
+
+        // Written only by the consumer.
+        std::size_t front_;
+
+        /**
+         * @endcond
+         */
+
+      };
+
+#pragma GCC diagnostic pop
+
+    /**
+     * @brief Lock-free single producer, single consumer circular
+     *  buffer of bytes.
+     * @headerfile circular-buffer.h <cmsis-plus/posix-driver/circular-buffer.h>
+     * @ingroup cmsis-plus-posix-io-utils
+     */
+    using spsc_circular_buffer_bytes = spsc_circular_buffer<uint8_t>;
+
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Circular buffer class template with inline storage and
+     *  a compile time size.
+     * @headerfile circular-buffer.h <cmsis-plus/posix-driver/circular-buffer.h>
+     * @ingroup cmsis-plus-posix-io-utils
+     *
+     * @details
+     * Same interface as `circular_buffer`; the storage is a member
+     * array of `N` elements. When `N` is a power of 2 the indices
+     * wrap with a mask, without compares.
+     */
+    template<typename T, std::size_t N>
+      class circular_buffer_static
+      {
+        static_assert(N > 0, "circular_buffer_static size must be > 0");
+
+        // ----------------------------------------------------------------------
+
+      public:
+
+        /**
+         * @brief Standard type definition.
+         */
+        using value_type = T;
+
+        /**
+         * @brief Accesses must be done in a critical section.
+         */
+        static constexpr bool is_lock_free = false;
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+      public:
+
+        circular_buffer_static (std::size_t high_water_mark = N,
+                                std::size_t low_water_mark = 0);
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        circular_buffer_static (const circular_buffer_static&) = delete;
+        circular_buffer_static (circular_buffer_static&&) = delete;
+        circular_buffer_static&
+        operator= (const circular_buffer_static&) = delete;
+        circular_buffer_static&
+        operator= (circular_buffer_static&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        ~circular_buffer_static () = default;
+
+        /**
+         * @}
+         */
+
+        // --------------------------------------------------------------------
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+      public:
+
+        void
+        clear (void);
+
+        const value_type&
+        operator[] (std::size_t idx) const;
+
+        // Insert bytes to the back of the buffer.
+        std::size_t
+        push_back (value_type v);
+
+        std::size_t
+        push_back (const value_type* buf, std::size_t count);
+
+        std::size_t
+        advance_back (std::size_t count);
+
+        void
+        retreat_back (void);
+
+        // Retrieve bytes from the front of the buffer.
+        std::size_t
+        pop_front (value_type* buf);
+
+        std::size_t
+        pop_front (value_type* buf, std::size_t size);
+
+        std::size_t
+        advance_front (std::size_t count);
+
+        // Get the address of the largest contiguous buffer in the front, and
+        // length; might be only partial, if buffer wraps.
+        std::size_t
+        front_contiguous_buffer (value_type** ppbuf);
+
+        // Get the address of the largest contiguous buffer in the back, and
+        // length; might be only partial, if buffer wraps.
+        std::size_t
+        back_contiguous_buffer (value_type** ppbuf);
+
+        bool
+        empty (void) const;
+
+        bool
+        full (void) const;
+
+        bool
+        above_high_water_mark (void) const;
+
+        bool
+        below_high_water_mark (void) const;
+
+        bool
+        above_low_water_mark (void) const;
+
+        bool
+        below_low_water_mark (void) const;
+
+        std::size_t
+        length (void) const;
+
+        static constexpr std::size_t
+        size (void);
+
+        void
+        dump (void);
+
+        /**
+         * @}
+         */
+
+        // --------------------------------------------------------------------
+      private:
+
+        /**
+         * @cond ignore
+         */
+
+        static constexpr bool is_power_of_2_ = ((N & (N - 1)) == 0);
+
+        // Wrap an index in [0, 2 * N) back to [0, N).
+        static constexpr std::size_t
+        wrap_ (std::size_t index);
+
+        std::size_t const high_water_mark_;
+        std::size_t const low_water_mark_;
+
+        // The following are volatile because they can be updated on
+        // different threads or even on interrupts.
+
+        // Actual length: [0 - size].
+        std::size_t volatile len_;
+
+        // Index of the next free position to push, at the back.
+        std::size_t volatile back_;
+
+        // Index of the first used position to pop, at the front.
+        std::size_t volatile front_;
+
+        value_type buf_[N];
+
+        /**
+         * @endcond
+         */
+
+      };
+
+#pragma GCC diagnostic pop
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace posix
+  {
+
+    template<typename T>
+      circular_buffer<T>::circular_buffer (const value_type* buf,
+                                           std::size_t siz,
+                                           std::size_t high_water_mark,
+                                           std::size_t low_water_mark) :
+          buf_ (buf), //
+          size_ (siz), //
+          high_water_mark_ (high_water_mark <= size_ ? high_water_mark : siz), //
+          low_water_mark_ (low_water_mark)
+      {
+        assert (low_water_mark_ <= high_water_mark_);
+
+        clear ();
+      }
+
+    template<typename T>
+      circular_buffer<T>::circular_buffer (const value_type* buf,
+                                           std::size_t siz) :
+          circular_buffer
+            { buf, siz, siz, 0 }
+      {
+        trace::printf ("%s(%p,%u) %p\n", __func__, buf, siz, this);
+      }
+
+    template<typename T>
+      circular_buffer<T>::~circular_buffer ()
+      {
+        trace::printf ("%s() %p\n", __func__, this);
+      }
+
+    // ------------------------------------------------------------------------
+
+    template<typename T>
+      void
+      circular_buffer<T>::clear (void)
+      {
+        back_ = front_ = const_cast<value_type* volatile > (buf_);
+        len_ = 0;
+#if defined(DEBUG)
+        std::memset (static_cast<void*> (const_cast<value_type*> (buf_)), '?',
+                     size_ * sizeof(value_type));
+#endif
+      }
+
+    template<typename T>
+      inline const typename circular_buffer<T>::value_type&
+      circular_buffer<T>::operator[] (std::size_t idx) const
+      {
+        return buf_[idx];
+      }
+
+    template<typename T>
+      inline bool
+      circular_buffer<T>::empty (void) const
+      {
+        return (len_ == 0);
+      }
+
+    template<typename T>
+      inline bool
+      circular_buffer<T>::full (void) const
+      {
+        return (len_ >= size_);
+      }
+
+    template<typename T>
+      inline bool
+      circular_buffer<T>::above_high_water_mark (void) const
+      {
+        // Allow for water mark to be size.
+        return (len_ >= high_water_mark_);
+      }
+
+    template<typename T>
+      inline bool
+      circular_buffer<T>::below_low_water_mark (void) const
+      {
+        // Allow for water mark to be 0.
+        return (len_ <= low_water_mark_);
+      }
+
+    template<typename T>
+      inline bool
+      circular_buffer<T>::below_high_water_mark (void) const
+      {
+        return !above_high_water_mark ();
+      }
+
+    template<typename T>
+      inline bool
+      circular_buffer<T>::above_low_water_mark (void) const
+      {
+        return !below_low_water_mark ();
+      }
+
+    template<typename T>
+      inline std::size_t
+      circular_buffer<T>::length (void) const
+      {
+        return len_;
+      }
+
+    template<typename T>
+      inline std::size_t
+      circular_buffer<T>::size (void) const
+      {
+        return size_;
+      }
+
+    template<typename T>
+      std::size_t
+      circular_buffer<T>::push_back (value_type v)
+      {
+        if (full ())
+          {
+            return 0;
+          }
+
+        // Add to back.
+        *back_++ = v;
+        if (static_cast<std::size_t> (back_ - buf_) >= size_)
+          {
+            // Wrap.
+            back_ = const_cast<value_type* volatile > (buf_);
+          }
+        len_++;
+        return 1;
+      }
+
+    // Return the actual number of bytes, if not enough space for all.
+    template<typename T>
+      std::size_t
+      circular_buffer<T>::push_back (const value_type* buf, std::size_t count)
+      {
+        assert (buf != nullptr);
+
+        std::size_t len = count;
+        if (count > (size_ - len_))
+          {
+            len = size_ - len_;
+          }
+
+        if (len == 0)
+          {
+            return 0;
+          }
+
+        std::size_t sizeToEnd = static_cast<std::size_t> (size_
+            - static_cast<std::size_t> (back_ - buf_));
+        if (len <= sizeToEnd)
+          {
+            std::memcpy (back_, buf, len);
+            back_ += len;
+            if (static_cast<std::size_t> (back_ - buf_) >= size_)
+              {
+                // Wrap.
+                back_ = const_cast<value_type* volatile > (buf_);
+              }
+            len_ += len;
+          }
+        else
+          {
+            std::memcpy (back_, buf, sizeToEnd);
+            back_ = const_cast<value_type* volatile > (buf_);
+            std::memcpy (back_, buf + sizeToEnd, len - sizeToEnd);
+            back_ += (len - sizeToEnd);
+            len_ += len;
+          }
+        return len;
+      }
+
+    template<typename T>
+      std::size_t
+      circular_buffer<T>::advance_back (std::size_t count)
+      {
+        std::size_t adjust = count;
+        if (count > (size_ - len_))
+          {
+            adjust = size_ - len_;
+          }
+
+        if (adjust == 0)
+          {
+            return 0;
+          }
+
+        back_ += adjust;
+        if (back_ >= (buf_ + size_))
+          {
+            // Wrap.
+            back_ -= size_;
+          }
+        len_ += adjust;
+
+        return adjust;
+      }
+
+    template<typename T>
+      void
+      circular_buffer<T>::retreat_back (void)
+      {
+        if (back_ == buf_)
+          {
+            back_ = static_cast<value_type*> (const_cast<value_type*> (buf_)
+                + size_ - 1);
+          }
+        else
+          {
+            back_ -= 1;
+          }
+        len_--;
+      }
+
+    template<typename T>
+      std::size_t
+      circular_buffer<T>::pop_front (value_type* buf)
+      {
+        assert (buf != nullptr);
+
+        value_type c;
+        if (len_ == 0)
+          {
+            return 0;
+          }
+        else
+          {
+            c = *front_++;
+            if (static_cast<std::size_t> (front_ - buf_) >= size_)
+              {
+                front_ = const_cast<value_type* volatile > (buf_);
+              }
+            len_--;
+            *buf = c;
+            return 1;
+          }
+      }
+
+    template<typename T>
+      std::size_t
+      circular_buffer<T>::pop_front (value_type* buf, std::size_t siz)
+      {
+        assert (buf != nullptr);
+
+        std::size_t len = siz;
+        if (len > len_)
+          {
+            len = len_;
+          }
+
+        std::size_t sizeToEnd = size_
+            - static_cast<std::size_t> (front_ - buf_);
+        if (len <= sizeToEnd)
+          {
+            std::memcpy (buf, front_, len);
+            front_ += len;
+            if (static_cast<std::size_t> (front_ - buf_) >= size_)
+              {
+                front_ = const_cast<value_type* volatile > (buf_);
+              }
+            len_ -= len;
+          }
+        else
+          {
+            std::memcpy (buf, front_, sizeToEnd);
+            front_ = const_cast<value_type* volatile > (buf_);
+            std::memcpy (buf + sizeToEnd, front_, len - sizeToEnd);
+            front_ += (len - sizeToEnd);
+            len_ -= len;
+          }
+        return len;
+      }
+
+    template<typename T>
+      std::size_t
+      circular_buffer<T>::advance_front (std::size_t count)
+      {
+        if (count == 0)
+          {
+            return 0;
+          }
+
+        std::size_t adjust = count;
+        if (adjust > len_)
+          {
+            adjust = len_;
+          }
+
+        front_ += adjust;
+        if (front_ >= (buf_ + size_))
+          {
+            // Wrap.
+            front_ -= size_;
+          }
+        len_ -= adjust;
+
+        return adjust;
+      }
+
+    template<typename T>
+      std::size_t
+      circular_buffer<T>::front_contiguous_buffer (value_type** ppbuf)
+      {
+        assert (ppbuf != nullptr);
+
+        *ppbuf = front_;
+
+        std::size_t sizeToEnd = size_
+            - static_cast<std::size_t> (front_ - buf_);
+        std::size_t len = sizeToEnd;
+        if (len > len_)
+          {
+            len = len_;
+          }
+
+        return len;
+      }
+
+    template<typename T>
+      std::size_t
+      circular_buffer<T>::back_contiguous_buffer (value_type** ppbuf)
+      {
+        assert (ppbuf != nullptr);
+
+        *ppbuf = back_;
+
+        std::size_t sizeToEnd = size_ - static_cast<std::size_t> (back_ - buf_);
+        std::size_t len = sizeToEnd;
+        if (len > (size_ - len_))
+          {
+            len = size_ - len_;
+          }
+
+        return len;
+      }
+
+    template<typename T>
+      void
+      circular_buffer<T>::dump (void)
+      {
+        os::trace::printf ("%s @%p {buf=%p, size=%d, len=%d, hwm=%d, lwn=%d}\n",
+                           __PRETTY_FUNCTION__, buf_, size_, len_,
+                           high_water_mark_, low_water_mark_);
+      }
+
+    // ========================================================================
+
+    template<typename T>
+      spsc_circular_buffer<T>::spsc_circular_buffer (
+          value_type* buf, std::size_t siz, std::size_t high_water_mark,
+          std::size_t low_water_mark) :
+          buf_ (buf), //
+          size_ (siz), //
+          high_water_mark_ (high_water_mark <= size_ ? high_water_mark : siz), //
+          low_water_mark_ (low_water_mark)
+      {
+        assert (buf_ != nullptr);
+        assert (size_ > 0);
+        assert (low_water_mark_ <= high_water_mark_);
+
+        clear ();
+      }
+
+    template<typename T>
+      spsc_circular_buffer<T>::spsc_circular_buffer (value_type* buf,
+                                                     std::size_t siz) :
+          spsc_circular_buffer
+            { buf, siz, siz, 0 }
+      {
+        trace::printf ("%s(%p,%u) %p\n", __func__, buf, siz, this);
+      }
+
+    template<typename T>
+      spsc_circular_buffer<T>::~spsc_circular_buffer ()
+      {
+        trace::printf ("%s() %p\n", __func__, this);
+      }
+
+    // ------------------------------------------------------------------------
+
+    template<typename T>
+      inline std::size_t
+      spsc_circular_buffer<T>::wrap_ (std::size_t index) const
+      {
+        return (index >= 2 * size_) ? (index - 2 * size_) : index;
+      }
+
+    template<typename T>
+      inline std::size_t
+      spsc_circular_buffer<T>::offset_ (std::size_t index) const
+      {
+        return (index >= size_) ? (index - size_) : index;
+      }
+
+    template<typename T>
+      inline std::size_t
+      spsc_circular_buffer<T>::distance_ (std::size_t back,
+                                          std::size_t front) const
+      {
+        return (back >= front) ? (back - front) : (back + 2 * size_ - front);
+      }
+
+    template<typename T>
+      void
+      spsc_circular_buffer<T>::clear (void)
+      {
+        back_ = front_ = 0;
+#if defined(DEBUG)
+        std::memset (static_cast<void*> (buf_), '?',
+                     size_ * sizeof(value_type));
+#endif
+        __atomic_thread_fence (__ATOMIC_SEQ_CST);
+      }
+
+    template<typename T>
+      inline std::size_t
+      spsc_circular_buffer<T>::length (void) const
+      {
+        std::size_t front = __atomic_load_n (&front_, __ATOMIC_ACQUIRE);
+        std::size_t back = __atomic_load_n (&back_, __ATOMIC_ACQUIRE);
+        return distance_ (back, front);
+      }
+
+    template<typename T>
+      inline std::size_t
+      spsc_circular_buffer<T>::size (void) const
+      {
+        return size_;
+      }
+
+    template<typename T>
+      inline bool
+      spsc_circular_buffer<T>::empty (void) const
+      {
+        return (length () == 0);
+      }
+
+    template<typename T>
+      inline bool
+      spsc_circular_buffer<T>::full (void) const
+      {
+        return (length () >= size_);
+      }
+
+    template<typename T>
+      inline bool
+      spsc_circular_buffer<T>::above_high_water_mark (void) const
+      {
+        // Allow for water mark to be size.
+        return (length () >= high_water_mark_);
+      }
+
+    template<typename T>
+      inline bool
+      spsc_circular_buffer<T>::below_low_water_mark (void) const
+      {
+        // Allow for water mark to be 0.
+        return (length () <= low_water_mark_);
+      }
+
+    template<typename T>
+      inline bool
+      spsc_circular_buffer<T>::below_high_water_mark (void) const
+      {
+        return !above_high_water_mark ();
+      }
+
+    template<typename T>
+      inline bool
+      spsc_circular_buffer<T>::above_low_water_mark (void) const
+      {
+        return !below_low_water_mark ();
+      }
+
+    // ------------------------------------------------------------------------
+
+    template<typename T>
+      inline std::size_t
+      spsc_circular_buffer<T>::push_back (value_type v)
+      {
+        return push_back (&v, 1);
+      }
+
+    // Return the actual number of elements, if not enough space for all.
+    template<typename T>
+      std::size_t
+      spsc_circular_buffer<T>::push_back (const value_type* buf,
+                                          std::size_t count)
+      {
+        assert (buf != nullptr);
+
+        // Only the producer writes back_.
+        std::size_t back = __atomic_load_n (&back_, __ATOMIC_RELAXED);
+        std::size_t front = __atomic_load_n (&front_, __ATOMIC_ACQUIRE);
+
+        std::size_t len = size_ - distance_ (back, front);
+        if (len > count)
+          {
+            len = count;
+          }
+        if (len == 0)
+          {
+            return 0;
+          }
+
+        std::size_t offset = offset_ (back);
+        std::size_t sizeToEnd = size_ - offset;
+        if (len <= sizeToEnd)
+          {
+            std::memcpy (buf_ + offset, buf, len * sizeof(value_type));
+          }
+        else
+          {
+            std::memcpy (buf_ + offset, buf, sizeToEnd * sizeof(value_type));
+            std::memcpy (buf_, buf + sizeToEnd,
+                         (len - sizeToEnd) * sizeof(value_type));
+          }
+
+        // Publish the elements to the consumer.
+        __atomic_store_n (&back_, wrap_ (back + len), __ATOMIC_RELEASE);
+        return len;
+      }
+
+    template<typename T>
+      std::size_t
+      spsc_circular_buffer<T>::advance_back (std::size_t count)
+      {
+        std::size_t back = __atomic_load_n (&back_, __ATOMIC_RELAXED);
+        std::size_t front = __atomic_load_n (&front_, __ATOMIC_ACQUIRE);
+
+        std::size_t adjust = size_ - distance_ (back, front);
+        if (adjust > count)
+          {
+            adjust = count;
+          }
+        if (adjust == 0)
+          {
+            return 0;
+          }
+
+        __atomic_store_n (&back_, wrap_ (back + adjust), __ATOMIC_RELEASE);
+        return adjust;
+      }
+
+    template<typename T>
+      std::size_t
+      spsc_circular_buffer<T>::back_contiguous_buffer (value_type** ppbuf)
+      {
+        assert (ppbuf != nullptr);
+
+        std::size_t back = __atomic_load_n (&back_, __ATOMIC_RELAXED);
+        std::size_t front = __atomic_load_n (&front_, __ATOMIC_ACQUIRE);
 
-        // Actual length: [0 - size].
-        std::size_t volatile len_;
+        std::size_t offset = offset_ (back);
+        *ppbuf = buf_ + offset;
 
-        // Next free position to push, at the back.
-        value_type* volatile back_;
+        std::size_t len = size_ - offset;
+        std::size_t space = size_ - distance_ (back, front);
+        if (len > space)
+          {
+            len = space;
+          }
 
-        // First used position to pop, at the front.
-        value_type* volatile front_;
+        return len;
+      }
 
-        /**
-         * @endcond
-         */
+    // ------------------------------------------------------------------------
 
-      };
-    // ========================================================================
+    template<typename T>
+      inline std::size_t
+      spsc_circular_buffer<T>::pop_front (value_type* buf)
+      {
+        return pop_front (buf, 1);
+      }
 
-    /**
-     * @brief Circular buffer of bytes.
-     * @headerfile circular-buffer.h <cmsis-plus/posix-driver/circular-buffer.h>
-     * @ingroup cmsis-plus-posix-io-utils
-     */
-    using circular_buffer_bytes = circular_buffer<uint8_t>;
+    template<typename T>
+      std::size_t
+      spsc_circular_buffer<T>::pop_front (value_type* buf, std::size_t siz)
+      {
+        assert (buf != nullptr);
 
-  // ==========================================================================
-  } /* namespace posix */
-} /* namespace os */
+        // Only the consumer writes front_.
+        std::size_t front = __atomic_load_n (&front_, __ATOMIC_RELAXED);
+        std::size_t back = __atomic_load_n (&back_, __ATOMIC_ACQUIRE);
 
-// ===== Inline & template implementations ====================================
+        std::size_t len = distance_ (back, front);
+        if (len > siz)
+          {
+            len = siz;
+          }
+        if (len == 0)
+          {
+            return 0;
+          }
 
-namespace os
-{
-  namespace posix
-  {
+        std::size_t offset = offset_ (front);
+        std::size_t sizeToEnd = size_ - offset;
+        if (len <= sizeToEnd)
+          {
+            std::memcpy (buf, buf_ + offset, len * sizeof(value_type));
+          }
+        else
+          {
+            std::memcpy (buf, buf_ + offset, sizeToEnd * sizeof(value_type));
+            std::memcpy (buf + sizeToEnd, buf_,
+                         (len - sizeToEnd) * sizeof(value_type));
+          }
+
+        // Give the space back to the producer.
+        __atomic_store_n (&front_, wrap_ (front + len), __ATOMIC_RELEASE);
+        return len;
+      }
 
     template<typename T>
-      circular_buffer<T>::circular_buffer (const value_type* buf,
-                                           std::size_t siz,
-                                           std::size_t high_water_mark,
-                                           std::size_t low_water_mark) :
-          buf_ (buf), //
-          size_ (siz), //
-          high_water_mark_ (high_water_mark <= size_ ? high_water_mark : siz), //
-          low_water_mark_ (low_water_mark)
+      std::size_t
+      spsc_circular_buffer<T>::advance_front (std::size_t count)
       {
-        assert (low_water_mark_ <= high_water_mark_);
+        std::size_t front = __atomic_load_n (&front_, __ATOMIC_RELAXED);
+        std::size_t back = __atomic_load_n (&back_, __ATOMIC_ACQUIRE);
 
-        clear ();
+        std::size_t adjust = distance_ (back, front);
+        if (adjust > count)
+          {
+            adjust = count;
+          }
+        if (adjust == 0)
+          {
+            return 0;
+          }
+
+        __atomic_store_n (&front_, wrap_ (front + adjust), __ATOMIC_RELEASE);
+        return adjust;
       }
 
     template<typename T>
-      circular_buffer<T>::circular_buffer (const value_type* buf,
-                                           std::size_t siz) :
-          circular_buffer
-            { buf, siz, siz, 0 }
+      std::size_t
+      spsc_circular_buffer<T>::front_contiguous_buffer (value_type** ppbuf)
       {
-        trace::printf ("%s(%p,%u) %p\n", __func__, buf, siz, this);
+        assert (ppbuf != nullptr);
+
+        std::size_t front = __atomic_load_n (&front_, __ATOMIC_RELAXED);
+        std::size_t back = __atomic_load_n (&back_, __ATOMIC_ACQUIRE);
+
+        std::size_t offset = offset_ (front);
+        *ppbuf = buf_ + offset;
+
+        std::size_t len = size_ - offset;
+        std::size_t avail = distance_ (back, front);
+        if (len > avail)
+          {
+            len = avail;
+          }
+
+        return len;
       }
 
     template<typename T>
-      circular_buffer<T>::~circular_buffer ()
+      void
+      spsc_circular_buffer<T>::dump (void)
       {
-        trace::printf ("%s() %p\n", __func__, this);
+        os::trace::printf ("%s @%p {buf=%p, size=%d, len=%d, hwm=%d, lwn=%d}\n",
+                           __PRETTY_FUNCTION__, this, buf_, size_, length (),
+                           high_water_mark_, low_water_mark_);
+      }
+
+    // ========================================================================
+
+    template<typename T, std::size_t N>
+      circular_buffer_static<T, N>::circular_buffer_static (
+          std::size_t high_water_mark, std::size_t low_water_mark) :
+          high_water_mark_ (high_water_mark <= N ? high_water_mark : N), //
+          low_water_mark_ (low_water_mark)
+      {
+        assert (low_water_mark_ <= high_water_mark_);
+
+        clear ();
       }
 
     // ------------------------------------------------------------------------
 
-    template<typename T>
+    template<typename T, std::size_t N>
+      inline constexpr std::size_t
+      circular_buffer_static<T, N>::wrap_ (std::size_t index)
+      {
+        return is_power_of_2_ ? (index & (N - 1)) :
+               ((index >= N) ? (index - N) : index);
+      }
+
+    template<typename T, std::size_t N>
       void
-      circular_buffer<T>::clear (void)
+      circular_buffer_static<T, N>::clear (void)
       {
-        back_ = front_ = const_cast<value_type* volatile > (buf_);
+        back_ = front_ = 0;
         len_ = 0;
 #if defined(DEBUG)
-        std::memset (static_cast<void*> (const_cast<value_type*> (buf_)), '?',
-                     size_ * sizeof(value_type));
+        std::memset (static_cast<void*> (buf_), '?', N * sizeof(value_type));
 #endif
       }
 
-    template<typename T>
-      inline const typename circular_buffer<T>::value_type&
-      circular_buffer<T>::operator[] (std::size_t idx) const
+    template<typename T, std::size_t N>
+      inline const typename circular_buffer_static<T, N>::value_type&
+      circular_buffer_static<T, N>::operator[] (std::size_t idx) const
       {
         return buf_[idx];
       }
 
-    template<typename T>
+    template<typename T, std::size_t N>
       inline bool
-      circular_buffer<T>::empty (void) const
+      circular_buffer_static<T, N>::empty (void) const
       {
         return (len_ == 0);
       }
 
-    template<typename T>
+    template<typename T, std::size_t N>
       inline bool
-      circular_buffer<T>::full (void) const
+      circular_buffer_static<T, N>::full (void) const
       {
-        return (len_ >= size_);
+        return (len_ >= N);
       }
 
-    template<typename T>
+    template<typename T, std::size_t N>
       inline bool
-      circular_buffer<T>::above_high_water_mark (void) const
+      circular_buffer_static<T, N>::above_high_water_mark (void) const
       {
         // Allow for water mark to be size.
         return (len_ >= high_water_mark_);
       }
 
-    template<typename T>
+    template<typename T, std::size_t N>
       inline bool
-      circular_buffer<T>::below_low_water_mark (void) const
+      circular_buffer_static<T, N>::below_low_water_mark (void) const
       {
         // Allow for water mark to be 0.
         return (len_ <= low_water_mark_);
       }
 
-    template<typename T>
+    template<typename T, std::size_t N>
       inline bool
-      circular_buffer<T>::below_high_water_mark (void) const
+      circular_buffer_static<T, N>::below_high_water_mark (void) const
       {
         return !above_high_water_mark ();
       }
 
-    template<typename T>
+    template<typename T, std::size_t N>
       inline bool
-      circular_buffer<T>::above_low_water_mark (void) const
+      circular_buffer_static<T, N>::above_low_water_mark (void) const
       {
         return !below_low_water_mark ();
       }
 
-    template<typename T>
+    template<typename T, std::size_t N>
       inline std::size_t
-      circular_buffer<T>::length (void) const
+      circular_buffer_static<T, N>::length (void) const
       {
         return len_;
       }
 
-    template<typename T>
-      inline std::size_t
-      circular_buffer<T>::size (void) const
+    template<typename T, std::size_t N>
+      inline constexpr std::size_t
+      circular_buffer_static<T, N>::size (void)
       {
-        return size_;
+        return N;
       }
 
-    template<typename T>
-      std::size_t
-      circular_buffer<T>::push_back (value_type v)
+    template<typename T, std::size_t N>
+      inline std::size_t
+      circular_buffer_static<T, N>::push_back (value_type v)
       {
-        if (full ())
+        if (len_ >= N)
           {
             return 0;
           }
 
         // Add to back.
-        *back_++ = v;
-        if (static_cast<std::size_t> (back_ - buf_) >= size_)
-          {
-            // Wrap.
-            back_ = const_cast<value_type* volatile > (buf_);
-          }
+        std::size_t back = back_;
+        buf_[back] = v;
+        back_ = wrap_ (back + 1);
         len_++;
         return 1;
       }
 
     // Return the actual number of bytes, if not enough space for all.
-    template<typename T>
+    template<typename T, std::size_t N>
       std::size_t
-      circular_buffer<T>::push_back (const value_type* buf, std::size_t count)
+      circular_buffer_static<T, N>::push_back (const value_type* buf,
+                                               std::size_t count)
       {
         assert (buf != nullptr);
 
         std::size_t len = count;
-        if (count > (size_ - len_))
+        if (count > (N - len_))
           {
-            len = size_ - len_;
+            len = N - len_;
           }
 
         if (len == 0)
@@ -369,38 +1399,32 @@ namespace os
             return 0;
           }
 
-        std::size_t sizeToEnd = static_cast<std::size_t> (size_
-            - static_cast<std::size_t> (back_ - buf_));
+        std::size_t back = back_;
+        std::size_t sizeToEnd = N - back;
         if (len <= sizeToEnd)
           {
-            std::memcpy (back_, buf, len);
-            back_ += len;
-            if (static_cast<std::size_t> (back_ - buf_) >= size_)
-              {
-                // Wrap.
-                back_ = const_cast<value_type* volatile > (buf_);
-              }
-            len_ += len;
+            std::memcpy (&buf_[back], buf, len * sizeof(value_type));
           }
         else
           {
-            std::memcpy (back_, buf, sizeToEnd);
-            back_ = const_cast<value_type* volatile > (buf_);
-            std::memcpy (back_, buf + sizeToEnd, len - sizeToEnd);
-            back_ += (len - sizeToEnd);
-            len_ += len;
+            std::memcpy (&buf_[back], buf, sizeToEnd * sizeof(value_type));
+            std::memcpy (&buf_[0], buf + sizeToEnd,
+                         (len - sizeToEnd) * sizeof(value_type));
           }
+        back_ = wrap_ (back + len);
+        len_ += len;
+
         return len;
       }
 
-    template<typename T>
+    template<typename T, std::size_t N>
       std::size_t
-      circular_buffer<T>::advance_back (std::size_t count)
+      circular_buffer_static<T, N>::advance_back (std::size_t count)
       {
         std::size_t adjust = count;
-        if (count > (size_ - len_))
+        if (count > (N - len_))
           {
-            adjust = size_ - len_;
+            adjust = N - len_;
           }
 
         if (adjust == 0)
@@ -408,60 +1432,42 @@ namespace os
             return 0;
           }
 
-        back_ += adjust;
-        if (back_ >= (buf_ + size_))
-          {
-            // Wrap.
-            back_ -= size_;
-          }
+        back_ = wrap_ (back_ + adjust);
         len_ += adjust;
 
         return adjust;
       }
 
-    template<typename T>
+    template<typename T, std::size_t N>
       void
-      circular_buffer<T>::retreat_back (void)
+      circular_buffer_static<T, N>::retreat_back (void)
       {
-        if (back_ == buf_)
-          {
-            back_ = static_cast<value_type*> (const_cast<value_type*> (buf_)
-                + size_ - 1);
-          }
-        else
-          {
-            back_ -= 1;
-          }
+        back_ = wrap_ (back_ + N - 1);
         len_--;
       }
 
-    template<typename T>
-      std::size_t
-      circular_buffer<T>::pop_front (value_type* buf)
+    template<typename T, std::size_t N>
+      inline std::size_t
+      circular_buffer_static<T, N>::pop_front (value_type* buf)
       {
         assert (buf != nullptr);
 
-        value_type c;
         if (len_ == 0)
           {
             return 0;
           }
-        else
-          {
-            c = *front_++;
-            if (static_cast<std::size_t> (front_ - buf_) >= size_)
-              {
-                front_ = const_cast<value_type* volatile > (buf_);
-              }
-            len_--;
-            *buf = c;
-            return 1;
-          }
+
+        std::size_t front = front_;
+        *buf = buf_[front];
+        front_ = wrap_ (front + 1);
+        len_--;
+        return 1;
       }
 
-    template<typename T>
+    template<typename T, std::size_t N>
       std::size_t
-      circular_buffer<T>::pop_front (value_type* buf, std::size_t siz)
+      circular_buffer_static<T, N>::pop_front (value_type* buf,
+                                               std::size_t siz)
       {
         assert (buf != nullptr);
 
@@ -471,66 +1477,61 @@ namespace os
             len = len_;
           }
 
-        std::size_t sizeToEnd = size_
-            - static_cast<std::size_t> (front_ - buf_);
+        if (len == 0)
+          {
+            return 0;
+          }
+
+        std::size_t front = front_;
+        std::size_t sizeToEnd = N - front;
         if (len <= sizeToEnd)
           {
-            std::memcpy (buf, front_, len);
-            front_ += len;
-            if (static_cast<std::size_t> (front_ - buf_) >= size_)
-              {
-                front_ = const_cast<value_type* volatile > (buf_);
-              }
-            len_ -= len;
+            std::memcpy (buf, &buf_[front], len * sizeof(value_type));
           }
         else
           {
-            std::memcpy (buf, front_, sizeToEnd);
-            front_ = const_cast<value_type* volatile > (buf_);
-            std::memcpy (buf + sizeToEnd, front_, len - sizeToEnd);
-            front_ += (len - sizeToEnd);
-            len_ -= len;
+            std::memcpy (buf, &buf_[front], sizeToEnd * sizeof(value_type));
+            std::memcpy (buf + sizeToEnd, &buf_[0],
+                         (len - sizeToEnd) * sizeof(value_type));
           }
+        front_ = wrap_ (front + len);
+        len_ -= len;
+
         return len;
       }
 
-    template<typename T>
+    template<typename T, std::size_t N>
       std::size_t
-      circular_buffer<T>::advance_front (std::size_t count)
+      circular_buffer_static<T, N>::advance_front (std::size_t count)
       {
-        if (count == 0)
-          {
-            return 0;
-          }
-
         std::size_t adjust = count;
         if (adjust > len_)
           {
             adjust = len_;
           }
 
-        front_ += adjust;
-        if (front_ >= (buf_ + size_))
+        if (adjust == 0)
           {
-            // Wrap.
-            front_ -= size_;
+            return 0;
           }
+
+        front_ = wrap_ (front_ + adjust);
         len_ -= adjust;
 
         return adjust;
       }
 
-    template<typename T>
+    template<typename T, std::size_t N>
       std::size_t
-      circular_buffer<T>::front_contiguous_buffer (value_type** ppbuf)
+      circular_buffer_static<T, N>::front_contiguous_buffer (
+          value_type** ppbuf)
       {
         assert (ppbuf != nullptr);
 
-        *ppbuf = front_;
+        std::size_t front = front_;
+        *ppbuf = &buf_[front];
 
-        std::size_t sizeToEnd = size_
-            - static_cast<std::size_t> (front_ - buf_);
-        std::size_t len = sizeToEnd;
+        std::size_t len = N - front;
         if (len > len_)
           {
             len = len_;
@@ -539,30 +1540,30 @@ namespace os
         return len;
       }
 
-    template<typename T>
+    template<typename T, std::size_t N>
       std::size_t
-      circular_buffer<T>::back_contiguous_buffer (value_type** ppbuf)
+      circular_buffer_static<T, N>::back_contiguous_buffer (value_type** ppbuf)
       {
         assert (ppbuf != nullptr);
 
-        *ppbuf = back_;
+        std::size_t back = back_;
+        *ppbuf = &buf_[back];
 
-        std::size_t sizeToEnd = size_ - static_cast<std::size_t> (back_ - buf_);
-        std::size_t len = sizeToEnd;
-        if (len > (size_ - len_))
+        std::size_t len = N - back;
+        if (len > (N - len_))
           {
-            len = size_ - len_;
+            len = N - len_;
           }
 
         return len;
       }
 
-    template<typename T>
+    template<typename T, std::size_t N>
       void
-      circular_buffer<T>::dump (void)
+      circular_buffer_static<T, N>::dump (void)
       {
         os::trace::printf ("%s @%p {buf=%p, size=%d, len=%d, hwm=%d, lwn=%d}\n",
-                           __PRETTY_FUNCTION__, buf_, size_, len_,
+                           __PRETTY_FUNCTION__, this, buf_, N, len_,
                            high_water_mark_, low_water_mark_);
       }
 
@@ -37,6 +37,17 @@
 #include <cmsis-plus/posix-io/device-char.h>
 #include <cmsis-plus/posix-driver/circular-buffer.h>
 #include <cmsis-plus/driver/serial.h>
+#include <cmsis-plus/cortexm/cache.h>
+
+#include <fcntl.h>
+#include <type_traits>
+
+// ----------------------------------------------------------------------------
+
+#if !defined(OS_INTEGER_POSIX_DRIVER_SERIAL_RX_TIMEOUT_BITS)
+// About 3 characters at 8N1.
+#define OS_INTEGER_POSIX_DRIVER_SERIAL_RX_TIMEOUT_BITS (30)
+#endif
 
 // ----------------------------------------------------------------------------
 
@@ -58,12 +69,42 @@ namespace os
      * @brief Buffered serial driver class template.
      * @headerfile circular-buffer.h <cmsis-plus/posix-driver/circular-buffer.h>
      * @ingroup cmsis-plus-posix-io-driver
+     *
+     * @details
+     * With a lock-free `spsc_circular_buffer_bytes` as `B`, the
+     * buffers are accessed without critical sections; the
+     * interrupt handler is the only producer for `rx_buf`
+     * and the only consumer for `tx_buf`.
      */
-    template<typename CS>
+    template<typename CS, typename B = circular_buffer_bytes>
       class device_serial_buffered : public os::posix::device_char
       {
         using critical_section = CS;
 
+        using buffer_type = B;
+
+        /**
+         * @cond ignore
+         */
+
+        class null_critical_section
+        {
+        public:
+
+          null_critical_section ()
+          {
+          }
+        };
+
+        // Only the buffer accesses; the driver state still needs CS.
+        using buffer_critical_section = typename std::conditional<
+            buffer_type::is_lock_free, null_critical_section,
+            critical_section>::type;
+
+        /**
+         * @endcond
+         */
+
         // ----------------------------------------------------------------------
 
         /**
@@ -75,8 +116,7 @@ namespace os
 
         device_serial_buffered (const char* device_name,
                                 os::driver::Serial* driver,
-                                os::posix::circular_buffer_bytes* rx_buf,
-                                os::posix::circular_buffer_bytes* tx_buf);
+                                buffer_type* rx_buf, buffer_type* tx_buf);
 
         /**
          * @cond ignore
@@ -160,6 +200,23 @@ namespace os
          * @}
          */
 
+        /**
+         * @cond ignore
+         */
+
+        int32_t
+        internal_receive_ (uint8_t* buf, std::size_t nbyte);
+
+        int32_t
+        internal_send_ (const void* buf, std::size_t nbyte);
+
+        void
+        internal_invalidate_rx_ (std::size_t offset, std::size_t count);
+
+        /**
+         * @endcond
+         */
+
         // --------------------------------------------------------------------
       private:
 
@@ -177,13 +234,28 @@ namespace os
         os::rtos::semaphore_binary tx_sem_
           { "tx", 0 };
 
-        os::posix::circular_buffer_bytes* rx_buf_ = nullptr;
-        os::posix::circular_buffer_bytes* tx_buf_ = nullptr;
+        buffer_type* rx_buf_ = nullptr;
+        buffer_type* tx_buf_ = nullptr;
 
+        // Last rx count; in circular mode, the last DMA write position.
         std::size_t rx_count_ = 0; //
         bool volatile tx_busy_ = false;
         bool volatile is_connected_ = false;
         bool volatile is_opened_ = false;
+        // O_NONBLOCK at open(), return EAGAIN instead of waiting.
+        bool nonblocking_ = false;
+        // The driver writes continuously into the rx_buf_ storage;
+        // events only advance the back index, no re-arm.
+        bool rx_circular_ = false;
+        // rx_buf_ was full, the receiver waits for do_read() to re-arm it.
+        bool volatile rx_stalled_ = false;
+        // The driver uses DMA; the buffers passed to it are cleaned
+        // before the transfers, and the received bytes invalidated.
+        bool dma_ = false;
+        // The storage given to the last receive(), where rx_count_
+        // counts from.
+        uint8_t* rx_dma_buf_ = nullptr;
+        std::size_t rx_dma_size_ = 0;
         // Padding!
 
         /**
@@ -205,11 +277,11 @@ namespace os
   {
     // ------------------------------------------------------------------------
 
-    template<typename CS>
-      device_serial_buffered<CS>::device_serial_buffered (
+    template<typename CS, typename B>
+      device_serial_buffered<CS, B>::device_serial_buffered (
           const char* device_name, //
-          os::driver::Serial* driver, os::posix::circular_buffer_bytes* rx_buf,
-          os::posix::circular_buffer_bytes* tx_buf) :
+          os::driver::Serial* driver, buffer_type* rx_buf,
+          buffer_type* tx_buf) :
           //
           device_char (device_name), // Construct parent.
           driver_ (driver), //
@@ -227,8 +299,8 @@ namespace os
             reinterpret_cast<os::driver::signal_event_t> (signal_event), this);
       }
 
-    template<typename CS>
-      device_serial_buffered<CS>::~device_serial_buffered ()
+    template<typename CS, typename B>
+      device_serial_buffered<CS, B>::~device_serial_buffered ()
       {
         trace::printf ("%s() %p\n", __func__, this);
 
@@ -242,10 +314,10 @@ namespace os
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-parameter"
 
-    template<typename CS>
+    template<typename CS, typename B>
       int
-      device_serial_buffered<CS>::do_vopen (const char* path, int oflag,
-                                            std::va_list args)
+      device_serial_buffered<CS, B>::do_vopen (const char* path, int oflag,
+                                               std::va_list args)
       {
         if (is_opened_)
           {
@@ -263,10 +335,13 @@ namespace os
             tx_sem_.reset ();
 
             is_opened_ = true;
+            nonblocking_ = ((oflag & O_NONBLOCK) != 0);
 
             // Clear buffers.
             rx_buf_->clear ();
             rx_count_ = 0;
+            rx_circular_ = false;
+            rx_stalled_ = false;
 
             if (tx_buf_ != nullptr)
               {
@@ -307,7 +382,19 @@ namespace os
 
         os::driver::serial::Capabilities capa;
         capa = driver_->get_capabilities ();
-        if (capa.dcd)
+        dma_ = capa.dma;
+
+#if OS_INTEGER_POSIX_DRIVER_SERIAL_RX_TIMEOUT_BITS > 0
+        if (capa.event_rx_timeout)
+          {
+            // Signal when the line goes idle, to return partial frames
+            // without waiting for the receive to complete. Optional,
+            // keep going if the driver does not accept it.
+            driver_->configure (os::driver::serial::RX_TIMEOUT,
+                                OS_INTEGER_POSIX_DRIVER_SERIAL_RX_TIMEOUT_BITS);
+          }
+#endif
+        if (capa.dcd && !nonblocking_)
           {
             os::driver::serial::Modem_status status;
             for (;;)
@@ -327,10 +414,22 @@ namespace os
               }
           }
 
+        // Buffer just cleared, this is the entire storage.
         uint8_t* pbuf;
         std::size_t nbyte = rx_buf_->back_contiguous_buffer (&pbuf);
 
-        result = driver_->receive (pbuf, nbyte);
+        if (capa.rx_circular
+            && (driver_->control (
+                os::driver::serial::Control::enable_rx_circular)
+                == os::driver::RETURN_OK))
+          {
+            // The driver (usually a circular DMA) wraps by itself at the
+            // end of the storage and signals half and full transfers.
+            assert (nbyte == rx_buf_->size ());
+            rx_circular_ = true;
+          }
+
+        result = internal_receive_ (pbuf, nbyte);
         if (result != os::driver::RETURN_OK)
           {
             errno = EIO;
@@ -343,23 +442,23 @@ namespace os
         return 0;
       }
 
-    template<typename CS>
+    template<typename CS, typename B>
       bool
-      device_serial_buffered<CS>::do_is_opened (void)
+      device_serial_buffered<CS, B>::do_is_opened (void)
       {
         return is_opened_;
       }
 
-    template<typename CS>
+    template<typename CS, typename B>
       bool
-      device_serial_buffered<CS>::do_is_connected (void)
+      device_serial_buffered<CS, B>::do_is_connected (void)
       {
         return is_connected_;
       }
 
-    template<typename CS>
+    template<typename CS, typename B>
       int
-      device_serial_buffered<CS>::do_close (void)
+      device_serial_buffered<CS, B>::do_close (void)
       {
 
         if (is_connected_)
@@ -397,6 +496,14 @@ namespace os
         ret = driver_->control (os::driver::serial::Control::disable_break);
         assert (ret == os::driver::RETURN_OK);
 
+        if (rx_circular_)
+          {
+            ret = driver_->control (
+                os::driver::serial::Control::disable_rx_circular);
+            assert (ret == os::driver::RETURN_OK);
+            rx_circular_ = false;
+          }
+
         is_opened_ = false;
         is_connected_ = false;
 
@@ -404,9 +511,9 @@ namespace os
         return 0;
       }
 
-    template<typename CS>
+    template<typename CS, typename B>
       ssize_t
-      device_serial_buffered<CS>::do_read (void* buf, std::size_t nbyte)
+      device_serial_buffered<CS, B>::do_read (void* buf, std::size_t nbyte)
       {
         // TODO: implement cases when 0 must be returned
         // (disconnects, timeouts).
@@ -415,13 +522,34 @@ namespace os
             std::size_t count;
               {
                 // ----- Enter critical section -------------------------------
-                critical_section cs;
+                buffer_critical_section cs;
 
                 count = rx_buf_->pop_front (static_cast<uint8_t*> (buf), nbyte);
                 // ----- Exit critical section --------------------------------
               }
             if (count > 0)
               {
+                if (rx_stalled_)
+                  {
+                    // ----- Enter critical section ---------------------------
+                    critical_section cs;
+
+                    if (rx_stalled_)
+                      {
+                        // There is space again, restart the receiver.
+                        uint8_t* pbuf;
+                        std::size_t nb = rx_buf_->back_contiguous_buffer (
+                            &pbuf);
+                        if (internal_receive_ (pbuf, nb)
+                            == os::driver::RETURN_OK)
+                          {
+                            rx_count_ = 0;
+                            rx_stalled_ = false;
+                          }
+                      }
+                    // ----- Exit critical section ----------------------------
+                  }
+
                 // Actual number of chars received in buffer.
                 return count;
               }
@@ -430,14 +558,20 @@ namespace os
                 errno = EIO;
                 return -1;
               }
+            if (nonblocking_)
+              {
+                errno = EAGAIN;
+                return -1;
+              }
             // Block and wait for bytes to arrive.
             rx_sem_.wait ();
           }
       }
 
-    template<typename CS>
+    template<typename CS, typename B>
       ssize_t
-      device_serial_buffered<CS>::do_write (const void* buf, std::size_t nbyte)
+      device_serial_buffered<CS, B>::do_write (const void* buf,
+                                               std::size_t nbyte)
       {
         std::size_t count;
 
@@ -446,7 +580,7 @@ namespace os
             count = 0;
               {
                 // ----- Enter critical section -------------------------------
-                critical_section cs;
+                buffer_critical_section cs;
 
                 if (tx_buf_->below_high_water_mark ())
                   {
@@ -476,14 +610,14 @@ namespace os
                     std::size_t nb;
                       {
                         // ----- Enter critical section -----------------------
-                        critical_section cs; // -----
+                        buffer_critical_section cs;
 
                         nb = tx_buf_->front_contiguous_buffer (&pbuf);
                         // ----- Exit critical section ------------------------
                       }
                     if (nb > 0)
                       {
-                        if (driver_->send (pbuf, nb) != os::driver::RETURN_OK)
+                        if (internal_send_ (pbuf, nb) != os::driver::RETURN_OK)
                           {
                             errno = EIO;
                             return -1;
@@ -513,13 +647,25 @@ namespace os
                     return -1;
                   }
 
+                if (nonblocking_)
+                  {
+                    // Return what was queued, do not wait for more space.
+                    if (count > 0)
+                      {
+                        return count;
+                      }
+
+                    errno = EAGAIN;
+                    return -1;
+                  }
+
                 // Block and wait for buffer to be freed.
                 tx_sem_.wait ();
 
                 if (count < nbyte)
                   {
                     // ----- Enter critical section ---------------------------
-                    critical_section cs;
+                    buffer_critical_section cs;
 
                     std::size_t n;
                     // If there is more space in the buffer, try to fill it.
@@ -549,10 +695,17 @@ namespace os
                   {
                     break;
                   }
+                if (nonblocking_)
+                  {
+                    errno = EAGAIN;
+                    return -1;
+                  }
                 tx_sem_.wait ();
               }
 
-            if ((driver_->send (buf, nbyte)) == os::driver::RETURN_OK)
+            // Once started, the send must complete even with O_NONBLOCK,
+            // since the driver uses the caller's buffer.
+            if ((internal_send_ (buf, nbyte)) == os::driver::RETURN_OK)
               {
                 for (;;)
                   {
@@ -583,25 +736,26 @@ namespace os
       }
 
 #if 0
-    template<typename CS>
+    template<typename CS, typename B>
     ssize_t
-    device_serial_buffered<CS>::do_writev (const struct iovec* iov, int iovcnt)
+    device_serial_buffered<CS, B>::do_writev (const struct iovec* iov,
+                                              int iovcnt)
       {
         errno = ENOSYS; // Not implemented
         return -1;
       }
 
-    template<typename CS>
+    template<typename CS, typename B>
     int
-    device_serial_buffered<CS>::do_vioctl (int request, std::va_list args)
+    device_serial_buffered<CS, B>::do_vioctl (int request, std::va_list args)
       {
         errno = ENOSYS; // Not implemented
         return -1;
       }
 
-    template<typename CS>
+    template<typename CS, typename B>
     int
-    device_serial_buffered<CS>::do_vfcntl (int cmd, std::va_list args)
+    device_serial_buffered<CS, B>::do_vfcntl (int cmd, std::va_list args)
       {
         errno = ENOSYS; // Not implemented
         return -1;
@@ -610,17 +764,116 @@ namespace os
 
     // ------------------------------------------------------------------------
 
-    template<typename CS>
+    /**
+     * @details
+     * With DMA drivers, the storage is cleaned and invalidated
+     * before the transfer, so no dirty line is evicted over the
+     * received bytes.
+     */
+    template<typename CS, typename B>
+      int32_t
+      device_serial_buffered<CS, B>::internal_receive_ (uint8_t* buf,
+                                                       std::size_t nbyte)
+      {
+        rx_dma_buf_ = buf;
+        rx_dma_size_ = nbyte;
+        if (dma_)
+          {
+            os::cortexm::cache::clean_invalidate (buf, nbyte);
+          }
+        return driver_->receive (buf, nbyte);
+      }
+
+    /**
+     * @details
+     * With DMA drivers, the bytes are written back from the data
+     * cache before the transfer.
+     */
+    template<typename CS, typename B>
+      int32_t
+      device_serial_buffered<CS, B>::internal_send_ (const void* buf,
+                                                    std::size_t nbyte)
+      {
+        if (dma_)
+          {
+            os::cortexm::cache::clean (buf, nbyte);
+          }
+        return driver_->send (buf, nbyte);
+      }
+
+    /**
+     * @details
+     * Discard the cached copy of the bytes received since the
+     * last event, before they become visible to the reader; in
+     * circular mode they may wrap at the end of the storage.
+     */
+    template<typename CS, typename B>
+      void
+      device_serial_buffered<CS, B>::internal_invalidate_rx_ (
+          std::size_t offset, std::size_t count)
+      {
+        if (!dma_ || count == 0 || rx_dma_buf_ == nullptr)
+          {
+            return;
+          }
+        offset %= rx_dma_size_;
+        std::size_t n = rx_dma_size_ - offset;
+        if (n > count)
+          {
+            n = count;
+          }
+        os::cortexm::cache::invalidate (rx_dma_buf_ + offset, n);
+        if (count > n)
+          {
+            os::cortexm::cache::invalidate (rx_dma_buf_, count - n);
+          }
+      }
+
+    template<typename CS, typename B>
       void
-      device_serial_buffered<CS>::signal_event (device_serial_buffered* object,
-                                                uint32_t event)
+      device_serial_buffered<CS, B>::signal_event (
+          device_serial_buffered* object, uint32_t event)
       {
         if (!object->is_opened_)
           {
             // After close(), ignore interrupts.
             return;
           }
-        if ((event
+        if (object->rx_circular_
+            && (event
+                & (os::driver::serial::Event::receive_complete
+                    | os::driver::serial::Event::rx_half_complete
+                    | os::driver::serial::Event::rx_framing_error
+                    | os::driver::serial::Event::rx_timeout)))
+          {
+            // The driver keeps writing into the buffer storage; half,
+            // full and idle line events only move the back index up to
+            // the current DMA position.
+            std::size_t size = object->rx_buf_->size ();
+            std::size_t pos = object->driver_->get_rx_count () % size;
+            // With half and full transfer events, less than a lap is
+            // received between two calls.
+            std::size_t count = (pos + size - object->rx_count_) % size;
+            object->internal_invalidate_rx_ (object->rx_count_, count);
+            object->rx_count_ = pos;
+
+            std::size_t adjust = object->rx_buf_->advance_back (count);
+            if (adjust < count && !buffer_type::is_lock_free)
+              {
+                // Overrun, the oldest bytes were already overwritten
+                // by the driver; drop them. A lock-free buffer cannot
+                // move the front from here, the new bytes are lost.
+                object->rx_buf_->advance_front (count - adjust);
+                object->rx_buf_->advance_back (count - adjust);
+              }
+
+            if (count > 0)
+              {
+                // Immediately wake up, do not wait to reach any water mark.
+                object->rx_sem_.post ();
+              }
+          }
+        else if ((event
             & (os::driver::serial::Event::receive_complete
                 | os::driver::serial::Event::rx_framing_error
                 | os::driver::serial::Event::rx_timeout)))
@@ -628,6 +881,7 @@ namespace os
             // TODO: process errors and timeouts
             std::size_t tmpCount = object->driver_->get_rx_count ();
             std::size_t count = tmpCount - object->rx_count_;
+            object->internal_invalidate_rx_ (object->rx_count_, count);
             object->rx_count_ = tmpCount;
             std::size_t adjust = object->rx_buf_->advance_back (count);
             assert (count == adjust);
@@ -639,18 +893,19 @@ namespace os
                     &pbuf);
                 if (nbyte == 0)
                   {
-                    // Overwrite the last byte, but keep the driver in
-                    // receive mode continuously.
-                    object->rx_buf_->retreat_back ();
-                    nbyte = object->rx_buf_->back_contiguous_buffer (&pbuf);
+                    // Buffer full; leave the receiver stopped until
+                    // do_read() makes room, do not overwrite bytes the
+                    // reader may already see.
+                    object->rx_stalled_ = true;
+                  }
+                else
+                  {
+                    // Read as much as we can.
+                    int32_t status;
+                    status = object->internal_receive_ (pbuf, nbyte);
+                    // TODO: implement error processing.
+                    assert (status == os::driver::RETURN_OK);
                   }
-                assert (nbyte > 0);
-
-                // Read as much as we can.
-                int32_t status;
-                status = object->driver_->receive (pbuf, nbyte);
-                // TODO: implement error processing.
-                assert (status == os::driver::RETURN_OK);
 
                 object->rx_count_ = 0;
               }
@@ -674,7 +929,7 @@ namespace os
                 if (nbyte > 0)
                   {
                     int32_t status;
-                    status = object->driver_->send (pbuf, nbyte);
+                    status = object->internal_send_ (pbuf, nbyte);
                     // TODO: implement error processing
                     assert (status == os::driver::RETURN_OK);
                   }
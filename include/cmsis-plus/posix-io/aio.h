@@ -0,0 +1,121 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_POSIX_IO_AIO_H_
+#define CMSIS_PLUS_POSIX_IO_AIO_H_
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#include <cmsis-plus/posix/aio.h>
+#include <cmsis-plus/rtos/os.h>
+
+#include <sys/types.h>
+
+// ----------------------------------------------------------------------------
+
+// The max number of operations in progress, or done and not yet
+// returned by aio_return().
+#if !defined(OS_INTEGER_POSIX_IO_AIO_MAX)
+#define OS_INTEGER_POSIX_IO_AIO_MAX (8)
+#endif
+
+#if !defined(OS_INTEGER_POSIX_IO_AIO_THREADS)
+#define OS_INTEGER_POSIX_IO_AIO_THREADS (2)
+#endif
+
+#if !defined(OS_INTEGER_POSIX_IO_AIO_STACK_SIZE_BYTES)
+#define OS_INTEGER_POSIX_IO_AIO_STACK_SIZE_BYTES (2048)
+#endif
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ------------------------------------------------------------------------
+
+    /**
+     * @ingroup cmsis-plus-posix-io-func
+     * @{
+     */
+
+    // http://pubs.opengroup.org/onlinepubs/9699919799/functions/aio_read.html
+    int
+    aio_read (struct aiocb* aiocbp);
+
+    // http://pubs.opengroup.org/onlinepubs/9699919799/functions/aio_write.html
+    int
+    aio_write (struct aiocb* aiocbp);
+
+    // http://pubs.opengroup.org/onlinepubs/9699919799/functions/aio_error.html
+    int
+    aio_error (const struct aiocb* aiocbp);
+
+    // http://pubs.opengroup.org/onlinepubs/9699919799/functions/aio_return.html
+    ssize_t
+    aio_return (struct aiocb* aiocbp);
+
+    // http://pubs.opengroup.org/onlinepubs/9699919799/functions/aio_suspend.html
+    int
+    aio_suspend (const struct aiocb* const list[], int nent,
+                 const struct timespec* timeout);
+
+    // http://pubs.opengroup.org/onlinepubs/9699919799/functions/aio_cancel.html
+    int
+    aio_cancel (int fildes, struct aiocb* aiocbp);
+
+    /**
+     * @brief Post a semaphore when an operation completes.
+     * @param [in] aiocbp Pointer to the control block of a submitted
+     *  operation.
+     * @param [in] sem Pointer to the semaphore; may be `nullptr`.
+     * @retval 0 The semaphore was registered, or posted.
+     * @retval -1 The operation is not known; `errno` is EINVAL.
+     */
+    int
+    aio_notify (const struct aiocb* aiocbp, rtos::semaphore* sem);
+
+    /**
+     * @}
+     */
+
+  // --------------------------------------------------------------------------
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_POSIX_IO_AIO_H_ */
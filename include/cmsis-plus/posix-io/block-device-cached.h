@@ -0,0 +1,1534 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_POSIX_IO_BLOCK_DEVICE_CACHED_H_
+#define CMSIS_PLUS_POSIX_IO_BLOCK_DEVICE_CACHED_H_
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#include <cmsis-plus/posix-io/block-device.h>
+#include <cmsis-plus/posix/sys/mman.h>
+#include <cmsis-plus/posix/sys/ioctl.h>
+#include <cmsis-plus/rtos/os.h>
+
+#include <cstring>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    /**
+     * @brief Block device with a write-back cache.
+     * @headerfile block-device-cached.h <cmsis-plus/posix-io/block-device-cached.h>
+     * @ingroup cmsis-plus-posix-io-base
+     * @details
+     * Keeps the most recently used blocks in RAM, so the blocks
+     * read or written again, like the file system metadata, do
+     * not go to the driver each time. The blocks written are
+     * kept dirty in the cache, and written to the device when
+     * evicted, by `sync()` and by `close()`.
+     *
+     * The victims are selected with the CLOCK algorithm, an
+     * approximation of LRU which only sets a bit on each access.
+     *
+     * The buffers are allocated from a memory resource when the
+     * device is first accessed after `open()`, since the block size
+     * is known only then, and are freed by `close()`.
+     *
+     * Requests larger than half of the cache go directly to the
+     * driver, so long transfers do not flush the cache; the cached
+     * copies of the blocks involved are kept coherent.
+     *
+     * When the reads are sequential, or with `POSIX_FADV_SEQUENTIAL`,
+     * a miss reads ahead the next blocks with a single driver
+     * request, into consecutive cache entries.
+     *
+     * Byte reads and writes need not be aligned; the partial
+     * blocks at the ends are accessed in the cache.
+     *
+     * In direct mode (`O_DIRECT`), the whole blocks with suitably
+     * aligned buffers go to the driver regardless of their size,
+     * so streaming transfers do not evict the metadata.
+     */
+    template<typename T>
+      class block_device_cached : public block_device
+      {
+        // --------------------------------------------------------------------
+
+      public:
+
+        using value_type = T;
+
+        /**
+         * @brief Cache statistics.
+         */
+        struct statistics_t
+        {
+          /**
+           * @brief Number of blocks found in the cache.
+           */
+          std::size_t hits;
+
+          /**
+           * @brief Number of blocks not found in the cache.
+           */
+          std::size_t misses;
+
+          /**
+           * @brief Number of dirty blocks written to the device.
+           */
+          std::size_t writebacks;
+
+          /**
+           * @brief Number of requests passed directly to the device.
+           */
+          std::size_t bypasses;
+
+          /**
+           * @brief Number of blocks read ahead.
+           */
+          std::size_t prefetches;
+        };
+
+        // --------------------------------------------------------------------
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+      public:
+
+        template<typename ... Args>
+          block_device_cached (const char* name, std::size_t cached_blocks,
+                               rtos::memory::memory_resource* mr,
+                               Args&&... args);
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        block_device_cached (const block_device_cached&) = delete;
+        block_device_cached (block_device_cached&&) = delete;
+        block_device_cached&
+        operator= (const block_device_cached&) = delete;
+        block_device_cached&
+        operator= (block_device_cached&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        virtual
+        ~block_device_cached () override;
+
+        /**
+         * @}
+         */
+
+        // --------------------------------------------------------------------
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+      public:
+
+        virtual int
+        close (void) override;
+
+        virtual ssize_t
+        read (void* buf, std::size_t nbyte) override;
+
+        virtual ssize_t
+        write (const void* buf, std::size_t nbyte) override;
+
+        virtual ssize_t
+        writev (const struct iovec* iov, int iovcnt) override;
+
+        virtual ssize_t
+        readv (const struct iovec* iov, int iovcnt) override;
+
+        virtual ssize_t
+        preadv (const struct iovec* iov, int iovcnt, off_t offset) override;
+
+        virtual ssize_t
+        pwritev (const struct iovec* iov, int iovcnt, off_t offset) override;
+
+        virtual ssize_t
+        read_block (void* buf, blknum_t blknum, std::size_t nblocks = 1)
+            override;
+
+        virtual ssize_t
+        write_block (const void* buf, blknum_t blknum, std::size_t nblocks = 1)
+            override;
+
+        virtual int
+        vioctl (int request, std::va_list args) override;
+
+        virtual int
+        discard (blknum_t blknum, std::size_t nblocks = 1) override;
+
+        virtual void
+        sync (void) override;
+
+        virtual int
+        fadvise (off_t offset, off_t len, int advice) override;
+
+        virtual int
+        submit (request& req) override;
+
+        virtual void*
+        mmap (std::size_t length, int prot, int flags, off_t offset)
+            override;
+
+        virtual ssize_t
+        peek (const void** buf, std::size_t nbyte, off_t offset) override;
+
+        /**
+         * @brief Set the read-ahead window.
+         * @param [in] nblocks The max number of blocks read with
+         *  each sequential miss, including the missing one;
+         *  1 disables the read-ahead.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        readahead (std::size_t nblocks);
+
+        /**
+         * @brief Write the dirty blocks and drop all cached blocks.
+         * @par Parameters
+         *  None.
+         * @retval 0 The cache was flushed.
+         * @retval -1 A write failed; the block remains dirty.
+         */
+        int
+        invalidate (void);
+
+        /**
+         * @brief Get the cache capacity.
+         * @par Parameters
+         *  None.
+         * @return The number of cached blocks.
+         */
+        std::size_t
+        cached_blocks (void) const;
+
+        /**
+         * @brief Copy the statistics.
+         * @param [out] stats Pointer to the destination structure.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        statistics (statistics_t* stats) const;
+
+        /**
+         * @brief Clear the statistics.
+         * @par Parameters
+         *  None.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        clear_statistics (void);
+
+        // --------------------------------------------------------------------
+        // Support functions.
+
+        value_type&
+        impl (void) const;
+
+        /**
+         * @}
+         */
+
+        // --------------------------------------------------------------------
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+        struct entry_t
+        {
+          blknum_t blknum;
+          uint8_t* data;
+          bool valid;
+          bool dirty;
+          bool referenced;
+        };
+
+#pragma GCC diagnostic pop
+
+        bool
+        internal_allocate_ (void);
+
+        void
+        internal_free_ (void);
+
+        entry_t*
+        internal_find_ (blknum_t blknum);
+
+        entry_t*
+        internal_victim_ (void);
+
+        int
+        internal_write_back_ (entry_t* entry);
+
+        entry_t*
+        internal_fill_ (blknum_t blknum, std::size_t window);
+
+        void
+        internal_drop_ (blknum_t blknum, std::size_t nblocks);
+
+        ssize_t
+        internal_transfer_vector_ (const struct iovec* iov, int iovcnt,
+                                   off_t offset, bool is_write);
+
+        ssize_t
+        internal_transfer_bytes_ (void* buf, std::size_t nbyte, off_t offset,
+                                  bool is_write);
+
+        int
+        internal_partial_ (blknum_t blknum, std::size_t ofs, uint8_t* p,
+                           std::size_t n, bool is_write);
+
+        value_type impl_instance_;
+
+        rtos::memory::memory_resource* mr_;
+
+        std::size_t count_;
+
+        // The clock hand, the next candidate for eviction.
+        std::size_t hand_ = 0;
+
+        // The entries, followed by the blocks data.
+        entry_t* entries_ = nullptr;
+
+        std::size_t allocated_bytes_ = 0;
+
+        std::size_t readahead_;
+
+        // Where the next sequential read would start, and how many
+        // sequential reads were seen in a row.
+        blknum_t next_blknum_ = 0;
+        std::size_t streak_ = 0;
+
+        statistics_t statistics_
+          { };
+
+        /**
+         * @endcond
+         */
+      };
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    /**
+     * @details
+     * If `mr` is `nullptr`, the buffers are allocated from the
+     * default memory resource.
+     */
+    template<typename T>
+      template<typename ... Args>
+        block_device_cached<T>::block_device_cached (
+            const char* name, std::size_t cached_blocks,
+            rtos::memory::memory_resource* mr, Args&&... args) :
+            block_device
+              { impl_instance_, name }, //
+            impl_instance_
+              { std::forward<Args>(args)... }, //
+            mr_ (
+                mr != nullptr ? mr : rtos::memory::get_default_resource ()), //
+            count_ (cached_blocks != 0 ? cached_blocks : 1), //
+            readahead_ (count_ / 4 != 0 ? count_ / 4 : 1)
+        {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+          OS_TRACE_PRINTF (posix_io_block_device,
+                           "block_device_cached::%s(\"%s\", %u)=@%p\n",
+                           __func__, name_, count_, this);
+#endif
+        }
+
+    /**
+     * @details
+     * The dirty blocks must be written by `sync()` or by `close()`
+     * before the object is destroyed, otherwise they are lost.
+     */
+    template<typename T>
+      block_device_cached<T>::~block_device_cached ()
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+        OS_TRACE_PRINTF (posix_io_block_device,
+                         "block_device_cached::%s() @%p %s\n", __func__, this,
+                         name_);
+#endif
+
+        internal_free_ ();
+      }
+
+    // ------------------------------------------------------------------------
+
+    template<typename T>
+      int
+      block_device_cached<T>::close (void)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+        OS_TRACE_PRINTF (posix_io_block_device,
+                         "block_device_cached::%s() @%p\n", __func__, this);
+#endif
+
+        int ret = invalidate ();
+
+        int res = block_device::close ();
+        if (!is_opened ())
+          {
+            internal_free_ ();
+          }
+
+        return (ret != 0) ? ret : res;
+      }
+
+    /**
+     * @details
+     * The offset and the size do not need to be aligned to blocks;
+     * the partial blocks at the ends are copied from the cache.
+     */
+    template<typename T>
+      ssize_t
+      block_device_cached<T>::read (void* buf, std::size_t nbyte)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+        OS_TRACE_PRINTF (posix_io_block_device,
+                         "block_device_cached::%s(0x0%X, %u) @%p\n", __func__,
+                         buf, nbyte, this);
+#endif
+
+        off_t offset = lseek (0, SEEK_CUR);
+        if (offset < 0)
+          {
+            return -1;
+          }
+
+        ssize_t ret = internal_transfer_bytes_ (buf, nbyte, offset, false);
+        if (ret > 0)
+          {
+            lseek (ret, SEEK_CUR);
+          }
+        return ret;
+      }
+
+    /**
+     * @details
+     * The offset and the size do not need to be aligned to blocks;
+     * the partial blocks at the ends are updated in the cache.
+     */
+    template<typename T>
+      ssize_t
+      block_device_cached<T>::write (const void* buf, std::size_t nbyte)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+        OS_TRACE_PRINTF (posix_io_block_device,
+                         "block_device_cached::%s(0x0%X, %u) @%p\n", __func__,
+                         buf, nbyte, this);
+#endif
+
+        off_t offset = lseek (0, SEEK_CUR);
+        if (offset < 0)
+          {
+            return -1;
+          }
+
+        ssize_t ret = internal_transfer_bytes_ (const_cast<void*> (buf), nbyte,
+                                                offset, true);
+        if (ret > 0)
+          {
+            lseek (ret, SEEK_CUR);
+          }
+        return ret;
+      }
+
+    template<typename T>
+      ssize_t
+      block_device_cached<T>::writev (const struct iovec* iov, int iovcnt)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+        OS_TRACE_PRINTF (posix_io_block_device,
+                         "block_device_cached::%s(0x0%X, %d) @%p\n", __func__,
+                         iov, iovcnt, this);
+#endif
+
+        off_t offset = lseek (0, SEEK_CUR);
+        if (offset < 0)
+          {
+            return -1;
+          }
+
+        ssize_t ret = pwritev (iov, iovcnt, offset);
+        if (ret > 0)
+          {
+            lseek (ret, SEEK_CUR);
+          }
+        return ret;
+      }
+
+    template<typename T>
+      ssize_t
+      block_device_cached<T>::readv (const struct iovec* iov, int iovcnt)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+        OS_TRACE_PRINTF (posix_io_block_device,
+                         "block_device_cached::%s(0x0%X, %d) @%p\n", __func__,
+                         iov, iovcnt, this);
+#endif
+
+        off_t offset = lseek (0, SEEK_CUR);
+        if (offset < 0)
+          {
+            return -1;
+          }
+
+        ssize_t ret = preadv (iov, iovcnt, offset);
+        if (ret > 0)
+          {
+            lseek (ret, SEEK_CUR);
+          }
+        return ret;
+      }
+
+    /**
+     * @details
+     * Each fragment goes through the cache, so long
+     * fragments still bypass it with a single driver request.
+     */
+    template<typename T>
+      ssize_t
+      block_device_cached<T>::preadv (const struct iovec* iov, int iovcnt,
+                                      off_t offset)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+        OS_TRACE_PRINTF (posix_io_block_device,
+                         "block_device_cached::%s(0x0%X, %d, %d) @%p\n",
+                         __func__, iov, iovcnt, offset, this);
+#endif
+
+        return internal_transfer_vector_ (iov, iovcnt, offset, false);
+      }
+
+    template<typename T>
+      ssize_t
+      block_device_cached<T>::pwritev (const struct iovec* iov, int iovcnt,
+                                       off_t offset)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+        OS_TRACE_PRINTF (posix_io_block_device,
+                         "block_device_cached::%s(0x0%X, %d, %d) @%p\n",
+                         __func__, iov, iovcnt, offset, this);
+#endif
+
+        return internal_transfer_vector_ (iov, iovcnt, offset, true);
+      }
+
+    /**
+     * @details
+     * Asynchronous requests bypass the cache, which is made coherent
+     * when they are queued: the dirty copies of the blocks to be read
+     * are written back, and the copies of the blocks to be written
+     * are dropped. The same blocks must not be accessed via the
+     * cache until the request is done.
+     */
+    template<typename T>
+      int
+      block_device_cached<T>::submit (request& req)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+        OS_TRACE_PRINTF (posix_io_block_device,
+                         "block_device_cached::%s(%p) @%p\n", __func__, &req,
+                         this);
+#endif
+
+        if (entries_ != nullptr)
+          {
+            for (std::size_t i = 0; i < count_; ++i)
+              {
+                entry_t& en = entries_[i];
+                if (!en.valid || en.blknum < req.blknum
+                    || en.blknum >= req.blknum + req.nblocks)
+                  {
+                    continue;
+                  }
+
+                if (req.is_write)
+                  {
+                    en.valid = false;
+                    en.dirty = false;
+                  }
+                else if (en.dirty && internal_write_back_ (&en) != 0)
+                  {
+                    return -1;
+                  }
+              }
+          }
+
+        return block_device::submit (req);
+      }
+
+    /**
+     * @details
+     * A direct mapping bypasses the cache, which is made coherent
+     * when the mapping is created: the dirty copies of the mapped
+     * blocks are written back and, for writable mappings, the
+     * copies are dropped.
+     */
+    template<typename T>
+      void*
+      block_device_cached<T>::mmap (std::size_t length, int prot, int flags,
+                                    off_t offset)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+        OS_TRACE_PRINTF (posix_io_block_device,
+                         "block_device_cached::%s(%u, %d, %d, %d) @%p\n",
+                         __func__, length, prot, flags, offset, this);
+#endif
+
+        if (entries_ != nullptr && length > 0 && offset >= 0)
+          {
+            std::size_t bs = block_logical_size_bytes ();
+            blknum_t first = static_cast<std::size_t> (offset) / bs;
+            blknum_t last = (static_cast<std::size_t> (offset) + length - 1)
+                / bs;
+
+            for (std::size_t i = 0; i < count_; ++i)
+              {
+                entry_t& en = entries_[i];
+                if (!en.valid || en.blknum < first || en.blknum > last)
+                  {
+                    continue;
+                  }
+
+                if (en.dirty && internal_write_back_ (&en) != 0)
+                  {
+                    return MAP_FAILED;
+                  }
+                if ((prot & PROT_WRITE) != 0)
+                  {
+                    en.valid = false;
+                  }
+              }
+          }
+
+        return block_device::mmap (length, prot, flags, offset);
+      }
+
+    /**
+     * @details
+     * The content is exposed from the cache, one block at a time;
+     * a missing block is first read into the cache.
+     */
+    template<typename T>
+      ssize_t
+      block_device_cached<T>::peek (const void** buf, std::size_t nbyte,
+                                    off_t offset)
+      {
+        if (buf == nullptr)
+          {
+            errno = EFAULT;
+            return -1;
+          }
+
+        std::size_t bs = block_logical_size_bytes ();
+        if ((nbyte == 0) || (offset < 0) || (bs == 0))
+          {
+            errno = EINVAL;
+            return -1;
+          }
+
+        blknum_t blknum = static_cast<std::size_t> (offset) / bs;
+        std::size_t ofs = static_cast<std::size_t> (offset) % bs;
+        if (blknum >= blocks ())
+          {
+            return 0; // End of device.
+          }
+
+        if (!internal_allocate_ ())
+          {
+            errno = ENOMEM;
+            return -1;
+          }
+
+        entry_t* en = internal_find_ (blknum);
+        if (en != nullptr)
+          {
+            ++statistics_.hits;
+          }
+        else
+          {
+            ++statistics_.misses;
+
+            en = internal_fill_ (blknum, 1);
+            if (en == nullptr)
+              {
+                return -1;
+              }
+          }
+
+        en->referenced = true;
+
+        *buf = en->data + ofs;
+        std::size_t n = bs - ofs;
+        return static_cast<ssize_t> ((nbyte < n) ? nbyte : n);
+      }
+
+    template<typename T>
+      ssize_t
+      block_device_cached<T>::internal_transfer_vector_ (
+          const struct iovec* iov, int iovcnt, off_t offset, bool is_write)
+      {
+        if (iov == nullptr)
+          {
+            errno = EFAULT;
+            return -1;
+          }
+
+        if (iovcnt <= 0)
+          {
+            errno = EINVAL;
+            return -1;
+          }
+
+        ssize_t total = 0;
+
+        for (int i = 0; i < iovcnt; ++i)
+          {
+            std::size_t len = iov[i].iov_len;
+            if (len == 0)
+              {
+                continue;
+              }
+
+            ssize_t ret = internal_transfer_bytes_ (iov[i].iov_base, len,
+                                                    offset + total, is_write);
+            if (ret < 0)
+              {
+                return (total > 0) ? total : -1;
+              }
+
+            total += ret;
+
+            if (static_cast<std::size_t> (ret) < len)
+              {
+                break; // Short transfer.
+              }
+          }
+
+        return total;
+      }
+
+    template<typename T>
+      ssize_t
+      block_device_cached<T>::internal_transfer_bytes_ (void* buf,
+                                                        std::size_t nbyte,
+                                                        off_t offset,
+                                                        bool is_write)
+      {
+        std::size_t bs = block_logical_size_bytes ();
+        if ((bs == 0) || (offset < 0)
+            || (static_cast<std::size_t> (offset) + nbyte > blocks () * bs))
+          {
+            errno = EINVAL;
+            return -1;
+          }
+
+        if (!is_opened ())
+          {
+            errno = EBADF; // Not opened.
+            return -1;
+          }
+
+        uint8_t* p = static_cast<uint8_t*> (buf);
+        std::size_t pos = static_cast<std::size_t> (offset);
+        std::size_t left = nbyte;
+
+        while (left > 0)
+          {
+            blknum_t blknum = pos / bs;
+            std::size_t ofs = pos % bs;
+
+            std::size_t n;
+            if (ofs == 0 && left >= bs)
+              {
+                // The aligned middle, with the usual cache policy.
+                std::size_t nblocks = left / bs;
+
+                ssize_t ret;
+                if (is_write)
+                  {
+                    ret = write_block (p, blknum, nblocks);
+                  }
+                else
+                  {
+                    ret = read_block (p, blknum, nblocks);
+                  }
+
+                if (ret < 0)
+                  {
+                    break;
+                  }
+
+                n = static_cast<std::size_t> (ret) * bs;
+                if (static_cast<std::size_t> (ret) < nblocks)
+                  {
+                    pos += n;
+                    left -= n;
+                    break; // Short transfer.
+                  }
+              }
+            else
+              {
+                // A partial block, at the head or the tail.
+                n = bs - ofs;
+                if (n > left)
+                  {
+                    n = left;
+                  }
+
+                if (internal_partial_ (blknum, ofs, p, n, is_write) != 0)
+                  {
+                    break;
+                  }
+              }
+
+            p += n;
+            pos += n;
+            left -= n;
+          }
+
+        std::size_t done = nbyte - left;
+        if (left > 0 && done == 0)
+          {
+            return -1;
+          }
+        return static_cast<ssize_t> (done);
+      }
+
+    template<typename T>
+      int
+      block_device_cached<T>::internal_partial_ (blknum_t blknum,
+                                                 std::size_t ofs, uint8_t* p,
+                                                 std::size_t n, bool is_write)
+      {
+        if (!internal_allocate_ ())
+          {
+            errno = ENOMEM;
+            return -1;
+          }
+
+        entry_t* en = internal_find_ (blknum);
+        if (en != nullptr)
+          {
+            ++statistics_.hits;
+          }
+        else
+          {
+            ++statistics_.misses;
+
+            // Even for writes, the rest of the block is needed.
+            en = internal_fill_ (blknum, 1);
+            if (en == nullptr)
+              {
+                return -1;
+              }
+          }
+
+        en->referenced = true;
+        if (is_write)
+          {
+            std::memcpy (en->data + ofs, p, n);
+            en->dirty = true;
+          }
+        else
+          {
+            std::memcpy (p, en->data + ofs, n);
+          }
+        return 0;
+      }
+
+    template<typename T>
+      ssize_t
+      block_device_cached<T>::read_block (void* buf, blknum_t blknum,
+                                          std::size_t nblocks)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+        OS_TRACE_PRINTF (posix_io_block_device,
+                         "block_device_cached::%s(%p, %u, %u) @%p\n", __func__,
+                         buf, blknum, nblocks, this);
+#endif
+
+        if (blknum + nblocks > blocks ())
+          {
+            errno = EINVAL;
+            return -1;
+          }
+
+        if (!is_opened ())
+          {
+            errno = EBADF; // Not opened.
+            return -1;
+          }
+
+        if (!internal_allocate_ ())
+          {
+            errno = ENOMEM;
+            return -1;
+          }
+
+        std::size_t bs = block_logical_size_bytes ();
+        uint8_t* p = static_cast<uint8_t*> (buf);
+
+        // Two sequential reads in a row enable the read-ahead.
+        streak_ = (blknum == next_blknum_) ? streak_ + 1 : 0;
+        next_blknum_ = blknum + nblocks;
+
+        std::size_t window = 1;
+        if (advice () == POSIX_FADV_SEQUENTIAL)
+          {
+            window = readahead_ * 2;
+          }
+        else if (advice () != POSIX_FADV_RANDOM && streak_ >= 2)
+          {
+            window = readahead_;
+          }
+
+        if (nblocks > count_ / 2 || direct (buf))
+          {
+            ++statistics_.bypasses;
+
+            ssize_t ret = block_device::read_block (buf, blknum, nblocks);
+            if (ret < 0)
+              {
+                return ret;
+              }
+
+            // The cached copies may be newer than the device.
+            for (std::size_t i = 0; i < count_; ++i)
+              {
+                entry_t& en = entries_[i];
+                if (en.valid && en.dirty && en.blknum >= blknum
+                    && en.blknum < blknum + nblocks)
+                  {
+                    std::memcpy (p + (en.blknum - blknum) * bs, en.data, bs);
+                  }
+              }
+            return static_cast<ssize_t> (nblocks);
+          }
+
+        for (std::size_t n = 0; n < nblocks; ++n, p += bs)
+          {
+            entry_t* en = internal_find_ (blknum + n);
+            if (en != nullptr)
+              {
+                ++statistics_.hits;
+              }
+            else
+              {
+                ++statistics_.misses;
+
+                // At least the rest of the request.
+                en = internal_fill_ (
+                    blknum + n,
+                    (window > nblocks - n) ? window : (nblocks - n));
+                if (en == nullptr)
+                  {
+                    return -1;
+                  }
+              }
+
+            en->referenced = true;
+            std::memcpy (p, en->data, bs);
+          }
+
+        return static_cast<ssize_t> (nblocks);
+      }
+
+    template<typename T>
+      ssize_t
+      block_device_cached<T>::write_block (const void* buf, blknum_t blknum,
+                                           std::size_t nblocks)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+        OS_TRACE_PRINTF (posix_io_block_device,
+                         "block_device_cached::%s(%p, %u, %u) @%p\n", __func__,
+                         buf, blknum, nblocks, this);
+#endif
+
+        if (blknum + nblocks > blocks ())
+          {
+            errno = EINVAL;
+            return -1;
+          }
+
+        if (!is_opened ())
+          {
+            errno = EBADF; // Not opened.
+            return -1;
+          }
+
+        if (!internal_allocate_ ())
+          {
+            errno = ENOMEM;
+            return -1;
+          }
+
+        std::size_t bs = block_logical_size_bytes ();
+        const uint8_t* p = static_cast<const uint8_t*> (buf);
+
+        if (nblocks > count_ / 2 || direct (buf))
+          {
+            ++statistics_.bypasses;
+
+            ssize_t ret = block_device::write_block (buf, blknum, nblocks);
+            if (ret < 0)
+              {
+                return ret;
+              }
+
+            // Refresh the cached copies, now clean.
+            for (std::size_t i = 0; i < count_; ++i)
+              {
+                entry_t& en = entries_[i];
+                if (en.valid && en.blknum >= blknum
+                    && en.blknum < blknum + nblocks)
+                  {
+                    std::memcpy (en.data, p + (en.blknum - blknum) * bs, bs);
+                    en.dirty = false;
+                  }
+              }
+            return static_cast<ssize_t> (nblocks);
+          }
+
+        for (std::size_t n = 0; n < nblocks; ++n, p += bs)
+          {
+            entry_t* en = internal_find_ (blknum + n);
+            if (en != nullptr)
+              {
+                ++statistics_.hits;
+              }
+            else
+              {
+                ++statistics_.misses;
+
+                // The whole block is overwritten, no need to read it.
+                en = internal_victim_ ();
+                if (en == nullptr)
+                  {
+                    return -1;
+                  }
+                en->blknum = blknum + n;
+                en->valid = true;
+              }
+
+            en->referenced = true;
+            en->dirty = true;
+            std::memcpy (en->data, p, bs);
+          }
+
+        return static_cast<ssize_t> (nblocks);
+      }
+
+    /**
+     * @details
+     * The dirty blocks are written in the order of their block
+     * numbers, then the driver is asked to sync.
+     */
+    template<typename T>
+      void
+      block_device_cached<T>::sync (void)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+        OS_TRACE_PRINTF (posix_io_block_device,
+                         "block_device_cached::%s() @%p\n", __func__, this);
+#endif
+
+        if (entries_ != nullptr)
+          {
+            for (;;)
+              {
+                // The lowest dirty block number.
+                entry_t* first = nullptr;
+                for (std::size_t i = 0; i < count_; ++i)
+                  {
+                    entry_t& en = entries_[i];
+                    if (en.valid && en.dirty
+                        && (first == nullptr || en.blknum < first->blknum))
+                      {
+                        first = &en;
+                      }
+                  }
+
+                if (first == nullptr || internal_write_back_ (first) != 0)
+                  {
+                    break;
+                  }
+              }
+          }
+
+        block_device::sync ();
+      }
+
+    /**
+     * @details
+     * For `BLKDISCARD`, the cached copies of the range are
+     * dropped first.
+     */
+    template<typename T>
+      int
+      block_device_cached<T>::vioctl (int request, std::va_list args)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+        OS_TRACE_PRINTF (posix_io_block_device,
+                         "block_device_cached::%s(%d) @%p\n", __func__, request,
+                         this);
+#endif
+
+        if (static_cast<unsigned int> (request) == BLKDISCARD && is_opened ())
+          {
+            std::va_list again;
+            va_copy(again, args);
+            uint64_t* range = va_arg(again, uint64_t*);
+            va_end(again);
+
+            std::size_t bs = block_logical_size_bytes ();
+            if (range != nullptr && bs != 0)
+              {
+                internal_drop_ (
+                    static_cast<blknum_t> (range[0] / bs),
+                    static_cast<std::size_t> ((range[1] + bs - 1) / bs));
+              }
+          }
+
+        return block_device::vioctl (request, args);
+      }
+
+    /**
+     * @details
+     * The cached copies are dropped, even if dirty, then the
+     * driver is told.
+     */
+    template<typename T>
+      int
+      block_device_cached<T>::discard (blknum_t blknum, std::size_t nblocks)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+        OS_TRACE_PRINTF (posix_io_block_device,
+                         "block_device_cached::%s(%u, %u) @%p\n", __func__,
+                         blknum, nblocks, this);
+#endif
+
+        if (blknum + nblocks > blocks ())
+          {
+            errno = EINVAL;
+            return -1;
+          }
+
+        internal_drop_ (blknum, nblocks);
+
+        return block_device::discard (blknum, nblocks);
+      }
+
+    /**
+     * @details
+     * The access pattern is used by the read-ahead;
+     * `POSIX_FADV_WILLNEED` reads the range into the cache,
+     * up to half of its size, and `POSIX_FADV_DONTNEED` drops
+     * the clean blocks of the range.
+     */
+    template<typename T>
+      int
+      block_device_cached<T>::fadvise (off_t offset, off_t len, int advice)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+        OS_TRACE_PRINTF (posix_io_block_device,
+                         "block_device_cached::%s(%d, %d, %d) @%p\n", __func__,
+                         offset, len, advice, this);
+#endif
+
+        if (block_device::fadvise (offset, len, advice) != 0)
+          {
+            return -1;
+          }
+
+        std::size_t bs = block_logical_size_bytes ();
+        if (bs == 0 || entries_ == nullptr || offset < 0 || len < 0)
+          {
+            return 0;
+          }
+
+        blknum_t first = static_cast<std::size_t> (offset) / bs;
+        blknum_t end =
+            (len == 0) ?
+                blocks () :
+                (static_cast<std::size_t> (offset + len) + bs - 1) / bs;
+        if (end > blocks ())
+          {
+            end = blocks ();
+          }
+
+        if (advice == POSIX_FADV_WILLNEED)
+          {
+            for (blknum_t b = first; b < end && b < first + count_ / 2; ++b)
+              {
+                if (internal_find_ (b) == nullptr)
+                  {
+                    if (internal_fill_ (b, end - b) == nullptr)
+                      {
+                        return -1;
+                      }
+                    ++statistics_.prefetches;
+                  }
+              }
+          }
+        else if (advice == POSIX_FADV_DONTNEED)
+          {
+            for (std::size_t i = 0; i < count_; ++i)
+              {
+                entry_t& en = entries_[i];
+                if (en.valid && !en.dirty && en.blknum >= first
+                    && en.blknum < end)
+                  {
+                    en.valid = false;
+                  }
+              }
+          }
+
+        return 0;
+      }
+
+    template<typename T>
+      void
+      block_device_cached<T>::readahead (std::size_t nblocks)
+      {
+        readahead_ = (nblocks != 0) ? nblocks : 1;
+      }
+
+    template<typename T>
+      int
+      block_device_cached<T>::invalidate (void)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+        OS_TRACE_PRINTF (posix_io_block_device,
+                         "block_device_cached::%s() @%p\n", __func__, this);
+#endif
+
+        if (entries_ == nullptr)
+          {
+            return 0;
+          }
+
+        for (std::size_t i = 0; i < count_; ++i)
+          {
+            entry_t& en = entries_[i];
+            if (en.valid && en.dirty)
+              {
+                if (internal_write_back_ (&en) != 0)
+                  {
+                    return -1;
+                  }
+              }
+            en.valid = false;
+            en.referenced = false;
+          }
+        return 0;
+      }
+
+    template<typename T>
+      inline std::size_t
+      block_device_cached<T>::cached_blocks (void) const
+      {
+        return count_;
+      }
+
+    template<typename T>
+      void
+      block_device_cached<T>::statistics (statistics_t* stats) const
+      {
+        if (stats != nullptr)
+          {
+            *stats = statistics_;
+          }
+      }
+
+    template<typename T>
+      void
+      block_device_cached<T>::clear_statistics (void)
+      {
+        statistics_ = statistics_t
+          { };
+      }
+
+    template<typename T>
+      typename block_device_cached<T>::value_type&
+      block_device_cached<T>::impl (void) const
+      {
+        return static_cast<value_type&> (impl_);
+      }
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @cond ignore
+     */
+
+    template<typename T>
+      bool
+      block_device_cached<T>::internal_allocate_ (void)
+      {
+        if (entries_ != nullptr)
+          {
+            return true;
+          }
+
+        std::size_t bs = block_logical_size_bytes ();
+        if (bs == 0)
+          {
+            return false;
+          }
+
+        std::size_t bytes = count_ * (sizeof(entry_t) + bs);
+        void* mem = mr_->allocate (bytes);
+        if (mem == nullptr)
+          {
+            return false;
+          }
+
+        entries_ = static_cast<entry_t*> (mem);
+        allocated_bytes_ = bytes;
+
+        uint8_t* data = reinterpret_cast<uint8_t*> (entries_ + count_);
+        for (std::size_t i = 0; i < count_; ++i)
+          {
+            entries_[i] =
+              { 0, data + i * bs, false, false, false };
+          }
+        hand_ = 0;
+
+        return true;
+      }
+
+    template<typename T>
+      void
+      block_device_cached<T>::internal_free_ (void)
+      {
+        if (entries_ != nullptr)
+          {
+            mr_->deallocate (entries_, allocated_bytes_);
+            entries_ = nullptr;
+            allocated_bytes_ = 0;
+          }
+      }
+
+    // A linear search, the caches are small.
+    template<typename T>
+      void
+      block_device_cached<T>::internal_drop_ (blknum_t blknum,
+                                              std::size_t nblocks)
+      {
+        if (entries_ == nullptr)
+          {
+            return;
+          }
+
+        for (std::size_t i = 0; i < count_; ++i)
+          {
+            entry_t& en = entries_[i];
+            if (en.valid && en.blknum >= blknum
+                && en.blknum < blknum + nblocks)
+              {
+                en.valid = false;
+                en.dirty = false;
+                en.referenced = false;
+              }
+          }
+      }
+
+    template<typename T>
+      typename block_device_cached<T>::entry_t*
+      block_device_cached<T>::internal_find_ (blknum_t blknum)
+      {
+        for (std::size_t i = 0; i < count_; ++i)
+          {
+            if (entries_[i].valid && entries_[i].blknum == blknum)
+              {
+                return &entries_[i];
+              }
+          }
+        return nullptr;
+      }
+
+    // Advance the clock hand, giving a second chance to the entries
+    // referenced since the last pass; a dirty victim is written
+    // back first.
+    template<typename T>
+      typename block_device_cached<T>::entry_t*
+      block_device_cached<T>::internal_victim_ (void)
+      {
+        for (;;)
+          {
+            entry_t* en = &entries_[hand_];
+            hand_ = (hand_ + 1) % count_;
+
+            if (en->valid && en->referenced)
+              {
+                en->referenced = false;
+                continue;
+              }
+
+            if (en->valid && en->dirty)
+              {
+                if (internal_write_back_ (en) != 0)
+                  {
+                    return nullptr;
+                  }
+              }
+
+            en->valid = false;
+            return en;
+          }
+      }
+
+    // Read a run of blocks into consecutive entries, whose data
+    // buffers are adjacent, with a single driver request; the run
+    // starts at the victim and stops before the first entry
+    // referenced since the last pass, so the hot blocks are kept.
+    template<typename T>
+      typename block_device_cached<T>::entry_t*
+      block_device_cached<T>::internal_fill_ (blknum_t blknum,
+                                              std::size_t window)
+      {
+        entry_t* victim = internal_victim_ ();
+        if (victim == nullptr)
+          {
+            return nullptr;
+          }
+
+        std::size_t first = static_cast<std::size_t> (victim - entries_);
+        std::size_t run = 1;
+        while (run < window && first + run < count_
+            && blknum + run < blocks ())
+          {
+            entry_t* en = &entries_[first + run];
+            if (en->valid && en->referenced)
+              {
+                break;
+              }
+            if (internal_find_ (blknum + run) != nullptr)
+              {
+                // Already cached, possibly dirty.
+                break;
+              }
+            if (en->valid && en->dirty)
+              {
+                if (internal_write_back_ (en) != 0)
+                  {
+                    break;
+                  }
+              }
+            en->valid = false;
+            ++run;
+          }
+
+        if (block_device::read_block (victim->data, blknum, run) < 0)
+          {
+            return nullptr;
+          }
+
+        for (std::size_t i = 0; i < run; ++i)
+          {
+            entry_t& en = entries_[first + i];
+            en.blknum = blknum + i;
+            en.valid = true;
+            en.referenced = false;
+          }
+        statistics_.prefetches += run - 1;
+        hand_ = (first + run) % count_;
+
+        return victim;
+      }
+
+    template<typename T>
+      int
+      block_device_cached<T>::internal_write_back_ (entry_t* entry)
+      {
+        if (block_device::write_block (entry->data, entry->blknum, 1) < 0)
+          {
+            return -1;
+          }
+
+        ++statistics_.writebacks;
+        entry->dirty = false;
+        return 0;
+      }
+
+    /**
+     * @endcond
+     */
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_POSIX_IO_BLOCK_DEVICE_CACHED_H_ */
@@ -0,0 +1,405 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_POSIX_IO_BLOCK_DEVICE_FLASH_H_
+#define CMSIS_PLUS_POSIX_IO_BLOCK_DEVICE_FLASH_H_
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#include <cmsis-plus/posix-io/block-device.h>
+#include <cmsis-plus/rtos/os.h>
+
+#include <mutex>
+
+// ----------------------------------------------------------------------------
+
+#if !defined(OS_INTEGER_POSIX_IO_FLASH_STACK_SIZE_BYTES)
+#define OS_INTEGER_POSIX_IO_FLASH_STACK_SIZE_BYTES (2048)
+#endif
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Flash translation layer block device implementation.
+     * @headerfile block-device-flash.h <cmsis-plus/posix-io/block-device-flash.h>
+     * @ingroup cmsis-plus-posix-io-base
+     * @details
+     * Presents a raw flash, accessed through a parent block device
+     * whose blocks are the flash pages and whose `discard()` erases,
+     * as a block device that can be rewritten in place.
+     *
+     * The flash is divided in erase units of consecutive pages.
+     * The writes are log structured: each block is written to the
+     * next free page of the active unit, and the map from logical
+     * blocks to pages is updated. The last page of each unit holds
+     * a summary with the logical blocks of its pages, written
+     * when the unit is full, or by `sync()`; the map is rebuilt
+     * from the summaries when the device is opened. The blocks
+     * written after the last `sync()` may be lost on power failure.
+     *
+     * A background thread erases ahead the units with no valid
+     * pages, and keeps a reserve of erased units by relocating the
+     * valid pages of the units with the fewest of them (garbage
+     * collection), so the writes seldom wait for an erase. The units
+     * released are not erased until the pages moved out of them are
+     * summarised.
+     *
+     * For wear levelling, the erased unit with the lowest erase
+     * count is used next, and the data of the least erased unit
+     * is moved when the difference to the most erased one
+     * exceeds `wear_threshold`, so the units holding static data
+     * also take their share of erases.
+     *
+     * The blocks discarded by the file system are released
+     * immediately, and are read as zeros, like the blocks never
+     * written.
+     *
+     * The parent device is accessed both by the callers and by
+     * the background thread, so it must be protected by a lock
+     * (for example a `block_device_lockable`).
+     */
+    class block_device_flash_impl : public block_device_impl
+    {
+      // ----------------------------------------------------------------------
+
+    public:
+
+      /**
+       * @brief Flash translation layer statistics.
+       */
+      struct statistics_t
+      {
+        /**
+         * @brief Number of units erased.
+         */
+        std::size_t erases;
+
+        /**
+         * @brief Number of erases the writers had to wait for.
+         */
+        std::size_t foreground_erases;
+
+        /**
+         * @brief Number of valid pages moved by the garbage collection.
+         */
+        std::size_t relocations;
+
+        /**
+         * @brief Number of units moved for wear levelling.
+         */
+        std::size_t wear_relocations;
+
+        /**
+         * @brief Number of units which failed to erase.
+         */
+        std::size_t bad_units;
+      };
+
+      /**
+       * @brief Maximum difference between the erase counts.
+       */
+      static constexpr uint32_t wear_threshold = 32;
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      /**
+       * @brief Construct a flash translation layer.
+       * @param [in] parent Reference to the raw flash device.
+       * @param [in] unit_pages The number of pages in an erase unit.
+       * @param [in] spare_units The number of units not exposed,
+       *  for the garbage collection; at least 2.
+       * @param [in] mr Pointer to the memory resource for the maps;
+       *  `nullptr` for the default resource.
+       */
+      block_device_flash_impl (block_device& parent, std::size_t unit_pages,
+                               std::size_t spare_units = 2,
+                               rtos::memory::memory_resource* mr = nullptr);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      block_device_flash_impl (const block_device_flash_impl&) = delete;
+      block_device_flash_impl (block_device_flash_impl&&) = delete;
+      block_device_flash_impl&
+      operator= (const block_device_flash_impl&) = delete;
+      block_device_flash_impl&
+      operator= (block_device_flash_impl&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      virtual
+      ~block_device_flash_impl () override;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      virtual int
+      do_vioctl (int request, std::va_list args) override;
+
+      virtual int
+      do_vopen (const char* path, int oflag, std::va_list args) override;
+
+      virtual ssize_t
+      do_read_block (void* buf, blknum_t blknum, std::size_t nblocks) override;
+
+      virtual ssize_t
+      do_write_block (const void* buf, blknum_t blknum, std::size_t nblocks)
+          override;
+
+      virtual int
+      do_discard (blknum_t blknum, std::size_t nblocks) override;
+
+      virtual void
+      do_sync (void) override;
+
+      virtual int
+      do_close (void) override;
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @brief Get the statistics.
+       * @par Parameters
+       *  None.
+       * @return A reference to the counters.
+       */
+      const statistics_t&
+      statistics (void) const;
+
+      /**
+       * @brief Get the number of erased units.
+       * @par Parameters
+       *  None.
+       * @return The number of units ready to be written.
+       */
+      std::size_t
+      erased_units (void);
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      // The retired units are full and have no valid pages, but
+      // are not erased until the pages moved out are summarised.
+      struct unit_state
+      {
+        enum
+          : uint8_t
+            {
+              dirty = 0,
+            erasing = 1,
+            erased = 2,
+            active = 3,
+            full = 4,
+            retired = 5,
+            bad = 6
+        };
+      };
+
+      struct unit_t
+      {
+        uint32_t erase_count;
+        uint16_t valid;
+        uint16_t next;
+        uint8_t state;
+      };
+
+      static void*
+      internal_thread_ (void* args);
+
+      bool
+      internal_background_step_ (void);
+
+      int
+      internal_mount_ (void);
+
+      ssize_t
+      internal_program_ (const void* buf, blknum_t blknum,
+                         std::size_t nblocks, bool gc);
+
+      blknum_t
+      internal_allocate_page_ (bool gc);
+
+      int
+      internal_close_active_ (void);
+
+      void
+      internal_invalidate_ (blknum_t blknum);
+
+      int
+      internal_relocate_page_ (blknum_t page);
+
+      int
+      internal_relocate_unit_ (std::size_t unit);
+
+      void
+      internal_erase_ (std::size_t unit);
+
+      void
+      internal_erased_ (std::size_t unit, int result);
+
+      std::size_t
+      internal_find_ (uint8_t state);
+
+      std::size_t
+      internal_count_ (uint8_t state);
+
+      std::size_t
+      internal_victim_ (void);
+
+      std::size_t
+      internal_cold_unit_ (void);
+
+      void
+      internal_free_ (void);
+
+      /**
+       * @endcond
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      block_device& parent_;
+      rtos::memory::memory_resource* mr_;
+      std::size_t unit_pages_;
+      std::size_t spare_units_;
+      std::size_t num_units_ = 0;
+
+      // Allocated on the first open.
+      uint32_t* map_ = nullptr;
+      uint32_t* owner_ = nullptr;
+      unit_t* units_ = nullptr;
+      uint8_t* copy_buffer_ = nullptr;
+      uint8_t* summary_buffer_ = nullptr;
+
+      std::size_t active_;
+      uint64_t sequence_ = 0;
+      bool mounted_ = false;
+      bool stop_ = false;
+
+      statistics_t statistics_
+        { };
+
+      // Protects the maps; the erases are done without it,
+      // under the erase mutex.
+      rtos::mutex mutex_
+        { "flash" };
+      rtos::mutex erase_mutex_
+        { "flash-erase" };
+      rtos::semaphore_binary wakeup_
+        { "flash", 0 };
+
+      // Constructed last, it uses the members above.
+      rtos::thread_inclusive<OS_INTEGER_POSIX_IO_FLASH_STACK_SIZE_BYTES> //
+      thread_;
+
+      /**
+       * @endcond
+       */
+    };
+
+#pragma GCC diagnostic pop
+
+    /**
+     * @brief Flash translation layer block device.
+     * @ingroup cmsis-plus-posix-io-base
+     */
+    using block_device_flash =
+    block_device_implementable<block_device_flash_impl>;
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    inline const block_device_flash_impl::statistics_t&
+    block_device_flash_impl::statistics (void) const
+    {
+      return statistics_;
+    }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_POSIX_IO_BLOCK_DEVICE_FLASH_H_ */
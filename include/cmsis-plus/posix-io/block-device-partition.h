@@ -179,6 +179,9 @@ namespace os
       do_write_block (const void* buf, blknum_t blknum, std::size_t nblocks)
           override;
 
+      virtual int
+      do_discard (blknum_t blknum, std::size_t nblocks) override;
+
       virtual void
       do_sync (void) override;
 
@@ -363,6 +366,9 @@ namespace os
         write_block (const void* buf, blknum_t blknum, std::size_t nblocks = 1)
             override;
 
+        virtual int
+        discard (blknum_t blknum, std::size_t nblocks = 1) override;
+
         // --------------------------------------------------------------------
         // Support functions.
 
@@ -432,9 +438,9 @@ namespace os
               { parent, std::forward<Args>(args)... }
         {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
-          trace::printf (
-              "block_device_partition_implementable::%s(\"%s\")=@%p\n",
-              __func__, name_, this);
+          OS_TRACE_PRINTF (posix_io_block_device,
+                           "block_device_partition_implementable::%s(\"%s\")=@%p\n",
+                           __func__, name_, this);
 #endif
         }
 
@@ -442,8 +448,9 @@ namespace os
       block_device_partition_implementable<T>::~block_device_partition_implementable ()
       {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
-        trace::printf ("block_device_partition_implementable::%s() @%p %s\n",
-                       __func__, this, name_);
+        OS_TRACE_PRINTF (posix_io_block_device,
+                         "block_device_partition_implementable::%s() @%p %s\n",
+                         __func__, this, name_);
 #endif
       }
 
@@ -468,8 +475,9 @@ namespace os
             locker_ (locker)
         {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
-          trace::printf ("block_device_partition_lockable::%s(\"%s\")=@%p\n",
-                         __func__, name_, this);
+          OS_TRACE_PRINTF (posix_io_block_device,
+                           "block_device_partition_lockable::%s(\"%s\")=@%p\n",
+                           __func__, name_, this);
 #endif
 
         }
@@ -478,8 +486,9 @@ namespace os
       block_device_partition_lockable<T, L>::~block_device_partition_lockable ()
       {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
-        trace::printf ("block_device_partition_lockable::%s() @%p %s\n",
-                       __func__, this, name_);
+        OS_TRACE_PRINTF (posix_io_block_device,
+                         "block_device_partition_lockable::%s() @%p %s\n",
+                         __func__, this, name_);
 #endif
       }
 
@@ -491,8 +500,9 @@ namespace os
                                                      std::va_list args)
       {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
-        trace::printf ("block_device_partition_lockable::%s(%d) @%p\n",
-                       __func__, request, this);
+        OS_TRACE_PRINTF (posix_io_block_device,
+                         "block_device_partition_lockable::%s(%d) @%p\n",
+                         __func__, request, this);
 #endif
 
         std::lock_guard<L> lock
@@ -508,8 +518,9 @@ namespace os
                                                          std::size_t nblocks)
       {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
-        trace::printf ("block_device_partition_lockable::%s(%p, %u, %u) @%p\n",
-                       __func__, buf, blknum, nblocks, this);
+        OS_TRACE_PRINTF (posix_io_block_device,
+                         "block_device_partition_lockable::%s(%p, %u, %u) @%p\n",
+                         __func__, buf, blknum, nblocks, this);
 #endif
 
         std::lock_guard<L> lock
@@ -525,8 +536,9 @@ namespace os
                                                           std::size_t nblocks)
       {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
-        trace::printf ("block_device_partition_lockable::%s(%p, %u, %u) @%p\n",
-                       __func__, buf, blknum, nblocks, this);
+        OS_TRACE_PRINTF (posix_io_block_device,
+                         "block_device_partition_lockable::%s(%p, %u, %u) @%p\n",
+                         __func__, buf, blknum, nblocks, this);
 #endif
 
         std::lock_guard<L> lock
@@ -535,6 +547,23 @@ namespace os
         return block_device_partition::write_block (buf, blknum, nblocks);
       }
 
+    template<typename T, typename L>
+      int
+      block_device_partition_lockable<T, L>::discard (blknum_t blknum,
+                                                      std::size_t nblocks)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
+        OS_TRACE_PRINTF (posix_io_block_device,
+                         "block_device_partition_lockable::%s(%u, %u) @%p\n",
+                         __func__, blknum, nblocks, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_partition::discard (blknum, nblocks);
+      }
+
     template<typename T, typename L>
       typename block_device_partition_lockable<T, L>::value_type&
       block_device_partition_lockable<T, L>::impl (void) const
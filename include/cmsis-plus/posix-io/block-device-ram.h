@@ -0,0 +1,240 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_POSIX_IO_BLOCK_DEVICE_RAM_H_
+#define CMSIS_PLUS_POSIX_IO_BLOCK_DEVICE_RAM_H_
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#include <cmsis-plus/posix-io/block-device.h>
+#include <cmsis-plus/rtos/os.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief RAM disk block device implementation.
+     * @headerfile block-device-ram.h <cmsis-plus/posix-io/block-device-ram.h>
+     * @ingroup cmsis-plus-posix-io-base
+     * @details
+     * The blocks are kept in memory allocated from a memory
+     * resource, in chunks of consecutive blocks. A chunk is
+     * allocated when one of its blocks is first written, or
+     * mapped, so the unused parts of the device take no memory;
+     * the blocks never written read as zeros.
+     *
+     * Discarding all blocks of a chunk returns its memory to the
+     * resource; the blocks discarded from a partially discarded
+     * chunk are cleared.
+     *
+     * `mmap()` returns a pointer inside a chunk, without copying,
+     * so the mapped range must be inside one chunk; with a single
+     * chunk, the whole device can be mapped.
+     *
+     * The content is kept when the device is closed, and is lost
+     * when the object is destroyed.
+     */
+    class block_device_ram_impl : public block_device_impl
+    {
+      // ----------------------------------------------------------------------
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      /**
+       * @brief Construct a RAM disk.
+       * @param [in] block_size_bytes The size of a block.
+       * @param [in] nblocks The number of blocks.
+       * @param [in] chunk_blocks The number of blocks allocated
+       *  together; 0 for a single chunk.
+       * @param [in] mr Pointer to the memory resource; `nullptr`
+       *  for the default resource.
+       */
+      block_device_ram_impl (std::size_t block_size_bytes, blknum_t nblocks,
+                             std::size_t chunk_blocks = 1,
+                             rtos::memory::memory_resource* mr = nullptr);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      block_device_ram_impl (const block_device_ram_impl&) = delete;
+      block_device_ram_impl (block_device_ram_impl&&) = delete;
+      block_device_ram_impl&
+      operator= (const block_device_ram_impl&) = delete;
+      block_device_ram_impl&
+      operator= (block_device_ram_impl&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      virtual
+      ~block_device_ram_impl () override;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      virtual int
+      do_vioctl (int request, std::va_list args) override;
+
+      virtual int
+      do_vopen (const char* path, int oflag, std::va_list args) override;
+
+      virtual ssize_t
+      do_read_block (void* buf, blknum_t blknum, std::size_t nblocks) override;
+
+      virtual ssize_t
+      do_write_block (const void* buf, blknum_t blknum, std::size_t nblocks)
+          override;
+
+      virtual int
+      do_discard (blknum_t blknum, std::size_t nblocks) override;
+
+      virtual void*
+      do_mmap (std::size_t length, int prot, int flags, off_t offset)
+          override;
+
+      virtual void
+      do_sync (void) override;
+
+      virtual int
+      do_close (void) override;
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @brief Get the memory used by the chunks.
+       * @par Parameters
+       *  None.
+       * @return The number of bytes allocated from the resource.
+       */
+      std::size_t
+      allocated_bytes (void) const;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      uint8_t*
+      internal_chunk_ (std::size_t index, bool allocate);
+
+      void
+      internal_free_ (void);
+
+      /**
+       * @endcond
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      rtos::memory::memory_resource* mr_;
+      std::size_t chunk_blocks_;
+      std::size_t chunk_size_bytes_;
+      std::size_t num_chunks_;
+      // Allocated on the first open.
+      uint8_t** chunks_ = nullptr;
+      std::size_t allocated_chunks_ = 0;
+
+      /**
+       * @endcond
+       */
+    };
+
+#pragma GCC diagnostic pop
+
+    /**
+     * @brief RAM disk block device.
+     * @ingroup cmsis-plus-posix-io-base
+     */
+    using block_device_ram = block_device_implementable<block_device_ram_impl>;
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    inline std::size_t
+    block_device_ram_impl::allocated_bytes (void) const
+    {
+      return allocated_chunks_ * chunk_size_bytes_;
+    }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_POSIX_IO_BLOCK_DEVICE_RAM_H_ */
@@ -40,6 +40,12 @@
 
 // ----------------------------------------------------------------------------
 
+#if !defined(OS_INTEGER_POSIX_IO_DIRECT_ALIGNMENT)
+#define OS_INTEGER_POSIX_IO_DIRECT_ALIGNMENT (4)
+#endif
+
+// ----------------------------------------------------------------------------
+
 namespace os
 {
   namespace posix
@@ -66,6 +72,150 @@ namespace os
 
       using blknum_t = std::size_t;
 
+      using policy_t = uint8_t;
+
+      /**
+       * @brief Requests queue policies.
+       */
+      struct policy
+      {
+        enum
+          : policy_t
+            {
+              /**
+               * @brief In the order of arrival.
+               */
+              fifo = 0,
+          /**
+           * @brief By priority and block number, adjacent requests merged.
+           * @details
+           * Overlapping asynchronous requests are not kept in order.
+           */
+          elevator = 1
+        };
+      }; /* struct policy */
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+      /**
+       * @brief Asynchronous transfer request.
+       * @headerfile block-device.h <cmsis-plus/posix-io/block-device.h>
+       * @details
+       * The request is owned by the caller, and must not be changed
+       * or destroyed until it is completed or cancelled.
+       */
+      class request
+      {
+        // --------------------------------------------------------------------
+
+        friend class block_device;
+        friend class block_device_impl;
+
+      public:
+
+        /**
+         * @brief Type of the completion callback.
+         * @details
+         * With devices able to transfer asynchronously, the callback
+         * is invoked from the completion interrupt.
+         */
+        using callback_t = void (*) (request* req, void* arg);
+
+        using state_t = uint8_t;
+
+        /**
+         * @brief Request states.
+         */
+        struct state
+        {
+          enum
+            : state_t
+              {
+                idle = 0,
+            queued = 1,
+            active = 2,
+            done = 3
+          };
+        }; /* struct state */
+
+        // --------------------------------------------------------------------
+
+        request (void) = default;
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        request (const request&) = delete;
+        request (request&&) = delete;
+        request&
+        operator= (const request&) = delete;
+        request&
+        operator= (request&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        ~request () = default;
+
+        // --------------------------------------------------------------------
+
+        /**
+         * @brief Get the request state.
+         * @par Parameters
+         *  None.
+         * @return The current state.
+         */
+        state_t
+        get_state (void) const;
+
+        /**
+         * @brief Check if the request was completed or cancelled.
+         * @par Parameters
+         *  None.
+         * @retval true The results are available.
+         * @retval false The request is still in the queue.
+         */
+        bool
+        done (void) const;
+
+        // --------------------------------------------------------------------
+
+        // Prepared by the caller.
+        void* buffer = nullptr;
+        blknum_t blknum = 0;
+        std::size_t nblocks = 0;
+        bool is_write = false;
+        // Used by the elevator, higher values first.
+        uint8_t priority = 0;
+        callback_t callback = nullptr;
+        void* arg = nullptr;
+
+        // Set on completion; the number of blocks transferred or -1,
+        // and the error code.
+        ssize_t result = 0;
+        int error = 0;
+
+        // --------------------------------------------------------------------
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        request* next_ = nullptr;
+        volatile state_t state_ = state::idle;
+
+        /**
+         * @endcond
+         */
+      };
+
+#pragma GCC diagnostic pop
+
       // ----------------------------------------------------------------------
 
       /**
@@ -117,6 +267,183 @@ namespace os
       virtual ssize_t
       write_block (const void* buf, blknum_t blknum, std::size_t nblocks = 1);
 
+      /**
+       * @brief Tell the device the content of some blocks is no longer
+       *  needed.
+       * @param [in] blknum The first block.
+       * @param [in] nblocks The number of blocks.
+       * @retval 0 The blocks were discarded.
+       * @retval -1 The blocks were not discarded; `errno` is
+       *  ENOTSUP if the device does not support it.
+       * @details
+       * Subsequent reads of the blocks return undefined content.
+       */
+      virtual int
+      discard (blknum_t blknum, std::size_t nblocks = 1);
+
+      /**
+       * @brief Declare the expected access pattern.
+       * @param [in] offset Start of the range, in bytes.
+       * @param [in] len Length of the range, in bytes; 0 up to the end.
+       * @param [in] advice One of the `POSIX_FADV_*` values.
+       * @retval 0 The advice was recorded.
+       * @retval -1 The advice is not valid.
+       */
+      virtual int
+      fadvise (off_t offset, off_t len, int advice);
+
+      /**
+       * @brief Queue an asynchronous transfer.
+       * @param [in] req Reference to the request.
+       * @retval 0 The request was queued; the callback will be invoked
+       *  when done, possibly before this function returns.
+       * @retval -1 The request was not queued, the callback will not be
+       *  invoked; `errno` is EBADF, EINVAL, EBUSY or EAGAIN if the
+       *  queue is full.
+       */
+      virtual int
+      submit (request& req);
+
+      /**
+       * @brief Cancel an asynchronous transfer.
+       * @param [in] req Reference to the request.
+       * @retval 0 The request was completed with ECANCELED.
+       * @retval -1 The request was not cancelled; `errno` is EBUSY if it
+       *  is in progress and cannot be aborted, ENOENT if not queued.
+       */
+      int
+      cancel (request& req);
+
+      /**
+       * @brief Queue a transfer and wait for it.
+       * @param [in] req Reference to the request; the completion
+       *  callback is not used.
+       * @return The number of blocks transferred, or -1 with
+       *  `errno` set.
+       */
+      ssize_t
+      transfer (request& req);
+
+      /**
+       * @brief Set the maximum number of requests in the queue.
+       * @param [in] n The new limit, at least 1.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      queue_size (std::size_t n);
+
+      /**
+       * @brief Get the maximum number of requests in the queue.
+       * @par Parameters
+       *  None.
+       * @return The current limit.
+       */
+      std::size_t
+      queue_size (void) const;
+
+      /**
+       * @brief Get the number of requests in the queue.
+       * @par Parameters
+       *  None.
+       * @return The number of requests queued, including the active one.
+       */
+      std::size_t
+      queued (void) const;
+
+      /**
+       * @brief Set the requests queue policy.
+       * @param [in] p One of the `policy` values.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      queue_policy (policy_t p);
+
+      /**
+       * @brief Get the requests queue policy.
+       * @par Parameters
+       *  None.
+       * @return One of the `policy` values.
+       */
+      policy_t
+      queue_policy (void) const;
+
+      /**
+       * @brief Set the buffer used to merge requests.
+       * @param [in] buf Pointer to the buffer, or `nullptr`.
+       * @param [in] size_bytes The buffer size.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      merge_buffer (void* buf, std::size_t size_bytes);
+
+      /**
+       * @brief Get the access pattern.
+       * @par Parameters
+       *  None.
+       * @return The last `POSIX_FADV_NORMAL`, `POSIX_FADV_RANDOM`
+       *  or `POSIX_FADV_SEQUENTIAL` advice.
+       */
+      int
+      advice (void) const;
+
+      /**
+       * @brief Check if the driver serves concurrent reads.
+       * @par Parameters
+       *  None.
+       * @retval true The driver can serve `read_block()` calls from
+       *  several threads at the same time.
+       * @retval false The driver calls must be serialised.
+       */
+      bool
+      concurrent_reads (void) const;
+
+      /**
+       * @brief Check if the driver transfers asynchronously.
+       * @par Parameters
+       *  None.
+       * @retval true `submit()` returns before the transfer is done,
+       *  the completion is signalled later, usually from an interrupt.
+       * @retval false `submit()` performs the transfer synchronously.
+       */
+      bool
+      asynchronous (void) const;
+
+      /**
+       * @brief Request the next transfers to bypass the caches.
+       * @param [in] enable `true` for direct transfers.
+       * @par Returns
+       *  Nothing.
+       * @details
+       * Set by the files opened with `O_DIRECT` before each
+       * transfer, like the access pattern.
+       */
+      void
+      direct (bool enable);
+
+      /**
+       * @brief Check if the transfers bypass the caches.
+       * @par Parameters
+       *  None.
+       * @retval true The device was opened with `O_DIRECT`, or
+       *  the direct transfers were requested.
+       * @retval false The transfers use the caches.
+       */
+      bool
+      direct (void) const;
+
+      /**
+       * @brief Check if a buffer can be used for direct transfers.
+       * @param [in] buf Pointer to the buffer.
+       * @retval true The direct transfers are requested and the
+       *  buffer is aligned to `OS_INTEGER_POSIX_IO_DIRECT_ALIGNMENT`.
+       * @retval false The transfer must use the caches.
+       */
+      bool
+      direct (const void* buf) const;
+
       // ----------------------------------------------------------------------
 
       /**
@@ -147,6 +474,17 @@ namespace os
        */
 
       // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      int advice_ = POSIX_FADV_NORMAL;
+
+      /**
+       * @endcond
+       */
     };
 
     // ========================================================================
@@ -163,6 +501,7 @@ namespace os
     public:
 
       using blknum_t = block_device::blknum_t;
+      using request = block_device::request;
 
       // ----------------------------------------------------------------------
 
@@ -215,6 +554,22 @@ namespace os
       virtual off_t
       do_lseek (off_t offset, int whence) override;
 
+      virtual ssize_t
+      do_readv (const struct iovec* iov, int iovcnt) override;
+
+      virtual ssize_t
+      do_writev (const struct iovec* iov, int iovcnt) override;
+
+      virtual ssize_t
+      do_preadv (const struct iovec* iov, int iovcnt, off_t offset) override;
+
+      virtual ssize_t
+      do_pwritev (const struct iovec* iov, int iovcnt, off_t offset) override;
+
+      virtual void*
+      do_mmap (std::size_t length, int prot, int flags, off_t offset)
+          override;
+
       virtual ssize_t
       do_read_block (void* buf, blknum_t blknum, std::size_t nblocks) = 0;
 
@@ -222,6 +577,65 @@ namespace os
       do_write_block (const void* buf, blknum_t blknum,
                       std::size_t nblocks) = 0;
 
+      /**
+       * @brief Discard blocks, for example erase them in advance.
+       * @retval 0 The blocks were discarded.
+       * @retval -1 With `errno` ENOTSUP (the default) if not supported.
+       */
+      virtual int
+      do_discard (blknum_t blknum, std::size_t nblocks);
+
+      /**
+       * @brief Start an asynchronous transfer.
+       * @param [in] req Reference to the request, the head of the queue.
+       * @retval 0 The transfer was started; the driver must call
+       *  `complete_request()` when done.
+       * @retval -1 The transfer was not started; with `errno` ENOTSUP
+       *  it is performed synchronously with `do_read_block()` or
+       *  `do_write_block()`.
+       */
+      virtual int
+      do_start_request (request& req);
+
+      /**
+       * @brief Abort the transfer in progress.
+       * @param [in] req Reference to the active request.
+       * @retval true The transfer was stopped, and will not be completed
+       *  by the driver.
+       * @retval false The transfer cannot be aborted.
+       */
+      virtual bool
+      do_abort_request (request& req);
+
+      // ----------------------------------------------------------------------
+      // Support functions, for the drivers.
+
+      /**
+       * @brief Complete the active request and start the next one.
+       * @param [in] result The number of blocks transferred, or -1.
+       * @param [in] error The error code, if the result is -1.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      complete_request (ssize_t result, int error = 0);
+
+      /**
+       * @brief Queue a transfer and wait for it.
+       * @param [in] buf Pointer to the buffer.
+       * @param [in] blknum The first block.
+       * @param [in] nblocks The number of blocks.
+       * @param [in] is_write True for writes.
+       * @return The number of blocks transferred, or -1 with
+       *  `errno` set.
+       * @details
+       * To be used by the asynchronous drivers to implement
+       * `do_read_block()` and `do_write_block()`.
+       */
+      ssize_t
+      transfer_request (void* buf, blknum_t blknum, std::size_t nblocks,
+                        bool is_write);
+
       /**
        * @}
        */
@@ -229,6 +643,62 @@ namespace os
       // ----------------------------------------------------------------------
     protected:
 
+      /**
+       * @cond ignore
+       */
+
+      ssize_t
+      internal_transfer_vector_ (const struct iovec* iov, int iovcnt,
+                                 off_t offset, bool is_write);
+
+      ssize_t
+      internal_io_ (void* buf, blknum_t blknum, std::size_t nblocks,
+                    bool is_write);
+
+      int
+      internal_submit_ (request& req, bool bounded);
+
+      void
+      internal_dispatch_ (void);
+
+      request*
+      internal_select_ (void);
+
+      bool
+      internal_precedes_ (const request& a, const request& b) const;
+
+      void
+      internal_unlink_pending_ (request& req);
+
+      void
+      internal_finish_ (request* req, ssize_t result, int error);
+
+      int
+      internal_cancel_ (request& req);
+
+      ssize_t
+      internal_transfer_bytes_ (void* buf, std::size_t nbyte, off_t offset,
+                                bool is_write);
+
+      uint8_t*
+      internal_bounce_buffer_ (void);
+
+      void
+      internal_free_bounce_buffer_ (void);
+
+      void
+      internal_cache_before_ (void* buf, std::size_t nblocks, bool is_write);
+
+      void
+      internal_cache_after_ (void* buf, std::size_t nblocks, bool is_write);
+
+      /**
+       * @endcond
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
       /**
        * @cond ignore
        */
@@ -239,6 +709,52 @@ namespace os
 
       blknum_t num_blocks_ = 0;
 
+      // The requests waiting, and the one in progress; when merged,
+      // the batch is in progress, with the list of merged requests.
+      request* pending_head_ = nullptr;
+      request* pending_tail_ = nullptr;
+      request* active_ = nullptr;
+      request* batch_first_ = nullptr;
+      request batch_;
+      std::size_t queued_ = 0;
+      std::size_t queue_size_ = 4;
+
+      // The elevator position, after the last block started.
+      blknum_t head_blknum_ = 0;
+      uint8_t* merge_buffer_ = nullptr;
+      std::size_t merge_size_bytes_ = 0;
+      block_device::policy_t policy_ = block_device::policy::fifo;
+
+      // One block, for the unaligned parts of the transfers.
+      uint8_t* bounce_ = nullptr;
+      std::size_t bounce_size_bytes_ = 0;
+
+      // Set by the implementations of devices with storage mapped
+      // in the address space (XIP flash, RAM disks), to be
+      // returned by mmap().
+      void* storage_ = nullptr;
+      bool storage_writable_ = false;
+
+      // Set by the implementations of drivers that can serve
+      // do_read_block() from several threads at the same time
+      // (or queue the reads internally); the lockable device then
+      // takes its lock in shared mode for the block reads.
+      bool concurrent_reads_ = false;
+
+      // Set by the implementations of drivers that start the
+      // transfers in do_start_request() and complete them later;
+      // asynchronous I/O then submits the requests directly.
+      bool asynchronous_ = false;
+
+      // Set by block_device::direct(), the transfers of the
+      // files opened with O_DIRECT bypass the caches.
+      bool direct_ = false;
+
+      // Set by the implementations of drivers that transfer with
+      // DMA; the data cache is then maintained for the buffers
+      // around do_read_block(), do_write_block() and the requests.
+      bool dma_ = false;
+
       /**
        * @endcond
        */
@@ -326,6 +842,18 @@ namespace os
 
     // ========================================================================
 
+    /**
+     * @brief Block device with locking.
+     * @headerfile block-device.h <cmsis-plus/posix-io/block-device.h>
+     * @ingroup cmsis-plus-posix-io-base
+     * @details
+     * All operations take the lock in exclusive mode, except
+     * `read_block()` on drivers with concurrent reads
+     * (see `concurrent_reads()`), which takes it in shared
+     * mode when the lockable supports it (like `rtos::rwlock`);
+     * the block reads of different threads then run in parallel,
+     * while the writes remain exclusive.
+     */
     template<typename T, typename L>
       class block_device_lockable : public block_device
       {
@@ -392,6 +920,15 @@ namespace os
         virtual ssize_t
         writev (const struct iovec* iov, int iovcnt) override;
 
+        virtual ssize_t
+        readv (const struct iovec* iov, int iovcnt) override;
+
+        virtual ssize_t
+        preadv (const struct iovec* iov, int iovcnt, off_t offset) override;
+
+        virtual ssize_t
+        pwritev (const struct iovec* iov, int iovcnt, off_t offset) override;
+
         virtual int
         vfcntl (int cmd, std::va_list args) override;
 
@@ -409,9 +946,15 @@ namespace os
         write_block (const void* buf, blknum_t blknum, std::size_t nblocks = 1)
             override;
 
+        virtual int
+        discard (blknum_t blknum, std::size_t nblocks = 1) override;
+
         virtual void
         sync (void) override;
 
+        virtual int
+        fadvise (off_t offset, off_t len, int advice) override;
+
         // --------------------------------------------------------------------
         // Support functions.
 
@@ -474,6 +1017,74 @@ namespace os
       return static_cast<block_device_impl&> (impl_);
     }
 
+    inline block_device::request::state_t
+    block_device::request::get_state (void) const
+    {
+      return state_;
+    }
+
+    inline bool
+    block_device::request::done (void) const
+    {
+      return state_ == state::done;
+    }
+
+    inline std::size_t
+    block_device::queue_size (void) const
+    {
+      return impl ().queue_size_;
+    }
+
+    inline std::size_t
+    block_device::queued (void) const
+    {
+      return impl ().queued_;
+    }
+
+    inline block_device::policy_t
+    block_device::queue_policy (void) const
+    {
+      return impl ().policy_;
+    }
+
+    inline int
+    block_device::advice (void) const
+    {
+      return advice_;
+    }
+
+    inline bool
+    block_device::concurrent_reads (void) const
+    {
+      return impl ().concurrent_reads_;
+    }
+
+    inline bool
+    block_device::asynchronous (void) const
+    {
+      return impl ().asynchronous_;
+    }
+
+    inline void
+    block_device::direct (bool enable)
+    {
+      impl ().direct_ = enable;
+    }
+
+    inline bool
+    block_device::direct (void) const
+    {
+      return impl ().direct_ || ((impl ().status_flags () & O_DIRECT) != 0);
+    }
+
+    inline bool
+    block_device::direct (const void* buf) const
+    {
+      return direct ()
+          && (reinterpret_cast<uintptr_t> (buf)
+              % OS_INTEGER_POSIX_IO_DIRECT_ALIGNMENT) == 0;
+    }
+
     // ========================================================================
 
     template<typename T>
@@ -486,8 +1097,9 @@ namespace os
               { std::forward<Args>(args)... }
         {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-          trace::printf ("block_device_implementable::%s(\"%s\")=@%p\n",
-                         __func__, name_, this);
+          OS_TRACE_PRINTF (posix_io_block_device,
+                           "block_device_implementable::%s(\"%s\")=@%p\n",
+                           __func__, name_, this);
 #endif
         }
 
@@ -495,8 +1107,9 @@ namespace os
       block_device_implementable<T>::~block_device_implementable ()
       {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-        trace::printf ("block_device_implementable::%s() @%p %s\n", __func__,
-                       this, name_);
+        OS_TRACE_PRINTF (posix_io_block_device,
+                         "block_device_implementable::%s() @%p %s\n", __func__,
+                         this, name_);
 #endif
       }
 
@@ -520,8 +1133,9 @@ namespace os
             locker_ (locker)
         {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-          trace::printf ("block_device_lockable::%s(\"%s\")=@%p\n", __func__,
-                         name_, this);
+          OS_TRACE_PRINTF (posix_io_block_device,
+                           "block_device_lockable::%s(\"%s\")=@%p\n", __func__,
+                           name_, this);
 #endif
         }
 
@@ -529,8 +1143,9 @@ namespace os
       block_device_lockable<T, L>::~block_device_lockable ()
       {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-        trace::printf ("block_device_lockable::%s() @%p %s\n", __func__, this,
-                       name_);
+        OS_TRACE_PRINTF (posix_io_block_device,
+                         "block_device_lockable::%s() @%p %s\n", __func__, this,
+                         name_);
 #endif
       }
 
@@ -541,7 +1156,8 @@ namespace os
       block_device_lockable<T, L>::close (void)
       {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-        trace::printf ("block_device_lockable::%s() @%p\n", __func__, this);
+        OS_TRACE_PRINTF (posix_io_block_device,
+                         "block_device_lockable::%s() @%p\n", __func__, this);
 #endif
 
         std::lock_guard<L> lock
@@ -555,8 +1171,9 @@ namespace os
       block_device_lockable<T, L>::read (void* buf, std::size_t nbyte)
       {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-        trace::printf ("block_device_lockable::%s(0x0%X, %u) @%p\n", __func__,
-                       buf, nbyte, this);
+        OS_TRACE_PRINTF (posix_io_block_device,
+                         "block_device_lockable::%s(0x0%X, %u) @%p\n", __func__,
+                         buf, nbyte, this);
 #endif
 
         std::lock_guard<L> lock
@@ -570,8 +1187,9 @@ namespace os
       block_device_lockable<T, L>::write (const void* buf, std::size_t nbyte)
       {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-        trace::printf ("block_device_lockable::%s(0x0%X, %u) @%p\n", __func__,
-                       buf, nbyte, this);
+        OS_TRACE_PRINTF (posix_io_block_device,
+                         "block_device_lockable::%s(0x0%X, %u) @%p\n", __func__,
+                         buf, nbyte, this);
 #endif
 
         std::lock_guard<L> lock
@@ -585,8 +1203,9 @@ namespace os
       block_device_lockable<T, L>::writev (const struct iovec* iov, int iovcnt)
       {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-        trace::printf ("block_device_lockable::%s(0x0%X, %d) @%p\n", __func__,
-                       iov, iovcnt, this);
+        OS_TRACE_PRINTF (posix_io_block_device,
+                         "block_device_lockable::%s(0x0%X, %d) @%p\n", __func__,
+                         iov, iovcnt, this);
 #endif
 
         std::lock_guard<L> lock
@@ -595,13 +1214,64 @@ namespace os
         return block_device::writev (iov, iovcnt);
       }
 
+    template<typename T, typename L>
+      ssize_t
+      block_device_lockable<T, L>::readv (const struct iovec* iov, int iovcnt)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+        OS_TRACE_PRINTF (posix_io_block_device,
+                         "block_device_lockable::%s(0x0%X, %d) @%p\n", __func__,
+                         iov, iovcnt, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device::readv (iov, iovcnt);
+      }
+
+    template<typename T, typename L>
+      ssize_t
+      block_device_lockable<T, L>::preadv (const struct iovec* iov, int iovcnt,
+                                           off_t offset)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+        OS_TRACE_PRINTF (posix_io_block_device,
+                         "block_device_lockable::%s(0x0%X, %d, %d) @%p\n",
+                         __func__, iov, iovcnt, offset, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device::preadv (iov, iovcnt, offset);
+      }
+
+    template<typename T, typename L>
+      ssize_t
+      block_device_lockable<T, L>::pwritev (const struct iovec* iov,
+                                            int iovcnt, off_t offset)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+        OS_TRACE_PRINTF (posix_io_block_device,
+                         "block_device_lockable::%s(0x0%X, %d, %d) @%p\n",
+                         __func__, iov, iovcnt, offset, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device::pwritev (iov, iovcnt, offset);
+      }
+
     template<typename T, typename L>
       int
       block_device_lockable<T, L>::vfcntl (int cmd, std::va_list args)
       {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-        trace::printf ("block_device_lockable::%s(%d) @%p\n", __func__, cmd,
-                       this);
+        OS_TRACE_PRINTF (posix_io_block_device,
+                         "block_device_lockable::%s(%d) @%p\n", __func__, cmd,
+                         this);
 #endif
 
         std::lock_guard<L> lock
@@ -615,8 +1285,9 @@ namespace os
       block_device_lockable<T, L>::vioctl (int request, std::va_list args)
       {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-        trace::printf ("block_device_lockable::%s(%d) @%p\n", __func__, request,
-                       this);
+        OS_TRACE_PRINTF (posix_io_block_device,
+                         "block_device_lockable::%s(%d) @%p\n", __func__,
+                         request, this);
 #endif
 
         std::lock_guard<L> lock
@@ -630,8 +1301,9 @@ namespace os
       block_device_lockable<T, L>::lseek (off_t offset, int whence)
       {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-        trace::printf ("block_device_lockable::%s(%d, %d) @%p\n", __func__,
-                       offset, whence, this);
+        OS_TRACE_PRINTF (posix_io_block_device,
+                         "block_device_lockable::%s(%d, %d) @%p\n", __func__,
+                         offset, whence, this);
 #endif
 
         std::lock_guard<L> lock
@@ -646,10 +1318,26 @@ namespace os
                                                std::size_t nblocks)
       {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-        trace::printf ("block_device_lockable::%s(%p, %u, %u) @%p\n", __func__,
-                       buf, blknum, nblocks, this);
+        OS_TRACE_PRINTF (posix_io_block_device,
+                         "block_device_lockable::%s(%p, %u, %u) @%p\n",
+                         __func__, buf, blknum, nblocks, this);
 #endif
 
+        if (queue_policy () == policy::elevator)
+          {
+            // The queue serialises the driver calls; without the lock
+            // the requests of the other threads can be merged.
+            return block_device::read_block (buf, blknum, nblocks);
+          }
+
+        if (concurrent_reads ())
+          {
+            internal::shared_lock_guard<L> lock
+              { locker_ };
+
+            return block_device::read_block (buf, blknum, nblocks);
+          }
+
         std::lock_guard<L> lock
           { locker_ };
 
@@ -663,22 +1351,46 @@ namespace os
                                                 std::size_t nblocks)
       {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-        trace::printf ("block_device_lockable::%s(%p, %u, %u) @%p\n", __func__,
-                       buf, blknum, nblocks, this);
+        OS_TRACE_PRINTF (posix_io_block_device,
+                         "block_device_lockable::%s(%p, %u, %u) @%p\n",
+                         __func__, buf, blknum, nblocks, this);
 #endif
 
+        if (queue_policy () == policy::elevator)
+          {
+            return block_device::write_block (buf, blknum, nblocks);
+          }
+
         std::lock_guard<L> lock
           { locker_ };
 
         return block_device::write_block (buf, blknum, nblocks);
       }
 
+    template<typename T, typename L>
+      int
+      block_device_lockable<T, L>::discard (blknum_t blknum,
+                                            std::size_t nblocks)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+        OS_TRACE_PRINTF (posix_io_block_device,
+                         "block_device_lockable::%s(%u, %u) @%p\n", __func__,
+                         blknum, nblocks, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device::discard (blknum, nblocks);
+      }
+
     template<typename T, typename L>
       void
       block_device_lockable<T, L>::sync (void)
       {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-        trace::printf ("block_device_lockable::%s() @%p\n", __func__, this);
+        OS_TRACE_PRINTF (posix_io_block_device,
+                         "block_device_lockable::%s() @%p\n", __func__, this);
 #endif
 
         std::lock_guard<L> lock
@@ -687,6 +1399,23 @@ namespace os
         return block_device::sync ();
       }
 
+    template<typename T, typename L>
+      int
+      block_device_lockable<T, L>::fadvise (off_t offset, off_t len,
+                                            int advice)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+        OS_TRACE_PRINTF (posix_io_block_device,
+                         "block_device_lockable::%s(%d, %d, %d) @%p\n",
+                         __func__, offset, len, advice, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device::fadvise (offset, len, advice);
+      }
+
     template<typename T, typename L>
       typename block_device_lockable<T, L>::value_type&
       block_device_lockable<T, L>::impl (void) const
@@ -44,6 +44,25 @@ extern "C"
   int __attribute__((weak, alias ("__posix_accept")))
   accept (int socket, struct sockaddr* address, socklen_t* address_len);
 
+  int __attribute__((weak, alias ("__posix_aio_cancel")))
+  aio_cancel (int fildes, struct aiocb* aiocbp);
+
+  int __attribute__((weak, alias ("__posix_aio_error")))
+  aio_error (const struct aiocb* aiocbp);
+
+  int __attribute__((weak, alias ("__posix_aio_read")))
+  aio_read (struct aiocb* aiocbp);
+
+  ssize_t __attribute__((weak, alias ("__posix_aio_return")))
+  aio_return (struct aiocb* aiocbp);
+
+  int __attribute__((weak, alias ("__posix_aio_suspend")))
+  aio_suspend (const struct aiocb* const list[], int nent,
+               const struct timespec* timeout);
+
+  int __attribute__((weak, alias ("__posix_aio_write")))
+  aio_write (struct aiocb* aiocbp);
+
   int __attribute__((weak, alias ("__posix_bind")))
   bind (int socket, const struct sockaddr* address, socklen_t address_len);
 
@@ -130,6 +149,12 @@ extern "C"
   int __attribute__((weak, alias ("__posix_mkdir")))
   mkdir (const char* path, mode_t mode);
 
+  void* __attribute__((weak, alias ("__posix_mmap")))
+  mmap (void* addr, size_t len, int prot, int flags, int fildes, off_t off);
+
+  int __attribute__((weak, alias ("__posix_munmap")))
+  munmap (void* addr, size_t len);
+
   int __attribute__((weak, alias ("__posix_open")))
   _open (const char* path, int oflag, ...);
 
@@ -137,6 +162,24 @@ extern "C"
   __attribute__((weak, alias ("__posix_opendir")))
   opendir (const char* dirname);
 
+  int __attribute__((weak, alias ("__posix_pipe")))
+  pipe (int fildes[2]);
+
+  int __attribute__((weak, alias ("__posix_posix_fallocate")))
+  posix_fallocate (int fildes, off_t offset, off_t len);
+
+  ssize_t __attribute__((weak, alias ("__posix_pread")))
+  pread (int fildes, void* buf, size_t nbyte, off_t offset);
+
+  ssize_t __attribute__((weak, alias ("__posix_preadv")))
+  preadv (int fildes, const struct iovec* iov, int iovcnt, off_t offset);
+
+  ssize_t __attribute__((weak, alias ("__posix_pwrite")))
+  pwrite (int fildes, const void* buf, size_t nbyte, off_t offset);
+
+  ssize_t __attribute__((weak, alias ("__posix_pwritev")))
+  pwritev (int fildes, const struct iovec* iov, int iovcnt, off_t offset);
+
   int __attribute__((weak, alias ("__posix_raise")))
   raise (int sig);
 
@@ -153,6 +196,9 @@ extern "C"
   ssize_t __attribute__((weak, alias ("__posix_readlink")))
   _readlink (const char* path, char* buf, size_t bufsize);
 
+  ssize_t __attribute__((weak, alias ("__posix_readv")))
+  readv (int fildes, const struct iovec* iov, int iovcnt);
+
   ssize_t __attribute__((weak, alias ("__posix_recv")))
   recv (int socket, void* buffer, size_t length, int flags);
 
@@ -163,6 +209,10 @@ extern "C"
   ssize_t __attribute__((weak, alias ("__posix_recvmsg")))
   recvmsg (int socket, struct msghdr* message, int flags);
 
+  int __attribute__((weak, alias ("__posix_recvmmsg")))
+  recvmmsg (int socket, struct mmsghdr* vmessages, unsigned int vlen,
+            int flags, struct timespec* timeout);
+
   int __attribute__((weak, alias ("__posix_rename")))
   rename (const char* oldfn, const char* newfn);
 
@@ -182,6 +232,10 @@ extern "C"
   ssize_t __attribute__((weak, alias ("__posix_sendmsg")))
   sendmsg (int socket, const struct msghdr* message, int flags);
 
+  int __attribute__((weak, alias ("__posix_sendmmsg")))
+  sendmmsg (int socket, struct mmsghdr* vmessages, unsigned int vlen,
+            int flags);
+
   ssize_t __attribute__((weak, alias ("__posix_sendto")))
   sendto (int socket, const void* message, size_t length, int flags,
           const struct sockaddr* dest_addr, socklen_t dest_len);
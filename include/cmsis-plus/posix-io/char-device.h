@@ -282,8 +282,9 @@ namespace os
               { std::forward<Args>(args)... }
         {
 #if defined(OS_TRACE_POSIX_IO_CHAR_DEVICE)
-          trace::printf ("char_device_implementable::%s(\"%s\")=@%p\n",
-                         __func__, name_, this);
+          OS_TRACE_PRINTF (posix_io_char_device,
+                           "char_device_implementable::%s(\"%s\")=@%p\n",
+                           __func__, name_, this);
 #endif
         }
 
@@ -291,8 +292,9 @@ namespace os
       char_device_implementable<T>::~char_device_implementable ()
       {
 #if defined(OS_TRACE_POSIX_IO_CHAR_DEVICE)
-        trace::printf ("char_device_implementable::%s() @%p %s\n", __func__,
-                       this, name_);
+        OS_TRACE_PRINTF (posix_io_char_device,
+                         "char_device_implementable::%s() @%p %s\n", __func__,
+                         this, name_);
 #endif
       }
 
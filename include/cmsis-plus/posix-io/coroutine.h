@@ -0,0 +1,200 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_POSIX_IO_COROUTINE_H_
+#define CMSIS_PLUS_POSIX_IO_COROUTINE_H_
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#include <cmsis-plus/rtos/os-coroutine.h>
+
+#if defined(__cpp_impl_coroutine) && (__cplusplus >= 202002L)
+
+#include <cmsis-plus/posix-io/aio.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    /**
+     * @brief Awaitable posix-io transfers, for `rtos::co` coroutines.
+     * @ingroup cmsis-plus-posix-io
+     */
+    namespace co
+    {
+      // ======================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+      /**
+       * @brief Wait for an asynchronous read or write.
+       * @headerfile coroutine.h <cmsis-plus/posix-io/coroutine.h>
+       *
+       * @details
+       * The transfer is started with `aio_read()` or `aio_write()`
+       * when awaited; the coroutine is resumed when it completes,
+       * without a thread blocked for it.
+       */
+      class io_awaiter : public rtos::co::awaiter
+      {
+      public:
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct an awaiter for a transfer.
+         * @param [in] fildes The file descriptor.
+         * @param [in] buf The buffer.
+         * @param [in] nbyte The number of bytes to transfer.
+         * @param [in] offset The offset, for files and block devices.
+         * @param [in] is_write Write the buffer, instead of reading.
+         */
+        io_awaiter (int fildes, void* buf, std::size_t nbyte, off_t offset,
+                    bool is_write);
+
+        /**
+         * @brief Destruct the awaiter object instance.
+         *
+         * @details
+         * If the coroutine is destroyed with the transfer
+         * in progress, it is cancelled, or waited for.
+         */
+        virtual
+        ~io_awaiter () override;
+
+        /**
+         * @}
+         */
+
+        /**
+         * @brief Get the result of the transfer.
+         * @par Parameters
+         *  None.
+         * @return The number of bytes transferred, or -1 with
+         *  `errno` set.
+         */
+        ssize_t
+        await_resume (void) const noexcept;
+
+      protected:
+
+        virtual bool
+        do_try_complete (void) override;
+
+        virtual bool
+        do_ready (void) override;
+
+        /**
+         * @cond ignore
+         */
+
+        struct aiocb cb_;
+        rtos::semaphore_binary done_
+          { 0 };
+        ssize_t result_ = -1;
+        int error_ = 0;
+        bool started_ = false;
+        bool completed_ = false;
+
+        /**
+         * @endcond
+         */
+      };
+
+#pragma GCC diagnostic pop
+
+      // ======================================================================
+
+      /**
+       * @brief Read from a file descriptor.
+       * @param [in] fildes The file descriptor.
+       * @param [out] buf The destination buffer.
+       * @param [in] nbyte The number of bytes to read.
+       * @param [in] offset The offset, for files and block devices.
+       * @return An awaiter; `co_await` returns the number of bytes
+       *  read, or -1 with `errno` set.
+       */
+      io_awaiter
+      read (int fildes, void* buf, std::size_t nbyte, off_t offset = 0);
+
+      /**
+       * @brief Write to a file descriptor.
+       * @param [in] fildes The file descriptor.
+       * @param [in] buf The source buffer.
+       * @param [in] nbyte The number of bytes to write.
+       * @param [in] offset The offset, for files and block devices.
+       * @return An awaiter; `co_await` returns the number of bytes
+       *  written, or -1 with `errno` set.
+       */
+      io_awaiter
+      write (int fildes, const void* buf, std::size_t nbyte, off_t offset = 0);
+
+    } /* namespace co */
+  } /* namespace posix */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace posix
+  {
+    namespace co
+    {
+      inline io_awaiter
+      read (int fildes, void* buf, std::size_t nbyte, off_t offset)
+      {
+        return io_awaiter
+          { fildes, buf, nbyte, offset, false };
+      }
+
+      inline io_awaiter
+      write (int fildes, const void* buf, std::size_t nbyte, off_t offset)
+      {
+        return io_awaiter
+          { fildes, const_cast<void*> (buf), nbyte, offset, true };
+      }
+
+    } /* namespace co */
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* defined(__cpp_impl_coroutine) */
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_POSIX_IO_COROUTINE_H_ */
@@ -40,11 +40,18 @@
 #include <cmsis-plus/diag/trace.h>
 
 #include <cstddef>
+#include <cstdint>
 #include <cassert>
 #include <cstring>
 
 // ----------------------------------------------------------------------------
 
+#if !defined(OS_INTEGER_POSIX_IO_DEVICE_REGISTRY_BUCKETS)
+#define OS_INTEGER_POSIX_IO_DEVICE_REGISTRY_BUCKETS (16)
+#endif
+
+// ----------------------------------------------------------------------------
+
 namespace os
 {
   namespace posix
@@ -55,6 +62,11 @@ namespace os
      * @brief Devices registry static class.
      * @headerfile device-registry.h <cmsis-plus/posix-io/device-registry.h>
      * @ingroup cmsis-plus-posix-io-base
+     *
+     * @details
+     * The devices are kept in a list and in a hash table indexed
+     * by name, so `identify_device()` does not depend on the
+     * number of registered devices.
      */
     template<typename T>
       class device_registry
@@ -110,6 +122,9 @@ namespace os
         static void
         link (value_type* device);
 
+        static void
+        unlink (value_type* device);
+
         static value_type*
         identify_device (const char* path);
 
@@ -134,6 +149,12 @@ namespace os
         utils::double_list_links, &device::registry_links_, T>;
         static device_list registry_list__;
 
+        static uint32_t
+        hash_ (const char* name);
+
+        // Also in the BSS, for the same reason.
+        static device* buckets__[OS_INTEGER_POSIX_IO_DEVICE_REGISTRY_BUCKETS];
+
         /**
          * @endcond
          */
@@ -169,12 +190,54 @@ namespace os
 
         registry_list__.link (*device);
 
+        uint32_t h = hash_ (device->name ());
+        class device** bucket = &buckets__[h
+            % OS_INTEGER_POSIX_IO_DEVICE_REGISTRY_BUCKETS];
+
+        device->registry_hash_ = h;
+        device->registry_hash_next_ = *bucket;
+        device->registry_hash_pprev_ = bucket;
+        if (*bucket != nullptr)
+          {
+            (*bucket)->registry_hash_pprev_ = &device->registry_hash_next_;
+          }
+        *bucket = device;
+
         trace::printf ("Device '%s%s' linked.\n", value_type::device_prefix (),
                        device->name ());
       }
 
+    /**
+     * @details
+     * Remove the device from the list and from the hash table;
+     * it is safe to call it for devices not linked.
+     */
+    template<typename T>
+      void
+      device_registry<T>::unlink (value_type* device)
+      {
+        device->registry_links_.unlink ();
+
+        if (device->registry_hash_pprev_ != nullptr)
+          {
+            *device->registry_hash_pprev_ = device->registry_hash_next_;
+            if (device->registry_hash_next_ != nullptr)
+              {
+                device->registry_hash_next_->registry_hash_pprev_ =
+                    device->registry_hash_pprev_;
+              }
+            device->registry_hash_next_ = nullptr;
+            device->registry_hash_pprev_ = nullptr;
+          }
+      }
+
     /**
      * return pointer to device or nullptr if not found.
+     *
+     * @details
+     * The name is first searched in the hash table; if not found,
+     * the list is walked, for the devices that redefine
+     * `match_name()` to accept other names.
      */
     template<typename T>
       T*
@@ -192,11 +255,21 @@ namespace os
         // The prefix was identified; try to match the rest of the path.
         auto name = path + std::strlen (prefix);
 
-        for (auto&& p : registry_list__)
+        uint32_t h = hash_ (name);
+        device* p = buckets__[h % OS_INTEGER_POSIX_IO_DEVICE_REGISTRY_BUCKETS];
+        for (; p != nullptr; p = p->registry_hash_next_)
+          {
+            if (p->registry_hash_ == h && p->match_name (name))
+              {
+                return static_cast<value_type*> (p);
+              }
+          }
+
+        for (auto&& d : registry_list__)
           {
-            if (p.match_name (name))
+            if (d.match_name (name))
               {
-                return static_cast<value_type*> (&p);
+                return static_cast<value_type*> (&d);
               }
           }
 
@@ -208,6 +281,20 @@ namespace os
      * @cond ignore
      */
 
+    // FNV-1a, 32-bit.
+    template<typename T>
+      uint32_t
+      device_registry<T>::hash_ (const char* name)
+      {
+        uint32_t h = 2166136261u;
+        for (; *name != '\0'; ++name)
+          {
+            h ^= static_cast<uint8_t> (*name);
+            h *= 16777619u;
+          }
+        return h;
+      }
+
 #pragma GCC diagnostic push
 #if defined(__clang__)
 #pragma clang diagnostic ignored "-Wexit-time-destructors"
@@ -218,6 +305,11 @@ namespace os
     template<typename T>
       typename device_registry<T>::device_list device_registry<T>::registry_list__;
 
+    // Initialised to 0 by BSS.
+    template<typename T>
+      device* device_registry<T>::buckets__[
+          OS_INTEGER_POSIX_IO_DEVICE_REGISTRY_BUCKETS];
+
 #pragma GCC diagnostic pop
 
   /**
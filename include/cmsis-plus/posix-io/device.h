@@ -183,6 +183,12 @@ namespace os
       // Must be public.
       utils::double_list_links registry_links_;
 
+      // Links in the registry hash table bucket, and the hash
+      // of the name, computed when linked.
+      device* registry_hash_next_ = nullptr;
+      device** registry_hash_pprev_ = nullptr;
+      uint32_t registry_hash_ = 0;
+
       /**
        * @endcond
        */
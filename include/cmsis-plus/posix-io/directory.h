@@ -42,6 +42,17 @@
 #include <cmsis-plus/diag/trace.h>
 
 #include <mutex>
+#include <cstddef>
+
+#include <sys/types.h>
+
+// ----------------------------------------------------------------------------
+
+#if !defined(OS_INTEGER_POSIX_IO_DIRECTORY_PATH_MAX)
+#define OS_INTEGER_POSIX_IO_DIRECTORY_PATH_MAX (64)
+#endif
+
+struct stat;
 
 // ----------------------------------------------------------------------------
 
@@ -125,6 +136,12 @@ namespace os
       virtual struct dirent *
       read (void);
 
+      // Batched read, similar to getdents(), optionally with
+      // the attributes of each entry.
+      virtual ssize_t
+      read_entries (struct dirent* buf, std::size_t n, struct stat* st =
+                        nullptr);
+
       // http://pubs.opengroup.org/onlinepubs/9699919799/functions/rewinddir.html
       virtual void
       rewind (void);
@@ -189,6 +206,7 @@ namespace os
        */
 
       friend class directory;
+      friend class file_system;
 
       /**
        * @endcond
@@ -243,6 +261,15 @@ namespace os
       virtual struct dirent*
       do_read (void) = 0;
 
+      /**
+       * @return number of entries, 0 at end, otherwise -1 and errno.
+       */
+      virtual ssize_t
+      do_read_entries (struct dirent* buf, std::size_t n, struct stat* st);
+
+      virtual int
+      do_stat_entry (const struct dirent* entry, struct stat* buf);
+
       virtual void
       do_rewind (void) = 0;
 
@@ -255,6 +282,13 @@ namespace os
       class file_system&
       file_system (void) const;
 
+      /**
+       * @return the path passed to opendir(), relative to the mount point,
+       *  or an empty string if it did not fit.
+       */
+      const char*
+      path (void) const;
+
       /**
        * @}
        */
@@ -262,6 +296,9 @@ namespace os
       // ----------------------------------------------------------------------
     protected:
 
+      void
+      path (const char* dirpath);
+
       /**
        * @cond ignore
        */
@@ -269,6 +306,9 @@ namespace os
       // This also solves the readdir() re-entrancy issue.
       struct dirent dir_entry_;
 
+      // Used to stat() the entries returned by read_entries().
+      char path_[OS_INTEGER_POSIX_IO_DIRECTORY_PATH_MAX];
+
       class file_system& file_system_;
 
       /**
@@ -411,6 +451,10 @@ namespace os
         virtual struct dirent *
         read (void) override;
 
+        virtual ssize_t
+        read_entries (struct dirent* buf, std::size_t n, struct stat* st =
+                          nullptr) override;
+
         // http://pubs.opengroup.org/onlinepubs/9699919799/functions/rewinddir.html
         virtual void
         rewind (void) override;
@@ -485,6 +529,12 @@ namespace os
       return file_system_;
     }
 
+    inline const char*
+    directory_impl::path (void) const
+    {
+      return path_;
+    }
+
     // ========================================================================
 
     template<typename T>
@@ -496,7 +546,8 @@ namespace os
             { fs }
       {
 #if defined(OS_TRACE_POSIX_IO_DIRECTORY)
-        trace::printf ("directory_implementable::%s()=@%p\n", __func__, this);
+        OS_TRACE_PRINTF (posix_io_directory,
+                         "directory_implementable::%s()=@%p\n", __func__, this);
 #endif
       }
 
@@ -504,7 +555,8 @@ namespace os
       directory_implementable<T>::~directory_implementable ()
       {
 #if defined(OS_TRACE_POSIX_IO_DIRECTORY)
-        trace::printf ("directory_implementable::%s() @%p\n", __func__, this);
+        OS_TRACE_PRINTF (posix_io_directory,
+                         "directory_implementable::%s() @%p\n", __func__, this);
 #endif
       }
 
@@ -527,7 +579,8 @@ namespace os
           locker_ (locker)
       {
 #if defined(OS_TRACE_POSIX_IO_DIRECTORY)
-        trace::printf ("directory_lockable::%s()=@%p\n", __func__, this);
+        OS_TRACE_PRINTF (posix_io_directory, "directory_lockable::%s()=@%p\n",
+                         __func__, this);
 #endif
       }
 
@@ -535,7 +588,8 @@ namespace os
       directory_lockable<T, L>::~directory_lockable ()
       {
 #if defined(OS_TRACE_POSIX_IO_DIRECTORY)
-        trace::printf ("directory_lockable::%s() @%p\n", __func__, this);
+        OS_TRACE_PRINTF (posix_io_directory, "directory_lockable::%s() @%p\n",
+                         __func__, this);
 #endif
       }
 
@@ -546,7 +600,8 @@ namespace os
       directory_lockable<T, L>::read (void)
       {
 #if defined(OS_TRACE_POSIX_IO_DIRECTORY)
-        trace::printf ("directory_lockable::%s() @%p\n", __func__, this);
+        OS_TRACE_PRINTF (posix_io_directory, "directory_lockable::%s() @%p\n",
+                         __func__, this);
 #endif
 
         std::lock_guard<L> lock
@@ -555,12 +610,31 @@ namespace os
         return directory::read ();
       }
 
+    template<typename T, typename L>
+      ssize_t
+      directory_lockable<T, L>::read_entries (struct dirent* buf,
+                                              std::size_t n, struct stat* st)
+      {
+#if defined(OS_TRACE_POSIX_IO_DIRECTORY)
+        OS_TRACE_PRINTF (posix_io_directory,
+                         "directory_lockable::%s(%p, %u, %p) @%p\n", __func__,
+                         buf, n, st, this);
+#endif
+
+        // A single lock for the entire batch.
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return directory::read_entries (buf, n, st);
+      }
+
     template<typename T, typename L>
       void
       directory_lockable<T, L>::rewind (void)
       {
 #if defined(OS_TRACE_POSIX_IO_DIRECTORY)
-        trace::printf ("directory_lockable::%s() @%p\n", __func__, this);
+        OS_TRACE_PRINTF (posix_io_directory, "directory_lockable::%s() @%p\n",
+                         __func__, this);
 #endif
 
         std::lock_guard<L> lock
@@ -574,7 +648,8 @@ namespace os
       directory_lockable<T, L>::close (void)
       {
 #if defined(OS_TRACE_POSIX_IO_DIRECTORY)
-        trace::printf ("directory_lockable::%s() @%p\n", __func__, this);
+        OS_TRACE_PRINTF (posix_io_directory, "directory_lockable::%s() @%p\n",
+                         __func__, this);
 #endif
 
         std::lock_guard<L> lock
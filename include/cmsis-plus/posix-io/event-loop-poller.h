@@ -0,0 +1,202 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_POSIX_IO_EVENT_LOOP_POLLER_H_
+#define CMSIS_PLUS_POSIX_IO_EVENT_LOOP_POLLER_H_
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#include <cmsis-plus/posix-io/event-poll.h>
+#include <cmsis-plus/rtos/os-event-loop.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Descriptors readiness for an `rtos::event_loop`.
+     * @headerfile event-loop-poller.h <cmsis-plus/posix-io/event-loop-poller.h>
+     * @ingroup cmsis-plus-posix-io-base
+     *
+     * @details
+     * An `event_poll` with a callback for each watched descriptor,
+     * run by the loop thread when the descriptor is ready.
+     *
+     * @par Example
+     *
+     * @code{.cpp}
+     * posix::event_loop_poller poller { 4 };
+     * rtos::event_loop_inclusive<16, 8> loop { "loop", &poller };
+     *
+     * poller.watch (fd, posix::io::readiness::read, on_read, &ctx);
+     * @endcode
+     */
+    class event_loop_poller : public rtos::event_loop::poller
+    {
+    public:
+
+      /**
+       * @brief Type of callback functions.
+       * @param [in] fd The ready file descriptor.
+       * @param [in] events The conditions (`io::readiness` bits).
+       * @param [in] args Pointer to callback arguments.
+       * @par Returns
+       *  Nothing.
+       */
+      using func_t = void (*) (int fd, io::readiness_t events, void* args);
+
+      /**
+       * @brief The max number of events handled by one wait.
+       */
+      static constexpr int max_events = 8;
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+      /**
+       * @brief Construct a poller object instance.
+       * @param [in] size The max number of watched descriptors.
+       */
+      event_loop_poller (std::size_t size);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      event_loop_poller (const event_loop_poller&) = delete;
+      event_loop_poller (event_loop_poller&&) = delete;
+      event_loop_poller&
+      operator= (const event_loop_poller&) = delete;
+      event_loop_poller&
+      operator= (event_loop_poller&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @brief Destruct the poller object instance.
+       */
+      virtual
+      ~event_loop_poller () override;
+
+      /**
+       * @}
+       */
+
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+      /**
+       * @brief Call a function when a descriptor is ready.
+       * @param [in] fd The file descriptor.
+       * @param [in] events The expected conditions (`io::readiness` bits).
+       * @param [in] func Pointer to function.
+       * @param [in] args Pointer to function arguments.
+       * @param [in] trig `event_poll::trigger::level` or
+       *  `event_poll::trigger::edge`.
+       * @retval 0 if successful,
+       * @retval -1 otherwise and the variable errno is set to
+       *   indicate the error.
+       */
+      int
+      watch (int fd, io::readiness_t events, func_t func, void* args =
+                 nullptr,
+             event_poll::trigger_t trig = event_poll::trigger::level);
+
+      /**
+       * @brief Stop watching a descriptor.
+       * @param [in] fd The file descriptor.
+       * @retval 0 if successful,
+       * @retval -1 otherwise and the variable errno is set to
+       *   indicate the error.
+       */
+      int
+      unwatch (int fd);
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      virtual void
+      wait (rtos::clock::duration_t timeout) override;
+
+      virtual void
+      wakeup (void) override;
+
+      /**
+       * @cond ignore
+       */
+
+      struct watch_t
+      {
+        func_t func;
+        void* args;
+        int fd;
+      };
+
+      event_poll poll_;
+
+      watch_t* watches_;
+      std::size_t size_;
+
+      /**
+       * @endcond
+       */
+    };
+
+#pragma GCC diagnostic pop
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_POSIX_IO_EVENT_LOOP_POLLER_H_ */
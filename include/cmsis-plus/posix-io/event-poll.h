@@ -0,0 +1,353 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_POSIX_IO_EVENT_POLL_H_
+#define CMSIS_PLUS_POSIX_IO_EVENT_POLL_H_
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#include <cmsis-plus/posix-io/io.h>
+#include <cmsis-plus/rtos/os.h>
+
+#include <cstddef>
+#include <cstdint>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ------------------------------------------------------------------------
+
+    class event_poll;
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @cond ignore
+     */
+
+    // One descriptor in the interest list; linked in the list of
+    // the watched io_impl and, when notified, in the ready list
+    // of the event poll. Free and removed entries have no target.
+    struct event_poll_entry
+    {
+      event_poll_entry* watch_next;
+      event_poll_entry* ready_next;
+      event_poll* poll;
+      io* target;
+      void* data;
+      int fd;
+      io::readiness_t events;
+      uint8_t trigger;
+      bool queued;
+    };
+
+    /**
+     * @endcond
+     */
+
+    // ========================================================================
+
+    /**
+     * @brief Interest list of descriptors, with a list of ready events.
+     * @headerfile event-poll.h <cmsis-plus/posix-io/event-poll.h>
+     * @ingroup cmsis-plus-posix-io-base
+     *
+     * @details
+     * Similar to Linux `epoll`; the implementations push their
+     * descriptors in the ready list when they call
+     * `io_impl::notify_readiness()`, and `wait()` retrieves them
+     * in a time proportional to the number of ready descriptors,
+     * not to the number of watched ones.
+     *
+     * The interest list must be changed by the thread that waits, or
+     * under a lock of the application; the notifications may come
+     * from any thread or interrupt.
+     */
+    class event_poll
+    {
+    public:
+
+      /**
+       * @name Types & Constants
+       * @{
+       */
+
+      using trigger_t = uint8_t;
+      struct trigger
+      {
+        enum
+          : trigger_t
+            {
+              // Report the descriptor as long as it is ready.
+              level = 0,
+              // Report the descriptor once for each notification.
+              edge = 1
+        };
+      };
+
+      /**
+       * @brief A ready descriptor, returned by `wait()`.
+       */
+      struct event
+      {
+        int fd;
+        io::readiness_t events;
+        void* data;
+      };
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      /**
+       * @brief Construct an event poll object instance.
+       * @param [in] size The max number of watched descriptors.
+       */
+      event_poll (std::size_t size);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      event_poll (const event_poll&) = delete;
+      event_poll (event_poll&&) = delete;
+      event_poll&
+      operator= (const event_poll&) = delete;
+      event_poll&
+      operator= (event_poll&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      ~event_poll ();
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      /**
+       * @brief Add a descriptor to the interest list.
+       * @param [in] fd The file descriptor.
+       * @param [in] events The expected conditions (`io::readiness` bits).
+       * @param [in] data Pointer returned with the events.
+       * @param [in] trig `trigger::level` or `trigger::edge`.
+       * @retval 0 if successful,
+       * @retval -1 otherwise and the variable errno is set to
+       *   indicate the error.
+       */
+      int
+      add (int fd, io::readiness_t events, void* data = nullptr,
+           trigger_t trig = trigger::level);
+
+      /**
+       * @brief Change the expected conditions of a descriptor.
+       * @param [in] fd The file descriptor.
+       * @param [in] events The expected conditions (`io::readiness` bits).
+       * @param [in] data Pointer returned with the events.
+       * @retval 0 if successful,
+       * @retval -1 otherwise and the variable errno is set to
+       *   indicate the error.
+       */
+      int
+      modify (int fd, io::readiness_t events, void* data = nullptr);
+
+      /**
+       * @brief Remove a descriptor from the interest list.
+       * @param [in] fd The file descriptor.
+       * @retval 0 if successful,
+       * @retval -1 otherwise and the variable errno is set to
+       *   indicate the error.
+       */
+      int
+      remove (int fd);
+
+      /**
+       * @brief Wait for ready descriptors.
+       * @param [out] events Array where to store the ready descriptors.
+       * @param [in] maxevents The size of the array.
+       * @param [in] timeout Timeout in system clock ticks; 0 does not
+       *  block, `forever` does not time out.
+       * @return The number of ready descriptors, 0 if the timeout
+       *  expired, or -1 and the variable errno is set to
+       *  indicate the error.
+       */
+      int
+      wait (event* events, int maxevents, rtos::clock::duration_t timeout =
+                forever);
+
+      /**
+       * @brief Make the current or the next `wait()` return.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      wakeup (void);
+
+      /**
+       * @brief Get the number of watched descriptors.
+       * @par Parameters
+       *  None.
+       * @return The number of descriptors in the interest list.
+       */
+      std::size_t
+      size (void) const;
+
+      /**
+       * @}
+       */
+
+      /**
+       * @brief Do not time out.
+       */
+      static constexpr rtos::clock::duration_t forever =
+          static_cast<rtos::clock::duration_t> (-1);
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @cond ignore
+       */
+
+      // Called in a critical section by io_impl::notify_readiness().
+      void
+      internal_notify_ (event_poll_entry* entry);
+
+      // Called by io::close(), to forget the descriptor.
+      static void
+      internal_forget_ (io_impl& impl);
+
+      /**
+       * @endcond
+       */
+
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      event_poll_entry*
+      internal_find_ (int fd);
+
+      // Must be called in a critical section.
+      void
+      internal_enqueue_ (event_poll_entry* entry);
+
+      // Must be called in a critical section.
+      void
+      internal_release_ (event_poll_entry* entry);
+
+      /**
+       * @endcond
+       */
+
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      event_poll_entry* entries_ = nullptr;
+      std::size_t size_ = 0;
+      std::size_t used_ = 0;
+
+      event_poll_entry* free_list_ = nullptr;
+
+      event_poll_entry* ready_head_ = nullptr;
+      event_poll_entry* ready_tail_ = nullptr;
+
+      rtos::semaphore_binary sem_
+        { "epoll", 0 };
+
+      bool volatile woken_ = false;
+
+      /**
+       * @endcond
+       */
+    };
+
+#pragma GCC diagnostic pop
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    inline std::size_t
+    event_poll::size (void) const
+    {
+      return used_;
+    }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_POSIX_IO_EVENT_POLL_H_ */
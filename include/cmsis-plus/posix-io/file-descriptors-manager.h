@@ -38,6 +38,10 @@
 
 #include <cmsis-plus/posix-io/types.h>
 
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+#include <cmsis-plus/posix-io/io.h>
+#endif
+
 #include <cstddef>
 #include <cassert>
 
@@ -127,6 +131,29 @@ namespace os
       static size_t
       used (void);
 
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS) || defined(__DOXYGEN__)
+
+      /**
+       * @brief The statistics of an open descriptor.
+       */
+      struct descriptor_statistics_t
+      {
+        file_descriptor_t fildes;
+        class io* object;
+        io::statistics_t stats;
+      };
+
+      /**
+       * @brief Copy the statistics of all open descriptors.
+       * @param [out] array Pointer to the destination array.
+       * @param [in] count The number of elements in the array.
+       * @return The number of elements filled.
+       */
+      static std::size_t
+      statistics (descriptor_statistics_t* array, std::size_t count);
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
       /**
        * @}
        */
@@ -141,10 +168,45 @@ namespace os
       // Reserve 0, 1, 2 (stdin, stdout, stderr).
       static constexpr std::size_t reserved__ = 3;
 
+      // Number of bits in a bitmap word.
+      static constexpr std::size_t word_bits__ = sizeof(std::size_t) * 8;
+
+      static void
+      set_bit (std::size_t* map, std::size_t n);
+
+      static void
+      clear_bit (std::size_t* map, std::size_t n);
+
+      static bool
+      test_bit (const std::size_t* map, std::size_t n);
+
+      static void
+      mark_used (std::size_t fildes);
+
+      static void
+      mark_free (std::size_t fildes);
+
       static std::size_t size__;
 
       static class io** descriptors_array__;
 
+      // One bit for each free descriptor.
+      static std::size_t* free_map__;
+
+      // One bit for each word of free_map__ with free descriptors;
+      // a single word covers word_bits__ * word_bits__ descriptors.
+      static std::size_t* summary_map__;
+
+      // One bit for each descriptor associated with a socket.
+      static std::size_t* socket_map__;
+
+      static std::size_t words__;
+
+      static std::size_t summary_words__;
+
+      // Descriptors in use, excluding the reserved ones.
+      static std::size_t used__;
+
       /**
        * @endcond
        */
@@ -168,6 +230,61 @@ namespace os
       return size__;
     }
 
+    /**
+     * @details
+     * Called on every I/O system call, it takes no lock; the slot
+     * is a single word, updated atomically by `allocate()` and
+     * `deallocate()`.
+     */
+    inline class io*
+    file_descriptors_manager::io (int fildes)
+    {
+      // A single unsigned compare also rejects negative descriptors
+      // and the not yet initialised array (size__ is 0).
+      if (static_cast<std::size_t> (fildes) >= size__)
+        {
+          return nullptr;
+        }
+      return descriptors_array__[fildes];
+    }
+
+    /**
+     * @details
+     * The socket type is recorded when the descriptor is allocated,
+     * so there is no need to check the type of the object.
+     */
+    inline class socket*
+    file_descriptors_manager::socket (int fildes)
+    {
+      if ((static_cast<std::size_t> (fildes) >= size__)
+          || !test_bit (socket_map__, static_cast<std::size_t> (fildes)))
+        {
+          return nullptr;
+        }
+      return reinterpret_cast<class socket*> (descriptors_array__[fildes]);
+    }
+
+    inline void
+    file_descriptors_manager::set_bit (std::size_t* map, std::size_t n)
+    {
+      map[n / word_bits__] |= (static_cast<std::size_t> (1)
+          << (n % word_bits__));
+    }
+
+    inline void
+    file_descriptors_manager::clear_bit (std::size_t* map, std::size_t n)
+    {
+      map[n / word_bits__] &= ~(static_cast<std::size_t> (1)
+          << (n % word_bits__));
+    }
+
+    inline bool
+    file_descriptors_manager::test_bit (const std::size_t* map, std::size_t n)
+    {
+      return (map[n / word_bits__] & (static_cast<std::size_t> (1)
+          << (n % word_bits__))) != 0;
+    }
+
   // ==========================================================================
   } /* namespace posix */
 } /* namespace os */
@@ -38,13 +38,16 @@
 
 #include <cmsis-plus/posix-io/file.h>
 #include <cmsis-plus/posix-io/directory.h>
+#include <cmsis-plus/posix-io/group-commit.h>
 
 #include <cmsis-plus/utils/lists.h>
+#include <cmsis-plus/rtos/os.h>
 
 #include <cmsis-plus/diag/trace.h>
 
 #include <mutex>
 #include <cstdarg>
+#include <cerrno>
 #include <sys/stat.h>
 #include <utime.h>
 
@@ -299,6 +302,38 @@ namespace os
       const char*
       mounted_path (void);
 
+#if defined(OS_INCLUDE_POSIX_IO_PATH_CACHE)
+
+      /**
+       * @brief Invalidate the cached paths.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       * @details
+       * Called for each change of the file system content.
+       */
+      void
+      invalidate_paths (void);
+
+      uint32_t
+      paths_generation (void) const;
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_PATH_CACHE) */
+
+#if defined(OS_INCLUDE_POSIX_IO_GROUP_COMMIT)
+
+      /**
+       * @brief Get the group commit used by `fsync()`.
+       * @par Parameters
+       *  None.
+       * @return Reference to the group commit of the device.
+       */
+      class group_commit&
+      fsync_group (void);
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_GROUP_COMMIT) */
+
       const char*
       name (void) const;
 
@@ -320,6 +355,57 @@ namespace os
       deferred_directories_list_t&
       deferred_directories_list (void);
 
+      /**
+       * @brief Define the pools for file and directory objects.
+       * @param [in] files Pointer to the memory resource used for files.
+       * @param [in] directories Pointer to the memory resource used
+       *  for directories.
+       * @par Returns
+       *  Nothing.
+       * @details
+       * Must be called before opening the first file; usually the
+       * application passes `memory::block_pool_typed_inclusive<>`
+       * objects, sized for the maximum number of objects open at
+       * the same time.
+       */
+      void
+      objects_pools (rtos::memory::memory_resource* files,
+                     rtos::memory::memory_resource* directories);
+
+      /**
+       * @brief Set the preallocation hint.
+       * @param [in] bytes The size of the extents reserved when the
+       *  files grow; 0 to allocate only as needed.
+       * @retval 0 The hint was accepted.
+       * @retval -1 Otherwise, and `errno` is set.
+       * @details
+       * With a large hint, appending to a file allocates one extent
+       * from time to time, instead of a cluster for each write.
+       */
+      int
+      preallocation (std::size_t bytes);
+
+      /**
+       * @brief Get the preallocation hint.
+       * @par Parameters
+       *  None.
+       * @return The size of the extents, in bytes.
+       */
+      std::size_t
+      preallocation (void) const;
+
+      std::size_t
+      open_files (void) const;
+
+      std::size_t
+      max_open_files (void) const;
+
+      std::size_t
+      open_directories (void) const;
+
+      std::size_t
+      max_open_directories (void) const;
+
       // ----------------------------------------------------------------------
 
       template<typename T>
@@ -374,8 +460,29 @@ namespace os
 
       deferred_directories_list_t deferred_directories_list_;
 
+      // If set, objects are not allocated on the heap and the closed
+      // objects are kept for recycling.
+      rtos::memory::memory_resource* files_pool_ = nullptr;
+      rtos::memory::memory_resource* directories_pool_ = nullptr;
+
+      std::size_t open_files_ = 0;
+      std::size_t max_open_files_ = 0;
+      std::size_t open_directories_ = 0;
+      std::size_t max_open_directories_ = 0;
+
       const char* mounted_path_ = nullptr;
 
+      // Computed once when mounted, not at each lookup.
+      std::size_t mounted_path_size_ = 0;
+
+#if defined(OS_INCLUDE_POSIX_IO_PATH_CACHE)
+      uint32_t paths_generation_ = 0;
+#endif /* defined(OS_INCLUDE_POSIX_IO_PATH_CACHE) */
+
+#if defined(OS_INCLUDE_POSIX_IO_GROUP_COMMIT)
+      class group_commit fsync_group_;
+#endif /* defined(OS_INCLUDE_POSIX_IO_GROUP_COMMIT) */
+
       /**
        * @endcond
        */
@@ -509,12 +616,27 @@ namespace os
       virtual int
       do_statvfs (struct statvfs* buf) = 0;
 
+      /**
+       * @brief Set the preallocation hint.
+       * @param [in] bytes The size of the extents, in bytes.
+       * @retval 0 The hint was accepted.
+       * @retval -1 Otherwise, and `errno` is set.
+       */
+      virtual int
+      do_preallocation (std::size_t bytes);
+
       // ----------------------------------------------------------------------
       // Support functions.
 
+      // The implementations call device().discard() for the freed blocks.
       block_device&
       device (void) const;
 
+      // The implementations reserve at least this many bytes when
+      // a file grows, and release the unused part when it is closed.
+      std::size_t
+      preallocation (void) const;
+
       /**
        * @}
        */
@@ -530,6 +652,8 @@ namespace os
 
       file_system* fs_ = nullptr;
 
+      std::size_t preallocation_bytes_ = 0;
+
       /**
        * @endcond
        */
@@ -615,6 +739,20 @@ namespace os
 
     // ========================================================================
 
+    /**
+     * @brief File system with locking.
+     * @headerfile file-system.h <cmsis-plus/posix-io/file-system.h>
+     * @ingroup cmsis-plus-posix-io-base
+     * @details
+     * The lock protects the file system metadata and the allocation
+     * of files and directories. Queries (`stat()`, `statvfs()`) take
+     * it in shared mode when the lockable supports it (like
+     * `rtos::rwlock`), all other operations take it in exclusive mode.
+     *
+     * Files opened on the file system should be `file_lockable`
+     * objects using the same lockable; they use their own per file
+     * lock and take the file system lock in shared mode for reads.
+     */
     template<typename T, typename L>
       class file_system_lockable : public file_system
       {
@@ -773,6 +911,32 @@ namespace os
   {
     // ========================================================================
 
+#if defined(OS_INCLUDE_POSIX_IO_PATH_CACHE)
+
+    inline void
+    file_system::invalidate_paths (void)
+    {
+      ++paths_generation_;
+    }
+
+    inline uint32_t
+    file_system::paths_generation (void) const
+    {
+      return paths_generation_;
+    }
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_PATH_CACHE) */
+
+#if defined(OS_INCLUDE_POSIX_IO_GROUP_COMMIT)
+
+    inline group_commit&
+    file_system::fsync_group (void)
+    {
+      return fsync_group_;
+    }
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_GROUP_COMMIT) */
+
     inline const char*
     file_system::name (void) const
     {
@@ -791,16 +955,62 @@ namespace os
       return impl ().device ();
     }
 
+    inline std::size_t
+    file_system::preallocation (void) const
+    {
+      return impl ().preallocation ();
+    }
+
     inline void
     file_system::add_deferred_file (file* fil)
     {
       deferred_files_list_.link (*fil);
+      if (open_files_ > 0)
+        {
+          --open_files_;
+        }
     }
 
     inline void
     file_system::add_deferred_directory (directory* dir)
     {
       deferred_directories_list_.link (*dir);
+      if (open_directories_ > 0)
+        {
+          --open_directories_;
+        }
+    }
+
+    inline void
+    file_system::objects_pools (rtos::memory::memory_resource* files,
+                                rtos::memory::memory_resource* directories)
+    {
+      files_pool_ = files;
+      directories_pool_ = directories;
+    }
+
+    inline std::size_t
+    file_system::open_files (void) const
+    {
+      return open_files_;
+    }
+
+    inline std::size_t
+    file_system::max_open_files (void) const
+    {
+      return max_open_files_;
+    }
+
+    inline std::size_t
+    file_system::open_directories (void) const
+    {
+      return open_directories_;
+    }
+
+    inline std::size_t
+    file_system::max_open_directories (void) const
+    {
+      return max_open_directories_;
     }
 
     inline file_system::deferred_files_list_t&
@@ -825,7 +1035,22 @@ namespace os
 
         if (deferred_files_list_.empty ())
           {
-            fil = new file_type (*this);
+            if (files_pool_ != nullptr)
+              {
+                void* p = files_pool_->allocate (sizeof(file_type),
+                                                 alignof(file_type));
+                if (p == nullptr)
+                  {
+                    // Too many files open in the file system.
+                    errno = ENFILE;
+                    return nullptr;
+                  }
+                fil = new (p) file_type (*this);
+              }
+            else
+              {
+                fil = new file_type (*this);
+              }
           }
         else
           {
@@ -837,7 +1062,15 @@ namespace os
             // Placement new, run only the constructor.
             new (fil) file_type (*this);
 
-            deallocate_files<file_type> ();
+            if (files_pool_ == nullptr)
+              {
+                deallocate_files<file_type> ();
+              }
+          }
+
+        if (++open_files_ > max_open_files_)
+          {
+            max_open_files_ = open_files_;
           }
         return fil;
       }
@@ -852,7 +1085,22 @@ namespace os
 
         if (deferred_files_list_.empty ())
           {
-            fil = new file_type (*this, locker);
+            if (files_pool_ != nullptr)
+              {
+                void* p = files_pool_->allocate (sizeof(file_type),
+                                                 alignof(file_type));
+                if (p == nullptr)
+                  {
+                    // Too many files open in the file system.
+                    errno = ENFILE;
+                    return nullptr;
+                  }
+                fil = new (p) file_type (*this, locker);
+              }
+            else
+              {
+                fil = new file_type (*this, locker);
+              }
           }
         else
           {
@@ -864,7 +1112,15 @@ namespace os
             // Placement new, run only the constructor.
             new (fil) file_type (*this, locker);
 
-            deallocate_files<file_type> ();
+            if (files_pool_ == nullptr)
+              {
+                deallocate_files<file_type> ();
+              }
+          }
+
+        if (++open_files_ > max_open_files_)
+          {
+            max_open_files_ = open_files_;
           }
         return fil;
       }
@@ -881,8 +1137,18 @@ namespace os
             file_type* f =
                 static_cast<file_type*> (deferred_files_list_.unlink_head ());
 
-            // Call the destructor and the deallocator.
-            delete f;
+            if (files_pool_ != nullptr)
+              {
+                // Call the destructor and return the block to the pool.
+                f->~file_type ();
+                files_pool_->deallocate (f, sizeof(file_type),
+                                         alignof(file_type));
+              }
+            else
+              {
+                // Call the destructor and the deallocator.
+                delete f;
+              }
           }
       }
 
@@ -896,7 +1162,22 @@ namespace os
 
         if (deferred_directories_list_.empty ())
           {
-            dir = new directory_type (*this);
+            if (directories_pool_ != nullptr)
+              {
+                void* p = directories_pool_->allocate (
+                    sizeof(directory_type), alignof(directory_type));
+                if (p == nullptr)
+                  {
+                    // Too many directories open in the file system.
+                    errno = ENFILE;
+                    return nullptr;
+                  }
+                dir = new (p) directory_type (*this);
+              }
+            else
+              {
+                dir = new directory_type (*this);
+              }
           }
         else
           {
@@ -909,7 +1190,15 @@ namespace os
             // Placement new, run only the constructor.
             new (dir) directory_type (*this);
 
-            deallocate_directories<directory_type> ();
+            if (directories_pool_ == nullptr)
+              {
+                deallocate_directories<directory_type> ();
+              }
+          }
+
+        if (++open_directories_ > max_open_directories_)
+          {
+            max_open_directories_ = open_directories_;
           }
         return dir;
       }
@@ -924,7 +1213,22 @@ namespace os
 
         if (deferred_directories_list_.empty ())
           {
-            dir = new directory_type (*this, locker);
+            if (directories_pool_ != nullptr)
+              {
+                void* p = directories_pool_->allocate (
+                    sizeof(directory_type), alignof(directory_type));
+                if (p == nullptr)
+                  {
+                    // Too many directories open in the file system.
+                    errno = ENFILE;
+                    return nullptr;
+                  }
+                dir = new (p) directory_type (*this, locker);
+              }
+            else
+              {
+                dir = new directory_type (*this, locker);
+              }
           }
         else
           {
@@ -937,7 +1241,15 @@ namespace os
             // Placement new, run only the constructor.
             new (dir) directory_type (*this, locker);
 
-            deallocate_directories<directory_type> ();
+            if (directories_pool_ == nullptr)
+              {
+                deallocate_directories<directory_type> ();
+              }
+          }
+
+        if (++open_directories_ > max_open_directories_)
+          {
+            max_open_directories_ = open_directories_;
           }
         return dir;
       }
@@ -954,8 +1266,18 @@ namespace os
             directory_type* d =
                 static_cast<directory_type*> (deferred_directories_list_.unlink_head ());
 
-            // Call the destructor and the deallocator.
-            delete d;
+            if (directories_pool_ != nullptr)
+              {
+                // Call the destructor and return the block to the pool.
+                d->~directory_type ();
+                directories_pool_->deallocate (d, sizeof(directory_type),
+                                               alignof(directory_type));
+              }
+            else
+              {
+                // Call the destructor and the deallocator.
+                delete d;
+              }
           }
       }
 
@@ -967,6 +1289,12 @@ namespace os
       return device_;
     }
 
+    inline std::size_t
+    file_system_impl::preallocation (void) const
+    {
+      return preallocation_bytes_;
+    }
+
     // ========================================================================
 
     template<typename T>
@@ -979,8 +1307,9 @@ namespace os
               { device, std::forward<Args>(args)... }
         {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-          trace::printf ("file_system_implementable::%s(\"%s\")=@%p\n",
-                         __func__, name_, this);
+          OS_TRACE_PRINTF (posix_io_file_system,
+                           "file_system_implementable::%s(\"%s\")=@%p\n",
+                           __func__, name_, this);
 #endif
         }
 
@@ -988,8 +1317,9 @@ namespace os
       file_system_implementable<T>::~file_system_implementable ()
       {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-        trace::printf ("file_system_implementable::%s() @%p %s\n", __func__,
-                       this, name_);
+        OS_TRACE_PRINTF (posix_io_file_system,
+                         "file_system_implementable::%s() @%p %s\n", __func__,
+                         this, name_);
 #endif
       }
 
@@ -1014,7 +1344,8 @@ namespace os
               { device, locker, std::forward<Args>(args)... }
         {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-          trace::printf ("file_system_lockable::%s()=%p\n", __func__, this);
+          OS_TRACE_PRINTF (posix_io_file_system,
+                           "file_system_lockable::%s()=%p\n", __func__, this);
 #endif
         }
 
@@ -1022,7 +1353,8 @@ namespace os
       file_system_lockable<T, L>::~file_system_lockable ()
       {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-        trace::printf ("file_system_lockable::%s() @%p\n", __func__, this);
+        OS_TRACE_PRINTF (posix_io_file_system,
+                         "file_system_lockable::%s() @%p\n", __func__, this);
 #endif
       }
 
@@ -1125,7 +1457,7 @@ namespace os
       int
       file_system_lockable<T, L>::stat (const char* path, struct stat* buf)
       {
-        std::lock_guard<L> lock
+        internal::shared_lock_guard<L> lock
           { impl_instance_.locker () };
 
         return file_system::stat (path, buf);
@@ -1178,7 +1510,7 @@ namespace os
       int
       file_system_lockable<T, L>::statvfs (struct statvfs* buf)
       {
-        std::lock_guard<L> lock
+        internal::shared_lock_guard<L> lock
           { impl_instance_.locker () };
 
         return file_system::statvfs (buf);
@@ -41,7 +41,10 @@
 #include <cmsis-plus/posix/utime.h>
 #include <cmsis-plus/posix/sys/statvfs.h>
 
+#include <cmsis-plus/rtos/os-decls.h>
+
 #include <mutex>
+#include <type_traits>
 
 // ----------------------------------------------------------------------------
 
@@ -54,6 +57,25 @@ namespace os
     class file_system;
     class file_impl;
 
+    namespace internal
+    {
+      // ----------------------------------------------------------------------
+
+      /**
+       * @brief Default type of the per file lock.
+       * @details
+       * With an exclusive file system lockable, all file operations
+       * are already serialised, and no per file lock is needed.
+       * With a shared lockable, readers of different files run
+       * in parallel, and each file needs its own lock to keep
+       * its state (like the current offset) consistent.
+       */
+      template<typename L>
+        using file_lock_t = typename std::conditional<
+        shared_locking<L>::is_shared, L, rtos::null_locker>::type;
+
+    } /* namespace internal */
+
     // ========================================================================
 
     /**
@@ -120,6 +142,27 @@ namespace os
       virtual int
       close (void) override;
 
+      // The transfers pass the file access mode to the device;
+      // writes also invalidate the cached status of the paths.
+
+      virtual ssize_t
+      read (void* buf, std::size_t nbyte) override;
+
+      virtual ssize_t
+      readv (const struct iovec* iov, int iovcnt) override;
+
+      virtual ssize_t
+      preadv (const struct iovec* iov, int iovcnt, off_t offset) override;
+
+      virtual ssize_t
+      write (const void* buf, std::size_t nbyte) override;
+
+      virtual ssize_t
+      writev (const struct iovec* iov, int iovcnt) override;
+
+      virtual ssize_t
+      pwritev (const struct iovec* iov, int iovcnt, off_t offset) override;
+
       virtual int
       ftruncate (off_t length);
 
@@ -129,6 +172,28 @@ namespace os
       virtual int
       fstatvfs (struct statvfs *buf);
 
+      /**
+       * @brief Reserve space for a range of the file.
+       * @param [in] offset Start of the range, in bytes.
+       * @param [in] len Length of the range, in bytes.
+       * @retval 0 The space was reserved, and the size of the file is
+       *  at least `offset + len`.
+       * @retval -1 Otherwise, and `errno` is set.
+       */
+      virtual int
+      fallocate (off_t offset, off_t len);
+
+      /**
+       * @brief Declare the expected access pattern.
+       * @param [in] offset Start of the range, in bytes.
+       * @param [in] len Length of the range, in bytes; 0 up to the end.
+       * @param [in] advice One of the `POSIX_FADV_*` values.
+       * @retval 0 The advice was recorded.
+       * @retval -1 The advice is not valid.
+       */
+      virtual int
+      fadvise (off_t offset, off_t len, int advice);
+
       // ----------------------------------------------------------------------
       // Support functions.
 
@@ -142,6 +207,51 @@ namespace os
        * @}
        */
 
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @brief Pass the access pattern and `O_DIRECT` to the device.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_device_mode_ (void);
+
+#if defined(OS_INCLUDE_POSIX_IO_GROUP_COMMIT)
+
+      /**
+       * @brief First part of fsync(), done under the locks.
+       * @retval 1 The file was written back, the device flush is due.
+       * @retval 0 The file was fully synchronised by `do_fsync()`.
+       * @retval -1 Error, errno set.
+       */
+      int
+      fsync_writeback (void);
+
+      /**
+       * @brief Second part of fsync(), done without the locks.
+       * @retval 0 The device flush completed.
+       * @retval -1 Error, errno set.
+       */
+      int
+      fsync_commit (void);
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_GROUP_COMMIT) */
+
+      /**
+       * @cond ignore
+       */
+
+      // The access pattern, passed to the device by read().
+      int advice_ = POSIX_FADV_NORMAL;
+
+      /**
+       * @endcond
+       */
+
       // ----------------------------------------------------------------------
     public:
 
@@ -223,6 +333,21 @@ namespace os
       virtual int
       do_fsync (void) = 0;
 
+#if defined(OS_INCLUDE_POSIX_IO_GROUP_COMMIT)
+
+      /**
+       * @brief Write back the file, without flushing the device.
+       * @retval 0 Success, the device flush is left to the caller.
+       * @retval -1 Error, errno set; ENOSYS if not supported.
+       */
+      virtual int
+      do_fsync_writeback (void);
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_GROUP_COMMIT) */
+
+      virtual int
+      do_fallocate (off_t offset, off_t len);
+
       // ----------------------------------------------------------------------
       // Support functions.
 
@@ -325,7 +450,27 @@ namespace os
 
     // ========================================================================
 
-    template<typename T, typename L>
+    /**
+     * @brief File with locking.
+     * @headerfile file.h <cmsis-plus/posix-io/file.h>
+     * @ingroup cmsis-plus-posix-io-base
+     * @details
+     * The file system lock is taken in shared mode by the operations
+     * that do not change the file size or the file system metadata
+     * (read, seek, status), and in exclusive mode by all other
+     * operations (write, truncate, allocate, sync, close). With a shared
+     * lockable (see `internal::shared_locking`)
+     * threads reading different files, or reading while no other
+     * thread writes, make progress in parallel; with an exclusive
+     * lockable the behaviour is the same as a single lock.
+     *
+     * Operations on the same file are also serialised by a
+     * per file lock, always taken before the file system lock.
+     *
+     * @note Shared locking requires the file system implementation
+     * to be safe for concurrent readers.
+     */
+    template<typename T, typename L, typename F = internal::file_lock_t<L>>
       class file_lockable : public file
       {
         // --------------------------------------------------------------------
@@ -334,6 +479,7 @@ namespace os
 
         using value_type = T;
         using lockable_type = L;
+        using file_lockable_type = F;
 
         // --------------------------------------------------------------------
 
@@ -389,6 +535,15 @@ namespace os
         virtual ssize_t
         writev (const struct iovec* iov, int iovcnt) override;
 
+        virtual ssize_t
+        readv (const struct iovec* iov, int iovcnt) override;
+
+        virtual ssize_t
+        preadv (const struct iovec* iov, int iovcnt, off_t offset) override;
+
+        virtual ssize_t
+        pwritev (const struct iovec* iov, int iovcnt, off_t offset) override;
+
         virtual int
         vfcntl (int cmd, std::va_list args) override;
 
@@ -404,6 +559,12 @@ namespace os
         virtual int
         fsync (void) override;
 
+        virtual int
+        fallocate (off_t offset, off_t len) override;
+
+        virtual int
+        fadvise (off_t offset, off_t len, int advice) override;
+
         // fstatvfs() - must not be locked, since will be locked by the
         // file system. (otherwise non-recursive mutexes will fail).
 
@@ -428,6 +589,8 @@ namespace os
 
         lockable_type& locker_;
 
+        file_lockable_type file_locker_;
+
         /**
          * @endcond
          */
@@ -475,7 +638,8 @@ namespace os
             { fs }
       {
 #if defined(OS_TRACE_POSIX_IO_FILE)
-        trace::printf ("file_implementable::%s()=@%p\n", __func__, this);
+        OS_TRACE_PRINTF (posix_io_file, "file_implementable::%s()=@%p\n",
+                         __func__, this);
 #endif
       }
 
@@ -483,7 +647,8 @@ namespace os
       file_implementable<T>::~file_implementable ()
       {
 #if defined(OS_TRACE_POSIX_IO_FILE)
-        trace::printf ("file_implementable::%s() @%p\n", __func__, this);
+        OS_TRACE_PRINTF (posix_io_file, "file_implementable::%s() @%p\n",
+                         __func__, this);
 #endif
       }
 
@@ -496,9 +661,9 @@ namespace os
 
     // ========================================================================
 
-    template<typename T, typename L>
-      file_lockable<T, L>::file_lockable (class file_system& fs,
-                                          lockable_type& locker) :
+    template<typename T, typename L, typename F>
+      file_lockable<T, L, F>::file_lockable (class file_system& fs,
+                                             lockable_type& locker) :
           file
             { impl_instance_ }, //
           impl_instance_
@@ -506,113 +671,215 @@ namespace os
           locker_ (locker)
       {
 #if defined(OS_TRACE_POSIX_IO_FILE)
-        trace::printf ("file_lockable::%s()=@%p\n", __func__, this);
+        OS_TRACE_PRINTF (posix_io_file, "file_lockable::%s()=@%p\n", __func__,
+                         this);
 #endif
       }
 
-    template<typename T, typename L>
-      file_lockable<T, L>::~file_lockable ()
+    template<typename T, typename L, typename F>
+      file_lockable<T, L, F>::~file_lockable ()
       {
 #if defined(OS_TRACE_POSIX_IO_FILE)
-        trace::printf ("file_lockable::%s() @%p\n", __func__, this);
+        OS_TRACE_PRINTF (posix_io_file, "file_lockable::%s() @%p\n", __func__,
+                         this);
 #endif
       }
 
     // ------------------------------------------------------------------------
 
-    template<typename T, typename L>
+    template<typename T, typename L, typename F>
       int
-      file_lockable<T, L>::close (void)
+      file_lockable<T, L, F>::close (void)
       {
+        std::lock_guard<F> file_lock
+          { file_locker_ };
         std::lock_guard<L> lock
           { locker_ };
 
         return file::close ();
       }
 
-    template<typename T, typename L>
+    template<typename T, typename L, typename F>
       ssize_t
-      file_lockable<T, L>::read (void* buf, std::size_t nbyte)
+      file_lockable<T, L, F>::read (void* buf, std::size_t nbyte)
       {
-        std::lock_guard<L> lock
+        std::lock_guard<F> file_lock
+          { file_locker_ };
+        internal::shared_lock_guard<L> lock
           { locker_ };
 
         return file::read (buf, nbyte);
       }
 
-    template<typename T, typename L>
+    template<typename T, typename L, typename F>
       ssize_t
-      file_lockable<T, L>::write (const void* buf, std::size_t nbyte)
+      file_lockable<T, L, F>::write (const void* buf, std::size_t nbyte)
       {
+        std::lock_guard<F> file_lock
+          { file_locker_ };
         std::lock_guard<L> lock
           { locker_ };
 
         return file::write (buf, nbyte);
       }
 
-    template<typename T, typename L>
+    template<typename T, typename L, typename F>
       ssize_t
-      file_lockable<T, L>::writev (const struct iovec* iov, int iovcnt)
+      file_lockable<T, L, F>::writev (const struct iovec* iov, int iovcnt)
       {
+        std::lock_guard<F> file_lock
+          { file_locker_ };
         std::lock_guard<L> lock
           { locker_ };
 
         return file::writev (iov, iovcnt);
       }
 
-    template<typename T, typename L>
-      int
-      file_lockable<T, L>::vfcntl (int cmd, std::va_list args)
+    template<typename T, typename L, typename F>
+      ssize_t
+      file_lockable<T, L, F>::readv (const struct iovec* iov, int iovcnt)
       {
+        std::lock_guard<F> file_lock
+          { file_locker_ };
+        internal::shared_lock_guard<L> lock
+          { locker_ };
+
+        return file::readv (iov, iovcnt);
+      }
+
+    template<typename T, typename L, typename F>
+      ssize_t
+      file_lockable<T, L, F>::preadv (const struct iovec* iov, int iovcnt,
+                                      off_t offset)
+      {
+        std::lock_guard<F> file_lock
+          { file_locker_ };
+        internal::shared_lock_guard<L> lock
+          { locker_ };
+
+        return file::preadv (iov, iovcnt, offset);
+      }
+
+    template<typename T, typename L, typename F>
+      ssize_t
+      file_lockable<T, L, F>::pwritev (const struct iovec* iov, int iovcnt,
+                                       off_t offset)
+      {
+        std::lock_guard<F> file_lock
+          { file_locker_ };
         std::lock_guard<L> lock
           { locker_ };
 
+        return file::pwritev (iov, iovcnt, offset);
+      }
+
+    template<typename T, typename L, typename F>
+      int
+      file_lockable<T, L, F>::vfcntl (int cmd, std::va_list args)
+      {
+        std::lock_guard<F> file_lock
+          { file_locker_ };
+        internal::shared_lock_guard<L> lock
+          { locker_ };
+
         return file::vfcntl (cmd, args);
       }
 
-    template<typename T, typename L>
+    template<typename T, typename L, typename F>
       int
-      file_lockable<T, L>::fstat (struct stat* buf)
+      file_lockable<T, L, F>::fstat (struct stat* buf)
       {
-        std::lock_guard<L> lock
+        std::lock_guard<F> file_lock
+          { file_locker_ };
+        internal::shared_lock_guard<L> lock
           { locker_ };
 
         return file::fstat (buf);
       }
 
-    template<typename T, typename L>
+    template<typename T, typename L, typename F>
       off_t
-      file_lockable<T, L>::lseek (off_t offset, int whence)
+      file_lockable<T, L, F>::lseek (off_t offset, int whence)
       {
-        std::lock_guard<L> lock
+        std::lock_guard<F> file_lock
+          { file_locker_ };
+        internal::shared_lock_guard<L> lock
           { locker_ };
 
         return file::lseek (offset, whence);
       }
 
-    template<typename T, typename L>
+    template<typename T, typename L, typename F>
       int
-      file_lockable<T, L>::ftruncate (off_t length)
+      file_lockable<T, L, F>::ftruncate (off_t length)
       {
+        std::lock_guard<F> file_lock
+          { file_locker_ };
         std::lock_guard<L> lock
           { locker_ };
 
         return file::ftruncate (length);
       }
 
-    template<typename T, typename L>
+    template<typename T, typename L, typename F>
       int
-      file_lockable<T, L>::fsync (void)
+      file_lockable<T, L, F>::fsync (void)
       {
+#if defined(OS_INCLUDE_POSIX_IO_GROUP_COMMIT)
+        int ret;
+          {
+            std::lock_guard<F> file_lock
+              { file_locker_ };
+            std::lock_guard<L> lock
+              { locker_ };
+
+            ret = fsync_writeback ();
+          }
+        if (ret <= 0)
+          {
+            return ret;
+          }
+
+        // The device flush is done without the locks, so that
+        // concurrent fsync() calls can be merged into one flush.
+        return fsync_commit ();
+#else
+        std::lock_guard<F> file_lock
+          { file_locker_ };
         std::lock_guard<L> lock
           { locker_ };
 
         return file::fsync ();
+#endif /* defined(OS_INCLUDE_POSIX_IO_GROUP_COMMIT) */
+      }
+
+    template<typename T, typename L, typename F>
+      int
+      file_lockable<T, L, F>::fallocate (off_t offset, off_t len)
+      {
+        std::lock_guard<F> file_lock
+          { file_locker_ };
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return file::fallocate (offset, len);
+      }
+
+    template<typename T, typename L, typename F>
+      int
+      file_lockable<T, L, F>::fadvise (off_t offset, off_t len, int advice)
+      {
+        std::lock_guard<F> file_lock
+          { file_locker_ };
+        internal::shared_lock_guard<L> lock
+          { locker_ };
+
+        return file::fadvise (offset, len, advice);
       }
 
-    template<typename T, typename L>
-      typename file_lockable<T, L>::value_type&
-      file_lockable<T, L>::impl (void) const
+    template<typename T, typename L, typename F>
+      typename file_lockable<T, L, F>::value_type&
+      file_lockable<T, L, F>::impl (void) const
       {
         return static_cast<value_type&> (impl_);
       }
@@ -0,0 +1,220 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_POSIX_IO_GROUP_COMMIT_H_
+#define CMSIS_PLUS_POSIX_IO_GROUP_COMMIT_H_
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#if defined(OS_INCLUDE_POSIX_IO_GROUP_COMMIT)
+
+#include <cmsis-plus/rtos/os.h>
+
+#include <cstdint>
+
+// ----------------------------------------------------------------------------
+
+#if !defined(OS_INTEGER_POSIX_IO_GROUP_COMMIT_WINDOW_TICKS)
+#define OS_INTEGER_POSIX_IO_GROUP_COMMIT_WINDOW_TICKS (0)
+#endif
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ------------------------------------------------------------------------
+
+    class block_device;
+
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Merge concurrent device flushes.
+     * @headerfile group-commit.h <cmsis-plus/posix-io/group-commit.h>
+     * @ingroup cmsis-plus-posix-io-base
+     * @details
+     * The first caller becomes the leader, waits for the commit
+     * window, then flushes the device once for all the requests
+     * received so far. The callers arriving meanwhile only wait
+     * for the flush to complete; those arriving during the flush
+     * are served by the next one, since the flush in progress may
+     * not include their writes.
+     */
+    class group_commit
+    {
+    public:
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @brief Statistics.
+       */
+      struct statistics_t
+      {
+        // Total number of commit() calls.
+        uint32_t requests;
+        // Number of device flushes actually performed.
+        uint32_t flushes;
+      };
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      group_commit (void);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      group_commit (const group_commit&) = delete;
+      group_commit (group_commit&&) = delete;
+      group_commit&
+      operator= (const group_commit&) = delete;
+      group_commit&
+      operator= (group_commit&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      ~group_commit ();
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      /**
+       * @brief Flush the device, merged with the concurrent callers.
+       * @param [in] device Reference to the device to flush.
+       * @retval 0 The flush covering this request completed.
+       * @retval -1 The flush failed, errno set.
+       */
+      int
+      commit (block_device& device);
+
+      void
+      window (rtos::clock::duration_t ticks);
+
+      rtos::clock::duration_t
+      window (void) const;
+
+      statistics_t
+      statistics (void) const;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      mutable rtos::mutex mutex_
+        { "group-commit" };
+      rtos::condition_variable done_
+        { "group-commit" };
+
+      // Tickets, incremented for each request; compared
+      // with a difference, so they may wrap.
+      uint32_t requested_ = 0;
+      uint32_t completed_ = 0;
+
+      // The errno of the last flush, passed to all its waiters.
+      int error_ = 0;
+
+      rtos::clock::duration_t window_ =
+          OS_INTEGER_POSIX_IO_GROUP_COMMIT_WINDOW_TICKS;
+
+      statistics_t statistics_
+        { };
+
+      bool busy_ = false;
+
+      /**
+       * @endcond
+       */
+    };
+
+#pragma GCC diagnostic pop
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    inline rtos::clock::duration_t
+    group_commit::window (void) const
+    {
+      return window_;
+    }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_GROUP_COMMIT) */
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_POSIX_IO_GROUP_COMMIT_H_ */
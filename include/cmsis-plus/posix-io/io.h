@@ -41,12 +41,20 @@
 
 #include <cstddef>
 #include <cstdarg>
+#include <cstdint>
+#include <utility>
 
 // Needed for ssize_t
 #include <sys/types.h>
 
 // ----------------------------------------------------------------------------
 
+#if !defined(OS_INTEGER_POSIX_IO_SENDFILE_BUFFER_SIZE)
+#define OS_INTEGER_POSIX_IO_SENDFILE_BUFFER_SIZE (512)
+#endif
+
+// ----------------------------------------------------------------------------
+
 struct iovec;
 
 namespace os
@@ -57,6 +65,8 @@ namespace os
 
     class io;
     class io_impl;
+    class event_poll;
+    struct event_poll_entry;
 
     class file_system;
     class socket;
@@ -73,6 +83,16 @@ namespace os
     io*
     vopen (const char* path, int oflag, std::va_list args);
 
+    int
+    munmap (void* addr, std::size_t length);
+
+    int
+    select (int nfds, fd_set* readfds, fd_set* writefds, fd_set* exceptfds,
+            struct timeval* timeout);
+
+    ssize_t
+    sendfile (io& out, io& in, off_t* offset, std::size_t count);
+
     /**
      * @}
      */
@@ -124,9 +144,75 @@ namespace os
         block_device = 1 << 2,
         tty = 1 << 3,
         file = 1 << 4,
-        socket = 1 << 5
+        socket = 1 << 5,
+        pipe = 1 << 6
+      };
+
+      // The conditions reported to select().
+      using readiness_t = unsigned int;
+      struct readiness
+      {
+        enum
+          : readiness_t
+            { none = 0,
+          read = 1 << 0,
+          write = 1 << 1,
+          except = 1 << 2
+        };
       };
 
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS) || defined(__DOXYGEN__)
+
+      /**
+       * @brief Counters of one kind of operation.
+       */
+      struct operation_statistics_t
+      {
+        /**
+         * @brief Number of calls.
+         */
+        std::size_t calls;
+
+        /**
+         * @brief Number of calls that failed.
+         */
+        std::size_t errors;
+
+        /**
+         * @brief Number of bytes transferred.
+         */
+        uint64_t bytes;
+
+        /**
+         * @brief Total duration, including the time blocked,
+         *  in `clock_highres` cycles; divide by `calls` for the mean.
+         */
+        uint64_t total_cycles;
+
+        /**
+         * @brief Longest call, in `clock_highres` cycles.
+         */
+        uint64_t max_cycles;
+      };
+
+      /**
+       * @brief I/O statistics.
+       */
+      struct statistics_t
+      {
+        /**
+         * @brief The `read()`, `readv()` and `preadv()` calls.
+         */
+        operation_statistics_t read;
+
+        /**
+         * @brief The `write()`, `writev()` and `pwritev()` calls.
+         */
+        operation_statistics_t write;
+      };
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
       /**
        * @}
        */
@@ -187,6 +273,46 @@ namespace os
       virtual ssize_t
       writev (const struct iovec* iov, int iovcnt);
 
+      virtual ssize_t
+      readv (const struct iovec* iov, int iovcnt);
+
+      ssize_t
+      pread (void* buf, std::size_t nbyte, off_t offset);
+
+      ssize_t
+      pwrite (const void* buf, std::size_t nbyte, off_t offset);
+
+      virtual ssize_t
+      preadv (const struct iovec* iov, int iovcnt, off_t offset);
+
+      virtual ssize_t
+      pwritev (const struct iovec* iov, int iovcnt, off_t offset);
+
+      /**
+       * @brief Map the content into memory.
+       * @param [in] length Number of bytes to map.
+       * @param [in] prot `PROT_READ` and/or `PROT_WRITE`.
+       * @param [in] flags `MAP_SHARED` or `MAP_PRIVATE`.
+       * @param [in] offset Position of the first mapped byte.
+       * @return The address of the mapping, or `MAP_FAILED` and
+       *  the variable errno is set to indicate the error.
+       */
+      virtual void*
+      mmap (std::size_t length, int prot, int flags, off_t offset);
+
+      /**
+       * @brief Get a pointer to the content, without copying it.
+       * @param [out] buf Pointer where to store the address.
+       * @param [in] nbyte The max number of bytes.
+       * @param [in] offset Position of the first byte.
+       * @return The number of bytes available at the address, or -1
+       *  and the variable errno is set to indicate the error.
+       * @details
+       * The content is valid until the next operation on the object.
+       */
+      virtual ssize_t
+      peek (const void** buf, std::size_t nbyte, off_t offset);
+
       int
       fcntl (int cmd, ...);
 
@@ -196,6 +322,32 @@ namespace os
       int
       isatty (void);
 
+      readiness_t
+      ready (void);
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS) || defined(__DOXYGEN__)
+
+      /**
+       * @brief Copy the statistics.
+       * @param [out] stats Pointer to the destination.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      statistics (statistics_t* stats) const;
+
+      /**
+       * @brief Clear the statistics.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      clear_statistics (void);
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
       virtual int
       fstat (struct stat* buf);
 
@@ -288,6 +440,7 @@ namespace os
       // ----------------------------------------------------------------------
 
       friend class io;
+      friend class event_poll;
 
       /**
        * @name Constructors & Destructor
@@ -349,12 +502,31 @@ namespace os
       virtual ssize_t
       do_writev (const struct iovec* iov, int iovcnt);
 
+      virtual ssize_t
+      do_readv (const struct iovec* iov, int iovcnt);
+
+      virtual ssize_t
+      do_preadv (const struct iovec* iov, int iovcnt, off_t offset);
+
+      virtual ssize_t
+      do_pwritev (const struct iovec* iov, int iovcnt, off_t offset);
+
+      // Return the address of the storage, if it can be mapped
+      // directly, or MAP_FAILED with errno = ENODEV.
+      virtual void*
+      do_mmap (std::size_t length, int prot, int flags, off_t offset);
+
       virtual int
       do_vfcntl (int cmd, std::va_list args);
 
       virtual int
       do_isatty (void);
 
+      // Return the current conditions, as io::readiness bits;
+      // implementations that change them must call notify_readiness().
+      virtual io::readiness_t
+      do_ready (void);
+
       virtual int
       do_fstat (struct stat* buf);
 
@@ -373,6 +545,20 @@ namespace os
       void
       offset (off_t offset);
 
+      // The file status flags (O_NONBLOCK, O_APPEND, O_DIRECT),
+      // set by open() and by fcntl(F_SETFL).
+      int
+      status_flags (void) const;
+
+      void
+      status_flags (int flags);
+
+      bool
+      nonblocking (void) const;
+
+      void
+      notify_readiness (void);
+
       /**
        * @}
        */
@@ -386,11 +572,113 @@ namespace os
 
       off_t offset_ = 0;
 
+      int status_flags_ = 0;
+
+      // The event poll entries watching this object.
+      event_poll_entry* watchers_ = nullptr;
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      io::statistics_t statistics_
+        { };
+#endif
+
       /**
        * @endcond
        */
     };
 
+    namespace internal
+    {
+      // ----------------------------------------------------------------------
+
+      /**
+       * @brief Shared locking traits.
+       * @details
+       * Lockables that also provide `lock_shared()` and
+       * `unlock_shared()` (like `rtos::rwlock` or
+       * `estd::shared_mutex`) are locked in shared mode; all
+       * other lockables fall back to the exclusive `lock()`
+       * and `unlock()`.
+       */
+      template<typename L, typename = void>
+        struct shared_locking
+        {
+          static constexpr bool is_shared = false;
+
+          static void
+          lock (L& locker)
+          {
+            locker.lock ();
+          }
+
+          static void
+          unlock (L& locker)
+          {
+            locker.unlock ();
+          }
+        };
+
+      /**
+       * @cond ignore
+       */
+
+      template<typename L>
+        struct shared_locking<L,
+            decltype (std::declval<L&> ().lock_shared (), void ())>
+        {
+          static constexpr bool is_shared = true;
+
+          static void
+          lock (L& locker)
+          {
+            locker.lock_shared ();
+          }
+
+          static void
+          unlock (L& locker)
+          {
+            locker.unlock_shared ();
+          }
+        };
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @brief Scoped shared lock.
+       * @details
+       * Similar to `std::lock_guard`, but takes the lock in shared
+       * mode when the lockable supports it.
+       */
+      template<typename L>
+        class shared_lock_guard
+        {
+        public:
+
+          explicit
+          shared_lock_guard (L& locker) :
+              locker_ (locker)
+          {
+            shared_locking<L>::lock (locker_);
+          }
+
+          shared_lock_guard (const shared_lock_guard&) = delete;
+          shared_lock_guard&
+          operator= (const shared_lock_guard&) = delete;
+
+          ~shared_lock_guard ()
+          {
+            shared_locking<L>::unlock (locker_);
+          }
+
+        private:
+
+          L& locker_;
+        };
+
+    } /* namespace internal */
+
   // ==========================================================================
   } /* namespace posix */
 } /* namespace os */
@@ -453,6 +741,12 @@ namespace os
       offset_ = offset;
     }
 
+    inline int
+    io_impl::status_flags (void) const
+    {
+      return status_flags_;
+    }
+
   // ==========================================================================
   } /* namespace posix */
 } /* namespace os */
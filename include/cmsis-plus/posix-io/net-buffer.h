@@ -0,0 +1,145 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_POSIX_IO_NET_BUFFER_H_
+#define CMSIS_PLUS_POSIX_IO_NET_BUFFER_H_
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#include <cstddef>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ------------------------------------------------------------------------
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Network buffer, an element of a chain of buffers.
+     * @headerfile net-buffer.h <cmsis-plus/posix-io/net-buffer.h>
+     * @ingroup cmsis-plus-posix-io-base
+     *
+     * @details
+     * Similar to the lwIP `pbuf`; the buffers are allocated by the
+     * network stack (`net_stack::allocate_buffer()`), and passed
+     * between the application, the stack and the drivers without
+     * copying the payload.
+     *
+     * Each buffer is given back to its owner with `release`.
+     */
+    struct net_buffer
+    {
+      // The next buffer in the chain, or nullptr.
+      net_buffer* next;
+      // The content.
+      void* payload;
+      // The number of bytes used at payload.
+      std::size_t length;
+      // The number of bytes available at payload.
+      std::size_t capacity;
+      // Give the buffer back to its owner.
+      void
+      (*release) (net_buffer* buffer);
+      // Reserved for the owner.
+      void* owner;
+    };
+
+#pragma GCC diagnostic pop
+
+    /**
+     * @brief Get the number of bytes in a chain.
+     * @param [in] chain Pointer to the first buffer.
+     * @return The sum of the buffers lengths.
+     */
+    std::size_t
+    net_buffers_length (const net_buffer* chain);
+
+    /**
+     * @brief Release all buffers in a chain.
+     * @param [in] chain Pointer to the first buffer, may be nullptr.
+     */
+    void
+    net_buffers_release (net_buffer* chain);
+
+  } /* namespace posix */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace posix
+  {
+    // ------------------------------------------------------------------------
+
+    inline std::size_t
+    net_buffers_length (const net_buffer* chain)
+    {
+      std::size_t total = 0;
+      for (; chain != nullptr; chain = chain->next)
+        {
+          total += chain->length;
+        }
+      return total;
+    }
+
+    inline void
+    net_buffers_release (net_buffer* chain)
+    {
+      while (chain != nullptr)
+        {
+          net_buffer* next = chain->next;
+          chain->next = nullptr;
+          if (chain->release != nullptr)
+            {
+              chain->release (chain);
+            }
+          chain = next;
+        }
+    }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_POSIX_IO_NET_BUFFER_H_ */
@@ -36,6 +36,17 @@
 #include <cmsis-plus/os-app-config.h>
 #endif
 
+#include <cmsis-plus/posix-io/net-buffer.h>
+#include <cmsis-plus/rtos/os.h>
+
+#include <cstddef>
+
+// ----------------------------------------------------------------------------
+
+#if !defined(OS_INTEGER_POSIX_IO_NET_POLL_BUDGET)
+#define OS_INTEGER_POSIX_IO_NET_POLL_BUDGET (16)
+#endif
+
 // ----------------------------------------------------------------------------
 
 namespace os
@@ -48,15 +59,36 @@ namespace os
 
     // ========================================================================
 
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
     /**
      * @brief Network interface class.
      * @headerfile net-interface.h <cmsis-plus/posix-io/net-interface.h>
      * @ingroup cmsis-plus-posix-io-base
+     *
+     * @details
+     * The received frames are delivered with interrupt mitigation:
+     * the first receive interrupt masks further receive interrupts
+     * and wakes up a network thread, which polls the interface
+     * in batches, and enables the interrupts again only when
+     * there are no more frames.
      */
     class net_interface
     {
       // ----------------------------------------------------------------------
 
+    public:
+
+      /**
+       * @brief Type of the function receiving the frames.
+       * @details
+       * The function takes ownership of the buffers chain.
+       */
+      using rx_handler_t = void (*) (net_buffer* frame, void* args);
+
+      // ----------------------------------------------------------------------
+
       /**
        * @name Constructors & Destructor
        * @{
@@ -89,9 +121,351 @@ namespace os
        * @}
        */
 
-      // TODO: add content
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      /**
+       * @brief Set the function receiving the frames.
+       * @param [in] handler Pointer to function, usually in the stack.
+       * @param [in] args Pointer to function arguments.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      rx_handler (rx_handler_t handler, void* args);
+
+      /**
+       * @brief Notify the arrival of frames.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       * @note Called by the driver from the receive interrupt.
+       */
+      void
+      rx_interrupt (void);
+
+      /**
+       * @brief Deliver a batch of received frames.
+       * @param [in] budget Maximum number of frames.
+       * @return The number of frames delivered; if less than
+       *  `budget`, the interface is idle and the receive
+       *  interrupts are enabled.
+       */
+      std::size_t
+      poll (std::size_t budget = OS_INTEGER_POSIX_IO_NET_POLL_BUDGET);
+
+      /**
+       * @brief Wait for frames and deliver them, forever.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      [[noreturn]] void
+      run_rx (void);
+
+      /**
+       * @brief Thread function running `run_rx()`.
+       * @param [in] args Pointer to the `net_interface`.
+       * @return Does not return.
+       */
+      static void*
+      rx_thread (void* args);
+
+      const char*
+      name (void) const;
+
+      /**
+       * @brief Get the number of polling rounds.
+       * @par Parameters
+       *  None.
+       * @return The number of calls to `poll()`.
+       */
+      std::size_t
+      polls (void) const;
+
+      /**
+       * @brief Get the number of received frames.
+       * @par Parameters
+       *  None.
+       * @return The number of frames delivered.
+       */
+      std::size_t
+      rx_frames (void) const;
+
+      // ----------------------------------------------------------------------
+      // Support functions.
+
+      net_interface_impl&
+      impl (void) const;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      const char* name_ = nullptr;
+
+      net_interface_impl& impl_;
+
+      rx_handler_t rx_handler_ = nullptr;
+      void* rx_handler_args_ = nullptr;
+
+      std::size_t polls_ = 0;
+      std::size_t rx_frames_ = 0;
+
+      rtos::semaphore_binary rx_sem_
+        { "net-rx", 0 };
+
+      /**
+       * @endcond
+       */
+    };
+
+#pragma GCC diagnostic pop
+
+    // ========================================================================
+
+    class net_interface_impl
+    {
+      // ----------------------------------------------------------------------
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      net_interface_impl (void);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      net_interface_impl (const net_interface_impl&) = delete;
+      net_interface_impl (net_interface_impl&&) = delete;
+      net_interface_impl&
+      operator= (const net_interface_impl&) = delete;
+      net_interface_impl&
+      operator= (net_interface_impl&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      virtual
+      ~net_interface_impl ();
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      /**
+       * @brief Enable or disable the receive interrupts.
+       * @param [in] enable true to enable.
+       * @par Returns
+       *  Nothing.
+       * @note Can be called from the receive interrupt.
+       */
+      virtual void
+      do_rx_interrupts (bool enable) = 0;
+
+      /**
+       * @brief Get the next received frame.
+       * @par Parameters
+       *  None.
+       * @return Pointer to the buffers chain, or nullptr if there
+       *  are no more frames.
+       * @details
+       * With zero-copy drivers, the chain uses the receive
+       * buffers, which are replenished by the driver.
+       */
+      virtual net_buffer*
+      do_receive (void) = 0;
+
+      /**
+       * @}
+       */
     };
 
+    // ========================================================================
+
+    template<typename T>
+      class net_interface_implementable : public net_interface
+      {
+        // --------------------------------------------------------------------
+
+      public:
+
+        using value_type = T;
+
+        // --------------------------------------------------------------------
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+      public:
+
+        template<typename ... Args>
+          net_interface_implementable (const char* name, Args&&... args);
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        net_interface_implementable (const net_interface_implementable&) = delete;
+        net_interface_implementable (net_interface_implementable&&) = delete;
+        net_interface_implementable&
+        operator= (const net_interface_implementable&) = delete;
+        net_interface_implementable&
+        operator= (net_interface_implementable&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        virtual
+        ~net_interface_implementable ();
+
+        /**
+         * @}
+         */
+
+        // --------------------------------------------------------------------
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+      public:
+
+        // Support functions.
+
+        value_type&
+        impl (void) const;
+
+        /**
+         * @}
+         */
+
+        // --------------------------------------------------------------------
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        value_type impl_instance_;
+
+        /**
+         * @endcond
+         */
+      };
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace posix
+  {
+    // ------------------------------------------------------------------------
+
+    inline void
+    net_interface::rx_handler (rx_handler_t handler, void* args)
+    {
+      rx_handler_ = handler;
+      rx_handler_args_ = args;
+    }
+
+    inline const char*
+    net_interface::name (void) const
+    {
+      return name_;
+    }
+
+    inline std::size_t
+    net_interface::polls (void) const
+    {
+      return polls_;
+    }
+
+    inline std::size_t
+    net_interface::rx_frames (void) const
+    {
+      return rx_frames_;
+    }
+
+    inline net_interface_impl&
+    net_interface::impl (void) const
+    {
+      return static_cast<net_interface_impl&> (impl_);
+    }
+
+    // ========================================================================
+
+    template<typename T>
+      template<typename ... Args>
+        net_interface_implementable<T>::net_interface_implementable (
+            const char* name, Args&&... args) :
+            net_interface
+              { impl_instance_, name }, //
+            impl_instance_
+              { std::forward<Args>(args)... }
+        {
+#if defined(OS_TRACE_POSIX_IO_NET_INTERFACE)
+          OS_TRACE_PRINTF (posix_io_net_stack,
+                           "net_interface_implementable::%s(\"%s\")=@%p\n",
+                           __func__, name_, this);
+#endif
+        }
+
+    template<typename T>
+      net_interface_implementable<T>::~net_interface_implementable ()
+      {
+#if defined(OS_TRACE_POSIX_IO_NET_INTERFACE)
+        OS_TRACE_PRINTF (posix_io_net_stack,
+                         "net_interface_implementable::%s() @%p %s\n",
+                         __func__, this, name_);
+#endif
+      }
+
+    template<typename T>
+      typename net_interface_implementable<T>::value_type&
+      net_interface_implementable<T>::impl (void) const
+      {
+        return static_cast<value_type&> (impl_);
+      }
+
+  // ==========================================================================
   } /* namespace posix */
 } /* namespace os */
 
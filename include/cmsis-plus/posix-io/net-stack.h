@@ -125,6 +125,15 @@ namespace os
       virtual class socket*
       socket (int domain, int type, int protocol);
 
+      /**
+       * @brief Allocate a buffer for zero-copy transfers.
+       * @param [in] size The number of bytes needed.
+       * @return Pointer to the buffer, or nullptr and the variable
+       *  errno is set to indicate the error.
+       */
+      net_buffer*
+      allocate_buffer (std::size_t size);
+
       const char*
       name (void) const;
 
@@ -260,6 +269,9 @@ namespace os
       virtual class socket*
       do_socket (int domain, int type, int protocol) = 0;
 
+      virtual net_buffer*
+      do_allocate_buffer (std::size_t size);
+
       // ----------------------------------------------------------------------
       // Support functions.
 
@@ -572,8 +584,9 @@ namespace os
               { interface, std::forward<Args>(args)... }
         {
 #if defined(OS_TRACE_POSIX_IO_NET_STACK)
-          trace::printf ("net_stack_implementable::%s(\"%s\")=@%p\n", __func__,
-                         name_, this);
+          OS_TRACE_PRINTF (posix_io_net_stack,
+                           "net_stack_implementable::%s(\"%s\")=@%p\n",
+                           __func__, name_, this);
 #endif
         }
 
@@ -581,8 +594,9 @@ namespace os
       net_stack_implementable<T>::~net_stack_implementable ()
       {
 #if defined(OS_TRACE_POSIX_IO_NET_STACK)
-        trace::printf ("net_stack_implementable::%s() @%p %s\n", __func__, this,
-                       name_);
+        OS_TRACE_PRINTF (posix_io_net_stack,
+                         "net_stack_implementable::%s() @%p %s\n", __func__,
+                         this, name_);
 #endif
       }
 
@@ -607,7 +621,8 @@ namespace os
               { interface, locker, std::forward<Args>(args)... }
         {
 #if defined(OS_TRACE_POSIX_IO_NET_STACK)
-          trace::printf ("net_stack_lockable::%s()=%p\n", __func__, this);
+          OS_TRACE_PRINTF (posix_io_net_stack, "net_stack_lockable::%s()=%p\n",
+                           __func__, this);
 #endif
         }
 
@@ -615,7 +630,8 @@ namespace os
       net_stack_lockable<T, L>::~net_stack_lockable ()
       {
 #if defined(OS_TRACE_POSIX_IO_NET_STACK)
-        trace::printf ("net_stack_lockable::%s() @%p\n", __func__, this);
+        OS_TRACE_PRINTF (posix_io_net_stack, "net_stack_lockable::%s() @%p\n",
+                         __func__, this);
 #endif
       }
 
@@ -0,0 +1,128 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_POSIX_IO_PATH_CACHE_H_
+#define CMSIS_PLUS_POSIX_IO_PATH_CACHE_H_
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#if defined(OS_INCLUDE_POSIX_IO_PATH_CACHE)
+
+#include <sys/stat.h>
+#include <cstdint>
+
+// ----------------------------------------------------------------------------
+
+#if !defined(OS_INTEGER_POSIX_IO_PATH_CACHE_SIZE)
+#define OS_INTEGER_POSIX_IO_PATH_CACHE_SIZE (8)
+#endif
+
+#if !defined(OS_INTEGER_POSIX_IO_PATH_CACHE_PATH_MAX)
+#define OS_INTEGER_POSIX_IO_PATH_CACHE_PATH_MAX (48)
+#endif
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ------------------------------------------------------------------------
+
+    class file_system;
+
+    /**
+     * @brief Cache of the recently resolved paths.
+     * @ingroup cmsis-plus-posix-io-base
+     * @details
+     * Keeps the `stat()` results of the recently used paths, and the
+     * paths known not to exist, so repeated lookups do not walk the
+     * file system directories again.
+     *
+     * The paths are relative to the file system, with the mount point
+     * removed. The entries are valid only while the file system
+     * generation does not change; any modification through the
+     * file system, including writes to its files, increments it.
+     */
+    namespace path_cache
+    {
+      /**
+       * @brief Search a path.
+       * @param [in] fs Reference to the file system.
+       * @param [in] path The path, relative to the file system.
+       * @param [out] buf Pointer to a `stat` structure, or `nullptr`.
+       * @retval 1 The path exists, the status was copied if available.
+       * @retval 0 The path is known not to exist.
+       * @retval -1 The path is not in the cache.
+       */
+      int
+      lookup (file_system& fs, const char* path, struct stat* buf);
+
+      /**
+       * @brief Remember a path.
+       * @param [in] fs Reference to the file system.
+       * @param [in] path The path, relative to the file system.
+       * @param [in] buf Pointer to the path status, or `nullptr`
+       *  if the path does not exist.
+       * @param [in] generation The file system generation before
+       *  the lookup, so changes done meanwhile make the entry stale.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      insert (file_system& fs, const char* path, const struct stat* buf,
+              uint32_t generation);
+
+      /**
+       * @brief Remove all paths of a file system.
+       * @param [in] fs Reference to the file system.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      purge (file_system& fs);
+
+    } /* namespace path_cache */
+
+  // --------------------------------------------------------------------------
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_PATH_CACHE) */
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_POSIX_IO_PATH_CACHE_H_ */
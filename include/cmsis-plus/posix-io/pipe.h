@@ -0,0 +1,489 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_POSIX_IO_PIPE_H_
+#define CMSIS_PLUS_POSIX_IO_PIPE_H_
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#include <cmsis-plus/posix-io/io.h>
+#include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/utils/lists.h>
+
+#include <cstddef>
+
+// ----------------------------------------------------------------------------
+
+#if !defined(OS_INTEGER_POSIX_IO_PIPE_SIZE_BYTES)
+#define OS_INTEGER_POSIX_IO_PIPE_SIZE_BYTES (512)
+#endif
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ------------------------------------------------------------------------
+
+    class pipe;
+
+    /**
+     * @ingroup cmsis-plus-posix-io-func
+     * @{
+     */
+
+    /**
+     * @brief Create a pipe.
+     * @param [out] fildes Array where to store the descriptors of
+     *  the read end (`fildes[0]`) and of the write end (`fildes[1]`).
+     * @retval 0 if successful,
+     * @retval -1 otherwise and the variable errno is set to
+     *   indicate the error.
+     */
+    int
+    pipe (int fildes[2]);
+
+    /**
+     * @}
+     */
+
+    // ========================================================================
+
+    /**
+     * @brief Implementation of one end of a pipe.
+     * @headerfile pipe.h <cmsis-plus/posix-io/pipe.h>
+     * @ingroup cmsis-plus-posix-io-base
+     */
+    class pipe_end_impl : public io_impl
+    {
+      // ----------------------------------------------------------------------
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      pipe_end_impl (class pipe& p, bool writer);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      pipe_end_impl (const pipe_end_impl&) = delete;
+      pipe_end_impl (pipe_end_impl&&) = delete;
+      pipe_end_impl&
+      operator= (const pipe_end_impl&) = delete;
+      pipe_end_impl&
+      operator= (pipe_end_impl&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      virtual
+      ~pipe_end_impl () override;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      virtual bool
+      do_is_opened (void) override;
+
+      virtual ssize_t
+      do_read (void* buf, std::size_t nbyte) override;
+
+      virtual ssize_t
+      do_write (const void* buf, std::size_t nbyte) override;
+
+      virtual io::readiness_t
+      do_ready (void) override;
+
+      virtual off_t
+      do_lseek (off_t offset, int whence) override;
+
+      virtual int
+      do_close (void) override;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      class pipe& pipe_;
+      bool writer_;
+
+      /**
+       * @endcond
+       */
+    };
+
+    // ========================================================================
+
+    /**
+     * @brief One end of a pipe.
+     * @headerfile pipe.h <cmsis-plus/posix-io/pipe.h>
+     * @ingroup cmsis-plus-posix-io-base
+     */
+    class pipe_end : public io
+    {
+      // ----------------------------------------------------------------------
+
+      /**
+       * @cond ignore
+       */
+
+      friend class pipe;
+
+      /**
+       * @endcond
+       */
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      pipe_end (pipe_end_impl& impl);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      pipe_end (const pipe_end&) = delete;
+      pipe_end (pipe_end&&) = delete;
+      pipe_end&
+      operator= (const pipe_end&) = delete;
+      pipe_end&
+      operator= (pipe_end&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      virtual
+      ~pipe_end () override;
+
+      /**
+       * @}
+       */
+    };
+
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Unidirectional byte stream between two descriptors.
+     * @headerfile pipe.h <cmsis-plus/posix-io/pipe.h>
+     * @ingroup cmsis-plus-posix-io-base
+     *
+     * @details
+     * Similar to the POSIX pipes; the bytes written to the write
+     * end are kept in a ring buffer, allocated from a memory
+     * resource, until read from the read end.
+     *
+     * When a reader is already waiting on an empty pipe, the
+     * writer copies the data straight into the reader buffer,
+     * up to its size, bypassing the ring buffer; this halves the
+     * number of copies for large transfers.
+     *
+     * The pipes can be created statically and opened with
+     * `open()`, or dynamically, with `posix::pipe()`; the
+     * dynamic ones are destroyed after both ends are closed.
+     */
+    class pipe
+    {
+      // ----------------------------------------------------------------------
+
+      /**
+       * @cond ignore
+       */
+
+      friend class pipe_end_impl;
+
+      friend int
+      pipe (int fildes[2]);
+
+      /**
+       * @endcond
+       */
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      /**
+       * @brief Construct a pipe.
+       * @param [in] size The size of the ring buffer, in bytes.
+       * @param [in] mr Pointer to the memory resource used to
+       *  allocate the ring buffer.
+       */
+      pipe (std::size_t size = OS_INTEGER_POSIX_IO_PIPE_SIZE_BYTES,
+            rtos::memory::memory_resource* mr =
+                rtos::memory::get_default_resource ());
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      pipe (const pipe&) = delete;
+      pipe (pipe&&) = delete;
+      pipe&
+      operator= (const pipe&) = delete;
+      pipe&
+      operator= (pipe&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      ~pipe ();
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      /**
+       * @brief Allocate the buffer and the descriptors of both ends.
+       * @param [out] fildes Array where to store the descriptors of
+       *  the read end (`fildes[0]`) and of the write end (`fildes[1]`).
+       * @retval 0 if successful,
+       * @retval -1 otherwise and the variable errno is set to
+       *   indicate the error.
+       */
+      int
+      open (int fildes[2]);
+
+      pipe_end&
+      read_end (void);
+
+      pipe_end&
+      write_end (void);
+
+      /**
+       * @brief Get the size of the ring buffer.
+       * @par Parameters
+       *  None.
+       * @return The number of bytes.
+       */
+      std::size_t
+      size (void) const;
+
+      /**
+       * @brief Get the number of direct transfers.
+       * @par Parameters
+       *  None.
+       * @return The number of writes copied straight into the
+       *  buffer of a waiting reader.
+       */
+      std::size_t
+      handoffs (void) const;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      ssize_t
+      internal_read_ (void* buf, std::size_t nbyte, bool nonblocking);
+
+      ssize_t
+      internal_write_ (const void* buf, std::size_t nbyte, bool nonblocking);
+
+      io::readiness_t
+      internal_ready_ (bool writer) const;
+
+      void
+      internal_close_ (bool writer);
+
+      std::size_t
+      internal_copy_in_ (const char* buf, std::size_t nbyte);
+
+      std::size_t
+      internal_copy_out_ (char* buf, std::size_t nbyte);
+
+      /**
+       * @endcond
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      rtos::memory::memory_resource* mr_;
+      char* buffer_ = nullptr;
+      std::size_t size_;
+
+      // Index of the first byte to read and number of bytes.
+      std::size_t head_ = 0;
+      std::size_t count_ = 0;
+
+      // The buffer offered by a reader waiting on an empty pipe.
+      char* direct_buf_ = nullptr;
+      std::size_t direct_size_ = 0;
+      std::size_t direct_count_ = 0;
+
+      std::size_t handoffs_ = 0;
+
+      rtos::mutex mutex_
+        { "pipe" };
+      rtos::condition_variable readable_
+        { "pipe-rd" };
+      rtos::condition_variable writable_
+        { "pipe-wr" };
+
+      bool reader_open_ = false;
+      bool writer_open_ = false;
+      bool dynamic_ = false;
+
+      pipe_end_impl read_impl_;
+      pipe_end_impl write_impl_;
+
+      pipe_end read_end_;
+      pipe_end write_end_;
+
+      /**
+       * @endcond
+       */
+
+      // ----------------------------------------------------------------------
+    public:
+
+      /**
+       * @cond ignore
+       */
+
+      // Intrusive node used to link the closed dynamic pipes,
+      // destroyed by the next `posix::pipe()`.
+      utils::double_list_links deferred_links_;
+
+      /**
+       * @endcond
+       */
+    };
+
+#pragma GCC diagnostic pop
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace posix
+  {
+    // ------------------------------------------------------------------------
+
+    inline pipe_end&
+    pipe::read_end (void)
+    {
+      return read_end_;
+    }
+
+    inline pipe_end&
+    pipe::write_end (void)
+    {
+      return write_end_;
+    }
+
+    inline std::size_t
+    pipe::size (void) const
+    {
+      return size_;
+    }
+
+    inline std::size_t
+    pipe::handoffs (void) const
+    {
+      return handoffs_;
+    }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_POSIX_IO_PIPE_H_ */
@@ -32,6 +32,12 @@
 // if both prefixed and not prefixed names are ok.
 
 #define __posix_accept accept
+#define __posix_aio_cancel aio_cancel
+#define __posix_aio_error aio_error
+#define __posix_aio_read aio_read
+#define __posix_aio_return aio_return
+#define __posix_aio_suspend aio_suspend
+#define __posix_aio_write aio_write
 #define __posix_bind bind
 #define __posix_chdir chdir
 #define __posix_chmod chmod
@@ -59,22 +65,33 @@
 #define __posix_listen listen
 #define __posix_lseek lseek
 #define __posix_mkdir mkdir
+#define __posix_mmap mmap
+#define __posix_munmap munmap
 #define __posix_open open
 #define __posix_opendir opendir
+#define __posix_pipe pipe
+#define __posix_posix_fallocate posix_fallocate
+#define __posix_pread pread
+#define __posix_preadv preadv
+#define __posix_pwrite pwrite
+#define __posix_pwritev pwritev
 #define __posix_raise raise
 #define __posix_read read
 #define __posix_readdir readdir
 #define __posix_readdir_r readdir_r
 #define __posix_readlink readlink
+#define __posix_readv readv
 #define __posix_recv recv
 #define __posix_recvfrom recvfrom
 #define __posix_recvmsg recvmsg
+#define __posix_recvmmsg recvmmsg
 #define __posix_rename rename
 #define __posix_rewinddir rewinddir
 #define __posix_rmdir rmdir
 #define __posix_select select
 #define __posix_send send
 #define __posix_sendmsg sendmsg
+#define __posix_sendmmsg sendmmsg
 #define __posix_sendto sendto
 #define __posix_setsockopt setsockopt
 #define __posix_shutdown shutdown
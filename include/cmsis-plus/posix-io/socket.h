@@ -37,10 +37,18 @@
 #endif
 
 #include <cmsis-plus/posix-io/io.h>
+#include <cmsis-plus/posix-io/net-buffer.h>
 #include <cmsis-plus/posix/sys/socket.h>
 #include <cmsis-plus/utils/lists.h>
 
 #include <mutex>
+#include <time.h>
+
+// ----------------------------------------------------------------------------
+
+#if !defined(OS_INTEGER_POSIX_IO_SOCKET_SEND_IOV_MAX)
+#define OS_INTEGER_POSIX_IO_SOCKET_SEND_IOV_MAX (8)
+#endif
 
 // ----------------------------------------------------------------------------
 
@@ -141,6 +149,33 @@ namespace os
       virtual ssize_t
       sendmsg (const struct msghdr* message, int flags);
 
+      /**
+       * @brief Receive several messages with one call.
+       * @param [in,out] vmessages Array of messages.
+       * @param [in] vlen The number of messages in the array.
+       * @param [in] flags The `recvmsg()` flags, and `MSG_WAITFORONE`.
+       * @param [in] timeout Max duration, checked after each message;
+       *  nullptr to wait for all.
+       * @return The number of messages received, the length of each
+       *  in `msg_len`; or -1 and the variable errno is set to
+       *  indicate the error.
+       */
+      virtual int
+      recvmmsg (struct mmsghdr* vmessages, unsigned int vlen, int flags,
+                struct timespec* timeout);
+
+      /**
+       * @brief Send several messages with one call.
+       * @param [in,out] vmessages Array of messages.
+       * @param [in] vlen The number of messages in the array.
+       * @param [in] flags The `sendmsg()` flags.
+       * @return The number of messages sent, the length of each in
+       *  `msg_len`; or -1 and the variable errno is set to indicate
+       *  the error.
+       */
+      virtual int
+      sendmmsg (struct mmsghdr* vmessages, unsigned int vlen, int flags);
+
       virtual ssize_t
       sendto (const void* message, size_t length, int flags,
               const struct sockaddr* dest_addr, socklen_t dest_len);
@@ -155,6 +190,32 @@ namespace os
       virtual int
       sockatmark (void);
 
+      /**
+       * @brief Send a chain of buffers, without copying it.
+       * @param [in] chain Pointer to the first buffer.
+       * @param [in] flags The `send()` flags.
+       * @return The number of bytes sent, and the chain belongs to
+       *  the stack, which releases it when done; or -1 and the
+       *  variable errno is set to indicate the error, and the chain
+       *  still belongs to the caller.
+       */
+      virtual ssize_t
+      send_buffers (net_buffer* chain, int flags);
+
+      /**
+       * @brief Receive a chain of buffers, without copying it.
+       * @param [out] chain Pointer where to store the first buffer.
+       * @param [in] length The max number of bytes.
+       * @param [in] flags The `recv()` flags.
+       * @return The number of bytes received, or -1 and the variable
+       *  errno is set to indicate the error.
+       * @details
+       * The caller must give back the chain with
+       * `net_buffers_release()`.
+       */
+      virtual ssize_t
+      recv_borrow (net_buffer** chain, std::size_t length, int flags);
+
       // ----------------------------------------------------------------------
       // Support functions.
 
@@ -293,6 +354,15 @@ namespace os
       virtual ssize_t
       do_sendmsg (const struct msghdr* message, int flags) = 0;
 
+      // The defaults call do_recvmsg()/do_sendmsg() for each message;
+      // stacks override them to process the batch in one pass.
+      virtual int
+      do_recvmmsg (struct mmsghdr* vmessages, unsigned int vlen, int flags,
+                   struct timespec* timeout);
+
+      virtual int
+      do_sendmmsg (struct mmsghdr* vmessages, unsigned int vlen, int flags);
+
       virtual ssize_t
       do_sendto (const void* message, size_t length, int flags,
                  const struct sockaddr* dest_addr, socklen_t dest_len) = 0;
@@ -307,6 +377,14 @@ namespace os
       virtual int
       do_sockatmark (void) = 0;
 
+      // Stacks able to pass their buffers to the drivers override
+      // them; the default (ENOTSUP) makes the socket copy.
+      virtual ssize_t
+      do_send_buffers (net_buffer* chain, int flags);
+
+      virtual ssize_t
+      do_recv_borrow (net_buffer** chain, std::size_t length, int flags);
+
       /**
        * @}
        */
@@ -484,6 +562,14 @@ namespace os
         virtual ssize_t
         sendmsg (const struct msghdr* message, int flags) override;
 
+        virtual int
+        recvmmsg (struct mmsghdr* vmessages, unsigned int vlen, int flags,
+                  struct timespec* timeout) override;
+
+        virtual int
+        sendmmsg (struct mmsghdr* vmessages, unsigned int vlen, int flags)
+            override;
+
         virtual ssize_t
         sendto (const void* message, size_t length, int flags,
                 const struct sockaddr* dest_addr, socklen_t dest_len) override;
@@ -498,6 +584,13 @@ namespace os
         virtual int
         sockatmark (void) override;
 
+        virtual ssize_t
+        send_buffers (net_buffer* chain, int flags) override;
+
+        virtual ssize_t
+        recv_borrow (net_buffer** chain, std::size_t length, int flags)
+            override;
+
         // --------------------------------------------------------------------
         // Support functions.
 
@@ -556,7 +649,8 @@ namespace os
             { impl_instance_, ns }
       {
 #if defined(OS_TRACE_POSIX_IO_SOCKET)
-        trace::printf ("socket_implementable::%s()=@%p\n", __func__, this);
+        OS_TRACE_PRINTF (posix_io_socket, "socket_implementable::%s()=@%p\n",
+                         __func__, this);
 #endif
       }
 
@@ -564,7 +658,8 @@ namespace os
       socket_implementable<T>::~socket_implementable ()
       {
 #if defined(OS_TRACE_POSIX_IO_SOCKET)
-        trace::printf ("socket_implementable::%s() @%p\n", __func__, this);
+        OS_TRACE_PRINTF (posix_io_socket, "socket_implementable::%s() @%p\n",
+                         __func__, this);
 #endif
       }
 
@@ -585,7 +680,8 @@ namespace os
           locker_ (locker)
       {
 #if defined(OS_TRACE_POSIX_IO_SOCKET)
-        trace::printf ("socket_lockable::%s()=@%p\n", __func__, this);
+        OS_TRACE_PRINTF (posix_io_socket, "socket_lockable::%s()=@%p\n",
+                         __func__, this);
 #endif
       }
 
@@ -593,7 +689,8 @@ namespace os
       socket_lockable<T, L>::~socket_lockable ()
       {
 #if defined(OS_TRACE_POSIX_IO_SOCKET)
-        trace::printf ("socket_lockable::%s() @%p\n", __func__, this);
+        OS_TRACE_PRINTF (posix_io_socket, "socket_lockable::%s() @%p\n",
+                         __func__, this);
 #endif
       }
 
@@ -738,6 +835,31 @@ namespace os
         return socket::sendmsg (message, flags);
       }
 
+    template<typename T, typename L>
+      int
+      socket_lockable<T, L>::recvmmsg (struct mmsghdr* vmessages,
+                                       unsigned int vlen, int flags,
+                                       struct timespec* timeout)
+      {
+        // A single lock for the whole batch.
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return socket::recvmmsg (vmessages, vlen, flags, timeout);
+      }
+
+    template<typename T, typename L>
+      int
+      socket_lockable<T, L>::sendmmsg (struct mmsghdr* vmessages,
+                                       unsigned int vlen, int flags)
+      {
+        // A single lock for the whole batch.
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return socket::sendmmsg (vmessages, vlen, flags);
+      }
+
     template<typename T, typename L>
       ssize_t
       socket_lockable<T, L>::sendto (const void* message, size_t length,
@@ -783,6 +905,27 @@ namespace os
         return socket::sockatmark ();
       }
 
+    template<typename T, typename L>
+      ssize_t
+      socket_lockable<T, L>::send_buffers (net_buffer* chain, int flags)
+      {
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return socket::send_buffers (chain, flags);
+      }
+
+    template<typename T, typename L>
+      ssize_t
+      socket_lockable<T, L>::recv_borrow (net_buffer** chain,
+                                          std::size_t length, int flags)
+      {
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return socket::recv_borrow (chain, length, flags);
+      }
+
     template<typename T, typename L>
       typename socket_lockable<T, L>::value_type&
       socket_lockable<T, L>::impl (void) const
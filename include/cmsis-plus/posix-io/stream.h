@@ -0,0 +1,421 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_POSIX_IO_STREAM_H_
+#define CMSIS_PLUS_POSIX_IO_STREAM_H_
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#include <cmsis-plus/posix-io/io.h>
+#include <cmsis-plus/rtos/os.h>
+
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+
+// ----------------------------------------------------------------------------
+
+#if !defined(OS_INTEGER_POSIX_IO_STREAM_BUFFER_SIZE)
+#define OS_INTEGER_POSIX_IO_STREAM_BUFFER_SIZE (128)
+#endif
+
+#if !defined(OS_INTEGER_POSIX_IO_STREAM_PRINTF_TMP_ARRAY_SIZE)
+#define OS_INTEGER_POSIX_IO_STREAM_PRINTF_TMP_ARRAY_SIZE (128)
+#endif
+
+#if !defined(OS_INTEGER_POSIX_IO_STREAM_THREAD_LINES)
+#define OS_INTEGER_POSIX_IO_STREAM_THREAD_LINES (4)
+#endif
+
+#if !defined(OS_INTEGER_POSIX_IO_STREAM_THREAD_LINE_SIZE)
+#define OS_INTEGER_POSIX_IO_STREAM_THREAD_LINE_SIZE (80)
+#endif
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ------------------------------------------------------------------------
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Buffered stream, similar to the standard `FILE`.
+     * @headerfile stream.h <cmsis-plus/posix-io/stream.h>
+     * @ingroup cmsis-plus-posix-io-base
+     *
+     * @details
+     * A replacement for the newlib stdio, tuned for µOS++: the buffer
+     * is sized by `st_blksize`, the flushes go straight to
+     * `io::write()`/`io::writev()`, and the lock is a recursive
+     * `rtos::mutex`.
+     *
+     * With `buffering::thread_line`, each thread collects its
+     * output in a separate line buffer, without locking the
+     * stream; complete lines are written with a single `writev()`,
+     * so the lines from different threads are never mixed.
+     */
+    class stream
+    {
+    public:
+
+      /**
+       * @name Types & Constants
+       * @{
+       */
+
+      using buffering_t = uint8_t;
+      struct buffering
+      {
+        enum
+          : buffering_t
+            {
+              // Line buffered for terminals, fully buffered otherwise.
+              automatic = 0,
+              // Write when the buffer is full.
+              full = 1,
+              // Write at each new line.
+              line = 2,
+              // Write immediately.
+              none = 3,
+              // Line buffered, with a separate buffer for each thread.
+              thread_line = 4
+        };
+      };
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      /**
+       * @brief Construct a stream object instance.
+       * @param [in] target The opened object to read and write.
+       * @param [in] mode One of the `buffering` values.
+       * @param [in] buf Pointer to a buffer, or `nullptr` to allocate it.
+       * @param [in] size The buffer size, or 0 to use `st_blksize`.
+       */
+      stream (class io& target, buffering_t mode = buffering::automatic,
+              char* buf = nullptr, std::size_t size = 0);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      stream (const stream&) = delete;
+      stream (stream&&) = delete;
+      stream&
+      operator= (const stream&) = delete;
+      stream&
+      operator= (stream&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @brief Destruct the stream object instance.
+       * @details
+       * The buffered content is flushed; the io object is not closed.
+       */
+      ~stream ();
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      /**
+       * @brief Write bytes.
+       * @param [in] buf Pointer to the bytes.
+       * @param [in] nbyte The number of bytes.
+       * @return The number of bytes written, or -1 and the variable
+       *  errno is set to indicate the error.
+       */
+      ssize_t
+      write (const void* buf, std::size_t nbyte);
+
+      /**
+       * @brief Write a byte.
+       * @param [in] c The byte.
+       * @return The byte, or `EOF` if an error occurred.
+       */
+      int
+      put (int c);
+
+      /**
+       * @brief Write a string, without the terminating null.
+       * @param [in] s Pointer to the string.
+       * @return A non negative number, or `EOF` if an error occurred.
+       */
+      int
+      puts (const char* s);
+
+      /**
+       * @brief Write formatted output.
+       * @param [in] format The `printf()` style format.
+       * @return The number of bytes written, or a negative value
+       *  if an error occurred.
+       */
+      int
+      printf (const char* format, ...);
+
+      int
+      vprintf (const char* format, std::va_list args);
+
+      /**
+       * @brief Read bytes.
+       * @param [out] buf Pointer to the destination.
+       * @param [in] nbyte The max number of bytes.
+       * @return The number of bytes read, 0 at end of file, or -1 and
+       *  the variable errno is set to indicate the error.
+       * @details
+       * Like `io::read()`, it may return less than requested.
+       */
+      ssize_t
+      read (void* buf, std::size_t nbyte);
+
+      /**
+       * @brief Read a byte.
+       * @return The byte, or `EOF` at end of file or if an error
+       *  occurred.
+       */
+      int
+      get (void);
+
+      /**
+       * @brief Write the buffered content.
+       * @retval 0 if successful,
+       * @retval EOF otherwise and the variable errno is set to
+       *   indicate the error.
+       * @details
+       * With `buffering::thread_line`, also write the partial line
+       * of the calling thread.
+       */
+      int
+      flush (void);
+
+      // Similar to flockfile(), ftrylockfile(), funlockfile().
+      void
+      lock (void);
+
+      bool
+      try_lock (void);
+
+      void
+      unlock (void);
+
+      bool
+      eof (void) const;
+
+      bool
+      error (void) const;
+
+      void
+      clear_errors (void);
+
+      class io&
+      get_io (void) const;
+
+      std::size_t
+      buffer_size (void) const;
+
+      buffering_t
+      mode (void) const;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+    private:
+
+      /**
+       * @cond ignore
+       */
+
+      // A partial line of a thread, for buffering::thread_line.
+      struct thread_line_slot
+      {
+        rtos::thread* owner;
+        std::size_t count;
+        char line[OS_INTEGER_POSIX_IO_STREAM_THREAD_LINE_SIZE];
+      };
+
+      ssize_t
+      internal_write_ (const char* buf, std::size_t nbyte);
+
+      ssize_t
+      internal_write_thread_line_ (const char* buf, std::size_t nbyte);
+
+      int
+      internal_flush_ (const char* buf, std::size_t nbyte);
+
+      int
+      internal_end_read_ (void);
+
+      thread_line_slot*
+      internal_thread_slot_ (bool claim);
+
+      /**
+       * @endcond
+       */
+
+      // ----------------------------------------------------------------------
+    private:
+
+      /**
+       * @cond ignore
+       */
+
+      class io& io_;
+
+      rtos::mutex_recursive mutex_;
+
+      char* buf_ = nullptr;
+      std::size_t size_ = 0;
+      // Bytes waiting to be written.
+      std::size_t count_ = 0;
+      // Bytes read but not yet consumed, at buf_[pos_].
+      std::size_t pos_ = 0;
+      std::size_t avail_ = 0;
+
+      thread_line_slot* slots_ = nullptr;
+
+      buffering_t mode_;
+      bool allocated_ = false;
+      bool eof_ = false;
+      bool error_ = false;
+
+      /**
+       * @endcond
+       */
+    };
+
+#pragma GCC diagnostic pop
+
+  } /* namespace posix */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace posix
+  {
+    // ------------------------------------------------------------------------
+
+    inline void
+    stream::lock (void)
+    {
+      mutex_.lock ();
+    }
+
+    inline bool
+    stream::try_lock (void)
+    {
+      return mutex_.try_lock () == rtos::result::ok;
+    }
+
+    inline void
+    stream::unlock (void)
+    {
+      mutex_.unlock ();
+    }
+
+    inline bool
+    stream::eof (void) const
+    {
+      return eof_;
+    }
+
+    inline bool
+    stream::error (void) const
+    {
+      return error_;
+    }
+
+    inline void
+    stream::clear_errors (void)
+    {
+      eof_ = false;
+      error_ = false;
+    }
+
+    inline class io&
+    stream::get_io (void) const
+    {
+      return io_;
+    }
+
+    inline std::size_t
+    stream::buffer_size (void) const
+    {
+      return size_;
+    }
+
+    inline stream::buffering_t
+    stream::mode (void) const
+    {
+      return mode_;
+    }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_POSIX_IO_STREAM_H_ */
@@ -197,6 +197,157 @@ namespace os
        */
     };
 
+#pragma GCC diagnostic pop
+
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Terminal implementation with a line discipline.
+     *
+     * @details
+     * Keeps the termios attributes and assembles the input, as
+     * received by the driver with `input()`; in canonical mode
+     * the readers are woken once per line, otherwise as required
+     * by `VMIN` and `VTIME`.
+     *
+     * Drivers derive from it and implement the output, the
+     * hardware configuration and the remaining `do_tc*()`.
+     */
+    class tty_line_discipline_impl : public tty_impl
+    {
+      // ----------------------------------------------------------------------
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      tty_line_discipline_impl (char* buf, std::size_t size);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      tty_line_discipline_impl (const tty_line_discipline_impl&) = delete;
+      tty_line_discipline_impl (tty_line_discipline_impl&&) = delete;
+      tty_line_discipline_impl&
+      operator= (const tty_line_discipline_impl&) = delete;
+      tty_line_discipline_impl&
+      operator= (tty_line_discipline_impl&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      virtual
+      ~tty_line_discipline_impl ();
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      // Called by the driver with the received characters;
+      // returns how many were kept, the rest did not fit.
+      std::size_t
+      input (const char* buf, std::size_t nbyte);
+
+      // Discard the received characters, for TCIFLUSH.
+      void
+      flush_input (void);
+
+      virtual ssize_t
+      do_read (void* buf, std::size_t nbyte) override;
+
+      virtual io::readiness_t
+      do_ready (void) override;
+
+      virtual int
+      do_tcgetattr (struct termios *ptio) override;
+
+      virtual int
+      do_tcsetattr (int options, const struct termios *ptio) override;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      // Write the echoed characters; by default with do_write().
+      virtual void
+      do_echo (const char* buf, std::size_t nbyte);
+
+      // Apply the new attributes (speeds, control modes)
+      // to the hardware; by default nothing to do.
+      virtual int
+      do_configure (const struct termios *ptio);
+
+      // ----------------------------------------------------------------------
+    private:
+
+      /**
+       * @cond ignore
+       */
+
+      bool
+      is_char_ (char c, int index) const;
+
+      bool
+      is_delimiter_ (char c) const;
+
+      std::size_t
+      internal_consume_ (char* buf, std::size_t nbyte, bool line);
+
+      rtos::clock::duration_t
+      internal_vtime_ (void) const;
+
+      /**
+       * @endcond
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      struct termios termios_;
+
+      rtos::semaphore_binary input_sem_
+        { "tty", 0 };
+
+      char* buf_;
+      std::size_t size_;
+
+      // All received characters, in [0, count_); the complete
+      // lines (or all of them when not canonical) in [0, ready_).
+      std::size_t volatile count_ = 0;
+      std::size_t volatile ready_ = 0;
+
+      // An end of file was typed on an empty line.
+      bool volatile eof_ = false;
+
+      /**
+       * @endcond
+       */
+    };
+
 #pragma GCC diagnostic pop
 
     // ========================================================================
@@ -306,8 +457,8 @@ namespace os
               { std::forward<Args>(args)... }
         {
 #if defined(OS_TRACE_POSIX_IO_TTY)
-          trace::printf ("tty_implementable::%s(\"%s\")=@%p\n", __func__, name_,
-                         this);
+          OS_TRACE_PRINTF (posix_io_tty, "tty_implementable::%s(\"%s\")=@%p\n",
+                           __func__, name_, this);
 #endif
         }
 
@@ -315,8 +466,8 @@ namespace os
       tty_implementable<T>::~tty_implementable ()
       {
 #if defined(OS_TRACE_POSIX_IO_TTY)
-        trace::printf ("tty_implementable::%s() @%p %s\n", __func__, this,
-                       name_);
+        OS_TRACE_PRINTF (posix_io_tty, "tty_implementable::%s() @%p %s\n",
+                         __func__, this, name_);
 #endif
       }
 
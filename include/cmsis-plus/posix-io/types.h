@@ -32,13 +32,33 @@
 
 #include <sys/types.h>
 #include <sys/select.h>
+#include <fcntl.h>
 
+#include <cmsis-plus/posix/aio.h>
 #include <cmsis-plus/posix/dirent.h>
 #include <cmsis-plus/posix/sys/socket.h>
 #include <cmsis-plus/posix/termios.h>
 
 // ----------------------------------------------------------------------------
 
+// The advice values of posix_fadvise(), if not provided by <fcntl.h>.
+#if !defined(POSIX_FADV_NORMAL)
+#define POSIX_FADV_NORMAL       0
+#define POSIX_FADV_RANDOM       1
+#define POSIX_FADV_SEQUENTIAL   2
+#define POSIX_FADV_WILLNEED     3
+#define POSIX_FADV_DONTNEED     4
+#define POSIX_FADV_NOREUSE      5
+#endif /* !defined(POSIX_FADV_NORMAL) */
+
+// Transfers bypassing the caches, if not provided by <fcntl.h>
+// (the newlib value).
+#if !defined(O_DIRECT)
+#define O_DIRECT                0x80000
+#endif /* !defined(O_DIRECT) */
+
+// ----------------------------------------------------------------------------
+
 #ifdef __cplusplus
 
 namespace os
@@ -69,6 +89,25 @@ extern "C"
   int __attribute__((weak))
   __posix_accept (int socket, struct sockaddr* address, socklen_t* address_len);
 
+  int __attribute__((weak))
+  __posix_aio_cancel (int fildes, struct aiocb* aiocbp);
+
+  int __attribute__((weak))
+  __posix_aio_error (const struct aiocb* aiocbp);
+
+  int __attribute__((weak))
+  __posix_aio_read (struct aiocb* aiocbp);
+
+  ssize_t __attribute__((weak))
+  __posix_aio_return (struct aiocb* aiocbp);
+
+  int __attribute__((weak))
+  __posix_aio_suspend (const struct aiocb* const list[], int nent,
+                       const struct timespec* timeout);
+
+  int __attribute__((weak))
+  __posix_aio_write (struct aiocb* aiocbp);
+
   int __attribute__((weak))
   __posix_bind (int socket, const struct sockaddr* address,
                 socklen_t address_len);
@@ -171,6 +210,13 @@ extern "C"
   int __attribute__((weak))
   __posix_mkdir (const char* path, mode_t mode);
 
+  void* __attribute__((weak))
+  __posix_mmap (void* addr, size_t len, int prot, int flags, int fildes,
+                off_t off);
+
+  int __attribute__((weak))
+  __posix_munmap (void* addr, size_t len);
+
   /**
    * @brief Open file relative to directory file descriptor.
    *
@@ -193,6 +239,38 @@ extern "C"
   __attribute__((weak))
   __posix_opendir (const char* dirname);
 
+  int __attribute__((weak))
+  __posix_pipe (int fildes[2]);
+
+  /**
+   * @brief Reserve space for a file.
+   *
+   * @headerfile <fcntl.h>
+   *
+   * @param [in] fildes Non-negative file descriptor.
+   * @param [in] offset Start of the range, in bytes.
+   * @param [in] len Length of the range, in bytes.
+   *
+   * @return 0 if successful, otherwise the error number; _errno_
+   * is not set.
+   */
+  int __attribute__((weak))
+  __posix_posix_fallocate (int fildes, off_t offset, off_t len);
+
+  ssize_t __attribute__((weak))
+  __posix_pread (int fildes, void* buf, size_t nbyte, off_t offset);
+
+  ssize_t __attribute__((weak))
+  __posix_preadv (int fildes, const struct iovec* iov, int iovcnt,
+                  off_t offset);
+
+  ssize_t __attribute__((weak))
+  __posix_pwrite (int fildes, const void* buf, size_t nbyte, off_t offset);
+
+  ssize_t __attribute__((weak))
+  __posix_pwritev (int fildes, const struct iovec* iov, int iovcnt,
+                   off_t offset);
+
   int __attribute__((weak))
   __posix_raise (int sig);
 
@@ -209,6 +287,9 @@ extern "C"
   ssize_t __attribute__((weak))
   __posix_readlink (const char* path, char* buf, size_t bufsize);
 
+  ssize_t __attribute__((weak))
+  __posix_readv (int fildes, const struct iovec* iov, int iovcnt);
+
   ssize_t __attribute__((weak))
   __posix_recv (int socket, void* buffer, size_t length, int flags);
 
@@ -219,6 +300,10 @@ extern "C"
   ssize_t __attribute__((weak))
   __posix_recvmsg (int socket, struct msghdr* message, int flags);
 
+  int __attribute__((weak))
+  __posix_recvmmsg (int socket, struct mmsghdr* vmessages, unsigned int vlen,
+                    int flags, struct timespec* timeout);
+
   int __attribute__((weak))
   __posix_rename (const char* oldfn, const char* newfn);
 
@@ -238,6 +323,10 @@ extern "C"
   ssize_t __attribute__((weak))
   __posix_sendmsg (int socket, const struct msghdr* message, int flags);
 
+  int __attribute__((weak))
+  __posix_sendmmsg (int socket, struct mmsghdr* vmessages, unsigned int vlen,
+                    int flags);
+
   ssize_t __attribute__((weak))
   __posix_sendto (int socket, const void* message, size_t length, int flags,
                   const struct sockaddr* dest_addr, socklen_t dest_len);
@@ -0,0 +1,113 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef POSIX_AIO_H_
+#define POSIX_AIO_H_
+
+// ----------------------------------------------------------------------------
+
+#include <unistd.h>
+
+#if defined(_POSIX_VERSION)
+
+#pragma GCC diagnostic push
+#if defined(__clang__)
+#pragma clang diagnostic ignored "-Wgnu-include-next"
+#endif
+#include_next <aio.h>
+#pragma GCC diagnostic pop
+
+#else
+
+#include <sys/types.h>
+#include <signal.h>
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// ----------------------------------------------------------------------------
+
+// Return values of aio_cancel().
+#define AIO_ALLDONE     0
+#define AIO_CANCELED    1
+#define AIO_NOTCANCELED 2
+
+// Operations and modes of lio_listio().
+#define LIO_NOP         0
+#define LIO_READ        1
+#define LIO_WRITE       2
+
+#define LIO_NOWAIT      0
+#define LIO_WAIT        1
+
+  // --------------------------------------------------------------------------
+
+  // http://pubs.opengroup.org/onlinepubs/9699919799/basedefs/aio.h.html
+  struct aiocb
+  {
+    int aio_fildes; /* File descriptor. */
+    off_t aio_offset; /* File offset. */
+    volatile void* aio_buf; /* Location of buffer. */
+    size_t aio_nbytes; /* Length of transfer. */
+    int aio_reqprio; /* Request priority offset. */
+    struct sigevent aio_sigevent; /* Signal number and value. */
+    int aio_lio_opcode; /* Operation to be performed. */
+  };
+
+  // --------------------------------------------------------------------------
+
+  int
+  aio_cancel (int fildes, struct aiocb* aiocbp);
+
+  int
+  aio_error (const struct aiocb* aiocbp);
+
+  int
+  aio_read (struct aiocb* aiocbp);
+
+  ssize_t
+  aio_return (struct aiocb* aiocbp);
+
+  int
+  aio_suspend (const struct aiocb* const list[], int nent,
+               const struct timespec* timeout);
+
+  int
+  aio_write (struct aiocb* aiocbp);
+
+// ----------------------------------------------------------------------------
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* defined(_POSIX_VERSION) */
+
+#endif /* POSIX_AIO_H_ */
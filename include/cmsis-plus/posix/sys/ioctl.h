@@ -113,6 +113,7 @@
 
 #define BLKSSZGET  _IO(0x12,104) /* get block logical device sector size */
 #define BLKGETSIZE64 _IOR(0x12,114,size_t)  /* get device size in bytes (u64 *arg) */
+#define BLKDISCARD _IO(0x12,119) /* discard a byte range (u64 arg[2]) */
 #define BLKPBSZGET _IO(0x12,123) /* get block physical device sector size */
 
 // ----------------------------------------------------------------------------
@@ -44,6 +44,7 @@
 #else
 
 #include <sys/types.h>
+#include <cmsis-plus/posix/sys/uio.h>
 
 #ifdef __cplusplus
 extern "C"
@@ -62,6 +63,24 @@ extern "C"
     char sa_data[];  // Socket address (variable-length data).
   };
 
+  struct msghdr
+  {
+    void* msg_name;  // Optional address.
+    socklen_t msg_namelen;  // Size of address.
+    struct iovec* msg_iov;  // Scatter/gather array.
+    int msg_iovlen;  // Members in msg_iov.
+    void* msg_control;  // Ancillary data.
+    socklen_t msg_controllen;  // Ancillary data buffer len.
+    int msg_flags;  // Flags on received message.
+  };
+
+  // Non-standard, for recvmmsg() and sendmmsg().
+  struct mmsghdr
+  {
+    struct msghdr msg_hdr;  // The message.
+    unsigned int msg_len;  // Number of bytes transferred.
+  };
+
   int
   accept (int socket, struct sockaddr* address, socklen_t* address_len);
 
@@ -117,6 +136,14 @@ extern "C"
   int
   socketpair (int domain, int type, int protocol, int socket_vector[2]);
 
+  int
+  recvmmsg (int socket, struct mmsghdr* vmessages, unsigned int vlen,
+            int flags, struct timespec* timeout);
+
+  int
+  sendmmsg (int socket, struct mmsghdr* vmessages, unsigned int vlen,
+            int flags);
+
 // ----------------------------------------------------------------------------
 
 #ifdef __cplusplus
@@ -125,4 +152,9 @@ extern "C"
 
 #endif /* defined(_POSIX_VERSION) */
 
+#if !defined(MSG_WAITFORONE)
+// For recvmmsg(), block only until the first message is received.
+#define MSG_WAITFORONE (0x10000)
+#endif
+
 #endif /* POSIX_IO_SYS_SOCKET_H_ */
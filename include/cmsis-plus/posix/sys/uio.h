@@ -58,9 +58,19 @@ extern "C"
     size_t iov_len;   // The size of the memory pointed to by iov_base.
   };
 
+  ssize_t
+  readv (int fildes, const struct iovec* iov, int iovcnt);
+
   ssize_t
   writev (int fildes, const struct iovec* iov, int iovcnt);
 
+  // Non-standard, the positional versions of readv() and writev().
+  ssize_t
+  preadv (int fildes, const struct iovec* iov, int iovcnt, off_t offset);
+
+  ssize_t
+  pwritev (int fildes, const struct iovec* iov, int iovcnt, off_t offset);
+
 // ----------------------------------------------------------------------------
 
 #ifdef __cplusplus
@@ -194,6 +194,14 @@ namespace os
          */
         port::clock::timestamp_t timestamp;
 
+#if defined(OS_INCLUDE_RTOS_TIMER_SLACK)
+        /**
+         * @brief How late the action may be performed, to share the
+         *  wakeup with other nodes.
+         */
+        port::clock::duration_t slack = 0;
+#endif /* defined(OS_INCLUDE_RTOS_TIMER_SLACK) */
+
         /**
          * @}
          */
@@ -446,13 +454,42 @@ namespace os
 
       // ======================================================================
 
+#if defined(OS_USE_RTOS_READY_LIST_BITMAP)
+
       /**
-       * @brief Priority ordered list of threads waiting too run.
+       * @brief Priority indexed array of lists of threads waiting too run.
        */
-      class ready_threads_list : public utils::static_double_list
+      class ready_threads_list
       {
       public:
 
+        /**
+         * @name Types and constants
+         * @{
+         */
+
+        /**
+         * @brief Number of priority levels.
+         * @details
+         * The thread priority is an 8-bits value, so there is one
+         * FIFO for each possible value.
+         */
+        static constexpr std::size_t priorities = 256;
+
+        /**
+         * @brief Type of the bitmap words.
+         */
+        using bitmap_t = uint32_t;
+
+        /**
+         * @brief Number of bits in a bitmap word.
+         */
+        static constexpr std::size_t bitmap_bits = sizeof(bitmap_t) * 8;
+
+        /**
+         * @}
+         */
+
         /**
          * @name Constructors & Destructor
          * @{
@@ -503,11 +540,44 @@ namespace os
         void
         link (waiting_thread_node& node);
 
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING)
+
+        /**
+         * @brief Add a thread node ahead of its priority peers.
+         * @param [in] node Reference to a list node.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        link_head (waiting_thread_node& node);
+
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING) */
+
+        /**
+         * @brief Check if the list is empty.
+         * @par Parameters
+         *  None.
+         * @retval true The list has no nodes.
+         * @retval false The list has at least one node.
+         */
+        bool
+        empty (void) const;
+
+        /**
+         * @brief Count the ready threads.
+         * @par Parameters
+         *  None.
+         * @return The number of nodes in all priority levels.
+         */
+        std::size_t
+        length (void) const;
+
         /**
          * @brief Get list head.
          * @par Parameters
          *  None.
-         * @return Casted pointer to head node.
+         * @return Casted pointer to the oldest node with the
+         *  highest priority, or `nullptr` if the list is empty.
          */
         volatile waiting_thread_node*
         head (void) const;
@@ -521,140 +591,122 @@ namespace os
         thread*
         unlink_head (void);
 
-        // TODO add iterator begin(), end()
-
-        /**
-         * @}
-         */
-      };
-
-      // ======================================================================
-
-      /**
-       * @brief Priority ordered list of threads.
-       */
-      class waiting_threads_list : public utils::double_list
-      {
-      public:
-
         /**
-         * @name Types and constants
-         * @{
+         * @brief Remove a node from the list.
+         * @param [in] node Reference to a list node.
+         * @par Returns
+         *  Nothing.
          */
+        void
+        unlink (waiting_thread_node& node);
 
         /**
-         * @brief Iterator over the list threads.
+         * @brief Move a node after its thread priority changed.
+         * @param [in] node Reference to a linked list node.
+         * @par Returns
+         *  Nothing.
          */
-        using iterator = utils::double_list_iterator<thread, waiting_thread_node, &waiting_thread_node::thread_>;
+        void
+        relink (waiting_thread_node& node);
 
         /**
          * @}
          */
 
-        /**
-         * @name Constructors & Destructor
-         * @{
-         */
+      protected:
 
         /**
-         * @brief Construct a list of waiting threads.
+         * @cond ignore
          */
-        waiting_threads_list ();
 
         /**
-         * @cond ignore
+         * @brief FIFO of threads with the same priority.
          */
+        class bucket : public utils::static_double_list
+        {
+        public:
 
-        waiting_threads_list (const waiting_threads_list&) = delete;
-        waiting_threads_list (waiting_threads_list&&) = delete;
-        waiting_threads_list&
-        operator= (const waiting_threads_list&) = delete;
-        waiting_threads_list&
-        operator= (waiting_threads_list&&) = delete;
+          void
+          link_tail (waiting_thread_node& node);
 
-        /**
-         * @endcond
-         */
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING)
+          void
+          link_head (waiting_thread_node& node);
+#endif
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
+          void
+          link_deadline (waiting_thread_node& node);
+#endif
+        };
 
         /**
-         * @brief Destruct the list.
+         * @endcond
          */
-        ~waiting_threads_list ();
 
         /**
-         * @}
+         * @name Private Member Functions
+         * @{
          */
 
-      public:
-
         /**
-         * @name Public Member Functions
-         * @{
+         * @brief Get the highest priority with the bit set.
+         * @par Parameters
+         *  None.
+         * @return The priority level.
          */
+        std::size_t
+        top_priority_ (void) const;
 
         /**
-         * @brief Add a new thread node to the list.
-         * @param [in] node Reference to a list node.
+         * @brief Clear the bit of an empty priority level.
+         * @param [in] prio The priority level.
          * @par Returns
          *  Nothing.
          */
         void
-        link (waiting_thread_node& node);
+        clear_priority_ (std::size_t prio);
 
         /**
-         * @brief Get list head.
-         * @par Parameters
-         *  None.
-         * @return Casted pointer to head node.
+         * @}
          */
-        volatile waiting_thread_node*
-        head (void) const;
+
+      protected:
 
         /**
-         * @brief Wake-up one thread (the oldest with the highest priority)
-         * @par Parameters
-         *  None.
-         * @retval true The list may have further entries.
-         * @retval false The list is empty.
+         * @name Private Member Variables
+         * @{
          */
-        bool
-        resume_one (void);
 
         /**
-         * @brief Wake-up all threads in the list.
-         * @par Parameters
-         *  None.
-         * @par Returns
-         *  Nothing.
+         * @brief One bit for each non-empty bitmap word.
          */
-        void
-        resume_all (void);
+        bitmap_t summary_;
 
         /**
-         * @brief Iterator begin.
-         * @return An iterator positioned at the first element.
+         * @brief One bit for each non-empty priority level.
          */
-        iterator
-        begin () const;
+        bitmap_t bitmap_[priorities / bitmap_bits];
 
         /**
-         * @brief Iterator begin.
-         * @return An iterator positioned after the last element.
+         * @brief One FIFO list for each priority level.
+         * @details
+         * All members are BSS initialised, the lists are
+         * cleared on first use.
          */
-        iterator
-        end () const;
+        bucket buckets_[priorities];
 
         /**
          * @}
          */
       };
 
-      // ======================================================================
+#else
 
       /**
-       * @brief Ordered list of time stamp nodes.
+       * @brief Priority ordered list of threads waiting too run.
        */
-      class clock_timestamps_list : public utils::double_list
+      class ready_threads_list : public utils::static_double_list
       {
       public:
 
@@ -664,20 +716,20 @@ namespace os
          */
 
         /**
-         * @brief Construct a list of clock time stamps.
+         * @brief Construct a list of waiting threads.
          */
-        clock_timestamps_list ();
+        ready_threads_list ();
 
         /**
          * @cond ignore
          */
 
-        clock_timestamps_list (const clock_timestamps_list&) = delete;
-        clock_timestamps_list (clock_timestamps_list&&) = delete;
-        clock_timestamps_list&
-        operator= (const clock_timestamps_list&) = delete;
-        clock_timestamps_list&
-        operator= (clock_timestamps_list&&) = delete;
+        ready_threads_list (const ready_threads_list&) = delete;
+        ready_threads_list (ready_threads_list&&) = delete;
+        ready_threads_list&
+        operator= (const ready_threads_list&) = delete;
+        ready_threads_list&
+        operator= (ready_threads_list&&) = delete;
 
         /**
          * @endcond
@@ -686,7 +738,7 @@ namespace os
         /**
          * @brief Destruct the list.
          */
-        ~clock_timestamps_list ();
+        ~ready_threads_list ();
 
         /**
          * @}
@@ -706,7 +758,20 @@ namespace os
          *  Nothing.
          */
         void
-        link (timestamp_node& node);
+        link (waiting_thread_node& node);
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING)
+
+        /**
+         * @brief Add a thread node ahead of its priority peers.
+         * @param [in] node Reference to a list node.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        link_head (waiting_thread_node& node);
+
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING) */
 
         /**
          * @brief Get list head.
@@ -714,95 +779,1011 @@ namespace os
          *  None.
          * @return Casted pointer to head node.
          */
-        volatile timestamp_node*
+        volatile waiting_thread_node*
         head (void) const;
 
         /**
-         * @brief Check list time stamps.
-         * @param [in] now The current clock time stamp.
+         * @brief Remove the top node from the list.
+         * @par Parameters
+         *  None.
+         * @return Pointer to thread.
+         */
+        thread*
+        unlink_head (void);
+
+        /**
+         * @brief Remove a node from the list.
+         * @param [in] node Reference to a list node.
          * @par Returns
          *  Nothing.
          */
         void
-        check_timestamp (port::clock::timestamp_t now);
+        unlink (waiting_thread_node& node);
+
+        /**
+         * @brief Move a node after its thread priority changed.
+         * @param [in] node Reference to a linked list node.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        relink (waiting_thread_node& node);
+
+        // TODO add iterator begin(), end()
 
         /**
          * @}
          */
       };
 
+#endif /* defined(OS_USE_RTOS_READY_LIST_BITMAP) */
+
       // ======================================================================
 
+#if defined(OS_USE_RTOS_WAITING_LIST_BUCKETS)
+
       /**
-       * @brief Unordered list of threads.
+       * @brief Priority ordered list of threads, split in buckets.
        */
-      class terminated_threads_list : public utils::static_double_list
+      class waiting_threads_list
       {
       public:
 
         /**
-         * @name Constructors & Destructor
+         * @name Types and constants
          * @{
          */
 
         /**
-         * @brief Construct a list of waiting threads.
+         * @brief Number of buckets.
+         * @details
+         * One bucket for each group of priorities with the same
+         * upper 4 bits (see `thread::priority::range`).
          */
-        terminated_threads_list ();
+        static constexpr std::size_t buckets = 16;
+
+        /**
+         * @brief Bits to shift the priority to get the bucket index.
+         */
+        static constexpr std::size_t bucket_shift = 4;
+
+        /**
+         * @brief Type of the buckets bitmap.
+         */
+        using bitmap_t = uint32_t;
 
         /**
          * @cond ignore
          */
 
-        terminated_threads_list (const terminated_threads_list&) = delete;
-        terminated_threads_list (terminated_threads_list&&) = delete;
-        terminated_threads_list&
-        operator= (const terminated_threads_list&) = delete;
-        terminated_threads_list&
-        operator= (terminated_threads_list&&) = delete;
+        /**
+         * @brief Priority ordered list of threads with priorities
+         * in the same group.
+         */
+        class bucket : public utils::double_list
+        {
+        public:
+
+          constexpr
+          bucket ();
+
+          void
+          link (waiting_thread_node& node);
+
+          const utils::static_double_list_links*
+          sentinel (void) const;
+        };
 
         /**
          * @endcond
          */
 
         /**
-         * @brief Destruct the list.
+         * @brief Iterator over the list threads.
+         * @details
+         * The buckets are traversed from the highest priority down,
+         * thus the threads are enumerated in the same order as
+         * in a single priority ordered list.
          */
-        ~terminated_threads_list ();
+        class iterator
+        {
+        public:
+
+          using value_type = thread;
+          using pointer = thread*;
+          using reference = thread&;
+          using iterator_pointer = waiting_thread_node*;
+          using difference_type = ptrdiff_t;
+          using iterator_category = std::forward_iterator_tag;
+
+          constexpr
+          iterator ();
+
+          iterator (const waiting_threads_list* list, std::size_t index,
+                    iterator_pointer node);
+
+          pointer
+          operator-> () const;
+
+          reference
+          operator* () const;
+
+          iterator&
+          operator++ ();
+
+          iterator
+          operator++ (int);
+
+          bool
+          operator== (const iterator& other) const;
+
+          bool
+          operator!= (const iterator& other) const;
+
+          pointer
+          get_pointer (void) const;
+
+          iterator_pointer
+          get_iterator_pointer () const;
+
+        protected:
+
+          void
+          skip_empty_ (void);
+
+          const waiting_threads_list* list_;
+          std::size_t index_;
+          iterator_pointer node_;
+        };
 
         /**
          * @}
          */
 
-      public:
-
         /**
-         * @name Public Member Functions
+         * @name Constructors & Destructor
          * @{
          */
 
         /**
-         * @brief Add a new thread node to the list.
-         * @param [in] node Reference to a list node.
-         * @par Returns
-         *  Nothing.
+         * @brief Construct a list of waiting threads.
          */
-        void
-        link (waiting_thread_node& node);
+        waiting_threads_list ();
 
         /**
-         * @brief Get list head.
-         * @par Parameters
-         *  None.
-         * @return Casted pointer to head node.
+         * @brief Construct an empty list of waiting threads
+         *  at compile time.
+         * @param [in] tag The constant initialisation tag.
          */
-        volatile waiting_thread_node*
-        head (void) const;
-
-        // TODO add iterator begin(), end()
+        constexpr
+        waiting_threads_list (utils::constant_init_t tag);
 
         /**
-         * @}
+         * @cond ignore
+         */
+
+        waiting_threads_list (const waiting_threads_list&) = delete;
+        waiting_threads_list (waiting_threads_list&&) = delete;
+        waiting_threads_list&
+        operator= (const waiting_threads_list&) = delete;
+        waiting_threads_list&
+        operator= (waiting_threads_list&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the list.
+         */
+        ~waiting_threads_list ();
+
+        /**
+         * @}
+         */
+
+      public:
+
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+        /**
+         * @brief Add a new thread node to the list.
+         * @param [in] node Reference to a list node.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        link (waiting_thread_node& node);
+
+        /**
+         * @brief Check if the list is empty.
+         * @par Parameters
+         *  None.
+         * @retval true The list has no nodes.
+         * @retval false The list has at least one node.
+         */
+        bool
+        empty (void) const;
+
+        /**
+         * @brief Get list head.
+         * @par Parameters
+         *  None.
+         * @return Casted pointer to head node, or `nullptr` if
+         *  the list is empty.
+         */
+        volatile waiting_thread_node*
+        head (void) const;
+
+        /**
+         * @brief Wake-up one thread (the oldest with the highest priority)
+         * @par Parameters
+         *  None.
+         * @retval true The list may have further entries.
+         * @retval false The list is empty.
+         */
+        bool
+        resume_one (void);
+
+        /**
+         * @brief Wake-up all threads in the list.
+         * @par Parameters
+         *  None.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        resume_all (void);
+
+        /**
+         * @brief Move a node after its thread priority changed.
+         * @param [in] node Reference to a linked list node.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        relink (waiting_thread_node& node);
+
+        /**
+         * @brief Wake-up the threads accepted by a check function.
+         * @param [in] check Function called for each node, in priority
+         *  order; returns true if the thread should be resumed.
+         * @param [in] args Pointer passed to the check function.
+         * @return The number of threads resumed.
+         */
+        std::size_t
+        resume_if (bool
+                   (*check) (waiting_thread_node& node, void* args),
+                   void* args);
+
+        /**
+         * @brief Iterator begin.
+         * @return An iterator positioned at the first element.
+         */
+        iterator
+        begin () const;
+
+        /**
+         * @brief Iterator begin.
+         * @return An iterator positioned after the last element.
+         */
+        iterator
+        end () const;
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @name Private Member Functions
+         * @{
+         */
+
+        /**
+         * @brief Get the index of the highest non-empty bucket.
+         * @par Parameters
+         *  None.
+         * @return The bucket index, or `buckets` if all are empty.
+         */
+        std::size_t
+        top_bucket_ (void) const;
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @name Private Member Variables
+         * @{
+         */
+
+        /**
+         * @brief One prioritised list for each group of priorities.
+         */
+        bucket buckets_[buckets];
+
+        /**
+         * @brief One bit for each possibly non-empty bucket.
+         * @details
+         * Nodes are also unlinked directly, without going through
+         * the list, so a bit may be set for an empty bucket;
+         * it is cleared by `resume_one()` when the bucket is
+         * found empty.
+         */
+        bitmap_t bitmap_ = 0;
+
+        /**
+         * @}
+         */
+      };
+
+#else
+
+      /**
+       * @brief Priority ordered list of threads.
+       */
+      class waiting_threads_list : public utils::double_list
+      {
+      public:
+
+        /**
+         * @name Types and constants
+         * @{
+         */
+
+        /**
+         * @brief Iterator over the list threads.
+         */
+        using iterator = utils::double_list_iterator<thread, waiting_thread_node, &waiting_thread_node::thread_>;
+
+        /**
+         * @}
+         */
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a list of waiting threads.
+         */
+        waiting_threads_list ();
+
+        /**
+         * @brief Construct an empty list of waiting threads
+         *  at compile time.
+         * @param [in] tag The constant initialisation tag.
+         */
+        constexpr
+        waiting_threads_list (utils::constant_init_t tag);
+
+        /**
+         * @cond ignore
+         */
+
+        waiting_threads_list (const waiting_threads_list&) = delete;
+        waiting_threads_list (waiting_threads_list&&) = delete;
+        waiting_threads_list&
+        operator= (const waiting_threads_list&) = delete;
+        waiting_threads_list&
+        operator= (waiting_threads_list&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the list.
+         */
+        ~waiting_threads_list ();
+
+        /**
+         * @}
+         */
+
+      public:
+
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+        /**
+         * @brief Add a new thread node to the list.
+         * @param [in] node Reference to a list node.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        link (waiting_thread_node& node);
+
+        /**
+         * @brief Get list head.
+         * @par Parameters
+         *  None.
+         * @return Casted pointer to head node.
+         */
+        volatile waiting_thread_node*
+        head (void) const;
+
+        /**
+         * @brief Wake-up one thread (the oldest with the highest priority)
+         * @par Parameters
+         *  None.
+         * @retval true The list may have further entries.
+         * @retval false The list is empty.
+         */
+        bool
+        resume_one (void);
+
+        /**
+         * @brief Wake-up all threads in the list.
+         * @par Parameters
+         *  None.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        resume_all (void);
+
+        /**
+         * @brief Move a node after its thread priority changed.
+         * @param [in] node Reference to a linked list node.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        relink (waiting_thread_node& node);
+
+        /**
+         * @brief Wake-up the threads accepted by a check function.
+         * @param [in] check Function called for each node, in priority
+         *  order; returns true if the thread should be resumed.
+         * @param [in] args Pointer passed to the check function.
+         * @return The number of threads resumed.
+         */
+        std::size_t
+        resume_if (bool
+                   (*check) (waiting_thread_node& node, void* args),
+                   void* args);
+
+        /**
+         * @brief Iterator begin.
+         * @return An iterator positioned at the first element.
+         */
+        iterator
+        begin () const;
+
+        /**
+         * @brief Iterator begin.
+         * @return An iterator positioned after the last element.
+         */
+        iterator
+        end () const;
+
+        /**
+         * @}
+         */
+      };
+
+#endif /* defined(OS_USE_RTOS_WAITING_LIST_BUCKETS) */
+
+      // ======================================================================
+
+#if defined(OS_USE_RTOS_CLOCK_TIMER_WHEEL)
+      class clock_timestamps_wheel;
+#endif /* defined(OS_USE_RTOS_CLOCK_TIMER_WHEEL) */
+
+      /**
+       * @brief Ordered list of time stamp nodes.
+       */
+      class clock_timestamps_list : public utils::double_list
+      {
+      public:
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a list of clock time stamps.
+         */
+        clock_timestamps_list ();
+
+        /**
+         * @cond ignore
+         */
+
+        clock_timestamps_list (const clock_timestamps_list&) = delete;
+        clock_timestamps_list (clock_timestamps_list&&) = delete;
+        clock_timestamps_list&
+        operator= (const clock_timestamps_list&) = delete;
+        clock_timestamps_list&
+        operator= (clock_timestamps_list&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the list.
+         */
+        ~clock_timestamps_list ();
+
+        /**
+         * @}
+         */
+
+      public:
+
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+        /**
+         * @brief Add a new thread node to the list.
+         * @param [in] node Reference to a list node.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        link (timestamp_node& node);
+
+        /**
+         * @brief Move all nodes of a sorted list to this list.
+         * @param [in] batch Reference to a list sorted by time stamps.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        merge (clock_timestamps_list& batch);
+
+#if defined(OS_USE_RTOS_CLOCK_RETIMING)
+
+        /**
+         * @brief Scale the time left to all time stamps.
+         * @param [in] now The current time stamp.
+         * @param [in] numerator The new clock frequency.
+         * @param [in] denominator The old clock frequency.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        rescale (port::clock::timestamp_t now, uint32_t numerator,
+                 uint32_t denominator);
+
+#endif /* defined(OS_USE_RTOS_CLOCK_RETIMING) */
+
+        /**
+         * @brief Get list head.
+         * @par Parameters
+         *  None.
+         * @return Casted pointer to head node.
+         */
+        volatile timestamp_node*
+        head (void) const;
+
+        /**
+         * @brief Check list time stamps.
+         * @param [in] now The current clock time stamp.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        check_timestamp (port::clock::timestamp_t now);
+
+#if defined(OS_USE_RTOS_CLOCK_TIMER_WHEEL)
+
+        /**
+         * @brief Check if the list is empty.
+         * @par Parameters
+         *  None.
+         * @retval true The list has no nodes.
+         * @retval false The list has at least one node.
+         */
+        bool
+        empty (void) const;
+
+        /**
+         * @brief Keep the nodes in a timer wheel.
+         * @param [in] wheel Pointer to the timer wheel.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        wheel (clock_timestamps_wheel* wheel);
+
+#endif /* defined(OS_USE_RTOS_CLOCK_TIMER_WHEEL) */
+
+#if defined(OS_USE_RTOS_HIGHRES_COMPARE_MATCH)
+
+        /**
+         * @brief Arm the `hrclock` compare match when the head changes.
+         * @par Parameters
+         *  None.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        compare_match (void);
+
+#endif /* defined(OS_USE_RTOS_HIGHRES_COMPARE_MATCH) */
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        // Never later than the head time stamp; all ones when
+        // the list is empty. Zero (the BSS value) only forces
+        // the next check to read the list.
+        port::clock::timestamp_t head_timestamp_ = 0;
+
+        /**
+         * @endcond
+         */
+
+#if defined(OS_USE_RTOS_CLOCK_TIMER_WHEEL)
+
+      protected:
+
+        /**
+         * @name Private Member Variables
+         * @{
+         */
+
+        /**
+         * @brief Pointer to the timer wheel, if any.
+         * @details
+         * When set, all operations are forwarded to the wheel
+         * and the list itself remains empty.
+         */
+        clock_timestamps_wheel* wheel_ = nullptr;
+
+        /**
+         * @}
+         */
+
+#endif /* defined(OS_USE_RTOS_CLOCK_TIMER_WHEEL) */
+
+#if defined(OS_USE_RTOS_HIGHRES_COMPARE_MATCH)
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        bool compare_match_ = false;
+
+        /**
+         * @endcond
+         */
+
+#endif /* defined(OS_USE_RTOS_HIGHRES_COMPARE_MATCH) */
+      };
+
+#if defined(OS_USE_RTOS_CLOCK_TIMER_WHEEL)
+
+#if !defined(OS_INTEGER_RTOS_CLOCK_TIMER_WHEEL_SLOT_BITS)
+#define OS_INTEGER_RTOS_CLOCK_TIMER_WHEEL_SLOT_BITS         (5)
+#endif
+
+      // ======================================================================
+
+      /**
+       * @brief Hierarchical timer wheel of time stamp nodes.
+       * @details
+       * The wheel has several levels, each with an array of
+       * slots; level 0 has one slot for each time stamp in the
+       * current window, and each higher level has one slot for
+       * each window of the level below.
+       *
+       * Linking a node and unlinking it are constant time, and
+       * on each clock tick only the slot of the current time stamp
+       * is processed, plus, when a window ends, the slot of the
+       * next window at the higher levels, whose nodes are moved
+       * to the lower levels (cascaded).
+       */
+      class clock_timestamps_wheel
+      {
+      public:
+
+        /**
+         * @name Types and constants
+         * @{
+         */
+
+        /**
+         * @brief Number of levels.
+         */
+        static constexpr std::size_t levels = 4;
+
+        /**
+         * @brief Number of bits used to index the slots.
+         */
+        static constexpr std::size_t slot_bits =
+            OS_INTEGER_RTOS_CLOCK_TIMER_WHEEL_SLOT_BITS;
+
+        /**
+         * @brief Number of slots in each level.
+         */
+        static constexpr std::size_t slots = (1u << slot_bits);
+
+        /**
+         * @}
+         */
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a timer wheel.
+         */
+        clock_timestamps_wheel ();
+
+        /**
+         * @cond ignore
+         */
+
+        clock_timestamps_wheel (const clock_timestamps_wheel&) = delete;
+        clock_timestamps_wheel (clock_timestamps_wheel&&) = delete;
+        clock_timestamps_wheel&
+        operator= (const clock_timestamps_wheel&) = delete;
+        clock_timestamps_wheel&
+        operator= (clock_timestamps_wheel&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the timer wheel.
+         */
+        ~clock_timestamps_wheel ();
+
+        /**
+         * @}
+         */
+
+      public:
+
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+        /**
+         * @brief Add a new node to the wheel.
+         * @param [in] node Reference to a list node.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        link (timestamp_node& node);
+
+        /**
+         * @brief Get the node with the earliest time stamp.
+         * @par Parameters
+         *  None.
+         * @return Pointer to the node, or `nullptr` if the wheel is empty.
+         */
+        volatile timestamp_node*
+        head (void) const;
+
+        /**
+         * @brief Check if the wheel is empty.
+         * @par Parameters
+         *  None.
+         * @retval true The wheel has no nodes.
+         * @retval false The wheel has at least one node.
+         */
+        bool
+        empty (void) const;
+
+        /**
+         * @brief Check the wheel time stamps.
+         * @param [in] now The current clock time stamp.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        check_timestamp (port::clock::timestamp_t now);
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        /**
+         * @brief Unordered list of nodes in the same slot.
+         */
+        class slot : public utils::double_list
+        {
+        public:
+
+          void
+          link_tail (timestamp_node& node);
+
+          timestamp_node*
+          earliest (void) const;
+        };
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @name Private Member Functions
+         * @{
+         */
+
+        /**
+         * @brief Get the slot index of a time stamp.
+         * @param [in] timestamp The time stamp.
+         * @param [in] level The wheel level.
+         * @return The slot index.
+         */
+        static std::size_t
+        index_ (port::clock::timestamp_t timestamp, std::size_t level);
+
+        /**
+         * @brief Run the actions of all nodes in a slot.
+         * @param [in] slt Reference to the slot.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        fire_ (slot& slt);
+
+        /**
+         * @brief Move the nodes of a slot to the lower levels.
+         * @param [in] level The wheel level.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        cascade_ (std::size_t level);
+
+        /**
+         * @brief Move all nodes to match a new wheel time.
+         * @param [in] now The new wheel time stamp.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        rebuild_ (port::clock::timestamp_t now);
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @name Private Member Variables
+         * @{
+         */
+
+        /**
+         * @brief The last processed time stamp.
+         */
+        port::clock::timestamp_t time_ = 0;
+
+        /**
+         * @brief Ordered list of nodes already due.
+         * @details
+         * Nodes linked with time stamps not in the future are
+         * kept here, and are processed on the next check.
+         */
+        clock_timestamps_list expired_;
+
+        /**
+         * @brief The slots of all levels.
+         */
+        slot slots_[levels][slots];
+
+        /**
+         * @}
+         */
+      };
+
+#endif /* defined(OS_USE_RTOS_CLOCK_TIMER_WHEEL) */
+
+      // ======================================================================
+
+      /**
+       * @brief Unordered list of threads.
+       */
+      class terminated_threads_list : public utils::static_double_list
+      {
+      public:
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a list of waiting threads.
+         */
+        terminated_threads_list ();
+
+        /**
+         * @cond ignore
+         */
+
+        terminated_threads_list (const terminated_threads_list&) = delete;
+        terminated_threads_list (terminated_threads_list&&) = delete;
+        terminated_threads_list&
+        operator= (const terminated_threads_list&) = delete;
+        terminated_threads_list&
+        operator= (terminated_threads_list&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the list.
+         */
+        ~terminated_threads_list ();
+
+        /**
+         * @}
+         */
+
+      public:
+
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+        /**
+         * @brief Add a new thread node to the list.
+         * @param [in] node Reference to a list node.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        link (waiting_thread_node& node);
+
+        /**
+         * @brief Get list head.
+         * @par Parameters
+         *  None.
+         * @return Casted pointer to head node.
+         */
+        volatile waiting_thread_node*
+        head (void) const;
+
+        // TODO add iterator begin(), end()
+
+        /**
+         * @}
          */
 
       };
@@ -906,14 +1887,245 @@ namespace os
         ;
       }
 
+#if defined(OS_USE_RTOS_READY_LIST_BITMAP)
+
+      inline bool
+      ready_threads_list::empty (void) const
+      {
+        return (summary_ == 0);
+      }
+
+      /**
+       * @details
+       * Bit `n` of word `w` in the bitmap represents priority
+       * `w * 32 + n`; bit `w` in the summary word tells that
+       * word `w` is not zero. Two _count leading zeros_ are
+       * enough to identify the highest priority.
+       */
+      inline std::size_t
+      ready_threads_list::top_priority_ (void) const
+      {
+        std::size_t word = (bitmap_bits - 1)
+            - static_cast<std::size_t> (__builtin_clz (summary_));
+        std::size_t bit = (bitmap_bits - 1)
+            - static_cast<std::size_t> (__builtin_clz (bitmap_[word]));
+
+        return (word * bitmap_bits) + bit;
+      }
+
+      inline volatile waiting_thread_node*
+      ready_threads_list::head (void) const
+      {
+        if (empty ())
+          {
+            return nullptr;
+          }
+        return static_cast<volatile waiting_thread_node*> (buckets_[top_priority_ ()].head ());
+      }
+
+      inline void
+      ready_threads_list::bucket::link_tail (waiting_thread_node& node)
+      {
+        if (uninitialized ())
+          {
+            // If this is the first time, initialise the list to empty.
+            clear ();
+          }
+
+        insert_after (node,
+                      const_cast<utils::static_double_list_links*> (tail ()));
+      }
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING)
+
+      inline void
+      ready_threads_list::bucket::link_head (waiting_thread_node& node)
+      {
+        if (uninitialized ())
+          {
+            // If this is the first time, initialise the list to empty.
+            clear ();
+          }
+
+        insert_after (node, &head_);
+      }
+
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING) */
+
+#else
+
       inline volatile waiting_thread_node*
       ready_threads_list::head (void) const
       {
         return static_cast<volatile waiting_thread_node*> (static_double_list::head ());
       }
 
+      inline void
+      ready_threads_list::unlink (waiting_thread_node& node)
+      {
+        node.unlink ();
+      }
+
+#endif /* defined(OS_USE_RTOS_READY_LIST_BITMAP) */
+
       // ======================================================================
 
+#if defined(OS_USE_RTOS_WAITING_LIST_BUCKETS)
+
+      /**
+       * @details
+       * Equivalent to `clear()`, but also usable for the constant
+       * initialisation of the list.
+       */
+      constexpr
+      waiting_threads_list::bucket::bucket () :
+          utils::double_list
+            { utils::constant_init }
+      {
+        ;
+      }
+
+      inline const utils::static_double_list_links*
+      waiting_threads_list::bucket::sentinel (void) const
+      {
+        return &head_;
+      }
+
+      constexpr
+      waiting_threads_list::iterator::iterator () :
+          list_ (nullptr), //
+          index_ (0), //
+          node_ (nullptr)
+      {
+        ;
+      }
+
+      inline typename waiting_threads_list::iterator::pointer
+      waiting_threads_list::iterator::operator-> () const
+      {
+        return get_pointer ();
+      }
+
+      inline typename waiting_threads_list::iterator::reference
+      waiting_threads_list::iterator::operator* () const
+      {
+        return *get_pointer ();
+      }
+
+      inline waiting_threads_list::iterator&
+      waiting_threads_list::iterator::operator++ ()
+      {
+        node_ = static_cast<iterator_pointer> (node_->next ());
+        skip_empty_ ();
+        return *this;
+      }
+
+      inline waiting_threads_list::iterator
+      waiting_threads_list::iterator::operator++ (int)
+      {
+        const auto tmp = *this;
+        ++(*this);
+        return tmp;
+      }
+
+      inline bool
+      waiting_threads_list::iterator::operator== (const iterator& other) const
+      {
+        return node_ == other.node_;
+      }
+
+      inline bool
+      waiting_threads_list::iterator::operator!= (const iterator& other) const
+      {
+        return node_ != other.node_;
+      }
+
+      inline typename waiting_threads_list::iterator::pointer
+      waiting_threads_list::iterator::get_pointer (void) const
+      {
+        return node_->thread_;
+      }
+
+      inline typename waiting_threads_list::iterator::iterator_pointer
+      waiting_threads_list::iterator::get_iterator_pointer () const
+      {
+        return node_;
+      }
+
+      /**
+       * @details
+       * The initial list status is empty.
+       */
+      inline
+      waiting_threads_list::waiting_threads_list ()
+      {
+        ;
+      }
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+      /**
+       * @details
+       * The buckets are constructed by their `constexpr` default
+       * constructor.
+       */
+      constexpr
+      waiting_threads_list::waiting_threads_list (utils::constant_init_t tag) :
+          bitmap_ (0)
+      {
+        ;
+      }
+
+#pragma GCC diagnostic pop
+
+      inline
+      waiting_threads_list::~waiting_threads_list ()
+      {
+        ;
+      }
+
+      inline bool
+      waiting_threads_list::empty (void) const
+      {
+        return (top_bucket_ () == buckets);
+      }
+
+      inline volatile waiting_thread_node*
+      waiting_threads_list::head (void) const
+      {
+        std::size_t index = top_bucket_ ();
+        if (index == buckets)
+          {
+            return nullptr;
+          }
+        return static_cast<volatile waiting_thread_node*> (buckets_[index].head ());
+      }
+
+      inline waiting_threads_list::iterator
+      waiting_threads_list::begin () const
+      {
+        std::size_t index = top_bucket_ ();
+        if (index == buckets)
+          {
+            return end ();
+          }
+        return iterator
+          {
+              this,
+              index,
+              static_cast<iterator::iterator_pointer> (const_cast<utils::static_double_list_links*> (buckets_[index].head ())) };
+      }
+
+      inline waiting_threads_list::iterator
+      waiting_threads_list::end () const
+      {
+        return iterator
+          { this, 0, nullptr };
+      }
+
+#else
+
       /**
        * @details
        * The initial list status is empty.
@@ -924,6 +2136,14 @@ namespace os
         ;
       }
 
+      constexpr
+      waiting_threads_list::waiting_threads_list (utils::constant_init_t tag) :
+          utils::double_list
+            { tag }
+      {
+        ;
+      }
+
       inline
       waiting_threads_list::~waiting_threads_list ()
       {
@@ -952,6 +2172,8 @@ namespace os
               static_cast<waiting_threads_list::iterator::iterator_pointer> (const_cast<utils::static_double_list_links*> (&head_)) };
       }
 
+#endif /* defined(OS_USE_RTOS_WAITING_LIST_BUCKETS) */
+
       // ======================================================================
 
       inline
@@ -969,9 +2191,67 @@ namespace os
       inline volatile timestamp_node*
       clock_timestamps_list::head (void) const
       {
+#if defined(OS_USE_RTOS_CLOCK_TIMER_WHEEL)
+        if (wheel_ != nullptr)
+          {
+            return wheel_->head ();
+          }
+#endif /* defined(OS_USE_RTOS_CLOCK_TIMER_WHEEL) */
         return static_cast<volatile timestamp_node*> (double_list::head ());
       }
 
+#if defined(OS_USE_RTOS_CLOCK_TIMER_WHEEL)
+
+      inline bool
+      clock_timestamps_list::empty (void) const
+      {
+        if (wheel_ != nullptr)
+          {
+            return wheel_->empty ();
+          }
+        return double_list::empty ();
+      }
+
+      inline void
+      clock_timestamps_list::wheel (clock_timestamps_wheel* wheel)
+      {
+        wheel_ = wheel;
+      }
+
+      // ======================================================================
+
+      inline
+      clock_timestamps_wheel::clock_timestamps_wheel ()
+      {
+        ;
+      }
+
+      inline
+      clock_timestamps_wheel::~clock_timestamps_wheel ()
+      {
+        ;
+      }
+
+      inline std::size_t
+      clock_timestamps_wheel::index_ (port::clock::timestamp_t timestamp,
+                                      std::size_t level)
+      {
+        return static_cast<std::size_t> (timestamp >> (level * slot_bits))
+            & (slots - 1);
+      }
+
+#endif /* defined(OS_USE_RTOS_CLOCK_TIMER_WHEEL) */
+
+#if defined(OS_USE_RTOS_HIGHRES_COMPARE_MATCH)
+
+      inline void
+      clock_timestamps_list::compare_match (void)
+      {
+        compare_match_ = true;
+      }
+
+#endif /* defined(OS_USE_RTOS_HIGHRES_COMPARE_MATCH) */
+
       // ======================================================================
 
       /**
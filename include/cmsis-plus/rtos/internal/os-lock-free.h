@@ -0,0 +1,207 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_RTOS_INTERNAL_OS_LOCK_FREE_H_
+#define CMSIS_PLUS_RTOS_INTERNAL_OS_LOCK_FREE_H_
+
+// ----------------------------------------------------------------------------
+
+#ifdef  __cplusplus
+
+#include <cmsis-plus/rtos/os-decls.h>
+
+namespace os
+{
+  namespace rtos
+  {
+    namespace internal
+    {
+
+      // ======================================================================
+
+      /**
+       * @brief Lock-free list of free blocks.
+       *
+       * @details
+       * A single linked LIFO list of fixed size blocks, which can be
+       * accessed concurrently from threads and from interrupts of any
+       * priority, without critical sections.
+       *
+       * The head keeps the index of the first block in the lower
+       * half of the word and a tag in the upper half; the tag
+       * is incremented by each change, so a compare and swap
+       * with a head read before a pop/push sequence by another
+       * context fails (the ABA problem).
+       *
+       * On Cortex-M3 and up, the atomic operations are
+       * implemented with LDREX/STREX.
+       */
+      class lock_free_block_list
+      {
+
+      public:
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct an empty list.
+         */
+        lock_free_block_list () = default;
+
+        /**
+         * @cond ignore
+         */
+
+        lock_free_block_list (const lock_free_block_list&) = delete;
+        lock_free_block_list (lock_free_block_list&&) = delete;
+        lock_free_block_list&
+        operator= (const lock_free_block_list&) = delete;
+        lock_free_block_list&
+        operator= (lock_free_block_list&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the list.
+         */
+        ~lock_free_block_list () = default;
+
+        /**
+         * @}
+         */
+
+      public:
+
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+        /**
+         * @brief Link all blocks in the list.
+         * @param [in] addr Address of the first block.
+         * @param [in] blocks Number of blocks.
+         * @param [in] block_size_bytes Size of a block, in bytes.
+         * @par Returns
+         *  Nothing.
+         *
+         * @note Not thread safe.
+         */
+        void
+        init (void* addr, std::size_t blocks, std::size_t block_size_bytes)
+            noexcept;
+
+        /**
+         * @brief Remove the first block from the list.
+         * @par Parameters
+         *  None.
+         * @return Pointer to block, or `nullptr` if the list is empty.
+         */
+        void*
+        pop (void) noexcept;
+
+        /**
+         * @brief Add a block to the beginning of the list.
+         * @param [in] block Pointer to block.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        push (void* block) noexcept;
+
+        /**
+         * @brief Check if the list is empty.
+         * @par Parameters
+         *  None.
+         * @retval true The list has no blocks.
+         * @retval false The list has at least one block.
+         */
+        bool
+        empty (void) const noexcept;
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        static constexpr std::size_t index_bits = sizeof(std::size_t) * 8 / 2;
+        static constexpr std::size_t index_mask = (static_cast<std::size_t> (1)
+            << index_bits) - 1;
+        static constexpr std::size_t tag_one = index_mask + 1;
+
+        char* addr_ = nullptr;
+        std::size_t block_size_bytes_ = 0;
+
+        // The index of the first block plus one, 0 for an empty list,
+        // and the tag. Accessed only with atomic operations.
+        std::size_t head_ = 0;
+
+        /**
+         * @endcond
+         */
+
+      };
+    /* class lock_free_block_list */
+
+    // ------------------------------------------------------------------------
+    } /* namespace internal */
+  } /* namespace rtos */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace rtos
+  {
+    namespace internal
+    {
+
+      inline bool
+      lock_free_block_list::empty (void) const noexcept
+      {
+        return (__atomic_load_n (&head_, __ATOMIC_RELAXED) & index_mask) == 0;
+      }
+
+    // ------------------------------------------------------------------------
+    } /* namespace internal */
+  } /* namespace rtos */
+} /* namespace os */
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_RTOS_INTERNAL_OS_LOCK_FREE_H_ */
@@ -0,0 +1,252 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_RTOS_INTERNAL_OS_SPINLOCK_H_
+#define CMSIS_PLUS_RTOS_INTERNAL_OS_SPINLOCK_H_
+
+// ----------------------------------------------------------------------------
+
+#ifdef  __cplusplus
+
+#include <cmsis-plus/rtos/os-decls.h>
+
+namespace os
+{
+  namespace rtos
+  {
+    namespace internal
+    {
+
+      // ======================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+      /**
+       * @brief Ticket spin lock.
+       *
+       * @details
+       * Mutual exclusion between cores; the cores acquire the lock
+       * in the order they asked for it, so none of them starves.
+       *
+       * It does not mask interrupts; to be used from interrupts too,
+       * it must be acquired with the interrupts disabled.
+       */
+      class spinlock
+      {
+      public:
+
+        constexpr
+        spinlock ();
+
+        spinlock (const spinlock&) = delete;
+        spinlock (spinlock&&) = delete;
+        spinlock&
+        operator= (const spinlock&) = delete;
+        spinlock&
+        operator= (spinlock&&) = delete;
+
+        ~spinlock () = default;
+
+        void
+        lock (void) noexcept;
+
+        bool
+        try_lock (void) noexcept;
+
+        void
+        unlock (void) noexcept;
+
+        bool
+        locked (void) const noexcept;
+
+      protected:
+
+        std::size_t next_;
+        std::size_t serving_;
+      };
+
+      // ======================================================================
+
+      /**
+       * @brief Recursive spin lock, owned by a core.
+       *
+       * @details
+       * The kernel lock, taken by `interrupts::critical_section`
+       * in SMP configurations. A core that already owns it only
+       * increments the nesting count, so critical sections can be
+       * nested as on a single core.
+       *
+       * Must be used with the local interrupts disabled.
+       */
+      class kernel_lock
+      {
+      public:
+
+        constexpr
+        kernel_lock ();
+
+        kernel_lock (const kernel_lock&) = delete;
+        kernel_lock (kernel_lock&&) = delete;
+        kernel_lock&
+        operator= (const kernel_lock&) = delete;
+        kernel_lock&
+        operator= (kernel_lock&&) = delete;
+
+        ~kernel_lock () = default;
+
+        void
+        lock (void) noexcept;
+
+        void
+        unlock (void) noexcept;
+
+        bool
+        owned (void) const noexcept;
+
+      protected:
+
+        static constexpr std::size_t no_owner = static_cast<std::size_t> (-1);
+
+        spinlock spinlock_;
+        std::size_t owner_;
+        std::size_t depth_;
+      };
+
+#pragma GCC diagnostic pop
+
+    // ------------------------------------------------------------------------
+    } /* namespace internal */
+  } /* namespace rtos */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace rtos
+  {
+    namespace internal
+    {
+
+      // ======================================================================
+
+      constexpr
+      spinlock::spinlock () :
+          next_ (0), //
+          serving_ (0)
+      {
+        ;
+      }
+
+      inline void
+      spinlock::lock (void) noexcept
+      {
+        std::size_t ticket = __atomic_fetch_add (&next_, 1, __ATOMIC_RELAXED);
+        while (__atomic_load_n (&serving_, __ATOMIC_ACQUIRE) != ticket)
+          {
+            ;
+          }
+      }
+
+      inline bool
+      spinlock::try_lock (void) noexcept
+      {
+        std::size_t ticket = __atomic_load_n (&serving_, __ATOMIC_ACQUIRE);
+        std::size_t expected = ticket;
+        return __atomic_compare_exchange_n (&next_, &expected, ticket + 1,
+                                            false, __ATOMIC_ACQUIRE,
+                                            __ATOMIC_RELAXED);
+      }
+
+      inline void
+      spinlock::unlock (void) noexcept
+      {
+        // Only the owner writes it, no need for a read-modify-write.
+        __atomic_store_n (&serving_,
+                          __atomic_load_n (&serving_, __ATOMIC_RELAXED) + 1,
+                          __ATOMIC_RELEASE);
+      }
+
+      inline bool
+      spinlock::locked (void) const noexcept
+      {
+        return __atomic_load_n (&next_, __ATOMIC_RELAXED)
+            != __atomic_load_n (&serving_, __ATOMIC_RELAXED);
+      }
+
+      // ======================================================================
+
+      constexpr
+      kernel_lock::kernel_lock () :
+          owner_ (no_owner), //
+          depth_ (0)
+      {
+        ;
+      }
+
+      inline void
+      kernel_lock::lock (void) noexcept
+      {
+        std::size_t core = port::core::id ();
+        if (__atomic_load_n (&owner_, __ATOMIC_RELAXED) == core)
+          {
+            // Nested, the interrupts are disabled on this core.
+            ++depth_;
+            return;
+          }
+
+        spinlock_.lock ();
+        __atomic_store_n (&owner_, core, __ATOMIC_RELAXED);
+        depth_ = 1;
+      }
+
+      inline void
+      kernel_lock::unlock (void) noexcept
+      {
+        if (--depth_ == 0)
+          {
+            __atomic_store_n (&owner_, no_owner, __ATOMIC_RELAXED);
+            spinlock_.unlock ();
+          }
+      }
+
+      inline bool
+      kernel_lock::owned (void) const noexcept
+      {
+        return __atomic_load_n (&owner_, __ATOMIC_RELAXED) == port::core::id ();
+      }
+
+    // ------------------------------------------------------------------------
+    } /* namespace internal */
+  } /* namespace rtos */
+} /* namespace os */
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_RTOS_INTERNAL_OS_SPINLOCK_H_ */
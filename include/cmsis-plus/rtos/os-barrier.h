@@ -0,0 +1,494 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_RTOS_OS_BARRIER_H_
+#define CMSIS_PLUS_RTOS_OS_BARRIER_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#include <cmsis-plus/rtos/os-decls.h>
+
+#include <cstddef>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Single use **latch**.
+     * @headerfile os.h <cmsis-plus/rtos/os.h>
+     * @ingroup cmsis-plus-rtos-semaphore
+     *
+     * @details
+     * A down counter, initialised with the number of expected
+     * events; the threads waiting for it are released together
+     * when the counter reaches zero, and it cannot be reset.
+     */
+    class latch : public internal::object_named_system
+    {
+    public:
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+      /**
+       * @brief Construct a latch object instance.
+       * @param [in] expected The initial count.
+       */
+      latch (std::ptrdiff_t expected);
+
+      /**
+       * @brief Construct a named latch object instance.
+       * @param [in] name Pointer to name.
+       * @param [in] expected The initial count.
+       */
+      latch (const char* name, std::ptrdiff_t expected);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      latch (const latch&) = delete;
+      latch (latch&&) = delete;
+      latch&
+      operator= (const latch&) = delete;
+      latch&
+      operator= (latch&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @brief Destruct the latch object instance.
+       */
+      ~latch ();
+
+      /**
+       * @}
+       */
+
+    public:
+
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+      /**
+       * @brief Decrement the counter.
+       * @param [in] n The amount to subtract.
+       * @retval result::ok The counter was decremented.
+       * @retval EINVAL The amount is negative or higher than the count.
+       */
+      result_t
+      count_down (std::ptrdiff_t n = 1);
+
+      /**
+       * @brief Check if the counter reached zero.
+       * @par Parameters
+       *  None.
+       * @retval true The counter is zero.
+       * @retval false The counter is not zero.
+       */
+      bool
+      try_wait (void) const;
+
+      /**
+       * @brief Wait for the counter to reach zero.
+       * @par Parameters
+       *  None.
+       * @retval result::ok The counter is zero.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINTR The operation was interrupted.
+       */
+      result_t
+      wait (void);
+
+      /**
+       * @brief Wait for the counter to reach zero, with timeout.
+       * @param [in] timeout The timeout duration, in sysclock ticks.
+       * @retval result::ok The counter is zero.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINTR The operation was interrupted.
+       * @retval ETIMEDOUT The counter was not zero when the
+       *  timeout expired.
+       */
+      result_t
+      timed_wait (clock::duration_t timeout);
+
+      /**
+       * @brief Decrement the counter and wait for it to reach zero.
+       * @param [in] n The amount to subtract.
+       * @retval result::ok The counter is zero.
+       * @retval EINVAL The amount is negative or higher than the count.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINTR The operation was interrupted.
+       */
+      result_t
+      arrive_and_wait (std::ptrdiff_t n = 1);
+
+      /**
+       * @brief Get the counter value.
+       * @par Parameters
+       *  None.
+       * @return The current count.
+       */
+      std::ptrdiff_t
+      count (void) const;
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      internal::waiting_threads_list list_;
+      std::ptrdiff_t volatile count_;
+
+      /**
+       * @endcond
+       */
+    };
+
+    // ========================================================================
+
+    /**
+     * @brief Reusable **barrier**.
+     * @headerfile os.h <cmsis-plus/rtos/os.h>
+     * @ingroup cmsis-plus-rtos-semaphore
+     *
+     * @details
+     * A group of threads arrive at the barrier in each phase;
+     * when the last expected thread arrives, the completion
+     * function, if any, is called, the phase ends and all the
+     * waiting threads are released together, while the barrier
+     * is ready for the next phase.
+     */
+    class barrier : public internal::object_named_system
+    {
+    public:
+
+      /**
+       * @brief Type of completion function arguments.
+       */
+      using func_args_t = void*;
+
+      /**
+       * @brief Type of completion function.
+       */
+      using func_t = void (*) (func_args_t args);
+
+      /**
+       * @brief Type of the token returned by `arrive()`.
+       * @details
+       * The phase number at the moment of arrival.
+       */
+      using arrival_token = std::size_t;
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+      /**
+       * @brief Construct a barrier object instance.
+       * @param [in] expected The number of threads in each phase.
+       * @param [in] func Pointer to completion function, or `nullptr`.
+       * @param [in] args Pointer to completion function arguments.
+       */
+      barrier (std::ptrdiff_t expected, func_t func = nullptr,
+               func_args_t args = nullptr);
+
+      /**
+       * @brief Construct a named barrier object instance.
+       * @param [in] name Pointer to name.
+       * @param [in] expected The number of threads in each phase.
+       * @param [in] func Pointer to completion function, or `nullptr`.
+       * @param [in] args Pointer to completion function arguments.
+       */
+      barrier (const char* name, std::ptrdiff_t expected,
+               func_t func = nullptr, func_args_t args = nullptr);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      barrier (const barrier&) = delete;
+      barrier (barrier&&) = delete;
+      barrier&
+      operator= (const barrier&) = delete;
+      barrier&
+      operator= (barrier&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @brief Destruct the barrier object instance.
+       */
+      ~barrier ();
+
+      /**
+       * @}
+       */
+
+    public:
+
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+      /**
+       * @brief Arrive at the barrier, without waiting.
+       * @param [in] n The number of arrivals.
+       * @return The token to pass to `wait()`.
+       */
+      arrival_token
+      arrive (std::ptrdiff_t n = 1);
+
+      /**
+       * @brief Wait for the end of the phase.
+       * @param [in] token The token returned by `arrive()`.
+       * @retval result::ok The phase ended.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINTR The operation was interrupted.
+       */
+      result_t
+      wait (arrival_token token);
+
+      /**
+       * @brief Wait for the end of the phase, with timeout.
+       * @param [in] token The token returned by `arrive()`.
+       * @param [in] timeout The timeout duration, in sysclock ticks.
+       * @retval result::ok The phase ended.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINTR The operation was interrupted.
+       * @retval ETIMEDOUT The phase did not end before the
+       *  timeout expired; the arrival still counts.
+       */
+      result_t
+      timed_wait (arrival_token token, clock::duration_t timeout);
+
+      /**
+       * @brief Arrive at the barrier and wait for the end of the phase.
+       * @par Parameters
+       *  None.
+       * @retval result::ok The phase ended.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINTR The operation was interrupted.
+       */
+      result_t
+      arrive_and_wait (void);
+
+      /**
+       * @brief Arrive at the barrier and leave the group.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      arrive_and_drop (void);
+
+      /**
+       * @brief Get the number of threads expected in each phase.
+       * @par Parameters
+       *  None.
+       * @return The expected count.
+       */
+      std::ptrdiff_t
+      expected (void) const;
+
+      /**
+       * @brief Get the current phase number.
+       * @par Parameters
+       *  None.
+       * @return The number of completed phases.
+       */
+      std::size_t
+      phase (void) const;
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      /**
+       * @brief Internal function used to count arrivals.
+       * @param [in] n The number of arrivals.
+       * @param [in] drop Also decrease the expected count.
+       * @return The phase of the arrival.
+       */
+      arrival_token
+      internal_arrive_ (std::ptrdiff_t n, bool drop);
+
+      /**
+       * @endcond
+       */
+
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      internal::waiting_threads_list list_;
+
+      func_t func_;
+      func_args_t func_args_;
+
+      std::ptrdiff_t volatile expected_;
+      std::ptrdiff_t volatile pending_;
+      std::size_t volatile phase_ = 0;
+
+      /**
+       * @endcond
+       */
+    };
+
+#pragma GCC diagnostic pop
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace rtos
+  {
+
+    inline
+    latch::latch (std::ptrdiff_t expected) :
+        latch
+          { nullptr, expected }
+    {
+      ;
+    }
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline bool
+    latch::try_wait (void) const
+    {
+      return (count_ == 0);
+    }
+
+    inline std::ptrdiff_t
+    latch::count (void) const
+    {
+      return count_;
+    }
+
+    // ========================================================================
+
+    inline
+    barrier::barrier (std::ptrdiff_t expected, func_t func, func_args_t args) :
+        barrier
+          { nullptr, expected, func, args }
+    {
+      ;
+    }
+
+    /**
+     * @details
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    inline barrier::arrival_token
+    barrier::arrive (std::ptrdiff_t n)
+    {
+      return internal_arrive_ (n, false);
+    }
+
+    /**
+     * @details
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    inline result_t
+    barrier::arrive_and_wait (void)
+    {
+      return wait (arrive ());
+    }
+
+    /**
+     * @details
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    inline void
+    barrier::arrive_and_drop (void)
+    {
+      internal_arrive_ (1, true);
+    }
+
+    inline std::ptrdiff_t
+    barrier::expected (void) const
+    {
+      return expected_;
+    }
+
+    inline std::size_t
+    barrier::phase (void) const
+    {
+      return phase_;
+    }
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_RTOS_OS_BARRIER_H_ */
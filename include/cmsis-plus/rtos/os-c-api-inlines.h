@@ -0,0 +1,683 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_RTOS_OS_C_API_INLINES_H_
+#define CMSIS_PLUS_RTOS_OS_C_API_INLINES_H_
+
+/*
+ * Inline definitions of the trivial C API wrappers, for C++ callers
+ * of the C API.
+ *
+ * The definitions use the GNU `extern inline` semantics; they are
+ * used only for inlining, and the calls which are not inlined, or
+ * take the function address, still go to the out-of-line
+ * definitions in `os-c-wrapper.cpp`, which remain exported.
+ *
+ * Included by `<cmsis-plus/rtos/os-c-api.h>` when
+ * `OS_INCLUDE_RTOS_C_API_INLINES` is defined.
+ */
+
+// ----------------------------------------------------------------------------
+#if defined(__cplusplus)
+
+#include <cmsis-plus/rtos/os.h>
+
+#include <cassert>
+
+// ----------------------------------------------------------------------------
+
+extern "C"
+{
+
+  extern inline bool
+  __attribute__((gnu_inline))
+  os_sched_is_started (void)
+  {
+    return os::rtos::scheduler::started ();
+  }
+
+  extern inline os_sched_state_t
+  __attribute__((gnu_inline))
+  os_sched_lock (void)
+  {
+    return os::rtos::scheduler::lock ();
+  }
+
+  extern inline os_sched_state_t
+  __attribute__((gnu_inline))
+  os_sched_unlock (void)
+  {
+    return os::rtos::scheduler::unlock ();
+  }
+
+  extern inline bool
+  __attribute__((gnu_inline))
+  os_sched_is_locked (void)
+  {
+    return os::rtos::scheduler::locked ();
+  }
+
+  extern inline bool
+  __attribute__((gnu_inline))
+  os_irq_in_handler_mode (void)
+  {
+    return os::rtos::interrupts::in_handler_mode ();
+  }
+
+  extern inline os_irq_state_t
+  __attribute__((gnu_inline))
+  os_irq_critical_enter (void)
+  {
+    return os::rtos::interrupts::critical_section::enter ();
+  }
+
+  extern inline void
+  __attribute__((gnu_inline))
+  os_irq_critical_exit (os_irq_state_t state)
+  {
+    os::rtos::interrupts::critical_section::exit (state);
+  }
+
+  extern inline os_irq_state_t
+  __attribute__((gnu_inline))
+  os_irq_uncritical_enter (void)
+  {
+    return os::rtos::interrupts::uncritical_section::enter ();
+  }
+
+  extern inline void
+  __attribute__((gnu_inline))
+  os_irq_uncritical_exit (os_irq_state_t state)
+  {
+    os::rtos::interrupts::uncritical_section::exit (state);
+  }
+
+  extern inline os_thread_t*
+  __attribute__((gnu_inline))
+  os_this_thread (void)
+  {
+    return (os_thread_t*) &os::rtos::this_thread::thread ();
+  }
+
+  extern inline os_result_t
+  __attribute__((gnu_inline))
+  os_this_thread_flags_wait (os_flags_mask_t mask, os_flags_mask_t* oflags,
+                             os_flags_mode_t mode)
+  {
+    return (os_result_t) os::rtos::this_thread::flags_wait (mask, oflags, mode);
+  }
+
+  extern inline os_result_t
+  __attribute__((gnu_inline))
+  os_this_thread_flags_try_wait (os_flags_mask_t mask, os_flags_mask_t* oflags,
+                                 os_flags_mode_t mode)
+  {
+    return (os_result_t) os::rtos::this_thread::flags_try_wait (
+        mask, oflags, mode);
+  }
+
+  extern inline os_result_t
+  __attribute__((gnu_inline))
+  os_this_thread_flags_timed_wait (os_flags_mask_t mask,
+                                   os_clock_duration_t timeout,
+                                   os_flags_mask_t* oflags,
+                                   os_flags_mode_t mode)
+  {
+    return (os_result_t) os::rtos::this_thread::flags_timed_wait (
+        mask, timeout, oflags, mode);
+  }
+
+  extern inline os_result_t
+  __attribute__((gnu_inline))
+  os_this_thread_flags_clear (os_flags_mask_t mask, os_flags_mask_t* oflags)
+  {
+    return (os_result_t) os::rtos::this_thread::flags_clear (mask, oflags);
+  }
+
+  extern inline os_flags_mask_t
+  __attribute__((gnu_inline))
+  os_this_thread_flags_get (os_flags_mask_t mask, os_flags_mode_t mode)
+  {
+    return (os_flags_mask_t) os::rtos::this_thread::flags_get (mask, mode);
+  }
+
+  extern inline const char*
+  __attribute__((gnu_inline))
+  os_thread_get_name (os_thread_t* thread)
+  {
+    assert (thread != nullptr);
+    os::rtos::thread& obj = reinterpret_cast<os::rtos::thread&> (*thread);
+    return obj.name ();
+  }
+
+  extern inline os_thread_prio_t
+  __attribute__((gnu_inline))
+  os_thread_get_priority (os_thread_t* thread)
+  {
+    assert (thread != nullptr);
+    os::rtos::thread& obj = reinterpret_cast<os::rtos::thread&> (*thread);
+    return (os_thread_prio_t) obj.priority ();
+  }
+
+  extern inline void
+  __attribute__((gnu_inline))
+  os_thread_resume (os_thread_t* thread)
+  {
+    assert (thread != nullptr);
+    os::rtos::thread& obj = reinterpret_cast<os::rtos::thread&> (*thread);
+    return obj.resume ();
+  }
+
+  extern inline os_result_t
+  __attribute__((gnu_inline))
+  os_thread_flags_raise (os_thread_t* thread, os_flags_mask_t mask,
+                         os_flags_mask_t* oflags)
+  {
+    assert (thread != nullptr);
+    os::rtos::thread& obj = reinterpret_cast<os::rtos::thread&> (*thread);
+    return (os_result_t) obj.flags_raise (mask, oflags);
+  }
+
+  extern inline os_clock_timestamp_t
+  __attribute__((gnu_inline))
+  os_clock_now (os_clock_t* clock)
+  {
+    assert (clock != nullptr);
+    os::rtos::clock& obj = reinterpret_cast<os::rtos::clock&> (*clock);
+    return (os_clock_timestamp_t) obj.now ();
+  }
+
+  extern inline os_clock_timestamp_t
+  __attribute__((gnu_inline))
+  os_clock_steady_now (os_clock_t* clock)
+  {
+    assert (clock != nullptr);
+    os::rtos::clock& obj = reinterpret_cast<os::rtos::clock&> (*clock);
+    return (os_clock_timestamp_t) obj.steady_now ();
+  }
+
+  extern inline os_result_t
+  __attribute__((gnu_inline))
+  os_clock_sleep_for (os_clock_t* clock, os_clock_duration_t duration)
+  {
+    assert (clock != nullptr);
+    os::rtos::clock& obj = reinterpret_cast<os::rtos::clock&> (*clock);
+    return (os_result_t) obj.sleep_for (duration);
+  }
+
+  extern inline os_result_t
+  __attribute__((gnu_inline))
+  os_clock_sleep_until (os_clock_t* clock, os_clock_timestamp_t timestamp)
+  {
+    assert (clock != nullptr);
+    os::rtos::clock& obj = reinterpret_cast<os::rtos::clock&> (*clock);
+    return (os_result_t) obj.sleep_until (timestamp);
+  }
+
+  extern inline os_result_t
+  __attribute__((gnu_inline))
+  os_clock_wait_for (os_clock_t* clock, os_clock_duration_t timeout)
+  {
+    assert (clock != nullptr);
+    os::rtos::clock& obj = reinterpret_cast<os::rtos::clock&> (*clock);
+    return (os_result_t) obj.wait_for (timeout);
+  }
+
+  extern inline os_clock_timestamp_t
+  __attribute__((gnu_inline))
+  os_sysclock_now (void)
+  {
+    return (os_clock_timestamp_t) os::rtos::sysclock.now ();
+  }
+
+  extern inline os_result_t
+  __attribute__((gnu_inline))
+  os_sysclock_sleep_for (os_clock_duration_t duration)
+  {
+    return (os_result_t) os::rtos::sysclock.sleep_for (duration);
+  }
+
+  extern inline os_result_t
+  __attribute__((gnu_inline))
+  os_sysclock_sleep_until (os_clock_timestamp_t timestamp)
+  {
+    return (os_result_t) os::rtos::sysclock.sleep_until (timestamp);
+  }
+
+  extern inline os_result_t
+  __attribute__((gnu_inline))
+  os_sysclock_wait_for (os_clock_duration_t timeout)
+  {
+    return (os_result_t) os::rtos::sysclock.wait_for (timeout);
+  }
+
+  extern inline os_result_t
+  __attribute__((gnu_inline))
+  os_timer_start (os_timer_t* timer, os_clock_duration_t period)
+  {
+    assert (timer != nullptr);
+    os::rtos::timer& obj = reinterpret_cast<os::rtos::timer&> (*timer);
+    return (os_result_t) obj.start (period);
+  }
+
+  extern inline os_result_t
+  __attribute__((gnu_inline))
+  os_timer_stop (os_timer_t* timer)
+  {
+    assert (timer != nullptr);
+    os::rtos::timer& obj = reinterpret_cast<os::rtos::timer&> (*timer);
+    return (os_result_t) obj.stop ();
+  }
+
+  extern inline os_result_t
+  __attribute__((gnu_inline))
+  os_mutex_lock (os_mutex_t* mutex)
+  {
+    assert (mutex != nullptr);
+    os::rtos::mutex& obj = reinterpret_cast<os::rtos::mutex&> (*mutex);
+    return (os_result_t) obj.lock ();
+  }
+
+  extern inline os_result_t
+  __attribute__((gnu_inline))
+  os_mutex_try_lock (os_mutex_t* mutex)
+  {
+    assert (mutex != nullptr);
+    os::rtos::mutex& obj = reinterpret_cast<os::rtos::mutex&> (*mutex);
+    return (os_result_t) obj.try_lock ();
+  }
+
+  extern inline os_result_t
+  __attribute__((gnu_inline))
+  os_mutex_timed_lock (os_mutex_t* mutex, os_clock_duration_t timeout)
+  {
+    assert (mutex != nullptr);
+    os::rtos::mutex& obj = reinterpret_cast<os::rtos::mutex&> (*mutex);
+    return (os_result_t) obj.timed_lock (timeout);
+  }
+
+  extern inline os_result_t
+  __attribute__((gnu_inline))
+  os_mutex_unlock (os_mutex_t* mutex)
+  {
+    assert (mutex != nullptr);
+    os::rtos::mutex& obj = reinterpret_cast<os::rtos::mutex&> (*mutex);
+    return (os_result_t) obj.unlock ();
+  }
+
+  extern inline os_thread_t*
+  __attribute__((gnu_inline))
+  os_mutex_get_owner (os_mutex_t* mutex)
+  {
+    assert (mutex != nullptr);
+    os::rtos::mutex& obj = reinterpret_cast<os::rtos::mutex&> (*mutex);
+    return (os_thread_t*) obj.owner ();
+  }
+
+  extern inline os_result_t
+  __attribute__((gnu_inline))
+  os_condvar_signal (os_condvar_t* condvar)
+  {
+    assert (condvar != nullptr);
+    os::rtos::condition_variable& obj =
+        reinterpret_cast<os::rtos::condition_variable&> (*condvar);
+    return (os_result_t) obj.signal ();
+  }
+
+  extern inline os_result_t
+  __attribute__((gnu_inline))
+  os_condvar_broadcast (os_condvar_t* condvar)
+  {
+    assert (condvar != nullptr);
+    os::rtos::condition_variable& obj =
+        reinterpret_cast<os::rtos::condition_variable&> (*condvar);
+    return (os_result_t) obj.broadcast ();
+  }
+
+  extern inline os_result_t
+  __attribute__((gnu_inline))
+  os_condvar_wait (os_condvar_t* condvar, os_mutex_t* mutex)
+  {
+    assert (condvar != nullptr);
+    os::rtos::condition_variable& obj =
+        reinterpret_cast<os::rtos::condition_variable&> (*condvar);
+    return (os_result_t) obj.wait (reinterpret_cast<os::rtos::mutex&> (*mutex));
+  }
+
+  extern inline os_result_t
+  __attribute__((gnu_inline))
+  os_condvar_timed_wait (os_condvar_t* condvar, os_mutex_t* mutex,
+                         os_clock_duration_t timeout)
+  {
+    assert (condvar != nullptr);
+    os::rtos::condition_variable& obj =
+        reinterpret_cast<os::rtos::condition_variable&> (*condvar);
+    return (os_result_t) obj.timed_wait (
+        reinterpret_cast<os::rtos::mutex&> (*mutex), timeout);
+  }
+
+  extern inline os_result_t
+  __attribute__((gnu_inline))
+  os_semaphore_post (os_semaphore_t* semaphore)
+  {
+    assert (semaphore != nullptr);
+    os::rtos::semaphore& obj =
+        reinterpret_cast<os::rtos::semaphore&> (*semaphore);
+    return (os_result_t) obj.post ();
+  }
+
+  extern inline os_result_t
+  __attribute__((gnu_inline))
+  os_semaphore_wait (os_semaphore_t* semaphore)
+  {
+    assert (semaphore != nullptr);
+    os::rtos::semaphore& obj =
+        reinterpret_cast<os::rtos::semaphore&> (*semaphore);
+    return (os_result_t) obj.wait ();
+  }
+
+  extern inline os_result_t
+  __attribute__((gnu_inline))
+  os_semaphore_try_wait (os_semaphore_t* semaphore)
+  {
+    assert (semaphore != nullptr);
+    os::rtos::semaphore& obj =
+        reinterpret_cast<os::rtos::semaphore&> (*semaphore);
+    return (os_result_t) obj.try_wait ();
+  }
+
+  extern inline os_result_t
+  __attribute__((gnu_inline))
+  os_semaphore_timed_wait (os_semaphore_t* semaphore,
+                           os_clock_duration_t timeout)
+  {
+    assert (semaphore != nullptr);
+    os::rtos::semaphore& obj =
+        reinterpret_cast<os::rtos::semaphore&> (*semaphore);
+    return (os_result_t) obj.timed_wait (timeout);
+  }
+
+  extern inline os_semaphore_count_t
+  __attribute__((gnu_inline))
+  os_semaphore_get_value (os_semaphore_t* semaphore)
+  {
+    assert (semaphore != nullptr);
+    os::rtos::semaphore& obj =
+        reinterpret_cast<os::rtos::semaphore&> (*semaphore);
+    return (os_semaphore_count_t) obj.value ();
+  }
+
+  extern inline void*
+  __attribute__((gnu_inline))
+  os_mempool_alloc (os_mempool_t* mempool)
+  {
+    assert (mempool != nullptr);
+    os::rtos::memory_pool& obj =
+        reinterpret_cast<os::rtos::memory_pool&> (*mempool);
+    return obj.alloc ();
+  }
+
+  extern inline void*
+  __attribute__((gnu_inline))
+  os_mempool_try_alloc (os_mempool_t* mempool)
+  {
+    assert (mempool != nullptr);
+    os::rtos::memory_pool& obj =
+        reinterpret_cast<os::rtos::memory_pool&> (*mempool);
+    return obj.try_alloc ();
+  }
+
+  extern inline void*
+  __attribute__((gnu_inline))
+  os_mempool_timed_alloc (os_mempool_t* mempool, os_clock_duration_t timeout)
+  {
+    assert (mempool != nullptr);
+    os::rtos::memory_pool& obj =
+        reinterpret_cast<os::rtos::memory_pool&> (*mempool);
+    return obj.timed_alloc (timeout);
+  }
+
+  extern inline os_result_t
+  __attribute__((gnu_inline))
+  os_mempool_free (os_mempool_t* mempool, void* block)
+  {
+    assert (mempool != nullptr);
+    os::rtos::memory_pool& obj =
+        reinterpret_cast<os::rtos::memory_pool&> (*mempool);
+    return (os_result_t) obj.free (block);
+  }
+
+  extern inline size_t
+  __attribute__((gnu_inline))
+  os_mempool_get_count (os_mempool_t* mempool)
+  {
+    assert (mempool != nullptr);
+    os::rtos::memory_pool& obj =
+        reinterpret_cast<os::rtos::memory_pool&> (*mempool);
+    return obj.count ();
+  }
+
+  extern inline bool
+  __attribute__((gnu_inline))
+  os_mempool_is_empty (os_mempool_t* mempool)
+  {
+    assert (mempool != nullptr);
+    os::rtos::memory_pool& obj =
+        reinterpret_cast<os::rtos::memory_pool&> (*mempool);
+    return obj.empty ();
+  }
+
+  extern inline bool
+  __attribute__((gnu_inline))
+  os_mempool_is_full (os_mempool_t* mempool)
+  {
+    assert (mempool != nullptr);
+    os::rtos::memory_pool& obj =
+        reinterpret_cast<os::rtos::memory_pool&> (*mempool);
+    return obj.full ();
+  }
+
+  extern inline os_result_t
+  __attribute__((gnu_inline))
+  os_mqueue_send (os_mqueue_t* mqueue, const void* msg, size_t nbytes,
+                  os_mqueue_prio_t mprio)
+  {
+    assert (mqueue != nullptr);
+    os::rtos::message_queue& obj =
+        reinterpret_cast<os::rtos::message_queue&> (*mqueue);
+    return (os_result_t) obj.send (msg, nbytes, mprio);
+  }
+
+  extern inline os_result_t
+  __attribute__((gnu_inline))
+  os_mqueue_try_send (os_mqueue_t* mqueue, const void* msg, size_t nbytes,
+                      os_mqueue_prio_t mprio)
+  {
+    assert (mqueue != nullptr);
+    os::rtos::message_queue& obj =
+        reinterpret_cast<os::rtos::message_queue&> (*mqueue);
+    return (os_result_t) obj.try_send (msg, nbytes, mprio);
+  }
+
+  extern inline os_result_t
+  __attribute__((gnu_inline))
+  os_mqueue_timed_send (os_mqueue_t* mqueue, const void* msg, size_t nbytes,
+                        os_clock_duration_t timeout, os_mqueue_prio_t mprio)
+  {
+    assert (mqueue != nullptr);
+    os::rtos::message_queue& obj =
+        reinterpret_cast<os::rtos::message_queue&> (*mqueue);
+    return (os_result_t) obj.timed_send (msg, nbytes, timeout, mprio);
+  }
+
+  extern inline os_result_t
+  __attribute__((gnu_inline))
+  os_mqueue_receive (os_mqueue_t* mqueue, void* msg, size_t nbytes,
+                     os_mqueue_prio_t* mprio)
+  {
+    assert (mqueue != nullptr);
+    os::rtos::message_queue& obj =
+        reinterpret_cast<os::rtos::message_queue&> (*mqueue);
+    return (os_result_t) obj.receive (msg, nbytes, mprio);
+  }
+
+  extern inline os_result_t
+  __attribute__((gnu_inline))
+  os_mqueue_try_receive (os_mqueue_t* mqueue, void* msg, size_t nbytes,
+                         os_mqueue_prio_t* mprio)
+  {
+    assert (mqueue != nullptr);
+    os::rtos::message_queue& obj =
+        reinterpret_cast<os::rtos::message_queue&> (*mqueue);
+    return (os_result_t) obj.try_receive (msg, nbytes, mprio);
+  }
+
+  extern inline os_result_t
+  __attribute__((gnu_inline))
+  os_mqueue_timed_receive (os_mqueue_t* mqueue, void* msg, size_t nbytes,
+                           os_clock_duration_t timeout, os_mqueue_prio_t* mprio)
+  {
+    assert (mqueue != nullptr);
+    os::rtos::message_queue& obj =
+        reinterpret_cast<os::rtos::message_queue&> (*mqueue);
+    return (os_result_t) obj.timed_receive (msg, nbytes, timeout, mprio);
+  }
+
+  extern inline size_t
+  __attribute__((gnu_inline))
+  os_mqueue_get_length (os_mqueue_t* mqueue)
+  {
+    assert (mqueue != nullptr);
+    os::rtos::message_queue& obj =
+        reinterpret_cast<os::rtos::message_queue&> (*mqueue);
+    return obj.length ();
+  }
+
+  extern inline bool
+  __attribute__((gnu_inline))
+  os_mqueue_is_empty (os_mqueue_t* mqueue)
+  {
+    assert (mqueue != nullptr);
+    os::rtos::message_queue& obj =
+        reinterpret_cast<os::rtos::message_queue&> (*mqueue);
+    return obj.empty ();
+  }
+
+  extern inline bool
+  __attribute__((gnu_inline))
+  os_mqueue_is_full (os_mqueue_t* mqueue)
+  {
+    assert (mqueue != nullptr);
+    os::rtos::message_queue& obj =
+        reinterpret_cast<os::rtos::message_queue&> (*mqueue);
+    return obj.full ();
+  }
+
+  extern inline os_result_t
+  __attribute__((gnu_inline))
+  os_evflags_wait (os_evflags_t* evflags, os_flags_mask_t mask,
+                   os_flags_mask_t* oflags, os_flags_mode_t mode)
+  {
+    assert (evflags != nullptr);
+    os::rtos::event_flags& obj =
+        reinterpret_cast<os::rtos::event_flags&> (*evflags);
+    return (os_result_t) obj.wait (mask, oflags, mode);
+  }
+
+  extern inline os_result_t
+  __attribute__((gnu_inline))
+  os_evflags_try_wait (os_evflags_t* evflags, os_flags_mask_t mask,
+                       os_flags_mask_t* oflags, os_flags_mode_t mode)
+  {
+    assert (evflags != nullptr);
+    os::rtos::event_flags& obj =
+        reinterpret_cast<os::rtos::event_flags&> (*evflags);
+    return (os_result_t) obj.try_wait (mask, oflags, mode);
+  }
+
+  extern inline os_result_t
+  __attribute__((gnu_inline))
+  os_evflags_timed_wait (os_evflags_t* evflags, os_flags_mask_t mask,
+                         os_clock_duration_t timeout, os_flags_mask_t* oflags,
+                         os_flags_mode_t mode)
+  {
+    assert (evflags != nullptr);
+    os::rtos::event_flags& obj =
+        reinterpret_cast<os::rtos::event_flags&> (*evflags);
+    return (os_result_t) obj.timed_wait (mask, timeout, oflags, mode);
+  }
+
+  extern inline os_result_t
+  __attribute__((gnu_inline))
+  os_evflags_raise (os_evflags_t* evflags, os_flags_mask_t mask,
+                    os_flags_mask_t* oflags)
+  {
+    assert (evflags != nullptr);
+    os::rtos::event_flags& obj =
+        reinterpret_cast<os::rtos::event_flags&> (*evflags);
+    return (os_result_t) obj.raise (mask, oflags);
+  }
+
+  extern inline os_result_t
+  __attribute__((gnu_inline))
+  os_evflags_clear (os_evflags_t* evflags, os_flags_mask_t mask,
+                    os_flags_mask_t* oflags)
+  {
+    assert (evflags != nullptr);
+    os::rtos::event_flags& obj =
+        reinterpret_cast<os::rtos::event_flags&> (*evflags);
+    return (os_result_t) obj.clear (mask, oflags);
+  }
+
+  extern inline os_flags_mask_t
+  __attribute__((gnu_inline))
+  os_evflags_get (os_evflags_t* evflags, os_flags_mask_t mask,
+                  os_flags_mode_t mode)
+  {
+    assert (evflags != nullptr);
+    os::rtos::event_flags& obj =
+        reinterpret_cast<os::rtos::event_flags&> (*evflags);
+    return (os_flags_mask_t) obj.get (mask, mode);
+  }
+
+  extern inline bool
+  __attribute__((gnu_inline))
+  os_evflags_are_waiting (os_evflags_t* evflags)
+  {
+    assert (evflags != nullptr);
+    os::rtos::event_flags& obj =
+        reinterpret_cast<os::rtos::event_flags&> (*evflags);
+    return obj.waiting ();
+  }
+
+}
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_RTOS_OS_C_API_INLINES_H_ */
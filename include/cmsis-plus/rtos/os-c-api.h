@@ -695,6 +695,18 @@ extern "C"
   size_t
   os_thread_stack_get_available (os_thread_stack_t* stack);
 
+#if defined(OS_INCLUDE_RTOS_THREAD_STACK_SCAN)
+
+  /**
+   * @brief Get the maximum stack usage seen so far.
+   * @param [in] stack Pointer to stack object instance.
+   * @return Number of used bytes.
+   */
+  size_t
+  os_thread_stack_get_high_water_mark (os_thread_stack_t* stack);
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_STACK_SCAN) */
+
   /**
    * @brief Check if bottom magic word is still there.
    * @param [in] stack Pointer to stack object instance.
@@ -2666,6 +2678,17 @@ extern "C"
   os_memory_deallocate (os_memory_t* memory, void* addr, size_t bytes,
                         size_t alignment);
 
+  /**
+   * @brief Deallocate a block of memory later; can be invoked
+   *  from interrupt handlers.
+   * @param memory Pointer to a memory resource object instance.
+   * @param addr Address of memory block to free.
+   * @par Returns
+   *  Nothing.
+   */
+  void
+  os_memory_deallocate_deferred (os_memory_t* memory, void* addr);
+
   /**
    * @brief Reset the memory manager to the initial state.
    * @param memory Pointer to a memory resource object instance.
@@ -2743,4 +2766,11 @@ extern "C"
 
 // ----------------------------------------------------------------------------
 
+#if defined(OS_INCLUDE_RTOS_C_API_INLINES) && defined(__cplusplus)
+// Inline definitions of the trivial wrappers, for C++ callers.
+#include <cmsis-plus/rtos/os-c-api-inlines.h>
+#endif /* defined(OS_INCLUDE_RTOS_C_API_INLINES) && defined(__cplusplus) */
+
+// ----------------------------------------------------------------------------
+
 #endif /* CMSIS_PLUS_RTOS_OS_C_API_H_ */
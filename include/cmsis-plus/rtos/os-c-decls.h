@@ -59,12 +59,29 @@ extern "C"
 
   typedef struct os_internal_double_list_links_s
   {
+#if defined(OS_INCLUDE_UTILS_LISTS_COMPACT)
+    uint16_t prev;
+    uint16_t next;
+#else
     void* prev;
     void* next;
+#endif /* defined(OS_INCLUDE_UTILS_LISTS_COMPACT) */
   } os_internal_double_list_links_t;
 
+#if defined(OS_USE_RTOS_WAITING_LIST_BUCKETS)
+
+  typedef struct os_internal_threads_waiting_list_s
+  {
+    os_internal_double_list_links_t buckets[16];
+    uint32_t bitmap;
+  } os_internal_threads_waiting_list_t;
+
+#else
+
   typedef os_internal_double_list_links_t os_internal_threads_waiting_list_t;
 
+#endif /* defined(OS_USE_RTOS_WAITING_LIST_BUCKETS) */
+
   typedef struct os_internal_thread_children_list_s
   {
     os_internal_double_list_links_t links;
@@ -79,6 +96,13 @@ extern "C"
   typedef struct os_internal_clock_timestamps_list_s
   {
     os_internal_double_list_links_t links;
+    os_port_clock_timestamp_t head_timestamp;
+#if defined(OS_USE_RTOS_CLOCK_TIMER_WHEEL)
+    void* wheel;
+#endif /* defined(OS_USE_RTOS_CLOCK_TIMER_WHEEL) */
+#if defined(OS_USE_RTOS_HIGHRES_COMPARE_MATCH)
+    bool compare_match;
+#endif /* defined(OS_USE_RTOS_HIGHRES_COMPARE_MATCH) */
   } os_internal_clock_timestamps_list_t;
 
   /**
@@ -257,6 +281,18 @@ extern "C"
     os_flags_mask_t flags_mask;
   } os_internal_evflags_t;
 
+  /**
+   * @brief Internal lock-free list of free blocks.
+   *
+   * @see os::rtos::internal::lock_free_block_list
+   */
+  typedef struct os_internal_lock_free_block_list_s
+  {
+    void* addr;
+    size_t block_size_bytes;
+    size_t head;
+  } os_internal_lock_free_block_list_t;
+
   // ==========================================================================
 #define OS_THREAD_PRIO_SHIFT   (4)
 
@@ -407,6 +443,10 @@ extern "C"
 
     void* stack_addr;
     size_t stack_size_bytes;
+#if defined(OS_INCLUDE_RTOS_THREAD_STACK_SCAN)
+    void* scan_addr;
+    void* peak_addr;
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_STACK_SCAN) */
 
     /**
      * @endcond
@@ -468,6 +508,29 @@ extern "C"
     os_statistics_duration_t cpu_cycles;
 #endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES) */
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_EVENTS)
+    os_statistics_counter_t events[6];
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_EVENTS) */
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_PROFILE)
+    os_statistics_counter_t preemptions;
+    os_statistics_duration_t max_latency;
+    os_statistics_duration_t blocked_cycles;
+    os_statistics_counter_t histogram[16];
+    struct
+    {
+      const void* object;
+      os_statistics_counter_t count;
+      os_statistics_duration_t cycles;
+    } objects[4];
+    os_statistics_duration_t slice_cycles;
+    os_clock_timestamp_t ready_timestamp;
+    os_clock_timestamp_t block_timestamp;
+    const void* block_object;
+    bool ready;
+    bool blocked;
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_PROFILE) */
+
     /**
      * @endcond
      */
@@ -533,6 +596,75 @@ extern "C"
      */
     os_thread_prio_t th_priority;
 
+#if defined(OS_INCLUDE_RTOS_THREAD_STACK_POOL)
+    /**
+     * @brief Pool to take the thread stack from.
+     *
+     * @details
+     * If not `NULL`, and there is no user defined storage,
+     * the stack is taken from the pool.
+     */
+    void* th_stack_pool;
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_STACK_POOL) */
+
+#if defined(OS_INCLUDE_RTOS_SMP)
+    /**
+     * @brief Core to run the thread on.
+     *
+     * @details
+     * If 0xFF, the default is the core that creates the thread.
+     */
+    uint8_t th_core;
+
+    /**
+     * @brief Mask of the cores the thread may run on.
+     *
+     * @details
+     * If 0, the thread may run on any core.
+     */
+    uint32_t th_affinity;
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
+    /**
+     * @brief Relative deadline, in clock units.
+     *
+     * @details
+     * If not 0, the thread is scheduled by earliest deadline.
+     */
+    os_clock_duration_t th_deadline;
+
+    /**
+     * @brief Period, in clock units; 0 for aperiodic threads.
+     */
+    os_clock_duration_t th_period;
+
+    /**
+     * @brief Worst case execution time of a job, in clock units.
+     */
+    os_clock_duration_t th_budget;
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_EDF) */
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING)
+    /**
+     * @brief Time slice, in ticks.
+     *
+     * @details
+     * If 0, the quantum of the priority class is used.
+     */
+    os_clock_duration_t th_quantum;
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING) */
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_PREEMPTION_THRESHOLD)
+    /**
+     * @brief Preemption threshold.
+     *
+     * @details
+     * If 0, the thread can be preempted by any higher priority thread.
+     */
+    os_thread_prio_t th_preemption_threshold;
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_PREEMPTION_THRESHOLD) */
+
   } os_thread_attr_t;
 
   /**
@@ -551,6 +683,36 @@ extern "C"
    *
    * @see os::rtos::thread
    */
+#if defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE)
+
+  /**
+   * @brief Thread allocation cache.
+   * @headerfile os-c-api.h <cmsis-plus/rtos/os-c-api.h>
+   *
+   * @details
+   * The members of this structure are hidden and should not
+   * be accessed directly.
+   *
+   * @see os::rtos::memory::allocation_cache
+   */
+  typedef struct os_thread_allocation_cache_s
+  {
+    /**
+     * @cond ignore
+     */
+
+    void* lists[4];
+    size_t counts[4];
+    size_t cached_bytes;
+
+    /**
+     * @endcond
+     */
+
+  } os_thread_allocation_cache_t;
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE) */
+
   typedef struct os_thread_s
   {
     /**
@@ -558,7 +720,9 @@ extern "C"
      */
 
     void* vtbl;
+#if !defined(OS_EXCLUDE_RTOS_OBJECT_NAMES)
     const char* name;
+#endif /* !defined(OS_EXCLUDE_RTOS_OBJECT_NAMES) */
     int errno_; // Prevent the macro to expand (for example with a prefix).
     os_internal_waiting_thread_node_t ready_node;
     os_thread_func_t func;
@@ -571,15 +735,66 @@ extern "C"
     void* joiner;
     void* waiting_node;
     void* clock_node;
+    void* blocking_mutex;
     void* clock;
     void* allocator;
     void* allocted_stack_address;
     size_t acquired_mutexes;
     size_t allocated_stack_size_elements;
+#if defined(OS_INCLUDE_RTOS_THREAD_STACK_POOL)
+    void* stack_pool;
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_STACK_POOL) */
     os_thread_state_t state;
     os_thread_prio_t prio_assigned;
     os_thread_prio_t prio_inherited;
+#if !defined(OS_EXCLUDE_RTOS_THREAD_CANCELLATION)
     bool interrupted;
+#endif /* !defined(OS_EXCLUDE_RTOS_THREAD_CANCELLATION) */
+#if defined(OS_INCLUDE_RTOS_SMP)
+    uint8_t core;
+    uint32_t affinity;
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES)
+    os_statistics_duration_t balance_cycles;
+    os_statistics_duration_t balance_load;
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES) */
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
+    os_clock_timestamp_t edf_release;
+    os_clock_timestamp_t edf_deadline;
+    os_clock_duration_t edf_relative;
+    os_clock_duration_t edf_period;
+    os_clock_duration_t edf_budget;
+    os_statistics_counter_t deadline_misses;
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_EDF) */
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING)
+    os_clock_duration_t quantum;
+    os_clock_duration_t slice_left;
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING) */
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_PREEMPTION_THRESHOLD)
+    os_thread_prio_t threshold;
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_PREEMPTION_THRESHOLD) */
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_HANDOFF)
+    void* handoff;
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_HANDOFF) */
+#if defined(OS_INCLUDE_RTOS_TIMER_SLACK)
+    os_clock_duration_t timer_slack;
+#endif /* defined(OS_INCLUDE_RTOS_TIMER_SLACK) */
+#if defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK_LATENCY)
+    void* latency_slot;
+    os_clock_timestamp_t latency_woken;
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK_LATENCY) */
+#if defined(OS_INCLUDE_RTOS_THREAD_BUDGET)
+    os_statistics_duration_t budget_cycles;
+    os_statistics_duration_t budget_base;
+    void* budget_func;
+    void* budget_args;
+    os_statistics_counter_t budget_overruns;
+    bool budget_fired;
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_BUDGET) */
+#if defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS)
+    uint32_t notify_value;
+    uint8_t notify_state;
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS) */
     os_internal_evflags_t event_flags;
 #if defined(OS_INCLUDE_RTOS_CUSTOM_THREAD_USER_STORAGE)
     os_thread_user_storage_t user_storage; //
@@ -590,6 +805,18 @@ extern "C"
     os_thread_statistics_t statistics;
 #endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CONTEXT_SWITCHES) */
 
+#if defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE)
+    os_thread_allocation_cache_t allocation_cache;
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE) */
+
+#if defined(OS_INCLUDE_RTOS_THREAD_NEWLIB_REENT)
+    void* newlib_reent;
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_NEWLIB_REENT) */
+
+#if defined(OS_INCLUDE_RTOS_THREAD_LOCAL_SLOTS)
+    void* local_slots[OS_INTEGER_RTOS_THREAD_LOCAL_SLOTS];
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_LOCAL_SLOTS) */
+
 #if defined(OS_USE_RTOS_PORT_SCHEDULER)
     os_thread_port_data_t port;
 #endif
@@ -635,7 +862,9 @@ extern "C"
      */
 
     void* vtbl;
+#if !defined(OS_EXCLUDE_RTOS_OBJECT_NAMES)
     const char* name;
+#endif /* !defined(OS_EXCLUDE_RTOS_OBJECT_NAMES) */
     os_internal_clock_timestamps_list_t steady_list;
     os_clock_duration_t sleep_count;
     os_clock_timestamp_t steady_count;
@@ -658,10 +887,12 @@ extern "C"
 
   typedef struct os_clock_node_s
   {
-    void* next;
-    void* prev;
-    void* list;
+    void* vtbl;
+    os_internal_double_list_links_t links;
     os_clock_timestamp_t timestamp;
+#if defined(OS_INCLUDE_RTOS_TIMER_SLACK)
+    os_clock_duration_t slack;
+#endif /* defined(OS_INCLUDE_RTOS_TIMER_SLACK) */
     void* timer;
   } os_internal_clock_timer_node_t;
 
@@ -767,19 +998,29 @@ extern "C"
      * @cond ignore
      */
 
+#if !defined(OS_EXCLUDE_RTOS_OBJECT_NAMES)
     const char* name;
+#endif /* !defined(OS_EXCLUDE_RTOS_OBJECT_NAMES) */
     os_timer_func_t func;
     os_timer_func_args_t func_args;
 #if !defined(OS_USE_RTOS_PORT_TIMER)
     void* clock;
     os_internal_clock_timer_node_t clock_node;
     os_clock_duration_t period;
+#if defined(OS_INCLUDE_RTOS_TIMER_SLACK)
+    os_clock_timestamp_t nominal;
+#endif /* defined(OS_INCLUDE_RTOS_TIMER_SLACK) */
 #endif
 #if defined(OS_USE_RTOS_PORT_TIMER)
     os_timer_port_data_t port_;
 #endif
     os_timer_type_t type;
     os_timer_state_t state;
+#if defined(OS_INCLUDE_RTOS_TIMER_DAEMON) && !defined(OS_USE_RTOS_PORT_TIMER)
+    void* pending_next;
+    uint32_t overruns;
+    bool pending;
+#endif
 
     /**
      * @endcond
@@ -928,6 +1169,13 @@ extern "C"
      */
     os_mutex_count_t mx_max_count;
 
+#if defined(OS_INCLUDE_RTOS_SMP)
+    /**
+     * @brief Mutex adaptive spin limit, in high resolution clock cycles.
+     */
+    uint32_t mx_spin_cycles;
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+
   } os_mutex_attr_t;
 
   /**
@@ -952,7 +1200,9 @@ extern "C"
      * @cond ignore
      */
 
+#if !defined(OS_EXCLUDE_RTOS_OBJECT_NAMES)
     const char* name;
+#endif /* !defined(OS_EXCLUDE_RTOS_OBJECT_NAMES) */
     void* owner;
 #if !defined(OS_USE_RTOS_PORT_MUTEX)
     os_internal_threads_waiting_list_t list;
@@ -963,16 +1213,23 @@ extern "C"
     os_mutex_port_data_t port;
 #endif
     os_mutex_count_t count;
+#if !defined(OS_EXCLUDE_RTOS_MUTEX_PRIORITY_CEILING)
     os_thread_prio_t initial_prio_ceiling;
     os_thread_prio_t prio_ceiling;
+#endif /* !defined(OS_EXCLUDE_RTOS_MUTEX_PRIORITY_CEILING) */
     os_thread_prio_t bosted_prio;
+#if !defined(OS_EXCLUDE_RTOS_MUTEX_ROBUST)
     bool owner_dead;
     bool consistent;
     bool recoverable;
+#endif /* !defined(OS_EXCLUDE_RTOS_MUTEX_ROBUST) */
     os_mutex_type_t type;
     os_mutex_protocol_t protocol;
     os_mutex_robustness_t robustness;
     os_mutex_count_t max_count;
+#if defined(OS_INCLUDE_RTOS_SMP)
+    uint32_t spin_cycles;
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
 
     /**
      * @endcond
@@ -1034,10 +1291,13 @@ extern "C"
      * @cond ignore
      */
 
+#if !defined(OS_EXCLUDE_RTOS_OBJECT_NAMES)
     const char* name;
+#endif /* !defined(OS_EXCLUDE_RTOS_OBJECT_NAMES) */
 #if !defined(OS_USE_RTOS_PORT_CONDITION_VARIABLE)
     os_internal_threads_waiting_list_t list;
     // void* clock;
+    void* mutex;
 #endif
 
     /**
@@ -1117,7 +1377,9 @@ extern "C"
      * @cond ignore
      */
 
+#if !defined(OS_EXCLUDE_RTOS_OBJECT_NAMES)
     const char* name;
+#endif /* !defined(OS_EXCLUDE_RTOS_OBJECT_NAMES) */
 #if !defined(OS_USE_RTOS_PORT_SEMAPHORE)
     os_internal_threads_waiting_list_t list;
     void* clock;
@@ -1179,6 +1441,11 @@ extern "C"
      */
     size_t mp_pool_size_bytes;
 
+    /**
+     * @brief Use a lock-free list of free blocks.
+     */
+    bool mp_lock_free;
+
   } os_mempool_attr_t;
 
   /**
@@ -1204,7 +1471,9 @@ extern "C"
      */
 
     void* vtbl;
+#if !defined(OS_EXCLUDE_RTOS_OBJECT_NAMES)
     const char* name;
+#endif /* !defined(OS_EXCLUDE_RTOS_OBJECT_NAMES) */
 #if !defined(OS_USE_RTOS_PORT_MEMORY_POOL)
     os_internal_threads_waiting_list_t list;
     void* clock;
@@ -1221,6 +1490,8 @@ extern "C"
     os_mempool_size_t block_size_bytes;
     os_mempool_size_t count;
     void* first;
+    os_internal_lock_free_block_list_t lock_free_list;
+    bool lock_free;
 
     /**
      * @endcond
@@ -1286,6 +1557,11 @@ extern "C"
      */
     size_t mq_queue_size_bytes;
 
+    /**
+     * @brief Keep a tail per priority level, to insert in constant time.
+     */
+    bool mq_priority_levels;
+
   } os_mqueue_attr_t;
 
   /**
@@ -1311,7 +1587,9 @@ extern "C"
      */
 
     void* vtbl;
+#if !defined(OS_EXCLUDE_RTOS_OBJECT_NAMES)
     const char* name;
+#endif /* !defined(OS_EXCLUDE_RTOS_OBJECT_NAMES) */
 #if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
     os_internal_threads_waiting_list_t send_list;
     os_internal_threads_waiting_list_t receive_list;
@@ -1319,6 +1597,7 @@ extern "C"
     os_mqueue_index_t* prev_array;
     os_mqueue_index_t* next_array;
     os_mqueue_prio_t* prio_array;
+    uint32_t* levels_map;
     void* first_free;
 #endif
 
@@ -1403,9 +1682,14 @@ extern "C"
      * @cond ignore
      */
 
+#if !defined(OS_EXCLUDE_RTOS_OBJECT_NAMES)
     const char* name;
+#endif /* !defined(OS_EXCLUDE_RTOS_OBJECT_NAMES) */
 #if !defined(OS_USE_RTOS_PORT_EVENT_FLAGS)
     os_internal_threads_waiting_list_t list;
+#if defined(OS_INCLUDE_RTOS_EVENT_FLAGS_MASKED_WAKEUP)
+    os_internal_threads_waiting_list_t masked_list;
+#endif /* defined(OS_INCLUDE_RTOS_EVENT_FLAGS_MASKED_WAKEUP) */
     void* clock;
 #endif
 
@@ -1450,6 +1734,26 @@ extern "C"
   void
   os_rtc_handler (void);
 
+#if defined(OS_USE_RTOS_HIGHRES_COMPARE_MATCH)
+
+  /**
+   * @brief High resolution compare match interrupt handler.
+   */
+  void
+  os_highres_compare_handler (void);
+
+#endif /* defined(OS_USE_RTOS_HIGHRES_COMPARE_MATCH) */
+
+#if defined(OS_INCLUDE_RTOS_CALLOUTS)
+
+  /**
+   * @brief Callouts hardware timer interrupt handler.
+   */
+  void
+  os_callout_handler (void);
+
+#endif /* defined(OS_INCLUDE_RTOS_CALLOUTS) */
+
   /**
    * @}
    */
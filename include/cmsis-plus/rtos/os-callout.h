@@ -0,0 +1,150 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_RTOS_OS_CALLOUT_H_
+#define CMSIS_PLUS_RTOS_OS_CALLOUT_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#include <cmsis-plus/rtos/os-decls.h>
+#include <cmsis-plus/rtos/os-clocks.h>
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_INCLUDE_RTOS_CALLOUTS)
+
+namespace os
+{
+  namespace rtos
+  {
+    /**
+     * @brief High resolution callouts.
+     * @ingroup cmsis-plus-rtos-core
+     * @details
+     * Short functions called directly from the interrupt handler
+     * of a dedicated hardware timer, at a high resolution clock
+     * time stamp, with a resolution of a few CPU cycles.
+     *
+     * Unlike `timer`, the callouts do not use the clock timer
+     * lists and do not depend on the SysTick period; they are
+     * intended for tiny actions, like starting a conversion
+     * a few microseconds after an event.
+     */
+    namespace callout
+    {
+      /**
+       * @brief Type of callout functions.
+       * @param [in] args Pointer to the argument passed to `schedule()`.
+       */
+      using func_t = void (*) (void* args);
+
+      /**
+       * @brief Type of callout identifiers.
+       * @details
+       * Zero is never used for a scheduled callout.
+       */
+      using id_t = uint32_t;
+
+      /**
+       * @brief Schedule a function after a delay.
+       * @param [in] cycles The delay, in high resolution clock cycles.
+       * @param [in] func Pointer to function.
+       * @param [in] args Pointer to function argument.
+       * @param [out] id Pointer where to store the identifier;
+       *  may be `nullptr`.
+       * @retval result::ok The callout was scheduled.
+       * @retval EINVAL The function pointer is `nullptr`.
+       * @retval EWOULDBLOCK All entries are in use.
+       */
+      result_t
+      schedule (clock::duration_t cycles, func_t func, void* args = nullptr,
+                id_t* id = nullptr);
+
+      /**
+       * @brief Schedule a function at a time stamp.
+       * @param [in] timestamp The high resolution clock time stamp.
+       * @param [in] func Pointer to function.
+       * @param [in] args Pointer to function argument.
+       * @param [out] id Pointer where to store the identifier;
+       *  may be `nullptr`.
+       * @retval result::ok The callout was scheduled.
+       * @retval EINVAL The function pointer is `nullptr`.
+       * @retval EWOULDBLOCK All entries are in use.
+       */
+      result_t
+      schedule_at (clock::timestamp_t timestamp, func_t func,
+                   void* args = nullptr, id_t* id = nullptr);
+
+      /**
+       * @brief Cancel a pending callout.
+       * @param [in] id The identifier returned by `schedule()`.
+       * @retval result::ok The callout was removed.
+       * @retval ENOENT The callout was already called or cancelled.
+       */
+      result_t
+      cancel (id_t id);
+
+      /**
+       * @brief Convert microseconds to high resolution clock cycles.
+       * @param [in] microsec The number of microseconds.
+       * @return The number of cycles.
+       */
+      clock::duration_t
+      cycles_from_us (uint32_t microsec);
+
+      /**
+       * @brief Get the number of pending callouts.
+       * @par Parameters
+       *  None.
+       * @return The number of callouts scheduled and not yet called.
+       */
+      std::size_t
+      pending (void);
+
+      /**
+       * @brief Get the capacity.
+       * @par Parameters
+       *  None.
+       * @return The max number of pending callouts.
+       */
+      std::size_t
+      capacity (void);
+
+    } /* namespace callout */
+  } /* namespace rtos */
+} /* namespace os */
+
+#endif /* defined(OS_INCLUDE_RTOS_CALLOUTS) */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_RTOS_OS_CALLOUT_H_ */
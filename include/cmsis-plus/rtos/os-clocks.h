@@ -221,6 +221,43 @@ namespace os
       timestamp_t
       update_for_slept_time (duration_t duration);
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK_LATENCY)
+
+      /**
+       * @brief Get the timeouts latency statistics.
+       * @param [out] expiry Where to copy the lateness of the
+       *  dispatch from the time stamps; may be `nullptr`.
+       * @param [out] wakeup Where to copy the delay from the
+       *  dispatch to the woken thread running; may be `nullptr`.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      latency_statistics (statistics::latency* expiry,
+                          statistics::latency* wakeup);
+
+      /**
+       * @brief Display the timeouts latency statistics.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      dump_latency_statistics (void);
+
+      /**
+       * @brief Clear the timeouts latency statistics.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      reset_latency_statistics (void);
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK_LATENCY) */
+
       /**
        * @cond ignore
        */
@@ -560,6 +597,15 @@ namespace os
 
 #endif /* defined(OS_USE_RTOS_PORT_CLOCK_SYSTICK_WAIT_FOR) */
 
+#if defined(OS_USE_RTOS_CLOCK_TIMER_WHEEL)
+
+      /**
+       * @brief Timer wheel used for the steady time stamps.
+       */
+      internal::clock_timestamps_wheel wheel_;
+
+#endif /* defined(OS_USE_RTOS_CLOCK_TIMER_WHEEL) */
+
       /**
        * @endcond
        */
@@ -679,6 +725,17 @@ namespace os
 
 #endif
 
+#if defined(OS_USE_RTOS_CLOCK_TIMER_WHEEL)
+
+    protected:
+
+      /**
+       * @brief Timer wheel used for the steady time stamps.
+       */
+      internal::clock_timestamps_wheel wheel_;
+
+#endif /* defined(OS_USE_RTOS_CLOCK_TIMER_WHEEL) */
+
       /**
        * @endcond
        */
@@ -760,9 +817,71 @@ namespace os
       uint32_t
       input_clock_frequency_hz (void);
 
+#if defined(OS_USE_RTOS_CLOCK_RETIMING)
+
+      /**
+       * @brief Adjust the clocks to a new core clock frequency.
+       * @param [in] input_frequency_hz The new frequency of the
+       *  SysTick input clock.
+       * @retval result::ok The clocks were adjusted.
+       * @retval EINVAL The frequency is 0.
+       */
+      result_t
+      retime (uint32_t input_frequency_hz);
+
+#endif /* defined(OS_USE_RTOS_CLOCK_RETIMING) */
+
       void
       internal_increment_count (void);
 
+      /**
+       * @brief Tell the current time, without a critical section.
+       * @par Parameters
+       *  None.
+       * @return The number of SysTick input clocks since startup.
+       * @note Must be called with the interrupts masked.
+       */
+      timestamp_t
+      internal_now_unlocked (void);
+
+#if defined(OS_USE_RTOS_HIGHRES_COMPARE_MATCH)
+
+      /**
+       * @brief Arm the compare match for the earliest deadline.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       * @note Must be called with the interrupts masked.
+       */
+      void
+      internal_arm_compare (void);
+
+      /**
+       * @brief Process the compare match interrupt.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_compare_match (void);
+
+#endif /* defined(OS_USE_RTOS_HIGHRES_COMPARE_MATCH) */
+
+#if defined(OS_USE_RTOS_HIGHRES_FREE_RUNNING_COUNTER)
+
+      /**
+       * @brief Update the clock after sleep.
+       * @param [in] duration Ignored, the time is taken from
+       *  the free-running counter.
+       * @return The clock count after the update.
+       */
+      timestamp_t
+      update_for_slept_time (duration_t duration);
+
+#endif /* defined(OS_USE_RTOS_HIGHRES_FREE_RUNNING_COUNTER) */
+
       /**
        * @}
        */
@@ -779,6 +898,24 @@ namespace os
        * @}
        */
 
+#if defined(OS_USE_RTOS_HIGHRES_FREE_RUNNING_COUNTER)
+
+      /**
+       * @cond ignore
+       */
+
+      // The counter value when steady_count_ was last updated.
+      uint32_t last_cycles_ = 0;
+
+      // Odd while steady_count_ and last_cycles_ are updated.
+      uint32_t sequence_ = 0;
+
+      /**
+       * @endcond
+       */
+
+#endif /* defined(OS_USE_RTOS_HIGHRES_FREE_RUNNING_COUNTER) */
+
     };
 
     /**
@@ -831,6 +968,11 @@ namespace os
     __attribute__((always_inline))
     clock::internal_check_timestamps (void)
     {
+#if defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK_LATENCY)
+      statistics::dispatch_scope ds
+        { *this, steady_count_ };
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK_LATENCY) */
+
       steady_list_.check_timestamp (steady_count_);
     }
 
@@ -859,6 +1001,11 @@ namespace os
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wsign-conversion"
+#if defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK_LATENCY)
+      statistics::dispatch_scope ds
+        { *this, steady_count_ + offset_ };
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK_LATENCY) */
+
       adjusted_list_.check_timestamp (steady_count_ + offset_);
 #pragma GCC diagnostic pop
     }
@@ -896,8 +1043,23 @@ namespace os
     __attribute__((always_inline))
     clock_highres::internal_increment_count (void)
     {
+#if defined(OS_USE_RTOS_HIGHRES_FREE_RUNNING_COUNTER)
+      // Extend the counter, assuming it did not wrap more than once
+      // since the last update.
+      uint32_t cycles = port::clock_highres::free_running_cycles ();
+
+      __atomic_store_n (&sequence_, sequence_ + 1, __ATOMIC_RELAXED);
+      __atomic_signal_fence (__ATOMIC_SEQ_CST);
+
+      steady_count_ += static_cast<uint32_t> (cycles - last_cycles_);
+      last_cycles_ = cycles;
+
+      __atomic_signal_fence (__ATOMIC_SEQ_CST);
+      __atomic_store_n (&sequence_, sequence_ + 1, __ATOMIC_RELEASE);
+#else
       // Increment the highres count by SysTick divisor.
       steady_count_ += port::clock_highres::cycles_per_tick ();
+#endif /* defined(OS_USE_RTOS_HIGHRES_FREE_RUNNING_COUNTER) */
     }
 
     inline uint32_t
@@ -907,6 +1069,19 @@ namespace os
       return port::clock_highres::input_clock_frequency_hz ();
     }
 
+    inline clock::timestamp_t
+    __attribute__((always_inline))
+    clock_highres::internal_now_unlocked (void)
+    {
+#if defined(OS_USE_RTOS_HIGHRES_FREE_RUNNING_COUNTER)
+      return steady_count_
+          + static_cast<uint32_t> (port::clock_highres::free_running_cycles ()
+              - last_cycles_);
+#else
+      return steady_count_ + port::clock_highres::cycles_since_tick ();
+#endif /* defined(OS_USE_RTOS_HIGHRES_FREE_RUNNING_COUNTER) */
+    }
+
   // ========================================================================
 
   } /* namespace rtos */
@@ -152,6 +152,19 @@ namespace os
       condition_variable (const char* name,
                           const attributes& attr = initializer);
 
+#if !defined(OS_USE_RTOS_PORT_CONDITION_VARIABLE)
+
+      /**
+       * @brief Construct a condition variable object instance
+       *  at compile time.
+       * @param [in] tag The constant initialisation tag.
+       * @param [in] name Pointer to name.
+       */
+      constexpr
+      condition_variable (constant_init_t tag, const char* name);
+
+#endif /* !defined(OS_USE_RTOS_PORT_CONDITION_VARIABLE) */
+
       /**
        * @cond ignore
        */
@@ -274,6 +287,36 @@ namespace os
        * @}
        */
 
+    protected:
+
+      /**
+       * @name Private Member Functions
+       * @{
+       */
+
+      /**
+       * @cond ignore
+       */
+
+      /**
+       * @brief Internal function used to wait for a notification.
+       * @param [in] mutex Reference to the associated mutex.
+       * @param [in] timeout The timeout duration.
+       * @param [in] timed Use the timeout.
+       * @retval result::ok The condition change was signalled.
+       * @retval ETIMEDOUT The timeout has passed.
+       */
+      result_t
+      internal_wait_ (mutex& mutex, clock::duration_t timeout, bool timed);
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @}
+       */
+
     protected:
 
       /**
@@ -288,6 +331,9 @@ namespace os
 #if !defined(OS_USE_RTOS_PORT_CONDITION_VARIABLE)
       internal::waiting_threads_list list_;
       // clock& clock_;
+
+      // The mutex used by the waiting threads, if any.
+      mutex* mutex_ = nullptr;
 #endif
 
       /**
@@ -318,6 +364,26 @@ namespace os
 
     // ========================================================================
 
+#if !defined(OS_USE_RTOS_PORT_CONDITION_VARIABLE)
+
+    /**
+     * @details
+     * Static instances are fully initialised by the compiler,
+     * so no constructor runs from the init array.
+     */
+    constexpr
+    condition_variable::condition_variable (constant_init_t tag,
+                                            const char* name) :
+        object_named_system
+          { name }, //
+        list_
+          { tag }
+    {
+      ;
+    }
+
+#endif /* !defined(OS_USE_RTOS_PORT_CONDITION_VARIABLE) */
+
     /**
      * @details
      * Identical condition variables should have the same memory address.
@@ -0,0 +1,1096 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_RTOS_OS_COROUTINE_H_
+#define CMSIS_PLUS_RTOS_OS_COROUTINE_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#include <cmsis-plus/rtos/os.h>
+
+// Coroutines require C++20 (or `-fcoroutines`).
+#if defined(__cpp_impl_coroutine) && (__cplusplus >= 202002L)
+
+#include <coroutine>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    /**
+     * @brief Stackless coroutines on top of the RTOS objects.
+     * @ingroup cmsis-plus-rtos
+     *
+     * @details
+     * Many coroutines share the stack of the thread running
+     * the `co::scheduler`; each one needs only its frame,
+     * allocated from a memory resource.
+     */
+    namespace co
+    {
+      class scheduler;
+      class promise;
+      class task;
+
+      // ======================================================================
+
+      /**
+       * @brief Set the memory resource used for coroutine frames.
+       * @param [in] mr Pointer to memory resource, for example a
+       *  `memory::block_pool`; `nullptr` for the default resource.
+       * @return Pointer to the previous memory resource.
+       */
+      memory::memory_resource*
+      frame_resource (memory::memory_resource* mr) noexcept;
+
+      // ======================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+      /**
+       * @brief Base class of the objects a coroutine can wait for.
+       * @headerfile os-coroutine.h <cmsis-plus/rtos/os-coroutine.h>
+       *
+       * @details
+       * The awaiter lives in the coroutine frame while it is
+       * suspended; the scheduler keeps it in a list and, when
+       * idle, links a node of its thread in the waiting list of
+       * the RTOS object, like `wait_set` does.
+       */
+      class awaiter
+      {
+      public:
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct an awaiter object instance.
+         * @par Parameters
+         *  None.
+         */
+        awaiter () = default;
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        awaiter (const awaiter&) = delete;
+        awaiter (awaiter&&) = delete;
+        awaiter&
+        operator= (const awaiter&) = delete;
+        awaiter&
+        operator= (awaiter&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the awaiter object instance.
+         */
+        virtual
+        ~awaiter () = default;
+
+        /**
+         * @}
+         */
+
+      public:
+
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+        /**
+         * @brief Check if the coroutine can continue without suspending.
+         * @par Parameters
+         *  None.
+         * @retval true The operation was completed.
+         * @retval false The coroutine must be suspended.
+         */
+        bool
+        await_ready (void);
+
+        /**
+         * @brief Suspend the coroutine until the operation completes.
+         * @param [in] h The handle of the suspended coroutine.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        await_suspend (std::coroutine_handle<promise> h);
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        friend class scheduler;
+
+        /**
+         * @name Private Member Functions
+         * @{
+         */
+
+        /**
+         * @brief Try to complete the operation, without blocking.
+         * @par Parameters
+         *  None.
+         * @retval true The operation was completed.
+         * @retval false The operation must wait.
+         */
+        virtual bool
+        do_try_complete (void) = 0;
+
+        /**
+         * @brief Check if `do_try_complete()` would succeed.
+         * @par Parameters
+         *  None.
+         * @retval true The operation can be completed.
+         * @retval false The operation must wait.
+         *
+         * @details
+         * Called in an interrupts critical section, it must not
+         * consume anything.
+         */
+        virtual bool
+        do_ready (void) = 0;
+
+        /**
+         * @cond ignore
+         */
+
+        static internal::waiting_threads_list*
+        internal_list_ (semaphore& sem);
+
+        static internal::waiting_threads_list*
+        internal_list_ (message_queue& mq);
+
+        static internal::waiting_threads_list*
+        internal_list_ (event_flags& evf);
+
+        static bool
+        internal_raised_ (event_flags& evf, flags::mask_t mask,
+                          flags::mode_t mode);
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @name Private Member Variables
+         * @{
+         */
+
+        /**
+         * @cond ignore
+         */
+
+        // The waiting list of the RTOS object; if `nullptr`,
+        // the awaiter is checked at each clock tick.
+        internal::waiting_threads_list* list_ = nullptr;
+
+        // Only with `timed_`, the time stamp when it is ready.
+        clock::timestamp_t deadline_ = 0;
+        bool timed_ = false;
+
+        std::coroutine_handle<> handle_;
+        awaiter* next_ = nullptr;
+
+        // Constructed while the scheduler thread blocks.
+        alignas(internal::waiting_thread_node) //
+        char node_[sizeof(internal::waiting_thread_node)];
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @}
+         */
+      };
+
+      // ======================================================================
+
+      /**
+       * @brief Let the other ready coroutines run.
+       * @headerfile os-coroutine.h <cmsis-plus/rtos/os-coroutine.h>
+       */
+      class yield_awaiter : public awaiter
+      {
+      public:
+
+        /**
+         * @brief Resume the coroutine.
+         * @par Parameters
+         *  None.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        await_resume (void) noexcept
+        {
+        }
+
+      protected:
+
+        virtual bool
+        do_try_complete (void) override;
+
+        virtual bool
+        do_ready (void) override;
+      };
+
+      // ======================================================================
+
+      /**
+       * @brief Promise of the `co::task` coroutines.
+       * @headerfile os-coroutine.h <cmsis-plus/rtos/os-coroutine.h>
+       *
+       * @details
+       * The frames are allocated from the memory resource set with
+       * `frame_resource()`; if the allocation fails, the coroutine
+       * returns an invalid task.
+       */
+      class promise
+      {
+      public:
+
+        /**
+         * @brief The final awaiter, resuming the caller, if any.
+         */
+        class final_awaiter
+        {
+        public:
+
+          bool
+          await_ready (void) noexcept
+          {
+            return false;
+          }
+
+          std::coroutine_handle<>
+          await_suspend (std::coroutine_handle<promise> h) noexcept;
+
+          void
+          await_resume (void) noexcept
+          {
+          }
+        };
+
+        /**
+         * @name Coroutine Interface
+         * @{
+         */
+
+        task
+        get_return_object (void) noexcept;
+
+        static task
+        get_return_object_on_allocation_failure (void) noexcept;
+
+        std::suspend_always
+        initial_suspend (void) noexcept
+        {
+          return
+            {};
+        }
+
+        final_awaiter
+        final_suspend (void) noexcept
+        {
+          return
+            {};
+        }
+
+        void
+        return_void (void) noexcept
+        {
+        }
+
+        void
+        unhandled_exception (void) noexcept;
+
+        static void*
+        operator new (std::size_t bytes) noexcept;
+
+        static void
+        operator delete (void* ptr, std::size_t bytes) noexcept;
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        friend class awaiter;
+        friend class scheduler;
+        friend class task;
+
+        /**
+         * @cond ignore
+         */
+
+        scheduler* scheduler_ = nullptr;
+
+        // The coroutine waiting for this one to complete;
+        // empty for the tasks spawned in the scheduler.
+        std::coroutine_handle<> continuation_;
+
+        // The spawned tasks, in the scheduler list.
+        promise* prev_ = nullptr;
+        promise* next_ = nullptr;
+
+        // Used to queue the task when spawned.
+        yield_awaiter start_;
+
+        /**
+         * @endcond
+         */
+      };
+
+      // ======================================================================
+
+      /**
+       * @brief The return type of coroutines.
+       * @headerfile os-coroutine.h <cmsis-plus/rtos/os-coroutine.h>
+       *
+       * @details
+       * A task either runs in a scheduler, passed to `spawn()`,
+       * or is awaited by another coroutine, which is resumed when
+       * the task completes; the task owns the coroutine frame
+       * until then.
+       *
+       * @par Example
+       *
+       * @code{.cpp}
+       * co::task
+       * blink (semaphore& sem)
+       * {
+       *   for (;;)
+       *     {
+       *       co_await co::wait (sem);
+       *       led.toggle ();
+       *       co_await co::sleep_for (100);
+       *     }
+       * }
+       * @endcode
+       */
+      class task
+      {
+      public:
+
+        using promise_type = promise;
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct an invalid task.
+         * @par Parameters
+         *  None.
+         */
+        task () = default;
+
+        /**
+         * @brief Construct a task from a coroutine handle.
+         * @param [in] h The coroutine handle.
+         */
+        explicit
+        task (std::coroutine_handle<promise> h) noexcept;
+
+        /**
+         * @brief Move the ownership of the coroutine.
+         * @param [in] other The task to move from.
+         */
+        task (task&& other) noexcept;
+
+        /**
+         * @brief Move the ownership of the coroutine.
+         * @param [in] other The task to move from.
+         * @return Reference to this task.
+         */
+        task&
+        operator= (task&& other) noexcept;
+
+        /**
+         * @cond ignore
+         */
+
+        task (const task&) = delete;
+        task&
+        operator= (const task&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destroy the coroutine frame, if still owned.
+         */
+        ~task ();
+
+        /**
+         * @}
+         */
+
+      public:
+
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+        /**
+         * @brief Check if the task refers to a coroutine.
+         * @par Parameters
+         *  None.
+         * @retval true The coroutine frame was allocated.
+         * @retval false The task is empty.
+         */
+        bool
+        valid (void) const noexcept;
+
+        /**
+         * @brief Check if the awaited task is already done.
+         * @par Parameters
+         *  None.
+         * @retval true The task is empty or completed.
+         * @retval false The task must run.
+         */
+        bool
+        await_ready (void) const noexcept;
+
+        /**
+         * @brief Run the task in the scheduler of the caller.
+         * @param [in] caller The handle of the awaiting coroutine.
+         * @return The task coroutine handle.
+         */
+        std::coroutine_handle<>
+        await_suspend (std::coroutine_handle<promise> caller) noexcept;
+
+        /**
+         * @brief Get the result of awaiting.
+         * @par Parameters
+         *  None.
+         * @retval result::ok The task was completed.
+         * @retval ENOMEM The coroutine frame could not be allocated.
+         */
+        result_t
+        await_resume (void) const noexcept;
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        friend class scheduler;
+
+        /**
+         * @cond ignore
+         */
+
+        std::coroutine_handle<promise> handle_;
+
+        /**
+         * @endcond
+         */
+      };
+
+      // ======================================================================
+
+      /**
+       * @brief Run coroutines on the current thread.
+       * @headerfile os-coroutine.h <cmsis-plus/rtos/os-coroutine.h>
+       * @ingroup cmsis-plus-rtos
+       *
+       * @details
+       * The ready coroutines are resumed in the order they became
+       * ready; when none is ready, the thread is suspended until
+       * one of the awaited objects is posted, sent or raised,
+       * a sleep expires, or a task is spawned.
+       */
+      class scheduler : public internal::object_named_system
+      {
+      public:
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a coroutine scheduler object instance.
+         * @param [in] name Pointer to name.
+         */
+        scheduler (const char* name = nullptr);
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        scheduler (const scheduler&) = delete;
+        scheduler (scheduler&&) = delete;
+        scheduler&
+        operator= (const scheduler&) = delete;
+        scheduler&
+        operator= (scheduler&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the scheduler, and the tasks not completed.
+         */
+        ~scheduler ();
+
+        /**
+         * @}
+         */
+
+      public:
+
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+        /**
+         * @brief Add a task to the scheduler.
+         * @param [in] t The task; the scheduler takes its ownership.
+         * @retval result::ok The task was added.
+         * @retval ENOMEM The coroutine frame could not be allocated.
+         * @retval EINVAL The task already started.
+         */
+        result_t
+        spawn (task&& t);
+
+        /**
+         * @brief Run the tasks, until all complete.
+         * @par Parameters
+         *  None.
+         * @retval result::ok All tasks completed.
+         * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+         * @retval EBUSY Another thread runs the scheduler.
+         * @retval EINTR The thread was interrupted.
+         */
+        result_t
+        run (void);
+
+        /**
+         * @brief Get the number of tasks not completed.
+         * @par Parameters
+         *  None.
+         * @return The number of tasks.
+         */
+        std::size_t
+        size (void) const;
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        friend class awaiter;
+        friend class promise;
+
+        /**
+         * @name Private Member Functions
+         * @{
+         */
+
+        /**
+         * @cond ignore
+         */
+
+        void
+        internal_ready_ (awaiter& a);
+
+        void
+        internal_wait_ (awaiter& a);
+
+        void
+        internal_done_ (promise& p);
+
+        bool
+        internal_poll_ (void);
+
+        result_t
+        internal_block_ (thread& th);
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @name Private Member Variables
+         * @{
+         */
+
+        /**
+         * @cond ignore
+         */
+
+        // Functions resumed in order; also linked from other threads.
+        awaiter* ready_head_ = nullptr;
+        awaiter* ready_tail_ = nullptr;
+
+        // Only used by the scheduler thread.
+        awaiter* waiting_ = nullptr;
+
+        // The spawned tasks, not yet completed.
+        promise* tasks_ = nullptr;
+        promise* done_ = nullptr;
+        std::size_t size_ = 0;
+
+        // Where the scheduler thread waits for new tasks.
+        internal::waiting_threads_list wake_list_;
+        thread* volatile thread_ = nullptr;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @}
+         */
+      };
+
+      // ======================================================================
+
+      /**
+       * @brief Wait for a semaphore.
+       * @headerfile os-coroutine.h <cmsis-plus/rtos/os-coroutine.h>
+       */
+      class semaphore_awaiter : public awaiter
+      {
+      public:
+
+        /**
+         * @brief Construct an awaiter for a semaphore.
+         * @param [in] sem Reference to semaphore.
+         */
+        semaphore_awaiter (semaphore& sem);
+
+        /**
+         * @brief Get the result.
+         * @par Parameters
+         *  None.
+         * @return The result of `semaphore::try_wait()`.
+         */
+        result_t
+        await_resume (void) const noexcept
+        {
+          return res_;
+        }
+
+      protected:
+
+        virtual bool
+        do_try_complete (void) override;
+
+        virtual bool
+        do_ready (void) override;
+
+        /**
+         * @cond ignore
+         */
+
+        semaphore& sem_;
+        result_t res_ = result::ok;
+
+        /**
+         * @endcond
+         */
+      };
+
+      /**
+       * @brief Wait for a message.
+       * @headerfile os-coroutine.h <cmsis-plus/rtos/os-coroutine.h>
+       */
+      class receive_awaiter : public awaiter
+      {
+      public:
+
+        /**
+         * @brief Construct an awaiter for a message queue.
+         * @param [in] mq Reference to message queue.
+         * @param [out] msg The address where to store the message.
+         * @param [in] nbytes The size of the destination.
+         * @param [out] mprio Optional pointer where to store
+         *  the message priority; may be `nullptr`.
+         */
+        receive_awaiter (message_queue& mq, void* msg, std::size_t nbytes,
+                         message_queue::priority_t* mprio);
+
+        /**
+         * @brief Get the result.
+         * @par Parameters
+         *  None.
+         * @return The result of `message_queue::try_receive()`.
+         */
+        result_t
+        await_resume (void) const noexcept
+        {
+          return res_;
+        }
+
+      protected:
+
+        virtual bool
+        do_try_complete (void) override;
+
+        virtual bool
+        do_ready (void) override;
+
+        /**
+         * @cond ignore
+         */
+
+        message_queue& mq_;
+        void* msg_;
+        std::size_t nbytes_;
+        message_queue::priority_t* mprio_;
+        result_t res_ = result::ok;
+
+        /**
+         * @endcond
+         */
+      };
+
+      /**
+       * @brief Wait for event flags.
+       * @headerfile os-coroutine.h <cmsis-plus/rtos/os-coroutine.h>
+       */
+      class flags_awaiter : public awaiter
+      {
+      public:
+
+        /**
+         * @brief Construct an awaiter for event flags.
+         * @param [in] evf Reference to event flags.
+         * @param [in] mask The expected flags (OR-ed bit-mask).
+         * @param [out] oflags Optional pointer where to store the
+         *  expected flags raised; may be `nullptr`.
+         * @param [in] mode Mode bits, as for `event_flags::try_wait()`.
+         */
+        flags_awaiter (event_flags& evf, flags::mask_t mask,
+                       flags::mask_t* oflags, flags::mode_t mode);
+
+        /**
+         * @brief Get the result.
+         * @par Parameters
+         *  None.
+         * @return The result of `event_flags::try_wait()`.
+         */
+        result_t
+        await_resume (void) const noexcept
+        {
+          return res_;
+        }
+
+      protected:
+
+        virtual bool
+        do_try_complete (void) override;
+
+        virtual bool
+        do_ready (void) override;
+
+        /**
+         * @cond ignore
+         */
+
+        event_flags& evf_;
+        flags::mask_t mask_;
+        flags::mask_t* oflags_;
+        flags::mode_t mode_;
+        result_t res_ = result::ok;
+
+        /**
+         * @endcond
+         */
+      };
+
+      /**
+       * @brief Wait for a time stamp of the system clock.
+       * @headerfile os-coroutine.h <cmsis-plus/rtos/os-coroutine.h>
+       */
+      class sleep_awaiter : public awaiter
+      {
+      public:
+
+        /**
+         * @brief Construct an awaiter for a time stamp.
+         * @param [in] timestamp The steady time stamp, in ticks.
+         */
+        explicit
+        sleep_awaiter (clock::timestamp_t timestamp);
+
+        /**
+         * @brief Resume the coroutine.
+         * @par Parameters
+         *  None.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        await_resume (void) const noexcept
+        {
+        }
+
+      protected:
+
+        virtual bool
+        do_try_complete (void) override;
+
+        virtual bool
+        do_ready (void) override;
+      };
+
+#pragma GCC diagnostic pop
+
+      // ======================================================================
+
+      /**
+       * @brief Wait for a semaphore.
+       * @param [in] sem Reference to semaphore.
+       * @return An awaiter; `co_await` returns the `try_wait()` result.
+       */
+      semaphore_awaiter
+      wait (semaphore& sem);
+
+      /**
+       * @brief Wait for a message.
+       * @param [in] mq Reference to message queue.
+       * @param [out] msg The address where to store the message.
+       * @param [in] nbytes The size of the destination.
+       * @param [out] mprio Optional pointer where to store
+       *  the message priority; may be `nullptr`.
+       * @return An awaiter; `co_await` returns the `try_receive()` result.
+       */
+      receive_awaiter
+      receive (message_queue& mq, void* msg, std::size_t nbytes,
+               message_queue::priority_t* mprio = nullptr);
+
+      /**
+       * @brief Wait for event flags.
+       * @param [in] evf Reference to event flags.
+       * @param [in] mask The expected flags (OR-ed bit-mask).
+       * @param [out] oflags Optional pointer where to store the
+       *  expected flags raised; may be `nullptr`.
+       * @param [in] mode Mode bits, as for `event_flags::try_wait()`.
+       * @return An awaiter; `co_await` returns the `try_wait()` result.
+       */
+      flags_awaiter
+      wait (event_flags& evf, flags::mask_t mask, flags::mask_t* oflags =
+                nullptr,
+            flags::mode_t mode = flags::mode::all | flags::mode::clear);
+
+      /**
+       * @brief Sleep for a number of system clock ticks.
+       * @param [in] ticks The number of ticks.
+       * @return An awaiter.
+       */
+      sleep_awaiter
+      sleep_for (clock::duration_t ticks);
+
+      /**
+       * @brief Sleep until a system clock time stamp.
+       * @param [in] timestamp The steady time stamp, in ticks.
+       * @return An awaiter.
+       */
+      sleep_awaiter
+      sleep_until (clock::timestamp_t timestamp);
+
+      /**
+       * @brief Let the other ready coroutines run.
+       * @par Parameters
+       *  None.
+       * @return An awaiter.
+       */
+      yield_awaiter
+      yield (void);
+
+    } /* namespace co */
+  } /* namespace rtos */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace rtos
+  {
+    namespace co
+    {
+      inline bool
+      awaiter::await_ready (void)
+      {
+        return do_try_complete ();
+      }
+
+      inline void
+      awaiter::await_suspend (std::coroutine_handle<promise> h)
+      {
+        handle_ = h;
+        h.promise ().scheduler_->internal_wait_ (*this);
+      }
+
+      // ----------------------------------------------------------------------
+
+      inline
+      task::task (std::coroutine_handle<promise> h) noexcept :
+          handle_ (h)
+      {
+      }
+
+      inline
+      task::task (task&& other) noexcept :
+          handle_ (other.handle_)
+      {
+        other.handle_ = nullptr;
+      }
+
+      inline bool
+      task::valid (void) const noexcept
+      {
+        return static_cast<bool> (handle_);
+      }
+
+      inline bool
+      task::await_ready (void) const noexcept
+      {
+        return !handle_ || handle_.done ();
+      }
+
+      inline result_t
+      task::await_resume (void) const noexcept
+      {
+        if (!handle_)
+          {
+            return ENOMEM;
+          }
+        return result::ok;
+      }
+
+      // ----------------------------------------------------------------------
+
+      inline std::size_t
+      scheduler::size (void) const
+      {
+        return size_;
+      }
+
+      // ----------------------------------------------------------------------
+
+      inline semaphore_awaiter
+      wait (semaphore& sem)
+      {
+        return semaphore_awaiter
+          { sem };
+      }
+
+      inline receive_awaiter
+      receive (message_queue& mq, void* msg, std::size_t nbytes,
+               message_queue::priority_t* mprio)
+      {
+        return receive_awaiter
+          { mq, msg, nbytes, mprio };
+      }
+
+      inline flags_awaiter
+      wait (event_flags& evf, flags::mask_t mask, flags::mask_t* oflags,
+            flags::mode_t mode)
+      {
+        return flags_awaiter
+          { evf, mask, oflags, mode };
+      }
+
+      inline sleep_awaiter
+      sleep_for (clock::duration_t ticks)
+      {
+        return sleep_awaiter
+          { sysclock.steady_now () + ticks };
+      }
+
+      inline sleep_awaiter
+      sleep_until (clock::timestamp_t timestamp)
+      {
+        return sleep_awaiter
+          { timestamp };
+      }
+
+      inline yield_awaiter
+      yield (void)
+      {
+        return
+          {};
+      }
+
+    } /* namespace co */
+  } /* namespace rtos */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* defined(__cpp_impl_coroutine) */
+
+#endif /* __cplusplus */
+
+// ----------------------------------------------------------------------------
+
+#endif /* CMSIS_PLUS_RTOS_OS_COROUTINE_H_ */
@@ -48,6 +48,8 @@
 #include <cerrno>
 #include <cstring>
 
+#include <cmsis-plus/utils/lists.h>
+
 /**
  * @brief System namespace.
  */
@@ -71,8 +73,15 @@ namespace os
     class message_queue;
     class mutex;
     class semaphore;
+    class stack_pool;
     class thread;
     class timer;
+    class wait_set;
+
+    namespace co
+    {
+      class awaiter;
+    } /* namespace co */
 
     // ------------------------------------------------------------------------
 
@@ -221,6 +230,135 @@ namespace os
        */
       using duration_t = uint64_t;
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_CRITICAL_SECTIONS) \
+  || defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK_LATENCY) \
+  || defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_PROFILE)
+
+      /**
+       * @brief Number of duration histogram buckets.
+       * @details
+       * Bucket `i` counts the durations between `4^i` and `4^(i+1)`
+       * CPU cycles; the last bucket also counts all longer ones.
+       */
+      constexpr std::size_t histogram_buckets = 16;
+
+      /**
+       * @brief Internal function used to get the histogram bucket
+       *  of a duration.
+       * @param [in] cycles The duration, in CPU cycles.
+       * @return The bucket index, below `histogram_buckets`.
+       */
+      inline std::size_t
+      __attribute__((always_inline))
+      internal_histogram_bucket_ (duration_t cycles)
+      {
+        std::size_t i = static_cast<std::size_t> ((63
+            - __builtin_clzll (cycles | 1)) / 2);
+        if (i >= histogram_buckets)
+          {
+            i = histogram_buckets - 1;
+          }
+        return i;
+      }
+
+#endif
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_CRITICAL_SECTIONS)
+
+      /**
+       * @brief Durations measured at one place in the code.
+       */
+      typedef struct site_s
+      {
+        /**
+         * @brief Return address of the code entering the critical
+         *  section, or `nullptr` for the interrupt latency.
+         */
+        const void* address;
+
+        /**
+         * @brief Number of measurements.
+         */
+        counter_t count;
+
+        /**
+         * @brief Longest duration, in CPU cycles.
+         */
+        duration_t max_cycles;
+
+        /**
+         * @brief Histogram of the durations.
+         */
+        counter_t histogram[histogram_buckets];
+      } site;
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_CRITICAL_SECTIONS) */
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK_LATENCY)
+
+      /**
+       * @brief Distribution of a timing latency.
+       */
+      typedef struct latency_s
+      {
+        /**
+         * @brief Number of measurements.
+         */
+        counter_t count;
+
+        /**
+         * @brief Sum of all latencies, in CPU cycles.
+         */
+        duration_t total_cycles;
+
+        /**
+         * @brief Longest latency, in CPU cycles.
+         */
+        duration_t max_cycles;
+
+        /**
+         * @brief Histogram of the latencies.
+         */
+        counter_t histogram[histogram_buckets];
+      } latency;
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK_LATENCY) */
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_STACK_SITES)
+
+      /**
+       * @brief Peak stack usage of the threads running one function.
+       */
+      typedef struct stack_site_s
+      {
+        /**
+         * @brief The thread function.
+         */
+        const void* function;
+
+        /**
+         * @brief Largest stack size, in bytes.
+         */
+        std::size_t size_bytes;
+
+        /**
+         * @brief Largest stack usage, in bytes.
+         */
+        std::size_t peak_bytes;
+
+        /**
+         * @brief Suggested stack size, in bytes.
+         */
+        std::size_t recommended_bytes;
+
+        /**
+         * @brief The thread name, possibly truncated.
+         */
+        char name[16];
+      } stack_site;
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_STACK_SITES) */
+
     } /* namespace statistics */
 
     // ------------------------------------------------------------------------
@@ -323,6 +461,52 @@ namespace os
 
     } /* namespace flags */
 
+#if defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS)
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @brief Thread notifications definitions.
+     * @ingroup cmsis-plus-rtos-thread
+     */
+    namespace notify
+    {
+      /**
+       * @brief Type of the thread notification value.
+       */
+      using value_t = uint32_t;
+
+      /**
+       * @brief How a notification updates the value.
+       */
+      enum class action : uint8_t
+      {
+        /**
+         * @brief OR the given bits into the value.
+         */
+        set_bits = 0,
+
+        /**
+         * @brief Increment the value; the given value is ignored.
+         */
+        increment,
+
+        /**
+         * @brief Replace the value.
+         */
+        overwrite,
+
+        /**
+         * @brief Replace the value, only if the previous
+         *  notification was already taken.
+         */
+        no_overwrite
+      };
+
+    } /* namespace notify */
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS) */
+
     // ------------------------------------------------------------------------
 
     /**
@@ -335,6 +519,80 @@ namespace os
 
     // ------------------------------------------------------------------------
 
+    /**
+     * @brief Tag type selecting the `constexpr` constructors.
+     * @details
+     * Static objects constructed with the
+     * `constant_init` tag are initialised by the compiler,
+     * without adding code to the init array.
+     */
+    using constant_init_t = utils::constant_init_t;
+
+    using utils::constant_init;
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @brief The kernel features profile.
+     *
+     * @details
+     * The optional features of the synchronisation objects are
+     * enabled by default; the `OS_EXCLUDE_RTOS_*` configuration macros
+     * remove them. The kernel tests these constants instead of the
+     * attributes, so the branches of the excluded features are
+     * removed by the compiler, together with their data members.
+     */
+    namespace features
+    {
+#if defined(OS_EXCLUDE_RTOS_MUTEX_RECURSIVE)
+      constexpr bool mutex_recursive = false;
+#else
+      /**
+       * @brief Recursive mutexes (`mutex::type::recursive`).
+       */
+      constexpr bool mutex_recursive = true;
+#endif /* defined(OS_EXCLUDE_RTOS_MUTEX_RECURSIVE) */
+
+#if defined(OS_EXCLUDE_RTOS_MUTEX_ROBUST)
+      constexpr bool mutex_robust = false;
+#else
+      /**
+       * @brief Robust mutexes (`mutex::robustness::robust`).
+       */
+      constexpr bool mutex_robust = true;
+#endif /* defined(OS_EXCLUDE_RTOS_MUTEX_ROBUST) */
+
+#if defined(OS_EXCLUDE_RTOS_MUTEX_PRIORITY_CEILING)
+      constexpr bool mutex_priority_ceiling = false;
+#else
+      /**
+       * @brief Priority ceiling mutexes (`mutex::protocol::protect`).
+       */
+      constexpr bool mutex_priority_ceiling = true;
+#endif /* defined(OS_EXCLUDE_RTOS_MUTEX_PRIORITY_CEILING) */
+
+#if defined(OS_EXCLUDE_RTOS_THREAD_CANCELLATION)
+      constexpr bool thread_cancellation = false;
+#else
+      /**
+       * @brief Cancel the waits with `thread::interrupt()`.
+       */
+      constexpr bool thread_cancellation = true;
+#endif /* defined(OS_EXCLUDE_RTOS_THREAD_CANCELLATION) */
+
+#if defined(OS_EXCLUDE_RTOS_OBJECT_NAMES)
+      constexpr bool object_names = false;
+#else
+      /**
+       * @brief Store the names of the objects.
+       */
+      constexpr bool object_names = true;
+#endif /* defined(OS_EXCLUDE_RTOS_OBJECT_NAMES) */
+
+    } /* namespace features */
+
+    // ------------------------------------------------------------------------
+
     /**
      * @brief A namespace to group all internal implementation objects.
      */
@@ -359,6 +617,7 @@ namespace os
         /**
          * @brief Construct a named object instance.
          */
+        constexpr
         object_named ();
 
         /**
@@ -366,6 +625,7 @@ namespace os
          * @param [in] name Null terminated name. If `nullptr`,
          * "-" is assigned.
          */
+        constexpr
         object_named (const char* name);
 
         /**
@@ -421,10 +681,12 @@ namespace os
          * @cond ignore
          */
 
+#if !defined(OS_EXCLUDE_RTOS_OBJECT_NAMES)
         /**
          * @brief Pointer to name.
          */
         const char* const name_ = "-";
+#endif /* !defined(OS_EXCLUDE_RTOS_OBJECT_NAMES) */
 
         /**
          * @endcond
@@ -453,6 +715,7 @@ namespace os
         /**
          * @brief Construct a named system object instance.
          */
+        constexpr
         object_named_system ();
 
         /**
@@ -460,6 +723,7 @@ namespace os
          * @param [in] name Null terminated name. If `nullptr`,
          * "-" is assigned.
          */
+        constexpr
         object_named_system (const char* name);
 
         /**
@@ -727,6 +991,12 @@ namespace os
   {
     // ========================================================================
 
+    constexpr
+    null_locker::null_locker ()
+    {
+      ;
+    }
+
     inline
     null_locker::~null_locker ()
     {
@@ -749,6 +1019,43 @@ namespace os
     {
       // ======================================================================
 
+      constexpr
+      object_named::object_named ()
+      {
+        ;
+      }
+
+      /**
+       * @details
+       * Prefer the given name, otherwise
+       * default to '-'.
+       *
+       * To save space, instead of copying the null terminated string
+       * locally, the pointer to the string
+       * is copied, so the caller must ensure that the pointer
+       * life cycle is at least as long as the object life cycle.
+       * A constant string (stored in flash) is preferred.
+       *
+       * Being `constexpr`, it allows the constant initialisation
+       * of the derived objects.
+       *
+       * With `OS_EXCLUDE_RTOS_OBJECT_NAMES` the name is not stored.
+       */
+#if !defined(OS_EXCLUDE_RTOS_OBJECT_NAMES)
+      constexpr
+      object_named::object_named (const char* name) :
+          name_ (name != nullptr ? name : "-")
+      {
+        ;
+      }
+#else
+      constexpr
+      object_named::object_named (const char* name __attribute__((unused)))
+      {
+        ;
+      }
+#endif /* !defined(OS_EXCLUDE_RTOS_OBJECT_NAMES) */
+
       /**
        * @details
        * All objects return a non-null string; anonymous objects
@@ -759,18 +1066,22 @@ namespace os
       inline const char*
       object_named::name (void) const
       {
+#if !defined(OS_EXCLUDE_RTOS_OBJECT_NAMES)
         return name_;
+#else
+        return "-";
+#endif /* !defined(OS_EXCLUDE_RTOS_OBJECT_NAMES) */
       }
 
       // ======================================================================
 
-      inline
+      constexpr
       object_named_system::object_named_system ()
       {
         ;
       }
 
-      inline
+      constexpr
       object_named_system::object_named_system (const char* name) :
           object_named (name)
       {
@@ -927,6 +1238,32 @@ namespace os
 
       // ----------------------------------------------------------------------
 
+#if defined(OS_INCLUDE_RTOS_SMP)
+
+      namespace core
+      {
+
+        // The index of the core executing the call, 0 for the boot core.
+        std::size_t
+        id (void);
+
+        // Release a secondary core, which must enter
+        // port::scheduler::start() and run its ready threads.
+        void
+        start (std::size_t core);
+
+        // Raise the inter-processor interrupt on the given core;
+        // its handler must request a context switch, like
+        // port::scheduler::reschedule().
+        void
+        reschedule (std::size_t core);
+
+      } /* namespace core */
+
+      // ----------------------------------------------------------------------
+
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+
       namespace this_thread
       {
 
@@ -1009,6 +1346,25 @@ namespace os
         static result_t
         wait_for (clock::duration_t ticks);
 
+#if defined(OS_USE_RTOS_CLOCK_RETIMING)
+
+        /**
+         * @brief Reprogram the SysTick for a new input frequency.
+         * @param [in] input_frequency_hz The new frequency of the
+         *  SysTick input clock.
+         * @details
+         * Called with the interrupts masked, after the clock was
+         * changed. Must keep the tick rate at
+         * `clock_systick::frequency_hz`, restart the current tick
+         * period, and update the values returned by
+         * `clock_highres::input_clock_frequency_hz()` and
+         * `clock_highres::cycles_per_tick()`.
+         */
+        static void
+        retime (uint32_t input_frequency_hz);
+
+#endif /* defined(OS_USE_RTOS_CLOCK_RETIMING) */
+
         /**
          * @brief SysTick implementation hook.
          * @details
@@ -1058,11 +1414,133 @@ namespace os
 
         static uint32_t
         input_clock_frequency_hz (void);
+
+#if defined(OS_USE_RTOS_HIGHRES_FREE_RUNNING_COUNTER)
+
+        /**
+         * @brief Read the free-running 32-bit up counter.
+         * @details
+         * Must count at `input_clock_frequency_hz()` and be
+         * started by `start()`.
+         */
+        static uint32_t
+        free_running_cycles (void);
+
+#endif /* defined(OS_USE_RTOS_HIGHRES_FREE_RUNNING_COUNTER) */
+
+#if defined(OS_USE_RTOS_HIGHRES_COMPARE_MATCH)
+
+        /**
+         * @brief Raise the compare match interrupt after a delay.
+         * @param [in] cycles The delay, in input clock cycles, at least 1.
+         * @details
+         * Replaces any previous request; the interrupt handler
+         * must call `os_highres_compare_handler()`.
+         */
+        static void
+        arm_compare (uint32_t cycles);
+
+        /**
+         * @brief Cancel the compare match interrupt.
+         */
+        static void
+        disarm_compare (void);
+
+#endif /* defined(OS_USE_RTOS_HIGHRES_COMPARE_MATCH) */
       };
 
+#if defined(OS_INCLUDE_RTOS_CALLOUTS)
+
+      // ======================================================================
+
+      /**
+       * @brief Hardware timer used by the callouts.
+       * @details
+       * A timer distinct from the SysTick and from the high
+       * resolution clock compare match, counting at
+       * `clock_highres::input_clock_frequency_hz()`.
+       */
+      class callout_timer
+      {
+      public:
+
+        callout_timer () = delete;
+
+        /**
+         * @brief Raise the timer interrupt after a delay.
+         * @param [in] cycles The delay, in input clock cycles, at least 1.
+         * @details
+         * Replaces any previous request; the interrupt handler
+         * must call `os_callout_handler()`.
+         */
+        static void
+        arm (uint32_t cycles);
+
+        /**
+         * @brief Cancel the timer interrupt.
+         */
+        static void
+        disarm (void);
+      };
+
+#endif /* defined(OS_INCLUDE_RTOS_CALLOUTS) */
+
     // ========================================================================
 
     } /* namespace port */
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK_LATENCY)
+
+    namespace statistics
+    {
+      /**
+       * @cond ignore
+       */
+
+      /**
+       * @brief Mark the nodes dispatched by a clock.
+       * @details
+       * Constructed around `check_timestamp()`, so the node
+       * actions know which clock dispatched them; nested
+       * clock interrupts restore the outer clock.
+       */
+      class dispatch_scope
+      {
+      public:
+
+        dispatch_scope (clock& clk, port::clock::timestamp_t now);
+
+        ~dispatch_scope ();
+
+        dispatch_scope (const dispatch_scope&) = delete;
+        dispatch_scope (dispatch_scope&&) = delete;
+        dispatch_scope&
+        operator= (const dispatch_scope&) = delete;
+        dispatch_scope&
+        operator= (dispatch_scope&&) = delete;
+
+      protected:
+
+        void* previous_;
+        port::clock::timestamp_t previous_now_;
+      };
+
+      void
+      internal_record_expiry_ (port::clock::timestamp_t timestamp);
+
+      void
+      internal_record_woken_ (thread& th);
+
+      void
+      internal_record_running_ (thread& th);
+
+      /**
+       * @endcond
+       */
+    } /* namespace statistics */
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK_LATENCY) */
+
   } /* namespace rtos */
 } /* namespace os */
 
@@ -1129,6 +1607,19 @@ extern "C"
 
 #endif /* __cplusplus */
 
+/**
+ * @brief Place a kernel hot path function in the configured section.
+ * @details
+ * Used on the definitions of the functions executed on each
+ * context switch and tick; with `OS_STRING_RTOS_HOT_SECTION`
+ * undefined it expands to nothing and the functions stay in `.text`.
+ */
+#if defined(OS_STRING_RTOS_HOT_SECTION)
+#define OS_RTOS_HOT __attribute__((section (OS_STRING_RTOS_HOT_SECTION)))
+#else
+#define OS_RTOS_HOT
+#endif
+
 // ----------------------------------------------------------------------------
 
 // Default definitions for various configuration macros.
@@ -1152,6 +1643,220 @@ extern "C"
 #define OS_BOOL_RTOS_SCHEDULER_PREEMPTIVE                   (true)
 #endif
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_PROFILE) \
+  && !(defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CONTEXT_SWITCHES) \
+      && defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES))
+#error "OS_INCLUDE_RTOS_STATISTICS_THREAD_PROFILE requires both thread statistics."
+#endif
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_EVENTS) \
+  && !defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES)
+#error "OS_INCLUDE_RTOS_STATISTICS_THREAD_EVENTS requires OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES."
+#endif
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_EVENTS) \
+  && defined(OS_USE_RTOS_PORT_SCHEDULER)
+#error "OS_INCLUDE_RTOS_STATISTICS_THREAD_EVENTS requires the native scheduler."
+#endif
+
+#if defined(OS_INCLUDE_RTOS_THREAD_BUDGET) \
+  && !defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES)
+#error "OS_INCLUDE_RTOS_THREAD_BUDGET requires OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES."
+#endif
+
+#if defined(OS_INCLUDE_RTOS_THREAD_BUDGET) \
+  && defined(OS_USE_RTOS_PORT_SCHEDULER)
+#error "OS_INCLUDE_RTOS_THREAD_BUDGET requires the native scheduler."
+#endif
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_CPU_LOAD) \
+  && !defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES)
+#error "OS_INCLUDE_RTOS_STATISTICS_CPU_LOAD requires OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES."
+#endif
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_CPU_LOAD) \
+  && defined(OS_USE_RTOS_PORT_SCHEDULER)
+#error "OS_INCLUDE_RTOS_STATISTICS_CPU_LOAD requires the native scheduler."
+#endif
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_STACK_SITES) \
+  && !defined(OS_INCLUDE_RTOS_THREAD_STACK_SCAN)
+#error "OS_INCLUDE_RTOS_STATISTICS_STACK_SITES requires OS_INCLUDE_RTOS_THREAD_STACK_SCAN."
+#endif
+
+#if defined(OS_INCLUDE_RTOS_DVFS) \
+  && !(defined(OS_INCLUDE_RTOS_STATISTICS_CPU_LOAD) \
+      && defined(OS_USE_RTOS_CLOCK_RETIMING))
+#error "OS_INCLUDE_RTOS_DVFS requires the CPU load and the clock re-timing."
+#endif
+
+#if defined(OS_INCLUDE_RTOS_ZERO_LATENCY_INTERRUPTS) \
+  && !defined(OS_INTEGER_RTOS_CRITICAL_SECTION_INTERRUPT_PRIORITY)
+#error "OS_INCLUDE_RTOS_ZERO_LATENCY_INTERRUPTS requires OS_INTEGER_RTOS_CRITICAL_SECTION_INTERRUPT_PRIORITY."
+#endif
+
+#if defined(OS_INCLUDE_RTOS_ISR_RESCHEDULE_COALESCING) \
+  && defined(OS_USE_RTOS_PORT_SCHEDULER)
+#error "OS_INCLUDE_RTOS_ISR_RESCHEDULE_COALESCING requires the native scheduler."
+#endif
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF) \
+  && defined(OS_USE_RTOS_PORT_SCHEDULER)
+#error "OS_INCLUDE_RTOS_SCHEDULER_EDF requires the native scheduler."
+#endif
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING) \
+  && defined(OS_USE_RTOS_PORT_SCHEDULER)
+#error "OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING requires the native scheduler."
+#endif
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_PREEMPTION_THRESHOLD) \
+  && defined(OS_USE_RTOS_PORT_SCHEDULER)
+#error "OS_INCLUDE_RTOS_SCHEDULER_PREEMPTION_THRESHOLD requires the native scheduler."
+#endif
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_HANDOFF) \
+  && defined(OS_USE_RTOS_PORT_SCHEDULER)
+#error "OS_INCLUDE_RTOS_SCHEDULER_HANDOFF requires the native scheduler."
+#endif
+
+#if defined(OS_USE_RTOS_SCHEDULER_LOCK_NESTING) \
+  && (defined(OS_USE_RTOS_PORT_SCHEDULER) || defined(OS_INCLUDE_RTOS_SMP))
+#error "OS_USE_RTOS_SCHEDULER_LOCK_NESTING requires the native single core scheduler."
+#endif
+
+#if defined(OS_INCLUDE_RTOS_THREAD_REAPER) \
+  && defined(OS_USE_RTOS_PORT_SCHEDULER)
+#error "OS_INCLUDE_RTOS_THREAD_REAPER requires the native scheduler."
+#endif
+
+#if defined(OS_INCLUDE_RTOS_THREAD_NEWLIB_REENT) \
+  && (defined(OS_USE_RTOS_PORT_SCHEDULER) || defined(OS_INCLUDE_RTOS_SMP))
+#error "OS_INCLUDE_RTOS_THREAD_NEWLIB_REENT requires the native single core scheduler."
+#endif
+
+#if defined(OS_INCLUDE_RTOS_THREAD_LOCAL_SLOTS) \
+  && (defined(OS_USE_RTOS_PORT_SCHEDULER) || defined(OS_INCLUDE_RTOS_SMP))
+#error "OS_INCLUDE_RTOS_THREAD_LOCAL_SLOTS requires the native single core scheduler."
+#endif
+
+#if !defined(OS_INTEGER_RTOS_TICKLESS_IDLE_MIN_TICKS)
+#define OS_INTEGER_RTOS_TICKLESS_IDLE_MIN_TICKS             (2)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_MUTEX_INHERIT_MAX_DEPTH)
+#define OS_INTEGER_RTOS_MUTEX_INHERIT_MAX_DEPTH             (8)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_WAIT_ADDRESS_BUCKETS)
+#define OS_INTEGER_RTOS_WAIT_ADDRESS_BUCKETS                (8)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_DEFERRED_QUEUE_SIZE)
+#define OS_INTEGER_RTOS_DEFERRED_QUEUE_SIZE                 (16)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_DEFERRED_STACK_SIZE_BYTES)
+#define OS_INTEGER_RTOS_DEFERRED_STACK_SIZE_BYTES           (os::rtos::port::stack::default_size_bytes)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_DEFERRED_PRIORITY)
+#define OS_INTEGER_RTOS_DEFERRED_PRIORITY                   (os::rtos::thread::priority::high)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_CALLOUTS_SIZE)
+#define OS_INTEGER_RTOS_CALLOUTS_SIZE                       (8)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_SMP_CORES)
+#define OS_INTEGER_RTOS_SMP_CORES                           (2)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_SMP_BALANCE_PERIOD_TICKS)
+#define OS_INTEGER_RTOS_SMP_BALANCE_PERIOD_TICKS            (100)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_TIMER_DAEMON_STACK_SIZE_BYTES)
+#define OS_INTEGER_RTOS_TIMER_DAEMON_STACK_SIZE_BYTES       (os::rtos::port::stack::default_size_bytes)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_TIMER_DAEMON_PRIORITY)
+#define OS_INTEGER_RTOS_TIMER_DAEMON_PRIORITY               (os::rtos::thread::priority::above_normal)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_SCHEDULER_EDF_PRIORITY)
+#define OS_INTEGER_RTOS_SCHEDULER_EDF_PRIORITY              (os::rtos::thread::priority::high)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_THREAD_STACK_SCAN_WORDS)
+#define OS_INTEGER_RTOS_THREAD_STACK_SCAN_WORDS             (16)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_THREAD_NEWLIB_REENT_POOL_SIZE)
+#define OS_INTEGER_RTOS_THREAD_NEWLIB_REENT_POOL_SIZE       (4)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_THREAD_LOCAL_SLOTS)
+#define OS_INTEGER_RTOS_THREAD_LOCAL_SLOTS                  (4)
+#endif
+
+#if (OS_INTEGER_RTOS_THREAD_LOCAL_SLOTS < 1) \
+  || (OS_INTEGER_RTOS_THREAD_LOCAL_SLOTS > 32)
+#error "OS_INTEGER_RTOS_THREAD_LOCAL_SLOTS must be between 1 and 32."
+#endif
+
+#if !defined(OS_INTEGER_RTOS_THREAD_STACK_WARNING_PERCENT)
+#define OS_INTEGER_RTOS_THREAD_STACK_WARNING_PERCENT        (10)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_IDLE_ZERO_FREE_BYTES)
+#define OS_INTEGER_RTOS_IDLE_ZERO_FREE_BYTES                (256)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_MEMORY_PROFILER_SITES)
+#define OS_INTEGER_RTOS_MEMORY_PROFILER_SITES               (64)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_MEMORY_PROFILER_BLOCKS)
+#define OS_INTEGER_RTOS_MEMORY_PROFILER_BLOCKS              (64)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_MEMORY_PROFILER_SAMPLE_RATE)
+#define OS_INTEGER_RTOS_MEMORY_PROFILER_SAMPLE_RATE         (16)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_PROFILER_SAMPLES)
+#define OS_INTEGER_RTOS_PROFILER_SAMPLES                    (256)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_OBJECT_REGISTRY_SIZE)
+#define OS_INTEGER_RTOS_OBJECT_REGISTRY_SIZE                (64)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_SCHEDULER_QUANTUM_TICKS)
+#define OS_INTEGER_RTOS_SCHEDULER_QUANTUM_TICKS             (10)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_STATISTICS_STACK_SITES)
+#define OS_INTEGER_RTOS_STATISTICS_STACK_SITES              (16)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_STATISTICS_STACK_MARGIN_PERCENT)
+#define OS_INTEGER_RTOS_STATISTICS_STACK_MARGIN_PERCENT     (25)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_STATISTICS_CRITICAL_SITES)
+#define OS_INTEGER_RTOS_STATISTICS_CRITICAL_SITES           (16)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_THREAD_REAPER_STACK_SIZE_BYTES)
+#define OS_INTEGER_RTOS_THREAD_REAPER_STACK_SIZE_BYTES      (os::rtos::port::stack::default_size_bytes)
+#endif
+
+#if !defined(OS_INTEGER_RTOS_THREAD_REAPER_PRIORITY)
+#define OS_INTEGER_RTOS_THREAD_REAPER_PRIORITY              (os::rtos::thread::priority::low)
+#endif
+
 // ----------------------------------------------------------------------------
 
 #endif /* CMSIS_PLUS_RTOS_OS_DECLS_H_ */
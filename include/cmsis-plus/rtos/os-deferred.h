@@ -0,0 +1,177 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_RTOS_OS_DEFERRED_H_
+#define CMSIS_PLUS_RTOS_OS_DEFERRED_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#include <cmsis-plus/rtos/os-decls.h>
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_INCLUDE_RTOS_DEFERRED)
+
+namespace os
+{
+  namespace rtos
+  {
+    /**
+     * @brief Deferred procedure calls.
+     * @ingroup cmsis-plus-rtos-core
+     * @details
+     * Interrupt handlers post a function and its argument, which
+     * are later executed, in the order they were posted, by a
+     * dedicated worker thread (the interrupts _bottom half_).
+     */
+    namespace deferred
+    {
+      /**
+       * @brief Type of deferred functions.
+       * @param [in] args Pointer to the argument passed to `post()`.
+       */
+      using func_t = void (*) (void* args);
+
+      /**
+       * @brief Deferred calls statistics.
+       * @details
+       * The latencies are measured with the high resolution clock,
+       * from `post()` to the moment the function is called.
+       */
+      struct statistics_t
+      {
+        /**
+         * @brief Number of calls posted.
+         */
+        uint32_t posted;
+
+        /**
+         * @brief Number of calls executed.
+         */
+        uint32_t executed;
+
+        /**
+         * @brief Number of calls rejected because the queue was full.
+         */
+        uint32_t overflows;
+
+        /**
+         * @brief Number of times the worker drained the queue.
+         */
+        uint32_t batches;
+
+        /**
+         * @brief Maximum number of calls pending in the queue.
+         */
+        uint32_t max_depth;
+
+        /**
+         * @brief Maximum number of calls executed in one batch.
+         */
+        uint32_t max_batch;
+
+        /**
+         * @brief Maximum latency, in high resolution clock cycles.
+         */
+        uint32_t max_latency;
+
+        /**
+         * @brief Sum of all latencies, in high resolution clock cycles.
+         */
+        uint64_t total_latency;
+      };
+
+      /**
+       * @brief Post a function to be called by the worker thread.
+       * @param [in] func Pointer to function.
+       * @param [in] args Pointer to function argument.
+       * @retval result::ok The call was queued.
+       * @retval EINVAL The function pointer is `nullptr`.
+       * @retval EWOULDBLOCK The queue is full.
+       */
+      result_t
+      post (func_t func, void* args = nullptr);
+
+      /**
+       * @brief Get the number of pending calls.
+       * @par Parameters
+       *  None.
+       * @return The number of calls posted and not yet started.
+       */
+      std::size_t
+      depth (void);
+
+      /**
+       * @brief Get the queue capacity.
+       * @par Parameters
+       *  None.
+       * @return The max number of pending calls.
+       */
+      std::size_t
+      capacity (void);
+
+      /**
+       * @brief Get the worker thread.
+       * @par Parameters
+       *  None.
+       * @return Pointer to thread, or `nullptr` before it is created.
+       */
+      thread*
+      worker (void);
+
+      /**
+       * @brief Copy the statistics.
+       * @param [out] stats Pointer to the destination structure.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      statistics (statistics_t* stats);
+
+      /**
+       * @brief Clear the statistics.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      clear_statistics (void);
+
+    } /* namespace deferred */
+  } /* namespace rtos */
+} /* namespace os */
+
+#endif /* defined(OS_INCLUDE_RTOS_DEFERRED) */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_RTOS_OS_DEFERRED_H_ */
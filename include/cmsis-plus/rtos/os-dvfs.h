@@ -0,0 +1,366 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_RTOS_OS_DVFS_H_
+#define CMSIS_PLUS_RTOS_OS_DVFS_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#if defined(OS_INCLUDE_RTOS_DVFS)
+
+#include <cmsis-plus/rtos/os-decls.h>
+
+#include <cstddef>
+#include <cstdint>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    /**
+     * @brief Dynamic voltage and frequency scaling.
+     * @ingroup cmsis-plus-rtos
+     * @details
+     * The application defines a table of operating points, in
+     * increasing frequency order, and a governor; on each CPU load
+     * sample, every 100 ms, the governor selects the operating
+     * point from the load, the number of ready threads and the
+     * missed EDF deadlines.
+     *
+     * The frequency is changed by
+     * `os_rtos_dvfs_set_frequency_hook()`, and the high resolution
+     * clock is re-timed right after it, so the pending time stamps
+     * expire after the same time in seconds.
+     *
+     * The higher frequencies are set at once, from the system tick;
+     * the lower ones are set by the idle thread, when there is
+     * nothing else to do.
+     */
+    namespace dvfs
+    {
+      /**
+       * @brief The load figures passed to the governor.
+       */
+      typedef struct sample_s
+      {
+        /**
+         * @brief The CPU load of the last 100 ms, in per mille.
+         */
+        uint32_t load;
+
+        /**
+         * @brief The CPU load averaged over 1 s, in per mille.
+         */
+        uint32_t load_1s;
+
+        /**
+         * @brief The number of ready threads, when sampled.
+         */
+        std::size_t ready;
+
+        /**
+         * @brief The deadlines missed since the previous sample,
+         *  always 0 without EDF.
+         */
+        uint32_t deadline_misses;
+
+      } sample_t;
+
+      // ======================================================================
+
+      /**
+       * @brief Frequency selection policy.
+       * @headerfile os-dvfs.h <cmsis-plus/rtos/os-dvfs.h>
+       */
+      class governor
+      {
+      public:
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        governor () = default;
+
+        /**
+         * @cond ignore
+         */
+
+        governor (const governor&) = delete;
+        governor (governor&&) = delete;
+        governor&
+        operator= (const governor&) = delete;
+        governor&
+        operator= (governor&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        virtual
+        ~governor () = default;
+
+        /**
+         * @}
+         */
+
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+        /**
+         * @brief Select the operating point.
+         * @param [in] s The load figures.
+         * @param [in] level The current operating point.
+         * @param [in] levels The number of operating points.
+         * @return The new operating point, less than `levels`.
+         * @note Called from the system tick interrupt; must be short.
+         */
+        virtual std::size_t
+        select (const sample_t& s, std::size_t level, std::size_t levels) = 0;
+
+        /**
+         * @}
+         */
+      };
+
+      // ======================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+      /**
+       * @brief Governor raising the frequency at once, and lowering
+       *  it step by step.
+       * @headerfile os-dvfs.h <cmsis-plus/rtos/os-dvfs.h>
+       * @details
+       * The highest operating point is selected when the load of
+       * the last sample reaches the upper threshold, when more
+       * threads are ready than the limit, or when a deadline was
+       * missed; the operating point is lowered by one step after
+       * the 1 s load stayed below the lower threshold for
+       * a number of samples.
+       */
+      class ondemand_governor : public governor
+      {
+      public:
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct an on demand governor.
+         * @param [in] up_load Upper load threshold, in per mille.
+         * @param [in] down_load Lower load threshold, in per mille.
+         * @param [in] max_ready Max number of ready threads at the
+         *  lower operating points.
+         * @param [in] hold_samples Number of samples with a low load
+         *  before each step down.
+         */
+        ondemand_governor (uint32_t up_load = 800, uint32_t down_load = 300,
+                           std::size_t max_ready = 2,
+                           uint32_t hold_samples = 10);
+
+        /**
+         * @cond ignore
+         */
+
+        ondemand_governor (const ondemand_governor&) = delete;
+        ondemand_governor (ondemand_governor&&) = delete;
+        ondemand_governor&
+        operator= (const ondemand_governor&) = delete;
+        ondemand_governor&
+        operator= (ondemand_governor&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        virtual
+        ~ondemand_governor () override = default;
+
+        /**
+         * @}
+         */
+
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+        virtual std::size_t
+        select (const sample_t& s, std::size_t level, std::size_t levels)
+            override;
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        uint32_t up_load_;
+        uint32_t down_load_;
+        std::size_t max_ready_;
+        uint32_t hold_samples_;
+        uint32_t low_samples_ = 0;
+
+        /**
+         * @endcond
+         */
+      };
+
+#pragma GCC diagnostic pop
+
+      // ======================================================================
+
+      /**
+       * @brief Start scaling the frequency.
+       * @param [in] frequencies_hz Array of core frequencies,
+       *  in increasing order.
+       * @param [in] levels Number of operating points.
+       * @param [in] gov Reference to the governor.
+       * @param [in] initial The current operating point.
+       * @retval result::ok The governor was installed.
+       * @retval EINVAL The table is empty or the initial operating
+       *  point is out of range.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @note The table must remain valid until `stop()`.
+       */
+      result_t
+      start (const uint32_t* frequencies_hz, std::size_t levels,
+             governor& gov, std::size_t initial);
+
+      /**
+       * @brief Stop scaling the frequency.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       * @details
+       * The current operating point is kept.
+       */
+      void
+      stop (void);
+
+      /**
+       * @brief Get the current operating point.
+       * @par Parameters
+       *  None.
+       * @return The index in the frequencies table.
+       */
+      std::size_t
+      level (void);
+
+      /**
+       * @brief Set the operating point.
+       * @param [in] lvl The index in the frequencies table.
+       * @retval result::ok The frequency was changed.
+       * @retval EINVAL The operating point is out of range.
+       * @retval EAGAIN The frequency scaling is not started.
+       * @retval EIO The hook did not change the frequency.
+       * @details
+       * The governor may select another one on the next sample.
+       */
+      result_t
+      level (std::size_t lvl);
+
+      /**
+       * @brief Get the current core frequency.
+       * @par Parameters
+       *  None.
+       * @return The frequency in Hz, or 0 if not started.
+       */
+      uint32_t
+      frequency (void);
+
+      /**
+       * @cond ignore
+       */
+
+      void
+      internal_sample_ (void);
+
+      void
+      internal_idle_ (void);
+
+      /**
+       * @endcond
+       */
+
+    } /* namespace dvfs */
+  } /* namespace rtos */
+} /* namespace os */
+
+extern "C"
+{
+  /**
+   * @addtogroup cmsis-plus-app-hooks
+   * @{
+   */
+
+  /**
+   * @brief Change the core frequency.
+   * @param [in] level The operating point.
+   * @param [in] frequency_hz The core frequency.
+   * @return The new frequency of the SysTick input clock,
+   *  or 0 if the frequency was not changed.
+   * @details
+   * Called with interrupts disabled; it must set the voltage and
+   * the clock tree, usually the voltage first when going up and
+   * the clock first when going down.
+   *
+   * Weak, returns 0 by default.
+   */
+  uint32_t
+  os_rtos_dvfs_set_frequency_hook (std::size_t level, uint32_t frequency_hz);
+
+  /**
+   * @}
+   */
+}
+
+// ----------------------------------------------------------------------------
+
+#endif /* defined(OS_INCLUDE_RTOS_DVFS) */
+
+#endif /* __cplusplus */
+
+// ----------------------------------------------------------------------------
+
+#endif /* CMSIS_PLUS_RTOS_OS_DVFS_H_ */
@@ -0,0 +1,604 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_RTOS_OS_EVENT_LOOP_H_
+#define CMSIS_PLUS_RTOS_OS_EVENT_LOOP_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#include <cmsis-plus/rtos/os.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Single thread running small **callbacks**.
+     * @headerfile os-event-loop.h <cmsis-plus/rtos/os-event-loop.h>
+     * @ingroup cmsis-plus-rtos-thread
+     *
+     * @details
+     * Type independent part of `event_loop_inclusive`. One thread
+     * runs the functions posted from threads or interrupts,
+     * the expired timers and, with a `poller`, the callbacks
+     * of the ready descriptors; the callbacks must not block.
+     */
+    class event_loop : public internal::object_named_system
+    {
+    public:
+
+      /**
+       * @brief Type of callback functions.
+       * @param [in] args Pointer to callback arguments.
+       * @par Returns
+       *  Nothing.
+       */
+      using func_t = void (*) (void* args);
+
+      /**
+       * @brief Do not time out.
+       */
+      static constexpr clock::duration_t forever =
+          static_cast<clock::duration_t> (-1);
+
+      // ======================================================================
+
+      /**
+       * @brief Source of events waited by the loop when idle.
+       * @headerfile os-event-loop.h <cmsis-plus/rtos/os-event-loop.h>
+       *
+       * @details
+       * For example `posix::event_loop_poller`, which runs the
+       * callbacks of the ready descriptors.
+       */
+      class poller
+      {
+      public:
+
+        /**
+         * @cond ignore
+         */
+
+        poller () = default;
+
+        // The rule of five.
+        poller (const poller&) = delete;
+        poller (poller&&) = delete;
+        poller&
+        operator= (const poller&) = delete;
+        poller&
+        operator= (poller&&) = delete;
+
+        virtual
+        ~poller () = default;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Wait for events and run their callbacks.
+         * @param [in] timeout Timeout in system clock ticks;
+         *  `forever` does not time out.
+         * @par Returns
+         *  Nothing.
+         *
+         * @details
+         * Called by the loop thread; it must also return
+         * after `wakeup()`, even if called before the wait.
+         */
+        virtual void
+        wait (clock::duration_t timeout) = 0;
+
+        /**
+         * @brief Make the current or the next `wait()` return.
+         * @par Parameters
+         *  None.
+         * @par Returns
+         *  Nothing.
+         *
+         * @note Must be callable from Interrupt Service Routines.
+         */
+        virtual void
+        wakeup (void) = 0;
+      };
+
+      // ======================================================================
+
+      /**
+       * @brief Timer run by the loop thread.
+       * @headerfile os-event-loop.h <cmsis-plus/rtos/os-event-loop.h>
+       *
+       * @details
+       * Owned by the caller, it must be stopped before destruction.
+       */
+      class timer
+      {
+      public:
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a timer object instance.
+         * @param [in] func Pointer to the function to call.
+         * @param [in] args Pointer to the function arguments.
+         */
+        timer (func_t func, void* args = nullptr);
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        timer (const timer&) = delete;
+        timer (timer&&) = delete;
+        timer&
+        operator= (const timer&) = delete;
+        timer&
+        operator= (timer&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the timer object instance.
+         */
+        ~timer () = default;
+
+        /**
+         * @}
+         */
+
+      public:
+
+        /**
+         * @brief Check if the timer is started.
+         * @par Parameters
+         *  None.
+         * @retval true The timer is in the loop heap.
+         * @retval false The timer is stopped, or a one-shot timer expired.
+         */
+        bool
+        active (void) const;
+
+      protected:
+
+        friend class event_loop;
+
+        /**
+         * @cond ignore
+         */
+
+        static constexpr std::size_t not_queued = static_cast<std::size_t> (-1);
+
+        func_t func_;
+        void* args_;
+
+        clock::timestamp_t deadline_ = 0;
+        clock::duration_t period_ = 0;
+
+        // The position in the loop heap.
+        std::size_t index_ = not_queued;
+
+        /**
+         * @endcond
+         */
+      };
+
+      // ======================================================================
+
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      // Bounded multi-producer queue, as for the deferred calls.
+      struct cell_t
+      {
+        std::size_t seq;
+        func_t func;
+        void* args;
+      };
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+      /**
+       * @brief Construct an event loop object instance.
+       * @param [in] name Pointer to name.
+       */
+      event_loop (const char* name);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      event_loop (const event_loop&) = delete;
+      event_loop (event_loop&&) = delete;
+      event_loop&
+      operator= (const event_loop&) = delete;
+      event_loop&
+      operator= (event_loop&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @brief Destruct the event loop object instance.
+       */
+      ~event_loop () = default;
+
+      /**
+       * @}
+       */
+
+    public:
+
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+      /**
+       * @brief Post a function to be called by the loop thread.
+       * @param [in] func Pointer to function.
+       * @param [in] args Pointer to function argument.
+       * @retval result::ok The call was queued.
+       * @retval EINVAL The function pointer is `nullptr`.
+       * @retval EWOULDBLOCK The queue is full.
+       */
+      result_t
+      post (func_t func, void* args = nullptr);
+
+      /**
+       * @brief Start or restart a timer.
+       * @param [in] t Reference to timer.
+       * @param [in] delay The first expiration, in system clock ticks.
+       * @param [in] period The period, in system clock ticks;
+       *  0 for one-shot timers.
+       * @retval result::ok The timer was started.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval ENOMEM The timer heap is full.
+       */
+      result_t
+      start (timer& t, clock::duration_t delay, clock::duration_t period = 0);
+
+      /**
+       * @brief Stop a timer.
+       * @param [in] t Reference to timer.
+       * @retval result::ok The timer was stopped.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EAGAIN The timer was not started.
+       */
+      result_t
+      stop (timer& t);
+
+      /**
+       * @brief Get the number of pending calls.
+       * @par Parameters
+       *  None.
+       * @return The number of calls posted and not yet started.
+       */
+      std::size_t
+      depth (void) const;
+
+      /**
+       * @brief Get the queue capacity.
+       * @par Parameters
+       *  None.
+       * @return The max number of pending calls.
+       */
+      std::size_t
+      capacity (void) const;
+
+      /**
+       * @brief Get the loop thread.
+       * @par Parameters
+       *  None.
+       * @return Pointer to thread.
+       */
+      thread*
+      worker (void) const;
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @name Private Member Functions
+       * @{
+       */
+
+      /**
+       * @cond ignore
+       */
+
+      void
+      internal_construct_ (cell_t* cells, std::size_t cells_count,
+                           timer** heap, std::size_t heap_size, poller* p,
+                           void* stack, std::size_t stack_size_bytes,
+                           thread::priority_t prio);
+
+      void
+      internal_destruct_ (void);
+
+      static void*
+      internal_run_ (void* args);
+
+      std::size_t
+      internal_drain_ (void);
+
+      bool
+      internal_queue_ready_ (void);
+
+      void
+      internal_wakeup_ (void);
+
+      bool
+      internal_fire_timer_ (clock::timestamp_t now);
+
+      // The heap functions must be called with the scheduler locked.
+      void
+      internal_heap_insert_ (timer* t);
+
+      void
+      internal_heap_remove_ (timer* t);
+
+      void
+      internal_heap_place_ (timer* t, std::size_t index);
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @name Private Member Variables
+       * @{
+       */
+
+      /**
+       * @cond ignore
+       */
+
+      cell_t* cells_ = nullptr;
+      std::size_t mask_ = 0;
+
+      // Written by producers (with CAS) and by the loop, respectively.
+      std::size_t enqueue_pos_ = 0;
+      std::size_t dequeue_pos_ = 0;
+
+      // Min-heap of the started timers, by deadline.
+      timer** heap_ = nullptr;
+      std::size_t heap_size_ = 0;
+      std::size_t heap_count_ = 0;
+
+      poller* poller_ = nullptr;
+
+      alignas(thread) char thread_storage_[sizeof(thread)];
+      thread* thread_ = nullptr;
+
+      // Set by the loop before the last check and waiting.
+      bool waiting_ = false;
+      bool volatile stopping_ = false;
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @}
+       */
+    };
+
+    // ========================================================================
+
+    /**
+     * @brief Event loop with the queue, the timers and the stack included.
+     * @headerfile os-event-loop.h <cmsis-plus/rtos/os-event-loop.h>
+     * @ingroup cmsis-plus-rtos-thread
+     * @tparam Q Number of calls that can be posted (a power of 2).
+     * @tparam T Number of timers that can be started.
+     * @tparam S Size of the loop thread stack, in bytes.
+     *
+     * @details
+     * The loop thread is created by the constructor and is
+     * joined by the destructor; nothing is allocated from the heap.
+     */
+    template<std::size_t Q, std::size_t T,
+        std::size_t S = port::stack::default_size_bytes>
+      class event_loop_inclusive : public event_loop
+      {
+      public:
+
+        static_assert((Q >= 2) && ((Q & (Q - 1)) == 0),
+            "event_loop_inclusive<Q, T, S>: Q must be a power of 2");
+        static_assert(T >= 1, "event_loop_inclusive<Q, T, S>: T must be >= 1");
+
+        /**
+         * @brief Local constant based on template definition.
+         */
+        static const std::size_t stack_size_bytes = S;
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct an event loop object instance.
+         * @param [in] name Pointer to name.
+         * @param [in] p Pointer to poller; may be `nullptr`.
+         * @param [in] prio The priority of the loop thread.
+         */
+        event_loop_inclusive (const char* name = nullptr, poller* p = nullptr,
+                              thread::priority_t prio =
+                                  thread::priority::normal);
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        event_loop_inclusive (const event_loop_inclusive&) = delete;
+        event_loop_inclusive (event_loop_inclusive&&) = delete;
+        event_loop_inclusive&
+        operator= (const event_loop_inclusive&) = delete;
+        event_loop_inclusive&
+        operator= (event_loop_inclusive&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the event loop object instance.
+         */
+        ~event_loop_inclusive ();
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        cell_t cells_storage_[Q];
+
+        timer* heap_storage_[T];
+
+        thread::stack::allocation_element_t stack_[(stack_size_bytes
+            + sizeof(thread::stack::allocation_element_t) - 1)
+            / sizeof(thread::stack::allocation_element_t)];
+
+        /**
+         * @endcond
+         */
+      };
+
+#pragma GCC diagnostic pop
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace rtos
+  {
+
+    inline bool
+    event_loop::timer::active (void) const
+    {
+      return index_ != not_queued;
+    }
+
+    inline std::size_t
+    event_loop::depth (void) const
+    {
+      return __atomic_load_n (&enqueue_pos_, __ATOMIC_ACQUIRE)
+          - __atomic_load_n (&dequeue_pos_, __ATOMIC_ACQUIRE);
+    }
+
+    inline std::size_t
+    event_loop::capacity (void) const
+    {
+      return mask_ + 1;
+    }
+
+    inline thread*
+    event_loop::worker (void) const
+    {
+      return thread_;
+    }
+
+    // ========================================================================
+
+    template<std::size_t Q, std::size_t T, std::size_t S>
+      event_loop_inclusive<Q, T, S>::event_loop_inclusive (
+          const char* name, poller* p, thread::priority_t prio) :
+          event_loop
+            { name }
+      {
+        internal_construct_ (&cells_storage_[0], Q, &heap_storage_[0], T, p,
+                             &stack_[0], sizeof(stack_), prio);
+      }
+
+    /**
+     * @details
+     * The loop thread is stopped and joined here, before the
+     * members it uses are destroyed; the calls still queued are
+     * not executed.
+     */
+    template<std::size_t Q, std::size_t T, std::size_t S>
+      event_loop_inclusive<Q, T, S>::~event_loop_inclusive ()
+      {
+        internal_destruct_ ();
+      }
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_RTOS_OS_EVENT_LOOP_H_ */
@@ -244,6 +244,28 @@ namespace os
                   flags::mask_t* oflags = nullptr,
                   flags::mode_t mode = flags::mode::all | flags::mode::clear);
 
+      /**
+       * @brief Wait for event flags until an absolute time.
+       * @param [in] mask The expected flags (OR-ed bit-mask);
+       *  if `flags::any`, any flag raised will do it.
+       * @param [in] timestamp The deadline, in steady clock units.
+       * @param [out] oflags Pointer where to store the current flags;
+       *  may be `nullptr`.
+       * @param [in] mode Mode bits to select if either all or any flags
+       *  in the mask are expected, and if the flags should be cleared.
+       * @retval result::ok All expected flags are raised.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval ETIMEDOUT The expected condition did not occur before
+       *  the deadline.
+       * @retval EINVAL The mask is outside of the permitted range.
+       * @retval EINTR The operation was interrupted.
+       */
+      result_t
+      timed_wait_until (flags::mask_t mask, clock::timestamp_t timestamp,
+                        flags::mask_t* oflags = nullptr,
+                        flags::mode_t mode = flags::mode::all
+                            | flags::mode::clear);
+
       /**
        * @brief Raise event flags.
        * @param [in] mask The OR-ed flags to raise.
@@ -304,9 +326,20 @@ namespace os
 
 #if !defined(OS_USE_RTOS_PORT_EVENT_FLAGS)
       internal::waiting_threads_list list_;
+#if defined(OS_INCLUDE_RTOS_EVENT_FLAGS_MASKED_WAKEUP)
+      // The threads of wait(), which remember their masks; list_
+      // keeps the wait sets and the coroutine awaiters.
+      internal::waiting_threads_list masked_list_;
+#endif /* defined(OS_INCLUDE_RTOS_EVENT_FLAGS_MASKED_WAKEUP) */
       clock* clock_;
 #endif
 
+#if !defined(OS_USE_RTOS_PORT_EVENT_FLAGS)
+      // Links its nodes to the waiting lists.
+      friend class wait_set;
+      friend class co::awaiter;
+#endif
+
 #if defined(OS_USE_RTOS_PORT_EVENT_FLAGS)
       friend class port::event_flags;
       os_evflags_port_data_t port_;
@@ -0,0 +1,606 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_RTOS_OS_EXECUTOR_H_
+#define CMSIS_PLUS_RTOS_OS_EXECUTOR_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/memory/block-pool.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Pool of worker threads running **jobs**.
+     * @headerfile os-executor.h <cmsis-plus/rtos/os-executor.h>
+     * @ingroup cmsis-plus-rtos-thread
+     *
+     * @details
+     * Type independent part of `executor_inclusive`, with the
+     * per-worker deques and the scheduling logic.
+     */
+    class executor : public internal::object_named_system
+    {
+    public:
+
+      /**
+       * @brief Type of job functions.
+       * @param [in] args Pointer to job arguments.
+       * @par Returns
+       *  Nothing.
+       */
+      using func_t = void (*) (void* args);
+
+      /**
+       * @brief Type of `parallel_for()` functions.
+       * @param [in] index The index in the range.
+       * @param [in] args Pointer to function arguments.
+       * @par Returns
+       *  Nothing.
+       */
+      using index_func_t = void (*) (std::size_t index, void* args);
+
+      // ======================================================================
+
+      /**
+       * @brief Handle to wait for the completion of a job.
+       * @headerfile os-executor.h <cmsis-plus/rtos/os-executor.h>
+       *
+       * @details
+       * Similar to a `std::future<void>`; it is owned by the caller
+       * and must live until the job is completed.
+       */
+      class handle
+      {
+      public:
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a handle object instance.
+         * @par Parameters
+         *  None.
+         */
+        handle ();
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        handle (const handle&) = delete;
+        handle (handle&&) = delete;
+        handle&
+        operator= (const handle&) = delete;
+        handle&
+        operator= (handle&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the handle object instance.
+         */
+        ~handle () = default;
+
+        /**
+         * @}
+         */
+
+      public:
+
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+        /**
+         * @brief Check if the handle refers to a submitted job.
+         * @par Parameters
+         *  None.
+         * @retval true A job was submitted with this handle.
+         * @retval false The handle was not used.
+         */
+        bool
+        valid (void) const;
+
+        /**
+         * @brief Check if the job was completed.
+         * @par Parameters
+         *  None.
+         * @retval true The job was completed.
+         * @retval false The job was not completed.
+         */
+        bool
+        ready (void) const;
+
+        /**
+         * @brief Wait for the job to complete.
+         * @par Parameters
+         *  None.
+         * @retval result::ok The job was completed.
+         * @retval EINVAL The handle was not used.
+         * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+         * @retval EINTR The operation was interrupted.
+         */
+        result_t
+        wait (void);
+
+        /**
+         * @brief Timed wait for the job to complete.
+         * @param [in] timeout Timeout to wait, in system clock ticks.
+         * @retval result::ok The job was completed.
+         * @retval EINVAL The handle was not used.
+         * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+         * @retval EINTR The operation was interrupted.
+         * @retval ETIMEDOUT The job was not completed in time.
+         */
+        result_t
+        timed_wait (clock::duration_t timeout);
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        friend class executor;
+
+        /**
+         * @cond ignore
+         */
+
+        semaphore_binary done_;
+        bool volatile valid_ = false;
+        bool volatile ready_ = false;
+
+        /**
+         * @endcond
+         */
+      };
+
+      // ======================================================================
+
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      typedef struct job_s
+      {
+        func_t func;
+        void* args;
+        handle* hnd;
+      } job_t;
+
+      typedef struct worker_s
+      {
+        executor* owner;
+        // Ring of jobs; the owner works at the bottom, thieves at the top.
+        job_t** deque;
+        std::size_t top;
+        std::size_t bottom;
+        thread* th;
+        alignas(thread) char thread_storage[sizeof(thread)];
+      } worker_t;
+
+      /**
+       * @endcond
+       */
+
+    public:
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+      /**
+       * @brief Construct an executor object instance.
+       * @param [in] name Pointer to name.
+       */
+      executor (const char* name);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      executor (const executor&) = delete;
+      executor (executor&&) = delete;
+      executor&
+      operator= (const executor&) = delete;
+      executor&
+      operator= (executor&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @brief Destruct the executor object instance.
+       */
+      ~executor ();
+
+      /**
+       * @}
+       */
+
+    public:
+
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+      /**
+       * @brief Submit a job.
+       * @param [in] func Pointer to job function.
+       * @param [in] args Pointer to job arguments.
+       * @param [in] hnd Optional pointer to a handle used to wait
+       *  for the job; may be `nullptr`.
+       * @retval result::ok The job was queued.
+       * @retval EINVAL The function pointer is `nullptr`.
+       * @retval ENOMEM There are no free jobs in the pool.
+       * @retval EAGAIN The executor is stopping.
+       */
+      result_t
+      submit (func_t func, void* args = nullptr, handle* hnd = nullptr);
+
+      /**
+       * @brief Run a function for each index, in parallel.
+       * @param [in] begin The first index.
+       * @param [in] end The index past the last one.
+       * @param [in] func Pointer to function.
+       * @param [in] args Pointer to function arguments.
+       * @param [in] grain The number of indices claimed at once.
+       * @retval result::ok All indices were processed.
+       * @retval EINVAL The function pointer is `nullptr`.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       */
+      result_t
+      parallel_for (std::size_t begin, std::size_t end, index_func_t func,
+                    void* args = nullptr, std::size_t grain = 1);
+
+      /**
+       * @brief Get the number of worker threads.
+       * @par Parameters
+       *  None.
+       * @return The number of workers.
+       */
+      std::size_t
+      workers (void) const;
+
+      /**
+       * @brief Get the number of queued jobs.
+       * @par Parameters
+       *  None.
+       * @return The number of jobs not yet started.
+       */
+      std::size_t
+      pending (void) const;
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @name Private Member Functions
+       * @{
+       */
+
+      /**
+       * @cond ignore
+       */
+
+      /**
+       * @brief Internal function used to create the workers.
+       * @param [in] workers Pointer to array of workers.
+       * @param [in] workers_count The number of workers.
+       * @param [in] deques Pointer to the deques storage.
+       * @param [in] pool Pointer to the pool of jobs.
+       * @param [in] jobs The number of jobs in the pool.
+       * @param [in] stacks Pointer to the stacks storage.
+       * @param [in] stack_size_bytes The size of each stack, in bytes.
+       * @param [in] prio The priority of the workers.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_construct_ (worker_t* workers, std::size_t workers_count,
+                           job_t** deques, os::memory::block_pool* pool,
+                           std::size_t jobs, void* stacks,
+                           std::size_t stack_size_bytes,
+                           thread::priority_t prio);
+
+      /**
+       * @brief Internal function used to stop the workers.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_destruct_ (void);
+
+      /**
+       * @brief Internal function used to get a job to run.
+       * @param [in] w Pointer to the current worker, or `nullptr`.
+       * @return Pointer to job or `nullptr`.
+       */
+      job_t*
+      internal_take_ (worker_t* w);
+
+      /**
+       * @brief Internal function used to run a job and free it.
+       * @param [in] job Pointer to job.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_run_ (job_t* job);
+
+      /**
+       * @brief Internal function used to find the current worker.
+       * @par Parameters
+       *  None.
+       * @return Pointer to worker or `nullptr`.
+       */
+      worker_t*
+      internal_current_worker_ (void);
+
+      /**
+       * @brief The worker threads function.
+       * @param [in] args Pointer to worker.
+       * @return Nothing.
+       */
+      static void*
+      internal_worker_ (void* args);
+
+      /**
+       * @brief The `parallel_for()` helper job function.
+       * @param [in] args Pointer to range.
+       * @par Returns
+       *  Nothing.
+       */
+      static void
+      internal_range_job_ (void* args);
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @name Private Member Variables
+       * @{
+       */
+
+      /**
+       * @cond ignore
+       */
+
+      worker_t* workers_ = nullptr;
+      std::size_t workers_count_ = 0;
+      std::size_t capacity_ = 0;
+
+      os::memory::block_pool* pool_ = nullptr;
+
+      // One count for each queued job, plus one for each worker
+      // when stopping.
+      semaphore_counting work_;
+
+      // Round-robin index for jobs submitted from outside the workers.
+      std::size_t next_ = 0;
+
+      bool volatile stopping_ = false;
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @}
+       */
+    };
+
+    // ========================================================================
+
+    /**
+     * @brief Executor with the workers and the jobs included.
+     * @headerfile os-executor.h <cmsis-plus/rtos/os-executor.h>
+     * @ingroup cmsis-plus-rtos-thread
+     * @tparam W Number of worker threads.
+     * @tparam J Number of jobs that can be queued.
+     * @tparam S Size of each worker stack, in bytes.
+     *
+     * @details
+     * The workers are created by the constructor and are
+     * joined by the destructor; the jobs are allocated from
+     * a block pool, so `submit()` never uses the heap.
+     */
+    template<std::size_t W, std::size_t J,
+        std::size_t S = port::stack::default_size_bytes>
+      class executor_inclusive : public executor
+      {
+      public:
+
+        static_assert(W >= 1, "executor_inclusive<W, J, S>: W must be >= 1");
+        static_assert(J >= 1, "executor_inclusive<W, J, S>: J must be >= 1");
+
+        /**
+         * @brief Local constant based on template definition.
+         */
+        static const std::size_t stack_size_bytes = S;
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct an executor object instance.
+         * @param [in] name Pointer to name.
+         * @param [in] prio The priority of the workers.
+         */
+        executor_inclusive (const char* name = nullptr,
+                            thread::priority_t prio = thread::priority::normal);
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        executor_inclusive (const executor_inclusive&) = delete;
+        executor_inclusive (executor_inclusive&&) = delete;
+        executor_inclusive&
+        operator= (const executor_inclusive&) = delete;
+        executor_inclusive&
+        operator= (executor_inclusive&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the executor object instance.
+         */
+        ~executor_inclusive ();
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        worker_t workers_storage_[W];
+
+        job_t* deques_[W][J];
+
+        os::memory::block_pool_typed_inclusive<job_t, J> pool_storage_;
+
+        thread::stack::allocation_element_t stacks_[W][(stack_size_bytes
+            + sizeof(thread::stack::allocation_element_t) - 1)
+            / sizeof(thread::stack::allocation_element_t)];
+
+        /**
+         * @endcond
+         */
+      };
+
+#pragma GCC diagnostic pop
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace rtos
+  {
+
+    inline bool
+    executor::handle::valid (void) const
+    {
+      return valid_;
+    }
+
+    inline bool
+    executor::handle::ready (void) const
+    {
+      return ready_;
+    }
+
+    inline std::size_t
+    executor::workers (void) const
+    {
+      return workers_count_;
+    }
+
+    // ========================================================================
+
+    template<std::size_t W, std::size_t J, std::size_t S>
+      executor_inclusive<W, J, S>::executor_inclusive (const char* name,
+                                                       thread::priority_t prio) :
+          executor
+            { name }
+      {
+        internal_construct_ (&workers_storage_[0], W, &deques_[0][0],
+                             &pool_storage_, J, &stacks_[0][0],
+                             sizeof(stacks_[0]), prio);
+      }
+
+    /**
+     * @details
+     * The workers are stopped and joined here, before the
+     * members they use are destroyed.
+     */
+    template<std::size_t W, std::size_t J, std::size_t S>
+      executor_inclusive<W, J, S>::~executor_inclusive ()
+      {
+        internal_destruct_ ();
+      }
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_RTOS_OS_EXECUTOR_H_ */
@@ -30,6 +30,7 @@
 
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 // ----------------------------------------------------------------------------
 
@@ -97,6 +98,44 @@ extern "C"
   void
   os_startup_initialize_args (int* p_argc, char*** p_argv);
 
+#if defined(OS_INCLUDE_STARTUP_DEFERRED_BSS)
+
+  /**
+   * @brief Clear the deferred BSS regions.
+   * @par Parameters
+   *  None.
+   * @par Returns
+   *  Nothing.
+   */
+  void
+  os_startup_initialize_deferred_bss (void);
+
+#endif /* defined(OS_INCLUDE_STARTUP_DEFERRED_BSS) */
+
+#if defined(OS_INCLUDE_STARTUP_DEFERRED_INIT_ARRAY)
+
+  /**
+   * @brief Run the next deferred static constructor.
+   * @par Parameters
+   *  None.
+   * @retval true One constructor was executed.
+   * @retval false All deferred constructors were already executed.
+   */
+  bool
+  os_startup_run_deferred_init (void);
+
+  /**
+   * @brief Run all remaining deferred static constructors.
+   * @par Parameters
+   *  None.
+   * @par Returns
+   *  Nothing.
+   */
+  void
+  os_startup_complete_deferred_init (void);
+
+#endif /* defined(OS_INCLUDE_STARTUP_DEFERRED_INIT_ARRAY) */
+
   /**
    * @brief Create the idle thread.
    * @par Parameters
@@ -107,6 +146,36 @@ extern "C"
   void
   os_startup_create_thread_idle (void);
 
+  /**
+   * @brief Create the deferred calls worker thread.
+   * @par Parameters
+   *  None.
+   * @par Returns
+   *  Nothing.
+   */
+  void
+  os_startup_create_thread_deferred (void);
+
+  /**
+   * @brief Create the thread that destroys the terminated threads.
+   * @par Parameters
+   *  None.
+   * @par Returns
+   *  Nothing.
+   */
+  void
+  os_startup_create_thread_reaper (void);
+
+  /**
+   * @brief Create the timer daemon thread.
+   * @par Parameters
+   *  None.
+   * @par Returns
+   *  Nothing.
+   */
+  void
+  os_startup_create_thread_timer_daemon (void);
+
   /**
    * @}
    */
@@ -155,6 +224,26 @@ extern "C"
   bool
   os_rtos_idle_enter_power_saving_mode_hook (void);
 
+  /**
+   * @brief Hook to sleep without the system tick.
+   * @param [in] ticks Number of ticks until the earliest deadline.
+   * @return The number of ticks actually slept, or 0 if the
+   *  hook did not sleep.
+   */
+  uint32_t
+  os_rtos_idle_tickless_sleep_hook (uint32_t ticks);
+
+  /**
+   * @brief Hook to report a thread close to its stack limit.
+   * @param [in] th Pointer to the thread (`os::rtos::thread` or
+   *  `os_thread_t`).
+   * @param [in] available Number of stack bytes never used.
+   * @par Returns
+   *  Nothing.
+   */
+  void
+  os_rtos_stack_warning_hook (void* th, size_t available);
+
   /**
    * @brief Hook to handle out of memory in the application free store.
    * @par Parameters
@@ -179,6 +268,27 @@ extern "C"
  * @}
  */
 
+#if defined(OS_INCLUDE_STARTUP_DEFERRED_INIT_ARRAY)
+
+/**
+ * @brief Lowest priority of the deferred static constructors.
+ */
+#define OS_STARTUP_DEFERRED_INIT_PRIORITY (60000)
+
+/**
+ * @brief Mark a static object as constructed after the scheduler starts.
+ * @param order Order among the deferred objects (0-5534, lower first).
+ *
+ * @details
+ * With priorities 60000 and higher, the compiler places the
+ * constructors in `.init_array.6xxxx` sections, which the linker
+ * script collects in the deferred array.
+ */
+#define OS_STARTUP_DEFERRED_INIT(order) \
+  __attribute__((init_priority(OS_STARTUP_DEFERRED_INIT_PRIORITY + (order))))
+
+#endif /* defined(OS_INCLUDE_STARTUP_DEFERRED_INIT_ARRAY) */
+
 /**
  * @name Compatibility Macros
  * @{
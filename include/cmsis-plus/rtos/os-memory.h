@@ -65,6 +65,7 @@ namespace os
     }
 
     class null_locker;
+    class mutex;
 
     namespace memory
     {
@@ -76,6 +77,12 @@ namespace os
         return (a >= b) ? a : b;
       }
 
+      constexpr std::size_t
+      min (std::size_t a, std::size_t b)
+      {
+        return (a <= b) ? a : b;
+      }
+
       /**
        * @brief Helper function to align size values.
        * @param size Unaligned size.
@@ -141,6 +148,86 @@ namespace os
        */
       using out_of_memory_handler_t = void (*)(void);
 
+#if defined(OS_INCLUDE_RTOS_MEMORY_RECLAIM)
+
+      /**
+       * @brief Memory pressure callback.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       *
+       * @details
+       * Caches that can give back memory on request define a
+       * shrinker and register it with the memory resource they
+       * allocate from.
+       */
+      class shrinker
+      {
+      public:
+
+        /**
+         * @brief Type of reclaim functions.
+         * @param [in] bytes Number of bytes needed.
+         * @param [in] args Pointer to the argument given to
+         *  the constructor.
+         * @return Number of bytes released; 0 if nothing was released.
+         */
+        using func_t = std::size_t (*) (std::size_t bytes, void* args);
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a shrinker.
+         * @param [in] func Pointer to reclaim function.
+         * @param [in] args Pointer to function argument.
+         */
+        shrinker (func_t func, void* args = nullptr);
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        shrinker (const shrinker&) = delete;
+        shrinker (shrinker&&) = delete;
+        shrinker&
+        operator= (const shrinker&) = delete;
+        shrinker&
+        operator= (shrinker&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the shrinker.
+         * @details
+         * It must be unregistered before.
+         */
+        ~shrinker () = default;
+
+        /**
+         * @}
+         */
+
+        /**
+         * @cond ignore
+         */
+
+        func_t func_;
+        void* args_;
+
+        // Set when registered to a memory resource.
+        shrinker* next_ = nullptr;
+
+        /**
+         * @endcond
+         */
+      };
+
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_RECLAIM) */
+
       /**
        * @brief Memory resource manager (abstract class).
        * @headerfile os.h <cmsis-plus/rtos/os.h>
@@ -155,6 +242,101 @@ namespace os
 
       public:
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY)
+
+        /**
+         * @brief Number of request size histogram buckets.
+         * @details
+         * Bucket `i` counts the requests between `2^i` and `2^(i+1)-1`
+         * bytes; the last bucket also counts all larger ones.
+         */
+        static constexpr std::size_t histogram_buckets = 16;
+
+        /**
+         * @brief Snapshot of the memory usage statistics.
+         */
+        typedef struct usage_s
+        {
+          /**
+           * @brief Total size of managed memory, in bytes.
+           */
+          std::size_t total_bytes;
+
+          /**
+           * @brief Current size of all allocated chunks, in bytes.
+           */
+          std::size_t allocated_bytes;
+
+          /**
+           * @brief Current size of all free chunks, in bytes.
+           */
+          std::size_t free_bytes;
+
+          /**
+           * @brief Current number of allocated chunks.
+           */
+          std::size_t allocated_chunks;
+
+          /**
+           * @brief Current number of free chunks.
+           */
+          std::size_t free_chunks;
+
+          /**
+           * @brief Peak size of all allocated chunks, in bytes.
+           */
+          std::size_t max_allocated_bytes;
+
+          /**
+           * @brief Peak number of allocated chunks.
+           */
+          std::size_t max_allocated_chunks;
+
+          /**
+           * @brief Lowest size of all free chunks, in bytes.
+           */
+          std::size_t min_free_bytes;
+
+          /**
+           * @brief Size of the largest free chunk, in bytes, or 0
+           *  if unknown.
+           */
+          std::size_t largest_free_chunk;
+
+          /**
+           * @brief Fragmentation index, in per mille.
+           */
+          std::size_t fragmentation;
+
+          /**
+           * @brief Number of allocations.
+           */
+          std::size_t allocations;
+
+          /**
+           * @brief Number of deallocations.
+           */
+          std::size_t deallocations;
+
+          /**
+           * @brief Number of allocations that returned `nullptr`.
+           */
+          std::size_t failures;
+
+          /**
+           * @brief Largest request that returned `nullptr`, in bytes.
+           */
+          std::size_t largest_failed_bytes;
+
+          /**
+           * @brief Number of requests in each size bucket.
+           */
+          std::size_t histogram[histogram_buckets];
+
+        } usage_t;
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY) */
+
         /**
          * @brief The largest alignment for the platform. Also default
          * when supplied alignment is not supported.
@@ -220,6 +402,15 @@ namespace os
         void*
         allocate (std::size_t bytes, std::size_t alignment = max_align);
 
+        /**
+         * @brief Allocate a memory block filled with zeros.
+         * @param bytes Number of bytes to allocate.
+         * @param alignment Alignment constraint (power of 2).
+         * @return Pointer to newly allocated block, or `nullptr`.
+         */
+        void*
+        allocate_zeroed (std::size_t bytes, std::size_t alignment = max_align);
+
         /**
          * @brief Deallocate the previously allocated memory block.
          * @param addr Address of the block to free.
@@ -232,6 +423,18 @@ namespace os
         deallocate (void* addr, std::size_t bytes, std::size_t alignment =
                         max_align) noexcept;
 
+        /**
+         * @brief Change the size of a previously allocated memory block.
+         * @param addr Address of the block to resize.
+         * @param old_bytes Current size of the block (may be 0 if unknown).
+         * @param new_bytes Number of bytes required.
+         * @param alignment Alignment constraint (power of 2).
+         * @return Pointer to the resized block, or `nullptr`.
+         */
+        void*
+        reallocate (void* addr, std::size_t old_bytes, std::size_t new_bytes,
+                    std::size_t alignment = max_align);
+
         /**
          * @brief Compare for equality with another `memory_resource`.
          * @param other Reference to another `memory_resource`.
@@ -270,6 +473,33 @@ namespace os
         std::size_t
         max_size (void) const noexcept;
 
+        /**
+         * @brief Fill with zeros part of the free memory.
+         * @param bytes Maximum number of bytes to fill.
+         * @return Number of bytes filled, 0 if nothing left to do.
+         */
+        std::size_t
+        zero_free (std::size_t bytes) noexcept;
+
+        /**
+         * @brief Deallocate a block later; can be invoked from
+         *  interrupt handlers.
+         * @param addr Address of the block to free.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        deallocate_deferred (void* addr) noexcept;
+
+        /**
+         * @brief Deallocate the blocks queued by `deallocate_deferred()`.
+         * @par Parameters
+         *  None.
+         * @return Number of blocks deallocated.
+         */
+        std::size_t
+        drain_deferred (void) noexcept;
+
         /**
          * @brief Set the out of memory handler.
          * @param handler Pointer to new handler.
@@ -287,6 +517,78 @@ namespace os
         out_of_memory_handler_t
         out_of_memory_handler (void);
 
+#if defined(OS_INCLUDE_RTOS_MEMORY_RECLAIM)
+
+        /**
+         * @brief Register a memory pressure callback.
+         * @param [in] s Reference to the shrinker.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        register_shrinker (shrinker& s) noexcept;
+
+        /**
+         * @brief Unregister a memory pressure callback.
+         * @param [in] s Reference to the shrinker.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        unregister_shrinker (shrinker& s) noexcept;
+
+        /**
+         * @brief Set the low water mark.
+         * @param [in] bytes Number of free bytes below which the
+         *  shrinkers are called before allocating; 0 to call
+         *  them only when allocations fail.
+         * @return The previous low water mark.
+         */
+        std::size_t
+        low_water_mark (std::size_t bytes) noexcept;
+
+        /**
+         * @brief Get the low water mark.
+         * @par Parameters
+         *  None.
+         * @return Number of bytes.
+         */
+        std::size_t
+        low_water_mark (void) const noexcept;
+
+        /**
+         * @brief Ask the shrinkers to release memory.
+         * @param [in] bytes Number of bytes needed.
+         * @return Number of bytes released.
+         */
+        std::size_t
+        reclaim (std::size_t bytes) noexcept;
+
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_RECLAIM) */
+
+#if defined(OS_INCLUDE_RTOS_MEMORY_RESOURCE_LOCKING)
+
+        /**
+         * @brief Set the mutex protecting the memory resource.
+         * @param [in] mx Pointer to mutex, or `nullptr` to lock
+         *  the scheduler.
+         * @return Pointer to the previous mutex.
+         */
+        class mutex*
+        locker (class mutex* mx) noexcept;
+
+        /**
+         * @brief Get the mutex protecting the memory resource.
+         * @par Parameters
+         *  None.
+         * @return Pointer to mutex, or `nullptr` if the scheduler
+         *  is locked.
+         */
+        class mutex*
+        locker (void) const noexcept;
+
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_RESOURCE_LOCKING) */
+
         /**
          * @brief Get the total size of managed memory.
          * @return Number of bytes.
@@ -357,6 +659,50 @@ namespace os
         std::size_t
         deallocations (void);
 
+#if defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE)
+
+        /**
+         * @brief Get the size of the blocks owned by the thread caches.
+         * @par Parameters
+         *  None.
+         * @return Number of bytes.
+         */
+        std::size_t
+        cached_bytes (void);
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE) */
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY)
+
+        /**
+         * @brief Get the size of the largest free chunk.
+         * @par Parameters
+         *  None.
+         * @return Number of bytes, or 0 if unknown.
+         */
+        std::size_t
+        largest_free_chunk (void) const noexcept;
+
+        /**
+         * @brief Get the fragmentation index.
+         * @par Parameters
+         *  None.
+         * @return Per mille of the free memory not in the largest chunk.
+         */
+        std::size_t
+        fragmentation (void) const noexcept;
+
+        /**
+         * @brief Get a snapshot of the usage statistics.
+         * @param [out] out Reference to the structure to fill in.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        snapshot (usage_t& out) const noexcept;
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY) */
+
         /**
          * @brief Print a long message with usage statistics.
          * @par Parameters
@@ -387,6 +733,15 @@ namespace os
         virtual void*
         do_allocate (std::size_t bytes, std::size_t alignment) = 0;
 
+        /**
+         * @brief Implementation of the zeroed memory allocator.
+         * @param bytes Number of bytes to allocate.
+         * @param alignment Alignment constraint (power of 2).
+         * @return Pointer to newly allocated block, or `nullptr`.
+         */
+        virtual void*
+        do_allocate_zeroed (std::size_t bytes, std::size_t alignment);
+
         /**
          * @brief Implementation of the memory deallocator.
          * @param addr Address of a previously allocated block to free.
@@ -399,6 +754,18 @@ namespace os
         do_deallocate (void* addr, std::size_t bytes, std::size_t alignment)
             noexcept = 0;
 
+        /**
+         * @brief Implementation of the memory reallocator.
+         * @param addr Address of the block to resize.
+         * @param old_bytes Current size of the block (may be 0 if unknown).
+         * @param new_bytes Number of bytes required.
+         * @param alignment Alignment constraint (power of 2).
+         * @return Pointer to the resized block, or `nullptr`.
+         */
+        virtual void*
+        do_reallocate (void* addr, std::size_t old_bytes, std::size_t new_bytes,
+                       std::size_t alignment);
+
         /**
          * @brief Implementation of the equality comparator.
          * @param other Reference to another `memory_resource`.
@@ -417,6 +784,15 @@ namespace os
         virtual std::size_t
         do_max_size (void) const noexcept;
 
+        /**
+         * @brief Implementation of the function to fill free memory
+         *  with zeros.
+         * @param bytes Maximum number of bytes to fill.
+         * @return Number of bytes filled.
+         */
+        virtual std::size_t
+        do_zero_free (std::size_t bytes) noexcept;
+
         /**
          * @brief Implementation of the function to reset the memory manager.
          * @par Parameters
@@ -434,84 +810,529 @@ namespace os
          * @retval true if the operation resulted in larger blocks.
          * @retval false if the operation was ineffective.
          */
-        virtual bool
-        do_coalesce (void) noexcept;
+        virtual bool
+        do_coalesce (void) noexcept;
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY)
+
+        /**
+         * @brief Implementation of the function to get the largest
+         *  free chunk.
+         * @par Parameters
+         *  None.
+         * @return Number of bytes, or 0 if unknown.
+         */
+        virtual std::size_t
+        do_largest_free_chunk (void) const noexcept;
+
+        /**
+         * @brief Update statistics after a request.
+         * @param [in] bytes Number of requested bytes.
+         * @param [in] addr Address of the block, or `nullptr`.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        internal_record_request_ (std::size_t bytes, void* addr) noexcept;
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY) */
+
+#if defined(OS_INCLUDE_RTOS_MEMORY_TRACE_EVENTS)
+
+        /**
+         * @brief Kinds of heap trace events.
+         */
+        static constexpr std::size_t trace_allocation = 0;
+        static constexpr std::size_t trace_deallocation = 1;
+
+        /**
+         * @brief Store a heap event in the binary trace.
+         * @param [in] event `trace_allocation` or `trace_deallocation`.
+         * @param [in] addr Address of the block, or `nullptr`.
+         * @param [in] bytes Number of bytes.
+         * @par Returns
+         *  Nothing.
+         * @details
+         * Not inlined, so the return address is the
+         * call site of `allocate()` or `deallocate()`.
+         */
+        void
+        __attribute__((noinline))
+        internal_trace_event_ (std::size_t event, void* addr,
+                               std::size_t bytes) noexcept;
+
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_TRACE_EVENTS) */
+
+        /**
+         * @brief Update statistics after allocation.
+         * @param [in] bytes Number of allocated bytes.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        internal_increase_allocated_statistics (std::size_t bytes) noexcept;
+
+        /**
+         * @brief Update statistics after deallocation.
+         * @param [in] bytes Number of deallocated bytes.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        internal_decrease_allocated_statistics (std::size_t bytes) noexcept;
+
+        /**
+         * @brief Update statistics after a chunk was enlarged.
+         * @param [in] bytes Number of bytes added to the chunk.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        internal_grow_allocated_statistics (std::size_t bytes) noexcept;
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        out_of_memory_handler_t out_of_memory_handler_ = nullptr;
+
+        std::size_t total_bytes_ = 0;
+        std::size_t allocated_bytes_ = 0;
+        std::size_t free_bytes_ = 0;
+        std::size_t allocated_chunks_ = 0;
+        std::size_t free_chunks_ = 0;
+        std::size_t max_allocated_bytes_ = 0;
+        std::size_t allocations_ = 0;
+        std::size_t deallocations_ = 0;
+
+        // List of blocks released from interrupt handlers,
+        // linked via their first word.
+        void* deferred_ = nullptr;
+
+#if defined(OS_INCLUDE_RTOS_MEMORY_RESOURCE_LOCKING)
+
+        class mutex* locker_ = nullptr;
+
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_RESOURCE_LOCKING) */
+
+#if defined(OS_INCLUDE_RTOS_MEMORY_RECLAIM)
+
+        shrinker* shrinkers_ = nullptr;
+        std::size_t low_water_mark_ = 0;
+        // Prevents recursion, if a shrinker allocates.
+        bool reclaiming_ = false;
+
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_RECLAIM) */
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY)
+
+        std::size_t max_allocated_chunks_ = 0;
+        // Updated only after allocations, the initial value means none.
+        std::size_t min_free_bytes_ = ~static_cast<std::size_t> (0);
+        std::size_t failures_ = 0;
+        std::size_t largest_failed_bytes_ = 0;
+        std::size_t histogram_[histogram_buckets] =
+          { 0 };
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY) */
+
+#if defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE)
+
+        // Included in allocated_bytes_.
+        std::size_t cached_bytes_ = 0;
+
+        friend class allocation_cache;
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE) */
+
+        /**
+         * @endcond
+         */
+
+      };
+
+      /**
+       * @name Operators
+       * @{
+       */
+
+      /**
+       * @brief Compare the `memory_resource` instances for equality.
+       * @param lhs First instance to compare.
+       * @param rhs Second instance to compare.
+       * @retval true The two object `memory_resource` instances are equal.
+       * @retval false The two object `memory_resource` instances are not equal.
+       */
+      bool
+      operator== (const memory_resource& lhs, const memory_resource& rhs)
+          noexcept;
+
+      /**
+       * @brief Compare the `memory_resource` instances for inequality.
+       * @param lhs First instance to compare.
+       * @param rhs Second instance to compare.
+       * @retval true The two object `memory_resource` instances are not equal.
+       * @retval false The two object `memory_resource` instances are equal.
+       */
+      bool
+      operator!= (const memory_resource& lhs, const memory_resource& rhs)
+          noexcept;
+
+      /**
+       * @}
+       */
+
+#if defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE)
+
+      // ======================================================================
+
+      class allocation_cache;
+
+      /**
+       * @brief Allocate a block via the current thread cache.
+       * @param bytes Number of bytes to allocate.
+       * @return Pointer to newly allocated block, or `nullptr`.
+       */
+      void*
+      allocate_cached (std::size_t bytes);
+
+      /**
+       * @brief Allocate an aligned block via the current thread cache.
+       * @param bytes Number of bytes to allocate.
+       * @param alignment Alignment constraint (power of 2).
+       * @return Pointer to newly allocated block, or `nullptr`.
+       */
+      void*
+      allocate_cached (std::size_t bytes, std::size_t alignment);
+
+      /**
+       * @brief Deallocate a block via the current thread cache.
+       * @param addr Address of a block returned by `allocate_cached()`.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      deallocate_cached (void* addr) noexcept;
+
+      /**
+       * @brief Per-thread cache of small blocks.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       *
+       * @details
+       * Each thread keeps lists of free blocks, one for each
+       * size class, allocated from the application default memory
+       * resource in batches, so most small allocations and
+       * deallocations do not need to lock the scheduler.
+       *
+       * It is used by `operator new()` and `malloc()`, via
+       * `allocate_cached()` and `deallocate_cached()`.
+       */
+      class allocation_cache
+      {
+      public:
+
+        /**
+         * @brief The number of size classes.
+         */
+        static constexpr std::size_t classes = 4;
+
+        /**
+         * @brief The number of blocks moved from/to the memory resource.
+         */
+        static constexpr std::size_t batch = 4;
+
+        /**
+         * @brief The payload size of the smallest class; each class
+         *  is twice as large as the previous one.
+         */
+        static constexpr std::size_t min_bytes = 16;
+
+        /**
+         * @brief The size of the block header.
+         */
+        static constexpr std::size_t header_bytes = memory_resource::max_align;
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct an empty cache.
+         */
+        allocation_cache () = default;
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        allocation_cache (const allocation_cache&) = delete;
+        allocation_cache (allocation_cache&&) = delete;
+        allocation_cache&
+        operator= (const allocation_cache&) = delete;
+        allocation_cache&
+        operator= (allocation_cache&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the cache.
+         */
+        ~allocation_cache ();
+
+        /**
+         * @}
+         */
+
+      public:
+
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+        /**
+         * @brief Allocate a block.
+         * @param bytes Number of bytes to allocate.
+         * @return Pointer to newly allocated block, or `nullptr`.
+         */
+        void*
+        allocate (std::size_t bytes);
+
+        /**
+         * @brief Deallocate a block.
+         * @param addr Address of a block returned by `allocate()`
+         *  on any cache.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        deallocate (void* addr) noexcept;
+
+        /**
+         * @brief Return all cached blocks to the memory resource.
+         * @par Parameters
+         *  None.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        flush (void) noexcept;
+
+        /**
+         * @brief Get the size of the free blocks in the cache.
+         * @par Parameters
+         *  None.
+         * @return Number of bytes.
+         */
+        std::size_t
+        cached_bytes (void);
+
+        /**
+         * @}
+         */
+
+        /**
+         * @cond ignore
+         */
+
+        static void*
+        internal_allocate_direct_ (std::size_t bytes,
+                                   std::size_t alignment = header_bytes);
+
+        static void
+        internal_deallocate_direct_ (void* addr) noexcept;
+
+        /**
+         * @endcond
+         */
+
+      protected:
+
+        /**
+         * @name Private Member Functions
+         * @{
+         */
+
+        /**
+         * @brief Allocate a batch of blocks from the memory resource.
+         * @param [in] cls Size class.
+         * @retval true Some blocks were allocated.
+         * @retval false The memory resource is full.
+         */
+        bool
+        internal_refill_ (std::size_t cls);
+
+        /**
+         * @brief Return blocks to the memory resource.
+         * @param [in] cls Size class.
+         * @param [in] count Number of blocks.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        internal_release_ (std::size_t cls, std::size_t count) noexcept;
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        // Free blocks are linked via their first word.
+        typedef struct block_s
+        {
+          struct block_s* next;
+        } block_t;
+
+        block_t* lists_[classes] =
+          { };
+        std::size_t counts_[classes] =
+          { };
+        std::size_t cached_bytes_ = 0;
+
+        /**
+         * @endcond
+         */
+
+      };
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE) */
+
+#if defined(OS_INCLUDE_RTOS_MEMORY_PROFILER)
+
+      // ======================================================================
+
+      /**
+       * @brief Allocation hot-site profiler.
+       *
+       * @details
+       * Sampled allocations done by `operator new()` and `malloc()`
+       * are aggregated by the caller return address; the caller
+       * addresses can be translated to source lines with
+       * `addr2line`.
+       */
+      namespace profiler
+      {
+        /**
+         * @brief Statistics of an allocation site.
+         * @details
+         * All counters refer to sampled allocations; multiply by
+         * the sampling rate to estimate the totals.
+         */
+        typedef struct site_s
+        {
+          /**
+           * @brief Return address of the allocation call,
+           *  or `nullptr` for an unused entry.
+           */
+          const void* caller;
+
+          /**
+           * @brief Number of sampled allocations.
+           */
+          std::size_t allocations;
+
+          /**
+           * @brief Sum of the sampled allocation sizes, in bytes.
+           */
+          std::size_t bytes;
+
+          /**
+           * @brief Number of sampled blocks not yet deallocated.
+           */
+          std::size_t live;
+
+          /**
+           * @brief Number of sampled blocks deallocated.
+           */
+          std::size_t freed;
+
+          /**
+           * @brief Sum of the lifetimes of the deallocated blocks,
+           *  in high resolution clock cycles.
+           */
+          port::clock::timestamp_t lifetime_cycles;
+
+          /**
+           * @brief Longest lifetime, in high resolution clock cycles.
+           */
+          port::clock::timestamp_t max_lifetime_cycles;
+
+        } site_t;
+
+        /**
+         * @brief The number of entries in the sites table.
+         */
+        constexpr std::size_t sites_size =
+            OS_INTEGER_RTOS_MEMORY_PROFILER_SITES;
 
         /**
-         * @brief Update statistics after allocation.
-         * @param [in] bytes Number of allocated bytes.
+         * @brief Record an allocation.
+         * @param [in] caller Return address in the caller.
+         * @param [in] addr Address of the allocated block.
+         * @param [in] bytes Number of bytes requested.
          * @par Returns
          *  Nothing.
          */
         void
-        internal_increase_allocated_statistics (std::size_t bytes) noexcept;
+        record_allocation (const void* caller, const void* addr,
+                           std::size_t bytes) noexcept;
 
         /**
-         * @brief Update statistics after deallocation.
-         * @param [in] bytes Number of deallocated bytes.
+         * @brief Record a deallocation.
+         * @param [in] addr Address of the block.
          * @par Returns
          *  Nothing.
          */
         void
-        internal_decrease_allocated_statistics (std::size_t bytes) noexcept;
+        record_deallocation (const void* addr) noexcept;
 
         /**
-         * @}
+         * @brief Get an entry of the sites table.
+         * @param [in] index Index, less than `sites_size`.
+         * @return Reference to entry; unused entries have
+         *  a null caller.
          */
-
-      protected:
+        const site_t&
+        site (std::size_t index) noexcept;
 
         /**
-         * @cond ignore
+         * @brief Clear all profiling data.
+         * @par Parameters
+         *  None.
+         * @par Returns
+         *  Nothing.
          */
-
-        out_of_memory_handler_t out_of_memory_handler_ = nullptr;
-
-        std::size_t total_bytes_ = 0;
-        std::size_t allocated_bytes_ = 0;
-        std::size_t free_bytes_ = 0;
-        std::size_t allocated_chunks_ = 0;
-        std::size_t free_chunks_ = 0;
-        std::size_t max_allocated_bytes_ = 0;
-        std::size_t allocations_ = 0;
-        std::size_t deallocations_ = 0;
+        void
+        clear (void) noexcept;
 
         /**
-         * @endcond
+         * @brief Print the allocation sites, heaviest first.
+         * @par Parameters
+         *  None.
+         * @par Returns
+         *  Nothing.
          */
+        void
+        trace_print (void);
 
-      };
-
-      /**
-       * @name Operators
-       * @{
-       */
-
-      /**
-       * @brief Compare the `memory_resource` instances for equality.
-       * @param lhs First instance to compare.
-       * @param rhs Second instance to compare.
-       * @retval true The two object `memory_resource` instances are equal.
-       * @retval false The two object `memory_resource` instances are not equal.
-       */
-      bool
-      operator== (const memory_resource& lhs, const memory_resource& rhs)
-          noexcept;
-
-      /**
-       * @brief Compare the `memory_resource` instances for inequality.
-       * @param lhs First instance to compare.
-       * @param rhs Second instance to compare.
-       * @retval true The two object `memory_resource` instances are not equal.
-       * @retval false The two object `memory_resource` instances are equal.
-       */
-      bool
-      operator!= (const memory_resource& lhs, const memory_resource& rhs)
-          noexcept;
+      } /* namespace profiler */
 
-      /**
-       * @}
-       */
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_PROFILER) */
 
       // ======================================================================
       /**
@@ -662,6 +1483,134 @@ namespace os
        * @endcond
        */
 
+#if defined(OS_INCLUDE_RTOS_MEMORY_RESOURCE_LOCKING)
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+      /**
+       * @brief Lockable of a memory resource.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       *
+       * @details
+       * Lock the mutex of the memory resource, if set,
+       * otherwise the scheduler.
+       */
+      class resource_lockable
+      {
+      public:
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a lockable for a memory resource.
+         * @param [in] res Pointer to memory resource.
+         */
+        explicit
+        resource_lockable (memory_resource* res) noexcept;
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        resource_lockable (const resource_lockable&) = delete;
+        resource_lockable (resource_lockable&&) = delete;
+        resource_lockable&
+        operator= (const resource_lockable&) = delete;
+        resource_lockable&
+        operator= (resource_lockable&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the lockable.
+         */
+        ~resource_lockable () = default;
+
+        /**
+         * @}
+         */
+
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+        /**
+         * @brief Lock the memory resource.
+         * @par Parameters
+         *  None.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        lock (void);
+
+        /**
+         * @brief Unlock the memory resource.
+         * @par Parameters
+         *  None.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        unlock (void);
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        memory_resource* res_;
+
+        // The mutex taken by lock(), or nullptr if the scheduler
+        // was locked.
+        class mutex* mutex_ = nullptr;
+
+        scheduler::state_t state_ = false;
+
+        /**
+         * @endcond
+         */
+      };
+
+#pragma GCC diagnostic pop
+
+      /**
+       * @brief Lockable of the memory resource returned by a function.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       * @tparam get_resource Function to get the resource.
+       *
+       * @details
+       * Default constructible, to be used as the locker of
+       * the synchronized allocators.
+       */
+      template<F get_resource>
+        class resource_locker : public resource_lockable
+        {
+        public:
+
+          /**
+           * @brief Construct a lockable for the resource.
+           * @par Parameters
+           *  None.
+           */
+          resource_locker () noexcept;
+        };
+
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_RESOURCE_LOCKING) */
+
       /**
        * @brief Allocator using memory resources.
        * @headerfile os.h <cmsis-plus/rtos/os.h>
@@ -1059,10 +2008,16 @@ namespace os
        *
        * @details
        * The allocator uses scheduler critical sections to be thread safe,
-       * and the default memory resource associated with the given type.
+       * or, with `OS_INCLUDE_RTOS_MEMORY_RESOURCE_LOCKING`, the
+       * mutex of the resource, if set, and the default memory resource
+       * associated with the given type.
        */
       template<typename T, typename U = T>
+#if defined(OS_INCLUDE_RTOS_MEMORY_RESOURCE_LOCKING)
+        using allocator_typed = allocator_stateless_polymorphic_synchronized<T, resource_locker<get_resource_typed<U>>, get_resource_typed<U>>;
+#else
         using allocator_typed = allocator_stateless_polymorphic_synchronized<T, scheduler::lockable, get_resource_typed<U>>;
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_RESOURCE_LOCKING) */
 
       /**
        * @brief Type of a RTOS unique pointer to objects of type T.
@@ -1270,9 +2225,12 @@ namespace os
        *
        * If the storage of the requested size and alignment cannot be
        * obtained:
+       * - if shrinkers are registered and release memory, retry;
        * - if the out of memory handler is not set, return `nullptr`;
        * - if the out of memory handler is set, call it and retry.
        *
+       * Blocks queued by `deallocate_deferred()` are deallocated first.
+       *
        * Equivalent to `return do_allocate(bytes, alignment);`.
        *
        * @par Exceptions
@@ -1284,8 +2242,77 @@ namespace os
       inline void*
       memory_resource::allocate (std::size_t bytes, std::size_t alignment)
       {
+        if (__atomic_load_n (&deferred_, __ATOMIC_RELAXED) != nullptr)
+          {
+            drain_deferred ();
+          }
+
+#if defined(OS_INCLUDE_RTOS_MEMORY_RECLAIM)
+        if (free_bytes_ < low_water_mark_)
+          {
+            reclaim (low_water_mark_ - free_bytes_);
+          }
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_RECLAIM) */
+
         ++allocations_;
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY) \
+    || defined(OS_INCLUDE_RTOS_MEMORY_TRACE_EVENTS)
+        void* addr = do_allocate (bytes, alignment);
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY)
+        internal_record_request_ (bytes, addr);
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY) */
+#if defined(OS_INCLUDE_RTOS_MEMORY_TRACE_EVENTS)
+        internal_trace_event_ (trace_allocation, addr, bytes);
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_TRACE_EVENTS) */
+        return addr;
+#else
         return do_allocate (bytes, alignment);
+#endif
+      }
+
+      /**
+       * @details
+       * The same as `allocate()`, but the block is filled with zeros.
+       * Memory managers that know which free memory is already
+       * zero can skip filling it.
+       *
+       * Equivalent to `return do_allocate_zeroed(bytes, alignment);`.
+       *
+       * @par Standard compliance
+       *   Extension to standard.
+       *
+       * @see do_allocate_zeroed();
+       */
+      inline void*
+      memory_resource::allocate_zeroed (std::size_t bytes,
+                                        std::size_t alignment)
+      {
+        if (__atomic_load_n (&deferred_, __ATOMIC_RELAXED) != nullptr)
+          {
+            drain_deferred ();
+          }
+
+#if defined(OS_INCLUDE_RTOS_MEMORY_RECLAIM)
+        if (free_bytes_ < low_water_mark_)
+          {
+            reclaim (low_water_mark_ - free_bytes_);
+          }
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_RECLAIM) */
+
+        ++allocations_;
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY) \
+    || defined(OS_INCLUDE_RTOS_MEMORY_TRACE_EVENTS)
+        void* addr = do_allocate_zeroed (bytes, alignment);
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY)
+        internal_record_request_ (bytes, addr);
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY) */
+#if defined(OS_INCLUDE_RTOS_MEMORY_TRACE_EVENTS)
+        internal_trace_event_ (trace_allocation, addr, bytes);
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_TRACE_EVENTS) */
+        return addr;
+#else
+        return do_allocate_zeroed (bytes, alignment);
+#endif
       }
 
       /**
@@ -1308,9 +2335,49 @@ namespace os
                                    std::size_t alignment) noexcept
       {
         ++deallocations_;
+#if defined(OS_INCLUDE_RTOS_MEMORY_TRACE_EVENTS)
+        internal_trace_event_ (trace_deallocation, addr, bytes);
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_TRACE_EVENTS) */
         do_deallocate (addr, bytes, alignment);
       }
 
+      /**
+       * @details
+       * Change the size of the block pointed by _addr_, preserving
+       * its content up to the lesser of the old and new sizes.
+       * The block may be resized in place, or moved to a new address;
+       * if the new block cannot be obtained, the old one is
+       * left unchanged and `nullptr` is returned.
+       *
+       * Equivalent to
+       * `return do_reallocate(addr, old_bytes, new_bytes, alignment);`.
+       *
+       * @par Exceptions
+       *   The code itself throws nothing, but if the out of memory
+       *   handler is set, it may throw a `bad_alloc()` exception.
+       *
+       * @par Standard compliance
+       *   Extension to standard.
+       *
+       * @see do_reallocate();
+       */
+      inline void*
+      memory_resource::reallocate (void* addr, std::size_t old_bytes,
+                                   std::size_t new_bytes, std::size_t alignment)
+      {
+#if defined(OS_INCLUDE_RTOS_MEMORY_TRACE_EVENTS)
+        void* new_addr = do_reallocate (addr, old_bytes, new_bytes, alignment);
+        if (new_addr != nullptr && addr != nullptr)
+          {
+            internal_trace_event_ (trace_deallocation, addr, old_bytes);
+          }
+        internal_trace_event_ (trace_allocation, new_addr, new_bytes);
+        return new_addr;
+#else
+        return do_reallocate (addr, old_bytes, new_bytes, alignment);
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_TRACE_EVENTS) */
+      }
+
       /**
        * @details
        * Compare `*this` for equality with other. Two `memory_resources`
@@ -1339,6 +2406,23 @@ namespace os
         return do_max_size ();
       }
 
+      /**
+       * @details
+       * Intended to be called during idle time, with small values,
+       * so that later `allocate_zeroed()` calls need not
+       * fill the blocks.
+       *
+       * @par Standard compliance
+       *   Extension to standard.
+       *
+       * @see do_zero_free();
+       */
+      inline std::size_t
+      memory_resource::zero_free (std::size_t bytes) noexcept
+      {
+        return do_zero_free (bytes);
+      }
+
       /**
        * @details
        *
@@ -1347,6 +2431,16 @@ namespace os
       inline void
       memory_resource::reset (void) noexcept
       {
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY)
+        max_allocated_chunks_ = 0;
+        min_free_bytes_ = ~static_cast<std::size_t> (0);
+        failures_ = 0;
+        largest_failed_bytes_ = 0;
+        for (std::size_t i = 0; i < histogram_buckets; ++i)
+          {
+            histogram_[i] = 0;
+          }
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY) */
         do_reset ();
       }
 
@@ -1443,6 +2537,31 @@ namespace os
         return deallocations_;
       }
 
+#if defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE)
+
+      inline std::size_t
+      memory_resource::cached_bytes (void)
+      {
+        return cached_bytes_;
+      }
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE) */
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY)
+
+      /**
+       * @details
+       *
+       * @see do_largest_free_chunk();
+       */
+      inline std::size_t
+      memory_resource::largest_free_chunk (void) const noexcept
+      {
+        return do_largest_free_chunk ();
+      }
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY) */
+
       inline void
       memory_resource::trace_print_statistics (void)
       {
@@ -1457,6 +2576,25 @@ namespace os
                        allocated_chunks (), free_bytes (), free_chunks (),
                        max_allocated_bytes (), allocations (),
                        deallocations ());
+#if defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE)
+        trace::printf ("\tcached: %u bytes\n", cached_bytes ());
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE) */
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY)
+        usage_t u;
+        snapshot (u);
+        trace::printf ("\tpeak: %u chunk(s), min free: %u bytes, \n"
+                       "\tlargest free: %u bytes, fragmentation: %u/1000, \n"
+                       "\tfailures: %u, largest failed: %u bytes\n",
+                       u.max_allocated_chunks, u.min_free_bytes,
+                       u.largest_free_chunk, u.fragmentation, u.failures,
+                       u.largest_failed_bytes);
+        trace::printf ("\tsizes:");
+        for (std::size_t i = 0; i < histogram_buckets; ++i)
+          {
+            trace::printf (" %u", u.histogram[i]);
+          }
+        trace::printf ("\n");
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY) */
 #endif /* defined(TRACE) */
       }
 
@@ -1476,6 +2614,33 @@ namespace os
 
       // ======================================================================
 
+#if defined(OS_INCLUDE_RTOS_MEMORY_RESOURCE_LOCKING)
+
+      inline
+      resource_lockable::resource_lockable (memory_resource* res) noexcept :
+          res_ (res)
+      {
+        ;
+      }
+
+      template<F get_resource>
+        inline
+        resource_locker<get_resource>::resource_locker () noexcept :
+            resource_lockable (get_resource ())
+        {
+          ;
+        }
+
+      inline class mutex*
+      memory_resource::locker (void) const noexcept
+      {
+        return locker_;
+      }
+
+      // ======================================================================
+
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_RESOURCE_LOCKING) */
+
       template<typename T>
         template<typename U>
           inline
@@ -1489,7 +2654,14 @@ namespace os
         inline typename allocator_stateless_default_resource<T>::value_type*
         allocator_stateless_default_resource<T>::allocate (std::size_t elements)
         {
+#if defined(OS_INCLUDE_RTOS_MEMORY_RESOURCE_LOCKING)
+          resource_lockable lk
+            { get_default_resource () };
+          std::lock_guard<resource_lockable> ulk
+            { lk };
+#else
           scheduler::critical_section scs;
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_RESOURCE_LOCKING) */
 
           return static_cast<value_type*> (get_default_resource ()->allocate (
               elements * sizeof(value_type)));
@@ -1500,7 +2672,14 @@ namespace os
         allocator_stateless_default_resource<T>::deallocate (
             value_type* addr, std::size_t elements) noexcept
         {
+#if defined(OS_INCLUDE_RTOS_MEMORY_RESOURCE_LOCKING)
+          resource_lockable lk
+            { get_default_resource () };
+          std::lock_guard<resource_lockable> ulk
+            { lk };
+#else
           scheduler::critical_section scs;
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_RESOURCE_LOCKING) */
 
           get_default_resource ()->deallocate (addr,
                                                elements * sizeof(value_type));
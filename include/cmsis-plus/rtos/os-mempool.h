@@ -34,6 +34,7 @@
 
 #include <cmsis-plus/rtos/os-decls.h>
 #include <cmsis-plus/rtos/os-memory.h>
+#include <cmsis-plus/rtos/internal/os-lock-free.h>
 
 #include <cmsis-plus/diag/trace.h>
 
@@ -139,6 +140,17 @@ namespace os
          */
         std::size_t mp_pool_size_bytes = 0;
 
+        /**
+         * @brief Use a lock-free list of free blocks.
+         * @details
+         * `try_alloc()` and `free()` do not use critical sections,
+         * and can be invoked from interrupts of any priority;
+         * threads waiting in `alloc()` are not resumed by
+         * `free()` from interrupts above the critical section
+         * priority.
+         */
+        bool mp_lock_free = false;
+
         // Add more attributes here.
 
         /**
@@ -165,7 +177,8 @@ namespace os
         class arena
         {
         public:
-          T pool[(blocks * block_size_bytes + sizeof(T) - 1) / sizeof(T)];
+          // Each block is aligned, as in compute_allocated_size_bytes().
+          T pool[blocks * ((block_size_bytes + sizeof(T) - 1) / sizeof(T))];
         };
 
       /**
@@ -231,6 +244,13 @@ namespace os
       memory_pool ();
       memory_pool (const char* name);
 
+#if !defined(OS_USE_RTOS_PORT_MEMORY_POOL)
+      constexpr
+      memory_pool (constant_init_t tag, const char* name, std::size_t blocks,
+                   std::size_t block_size_bytes, void* pool_address,
+                   std::size_t pool_size_bytes);
+#endif /* !defined(OS_USE_RTOS_PORT_MEMORY_POOL) */
+
       /**
        * @endcond
        */
@@ -324,6 +344,36 @@ namespace os
       result_t
       free (void* block);
 
+      /**
+       * @brief Allocate multiple memory blocks.
+       * @param [out] blocks Array where to store the block pointers.
+       * @param [in] n Number of blocks requested.
+       * @return Number of blocks allocated, at least 1,
+       *  or 0 if interrupted.
+       */
+      std::size_t
+      alloc_n (void** blocks, std::size_t n);
+
+      /**
+       * @brief Try to allocate multiple memory blocks.
+       * @param [out] blocks Array where to store the block pointers.
+       * @param [in] n Number of blocks requested.
+       * @return Number of blocks allocated, or 0 if no memory available.
+       */
+      std::size_t
+      try_alloc_n (void** blocks, std::size_t n);
+
+      /**
+       * @brief Free multiple memory blocks.
+       * @param [in] blocks Array of pointers to memory blocks to free.
+       * @param [in] n Number of blocks.
+       * @retval result::ok The memory blocks were released.
+       * @retval EINVAL A block does not belong to the memory pool;
+       *  no block was released.
+       */
+      result_t
+      free_n (void* const * blocks, std::size_t n);
+
       /**
        * @brief Get memory pool capacity.
        * @par Parameters
@@ -437,6 +487,15 @@ namespace os
       void*
       internal_try_first_ (void);
 
+      std::size_t
+      internal_try_first_n_ (void** blocks, std::size_t n);
+
+      void*
+      internal_next_free_ (void* block) const;
+
+      void
+      internal_link_free_ (void* block, void* next);
+
       /**
        * @endcond
        */
@@ -517,6 +576,16 @@ namespace os
        */
       void* volatile first_ = nullptr;
 
+      /**
+       * @brief The free blocks, if the pool is lock-free.
+       */
+      internal::lock_free_block_list lock_free_list_;
+
+      /**
+       * @brief True if the pool is lock-free (from `attr.mp_lock_free`).
+       */
+      bool lock_free_ = false;
+
       /**
        * @endcond
        */
@@ -726,6 +795,36 @@ namespace os
         result_t
         free (value_type* block);
 
+        /**
+         * @brief Allocate multiple memory blocks.
+         * @param [out] blocks Array where to store the block pointers.
+         * @param [in] n Number of blocks requested.
+         * @return Number of blocks allocated, at least 1,
+         *  or 0 if interrupted.
+         */
+        std::size_t
+        alloc_n (value_type** blocks, std::size_t n);
+
+        /**
+         * @brief Try to allocate multiple memory blocks.
+         * @param [out] blocks Array where to store the block pointers.
+         * @param [in] n Number of blocks requested.
+         * @return Number of blocks allocated, or 0 if no memory available.
+         */
+        std::size_t
+        try_alloc_n (value_type** blocks, std::size_t n);
+
+        /**
+         * @brief Free multiple memory blocks.
+         * @param [in] blocks Array of pointers to memory blocks to free.
+         * @param [in] n Number of blocks.
+         * @retval result::ok The memory blocks were released.
+         * @retval EINVAL A block does not belong to the memory pool;
+         *  no block was released.
+         */
+        result_t
+        free_n (value_type* const * blocks, std::size_t n);
+
         /**
          * @}
          */
@@ -774,6 +873,19 @@ namespace os
         memory_pool_inclusive (const char* name, const attributes& attr =
                                    initializer);
 
+#if !defined(OS_USE_RTOS_PORT_MEMORY_POOL)
+
+        /**
+         * @brief Construct a memory pool object instance at compile time.
+         * @param [in] tag The constant initialisation tag.
+         * @param [in] name Pointer to name.
+         */
+        constexpr
+        memory_pool_inclusive (constant_init_t tag, const char* name =
+                                   nullptr);
+
+#endif /* !defined(OS_USE_RTOS_PORT_MEMORY_POOL) */
+
         /**
          * @cond ignore
          */
@@ -864,6 +976,36 @@ namespace os
         result_t
         free (value_type* block);
 
+        /**
+         * @brief Allocate multiple memory blocks.
+         * @param [out] blocks Array where to store the block pointers.
+         * @param [in] n Number of blocks requested.
+         * @return Number of blocks allocated, at least 1,
+         *  or 0 if interrupted.
+         */
+        std::size_t
+        alloc_n (value_type** blocks, std::size_t n);
+
+        /**
+         * @brief Try to allocate multiple memory blocks.
+         * @param [out] blocks Array where to store the block pointers.
+         * @param [in] n Number of blocks requested.
+         * @return Number of blocks allocated, or 0 if no memory available.
+         */
+        std::size_t
+        try_alloc_n (value_type** blocks, std::size_t n);
+
+        /**
+         * @brief Free multiple memory blocks.
+         * @param [in] blocks Array of pointers to memory blocks to free.
+         * @param [in] n Number of blocks.
+         * @retval result::ok The memory blocks were released.
+         * @retval EINVAL A block does not belong to the memory pool;
+         *  no block was released.
+         */
+        result_t
+        free_n (value_type* const * blocks, std::size_t n);
+
         /**
          * @}
          */
@@ -889,6 +1031,43 @@ namespace os
 
     // ========================================================================
 
+#if !defined(OS_USE_RTOS_PORT_MEMORY_POOL)
+
+    /**
+     * @cond ignore
+     */
+
+    /*
+     * The free list is not built; the zero filled storage is
+     * already a list of all blocks (see `internal_next_free_()`).
+     * The clock is the `sysclock` and the pool is not lock-free.
+     */
+    constexpr
+    memory_pool::memory_pool (constant_init_t tag, const char* name,
+                              std::size_t blocks, std::size_t block_size_bytes,
+                              void* pool_address, std::size_t pool_size_bytes) :
+        object_named_system
+          { name }, //
+        list_
+          { tag }, //
+        clock_ (&sysclock), //
+        pool_addr_ (pool_address), //
+        pool_size_bytes_ (pool_size_bytes), //
+        blocks_ (static_cast<memory_pool::size_t> (blocks)), //
+        block_size_bytes_ (
+            static_cast<memory_pool::size_t> ((block_size_bytes
+                + __SIZEOF_POINTER__ - 1) & ~(__SIZEOF_POINTER__ - 1))), //
+        first_ (pool_address)
+    {
+      ;
+    }
+
+    /**
+     * @endcond
+     */
+
+#endif /* !defined(OS_USE_RTOS_PORT_MEMORY_POOL) */
+
     /**
      * @details
      * Identical memory pools should have the same memory address.
@@ -1036,8 +1215,8 @@ namespace os
             { name }
       {
 #if defined(OS_TRACE_RTOS_MEMPOOL)
-        trace::printf ("%s() @%p %s %d %d\n", __func__, this, this->name (),
-                       blocks, block_size_bytes);
+        OS_TRACE_PRINTF (rtos_mempool, "%s() @%p %s %d %d\n", __func__, this,
+                         this->name (), blocks, block_size_bytes);
 #endif
         if (attr.mp_pool_address != nullptr)
           {
@@ -1089,7 +1268,8 @@ namespace os
       memory_pool_allocated<Allocator>::~memory_pool_allocated ()
       {
 #if defined(OS_TRACE_RTOS_MEMPOOL)
-        trace::printf ("%s() @%p %s\n", __func__, this, name ());
+        OS_TRACE_PRINTF (rtos_mempool, "%s() @%p %s\n", __func__, this,
+                         name ());
 #endif
         typedef typename std::allocator_traits<allocator_type>::pointer pointer;
 
@@ -1264,6 +1444,48 @@ namespace os
         return memory_pool_allocated<allocator_type>::free (block);
       }
 
+    /**
+     * @details
+     * Wrapper over the parent method, automatically
+     * passing the cast.
+     *
+     * @see memory_pool::alloc_n().
+     */
+    template<typename T, typename Allocator>
+      inline std::size_t
+      memory_pool_typed<T, Allocator>::alloc_n (value_type** blocks, std::size_t n)
+      {
+        return memory_pool_allocated<allocator_type>::alloc_n (reinterpret_cast<void**> (blocks), n);
+      }
+
+    /**
+     * @details
+     * Wrapper over the parent method, automatically
+     * passing the cast.
+     *
+     * @see memory_pool::try_alloc_n().
+     */
+    template<typename T, typename Allocator>
+      inline std::size_t
+      memory_pool_typed<T, Allocator>::try_alloc_n (value_type** blocks, std::size_t n)
+      {
+        return memory_pool_allocated<allocator_type>::try_alloc_n (reinterpret_cast<void**> (blocks), n);
+      }
+
+    /**
+     * @details
+     * Wrapper over the parent method, automatically
+     * passing the cast.
+     *
+     * @see memory_pool::free_n().
+     */
+    template<typename T, typename Allocator>
+      inline result_t
+      memory_pool_typed<T, Allocator>::free_n (value_type* const * blocks, std::size_t n)
+      {
+        return memory_pool_allocated<allocator_type>::free_n (reinterpret_cast<void* const *> (blocks), n);
+      }
+
     // ========================================================================
 
     /**
@@ -1334,6 +1556,42 @@ namespace os
         internal_construct_ (blocks, sizeof(T), attr, &arena_, sizeof(arena_));
       }
 
+#if !defined(OS_USE_RTOS_PORT_MEMORY_POOL)
+
+    /**
+     * @details
+     * Static instances are fully initialised by the compiler,
+     * so no constructor runs from the init array and the pool
+     * can be used regardless of the static constructors order.
+     * The free list is not built, the zero filled arena is
+     * already a list of all blocks.
+     *
+     * The pool uses the default attributes (`sysclock`,
+     * not lock-free).
+     *
+     * @note Since the object has non-zero members, the compiler
+     * places it in `.data`, with the arena; for large pools
+     * this also adds the arena size to the flash image.
+     */
+    template<typename T, std::size_t N>
+      constexpr
+      memory_pool_inclusive<T, N>::memory_pool_inclusive (constant_init_t tag,
+                                                          const char* name) :
+          memory_pool
+            { tag, name, blocks, sizeof(T), &arena_, sizeof(arena_) }, //
+          arena_
+            { }
+      {
+        // Same as compute_allocated_size_bytes<void*>(), which
+        // is not usable here.
+        static_assert(
+            sizeof(arena_)
+                >= N * ((sizeof(T) + sizeof(void*) - 1) & ~(sizeof(void*) - 1)),
+            "The arena must fit the aligned blocks");
+      }
+
+#endif /* !defined(OS_USE_RTOS_PORT_MEMORY_POOL) */
+
     /**
      * @details
      * This destructor shall destroy the memory pool object; the object
@@ -1409,6 +1667,48 @@ namespace os
         return memory_pool::free (block);
       }
 
+    /**
+     * @details
+     * Wrapper over the parent method, automatically
+     * passing the cast.
+     *
+     * @see memory_pool::alloc_n().
+     */
+    template<typename T, std::size_t N>
+      inline std::size_t
+      memory_pool_inclusive<T, N>::alloc_n (value_type** blocks, std::size_t n)
+      {
+        return memory_pool::alloc_n (reinterpret_cast<void**> (blocks), n);
+      }
+
+    /**
+     * @details
+     * Wrapper over the parent method, automatically
+     * passing the cast.
+     *
+     * @see memory_pool::try_alloc_n().
+     */
+    template<typename T, std::size_t N>
+      inline std::size_t
+      memory_pool_inclusive<T, N>::try_alloc_n (value_type** blocks, std::size_t n)
+      {
+        return memory_pool::try_alloc_n (reinterpret_cast<void**> (blocks), n);
+      }
+
+    /**
+     * @details
+     * Wrapper over the parent method, automatically
+     * passing the cast.
+     *
+     * @see memory_pool::free_n().
+     */
+    template<typename T, std::size_t N>
+      inline result_t
+      memory_pool_inclusive<T, N>::free_n (value_type* const * blocks, std::size_t n)
+      {
+        return memory_pool::free_n (reinterpret_cast<void* const *> (blocks), n);
+      }
+
   } /* namespace rtos */
 } /* namespace os */
 
@@ -37,6 +37,8 @@
 
 #include <cmsis-plus/diag/trace.h>
 
+#include <type_traits>
+
 // ----------------------------------------------------------------------------
 
 namespace os
@@ -132,6 +134,12 @@ namespace os
        */
       static constexpr priority_t max_priority = 0xFF;
 
+      /**
+       * @brief Number of words in the map of used priority levels.
+       * @ingroup cmsis-plus-rtos-mqueue
+       */
+      static constexpr std::size_t levels_map_words = (max_priority + 1) / 32;
+
       // ======================================================================
 
       /**
@@ -192,6 +200,11 @@ namespace os
          */
         std::size_t mq_queue_size_bytes = 0;
 
+        /**
+         * @brief Keep a tail per priority level, to insert in constant time.
+         */
+        bool mq_priority_levels = false;
+
         // Add more attributes here.
 
         /**
@@ -229,17 +242,40 @@ namespace os
           T prios[(msgs * sizeof(priority_t) + sizeof(T) - 1) / sizeof(T)];
         };
 
+      /**
+       * @brief Storage for a static message queue, with typed arrays.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       * @details
+       * The size is the one returned by `compute_allocated_size_bytes()`;
+       * the typed arrays of indices and priorities can be referred
+       * by the constant initialised constructors.
+       */
+      template<std::size_t msgs, std::size_t msg_size_bytes>
+        class arena_typed
+        {
+        public:
+          void* queue[msgs
+              * ((msg_size_bytes + sizeof(void*) - 1) / sizeof(void*))];
+          index_t links[((2 * msgs * sizeof(index_t) + sizeof(void*) - 1)
+              & ~(sizeof(void*) - 1)) / sizeof(index_t)];
+          priority_t prios[((msgs * sizeof(priority_t) + sizeof(void*) - 1)
+              & ~(sizeof(void*) - 1)) / sizeof(priority_t)];
+        };
+
       /**
        * @brief Calculator for queue storage requirements.
        * @param msgs Number of messages.
        * @param msg_size_bytes Size of message.
+       * @param priority_levels Add the per priority levels tables
+       * (`attr.mq_priority_levels`).
        * @return Total required storage in bytes, including
        * internal alignment.
        */
       template<typename T>
         constexpr std::size_t
         compute_allocated_size_bytes (std::size_t msgs,
-                                      std::size_t msg_size_bytes)
+                                      std::size_t msg_size_bytes,
+                                      bool priority_levels = false)
         {
           // Align each message
           return (msgs * ((msg_size_bytes + (sizeof(T) - 1)) & ~(sizeof(T) - 1)))
@@ -248,7 +284,13 @@ namespace os
                   & ~(sizeof(T) - 1))
               // Align the priority array
               + ((msgs * sizeof(priority_t) + (sizeof(T) - 1))
-                  & ~(sizeof(T) - 1));
+                  & ~(sizeof(T) - 1))
+              // Align the levels map and the array of tails
+              + (priority_levels ?
+                  ((levels_map_words * sizeof(uint32_t)
+                      + (max_priority + 1) * sizeof(index_t) + (sizeof(T) - 1))
+                      & ~(sizeof(T) - 1)) :
+                  0);
         }
 
       // ======================================================================
@@ -294,6 +336,14 @@ namespace os
       message_queue ();
       message_queue (const char* name);
 
+#if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+      constexpr
+      message_queue (constant_init_t tag, const char* name, std::size_t msgs,
+                     std::size_t msg_size_bytes, void* queue_address,
+                     std::size_t queue_size_bytes, index_t* links,
+                     priority_t* prios);
+#endif /* !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE) */
+
       /**
        * @endcond
        */
@@ -476,8 +526,164 @@ namespace os
       timed_receive (void* msg, std::size_t nbytes, clock::duration_t timeout,
                      priority_t* mprio = nullptr);
 
+      /**
+       * @brief Receive a message from the queue until an absolute time.
+       * @param [out] msg The address where to store the dequeued message.
+       * @param [in] nbytes The size of the destination buffer. Must
+       *  be lower/equal to the value of the message size attribute.
+       * @param [in] timestamp The deadline, in steady clock units.
+       * @param [out] mprio The address where to store the message
+       *  priority. The default is `nullptr`.
+       * @retval result::ok The message was received.
+       * @retval EINVAL A parameter is invalid or outside of a permitted range.
+       * @retval EMSGSIZE The specified message length, nbytes, is
+       *  greater than the message size attribute of the message queue.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINTR The operation was interrupted.
+       * @retval ETIMEDOUT No message arrived on the queue before the
+       *  deadline.
+       */
+      result_t
+      timed_receive_until (void* msg, std::size_t nbytes,
+                           clock::timestamp_t timestamp,
+                           priority_t* mprio = nullptr);
+
       // TODO: check if some kind of peek() is useful.
 
+#if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+
+      /**
+       * @brief Send an array of messages to the queue.
+       * @param [in] msgs The address of the first message to enqueue.
+       * @param [in] nbytes The length of each message. Must be not
+       *  higher than the value used when creating the queue.
+       * @param [in] count The number of messages.
+       * @param [in] mprio The messages priority. The default is 0.
+       * @param [out] sent The address where to store the number
+       *  of messages enqueued. The default is `nullptr`.
+       * @retval result::ok All messages were enqueued.
+       * @retval EINVAL A parameter is invalid or outside of a permitted range.
+       * @retval EMSGSIZE The specified message length, nbytes,
+       *  exceeds the message size attribute of the message queue.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINTR The operation was interrupted.
+       */
+      result_t
+      send_n (const void* msgs, std::size_t nbytes, std::size_t count,
+              priority_t mprio = default_priority, std::size_t* sent = nullptr);
+
+      /**
+       * @brief Try to receive an array of messages from the queue.
+       * @param [out] msgs The address where to store the dequeued messages.
+       * @param [in] nbytes The size of each destination buffer. Must
+       *  be lower than the value used when creating the queue.
+       * @param [in] count The max number of messages.
+       * @param [out] received The address where to store the number
+       *  of messages dequeued.
+       * @param [out] mprios The address of an array where to store
+       *  the messages priorities. The default is `nullptr`.
+       * @retval result::ok At least one message was received.
+       * @retval EINVAL A parameter is invalid or outside of a permitted range.
+       * @retval EMSGSIZE The specified message length, nbytes, is
+       *  greater than the message size attribute of the message queue.
+       * @retval EWOULDBLOCK The specified message queue is empty.
+       */
+      result_t
+      try_receive_n (void* msgs, std::size_t nbytes, std::size_t count,
+                     std::size_t* received, priority_t* mprios = nullptr);
+
+      /**
+       * @brief Receive an array of messages from the queue with timeout.
+       * @param [out] msgs The address where to store the dequeued messages.
+       * @param [in] nbytes The size of each destination buffer. Must
+       *  be lower than the value used when creating the queue.
+       * @param [in] count The max number of messages.
+       * @param [in] timeout The timeout duration.
+       * @param [out] received The address where to store the number
+       *  of messages dequeued.
+       * @param [out] mprios The address of an array where to store
+       *  the messages priorities. The default is `nullptr`.
+       * @retval result::ok At least one message was received.
+       * @retval EINVAL A parameter is invalid or outside of a permitted range.
+       * @retval EMSGSIZE The specified message length, nbytes, is
+       *  greater than the message size attribute of the message queue.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINTR The operation was interrupted.
+       * @retval ETIMEDOUT No message arrived on the queue before the
+       *  specified timeout expired.
+       */
+      result_t
+      timed_receive_n (void* msgs, std::size_t nbytes, std::size_t count,
+                       clock::duration_t timeout, std::size_t* received,
+                       priority_t* mprios = nullptr);
+
+      /**
+       * @brief Reserve a message slot, blocking if none is free.
+       * @param [out] buf The address where to store the slot address.
+       * @retval result::ok A slot was reserved.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINVAL A parameter is invalid or outside of a permitted range.
+       * @retval EINTR The operation was interrupted.
+       */
+      result_t
+      reserve (void** buf);
+
+      /**
+       * @brief Try to reserve a message slot.
+       * @param [out] buf The address where to store the slot address.
+       * @retval result::ok A slot was reserved.
+       * @retval EINVAL A parameter is invalid or outside of a permitted range.
+       * @retval EWOULDBLOCK There are no free slots.
+       */
+      result_t
+      try_reserve (void** buf);
+
+      /**
+       * @brief Enqueue a reserved message slot, without copying.
+       * @param [in] buf The address of the slot returned by `reserve()`.
+       * @param [in] mprio The message priority. The default is 0.
+       * @retval result::ok The message was enqueued.
+       * @retval EINVAL The address is not a message slot.
+       */
+      result_t
+      commit (void* buf, priority_t mprio = default_priority);
+
+      /**
+       * @brief Dequeue a message in place, blocking if the queue is empty.
+       * @param [out] buf The address where to store the slot address.
+       * @param [out] mprio The address where to store the message
+       *  priority. The default is `nullptr`.
+       * @retval result::ok A message was dequeued.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINVAL A parameter is invalid or outside of a permitted range.
+       * @retval EINTR The operation was interrupted.
+       */
+      result_t
+      borrow (void** buf, priority_t* mprio = nullptr);
+
+      /**
+       * @brief Try to dequeue a message in place.
+       * @param [out] buf The address where to store the slot address.
+       * @param [out] mprio The address where to store the message
+       *  priority. The default is `nullptr`.
+       * @retval result::ok A message was dequeued.
+       * @retval EINVAL A parameter is invalid or outside of a permitted range.
+       * @retval EWOULDBLOCK The queue is empty.
+       */
+      result_t
+      try_borrow (void** buf, priority_t* mprio = nullptr);
+
+      /**
+       * @brief Return a borrowed or reserved message slot to the queue.
+       * @param [in] buf The address of the slot.
+       * @retval result::ok The slot was released.
+       * @retval EINVAL The address is not a message slot.
+       */
+      result_t
+      release (void* buf);
+
+#endif /* !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE) */
+
       /**
        * @brief Get queue capacity.
        * @par Parameters
@@ -575,8 +781,126 @@ namespace os
       void
       internal_init_ (void);
 
+      /**
+       * @brief Internal function used to check if the typed
+       *  fast paths can be used for a message type.
+       * @tparam T Type of the message.
+       * @retval true The message is small and trivially copyable.
+       * @retval false The generic functions must be used.
+       */
+      template<typename T>
+        static constexpr bool
+        internal_is_typed_fast_ (void);
+
 #if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
 
+      /**
+       * @brief Internal function used to get a free message slot.
+       * @par Parameters
+       *  None.
+       * @return The address of the slot, or `nullptr` if the queue is full.
+       */
+      void*
+      internal_try_reserve_ (void);
+
+      /**
+       * @brief Internal function used to link a slot in the queue.
+       * @param [in] buf The address of the slot.
+       * @param [in] mprio The message priority.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_commit_ (void* buf, priority_t mprio);
+
+      /**
+       * @brief Internal function used to unlink the head message.
+       * @param [out] mprio The address where to store the message
+       *  priority, or `nullptr`.
+       * @return The address of the slot, or `nullptr` if the queue is empty.
+       */
+      void*
+      internal_try_borrow_ (priority_t* mprio);
+
+      /**
+       * @brief Internal function used to return a slot to the free list.
+       * @param [in] buf The address of the slot.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_release_ (void* buf);
+
+      /**
+       * @brief Internal function used to check the interrupt priority.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      static void
+      internal_assert_priority_ (void);
+
+      /**
+       * @brief Internal function used to enqueue a small typed message.
+       * @tparam T Type of the message.
+       * @param [in] msg The address of the message to enqueue.
+       * @param [in] mprio The message priority.
+       * @retval true The message was enqueued.
+       * @retval false The message queue is full.
+       */
+      template<typename T>
+        bool
+        internal_try_send_typed_ (const T* msg, priority_t mprio);
+
+      /**
+       * @brief Internal function used to dequeue a small typed message.
+       * @tparam T Type of the message.
+       * @param [out] msg The address where to store the dequeued message.
+       * @param [out] mprio The address where to store the message
+       *  priority, or `nullptr`.
+       * @retval true The message was dequeued.
+       * @retval false There are not messages in the queue.
+       */
+      template<typename T>
+        bool
+        internal_try_receive_typed_ (T* msg, priority_t* mprio);
+
+      /**
+       * @brief Internal function used to get the next free slot.
+       * @param [in] buf The address of a free slot.
+       * @return The address of the next free slot, or `nullptr`.
+       */
+      void*
+      internal_next_free_ (void* buf) const;
+
+      /**
+       * @brief Internal function used to validate a slot address.
+       * @param [in] buf The address to check.
+       * @retval true The address is the beginning of a message slot.
+       * @retval false The address is outside the queue storage.
+       */
+      bool
+      internal_is_slot_ (const void* buf) const;
+
+      /**
+       * @brief Internal function used to find a used priority level.
+       * @param [in] mprio The lowest priority level to check.
+       * @return The lowest used level not lower than _mprio_,
+       *  or a value higher than `max_priority` if there is none.
+       */
+      std::size_t
+      internal_find_level_ (priority_t mprio) const;
+
+      /**
+       * @brief Internal function used to get the array of level tails.
+       * @par Parameters
+       *  None.
+       * @return Pointer to the array following the levels map.
+       */
+      volatile index_t*
+      internal_levels_tail_array_ (void) const;
+
       /**
        * @brief Internal function used to enqueue a message, if possible.
        * @param [in] msg The address of the message to enqueue.
@@ -603,6 +927,31 @@ namespace os
       bool
       internal_try_receive_ (void* msg, std::size_t nbytes, priority_t* mprio);
 
+      /**
+       * @brief Internal function used to enqueue an array of messages.
+       * @param [in] msgs The address of the first message to enqueue.
+       * @param [in] nbytes The length of each message.
+       * @param [in] count The number of messages.
+       * @param [in] mprio The messages priority.
+       * @return The number of messages enqueued.
+       */
+      std::size_t
+      internal_try_send_n_ (const void* msgs, std::size_t nbytes,
+                            std::size_t count, priority_t mprio);
+
+      /**
+       * @brief Internal function used to dequeue an array of messages.
+       * @param [out] msgs The address where to store the dequeued messages.
+       * @param [in] nbytes The size of each destination buffer.
+       * @param [in] count The max number of messages.
+       * @param [out] mprios The address of an array where to store
+       *  the messages priorities, or `nullptr`.
+       * @return The number of messages dequeued.
+       */
+      std::size_t
+      internal_try_receive_n_ (void* msgs, std::size_t nbytes,
+                               std::size_t count, priority_t* mprios);
+
 #endif /* !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE) */
 
       /**
@@ -653,6 +1002,14 @@ namespace os
        * @brief Pointer to array of priorities.
        */
       volatile priority_t* prio_array_ = nullptr;
+      /**
+       * @brief Pointer to the map of used priority levels, or `nullptr`.
+       * @details
+       * The map is followed by the array with the indices of the
+       * last message of each priority level
+       * (only with `attr.mq_priority_levels`).
+       */
+      volatile uint32_t* levels_map_ = nullptr;
 
       /**
        * @brief Pointer to the first free message, or `nullptr`.
@@ -681,6 +1038,12 @@ namespace os
        */
       const void* allocator_ = nullptr;
 
+#if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+      // Links its nodes to the waiting lists.
+      friend class wait_set;
+      friend class co::awaiter;
+#endif
+
 #if defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
       friend class port::message_queue;
       os_mqueue_port_data_t port_;
@@ -1011,6 +1374,65 @@ namespace os
         timed_receive (value_type* msg, clock::duration_t timeout,
                        message_queue::priority_t* mprio = nullptr);
 
+#if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+
+        /**
+         * @brief Send an array of typed messages to the queue.
+         * @param [in] msgs The address of the first message to enqueue.
+         * @param [in] count The number of messages.
+         * @param [in] mprio The messages priority. The default is 0.
+         * @param [out] sent The address where to store the number
+         *  of messages enqueued. The default is `nullptr`.
+         * @retval result::ok All messages were enqueued.
+         * @retval EINVAL A parameter is invalid or outside of a permitted range.
+         * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+         * @retval EINTR The operation was interrupted.
+         */
+        result_t
+        send_n (const value_type* msgs, std::size_t count,
+                message_queue::priority_t mprio = message_queue::default_priority,
+                std::size_t* sent = nullptr);
+
+        /**
+         * @brief Try to receive an array of typed messages from the queue.
+         * @param [out] msgs The address where to store the dequeued messages.
+         * @param [in] count The max number of messages.
+         * @param [out] received The address where to store the number
+         *  of messages dequeued.
+         * @param [out] mprios The address of an array where to store
+         *  the messages priorities. The default is `nullptr`.
+         * @retval result::ok At least one message was received.
+         * @retval EINVAL A parameter is invalid or outside of a permitted range.
+         * @retval EWOULDBLOCK The specified message queue is empty.
+         */
+        result_t
+        try_receive_n (value_type* msgs, std::size_t count,
+                       std::size_t* received, message_queue::priority_t* mprios = nullptr);
+
+        /**
+         * @brief Receive an array of typed messages from the queue
+         *  with timeout.
+         * @param [out] msgs The address where to store the dequeued messages.
+         * @param [in] count The max number of messages.
+         * @param [in] timeout The timeout duration.
+         * @param [out] received The address where to store the number
+         *  of messages dequeued.
+         * @param [out] mprios The address of an array where to store
+         *  the messages priorities. The default is `nullptr`.
+         * @retval result::ok At least one message was received.
+         * @retval EINVAL A parameter is invalid or outside of a permitted range.
+         * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+         * @retval EINTR The operation was interrupted.
+         * @retval ETIMEDOUT No message arrived on the queue before the
+         *  specified timeout expired.
+         */
+        result_t
+        timed_receive_n (value_type* msgs, std::size_t count,
+                         clock::duration_t timeout, std::size_t* received,
+                         message_queue::priority_t* mprios = nullptr);
+
+#endif /* !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE) */
+
         /**
          * @}
          */
@@ -1059,6 +1481,19 @@ namespace os
         message_queue_inclusive (const char* name, const attributes& attr =
                                      initializer);
 
+#if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+
+        /**
+         * @brief Construct a message queue object instance at compile time.
+         * @param [in] tag The constant initialisation tag.
+         * @param [in] name Pointer to name.
+         */
+        constexpr
+        message_queue_inclusive (constant_init_t tag, const char* name =
+                                     nullptr);
+
+#endif /* !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE) */
+
         /**
          * @cond ignore
          */
@@ -1205,6 +1640,65 @@ namespace os
         timed_receive (value_type* msg, clock::duration_t timeout,
                        priority_t* mprio = nullptr);
 
+#if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+
+        /**
+         * @brief Send an array of typed messages to the queue.
+         * @param [in] msgs The address of the first message to enqueue.
+         * @param [in] count The number of messages.
+         * @param [in] mprio The messages priority. The default is 0.
+         * @param [out] sent The address where to store the number
+         *  of messages enqueued. The default is `nullptr`.
+         * @retval result::ok All messages were enqueued.
+         * @retval EINVAL A parameter is invalid or outside of a permitted range.
+         * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+         * @retval EINTR The operation was interrupted.
+         */
+        result_t
+        send_n (const value_type* msgs, std::size_t count,
+                priority_t mprio = default_priority,
+                std::size_t* sent = nullptr);
+
+        /**
+         * @brief Try to receive an array of typed messages from the queue.
+         * @param [out] msgs The address where to store the dequeued messages.
+         * @param [in] count The max number of messages.
+         * @param [out] received The address where to store the number
+         *  of messages dequeued.
+         * @param [out] mprios The address of an array where to store
+         *  the messages priorities. The default is `nullptr`.
+         * @retval result::ok At least one message was received.
+         * @retval EINVAL A parameter is invalid or outside of a permitted range.
+         * @retval EWOULDBLOCK The specified message queue is empty.
+         */
+        result_t
+        try_receive_n (value_type* msgs, std::size_t count,
+                       std::size_t* received, priority_t* mprios = nullptr);
+
+        /**
+         * @brief Receive an array of typed messages from the queue
+         *  with timeout.
+         * @param [out] msgs The address where to store the dequeued messages.
+         * @param [in] count The max number of messages.
+         * @param [in] timeout The timeout duration.
+         * @param [out] received The address where to store the number
+         *  of messages dequeued.
+         * @param [out] mprios The address of an array where to store
+         *  the messages priorities. The default is `nullptr`.
+         * @retval result::ok At least one message was received.
+         * @retval EINVAL A parameter is invalid or outside of a permitted range.
+         * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+         * @retval EINTR The operation was interrupted.
+         * @retval ETIMEDOUT No message arrived on the queue before the
+         *  specified timeout expired.
+         */
+        result_t
+        timed_receive_n (value_type* msgs, std::size_t count,
+                         clock::duration_t timeout, std::size_t* received,
+                         priority_t* mprios = nullptr);
+
+#endif /* !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE) */
+
         /**
          * @}
          */
@@ -1229,7 +1723,7 @@ namespace os
          * For performance reasons, the individual components are
          * aligned as pointers.
          */
-        arena<void*, msgs, sizeof(value_type)> arena_;
+        arena_typed<msgs, sizeof(value_type)> arena_;
 
         /**
          * @endcond
@@ -1261,6 +1755,50 @@ namespace os
 
     // ========================================================================
 
+#if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+
+    /**
+     * @cond ignore
+     */
+
+    /*
+     * The free list is not built; the zero filled storage is
+     * already a list of all slots (see `internal_next_free_()`).
+     * The clock is the `sysclock`.
+     */
+    constexpr
+    message_queue::message_queue (constant_init_t tag, const char* name,
+                                  std::size_t msgs, std::size_t msg_size_bytes,
+                                  void* queue_address,
+                                  std::size_t queue_size_bytes, index_t* links,
+                                  priority_t* prios) :
+        object_named_system
+          { name }, //
+        send_list_
+          { tag }, //
+        receive_list_
+          { tag }, //
+        clock_ (&sysclock), //
+        prev_array_ (links), //
+        next_array_ (links + msgs), //
+        prio_array_ (prios), //
+        first_free_ (queue_address), //
+        queue_addr_ (queue_address), //
+        queue_size_bytes_ (queue_size_bytes), //
+        msg_size_bytes_ (
+            static_cast<message_queue::msg_size_t> (msg_size_bytes)), //
+        msgs_ (static_cast<message_queue::size_t> (msgs)), //
+        head_ (no_index)
+    {
+      ;
+    }
+
+    /**
+     * @endcond
+     */
+
+#endif /* !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE) */
+
     /**
      * @details
      * Identical message queues should have the same memory address.
@@ -1339,6 +1877,111 @@ namespace os
       return (length () == capacity ());
     }
 
+    /**
+     * @details
+     * Messages up to a few words, which can be copied as plain
+     * memory, are sent and received by the typed queues with
+     * a copy of known size, expanded inline, without the generic
+     * run-time size checks. With the port implementation or
+     * with trace, the generic functions are always used.
+     */
+    template<typename T>
+      constexpr bool
+      message_queue::internal_is_typed_fast_ (void)
+      {
+#if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE) \
+  && !defined(OS_INCLUDE_RTOS_TRACE_EVENTS) && !defined(OS_TRACE_RTOS_MQUEUE)
+        return std::is_trivially_copyable<T>::value
+            && (sizeof(T) <= 4 * sizeof(void*));
+#else
+        return false;
+#endif
+      }
+
+#if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+
+    inline volatile message_queue::index_t*
+    message_queue::internal_levels_tail_array_ (void) const
+    {
+      return reinterpret_cast<volatile index_t*> (levels_map_
+          + levels_map_words);
+    }
+
+    /**
+     * @details
+     * Same as the generic `internal_try_send_()`, but the message
+     * size is known at compile time, and it is copied inside the
+     * critical section.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    template<typename T>
+      inline bool
+      message_queue::internal_try_send_typed_ (const T* msg, priority_t mprio)
+      {
+        // Don't call this from high priority interrupts.
+        internal_assert_priority_ ();
+
+          {
+            // ----- Enter critical section -----------------------------------
+            interrupts::critical_section ics;
+
+            void* dest = internal_try_reserve_ ();
+            if (dest == nullptr)
+              {
+                // No available space to send the message.
+                return false;
+              }
+
+            std::memcpy (dest, msg, sizeof(T));
+            internal_commit_ (dest, mprio);
+
+            // Wake-up one thread, if any.
+            receive_list_.resume_one ();
+            // ----- Exit critical section ------------------------------------
+          }
+
+        return true;
+      }
+
+    /**
+     * @details
+     * Same as the generic `internal_try_receive_()`, but the message
+     * size is known at compile time, and it is copied inside the
+     * critical section.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    template<typename T>
+      inline bool
+      message_queue::internal_try_receive_typed_ (T* msg, priority_t* mprio)
+      {
+        // Don't call this from high priority interrupts.
+        internal_assert_priority_ ();
+
+          {
+            // ----- Enter critical section -----------------------------------
+            interrupts::critical_section ics;
+
+            void* src = internal_try_borrow_ (mprio);
+            if (src == nullptr)
+              {
+                return false;
+              }
+
+            std::memcpy (msg, src, sizeof(T));
+            internal_release_ (src);
+
+            // Wake-up one thread, if any.
+            send_list_.resume_one ();
+            // ----- Exit critical section ------------------------------------
+          }
+
+        return true;
+      }
+
+#endif /* !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE) */
+
     // ========================================================================
 
     /**
@@ -1412,8 +2055,8 @@ namespace os
             { name }
       {
 #if defined(OS_TRACE_RTOS_MQUEUE)
-        trace::printf ("%s() @%p %s %d %d\n", __func__, this, this->name (),
-                       msgs, msg_size_bytes);
+        OS_TRACE_PRINTF (rtos_mqueue, "%s() @%p %s %d %d\n", __func__, this,
+                         this->name (), msgs, msg_size_bytes);
 #endif
 
         if (attr.mq_queue_address != nullptr)
@@ -1428,7 +2071,8 @@ namespace os
             // If no user storage was provided via attributes,
             // allocate it dynamically via the allocator.
             allocated_queue_size_elements_ = (compute_allocated_size_bytes<
-                typename allocator_type::value_type> (msgs, msg_size_bytes)
+                typename allocator_type::value_type> (msgs, msg_size_bytes,
+                                                      attr.mq_priority_levels)
                 + sizeof(typename allocator_type::value_type) - 1)
                 / sizeof(typename allocator_type::value_type);
 
@@ -1464,7 +2108,7 @@ namespace os
       message_queue_allocated<Allocator>::~message_queue_allocated ()
       {
 #if defined(OS_TRACE_RTOS_MQUEUE)
-        trace::printf ("%s() @%p %s\n", __func__, this, name ());
+        OS_TRACE_PRINTF (rtos_mqueue, "%s() @%p %s\n", __func__, this, name ());
 #endif
         typedef typename std::allocator_traits<allocator_type>::pointer pointer;
 
@@ -1595,6 +2239,17 @@ namespace os
       message_queue_typed<T, Allocator>::send (const value_type* msg,
                                                message_queue::priority_t mprio)
       {
+#if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+        // Fast path, if there is space in the queue.
+        if (message_queue::internal_is_typed_fast_<value_type> ()
+            && (msg != nullptr) && !interrupts::in_handler_mode ()
+            && !scheduler::locked ()
+            && this->internal_try_send_typed_ (msg, mprio))
+          {
+            return result::ok;
+          }
+#endif /* !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE) */
+
         return message_queue_allocated<allocator_type>::send (
             reinterpret_cast<const char*> (msg), sizeof(value_type), mprio);
       }
@@ -1611,6 +2266,19 @@ namespace os
       message_queue_typed<T, Allocator>::try_send (
           const value_type* msg, message_queue::priority_t mprio)
       {
+#if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+        if (message_queue::internal_is_typed_fast_<value_type> ())
+          {
+            os_assert_err(msg != nullptr, EINVAL);
+
+            if (this->internal_try_send_typed_ (msg, mprio))
+              {
+                return result::ok;
+              }
+            return EWOULDBLOCK;
+          }
+#endif /* !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE) */
+
         return message_queue_allocated<allocator_type>::try_send (
             reinterpret_cast<const char*> (msg), sizeof(value_type), mprio);
       }
@@ -1628,6 +2296,17 @@ namespace os
           const value_type* msg, clock::duration_t timeout,
           message_queue::priority_t mprio)
       {
+#if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+        // Fast path, if there is space in the queue.
+        if (message_queue::internal_is_typed_fast_<value_type> ()
+            && (msg != nullptr) && !interrupts::in_handler_mode ()
+            && !scheduler::locked ()
+            && this->internal_try_send_typed_ (msg, mprio))
+          {
+            return result::ok;
+          }
+#endif /* !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE) */
+
         return message_queue_allocated<allocator_type>::timed_send (
             reinterpret_cast<const char*> (msg), sizeof(value_type), timeout,
             mprio);
@@ -1645,6 +2324,17 @@ namespace os
       message_queue_typed<T, Allocator>::receive (
           value_type* msg, message_queue::priority_t* mprio)
       {
+#if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+        // Fast path, if there are messages in the queue.
+        if (message_queue::internal_is_typed_fast_<value_type> ()
+            && (msg != nullptr) && !interrupts::in_handler_mode ()
+            && !scheduler::locked ()
+            && this->internal_try_receive_typed_ (msg, mprio))
+          {
+            return result::ok;
+          }
+#endif /* !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE) */
+
         return message_queue_allocated<allocator_type>::receive (
             reinterpret_cast<char*> (msg), sizeof(value_type), mprio);
       }
@@ -1661,6 +2351,19 @@ namespace os
       message_queue_typed<T, Allocator>::try_receive (
           value_type* msg, message_queue::priority_t* mprio)
       {
+#if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+        if (message_queue::internal_is_typed_fast_<value_type> ())
+          {
+            os_assert_err(msg != nullptr, EINVAL);
+
+            if (this->internal_try_receive_typed_ (msg, mprio))
+              {
+                return result::ok;
+              }
+            return EWOULDBLOCK;
+          }
+#endif /* !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE) */
+
         return message_queue_allocated<allocator_type>::try_receive (
             reinterpret_cast<char*> (msg), sizeof(value_type), mprio);
       }
@@ -1678,10 +2381,79 @@ namespace os
           value_type* msg, clock::duration_t timeout,
           message_queue::priority_t* mprio)
       {
+#if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+        // Fast path, if there are messages in the queue.
+        if (message_queue::internal_is_typed_fast_<value_type> ()
+            && (msg != nullptr) && !interrupts::in_handler_mode ()
+            && !scheduler::locked ()
+            && this->internal_try_receive_typed_ (msg, mprio))
+          {
+            return result::ok;
+          }
+#endif /* !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE) */
+
         return message_queue_allocated<allocator_type>::timed_receive (
             reinterpret_cast<char*> (msg), sizeof(value_type), timeout, mprio);
       }
 
+#if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+
+    /**
+     * @details
+     * Wrapper over the parent method, automatically
+     * passing the message size.
+     *
+     * @see message_queue::send_n().
+     */
+    template<typename T, typename Allocator>
+      inline result_t
+      message_queue_typed<T, Allocator>::send_n (
+          const value_type* msgs, std::size_t count,
+          message_queue::priority_t mprio, std::size_t* sent)
+      {
+        return message_queue_allocated<allocator_type>::send_n (
+            reinterpret_cast<const char*> (msgs), sizeof(value_type), count,
+            mprio, sent);
+      }
+
+    /**
+     * @details
+     * Wrapper over the parent method, automatically
+     * passing the message size.
+     *
+     * @see message_queue::try_receive_n().
+     */
+    template<typename T, typename Allocator>
+      inline result_t
+      message_queue_typed<T, Allocator>::try_receive_n (
+          value_type* msgs, std::size_t count, std::size_t* received,
+          message_queue::priority_t* mprios)
+      {
+        return message_queue_allocated<allocator_type>::try_receive_n (
+            reinterpret_cast<char*> (msgs), sizeof(value_type), count,
+            received, mprios);
+      }
+
+    /**
+     * @details
+     * Wrapper over the parent method, automatically
+     * passing the message size.
+     *
+     * @see message_queue::timed_receive_n().
+     */
+    template<typename T, typename Allocator>
+      inline result_t
+      message_queue_typed<T, Allocator>::timed_receive_n (
+          value_type* msgs, std::size_t count, clock::duration_t timeout,
+          std::size_t* received, message_queue::priority_t* mprios)
+      {
+        return message_queue_allocated<allocator_type>::timed_receive_n (
+            reinterpret_cast<char*> (msgs), sizeof(value_type), count,
+            timeout, received, mprios);
+      }
+
+#endif /* !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE) */
+
     // ========================================================================
 
     /**
@@ -1773,6 +2545,37 @@ namespace os
                              sizeof(arena_));
       }
 
+#if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+
+    /**
+     * @details
+     * Static instances are fully initialised by the compiler,
+     * so no constructor runs from the init array and the queue
+     * can be used regardless of the static constructors order.
+     * The free list is not built, the zero filled arena is
+     * already a list of all slots.
+     *
+     * The queue uses the default attributes (`sysclock`).
+     *
+     * @note Since the object has non-zero members, the compiler
+     * places it in `.data`, with the arena; for large queues
+     * this also adds the arena size to the flash image.
+     */
+    template<typename T, std::size_t N>
+      constexpr
+      message_queue_inclusive<T, N>::message_queue_inclusive (
+          constant_init_t tag, const char* name) :
+          message_queue
+            { tag, name, msgs, sizeof(value_type), &arena_, sizeof(arena_),
+                arena_.links, arena_.prios }, //
+          arena_
+            { }
+      {
+        static_assert(sizeof(T) >= sizeof(void*), "Messages of message_queue need to have at least the size of a pointer");
+      }
+
+#endif /* !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE) */
+
     /**
      * @details
      * This destructor shall destroy the message queue object; the object
@@ -1804,6 +2607,17 @@ namespace os
       message_queue_inclusive<T, N>::send (const value_type* msg,
                                            priority_t mprio)
       {
+#if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+        // Fast path, if there is space in the queue.
+        if (message_queue::internal_is_typed_fast_<value_type> ()
+            && (msg != nullptr) && !interrupts::in_handler_mode ()
+            && !scheduler::locked ()
+            && this->internal_try_send_typed_ (msg, mprio))
+          {
+            return result::ok;
+          }
+#endif /* !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE) */
+
         return message_queue::send (reinterpret_cast<const char*> (msg),
                                     sizeof(value_type), mprio);
       }
@@ -1820,6 +2634,19 @@ namespace os
       message_queue_inclusive<T, N>::try_send (const value_type* msg,
                                                priority_t mprio)
       {
+#if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+        if (message_queue::internal_is_typed_fast_<value_type> ())
+          {
+            os_assert_err(msg != nullptr, EINVAL);
+
+            if (this->internal_try_send_typed_ (msg, mprio))
+              {
+                return result::ok;
+              }
+            return EWOULDBLOCK;
+          }
+#endif /* !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE) */
+
         return message_queue::try_send (reinterpret_cast<const char*> (msg),
                                         sizeof(value_type), mprio);
       }
@@ -1837,6 +2664,17 @@ namespace os
                                                  clock::duration_t timeout,
                                                  priority_t mprio)
       {
+#if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+        // Fast path, if there is space in the queue.
+        if (message_queue::internal_is_typed_fast_<value_type> ()
+            && (msg != nullptr) && !interrupts::in_handler_mode ()
+            && !scheduler::locked ()
+            && this->internal_try_send_typed_ (msg, mprio))
+          {
+            return result::ok;
+          }
+#endif /* !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE) */
+
         return message_queue::timed_send (reinterpret_cast<const char*> (msg),
                                           sizeof(value_type), timeout, mprio);
       }
@@ -1853,6 +2691,17 @@ namespace os
       message_queue_inclusive<T, N>::receive (value_type* msg,
                                               priority_t* mprio)
       {
+#if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+        // Fast path, if there are messages in the queue.
+        if (message_queue::internal_is_typed_fast_<value_type> ()
+            && (msg != nullptr) && !interrupts::in_handler_mode ()
+            && !scheduler::locked ()
+            && this->internal_try_receive_typed_ (msg, mprio))
+          {
+            return result::ok;
+          }
+#endif /* !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE) */
+
         return message_queue::receive (reinterpret_cast<char*> (msg),
                                        sizeof(value_type), mprio);
       }
@@ -1869,6 +2718,19 @@ namespace os
       message_queue_inclusive<T, N>::try_receive (value_type* msg,
                                                   priority_t* mprio)
       {
+#if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+        if (message_queue::internal_is_typed_fast_<value_type> ())
+          {
+            os_assert_err(msg != nullptr, EINVAL);
+
+            if (this->internal_try_receive_typed_ (msg, mprio))
+              {
+                return result::ok;
+              }
+            return EWOULDBLOCK;
+          }
+#endif /* !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE) */
+
         return message_queue::try_receive (reinterpret_cast<char*> (msg),
                                            sizeof(value_type), mprio);
       }
@@ -1886,10 +2748,79 @@ namespace os
                                                     clock::duration_t timeout,
                                                     priority_t* mprio)
       {
+#if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+        // Fast path, if there are messages in the queue.
+        if (message_queue::internal_is_typed_fast_<value_type> ()
+            && (msg != nullptr) && !interrupts::in_handler_mode ()
+            && !scheduler::locked ()
+            && this->internal_try_receive_typed_ (msg, mprio))
+          {
+            return result::ok;
+          }
+#endif /* !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE) */
+
         return message_queue::timed_receive (reinterpret_cast<char*> (msg),
                                              sizeof(value_type), timeout, mprio);
       }
 
+#if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+
+    /**
+     * @details
+     * Wrapper over the parent method, automatically
+     * passing the message size.
+     *
+     * @see message_queue::send_n().
+     */
+    template<typename T, std::size_t N>
+      inline result_t
+      message_queue_inclusive<T, N>::send_n (
+          const value_type* msgs, std::size_t count,
+          priority_t mprio, std::size_t* sent)
+      {
+        return message_queue::send_n (
+            reinterpret_cast<const char*> (msgs), sizeof(value_type), count,
+            mprio, sent);
+      }
+
+    /**
+     * @details
+     * Wrapper over the parent method, automatically
+     * passing the message size.
+     *
+     * @see message_queue::try_receive_n().
+     */
+    template<typename T, std::size_t N>
+      inline result_t
+      message_queue_inclusive<T, N>::try_receive_n (
+          value_type* msgs, std::size_t count, std::size_t* received,
+          priority_t* mprios)
+      {
+        return message_queue::try_receive_n (
+            reinterpret_cast<char*> (msgs), sizeof(value_type), count,
+            received, mprios);
+      }
+
+    /**
+     * @details
+     * Wrapper over the parent method, automatically
+     * passing the message size.
+     *
+     * @see message_queue::timed_receive_n().
+     */
+    template<typename T, std::size_t N>
+      inline result_t
+      message_queue_inclusive<T, N>::timed_receive_n (
+          value_type* msgs, std::size_t count, clock::duration_t timeout,
+          std::size_t* received, priority_t* mprios)
+      {
+        return message_queue::timed_receive_n (
+            reinterpret_cast<char*> (msgs), sizeof(value_type), count,
+            timeout, received, mprios);
+      }
+
+#endif /* !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE) */
+
   } /* namespace rtos */
 } /* namespace os */
 
@@ -38,6 +38,11 @@
 
 namespace os
 {
+  namespace estd
+  {
+    class mutex;
+  } /* namespace estd */
+
   namespace rtos
   {
     // ========================================================================
@@ -287,6 +292,17 @@ namespace os
          */
         count_t mx_max_count = max_count;
 
+#if defined(OS_INCLUDE_RTOS_SMP)
+        /**
+         * @brief Attribute with the adaptive spin limit,
+         *  in high resolution clock cycles.
+         * @details
+         * While the owner runs on another core, a contender spins
+         * up to this limit before blocking; zero blocks at once.
+         */
+        uint32_t mx_spin_cycles = 0;
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+
         // Add more attributes here.
 
         /**
@@ -368,6 +384,21 @@ namespace os
        */
       mutex (const char* name, const attributes& attr = initializer_normal);
 
+#if !defined(OS_USE_RTOS_PORT_MUTEX)
+
+      /**
+       * @brief Construct a mutex object instance at compile time.
+       * @param [in] tag The constant initialisation tag.
+       * @param [in] name Pointer to name.
+       * @param [in] attr Reference to constant attributes.
+       */
+      constexpr
+      mutex (constant_init_t tag, const char* name, const attributes& attr =
+                 attributes
+                   { });
+
+#endif /* !defined(OS_USE_RTOS_PORT_MUTEX) */
+
       /**
        * @cond ignore
        */
@@ -491,6 +522,26 @@ namespace os
       result_t
       timed_lock (clock::duration_t timeout);
 
+      /**
+       * @brief Try to lock/acquire the mutex until an absolute time.
+       * @param [in] timestamp The deadline, in steady clock units.
+       * @retval result::ok The mutex was locked.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval ETIMEDOUT The mutex could not be locked before the
+       *  deadline.
+       * @retval ENOTRECOVERABLE The state protected by the mutex
+       *  is not recoverable.
+       * @retval EAGAIN The mutex could not be acquired because the
+       *  maximum number of recursive locks for mutex has been exceeded.
+       * @retval EDEADLK The mutex type is `mutex::type::errorcheck`
+       *  and the current thread already owns the mutex.
+       * @retval EOWNERDEAD The mutex is a robust mutex and the process
+       *  containing the previous owning thread terminated while holding
+       *  the mutex lock.
+       */
+      result_t
+      timed_lock_until (clock::timestamp_t timestamp);
+
       /**
        * @brief Unlock/release the mutex.
        * @par Parameters
@@ -596,9 +647,45 @@ namespace os
        * @}
        */
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MUTEX_INHERIT)
+
+      /**
+       * @name Public Statistics Functions
+       * @{
+       */
+
+      /**
+       * @brief Get the longest priority inheritance chain.
+       * @par Parameters
+       *  None.
+       * @return The max number of owners boosted by a single lock.
+       */
+      static std::size_t
+      inherit_max_depth (void);
+
+      /**
+       * @brief Get the number of truncated inheritance chains.
+       * @par Parameters
+       *  None.
+       * @return The number of chains cut at
+       *  @ref OS_INTEGER_RTOS_MUTEX_INHERIT_MAX_DEPTH.
+       */
+      static rtos::statistics::counter_t
+      inherit_capped (void);
+
+      /**
+       * @}
+       */
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_MUTEX_INHERIT) */
+
     protected:
 
       friend class thread;
+      // Requeues the waiters on the mutex list in `broadcast()`.
+      friend class condition_variable;
+      // Uses the uncontended fast paths directly.
+      friend class os::estd::mutex;
 
       /**
        * @name Private Member Functions
@@ -637,6 +724,74 @@ namespace os
       void
       internal_mark_owner_dead_ (void);
 
+      /**
+       * @brief Internal function used to get the owner thread.
+       * @par Parameters
+       *  None.
+       * @return Pointer to thread or `nullptr` if not owned.
+       */
+      thread*
+      internal_owner_ (void) const;
+
+      /**
+       * @brief Internal function used to lock an uncontended mutex.
+       * @param th Pointer to thread.
+       * @retval true The mutex was locked.
+       * @retval false The slow path must be used.
+       */
+      bool
+      internal_try_lock_fast_ (thread* th);
+
+#if defined(OS_INCLUDE_RTOS_SMP)
+
+      /**
+       * @brief Internal function used to wait for a mutex held
+       *  by a thread running on another core.
+       * @par Parameters
+       *  None.
+       * @retval true The mutex was released, try to lock it.
+       * @retval false Spinning is useless, block.
+       */
+      bool
+      internal_spin_ (void);
+
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+
+      /**
+       * @brief Internal function used to unlock an uncontended mutex.
+       * @param th Pointer to thread.
+       * @retval true The mutex was unlocked.
+       * @retval false The slow path must be used.
+       */
+      bool
+      internal_try_unlock_fast_ (thread* th);
+
+      /**
+       * @brief Internal function used to keep the owned mutexes ordered.
+       * @param th Pointer to the owner thread.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_relink_owned_ (thread* th);
+
+      /**
+       * @brief Internal function used to get the priority to inherit.
+       * @param th Pointer to the owner thread.
+       * @return The highest boosted priority of the owned mutexes.
+       */
+      static thread::priority_t
+      internal_inherited_ (thread* th);
+
+      /**
+       * @brief Internal function used to boost the chain of owners.
+       * @param prio The priority of the blocked thread.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_boost_chain_ (thread::priority_t prio);
+
       /**
        * @endcond
        */
@@ -656,8 +811,14 @@ namespace os
        * @cond ignore
        */
 
+      // Bit in `owner_` forcing the unlock on the slow path.
+      static constexpr std::uintptr_t owner_contended = 1;
+
       // Can be updated in different thread contexts.
-      thread* volatile owner_ = nullptr;
+      // The address of the owner thread; bit 0 is set when someone
+      // else is waiting (or waited) for the mutex, and the owner must
+      // unlock it on the slow path. Read it via `internal_owner_()`.
+      std::uintptr_t volatile owner_ = 0;
 
 #if !defined(OS_USE_RTOS_PORT_MUTEX)
       internal::waiting_threads_list list_;
@@ -681,14 +842,18 @@ namespace os
       volatile count_t count_ = 0;
 
       // Can be updated in different thread contexts.
+#if !defined(OS_EXCLUDE_RTOS_MUTEX_PRIORITY_CEILING)
       volatile thread::priority_t initial_prio_ceiling_ =
           thread::priority::highest;
       volatile thread::priority_t prio_ceiling_ = thread::priority::highest;
+#endif /* !defined(OS_EXCLUDE_RTOS_MUTEX_PRIORITY_CEILING) */
       volatile thread::priority_t boosted_prio_ = thread::priority::none;
 
+#if !defined(OS_EXCLUDE_RTOS_MUTEX_ROBUST)
       bool owner_dead_ = false;
       bool consistent_ = true;
       bool recoverable_ = true;
+#endif /* !defined(OS_EXCLUDE_RTOS_MUTEX_ROBUST) */
 
       // Constants set during construction.
       const type_t type_; // normal, errorcheck, recursive
@@ -696,6 +861,15 @@ namespace os
       const robustness_t robustness_; // stalled, robust
       const count_t max_count_;
 
+#if defined(OS_INCLUDE_RTOS_SMP)
+      const uint32_t spin_cycles_;
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MUTEX_INHERIT)
+      static std::size_t inherit_max_depth_;
+      static rtos::statistics::counter_t inherit_capped_;
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_MUTEX_INHERIT) */
+
       // Add more internal data.
 
       /**
@@ -733,6 +907,19 @@ namespace os
       mutex_recursive (const char* name, const attributes& attr =
                            initializer_recursive);
 
+#if !defined(OS_USE_RTOS_PORT_MUTEX)
+
+      /**
+       * @brief Construct a named recursive mutex object instance
+       *  at compile time.
+       */
+      constexpr
+      mutex_recursive (constant_init_t tag, const char* name,
+                       const attributes& attr = attributes_recursive
+                         { });
+
+#endif /* !defined(OS_USE_RTOS_PORT_MUTEX) */
+
       /**
        * @cond ignore
        */
@@ -825,6 +1012,47 @@ namespace os
 
     // ========================================================================
 
+#if !defined(OS_USE_RTOS_PORT_MUTEX)
+
+    /**
+     * @details
+     * Static instances are fully initialised by the compiler,
+     * in `.data`, so no constructor runs from the init array
+     * and the mutex can be used regardless of the static
+     * constructors order.
+     *
+     * The attributes must be a constant expression, like
+     * `mutex::attributes { }` (the default), or a `constexpr`
+     * object; they are not validated at run time.
+     */
+    constexpr
+    mutex::mutex (constant_init_t tag, const char* name,
+                  const attributes& attr) :
+        object_named_system
+          { name }, //
+        list_
+          { tag }, //
+        clock_ (attr.clock != nullptr ? attr.clock : &sysclock), //
+        owner_links_
+          { tag }, //
+#if !defined(OS_EXCLUDE_RTOS_MUTEX_PRIORITY_CEILING)
+        initial_prio_ceiling_ (attr.mx_priority_ceiling), //
+        prio_ceiling_ (attr.mx_priority_ceiling), //
+#endif /* !defined(OS_EXCLUDE_RTOS_MUTEX_PRIORITY_CEILING) */
+        type_ (attr.mx_type), //
+        protocol_ (attr.mx_protocol), //
+        robustness_ (attr.mx_robustness), //
+        max_count_ ((attr.mx_type == type::recursive) ? attr.mx_max_count : 1)
+#if defined(OS_INCLUDE_RTOS_SMP)
+            , //
+        spin_cycles_ (attr.mx_spin_cycles)
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+    {
+      ;
+    }
+
+#endif /* !defined(OS_USE_RTOS_PORT_MUTEX) */
+
     /**
      * @details
      * Identical mutexes should have the same memory address.
@@ -843,9 +1071,23 @@ namespace os
     inline thread*
     mutex::owner (void)
     {
-      return owner_;
+      return internal_owner_ ();
     }
 
+    /**
+     * @cond ignore
+     */
+
+    inline thread*
+    mutex::internal_owner_ (void) const
+    {
+      return reinterpret_cast<thread*> (owner_ & ~owner_contended);
+    }
+
+    /**
+     * @endcond
+     */
+
     /**
      * @details
      *
@@ -897,6 +1139,19 @@ namespace os
       ;
     }
 
+#if !defined(OS_USE_RTOS_PORT_MUTEX)
+
+    constexpr
+    mutex_recursive::mutex_recursive (constant_init_t tag, const char* name,
+                                      const attributes& attr) :
+        mutex
+          { tag, name, attr }
+    {
+      ;
+    }
+
+#endif /* !defined(OS_USE_RTOS_PORT_MUTEX) */
+
     inline
     mutex_recursive::~mutex_recursive ()
     {
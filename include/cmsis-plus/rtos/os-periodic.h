@@ -0,0 +1,358 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_RTOS_OS_PERIODIC_H_
+#define CMSIS_PLUS_RTOS_OS_PERIODIC_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#include <cmsis-plus/rtos/os-decls.h>
+#include <cmsis-plus/rtos/os-clocks.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Drift-free **periodic activation** of a thread.
+     * @headerfile os.h <cmsis-plus/rtos/os.h>
+     * @ingroup cmsis-plus-rtos-clock
+     *
+     * @details
+     * Keeps the absolute release time of the next activation on
+     * a clock, so the period does not accumulate the execution
+     * time of the loop body; counts the missed releases and
+     * measures the release jitter with `hrclock`.
+     */
+    class periodic : public internal::object_named
+    {
+    public:
+
+      /**
+       * @brief Type of the jitter values, in `hrclock` cycles.
+       */
+      using jitter_t = int32_t;
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+      /**
+       * @brief Construct a periodic activation object instance.
+       * @param [in] period The period, in clock units.
+       * @param [in] clk The clock used for the release times.
+       */
+      periodic (clock::duration_t period, clock& clk = sysclock);
+
+      /**
+       * @brief Construct a named periodic activation object instance.
+       * @param [in] name Pointer to name.
+       * @param [in] period The period, in clock units.
+       * @param [in] clk The clock used for the release times.
+       */
+      periodic (const char* name, clock::duration_t period, clock& clk =
+                    sysclock);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      periodic (const periodic&) = delete;
+      periodic (periodic&&) = delete;
+      periodic&
+      operator= (const periodic&) = delete;
+      periodic&
+      operator= (periodic&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @brief Destruct the periodic activation object instance.
+       */
+      ~periodic () = default;
+
+      /**
+       * @}
+       */
+
+    public:
+
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+      /**
+       * @brief Start the activations from the current time.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      start (void);
+
+      /**
+       * @brief Wait for the next release time.
+       * @par Parameters
+       *  None.
+       * @retval result::ok The thread was released in time.
+       * @retval ETIMEDOUT The release time had passed; the missed
+       *  releases were skipped and the thread was released at
+       *  the next one.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINTR The sleep was interrupted.
+       */
+      result_t
+      wait_next_period (void);
+
+      /**
+       * @brief Get the period.
+       * @par Parameters
+       *  None.
+       * @return The period, in clock units.
+       */
+      clock::duration_t
+      period (void) const;
+
+      /**
+       * @brief Get the release time of the current activation.
+       * @par Parameters
+       *  None.
+       * @return The absolute time, in clock units.
+       */
+      clock::timestamp_t
+      release (void) const;
+
+      /**
+       * @brief Get the number of activations.
+       * @par Parameters
+       *  None.
+       * @return The number of returns from `wait_next_period()`.
+       */
+      statistics::counter_t
+      activations (void) const;
+
+      /**
+       * @brief Get the number of missed releases.
+       * @par Parameters
+       *  None.
+       * @return The number of release times that passed while
+       *  the loop body was still running.
+       */
+      statistics::counter_t
+      misses (void) const;
+
+      /**
+       * @brief Get the earliest release.
+       * @par Parameters
+       *  None.
+       * @return The minimum difference between the wakeup and the
+       *  release time, in `hrclock` cycles.
+       */
+      jitter_t
+      jitter_min (void) const;
+
+      /**
+       * @brief Get the latest release.
+       * @par Parameters
+       *  None.
+       * @return The maximum difference between the wakeup and the
+       *  release time, in `hrclock` cycles.
+       */
+      jitter_t
+      jitter_max (void) const;
+
+      /**
+       * @brief Get the mean release jitter.
+       * @par Parameters
+       *  None.
+       * @return The mean difference between the wakeup and the
+       *  release time, in `hrclock` cycles.
+       */
+      jitter_t
+      jitter_mean (void) const;
+
+      /**
+       * @brief Clear the counters and the jitter statistics.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      clear_statistics (void);
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @name Private Member Functions
+       * @{
+       */
+
+      /**
+       * @cond ignore
+       */
+
+      void
+      internal_record_jitter_ (void);
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @}
+       */
+
+      /**
+       * @name Private Member Variables
+       * @{
+       */
+
+      /**
+       * @cond ignore
+       */
+
+      clock* clock_;
+      clock::duration_t period_;
+
+      // The number of hrclock cycles in one clock unit.
+      uint32_t cycles_per_unit_;
+
+      // The release time of the current activation.
+      clock::timestamp_t release_ = 0;
+
+      // The first release and the hrclock time of its wakeup, the
+      // reference for the expected wakeups of all the others.
+      clock::timestamp_t origin_release_ = 0;
+      clock::timestamp_t origin_cycles_ = 0;
+      bool has_origin_ = false;
+
+      statistics::counter_t activations_ = 0;
+      statistics::counter_t misses_ = 0;
+
+      jitter_t jitter_min_ = 0;
+      jitter_t jitter_max_ = 0;
+      int64_t jitter_sum_ = 0;
+      statistics::counter_t jitter_count_ = 0;
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @}
+       */
+    };
+
+#pragma GCC diagnostic pop
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace rtos
+  {
+
+    inline clock::duration_t
+    periodic::period (void) const
+    {
+      return period_;
+    }
+
+    inline clock::timestamp_t
+    periodic::release (void) const
+    {
+      return release_;
+    }
+
+    inline statistics::counter_t
+    periodic::activations (void) const
+    {
+      return activations_;
+    }
+
+    inline statistics::counter_t
+    periodic::misses (void) const
+    {
+      return misses_;
+    }
+
+    inline periodic::jitter_t
+    periodic::jitter_min (void) const
+    {
+      return jitter_min_;
+    }
+
+    inline periodic::jitter_t
+    periodic::jitter_max (void) const
+    {
+      return jitter_max_;
+    }
+
+    inline periodic::jitter_t
+    periodic::jitter_mean (void) const
+    {
+      if (jitter_count_ == 0)
+        {
+          return 0;
+        }
+      return static_cast<jitter_t> (jitter_sum_
+          / static_cast<int64_t> (jitter_count_));
+    }
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_RTOS_OS_PERIODIC_H_ */
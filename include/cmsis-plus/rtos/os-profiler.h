@@ -0,0 +1,193 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_RTOS_OS_PROFILER_H_
+#define CMSIS_PLUS_RTOS_OS_PROFILER_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#if defined(OS_INCLUDE_RTOS_PROFILER)
+
+#include <cstddef>
+#include <cstdint>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    class thread;
+
+    /**
+     * @brief Statistical PC sampling profiler.
+     * @ingroup cmsis-plus-rtos
+     * @details
+     * A periodic high priority interrupt, usually from a hardware
+     * timer not synchronised with the system tick, records the
+     * interrupted program counter and the running thread in a ring;
+     * the samples are later drained by a thread, or printed on
+     * the trace channel, and aggregated on the host, with
+     * `addr2line`, in flat or per thread profiles.
+     *
+     * On Cortex-M, the timer interrupt vector can point directly to
+     * `os_rtos_profiler_sample_isr()`, which takes the PC from the
+     * exception stack frame and calls
+     * `os_rtos_profiler_acknowledge_hook()` to clear the interrupt;
+     * otherwise the handler must call `sample()` with the PC.
+     */
+    namespace profiler
+    {
+      /**
+       * @brief A PC sample.
+       */
+      typedef struct sample_s
+      {
+        /**
+         * @brief The interrupted program counter.
+         */
+        const void* pc;
+
+        /**
+         * @brief The running thread, or `nullptr` before the
+         *  scheduler started.
+         */
+        thread* th;
+
+      } sample_t;
+
+      /**
+       * @brief The number of samples in the ring.
+       */
+      constexpr std::size_t samples_size = OS_INTEGER_RTOS_PROFILER_SAMPLES;
+
+      /**
+       * @brief Start recording samples.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      start (void) noexcept;
+
+      /**
+       * @brief Stop recording samples.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      stop (void) noexcept;
+
+      /**
+       * @brief Record a sample.
+       * @param [in] pc The interrupted program counter.
+       * @par Returns
+       *  Nothing.
+       * @note Must be invoked from the sampling interrupt handler;
+       *  there must be a single producer.
+       */
+      void
+      sample (const void* pc) noexcept;
+
+      /**
+       * @brief Get recorded samples, removing them from the ring.
+       * @param [out] samples Pointer to array of samples.
+       * @param [in] count Size of the array.
+       * @return The number of samples copied.
+       * @note There must be a single consumer.
+       */
+      std::size_t
+      drain (sample_t* samples, std::size_t count) noexcept;
+
+      /**
+       * @brief Get the number of samples lost because the ring was full.
+       * @par Parameters
+       *  None.
+       * @return The number of lost samples.
+       */
+      std::size_t
+      dropped (void) noexcept;
+
+      /**
+       * @brief Drain the samples to the trace channel.
+       * @param [in] max_samples Max number of samples to print.
+       * @return The number of samples printed.
+       * @details
+       * One line for each sample, with the PC, the thread address
+       * and the thread name.
+       */
+      std::size_t
+      trace_print (std::size_t max_samples = SIZE_MAX) noexcept;
+
+    } /* namespace profiler */
+  } /* namespace rtos */
+} /* namespace os */
+
+extern "C"
+{
+  /**
+   * @addtogroup cmsis-plus-app-hooks
+   * @{
+   */
+
+  /**
+   * @brief Sampling interrupt handler, for Cortex-M.
+   * @details
+   * Must be installed directly in the interrupt vector, since it
+   * needs the `EXC_RETURN` value in `LR`.
+   */
+  void
+  os_rtos_profiler_sample_isr (void);
+
+  /**
+   * @brief Clear the sampling interrupt, from
+   *  `os_rtos_profiler_sample_isr()`.
+   * @details
+   * Weak, empty by default; applications must redefine it to
+   * acknowledge the timer interrupt.
+   */
+  void
+  os_rtos_profiler_acknowledge_hook (void);
+
+  /**
+   * @}
+   */
+}
+
+// ----------------------------------------------------------------------------
+
+#endif /* defined(OS_INCLUDE_RTOS_PROFILER) */
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_RTOS_OS_PROFILER_H_ */
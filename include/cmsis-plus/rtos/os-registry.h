@@ -0,0 +1,214 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_RTOS_OS_REGISTRY_H_
+#define CMSIS_PLUS_RTOS_OS_REGISTRY_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#if defined(OS_INCLUDE_RTOS_OBJECT_REGISTRY)
+
+#include <cmsis-plus/rtos/os-decls.h>
+
+#include <cstddef>
+#include <cstdint>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    /**
+     * @brief Registry of named objects.
+     * @ingroup cmsis-plus-rtos
+     * @details
+     * The threads, mutexes, condition variables, semaphores,
+     * event flags, message queues, memory pools and timers
+     * with a name are entered in a hash table when constructed,
+     * and removed when destroyed, so they can be found by name
+     * and type in constant time, without walking the threads tree.
+     *
+     * Objects without a name (`"-"`) are not registered;
+     * when the table is full, the new objects are not
+     * registered either.
+     */
+    namespace registry
+    {
+      /**
+       * @brief Type of registered objects.
+       */
+      enum class type
+        : uint8_t
+          {
+            thread = 1, //
+        mutex, //
+        condition_variable, //
+        semaphore, //
+        event_flags, //
+        message_queue, //
+        memory_pool, //
+        timer
+      };
+
+      /**
+       * @brief The number of entries in the table.
+       */
+      constexpr std::size_t table_size =
+          OS_INTEGER_RTOS_OBJECT_REGISTRY_SIZE;
+
+      /**
+       * @brief Find an object by name and type.
+       * @param [in] name Null terminated name.
+       * @param [in] t Type of the object.
+       * @return Pointer to the object, or `nullptr` if not found.
+       * @note If several objects of the same type have the same
+       *  name, any of them may be returned.
+       * @warning Cannot be invoked from Interrupt Service Routines.
+       */
+      internal::object_named*
+      find (const char* name, type t);
+
+      /**
+       * @brief Find an object by name.
+       * @tparam T Type of the object.
+       * @param [in] name Null terminated name.
+       * @return Pointer to the object, or `nullptr` if not found.
+       * @warning Cannot be invoked from Interrupt Service Routines.
+       */
+      template<typename T>
+        T*
+        find (const char* name);
+
+      /**
+       * @brief Get the number of registered objects.
+       * @par Parameters
+       *  None.
+       * @return The number of objects.
+       */
+      std::size_t
+      size (void);
+
+      /**
+       * @cond ignore
+       */
+
+      template<typename T>
+        struct type_of;
+
+      template<>
+        struct type_of<thread>
+        {
+          static constexpr type value = type::thread;
+        };
+
+      template<>
+        struct type_of<mutex>
+        {
+          static constexpr type value = type::mutex;
+        };
+
+      template<>
+        struct type_of<condition_variable>
+        {
+          static constexpr type value = type::condition_variable;
+        };
+
+      template<>
+        struct type_of<semaphore>
+        {
+          static constexpr type value = type::semaphore;
+        };
+
+      template<>
+        struct type_of<event_flags>
+        {
+          static constexpr type value = type::event_flags;
+        };
+
+      template<>
+        struct type_of<message_queue>
+        {
+          static constexpr type value = type::message_queue;
+        };
+
+      template<>
+        struct type_of<memory_pool>
+        {
+          static constexpr type value = type::memory_pool;
+        };
+
+      template<>
+        struct type_of<timer>
+        {
+          static constexpr type value = type::timer;
+        };
+
+      bool
+      internal_insert (internal::object_named* obj, type t);
+
+      void
+      internal_erase (internal::object_named* obj, type t);
+
+      /**
+       * @endcond
+       */
+
+    } /* namespace registry */
+  } /* namespace rtos */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace rtos
+  {
+    namespace registry
+    {
+      template<typename T>
+        inline T*
+        find (const char* name)
+        {
+          return static_cast<T*> (find (name, type_of<T>::value));
+        }
+
+    } /* namespace registry */
+  } /* namespace rtos */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* defined(OS_INCLUDE_RTOS_OBJECT_REGISTRY) */
+
+#endif /* __cplusplus */
+
+// ----------------------------------------------------------------------------
+
+#endif /* CMSIS_PLUS_RTOS_OS_REGISTRY_H_ */
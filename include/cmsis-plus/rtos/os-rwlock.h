@@ -0,0 +1,391 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_RTOS_OS_RWLOCK_H_
+#define CMSIS_PLUS_RTOS_OS_RWLOCK_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#include <cmsis-plus/rtos/os-decls.h>
+#include <cmsis-plus/rtos/os-mutex.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief POSIX compliant **read-write lock**.
+     * @headerfile os.h <cmsis-plus/rtos/os.h>
+     * @ingroup cmsis-plus-rtos-mutex
+     *
+     * @details
+     * Many readers may hold the lock in shared mode at the same
+     * time, while a writer holds it in exclusive mode alone.
+     * Writers have preference: once a writer waits, new readers
+     * wait too, so the writers cannot starve.
+     *
+     * The writers are serialised by an inner mutex with the
+     * priority inheritance protocol.
+     *
+     * @par POSIX compatibility
+     *  Inspired by [`pthread_rwlock_t`](http://pubs.opengroup.org/onlinepubs/9699919799/basedefs/pthread.h.html)
+     *  from [`<pthread.h>`](http://pubs.opengroup.org/onlinepubs/9699919799/basedefs/pthread.h.html)
+     *  ([IEEE Std 1003.1, 2013 Edition](http://pubs.opengroup.org/onlinepubs/9699919799/nframe.html)).
+     */
+    class rwlock : public internal::object_named_system
+    {
+    public:
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+      /**
+       * @brief Construct a read-write lock object instance.
+       * @par Parameters
+       *  None.
+       */
+      rwlock ();
+
+      /**
+       * @brief Construct a named read-write lock object instance.
+       * @param [in] name Pointer to name.
+       */
+      rwlock (const char* name);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      rwlock (const rwlock&) = delete;
+      rwlock (rwlock&&) = delete;
+      rwlock&
+      operator= (const rwlock&) = delete;
+      rwlock&
+      operator= (rwlock&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @brief Destruct the read-write lock object instance.
+       */
+      ~rwlock ();
+
+      /**
+       * @}
+       */
+
+      /**
+       * @name Operators
+       * @{
+       */
+
+      /**
+       * @brief Compare read-write locks.
+       * @retval true The given read-write lock is the same as this one.
+       * @retval false The read-write locks are different.
+       */
+      bool
+      operator== (const rwlock& rhs) const;
+
+      /**
+       * @}
+       */
+
+    public:
+
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+      /**
+       * @brief Lock the read-write lock in exclusive mode.
+       * @par Parameters
+       *  None.
+       * @retval result::ok The lock was acquired.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINTR The operation was interrupted.
+       * @retval EDEADLK The current thread already owns the lock.
+       */
+      result_t
+      lock (void);
+
+      /**
+       * @brief Try to lock the read-write lock in exclusive mode.
+       * @par Parameters
+       *  None.
+       * @retval result::ok The lock was acquired.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EWOULDBLOCK The lock is held in any mode.
+       */
+      result_t
+      try_lock (void);
+
+      /**
+       * @brief Timed attempt to lock the read-write lock in exclusive mode.
+       * @param [in] timeout Timeout to wait, in clock units (ticks or seconds).
+       * @retval result::ok The lock was acquired.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINTR The operation was interrupted.
+       * @retval ETIMEDOUT The lock could not be acquired before the
+       *  specified timeout expired.
+       * @retval EDEADLK The current thread already owns the lock.
+       */
+      result_t
+      timed_lock (clock::duration_t timeout);
+
+      /**
+       * @brief Unlock the read-write lock held in exclusive mode.
+       * @par Parameters
+       *  None.
+       * @retval result::ok The lock was released.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines,
+       *  or the current thread does not own the lock.
+       */
+      result_t
+      unlock (void);
+
+      /**
+       * @brief Lock the read-write lock in shared mode.
+       * @par Parameters
+       *  None.
+       * @retval result::ok The lock was acquired.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINTR The operation was interrupted.
+       */
+      result_t
+      lock_shared (void);
+
+      /**
+       * @brief Try to lock the read-write lock in shared mode.
+       * @par Parameters
+       *  None.
+       * @retval result::ok The lock was acquired.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EWOULDBLOCK A writer holds or waits for the lock.
+       */
+      result_t
+      try_lock_shared (void);
+
+      /**
+       * @brief Timed attempt to lock the read-write lock in shared mode.
+       * @param [in] timeout Timeout to wait, in clock units (ticks or seconds).
+       * @retval result::ok The lock was acquired.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINTR The operation was interrupted.
+       * @retval ETIMEDOUT The lock could not be acquired before the
+       *  specified timeout expired.
+       */
+      result_t
+      timed_lock_shared (clock::duration_t timeout);
+
+      /**
+       * @brief Unlock the read-write lock held in shared mode.
+       * @par Parameters
+       *  None.
+       * @retval result::ok The lock was released.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines,
+       *  or the lock is not held in shared mode.
+       */
+      result_t
+      unlock_shared (void);
+
+      /**
+       * @brief Get the number of readers holding the lock.
+       * @par Parameters
+       *  None.
+       * @return The number of readers.
+       */
+      std::size_t
+      readers (void) const;
+
+      /**
+       * @brief Get the thread holding the lock in exclusive mode.
+       * @par Parameters
+       *  None.
+       * @return Pointer to the writer thread, or `nullptr`.
+       */
+      thread*
+      writer (void);
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @name Private Member Functions
+       * @{
+       */
+
+      /**
+       * @cond ignore
+       */
+
+      /**
+       * @brief Internal function used to wait for the lock to be free.
+       * @param [in] shared Wait for the writers, instead of the readers.
+       * @param [in] timestamp The absolute time when the wait expires.
+       * @param [in] timed Use the timestamp.
+       * @retval result::ok The lock can be acquired.
+       * @retval EINTR The operation was interrupted.
+       * @retval ETIMEDOUT The timeout expired.
+       */
+      result_t
+      internal_wait_ (bool shared, clock::timestamp_t timestamp, bool timed);
+
+      /**
+       * @brief Internal function used to give up an exclusive lock attempt.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_cancel_writer_ (void);
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @name Private Member Variables
+       * @{
+       */
+
+      /**
+       * @cond ignore
+       */
+
+      /**
+       * @brief Serialises the writers, with priority inheritance.
+       */
+      mutex writers_mutex_;
+
+      /**
+       * @brief Readers waiting for the writers to go.
+       */
+      internal::waiting_threads_list readers_list_;
+      /**
+       * @brief The writer waiting for the readers to go.
+       */
+      internal::waiting_threads_list writer_list_;
+
+      /**
+       * @brief Number of readers holding the lock.
+       */
+      std::size_t volatile readers_ = 0;
+      /**
+       * @brief Number of writers holding or waiting for the lock.
+       */
+      std::size_t volatile writers_ = 0;
+      /**
+       * @brief The writer holding the lock, or `nullptr`.
+       */
+      thread* volatile writer_ = nullptr;
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @}
+       */
+    };
+
+#pragma GCC diagnostic pop
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace rtos
+  {
+
+    inline
+    rwlock::rwlock () :
+        rwlock
+          { nullptr }
+    {
+      ;
+    }
+
+    /**
+     * @details
+     * Identical read-write locks should have the same memory address.
+     */
+    inline bool
+    rwlock::operator== (const rwlock& rhs) const
+    {
+      return this == &rhs;
+    }
+
+    inline std::size_t
+    rwlock::readers (void) const
+    {
+      return readers_;
+    }
+
+    inline thread*
+    rwlock::writer (void)
+    {
+      return writer_;
+    }
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_RTOS_OS_RWLOCK_H_ */
@@ -35,6 +35,10 @@
 #include <cmsis-plus/rtos/os-decls.h>
 #include <cmsis-plus/rtos/os-clocks.h>
 
+#if defined(OS_INCLUDE_RTOS_SMP)
+#include <cmsis-plus/rtos/internal/os-spinlock.h>
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+
 // ----------------------------------------------------------------------------
 
 namespace os
@@ -55,12 +59,110 @@ namespace os
 
 #if !defined(OS_USE_RTOS_PORT_SCHEDULER)
       extern bool is_preemptive_;
+#if defined(OS_INCLUDE_RTOS_SMP)
+      // One running thread and one ready list for each core.
+      extern thread* volatile current_threads_[OS_INTEGER_RTOS_SMP_CORES];
+      extern internal::ready_threads_list ready_threads_lists_[OS_INTEGER_RTOS_SMP_CORES];
+#else
       extern thread* volatile current_thread_;
       extern internal::ready_threads_list ready_threads_list_;
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+
+#if defined(OS_INCLUDE_RTOS_THREAD_LOCAL_SLOTS)
+      // The local slots of the running thread, set on context switches.
+      extern void** local_slots_;
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_LOCAL_SLOTS) */
+
+      /**
+       * @brief Get the thread running on the current core.
+       * @par Parameters
+       *  None.
+       * @return A reference to the scheduler pointer.
+       */
+      thread* volatile&
+      internal_current_thread_ (void);
+
+#if defined(OS_INCLUDE_RTOS_SMP)
+      /**
+       * @brief Request a context switch on a core.
+       * @param [in] core The core index.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_reschedule_core_ (std::size_t core);
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING)
+      /**
+       * @brief Consume one tick of the running thread slice.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_consume_slice_ (void);
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING) */
+
+#if defined(OS_INCLUDE_RTOS_THREAD_BUDGET)
+      /**
+       * @brief Check the execution budget of the running thread.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_check_budget_ (void);
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_BUDGET) */
+
+#if defined(OS_USE_RTOS_SCHEDULER_LOCK_NESTING)
+      extern state_t volatile lock_state_;
+      extern bool volatile lock_reschedule_pending_;
+#endif /* defined(OS_USE_RTOS_SCHEDULER_LOCK_NESTING) */
 #endif /* !defined(OS_USE_RTOS_PORT_SCHEDULER) */
 
+#if defined(OS_INCLUDE_RTOS_SMP)
+      // Taken by interrupts::critical_section, for cross-core safety.
+      extern internal::kernel_lock kernel_lock_;
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES)
+      /**
+       * @brief Move threads from the busiest core to the least busy one.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_balance_ (void);
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES) */
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+
       extern internal::terminated_threads_list terminated_threads_list_;
 
+      /**
+       * @brief Destroy all terminated threads.
+       * @par Parameters
+       *  None.
+       * @return The number of threads destroyed.
+       */
+      std::size_t
+      internal_reap_terminated_ (void);
+
+#if defined(OS_INCLUDE_RTOS_THREAD_REAPER)
+      /**
+       * @brief Wake up the reaper thread.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_wake_reaper_ (void);
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_REAPER) */
+
       /**
        * @endcond
        */
@@ -469,7 +571,280 @@ namespace os
 
 #endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES) */
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_CPU_LOAD)
+
+        /**
+         * @brief Averaging windows of the CPU load.
+         */
+        enum class load_window
+          : uint8_t
+            {
+              ms_100, //
+          s_1, //
+          s_10
+        };
+
+        /**
+         * @brief Get the CPU load.
+         * @param [in] w The averaging window.
+         * @return The busy time, in per mille (0-1000).
+         */
+        uint32_t
+        cpu_load (load_window w = load_window::s_1);
+
+        /**
+         * @brief Get the total duration of the idle thread.
+         * @par Parameters
+         *  None.
+         * @return Integer with the number of CPU cycles.
+         */
+        rtos::statistics::duration_t
+        idle_cycles (void);
+
+        /**
+         * @brief Get the total duration of the idle sleeps.
+         * @par Parameters
+         *  None.
+         * @return Integer with the number of CPU cycles spent
+         *  waiting for interrupts.
+         */
+        rtos::statistics::duration_t
+        sleep_cycles (void);
+
+        /**
+         * @brief Display the CPU load.
+         * @par Parameters
+         *  None.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        dump_cpu_load (void);
+
+        /**
+         * @cond ignore
+         */
+
+        /*
+         * Constructed by the idle thread around the sleep.
+         */
+        class sleep_scope
+        {
+        public:
+
+          sleep_scope ();
+
+          ~sleep_scope ();
+
+          sleep_scope (const sleep_scope&) = delete;
+          sleep_scope (sleep_scope&&) = delete;
+          sleep_scope&
+          operator= (const sleep_scope&) = delete;
+          sleep_scope&
+          operator= (sleep_scope&&) = delete;
+
+        protected:
+
+          clock::timestamp_t begin_;
+          clock::timestamp_t switched_;
+          rtos::statistics::duration_t idle_;
+        };
+
+        void
+        internal_sample_load_ (void);
+
+        /**
+         * @endcond
+         */
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_CPU_LOAD) */
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_EVENTS)
+
+        /**
+         * @cond ignore
+         */
+
+        void
+        internal_start_events_ (void);
+
+        void
+        internal_sample_events_ (void);
+
+        /**
+         * @endcond
+         */
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_EVENTS) */
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_CRITICAL_SECTIONS)
+
+        /**
+         * @brief Get the scheduler critical sections durations.
+         * @param [out] out Pointer to an array of sites.
+         * @param [in] count Number of elements in the array.
+         * @return The number of sites copied.
+         */
+        std::size_t
+        critical_sections (rtos::statistics::site* out, std::size_t count);
+
+        /**
+         * @brief Display the scheduler critical sections durations.
+         * @par Parameters
+         *  None.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        dump_critical_sections (void);
+
+        /**
+         * @brief Clear the scheduler critical sections durations.
+         * @par Parameters
+         *  None.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        reset_critical_sections (void);
+
+        /**
+         * @cond ignore
+         */
+
+        __attribute__((noinline)) void
+        internal_lock_enter_ (void);
+
+        void
+        internal_lock_exit_ (void);
+
+        /**
+         * @endcond
+         */
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_CRITICAL_SECTIONS) */
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_STACK_SITES)
+
+        /**
+         * @brief Get the peak stack usage of the thread functions.
+         * @param [out] out Pointer to an array of sites.
+         * @param [in] count Number of elements in the array.
+         * @return The number of sites copied.
+         */
+        std::size_t
+        stack_sites (rtos::statistics::stack_site* out, std::size_t count);
+
+        /**
+         * @brief Display the recommended stack sizes.
+         * @par Parameters
+         *  None.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        dump_stack_sites (void);
+
+        /**
+         * @brief Clear the peak stack usage of the thread functions.
+         * @par Parameters
+         *  None.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        reset_stack_sites (void);
+
+        /**
+         * @cond ignore
+         */
+
+        void
+        internal_record_stack_ (const void* function, const char* name,
+                                std::size_t size_bytes,
+                                std::size_t peak_bytes);
+
+        /**
+         * @endcond
+         */
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_STACK_SITES) */
+
       } /* namespace statistics */
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
+
+      /**
+       * @brief Earliest deadline first admission control.
+       */
+      namespace edf
+      {
+        /**
+         * @brief Type of utilisation values, in parts per million.
+         */
+        using utilization_t = uint32_t;
+
+        /**
+         * @brief The utilisation of a fully loaded CPU.
+         */
+        constexpr utilization_t full = 1000000;
+
+        /**
+         * @brief Get the total utilisation of the EDF threads.
+         * @par Parameters
+         *  None.
+         * @return The sum of the thread densities, in parts per million.
+         */
+        utilization_t
+        utilization (void);
+
+        /**
+         * @brief Compute the density of a thread.
+         * @param [in] budget Worst case execution time of a job.
+         * @param [in] deadline Relative deadline.
+         * @param [in] period Period, or 0 for aperiodic threads.
+         * @return The density, in parts per million.
+         */
+        utilization_t
+        density (clock::duration_t budget, clock::duration_t deadline,
+                 clock::duration_t period);
+
+        /**
+         * @brief Check if a new EDF thread can be guaranteed.
+         * @param [in] budget Worst case execution time of a job.
+         * @param [in] deadline Relative deadline.
+         * @param [in] period Period, or 0 for aperiodic threads.
+         * @retval true All deadlines can still be met.
+         * @retval false The CPU would be overloaded.
+         */
+        bool
+        admissible (clock::duration_t budget, clock::duration_t deadline,
+                    clock::duration_t period);
+
+        /**
+         * @brief Get the number of missed deadlines of all EDF threads.
+         * @par Parameters
+         *  None.
+         * @return The number of jobs that ended after their deadline.
+         */
+        rtos::statistics::counter_t
+        deadline_misses (void);
+
+        /**
+         * @cond ignore
+         */
+
+        extern utilization_t utilization_;
+        extern rtos::statistics::counter_t deadline_misses_;
+
+        /**
+         * @endcond
+         */
+
+      } /* namespace edf */
+
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_EDF) */
+
     } /* namespace scheduler */
 
     namespace interrupts
@@ -484,6 +859,80 @@ namespace os
       bool
       in_handler_mode (void);
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_CRITICAL_SECTIONS)
+
+      /**
+       * @brief Interrupts statistics.
+       */
+      namespace statistics
+      {
+        /**
+         * @brief Get the interrupts critical sections durations.
+         * @param [out] out Pointer to an array of sites.
+         * @param [in] count Number of elements in the array.
+         * @return The number of sites copied.
+         */
+        std::size_t
+        critical_sections (rtos::statistics::site* out, std::size_t count);
+
+        /**
+         * @brief Get the system tick interrupt latency.
+         * @param [out] out Reference to a site.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        latency (rtos::statistics::site& out);
+
+        /**
+         * @brief Display the interrupts critical sections durations
+         *  and the interrupt latency.
+         * @par Parameters
+         *  None.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        dump_critical_sections (void);
+
+        /**
+         * @brief Clear the interrupts critical sections durations
+         *  and the interrupt latency.
+         * @par Parameters
+         *  None.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        reset_critical_sections (void);
+
+        /**
+         * @cond ignore
+         */
+
+        __attribute__((noinline)) void
+        internal_enter_ (void);
+
+        void
+        internal_exit_ (void);
+
+        void
+        internal_pause_ (void);
+
+        void
+        internal_resume_ (void);
+
+        void
+        internal_record_latency_ (uint32_t cycles);
+
+        /**
+         * @endcond
+         */
+
+      } /* namespace statistics */
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_CRITICAL_SECTIONS) */
+
       // ======================================================================
 
       // TODO: define all levels of critical sections
@@ -804,6 +1253,74 @@ namespace os
 
       };
 
+#if defined(OS_INCLUDE_RTOS_ISR_RESCHEDULE_COALESCING)
+
+      // ======================================================================
+
+      /**
+       * @brief Interrupt handler [RAII](https://en.wikipedia.org/wiki/Resource_Acquisition_Is_Initialization) helper,
+       *  coalescing the context switch requests.
+       * @headerfile os.h <cmsis-plus/rtos/os.h>
+       */
+      class handler_scope
+      {
+      public:
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Enter an interrupt handler.
+         * @par Parameters
+         *  None.
+         */
+        handler_scope ();
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        handler_scope (const handler_scope&) = delete;
+        handler_scope (handler_scope&&) = delete;
+        handler_scope&
+        operator= (const handler_scope&) = delete;
+        handler_scope&
+        operator= (handler_scope&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Exit the interrupt handler, and request a single
+         *  context switch if threads were made ready.
+         */
+        ~handler_scope ();
+
+        /**
+         * @}
+         */
+      };
+
+      /**
+       * @cond ignore
+       */
+
+      void
+      internal_request_reschedule_ (void);
+
+      extern std::size_t volatile handler_nesting_;
+      extern bool volatile reschedule_pending_;
+
+      /**
+       * @endcond
+       */
+
+#endif /* defined(OS_INCLUDE_RTOS_ISR_RESCHEDULE_COALESCING) */
+
     } /* namespace interrupts */
   } /* namespace rtos */
 } /* namespace os */
@@ -829,6 +1346,50 @@ namespace os
         return is_started_;
       }
 
+#if !defined(OS_USE_RTOS_PORT_SCHEDULER)
+
+      /**
+       * @details
+       * With SMP, each core has its own running thread.
+       *
+       * @note Can be invoked from Interrupt Service Routines.
+       */
+      inline thread* volatile&
+      internal_current_thread_ (void)
+      {
+#if defined(OS_INCLUDE_RTOS_SMP)
+        return current_threads_[port::core::id ()];
+#else
+        return current_thread_;
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+      }
+
+#if defined(OS_INCLUDE_RTOS_SMP)
+
+      /**
+       * @details
+       * For the current core the context switch is requested
+       * locally, for the other cores via an inter-processor interrupt.
+       *
+       * @note Can be invoked from Interrupt Service Routines.
+       */
+      inline void
+      internal_reschedule_core_ (std::size_t core)
+      {
+        if (core == port::core::id ())
+          {
+            port::scheduler::reschedule ();
+          }
+        else
+          {
+            port::core::reschedule (core);
+          }
+      }
+
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+
+#endif /* !defined(OS_USE_RTOS_PORT_SCHEDULER) */
+
       /**
        * @details
        * Check if the scheduler preemption is enabled.
@@ -855,50 +1416,87 @@ namespace os
       inline bool
       locked (void)
       {
+#if defined(OS_USE_RTOS_SCHEDULER_LOCK_NESTING)
+        return lock_state_;
+#else
         return port::scheduler::locked ();
+#endif /* defined(OS_USE_RTOS_SCHEDULER_LOCK_NESTING) */
       }
 
       /**
        * @details
-       * Set the scheduler lock state to locked and
+       * Set the scheduler lock state based on the parameter and
        * return the previous state.
        *
+       * This allows to implement scheduler critical sections, where
+       * the scheduler is disabled and context switches are not
+       * performed.
+       *
+       * With @ref OS_USE_RTOS_SCHEDULER_LOCK_NESTING, the state is
+       * a plain variable, changed without interrupts critical
+       * sections (the interrupts do not change it and a
+       * preempted thread finds it restored when resumed); the
+       * port is called only when the outermost unlock finds that
+       * a context switch was requested while locked.
+       *
        * @warning Cannot be invoked from Interrupt Service Routines.
        */
       inline state_t
-      lock (void)
+      locked (state_t state)
       {
-        return port::scheduler::lock ();
+#if defined(OS_USE_RTOS_SCHEDULER_LOCK_NESTING)
+        // Keep the protected accesses inside.
+        __atomic_signal_fence (__ATOMIC_SEQ_CST);
+
+        state_t tmp = lock_state_;
+        lock_state_ = state;
+
+        __atomic_signal_fence (__ATOMIC_SEQ_CST);
+
+        if (!state && tmp
+            && __atomic_exchange_n (&lock_reschedule_pending_, false,
+                                    __ATOMIC_RELAXED))
+          {
+            port::scheduler::reschedule ();
+          }
+        return tmp;
+#else
+        return port::scheduler::locked (state);
+#endif /* defined(OS_USE_RTOS_SCHEDULER_LOCK_NESTING) */
       }
 
       /**
        * @details
-       * Set the scheduler lock state to unlocked and
+       * Set the scheduler lock state to locked and
        * return the previous state.
        *
        * @warning Cannot be invoked from Interrupt Service Routines.
        */
       inline state_t
-      unlock (void)
+      lock (void)
       {
-        return port::scheduler::unlock ();
+#if defined(OS_USE_RTOS_SCHEDULER_LOCK_NESTING)
+        return locked (true);
+#else
+        return port::scheduler::lock ();
+#endif /* defined(OS_USE_RTOS_SCHEDULER_LOCK_NESTING) */
       }
 
       /**
        * @details
-       * Set the scheduler lock state based on the parameter and
+       * Set the scheduler lock state to unlocked and
        * return the previous state.
        *
-       * This allows to implement scheduler critical sections, where
-       * the scheduler is disabled and context switches are not
-       * performed.
-       *
        * @warning Cannot be invoked from Interrupt Service Routines.
        */
       inline state_t
-      locked (state_t state)
+      unlock (void)
       {
-        return port::scheduler::locked (state);
+#if defined(OS_USE_RTOS_SCHEDULER_LOCK_NESTING)
+        return locked (false);
+#else
+        return port::scheduler::unlock ();
+#endif /* defined(OS_USE_RTOS_SCHEDULER_LOCK_NESTING) */
       }
 
       /**
@@ -912,8 +1510,15 @@ namespace os
           state_ (lock ())
       {
 #if defined(OS_TRACE_RTOS_SCHEDULER)
-        trace::printf (" {c ");
+        OS_TRACE_PRINTF (rtos_scheduler, " {c ");
 #endif
+#if defined(OS_INCLUDE_RTOS_STATISTICS_CRITICAL_SECTIONS)
+        if (!state_)
+          {
+            // Only the outermost section is measured.
+            statistics::internal_lock_enter_ ();
+          }
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_CRITICAL_SECTIONS) */
       }
 
       /**
@@ -927,8 +1532,14 @@ namespace os
       critical_section::~critical_section ()
       {
 #if defined(OS_TRACE_RTOS_SCHEDULER)
-        trace::printf (" c} ");
+        OS_TRACE_PRINTF (rtos_scheduler, " c} ");
 #endif
+#if defined(OS_INCLUDE_RTOS_STATISTICS_CRITICAL_SECTIONS)
+        if (!state_)
+          {
+            statistics::internal_lock_exit_ ();
+          }
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_CRITICAL_SECTIONS) */
         locked (state_);
       }
 
@@ -943,7 +1554,7 @@ namespace os
           state_ (unlock ())
       {
 #if defined(OS_TRACE_RTOS_SCHEDULER)
-        trace::printf (" {u ");
+        OS_TRACE_PRINTF (rtos_scheduler, " {u ");
 #endif
       }
 
@@ -958,7 +1569,7 @@ namespace os
       uncritical_section::~uncritical_section ()
       {
 #if defined(OS_TRACE_RTOS_SCHEDULER)
-        trace::printf (" u} ");
+        OS_TRACE_PRINTF (rtos_scheduler, " u} ");
 #endif
         locked (state_);
       }
@@ -1075,6 +1686,39 @@ namespace os
 
       } /* namespace statistics */
 
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
+
+      namespace edf
+      {
+        /**
+         * @details
+         * The value is updated when EDF threads are created
+         * and destroyed.
+         *
+         * @note Can be invoked from Interrupt Service Routines.
+         */
+        inline utilization_t
+        utilization (void)
+        {
+          return utilization_;
+        }
+
+        /**
+         * @details
+         * Also counts the threads already destroyed.
+         *
+         * @note Can be invoked from Interrupt Service Routines.
+         */
+        inline rtos::statistics::counter_t
+        deadline_misses (void)
+        {
+          return deadline_misses_;
+        }
+
+      } /* namespace edf */
+
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_EDF) */
+
     } /* namespace scheduler */
 
     // ========================================================================
@@ -1127,7 +1771,23 @@ namespace os
       __attribute__((always_inline))
       critical_section::enter (void)
       {
+#if defined(OS_INCLUDE_RTOS_SMP)
+        state_t state = port::interrupts::critical_section::enter ();
+
+        // Masking the local interrupts is not enough to keep
+        // the other cores out.
+        scheduler::kernel_lock_.lock ();
+#if defined(OS_INCLUDE_RTOS_STATISTICS_CRITICAL_SECTIONS)
+        statistics::internal_enter_ ();
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_CRITICAL_SECTIONS) */
+        return state;
+#elif defined(OS_INCLUDE_RTOS_STATISTICS_CRITICAL_SECTIONS)
+        state_t state = port::interrupts::critical_section::enter ();
+        statistics::internal_enter_ ();
+        return state;
+#else
         return port::interrupts::critical_section::enter ();
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
       }
 
       /**
@@ -1139,6 +1799,12 @@ namespace os
       __attribute__((always_inline))
       critical_section::exit (state_t state)
       {
+#if defined(OS_INCLUDE_RTOS_STATISTICS_CRITICAL_SECTIONS)
+        statistics::internal_exit_ ();
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_CRITICAL_SECTIONS) */
+#if defined(OS_INCLUDE_RTOS_SMP)
+        scheduler::kernel_lock_.unlock ();
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
         port::interrupts::critical_section::exit (state);
       }
 
@@ -1178,6 +1844,10 @@ namespace os
       __attribute__((always_inline))
       uncritical_section::enter (void)
       {
+#if defined(OS_INCLUDE_RTOS_STATISTICS_CRITICAL_SECTIONS)
+        // The interrupts are no longer masked.
+        statistics::internal_pause_ ();
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_CRITICAL_SECTIONS) */
         return port::interrupts::uncritical_section::enter ();
       }
 
@@ -1191,6 +1861,9 @@ namespace os
       uncritical_section::exit (state_t state)
       {
         port::interrupts::uncritical_section::exit (state);
+#if defined(OS_INCLUDE_RTOS_STATISTICS_CRITICAL_SECTIONS)
+        statistics::internal_resume_ ();
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_CRITICAL_SECTIONS) */
       }
 
       // ======================================================================
@@ -1258,6 +1931,63 @@ namespace os
         critical_section::exit (state_);
       }
 
+#if defined(OS_INCLUDE_RTOS_ISR_RESCHEDULE_COALESCING)
+
+      // ======================================================================
+
+      /**
+       * @details
+       *
+       * @note Can be invoked from Interrupt Service Routines (obviously).
+       */
+      inline
+      __attribute__((always_inline))
+      handler_scope::handler_scope ()
+      {
+        __atomic_add_fetch (&handler_nesting_, 1, __ATOMIC_RELAXED);
+      }
+
+      /**
+       * @details
+       * Only the outermost handler requests the context switch.
+       *
+       * @note Can be invoked from Interrupt Service Routines (obviously).
+       */
+      inline
+      __attribute__((always_inline))
+      handler_scope::~handler_scope ()
+      {
+        if (__atomic_sub_fetch (&handler_nesting_, 1, __ATOMIC_RELAXED) == 0
+            && __atomic_exchange_n (&reschedule_pending_, false,
+                                    __ATOMIC_RELAXED))
+          {
+            port::scheduler::reschedule ();
+          }
+      }
+
+      /**
+       * @details
+       * Inside a `handler_scope` the request is only recorded;
+       * elsewhere the context switch is requested at once.
+       *
+       * @note Can be invoked from Interrupt Service Routines.
+       */
+      inline void
+      __attribute__((always_inline))
+      internal_request_reschedule_ (void)
+      {
+        if (handler_nesting_ != 0)
+          {
+            reschedule_pending_ = true;
+          }
+        else
+          {
+            port::scheduler::reschedule ();
+          }
+      }
+
+#endif /* defined(OS_INCLUDE_RTOS_ISR_RESCHEDULE_COALESCING) */
+
     // ========================================================================
     }
 
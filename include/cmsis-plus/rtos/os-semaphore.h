@@ -263,6 +263,21 @@ namespace os
        */
       semaphore (const char* name, const attributes& attr = initializer_binary);
 
+#if !defined(OS_USE_RTOS_PORT_SEMAPHORE)
+
+      /**
+       * @brief Construct a semaphore object instance at compile time.
+       * @param [in] tag The constant initialisation tag.
+       * @param [in] name Pointer to name.
+       * @param [in] max_value Maximum count value.
+       * @param [in] initial_value Initial count value.
+       */
+      constexpr
+      semaphore (constant_init_t tag, const char* name,
+                 const count_t max_value = 1, const count_t initial_value = 0);
+
+#endif /* !defined(OS_USE_RTOS_PORT_SEMAPHORE) */
+
     protected:
 
       /**
@@ -386,6 +401,20 @@ namespace os
       result_t
       timed_wait (clock::duration_t timeout);
 
+      /**
+       * @brief Wait to lock the semaphore until an absolute time.
+       * @param [in] timestamp The deadline, in steady clock units.
+       * @retval result::ok The calling process successfully
+       *  performed the semaphore lock operation.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval ETIMEDOUT The semaphore could not be locked before
+       *  the deadline.
+       * @retval ENOTRECOVERABLE Semaphore wait failed (extension to POSIX).
+       * @retval EINTR The operation was interrupted.
+       */
+      result_t
+      timed_wait_until (clock::timestamp_t timestamp);
+
       /**
        * @brief Get the semaphore count value.
        * @par Parameters
@@ -473,6 +502,12 @@ namespace os
       clock* clock_ = nullptr;
 #endif
 
+#if !defined(OS_USE_RTOS_PORT_SEMAPHORE)
+      // Links its nodes to the waiting lists.
+      friend class wait_set;
+      friend class co::awaiter;
+#endif
+
 #if defined(OS_USE_RTOS_PORT_SEMAPHORE)
       friend class port::semaphore;
       os_semaphore_port_data_t port_;
@@ -527,6 +562,21 @@ namespace os
        */
       semaphore_binary (const char* name, const count_t initial_value);
 
+#if !defined(OS_USE_RTOS_PORT_SEMAPHORE)
+
+      /**
+       * @brief Construct a binary semaphore object instance
+       *  at compile time.
+       * @param [in] tag The constant initialisation tag.
+       * @param [in] name Pointer to name.
+       * @param [in] initial_value Initial count value; 0 if missing.
+       */
+      constexpr
+      semaphore_binary (constant_init_t tag, const char* name,
+                        const count_t initial_value = 0);
+
+#endif /* !defined(OS_USE_RTOS_PORT_SEMAPHORE) */
+
       /**
        * @cond ignore
        */
@@ -603,6 +653,23 @@ namespace os
       semaphore_counting (const char* name, const count_t max_value,
                           const count_t initial_value);
 
+#if !defined(OS_USE_RTOS_PORT_SEMAPHORE)
+
+      /**
+       * @brief Construct a counting semaphore object instance
+       *  at compile time.
+       * @param [in] tag The constant initialisation tag.
+       * @param [in] name Pointer to name.
+       * @param [in] max_value Maximum count value.
+       * @param [in] initial_value Initial count value; 0 if missing.
+       */
+      constexpr
+      semaphore_counting (constant_init_t tag, const char* name,
+                          const count_t max_value,
+                          const count_t initial_value = 0);
+
+#endif /* !defined(OS_USE_RTOS_PORT_SEMAPHORE) */
+
       /**
        * @cond ignore
        */
@@ -741,6 +808,35 @@ namespace os
       ;
     }
 
+#if !defined(OS_USE_RTOS_PORT_SEMAPHORE)
+
+    /**
+     * @details
+     * Static instances are fully initialised by the compiler,
+     * in `.data`, so no constructor runs from the init array
+     * and the semaphore can be used regardless of the static
+     * constructors order. The semaphore uses the `sysclock`.
+     *
+     * The values are not validated at run time; the maximum
+     * must be positive and not lower than the initial value.
+     */
+    constexpr
+    semaphore::semaphore (constant_init_t tag, const char* name,
+                          const count_t max_value, const count_t initial_value) :
+        object_named_system
+          { name }, //
+        list_
+          { tag }, //
+        clock_ (&sysclock), //
+        max_value_ (max_value), //
+        initial_value_ (initial_value), //
+        count_ (initial_value)
+    {
+      ;
+    }
+
+#endif /* !defined(OS_USE_RTOS_PORT_SEMAPHORE) */
+
     /**
      * @details
      * Identical semaphores should have the same memory address.
@@ -832,6 +928,19 @@ namespace os
       ;
     }
 
+#if !defined(OS_USE_RTOS_PORT_SEMAPHORE)
+
+    constexpr
+    semaphore_binary::semaphore_binary (constant_init_t tag, const char* name,
+                                        const count_t initial_value) :
+        semaphore
+          { tag, name, 1, initial_value }
+    {
+      ;
+    }
+
+#endif /* !defined(OS_USE_RTOS_PORT_SEMAPHORE) */
+
     /**
      * @details
      * This destructor shall destroy the semaphore object; the object
@@ -913,6 +1022,21 @@ namespace os
       ;
     }
 
+#if !defined(OS_USE_RTOS_PORT_SEMAPHORE)
+
+    constexpr
+    semaphore_counting::semaphore_counting (constant_init_t tag,
+                                            const char* name,
+                                            const count_t max_value,
+                                            const count_t initial_value) :
+        semaphore
+          { tag, name, max_value, initial_value }
+    {
+      ;
+    }
+
+#endif /* !defined(OS_USE_RTOS_PORT_SEMAPHORE) */
+
     /**
      * @details
      * This destructor shall destroy the semaphore object; the object
@@ -0,0 +1,353 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_RTOS_OS_SEQLOCK_H_
+#define CMSIS_PLUS_RTOS_OS_SEQLOCK_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#include <cmsis-plus/rtos/os-decls.h>
+
+#include <cstring>
+#include <type_traits>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief **Sequence lock** protecting a shared value.
+     * @headerfile os.h <cmsis-plus/rtos/os.h>
+     * @ingroup cmsis-plus-rtos-mutex
+     * @tparam T Type of the protected value.
+     *
+     * @details
+     * A value with a single writer, and any number of readers,
+     * none of them using critical sections.
+     *
+     * The writer increments the sequence number before and after
+     * each update, so it is odd while the update is in progress.
+     * The readers copy the value between two reads of the
+     * sequence number, and retry if it was odd or changed.
+     *
+     * The writer never waits, so it can be an interrupt
+     * handler of any priority; the readers retry only if an
+     * update happened while they were copying the value.
+     *
+     * @warning A reader must not preempt the writer in the middle
+     * of an update, for example a reader in an interrupt handler
+     * with a higher priority than the writer handler, since
+     * `load()` would retry forever; such readers must
+     * use `try_load()`.
+     */
+    template<typename T>
+      class seqlock
+      {
+      public:
+
+        static_assert(std::is_trivially_copyable<T>::value,
+            "seqlock<T>: T must be trivially copyable");
+
+        /**
+         * @brief Local type of the protected value.
+         */
+        using value_type = T;
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a sequence lock, with a zero value.
+         * @par Parameters
+         *  None.
+         */
+        constexpr
+        seqlock ();
+
+        /**
+         * @brief Construct a sequence lock, with an initial value.
+         * @param [in] value The initial value.
+         */
+        constexpr
+        seqlock (const value_type& value);
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        seqlock (const seqlock&) = delete;
+        seqlock (seqlock&&) = delete;
+        seqlock&
+        operator= (const seqlock&) = delete;
+        seqlock&
+        operator= (seqlock&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the sequence lock.
+         */
+        ~seqlock () = default;
+
+        /**
+         * @}
+         */
+
+      public:
+
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+        /**
+         * @brief Update the value.
+         * @param [in] value The new value.
+         * @par Returns
+         *  Nothing.
+         *
+         * @note Only one writer is allowed.
+         */
+        void
+        store (const value_type& value) noexcept;
+
+        /**
+         * @brief Start an update in place.
+         * @par Parameters
+         *  None.
+         * @return Reference to the value, to be updated.
+         *
+         * @note Only one writer is allowed; must be followed by
+         *  `write_end()`.
+         */
+        value_type&
+        write_begin (void) noexcept;
+
+        /**
+         * @brief End an update in place.
+         * @par Parameters
+         *  None.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        write_end (void) noexcept;
+
+        /**
+         * @brief Get a consistent copy of the value.
+         * @par Parameters
+         *  None.
+         * @return A copy of the value.
+         */
+        value_type
+        load (void) const noexcept;
+
+        /**
+         * @brief Try once to get a consistent copy of the value.
+         * @param [out] value The address where to store the copy.
+         * @retval true The copy is consistent.
+         * @retval false An update was in progress; the copy
+         *  must be discarded.
+         */
+        bool
+        try_load (value_type* value) const noexcept;
+
+        /**
+         * @brief Get the sequence number.
+         * @par Parameters
+         *  None.
+         * @return Twice the number of updates, plus one during an update.
+         */
+        std::size_t
+        sequence (void) const noexcept;
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        std::size_t sequence_ = 0;
+        value_type value_;
+
+        /**
+         * @endcond
+         */
+      };
+
+#pragma GCC diagnostic pop
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace rtos
+  {
+
+    template<typename T>
+      constexpr
+      seqlock<T>::seqlock () :
+          value_ ()
+      {
+        ;
+      }
+
+    template<typename T>
+      constexpr
+      seqlock<T>::seqlock (const value_type& value) :
+          value_ (value)
+      {
+        ;
+      }
+
+    /**
+     * @details
+     * The odd sequence number is stored before the value;
+     * the release fence keeps the value stores after it.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    template<typename T>
+      inline typename seqlock<T>::value_type&
+      seqlock<T>::write_begin (void) noexcept
+      {
+        std::size_t seq = __atomic_load_n (&sequence_, __ATOMIC_RELAXED);
+        __atomic_store_n (&sequence_, seq + 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence (__ATOMIC_RELEASE);
+
+        return value_;
+      }
+
+    /**
+     * @details
+     * The even sequence number is published after the value.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    template<typename T>
+      inline void
+      seqlock<T>::write_end (void) noexcept
+      {
+        std::size_t seq = __atomic_load_n (&sequence_, __ATOMIC_RELAXED);
+        __atomic_store_n (&sequence_, seq + 1, __ATOMIC_RELEASE);
+      }
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    template<typename T>
+      inline void
+      seqlock<T>::store (const value_type& value) noexcept
+      {
+        std::memcpy (&write_begin (), &value, sizeof(value_type));
+        write_end ();
+      }
+
+    /**
+     * @details
+     * The acquire fence keeps the value loads before the second
+     * read of the sequence number.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    template<typename T>
+      bool
+      seqlock<T>::try_load (value_type* value) const noexcept
+      {
+        std::size_t seq = __atomic_load_n (&sequence_, __ATOMIC_ACQUIRE);
+        if ((seq & 1) != 0)
+          {
+            // An update is in progress.
+            return false;
+          }
+
+        std::memcpy (value, &value_, sizeof(value_type));
+
+        __atomic_thread_fence (__ATOMIC_ACQUIRE);
+        return (__atomic_load_n (&sequence_, __ATOMIC_RELAXED) == seq);
+      }
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines,
+     *  if they cannot preempt the writer.
+     */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Waggregate-return"
+
+    template<typename T>
+      typename seqlock<T>::value_type
+      seqlock<T>::load (void) const noexcept
+      {
+        value_type value;
+        while (!try_load (&value))
+          {
+            ;
+          }
+        return value;
+      }
+
+#pragma GCC diagnostic pop
+
+    template<typename T>
+      inline std::size_t
+      seqlock<T>::sequence (void) const noexcept
+      {
+        return __atomic_load_n (&sequence_, __ATOMIC_ACQUIRE);
+      }
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_RTOS_OS_SEQLOCK_H_ */
@@ -0,0 +1,620 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_RTOS_OS_SPSC_H_
+#define CMSIS_PLUS_RTOS_OS_SPSC_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#include <cmsis-plus/rtos/os-decls.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Base class for single producer, single consumer channels.
+     * @headerfile os.h <cmsis-plus/rtos/os.h>
+     * @ingroup cmsis-plus-rtos-mqueue
+     *
+     * @details
+     * Type independent part of `spsc_channel`, with the ring
+     * indices and the waiting logic.
+     */
+    class spsc_channel_base : public internal::object_named_system
+    {
+    public:
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+      /**
+       * @brief Construct a channel base object instance.
+       * @param [in] name Pointer to name.
+       * @param [in] capacity The number of elements; a power of 2.
+       */
+      spsc_channel_base (const char* name, std::size_t capacity);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      spsc_channel_base (const spsc_channel_base&) = delete;
+      spsc_channel_base (spsc_channel_base&&) = delete;
+      spsc_channel_base&
+      operator= (const spsc_channel_base&) = delete;
+      spsc_channel_base&
+      operator= (spsc_channel_base&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @brief Destruct the channel base object instance.
+       */
+      ~spsc_channel_base ();
+
+      /**
+       * @}
+       */
+
+    public:
+
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+      /**
+       * @brief Get channel capacity.
+       * @par Parameters
+       *  None.
+       * @return The max number of elements in the channel.
+       */
+      std::size_t
+      capacity (void) const;
+
+      /**
+       * @brief Get channel length.
+       * @par Parameters
+       *  None.
+       * @return The number of elements in the channel.
+       */
+      std::size_t
+      length (void) const;
+
+      /**
+       * @brief Check if the channel is empty.
+       * @par Parameters
+       *  None.
+       * @retval true The channel has no elements.
+       * @retval false The channel has some elements.
+       */
+      bool
+      empty (void) const;
+
+      /**
+       * @brief Check if the channel is full.
+       * @par Parameters
+       *  None.
+       * @retval true The channel is full.
+       * @retval false The channel is not full.
+       */
+      bool
+      full (void) const;
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @name Private Member Functions
+       * @{
+       */
+
+      /**
+       * @cond ignore
+       */
+
+      /**
+       * @brief Internal function used to wait for the ring to be ready.
+       * @param [in] consumer Wait for an element, instead of space.
+       * @param [in] timeout The timeout duration.
+       * @param [in] timed Use the timeout.
+       * @retval result::ok The channel is ready.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINTR The operation was interrupted.
+       * @retval ETIMEDOUT The timeout expired.
+       */
+      result_t
+      internal_wait_ (bool consumer, clock::duration_t timeout, bool timed);
+
+      /**
+       * @brief Internal function used to wake-up the parked consumer.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_notify_consumer_ (void);
+
+      /**
+       * @brief Internal function used to wake-up the parked producer.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_notify_producer_ (void);
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @name Private Member Variables
+       * @{
+       */
+
+      /**
+       * @cond ignore
+       */
+
+      // Free running counters; only the producer writes head_,
+      // only the consumer writes tail_.
+      std::size_t head_ = 0;
+      std::size_t tail_ = 0;
+
+      std::size_t mask_;
+
+      // At most one thread in each list.
+      internal::waiting_threads_list producer_list_;
+      internal::waiting_threads_list consumer_list_;
+
+      // Set by the side that goes to sleep, before the last check.
+      bool producer_waiting_ = false;
+      bool consumer_waiting_ = false;
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @}
+       */
+    };
+
+    // ========================================================================
+
+    /**
+     * @brief Lock-free **single producer, single consumer** channel.
+     * @headerfile os.h <cmsis-plus/rtos/os.h>
+     * @ingroup cmsis-plus-rtos-mqueue
+     * @tparam T Type of elements.
+     * @tparam N Number of elements; must be a power of 2.
+     *
+     * @details
+     * A ring buffer with acquire/release indices, for exactly
+     * one producer and one consumer, either threads or ISRs.
+     *
+     * The non blocking `try_send()` and `try_receive()` do not
+     * disable interrupts; only when the other side is parked,
+     * waking it up enters the scheduler critical sections.
+     *
+     * Unlike `message_queue`, there are no priorities and no
+     * multiple waiters; the elements are received in FIFO order.
+     */
+    template<typename T, std::size_t N>
+      class spsc_channel : public spsc_channel_base
+      {
+      public:
+
+        static_assert(N >= 2 && (N & (N - 1)) == 0,
+            "spsc_channel<T, N>: N must be a power of 2");
+
+        /**
+         * @brief Local type of elements.
+         */
+        using value_type = T;
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a channel object instance.
+         * @param [in] name Pointer to name.
+         */
+        spsc_channel (const char* name = nullptr);
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        spsc_channel (const spsc_channel&) = delete;
+        spsc_channel (spsc_channel&&) = delete;
+        spsc_channel&
+        operator= (const spsc_channel&) = delete;
+        spsc_channel&
+        operator= (spsc_channel&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the channel object instance.
+         */
+        ~spsc_channel () = default;
+
+        /**
+         * @}
+         */
+
+      public:
+
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+        /**
+         * @brief Send an element, blocking if the channel is full.
+         * @param [in] value The element to send.
+         * @retval result::ok The element was sent.
+         * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+         * @retval EINTR The operation was interrupted.
+         */
+        result_t
+        send (const value_type& value);
+
+        /**
+         * @brief Try to send an element.
+         * @param [in] value The element to send.
+         * @retval result::ok The element was sent.
+         * @retval EWOULDBLOCK The channel is full.
+         */
+        result_t
+        try_send (const value_type& value);
+
+        /**
+         * @brief Send an element with timeout.
+         * @param [in] value The element to send.
+         * @param [in] timeout The timeout duration, in sysclock ticks.
+         * @retval result::ok The element was sent.
+         * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+         * @retval EINTR The operation was interrupted.
+         * @retval ETIMEDOUT The channel was still full when the
+         *  timeout expired.
+         */
+        result_t
+        timed_send (const value_type& value, clock::duration_t timeout);
+
+        /**
+         * @brief Receive an element, blocking if the channel is empty.
+         * @param [out] value The address where to store the element.
+         * @retval result::ok The element was received.
+         * @retval EINVAL A parameter is invalid.
+         * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+         * @retval EINTR The operation was interrupted.
+         */
+        result_t
+        receive (value_type* value);
+
+        /**
+         * @brief Try to receive an element.
+         * @param [out] value The address where to store the element.
+         * @retval result::ok The element was received.
+         * @retval EINVAL A parameter is invalid.
+         * @retval EWOULDBLOCK The channel is empty.
+         */
+        result_t
+        try_receive (value_type* value);
+
+        /**
+         * @brief Receive an element with timeout.
+         * @param [out] value The address where to store the element.
+         * @param [in] timeout The timeout duration, in sysclock ticks.
+         * @retval result::ok The element was received.
+         * @retval EINVAL A parameter is invalid.
+         * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+         * @retval EINTR The operation was interrupted.
+         * @retval ETIMEDOUT No element arrived before the
+         *  timeout expired.
+         */
+        result_t
+        timed_receive (value_type* value, clock::duration_t timeout);
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        value_type buffer_[N];
+
+        /**
+         * @endcond
+         */
+      };
+
+#pragma GCC diagnostic pop
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace rtos
+  {
+
+    inline std::size_t
+    spsc_channel_base::capacity (void) const
+    {
+      return mask_ + 1;
+    }
+
+    inline std::size_t
+    spsc_channel_base::length (void) const
+    {
+      return __atomic_load_n (&head_, __ATOMIC_ACQUIRE)
+          - __atomic_load_n (&tail_, __ATOMIC_ACQUIRE);
+    }
+
+    inline bool
+    spsc_channel_base::empty (void) const
+    {
+      return (length () == 0);
+    }
+
+    inline bool
+    spsc_channel_base::full (void) const
+    {
+      return (length () > mask_);
+    }
+
+    /**
+     * @details
+     * Called by the producer after publishing a new element.
+     * The full fence orders the `head_` store before reading
+     * the flag, matching the fence in `internal_wait_()`.
+     */
+    inline void
+    spsc_channel_base::internal_notify_consumer_ (void)
+    {
+      __atomic_thread_fence (__ATOMIC_SEQ_CST);
+      if (__atomic_exchange_n (&consumer_waiting_, false, __ATOMIC_ACQ_REL))
+        {
+          consumer_list_.resume_one ();
+        }
+    }
+
+    /**
+     * @details
+     * Called by the consumer after freeing a slot.
+     */
+    inline void
+    spsc_channel_base::internal_notify_producer_ (void)
+    {
+      __atomic_thread_fence (__ATOMIC_SEQ_CST);
+      if (__atomic_exchange_n (&producer_waiting_, false, __ATOMIC_ACQ_REL))
+        {
+          producer_list_.resume_one ();
+        }
+    }
+
+    // ========================================================================
+
+    template<typename T, std::size_t N>
+      inline
+      spsc_channel<T, N>::spsc_channel (const char* name) :
+          spsc_channel_base (name, N)
+      {
+        ;
+      }
+
+    /**
+     * @details
+     * Only the consumer writes `tail_`, so the producer reads it
+     * with acquire semantics, to see the slot freed; the element
+     * is published with a release store to `head_`.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    template<typename T, std::size_t N>
+      result_t
+      spsc_channel<T, N>::try_send (const value_type& value)
+      {
+        std::size_t head = __atomic_load_n (&head_, __ATOMIC_RELAXED);
+        if (head - __atomic_load_n (&tail_, __ATOMIC_ACQUIRE) > mask_)
+          {
+            return EWOULDBLOCK;
+          }
+
+        buffer_[head & mask_] = value;
+        __atomic_store_n (&head_, head + 1, __ATOMIC_RELEASE);
+
+        internal_notify_consumer_ ();
+
+        return result::ok;
+      }
+
+    /**
+     * @details
+     * Only the producer writes `head_`, so the consumer reads it
+     * with acquire semantics, to see the published element.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    template<typename T, std::size_t N>
+      result_t
+      spsc_channel<T, N>::try_receive (value_type* value)
+      {
+        os_assert_err(value != nullptr, EINVAL);
+
+        std::size_t tail = __atomic_load_n (&tail_, __ATOMIC_RELAXED);
+        if (__atomic_load_n (&head_, __ATOMIC_ACQUIRE) == tail)
+          {
+            return EWOULDBLOCK;
+          }
+
+        *value = buffer_[tail & mask_];
+        __atomic_store_n (&tail_, tail + 1, __ATOMIC_RELEASE);
+
+        internal_notify_producer_ ();
+
+        return result::ok;
+      }
+
+    /**
+     * @details
+     * With a single producer, once the wait returns, nobody else
+     * can fill the free slot, so the second `try_send()` succeeds.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    template<typename T, std::size_t N>
+      result_t
+      spsc_channel<T, N>::send (const value_type& value)
+      {
+        result_t res = try_send (value);
+        if (res == EWOULDBLOCK)
+          {
+            res = internal_wait_ (false, 0, false);
+            if (res == result::ok)
+              {
+                res = try_send (value);
+              }
+          }
+        return res;
+      }
+
+    /**
+     * @details
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    template<typename T, std::size_t N>
+      result_t
+      spsc_channel<T, N>::timed_send (const value_type& value,
+                                      clock::duration_t timeout)
+      {
+        result_t res = try_send (value);
+        if (res == EWOULDBLOCK)
+          {
+            res = internal_wait_ (false, timeout, true);
+            if (res == result::ok)
+              {
+                res = try_send (value);
+              }
+          }
+        return res;
+      }
+
+    /**
+     * @details
+     * With a single consumer, once the wait returns, nobody else
+     * can take the element, so the second `try_receive()` succeeds.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    template<typename T, std::size_t N>
+      result_t
+      spsc_channel<T, N>::receive (value_type* value)
+      {
+        result_t res = try_receive (value);
+        if (res == EWOULDBLOCK)
+          {
+            res = internal_wait_ (true, 0, false);
+            if (res == result::ok)
+              {
+                res = try_receive (value);
+              }
+          }
+        return res;
+      }
+
+    /**
+     * @details
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    template<typename T, std::size_t N>
+      result_t
+      spsc_channel<T, N>::timed_receive (value_type* value,
+                                         clock::duration_t timeout)
+      {
+        result_t res = try_receive (value);
+        if (res == EWOULDBLOCK)
+          {
+            res = internal_wait_ (true, timeout, true);
+            if (res == result::ok)
+              {
+                res = try_receive (value);
+              }
+          }
+        return res;
+      }
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_RTOS_OS_SPSC_H_ */
@@ -0,0 +1,414 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_RTOS_OS_STACK_POOL_H_
+#define CMSIS_PLUS_RTOS_OS_STACK_POOL_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#include <cmsis-plus/rtos/os-decls.h>
+#include <cmsis-plus/rtos/os-thread.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Pool of **thread stacks** of the same size.
+     * @headerfile os.h <cmsis-plus/rtos/os.h>
+     * @ingroup cmsis-plus-rtos-thread
+     *
+     * @details
+     * The stacks are blocks of a user defined arena, filled
+     * with the stack magic word when the pool is constructed;
+     * threads created with the `th_stack_pool` attribute take
+     * a block from the pool and return it when destroyed,
+     * after filling again only the part that was used.
+     *
+     * For stacks of different sizes, use one pool for each
+     * size class.
+     */
+    class stack_pool : public internal::object_named_system
+    {
+    public:
+
+      /**
+       * @brief Type of a stack element.
+       */
+      using element_t = thread::stack::element_t;
+
+      /**
+       * @brief Type of a stack allocation element.
+       */
+      using allocation_element_t = thread::stack::allocation_element_t;
+
+      /**
+       * @brief Calculator for the size of a pool block.
+       * @param stack_size_bytes Size of the stack, in bytes.
+       * @return The block size, rounded up to allocation elements.
+       */
+      static constexpr std::size_t
+      compute_block_size_bytes (std::size_t stack_size_bytes)
+      {
+        return ((stack_size_bytes + (sizeof(allocation_element_t) - 1))
+            & ~(sizeof(allocation_element_t) - 1));
+      }
+
+      /**
+       * @brief Calculator for pool storage requirements.
+       * @param stacks Number of stacks.
+       * @param stack_size_bytes Size of each stack, in bytes.
+       * @return Total required storage in bytes, excluding the
+       *  arena alignment.
+       */
+      static constexpr std::size_t
+      compute_allocated_size_bytes (std::size_t stacks,
+                                    std::size_t stack_size_bytes)
+      {
+        return stacks * compute_block_size_bytes (stack_size_bytes);
+      }
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+      /**
+       * @brief Construct a stack pool object instance.
+       * @param [in] stacks The maximum number of stacks in the pool.
+       * @param [in] stack_size_bytes The size of each stack, in bytes.
+       * @param [in] arena_address Pointer to the storage.
+       * @param [in] arena_size_bytes Size of the storage, in bytes.
+       */
+      stack_pool (std::size_t stacks, std::size_t stack_size_bytes,
+                  void* arena_address, std::size_t arena_size_bytes);
+
+      /**
+       * @brief Construct a named stack pool object instance.
+       * @param [in] name Pointer to name.
+       * @param [in] stacks The maximum number of stacks in the pool.
+       * @param [in] stack_size_bytes The size of each stack, in bytes.
+       * @param [in] arena_address Pointer to the storage.
+       * @param [in] arena_size_bytes Size of the storage, in bytes.
+       */
+      stack_pool (const char* name, std::size_t stacks,
+                  std::size_t stack_size_bytes, void* arena_address,
+                  std::size_t arena_size_bytes);
+
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      stack_pool (const char* name);
+
+      /**
+       * @endcond
+       */
+
+    public:
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      stack_pool (const stack_pool&) = delete;
+      stack_pool (stack_pool&&) = delete;
+      stack_pool&
+      operator= (const stack_pool&) = delete;
+      stack_pool&
+      operator= (stack_pool&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @brief Destruct the stack pool object instance.
+       */
+      ~stack_pool ();
+
+      /**
+       * @}
+       */
+
+    public:
+
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+      /**
+       * @brief Take a stack from the pool.
+       * @par Parameters
+       *  None.
+       * @return Pointer to the bottom of the stack, filled with
+       *  the magic word, or `nullptr` if the pool is empty.
+       */
+      void*
+      try_acquire (void);
+
+      /**
+       * @brief Return a stack to the pool.
+       * @param [in] stack Pointer to the bottom of the stack.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      release (void* stack);
+
+      /**
+       * @brief Get the size of each stack.
+       * @par Parameters
+       *  None.
+       * @return The stack size, in bytes.
+       */
+      std::size_t
+      stack_size (void) const;
+
+      /**
+       * @brief Get the pool capacity.
+       * @par Parameters
+       *  None.
+       * @return The max number of stacks in the pool.
+       */
+      std::size_t
+      capacity (void) const;
+
+      /**
+       * @brief Get the number of available stacks.
+       * @par Parameters
+       *  None.
+       * @return The number of stacks in the pool.
+       */
+      std::size_t
+      count (void) const;
+
+      /**
+       * @brief Check if the pool is empty.
+       * @par Parameters
+       *  None.
+       * @retval true All stacks are in use.
+       * @retval false There are available stacks.
+       */
+      bool
+      empty (void) const;
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @name Private Member Functions
+       * @{
+       */
+
+      /**
+       * @cond ignore
+       */
+
+      void
+      internal_construct_ (std::size_t stacks, std::size_t stack_size_bytes,
+                           void* arena_address, std::size_t arena_size_bytes);
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @name Private Member Variables
+       * @{
+       */
+
+      /**
+       * @cond ignore
+       */
+
+      // The list of free stacks, linked by the first word.
+      void* volatile first_ = nullptr;
+
+      std::size_t block_size_bytes_ = 0;
+
+      std::size_t capacity_ = 0;
+
+      std::size_t volatile count_ = 0;
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @}
+       */
+    };
+
+    // ========================================================================
+
+    /**
+     * @brief Pool of thread stacks with inclusive storage.
+     * @headerfile os.h <cmsis-plus/rtos/os.h>
+     * @ingroup cmsis-plus-rtos-thread
+     * @tparam N Number of stacks.
+     * @tparam Bytes Size of each stack, in bytes.
+     */
+    template<std::size_t N, std::size_t Bytes>
+      class stack_pool_inclusive : public stack_pool
+      {
+      public:
+
+        /**
+         * @brief Local constant based on template definition.
+         */
+        static const std::size_t stacks = N;
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a stack pool object instance.
+         * @param [in] name Pointer to name.
+         */
+        stack_pool_inclusive (const char* name = nullptr);
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        stack_pool_inclusive (const stack_pool_inclusive&) = delete;
+        stack_pool_inclusive (stack_pool_inclusive&&) = delete;
+        stack_pool_inclusive&
+        operator= (const stack_pool_inclusive&) = delete;
+        stack_pool_inclusive&
+        operator= (stack_pool_inclusive&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the stack pool object instance.
+         */
+        ~stack_pool_inclusive () = default;
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        allocation_element_t arena_[compute_allocated_size_bytes (N, Bytes)
+            / sizeof(allocation_element_t)];
+
+        /**
+         * @endcond
+         */
+      };
+
+#pragma GCC diagnostic pop
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace rtos
+  {
+
+    inline std::size_t
+    stack_pool::stack_size (void) const
+    {
+      return block_size_bytes_;
+    }
+
+    inline std::size_t
+    stack_pool::capacity (void) const
+    {
+      return capacity_;
+    }
+
+    inline std::size_t
+    stack_pool::count (void) const
+    {
+      return count_;
+    }
+
+    inline bool
+    stack_pool::empty (void) const
+    {
+      return (count_ == 0);
+    }
+
+    // ========================================================================
+
+    template<std::size_t N, std::size_t Bytes>
+      inline
+      stack_pool_inclusive<N, Bytes>::stack_pool_inclusive (const char* name) :
+          stack_pool
+            { name }
+      {
+        internal_construct_ (N, Bytes, &arena_, sizeof(arena_));
+      }
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_RTOS_OS_STACK_POOL_H_ */
@@ -55,6 +55,11 @@ namespace
 void
 os_rtos_idle_actions (void);
 
+#if defined(OS_INCLUDE_RTOS_THREAD_NEWLIB_REENT)
+// The newlib reentrancy structure, defined in <reent.h>.
+struct _reent;
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_NEWLIB_REENT) */
+
 /**
  * @endcond
  */
@@ -97,6 +102,23 @@ namespace os
       void
       yield (void);
 
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_HANDOFF)
+
+      /**
+       * @brief Yield execution directly to a given thread.
+       * @param [in] th Reference to a ready thread.
+       * @retval result::ok The target thread was given the CPU, or
+       *  it was preempted by a higher priority thread.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINVAL The target is the current thread, or, with SMP,
+       *  runs on another core.
+       * @retval EAGAIN The target is not ready.
+       */
+      result_t
+      handoff (rtos::thread& th);
+
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_HANDOFF) */
+
       /**
        * @brief Suspend the current running thread to wait for an event.
        * @par Parameters
@@ -188,6 +210,56 @@ namespace os
       result_t
       flags_clear (flags::mask_t mask, flags::mask_t* oflags = nullptr);
 
+#if defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS)
+
+      /**
+       * @brief Wait for a thread notification.
+       * @param [out] ovalue Pointer where to store the notification
+       *  value; may be `nullptr`.
+       * @param [in] clear The value bits to clear after reading it.
+       * @retval result::ok A notification was taken.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINTR The operation was interrupted.
+       * @retval ENOTRECOVERABLE Wait failed.
+       */
+      result_t
+      notify_wait (notify::value_t* ovalue = nullptr, notify::value_t clear =
+                       ~static_cast<notify::value_t> (0));
+
+      /**
+       * @brief Try to take a thread notification.
+       * @param [out] ovalue Pointer where to store the notification
+       *  value; may be `nullptr`.
+       * @param [in] clear The value bits to clear after reading it.
+       * @retval result::ok A notification was taken.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EWOULDBLOCK No notification is pending.
+       */
+      result_t
+      notify_try_wait (notify::value_t* ovalue = nullptr,
+                       notify::value_t clear = ~static_cast<notify::value_t> (0));
+
+      /**
+       * @brief Timed wait for a thread notification.
+       * @param [in] timeout Timeout to wait, in clock units (ticks or seconds).
+       * @param [out] ovalue Pointer where to store the notification
+       *  value; may be `nullptr`.
+       * @param [in] clear The value bits to clear after reading it.
+       * @retval result::ok A notification was taken.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval ETIMEDOUT No notification arrived during the
+       *  entire timeout duration.
+       * @retval EINTR The operation was interrupted.
+       * @retval ENOTRECOVERABLE Wait failed.
+       */
+      result_t
+      notify_timed_wait (clock::duration_t timeout, notify::value_t* ovalue =
+                             nullptr,
+                         notify::value_t clear =
+                             ~static_cast<notify::value_t> (0));
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS) */
+
       /**
        * @brief Get/clear thread event flags.
        * @param [in] mask The OR-ed flags to get/clear; may be zero.
@@ -201,6 +273,22 @@ namespace os
       flags_get (flags::mask_t mask,
                  flags::mode_t mode = flags::mode::all | flags::mode::clear);
 
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
+
+      /**
+       * @brief Wait for the next period of a periodic EDF thread.
+       * @par Parameters
+       *  None.
+       * @retval ETIMEDOUT The thread slept until the next release.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINVAL The current thread has no period.
+       * @retval EINTR The sleep was interrupted.
+       */
+      result_t
+      wait_next_period (void);
+
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_EDF) */
+
       /**
        * @brief Implementation of the library `__errno()` function.
        * @return Pointer to thread specific `errno`.
@@ -208,6 +296,57 @@ namespace os
       int*
       __errno (void);
 
+#if defined(OS_INCLUDE_RTOS_THREAD_LOCAL_SLOTS) || defined(__DOXYGEN__)
+
+      /**
+       * @brief Type of thread local storage keys.
+       * @details
+       * An index in the array of slots of each thread.
+       */
+      using local_key_t = std::size_t;
+
+      /**
+       * @brief Allocate a thread local storage key.
+       * @param [out] key Pointer where to store the new key.
+       * @retval result::ok The key was allocated.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINVAL The pointer is `nullptr`.
+       * @retval EAGAIN All keys are in use.
+       */
+      result_t
+      local_key_create (local_key_t* key);
+
+      /**
+       * @brief Release a thread local storage key.
+       * @param [in] key The key to release.
+       * @retval result::ok The key was released.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINVAL The key is not allocated.
+       */
+      result_t
+      local_key_delete (local_key_t key);
+
+      /**
+       * @brief Get the value of a thread local storage slot.
+       * @param [in] key A key allocated by `local_key_create()`.
+       * @return The value stored by the current thread, or
+       *  `nullptr` if none was stored.
+       */
+      void*
+      local_slot (local_key_t key);
+
+      /**
+       * @brief Set the value of a thread local storage slot.
+       * @param [in] key A key allocated by `local_key_create()`.
+       * @param [in] value The value for the current thread.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      local_slot (local_key_t key, void* value);
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_LOCAL_SLOTS) */
+
     } /* namespace this_thread */
 
     // Forward definitions required by thread friends.
@@ -331,6 +470,36 @@ namespace os
         };
       }; /* struct priority */
 
+#if defined(OS_INCLUDE_RTOS_SMP)
+
+      /**
+       * @brief Type of variables holding core indices.
+       * @ingroup cmsis-plus-rtos-thread
+       */
+      using core_t = uint8_t;
+
+      /**
+       * @brief Run on the core that creates the thread.
+       * @ingroup cmsis-plus-rtos-thread
+       */
+      static constexpr core_t current_core = 0xFF;
+
+      /**
+       * @brief Type of variables holding core affinity masks.
+       * @details
+       * One bit for each core, bit 0 for the boot core.
+       * @ingroup cmsis-plus-rtos-thread
+       */
+      using affinity_t = uint32_t;
+
+      /**
+       * @brief Allow the thread to run on any core.
+       * @ingroup cmsis-plus-rtos-thread
+       */
+      static constexpr affinity_t any_core = 0;
+
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+
       /**
        * @brief Type of variables holding thread states.
        */
@@ -396,6 +565,17 @@ namespace os
        */
       using func_t = void* (*) (func_args_t args);
 
+#if defined(OS_INCLUDE_RTOS_THREAD_BUDGET)
+
+      /**
+       * @brief Type of execution budget overrun handlers.
+       * @param [in] th The thread that exceeded its budget.
+       * @param [in] args Pointer to the argument passed to `budget()`.
+       */
+      using budget_func_t = void (*) (thread* th, void* args);
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_BUDGET) */
+
       // ======================================================================
 
       /**
@@ -555,6 +735,20 @@ namespace os
         std::size_t
         available (void);
 
+#if defined(OS_INCLUDE_RTOS_THREAD_STACK_SCAN)
+
+        /**
+         * @brief Get the maximum stack usage seen so far.
+         * @par Parameters
+         *  None.
+         * @return Number of used bytes, as cached by the
+         *  idle thread scan.
+         */
+        std::size_t
+        high_water_mark (void);
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_STACK_SCAN) */
+
         /**
          * @}
          */
@@ -612,9 +806,42 @@ namespace os
 
         friend class rtos::thread;
 
+#if defined(OS_INCLUDE_RTOS_THREAD_STACK_SCAN)
+        friend void
+        ::os_rtos_idle_actions (void);
+
+        /**
+         * @brief Scan a few more words of the stack.
+         * @param [in] words Maximum number of words to check.
+         * @retval true The scan pass is complete.
+         * @retval false More words remain to be checked.
+         */
+        bool
+        internal_scan_ (std::size_t words);
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_STACK_SCAN) */
+
+#if defined(OS_INCLUDE_RTOS_THREAD_STACK_POOL)
+        /**
+         * @brief Use a stack already aligned and filled by a pool.
+         * @par Parameters
+         *  None.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        internal_adopt_ (void);
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_STACK_POOL) */
+
         stack::element_t* bottom_address_;
         std::size_t size_bytes_;
 
+#if defined(OS_INCLUDE_RTOS_THREAD_STACK_SCAN)
+        // The next word to check, or `nullptr` to start a new pass,
+        // and the lowest word known to be used.
+        stack::element_t* scan_address_;
+        stack::element_t* peak_address_;
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_STACK_SCAN) */
+
         static std::size_t min_size_bytes_;
         static std::size_t default_size_bytes_;
 
@@ -841,6 +1068,94 @@ namespace os
          */
         priority_t th_priority = priority::normal;
 
+#if defined(OS_INCLUDE_RTOS_THREAD_STACK_POOL)
+
+        /**
+         * @brief Pool to take the thread stack from.
+         * @details
+         * If not `nullptr`, and there is no user defined storage,
+         * the stack is taken from the pool and `th_stack_size_bytes`
+         * is ignored.
+         */
+        stack_pool* th_stack_pool = nullptr;
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_STACK_POOL) */
+
+#if defined(OS_INCLUDE_RTOS_SMP)
+
+        /**
+         * @brief Core to run the thread on.
+         * @details
+         * Threads do not migrate between cores; the default is the
+         * core that creates the thread.
+         */
+        core_t th_core = current_core;
+
+        /**
+         * @brief Cores the thread may run on.
+         * @details
+         * The load balancer moves the thread only between these
+         * cores; a single bit pins the thread to one core.
+         * If 0, the thread may run on any core.
+         */
+        affinity_t th_affinity = any_core;
+
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
+
+        /**
+         * @brief Relative deadline, in clock units.
+         * @details
+         * If not 0, the thread belongs to the EDF scheduling class,
+         * and `th_priority` is replaced by
+         * `OS_INTEGER_RTOS_SCHEDULER_EDF_PRIORITY`.
+         */
+        clock::duration_t th_deadline = 0;
+
+        /**
+         * @brief Period, in clock units.
+         * @details
+         * Used by `this_thread::wait_next_period()`; 0 for
+         * aperiodic threads.
+         */
+        clock::duration_t th_period = 0;
+
+        /**
+         * @brief Worst case execution time of a job, in clock units.
+         * @details
+         * Used only by the admission control.
+         */
+        clock::duration_t th_budget = 0;
+
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_EDF) */
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING)
+
+        /**
+         * @brief Time slice, in ticks.
+         * @details
+         * If 0, the quantum of the thread priority class is used
+         * (see `scheduler::quantum()`).
+         */
+        clock::duration_t th_quantum = 0;
+
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING) */
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_PREEMPTION_THRESHOLD)
+
+        /**
+         * @brief Preemption threshold.
+         * @details
+         * While running, the thread can be preempted only by threads
+         * with priorities above this value.
+         * If `priority::none`, or not above `th_priority`, the
+         * thread can be preempted by any higher priority thread.
+         */
+        priority_t th_preemption_threshold = priority::none;
+
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_PREEMPTION_THRESHOLD) */
+
         // Add more attributes here.
 
         /**
@@ -860,6 +1175,170 @@ namespace os
       class statistics
       {
       public:
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_PROFILE)
+
+        /**
+         * @name Types and constants
+         * @{
+         */
+
+        /**
+         * @brief Number of run time histogram buckets.
+         * @details
+         * Bucket `i` counts the running slices with durations
+         * between `4^i` and `4^(i+1)` CPU cycles; the last bucket
+         * also counts all longer slices, same as the global
+         * statistics histograms.
+         */
+        static constexpr std::size_t histogram_buckets =
+            rtos::statistics::histogram_buckets;
+
+        /**
+         * @brief Number of objects with separate blocked times.
+         */
+        static constexpr std::size_t blocked_objects = 4;
+
+        /**
+         * @brief Time blocked on a synchronisation object.
+         */
+        typedef struct blocked_object_s
+        {
+          /**
+           * @brief Address of the object waiting list, or the clock
+           * steady list for sleeps, or `nullptr` for thread flags.
+           */
+          const void* object;
+
+          /**
+           * @brief Number of times the thread was blocked.
+           */
+          rtos::statistics::counter_t count;
+
+          /**
+           * @brief Accumulated blocked duration, in CPU cycles.
+           */
+          rtos::statistics::duration_t cycles;
+        } blocked_object;
+
+        /**
+         * @brief Copy of the thread profiling data.
+         */
+        typedef struct profile_s
+        {
+          /**
+           * @brief Pointer to the thread.
+           */
+          thread* th;
+
+          /**
+           * @brief Thread name.
+           */
+          const char* name;
+
+          /**
+           * @brief Thread state.
+           */
+          state_t state;
+
+          /**
+           * @brief Number of context switches.
+           */
+          rtos::statistics::counter_t context_switches;
+
+          /**
+           * @brief Accumulated execution time, in CPU cycles.
+           */
+          rtos::statistics::duration_t cpu_cycles;
+
+          /**
+           * @brief Number of times the thread was switched out
+           * while still ready to run.
+           */
+          rtos::statistics::counter_t preemptions;
+
+          /**
+           * @brief Worst-case ready to running latency, in CPU cycles.
+           */
+          rtos::statistics::duration_t max_latency;
+
+          /**
+           * @brief Accumulated blocked duration, in CPU cycles.
+           */
+          rtos::statistics::duration_t blocked_cycles;
+
+          /**
+           * @brief Histogram of the running slices durations.
+           */
+          rtos::statistics::counter_t histogram[histogram_buckets];
+
+          /**
+           * @brief Blocked durations, for the first objects.
+           */
+          blocked_object objects[blocked_objects];
+        } profile;
+
+        /**
+         * @}
+         */
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_PROFILE) */
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_EVENTS)
+
+        /**
+         * @brief Copy of the thread hardware event counts.
+         * @details
+         * The counts not available on the current core are zero.
+         */
+        typedef struct event_counters_s
+        {
+          /**
+           * @brief Additional cycles of the multi-cycle instructions
+           * and the instruction fetch stalls (DWT `CPICNT`).
+           */
+          rtos::statistics::counter_t cpi;
+
+          /**
+           * @brief Cycles spent in exception entry and exit
+           * (DWT `EXCCNT`).
+           */
+          rtos::statistics::counter_t exception;
+
+          /**
+           * @brief Cycles spent sleeping (DWT `SLEEPCNT`).
+           */
+          rtos::statistics::counter_t sleep;
+
+          /**
+           * @brief Additional cycles of the load/store
+           * instructions (DWT `LSUCNT`).
+           */
+          rtos::statistics::counter_t lsu;
+
+          /**
+           * @brief Folded instructions (DWT `FOLDCNT`).
+           */
+          rtos::statistics::counter_t fold;
+
+          /**
+           * @brief Data cache read misses (PMU, Armv8.1-M only).
+           */
+          rtos::statistics::counter_t cache_misses;
+        } event_counters;
+
+        /**
+         * @cond ignore
+         */
+
+        static constexpr std::size_t event_types = 6;
+
+        /**
+         * @endcond
+         */
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_EVENTS) */
+
         /**
          * @name Constructors & Destructor
          * @{
@@ -931,9 +1410,59 @@ namespace os
 
 #endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES) */
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_PROFILE)
+
         /**
-         * @}
+         * @brief Copy the profiling data.
+         * @param [out] out Reference to the profile to fill in.
+         * @par Returns
+         *  Nothing.
          */
+        void
+        snapshot (profile& out);
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_PROFILE) */
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_EVENTS)
+
+        /**
+         * @brief Copy the hardware event counts.
+         * @param [out] out Reference to the counters to fill in.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        snapshot (event_counters& out);
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_EVENTS) */
+
+        /**
+         * @}
+         */
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_PROFILE)
+
+        /**
+         * @cond ignore
+         */
+
+        void
+        internal_waiting_for_ (const void* object);
+
+        void
+        internal_ready_ (clock::timestamp_t now);
+
+        void
+        internal_switch_out_ (clock::timestamp_t now, state_t state);
+
+        void
+        internal_switch_in_ (clock::timestamp_t now);
+
+        /**
+         * @endcond
+         */
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_PROFILE) */
 
       protected:
 
@@ -944,6 +1473,11 @@ namespace os
         friend void
         rtos::scheduler::internal_switch_threads (void);
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_EVENTS)
+        friend void
+        rtos::scheduler::statistics::internal_sample_events_ (void);
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_EVENTS) */
+
 #if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CONTEXT_SWITCHES)
         rtos::statistics::counter_t context_switches_ = 0;
 #endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CONTEXT_SWITCHES) */
@@ -952,6 +1486,31 @@ namespace os
         rtos::statistics::duration_t cpu_cycles_ = 0;
 #endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES) */
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_EVENTS)
+        // Same order as the event_counters members.
+        rtos::statistics::counter_t events_[event_types] =
+          { };
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_EVENTS) */
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_PROFILE)
+        rtos::statistics::counter_t preemptions_ = 0;
+        rtos::statistics::duration_t max_latency_ = 0;
+        rtos::statistics::duration_t blocked_cycles_ = 0;
+        rtos::statistics::counter_t histogram_[histogram_buckets] =
+          { };
+        blocked_object objects_[blocked_objects] =
+          { };
+
+        // The current running slice, possibly split by
+        // several switches which resumed the same thread.
+        rtos::statistics::duration_t slice_cycles_ = 0;
+        clock::timestamp_t ready_timestamp_ = 0;
+        clock::timestamp_t block_timestamp_ = 0;
+        const void* block_object_ = nullptr;
+        bool ready_ = false;
+        bool blocked_ = false;
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_PROFILE) */
+
         /**
          * @endcond
          */
@@ -1182,6 +1741,209 @@ namespace os
       state_t
       state (void) const;
 
+#if defined(OS_INCLUDE_RTOS_SMP)
+
+      /**
+       * @brief Get the core the thread runs on.
+       * @par Parameters
+       *  None.
+       * @return The core index.
+       */
+      core_t
+      core (void) const;
+
+      /**
+       * @brief Get the core affinity mask.
+       * @par Parameters
+       *  None.
+       * @return The mask of the cores the thread may run on.
+       */
+      affinity_t
+      affinity (void) const;
+
+      /**
+       * @brief Set the core affinity mask.
+       * @param [in] mask One bit for each allowed core, or `any_core`.
+       * @retval result::ok The mask was set; if the thread
+       *  was on another core, it was moved to the first allowed one.
+       * @retval EINVAL The mask has no valid core.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       */
+      result_t
+      affinity (affinity_t mask);
+
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
+
+      /**
+       * @brief Check if the thread is in the EDF scheduling class.
+       * @par Parameters
+       *  None.
+       * @retval true The thread is scheduled by deadline.
+       * @retval false The thread is scheduled by priority.
+       */
+      bool
+      edf (void) const;
+
+      /**
+       * @brief Get the absolute deadline.
+       * @par Parameters
+       *  None.
+       * @return The deadline of the current job, in clock units.
+       */
+      clock::timestamp_t
+      deadline (void) const;
+
+      /**
+       * @brief Set the relative deadline of the current job.
+       * @param [in] relative Deadline from now, in clock units.
+       * @retval result::ok The deadline was set.
+       * @retval EINVAL The thread is not in the EDF class, or
+       *  the deadline is 0.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       */
+      result_t
+      deadline (clock::duration_t relative);
+
+      /**
+       * @brief Get the number of missed deadlines.
+       * @par Parameters
+       *  None.
+       * @return The number of jobs that ended after their deadline.
+       */
+      rtos::statistics::counter_t
+      deadline_misses (void) const;
+
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_EDF) */
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING)
+
+      /**
+       * @brief Get the thread time slice.
+       * @par Parameters
+       *  None.
+       * @return The quantum in ticks, or 0 if the quantum
+       *  of the priority class is used.
+       */
+      clock::duration_t
+      quantum (void) const;
+
+      /**
+       * @brief Set the thread time slice.
+       * @param [in] ticks The quantum in ticks, or 0 to use the
+       *  quantum of the priority class.
+       * @retval result::ok The quantum was set; it is used
+       *  from the next time slice.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       */
+      result_t
+      quantum (clock::duration_t ticks);
+
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING) */
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_PREEMPTION_THRESHOLD)
+
+      /**
+       * @brief Get the preemption threshold.
+       * @par Parameters
+       *  None.
+       * @return The threshold, or `priority::none`.
+       */
+      priority_t
+      preemption_threshold (void) const;
+
+      /**
+       * @brief Set the preemption threshold.
+       * @param [in] prio The new threshold, or `priority::none`.
+       * @retval result::ok The threshold was set.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINVAL The value is outside of the permitted range.
+       */
+      result_t
+      preemption_threshold (priority_t prio);
+
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_PREEMPTION_THRESHOLD) */
+
+#if defined(OS_INCLUDE_RTOS_TIMER_SLACK)
+
+      /**
+       * @brief Get the timer slack.
+       * @par Parameters
+       *  None.
+       * @return The slack, in clock units.
+       */
+      clock::duration_t
+      timer_slack (void) const;
+
+      /**
+       * @brief Set the timer slack.
+       * @param [in] slack How late the thread timeouts may expire,
+       *  in clock units.
+       * @retval result::ok The slack was set.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       */
+      result_t
+      timer_slack (clock::duration_t slack);
+
+#endif /* defined(OS_INCLUDE_RTOS_TIMER_SLACK) */
+
+#if defined(OS_INCLUDE_RTOS_THREAD_BUDGET)
+
+      /**
+       * @brief Get the execution budget.
+       * @par Parameters
+       *  None.
+       * @return The budget of each activation, in CPU cycles,
+       *  or 0 if not monitored.
+       */
+      rtos::statistics::duration_t
+      budget (void) const;
+
+      /**
+       * @brief Set the execution budget.
+       * @param [in] cycles The budget of each activation, in CPU
+       *  cycles, or 0 to stop the monitoring.
+       * @param [in] func Pointer to the overrun handler; may be `nullptr`.
+       * @param [in] args Pointer to the handler argument.
+       * @retval result::ok The budget was set and a new activation
+       *  started.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       */
+      result_t
+      budget (rtos::statistics::duration_t cycles,
+              budget_func_t func = nullptr, void* args = nullptr);
+
+      /**
+       * @brief Start a new activation.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      budget_restart (void);
+
+      /**
+       * @brief Get the CPU cycles used in the current activation.
+       * @par Parameters
+       *  None.
+       * @return The number of CPU cycles.
+       */
+      rtos::statistics::duration_t
+      budget_used (void);
+
+      /**
+       * @brief Get the number of budget overruns.
+       * @par Parameters
+       *  None.
+       * @return The number of activations that exceeded the budget.
+       */
+      rtos::statistics::counter_t
+      budget_overruns (void) const;
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_BUDGET) */
+
       /**
        * @brief Resume the thread.
        * @par Parameters
@@ -1225,6 +1987,34 @@ namespace os
       result_t
       flags_raise (flags::mask_t mask, flags::mask_t* oflags = nullptr);
 
+#if defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS)
+
+      /**
+       * @brief Notify the thread.
+       * @param [in] value The value, used as selected by the action.
+       * @param [in] act How the notification value is updated.
+       * @param [out] oprevious Optional pointer where to store the
+       *  previous value; may be `nullptr`.
+       * @retval result::ok The thread was notified.
+       * @retval EAGAIN With `notify::action::no_overwrite`, the
+       *  previous notification was not yet taken.
+       */
+      result_t
+      notify (notify::value_t value, notify::action act =
+                  notify::action::set_bits,
+              notify::value_t* oprevious = nullptr);
+
+      /**
+       * @brief Get the thread notification value.
+       * @par Parameters
+       *  None.
+       * @return The current value, without taking the notification.
+       */
+      notify::value_t
+      notify_value (void);
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS) */
+
 #if defined(OS_INCLUDE_RTOS_THREAD_PUBLIC_FLAGS_CLEAR)
 
       // This is a kludge required to support CMSIS RTOS V1
@@ -1260,6 +2050,34 @@ namespace os
 
 #endif
 
+#if defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE)
+
+      /**
+       * @brief Get the thread allocation cache.
+       * @par Parameters
+       *  None.
+       * @return A reference to the allocation cache object instance.
+       */
+      memory::allocation_cache&
+      allocation_cache (void);
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE) */
+
+#if defined(OS_INCLUDE_RTOS_THREAD_NEWLIB_REENT)
+
+      /**
+       * @brief Get the thread newlib reentrancy structure.
+       * @par Parameters
+       *  None.
+       * @return A pointer to the thread structure, allocated on
+       *  the first call, or to the global structure if the pool
+       *  is exhausted.
+       */
+      struct _reent*
+      newlib_reent (void);
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_NEWLIB_REENT) */
+
       /**
        * @}
        */
@@ -1301,9 +2119,40 @@ namespace os
       friend flags::mask_t
       this_thread::flags_get (flags::mask_t mask, flags::mode_t mode);
 
+#if defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS)
+      friend result_t
+      this_thread::notify_wait (notify::value_t* ovalue,
+                                notify::value_t clear);
+
+      friend result_t
+      this_thread::notify_try_wait (notify::value_t* ovalue,
+                                    notify::value_t clear);
+
+      friend result_t
+      this_thread::notify_timed_wait (clock::duration_t timeout,
+                                      notify::value_t* ovalue,
+                                      notify::value_t clear);
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS) */
+
       friend int*
       this_thread::__errno (void);
 
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
+      friend result_t
+      this_thread::wait_next_period (void);
+#endif
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING) \
+  || defined(OS_INCLUDE_RTOS_SCHEDULER_PREEMPTION_THRESHOLD)
+      friend void
+      this_thread::yield (void);
+#endif
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_HANDOFF)
+      friend result_t
+      this_thread::handoff (rtos::thread& th);
+#endif
+
       friend void
       scheduler::internal_link_node (internal::waiting_threads_list& list,
                                      internal::waiting_thread_node& node);
@@ -1326,6 +2175,33 @@ namespace os
       friend void
       scheduler::internal_switch_threads (void);
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK_LATENCY)
+      friend void
+      rtos::statistics::internal_record_woken_ (thread& th);
+
+      friend void
+      rtos::statistics::internal_record_running_ (thread& th);
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK_LATENCY) */
+
+#if defined(OS_INCLUDE_RTOS_SMP) \
+  && defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES)
+      friend void
+      scheduler::internal_balance_ (void);
+#endif
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING)
+      friend void
+      scheduler::internal_consume_slice_ (void);
+#endif
+
+#if defined(OS_INCLUDE_RTOS_THREAD_BUDGET)
+      friend void
+      scheduler::internal_check_budget_ (void);
+#endif
+
+      friend std::size_t
+      scheduler::internal_reap_terminated_ (void);
+
       friend void
       port::scheduler::reschedule (void);
 
@@ -1504,6 +2380,39 @@ namespace os
       flags::mask_t
       internal_flags_get_ (flags::mask_t mask, flags::mode_t mode);
 
+#if !defined(OS_USE_RTOS_PORT_SCHEDULER)
+
+      /**
+       * @brief Requeue the thread after its priority changed.
+       * @param [in] old_prio The previous effective priority.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_priority_changed_ (priority_t old_prio);
+
+#endif /* !defined(OS_USE_RTOS_PORT_SCHEDULER) */
+
+#if defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS)
+
+      result_t
+      internal_notify_wait_ (notify::value_t* ovalue, notify::value_t clear);
+
+      result_t
+      internal_notify_try_wait_ (notify::value_t* ovalue,
+                                 notify::value_t clear);
+
+      result_t
+      internal_notify_timed_wait_ (clock::duration_t timeout,
+                                   notify::value_t* ovalue,
+                                   notify::value_t clear);
+
+      // Must be called in a critical section.
+      bool
+      internal_notify_take_ (notify::value_t* ovalue, notify::value_t clear);
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS) */
+
       /**
        * @brief The actual destructor, also called from exit() and kill().
        * @par Parameters
@@ -1521,16 +2430,158 @@ namespace os
        *  Nothing.
        */
       void
-      internal_relink_running_ (void);
+      internal_relink_running_ (void);
+
+#if !defined(OS_USE_RTOS_PORT_SCHEDULER)
+
+      /**
+       * @par Parameters
+       *  None.
+       * @return The ready list of the thread core.
+       */
+      internal::ready_threads_list&
+      internal_ready_list_ (void);
+
+#endif
+
+#if defined(OS_INCLUDE_RTOS_SMP)
+
+      /**
+       * @param [in] core The new core.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_migrate_ (core_t core);
+
+      /**
+       * @param [in] mask Affinity mask.
+       * @return The mask of the existing cores allowed by _mask_.
+       */
+      static affinity_t
+      internal_allowed_cores_ (affinity_t mask);
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES)
+
+      /**
+       * @param [in] parent Parent of the threads, recursively;
+       *  `nullptr` for the top threads.
+       * @param [out] loads Array with the CPU cycles of each core.
+       * @par Returns
+       *  Nothing.
+       */
+      static void
+      internal_balance_measure_ (thread* parent,
+                                 rtos::statistics::duration_t* loads);
+
+      /**
+       * @param [in] parent Parent of the threads, recursively;
+       *  `nullptr` for the top threads.
+       * @param [in] from Core to move a thread from.
+       * @param [in] to Core to move the thread to.
+       * @param [in] limit Maximum load allowed for the moved thread.
+       * @param [in] best Best candidate found so far, or `nullptr`.
+       * @return The busiest candidate below the limit, or `nullptr`.
+       */
+      static thread*
+      internal_balance_pick_ (thread* parent, core_t from, core_t to,
+                              rtos::statistics::duration_t limit,
+                              thread* best);
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES) */
+
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
+
+      /**
+       * @param [in] other Another ready thread, of the same priority.
+       * @retval true This thread must run before _other_.
+       * @retval false Otherwise.
+       */
+      bool
+      internal_edf_precedes_ (const thread& other) const;
+
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_EDF) */
+
+#if defined(OS_INCLUDE_RTOS_THREAD_BUDGET)
+
+      /**
+       * @brief Report the overrun of the execution budget.
+       * @param [in] running The CPU cycles used since the
+       *  last context switch and not yet accounted.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_check_budget_ (rtos::statistics::duration_t running);
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_BUDGET) */
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING)
+
+      /**
+       * @par Parameters
+       *  None.
+       * @return The effective quantum, in ticks.
+       */
+      clock::duration_t
+      internal_quantum_ (void);
+
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING) */
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_PREEMPTION_THRESHOLD)
+
+      /**
+       * @par Parameters
+       *  None.
+       * @retval true The thread runs and no ready thread
+       *  is above its threshold.
+       * @retval false The thread can be switched out.
+       */
+      bool
+      internal_above_threshold_ (void);
+
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_PREEMPTION_THRESHOLD) */
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_HANDOFF)
+
+      /**
+       * @par Parameters
+       *  None.
+       * @return The thread to switch to, or `nullptr` to
+       *  use the top of the ready list.
+       */
+      thread*
+      internal_handoff_target_ (void);
+
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_HANDOFF) */
+
+      /**
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_check_stack_ (void);
+
+#if defined(OS_INCLUDE_RTOS_THREAD_STACK_POOL)
 
       /**
-       * @par Parameters
-       *  None.
+       * @brief Construct the thread with a stack from the pool,
+       *  possibly destroying terminated threads to make room.
+       * @param [in] function Pointer to thread function.
+       * @param [in] args Pointer to thread function arguments.
+       * @param [in] attr Reference to attributes.
        * @par Returns
        *  Nothing.
        */
       void
-      internal_check_stack_ (void);
+      internal_construct_pooled_ (func_t function, func_args_t args,
+                                  const attributes& attr);
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_STACK_POOL) */
 
       /**
        * @endcond
@@ -1588,6 +2639,10 @@ namespace os
       // Pointer to timeout node (stored on stack)
       internal::timeout_thread_node* clock_node_ = nullptr;
 
+      // Pointer to the mutex this thread is blocked on, used to
+      // propagate the inherited priority to its owner.
+      mutex* blocking_mutex_ = nullptr;
+
       /**
        * @brief Pointer to clock to be used for timeouts.
        */
@@ -1602,6 +2657,11 @@ namespace os
 
       std::size_t allocated_stack_size_elements_ = 0;
 
+#if defined(OS_INCLUDE_RTOS_THREAD_STACK_POOL)
+      // The pool the stack was taken from, if any.
+      stack_pool* stack_pool_ = nullptr;
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_STACK_POOL) */
+
       // TODO: Add a list, to properly process robustness.
       std::size_t volatile acquired_mutexes_ = 0;
 
@@ -1631,7 +2691,77 @@ namespace os
       priority_t volatile prio_assigned_ = priority::none;
       priority_t volatile prio_inherited_ = priority::none;
 
+#if !defined(OS_EXCLUDE_RTOS_THREAD_CANCELLATION)
       bool volatile interrupted_ = false;
+#endif /* !defined(OS_EXCLUDE_RTOS_THREAD_CANCELLATION) */
+
+#if defined(OS_INCLUDE_RTOS_SMP)
+      core_t core_ = 0;
+      affinity_t affinity_ = any_core;
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES)
+      // The CPU cycles at the previous load balancing, and
+      // the cycles used since the one before it.
+      rtos::statistics::duration_t balance_cycles_ = 0;
+      rtos::statistics::duration_t balance_load_ = 0;
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES) */
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
+      // The release time and the absolute deadline of the current job;
+      // a zero relative deadline means a fixed priority thread.
+      clock::timestamp_t edf_release_ = 0;
+      clock::timestamp_t edf_deadline_ = 0;
+      clock::duration_t edf_relative_ = 0;
+      clock::duration_t edf_period_ = 0;
+      clock::duration_t edf_budget_ = 0;
+      rtos::statistics::counter_t deadline_misses_ = 0;
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_EDF) */
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING)
+      // The assigned quantum (0 for the priority class one), and the
+      // ticks left in the current slice; 0 means the slice expired.
+      clock::duration_t quantum_ = 0;
+      clock::duration_t volatile slice_left_ = 0;
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING) */
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_PREEMPTION_THRESHOLD)
+      priority_t volatile threshold_ = priority::none;
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_PREEMPTION_THRESHOLD) */
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_HANDOFF)
+      // The thread to switch to at the next context switch.
+      thread* volatile handoff_ = nullptr;
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_HANDOFF) */
+
+#if defined(OS_INCLUDE_RTOS_TIMER_SLACK)
+      // How late the sleeps and the timed waits may expire.
+      clock::duration_t timer_slack_ = 0;
+#endif /* defined(OS_INCLUDE_RTOS_TIMER_SLACK) */
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK_LATENCY)
+      // The clock statistics of the last timeout that woke the
+      // thread, and when, until the thread runs.
+      void* latency_slot_ = nullptr;
+      clock::timestamp_t latency_woken_ = 0;
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK_LATENCY) */
+
+#if defined(OS_INCLUDE_RTOS_THREAD_BUDGET)
+      // The budget of each activation, and the CPU cycles
+      // of the thread when the activation started.
+      rtos::statistics::duration_t budget_cycles_ = 0;
+      rtos::statistics::duration_t budget_base_ = 0;
+      budget_func_t budget_func_ = nullptr;
+      void* budget_args_ = nullptr;
+      rtos::statistics::counter_t budget_overruns_ = 0;
+      // Set after the overrun is reported, once for each activation.
+      bool volatile budget_fired_ = false;
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_BUDGET) */
+
+#if defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS)
+      notify::value_t volatile notify_value_ = 0;
+      // One of notify_none, notify_pending or notify_waiting.
+      uint8_t volatile notify_state_ = 0;
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS) */
 
       internal::event_flags event_flags_;
 
@@ -1645,6 +2775,27 @@ namespace os
 
 #endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CONTEXT_SWITCHES) */
 
+#if defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE)
+
+      memory::allocation_cache allocation_cache_;
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE) */
+
+#if defined(OS_INCLUDE_RTOS_THREAD_NEWLIB_REENT)
+
+      // Allocated from the pool on first use, null until then.
+      struct _reent* volatile newlib_reent_ = nullptr;
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_NEWLIB_REENT) */
+
+#if defined(OS_INCLUDE_RTOS_THREAD_LOCAL_SLOTS)
+
+      // Accessed via scheduler::local_slots_ while the thread runs.
+      void* local_slots_[OS_INTEGER_RTOS_THREAD_LOCAL_SLOTS] =
+        { };
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_LOCAL_SLOTS) */
+
       // Add other internal data
 
       // Implementation
@@ -1987,6 +3138,50 @@ namespace os
         return this_thread::thread ().internal_flags_get_ (mask, mode);
       }
 
+#if defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS)
+
+      /**
+       * @details
+       * If a notification is pending, return its value at once;
+       * otherwise suspend until `thread::notify()` is called.
+       * The bits in `clear` are cleared from the value after it is
+       * read; the default clears the entire value, and 0 keeps it.
+       *
+       * @warning Cannot be invoked from Interrupt Service Routines.
+       */
+      inline result_t
+      notify_wait (notify::value_t* ovalue, notify::value_t clear)
+      {
+        return this_thread::thread ().internal_notify_wait_ (ovalue, clear);
+      }
+
+      /**
+       * @details
+       *
+       * @warning Cannot be invoked from Interrupt Service Routines.
+       */
+      inline result_t
+      notify_try_wait (notify::value_t* ovalue, notify::value_t clear)
+      {
+        return this_thread::thread ().internal_notify_try_wait_ (ovalue, clear);
+      }
+
+      /**
+       * @details
+       *
+       * @warning Cannot be invoked from Interrupt Service Routines.
+       */
+      inline result_t
+      notify_timed_wait (clock::duration_t timeout, notify::value_t* ovalue,
+                         notify::value_t clear)
+      {
+        return this_thread::thread ().internal_notify_timed_wait_ (timeout,
+                                                                   ovalue,
+                                                                   clear);
+      }
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS) */
+
       /**
        * @details
        *
@@ -2056,6 +3251,40 @@ namespace os
         return &this_thread::thread ().errno_;
       }
 
+#if defined(OS_INCLUDE_RTOS_THREAD_LOCAL_SLOTS)
+
+      /**
+       * @details
+       * The scheduler keeps a pointer to the slots of the running
+       * thread, so the access does not need to identify the
+       * current thread.
+       *
+       * The key is not validated.
+       *
+       * @warning Cannot be invoked from Interrupt Service Routines.
+       */
+      inline void*
+      __attribute__ ((always_inline))
+      local_slot (local_key_t key)
+      {
+        return scheduler::local_slots_[key];
+      }
+
+      /**
+       * @details
+       * The key is not validated.
+       *
+       * @warning Cannot be invoked from Interrupt Service Routines.
+       */
+      inline void
+      __attribute__ ((always_inline))
+      local_slot (local_key_t key, void* value)
+      {
+        scheduler::local_slots_[key] = value;
+      }
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_LOCAL_SLOTS) */
+
     } /* namespace this_thread */
 
     constexpr
@@ -2087,6 +3316,10 @@ namespace os
     {
       bottom_address_ = nullptr;
       size_bytes_ = 0;
+#if defined(OS_INCLUDE_RTOS_THREAD_STACK_SCAN)
+      scan_address_ = nullptr;
+      peak_address_ = nullptr;
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_STACK_SCAN) */
     }
 
     /**
@@ -2135,6 +3368,30 @@ namespace os
       return size_bytes_;
     }
 
+#if defined(OS_INCLUDE_RTOS_THREAD_STACK_SCAN)
+
+    /**
+     * @details
+     * The value is updated by the idle thread, which scans
+     * all stacks incrementally, and by `available()`; it may lag
+     * behind the actual usage by one scan pass.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline std::size_t
+    thread::stack::high_water_mark (void)
+    {
+      if (peak_address_ == nullptr)
+        {
+          return 0;
+        }
+      return size_bytes_
+          - static_cast<std::size_t> (peak_address_ - bottom_address_)
+              * sizeof(element_t);
+    }
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_STACK_SCAN) */
+
     /**
      * @details
      *
@@ -2325,9 +3582,191 @@ namespace os
     inline bool
     thread::interrupted (void)
     {
+#if !defined(OS_EXCLUDE_RTOS_THREAD_CANCELLATION)
       return interrupted_;
+#else
+      // Constant, the tests after each wait are removed.
+      return false;
+#endif /* !defined(OS_EXCLUDE_RTOS_THREAD_CANCELLATION) */
+    }
+
+#if defined(OS_INCLUDE_RTOS_SMP)
+
+    /**
+     * @details
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline thread::core_t
+    thread::core (void) const
+    {
+      return core_;
+    }
+
+    /**
+     * @details
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline thread::affinity_t
+    thread::affinity (void) const
+    {
+      return affinity_;
+    }
+
+    inline thread::affinity_t
+    thread::internal_allowed_cores_ (affinity_t mask)
+    {
+      constexpr affinity_t all = static_cast<affinity_t> ((1ull
+          << OS_INTEGER_RTOS_SMP_CORES) - 1);
+
+      if (mask == any_core)
+        {
+          return all;
+        }
+      return mask & all;
+    }
+
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
+
+    /**
+     * @details
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline bool
+    thread::edf (void) const
+    {
+      return edf_relative_ != 0;
+    }
+
+    /**
+     * @details
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline clock::timestamp_t
+    thread::deadline (void) const
+    {
+      return edf_deadline_;
+    }
+
+    /**
+     * @details
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline rtos::statistics::counter_t
+    thread::deadline_misses (void) const
+    {
+      return deadline_misses_;
+    }
+
+    inline bool
+    thread::internal_edf_precedes_ (const thread& other) const
+    {
+      if (edf_relative_ == 0)
+        {
+          return false;
+        }
+      if (other.edf_relative_ == 0)
+        {
+          return true;
+        }
+      // Equal deadlines keep the FIFO order.
+      return edf_deadline_ < other.edf_deadline_;
+    }
+
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_EDF) */
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING)
+
+    /**
+     * @details
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline clock::duration_t
+    thread::quantum (void) const
+    {
+      return quantum_;
+    }
+
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING) */
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_PREEMPTION_THRESHOLD)
+
+    /**
+     * @details
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline thread::priority_t
+    thread::preemption_threshold (void) const
+    {
+      return threshold_;
+    }
+
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_PREEMPTION_THRESHOLD) */
+
+#if defined(OS_INCLUDE_RTOS_TIMER_SLACK)
+
+    /**
+     * @details
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline clock::duration_t
+    thread::timer_slack (void) const
+    {
+      return timer_slack_;
+    }
+
+#endif /* defined(OS_INCLUDE_RTOS_TIMER_SLACK) */
+
+#if defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS)
+
+    /**
+     * @details
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline notify::value_t
+    thread::notify_value (void)
+    {
+      return notify_value_;
+    }
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS) */
+
+#if defined(OS_INCLUDE_RTOS_THREAD_BUDGET)
+
+    /**
+     * @details
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline rtos::statistics::duration_t
+    thread::budget (void) const
+    {
+      return budget_cycles_;
+    }
+
+    /**
+     * @details
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline rtos::statistics::counter_t
+    thread::budget_overruns (void) const
+    {
+      return budget_overruns_;
     }
 
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_BUDGET) */
+
 #if defined(OS_INCLUDE_RTOS_CUSTOM_THREAD_USER_STORAGE) || defined(__DOXYGEN__)
 
     /**
@@ -2361,6 +3800,16 @@ namespace os
      * @cond ignore
      */
 
+    inline internal::ready_threads_list&
+    thread::internal_ready_list_ (void)
+    {
+#if defined(OS_INCLUDE_RTOS_SMP)
+      return rtos::scheduler::ready_threads_lists_[core_];
+#else
+      return rtos::scheduler::ready_threads_list_;
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+    }
+
     inline void
     thread::internal_relink_running_ (void)
     {
@@ -2371,7 +3820,21 @@ namespace os
           internal::waiting_thread_node& crt_node = ready_node_;
           if (crt_node.next () == nullptr)
             {
-              rtos::scheduler::ready_threads_list_.link (crt_node);
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING)
+              if (slice_left_ != 0)
+                {
+                  // Preempted inside its slice, keep the turn.
+                  internal_ready_list_ ().link_head (crt_node);
+                }
+              else
+                {
+                  // Slice expired, go behind the peers with a new one.
+                  slice_left_ = internal_quantum_ ();
+                  internal_ready_list_ ().link (crt_node);
+                }
+#else
+              internal_ready_list_ ().link (crt_node);
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING) */
               // Ready state set in above link().
             }
 
@@ -2381,6 +3844,73 @@ namespace os
         }
     }
 
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_PREEMPTION_THRESHOLD)
+
+    inline bool
+    thread::internal_above_threshold_ (void)
+    {
+      if (state_ != state::running || threshold_ <= priority ())
+        {
+          return false;
+        }
+
+#if defined(OS_INCLUDE_RTOS_SMP)
+      if (core_ != port::core::id ())
+        {
+          // Migrated, must leave this core.
+          return false;
+        }
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+
+      internal::ready_threads_list& list = internal_ready_list_ ();
+      return list.empty () || list.head ()->thread_->priority () <= threshold_;
+    }
+
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_PREEMPTION_THRESHOLD) */
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_HANDOFF)
+
+    /**
+     * @details
+     * Called before the running thread is re-linked. The target is
+     * honoured only if it is still ready on this core and no other
+     * ready thread has a higher priority, so a handoff never
+     * delays more urgent threads.
+     */
+    inline thread*
+    thread::internal_handoff_target_ (void)
+    {
+      thread* target = handoff_;
+      if (target == nullptr)
+        {
+          return nullptr;
+        }
+      handoff_ = nullptr;
+
+      if (target->state_ != state::ready
+          || target->ready_node_.next () == nullptr)
+        {
+          return nullptr;
+        }
+
+#if defined(OS_INCLUDE_RTOS_SMP)
+      if (target->core_ != core_)
+        {
+          return nullptr;
+        }
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+
+      if (internal_ready_list_ ().head ()->thread_->priority ()
+          > target->priority ())
+        {
+          return nullptr;
+        }
+
+      return target;
+    }
+
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_HANDOFF) */
+
     /**
      * @endcond
      */
@@ -2413,6 +3943,22 @@ namespace os
 
 #endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CONTEXT_SWITCHES) */
 
+#if defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE)
+
+    /**
+     * @details
+     * The cache must be used only by the thread itself.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    inline memory::allocation_cache&
+    thread::allocation_cache (void)
+    {
+      return allocation_cache_;
+    }
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE) */
+
 #if defined(OS_INCLUDE_RTOS_THREAD_PUBLIC_FLAGS_CLEAR)
 
     inline result_t
@@ -2459,6 +4005,10 @@ namespace os
      * the stack is dynamically allocated using the RTOS specific allocator
      * (`rtos::memory::allocator`).
      *
+     * With `OS_INCLUDE_RTOS_THREAD_STACK_POOL`, if the attributes
+     * define a stack pool (via `th_stack_pool`), the stack is
+     * taken from the pool instead.
+     *
      * @par POSIX compatibility
      *  Inspired by [`pthread_create()`](http://pubs.opengroup.org/onlinepubs/9699919799/functions/pthread_create.html)
      *  from [`<pthread.h>`](http://pubs.opengroup.org/onlinepubs/9699919799/basedefs/pthread.h.html)
@@ -2511,6 +4061,10 @@ namespace os
      * the stack is dynamically allocated using the RTOS specific allocator
      * (`rtos::memory::allocator`).
      *
+     * With `OS_INCLUDE_RTOS_THREAD_STACK_POOL`, if the attributes
+     * define a stack pool (via `th_stack_pool`), the stack is
+     * taken from the pool instead.
+     *
      * @par POSIX compatibility
      *  Inspired by [`pthread_create()`](http://pubs.opengroup.org/onlinepubs/9699919799/functions/pthread_create.html)
      *  from [`<pthread.h>`](http://pubs.opengroup.org/onlinepubs/9699919799/basedefs/pthread.h.html)
@@ -2526,13 +4080,20 @@ namespace os
             { name }
       {
 #if defined(OS_TRACE_RTOS_THREAD)
-        trace::printf ("%s @%p %s\n", __func__, this, this->name ());
+        OS_TRACE_PRINTF (rtos_thread, "%s @%p %s\n", __func__, this,
+                         this->name ());
 #endif
         if (attr.th_stack_address != nullptr
             && attr.th_stack_size_bytes > stack::min_size ())
           {
             internal_construct_ (function, args, attr, nullptr, 0);
           }
+#if defined(OS_INCLUDE_RTOS_THREAD_STACK_POOL)
+        else if (attr.th_stack_pool != nullptr)
+          {
+            internal_construct_pooled_ (function, args, attr);
+          }
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_STACK_POOL) */
         else
           {
             allocator_ = &allocator;
@@ -2577,8 +4138,8 @@ namespace os
       thread_allocated<Allocator>::internal_destroy_ (void)
       {
 #if defined(OS_TRACE_RTOS_THREAD)
-        trace::printf ("thread_allocated::%s() @%p %s\n", __func__, this,
-                       name ());
+        OS_TRACE_PRINTF (rtos_thread, "thread_allocated::%s() @%p %s\n",
+                         __func__, this, name ());
 #endif
 
         if (allocated_stack_address_ != nullptr)
@@ -2618,7 +4179,7 @@ namespace os
       thread_allocated<Allocator>::~thread_allocated ()
       {
 #if defined(OS_TRACE_RTOS_THREAD)
-        trace::printf ("%s @%p %s\n", __func__, this, name ());
+        OS_TRACE_PRINTF (rtos_thread, "%s @%p %s\n", __func__, this, name ());
 #endif
       }
 
@@ -2734,7 +4295,8 @@ namespace os
             { name }
       {
 #if defined(OS_TRACE_RTOS_THREAD)
-        trace::printf ("%s @%p %s\n", __func__, this, this->name ());
+        OS_TRACE_PRINTF (rtos_thread, "%s @%p %s\n", __func__, this,
+                         this->name ());
 #endif
         internal_construct_ (function, args, attr, &stack_, stack_size_bytes);
       }
@@ -2754,7 +4316,7 @@ namespace os
       thread_inclusive<N>::~thread_inclusive ()
       {
 #if defined(OS_TRACE_RTOS_THREAD)
-        trace::printf ("%s @%p %s\n", __func__, this, name ());
+        OS_TRACE_PRINTF (rtos_thread, "%s @%p %s\n", __func__, this, name ());
 #endif
       }
 
@@ -326,12 +326,14 @@ namespace os
       /**
        * @brief Start or restart the timer.
        * @param [in] period Timer period, in clock units (ticks or seconds).
+       * @param [in] slack How late each expiration may be, in clock units,
+       *  to share the wakeup with other timeouts.
        * @retval result::ok The timer has been started or restarted.
        * @retval ENOTRECOVERABLE Timer could not be started.
        * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
        */
       result_t
-      start (clock::duration_t period);
+      start (clock::duration_t period, clock::duration_t slack = 0);
 
       /**
        * @brief Stop the timer.
@@ -345,10 +347,83 @@ namespace os
       result_t
       stop (void);
 
+      /**
+       * @brief Start or restart several timers at once.
+       * @param [in] timers Array of pointers to timers.
+       * @param [in] count The number of timers.
+       * @param [in] periods Array with the period of each timer, in
+       *  clock units, or `nullptr` to reuse the previous periods.
+       * @retval result::ok The timers have been started or restarted.
+       * @retval EINVAL The array is null, or the periods are null
+       *  with `OS_USE_RTOS_PORT_TIMER`.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       */
+      static result_t
+      start_n (timer* const timers[], std::size_t count,
+               const clock::duration_t periods[] = nullptr);
+
+      /**
+       * @brief Stop several timers at once.
+       * @param [in] timers Array of pointers to timers.
+       * @param [in] count The number of timers.
+       * @retval result::ok The running timers have been stopped.
+       * @retval EINVAL The array is null.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       */
+      static result_t
+      stop_n (timer* const timers[], std::size_t count);
+
+#if defined(OS_INCLUDE_RTOS_TIMER_DAEMON) && !defined(OS_USE_RTOS_PORT_TIMER)
+
+      /**
+       * @brief Get the number of missed periods.
+       * @par Parameters
+       *  None.
+       * @return The number of times the timer expired while its
+       *  previous callback was still pending.
+       */
+      uint32_t
+      overruns (void) const;
+
+#endif
+
+      /**
+       * @}
+       */
+
+#if defined(OS_INCLUDE_RTOS_TIMER_DAEMON) && !defined(OS_USE_RTOS_PORT_TIMER)
+
+      /**
+       * @name Public Static Member Functions
+       * @{
+       */
+
+      /**
+       * @brief Get the timer daemon thread.
+       * @par Parameters
+       *  None.
+       * @return Pointer to the thread that calls the timer callbacks.
+       */
+      static thread*
+      daemon (void);
+
+      /**
+       * @cond ignore
+       */
+
+      static std::size_t
+      internal_dispatch_pending_ (void);
+
+      /**
+       * @endcond
+       */
+
       /**
        * @}
        */
 
+#endif
+
     protected:
 
       /**
@@ -386,6 +461,13 @@ namespace os
       void
       internal_interrupt_service_routine (void);
 
+#if defined(OS_INCLUDE_RTOS_TIMER_DAEMON)
+
+      void
+      internal_unlink_pending_ (void);
+
+#endif
+
 #endif
 
       /**
@@ -415,6 +497,11 @@ namespace os
       internal::timer_node timer_node_
         { 0, *this };
       clock::duration_t period_ = 0;
+#if defined(OS_INCLUDE_RTOS_TIMER_SLACK)
+      // The expiration time before coalescing, to re-arm periodic
+      // timers without accumulating the slack.
+      clock::timestamp_t nominal_ = 0;
+#endif /* defined(OS_INCLUDE_RTOS_TIMER_SLACK) */
 #endif
 
 #if defined(OS_USE_RTOS_PORT_TIMER)
@@ -425,6 +512,13 @@ namespace os
       type_t type_ = run::once;
       state_t state_ = state::undefined;
 
+#if defined(OS_INCLUDE_RTOS_TIMER_DAEMON) && !defined(OS_USE_RTOS_PORT_TIMER)
+      // Link in the list of timers waiting for the daemon.
+      timer* pending_next_ = nullptr;
+      uint32_t overruns_ = 0;
+      bool pending_ = false;
+#endif
+
       // Add more internal data.
 
       /**
@@ -490,6 +584,16 @@ namespace os
       return this == &rhs;
     }
 
+#if defined(OS_INCLUDE_RTOS_TIMER_DAEMON) && !defined(OS_USE_RTOS_PORT_TIMER)
+
+    inline uint32_t
+    timer::overruns (void) const
+    {
+      return overruns_;
+    }
+
+#endif
+
   } /* namespace rtos */
 } /* namespace os */
 
@@ -0,0 +1,658 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_RTOS_OS_TOPIC_H_
+#define CMSIS_PLUS_RTOS_OS_TOPIC_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#include <cmsis-plus/rtos/os-decls.h>
+#include <cmsis-plus/rtos/os-mempool.h>
+#include <cmsis-plus/rtos/os-mqueue.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+
+    class topic_subscriber_base;
+
+    // ========================================================================
+
+    /**
+     * @brief Storage for a topic frame.
+     * @headerfile os.h <cmsis-plus/rtos/os.h>
+     * @ingroup cmsis-plus-rtos-mqueue
+     * @tparam T Type of the payload.
+     *
+     * @details
+     * Use it as the type of the memory pool blocks, to reserve
+     * space for the frame header.
+     */
+    template<typename T>
+      struct topic_frame
+      {
+        static_assert(alignof(T) <= sizeof(void*),
+            "topic_frame<T>: T cannot be aligned more than a pointer");
+
+        /**
+         * @brief The reference count.
+         */
+        std::size_t refs;
+
+        /**
+         * @brief The payload.
+         */
+        T payload;
+      };
+
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Publish/subscribe **topic**, with shared frames.
+     * @headerfile os.h <cmsis-plus/rtos/os.h>
+     * @ingroup cmsis-plus-rtos-mqueue
+     *
+     * @details
+     * The publisher fills a frame allocated from a memory pool
+     * once, and each subscriber receives only a pointer to it,
+     * through its own queue; the frame returns to the pool when
+     * the last reference is released.
+     */
+    class topic : public internal::object_named_system
+    {
+    public:
+
+      /**
+       * @brief Size of the frame header, with the reference count.
+       */
+      static constexpr std::size_t header_size_bytes = sizeof(void*);
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+      /**
+       * @brief Construct a topic object instance.
+       * @param [in] pool Reference to the memory pool with the frames.
+       */
+      topic (memory_pool& pool);
+
+      /**
+       * @brief Construct a named topic object instance.
+       * @param [in] name Pointer to name.
+       * @param [in] pool Reference to the memory pool with the frames.
+       */
+      topic (const char* name, memory_pool& pool);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      topic (const topic&) = delete;
+      topic (topic&&) = delete;
+      topic&
+      operator= (const topic&) = delete;
+      topic&
+      operator= (topic&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @brief Destruct the topic object instance.
+       */
+      ~topic ();
+
+      /**
+       * @}
+       */
+
+    public:
+
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+      /**
+       * @brief Allocate a frame, blocking if the pool is empty.
+       * @par Parameters
+       *  None.
+       * @return Pointer to the frame payload, or `nullptr` if interrupted.
+       */
+      void*
+      alloc (void);
+
+      /**
+       * @brief Try to allocate a frame.
+       * @par Parameters
+       *  None.
+       * @return Pointer to the frame payload, or `nullptr` if the
+       *  pool is empty.
+       */
+      void*
+      try_alloc (void);
+
+      /**
+       * @brief Allocate a frame with timeout.
+       * @param [in] timeout The timeout duration, in clock units.
+       * @return Pointer to the frame payload, or `nullptr` if the
+       *  timeout expired.
+       */
+      void*
+      timed_alloc (clock::duration_t timeout);
+
+      /**
+       * @brief Publish a frame to all subscribers.
+       * @param [in] payload Pointer to a payload returned by `alloc()`.
+       * @retval result::ok The frame was published.
+       * @retval EINVAL The payload is `nullptr`.
+       */
+      result_t
+      publish (void* payload);
+
+      /**
+       * @brief Release a reference to a frame.
+       * @param [in] payload Pointer to the frame payload.
+       * @retval result::ok The reference was released.
+       * @retval EINVAL The payload is `nullptr`.
+       */
+      result_t
+      release (void* payload);
+
+      /**
+       * @brief Get the payload size.
+       * @par Parameters
+       *  None.
+       * @return The number of bytes available in a frame.
+       */
+      std::size_t
+      payload_size (void) const;
+
+      /**
+       * @brief Get the number of subscribers.
+       * @par Parameters
+       *  None.
+       * @return The number of subscribers.
+       */
+      std::size_t
+      subscribers (void) const;
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      friend class topic_subscriber_base;
+
+      /**
+       * @name Private Member Functions
+       * @{
+       */
+
+      /**
+       * @cond ignore
+       */
+
+      /**
+       * @brief Internal function used to initialise a new frame.
+       * @param [in] block The block allocated from the pool, or `nullptr`.
+       * @return Pointer to the frame payload, or `nullptr`.
+       */
+      static void*
+      internal_frame_ (void* block);
+
+      /**
+       * @brief Internal function used to get the frame reference count.
+       * @param [in] payload Pointer to the frame payload.
+       * @return Pointer to the reference count, at the block start.
+       */
+      static std::size_t*
+      internal_refs_ (void* payload);
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @name Private Member Variables
+       * @{
+       */
+
+      /**
+       * @cond ignore
+       */
+
+      memory_pool& pool_;
+
+      // Single linked list, protected by interrupts critical sections.
+      topic_subscriber_base* subscribers_list_ = nullptr;
+      std::size_t subscribers_count_ = 0;
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @}
+       */
+    };
+
+    // ========================================================================
+
+    /**
+     * @brief Base class for topic subscribers.
+     * @headerfile os.h <cmsis-plus/rtos/os.h>
+     * @ingroup cmsis-plus-rtos-mqueue
+     *
+     * @details
+     * Type independent part of `topic_subscriber`, with the
+     * link to the topic and the receive functions.
+     */
+    class topic_subscriber_base
+    {
+    public:
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+      /**
+       * @brief Construct a subscriber base object instance.
+       * @param [in] tpc Reference to the topic.
+       * @param [in] queue Reference to the queue of frame pointers.
+       */
+      topic_subscriber_base (topic& tpc, message_queue& queue);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      topic_subscriber_base (const topic_subscriber_base&) = delete;
+      topic_subscriber_base (topic_subscriber_base&&) = delete;
+      topic_subscriber_base&
+      operator= (const topic_subscriber_base&) = delete;
+      topic_subscriber_base&
+      operator= (topic_subscriber_base&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @brief Destruct the subscriber base object instance.
+       */
+      ~topic_subscriber_base ();
+
+      /**
+       * @}
+       */
+
+    public:
+
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+      /**
+       * @brief Receive a frame, blocking if there is none.
+       * @param [out] payload The address where to store the payload pointer.
+       * @retval result::ok A frame was received.
+       * @retval EINVAL A parameter is invalid.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINTR The operation was interrupted.
+       */
+      result_t
+      receive (void** payload);
+
+      /**
+       * @brief Try to receive a frame.
+       * @param [out] payload The address where to store the payload pointer.
+       * @retval result::ok A frame was received.
+       * @retval EINVAL A parameter is invalid.
+       * @retval EWOULDBLOCK There is no frame.
+       */
+      result_t
+      try_receive (void** payload);
+
+      /**
+       * @brief Receive a frame with timeout.
+       * @param [out] payload The address where to store the payload pointer.
+       * @param [in] timeout The timeout duration, in clock units.
+       * @retval result::ok A frame was received.
+       * @retval EINVAL A parameter is invalid.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINTR The operation was interrupted.
+       * @retval ETIMEDOUT No frame arrived before the timeout expired.
+       */
+      result_t
+      timed_receive (void** payload, clock::duration_t timeout);
+
+      /**
+       * @brief Release a received frame.
+       * @param [in] payload Pointer to the frame payload.
+       * @retval result::ok The frame was released.
+       * @retval EINVAL The payload is `nullptr`.
+       */
+      result_t
+      release (void* payload);
+
+      /**
+       * @brief Get the number of frames lost because the queue was full.
+       * @par Parameters
+       *  None.
+       * @return The number of dropped frames.
+       */
+      std::size_t
+      dropped (void) const;
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      friend class topic;
+
+      /**
+       * @name Private Member Functions
+       * @{
+       */
+
+      /**
+       * @cond ignore
+       */
+
+      /**
+       * @brief Internal function used to link to the topic.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_subscribe_ (void);
+
+      /**
+       * @brief Internal function used to unlink from the topic and
+       *  release the pending frames.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_unsubscribe_ (void);
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @name Private Member Variables
+       * @{
+       */
+
+      /**
+       * @cond ignore
+       */
+
+      topic& topic_;
+      message_queue& queue_;
+
+      topic_subscriber_base* next_ = nullptr;
+      std::size_t dropped_ = 0;
+      bool subscribed_ = false;
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @}
+       */
+    };
+
+    // ========================================================================
+
+    /**
+     * @brief Topic **subscriber**, with an inclusive queue.
+     * @headerfile os.h <cmsis-plus/rtos/os.h>
+     * @ingroup cmsis-plus-rtos-mqueue
+     * @tparam N Number of frames waiting to be received.
+     *
+     * @details
+     * The subscriber is linked to the topic during its whole
+     * life time. If the queue is full, new frames are dropped
+     * for this subscriber only, and counted in `dropped()`.
+     */
+    template<std::size_t N>
+      class topic_subscriber : public topic_subscriber_base
+      {
+      public:
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+        /**
+         * @brief Construct a subscriber object instance.
+         * @param [in] tpc Reference to the topic.
+         * @param [in] name Pointer to the queue name.
+         */
+        topic_subscriber (topic& tpc, const char* name = nullptr);
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        topic_subscriber (const topic_subscriber&) = delete;
+        topic_subscriber (topic_subscriber&&) = delete;
+        topic_subscriber&
+        operator= (const topic_subscriber&) = delete;
+        topic_subscriber&
+        operator= (topic_subscriber&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @brief Destruct the subscriber object instance.
+         */
+        ~topic_subscriber ();
+
+        /**
+         * @}
+         */
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        message_queue_inclusive<void*, N> handles_;
+
+        /**
+         * @endcond
+         */
+      };
+
+#pragma GCC diagnostic pop
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace rtos
+  {
+
+    inline
+    topic::topic (memory_pool& pool) :
+        topic
+          { nullptr, pool }
+    {
+      ;
+    }
+
+    inline std::size_t
+    topic::payload_size (void) const
+    {
+      return pool_.block_size () - header_size_bytes;
+    }
+
+    inline std::size_t
+    topic::subscribers (void) const
+    {
+      return subscribers_count_;
+    }
+
+    /**
+     * @details
+     * The reference count is stored in the first word of the
+     * pool block, just before the payload.
+     */
+    inline std::size_t*
+    topic::internal_refs_ (void* payload)
+    {
+      return reinterpret_cast<std::size_t*> (static_cast<char*> (payload)
+          - header_size_bytes);
+    }
+
+    /**
+     * @details
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    inline void*
+    topic::alloc (void)
+    {
+      return internal_frame_ (pool_.alloc ());
+    }
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    inline void*
+    topic::try_alloc (void)
+    {
+      return internal_frame_ (pool_.try_alloc ());
+    }
+
+    /**
+     * @details
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    inline void*
+    topic::timed_alloc (clock::duration_t timeout)
+    {
+      return internal_frame_ (pool_.timed_alloc (timeout));
+    }
+
+    // ========================================================================
+
+    inline result_t
+    topic_subscriber_base::release (void* payload)
+    {
+      return topic_.release (payload);
+    }
+
+    inline std::size_t
+    topic_subscriber_base::dropped (void) const
+    {
+      return dropped_;
+    }
+
+    // ========================================================================
+
+    /**
+     * @details
+     * The subscriber is linked only after the queue is constructed,
+     * so the publisher never sees a partially constructed queue.
+     */
+    template<std::size_t N>
+      inline
+      topic_subscriber<N>::topic_subscriber (topic& tpc, const char* name) :
+          topic_subscriber_base (tpc, handles_), //
+          handles_ (name)
+      {
+        internal_subscribe_ ();
+      }
+
+    /**
+     * @details
+     * The subscriber is unlinked before the queue is destroyed,
+     * and the frames still in the queue are released.
+     */
+    template<std::size_t N>
+      inline
+      topic_subscriber<N>::~topic_subscriber ()
+      {
+        internal_unsubscribe_ ();
+      }
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_RTOS_OS_TOPIC_H_ */
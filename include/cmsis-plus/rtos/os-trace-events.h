@@ -0,0 +1,171 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_RTOS_OS_TRACE_EVENTS_H_
+#define CMSIS_PLUS_RTOS_OS_TRACE_EVENTS_H_
+
+#include <stdint.h>
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_INCLUDE_RTOS_TRACE_EVENTS)
+
+#if defined(__cplusplus)
+extern "C"
+{
+#endif /* __cplusplus */
+
+  /**
+   * @addtogroup cmsis-plus-app-hooks
+   * @{
+   */
+
+  /**
+   * @name RTOS Event Tracing Hooks
+   * @details
+   * Called by the scheduler, the synchronisation objects and the
+   * clocks, to record events on a timeline; each call should cost
+   * only a few dozen cycles, so the implementation must store
+   * compact binary records, never format text.
+   *
+   * A backend for SEGGER SystemView is available with
+   * `OS_USE_TRACE_SEGGER_SYSTEMVIEW`; applications can provide
+   * other implementations (for example for Tracealyzer).
+   *
+   * The thread, timer and object identifiers are their addresses.
+   * @{
+   */
+
+  /**
+   * @brief Identifiers of the synchronisation object events.
+   */
+  typedef enum
+  {
+    os_rtos_trace_semaphore_post = 0,
+    os_rtos_trace_semaphore_wait,
+    os_rtos_trace_mutex_lock,
+    os_rtos_trace_mutex_unlock,
+    os_rtos_trace_mqueue_send,
+    os_rtos_trace_mqueue_receive,
+    os_rtos_trace_evflags_raise,
+    os_rtos_trace_evflags_wait,
+
+    os_rtos_trace_object_events
+  } os_rtos_trace_event_t;
+
+  /**
+   * @brief Start the recording, from `scheduler::initialize()`.
+   */
+  void
+  os_rtos_trace_initialize (void);
+
+  /**
+   * @brief A thread was created.
+   * @param [in] th Pointer to `os::rtos::thread`.
+   */
+  void
+  os_rtos_trace_thread_create (void* th);
+
+  /**
+   * @brief A thread terminated.
+   * @param [in] th Pointer to `os::rtos::thread`.
+   */
+  void
+  os_rtos_trace_thread_terminate (void* th);
+
+  /**
+   * @brief A thread was linked to the ready list.
+   * @param [in] th Pointer to `os::rtos::thread`.
+   */
+  void
+  os_rtos_trace_thread_ready (void* th);
+
+  /**
+   * @brief The running thread was suspended.
+   * @param [in] th Pointer to `os::rtos::thread`.
+   */
+  void
+  os_rtos_trace_thread_suspend (void* th);
+
+  /**
+   * @brief The scheduler switched to another thread.
+   * @param [in] th Pointer to the new running `os::rtos::thread`.
+   */
+  void
+  os_rtos_trace_thread_run (void* th);
+
+  /**
+   * @brief An interrupt handler started.
+   */
+  void
+  os_rtos_trace_isr_enter (void);
+
+  /**
+   * @brief An interrupt handler ended.
+   */
+  void
+  os_rtos_trace_isr_exit (void);
+
+  /**
+   * @brief A timer callback started.
+   * @param [in] tm Pointer to `os::rtos::timer`.
+   */
+  void
+  os_rtos_trace_timer_enter (void* tm);
+
+  /**
+   * @brief A timer callback ended.
+   */
+  void
+  os_rtos_trace_timer_exit (void);
+
+  /**
+   * @brief A synchronisation object was used.
+   * @param [in] event Event identifier.
+   * @param [in] object Pointer to the object.
+   */
+  void
+  os_rtos_trace_object (os_rtos_trace_event_t event, void* object);
+
+  /**
+   * @}
+   */
+
+  /**
+   * @}
+   */
+
+#if defined(__cplusplus)
+}
+#endif /* __cplusplus */
+
+#endif /* defined(OS_INCLUDE_RTOS_TRACE_EVENTS) */
+
+// ----------------------------------------------------------------------------
+
+#endif /* CMSIS_PLUS_RTOS_OS_TRACE_EVENTS_H_ */
@@ -0,0 +1,107 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_RTOS_OS_WAIT_ADDRESS_H_
+#define CMSIS_PLUS_RTOS_OS_WAIT_ADDRESS_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#include <cmsis-plus/rtos/os-decls.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+
+    // ========================================================================
+
+    /**
+     * @brief Wait for a word to change.
+     * @param [in] addr Address of the word.
+     * @param [in] expected The value the word is expected to have.
+     * @retval result::ok The thread was woken up; the word must
+     *  be checked again.
+     * @retval EAGAIN The word did not have the expected value.
+     * @retval EINVAL The address is `nullptr`.
+     * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+     * @retval EINTR The operation was interrupted.
+     * @ingroup cmsis-plus-rtos-thread
+     */
+    result_t
+    wait_on_address (const volatile std::uint32_t* addr,
+                     std::uint32_t expected);
+
+    /**
+     * @brief Wait for a word to change, with timeout.
+     * @param [in] addr Address of the word.
+     * @param [in] expected The value the word is expected to have.
+     * @param [in] timeout The timeout duration, in sysclock ticks.
+     * @retval result::ok The thread was woken up; the word must
+     *  be checked again.
+     * @retval EAGAIN The word did not have the expected value.
+     * @retval EINVAL The address is `nullptr`.
+     * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+     * @retval EINTR The operation was interrupted.
+     * @retval ETIMEDOUT Nobody woke the thread before the
+     *  timeout expired.
+     * @ingroup cmsis-plus-rtos-thread
+     */
+    result_t
+    timed_wait_on_address (const volatile std::uint32_t* addr,
+                           std::uint32_t expected, clock::duration_t timeout);
+
+    /**
+     * @brief Wake up threads waiting on an address.
+     * @param [in] addr Address of the word.
+     * @param [in] n The maximum number of threads to wake up.
+     * @return The number of threads woken up.
+     * @ingroup cmsis-plus-rtos-thread
+     */
+    std::size_t
+    wake_address (const volatile std::uint32_t* addr, std::size_t n = 1);
+
+    /**
+     * @brief Wake up all threads waiting on an address.
+     * @param [in] addr Address of the word.
+     * @return The number of threads woken up.
+     * @ingroup cmsis-plus-rtos-thread
+     */
+    std::size_t
+    wake_address_all (const volatile std::uint32_t* addr);
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_RTOS_OS_WAIT_ADDRESS_H_ */
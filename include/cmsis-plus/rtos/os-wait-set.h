@@ -0,0 +1,396 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef CMSIS_PLUS_RTOS_OS_WAIT_SET_H_
+#define CMSIS_PLUS_RTOS_OS_WAIT_SET_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#include <cmsis-plus/rtos/os-decls.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Wait for any of several synchronisation objects.
+     * @headerfile os.h <cmsis-plus/rtos/os.h>
+     * @ingroup cmsis-plus-rtos
+     *
+     * @details
+     * A set of semaphores, message queues and event flags,
+     * with a single thread blocking until one of them is ready.
+     *
+     * Waiting does not consume anything; when the wait returns,
+     * the thread is expected to call the non blocking function
+     * of the ready member (`try_wait()`, `try_receive()`,
+     * `try_wait()` with the same mask).
+     */
+    class wait_set : public internal::object_named_system
+    {
+    public:
+
+      /**
+       * @brief The max number of members in a set.
+       */
+      static constexpr std::size_t max_size = 8;
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+      /**
+       * @brief Construct a wait set object instance.
+       * @param [in] name Pointer to name.
+       */
+      wait_set (const char* name = nullptr);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      wait_set (const wait_set&) = delete;
+      wait_set (wait_set&&) = delete;
+      wait_set&
+      operator= (const wait_set&) = delete;
+      wait_set&
+      operator= (wait_set&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @brief Destruct the wait set object instance.
+       */
+      ~wait_set ();
+
+      /**
+       * @}
+       */
+
+    public:
+
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+      /**
+       * @brief Add a semaphore to the set.
+       * @param [in] sem Reference to semaphore; ready when it can be taken.
+       * @param [out] index Optional pointer where to store the
+       *  index of the new member; may be `nullptr`.
+       * @retval result::ok The semaphore was added.
+       * @retval ENOMEM The set is full.
+       * @retval EBUSY A thread is waiting on the set.
+       * @retval ENOTSUP The semaphore is implemented by the port.
+       */
+      result_t
+      add (semaphore& sem, std::size_t* index = nullptr);
+
+      /**
+       * @brief Add a message queue to the set.
+       * @param [in] mq Reference to message queue; ready when not empty.
+       * @param [out] index Optional pointer where to store the
+       *  index of the new member; may be `nullptr`.
+       * @retval result::ok The message queue was added.
+       * @retval ENOMEM The set is full.
+       * @retval EBUSY A thread is waiting on the set.
+       * @retval ENOTSUP The message queue is implemented by the port.
+       */
+      result_t
+      add (message_queue& mq, std::size_t* index = nullptr);
+
+      /**
+       * @brief Add event flags to the set.
+       * @param [in] evf Reference to event flags.
+       * @param [in] mask The expected flags (OR-ed bit-mask);
+       *  if `flags::any`, any flag raised will do it.
+       * @param [in] mode Mode bits to select if either all or any flags
+       *  in the mask are expected; `flags::mode::clear` is ignored.
+       * @param [out] index Optional pointer where to store the
+       *  index of the new member; may be `nullptr`.
+       * @retval result::ok The event flags were added.
+       * @retval ENOMEM The set is full.
+       * @retval EBUSY A thread is waiting on the set.
+       * @retval ENOTSUP The event flags are implemented by the port.
+       */
+      result_t
+      add (event_flags& evf, flags::mask_t mask, flags::mode_t mode =
+               flags::mode::all,
+           std::size_t* index = nullptr);
+
+      /**
+       * @brief Remove all members.
+       * @par Parameters
+       *  None.
+       * @retval result::ok The set is empty.
+       * @retval EBUSY A thread is waiting on the set.
+       */
+      result_t
+      clear (void);
+
+      /**
+       * @brief Get the number of members.
+       * @par Parameters
+       *  None.
+       * @return The number of members in the set.
+       */
+      std::size_t
+      size (void) const;
+
+      /**
+       * @brief Wait until a member is ready.
+       * @param [out] index Optional pointer where to store the
+       *  index of the ready member; may be `nullptr`.
+       * @retval result::ok A member is ready.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINVAL The set is empty.
+       * @retval EBUSY Another thread is waiting on the set.
+       * @retval EINTR The operation was interrupted.
+       */
+      result_t
+      wait (std::size_t* index = nullptr);
+
+      /**
+       * @brief Check if a member is ready.
+       * @param [out] index Optional pointer where to store the
+       *  index of the ready member; may be `nullptr`.
+       * @retval result::ok A member is ready.
+       * @retval EINVAL The set is empty.
+       * @retval EWOULDBLOCK No member is ready.
+       */
+      result_t
+      try_wait (std::size_t* index = nullptr);
+
+      /**
+       * @brief Timed wait until a member is ready.
+       * @param [in] timeout Timeout to wait, in system clock ticks.
+       * @param [out] index Optional pointer where to store the
+       *  index of the ready member; may be `nullptr`.
+       * @retval result::ok A member is ready.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINVAL The set is empty.
+       * @retval EBUSY Another thread is waiting on the set.
+       * @retval EINTR The operation was interrupted.
+       * @retval ETIMEDOUT The timeout expired.
+       */
+      result_t
+      timed_wait (clock::duration_t timeout, std::size_t* index = nullptr);
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @name Private Member Types
+       * @{
+       */
+
+      /**
+       * @cond ignore
+       */
+
+      enum class kind
+        : uint8_t
+          {
+            semaphore, //
+        message_queue, //
+        event_flags
+      };
+
+      typedef struct member_s
+      {
+        void* object;
+        internal::waiting_threads_list* list;
+        flags::mask_t mask;
+        flags::mode_t mode;
+        kind type;
+      } member_t;
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @}
+       */
+
+      /**
+       * @name Private Member Functions
+       * @{
+       */
+
+      /**
+       * @cond ignore
+       */
+
+      /**
+       * @brief Internal function used to add a member.
+       * @param [in] type The type of the object.
+       * @param [in] object Pointer to object.
+       * @param [in] list The list where the waiting thread is linked.
+       * @param [in] mask The expected flags.
+       * @param [in] mode The flags mode.
+       * @param [out] index Optional pointer to the new index.
+       * @retval result::ok The member was added.
+       * @retval ENOMEM The set is full.
+       * @retval EBUSY A thread is waiting on the set.
+       */
+      result_t
+      internal_add_ (kind type, void* object,
+                     internal::waiting_threads_list* list, flags::mask_t mask,
+                     flags::mode_t mode, std::size_t* index);
+
+      /**
+       * @brief Internal function used to find a ready member.
+       * @param [out] index Optional pointer to the ready index.
+       * @retval true A member is ready.
+       * @retval false No member is ready.
+       */
+      bool
+      internal_check_ (std::size_t* index);
+
+      /**
+       * @brief Internal function used to wait for a ready member.
+       * @param [in] timeout The timeout duration.
+       * @param [in] timed Use the timeout.
+       * @param [out] index Optional pointer to the ready index.
+       * @retval result::ok A member is ready.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @retval EINVAL The set is empty.
+       * @retval EBUSY Another thread is waiting on the set.
+       * @retval EINTR The operation was interrupted.
+       * @retval ETIMEDOUT The timeout expired.
+       */
+      result_t
+      internal_wait_ (clock::duration_t timeout, bool timed,
+                      std::size_t* index);
+
+      /**
+       * @brief Internal function used to unlink the waiting nodes.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      internal_unlink_nodes_ (void);
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @name Private Member Variables
+       * @{
+       */
+
+      /**
+       * @cond ignore
+       */
+
+      member_t members_[max_size];
+      std::size_t size_ = 0;
+
+      // The waiting nodes are kept in the object, not on the waiting
+      // thread stack, since a killed thread unlinks only one of them.
+      alignas(internal::waiting_thread_node) //
+      char nodes_[max_size][sizeof(internal::waiting_thread_node)];
+
+      // The thread waiting on the set, if any.
+      thread* volatile waiting_ = nullptr;
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @}
+       */
+    };
+
+#pragma GCC diagnostic pop
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace rtos
+  {
+
+    inline std::size_t
+    wait_set::size (void) const
+    {
+      return size_;
+    }
+
+    inline result_t
+    wait_set::wait (std::size_t* index)
+    {
+      return internal_wait_ (0, false, index);
+    }
+
+    inline result_t
+    wait_set::timed_wait (clock::duration_t timeout, std::size_t* index)
+    {
+      return internal_wait_ (timeout, true, index);
+    }
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_RTOS_OS_WAIT_SET_H_ */
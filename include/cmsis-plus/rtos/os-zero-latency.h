@@ -0,0 +1,261 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_RTOS_OS_ZERO_LATENCY_H_
+#define CMSIS_PLUS_RTOS_OS_ZERO_LATENCY_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+#include <cmsis-plus/rtos/os-decls.h>
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_INCLUDE_RTOS_ZERO_LATENCY_INTERRUPTS)
+
+namespace os
+{
+  namespace rtos
+  {
+    /**
+     * @brief Signals from interrupts never masked by the kernel.
+     * @ingroup cmsis-plus-rtos-core
+     * @details
+     * The interrupts with priorities above
+     * `OS_INTEGER_RTOS_CRITICAL_SECTION_INTERRUPT_PRIORITY` are
+     * never masked by the critical sections, so they must not call
+     * any other RTOS function. They can only raise signals, with
+     * an atomic operation on a word of pending bits; a kernel aware
+     * interrupt (the _drain_ interrupt, usually an unused vendor
+     * interrupt) later delivers them to the bound semaphores,
+     * event flags, thread flags or functions.
+     *
+     * Repeated raises before delivery are merged, like flags.
+     *
+     * The atomic operations require exclusive access instructions,
+     * so zero latency interrupts are possible only on ARMv7-M
+     * and higher, with the critical sections based on `BASEPRI`.
+     */
+    namespace zero_latency
+    {
+      /**
+       * @brief Type of signal numbers.
+       */
+      using signal_t = uint8_t;
+
+      /**
+       * @brief Number of signals.
+       */
+      constexpr std::size_t signals = 32;
+
+      /**
+       * @brief Type of functions called by the drain interrupt.
+       * @param [in] args Pointer to the argument passed to `bind()`.
+       */
+      using func_t = void (*) (void* args);
+
+      /**
+       * @brief Post a semaphore when the signal is raised.
+       * @param [in] sig The signal number.
+       * @param [in] sem Reference to the semaphore.
+       * @retval result::ok The signal was bound.
+       * @retval EINVAL The signal number is not valid.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       */
+      result_t
+      bind (signal_t sig, semaphore& sem);
+
+      /**
+       * @brief Raise event flags when the signal is raised.
+       * @param [in] sig The signal number.
+       * @param [in] evf Reference to the event flags.
+       * @param [in] mask The flags to raise.
+       * @retval result::ok The signal was bound.
+       * @retval EINVAL The signal number or the mask are not valid.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       */
+      result_t
+      bind (signal_t sig, event_flags& evf, flags::mask_t mask);
+
+      /**
+       * @brief Raise thread flags when the signal is raised.
+       * @param [in] sig The signal number.
+       * @param [in] th Reference to the thread.
+       * @param [in] mask The flags to raise.
+       * @retval result::ok The signal was bound.
+       * @retval EINVAL The signal number or the mask are not valid.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       */
+      result_t
+      bind (signal_t sig, thread& th, flags::mask_t mask);
+
+      /**
+       * @brief Call a function when the signal is raised.
+       * @param [in] sig The signal number.
+       * @param [in] func Pointer to function, called from the
+       *  drain interrupt.
+       * @param [in] args Pointer to function argument.
+       * @retval result::ok The signal was bound.
+       * @retval EINVAL The signal number or the function are not valid.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       */
+      result_t
+      bind (signal_t sig, func_t func, void* args = nullptr);
+
+      /**
+       * @brief Remove the signal binding.
+       * @param [in] sig The signal number.
+       * @retval result::ok The binding was removed.
+       * @retval EINVAL The signal number is not valid.
+       * @retval EPERM Cannot be invoked from an Interrupt Service Routines.
+       * @details
+       * A pending raise of this signal is dropped.
+       */
+      result_t
+      unbind (signal_t sig);
+
+      /**
+       * @brief Raise a signal.
+       * @param [in] sig The signal number.
+       * @par Returns
+       *  Nothing.
+       * @note Can be invoked from any interrupt, including those
+       *  above the kernel priority; lock-free.
+       */
+      void
+      raise (signal_t sig);
+
+      /**
+       * @brief Get the number of merged raises.
+       * @par Parameters
+       *  None.
+       * @return The number of raises of signals already pending.
+       */
+      uint32_t
+      merged (void);
+
+      /**
+       * @cond ignore
+       */
+
+      void
+      internal_drain_ (void);
+
+      extern uint32_t volatile pending_;
+      extern uint32_t merged_;
+
+      /**
+       * @endcond
+       */
+
+    } /* namespace zero_latency */
+  } /* namespace rtos */
+} /* namespace os */
+
+extern "C"
+{
+  /**
+   * @addtogroup cmsis-plus-app-hooks
+   * @{
+   */
+
+  /**
+   * @brief Request the drain interrupt.
+   * @par Parameters
+   *  None.
+   * @par Returns
+   *  Nothing.
+   * @details
+   * Called by `raise()`, from the zero latency interrupt; it must
+   * only set the drain interrupt pending, for example with
+   * `NVIC_SetPendingIRQ()`.
+   *
+   * Weak, empty by default; the signals are then delivered
+   * on the next system tick.
+   */
+  void
+  os_rtos_zero_latency_pend_hook (void);
+
+  /**
+   * @brief Deliver the pending signals.
+   * @par Parameters
+   *  None.
+   * @par Returns
+   *  Nothing.
+   * @details
+   * Must be called from the drain interrupt handler, whose
+   * priority must be at or below the kernel priority.
+   */
+  void
+  os_rtos_zero_latency_drain_handler (void);
+
+  /**
+   * @}
+   */
+}
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace rtos
+  {
+    namespace zero_latency
+    {
+      /**
+       * @details
+       * A single atomic OR on the pending word; the drain
+       * interrupt is requested only by the first raise.
+       */
+      inline void
+      __attribute__((always_inline))
+      raise (signal_t sig)
+      {
+        uint32_t bit = static_cast<uint32_t> (1) << (sig & (signals - 1));
+        uint32_t old = __atomic_fetch_or (&pending_, bit, __ATOMIC_RELEASE);
+        if (old == 0)
+          {
+            os_rtos_zero_latency_pend_hook ();
+          }
+        else if ((old & bit) != 0)
+          {
+            __atomic_fetch_add (&merged_, 1, __ATOMIC_RELAXED);
+          }
+      }
+
+    } /* namespace zero_latency */
+  } /* namespace rtos */
+} /* namespace os */
+
+#endif /* defined(OS_INCLUDE_RTOS_ZERO_LATENCY_INTERRUPTS) */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_RTOS_OS_ZERO_LATENCY_H_ */
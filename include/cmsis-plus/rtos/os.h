@@ -94,13 +94,29 @@
 #include <cmsis-plus/rtos/os-clocks.h>
 #include <cmsis-plus/rtos/os-timer.h>
 #include <cmsis-plus/rtos/os-mutex.h>
+#include <cmsis-plus/rtos/os-rwlock.h>
 #include <cmsis-plus/rtos/os-condvar.h>
 #include <cmsis-plus/rtos/os-semaphore.h>
+#include <cmsis-plus/rtos/os-barrier.h>
 #include <cmsis-plus/rtos/os-mempool.h>
 #include <cmsis-plus/rtos/os-mqueue.h>
 #include <cmsis-plus/rtos/os-evflags.h>
+#include <cmsis-plus/rtos/os-spsc.h>
+#include <cmsis-plus/rtos/os-seqlock.h>
+#include <cmsis-plus/rtos/os-topic.h>
+#include <cmsis-plus/rtos/os-stack-pool.h>
+#include <cmsis-plus/rtos/os-wait-set.h>
+#include <cmsis-plus/rtos/os-wait-address.h>
+#include <cmsis-plus/rtos/os-deferred.h>
+#include <cmsis-plus/rtos/os-periodic.h>
+#include <cmsis-plus/rtos/os-callout.h>
+#include <cmsis-plus/rtos/os-profiler.h>
+#include <cmsis-plus/rtos/os-registry.h>
+#include <cmsis-plus/rtos/os-dvfs.h>
+#include <cmsis-plus/rtos/os-zero-latency.h>
 
 #include <cmsis-plus/rtos/os-hooks.h>
+#include <cmsis-plus/rtos/os-trace-events.h>
 
 // More or less at the end, when all other definitions are available.
 #include <cmsis-plus/rtos/os-inlines.h>
@@ -133,6 +149,45 @@ namespace os
       thread::threads_list&
       children_threads (thread* th);
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_PROFILE)
+
+      namespace statistics
+      {
+        /**
+         * @brief Copy the profiling data of all threads.
+         * @param [out] buf Pointer to an array of profiles.
+         * @param [in] count Number of elements in the array.
+         * @return The number of threads, possibly larger than `count`.
+         */
+        std::size_t
+        threads_profile (thread::statistics::profile* buf, std::size_t count);
+
+      } /* namespace statistics */
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_PROFILE) */
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING)
+
+      /**
+       * @brief Get the time slice of a priority class.
+       * @param [in] prio Any priority in the class.
+       * @return The quantum, in ticks.
+       */
+      clock::duration_t
+      quantum (thread::priority_t prio);
+
+      /**
+       * @brief Set the time slice of a priority class.
+       * @param [in] prio Any priority in the class.
+       * @param [in] ticks The quantum, in ticks, or 0 for
+       *  `OS_INTEGER_RTOS_SCHEDULER_QUANTUM_TICKS`.
+       * @return The previous quantum, in ticks.
+       */
+      clock::duration_t
+      quantum (thread::priority_t prio, clock::duration_t ticks);
+
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING) */
+
     } /* namespace scheduler */
 
     // ------------------------------------------------------------------------
@@ -32,17 +32,48 @@
 
 #ifdef  __cplusplus
 
+#include <cmsis-plus/os-app-config.h>
+
 #include <cstdint>
 #include <cstddef>
 #include <cassert>
 #include <iterator>
 
+#if defined(OS_INCLUDE_UTILS_LISTS_COMPACT)
+#if !defined(OS_INTEGER_UTILS_LISTS_COMPACT_BASE)
+#define OS_INTEGER_UTILS_LISTS_COMPACT_BASE (0x20000000)
+#endif
+#endif /* defined(OS_INCLUDE_UTILS_LISTS_COMPACT) */
+
 namespace os
 {
   namespace utils
   {
     // ========================================================================
 
+    /**
+     * @brief Tag type selecting the constant initialisation constructors.
+     * @headerfile lists.h <cmsis-plus/utils/lists.h>
+     * @ingroup cmsis-plus-utils
+     *
+     * @details
+     * The constructors taking this tag are `constexpr`; static
+     * instances are fully initialised by the compiler, and no code
+     * is added to the init array.
+     */
+    struct constant_init_t
+    {
+    };
+
+    /**
+     * @brief Tag selecting the constant initialisation constructors.
+     * @ingroup cmsis-plus-utils
+     */
+    constexpr constant_init_t constant_init
+      { };
+
+    // ========================================================================
+
     /**
      * @brief Statically allocated core of a double linked list,
      * pointers to next, previous.
@@ -53,6 +84,26 @@ namespace os
     {
     public:
 
+#if defined(OS_INCLUDE_UTILS_LISTS_COMPACT)
+
+      /**
+       * @brief Type of a compact link, a 16-bit index relative
+       * to `OS_INTEGER_UTILS_LISTS_COMPACT_BASE`.
+       */
+      using link_t = uint16_t;
+
+      /**
+       * @brief Compact link to nowhere.
+       */
+      static constexpr link_t link_null = 0;
+
+      /**
+       * @brief Compact link to the node itself.
+       */
+      static constexpr link_t link_self = 0xFFFF;
+
+#endif /* defined(OS_INCLUDE_UTILS_LISTS_COMPACT) */
+
       /**
        * @name Constructors & Destructor
        * @{
@@ -63,6 +114,29 @@ namespace os
        */
       static_double_list_links ();
 
+#if defined(OS_INCLUDE_UTILS_LISTS_COMPACT)
+
+      /**
+       * @brief Construct a list node with the given compact links.
+       * @param [in] prev Link to previous node.
+       * @param [in] next Link to next node.
+       */
+      constexpr
+      static_double_list_links (link_t prev, link_t next);
+
+#else
+
+      /**
+       * @brief Construct a list node with the given links.
+       * @param [in] prev Pointer to previous node.
+       * @param [in] next Pointer to next node.
+       */
+      constexpr
+      static_double_list_links (static_double_list_links* prev,
+                                static_double_list_links* next);
+
+#endif /* defined(OS_INCLUDE_UTILS_LISTS_COMPACT) */
+
       /**
        * @cond ignore
        */
@@ -126,11 +200,43 @@ namespace os
 
     protected:
 
+#if defined(OS_INCLUDE_UTILS_LISTS_COMPACT)
+
+      /**
+       * @cond ignore
+       */
+
+      static_double_list_links*
+      decode_ (link_t link) const;
+
+      link_t
+      encode_ (static_double_list_links* node) const;
+
+      /**
+       * @endcond
+       */
+
+#endif /* defined(OS_INCLUDE_UTILS_LISTS_COMPACT) */
+
       /**
        * @name Private Member Variables
        * @{
        */
 
+#if defined(OS_INCLUDE_UTILS_LISTS_COMPACT)
+
+      /**
+       * @brief Link to previous node.
+       */
+      link_t prev_;
+
+      /**
+       * @brief Link to next node.
+       */
+      link_t next_;
+
+#else
+
       /**
        * @brief Pointer to previous node.
        */
@@ -141,6 +247,8 @@ namespace os
        */
       static_double_list_links* next_;
 
+#endif /* defined(OS_INCLUDE_UTILS_LISTS_COMPACT) */
+
       /**
        * @}
        */
@@ -169,6 +277,12 @@ namespace os
        */
       double_list_links ();
 
+      /**
+       * @brief Construct an unlinked list node at compile time.
+       */
+      constexpr
+      double_list_links (constant_init_t);
+
       /**
        * @cond ignore
        */
@@ -364,6 +478,12 @@ namespace os
        */
       static_double_list ();
 
+      /**
+       * @brief Construct an empty list at compile time.
+       */
+      constexpr
+      static_double_list (constant_init_t);
+
       /**
        * @cond ignore
        */
@@ -445,6 +565,37 @@ namespace os
       volatile static_double_list_links*
       tail (void) const;
 
+      /**
+       * @brief Count the nodes.
+       * @par Parameters
+       *  None.
+       * @return The number of nodes in the list.
+       */
+      std::size_t
+      length (void) const;
+
+      /**
+       * @brief Move all nodes of another list to the end of this list.
+       * @param [in] other Reference to the source list.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      splice_all (static_double_list& other);
+
+      /**
+       * @brief Move a range of nodes after an existing node.
+       * @param [in] after Pointer to the node to insert after.
+       * @param [in] first Reference to the first node in the range.
+       * @param [in] last Reference to the last node in the range.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      splice_after (static_double_list_links* after,
+                    static_double_list_links& first,
+                    static_double_list_links& last);
+
       /**
        * @}
        */
@@ -511,6 +662,13 @@ namespace os
        */
       double_list ();
 
+      /**
+       * @brief Construct an empty list at compile time.
+       * @param [in] tag The constant initialisation tag.
+       */
+      constexpr
+      double_list (constant_init_t tag);
+
       /**
        * @cond ignore
        */
@@ -810,6 +968,26 @@ namespace os
         pointer
         unlink_tail (void);
 
+        /**
+         * @brief Move all elements of another list to the end of this list.
+         * @param [in] other Reference to the source list.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        splice_all (intrusive_list& other);
+
+        /**
+         * @brief Move a range of elements before a position.
+         * @param [in] position Iterator to the element to insert before.
+         * @param [in] first Iterator to the first element to move.
+         * @param [in] last Iterator after the last element to move.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        splice (iterator position, iterator first, iterator last);
+
         /**
          * @}
          */
@@ -837,12 +1015,106 @@ namespace os
       ;
     }
 
+#if defined(OS_INCLUDE_UTILS_LISTS_COMPACT)
+
+    constexpr
+    static_double_list_links::static_double_list_links (link_t prev,
+                                                        link_t next) :
+        prev_ (prev), //
+        next_ (next)
+    {
+      ;
+    }
+
+#else
+
+    constexpr
+    static_double_list_links::static_double_list_links (
+        static_double_list_links* prev, static_double_list_links* next) :
+        prev_ (prev), //
+        next_ (next)
+    {
+      ;
+    }
+
+#endif /* defined(OS_INCLUDE_UTILS_LISTS_COMPACT) */
+
     inline
     static_double_list_links::~static_double_list_links ()
     {
       ;
     }
 
+#if defined(OS_INCLUDE_UTILS_LISTS_COMPACT)
+
+    inline static_double_list_links*
+    static_double_list_links::decode_ (link_t link) const
+    {
+      if (link == link_null)
+        {
+          return nullptr;
+        }
+      if (link == link_self)
+        {
+          return const_cast<static_double_list_links*> (this);
+        }
+      return reinterpret_cast<static_double_list_links*> (
+          static_cast<std::uintptr_t> (OS_INTEGER_UTILS_LISTS_COMPACT_BASE)
+              + (static_cast<std::uintptr_t> (link - 1) << 1));
+    }
+
+    inline static_double_list_links::link_t
+    static_double_list_links::encode_ (static_double_list_links* node) const
+    {
+      if (node == nullptr)
+        {
+          return link_null;
+        }
+      if (node == this)
+        {
+          return link_self;
+        }
+      std::uintptr_t offset = reinterpret_cast<std::uintptr_t> (node)
+          - static_cast<std::uintptr_t> (OS_INTEGER_UTILS_LISTS_COMPACT_BASE);
+
+      // The node must be in the 128 KB above the base.
+      assert((offset >> 1) < (link_self - 1));
+
+      return static_cast<link_t> ((offset >> 1) + 1);
+    }
+
+    inline bool
+    static_double_list_links::unlinked (void)
+    {
+      return (next_ == link_null);
+    }
+
+    inline static_double_list_links*
+    static_double_list_links::next (void) const
+    {
+      return decode_ (next_);
+    }
+
+    inline static_double_list_links*
+    static_double_list_links::prev (void) const
+    {
+      return decode_ (prev_);
+    }
+
+    inline void
+    static_double_list_links::next (static_double_list_links* n)
+    {
+      next_ = encode_ (n);
+    }
+
+    inline void
+    static_double_list_links::prev (static_double_list_links* n)
+    {
+      prev_ = encode_ (n);
+    }
+
+#else
+
     inline bool
     static_double_list_links::unlinked (void)
     {
@@ -873,13 +1145,27 @@ namespace os
       prev_ = n;
     }
 
+#endif /* defined(OS_INCLUDE_UTILS_LISTS_COMPACT) */
+
     // ========================================================================
 
     inline
     double_list_links::double_list_links ()
     {
-      prev_ = nullptr;
-      next_ = nullptr;
+      prev (nullptr);
+      next (nullptr);
+    }
+
+    constexpr
+    double_list_links::double_list_links (constant_init_t) :
+        static_double_list_links
+#if defined(OS_INCLUDE_UTILS_LISTS_COMPACT)
+          { link_null, link_null }
+#else
+          { nullptr, nullptr }
+#endif /* defined(OS_INCLUDE_UTILS_LISTS_COMPACT) */
+    {
+      ;
     }
 
     inline
@@ -1011,6 +1297,25 @@ namespace os
       // The constructor was not `default` to benefit from inline.
     }
 
+    /**
+     * @details
+     * The head points to itself, as after `clear()`; the address
+     * is a link time constant for static instances.
+     * With compact links the self links are encoded explicitly.
+     */
+    constexpr
+    static_double_list::static_double_list (constant_init_t) :
+        head_
+#if defined(OS_INCLUDE_UTILS_LISTS_COMPACT)
+          { static_double_list_links::link_self,
+              static_double_list_links::link_self }
+#else
+          { &head_, &head_ }
+#endif /* defined(OS_INCLUDE_UTILS_LISTS_COMPACT) */
+    {
+      ;
+    }
+
     /**
      * @details
      * There must be no nodes in the list.
@@ -1049,6 +1354,16 @@ namespace os
 
     // ========================================================================
 
+    constexpr
+    double_list::double_list (constant_init_t tag) :
+        static_double_list
+          { tag }
+    {
+      ;
+    }
+
+    // ========================================================================
+
     template<typename T, typename N, N T::* MP, typename U>
       constexpr
       intrusive_list_iterator<T, N, MP, U>::intrusive_list_iterator () :
@@ -1240,6 +1555,43 @@ namespace os
               static_cast<iterator_pointer> (const_cast<static_double_list_links*> (&head_)) };
       }
 
+    template<typename T, typename N, N T::* MP, typename U>
+      inline void
+      intrusive_list<T, N, MP, U>::splice_all (intrusive_list& other)
+      {
+        static_double_list::splice_all (other);
+      }
+
+    /**
+     * @details
+     * The elements in the range `[first, last)` are unlinked from
+     * their list, usually another one, and linked in the same
+     * order before `position`, in constant time. The range must not
+     * include `position`.
+     */
+    template<typename T, typename N, N T::* MP, typename U>
+      void
+      intrusive_list<T, N, MP, U>::splice (iterator position, iterator first,
+                                           iterator last)
+      {
+        if (first == last)
+          {
+            return;
+          }
+
+        if (uninitialized ())
+          {
+            // If this is the first time, initialise the list to empty.
+            clear ();
+          }
+
+        static_double_list_links* begin = first.get_iterator_pointer ();
+        static_double_list_links* end = last.get_iterator_pointer ()->prev ();
+
+        splice_after (position.get_iterator_pointer ()->prev (), *begin,
+                      *end);
+      }
+
     template<typename T, typename N, N T::* MP, typename U>
       inline typename intrusive_list<T, N, MP, U>::pointer
       intrusive_list<T, N, MP, U>::get_pointer (iterator_pointer node) const
@@ -0,0 +1,129 @@
+#!/usr/bin/env python3
+
+# -----------------------------------------------------------------------------
+# Post-link helper, compresses a raw binary (the content of a .data
+# region, extracted with `objcopy -O binary --only-section`) into a
+# raw LZ4 block, as expected by the startup code when
+# OS_INCLUDE_STARTUP_COMPRESSED_DATA is defined.
+#
+# Usage: lz4-data-image.py <input.bin> <output.lz4>
+#
+# The result is decompressed back and compared with the input,
+# to be sure the image is valid.
+# -----------------------------------------------------------------------------
+
+import sys
+
+MIN_MATCH = 4
+# The last 5 bytes are always literals, and the last match
+# starts at least 12 bytes before the end (LZ4 block format).
+LAST_LITERALS = 5
+MF_LIMIT = 12
+MAX_OFFSET = 65535
+HASH_BITS = 12
+
+
+def put_length(out, length):
+    while length >= 255:
+        out.append(255)
+        length -= 255
+    out.append(length)
+
+
+def emit(out, literals, match_length, offset):
+    lit = len(literals)
+    token = (min(lit, 15) << 4)
+    if match_length is not None:
+        token |= min(match_length - MIN_MATCH, 15)
+    out.append(token)
+    if lit >= 15:
+        put_length(out, lit - 15)
+    out += literals
+    if match_length is not None:
+        out.append(offset & 0xFF)
+        out.append(offset >> 8)
+        if match_length - MIN_MATCH >= 15:
+            put_length(out, match_length - MIN_MATCH - 15)
+
+
+def compress(data):
+    out = bytearray()
+    n = len(data)
+    table = {}
+    anchor = 0
+    i = 0
+    limit = n - MF_LIMIT
+    while i < limit:
+        key = data[i:i + MIN_MATCH]
+        candidate = table.get(key)
+        table[key] = i
+        if candidate is None or i - candidate > MAX_OFFSET:
+            i += 1
+            continue
+        length = MIN_MATCH
+        end = n - LAST_LITERALS
+        while i + length < end and \
+                data[candidate + length] == data[i + length]:
+            length += 1
+        emit(out, data[anchor:i], length, i - candidate)
+        i += length
+        anchor = i
+    emit(out, data[anchor:], None, 0)
+    return bytes(out)
+
+
+def decompress(image, size):
+    out = bytearray()
+    ip = 0
+    while len(out) < size:
+        token = image[ip]
+        ip += 1
+        length = token >> 4
+        if length == 15:
+            while True:
+                b = image[ip]
+                ip += 1
+                length += b
+                if b != 255:
+                    break
+        out += image[ip:ip + length]
+        ip += length
+        if len(out) >= size:
+            break
+        offset = image[ip] | (image[ip + 1] << 8)
+        ip += 2
+        length = token & 15
+        if length == 15:
+            while True:
+                b = image[ip]
+                ip += 1
+                length += b
+                if b != 255:
+                    break
+        for _ in range(length + MIN_MATCH):
+            out.append(out[-offset])
+    return bytes(out[:size])
+
+
+def main(argv):
+    if len(argv) != 3:
+        sys.stderr.write("usage: %s <input.bin> <output.lz4>\n" % argv[0])
+        return 1
+
+    with open(argv[1], "rb") as f:
+        data = f.read()
+
+    image = compress(data)
+    if decompress(image, len(data)) != data:
+        sys.stderr.write("%s: verification failed\n" % argv[0])
+        return 1
+
+    with open(argv[2], "wb") as f:
+        f.write(image)
+
+    sys.stderr.write("%s: %d -> %d bytes\n" % (argv[1], len(data), len(image)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
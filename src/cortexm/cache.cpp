@@ -0,0 +1,192 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/cortexm/cache.h>
+#include <cmsis-plus/rtos/os.h>
+
+#if defined(__ARM_EABI__)
+#include <cmsis_device.h>
+#endif
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace cortexm
+  {
+    namespace cache
+    {
+      // ----------------------------------------------------------------------
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+      /**
+       * @details
+       * Write back the dirty cache lines covering the range, so a
+       * DMA transfer from memory reads the current data.
+       *
+       * To be called before starting the transfer.
+       */
+      void
+      clean (const void* addr, std::size_t nbyte) noexcept
+      {
+#if defined(__DCACHE_PRESENT) && (__DCACHE_PRESENT == 1U)
+        if (nbyte == 0)
+          {
+            return;
+          }
+        std::uintptr_t start = align_down (
+            reinterpret_cast<std::uintptr_t> (addr));
+        std::uintptr_t end = reinterpret_cast<std::uintptr_t> (addr) + nbyte;
+        SCB_CleanDCache_by_Addr (reinterpret_cast<uint32_t*> (start),
+                                 static_cast<int32_t> (end - start));
+#endif
+      }
+
+      /**
+       * @details
+       * Discard the cache lines covering the range, so the CPU reads
+       * what a DMA transfer to memory wrote.
+       *
+       * To be called after the transfer completed, and also
+       * before starting it when the CPU may have written to the
+       * buffer, otherwise dirty lines evicted during the transfer
+       * overwrite the received data (use `clean_invalidate()`).
+       *
+       * The partial lines at the ends, shared with other data,
+       * are cleaned and invalidated, to preserve that data;
+       * their part of the buffer is not reliable, unless the
+       * buffer is aligned (see `dma_buffer`).
+       */
+      void
+      invalidate (void* addr, std::size_t nbyte) noexcept
+      {
+#if defined(__DCACHE_PRESENT) && (__DCACHE_PRESENT == 1U)
+        if (nbyte == 0)
+          {
+            return;
+          }
+        std::uintptr_t start = reinterpret_cast<std::uintptr_t> (addr);
+        std::uintptr_t end = start + nbyte;
+
+        std::uintptr_t first = align_down (start);
+        if (first != start)
+          {
+            SCB_CleanInvalidateDCache_by_Addr (
+                reinterpret_cast<uint32_t*> (first),
+                static_cast<int32_t> (line_size_bytes));
+            first += line_size_bytes;
+          }
+        std::uintptr_t last = align_down (end);
+        if (last != end && last >= first)
+          {
+            SCB_CleanInvalidateDCache_by_Addr (
+                reinterpret_cast<uint32_t*> (last),
+                static_cast<int32_t> (line_size_bytes));
+          }
+        if (last > first)
+          {
+            SCB_InvalidateDCache_by_Addr (reinterpret_cast<uint32_t*> (first),
+                                          static_cast<int32_t> (last - first));
+          }
+#endif
+      }
+
+      /**
+       * @details
+       * Write back and discard the cache lines covering the range.
+       *
+       * To be called before starting a DMA transfer to memory, so no
+       * dirty line is evicted over the received data.
+       */
+      void
+      clean_invalidate (void* addr, std::size_t nbyte) noexcept
+      {
+#if defined(__DCACHE_PRESENT) && (__DCACHE_PRESENT == 1U)
+        if (nbyte == 0)
+          {
+            return;
+          }
+        std::uintptr_t start = align_down (
+            reinterpret_cast<std::uintptr_t> (addr));
+        std::uintptr_t end = reinterpret_cast<std::uintptr_t> (addr) + nbyte;
+        SCB_CleanInvalidateDCache_by_Addr (reinterpret_cast<uint32_t*> (start),
+                                           static_cast<int32_t> (end - start));
+#endif
+      }
+
+#pragma GCC diagnostic pop
+
+      /**
+       * @details
+       * The buffer is aligned to the cache line and its size is
+       * rounded up to whole lines, so the cache maintenance
+       * does not affect other data.
+       *
+       * @note It uses a scheduler critical section, like `malloc()`.
+       *
+       * @warning Cannot be invoked from Interrupt Service Routines.
+       */
+      void*
+      allocate_dma_buffer (std::size_t nbyte,
+                           rtos::memory::memory_resource* res)
+      {
+        if (res == nullptr)
+          {
+            res = rtos::memory::get_default_resource ();
+          }
+
+        // ----- Enter critical section ---------------------------------------
+        rtos::scheduler::critical_section scs;
+
+        return res->allocate (align_up (nbyte), line_size_bytes);
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      void
+      deallocate_dma_buffer (void* addr, std::size_t nbyte,
+                             rtos::memory::memory_resource* res)
+      {
+        if (res == nullptr)
+          {
+            res = rtos::memory::get_default_resource ();
+          }
+
+        // ----- Enter critical section ---------------------------------------
+        rtos::scheduler::critical_section scs;
+
+        res->deallocate (addr, align_up (nbyte), line_size_bytes);
+        // ----- Exit critical section ----------------------------------------
+      }
+
+    // ------------------------------------------------------------------------
+    } /* namespace cache */
+  } /* namespace cortexm */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,165 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <cmsis-plus/os-app-config.h>
+
+#if defined(OS_USE_TRACE_PROBES)
+
+#include <cmsis-plus/diag/probe.h>
+#include <cmsis-plus/diag/trace.h>
+#include <cmsis-plus/rtos/os.h>
+
+#if defined(__ARM_EABI__)
+#include <cmsis_device.h>
+#endif
+
+// ----------------------------------------------------------------------------
+
+// Defined by the linker script; weak, so without them there
+// are simply no records to print.
+extern "C"
+{
+  extern os::trace::probe::probe_t* const __os_probes_start[]
+  __attribute__((weak));
+  extern os::trace::probe::probe_t* const __os_probes_end[]
+  __attribute__((weak));
+}
+
+namespace os
+{
+  namespace trace
+  {
+    namespace probe
+    {
+      // ----------------------------------------------------------------------
+
+      void
+      initialize (void)
+      {
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+      }
+
+      uint32_t __attribute__((weak))
+      cycles (void)
+      {
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+        return DWT->CYCCNT;
+#else
+        return 0;
+#endif
+      }
+
+      /**
+       * @details
+       * The record is updated with interrupts disabled, so probes
+       * can also be used in interrupt handlers.
+       */
+      void
+      update (probe_t& p, uint32_t cycles)
+      {
+        // ----- Enter critical section ---------------------------------------
+        rtos::interrupts::critical_section ics;
+
+        ++p.count;
+        p.total += cycles;
+        if (cycles < p.min)
+          {
+            p.min = cycles;
+          }
+        if (cycles > p.max)
+          {
+            p.max = cycles;
+          }
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      void
+      reset (void)
+      {
+        for (probe_t* const * pp = __os_probes_start; pp < __os_probes_end;
+            ++pp)
+          {
+            probe_t* p = *pp;
+
+            // ----- Enter critical section -----------------------------------
+            rtos::interrupts::critical_section ics;
+
+            p->count = 0;
+            p->min = UINT32_MAX;
+            p->max = 0;
+            p->total = 0;
+            // ----- Exit critical section ------------------------------------
+          }
+      }
+
+      /**
+       * @details
+       * One line for each probe that was hit, with the count and
+       * the minimum, average and maximum number of cycles.
+       */
+      void
+      trace_print (void)
+      {
+        for (probe_t* const * pp = __os_probes_start; pp < __os_probes_end;
+            ++pp)
+          {
+            probe_t* p = *pp;
+            probe_t r;
+              {
+                // ----- Enter critical section -------------------------------
+                rtos::interrupts::critical_section ics;
+
+                r = *p;
+                // ----- Exit critical section --------------------------------
+              }
+
+            if (r.count == 0)
+              {
+                continue;
+              }
+
+            trace::printf ("probe %s: %u, min %u, avg %u, max %u cycles\n",
+                           r.name, static_cast<unsigned int> (r.count),
+                           static_cast<unsigned int> (r.min),
+                           static_cast<unsigned int> (r.total / r.count),
+                           static_cast<unsigned int> (r.max));
+          }
+      }
+
+    } /* namespace probe */
+  } /* namespace trace */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* defined(OS_USE_TRACE_PROBES) */
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,344 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#if defined(TRACE)
+
+#include <cmsis-plus/os-app-config.h>
+
+#if defined(OS_USE_TRACE_BINARY)
+
+#include <cmsis-plus/diag/trace.h>
+#include <cmsis-plus/diag/trace-binary.h>
+
+#if defined(__ARM_EABI__)
+#include <cmsis_device.h>
+#endif
+
+#if defined(__ARM_ARCH_6M__)
+#include <cmsis-plus/rtos/os.h>
+#endif
+
+#include <cstdio>
+
+#ifndef OS_INTEGER_TRACE_PRINTF_TMP_ARRAY_SIZE
+#define OS_INTEGER_TRACE_PRINTF_TMP_ARRAY_SIZE (200)
+#endif
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+  constexpr std::size_t ring_words = OS_INTEGER_TRACE_BINARY_BUFFER_WORDS;
+
+  static_assert((ring_words & (ring_words - 1)) == 0,
+      "The ring size must be a power of 2");
+
+  // Record header: format, timestamp, number of arguments.
+  constexpr std::size_t header_words = 3;
+
+  // "BTRC"
+  constexpr uint32_t ring_magic = 0x43525442;
+
+  // Or-ed to the number of arguments when the format is interned.
+  constexpr uintptr_t interned_flag = 0x80;
+}
+
+// Exported with C linkage for the debugger scripts and host decoders.
+// The indices are free running counters of words; a record is
+// complete when its first word (the format pointer) is not zero.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+extern "C"
+{
+  struct os_trace_binary_ring_s
+  {
+    uint32_t magic;
+    uint32_t size;
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    volatile uint32_t dropped;
+    volatile os::trace::binary::word_t buf[ring_words];
+  };
+
+  os_trace_binary_ring_s os_trace_binary_ring =
+    { ring_magic, ring_words, 0, 0, 0,
+      { 0 } };
+}
+
+#pragma GCC diagnostic pop
+
+namespace os
+{
+  namespace trace
+  {
+    namespace binary
+    {
+      // ----------------------------------------------------------------------
+
+      void
+      initialize (void)
+      {
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CYCCNT = 0;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+      }
+
+      uint32_t __attribute__((weak))
+      timestamp (void)
+      {
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+        return DWT->CYCCNT;
+#else
+        return 0;
+#endif
+      }
+
+      /**
+       * @details
+       * Space is reserved by advancing the head with a compare and
+       * swap (or, on ARMv6-M, which has no exclusive access, in a
+       * short critical section), the record is written, and the
+       * format pointer is stored last, to commit it. When the ring
+       * is full the record is dropped and counted.
+       */
+      static void
+      store (const char* format, word_t flags, const word_t* args,
+             std::size_t nargs)
+      {
+        if (format == nullptr || nargs > max_args)
+          {
+            return;
+          }
+
+        uint32_t ts = timestamp ();
+        uint32_t n = static_cast<uint32_t> (header_words + nargs);
+        uint32_t head;
+
+#if defined(__ARM_ARCH_6M__)
+          {
+            // ----- Enter critical section -----------------------------------
+            rtos::interrupts::critical_section ics;
+
+            head = os_trace_binary_ring.head;
+            if (head - os_trace_binary_ring.tail + n > ring_words)
+              {
+                ++os_trace_binary_ring.dropped;
+                return;
+              }
+            os_trace_binary_ring.head = head + n;
+            // ----- Exit critical section ------------------------------------
+          }
+#else
+        head = __atomic_load_n (&os_trace_binary_ring.head, __ATOMIC_RELAXED);
+        do
+          {
+            uint32_t tail = __atomic_load_n (&os_trace_binary_ring.tail,
+                                             __ATOMIC_ACQUIRE);
+            if (head - tail + n > ring_words)
+              {
+                __atomic_fetch_add (&os_trace_binary_ring.dropped, 1,
+                                    __ATOMIC_RELAXED);
+                return;
+              }
+          }
+        while (!__atomic_compare_exchange_n (&os_trace_binary_ring.head, &head,
+                                             head + n, true, __ATOMIC_RELAXED,
+                                             __ATOMIC_RELAXED));
+#endif
+
+        constexpr uint32_t mask = ring_words - 1;
+        volatile word_t* buf = os_trace_binary_ring.buf;
+
+        buf[(head + 1) & mask] = ts;
+        buf[(head + 2) & mask] = nargs | flags;
+        for (std::size_t i = 0; i < nargs; ++i)
+          {
+            buf[(head + header_words + i) & mask] = args[i];
+          }
+
+        __atomic_store_n (&buf[head & mask], reinterpret_cast<word_t> (format),
+                          __ATOMIC_RELEASE);
+      }
+
+      void
+      record (const char* format, const word_t* args, std::size_t nargs)
+      {
+        store (format, 0, args, nargs);
+      }
+
+      /**
+       * @details
+       * The format is never dereferenced; with the `.trace_fmt`
+       * section not loaded, its address is only an ID for the host.
+       */
+      void
+      record_interned (const char* format, const word_t* args,
+                       std::size_t nargs)
+      {
+        store (format, interned_flag, args, nargs);
+      }
+
+      /**
+       * @details
+       * Single consumer; stops at the first record not yet
+       * committed. Each record is written as one line, prefixed
+       * with the timestamp; records with interned formats are
+       * written as the format ID followed by the raw arguments,
+       * to be decoded on the host.
+       */
+      std::size_t
+      drain (std::size_t max_records)
+      {
+        constexpr uint32_t mask = ring_words - 1;
+        volatile word_t* buf = os_trace_binary_ring.buf;
+
+        std::size_t count = 0;
+        while (count < max_records)
+          {
+            uint32_t tail = os_trace_binary_ring.tail;
+            if (tail == __atomic_load_n (&os_trace_binary_ring.head,
+                                         __ATOMIC_ACQUIRE))
+              {
+                break;
+              }
+
+            word_t w = __atomic_load_n (&buf[tail & mask], __ATOMIC_ACQUIRE);
+            if (w == 0)
+              {
+                // Reserved, not yet committed.
+                break;
+              }
+
+            const char* format = reinterpret_cast<const char*> (w);
+            uint32_t ts = static_cast<uint32_t> (buf[(tail + 1) & mask]);
+            std::size_t nargs = buf[(tail + 2) & mask];
+            bool is_interned = ((nargs & interned_flag) != 0);
+            nargs &= ~interned_flag;
+            if (nargs > max_args)
+              {
+                nargs = max_args;
+              }
+
+            word_t a[max_args] =
+              { 0, 0, 0, 0 };
+            for (std::size_t i = 0; i < nargs; ++i)
+              {
+                a[i] = buf[(tail + header_words + i) & mask];
+              }
+
+            // Free the slot before releasing the space.
+            buf[tail & mask] = 0;
+            __atomic_store_n (
+                &os_trace_binary_ring.tail,
+                tail + static_cast<uint32_t> (header_words + nargs),
+                __ATOMIC_RELEASE);
+
+            char line[OS_INTEGER_TRACE_PRINTF_TMP_ARRAY_SIZE];
+            int len = ::snprintf (line, sizeof(line), "[%10u] ",
+                                  static_cast<unsigned int> (ts));
+            if (len > 0 && static_cast<std::size_t> (len) < sizeof(line))
+              {
+                std::size_t room = sizeof(line)
+                    - static_cast<std::size_t> (len);
+                int ret;
+                if (is_interned)
+                  {
+                    // The ID and the raw arguments, one line.
+                    ret = ::snprintf (line + len, room, "@0x%lx",
+                                      static_cast<unsigned long> (w));
+                    for (std::size_t i = 0; i <= nargs; ++i)
+                      {
+                        if (ret <= 0 || static_cast<std::size_t> (ret) >= room)
+                          {
+                            break;
+                          }
+                        int r;
+                        if (i < nargs)
+                          {
+                            r = ::snprintf (
+                                line + len + ret,
+                                room - static_cast<std::size_t> (ret),
+                                " 0x%lx", static_cast<unsigned long> (a[i]));
+                          }
+                        else
+                          {
+                            r = ::snprintf (
+                                line + len + ret,
+                                room - static_cast<std::size_t> (ret), "\n");
+                          }
+                        if (r > 0)
+                          {
+                            ret += r;
+                          }
+                      }
+                  }
+                else
+                  {
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+#pragma GCC diagnostic ignored "-Wformat-security"
+                    ret = ::snprintf (line + len, room, format, a[0], a[1],
+                                      a[2], a[3]);
+#pragma GCC diagnostic pop
+                  }
+                if (ret > 0)
+                  {
+                    len += ret;
+                    if (static_cast<std::size_t> (len) >= sizeof(line))
+                      {
+                        len = sizeof(line) - 1;
+                      }
+                  }
+                write (line, static_cast<std::size_t> (len));
+              }
+
+            ++count;
+          }
+
+        return count;
+      }
+
+      uint32_t
+      dropped (void)
+      {
+        return os_trace_binary_ring.dropped;
+      }
+
+    } /* namespace binary */
+  } /* namespace trace */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* defined(OS_USE_TRACE_BINARY) */
+#endif /* defined(TRACE) */
+
+// ----------------------------------------------------------------------------
@@ -36,11 +36,18 @@
 #if defined(OS_USE_TRACE_ITM)
 
 #include <cmsis-plus/diag/trace.h>
+#include <cmsis-plus/diag/trace-itm.h>
+
+#if defined(OS_USE_TRACE_ITM_RTOS_EVENTS)
+#include <cmsis-plus/rtos/os.h>
+#endif
 
 // TODO: Find a better way to include the ITM definitions (including
 // the entire vendor header is averkill).
 #include <cmsis_device.h>
 
+#include <cstring>
+
 // ----------------------------------------------------------------------------
 
 namespace os
@@ -49,11 +56,30 @@ namespace os
     {
       // ------------------------------------------------------------------------
 
+      /**
+       * @details
+       * The debug registers are set by the JTAG software; with
+       * `OS_USE_TRACE_ITM_TIMESTAMPS`, if the debugger enabled the
+       * ITM, the local and global timestamps, the synchronisation
+       * packets and the forwarding of the DWT packets are also
+       * enabled. The trace clock, the SWO speed and the enabled
+       * stimulus ports remain the debugger choice.
+       */
       void
       initialize (void)
       {
-        // For ITM no inits required.
-        // The debug registers are set the JTAG software.
+#if defined(OS_USE_TRACE_ITM_TIMESTAMPS) \
+    && (defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__))
+        if ((ITM->TCR & ITM_TCR_ITMENA_Msk) != 0)
+          {
+            // Unlock the access to the ITM registers.
+            ITM->LAR = 0xC5ACCE55;
+
+            // Global timestamps every 8192 cycles.
+            ITM->TCR |= ITM_TCR_TSENA_Msk | ITM_TCR_SYNCENA_Msk
+                | ITM_TCR_DWTENA_Msk | (2UL << ITM_TCR_GTSFREQ_Pos);
+          }
+#endif
       }
 
       // ----------------------------------------------------------------------
@@ -69,10 +95,6 @@ namespace os
       // so this configuration will not work on OpenOCD (will not crash, but
       // nothing will be displayed in the output console).
 
-#if !defined(OS_INTEGER_TRACE_ITM_STIMULUS_PORT)
-#define OS_INTEGER_TRACE_ITM_STIMULUS_PORT     (0)
-#endif
-
       ssize_t
       write (const void* buf, std::size_t nbyte)
       {
@@ -81,30 +103,151 @@ namespace os
             return 0;
           }
 
-        const char* cbuf = (const char*) buf;
+        return static_cast<ssize_t> (itm::write (itm::text_port, buf, nbyte));
+      }
 
-        for (size_t i = 0; i < nbyte; i++)
-          {
-            // Check if ITM or the stimulus port are not enabled.
-            if (((ITM->TCR & ITM_TCR_ITMENA_Msk) == 0)
-                || ((ITM->TER & (1UL << OS_INTEGER_TRACE_ITM_STIMULUS_PORT))
-                    == 0))
-              {
-                // Return the number of sent characters (may be 0).
-                return (ssize_t) i;
-              }
-
-            // Wait until STIMx is ready...
-            while (ITM->PORT[OS_INTEGER_TRACE_ITM_STIMULUS_PORT].u32 == 0)
-              ;
-            // then send data, one byte at a time
-            ITM->PORT[OS_INTEGER_TRACE_ITM_STIMULUS_PORT].u8 =
-                (uint8_t) (*cbuf++);
-          }
+      namespace itm
+      {
+        // --------------------------------------------------------------------
 
-        // All characters successfully sent.
-        return (ssize_t) nbyte;
-      }
+        bool
+        is_enabled (port_t port)
+        {
+          return ((ITM->TCR & ITM_TCR_ITMENA_Msk) != 0)
+              && ((ITM->TER & (1UL << port)) != 0);
+        }
+
+        // Each write is a single packet of the given size; the port
+        // FIFO is flushed before the write, as in the byte-by-byte
+        // version.
+
+        void
+        write_u8 (port_t port, uint8_t value)
+        {
+          if (!is_enabled (port))
+            {
+              return;
+            }
+
+          // Wait until STIMx is ready...
+          while (ITM->PORT[port].u32 == 0)
+            ;
+          ITM->PORT[port].u8 = value;
+        }
+
+        void
+        write_u16 (port_t port, uint16_t value)
+        {
+          if (!is_enabled (port))
+            {
+              return;
+            }
+
+          while (ITM->PORT[port].u32 == 0)
+            ;
+          ITM->PORT[port].u16 = value;
+        }
+
+        void
+        write_u32 (port_t port, uint32_t value)
+        {
+          if (!is_enabled (port))
+            {
+              return;
+            }
+
+          while (ITM->PORT[port].u32 == 0)
+            ;
+          ITM->PORT[port].u32 = value;
+        }
+
+        /**
+         * @details
+         * The bytes are sent as 32-bit packets, in order (the core
+         * is little endian), with the tail sent as a half word and
+         * a byte; it takes a quarter of the packets of the byte
+         * by byte writes.
+         */
+        std::size_t
+        write (port_t port, const void* buf, std::size_t nbyte)
+        {
+          const uint8_t* p = static_cast<const uint8_t*> (buf);
+          std::size_t i = 0;
+
+          while (i < nbyte)
+            {
+              // Check if ITM or the stimulus port are not enabled.
+              if (!is_enabled (port))
+                {
+                  // Return the number of sent characters (may be 0).
+                  return i;
+                }
+
+              // Wait until STIMx is ready...
+              while (ITM->PORT[port].u32 == 0)
+                ;
+
+              std::size_t left = nbyte - i;
+              if (left >= 4)
+                {
+                  uint32_t w;
+                  std::memcpy (&w, p + i, 4);
+                  ITM->PORT[port].u32 = w;
+                  i += 4;
+                }
+              else if (left >= 2)
+                {
+                  uint16_t h;
+                  std::memcpy (&h, p + i, 2);
+                  ITM->PORT[port].u16 = h;
+                  i += 2;
+                }
+              else
+                {
+                  ITM->PORT[port].u8 = p[i];
+                  i += 1;
+                }
+            }
+
+          // All characters successfully sent.
+          return nbyte;
+        }
+
+        /**
+         * @details
+         * Configure the DWT comparator to emit a data value packet
+         * on each read or write of the word; the ITM must forward
+         * the DWT packets (`OS_USE_TRACE_ITM_TIMESTAMPS` sets it).
+         */
+        bool
+        watch_data (std::size_t comparator, const volatile void* address)
+        {
+          std::size_t count = (DWT->CTRL & DWT_CTRL_NUMCOMP_Msk)
+              >> DWT_CTRL_NUMCOMP_Pos;
+          if (comparator >= count)
+            {
+              return false;
+            }
+
+          CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+
+          // The COMP, MASK and FUNCTION registers are 16 bytes apart.
+          volatile uint32_t* regs = &DWT->COMP0 + 4 * comparator;
+          if (address == nullptr)
+            {
+              regs[2] = 0;
+              return true;
+            }
+
+          regs[0] = reinterpret_cast<uint32_t> (address);
+          regs[1] = 0; // Exact match.
+          // Word size, data value packet on read or write.
+          regs[2] = (2UL << DWT_FUNCTION_DATAVSIZE_Pos) | 2UL;
+
+          return true;
+        }
+
+      } /* namespace itm */
 
 #else
 
@@ -115,6 +258,112 @@ namespace os
     } /* namespace trace */
 } /* namespace os */
 
+// ----------------------------------------------------------------------------
+
+#if defined(OS_USE_TRACE_ITM_RTOS_EVENTS)
+
+#if !defined(OS_INCLUDE_RTOS_TRACE_EVENTS)
+#error "OS_USE_TRACE_ITM_RTOS_EVENTS requires OS_INCLUDE_RTOS_TRACE_EVENTS"
+#endif
+
+// The RTOS event tracing hooks, sent to the RTOS stimulus port as
+// a one byte event code, followed, for most events, by a word with
+// the thread, timer or object address, or the exception number;
+// the ITM timestamps give the timeline.
+//
+// 0x01 thread create      0x06 isr enter
+// 0x02 thread terminate   0x07 isr exit
+// 0x03 thread ready       0x08 timer enter
+// 0x04 thread suspend     0x09 timer exit
+// 0x05 thread run         0x10 + os_rtos_trace_event_t, object
+
+namespace
+{
+  inline void
+  __attribute__((always_inline))
+  send_event (uint8_t code)
+  {
+    os::trace::itm::write_u8 (os::trace::itm::rtos_port, code);
+  }
+
+  inline void
+  __attribute__((always_inline))
+  send_event (uint8_t code, const void* arg)
+  {
+    os::trace::itm::write_u8 (os::trace::itm::rtos_port, code);
+    os::trace::itm::write_u32 (os::trace::itm::rtos_port,
+                               reinterpret_cast<uint32_t> (arg));
+  }
+}
+
+void
+os_rtos_trace_initialize (void)
+{
+}
+
+void
+os_rtos_trace_thread_create (void* th)
+{
+  send_event (0x01, th);
+}
+
+void
+os_rtos_trace_thread_terminate (void* th)
+{
+  send_event (0x02, th);
+}
+
+void
+os_rtos_trace_thread_ready (void* th)
+{
+  send_event (0x03, th);
+}
+
+void
+os_rtos_trace_thread_suspend (void* th)
+{
+  send_event (0x04, th);
+}
+
+void
+os_rtos_trace_thread_run (void* th)
+{
+  send_event (0x05, th);
+}
+
+void
+os_rtos_trace_isr_enter (void)
+{
+  os::trace::itm::write_u8 (os::trace::itm::rtos_port, 0x06);
+  os::trace::itm::write_u32 (os::trace::itm::rtos_port, __get_IPSR ());
+}
+
+void
+os_rtos_trace_isr_exit (void)
+{
+  send_event (0x07);
+}
+
+void
+os_rtos_trace_timer_enter (void* tm)
+{
+  send_event (0x08, tm);
+}
+
+void
+os_rtos_trace_timer_exit (void)
+{
+  send_event (0x09);
+}
+
+void
+os_rtos_trace_object (os_rtos_trace_event_t event, void* object)
+{
+  send_event (static_cast<uint8_t> (0x10 + event), object);
+}
+
+#endif /* defined(OS_USE_TRACE_ITM_RTOS_EVENTS) */
+
 #endif /* defined(OS_USE_TRACE_ITM) */
 #endif /* defined(TRACE) */
 
@@ -42,6 +42,55 @@
 
 #include "SEGGER_RTT.h"
 
+#include <cstring>
+
+// ----------------------------------------------------------------------------
+
+#if !defined(__ARM_ARCH_6M__)
+
+namespace
+{
+  // Multi-producer reservation of the up buffer 0: the low 24 bits
+  // are the offset after the last reserved byte, the high 8 bits the
+  // number of writers still copying. The RTT write offset, read by
+  // the host, is advanced only when no writer is copying, so it
+  // never exposes a partly written record.
+  uint32_t reserve_state;
+
+  constexpr uint32_t offset_mask = 0x00FFFFFF;
+  constexpr uint32_t writer_one = 0x01000000;
+
+  inline unsigned
+  used (unsigned from, unsigned to, unsigned size)
+  {
+    return (to >= from) ? (to - from) : (size - from + to);
+  }
+
+  // Move the write offset forward, never backward, even if a writer
+  // preempted after the check publishes a stale value.
+  void
+  publish (SEGGER_RTT_BUFFER_UP* up, unsigned target)
+  {
+    unsigned cur = __atomic_load_n (&up->WrOff, __ATOMIC_RELAXED);
+    for (;;)
+      {
+        unsigned rd = up->RdOff;
+        if (used (rd, target, up->SizeOfBuffer)
+            <= used (rd, cur, up->SizeOfBuffer))
+          {
+            return;
+          }
+        if (__atomic_compare_exchange_n (&up->WrOff, &cur, target, true,
+                                         __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+          {
+            return;
+          }
+      }
+  }
+}
+
+#endif /* !defined(__ARM_ARCH_6M__) */
+
 // ----------------------------------------------------------------------------
 
 namespace os
@@ -55,6 +104,10 @@ namespace os
     {
       SEGGER_RTT_Init ();
 
+#if !defined(__ARM_ARCH_6M__)
+      reserve_state = _SEGGER_RTT.aUp[0].WrOff;
+#endif /* !defined(__ARM_ARCH_6M__) */
+
       // Clear the SLEEPDEEP.
       // This does not guarantee that the WFI will not prevent
       // the J-Link to read the RTT buffer, but it is the best it
@@ -77,12 +130,70 @@ namespace os
           return 0;
         }
 
+#if defined(__ARM_ARCH_6M__)
+
+      // No exclusive access instructions, use a critical section.
       ssize_t ret;
 
       rtos::interrupts::critical_section ics;
       ret = (ssize_t) SEGGER_RTT_WriteNoLock (0, buf, nbyte);
 
       return ret;
+
+#else
+
+      // Reserve the space, copy the bytes, then commit; threads and
+      // interrupts can write concurrently, without disabling the
+      // interrupts. As with SEGGER_RTT_MODE_NO_BLOCK_SKIP, messages
+      // that do not fit are dropped.
+      SEGGER_RTT_BUFFER_UP* up = &_SEGGER_RTT.aUp[0];
+      unsigned size = up->SizeOfBuffer;
+
+      uint32_t state = __atomic_load_n (&reserve_state, __ATOMIC_RELAXED);
+      unsigned start;
+      for (;;)
+        {
+          start = state & offset_mask;
+          // One byte is always kept free, to tell full from empty.
+          if (used (up->RdOff, start, size) + nbyte >= size)
+            {
+              return 0;
+            }
+          unsigned end = start + static_cast<unsigned> (nbyte);
+          if (end >= size)
+            {
+              end -= size;
+            }
+          uint32_t next = ((state & ~offset_mask) + writer_one) | end;
+          if (__atomic_compare_exchange_n (&reserve_state, &state, next, true,
+                                           __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+            {
+              break;
+            }
+        }
+
+      const char* cbuf = static_cast<const char*> (buf);
+      std::size_t first = size - start;
+      if (first >= nbyte)
+        {
+          std::memcpy (up->pBuffer + start, cbuf, nbyte);
+        }
+      else
+        {
+          std::memcpy (up->pBuffer + start, cbuf, first);
+          std::memcpy (up->pBuffer, cbuf + first, nbyte - first);
+        }
+
+      // Commit; the last writer publishes all reserved bytes.
+      state = __atomic_sub_fetch (&reserve_state, writer_one, __ATOMIC_ACQ_REL);
+      if ((state & ~offset_mask) == 0)
+        {
+          publish (up, state & offset_mask);
+        }
+
+      return static_cast<ssize_t> (nbyte);
+
+#endif /* defined(__ARM_ARCH_6M__) */
     }
 
     void
@@ -0,0 +1,215 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#if defined(__ARM_EABI__)
+
+// ----------------------------------------------------------------------------
+
+#include <cmsis-plus/os-app-config.h>
+
+#if defined(OS_USE_TRACE_SEGGER_SYSTEMVIEW)
+
+#if !defined(OS_INCLUDE_RTOS_TRACE_EVENTS)
+#error "OS_USE_TRACE_SEGGER_SYSTEMVIEW requires OS_INCLUDE_RTOS_TRACE_EVENTS"
+#endif
+
+#include <cmsis-plus/rtos/os.h>
+
+#include <cmsis_device.h>
+
+#include "SEGGER_SYSVIEW.h"
+
+#include <cstring>
+
+// ----------------------------------------------------------------------------
+
+// The RTOS event tracing hooks, implemented with the SEGGER SystemView
+// target library, which encodes the compact binary records and sends
+// them over RTT.
+//
+// The synchronisation object events are recorded as API events,
+// with the shrunk object address as parameter; for them to be
+// displayed by name, the SystemView description file must map the
+// identifiers, for example:
+//
+// 32 sem_post     obj=%p
+// 33 sem_wait     obj=%p
+// 34 mutex_lock   obj=%p
+// 35 mutex_unlock obj=%p
+// 36 mq_send      obj=%p
+// 37 mq_receive   obj=%p
+// 38 ev_raise     obj=%p
+// 39 ev_wait      obj=%p
+
+using namespace os;
+using namespace os::rtos;
+
+#if !defined(OS_USE_RTOS_PORT_SCHEDULER)
+extern thread* os_idle_thread;
+#endif
+
+namespace
+{
+  // The first identifier free for the API events.
+  constexpr unsigned int api_event_base = 32;
+
+  U64
+  get_time (void)
+  {
+    return static_cast<U64> (sysclock.now ()) * 1000000u
+        / clock_systick::frequency_hz;
+  }
+
+  void
+  send_task_info (thread* th)
+  {
+    SEGGER_SYSVIEW_TASKINFO info;
+    std::memset (&info, 0, sizeof(info));
+
+    info.TaskID = reinterpret_cast<U32> (th);
+    info.sName = th->name ();
+    info.Prio = th->priority ();
+    info.StackBase = reinterpret_cast<U32> (th->stack ().bottom ());
+    info.StackSize = static_cast<U32> (th->stack ().size ());
+
+    SEGGER_SYSVIEW_SendTaskInfo (&info);
+  }
+
+  void
+  send_children (thread* parent)
+  {
+    for (auto&& th : scheduler::children_threads (parent))
+      {
+        send_task_info (&th);
+        send_children (&th);
+      }
+  }
+
+  void
+  send_task_list (void)
+  {
+    send_children (nullptr);
+  }
+
+  void
+  send_system_description (void)
+  {
+    SEGGER_SYSVIEW_SendSysDesc ("N=uOS++,O=uOS++");
+    SEGGER_SYSVIEW_SendSysDesc ("I#15=SysTick");
+  }
+
+  const SEGGER_SYSVIEW_OS_API os_api =
+    { get_time, send_task_list };
+}
+
+// ----------------------------------------------------------------------------
+
+void
+os_rtos_trace_initialize (void)
+{
+  SEGGER_SYSVIEW_Init (SystemCoreClock, SystemCoreClock, &os_api,
+                       send_system_description);
+}
+
+void
+os_rtos_trace_thread_create (void* th)
+{
+  SEGGER_SYSVIEW_OnTaskCreate (reinterpret_cast<U32> (th));
+  send_task_info (static_cast<thread*> (th));
+}
+
+void
+os_rtos_trace_thread_terminate (void* th)
+{
+  SEGGER_SYSVIEW_OnTaskTerminate (reinterpret_cast<U32> (th));
+}
+
+void
+os_rtos_trace_thread_ready (void* th)
+{
+  SEGGER_SYSVIEW_OnTaskStartReady (reinterpret_cast<U32> (th));
+}
+
+void
+os_rtos_trace_thread_suspend (void* th)
+{
+  SEGGER_SYSVIEW_OnTaskStopReady (reinterpret_cast<U32> (th), 0);
+}
+
+void
+os_rtos_trace_thread_run (void* th)
+{
+#if !defined(OS_USE_RTOS_PORT_SCHEDULER)
+  if (th == os_idle_thread)
+    {
+      SEGGER_SYSVIEW_OnIdle ();
+      return;
+    }
+#endif
+  SEGGER_SYSVIEW_OnTaskStartExec (reinterpret_cast<U32> (th));
+}
+
+void
+os_rtos_trace_isr_enter (void)
+{
+  SEGGER_SYSVIEW_RecordEnterISR ();
+}
+
+void
+os_rtos_trace_isr_exit (void)
+{
+  SEGGER_SYSVIEW_RecordExitISR ();
+}
+
+void
+os_rtos_trace_timer_enter (void* tm)
+{
+  SEGGER_SYSVIEW_RecordEnterTimer (
+      SEGGER_SYSVIEW_ShrinkId (reinterpret_cast<U32> (tm)));
+}
+
+void
+os_rtos_trace_timer_exit (void)
+{
+  SEGGER_SYSVIEW_RecordExitTimer ();
+}
+
+void
+os_rtos_trace_object (os_rtos_trace_event_t event, void* object)
+{
+  SEGGER_SYSVIEW_RecordU32 (
+      api_event_base + static_cast<unsigned int> (event),
+      SEGGER_SYSVIEW_ShrinkId (reinterpret_cast<U32> (object)));
+}
+
+// ----------------------------------------------------------------------------
+
+#endif /* defined(OS_USE_TRACE_SEGGER_SYSTEMVIEW) */
+#endif /* defined(__ARM_EABI__) */
+
+// ----------------------------------------------------------------------------
@@ -45,6 +45,10 @@
 
 #include <cmsis-plus/arm/semihosting.h>
 
+#if defined(OS_USE_TRACE_SEMIHOSTING_BUFFERED)
+#include <cmsis-plus/rtos/os.h>
+#endif
+
 // ----------------------------------------------------------------------------
 
 namespace os
@@ -93,8 +97,8 @@ namespace os
 #define OS_INTEGER_TRACE_SEMIHOSTING_BUFF_ARRAY_SIZE  (16)
 #endif
 
-      ssize_t
-      write (const void* buf, std::size_t nbyte)
+      static ssize_t
+      host_write (const void* buf, std::size_t nbyte)
       {
         if (buf == nullptr || nbyte == 0)
           {
@@ -139,8 +143,8 @@ namespace os
 
 #elif defined(OS_USE_TRACE_SEMIHOSTING_STDOUT)
 
-    ssize_t
-    write (const void* buf, std::size_t nbyte)
+    static ssize_t
+    host_write (const void* buf, std::size_t nbyte)
       {
       if (buf == nullptr || nbyte == 0)
         {
@@ -196,6 +200,181 @@ namespace os
 
 #endif /* defined(OS_USE_TRACE_SEMIHOSTING_STDOUT) */
 
+      // ----------------------------------------------------------------------
+
+#if defined(OS_USE_TRACE_SEMIHOSTING_BUFFERED)
+
+      // Each semihosting call halts the core for a long time, so
+      // the messages are collected in a ring buffer and sent in large
+      // chunks, when a line ends with the buffer above the threshold,
+      // when the buffer is full, from the idle thread, or when
+      // explicitly flushed.
+
+#if !defined(OS_INTEGER_TRACE_SEMIHOSTING_BUFFER_SIZE)
+#define OS_INTEGER_TRACE_SEMIHOSTING_BUFFER_SIZE (1024)
+#endif
+
+#if !defined(OS_INTEGER_TRACE_SEMIHOSTING_FLUSH_THRESHOLD)
+#define OS_INTEGER_TRACE_SEMIHOSTING_FLUSH_THRESHOLD \
+  (OS_INTEGER_TRACE_SEMIHOSTING_BUFFER_SIZE / 2)
+#endif
+
+      namespace
+      {
+        constexpr std::size_t buffer_size =
+        OS_INTEGER_TRACE_SEMIHOSTING_BUFFER_SIZE;
+
+        static_assert(buffer_size > 2, "The buffer is too small");
+
+        // One more byte, always zero, terminates the chunks
+        // that end at the buffer end, for SYS_WRITE0.
+        char buffer[buffer_size + 1];
+
+        // Next byte to write and next byte to send.
+        std::size_t head;
+        std::size_t tail;
+
+        bool flushing;
+
+        inline std::size_t
+        used (void)
+        {
+          return (head + buffer_size - tail) % buffer_size;
+        }
+      }
+
+      /**
+       * @details
+       * The bytes are copied in the buffer, in a short critical
+       * section. When the buffer is full it is flushed; if the
+       * caller interrupted a flush, the rest of the bytes are sent
+       * directly, to avoid waiting for it.
+       */
+      ssize_t
+      write (const void* buf, std::size_t nbyte)
+      {
+        if (buf == nullptr || nbyte == 0)
+          {
+            return 0;
+          }
+
+        const char* cbuf = static_cast<const char*> (buf);
+        std::size_t done = 0;
+        bool line_end = false;
+
+        while (done < nbyte)
+          {
+            bool is_full;
+            bool is_flushing;
+              {
+                // ----- Enter critical section -----------------------------
+                rtos::interrupts::critical_section ics;
+
+                // One slot is always free, plus one for the
+                // terminator inserted by flush().
+                std::size_t room = buffer_size - 2 - used ();
+                for (; room > 0 && done < nbyte; --room, ++done)
+                  {
+                    char c = cbuf[done];
+                    if (c == '\n')
+                      {
+                        line_end = true;
+                      }
+                    buffer[head] = c;
+                    head = (head + 1) % buffer_size;
+                  }
+                is_full = (done < nbyte);
+                is_flushing = flushing;
+                // ----- Exit critical section ------------------------------
+              }
+
+            if (is_full)
+              {
+                if (is_flushing)
+                  {
+                    host_write (cbuf + done, nbyte - done);
+                    break;
+                  }
+                flush ();
+              }
+          }
+
+        if (line_end && used () >= OS_INTEGER_TRACE_SEMIHOSTING_FLUSH_THRESHOLD)
+          {
+            flush ();
+          }
+
+        // All bytes written.
+        return static_cast<ssize_t> (nbyte);
+      }
+
+      /**
+       * @details
+       * The pending bytes are sent with one host call for each
+       * contiguous chunk. Other threads and interrupts can write
+       * to the buffer during the (slow) host calls; nested calls
+       * to flush() return immediately.
+       */
+      void
+      flush (void)
+      {
+        while (true)
+          {
+            const char* chunk;
+            std::size_t n;
+            std::size_t skip;
+              {
+                // ----- Enter critical section -----------------------------
+                rtos::interrupts::critical_section ics;
+
+                if (flushing || head == tail)
+                  {
+                    return;
+                  }
+                flushing = true;
+
+                chunk = &buffer[tail];
+                if (head > tail)
+                  {
+                    // Terminate the chunk in place, with a byte
+                    // reserved in the buffer and skipped later.
+                    n = head - tail;
+                    buffer[head] = '\0';
+                    head = (head + 1) % buffer_size;
+                    skip = 1;
+                  }
+                else
+                  {
+                    // Up to the buffer end; the rest in the next pass.
+                    n = buffer_size - tail;
+                    skip = 0;
+                  }
+                // ----- Exit critical section ------------------------------
+              }
+
+            host_write (chunk, n);
+
+              {
+                // ----- Enter critical section -----------------------------
+                rtos::interrupts::critical_section ics;
+
+                tail = (tail + n + skip) % buffer_size;
+                flushing = false;
+                // ----- Exit critical section ------------------------------
+              }
+          }
+      }
+
+#else
+
+      ssize_t
+      write (const void* buf, std::size_t nbyte)
+      {
+        return host_write (buf, nbyte);
+      }
+
+#endif /* defined(OS_USE_TRACE_SEMIHOSTING_BUFFERED) */
+
   } /* namespace trace */
 } /* namespace os */
 
@@ -38,6 +38,16 @@
 #define OS_INTEGER_TRACE_PRINTF_TMP_ARRAY_SIZE (200)
 #endif
 
+#if defined(OS_USE_TRACE_CATEGORIES)
+
+#ifndef OS_INTEGER_TRACE_CATEGORIES
+#define OS_INTEGER_TRACE_CATEGORIES (0)
+#endif
+
+volatile uint32_t os_trace_categories = OS_INTEGER_TRACE_CATEGORIES;
+
+#endif /* defined(OS_USE_TRACE_CATEGORIES) */
+
 // ----------------------------------------------------------------------------
 
 namespace os
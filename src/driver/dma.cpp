@@ -0,0 +1,419 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <cmsis-plus/driver/dma.h>
+#include <cmsis-plus/cortexm/cache.h>
+#include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/diag/trace.h>
+
+#include <cassert>
+#include <cstring>
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+  // The thread flag raised when a copy completes.
+  constexpr os::rtos::flags::mask_t copy_flag = (1UL << 30);
+
+  os::driver::Dma* memcpy_engine;
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+  struct copy_context
+  {
+    os::rtos::thread* thread;
+    os::driver::event_t event;
+  };
+
+#pragma GCC diagnostic pop
+}
+
+namespace os
+{
+  namespace driver
+  {
+    namespace dma
+    {
+      // ----------------------------------------------------------------------
+
+      /**
+       * @details
+       * Write back the dirty cache lines covering the range, so the
+       * DMA reads the current data. Does nothing on devices without
+       * data cache.
+       *
+       * @see os::cortexm::cache::clean()
+       */
+      void
+      clean_cache (const void* addr, std::size_t nbyte) noexcept
+      {
+        cortexm::cache::clean (addr, nbyte);
+      }
+
+      /**
+       * @details
+       * Discard the cache lines covering the range, so the CPU reads
+       * what the DMA wrote. The buffer should be aligned to the cache
+       * line (see `cortexm::cache::dma_buffer`); the partial lines
+       * at the ends are cleaned too, to preserve the neighbouring data.
+       *
+       * @see os::cortexm::cache::invalidate()
+       */
+      void
+      invalidate_cache (void* addr, std::size_t nbyte) noexcept
+      {
+        cortexm::cache::invalidate (addr, nbyte);
+      }
+
+      void
+      set_memcpy_engine (Dma* engine) noexcept
+      {
+        memcpy_engine = engine;
+      }
+
+      /**
+       * @details
+       * Blocks shorter than `OS_INTEGER_DRIVER_DMA_MEMCPY_THRESHOLD`
+       * are copied faster by the CPU than the time needed to
+       * program the controller and to switch threads; the same when
+       * there is no engine, when called from interrupts or before
+       * the scheduler is started, or when the copy fails to start.
+       */
+      void*
+      memcpy (void* dst, const void* src, std::size_t nbyte) noexcept
+      {
+        Dma* engine = memcpy_engine;
+        if (engine != nullptr && nbyte >= OS_INTEGER_DRIVER_DMA_MEMCPY_THRESHOLD
+            && !rtos::interrupts::in_handler_mode ()
+            && rtos::scheduler::started ())
+          {
+            if (engine->copy (dst, src, nbyte) == RETURN_OK)
+              {
+                return dst;
+              }
+          }
+
+        return std::memcpy (dst, src, nbyte);
+      }
+
+    } /* namespace dma */
+
+    // ------------------------------------------------------------------------
+
+    Dma::Dma () noexcept
+    {
+      trace::printf ("%s() %p\n", __func__, this);
+
+      for (std::size_t i = 0; i < OS_INTEGER_DRIVER_DMA_CHANNELS; ++i)
+        {
+          channels_[i].dma = this;
+          channels_[i].cb_func = nullptr;
+          channels_[i].cb_object = nullptr;
+          channels_[i].pending = 0;
+          channels_[i].ch = static_cast<dma::channel_t> (i);
+          channels_[i].deferred = false;
+        }
+    }
+
+    Dma::~Dma () noexcept
+    {
+      trace::printf ("%s() %p\n", __func__, this);
+    }
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @details
+     * Try the free channels in order, the controller may refuse
+     * some of them for a given request line.
+     */
+    dma::channel_t
+    Dma::allocate (dma::request_t request) noexcept
+    {
+      std::size_t count = get_capabilities ().channels;
+      if (count > OS_INTEGER_DRIVER_DMA_CHANNELS)
+        {
+          count = OS_INTEGER_DRIVER_DMA_CHANNELS;
+        }
+
+      for (std::size_t i = 0; i < count; ++i)
+        {
+          dma::channel_t ch = static_cast<dma::channel_t> (i);
+          uint32_t bit = (1UL << i);
+            {
+              // ----- Enter critical section ---------------------------------
+              rtos::interrupts::critical_section ics;
+
+              if ((allocated_ & bit) != 0)
+                {
+                  continue;
+                }
+              allocated_ |= bit;
+              // ----- Exit critical section ----------------------------------
+            }
+
+          if (do_open_channel (ch, request) == RETURN_OK)
+            {
+              return ch;
+            }
+
+            {
+              // ----- Enter critical section ---------------------------------
+              rtos::interrupts::critical_section ics;
+
+              allocated_ &= ~bit;
+              // ----- Exit critical section ----------------------------------
+            }
+        }
+
+      return dma::CHANNEL_NONE;
+    }
+
+    void
+    Dma::release (dma::channel_t ch) noexcept
+    {
+      assert(ch < OS_INTEGER_DRIVER_DMA_CHANNELS);
+
+      do_abort (ch);
+      do_close_channel (ch);
+
+      channels_[ch].cb_func = nullptr;
+      channels_[ch].cb_object = nullptr;
+      channels_[ch].pending = 0;
+      channels_[ch].deferred = false;
+
+        {
+          // ----- Enter critical section -------------------------------------
+          rtos::interrupts::critical_section ics;
+
+          allocated_ &= ~(1UL << ch);
+          // ----- Exit critical section --------------------------------------
+        }
+    }
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+    void
+    Dma::register_callback (dma::channel_t ch, signal_event_t cb_func,
+                            const void* cb_object, bool deferred) noexcept
+    {
+      assert(ch < OS_INTEGER_DRIVER_DMA_CHANNELS);
+
+      channels_[ch].cb_func = cb_func;
+      channels_[ch].cb_object = cb_object;
+#if defined(OS_INCLUDE_RTOS_DEFERRED)
+      channels_[ch].deferred = deferred;
+#else
+      // Without the deferred calls service, call from the interrupt.
+      channels_[ch].deferred = false;
+#endif
+    }
+
+#pragma GCC diagnostic pop
+
+    return_t
+    Dma::start (dma::channel_t ch, const dma::descriptor* chain) noexcept
+    {
+      assert(ch < OS_INTEGER_DRIVER_DMA_CHANNELS);
+
+      if (chain == nullptr)
+        {
+          return ERROR_PARAMETER;
+        }
+      return do_start (ch, chain);
+    }
+
+    /**
+     * @details
+     * The data cache is cleaned for the source and cleaned and
+     * invalidated for the destination before the transfer, so no
+     * dirty line is later evicted over the destination, and the
+     * destination is invalidated again after.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    return_t
+    Dma::copy (void* dst, const void* src, std::size_t nbyte) noexcept
+    {
+      assert(!rtos::interrupts::in_handler_mode ());
+
+      if (!get_capabilities ().memory_to_memory)
+        {
+          return ERROR_UNSUPPORTED;
+        }
+
+      dma::channel_t ch = allocate (dma::REQUEST_MEMORY);
+      if (ch == dma::CHANNEL_NONE)
+        {
+          return ERROR_BUSY;
+        }
+
+      dma::descriptor desc;
+      desc.next = nullptr;
+      desc.src = src;
+      desc.dst = dst;
+      if (((reinterpret_cast<uintptr_t> (dst)
+          | reinterpret_cast<uintptr_t> (src) | nbyte) & 3) == 0)
+        {
+          desc.num = nbyte / 4;
+          desc.flags = dma::FLAG_WIDTH_32;
+        }
+      else
+        {
+          desc.num = nbyte;
+          desc.flags = dma::FLAG_WIDTH_8;
+        }
+
+      copy_context ctx;
+      ctx.thread = &rtos::this_thread::thread ();
+      ctx.event = 0;
+
+      register_callback (ch, copy_complete_, &ctx);
+
+      dma::clean_cache (src, nbyte);
+      cortexm::cache::clean_invalidate (dst, nbyte);
+
+      rtos::this_thread::flags_clear (copy_flag);
+      return_t ret = do_start (ch, &desc);
+      if (ret == RETURN_OK)
+        {
+          rtos::this_thread::flags_wait (copy_flag);
+          dma::invalidate_cache (dst, nbyte);
+          if ((ctx.event & dma::Event::transfer_error) != 0)
+            {
+              ret = ERROR;
+            }
+        }
+
+      release (ch);
+      return ret;
+    }
+
+    void
+    Dma::copy_complete_ (const void* object, event_t event)
+    {
+      copy_context* ctx =
+          static_cast<copy_context*> (const_cast<void*> (object));
+
+      if ((event
+          & (dma::Event::transfer_complete | dma::Event::transfer_error)) != 0)
+        {
+          ctx->event = event;
+          ctx->thread->flags_raise (copy_flag);
+        }
+    }
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @details
+     * Called by the drivers from the DMA interrupts. For channels
+     * registered as deferred, the events are accumulated and a
+     * single call is posted to the deferred calls worker, which
+     * delivers them all at once.
+     */
+    void
+    Dma::signal_event (dma::channel_t ch, event_t event) noexcept
+    {
+      assert(ch < OS_INTEGER_DRIVER_DMA_CHANNELS);
+
+      channel_state& state = channels_[ch];
+      if (state.cb_func == nullptr)
+        {
+          return;
+        }
+
+#if defined(OS_INCLUDE_RTOS_DEFERRED)
+      if (state.deferred)
+        {
+          event_t prev;
+            {
+              // ----- Enter critical section ---------------------------------
+              rtos::interrupts::critical_section ics;
+
+              prev = state.pending;
+              state.pending = prev | event;
+              // ----- Exit critical section ----------------------------------
+            }
+
+          if (prev != 0)
+            {
+              // Already posted.
+              return;
+            }
+
+          if (rtos::deferred::post (deferred_event_, &state)
+              == rtos::result::ok)
+            {
+              return;
+            }
+
+            {
+              // ----- Enter critical section ---------------------------------
+              rtos::interrupts::critical_section ics;
+
+              event = state.pending;
+              state.pending = 0;
+              // ----- Exit critical section ----------------------------------
+            }
+        }
+#endif
+
+      // Forward event to registered callback.
+      state.cb_func (state.cb_object, event);
+    }
+
+    void
+    Dma::deferred_event_ (void* args)
+    {
+      channel_state* state = static_cast<channel_state*> (args);
+
+      event_t event;
+        {
+          // ----- Enter critical section -------------------------------------
+          rtos::interrupts::critical_section ics;
+
+          event = state->pending;
+          state->pending = 0;
+          // ----- Exit critical section --------------------------------------
+        }
+
+      signal_event_t cb_func = state->cb_func;
+      if (event != 0 && cb_func != nullptr)
+        {
+          cb_func (state->cb_object, event);
+        }
+    }
+
+  } /* namespace driver */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
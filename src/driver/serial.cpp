@@ -32,6 +32,7 @@
  */
 
 #include <cmsis-plus/driver/serial.h>
+#include <cmsis-plus/rtos/os.h>
 #include <cmsis-plus/diag/trace.h>
 
 #include <cassert>
@@ -50,6 +51,8 @@ namespace os
 
       cb_func_ = nullptr;
       cb_object_ = nullptr;
+      pending_events_ = 0;
+      coalesce_ = false;
 
       clean ();
     }
@@ -80,11 +83,94 @@ namespace os
 
     // ----------------------------------------------------------------------
 
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+    /**
+     * @details
+     * With `coalesce`, the events signalled by the interrupts are
+     * OR-ed together, and the callback is invoked once per batch,
+     * from the deferred calls worker thread, which avoids
+     * redundant wake-ups in bursts. Without the deferred calls
+     * service (`OS_INCLUDE_RTOS_DEFERRED`), the events are always
+     * delivered from the interrupt.
+     */
     void
-    Serial::register_callback (signal_event_t cb_func, const void* cb_object) noexcept
+    Serial::register_callback (signal_event_t cb_func, const void* cb_object,
+                               bool coalesce) noexcept
     {
       cb_func_ = cb_func;
       cb_object_ = cb_object;
+      pending_events_ = 0;
+#if defined(OS_INCLUDE_RTOS_DEFERRED)
+      coalesce_ = coalesce;
+#else
+      coalesce_ = false;
+#endif
+    }
+
+#pragma GCC diagnostic pop
+
+    void
+    Serial::internal_coalesce_event_ (event_t event) noexcept
+    {
+#if defined(OS_INCLUDE_RTOS_DEFERRED)
+      event_t prev;
+        {
+          // ----- Enter critical section -------------------------------------
+          rtos::interrupts::critical_section ics;
+
+          prev = pending_events_;
+          pending_events_ = prev | event;
+          // ----- Exit critical section --------------------------------------
+        }
+
+      if (prev != 0)
+        {
+          // Already posted.
+          return;
+        }
+
+      if (rtos::deferred::post (internal_deliver_events_, this)
+          == rtos::result::ok)
+        {
+          return;
+        }
+
+      // The queue is full, deliver now.
+        {
+          // ----- Enter critical section -------------------------------------
+          rtos::interrupts::critical_section ics;
+
+          event = pending_events_;
+          pending_events_ = 0;
+          // ----- Exit critical section --------------------------------------
+        }
+#endif
+
+      cb_func_ (cb_object_, event);
+    }
+
+    void
+    Serial::internal_deliver_events_ (void* args)
+    {
+      Serial* self = static_cast<Serial*> (args);
+
+      event_t event;
+        {
+          // ----- Enter critical section -------------------------------------
+          rtos::interrupts::critical_section ics;
+
+          event = self->pending_events_;
+          self->pending_events_ = 0;
+          // ----- Exit critical section --------------------------------------
+        }
+
+      signal_event_t cb_func = self->cb_func_;
+      if (event != 0 && cb_func != nullptr)
+        {
+          cb_func (self->cb_object_, event);
+        }
     }
 
     return_t
@@ -26,14 +26,28 @@
  */
 
 #include <cmsis-plus/driver/usart-wrapper.h>
+#include <cmsis-plus/rtos/os.h>
 #include <cmsis-plus/diag/trace.h>
 #include <Driver_USART.h>
 
+#include <cassert>
 #include <utility>
 #include <stdio.h>
 
 // ----------------------------------------------------------------------------
 
+namespace
+{
+  // The thread flag raised by signal_event() for the waiters.
+  constexpr os::rtos::flags::mask_t wait_flag = (1UL << 31);
+
+  constexpr os::driver::event_t rx_error_events =
+      os::driver::serial::Event::rx_overflow
+          | os::driver::serial::Event::rx_break
+          | os::driver::serial::Event::rx_framing_error
+          | os::driver::serial::Event::rx_parity_error;
+}
+
 namespace os
 {
   namespace driver
@@ -167,6 +181,7 @@ namespace os
         case serial::Control::disable_tx:
         case serial::Control::disable_rx:
         case serial::Control::disable_break:
+        case serial::Control::disable_rx_circular:
           return driver_->Control (
               ctrl - (serial::Control::disable_tx - serial::Control::enable_tx),
               0);
@@ -174,6 +189,107 @@ namespace os
       return driver_->Control (ctrl, 1);
     }
 
+    /**
+     * @details
+     * Short messages, up to `OS_INTEGER_DRIVER_USART_WRAPPER_POLL_BYTES`,
+     * are sent faster than a context switch, so the thread polls
+     * the driver count; longer ones suspend the thread until
+     * `signal_event()` raises a flag directly on it, without the
+     * semaphore and callback round-trip.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    return_t
+    usart_wrapper::send_wait (const void* data, std::size_t num) noexcept
+    {
+      assert(!rtos::interrupts::in_handler_mode ());
+
+      if (num <= OS_INTEGER_DRIVER_USART_WRAPPER_POLL_BYTES)
+        {
+          return_t ret = driver_->Send (data, static_cast<uint32_t> (num));
+          if (ret != ARM_DRIVER_OK)
+            {
+              return ret;
+            }
+          while (driver_->GetTxCount () < num)
+            {
+              ;
+            }
+          return RETURN_OK;
+        }
+
+      rtos::this_thread::flags_clear (wait_flag);
+      tx_waiter_ = &rtos::this_thread::thread ();
+
+      return_t ret = driver_->Send (data, static_cast<uint32_t> (num));
+      if (ret == ARM_DRIVER_OK)
+        {
+          rtos::this_thread::flags_wait (wait_flag);
+        }
+
+      tx_waiter_ = nullptr;
+      return ret;
+    }
+
+    /**
+     * @details
+     * Since the peer may never answer, receives are not polled;
+     * the thread is suspended until `signal_event()` raises a flag
+     * directly on it, when the receive completes or fails.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    return_t
+    usart_wrapper::receive_wait (void* data, std::size_t num) noexcept
+    {
+      assert(!rtos::interrupts::in_handler_mode ());
+
+      rtos::this_thread::flags_clear (wait_flag);
+      rx_events_ = 0;
+      rx_waiter_ = &rtos::this_thread::thread ();
+
+      return_t ret = driver_->Receive (data, static_cast<uint32_t> (num));
+      if (ret == ARM_DRIVER_OK)
+        {
+          rtos::this_thread::flags_wait (wait_flag);
+          if ((rx_events_ & rx_error_events) != 0)
+            {
+              ret = ERROR;
+            }
+        }
+
+      rx_waiter_ = nullptr;
+      return ret;
+    }
+
+    /**
+     * @details
+     * Wake up the waiting threads, if any, then forward the event
+     * to the registered callback.
+     */
+    void
+    usart_wrapper::signal_event (event_t event) noexcept
+    {
+      rtos::thread* th = tx_waiter_;
+      if (th != nullptr && (event & serial::Event::send_complete) != 0)
+        {
+          tx_waiter_ = nullptr;
+          th->flags_raise (wait_flag);
+        }
+
+      th = rx_waiter_;
+      if (th != nullptr
+          && (event & (serial::Event::receive_complete | rx_error_events))
+              != 0)
+        {
+          rx_events_ = event;
+          rx_waiter_ = nullptr;
+          th->flags_raise (wait_flag);
+        }
+
+      Serial::signal_event (event);
+    }
+
     return_t
     usart_wrapper::do_control_modem_line (serial::Modem_control ctrl) noexcept
     {
@@ -32,6 +32,7 @@
  */
 
 #include <cmsis-plus/driver/usb-device.h>
+#include <cmsis-plus/rtos/os.h>
 #include <cmsis-plus/diag/trace.h>
 #include <cassert>
 
@@ -54,6 +55,18 @@ namespace os
 
         cb_endpoint_func_ = nullptr;
         cb_endpoint_object_ = nullptr;
+
+        for (std::size_t i = 0; i < device::ENDPOINT_QUEUES; ++i)
+          {
+            queue_head_[i] = nullptr;
+            queue_tail_[i] = nullptr;
+            pending_endpoint_events_[i] = 0;
+          }
+
+        pending_device_events_ = 0;
+        pending_endpoints_ = 0;
+        coalesce_device_ = false;
+        coalesce_endpoint_ = false;
       }
 
       Device::~Device () noexcept
@@ -61,22 +74,52 @@ namespace os
         trace::printf ("%s() %p\n", __func__, this);
       }
 
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+      /**
+       * @details
+       * With `coalesce`, the events signalled by the interrupts are
+       * OR-ed together, and the callback is invoked once per batch,
+       * from the deferred calls worker thread. Without the deferred
+       * calls service (`OS_INCLUDE_RTOS_DEFERRED`), the events are
+       * always delivered from the interrupt.
+       */
       void
       Device::register_device_callback (device::signal_device_event_t cb_func,
-                                        const void* cb_object) noexcept
+                                        const void* cb_object,
+                                        bool coalesce) noexcept
       {
         cb_device_func_ = cb_func;
         cb_device_object_ = cb_object;
+#if defined(OS_INCLUDE_RTOS_DEFERRED)
+        coalesce_device_ = coalesce;
+#else
+        coalesce_device_ = false;
+#endif
       }
 
+      /**
+       * @details
+       * Coalescing applies only to the callback; the queued transfers
+       * are still restarted from the interrupt.
+       */
       void
       Device::register_endpoint_callback (
-          device::signal_endpoint_event_t cb_func, const void* cb_object) noexcept
+          device::signal_endpoint_event_t cb_func, const void* cb_object,
+          bool coalesce) noexcept
       {
         cb_endpoint_func_ = cb_func;
         cb_endpoint_object_ = cb_object;
+#if defined(OS_INCLUDE_RTOS_DEFERRED)
+        coalesce_endpoint_ = coalesce;
+#else
+        coalesce_endpoint_ = false;
+#endif
       }
 
+#pragma GCC diagnostic pop
+
       // ----------------------------------------------------------------------
 
       return_t
@@ -99,11 +142,199 @@ namespace os
 
       // ----------------------------------------------------------------------
 
+      inline std::size_t
+      Device::queue_index (endpoint_t ep_addr) noexcept
+      {
+        return static_cast<std::size_t> (ep_addr & ENDPOINT_NUMBER_MASK) * 2
+            + (((ep_addr & ENDPOINT_DIRECTION_MASK) != 0) ? 1 : 0);
+      }
+
+      /**
+       * @details
+       * Append the chain of requests to the endpoint queue; if the
+       * queue was empty, start the first transfer.
+       *
+       * When a transfer completes, the next one is started from the
+       * endpoint interrupt, before calling the callback of the
+       * completed request, so the endpoint is not left idle while the
+       * class driver processes the data.
+       *
+       * While requests are queued, the IN/OUT events of the endpoint
+       * are not forwarded to the endpoint callback.
+       *
+       * @note Can be invoked from Interrupt Service Routines.
+       */
+      return_t
+      Device::submit_transfer (endpoint_t ep_addr,
+                               device::transfer_request* request) noexcept
+      {
+        assert (request != nullptr);
+
+        device::transfer_request* last = request;
+        for (;;)
+          {
+            assert (last->data != nullptr || last->num == 0);
+            last->count = 0;
+            last->status = RETURN_OK;
+            if (last->next == nullptr)
+              {
+                break;
+              }
+            last = last->next;
+          }
+
+        std::size_t i = queue_index (ep_addr);
+        return_t ret = RETURN_OK;
+          {
+            // ----- Enter critical section -----------------------------------
+            rtos::interrupts::critical_section ics;
+
+            if (queue_head_[i] != nullptr)
+              {
+                // Started when the previous ones complete.
+                queue_tail_[i]->next = request;
+                queue_tail_[i] = last;
+              }
+            else
+              {
+                ret = do_transfer (ep_addr, request->data, request->num);
+                if (ret == RETURN_OK)
+                  {
+                    queue_head_[i] = request;
+                    queue_tail_[i] = last;
+                  }
+              }
+            // ----- Exit critical section ------------------------------------
+          }
+
+        return ret;
+      }
+
+      /**
+       * @details
+       * The callbacks of the aborted requests are called with
+       * `ERROR`; the one in progress also with the partial count.
+       */
+      return_t
+      Device::abort_transfers (endpoint_t ep_addr) noexcept
+      {
+        std::size_t i = queue_index (ep_addr);
+        device::transfer_request* list;
+        return_t ret = RETURN_OK;
+          {
+            // ----- Enter critical section -----------------------------------
+            rtos::interrupts::critical_section ics;
+
+            list = queue_head_[i];
+            queue_head_[i] = nullptr;
+            queue_tail_[i] = nullptr;
+
+            if (list != nullptr)
+              {
+                ret = do_abort_transfer (ep_addr);
+                list->count = do_get_transfer_count (ep_addr);
+              }
+            // ----- Exit critical section ------------------------------------
+          }
+
+        complete_requests (list, ERROR);
+
+        return ret;
+      }
+
+      // Called from the endpoint interrupt; return false if there is
+      // no queued request, and the event is for a plain transfer().
+      bool
+      Device::complete_queued_transfer (endpoint_t ep_addr) noexcept
+      {
+        std::size_t i = queue_index (ep_addr);
+        device::transfer_request* done;
+        device::transfer_request* failed = nullptr;
+        return_t ret = RETURN_OK;
+          {
+            // ----- Enter critical section -----------------------------------
+            rtos::interrupts::critical_section ics;
+
+            done = queue_head_[i];
+            if (done == nullptr)
+              {
+                return false;
+              }
+
+            done->count = do_get_transfer_count (ep_addr);
+
+            device::transfer_request* next = done->next;
+            done->next = nullptr;
+            queue_head_[i] = next;
+            if (next == nullptr)
+              {
+                queue_tail_[i] = nullptr;
+              }
+            else
+              {
+                // Feed the endpoint first.
+                ret = do_transfer (ep_addr, next->data, next->num);
+                if (ret != RETURN_OK)
+                  {
+                    // Cannot continue, fail all remaining requests.
+                    failed = next;
+                    queue_head_[i] = nullptr;
+                    queue_tail_[i] = nullptr;
+                  }
+              }
+            // ----- Exit critical section ------------------------------------
+          }
+
+        complete_requests (done, RETURN_OK);
+        complete_requests (failed, ret);
+
+        return true;
+      }
+
+      void
+      Device::complete_requests (device::transfer_request* list,
+                                 return_t status) noexcept
+      {
+        while (list != nullptr)
+          {
+            // Fetch the link before the owner takes the request back.
+            device::transfer_request* next = list->next;
+            list->next = nullptr;
+            list->status = status;
+            if (list->cb_func != nullptr)
+              {
+                list->cb_func (list->cb_object, list);
+              }
+            list = next;
+          }
+      }
+
+      // ----------------------------------------------------------------------
+
       void
       Device::signal_device_event (event_t event) noexcept
       {
         if (cb_device_func_ != nullptr)
           {
+            if (coalesce_device_)
+              {
+                bool idle;
+                  {
+                    // ----- Enter critical section ---------------------------
+                    rtos::interrupts::critical_section ics;
+
+                    idle = (pending_device_events_ == 0)
+                        && (pending_endpoints_ == 0);
+                    pending_device_events_ |= event;
+                    // ----- Exit critical section ----------------------------
+                  }
+                if (idle)
+                  {
+                    internal_post_events_ ();
+                  }
+                return;
+              }
+
             // Forward event to registered callback.
             cb_device_func_ (cb_device_object_, event);
           }
@@ -112,13 +343,123 @@ namespace os
       void
       Device::signal_endpoint_event (endpoint_t ep_addr, event_t event) noexcept
       {
-        if (cb_endpoint_func_ != nullptr)
+        if ((event
+            & (device::Endpoint_event::in | device::Endpoint_event::out)) != 0)
+          {
+            if (complete_queued_transfer (ep_addr))
+              {
+                // Consumed by the queue.
+                event &= ~static_cast<event_t> (device::Endpoint_event::in
+                    | device::Endpoint_event::out);
+              }
+          }
+
+        if (event != 0 && cb_endpoint_func_ != nullptr)
           {
+            if (coalesce_endpoint_)
+              {
+                std::size_t i = queue_index (ep_addr);
+                bool idle;
+                  {
+                    // ----- Enter critical section ---------------------------
+                    rtos::interrupts::critical_section ics;
+
+                    idle = (pending_device_events_ == 0)
+                        && (pending_endpoints_ == 0);
+                    pending_endpoint_events_[i] |= event;
+                    pending_endpoints_ |= (1UL << i);
+                    // ----- Exit critical section ----------------------------
+                  }
+                if (idle)
+                  {
+                    internal_post_events_ ();
+                  }
+                return;
+              }
+
             // Forward event to registered callback.
             cb_endpoint_func_ (cb_endpoint_object_, ep_addr, event);
           }
       }
 
+      // Post a single call for all the pending events; if the queue
+      // is full, deliver them now.
+      void
+      Device::internal_post_events_ (void) noexcept
+      {
+#if defined(OS_INCLUDE_RTOS_DEFERRED)
+        if (rtos::deferred::post (internal_deliver_events_, this)
+            == rtos::result::ok)
+          {
+            return;
+          }
+#endif
+        internal_deliver_events_ (this);
+      }
+
+      /**
+       * @details
+       * Deliver the device events first, then the events of each
+       * endpoint, until nothing is pending; events signalled
+       * meanwhile are delivered in the same batch.
+       */
+      void
+      Device::internal_deliver_events_ (void* args)
+      {
+        Device* self = static_cast<Device*> (args);
+
+        for (;;)
+          {
+            event_t device_events = 0;
+            event_t endpoint_events = 0;
+            std::size_t i = 0;
+              {
+                // ----- Enter critical section -------------------------------
+                rtos::interrupts::critical_section ics;
+
+                if (self->pending_device_events_ != 0)
+                  {
+                    device_events = self->pending_device_events_;
+                    self->pending_device_events_ = 0;
+                  }
+                else if (self->pending_endpoints_ != 0)
+                  {
+                    i = static_cast<std::size_t> (__builtin_ctz (
+                        self->pending_endpoints_));
+                    self->pending_endpoints_ &= ~(1UL << i);
+                    endpoint_events = self->pending_endpoint_events_[i];
+                    self->pending_endpoint_events_[i] = 0;
+                  }
+                else
+                  {
+                    break;
+                  }
+                // ----- Exit critical section --------------------------------
+              }
+
+            if (device_events != 0)
+              {
+                device::signal_device_event_t cb_func = self->cb_device_func_;
+                if (cb_func != nullptr)
+                  {
+                    cb_func (self->cb_device_object_, device_events);
+                  }
+              }
+            else
+              {
+                device::signal_endpoint_event_t cb_func =
+                    self->cb_endpoint_func_;
+                if (cb_func != nullptr)
+                  {
+                    endpoint_t ep_addr = static_cast<endpoint_t> ((i / 2)
+                        | (((i & 1) != 0) ? ENDPOINT_DIRECTION_MASK : 0));
+                    cb_func (self->cb_endpoint_object_, ep_addr,
+                             endpoint_events);
+                  }
+              }
+          }
+      }
+
     } /* namespace usb */
   } /* namespace driver */
 } /* namespace os */
@@ -32,6 +32,7 @@
  */
 
 #include <cmsis-plus/driver/usb-host.h>
+#include <cmsis-plus/rtos/os.h>
 #include <cmsis-plus/diag/trace.h>
 #include <cassert>
 
@@ -54,6 +55,13 @@ namespace os
 
         cb_pipe_func_ = nullptr;
         cb_pipe_object_ = nullptr;
+
+        for (std::size_t i = 0; i < host::PIPE_QUEUES; ++i)
+          {
+            queue_pipe_[i] = 0;
+            queue_head_[i] = nullptr;
+            queue_tail_[i] = nullptr;
+          }
       }
 
       Host::~Host () noexcept
@@ -93,6 +101,212 @@ namespace os
 
       // ----------------------------------------------------------------------
 
+      // Must be called in a critical section; return PIPE_QUEUES
+      // if the pipe has no queue.
+      std::size_t
+      Host::find_queue (pipe_t pipe) const noexcept
+      {
+        for (std::size_t i = 0; i < host::PIPE_QUEUES; ++i)
+          {
+            if (queue_pipe_[i] == pipe)
+              {
+                return i;
+              }
+          }
+        return host::PIPE_QUEUES;
+      }
+
+      /**
+       * @details
+       * Append the chain of requests to the pipe queue; if the
+       * queue was empty, start the first transfer. At most
+       * `host::PIPE_QUEUES` pipes can have queued requests at the
+       * same time, otherwise `ERROR_BUSY` is returned.
+       *
+       * When a transfer completes, the next one is started from the
+       * pipe interrupt, before calling the callback of the completed
+       * request, so the pipe is not left idle.
+       *
+       * A STALL or an error completes the request with `ERROR` and
+       * fails the rest of the queue, since the pipe must be
+       * recovered first.
+       *
+       * While requests are queued, the completion events of the pipe
+       * are not forwarded to the pipe callback.
+       *
+       * @note Can be invoked from Interrupt Service Routines.
+       */
+      return_t
+      Host::submit_transfer (pipe_t pipe,
+                             host::transfer_request* request) noexcept
+      {
+        assert (pipe != 0);
+        assert (request != nullptr);
+
+        host::transfer_request* last = request;
+        for (;;)
+          {
+            assert (last->data != nullptr || last->num == 0);
+            last->count = 0;
+            last->status = RETURN_OK;
+            last->event = 0;
+            if (last->next == nullptr)
+              {
+                break;
+              }
+            last = last->next;
+          }
+
+        return_t ret = RETURN_OK;
+          {
+            // ----- Enter critical section -----------------------------------
+            rtos::interrupts::critical_section ics;
+
+            std::size_t i = find_queue (pipe);
+            if (i < host::PIPE_QUEUES)
+              {
+                // Started when the previous ones complete.
+                queue_tail_[i]->next = request;
+                queue_tail_[i] = last;
+              }
+            else
+              {
+                i = find_queue (0);
+                if (i >= host::PIPE_QUEUES)
+                  {
+                    ret = ERROR_BUSY;
+                  }
+                else
+                  {
+                    ret = do_transfer (pipe, request->packet, request->data,
+                                       request->num);
+                    if (ret == RETURN_OK)
+                      {
+                        queue_pipe_[i] = pipe;
+                        queue_head_[i] = request;
+                        queue_tail_[i] = last;
+                      }
+                  }
+              }
+            // ----- Exit critical section ------------------------------------
+          }
+
+        return ret;
+      }
+
+      /**
+       * @details
+       * The callbacks of the aborted requests are called with
+       * `ERROR`; the one in progress also with the partial count.
+       */
+      return_t
+      Host::abort_transfers (pipe_t pipe) noexcept
+      {
+        host::transfer_request* list = nullptr;
+        return_t ret = RETURN_OK;
+          {
+            // ----- Enter critical section -----------------------------------
+            rtos::interrupts::critical_section ics;
+
+            std::size_t i = find_queue (pipe);
+            if (i < host::PIPE_QUEUES)
+              {
+                list = queue_head_[i];
+                queue_pipe_[i] = 0;
+                queue_head_[i] = nullptr;
+                queue_tail_[i] = nullptr;
+
+                ret = do_abort_transfer (pipe);
+                list->count = do_get_transfer_count (pipe);
+              }
+            // ----- Exit critical section ------------------------------------
+          }
+
+        complete_requests (list, ERROR, 0);
+
+        return ret;
+      }
+
+      // Called from the pipe interrupt; return false if there is
+      // no queued request, and the event is for a plain transfer().
+      bool
+      Host::complete_queued_transfer (pipe_t pipe, event_t event) noexcept
+      {
+        host::transfer_request* done;
+        host::transfer_request* failed = nullptr;
+        return_t status = RETURN_OK;
+        return_t ret = RETURN_OK;
+          {
+            // ----- Enter critical section -----------------------------------
+            rtos::interrupts::critical_section ics;
+
+            std::size_t i = find_queue (pipe);
+            if (i >= host::PIPE_QUEUES)
+              {
+                return false;
+              }
+
+            done = queue_head_[i];
+            done->count = do_get_transfer_count (pipe);
+
+            host::transfer_request* next = done->next;
+            done->next = nullptr;
+
+            if ((event & host::Pipe_event::transfer_complete) == 0)
+              {
+                // STALL or error.
+                status = ERROR;
+                failed = next;
+                next = nullptr;
+              }
+            else if (next != nullptr)
+              {
+                // Feed the pipe first.
+                ret = do_transfer (pipe, next->packet, next->data, next->num);
+                if (ret != RETURN_OK)
+                  {
+                    // Cannot continue, fail all remaining requests.
+                    failed = next;
+                    next = nullptr;
+                  }
+              }
+
+            queue_head_[i] = next;
+            if (next == nullptr)
+              {
+                queue_pipe_[i] = 0;
+                queue_tail_[i] = nullptr;
+              }
+            // ----- Exit critical section ------------------------------------
+          }
+
+        complete_requests (done, status, event);
+        complete_requests (failed, (status != RETURN_OK) ? status : ret, 0);
+
+        return true;
+      }
+
+      void
+      Host::complete_requests (host::transfer_request* list, return_t status,
+                               event_t event) noexcept
+      {
+        while (list != nullptr)
+          {
+            // Fetch the link before the owner takes the request back.
+            host::transfer_request* next = list->next;
+            list->next = nullptr;
+            list->status = status;
+            list->event = event;
+            if (list->cb_func != nullptr)
+              {
+                list->cb_func (list->cb_object, list);
+              }
+            list = next;
+          }
+      }
+
+      // ----------------------------------------------------------------------
+
       void
       Host::signal_port_event (port_t port, event_t event) noexcept
       {
@@ -106,7 +320,20 @@ namespace os
       void
       Host::signal_pipe_event (pipe_t pipe, event_t event) noexcept
       {
-        if (cb_pipe_func_ != nullptr)
+        constexpr event_t completion = host::Pipe_event::transfer_complete
+            | host::Pipe_event::handshake_stall
+            | host::Pipe_event::handshake_err | host::Pipe_event::bus_err;
+
+        if ((event & completion) != 0)
+          {
+            if (complete_queued_transfer (pipe, event))
+              {
+                // Consumed by the queue.
+                event &= ~completion;
+              }
+          }
+
+        if (event != 0 && cb_pipe_func_ != nullptr)
           {
             // Forward event to registered callback.
             cb_pipe_func_ (cb_pipe_object_, pipe, event);
@@ -39,7 +39,60 @@
 
 // ----------------------------------------------------------------------------
 
-#if defined(OS_INCLUDE_ATEXIT_STATIC) && !defined(__EXCEPTIONS)
+#if defined(OS_EXCLUDE_ATEXIT_REGISTRATION)
+
+/**
+ * @brief Request execution of functions at program exit.
+ * @param fn Ignored.
+ * @retval 0 Always.
+ *
+ * @details
+ * For applications which never exit, there is no need to keep
+ * a registry of functions to be called at exit, so the
+ * registration is a no-op.
+ *
+ * This also applies to the destructors of static objects, including
+ * the function-local ones, which are registered at first use via
+ * `__cxa_atexit()`; thus the first use on hot paths never
+ * enters a critical section or allocates memory.
+ */
+int
+atexit (exit_func_t fn __attribute__((unused)))
+{
+#if defined(OS_TRACE_LIBC_ATEXIT)
+  trace_printf ("%s(%p) ignored\n", __func__, fn);
+#endif
+
+  return 0;
+}
+
+/**
+ * @brief Empty atexit() registry.
+ * @param type Ignored.
+ * @param fn Ignored.
+ * @param arg Ignored.
+ * @param d Ignored.
+ * @retval 0 Always.
+ */
+int
+__register_exitproc (int type __attribute__((unused)),
+                     exit_func_t fn __attribute__((unused)),
+                     void *arg __attribute__((unused)),
+                     void *d __attribute__((unused)))
+{
+  return 0;
+}
+
+// ----------------------------------------------------------------------------
+
+void
+__call_exitprocs (int code __attribute__((unused)),
+                  void* d __attribute__((unused)))
+{
+  trace_printf("%s() nothing registered\n", __func__);
+}
+
+#elif defined(OS_INCLUDE_ATEXIT_STATIC) && !defined(__EXCEPTIONS)
 
 /**
  * @brief Request execution of functions at program exit.
@@ -66,8 +119,9 @@
  *
  * To minimise RAM consumption and to avoid the use of dynamic
  * memory allocations, the above requirement is not met; instead
- * a static array of pointers is used; each application can customise the
- * size of this array to match its needs.
+ * a static array is used, extended by chunks taken from a
+ * dedicated static pool; each application can customise the
+ * sizes to match its needs.
  */
 int
 atexit (exit_func_t fn)
@@ -87,52 +141,134 @@ atexit (exit_func_t fn)
 #define OS_INTEGER_ATEXIT_ARRAY_SIZE (3)
 #endif
 
-/**
- * @brief Count of functions registered with atexit().
- */
-size_t __atexit_count;
+#if !defined(OS_INTEGER_ATEXIT_CHUNK_SIZE)
+#define OS_INTEGER_ATEXIT_CHUNK_SIZE (8)
+#endif
 
-/**
- * @brief Array of pointers to functions registered by atexit().
- * @details
- * To minimise the RAM consumption, the ANSI requirement to support
- * a minimum of 32 functions and to grow the storage dynamically
- * is not met; instead, this static array is used.
- */
-exit_func_t __atexit_functions[OS_INTEGER_ATEXIT_ARRAY_SIZE];
+#if !defined(OS_INTEGER_ATEXIT_POOL_CHUNKS)
+#define OS_INTEGER_ATEXIT_POOL_CHUNKS (2)
+#endif
+
+namespace
+{
+  typedef void
+  (*exit_arg_func_t) (void*);
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+  /**
+   * @brief Registered exit procedure.
+   */
+  typedef struct exitproc_s
+  {
+    exit_func_t fn;
+    // Only used by __et_cxa entries.
+    void* arg;
+    int type;
+  } exitproc_t;
+
+  /**
+   * @brief Chunk of exit procedures, taken from the pool.
+   */
+  typedef struct exitproc_chunk_s
+  {
+    exitproc_t procs[OS_INTEGER_ATEXIT_CHUNK_SIZE];
+  } exitproc_chunk_t;
+
+#pragma GCC diagnostic pop
+
+  constexpr std::size_t exitprocs_capacity = OS_INTEGER_ATEXIT_ARRAY_SIZE
+      + OS_INTEGER_ATEXIT_POOL_CHUNKS * OS_INTEGER_ATEXIT_CHUNK_SIZE;
+
+  /**
+   * @brief Count of functions registered.
+   */
+  std::size_t exitprocs_count;
+
+  /**
+   * @brief First functions registered.
+   */
+  exitproc_t exitprocs[OS_INTEGER_ATEXIT_ARRAY_SIZE];
+
+  /**
+   * @brief Dedicated pool of chunks, used in order when
+   * the first array is full.
+   */
+#if OS_INTEGER_ATEXIT_POOL_CHUNKS > 0
+  exitproc_chunk_t exitprocs_pool[OS_INTEGER_ATEXIT_POOL_CHUNKS];
+#endif
+
+  /**
+   * @brief Get the storage of the i-th registered function.
+   */
+  inline exitproc_t*
+  __attribute__((always_inline))
+  exitproc (std::size_t i)
+  {
+    if (i < OS_INTEGER_ATEXIT_ARRAY_SIZE)
+      {
+        return &exitprocs[i];
+      }
+#if OS_INTEGER_ATEXIT_POOL_CHUNKS > 0
+    i -= OS_INTEGER_ATEXIT_ARRAY_SIZE;
+    return &exitprocs_pool[i / OS_INTEGER_ATEXIT_CHUNK_SIZE].procs[i
+        % OS_INTEGER_ATEXIT_CHUNK_SIZE];
+#else
+    return nullptr;
+#endif
+  }
+}
 
 /**
  * @brief Simplified version of atexit() registry.
- * @param type Function type; only __et_atexit supported.
+ * @param type Function type; __et_atexit or __et_cxa.
  * @param fn Pointer to function to register.
- * @param arg Function arguments (ignored).
+ * @param arg Function argument, for __et_cxa.
  * @param d Pointer to DSO (ignored).
  * @retval 0 The function was registered.
  * @retval -1 The function was not registered, either the type is
- *  not supported or the static array is full.
+ *  not supported or the static storage is full.
  * @details
- * This registry supports only functions passed by atexit(), the
- * more general cxa or dso handles are currently not supported.
+ * This registry supports functions passed by atexit() and
+ * by `__cxa_atexit()`, used for the destructors of static objects;
+ * dso handles are ignored, since there is a single module.
+ *
+ * The storage is never allocated from the heap, the first
+ * functions are kept in a static array, and the next ones
+ * in chunks of a dedicated static pool.
  */
 int
-__register_exitproc (int type, exit_func_t fn,
-                     void *arg __attribute__((unused)),
+__register_exitproc (int type, exit_func_t fn, void *arg,
                      void *d __attribute__((unused)))
 {
-  assert(type == __et_atexit);
-  assert(__atexit_count < OS_INTEGER_ATEXIT_ARRAY_SIZE);
+  assert((type == __et_atexit) || (type == __et_cxa));
 
 #if defined(NDEBUG)
-  if ((type != __et_atexit) || (__atexit_count >= OS_INTEGER_ATEXIT_ARRAY_SIZE))
+  if ((type != __et_atexit) && (type != __et_cxa))
     {
       return -1;
     }
 #endif
 
-  // Use scheduler lock to synchronise access to the array.
-  os::rtos::scheduler::critical_section scs;
+    {
+      // ----- Enter critical section -----------------------------------------
+      // Use scheduler lock to synchronise access to the storage.
+      os::rtos::scheduler::critical_section scs;
+
+      assert(exitprocs_count < exitprocs_capacity);
+      if (exitprocs_count >= exitprocs_capacity)
+        {
+          return -1;
+        }
+
+      exitproc_t* p = exitproc (exitprocs_count++);
+      p->fn = fn;
+      p->arg = arg;
+      p->type = type;
+      // ----- Exit critical section ------------------------------------------
+    }
 
-  __atexit_functions[__atexit_count++] = fn;
   return 0;
 }
 
@@ -145,13 +281,21 @@ __call_exitprocs (int code __attribute__((unused)),
   trace_printf("%s()\n", __func__);
 
   // Call registered functions in reverse order.
-  for (size_t i = __atexit_count; i > 0;)
+  for (std::size_t i = exitprocs_count; i > 0;)
     {
-      __atexit_functions[--i] ();
+      exitproc_t* p = exitproc (--i);
+      if (p->type == __et_cxa)
+        {
+          reinterpret_cast<exit_arg_func_t> (p->fn) (p->arg);
+        }
+      else
+        {
+          p->fn ();
+        }
     }
 }
 
-#endif /* !defined(__EXCEPTIONS) */
+#endif /* defined(OS_EXCLUDE_ATEXIT_REGISTRATION) */
 
 // ----------------------------------------------------------------------------
 
@@ -40,6 +40,54 @@ using namespace os;
 
 // ----------------------------------------------------------------------------
 
+namespace
+{
+  // With the thread allocation caches, the blocks have a header
+  // and must be allocated and deallocated via the cache functions.
+
+  inline void*
+  allocate_block (size_t bytes)
+  {
+#if defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE)
+    return rtos::memory::allocate_cached (bytes);
+#else
+    return estd::pmr::get_default_resource ()->allocate (bytes);
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE) */
+  }
+
+  inline void*
+  allocate_aligned_block (size_t bytes, size_t alignment)
+  {
+#if defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE)
+    return rtos::memory::allocate_cached (bytes, alignment);
+#else
+    return estd::pmr::get_default_resource ()->allocate (
+        bytes,
+        rtos::memory::max (alignment,
+                           rtos::memory::memory_resource::max_align));
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE) */
+  }
+
+  inline bool
+  is_power_of_two (size_t n)
+  {
+    return n != 0 && (n & (n - 1)) == 0;
+  }
+
+  inline void
+  deallocate_block (void* ptr)
+  {
+#if defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE)
+    rtos::memory::deallocate_cached (ptr);
+#else
+    // Size unknown, pass 0.
+    estd::pmr::get_default_resource ()->deallocate (ptr, 0);
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE) */
+  }
+}
+
+// ----------------------------------------------------------------------------
+
 /**
  * @addtogroup cmsis-plus-rtos-c-memres
  * @{
@@ -98,15 +146,21 @@ malloc (size_t bytes)
 
   void* mem;
     {
+#if !defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE)
       // ----- Begin of critical section --------------------------------------
       rtos::scheduler::critical_section scs;
+#endif /* !defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE) */
 
       errno = 0;
-      mem = estd::pmr::get_default_resource ()->allocate (bytes);
+      mem = allocate_block (bytes);
       if (mem == nullptr)
         {
           errno = ENOMEM;
         }
+#if defined(OS_INCLUDE_RTOS_MEMORY_PROFILER)
+      rtos::memory::profiler::record_allocation (__builtin_return_address (0),
+                                                 mem, bytes);
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_PROFILER) */
 
 #if defined(OS_TRACE_LIBC_MALLOC)
       trace::printf ("::%s(%d)=%p\n", __func__, bytes, mem);
@@ -171,25 +225,39 @@ calloc (size_t nelem, size_t elbytes)
 
   void* mem;
     {
+#if !defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE)
       // ----- Begin of critical section --------------------------------------
       rtos::scheduler::critical_section scs;
+#endif /* !defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE) */
 
-      mem = estd::pmr::get_default_resource ()->allocate (nelem * elbytes);
+#if defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE)
+      mem = allocate_block (nelem * elbytes);
+#else
+      // The resource may know the block is already zero.
+      mem = estd::pmr::get_default_resource ()->allocate_zeroed (
+          nelem * elbytes);
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE) */
 
 #if defined(OS_TRACE_LIBC_MALLOC)
       trace::printf ("::%s(%u,%u)=%p\n", __func__, nelem, elbytes, mem);
 #endif
+#if defined(OS_INCLUDE_RTOS_MEMORY_PROFILER)
+      rtos::memory::profiler::record_allocation (__builtin_return_address (0),
+                                                 mem, nelem * elbytes);
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_PROFILER) */
       // ----- End of critical section ----------------------------------------
     }
 
-  if (mem != nullptr)
+  if (mem == nullptr)
     {
-      memset (mem, 0, nelem * elbytes);
+      errno = ENOMEM;
     }
+#if defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE)
   else
     {
-      errno = ENOMEM;
+      memset (mem, 0, nelem * elbytes);
     }
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE) */
 
   return mem;
 }
@@ -248,6 +316,10 @@ calloc (size_t nelem, size_t elbytes)
  * returns a null pointer and `errno` has been set to `ENOMEM`,
  * the memory referenced by _ptr_ shall not be changed.
  *
+ * In µOS++ the block is passed to `memory_resource::reallocate()`,
+ * so the memory managers that support it, like `first_fit_top`,
+ * can resize it in place, without copying.
+ *
  * @note In µOS++ this function uses a scheduler critical section
  * and is thread safe.
  *
@@ -265,13 +337,19 @@ realloc (void* ptr, size_t bytes)
   void* mem;
 
     {
+#if !defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE)
       // ----- Begin of critical section --------------------------------------
       rtos::scheduler::critical_section scs;
+#endif /* !defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE) */
 
       errno = 0;
       if (ptr == nullptr)
         {
-          mem = estd::pmr::get_default_resource ()->allocate (bytes);
+          mem = allocate_block (bytes);
+#if defined(OS_INCLUDE_RTOS_MEMORY_PROFILER)
+          rtos::memory::profiler::record_allocation (
+              __builtin_return_address (0), mem, bytes);
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_PROFILER) */
 #if defined(OS_TRACE_LIBC_MALLOC)
           trace::printf ("::%s(%p,%u)=%p\n", __func__, ptr, bytes, mem);
 #endif
@@ -282,32 +360,40 @@ realloc (void* ptr, size_t bytes)
           return mem;
         }
 
+#if defined(OS_INCLUDE_RTOS_MEMORY_PROFILER)
+      rtos::memory::profiler::record_deallocation (ptr);
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_PROFILER) */
+
       if (bytes == 0)
         {
-          estd::pmr::get_default_resource ()->deallocate (ptr, 0);
+          deallocate_block (ptr);
 #if defined(OS_TRACE_LIBC_MALLOC)
           trace::printf ("::%s(%p,%u)=0\n", __func__, ptr, bytes);
 #endif
           return nullptr;
         }
 
-#if 0
-      /* TODO: There is chance to shrink the chunk if newly requested
-       * size is much small */
-      if (nano_malloc_usable_size (RCALL ptr) >= bytes)
-      return ptr;
-#endif
-
-      mem = estd::pmr::get_default_resource ()->allocate (bytes);
+#if defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE)
+      mem = allocate_block (bytes);
       if (mem != nullptr)
         {
           memcpy (mem, ptr, bytes);
-          estd::pmr::get_default_resource ()->deallocate (ptr, 0);
+          deallocate_block (ptr);
         }
-      else
+#else
+      // Size unknown, pass 0; the resource may resize the block in place.
+      mem = estd::pmr::get_default_resource ()->reallocate (ptr, 0, bytes);
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE) */
+      if (mem == nullptr)
         {
           errno = ENOMEM;
         }
+#if defined(OS_INCLUDE_RTOS_MEMORY_PROFILER)
+      // On failure the old block is still allocated, but no longer
+      // tracked; this only affects the lifetime statistics.
+      rtos::memory::profiler::record_allocation (__builtin_return_address (0),
+                                                 mem, bytes);
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_PROFILER) */
 
 #if defined(OS_TRACE_LIBC_MALLOC)
       trace::printf ("::%s(%p,%u)=%p", __func__, ptr, bytes, mem);
@@ -358,18 +444,159 @@ free (void* ptr)
       return;
     }
 
+#if !defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE)
   // ----- Begin of critical section ------------------------------------------
   rtos::scheduler::critical_section scs;
+#endif /* !defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE) */
 
 #if defined(OS_TRACE_LIBC_MALLOC)
   trace::printf ("::%s(%p)\n", __func__, ptr);
 #endif
 
-  // Size unknown, pass 0.
-  estd::pmr::get_default_resource ()->deallocate (ptr, 0);
+#if defined(OS_INCLUDE_RTOS_MEMORY_PROFILER)
+  rtos::memory::profiler::record_deallocation (ptr);
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_PROFILER) */
+
+  deallocate_block (ptr);
   // ----- End of critical section --------------------------------------------
 }
 
+/**
+ * @brief Allocate an aligned memory block (non-initialised).
+ * @headerfile stdlib.h <stdlib.h>
+ * @param alignment Alignment constraint (power of 2).
+ * @param bytes Number of bytes to allocate.
+ * @return A pointer to the allocated memory or null and
+ *  `EINVAL` or `ENOMEM`.
+ *
+ * @details
+ * The `aligned_alloc()` function shall allocate unused space for
+ * an object whose alignment is specified by _alignment_, whose
+ * size is specified by _bytes_, and whose value is indeterminate.
+ *
+ * In µOS++ the alignment is passed to the memory resource, which
+ * can place the block at its exact alignment, for example to
+ * keep DMA buffers on separate cache lines, instead of padding
+ * a larger block.
+ *
+ * The block can be passed to `free()` and `realloc()`; `realloc()`
+ * does not preserve the alignment.
+ *
+ * @note In µOS++ this function uses a scheduler critical section
+ * and is thread safe.
+ *
+ * @par Standard compatibility
+ *  Inspired by `aligned_alloc()` (ISO/IEC 9899:2011).
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+void*
+aligned_alloc (size_t alignment, size_t bytes)
+{
+  assert(!rtos::interrupts::in_handler_mode ());
+
+  errno = 0;
+  if (!is_power_of_two (alignment))
+    {
+      errno = EINVAL;
+      return nullptr;
+    }
+
+  void* mem;
+    {
+#if !defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE)
+      // ----- Begin of critical section --------------------------------------
+      rtos::scheduler::critical_section scs;
+#endif /* !defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE) */
+
+      mem = allocate_aligned_block (bytes, alignment);
+#if defined(OS_INCLUDE_RTOS_MEMORY_PROFILER)
+      rtos::memory::profiler::record_allocation (__builtin_return_address (0),
+                                                 mem, bytes);
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_PROFILER) */
+
+#if defined(OS_TRACE_LIBC_MALLOC)
+      trace::printf ("::%s(%u,%u)=%p\n", __func__, alignment, bytes, mem);
+#endif
+      // ----- End of critical section ----------------------------------------
+    }
+
+  if (mem == nullptr)
+    {
+      errno = ENOMEM;
+    }
+
+  return mem;
+}
+
+/**
+ * @brief Allocate an aligned memory block (non-initialised).
+ * @headerfile stdlib.h <stdlib.h>
+ * @param [out] memptr Pointer to the location where to store
+ *  the address of the block.
+ * @param alignment Alignment constraint (power of 2, multiple
+ *  of `sizeof(void*)`).
+ * @param bytes Number of bytes to allocate.
+ * @retval 0 The block was allocated.
+ * @retval EINVAL The alignment is not valid.
+ * @retval ENOMEM There is not enough memory.
+ *
+ * @details
+ * The `posix_memalign()` function shall allocate _bytes_ bytes
+ * aligned on a boundary specified by _alignment_, and shall
+ * return a pointer to the allocated memory in _memptr_.
+ *
+ * Upon successful completion, `posix_memalign()` shall return zero;
+ * otherwise, an error number shall be returned to indicate the
+ * error and the contents of _memptr_ shall either be left unmodified
+ * or be set to a null pointer.
+ *
+ * @note In µOS++ this function uses a scheduler critical section
+ * and is thread safe.
+ *
+ * @par POSIX compatibility
+ *  Inspired by [`posix_memalign()`](http://pubs.opengroup.org/onlinepubs/9699919799/functions/posix_memalign.html)
+ *  ([IEEE Std 1003.1, 2013 Edition](http://pubs.opengroup.org/onlinepubs/9699919799/nframe.html)).
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+int
+posix_memalign (void** memptr, size_t alignment, size_t bytes)
+{
+  assert(memptr != nullptr);
+
+  if (!is_power_of_two (alignment) || (alignment % sizeof(void*)) != 0)
+    {
+      return EINVAL;
+    }
+
+  void* mem = aligned_alloc (alignment, bytes);
+  if (mem == nullptr)
+    {
+      return ENOMEM;
+    }
+
+  *memptr = mem;
+  return 0;
+}
+
+/**
+ * @brief Allocate an aligned memory block (non-initialised).
+ * @headerfile malloc.h <malloc.h>
+ * @param alignment Alignment constraint (power of 2).
+ * @param bytes Number of bytes to allocate.
+ * @return A pointer to the allocated memory or null and
+ *  `EINVAL` or `ENOMEM`.
+ *
+ * @details
+ * Obsolete, the same as `aligned_alloc()`.
+ */
+void*
+memalign (size_t alignment, size_t bytes)
+{
+  return aligned_alloc (alignment, bytes);
+}
+
 /**
  * @}
  */
@@ -410,6 +637,13 @@ _realloc_r (struct _reent* impure __attribute__((unused)), void* ptr,
   return realloc (ptr, size);
 }
 
+void*
+_memalign_r (struct _reent* impure __attribute__((unused)), size_t align,
+             size_t s)
+{
+  return memalign (align, s);
+}
+
 /**
  * @endcond
  */
@@ -453,13 +687,6 @@ _mallopt_r (struct _reent* impure __attribute__((unused)),
   abort ();
 }
 
-void*
-_memalign_r (struct _reent* impure __attribute__((unused)),
-             size_t align __attribute__((unused)),
-             size_t s __attribute__((unused)))
-{
-  abort ();
-}
 
 void*
 _pvalloc_r (struct _reent* impure __attribute__((unused)),
@@ -0,0 +1,331 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#if defined(__ARM_EABI__)
+
+// ----------------------------------------------------------------------------
+
+#include <cmsis-plus/os-app-config.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__ARM_FEATURE_MVE) && (__ARM_FEATURE_MVE & 1)
+#include <arm_mve.h>
+#endif
+
+// ----------------------------------------------------------------------------
+
+// The functions are always available with the os_libc_ prefix,
+// to be compared with the toolchain ones; with
+// OS_INCLUDE_LIBC_OPTIMISED_MEMORY_FUNCTIONS they also replace
+// memcpy(), memmove() and memset().
+// <string.h> is not included, to define the aliases without
+// the library declarations attributes.
+
+void*
+os_libc_memcpy (void* dst, const void* src, size_t n);
+
+void*
+os_libc_memmove (void* dst, const void* src, size_t n);
+
+void*
+os_libc_memset (void* dst, int c, size_t n);
+
+// Without it, GCC recognises the byte loops and replaces them
+// with calls to memcpy()/memset(), which are these very functions.
+#define OS_LIBC_NO_BUILTIN \
+  __attribute__((optimize("no-tree-loop-distribute-patterns")))
+
+// ----------------------------------------------------------------------------
+
+#if defined(__ARM_FEATURE_MVE) && (__ARM_FEATURE_MVE & 1)
+
+// Cortex-M55/M85: Helium vector loops, 16 bytes per iteration;
+// the tail is predicated, so there is no scalar loop.
+
+void*
+OS_LIBC_NO_BUILTIN
+os_libc_memcpy (void* dst, const void* src, size_t n)
+{
+  uint8_t* d = (uint8_t*) dst;
+  const uint8_t* s = (const uint8_t*) src;
+
+  while (n > 0)
+    {
+      mve_pred16_t p = vctp8q ((uint32_t) n);
+      vstrbq_p_u8 (d, vldrbq_z_u8 (s, p), p);
+      d += 16;
+      s += 16;
+      n = (n > 16) ? n - 16 : 0;
+    }
+
+  return dst;
+}
+
+void*
+OS_LIBC_NO_BUILTIN
+os_libc_memmove (void* dst, const void* src, size_t n)
+{
+  if ((uintptr_t) dst - (uintptr_t) src >= n)
+    {
+      // No overlap, or the destination is below the source.
+      return os_libc_memcpy (dst, src, n);
+    }
+
+  uint8_t* d = (uint8_t*) dst;
+  const uint8_t* s = (const uint8_t*) src;
+
+  // Backwards, each vector is loaded before it is stored, and
+  // the overwritten source bytes were already copied.
+  while (n > 0)
+    {
+      size_t k = (n > 16) ? 16 : n;
+      n -= k;
+      mve_pred16_t p = vctp8q ((uint32_t) k);
+      vstrbq_p_u8 (d + n, vldrbq_z_u8 (s + n, p), p);
+    }
+
+  return dst;
+}
+
+void*
+OS_LIBC_NO_BUILTIN
+os_libc_memset (void* dst, int c, size_t n)
+{
+  uint8_t* d = (uint8_t*) dst;
+  uint8x16_t v = vdupq_n_u8 ((uint8_t) c);
+
+  while (n > 0)
+    {
+      mve_pred16_t p = vctp8q ((uint32_t) n);
+      vstrbq_p_u8 (d, v, p);
+      d += 16;
+      n = (n > 16) ? n - 16 : 0;
+    }
+
+  return dst;
+}
+
+#else
+
+// Cortex-M3/M4/M7: word and LDRD/STRD bursts of 32 bytes, after
+// aligning the destination. LDRD/STRD require only word alignment.
+// When the source has a different alignment, the cores with
+// unaligned access use LDR from the odd addresses; the others
+// copy bytes.
+
+typedef uint64_t __attribute__((aligned(4), may_alias)) os_libc_dword_t;
+typedef uint32_t __attribute__((may_alias)) os_libc_word_t;
+typedef struct
+{
+  uint32_t w;
+} __attribute__((packed, may_alias)) os_libc_unaligned_word_t;
+
+void*
+OS_LIBC_NO_BUILTIN
+os_libc_memcpy (void* dst, const void* src, size_t n)
+{
+  uint8_t* d = (uint8_t*) dst;
+  const uint8_t* s = (const uint8_t*) src;
+
+  if (n >= 16)
+    {
+      while (((uintptr_t) d & 3) != 0)
+        {
+          *d++ = *s++;
+          --n;
+        }
+
+      if (((uintptr_t) s & 3) == 0)
+        {
+          while (n >= 32)
+            {
+              os_libc_dword_t a = ((const os_libc_dword_t*) s)[0];
+              os_libc_dword_t b = ((const os_libc_dword_t*) s)[1];
+              os_libc_dword_t e = ((const os_libc_dword_t*) s)[2];
+              os_libc_dword_t f = ((const os_libc_dword_t*) s)[3];
+              ((os_libc_dword_t*) d)[0] = a;
+              ((os_libc_dword_t*) d)[1] = b;
+              ((os_libc_dword_t*) d)[2] = e;
+              ((os_libc_dword_t*) d)[3] = f;
+              d += 32;
+              s += 32;
+              n -= 32;
+            }
+          while (n >= 4)
+            {
+              *(os_libc_word_t*) d = *(const os_libc_word_t*) s;
+              d += 4;
+              s += 4;
+              n -= 4;
+            }
+        }
+#if defined(__ARM_FEATURE_UNALIGNED)
+      else
+        {
+          while (n >= 16)
+            {
+              uint32_t a = ((const os_libc_unaligned_word_t*) s)[0].w;
+              uint32_t b = ((const os_libc_unaligned_word_t*) s)[1].w;
+              uint32_t e = ((const os_libc_unaligned_word_t*) s)[2].w;
+              uint32_t f = ((const os_libc_unaligned_word_t*) s)[3].w;
+              ((os_libc_word_t*) d)[0] = a;
+              ((os_libc_word_t*) d)[1] = b;
+              ((os_libc_word_t*) d)[2] = e;
+              ((os_libc_word_t*) d)[3] = f;
+              d += 16;
+              s += 16;
+              n -= 16;
+            }
+          while (n >= 4)
+            {
+              *(os_libc_word_t*) d = ((const os_libc_unaligned_word_t*) s)->w;
+              d += 4;
+              s += 4;
+              n -= 4;
+            }
+        }
+#endif /* defined(__ARM_FEATURE_UNALIGNED) */
+    }
+
+  while (n > 0)
+    {
+      *d++ = *s++;
+      --n;
+    }
+
+  return dst;
+}
+
+void*
+OS_LIBC_NO_BUILTIN
+os_libc_memmove (void* dst, const void* src, size_t n)
+{
+  if ((uintptr_t) dst - (uintptr_t) src >= n)
+    {
+      // No overlap, or the destination is below the source;
+      // the forward copy reads each burst before writing it.
+      return os_libc_memcpy (dst, src, n);
+    }
+
+  // Backwards, from the end of the buffers.
+  uint8_t* d = (uint8_t*) dst + n;
+  const uint8_t* s = (const uint8_t*) src + n;
+
+  if (n >= 8 && (((uintptr_t) d ^ (uintptr_t) s) & 3) == 0)
+    {
+      while (((uintptr_t) d & 3) != 0)
+        {
+          *--d = *--s;
+          --n;
+        }
+      while (n >= 4)
+        {
+          d -= 4;
+          s -= 4;
+          *(os_libc_word_t*) d = *(const os_libc_word_t*) s;
+          n -= 4;
+        }
+    }
+
+  while (n > 0)
+    {
+      *--d = *--s;
+      --n;
+    }
+
+  return dst;
+}
+
+void*
+OS_LIBC_NO_BUILTIN
+os_libc_memset (void* dst, int c, size_t n)
+{
+  uint8_t* d = (uint8_t*) dst;
+
+  if (n >= 16)
+    {
+      while (((uintptr_t) d & 3) != 0)
+        {
+          *d++ = (uint8_t) c;
+          --n;
+        }
+
+      uint32_t w = (uint8_t) c * 0x01010101u;
+      os_libc_dword_t dw = ((uint64_t) w << 32) | w;
+      while (n >= 32)
+        {
+          ((os_libc_dword_t*) d)[0] = dw;
+          ((os_libc_dword_t*) d)[1] = dw;
+          ((os_libc_dword_t*) d)[2] = dw;
+          ((os_libc_dword_t*) d)[3] = dw;
+          d += 32;
+          n -= 32;
+        }
+      while (n >= 4)
+        {
+          *(os_libc_word_t*) d = w;
+          d += 4;
+          n -= 4;
+        }
+    }
+
+  while (n > 0)
+    {
+      *d++ = (uint8_t) c;
+      --n;
+    }
+
+  return dst;
+}
+
+#endif /* defined(__ARM_FEATURE_MVE) && (__ARM_FEATURE_MVE & 1) */
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_INCLUDE_LIBC_OPTIMISED_MEMORY_FUNCTIONS)
+
+// They take precedence over the library archive members.
+
+void*
+memcpy (void* dst, const void* src, size_t n)
+__attribute__((alias ("os_libc_memcpy")));
+
+void*
+memmove (void* dst, const void* src, size_t n)
+__attribute__((alias ("os_libc_memmove")));
+
+void*
+memset (void* dst, int c, size_t n)
+__attribute__((alias ("os_libc_memset")));
+
+#endif /* defined(OS_INCLUDE_LIBC_OPTIMISED_MEMORY_FUNCTIONS) */
+
+// ----------------------------------------------------------------------------
+
+#endif /* defined(__ARM_EABI__) */
@@ -28,6 +28,8 @@
 #include <cmsis-plus/rtos/os.h>
 #include <cmsis-plus/estd/chrono>
 
+#include <limits>
+
 // ----------------------------------------------------------------------------
 
 namespace os
@@ -46,6 +48,76 @@ namespace os
       // Must be set during startup by reading the RTC.
       // uint64_t startup_absolute_seconds;
 
+      namespace
+      {
+        // The conversions between the hrclock cycles and the
+        // nanoseconds use 32.32 fixed point multipliers, computed
+        // when the input frequency changes. The nanoseconds counted
+        // up to the last change are kept in the base, so the clock
+        // remains monotonic.
+        uint64_t hr_nanos_per_cycle_;
+        uint64_t hr_cycles_per_nano_;
+        rtos::clock::timestamp_t hr_base_cycles_;
+        uint64_t hr_base_nanos_;
+        rtos::clock::timestamp_t hr_last_cycles_;
+        uint32_t hr_frequency_hz_;
+
+        // (a * b) >> 32, with 32-bit multiplications only.
+        inline uint64_t
+        __attribute__((always_inline))
+        mul_shift_32 (uint64_t a, uint64_t b)
+        {
+          uint64_t al = a & 0xFFFFFFFFu;
+          uint64_t ah = a >> 32;
+          uint64_t bl = b & 0xFFFFFFFFu;
+          uint64_t bh = b >> 32;
+
+          return ((ah * bh) << 32) + ah * bl + al * bh + ((al * bl) >> 32);
+        }
+
+        // Must be called from a critical section.
+        void
+        update_hr_frequency (void)
+        {
+          uint32_t hz = rtos::hrclock.input_clock_frequency_hz ();
+          if (hz == hr_frequency_hz_)
+            {
+              return;
+            }
+
+          if (hr_frequency_hz_ != 0)
+            {
+              // Continue from the last value, at the new rate.
+              hr_base_nanos_ += mul_shift_32 (hr_last_cycles_ - hr_base_cycles_,
+                                              hr_nanos_per_cycle_);
+              hr_base_cycles_ = hr_last_cycles_;
+            }
+
+          // Rounded up, so a cycle is not converted to less than
+          // its duration.
+          hr_nanos_per_cycle_ = ((1000000000ull << 32) + hz - 1) / hz;
+          hr_cycles_per_nano_ = (static_cast<uint64_t> (hz) << 32)
+              / 1000000000ull;
+          hr_frequency_hz_ = hz;
+        }
+
+        uint64_t
+        hr_nanos (void)
+        {
+          // ----- Enter critical section -------------------------------------
+          rtos::interrupts::critical_section ics;
+
+          update_hr_frequency ();
+
+          rtos::clock::timestamp_t cycles = rtos::hrclock.now ();
+          hr_last_cycles_ = cycles;
+
+          return hr_base_nanos_
+              + mul_shift_32 (cycles - hr_base_cycles_, hr_nanos_per_cycle_);
+          // ----- Exit critical section --------------------------------------
+        }
+      }
+
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Waggregate-return"
 
@@ -106,24 +178,43 @@ namespace os
       high_resolution_clock::time_point
       high_resolution_clock::now () noexcept
       {
-        auto cycles = rtos::hrclock.now ();
-
-        // The duration is the number of sum of SysTick ticks plus the current
-        // count of CPU cycles (computed from the SysTick counter).
-        // Notice: a more exact solution would be to compute
-        // ticks * divisor + cycles, but this severely reduces the
-        // range of ticks.
+        // The cycles are converted with a multiplication, without
+        // divisions and without the overflow of `cycles * 1000000000`.
         return time_point
           { duration
             { duration
-              { cycles * 1000000000ULL
-                  / rtos::hrclock.input_clock_frequency_hz () }
+              { static_cast<rep> (hr_nanos ()) }
                 + realtime_clock::startup_time_point.time_since_epoch () } //
           };
       }
 
 #pragma GCC diagnostic pop
 
+      void
+      high_resolution_clock::sleep_for (sleep_rep nanos)
+      {
+        uint64_t cycles;
+          {
+            // ----- Enter critical section -----------------------------------
+            rtos::interrupts::critical_section ics;
+
+            update_hr_frequency ();
+            // Round up, never sleep shorter.
+            cycles = mul_shift_32 (nanos, hr_cycles_per_nano_) + 1;
+            // ----- Exit critical section ------------------------------------
+          }
+
+        constexpr uint64_t max_cycles =
+            std::numeric_limits<rtos::clock::duration_t>::max ();
+        while (cycles > max_cycles)
+          {
+            rtos::hrclock.sleep_for (
+                static_cast<rtos::clock::duration_t> (max_cycles));
+            cycles -= max_cycles;
+          }
+        rtos::hrclock.sleep_for (static_cast<rtos::clock::duration_t> (cycles));
+      }
+
     // ------------------------------------------------------------------------
 
     } /* namespace chrono */
@@ -0,0 +1,206 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <cmsis-plus/estd/future>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace estd
+  {
+    // ========================================================================
+
+    /**
+     * @details
+     * The future errors are reported as system errors, with
+     * the closest POSIX error number.
+     */
+    void
+    __throw_future_error (future_errc ec)
+    {
+      switch (ec)
+        {
+        case future_errc::broken_promise:
+          __throw_system_error (EPIPE, "broken promise");
+          break;
+
+        case future_errc::future_already_retrieved:
+          __throw_system_error (EALREADY, "future already retrieved");
+          break;
+
+        case future_errc::promise_already_satisfied:
+          __throw_system_error (EBUSY, "promise already satisfied");
+          break;
+
+        case future_errc::no_state:
+        default:
+          __throw_system_error (EINVAL, "no associated state");
+          break;
+        }
+    }
+
+    // ========================================================================
+
+    future_state_base::future_state_base (pmr::memory_resource* mr,
+                                          std::size_t bytes,
+                                          std::size_t align) noexcept :
+        event_
+          { "future", 0 }, //
+        mr_ (mr), //
+        bytes_ (bytes), //
+        align_ (align)
+    {
+      ;
+    }
+
+    future_state_base::~future_state_base ()
+    {
+      ;
+    }
+
+    void
+    future_state_base::attach (void) noexcept
+    {
+      __atomic_add_fetch (&refs_, 1, __ATOMIC_RELAXED);
+    }
+
+    /**
+     * @details
+     * When the last reference goes away, a state allocated from
+     * a memory resource is destroyed and returned to it; an
+     * embedded state is left to its promise.
+     */
+    void
+    future_state_base::release (void) noexcept
+    {
+      if (__atomic_sub_fetch (&refs_, 1, __ATOMIC_ACQ_REL) != 0)
+        {
+          return;
+        }
+
+      pmr::memory_resource* mr = mr_;
+      if (mr != nullptr)
+        {
+          std::size_t bytes = bytes_;
+          std::size_t align = align_;
+
+          this->~future_state_base ();
+          mr->deallocate (this, bytes, align);
+        }
+    }
+
+    void
+    future_state_base::retrieve (void)
+    {
+      if (__atomic_exchange_n (&retrieved_, true, __ATOMIC_ACQ_REL))
+        {
+          __throw_future_error (future_errc::future_already_retrieved);
+        }
+      attach ();
+    }
+
+    void
+    future_state_base::satisfy (void)
+    {
+      if (__atomic_exchange_n (&satisfied_, true, __ATOMIC_ACQ_REL))
+        {
+          __throw_future_error (future_errc::promise_already_satisfied);
+        }
+    }
+
+    /**
+     * @details
+     * The flag is published before the event is posted, so a
+     * waiter that finds it set does not need to block.
+     */
+    void
+    future_state_base::make_ready (void) noexcept
+    {
+      __atomic_store_n (&ready_, true, __ATOMIC_RELEASE);
+      event_.post ();
+    }
+
+    void
+    future_state_base::abandon (void) noexcept
+    {
+      if (!__atomic_exchange_n (&satisfied_, true, __ATOMIC_ACQ_REL))
+        {
+          broken_ = true;
+          make_ready ();
+        }
+    }
+
+    void
+    future_state_base::wait (void)
+    {
+      while (!ready ())
+        {
+          event_.wait ();
+        }
+    }
+
+    future_status
+    future_state_base::timed_wait (rtos::clock::duration_t ticks)
+    {
+      if (ready ())
+        {
+          return future_status::ready;
+        }
+
+      rtos::result_t res;
+      res = event_.timed_wait (ticks);
+      if (ready ())
+        {
+          return future_status::ready;
+        }
+      else if (res == ETIMEDOUT || res == EINTR
+          || res == rtos::result::ok)
+        {
+          return future_status::timeout;
+        }
+
+      os::estd::__throw_system_error (static_cast<int> (res),
+                                      "future wait failed");
+    }
+
+    void
+    future_state_base::check (void) const
+    {
+      if (broken_)
+        {
+          __throw_future_error (future_errc::broken_promise);
+        }
+    }
+
+  // --------------------------------------------------------------------------
+
+  } /* namespace estd */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
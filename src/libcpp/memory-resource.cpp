@@ -74,6 +74,572 @@ namespace os
         return old;
       }
 
+      // ======================================================================
+
+      /**
+       * @details
+       * The default upstream is the application default memory resource.
+       */
+      unsynchronized_pool_resource::unsynchronized_pool_resource (
+          const pool_options& opts, memory_resource* upstream)
+      {
+        trace::printf ("%s(%u,%u,%p) @%p\n", __func__,
+                       opts.max_blocks_per_chunk,
+                       opts.largest_required_pool_block, upstream, this);
+
+        internal_construct_ (opts, upstream);
+      }
+
+      unsynchronized_pool_resource::unsynchronized_pool_resource () :
+          unsynchronized_pool_resource
+            { pool_options
+              { }, get_default_resource () }
+      {
+        ;
+      }
+
+      unsynchronized_pool_resource::unsynchronized_pool_resource (
+          memory_resource* upstream) :
+          unsynchronized_pool_resource
+            { pool_options
+              { }, upstream }
+      {
+        ;
+      }
+
+      unsynchronized_pool_resource::unsynchronized_pool_resource (
+          const pool_options& opts) :
+          unsynchronized_pool_resource
+            { opts, get_default_resource () }
+      {
+        ;
+      }
+
+      /**
+       * @details
+       * All memory is returned to upstream.
+       */
+      unsynchronized_pool_resource::~unsynchronized_pool_resource ()
+      {
+        trace::printf ("%s() @%p\n", __func__, this);
+
+        release ();
+      }
+
+      /**
+       * @details
+       * Zero options are replaced by the defaults; the largest
+       * pool block is rounded up to a power of two and limited
+       * to the largest bin.
+       */
+      void
+      unsynchronized_pool_resource::internal_construct_ (
+          const pool_options& opts, memory_resource* upstream)
+      {
+        assert(upstream != nullptr);
+        upstream_ = upstream;
+
+        max_blocks_per_chunk_ =
+            (opts.max_blocks_per_chunk != 0) ?
+                opts.max_blocks_per_chunk : default_max_blocks_per_chunk;
+
+        std::size_t largest =
+            (opts.largest_required_pool_block != 0) ?
+                opts.largest_required_pool_block :
+                default_largest_required_pool_block;
+
+        bins_count_ = rtos::memory::min (internal_index_ (largest, 1) + 1,
+                                         max_bins);
+
+        for (std::size_t i = 0; i < max_bins; ++i)
+          {
+            bins_[i].chunks = nullptr;
+            bins_[i].next_blocks = rtos::memory::min (initial_blocks_per_chunk,
+                                                      max_blocks_per_chunk_);
+          }
+      }
+
+      pool_options
+      unsynchronized_pool_resource::options (void) const noexcept
+      {
+        pool_options opts;
+        opts.max_blocks_per_chunk = max_blocks_per_chunk_;
+        opts.largest_required_pool_block = min_block_bytes
+            << (bins_count_ - 1);
+
+        return opts;
+      }
+
+      /**
+       * @details
+       * Bin `i` has blocks of `min_block_bytes << i` bytes; blocks
+       * are aligned to their size, up to `max_align`.
+       */
+      std::size_t
+      unsynchronized_pool_resource::internal_index_ (
+          std::size_t bytes, std::size_t alignment) noexcept
+      {
+        std::size_t size = rtos::memory::max (bytes, alignment);
+
+        std::size_t index = 0;
+        for (std::size_t b = min_block_bytes; b < size && index < max_bins;
+            b <<= 1)
+          {
+            ++index;
+          }
+        return index;
+      }
+
+      /**
+       * @details
+       * Each new chunk of a bin has twice as many blocks as the
+       * previous one, up to `max_blocks_per_chunk`, so the number of
+       * chunks to search grows logarithmically.
+       */
+      unsynchronized_pool_resource::chunk_t*
+      unsynchronized_pool_resource::internal_grow_ (std::size_t index)
+      {
+        bin_t& bin = bins_[index];
+        std::size_t block_bytes = min_block_bytes << index;
+        std::size_t blocks = bin.next_blocks;
+        std::size_t bytes = blocks * block_bytes;
+
+        void* mem = upstream_->allocate (chunk_offset + bytes, max_align);
+        if (mem == nullptr)
+          {
+            return nullptr;
+          }
+
+        chunk_t* chunk = new (mem) chunk_t
+          { blocks, block_bytes, static_cast<char*> (mem) + chunk_offset, bytes };
+
+        chunk->next = bin.chunks;
+        bin.chunks = chunk;
+
+        total_bytes_ += bytes;
+        free_bytes_ += bytes;
+        free_chunks_ += blocks;
+
+        bin.next_blocks = rtos::memory::min (blocks * 2, max_blocks_per_chunk_);
+
+        return chunk;
+      }
+
+      /**
+       * @details
+       * The header is placed just below the block, with padding in
+       * front to keep the block aligned.
+       */
+      void*
+      unsynchronized_pool_resource::internal_allocate_large_ (
+          std::size_t bytes, std::size_t alignment)
+      {
+        std::size_t align = rtos::memory::max (alignment, max_align);
+        std::size_t offset = rtos::memory::align_size (sizeof(large_t), align);
+        if (offset + bytes < bytes)
+          {
+            // Overflow.
+            return nullptr;
+          }
+
+        void* mem = upstream_->allocate (offset + bytes, align);
+        if (mem == nullptr)
+          {
+            return nullptr;
+          }
+
+        char* block = static_cast<char*> (mem) + offset;
+        large_t* large = reinterpret_cast<large_t*> (block - sizeof(large_t));
+
+        large->bytes = bytes;
+        large->alignment = align;
+        large->prev = nullptr;
+        large->next = large_;
+        if (large_ != nullptr)
+          {
+            large_->prev = large;
+          }
+        large_ = large;
+
+        // The block is both added and allocated.
+        total_bytes_ += bytes;
+        free_bytes_ += bytes;
+        ++free_chunks_;
+        internal_increase_allocated_statistics (bytes);
+
+        return block;
+      }
+
+      unsynchronized_pool_resource::chunk_t*
+      unsynchronized_pool_resource::internal_find_ (std::size_t index,
+                                                    void* addr) const noexcept
+      {
+        for (chunk_t* chunk = bins_[index].chunks; chunk != nullptr;
+            chunk = chunk->next)
+          {
+            char* first = reinterpret_cast<char*> (chunk) + chunk_offset;
+            if (addr >= first && addr < first + chunk->pool.total_bytes ())
+              {
+                return chunk;
+              }
+          }
+        return nullptr;
+      }
+
+      /**
+       * @details
+       * The block is taken from the first chunk of its bin with free
+       * blocks, which is moved at the beginning of the list, to be
+       * found first next time; if all chunks are full, a new one is
+       * requested from upstream.
+       *
+       * @par Exceptions
+       *   Throws nothing by itself, but the upstream resource or
+       *   the out of memory handler may throw `bad_alloc()`.
+       */
+      void*
+      unsynchronized_pool_resource::do_allocate (std::size_t bytes,
+                                                 std::size_t alignment)
+      {
+        std::size_t index = internal_index_ (bytes, alignment);
+
+        while (true)
+          {
+            void* p = nullptr;
+            if (alignment > max_align || index >= bins_count_)
+              {
+                p = internal_allocate_large_ (bytes, alignment);
+              }
+            else
+              {
+                bin_t& bin = bins_[index];
+
+                chunk_t* prev = nullptr;
+                chunk_t* chunk = bin.chunks;
+                while (chunk != nullptr && chunk->pool.free_chunks () == 0)
+                  {
+                    prev = chunk;
+                    chunk = chunk->next;
+                  }
+
+                if (chunk == nullptr)
+                  {
+                    chunk = internal_grow_ (index);
+                  }
+                else if (prev != nullptr)
+                  {
+                    // Move it to the beginning of the list.
+                    prev->next = chunk->next;
+                    chunk->next = bin.chunks;
+                    bin.chunks = chunk;
+                  }
+
+                if (chunk != nullptr)
+                  {
+                    std::size_t block_bytes = min_block_bytes << index;
+                    p = chunk->pool.allocate (block_bytes, alignment);
+                    internal_increase_allocated_statistics (block_bytes);
+                  }
+              }
+
+            if (p != nullptr)
+              {
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+                trace::printf ("%s(%u,%u)=%p @%p\n", __func__, bytes,
+                               alignment, p, this);
+#endif
+                return p;
+              }
+
+#if defined(OS_INCLUDE_RTOS_MEMORY_RECLAIM)
+            if (reclaim (bytes) != 0)
+              {
+                // Some cache released memory, try again to allocate.
+                continue;
+              }
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_RECLAIM) */
+
+            if (out_of_memory_handler_ == nullptr)
+              {
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+                trace::printf ("%s(%u,%u)=0 @%p\n", __func__, bytes, alignment,
+                               this);
+#endif
+                return nullptr;
+              }
+
+            out_of_memory_handler_ ();
+
+            // If the handler returned, assume it freed some memory
+            // and try again to allocate.
+          }
+      }
+
+      /**
+       * @details
+       * The block is returned to the chunk that owns it; chunks
+       * are kept by the bin until `release()`.
+       *
+       * If the size is not known, all bins are searched; blocks
+       * not found in any bin are assumed to be allocated from
+       * upstream.
+       *
+       * @par Exceptions
+       *   Throws nothing.
+       */
+      void
+      unsynchronized_pool_resource::do_deallocate (void* addr,
+                                                   std::size_t bytes,
+                                                   std::size_t alignment) noexcept
+      {
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+        trace::printf ("%s(%p,%u,%u) @%p\n", __func__, addr, bytes, alignment,
+                       this);
+#endif
+
+        if (addr == nullptr)
+          {
+            return;
+          }
+
+        std::size_t index = bins_count_;
+        chunk_t* chunk = nullptr;
+        if (bytes != 0)
+          {
+            if (alignment <= max_align)
+              {
+                index = internal_index_ (bytes, alignment);
+                if (index < bins_count_)
+                  {
+                    chunk = internal_find_ (index, addr);
+                    assert(chunk != nullptr);
+                  }
+              }
+          }
+        else
+          {
+            for (index = 0; index < bins_count_; ++index)
+              {
+                chunk = internal_find_ (index, addr);
+                if (chunk != nullptr)
+                  {
+                    break;
+                  }
+              }
+          }
+
+        if (chunk != nullptr)
+          {
+            std::size_t block_bytes = min_block_bytes << index;
+            chunk->pool.deallocate (addr, block_bytes);
+            internal_decrease_allocated_statistics (block_bytes);
+
+            return;
+          }
+
+        large_t* large =
+            reinterpret_cast<large_t*> (static_cast<char*> (addr)
+                - sizeof(large_t));
+
+        if (large->prev != nullptr)
+          {
+            large->prev->next = large->next;
+          }
+        else
+          {
+            large_ = large->next;
+          }
+        if (large->next != nullptr)
+          {
+            large->next->prev = large->prev;
+          }
+
+        std::size_t size = large->bytes;
+        std::size_t align = large->alignment;
+        std::size_t offset = rtos::memory::align_size (sizeof(large_t), align);
+
+        // The block is both deallocated and removed.
+        internal_decrease_allocated_statistics (size);
+        total_bytes_ -= size;
+        free_bytes_ -= size;
+        --free_chunks_;
+
+        upstream_->deallocate (static_cast<char*> (addr) - offset,
+                               offset + size, align);
+      }
+
+      /**
+       * @details
+       * The chunks and the large blocks are returned to upstream,
+       * even if there are blocks still allocated. The peak usage
+       * is preserved.
+       *
+       * @warning All pointers to memory allocated from this resource
+       *  become dangling.
+       */
+      void
+      unsynchronized_pool_resource::release (void) noexcept
+      {
+        for (std::size_t i = 0; i < bins_count_; ++i)
+          {
+            bin_t& bin = bins_[i];
+            while (bin.chunks != nullptr)
+              {
+                chunk_t* chunk = bin.chunks;
+                bin.chunks = chunk->next;
+
+                std::size_t bytes = chunk_offset + chunk->pool.total_bytes ();
+                chunk->~chunk_t ();
+                upstream_->deallocate (chunk, bytes, max_align);
+              }
+            bin.next_blocks = rtos::memory::min (initial_blocks_per_chunk,
+                                                 max_blocks_per_chunk_);
+          }
+
+        while (large_ != nullptr)
+          {
+            large_t* large = large_;
+            large_ = large->next;
+
+            std::size_t offset = rtos::memory::align_size (sizeof(large_t),
+                                                           large->alignment);
+            upstream_->deallocate (
+                reinterpret_cast<char*> (large) + sizeof(large_t) - offset,
+                offset + large->bytes, large->alignment);
+          }
+
+        total_bytes_ = 0;
+        allocated_bytes_ = 0;
+        free_bytes_ = 0;
+        allocated_chunks_ = 0;
+        free_chunks_ = 0;
+      }
+
+      /**
+       * @details
+       * The largest block is given by upstream.
+       */
+      std::size_t
+      unsynchronized_pool_resource::do_max_size (void) const noexcept
+      {
+        return upstream_->max_size ();
+      }
+
+      /**
+       * @details
+       * Release all memory and clear the peak usage.
+       */
+      void
+      unsynchronized_pool_resource::do_reset (void) noexcept
+      {
+        release ();
+
+        max_allocated_bytes_ = 0;
+      }
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY)
+
+      /**
+       * @details
+       * The largest block that can be allocated without asking
+       * upstream, which is the size of the largest bin with
+       * free blocks.
+       */
+      std::size_t
+      unsynchronized_pool_resource::do_largest_free_chunk (void) const noexcept
+      {
+        for (std::size_t i = bins_count_; i > 0; --i)
+          {
+            for (chunk_t* chunk = bins_[i - 1].chunks; chunk != nullptr;
+                chunk = chunk->next)
+              {
+                if (chunk->pool.free_chunks () > 0)
+                  {
+                    return min_block_bytes << (i - 1);
+                  }
+              }
+          }
+        return 0;
+      }
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY) */
+
+      // ======================================================================
+
+      synchronized_pool_resource::synchronized_pool_resource (
+          const pool_options& opts, memory_resource* upstream) :
+          unsynchronized_pool_resource
+            { opts, upstream }
+      {
+        ;
+      }
+
+      synchronized_pool_resource::synchronized_pool_resource () :
+          unsynchronized_pool_resource
+            { }
+      {
+        ;
+      }
+
+      synchronized_pool_resource::synchronized_pool_resource (
+          memory_resource* upstream) :
+          unsynchronized_pool_resource
+            { upstream }
+      {
+        ;
+      }
+
+      synchronized_pool_resource::synchronized_pool_resource (
+          const pool_options& opts) :
+          unsynchronized_pool_resource
+            { opts }
+      {
+        ;
+      }
+
+      synchronized_pool_resource::~synchronized_pool_resource ()
+      {
+        trace::printf ("%s() @%p\n", __func__, this);
+      }
+
+      void
+      synchronized_pool_resource::release (void) noexcept
+      {
+        std::lock_guard<rtos::mutex> lock
+          { mutex_ };
+
+        unsynchronized_pool_resource::release ();
+      }
+
+      void*
+      synchronized_pool_resource::do_allocate (std::size_t bytes,
+                                               std::size_t alignment)
+      {
+        std::lock_guard<rtos::mutex> lock
+          { mutex_ };
+
+        return unsynchronized_pool_resource::do_allocate (bytes, alignment);
+      }
+
+      void
+      synchronized_pool_resource::do_deallocate (void* addr, std::size_t bytes,
+                                                 std::size_t alignment) noexcept
+      {
+        std::lock_guard<rtos::mutex> lock
+          { mutex_ };
+
+        unsynchronized_pool_resource::do_deallocate (addr, bytes, alignment);
+      }
+
+      void
+      synchronized_pool_resource::do_reset (void) noexcept
+      {
+        std::lock_guard<rtos::mutex> lock
+          { mutex_ };
+
+        unsynchronized_pool_resource::do_reset ();
+      }
+
     // ------------------------------------------------------------------------
     } /* namespace pmr */
   } /* namespace estd */
@@ -35,9 +35,23 @@ namespace os
   {
     // ========================================================================
 
+    // Without the port, the uncontended cases take the atomic
+    // fast paths directly, without the checks and the tracing
+    // done by the rtos::mutex functions.
+#if !defined(OS_USE_RTOS_PORT_MUTEX) && !defined(OS_INCLUDE_RTOS_TRACE_EVENTS)
+#define OS_ESTD_MUTEX_FAST_PATHS
+#endif
+
     void
     mutex::lock ()
     {
+#if defined(OS_ESTD_MUTEX_FAST_PATHS)
+      if (nm_.internal_try_lock_fast_ (&os::rtos::this_thread::thread ()))
+        {
+          return;
+        }
+#endif /* defined(OS_ESTD_MUTEX_FAST_PATHS) */
+
       os::rtos::result_t res;
       res = nm_.lock ();
       if (res != os::rtos::result::ok)
@@ -50,6 +64,13 @@ namespace os
     bool
     mutex::try_lock ()
     {
+#if defined(OS_ESTD_MUTEX_FAST_PATHS)
+      if (nm_.internal_try_lock_fast_ (&os::rtos::this_thread::thread ()))
+        {
+          return true;
+        }
+#endif /* defined(OS_ESTD_MUTEX_FAST_PATHS) */
+
       os::rtos::result_t res;
       res = nm_.try_lock ();
       if (res == os::rtos::result::ok)
@@ -69,6 +90,13 @@ namespace os
     void
     mutex::unlock ()
     {
+#if defined(OS_ESTD_MUTEX_FAST_PATHS)
+      if (nm_.internal_try_unlock_fast_ (&os::rtos::this_thread::thread ()))
+        {
+          return;
+        }
+#endif /* defined(OS_ESTD_MUTEX_FAST_PATHS) */
+
       os::rtos::result_t res;
       res = nm_.unlock ();
       if (res != os::rtos::result::ok)
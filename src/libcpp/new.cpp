@@ -153,18 +153,29 @@ operator new (std::size_t bytes)
       bytes = 1;
     }
 
+#if !defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE)
   // ----- Begin of critical section ------------------------------------------
   rtos::scheduler::critical_section scs;
+#endif /* !defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE) */
 
   while (true)
     {
+#if defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE)
+      // The thread cache locks the scheduler only when needed.
+      void* mem = rtos::memory::allocate_cached (bytes);
+#else
       void* mem = estd::pmr::get_default_resource ()->allocate (bytes);
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE) */
 
       if (mem != nullptr)
         {
 #if defined(OS_TRACE_LIBCPP_OPERATOR_NEW)
           trace::printf ("::%s(%d)=%p\n", __func__, bytes, mem);
 #endif
+#if defined(OS_INCLUDE_RTOS_MEMORY_PROFILER)
+          rtos::memory::profiler::record_allocation (
+              __builtin_return_address (0), mem, bytes);
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_PROFILER) */
           return mem;
         }
 
@@ -217,18 +228,29 @@ operator new (std::size_t bytes,
       bytes = 1;
     }
 
+#if !defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE)
   // ----- Begin of critical section ------------------------------------------
   rtos::scheduler::critical_section scs;
+#endif /* !defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE) */
 
   while (true)
     {
+#if defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE)
+      // The thread cache locks the scheduler only when needed.
+      void* mem = rtos::memory::allocate_cached (bytes);
+#else
       void* mem = estd::pmr::get_default_resource ()->allocate (bytes);
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE) */
 
       if (mem != nullptr)
         {
 #if defined(OS_TRACE_LIBCPP_OPERATOR_NEW)
           trace::printf ("::%s(%d)=%p\n", __func__, bytes, mem);
 #endif
+#if defined(OS_INCLUDE_RTOS_MEMORY_PROFILER)
+          rtos::memory::profiler::record_allocation (
+              __builtin_return_address (0), mem, bytes);
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_PROFILER) */
           return mem;
         }
 
@@ -332,12 +354,21 @@ operator delete (void* ptr) noexcept
 
   if (ptr)
     {
+#if defined(OS_INCLUDE_RTOS_MEMORY_PROFILER)
+      rtos::memory::profiler::record_deallocation (ptr);
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_PROFILER) */
+
+#if defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE)
+      // The size is known from the block header.
+      rtos::memory::deallocate_cached (ptr);
+#else
       // ----- Begin of critical section --------------------------------------
       rtos::scheduler::critical_section scs;
 
       // The unknown size is passed as 0.
       estd::pmr::get_default_resource ()->deallocate (ptr, 0);
       // ----- End of critical section ----------------------------------------
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE) */
     }
 }
 
@@ -373,7 +404,7 @@ operator delete (void* ptr, std::size_t bytes) noexcept;
  */
 void
 __attribute__((weak))
-operator delete (void* ptr, std::size_t bytes) noexcept
+operator delete (void* ptr, std::size_t bytes __attribute__((unused))) noexcept
 {
 #if defined(OS_TRACE_LIBCPP_OPERATOR_NEW)
   trace::printf ("::%s(%p,%u)\n", __func__, ptr, bytes);
@@ -383,11 +414,20 @@ operator delete (void* ptr, std::size_t bytes) noexcept
 
   if (ptr)
     {
+#if defined(OS_INCLUDE_RTOS_MEMORY_PROFILER)
+      rtos::memory::profiler::record_deallocation (ptr);
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_PROFILER) */
+
+#if defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE)
+      // The size is known from the block header.
+      rtos::memory::deallocate_cached (ptr);
+#else
       // ----- Begin of critical section --------------------------------------
       rtos::scheduler::critical_section scs;
 
       estd::pmr::get_default_resource ()->deallocate (ptr, bytes);
       // ----- End of critical section ----------------------------------------
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE) */
     }
 }
 
@@ -424,11 +464,20 @@ operator delete (void* ptr,
 
   if (ptr)
     {
+#if defined(OS_INCLUDE_RTOS_MEMORY_PROFILER)
+      rtos::memory::profiler::record_deallocation (ptr);
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_PROFILER) */
+
+#if defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE)
+      // The size is known from the block header.
+      rtos::memory::deallocate_cached (ptr);
+#else
       // ----- Begin of critical section --------------------------------------
       rtos::scheduler::critical_section scs;
 
       estd::pmr::get_default_resource ()->deallocate (ptr, 0);
       // ----- End of critical section ----------------------------------------
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE) */
     }
 }
 
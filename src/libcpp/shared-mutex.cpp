@@ -0,0 +1,148 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/estd/shared_mutex>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace estd
+  {
+    // ========================================================================
+
+    void
+    shared_mutex::lock ()
+    {
+      os::rtos::result_t res;
+      res = nm_.lock ();
+      if (res != os::rtos::result::ok)
+        {
+          os::estd::__throw_cmsis_error (static_cast<int> (res),
+                                         "shared_mutex lock failed");
+        }
+    }
+
+    bool
+    shared_mutex::try_lock ()
+    {
+      os::rtos::result_t res;
+      res = nm_.try_lock ();
+      if (res == os::rtos::result::ok)
+        {
+          return true;
+        }
+      else if (res == EWOULDBLOCK)
+        {
+          return false;
+        }
+
+      os::estd::__throw_cmsis_error (static_cast<int> (res),
+                                     "shared_mutex try_lock failed");
+      // return false;
+    }
+
+    void
+    shared_mutex::unlock ()
+    {
+      os::rtos::result_t res;
+      res = nm_.unlock ();
+      if (res != os::rtos::result::ok)
+        {
+          os::estd::__throw_cmsis_error (static_cast<int> (res),
+                                         "shared_mutex unlock failed");
+        }
+    }
+
+    void
+    shared_mutex::lock_shared ()
+    {
+      os::rtos::result_t res;
+      res = nm_.lock_shared ();
+      if (res != os::rtos::result::ok)
+        {
+          os::estd::__throw_cmsis_error (static_cast<int> (res),
+                                         "shared_mutex lock_shared failed");
+        }
+    }
+
+    bool
+    shared_mutex::try_lock_shared ()
+    {
+      os::rtos::result_t res;
+      res = nm_.try_lock_shared ();
+      if (res == os::rtos::result::ok)
+        {
+          return true;
+        }
+      else if (res == EWOULDBLOCK)
+        {
+          return false;
+        }
+
+      os::estd::__throw_cmsis_error (static_cast<int> (res),
+                                     "shared_mutex try_lock_shared failed");
+      // return false;
+    }
+
+    void
+    shared_mutex::unlock_shared ()
+    {
+      os::rtos::result_t res;
+      res = nm_.unlock_shared ();
+      if (res != os::rtos::result::ok)
+        {
+          os::estd::__throw_cmsis_error (static_cast<int> (res),
+                                         "shared_mutex unlock_shared failed");
+        }
+    }
+
+    // ========================================================================
+
+    bool
+    shared_timed_mutex::internal_timed_result_ (os::rtos::result_t res,
+                                                const char* what_arg)
+    {
+      if (res == os::rtos::result::ok)
+        {
+          return true;
+        }
+      else if (res == ETIMEDOUT)
+        {
+          return false;
+        }
+
+      os::estd::__throw_cmsis_error (static_cast<int> (res), what_arg);
+      // return false;
+    }
+
+  // ==========================================================================
+
+  } /* namespace estd */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
@@ -127,4 +127,60 @@ thread::detach ()
   os::trace::printf ("%s() @%p detached\n", __func__, this);
 }
 
+// ------------------------------------------------------------------------
+
+thread::scoped_attributes* thread::scoped_attributes::top_ = nullptr;
+
+/**
+ * @details
+ * Typically `th_stack_size_bytes` and `th_stack_pool` are set,
+ * so short lived workers take their stacks from a pool.
+ */
+thread::scoped_attributes::scoped_attributes (
+    const os::rtos::thread::attributes& attr) noexcept :
+    attr_ (attr), //
+    owner_ (&os::rtos::this_thread::thread ())
+{
+  // ----- Enter critical section ---------------------------------------------
+  os::rtos::scheduler::critical_section scs;
+
+  previous_ = top_;
+  top_ = this;
+  // ----- Exit critical section ----------------------------------------------
+}
+
+thread::scoped_attributes::~scoped_attributes () noexcept
+{
+  // ----- Enter critical section ---------------------------------------------
+  os::rtos::scheduler::critical_section scs;
+
+  // The instances of different threads may end in any order.
+  scoped_attributes** p = &top_;
+  while (*p != this)
+    {
+      p = &(*p)->previous_;
+    }
+  *p = previous_;
+  // ----- Exit critical section ----------------------------------------------
+}
+
+const os::rtos::thread::attributes&
+thread::scoped_attributes::current (void) noexcept
+{
+  os::rtos::thread* th = &os::rtos::this_thread::thread ();
+
+  // ----- Enter critical section ---------------------------------------------
+  os::rtos::scheduler::critical_section scs;
+
+  for (scoped_attributes* p = top_; p != nullptr; p = p->previous_)
+    {
+      if (p->owner_ == th)
+        {
+          return p->attr_;
+        }
+    }
+  return os::rtos::thread::initializer;
+  // ----- Exit critical section ----------------------------------------------
+}
+
 // ==========================================================================
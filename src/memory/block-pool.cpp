@@ -56,14 +56,13 @@ namespace os
     {
       assert(bytes <= block_size_bytes_);
 
-      if (first_ == nullptr)
+      void* p = free_list_.pop ();
+      if (p == nullptr)
         {
           return nullptr;
         }
 
-      void* p = static_cast<void*> (first_);
-      first_ = *(static_cast<void**> (first_));
-      ++count_;
+      __atomic_add_fetch (&count_, 1, __ATOMIC_RELAXED);
 
       // Update statistics.
       // What is subtracted from free is added to allocated.
@@ -97,17 +96,10 @@ namespace os
           return;
         }
 
-      // Perform a push_front() on the single linked LIFO list,
-      // i.e. add the block to the beginning of the list.
+      // Add the block to the beginning of the list.
+      free_list_.push (addr);
 
-      // Link previous list to this block; may be null, but it does
-      // not matter.
-      *(static_cast<void**> (addr)) = first_;
-
-      // Now this block is the first in the free list..
-      first_ = addr;
-
-      --count_;
+      __atomic_sub_fetch (&count_, 1, __ATOMIC_RELAXED);
 
       // Update statistics.
       // What is subtracted from allocated is added to free.
@@ -125,6 +117,21 @@ namespace os
       return block_size_bytes_ * blocks_;
     }
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY)
+
+    /**
+     * @details
+     * All blocks have the same size, so the pool is never
+     * fragmented; the result is either a block or nothing.
+     */
+    std::size_t
+    block_pool::do_largest_free_chunk (void) const noexcept
+    {
+      return (free_chunks_ > 0) ? block_size_bytes_ : 0;
+    }
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY) */
+
     /**
      * @details
      */
@@ -181,25 +188,9 @@ namespace os
     void
     block_pool::internal_reset_ (void) noexcept
     {
-      // Construct a linked list of blocks. Store the pointer at
-      // the beginning of each block. Each block
-      // will hold the address of the next free block, or nullptr at the end.
-      char* p = static_cast<char*> (pool_addr_);
-      for (std::size_t i = 1; i < blocks_; ++i)
-        {
-          // Compute the address of the next block;
-          char* pn = p + block_size_bytes_;
-
-          // Make this block point to the next one.
-          *(static_cast<void**> (static_cast<void*> (p))) = pn;
-          // Advance pointer
-          p = pn;
-        }
-
-      // Mark end of list.
-      *(static_cast<void**> (static_cast<void*> (p))) = nullptr;
-
-      first_ = pool_addr_; // Pointer to first block.
+      // Construct a linked list of blocks. Each block will hold
+      // the index of the next free block.
+      free_list_.init (pool_addr_, blocks_, block_size_bytes_);
 
       count_ = 0; // No allocated blocks.
 
@@ -27,6 +27,7 @@
 
 #include <cmsis-plus/memory/first-fit-top.h>
 #include <memory>
+#include <cstring>
 
 // ----------------------------------------------------------------------------
 
@@ -91,6 +92,9 @@ namespace os
 
       // Remember first chunk as list head.
       free_list_ = chunk;
+
+      // Nothing is known to be zero.
+      zero_end_ = reinterpret_cast<char*> (chunk) + chunk_minsize;
     }
 
     /**
@@ -122,6 +126,10 @@ namespace os
      * in other words, memory is allocated top-down. This speeds
      * up deallocation for blocks allocated recently.
      *
+     * Over-aligned blocks (larger than `max_align`) are placed
+     * in the free chunks at their exact alignment, see
+     * `internal_find_aligned_()`.
+     *
      * @par Exceptions
      *   Throws nothing by itself, but the out of memory handler may
      *   throw `bad_alloc()`.
@@ -141,52 +149,61 @@ namespace os
 
       while (true)
         {
-          chunk_t* prev_chunk = free_list_;
-          chunk = prev_chunk;
-
-          while (chunk)
+          if (alignment > max_align)
+            {
+              // Select the chunk by the actual alignment,
+              // not by the worst case padding.
+              chunk = internal_find_aligned_ (bytes, alignment);
+            }
+          else
             {
-              int rem = static_cast<int> (chunk->size - alloc_size);
-              if (rem >= 0)
+              chunk_t* prev_chunk = free_list_;
+              chunk = prev_chunk;
+
+              while (chunk)
                 {
-                  if ((static_cast<std::size_t> (rem)) >= block_minchunk)
-                    {
-                      // Found a chunk that is much larger than required size
-                      // (at least one more chunk is available);
-                      // break it into two chunks and return the second one.
-
-                      chunk->size = static_cast<std::size_t> (rem);
-                      chunk =
-                          reinterpret_cast<chunk_t *> (reinterpret_cast<char *> (chunk)
-                              + rem);
-                      chunk->size = alloc_size;
-
-                      // Splitting one chunk creates one more chunk.
-                      ++free_chunks_;
-                    }
-                  else
+                  int rem = static_cast<int> (chunk->size - alloc_size);
+                  if (rem >= 0)
                     {
-                      // Found a chunk that is exactly the size or slightly
-                      // larger than the requested size; return this chunk.
-
-                      if (prev_chunk == chunk)
+                      if ((static_cast<std::size_t> (rem)) >= block_minchunk)
                         {
-                          // This implies p==r==free_list, i.e. the list head.
-                          // The next chunk becomes the first list element.
-                          free_list_ = chunk->next;
-
-                          // If this was the last chunk, the free list is empty.
+                          // Found a chunk that is much larger than required size
+                          // (at least one more chunk is available);
+                          // break it into two chunks and return the second one.
+
+                          chunk->size = static_cast<std::size_t> (rem);
+                          chunk =
+                              reinterpret_cast<chunk_t *> (reinterpret_cast<char *> (chunk)
+                                  + rem);
+                          chunk->size = alloc_size;
+
+                          // Splitting one chunk creates one more chunk.
+                          ++free_chunks_;
                         }
                       else
                         {
-                          // Normal case. Remove it from the free_list.
-                          prev_chunk->next = chunk->next;
+                          // Found a chunk that is exactly the size or slightly
+                          // larger than the requested size; return this chunk.
+
+                          if (prev_chunk == chunk)
+                            {
+                              // This implies p==r==free_list, i.e. the list head.
+                              // The next chunk becomes the first list element.
+                              free_list_ = chunk->next;
+
+                              // If this was the last chunk, the free list is empty.
+                            }
+                          else
+                            {
+                              // Normal case. Remove it from the free_list.
+                              prev_chunk->next = chunk->next;
+                            }
                         }
+                      break;
                     }
-                  break;
+                  prev_chunk = chunk;
+                  chunk = chunk->next;
                 }
-              prev_chunk = chunk;
-              chunk = chunk->next;
             }
 
           if (chunk != nullptr)
@@ -194,6 +211,14 @@ namespace os
               break;
             }
 
+#if defined(OS_INCLUDE_RTOS_MEMORY_RECLAIM)
+          if (reclaim (bytes) != 0)
+            {
+              // Some cache released memory, try again to allocate.
+              continue;
+            }
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_RECLAIM) */
+
           if (out_of_memory_handler_ == nullptr)
             {
 #if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
@@ -224,6 +249,113 @@ namespace os
       return aligned_payload;
     }
 
+    /**
+     * @details
+     * For alignments larger than `max_align`, like the cache line
+     * or the DMA alignment, reserving the worst case padding in
+     * each chunk wastes up to _alignment_ bytes per block and
+     * rejects chunks that would fit.
+     *
+     * Instead, for each free chunk, the highest aligned payload
+     * is computed and, if it fits, the block is carved exactly
+     * there, from the top of the chunk; the part below remains
+     * free, and the few bytes above the block, if large enough,
+     * are returned to the free list as a separate chunk.
+     *
+     * In most cases the payload is at the beginning of the block
+     * and no alignment offset is needed.
+     */
+    first_fit_top::chunk_t*
+    first_fit_top::internal_find_aligned_ (std::size_t bytes,
+                                           std::size_t alignment)
+    {
+      std::size_t payload_size = os::rtos::memory::max (
+          rtos::memory::align_size (bytes, chunk_align), block_minsize);
+      std::size_t free_minchunk = calc_block_minchunk (0);
+
+      chunk_t* prev_chunk = nullptr;
+      for (chunk_t* chunk = free_list_; chunk != nullptr;
+          prev_chunk = chunk, chunk = chunk->next)
+        {
+          if (chunk->size < chunk_offset + payload_size)
+            {
+              continue;
+            }
+
+          char* begin = reinterpret_cast<char *> (chunk);
+          char* end = begin + chunk->size;
+
+          // The highest aligned payload ending inside the chunk.
+          char* payload =
+              reinterpret_cast<char *> (reinterpret_cast<uintptr_t> (end
+                  - payload_size) & ~(static_cast<uintptr_t> (alignment) - 1));
+          if (payload < begin + chunk_offset)
+            {
+              continue;
+            }
+
+          chunk_t* next = chunk->next;
+          chunk_t* block;
+
+          std::size_t rem = static_cast<std::size_t> (payload - chunk_offset
+              - begin);
+          if (rem >= free_minchunk)
+            {
+              // Split the chunk, the bottom part remains free.
+              chunk->size = rem;
+              block = reinterpret_cast<chunk_t *> (payload - chunk_offset);
+
+              // Splitting one chunk creates one more chunk.
+              ++free_chunks_;
+
+              // The top part, if any, will follow it in the free list.
+              prev_chunk = chunk;
+            }
+          else
+            {
+              // Take the entire chunk; the small gap below the payload
+              // is handled as alignment offset.
+              if (prev_chunk == nullptr)
+                {
+                  free_list_ = next;
+                }
+              else
+                {
+                  prev_chunk->next = next;
+                }
+              block = chunk;
+            }
+
+          char* block_end = payload + payload_size;
+          std::size_t tail = static_cast<std::size_t> (end - block_end);
+          if (tail >= free_minchunk)
+            {
+              // Return the top part to the free list, keeping
+              // the list ordered by addresses.
+              chunk_t* top = reinterpret_cast<chunk_t *> (block_end);
+              top->size = tail;
+              top->next = next;
+              if (prev_chunk == nullptr)
+                {
+                  free_list_ = top;
+                }
+              else
+                {
+                  prev_chunk->next = top;
+                }
+
+              ++free_chunks_;
+              end = block_end;
+            }
+
+          block->size = static_cast<std::size_t> (end
+              - reinterpret_cast<char *> (block));
+          return block;
+        }
+
+      return nullptr;
+    }
+
     /**
      * @details
      *
@@ -396,6 +528,215 @@ namespace os
         }
     }
 
+    /**
+     * @details
+     * The block is resized in place when possible:
+     * - when shrinking, the end of the chunk, if large enough,
+     *   is split and returned to the free list;
+     * - when growing, the free chunk right after it, if any and
+     *   large enough, is absorbed, possibly after splitting it.
+     *
+     * Otherwise a new block is allocated, the content is copied
+     * and the old block is deallocated; since the size of the old
+     * chunk is known, only the valid content is copied.
+     *
+     * Finding the free chunk after the block requires a partial
+     * traversal of the free list, which is ordered by addresses,
+     * but no data is copied.
+     *
+     * @par Exceptions
+     *   Throws nothing by itself, but the out of memory handler may
+     *   throw `bad_alloc()`.
+     */
+    void*
+    first_fit_top::do_reallocate (void* addr, std::size_t old_bytes,
+                                  std::size_t new_bytes, std::size_t alignment)
+    {
+      if (addr == nullptr)
+        {
+          return memory_resource::do_reallocate (addr, old_bytes, new_bytes,
+                                                 alignment);
+        }
+
+      // The address must be inside the arena; no exceptions.
+      if ((addr < arena_addr_)
+          || (addr > (static_cast<char*> (arena_addr_) + total_bytes_)))
+        {
+          assert(false);
+          return nullptr;
+        }
+
+      // Compute the chunk address from the user address.
+      chunk_t* chunk = reinterpret_cast<chunk_t *> (static_cast<char *> (addr)
+          - chunk_offset);
+
+      // If the block was aligned, the offset appears as size; adjust back.
+      if (static_cast<std::ptrdiff_t> (chunk->size) < 0)
+        {
+          chunk = reinterpret_cast<chunk_t *> (reinterpret_cast<char *> (chunk)
+              + static_cast<std::ptrdiff_t> (chunk->size));
+        }
+
+      // From the chunk to the aligned payload.
+      std::size_t head = static_cast<std::size_t> (static_cast<char*> (addr)
+          - reinterpret_cast<char*> (chunk));
+      std::size_t block_minchunk = calc_block_minchunk (0);
+
+      std::size_t new_size = head
+          + rtos::memory::align_size (new_bytes, chunk_align);
+      new_size = os::rtos::memory::max (new_size, block_minchunk);
+
+      if (new_size <= chunk->size)
+        {
+          std::size_t rem = chunk->size - new_size;
+          if (rem >= block_minchunk)
+            {
+              // Split the end of the chunk and free it, as if it
+              // was a separate allocated chunk.
+              chunk->size = new_size;
+              chunk_t* tail =
+                  reinterpret_cast<chunk_t *> (reinterpret_cast<char *> (chunk)
+                      + new_size);
+              tail->size = rem;
+              ++allocated_chunks_;
+
+              first_fit_top::do_deallocate (
+                  reinterpret_cast<char *> (tail) + chunk_offset, 0, 0);
+            }
+
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+          trace::printf ("first_fit_top::%s(%p,%u,%u)=%p shrunk @%p %s\n",
+                         __func__, addr, old_bytes, new_bytes, addr, this,
+                         name ());
+#endif
+
+          return addr;
+        }
+
+      // Search the free chunk right after it.
+      char* end = reinterpret_cast<char *> (chunk) + chunk->size;
+      chunk_t* prev_chunk = nullptr;
+      chunk_t* next_chunk = free_list_;
+      while (next_chunk != nullptr && reinterpret_cast<char *> (next_chunk) < end)
+        {
+          prev_chunk = next_chunk;
+          next_chunk = next_chunk->next;
+        }
+
+      if (reinterpret_cast<char *> (next_chunk) == end
+          && chunk->size + next_chunk->size >= new_size)
+        {
+          std::size_t rem = chunk->size + next_chunk->size - new_size;
+          chunk_t* replacement;
+          if (rem >= block_minchunk)
+            {
+              // Leave the rest of the free chunk in the list.
+              replacement =
+                  reinterpret_cast<chunk_t *> (reinterpret_cast<char *> (chunk)
+                      + new_size);
+              replacement->size = rem;
+              replacement->next = next_chunk->next;
+            }
+          else
+            {
+              // Absorb the entire free chunk.
+              new_size = chunk->size + next_chunk->size;
+              replacement = next_chunk->next;
+
+              // One less free chunk.
+              --free_chunks_;
+            }
+
+          if (prev_chunk == nullptr)
+            {
+              free_list_ = replacement;
+            }
+          else
+            {
+              prev_chunk->next = replacement;
+            }
+
+          internal_grow_allocated_statistics (new_size - chunk->size);
+          chunk->size = new_size;
+
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+          trace::printf ("first_fit_top::%s(%p,%u,%u)=%p grown @%p %s\n",
+                         __func__, addr, old_bytes, new_bytes, addr, this,
+                         name ());
+#endif
+
+          return addr;
+        }
+
+      // Cannot resize in place; the usable size is known.
+      return memory_resource::do_reallocate (addr, chunk->size - head,
+                                             new_bytes, alignment);
+    }
+
+    /**
+     * @details
+     * Blocks fully carved from the zero area, the part of the first
+     * free chunk filled with zeros by `do_zero_free()` and not used
+     * since, are not filled again.
+     *
+     * @par Exceptions
+     *   Throws nothing by itself, but the out of memory handler may
+     *   throw `bad_alloc()`.
+     */
+    void*
+    first_fit_top::do_allocate_zeroed (std::size_t bytes,
+                                       std::size_t alignment)
+    {
+      last_zeroed_ = false;
+
+      void* mem = do_allocate (bytes, alignment);
+      if (mem != nullptr && !last_zeroed_)
+        {
+          std::memset (mem, 0, bytes);
+        }
+      return mem;
+    }
+
+    /**
+     * @details
+     * Since chunks are allocated from the top of the first free
+     * chunk, the part right after its header is the last to be
+     * used; this function fills it with zeros, upwards, a few bytes
+     * at a time, up to the end of the chunk. Freed blocks that
+     * coalesce into the first chunk extend it and are zeroed
+     * by later calls.
+     *
+     * The call must be protected by the same lock as `allocate()`.
+     */
+    std::size_t
+    first_fit_top::do_zero_free (std::size_t bytes) noexcept
+    {
+      chunk_t* chunk = free_list_;
+      if (chunk != reinterpret_cast<chunk_t*> (arena_addr_))
+        {
+          // The first chunk was allocated.
+          return 0;
+        }
+
+      char* begin = reinterpret_cast<char*> (chunk) + chunk_minsize;
+      char* end = reinterpret_cast<char*> (chunk) + chunk->size;
+      if (zero_end_ < begin)
+        {
+          zero_end_ = begin;
+        }
+      if (zero_end_ >= end)
+        {
+          return 0;
+        }
+
+      std::size_t n = os::rtos::memory::min (
+          bytes, static_cast<std::size_t> (end - zero_end_));
+      std::memset (zero_end_, 0, n);
+      zero_end_ += n;
+
+      return n;
+    }
+
     /**
      * @details
      */
@@ -405,6 +746,26 @@ namespace os
       return total_bytes_;
     }
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY)
+
+    /**
+     * @details
+     * Walk the free list; since free chunks are coalesced
+     * during deallocation, there is no need to look at neighbours.
+     */
+    std::size_t
+    first_fit_top::do_largest_free_chunk (void) const noexcept
+    {
+      std::size_t bytes = 0;
+      for (chunk_t* chunk = free_list_; chunk != nullptr; chunk = chunk->next)
+        {
+          bytes = os::rtos::memory::max (bytes, chunk->size);
+        }
+      return bytes;
+    }
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY) */
+
     /**
      * @details
      */
@@ -416,6 +777,18 @@ namespace os
       // The value subtracted from free is added to allocated.
       internal_increase_allocated_statistics (chunk->size);
 
+      // The payload is zero if the chunk is entirely in the zero area;
+      // the first chunk header is written, so it is never included.
+      char* begin = reinterpret_cast<char *> (chunk);
+      last_zeroed_ = (begin
+          >= static_cast<char*> (arena_addr_) + chunk_minsize)
+          && (begin + chunk->size <= zero_end_);
+      if (begin < zero_end_)
+        {
+          // From here up, the memory is used.
+          zero_end_ = begin;
+        }
+
       // Compute pointer to payload area.
       char* payload = reinterpret_cast<char *> (chunk) + chunk_offset;
 
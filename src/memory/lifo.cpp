@@ -134,6 +134,14 @@ namespace os
               break;
             }
 
+#if defined(OS_INCLUDE_RTOS_MEMORY_RECLAIM)
+          if (reclaim (bytes) != 0)
+            {
+              // Some cache released memory, try again to allocate.
+              continue;
+            }
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_RECLAIM) */
+
           if (out_of_memory_handler_ == nullptr)
             {
 #if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
@@ -0,0 +1,336 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <cmsis-plus/memory/monotonic-arena.h>
+#include <memory>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace memory
+  {
+
+    // ========================================================================
+
+    /**
+     * @details
+     * All buffers obtained from upstream are returned.
+     */
+    monotonic_arena::~monotonic_arena ()
+    {
+      trace::printf ("monotonic_arena::%s() @%p %s\n", __func__, this,
+                     name ());
+
+      release ();
+    }
+
+    /**
+     * @details
+     * The initial buffer may be missing, in which case all memory
+     * comes from upstream.
+     */
+    void
+    monotonic_arena::internal_construct_ (
+        void* addr, std::size_t bytes, rtos::memory::memory_resource* upstream)
+    {
+      assert(addr != nullptr || bytes == 0);
+
+      initial_addr_ = addr;
+      initial_bytes_ = bytes;
+      upstream_ = upstream;
+
+      release ();
+
+      max_allocated_bytes_ = 0;
+    }
+
+    /**
+     * @details
+     * Return all buffers obtained from upstream since construction
+     * or the previous call, and restart allocations from the
+     * beginning of the initial buffer. The objects in the arena
+     * are not destructed.
+     *
+     * The peak usage is preserved, to measure the largest request;
+     * use `reset()` to clear it too.
+     *
+     * @warning All pointers to memory allocated from this resource
+     *  become dangling.
+     */
+    void
+    monotonic_arena::release (void) noexcept
+    {
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+      trace::printf ("monotonic_arena::%s() @%p %s\n", __func__, this,
+                     name ());
+#endif
+
+      while (buffers_ != nullptr)
+        {
+          buffer_t* buffer = buffers_;
+          buffers_ = buffer->next;
+
+          upstream_->deallocate (buffer, buffer->bytes, max_align);
+        }
+
+      current_ = static_cast<char*> (initial_addr_);
+      remaining_ = initial_bytes_;
+      next_bytes_ = rtos::memory::max (initial_bytes_, min_buffer_bytes);
+
+      total_bytes_ = initial_bytes_;
+      allocated_bytes_ = 0;
+      free_bytes_ = remaining_;
+      allocated_chunks_ = 0;
+      free_chunks_ = (remaining_ != 0) ? 1 : 0;
+    }
+
+    /**
+     * @details
+     * The new buffer is large enough for the block aligned in the
+     * worst case, and at least as large as the last one requested,
+     * which is then doubled, so the number of buffers grows
+     * logarithmically with the total size.
+     *
+     * What is left in the current buffer is no longer used.
+     */
+    bool
+    monotonic_arena::internal_grow_ (std::size_t bytes, std::size_t alignment)
+    {
+      if (upstream_ == nullptr)
+        {
+          return false;
+        }
+
+      std::size_t needed = sizeof(buffer_t) + bytes + alignment - 1;
+      if (needed < bytes)
+        {
+          // Overflow.
+          return false;
+        }
+
+      std::size_t buffer_bytes = rtos::memory::max (next_bytes_, needed);
+      buffer_bytes = rtos::memory::align_size (buffer_bytes, max_align);
+
+      buffer_t* buffer = static_cast<buffer_t*> (upstream_->allocate (
+          buffer_bytes, max_align));
+      if (buffer == nullptr)
+        {
+          return false;
+        }
+
+      buffer->bytes = buffer_bytes;
+      buffer->next = buffers_;
+      buffers_ = buffer;
+
+      // The rest of the current buffer is lost.
+      free_bytes_ -= remaining_;
+
+      current_ = reinterpret_cast<char*> (buffer) + sizeof(buffer_t);
+      remaining_ = buffer_bytes - sizeof(buffer_t);
+
+      total_bytes_ += remaining_;
+      free_bytes_ += remaining_;
+
+      // Prevent overflow.
+      if (buffer_bytes * 2 > buffer_bytes)
+        {
+          next_bytes_ = buffer_bytes * 2;
+        }
+
+      return true;
+    }
+
+    /**
+     * @details
+     * The block is taken from the beginning of the free space in
+     * the current buffer, after padding it for alignment. If the
+     * current buffer is not large enough, a new one is requested
+     * from upstream.
+     *
+     * Zero sized requests consume one byte, to return distinct
+     * addresses.
+     *
+     * @par Exceptions
+     *   Throws nothing by itself, but the upstream resource or
+     *   the out of memory handler may throw `bad_alloc()`.
+     */
+    void*
+    monotonic_arena::do_allocate (std::size_t bytes, std::size_t alignment)
+    {
+      if (bytes == 0)
+        {
+          bytes = 1;
+        }
+
+      void* p;
+      std::size_t space;
+
+      while (true)
+        {
+          p = current_;
+          space = remaining_;
+          if (p != nullptr
+              && std::align (alignment, bytes, p, space) != nullptr)
+            {
+              break;
+            }
+
+          if (internal_grow_ (bytes, alignment))
+            {
+              continue;
+            }
+
+#if defined(OS_INCLUDE_RTOS_MEMORY_RECLAIM)
+          if (reclaim (bytes) != 0)
+            {
+              // Some cache released memory, try again to allocate.
+              continue;
+            }
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_RECLAIM) */
+
+          if (out_of_memory_handler_ == nullptr)
+            {
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+              trace::printf ("monotonic_arena::%s(%u,%u)=0 @%p %s\n",
+                             __func__, bytes, alignment, this, name ());
+#endif
+
+              return nullptr;
+            }
+
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+          trace::printf ("monotonic_arena::%s(%u,%u) @%p %s out of memory\n",
+                         __func__, bytes, alignment, this, name ());
+#endif
+          out_of_memory_handler_ ();
+
+          // If the handler returned, assume it freed some memory
+          // and try again to allocate.
+        }
+
+      // The padding is accounted as allocated.
+      internal_increase_allocated_statistics (remaining_ - space + bytes);
+
+      current_ = static_cast<char*> (p) + bytes;
+      remaining_ = space - bytes;
+
+      // The free space is a single chunk, at the end of the
+      // current buffer.
+      free_chunks_ = (remaining_ != 0) ? 1 : 0;
+
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+      trace::printf ("monotonic_arena::%s(%u,%u)=%p @%p %s\n", __func__, bytes,
+                     alignment, p, this, name ());
+#endif
+
+      return p;
+    }
+
+#pragma GCC diagnostic push
+// Needed because the parameters are used only in trace calls.
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+    /**
+     * @details
+     * Deallocation does nothing, the memory is reclaimed
+     * only by `release()`; the block remains accounted as
+     * allocated up to then.
+     *
+     * @par Exceptions
+     *   Throws nothing.
+     */
+    void
+    monotonic_arena::do_deallocate (void* addr, std::size_t bytes,
+                                    std::size_t alignment) noexcept
+    {
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+      trace::printf ("monotonic_arena::%s(%p,%u,%u) @%p %s\n", __func__, addr,
+                     bytes, alignment, this, name ());
+#endif
+    }
+
+#pragma GCC diagnostic pop
+
+    /**
+     * @details
+     * Without an upstream resource, the largest block is the initial
+     * buffer; otherwise it is given by upstream, less the
+     * buffer header.
+     */
+    std::size_t
+    monotonic_arena::do_max_size (void) const noexcept
+    {
+      if (upstream_ == nullptr)
+        {
+          return initial_bytes_;
+        }
+
+      std::size_t bytes = upstream_->max_size ();
+      if (bytes <= sizeof(buffer_t))
+        {
+          return 0;
+        }
+      return rtos::memory::max (initial_bytes_, bytes - sizeof(buffer_t));
+    }
+
+    /**
+     * @details
+     * Release all memory and clear the peak usage.
+     */
+    void
+    monotonic_arena::do_reset (void) noexcept
+    {
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+      trace::printf ("monotonic_arena::%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      release ();
+
+      max_allocated_bytes_ = 0;
+    }
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY)
+
+    /**
+     * @details
+     * Only the space left in the current buffer can be allocated.
+     */
+    std::size_t
+    monotonic_arena::do_largest_free_chunk (void) const noexcept
+    {
+      return remaining_;
+    }
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY) */
+
+  // --------------------------------------------------------------------------
+  } /* namespace memory */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
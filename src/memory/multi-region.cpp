@@ -0,0 +1,539 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <cmsis-plus/memory/multi-region.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace memory
+  {
+
+    // ========================================================================
+
+    /**
+     * @details
+     * The blocks remain owned by the regions.
+     */
+    multi_region::placement_resource::~placement_resource ()
+    {
+      trace::printf ("%s() @%p %s\n", __func__, this, this->name ());
+    }
+
+    /**
+     * @details
+     * Forward the request to the owner, with the placement hint.
+     * The statistics are kept by the owner.
+     */
+    void*
+    multi_region::placement_resource::do_allocate (std::size_t bytes,
+                                                   std::size_t alignment)
+    {
+      return owner_.allocate_placed (bytes, hint_, alignment);
+    }
+
+    void
+    multi_region::placement_resource::do_deallocate (void* addr,
+                                                     std::size_t bytes,
+                                                     std::size_t alignment) noexcept
+    {
+      owner_.deallocate (addr, bytes, alignment);
+    }
+
+    void*
+    multi_region::placement_resource::do_reallocate (void* addr,
+                                                     std::size_t old_bytes,
+                                                     std::size_t new_bytes,
+                                                     std::size_t alignment)
+    {
+      if (addr == nullptr)
+        {
+          return owner_.allocate_placed (new_bytes, hint_, alignment);
+        }
+      return owner_.reallocate (addr, old_bytes, new_bytes, alignment);
+    }
+
+    std::size_t
+    multi_region::placement_resource::do_max_size (void) const noexcept
+    {
+      return owner_.max_size ();
+    }
+
+    // ========================================================================
+
+    /**
+     * @details
+     * The array of regions is owned by the caller and must
+     * survive this object; it is not copied, to avoid dynamic
+     * allocations. The backends must be constructed, and their
+     * ranges must not overlap.
+     *
+     * The order in the array is the order of preference, both
+     * for the matching regions and for the fallback chain.
+     */
+    multi_region::multi_region (const char* name, region_t* regions,
+                                std::size_t count, hint_t default_hint) :
+        rtos::memory::memory_resource
+          { name }, //
+        regions_ (regions), //
+        count_ (count), //
+        default_hint_ (default_hint)
+    {
+      trace::printf ("%s(%p,%u,0x%X) @%p %s\n", __func__, regions, count,
+                     default_hint, this, this->name ());
+
+      assert(regions != nullptr || count == 0);
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY)
+      min_free_bytes_ = ~static_cast<std::size_t> (0);
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY) */
+
+      for (std::size_t i = 0; i < count_; ++i)
+        {
+          assert(regions_[i].resource != nullptr);
+
+          regions_[i].fallbacks = 0;
+          regions_[i].failures = 0;
+        }
+
+      internal_update_statistics_ ();
+    }
+
+    /**
+     * @details
+     * The backends are not destructed.
+     */
+    multi_region::~multi_region ()
+    {
+      trace::printf ("%s() @%p %s\n", __func__, this, this->name ());
+    }
+
+    /**
+     * @details
+     * Linear search, the number of regions is small.
+     */
+    multi_region::region_t*
+    multi_region::find_region (const void* addr) const noexcept
+    {
+      const char* p = static_cast<const char*> (addr);
+      for (std::size_t i = 0; i < count_; ++i)
+        {
+          const char* begin = static_cast<const char*> (regions_[i].addr);
+          if (p >= begin && p < begin + regions_[i].bytes)
+            {
+              return &regions_[i];
+            }
+        }
+      return nullptr;
+    }
+
+    void*
+    multi_region::internal_try_ (region_t& region, std::size_t bytes,
+                                 std::size_t alignment, bool zeroed)
+    {
+      void* mem;
+      if (zeroed)
+        {
+          mem = region.resource->allocate_zeroed (bytes, alignment);
+        }
+      else
+        {
+          mem = region.resource->allocate (bytes, alignment);
+        }
+
+      if (mem == nullptr)
+        {
+          ++region.failures;
+        }
+      return mem;
+    }
+
+    /**
+     * @details
+     * First try, in order, the regions serving one of the
+     * requested classes, skipping those that limit the block size
+     * below the request.
+     *
+     * If none succeeded, and the hint is not `strict`, try all
+     * the other regions, in order, regardless of the size limit.
+     * The region serving such a request records a fallback.
+     *
+     * Only when all regions failed, the out of memory handler
+     * is called, and, if it returns, the search is restarted.
+     */
+    void*
+    multi_region::internal_allocate_ (std::size_t bytes,
+                                      std::size_t alignment, hint_t placement,
+                                      bool zeroed)
+    {
+      hint_t classes = placement & hint::any;
+      if (classes == 0)
+        {
+          classes = hint::any;
+        }
+
+      void* mem = nullptr;
+
+      while (true)
+        {
+          for (std::size_t i = 0; i < count_; ++i)
+            {
+              region_t& region = regions_[i];
+              if (!internal_matches_ (region, bytes, classes))
+                {
+                  continue;
+                }
+
+              mem = internal_try_ (region, bytes, alignment, zeroed);
+              if (mem != nullptr)
+                {
+                  break;
+                }
+            }
+
+          if (mem == nullptr && (placement & hint::strict) == 0)
+            {
+              // The fallback chain.
+              for (std::size_t i = 0; i < count_; ++i)
+                {
+                  region_t& region = regions_[i];
+                  if (internal_matches_ (region, bytes, classes))
+                    {
+                      // Already tried.
+                      continue;
+                    }
+
+                  mem = internal_try_ (region, bytes, alignment, zeroed);
+                  if (mem != nullptr)
+                    {
+                      ++region.fallbacks;
+                      break;
+                    }
+                }
+            }
+
+          if (mem != nullptr)
+            {
+              break;
+            }
+
+#if defined(OS_INCLUDE_RTOS_MEMORY_RECLAIM)
+          if (reclaim (bytes) != 0)
+            {
+              // Some cache released memory, try again to allocate.
+              continue;
+            }
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_RECLAIM) */
+
+          if (out_of_memory_handler_ == nullptr)
+            {
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+              trace::printf ("multi_region::%s(%u,%u,0x%X)=0 @%p %s\n",
+                             __func__, bytes, alignment, placement, this,
+                             name ());
+#endif
+
+              break;
+            }
+
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+          trace::printf ("multi_region::%s(%u,%u,0x%X) @%p %s out of memory\n",
+                         __func__, bytes, alignment, placement, this, name ());
+#endif
+          out_of_memory_handler_ ();
+
+          // If the handler returned, assume it freed some memory
+          // and try again to allocate.
+        }
+
+      internal_update_statistics_ ();
+
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+      if (mem != nullptr)
+        {
+          trace::printf ("multi_region::%s(%u,%u,0x%X)=%p @%p %s\n", __func__,
+                         bytes, alignment, placement, mem, this, name ());
+        }
+#endif
+
+      return mem;
+    }
+
+    /**
+     * @details
+     * Add the statistics of all backends. The peaks are computed
+     * on the sums, so they are lower or equal to the sums of the
+     * backend peaks.
+     */
+    void
+    multi_region::internal_update_statistics_ (void) noexcept
+    {
+      total_bytes_ = 0;
+      allocated_bytes_ = 0;
+      free_bytes_ = 0;
+      allocated_chunks_ = 0;
+      free_chunks_ = 0;
+
+      for (std::size_t i = 0; i < count_; ++i)
+        {
+          rtos::memory::memory_resource* resource = regions_[i].resource;
+
+          total_bytes_ += resource->total_bytes ();
+          allocated_bytes_ += resource->allocated_bytes ();
+          free_bytes_ += resource->free_bytes ();
+          allocated_chunks_ += resource->allocated_chunks ();
+          free_chunks_ += resource->free_chunks ();
+        }
+
+      if (allocated_bytes_ > max_allocated_bytes_)
+        {
+          max_allocated_bytes_ = allocated_bytes_;
+        }
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY)
+      if (allocated_chunks_ > max_allocated_chunks_)
+        {
+          max_allocated_chunks_ = allocated_chunks_;
+        }
+      if (free_bytes_ < min_free_bytes_)
+        {
+          min_free_bytes_ = free_bytes_;
+        }
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY) */
+    }
+
+    /**
+     * @details
+     * Allocate with the default hint given to the constructor.
+     *
+     * @par Exceptions
+     *   Throws nothing by itself, but the out of memory handler may
+     *   throw `bad_alloc()`.
+     */
+    void*
+    multi_region::do_allocate (std::size_t bytes, std::size_t alignment)
+    {
+      return internal_allocate_ (bytes, alignment, default_hint_, false);
+    }
+
+    /**
+     * @details
+     * Allocate with the default hint, and let the backend skip
+     * filling memory known to be zero.
+     */
+    void*
+    multi_region::do_allocate_zeroed (std::size_t bytes,
+                                      std::size_t alignment)
+    {
+      return internal_allocate_ (bytes, alignment, default_hint_, true);
+    }
+
+    /**
+     * @details
+     * The block is returned to the region containing it.
+     */
+    void
+    multi_region::do_deallocate (void* addr, std::size_t bytes,
+                                 std::size_t alignment) noexcept
+    {
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+      trace::printf ("multi_region::%s(%p,%u,%u) @%p %s\n", __func__, addr,
+                     bytes, alignment, this, name ());
+#endif
+
+      region_t* region = find_region (addr);
+      if (region == nullptr)
+        {
+          trace::printf ("multi_region::%s(%p,%u,%u) @%p %s nonsense\n",
+                         __func__, addr, bytes, alignment, this, name ());
+
+          assert(false);
+          return;
+        }
+
+      region->resource->deallocate (addr, bytes, alignment);
+
+      internal_update_statistics_ ();
+    }
+
+    /**
+     * @details
+     * First ask the region containing the block; if it cannot
+     * satisfy the request, even by moving the block inside the
+     * region, move it to another region.
+     */
+    void*
+    multi_region::do_reallocate (void* addr, std::size_t old_bytes,
+                                 std::size_t new_bytes, std::size_t alignment)
+    {
+      if (addr == nullptr)
+        {
+          return allocate (new_bytes, alignment);
+        }
+
+      region_t* region = find_region (addr);
+      assert(region != nullptr);
+
+      void* mem = region->resource->reallocate (addr, old_bytes, new_bytes,
+                                                alignment);
+      if (mem == nullptr)
+        {
+          mem = rtos::memory::memory_resource::do_reallocate (addr, old_bytes,
+                                                              new_bytes,
+                                                              alignment);
+        }
+
+      internal_update_statistics_ ();
+
+      return mem;
+    }
+
+    /**
+     * @details
+     * The largest block that can be served by any region.
+     */
+    std::size_t
+    multi_region::do_max_size (void) const noexcept
+    {
+      std::size_t bytes = 0;
+      for (std::size_t i = 0; i < count_; ++i)
+        {
+          bytes = rtos::memory::max (bytes, regions_[i].resource->max_size ());
+        }
+      return bytes;
+    }
+
+    /**
+     * @details
+     * Ask the regions, in order, until the budget is consumed.
+     */
+    std::size_t
+    multi_region::do_zero_free (std::size_t bytes) noexcept
+    {
+      std::size_t count = 0;
+      for (std::size_t i = 0; i < count_ && count < bytes; ++i)
+        {
+          count += regions_[i].resource->zero_free (bytes - count);
+        }
+      return count;
+    }
+
+    /**
+     * @details
+     * Reset all backends and the region statistics.
+     */
+    void
+    multi_region::do_reset (void) noexcept
+    {
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+      trace::printf ("multi_region::%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      for (std::size_t i = 0; i < count_; ++i)
+        {
+          regions_[i].resource->reset ();
+          regions_[i].fallbacks = 0;
+          regions_[i].failures = 0;
+        }
+
+      max_allocated_bytes_ = 0;
+      internal_update_statistics_ ();
+    }
+
+    /**
+     * @details
+     * Coalesce all backends.
+     */
+    bool
+    multi_region::do_coalesce (void) noexcept
+    {
+      bool ret = false;
+      for (std::size_t i = 0; i < count_; ++i)
+        {
+          if (regions_[i].resource->coalesce ())
+            {
+              ret = true;
+            }
+        }
+
+      internal_update_statistics_ ();
+
+      return ret;
+    }
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY)
+
+    /**
+     * @details
+     * The largest free chunk of all regions.
+     */
+    std::size_t
+    multi_region::do_largest_free_chunk (void) const noexcept
+    {
+      std::size_t bytes = 0;
+      for (std::size_t i = 0; i < count_; ++i)
+        {
+          bytes = rtos::memory::max (
+              bytes, regions_[i].resource->largest_free_chunk ());
+        }
+      return bytes;
+    }
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY) */
+
+    /**
+     * @details
+     * Print the statistics of this object, then, for each region,
+     * the hints, the fallback and failure counters, and the
+     * statistics of the backend.
+     */
+    void
+    multi_region::trace_print_regions (void)
+    {
+#if defined(TRACE)
+      trace_print_statistics ();
+
+      for (std::size_t i = 0; i < count_; ++i)
+        {
+          region_t& region = regions_[i];
+          trace::printf ("Region %u @%p, %u bytes, hints 0x%X, "
+                         "max block %u bytes, "
+                         "%u fallback(s), %u failure(s)\n",
+                         i, region.addr, region.bytes, region.hints,
+                         region.max_block_bytes, region.fallbacks,
+                         region.failures);
+          region.resource->trace_print_statistics ();
+        }
+#endif /* defined(TRACE) */
+    }
+
+  // --------------------------------------------------------------------------
+  } /* namespace memory */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,551 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <cmsis-plus/memory/segregated-fit.h>
+#include <memory>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace memory
+  {
+
+    // ========================================================================
+
+    /**
+     * @details
+     */
+    segregated_fit::~segregated_fit ()
+    {
+      trace::printf ("segregated_fit::%s() @%p %s\n", __func__, this, name ());
+    }
+
+    /**
+     * @details
+     */
+    void
+    segregated_fit::internal_construct_ (void* addr, std::size_t bytes)
+    {
+      assert(bytes > chunk_minsize + sizeof(std::size_t));
+
+      arena_addr_ = addr;
+      total_bytes_ = bytes;
+
+      // Align address for first chunk.
+      void* res;
+      // Possibly adjust the last two parameters.
+      res = std::align (chunk_align, chunk_minsize, arena_addr_, total_bytes_);
+      // std::align() will fail if it cannot fit the min chunk.
+      if (res == nullptr)
+        {
+          assert(res != nullptr);
+        }
+
+      // Chunk sizes must be multiple of the alignment, to keep
+      // the flags bits free; drop the last incomplete word.
+      total_bytes_ &= ~(chunk_align - 1);
+
+      internal_reset_ ();
+    }
+
+    /**
+     * @details
+     * The arena is initialised with one large free chunk, followed
+     * by a header marked as used, which stops the coalescing
+     * at the end of the arena.
+     */
+    void
+    segregated_fit::internal_reset_ (void) noexcept
+    {
+      for (std::size_t i = 0; i < classes; ++i)
+        {
+          free_lists_[i] = nullptr;
+        }
+      bitmap_ = 0;
+
+      // The last word is reserved for the end marker.
+      std::size_t size = total_bytes_ - sizeof(std::size_t);
+
+      // Fill it with the first chunk.
+      chunk_t* chunk = reinterpret_cast<chunk_t*> (arena_addr_);
+      // There is nothing before the first chunk to coalesce with.
+      chunk->head = size | chunk_prev_used;
+      // Set the footer.
+      *reinterpret_cast<std::size_t*> (reinterpret_cast<char*> (chunk) + size
+          - sizeof(std::size_t)) = size;
+
+      // The end marker, an empty used chunk.
+      reinterpret_cast<chunk_t*> (reinterpret_cast<char*> (chunk) + size)->head =
+          chunk_used;
+
+      internal_link_ (chunk, size);
+
+      allocated_bytes_ = 0;
+      max_allocated_bytes_ = 0;
+      free_bytes_ = size;
+      allocated_chunks_ = 0;
+      free_chunks_ = 1;
+    }
+
+    /**
+     * @details
+     */
+    void
+    segregated_fit::do_reset (void) noexcept
+    {
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+      trace::printf ("segregated_fit::%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      internal_reset_ ();
+    }
+
+    /**
+     * @details
+     * The size class is the index of the most significant bit;
+     * class `i` keeps chunks with sizes between `2^i`
+     * and `2^(i+1)-1`.
+     */
+    std::size_t
+    segregated_fit::internal_class_ (std::size_t size) noexcept
+    {
+      return (classes - 1)
+          - static_cast<std::size_t> (__builtin_clzl (
+              static_cast<unsigned long> (size)));
+    }
+
+    /**
+     * @details
+     * The chunk is added at the beginning of the list,
+     * the header and the footer are not changed.
+     */
+    void
+    segregated_fit::internal_link_ (chunk_t* chunk, std::size_t size) noexcept
+    {
+      std::size_t cls = internal_class_ (size);
+
+      chunk->prev = nullptr;
+      chunk->next = free_lists_[cls];
+      if (chunk->next != nullptr)
+        {
+          chunk->next->prev = chunk;
+        }
+      free_lists_[cls] = chunk;
+
+      bitmap_ |= (static_cast<std::size_t> (1) << cls);
+    }
+
+    /**
+     * @details
+     */
+    void
+    segregated_fit::internal_unlink_ (chunk_t* chunk) noexcept
+    {
+      std::size_t cls = internal_class_ (chunk->head & ~chunk_flags);
+
+      if (chunk->prev != nullptr)
+        {
+          chunk->prev->next = chunk->next;
+        }
+      else
+        {
+          free_lists_[cls] = chunk->next;
+        }
+      if (chunk->next != nullptr)
+        {
+          chunk->next->prev = chunk->prev;
+        }
+
+      if (free_lists_[cls] == nullptr)
+        {
+          bitmap_ &= ~(static_cast<std::size_t> (1) << cls);
+        }
+    }
+
+    /**
+     * @details
+     * For sizes which are powers of two, any chunk in the
+     * same class fits; otherwise the first chunk is taken from
+     * the next non-empty larger class, as given by the bitmap.
+     *
+     * Only if there are no larger chunks, the chunks in the same
+     * class are checked one by one, since they may be smaller.
+     */
+    segregated_fit::chunk_t*
+    segregated_fit::internal_find_ (std::size_t size) noexcept
+    {
+      std::size_t cls = internal_class_ (size);
+
+      if ((size & (size - 1)) == 0 && free_lists_[cls] != nullptr)
+        {
+          return free_lists_[cls];
+        }
+
+      if (cls < classes - 1)
+        {
+          std::size_t mask = bitmap_
+              & ~((static_cast<std::size_t> (2) << cls) - 1);
+          if (mask != 0)
+            {
+              return free_lists_[__builtin_ctzl (
+                  static_cast<unsigned long> (mask))];
+            }
+        }
+
+      for (chunk_t* chunk = free_lists_[cls]; chunk != nullptr;
+          chunk = chunk->next)
+        {
+          if ((chunk->head & ~chunk_flags) >= size)
+            {
+              return chunk;
+            }
+        }
+
+      return nullptr;
+    }
+
+#pragma GCC diagnostic push
+// Needed because 'alignment' is used only in trace calls.
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+    /**
+     * @details
+     * The free chunk is identified with a lookup in the size
+     * class bitmap; if it is larger than required, it is split,
+     * and the remaining chunk is added to the list of its
+     * size class.
+     *
+     * @par Exceptions
+     *   Throws nothing by itself, but the out of memory handler may
+     *   throw `bad_alloc()`.
+     */
+    void*
+    segregated_fit::do_allocate (std::size_t bytes, std::size_t alignment)
+    {
+      std::size_t block_padding = calc_block_padding (alignment);
+      std::size_t alloc_size = rtos::memory::align_size (bytes, chunk_align);
+      alloc_size += block_padding;
+      alloc_size += chunk_offset;
+
+      alloc_size = os::rtos::memory::max (alloc_size, chunk_minsize);
+
+      chunk_t* chunk;
+
+      while (true)
+        {
+          chunk = internal_find_ (alloc_size);
+          if (chunk != nullptr)
+            {
+              break;
+            }
+
+#if defined(OS_INCLUDE_RTOS_MEMORY_RECLAIM)
+          if (reclaim (bytes) != 0)
+            {
+              // Some cache released memory, try again to allocate.
+              continue;
+            }
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_RECLAIM) */
+
+          if (out_of_memory_handler_ == nullptr)
+            {
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+              trace::printf ("segregated_fit::%s(%u,%u)=0 @%p %s\n", __func__,
+                             bytes, alignment, this, name ());
+#endif
+
+              return nullptr;
+            }
+
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+          trace::printf ("segregated_fit::%s(%u,%u) @%p %s out of memory\n",
+                         __func__, bytes, alignment, this, name ());
+#endif
+          out_of_memory_handler_ ();
+
+          // If the handler returned, assume it freed some memory
+          // and try again to allocate.
+        }
+
+      internal_unlink_ (chunk);
+
+      std::size_t size = chunk->head & ~chunk_flags;
+      std::size_t rem = size - alloc_size;
+      if (rem >= chunk_minsize)
+        {
+          // Found a chunk that is much larger than required size
+          // (at least one more chunk is available);
+          // break it into two chunks and keep the second one free.
+          chunk->head = alloc_size | (chunk->head & chunk_prev_used)
+              | chunk_used;
+
+          chunk_t* rest =
+              reinterpret_cast<chunk_t *> (reinterpret_cast<char *> (chunk)
+                  + alloc_size);
+          rest->head = rem | chunk_prev_used;
+          *reinterpret_cast<std::size_t*> (reinterpret_cast<char*> (rest) + rem
+              - sizeof(std::size_t)) = rem;
+          internal_link_ (rest, rem);
+
+          // Splitting one chunk creates one more chunk.
+          ++free_chunks_;
+        }
+      else
+        {
+          // Found a chunk that is exactly the size or slightly
+          // larger than the requested size; return this chunk.
+          chunk->head |= chunk_used;
+
+          reinterpret_cast<chunk_t *> (reinterpret_cast<char *> (chunk) + size)->head |=
+              chunk_prev_used;
+        }
+
+      void* aligned_payload = internal_align_ (chunk, bytes, alignment);
+
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+      trace::printf ("segregated_fit::%s(%u,%u)=%p,%u @%p %s\n", __func__,
+                     bytes, alignment, aligned_payload, alloc_size, this,
+                     name ());
+#endif
+
+      return aligned_payload;
+    }
+
+    /**
+     * @details
+     * Deallocation is deterministic; the boundary tags give direct
+     * access to the neighbour chunks, and if they are free, they
+     * are removed from their lists and merged with the deallocated
+     * chunk, before adding it to the list of its size class.
+     *
+     * If the block is already free, issue a trace message,
+     * but otherwise ignore the condition.
+     *
+     * @par Exceptions
+     *   Throws nothing.
+     */
+    void
+    segregated_fit::do_deallocate (void* addr, std::size_t bytes,
+                                   std::size_t alignment) noexcept
+    {
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+      trace::printf ("segregated_fit::%s(%p,%u,%u) @%p %s\n", __func__, addr,
+                     bytes, alignment, this, name ());
+#endif
+
+      // The address must be inside the arena; no exceptions.
+      if ((addr < arena_addr_)
+          || (addr > (static_cast<char*> (arena_addr_) + total_bytes_)))
+        {
+          assert(false);
+          return;
+        }
+
+      // Compute the chunk address from the user address.
+      chunk_t* chunk = reinterpret_cast<chunk_t *> (static_cast<char *> (addr)
+          - chunk_offset);
+
+      // If the block was aligned, the offset appears as size; adjust back.
+      if (static_cast<std::ptrdiff_t> (chunk->head) < 0)
+        {
+          chunk = reinterpret_cast<chunk_t *> (reinterpret_cast<char *> (chunk)
+              + static_cast<std::ptrdiff_t> (chunk->head));
+        }
+
+      if ((chunk->head & chunk_used) == 0)
+        {
+          // Already freed.
+          trace::printf ("segregated_fit::%s(%p,%u,%u) @%p %s already freed\n",
+                         __func__, addr, bytes, alignment, this, name ());
+
+          return;
+        }
+
+      std::size_t size = chunk->head & ~chunk_flags;
+
+      if (bytes)
+        {
+          // If size is known, validate.
+          // (when called from free(), the size is not known).
+          if (bytes + chunk_offset > size)
+            {
+              assert(false);
+              return;
+            }
+        }
+
+      // Update statistics.
+      // What is subtracted from allocated is added to free.
+      internal_decrease_allocated_statistics (size);
+
+      // Is the next chunk free? Does not match the end marker.
+      chunk_t* next_chunk =
+          reinterpret_cast<chunk_t *> (reinterpret_cast<char *> (chunk) + size);
+      if ((next_chunk->head & chunk_used) == 0)
+        {
+          internal_unlink_ (next_chunk);
+          size += next_chunk->head & ~chunk_flags;
+
+          // Coalescing means one less chunk.
+          --free_chunks_;
+        }
+
+      // Is the previous chunk free? Its footer is right before the header.
+      if ((chunk->head & chunk_prev_used) == 0)
+        {
+          std::size_t prev_size =
+              *(reinterpret_cast<std::size_t*> (chunk) - 1);
+          chunk_t* prev_chunk =
+              reinterpret_cast<chunk_t *> (reinterpret_cast<char *> (chunk)
+                  - prev_size);
+          internal_unlink_ (prev_chunk);
+          size += prev_size;
+          chunk = prev_chunk;
+
+          // Coalescing means one less chunk.
+          --free_chunks_;
+        }
+
+      // Free chunks are always coalesced, so the previous
+      // chunk is in use.
+      chunk->head = size | chunk_prev_used;
+      *reinterpret_cast<std::size_t*> (reinterpret_cast<char*> (chunk) + size
+          - sizeof(std::size_t)) = size;
+      internal_link_ (chunk, size);
+
+      reinterpret_cast<chunk_t *> (reinterpret_cast<char *> (chunk) + size)->head &=
+          ~chunk_prev_used;
+    }
+
+    /**
+     * @details
+     * The largest block is the payload of the initial
+     * chunk, covering the entire arena.
+     */
+    std::size_t
+    segregated_fit::do_max_size (void) const noexcept
+    {
+      return total_bytes_ - sizeof(std::size_t) - chunk_offset;
+    }
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY)
+
+    /**
+     * @details
+     * The largest chunk is in the highest non-empty class; walk
+     * only that list, since a class covers a range of sizes.
+     */
+    std::size_t
+    segregated_fit::do_largest_free_chunk (void) const noexcept
+    {
+      std::size_t bytes = 0;
+      for (std::size_t cls = classes; cls > 0; --cls)
+        {
+          if ((bitmap_ & (static_cast<std::size_t> (1) << (cls - 1))) == 0)
+            {
+              continue;
+            }
+          for (chunk_t* chunk = free_lists_[cls - 1]; chunk != nullptr;
+              chunk = chunk->next)
+            {
+              bytes = os::rtos::memory::max (bytes,
+                                             chunk->head & ~chunk_flags);
+            }
+          break;
+        }
+      return bytes;
+    }
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY) */
+
+    /**
+     * @details
+     * Free chunks are coalesced during deallocation, so there
+     * is nothing left to do.
+     */
+    bool
+    segregated_fit::do_coalesce (void) noexcept
+    {
+      return false;
+    }
+
+    /**
+     * @details
+     */
+    void*
+    segregated_fit::internal_align_ (chunk_t* chunk, std::size_t bytes,
+                                     std::size_t alignment)
+    {
+      std::size_t size = chunk->head & ~chunk_flags;
+
+      // Update statistics.
+      // The value subtracted from free is added to allocated.
+      internal_increase_allocated_statistics (size);
+
+      // Compute pointer to payload area.
+      char* payload = reinterpret_cast<char *> (chunk) + chunk_offset;
+
+      // Align it to user provided alignment.
+      void* aligned_payload = payload;
+      std::size_t aligned_size = size - chunk_offset;
+
+      void* res;
+      res = std::align (alignment, bytes, aligned_payload, aligned_size);
+      if (res == nullptr)
+        {
+          assert(res != nullptr);
+        }
+
+      // Compute the possible alignment offset.
+      std::ptrdiff_t offset = static_cast<char *> (aligned_payload) - payload;
+      if (offset)
+        {
+          // If non-zero, store it in the gap left by alignment in the
+          // chunk header.
+
+          chunk_t* adj_chunk =
+              reinterpret_cast<chunk_t *> (static_cast<char *> (aligned_payload)
+                  - chunk_offset);
+          adj_chunk->head = static_cast<std::size_t> (-offset);
+        }
+
+      assert(
+          (reinterpret_cast<uintptr_t> (aligned_payload) & (alignment - 1))
+              == 0);
+
+      return aligned_payload;
+    }
+
+#pragma GCC diagnostic pop
+
+  // --------------------------------------------------------------------------
+  } /* namespace memory */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,723 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <cmsis-plus/memory/tlsf.h>
+#include <memory>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace memory
+  {
+
+    // ========================================================================
+
+    namespace
+    {
+      // Index of the most significant bit.
+      inline std::size_t
+      floor_log2 (std::size_t n)
+      {
+        return (sizeof(unsigned long) * 8 - 1)
+            - static_cast<std::size_t> (__builtin_clzl (
+                static_cast<unsigned long> (n)));
+      }
+
+      // Index of the least significant bit.
+      inline std::size_t
+      lowest_bit (std::size_t n)
+      {
+        return static_cast<std::size_t> (__builtin_ctzl (
+            static_cast<unsigned long> (n)));
+      }
+    } /* namespace */
+
+    /**
+     * @details
+     */
+    tlsf::~tlsf ()
+    {
+      trace::printf ("tlsf::%s() @%p %s\n", __func__, this, name ());
+    }
+
+    /**
+     * @details
+     */
+    void
+    tlsf::internal_construct_ (void* addr, std::size_t bytes)
+    {
+      arena_addr_ = addr;
+      arena_bytes_ = bytes;
+
+      regions_ = nullptr;
+      add_region (addr, bytes);
+    }
+
+    /**
+     * @details
+     * The region is aligned and added to the list of regions; its
+     * chunk is added to the free lists, and the statistics are
+     * updated accordingly.
+     *
+     * Regions may be added at any time, but the call is not
+     * protected against concurrent allocations; if needed,
+     * use the same lock as for allocations.
+     *
+     * Chunks larger than 4 GB are not possible, the excess
+     * is ignored.
+     */
+    void
+    tlsf::add_region (void* addr, std::size_t bytes)
+    {
+      trace::printf ("tlsf::%s(%p,%u) @%p %s\n", __func__, addr, bytes, this,
+                     name ());
+
+      assert(bytes > sizeof(region_t) + chunk_minsize + sizeof(std::size_t));
+
+      // Align address for the region header.
+      void* res;
+      // Possibly adjust the last two parameters.
+      res = std::align (chunk_align,
+                        sizeof(region_t) + chunk_minsize + sizeof(std::size_t),
+                        addr, bytes);
+      // std::align() will fail if it cannot fit the min chunk.
+      if (res == nullptr)
+        {
+          assert(res != nullptr);
+          return;
+        }
+
+      // Chunk sizes must be multiple of the alignment, to keep
+      // the flags bits free; drop the last incomplete word.
+      constexpr std::size_t max_bytes = (((static_cast<std::size_t> (1)
+          << (fl_index_max - 1)) - 1) * 2 + 1) & ~(chunk_align - 1);
+      bytes &= ~(chunk_align - 1);
+      if (bytes > max_bytes)
+        {
+          bytes = max_bytes;
+        }
+
+      region_t* region = static_cast<region_t*> (addr);
+      region->bytes = bytes;
+      region->next = regions_;
+
+      if (regions_ == nullptr)
+        {
+          // The very first region, clear everything.
+          regions_ = region;
+          internal_reset_ ();
+        }
+      else
+        {
+          regions_ = region;
+          internal_init_region_ (region);
+        }
+    }
+
+    /**
+     * @details
+     * All regions are reinitialised, each with one large free chunk.
+     */
+    void
+    tlsf::internal_reset_ (void) noexcept
+    {
+      fl_bitmap_ = 0;
+      for (std::size_t i = 0; i < fl_index_count; ++i)
+        {
+          sl_bitmaps_[i] = 0;
+          for (std::size_t j = 0; j < sl_index_count; ++j)
+            {
+              free_lists_[i][j] = nullptr;
+            }
+        }
+
+      total_bytes_ = 0;
+      allocated_bytes_ = 0;
+      max_allocated_bytes_ = 0;
+      free_bytes_ = 0;
+      allocated_chunks_ = 0;
+      free_chunks_ = 0;
+
+      for (region_t* region = regions_; region != nullptr;
+          region = region->next)
+        {
+          internal_init_region_ (region);
+        }
+    }
+
+    /**
+     * @details
+     * The region is filled with one large free chunk, followed
+     * by a header marked as used, which stops the coalescing
+     * at the end of the region.
+     */
+    void
+    tlsf::internal_init_region_ (region_t* region) noexcept
+    {
+      // The region header and the end marker are not available.
+      std::size_t size = region->bytes - sizeof(region_t)
+          - sizeof(std::size_t);
+
+      chunk_t* chunk =
+          reinterpret_cast<chunk_t*> (reinterpret_cast<char*> (region)
+              + sizeof(region_t));
+      // There is nothing before the first chunk to coalesce with.
+      chunk->head = size | chunk_prev_used;
+      // Set the footer.
+      *reinterpret_cast<std::size_t*> (reinterpret_cast<char*> (chunk) + size
+          - sizeof(std::size_t)) = size;
+
+      // The end marker, an empty used chunk.
+      reinterpret_cast<chunk_t*> (reinterpret_cast<char*> (chunk) + size)->head =
+          chunk_used;
+
+      internal_link_ (chunk, size);
+
+      total_bytes_ += region->bytes;
+      free_bytes_ += size;
+      ++free_chunks_;
+    }
+
+    /**
+     * @details
+     */
+    void
+    tlsf::do_reset (void) noexcept
+    {
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+      trace::printf ("tlsf::%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      internal_reset_ ();
+    }
+
+    /**
+     * @details
+     * Sizes below `small_size` go to the first level list 0,
+     * indexed linearly. Larger sizes go to the list of their
+     * power of two class, and the second level index is given
+     * by the next `sl_index_bits` after the most significant bit.
+     */
+    void
+    tlsf::internal_mapping_ (std::size_t size, std::size_t& fl,
+                             std::size_t& sl) noexcept
+    {
+      if (size < small_size)
+        {
+          fl = 0;
+          sl = size;
+        }
+      else
+        {
+          std::size_t msb = floor_log2 (size);
+          fl = msb - sl_index_bits + 1;
+          sl = (size >> (msb - sl_index_bits)) ^ sl_index_count;
+        }
+    }
+
+    /**
+     * @details
+     * The chunk is added at the beginning of the list,
+     * the header and the footer are not changed.
+     */
+    void
+    tlsf::internal_link_ (chunk_t* chunk, std::size_t size) noexcept
+    {
+      std::size_t fl;
+      std::size_t sl;
+      internal_mapping_ (size, fl, sl);
+
+      chunk->prev = nullptr;
+      chunk->next = free_lists_[fl][sl];
+      if (chunk->next != nullptr)
+        {
+          chunk->next->prev = chunk;
+        }
+      free_lists_[fl][sl] = chunk;
+
+      fl_bitmap_ |= (static_cast<std::size_t> (1) << fl);
+      sl_bitmaps_[fl] |= (1u << sl);
+    }
+
+    /**
+     * @details
+     */
+    void
+    tlsf::internal_unlink_ (chunk_t* chunk) noexcept
+    {
+      std::size_t fl;
+      std::size_t sl;
+      internal_mapping_ (chunk->head & ~chunk_flags, fl, sl);
+
+      if (chunk->prev != nullptr)
+        {
+          chunk->prev->next = chunk->next;
+        }
+      else
+        {
+          free_lists_[fl][sl] = chunk->next;
+        }
+      if (chunk->next != nullptr)
+        {
+          chunk->next->prev = chunk->prev;
+        }
+
+      if (free_lists_[fl][sl] == nullptr)
+        {
+          sl_bitmaps_[fl] &= ~(1u << sl);
+          if (sl_bitmaps_[fl] == 0)
+            {
+              fl_bitmap_ &= ~(static_cast<std::size_t> (1) << fl);
+            }
+        }
+    }
+
+    /**
+     * @details
+     * The size is rounded up to the beginning of the next
+     * second level range, so any chunk in the lists at or
+     * above the resulting indices is large enough, and the
+     * first one is taken; the search uses only the bitmaps,
+     * and takes a constant time.
+     *
+     * If there are no such chunks, the first chunk in the list
+     * of the requested size may still be large enough.
+     */
+    tlsf::chunk_t*
+    tlsf::internal_find_ (std::size_t size) noexcept
+    {
+      std::size_t fl;
+      std::size_t sl;
+
+      std::size_t rounded_size = size;
+      if (size >= small_size)
+        {
+          rounded_size += (static_cast<std::size_t> (1)
+              << (floor_log2 (size) - sl_index_bits)) - 1;
+        }
+
+      internal_mapping_ (rounded_size, fl, sl);
+      if (fl >= fl_index_count)
+        {
+          return internal_find_exact_ (size);
+        }
+
+      // Search the second level lists of the same class.
+      uint32_t sl_map = sl_bitmaps_[fl] & (~0u << sl);
+      if (sl_map == 0)
+        {
+          // Search the next non-empty class.
+          std::size_t fl_map = fl_bitmap_
+              & ~((static_cast<std::size_t> (2) << fl) - 1);
+          if (fl_map == 0)
+            {
+              return internal_find_exact_ (size);
+            }
+
+          fl = lowest_bit (fl_map);
+          sl_map = sl_bitmaps_[fl];
+        }
+
+      return free_lists_[fl][lowest_bit (sl_map)];
+    }
+
+    /**
+     * @details
+     * Only the first chunk in the list is checked, to keep the
+     * search time constant.
+     */
+    tlsf::chunk_t*
+    tlsf::internal_find_exact_ (std::size_t size) noexcept
+    {
+      std::size_t fl;
+      std::size_t sl;
+      internal_mapping_ (size, fl, sl);
+      if (fl >= fl_index_count)
+        {
+          return nullptr;
+        }
+
+      chunk_t* chunk = free_lists_[fl][sl];
+      if (chunk != nullptr && (chunk->head & ~chunk_flags) >= size)
+        {
+          return chunk;
+        }
+
+      return nullptr;
+    }
+
+#pragma GCC diagnostic push
+// Needed because 'alignment' is used only in trace calls.
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+    /**
+     * @details
+     * The free chunk is identified with a lookup in the two
+     * levels of bitmaps; if it is larger than required, it is split,
+     * and the remaining chunk is added to its list.
+     *
+     * @par Exceptions
+     *   Throws nothing by itself, but the out of memory handler may
+     *   throw `bad_alloc()`.
+     */
+    void*
+    tlsf::do_allocate (std::size_t bytes, std::size_t alignment)
+    {
+      std::size_t block_padding = calc_block_padding (alignment);
+      std::size_t alloc_size = rtos::memory::align_size (bytes, chunk_align);
+      alloc_size += block_padding;
+      alloc_size += chunk_offset;
+
+      alloc_size = os::rtos::memory::max (alloc_size, chunk_minsize);
+
+      chunk_t* chunk;
+
+      while (true)
+        {
+          chunk = internal_find_ (alloc_size);
+          if (chunk != nullptr)
+            {
+              break;
+            }
+
+#if defined(OS_INCLUDE_RTOS_MEMORY_RECLAIM)
+          if (reclaim (bytes) != 0)
+            {
+              // Some cache released memory, try again to allocate.
+              continue;
+            }
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_RECLAIM) */
+
+          if (out_of_memory_handler_ == nullptr)
+            {
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+              trace::printf ("tlsf::%s(%u,%u)=0 @%p %s\n", __func__, bytes,
+                             alignment, this, name ());
+#endif
+
+              return nullptr;
+            }
+
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+          trace::printf ("tlsf::%s(%u,%u) @%p %s out of memory\n", __func__,
+                         bytes, alignment, this, name ());
+#endif
+          out_of_memory_handler_ ();
+
+          // If the handler returned, assume it freed some memory
+          // and try again to allocate.
+        }
+
+      internal_unlink_ (chunk);
+
+      std::size_t size = chunk->head & ~chunk_flags;
+      std::size_t rem = size - alloc_size;
+      if (rem >= chunk_minsize)
+        {
+          // Found a chunk that is much larger than required size
+          // (at least one more chunk is available);
+          // break it into two chunks and keep the second one free.
+          chunk->head = alloc_size | (chunk->head & chunk_prev_used)
+              | chunk_used;
+
+          chunk_t* rest =
+              reinterpret_cast<chunk_t *> (reinterpret_cast<char *> (chunk)
+                  + alloc_size);
+          rest->head = rem | chunk_prev_used;
+          *reinterpret_cast<std::size_t*> (reinterpret_cast<char*> (rest) + rem
+              - sizeof(std::size_t)) = rem;
+          internal_link_ (rest, rem);
+
+          // Splitting one chunk creates one more chunk.
+          ++free_chunks_;
+        }
+      else
+        {
+          // Found a chunk that is exactly the size or slightly
+          // larger than the requested size; return this chunk.
+          chunk->head |= chunk_used;
+
+          reinterpret_cast<chunk_t *> (reinterpret_cast<char *> (chunk) + size)->head |=
+              chunk_prev_used;
+        }
+
+      void* aligned_payload = internal_align_ (chunk, bytes, alignment);
+
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+      trace::printf ("tlsf::%s(%u,%u)=%p,%u @%p %s\n", __func__, bytes,
+                     alignment, aligned_payload, alloc_size, this, name ());
+#endif
+
+      return aligned_payload;
+    }
+
+    /**
+     * @details
+     * Deallocation takes a constant time; the boundary tags give
+     * direct access to the neighbour chunks, and if they are free,
+     * they are removed from their lists and merged with the
+     * deallocated chunk, before adding it to its list.
+     *
+     * If the block is already free, issue a trace message,
+     * but otherwise ignore the condition.
+     *
+     * @par Exceptions
+     *   Throws nothing.
+     */
+    void
+    tlsf::do_deallocate (void* addr, std::size_t bytes,
+                         std::size_t alignment) noexcept
+    {
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+      trace::printf ("tlsf::%s(%p,%u,%u) @%p %s\n", __func__, addr, bytes,
+                     alignment, this, name ());
+#endif
+
+#if !defined(NDEBUG)
+      // The address must be inside one of the regions; the search
+      // is not needed for the algorithm, so it is done only
+      // in debug builds.
+      region_t* region;
+      for (region = regions_; region != nullptr; region = region->next)
+        {
+          if ((addr > region)
+              && (addr < (reinterpret_cast<char*> (region) + region->bytes)))
+            {
+              break;
+            }
+        }
+      if (region == nullptr)
+        {
+          assert(false);
+          return;
+        }
+#endif
+
+      // Compute the chunk address from the user address.
+      chunk_t* chunk = reinterpret_cast<chunk_t *> (static_cast<char *> (addr)
+          - chunk_offset);
+
+      // If the block was aligned, the offset appears as size; adjust back.
+      if (static_cast<std::ptrdiff_t> (chunk->head) < 0)
+        {
+          chunk = reinterpret_cast<chunk_t *> (reinterpret_cast<char *> (chunk)
+              + static_cast<std::ptrdiff_t> (chunk->head));
+        }
+
+      if ((chunk->head & chunk_used) == 0)
+        {
+          // Already freed.
+          trace::printf ("tlsf::%s(%p,%u,%u) @%p %s already freed\n", __func__,
+                         addr, bytes, alignment, this, name ());
+
+          return;
+        }
+
+      std::size_t size = chunk->head & ~chunk_flags;
+
+      if (bytes)
+        {
+          // If size is known, validate.
+          // (when called from free(), the size is not known).
+          if (bytes + chunk_offset > size)
+            {
+              assert(false);
+              return;
+            }
+        }
+
+      // Update statistics.
+      // What is subtracted from allocated is added to free.
+      internal_decrease_allocated_statistics (size);
+
+      // Is the next chunk free? Does not match the end marker.
+      chunk_t* next_chunk =
+          reinterpret_cast<chunk_t *> (reinterpret_cast<char *> (chunk) + size);
+      if ((next_chunk->head & chunk_used) == 0)
+        {
+          internal_unlink_ (next_chunk);
+          size += next_chunk->head & ~chunk_flags;
+
+          // Coalescing means one less chunk.
+          --free_chunks_;
+        }
+
+      // Is the previous chunk free? Its footer is right before the header.
+      if ((chunk->head & chunk_prev_used) == 0)
+        {
+          std::size_t prev_size =
+              *(reinterpret_cast<std::size_t*> (chunk) - 1);
+          chunk_t* prev_chunk =
+              reinterpret_cast<chunk_t *> (reinterpret_cast<char *> (chunk)
+                  - prev_size);
+          internal_unlink_ (prev_chunk);
+          size += prev_size;
+          chunk = prev_chunk;
+
+          // Coalescing means one less chunk.
+          --free_chunks_;
+        }
+
+      // Free chunks are always coalesced, so the previous
+      // chunk is in use.
+      chunk->head = size | chunk_prev_used;
+      *reinterpret_cast<std::size_t*> (reinterpret_cast<char*> (chunk) + size
+          - sizeof(std::size_t)) = size;
+      internal_link_ (chunk, size);
+
+      reinterpret_cast<chunk_t *> (reinterpret_cast<char *> (chunk) + size)->head &=
+          ~chunk_prev_used;
+    }
+
+    /**
+     * @details
+     * The largest block is the payload of the chunk covering
+     * the largest region.
+     */
+    std::size_t
+    tlsf::do_max_size (void) const noexcept
+    {
+      std::size_t bytes = 0;
+      for (region_t* region = regions_; region != nullptr;
+          region = region->next)
+        {
+          bytes = os::rtos::memory::max (bytes, region->bytes);
+        }
+
+      if (bytes == 0)
+        {
+          return 0;
+        }
+      return bytes - sizeof(region_t) - sizeof(std::size_t) - chunk_offset;
+    }
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY)
+
+    /**
+     * @details
+     * The largest chunk is in the highest non-empty second level
+     * list of the highest non-empty first level; walk only that
+     * list, since it covers a range of sizes.
+     */
+    std::size_t
+    tlsf::do_largest_free_chunk (void) const noexcept
+    {
+      std::size_t bytes = 0;
+      for (std::size_t fl = fl_index_count; fl > 0; --fl)
+        {
+          if ((fl_bitmap_ & (static_cast<std::size_t> (1) << (fl - 1))) == 0)
+            {
+              continue;
+            }
+          for (std::size_t sl = sl_index_count; sl > 0; --sl)
+            {
+              if ((sl_bitmaps_[fl - 1] & (1u << (sl - 1))) == 0)
+                {
+                  continue;
+                }
+              for (chunk_t* chunk = free_lists_[fl - 1][sl - 1];
+                  chunk != nullptr; chunk = chunk->next)
+                {
+                  bytes = os::rtos::memory::max (bytes,
+                                                 chunk->head & ~chunk_flags);
+                }
+              break;
+            }
+          break;
+        }
+      return bytes;
+    }
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY) */
+
+    /**
+     * @details
+     * Free chunks are coalesced during deallocation, so there
+     * is nothing left to do.
+     */
+    bool
+    tlsf::do_coalesce (void) noexcept
+    {
+      return false;
+    }
+
+    /**
+     * @details
+     */
+    void*
+    tlsf::internal_align_ (chunk_t* chunk, std::size_t bytes,
+                           std::size_t alignment)
+    {
+      std::size_t size = chunk->head & ~chunk_flags;
+
+      // Update statistics.
+      // The value subtracted from free is added to allocated.
+      internal_increase_allocated_statistics (size);
+
+      // Compute pointer to payload area.
+      char* payload = reinterpret_cast<char *> (chunk) + chunk_offset;
+
+      // Align it to user provided alignment.
+      void* aligned_payload = payload;
+      std::size_t aligned_size = size - chunk_offset;
+
+      void* res;
+      res = std::align (alignment, bytes, aligned_payload, aligned_size);
+      if (res == nullptr)
+        {
+          assert(res != nullptr);
+        }
+
+      // Compute the possible alignment offset.
+      std::ptrdiff_t offset = static_cast<char *> (aligned_payload) - payload;
+      if (offset)
+        {
+          // If non-zero, store it in the gap left by alignment in the
+          // chunk header.
+
+          chunk_t* adj_chunk =
+              reinterpret_cast<chunk_t *> (static_cast<char *> (aligned_payload)
+                  - chunk_offset);
+          adj_chunk->head = static_cast<std::size_t> (-offset);
+        }
+
+      assert(
+          (reinterpret_cast<uintptr_t> (aligned_payload) & (alignment - 1))
+              == 0);
+
+      return aligned_payload;
+    }
+
+#pragma GCC diagnostic pop
+
+  // --------------------------------------------------------------------------
+  } /* namespace memory */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
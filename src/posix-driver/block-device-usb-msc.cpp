@@ -0,0 +1,449 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <cmsis-plus/posix-driver/block-device-usb-msc.h>
+
+#include <cmsis-plus/diag/trace.h>
+
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+  // Bulk-Only Transport signatures, little endian.
+  constexpr uint32_t cbw_signature = 0x43425355; // "USBC"
+  constexpr uint32_t csw_signature = 0x53425355; // "USBS"
+
+  // SCSI commands.
+  constexpr uint8_t scsi_test_unit_ready = 0x00;
+  constexpr uint8_t scsi_request_sense = 0x03;
+  constexpr uint8_t scsi_read_capacity_10 = 0x25;
+  constexpr uint8_t scsi_read_10 = 0x28;
+  constexpr uint8_t scsi_write_10 = 0x2A;
+  constexpr uint8_t scsi_synchronize_cache_10 = 0x35;
+
+  // Devices report UNIT ATTENTION for the first commands.
+  constexpr int ready_attempts = 5;
+
+  inline void
+  put_le32 (uint8_t* p, uint32_t v)
+  {
+    p[0] = static_cast<uint8_t> (v);
+    p[1] = static_cast<uint8_t> (v >> 8);
+    p[2] = static_cast<uint8_t> (v >> 16);
+    p[3] = static_cast<uint8_t> (v >> 24);
+  }
+
+  inline uint32_t
+  get_le32 (const uint8_t* p)
+  {
+    return static_cast<uint32_t> (p[0]) | (static_cast<uint32_t> (p[1]) << 8)
+        | (static_cast<uint32_t> (p[2]) << 16)
+        | (static_cast<uint32_t> (p[3]) << 24);
+  }
+
+  inline void
+  put_be32 (uint8_t* p, uint32_t v)
+  {
+    p[0] = static_cast<uint8_t> (v >> 24);
+    p[1] = static_cast<uint8_t> (v >> 16);
+    p[2] = static_cast<uint8_t> (v >> 8);
+    p[3] = static_cast<uint8_t> (v);
+  }
+
+  inline uint32_t
+  get_be32 (const uint8_t* p)
+  {
+    return (static_cast<uint32_t> (p[0]) << 24)
+        | (static_cast<uint32_t> (p[1]) << 16)
+        | (static_cast<uint32_t> (p[2]) << 8) | static_cast<uint32_t> (p[3]);
+  }
+}
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    block_device_usb_msc_impl::block_device_usb_msc_impl (
+        driver::usb::Host& host, driver::usb::pipe_t bulk_in,
+        driver::usb::pipe_t bulk_out, uint8_t lun) :
+        host_ (host), //
+        bulk_in_ (bulk_in), //
+        bulk_out_ (bulk_out), //
+        lun_ (lun)
+    {
+#if defined(OS_TRACE_POSIX_DRIVER_USB_MSC)
+      trace::printf ("block_device_usb_msc_impl::%s(%u,%u,%u)=@%p\n",
+                     __func__, bulk_in, bulk_out, lun, this);
+#endif
+
+      std::memset (stages_, 0, sizeof(stages_));
+    }
+
+    block_device_usb_msc_impl::~block_device_usb_msc_impl ()
+    {
+#if defined(OS_TRACE_POSIX_DRIVER_USB_MSC)
+      trace::printf ("block_device_usb_msc_impl::%s() @%p\n", __func__, this);
+#endif
+    }
+
+    // ------------------------------------------------------------------------
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+    int
+    block_device_usb_msc_impl::do_vioctl (int request, std::va_list args)
+    {
+      errno = ENOSYS;
+      return -1;
+    }
+
+    /**
+     * @details
+     * Wait for the unit to be ready, then read its capacity to
+     * set the geometry.
+     */
+    int
+    block_device_usb_msc_impl::do_vopen (const char* path, int oflag,
+                                         std::va_list args)
+    {
+#if defined(OS_TRACE_POSIX_DRIVER_USB_MSC)
+      trace::printf ("block_device_usb_msc_impl::%s(%d) @%p\n", __func__,
+                     oflag, this);
+#endif
+
+      uint8_t cdb[10];
+
+      int attempt = 0;
+      for (;; ++attempt)
+        {
+          std::memset (cdb, 0, 6);
+          cdb[0] = scsi_test_unit_ready;
+          if (internal_command_ (cdb, 6, nullptr, 0, true) >= 0)
+            {
+              break;
+            }
+          if (attempt + 1 >= ready_attempts)
+            {
+              errno = EIO;
+              return -1;
+            }
+
+          // Clear the pending condition, usually UNIT ATTENTION.
+          std::memset (cdb, 0, 6);
+          cdb[0] = scsi_request_sense;
+          cdb[4] = sizeof(reply_);
+          internal_command_ (cdb, 6, reply_, sizeof(reply_), true);
+        }
+
+      std::memset (cdb, 0, 10);
+      cdb[0] = scsi_read_capacity_10;
+      if (internal_command_ (cdb, 10, reply_, 8, true) != 8)
+        {
+          errno = EIO;
+          return -1;
+        }
+
+      uint32_t last = get_be32 (&reply_[0]);
+      uint32_t size = get_be32 (&reply_[4]);
+      if (size == 0)
+        {
+          errno = EIO;
+          return -1;
+        }
+
+      num_blocks_ = static_cast<blknum_t> (last) + 1;
+      block_logical_size_bytes_ = size;
+      block_physical_size_bytes_ = size;
+
+      return 0;
+    }
+
+#pragma GCC diagnostic pop
+
+    ssize_t
+    block_device_usb_msc_impl::do_read_block (void* buf, blknum_t blknum,
+                                              std::size_t nblocks)
+    {
+      return internal_transfer_ (buf, blknum, nblocks, false);
+    }
+
+    ssize_t
+    block_device_usb_msc_impl::do_write_block (const void* buf,
+                                               blknum_t blknum,
+                                               std::size_t nblocks)
+    {
+      return internal_transfer_ (const_cast<void*> (buf), blknum, nblocks,
+                                 true);
+    }
+
+    /**
+     * @details
+     * Ask the device to write its cache; errors are ignored, not all
+     * devices implement the command.
+     */
+    void
+    block_device_usb_msc_impl::do_sync (void)
+    {
+      uint8_t cdb[10];
+      std::memset (cdb, 0, sizeof(cdb));
+      cdb[0] = scsi_synchronize_cache_10;
+      internal_command_ (cdb, sizeof(cdb), nullptr, 0, false);
+    }
+
+    int
+    block_device_usb_msc_impl::do_close (void)
+    {
+      do_sync ();
+      return 0;
+    }
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @details
+     * Split the transfer in READ(10)/WRITE(10) commands of up to
+     * `OS_INTEGER_POSIX_DRIVER_USB_MSC_TRANSFER_SIZE` bytes, with
+     * the data directly to/from the caller buffer.
+     */
+    ssize_t
+    block_device_usb_msc_impl::internal_transfer_ (void* buf, blknum_t blknum,
+                                                   std::size_t nblocks,
+                                                   bool is_write)
+    {
+      assert (block_logical_size_bytes_ != 0);
+
+      std::size_t max_blocks = OS_INTEGER_POSIX_DRIVER_USB_MSC_TRANSFER_SIZE
+          / block_logical_size_bytes_;
+      if (max_blocks == 0)
+        {
+          max_blocks = 1;
+        }
+      else if (max_blocks > 0xFFFF)
+        {
+          max_blocks = 0xFFFF;
+        }
+
+      uint8_t* p = static_cast<uint8_t*> (buf);
+      std::size_t done = 0;
+      while (done < nblocks)
+        {
+          std::size_t n = nblocks - done;
+          if (n > max_blocks)
+            {
+              n = max_blocks;
+            }
+
+          uint8_t cdb[10];
+          std::memset (cdb, 0, sizeof(cdb));
+          cdb[0] = is_write ? scsi_write_10 : scsi_read_10;
+          put_be32 (&cdb[2], static_cast<uint32_t> (blknum + done));
+          cdb[7] = static_cast<uint8_t> (n >> 8);
+          cdb[8] = static_cast<uint8_t> (n);
+
+          std::size_t nbyte = n * block_logical_size_bytes_;
+          ssize_t ret = internal_command_ (cdb, sizeof(cdb), p, nbyte,
+                                           !is_write);
+          if (ret < 0 || static_cast<std::size_t> (ret) != nbyte)
+            {
+              if (done > 0)
+                {
+                  break;
+                }
+              errno = EIO;
+              return -1;
+            }
+
+          p += nbyte;
+          done += n;
+        }
+
+      return static_cast<ssize_t> (done);
+    }
+
+    /**
+     * @details
+     * The command, the data and the status transfers are queued
+     * at once: the data and the status on the IN pipe (for reads),
+     * or the command and the data on the OUT pipe (for writes), so
+     * the host controller goes from one stage to the next without
+     * waiting for the thread.
+     *
+     * On errors, both pipes are reset.
+     *
+     * @return The number of data bytes transferred, or -1 with
+     *  `errno` set.
+     */
+    ssize_t
+    block_device_usb_msc_impl::internal_command_ (const uint8_t* cdb,
+                                                  std::size_t cdb_len,
+                                                  void* data,
+                                                  std::size_t data_len,
+                                                  bool is_in)
+    {
+      using namespace driver::usb;
+
+      assert (cdb_len > 0 && cdb_len <= 16);
+
+      ++tag_;
+      std::memset (cbw_, 0, sizeof(cbw_));
+      put_le32 (&cbw_[0], cbw_signature);
+      put_le32 (&cbw_[4], tag_);
+      put_le32 (&cbw_[8], static_cast<uint32_t> (data_len));
+      cbw_[12] = (is_in && data_len > 0) ? 0x80 : 0x00;
+      cbw_[13] = lun_;
+      cbw_[14] = static_cast<uint8_t> (cdb_len);
+      std::memcpy (&cbw_[15], cdb, cdb_len);
+
+      host::transfer_request& cmd = stages_[0];
+      host::transfer_request& dat = stages_[1];
+      host::transfer_request& sts = stages_[2];
+
+      cmd.next = nullptr;
+      cmd.packet = host::PACKET_OUT;
+      cmd.data = cbw_;
+      cmd.num = sizeof(cbw_);
+
+      dat.next = nullptr;
+      dat.packet = is_in ? host::PACKET_IN : host::PACKET_OUT;
+      dat.data = static_cast<uint8_t*> (data);
+      dat.num = data_len;
+
+      sts.next = nullptr;
+      sts.packet = host::PACKET_IN;
+      sts.data = csw_;
+      sts.num = sizeof(csw_);
+
+      for (host::transfer_request& r : stages_)
+        {
+          r.status = driver::ERROR;
+          r.count = 0;
+          r.cb_func = internal_complete_;
+          r.cb_object = this;
+        }
+
+      host::transfer_request* in_chain = &sts;
+      host::transfer_request* out_chain = &cmd;
+      std::size_t stages = 2;
+      if (data_len > 0)
+        {
+          if (is_in)
+            {
+              dat.next = &sts;
+              in_chain = &dat;
+            }
+          else
+            {
+              cmd.next = &dat;
+            }
+          stages = 3;
+        }
+
+      done_sem_.reset ();
+
+      // Arm the IN pipe first, ready for the device to answer.
+      if (host_.submit_transfer (bulk_in_, in_chain) != driver::RETURN_OK)
+        {
+          errno = EIO;
+          return -1;
+        }
+      if (host_.submit_transfer (bulk_out_, out_chain) != driver::RETURN_OK)
+        {
+          // Nothing will come on the IN pipe.
+          host_.abort_transfers (bulk_in_);
+          stages = (data_len > 0 && is_in) ? 2 : 1;
+        }
+
+      for (std::size_t i = 0; i < stages; ++i)
+        {
+          done_sem_.wait ();
+        }
+
+      bool failed = (cmd.status != driver::RETURN_OK)
+          || (sts.status != driver::RETURN_OK)
+          || (data_len > 0 && dat.status != driver::RETURN_OK)
+          || (sts.count != sizeof(csw_))
+          || (get_le32 (&csw_[0]) != csw_signature)
+          || (get_le32 (&csw_[4]) != tag_);
+      if (failed)
+        {
+          host_.reset_pipe (bulk_in_);
+          host_.reset_pipe (bulk_out_);
+          errno = EIO;
+          return -1;
+        }
+
+      if (csw_[12] != 0)
+        {
+          // Command failed (1) or phase error (2).
+          errno = EIO;
+          return -1;
+        }
+
+      uint32_t residue = get_le32 (&csw_[8]);
+      if (residue > data_len)
+        {
+          residue = static_cast<uint32_t> (data_len);
+        }
+
+      return static_cast<ssize_t> (data_len - residue);
+    }
+
+    /**
+     * @details
+     * Called from the pipe interrupts. If the command itself could
+     * not be sent, the IN pipe transfers are aborted, otherwise the
+     * thread would wait forever.
+     */
+    void
+    block_device_usb_msc_impl::internal_complete_ (
+        const void* object, driver::usb::host::transfer_request* request)
+    {
+      block_device_usb_msc_impl* self =
+          static_cast<block_device_usb_msc_impl*> (const_cast<void*> (object));
+
+      if (request == &self->stages_[0]
+          && request->status != driver::RETURN_OK)
+        {
+          self->host_.abort_transfers (self->bulk_in_);
+        }
+
+      self->done_sem_.post ();
+    }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
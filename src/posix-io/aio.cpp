@@ -0,0 +1,639 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#include <cmsis-plus/posix-io/aio.h>
+#include <cmsis-plus/posix-io/io.h>
+#include <cmsis-plus/posix-io/block-device.h>
+#include <cmsis-plus/posix-io/file-descriptors-manager.h>
+
+#include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/rtos/os-executor.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <new>
+
+// ----------------------------------------------------------------------------
+
+/**
+ * @cond ignore
+ */
+
+namespace
+{
+  using namespace os;
+
+  static_assert(OS_INTEGER_POSIX_IO_AIO_MAX >= 1,
+      "OS_INTEGER_POSIX_IO_AIO_MAX must be at least 1");
+
+  using state_t = uint8_t;
+
+  struct state
+  {
+    enum
+      : state_t
+        {
+          free = 0,
+        queued = 1,
+        running = 2,
+        done = 3
+      };
+  };
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+  // The status of an operation is kept here, not in the aiocb,
+  // which has only the standard members.
+  struct control_t
+  {
+    const struct aiocb* cb = nullptr;
+
+    // Used when submitted directly to an asynchronous block device.
+    posix::block_device::request req;
+    posix::block_device* dev = nullptr;
+    std::size_t block_size = 0;
+
+    // The thread in aio_suspend(), if any.
+    rtos::semaphore* volatile waiter = nullptr;
+
+    ssize_t result = 0;
+    volatile int error = 0;
+    volatile state_t state = state::free;
+
+    // Set while the job in the workers queue still refers to
+    // the control block, even after it was cancelled.
+    volatile bool job_pending = false;
+    bool is_write = false;
+  };
+
+#pragma GCC diagnostic pop
+
+  control_t controls[OS_INTEGER_POSIX_IO_AIO_MAX];
+
+  using workers_t = rtos::executor_inclusive<OS_INTEGER_POSIX_IO_AIO_THREADS,
+  OS_INTEGER_POSIX_IO_AIO_MAX, OS_INTEGER_POSIX_IO_AIO_STACK_SIZE_BYTES>;
+
+  // Created at the first request which needs them.
+  alignas(workers_t) char workers_storage[sizeof(workers_t)];
+  workers_t* volatile workers = nullptr;
+
+  // Must be called in an interrupts critical section.
+  control_t*
+  find (const struct aiocb* cb)
+  {
+    for (std::size_t i = 0; i < OS_INTEGER_POSIX_IO_AIO_MAX; ++i)
+      {
+        if (controls[i].state != state::free && controls[i].cb == cb)
+          {
+            return &controls[i];
+          }
+      }
+    return nullptr;
+  }
+
+  // Can be called from interrupts, with the block device completions.
+  void
+  complete (control_t* c, ssize_t result, int error)
+  {
+    // ----- Enter critical section -------------------------------------------
+    rtos::interrupts::critical_section ics;
+
+    c->result = result;
+    c->error = error;
+    c->state = state::done;
+
+    // Posted here, the waiter cannot leave aio_suspend() before.
+    rtos::semaphore* waiter = c->waiter;
+    c->waiter = nullptr;
+    if (waiter != nullptr)
+      {
+        waiter->post ();
+      }
+    // ----- Exit critical section --------------------------------------------
+  }
+
+  void
+  request_done (posix::block_device::request* req, void* arg)
+  {
+    control_t* c = static_cast<control_t*> (arg);
+
+    ssize_t result = req->result;
+    if (result > 0)
+      {
+        result *= static_cast<ssize_t> (c->block_size);
+      }
+    complete (c, result, req->error);
+  }
+
+  // Executed by the workers, for the devices without
+  // asynchronous support.
+  void
+  run (void* args)
+  {
+    control_t* c = static_cast<control_t*> (args);
+
+      {
+        // ----- Enter critical section ---------------------------------------
+        rtos::interrupts::critical_section ics;
+
+        c->job_pending = false;
+        if (c->state != state::queued)
+          {
+            return; // Cancelled.
+          }
+        c->state = state::running;
+        // ----- Exit critical section ----------------------------------------
+      }
+
+    const struct aiocb* cb = c->cb;
+    void* buf = const_cast<void*> (cb->aio_buf);
+
+    ssize_t ret;
+    int err = 0;
+
+    posix::io* io = posix::file_descriptors_manager::io (cb->aio_fildes);
+    if (io == nullptr)
+      {
+        ret = -1;
+        err = EBADF;
+      }
+    else
+      {
+        // The offset is ignored by the devices which cannot seek.
+        bool seekable = ((io->get_type ()
+            & (posix::io::type::file | posix::io::type::block_device)) != 0);
+
+        errno = 0;
+        if (c->is_write)
+          {
+            ret = seekable ?
+                io->pwrite (buf, cb->aio_nbytes, cb->aio_offset) :
+                io->write (buf, cb->aio_nbytes);
+          }
+        else
+          {
+            ret = seekable ?
+                io->pread (buf, cb->aio_nbytes, cb->aio_offset) :
+                io->read (buf, cb->aio_nbytes);
+          }
+        if (ret < 0)
+          {
+            err = errno;
+          }
+      }
+
+    complete (c, ret, err);
+  }
+
+  workers_t*
+  internal_workers (void)
+  {
+    if (workers == nullptr)
+      {
+        // ----- Enter critical section ---------------------------------------
+        rtos::scheduler::critical_section scs;
+
+        if (workers == nullptr)
+          {
+            workers = new (&workers_storage) workers_t
+              { "aio" };
+          }
+        // ----- Exit critical section ----------------------------------------
+      }
+    return workers;
+  }
+
+  int
+  internal_submit (struct aiocb* aiocbp, bool is_write)
+  {
+    if (aiocbp == nullptr || aiocbp->aio_offset < 0)
+      {
+        errno = EINVAL;
+        return -1;
+      }
+
+    // Completion is checked with aio_error() or aio_suspend(),
+    // signals and notification threads are not supported.
+    if (aiocbp->aio_sigevent.sigev_notify != SIGEV_NONE)
+      {
+        errno = EINVAL;
+        return -1;
+      }
+
+    posix::io* io = posix::file_descriptors_manager::io (aiocbp->aio_fildes);
+    if (io == nullptr)
+      {
+        errno = EBADF;
+        return -1;
+      }
+
+    control_t* c = nullptr;
+      {
+        // ----- Enter critical section ---------------------------------------
+        rtos::interrupts::critical_section ics;
+
+        if (find (aiocbp) != nullptr)
+          {
+            errno = EINVAL; // Already in use.
+            return -1;
+          }
+
+        for (std::size_t i = 0; i < OS_INTEGER_POSIX_IO_AIO_MAX; ++i)
+          {
+            if (controls[i].state == state::free && !controls[i].job_pending)
+              {
+                c = &controls[i];
+                break;
+              }
+          }
+        if (c == nullptr)
+          {
+            errno = EAGAIN;
+            return -1;
+          }
+
+        c->cb = aiocbp;
+        c->dev = nullptr;
+        c->waiter = nullptr;
+        c->result = -1;
+        c->error = EINPROGRESS;
+        c->is_write = is_write;
+        c->state = state::queued;
+        // ----- Exit critical section ----------------------------------------
+      }
+
+    // Whole blocks go directly to the asynchronous block devices.
+    if ((io->get_type () & posix::io::type::block_device) != 0)
+      {
+        posix::block_device* dev = static_cast<posix::block_device*> (io);
+        std::size_t bs = dev->block_logical_size_bytes ();
+        std::size_t offset = static_cast<std::size_t> (aiocbp->aio_offset);
+        if (dev->asynchronous () && bs != 0 && aiocbp->aio_nbytes != 0
+            && (offset % bs) == 0 && (aiocbp->aio_nbytes % bs) == 0)
+          {
+            c->dev = dev;
+            c->block_size = bs;
+
+            posix::block_device::request& req = c->req;
+            req.buffer = const_cast<void*> (aiocbp->aio_buf);
+            req.blknum = offset / bs;
+            req.nblocks = aiocbp->aio_nbytes / bs;
+            req.is_write = is_write;
+            req.priority = 0;
+            req.callback = request_done;
+            req.arg = c;
+
+            if (dev->submit (req) == 0)
+              {
+                return 0;
+              }
+
+            // Not accepted (for example the queue is full),
+            // the workers will retry the transfer.
+            c->dev = nullptr;
+          }
+      }
+
+    c->job_pending = true;
+    if (internal_workers ()->submit (run, c) != rtos::result::ok)
+      {
+        // ----- Enter critical section ---------------------------------------
+        rtos::interrupts::critical_section ics;
+
+        c->job_pending = false;
+        c->cb = nullptr;
+        c->state = state::free;
+
+        errno = EAGAIN;
+        return -1;
+        // ----- Exit critical section ----------------------------------------
+      }
+
+    return 0;
+  }
+
+  // Remove the waiter from the operations it was registered with.
+  void
+  internal_unregister (const struct aiocb* const list[], int nent,
+                       rtos::semaphore* sem)
+  {
+    // ----- Enter critical section -------------------------------------------
+    rtos::interrupts::critical_section ics;
+
+    for (int i = 0; i < nent; ++i)
+      {
+        control_t* c = (list[i] != nullptr) ? find (list[i]) : nullptr;
+        if (c != nullptr && c->waiter == sem)
+          {
+            c->waiter = nullptr;
+          }
+      }
+    // ----- Exit critical section --------------------------------------------
+  }
+}
+
+/**
+ * @endcond
+ */
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ------------------------------------------------------------------------
+
+    /**
+     * @details
+     * The transfers with whole blocks, on block devices able to
+     * transfer asynchronously, are submitted directly to the device.
+     * The other transfers are performed with `pread()` by a small
+     * pool of worker threads, created at the first request.
+     *
+     * At most `OS_INTEGER_POSIX_IO_AIO_MAX` operations can be in
+     * progress or waiting for `aio_return()`; beyond this, the
+     * function fails with EAGAIN.
+     *
+     * Only `SIGEV_NONE` notifications are supported.
+     */
+    int
+    aio_read (struct aiocb* aiocbp)
+    {
+      return internal_submit (aiocbp, false);
+    }
+
+    /**
+     * @details
+     * Similar to `aio_read()`, the transfer is done with `pwrite()`.
+     * `O_APPEND` is not honoured, the write is always at
+     * `aio_offset`.
+     */
+    int
+    aio_write (struct aiocb* aiocbp)
+    {
+      return internal_submit (aiocbp, true);
+    }
+
+    int
+    aio_error (const struct aiocb* aiocbp)
+    {
+      // ----- Enter critical section -----------------------------------------
+      rtos::interrupts::critical_section ics;
+
+      control_t* c = find (aiocbp);
+      if (c == nullptr)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      if (c->state != state::done)
+        {
+          return EINPROGRESS;
+        }
+      return c->error;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    /**
+     * @details
+     * Must be called once for each completed operation, it
+     * releases the resources used by it.
+     */
+    ssize_t
+    aio_return (struct aiocb* aiocbp)
+    {
+      // ----- Enter critical section -----------------------------------------
+      rtos::interrupts::critical_section ics;
+
+      control_t* c = find (aiocbp);
+      if (c == nullptr || c->state != state::done)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      ssize_t ret = c->result;
+      c->cb = nullptr;
+      c->state = state::free;
+
+      return ret;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    /**
+     * @details
+     * Only one thread at a time should wait for the same operation.
+     */
+    int
+    aio_suspend (const struct aiocb* const list[], int nent,
+                 const struct timespec* timeout)
+    {
+      if (list == nullptr || nent <= 0)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      rtos::clock::duration_t ticks = 0;
+      if (timeout != nullptr)
+        {
+          if ((timeout->tv_sec < 0) || (timeout->tv_nsec < 0)
+              || (timeout->tv_nsec >= 1000000000))
+            {
+              errno = EINVAL;
+              return -1;
+            }
+          ticks = rtos::clock_systick::ticks_cast (
+              static_cast<uint64_t> (timeout->tv_sec) * 1000000u
+                  + static_cast<uint64_t> (timeout->tv_nsec) / 1000u);
+        }
+
+      rtos::semaphore_binary sem
+        { 0 };
+
+      for (;;)
+        {
+          bool completed = false;
+            {
+              // ----- Enter critical section ---------------------------------
+              rtos::interrupts::critical_section ics;
+
+              for (int i = 0; i < nent; ++i)
+                {
+                  if (list[i] == nullptr)
+                    {
+                      continue;
+                    }
+                  control_t* c = find (list[i]);
+                  if (c == nullptr || c->state == state::done)
+                    {
+                      completed = true;
+                      break;
+                    }
+                  c->waiter = &sem;
+                }
+              // ----- Exit critical section ----------------------------------
+            }
+
+          if (completed)
+            {
+              internal_unregister (list, nent, &sem);
+              return 0;
+            }
+
+          rtos::result_t res;
+          if (timeout != nullptr)
+            {
+              res = sem.timed_wait (ticks);
+            }
+          else
+            {
+              res = sem.wait ();
+            }
+
+          if (res != rtos::result::ok)
+            {
+              internal_unregister (list, nent, &sem);
+              errno = (res == ETIMEDOUT) ? EAGAIN : EINTR;
+              return -1;
+            }
+        }
+    }
+
+    /**
+     * @details
+     * Non standard, used to wait without a blocked thread, for
+     * example by coroutines. If the operation is already completed,
+     * the semaphore is posted immediately. It replaces the thread
+     * waiting in `aio_suspend()`, if any.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    int
+    aio_notify (const struct aiocb* aiocbp, rtos::semaphore* sem)
+    {
+      // ----- Enter critical section -----------------------------------------
+      rtos::interrupts::critical_section ics;
+
+      control_t* c = find (aiocbp);
+      if (c == nullptr)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      if (c->state == state::done)
+        {
+          if (sem != nullptr)
+            {
+              sem->post ();
+            }
+          return 0;
+        }
+
+      c->waiter = sem;
+      return 0;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    /**
+     * @details
+     * The operations still waiting for a worker are always
+     * cancelled, those submitted directly to a block device only
+     * if the device can abort them; the transfers in progress
+     * are not cancelled.
+     */
+    int
+    aio_cancel (int fildes, struct aiocb* aiocbp)
+    {
+      if (file_descriptors_manager::io (fildes) == nullptr)
+        {
+          errno = EBADF;
+          return -1;
+        }
+
+      int ret = AIO_ALLDONE;
+      for (std::size_t i = 0; i < OS_INTEGER_POSIX_IO_AIO_MAX; ++i)
+        {
+          control_t* c = &controls[i];
+
+          block_device* dev = nullptr;
+            {
+              // ----- Enter critical section ---------------------------------
+              rtos::interrupts::critical_section ics;
+
+              if (c->state == state::free || c->state == state::done
+                  || c->cb->aio_fildes != fildes
+                  || (aiocbp != nullptr && c->cb != aiocbp))
+                {
+                  continue;
+                }
+
+              if (c->state == state::queued && c->dev == nullptr)
+                {
+                  // The worker will find it done and skip it.
+                  complete (c, -1, ECANCELED);
+                  if (ret == AIO_ALLDONE)
+                    {
+                      ret = AIO_CANCELED;
+                    }
+                  continue;
+                }
+
+              dev = c->dev;
+              // ----- Exit critical section ----------------------------------
+            }
+
+          if (dev != nullptr && dev->cancel (c->req) == 0)
+            {
+              // Completed with ECANCELED by the device.
+              if (ret == AIO_ALLDONE)
+                {
+                  ret = AIO_CANCELED;
+                }
+            }
+          else if (dev == nullptr || errno != ENOENT)
+            {
+              ret = AIO_NOTCANCELED;
+            }
+        }
+
+      return ret;
+    }
+
+  // --------------------------------------------------------------------------
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,975 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/posix-io/block-device-flash.h>
+
+#include <cmsis-plus/diag/trace.h>
+
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    /**
+     * @cond ignore
+     */
+
+    namespace
+    {
+      // Used for the free map entries and the unused summary entries.
+      constexpr uint32_t no_block = 0xFFFFFFFF;
+
+      constexpr std::size_t no_unit = static_cast<std::size_t> (-1);
+
+      constexpr uint32_t summary_magic = 0x314C5446; // "FTL1"
+
+      // The header of the summary page, followed by the logical
+      // block numbers of the other pages of the unit.
+      struct summary_t
+      {
+        uint32_t magic;
+        uint32_t erase_count;
+        uint64_t sequence;
+      };
+    }
+
+    /**
+     * @endcond
+     */
+
+    // ========================================================================
+
+    /**
+     * @details
+     * The background thread is created here, and waits until the
+     * device is opened; the maps are allocated when the device is
+     * first opened, since the geometry of the parent is known
+     * only then.
+     */
+    block_device_flash_impl::block_device_flash_impl (
+        block_device& parent, std::size_t unit_pages, std::size_t spare_units,
+        rtos::memory::memory_resource* mr) :
+        parent_ (parent), //
+        mr_ (mr != nullptr ? mr : rtos::memory::get_default_resource ()), //
+        unit_pages_ (unit_pages), //
+        spare_units_ (spare_units < 2 ? 2 : spare_units), //
+        active_ (no_unit), //
+        thread_
+          { "flash", internal_thread_, this }
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+      OS_TRACE_PRINTF (posix_io_block_device,
+                       "block_device_flash_impl::%s(%u, %u)=@%p\n", __func__,
+                       unit_pages_, spare_units_, this);
+#endif
+    }
+
+    block_device_flash_impl::~block_device_flash_impl ()
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+      OS_TRACE_PRINTF (posix_io_block_device,
+                       "block_device_flash_impl::%s() @%p\n", __func__, this);
+#endif
+
+      stop_ = true;
+      wakeup_.post ();
+      thread_.join ();
+
+      internal_free_ ();
+    }
+
+    // ------------------------------------------------------------------------
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+    int
+    block_device_flash_impl::do_vioctl (int request, std::va_list args)
+    {
+      errno = ENOSYS;
+      return -1;
+    }
+
+#pragma GCC diagnostic pop
+
+    /**
+     * @details
+     * At the first open the maps are allocated and rebuilt from
+     * the summaries; the parent must have at least `spare_units + 1`
+     * units, and its pages must be large enough for a summary.
+     */
+    int
+    block_device_flash_impl::do_vopen (const char* path, int oflag,
+                                       std::va_list args)
+    {
+      if (parent_.vopen (path, oflag, args) < 0)
+        {
+          return -1;
+        }
+
+      std::lock_guard<rtos::mutex> lock
+        { mutex_ };
+
+      if (units_ == nullptr)
+        {
+          std::size_t bs = parent_.block_logical_size_bytes ();
+          num_units_ = parent_.blocks () / unit_pages_;
+
+          if (unit_pages_ < 2 || unit_pages_ > 0xFFFF
+              || num_units_ <= spare_units_
+              || (sizeof(summary_t) + (unit_pages_ - 1) * sizeof(uint32_t))
+                  > bs)
+            {
+              parent_.close ();
+              errno = EINVAL;
+              return -1;
+            }
+
+          block_logical_size_bytes_ = bs;
+          block_physical_size_bytes_ = parent_.block_physical_size_bytes ();
+          num_blocks_ = (num_units_ - spare_units_) * (unit_pages_ - 1);
+
+          std::size_t pages = num_units_ * unit_pages_;
+          map_ = static_cast<uint32_t*> (mr_->allocate (
+              num_blocks_ * sizeof(uint32_t), alignof(uint32_t)));
+          owner_ = static_cast<uint32_t*> (mr_->allocate (
+              pages * sizeof(uint32_t), alignof(uint32_t)));
+          units_ = static_cast<unit_t*> (mr_->allocate (
+              num_units_ * sizeof(unit_t), alignof(unit_t)));
+          copy_buffer_ = static_cast<uint8_t*> (mr_->allocate (
+              bs, alignof(uint64_t)));
+          summary_buffer_ = static_cast<uint8_t*> (mr_->allocate (
+              bs, alignof(uint64_t)));
+
+          if (map_ == nullptr || owner_ == nullptr || units_ == nullptr
+              || copy_buffer_ == nullptr || summary_buffer_ == nullptr)
+            {
+              internal_free_ ();
+              parent_.close ();
+              errno = ENOMEM;
+              return -1;
+            }
+
+          std::fill (map_, map_ + num_blocks_, no_block);
+          std::fill (owner_, owner_ + pages, no_block);
+
+          if (internal_mount_ () < 0)
+            {
+              internal_free_ ();
+              parent_.close ();
+              return -1;
+            }
+        }
+
+      mounted_ = true;
+      wakeup_.post ();
+
+      return 0;
+    }
+
+    /**
+     * @details
+     * The runs of blocks mapped to consecutive pages are read
+     * with a single parent request.
+     */
+    ssize_t
+    block_device_flash_impl::do_read_block (void* buf, blknum_t blknum,
+                                            std::size_t nblocks)
+    {
+      std::lock_guard<rtos::mutex> lock
+        { mutex_ };
+
+      uint8_t* p = static_cast<uint8_t*> (buf);
+      std::size_t bs = block_logical_size_bytes_;
+
+      std::size_t remaining = nblocks;
+      while (remaining > 0)
+        {
+          uint32_t page = map_[blknum];
+          std::size_t n = 1;
+          if (page == no_block)
+            {
+              while (n < remaining && map_[blknum + n] == no_block)
+                {
+                  ++n;
+                }
+              std::memset (p, 0, n * bs);
+            }
+          else
+            {
+              while (n < remaining && map_[blknum + n] == page + n)
+                {
+                  ++n;
+                }
+              if (parent_.read_block (p, page, n)
+                  != static_cast<ssize_t> (n))
+                {
+                  return -1;
+                }
+            }
+
+          p += n * bs;
+          blknum += n;
+          remaining -= n;
+        }
+
+      return static_cast<ssize_t> (nblocks);
+    }
+
+    /**
+     * @details
+     * The blocks are written to the free pages of the active unit;
+     * the writer waits for an erase only if the background thread
+     * did not keep up.
+     */
+    ssize_t
+    block_device_flash_impl::do_write_block (const void* buf, blknum_t blknum,
+                                             std::size_t nblocks)
+    {
+      std::lock_guard<rtos::mutex> lock
+        { mutex_ };
+
+      ssize_t ret = internal_program_ (buf, blknum, nblocks, false);
+      wakeup_.post ();
+
+      return ret;
+    }
+
+    /**
+     * @details
+     * The pages are released immediately; the units left with
+     * no valid pages are erased in the background.
+     */
+    int
+    block_device_flash_impl::do_discard (blknum_t blknum,
+                                         std::size_t nblocks)
+    {
+      std::lock_guard<rtos::mutex> lock
+        { mutex_ };
+
+      for (std::size_t i = 0; i < nblocks; ++i)
+        {
+          internal_invalidate_ (blknum + i);
+        }
+      wakeup_.post ();
+
+      return 0;
+    }
+
+    /**
+     * @details
+     * The active unit is closed, so its summary is written; the
+     * rest of its pages are reclaimed by the garbage collection.
+     */
+    void
+    block_device_flash_impl::do_sync (void)
+    {
+        {
+          std::lock_guard<rtos::mutex> lock
+            { mutex_ };
+
+          internal_close_active_ ();
+        }
+
+      parent_.sync ();
+    }
+
+    /**
+     * @details
+     * The maps are kept, for the next open; the erase in progress,
+     * if any, is waited for before closing the parent.
+     */
+    int
+    block_device_flash_impl::do_close (void)
+    {
+        {
+          std::lock_guard<rtos::mutex> lock
+            { mutex_ };
+
+          internal_close_active_ ();
+          mounted_ = false;
+        }
+
+        {
+          std::lock_guard<rtos::mutex> lock
+            { erase_mutex_ };
+        }
+
+      return parent_.close ();
+    }
+
+    std::size_t
+    block_device_flash_impl::erased_units (void)
+    {
+      std::lock_guard<rtos::mutex> lock
+        { mutex_ };
+
+      return internal_count_ (unit_state::erased);
+    }
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @cond ignore
+     */
+
+    void*
+    block_device_flash_impl::internal_thread_ (void* args)
+    {
+      block_device_flash_impl* self =
+          static_cast<block_device_flash_impl*> (args);
+
+      // The static instance is created with the default priority.
+      rtos::this_thread::thread ().priority (
+          rtos::thread::priority::below_normal);
+
+      while (!self->stop_)
+        {
+          if (!self->internal_background_step_ ())
+            {
+              self->wakeup_.wait ();
+            }
+        }
+
+      return nullptr;
+    }
+
+    /**
+     * Do one unit of work: erase a unit, close the active unit to
+     * release the retired units, or move one valid page, for the
+     * garbage collection or for wear levelling. The maps are locked
+     * for each step, so the writers are not kept waiting.
+     */
+    bool
+    block_device_flash_impl::internal_background_step_ (void)
+    {
+      std::size_t unit;
+        {
+          std::lock_guard<rtos::mutex> lock
+            { mutex_ };
+
+          if (!mounted_)
+            {
+              return false;
+            }
+
+          unit = internal_find_ (unit_state::dirty);
+          if (unit != no_unit)
+            {
+              units_[unit].state = unit_state::erasing;
+            }
+        }
+
+      if (unit != no_unit)
+        {
+          int ret;
+            {
+              std::lock_guard<rtos::mutex> lock
+                { erase_mutex_ };
+
+              ret = parent_.discard (unit * unit_pages_, unit_pages_);
+            }
+
+          std::lock_guard<rtos::mutex> lock
+            { mutex_ };
+
+          internal_erased_ (unit, ret);
+          return true;
+        }
+
+      std::lock_guard<rtos::mutex> lock
+        { mutex_ };
+
+      if (!mounted_)
+        {
+          return false;
+        }
+
+      bool wear = false;
+      if (internal_count_ (unit_state::erased) < spare_units_)
+        {
+          if (internal_count_ (unit_state::retired) > 0)
+            {
+              return internal_close_active_ () == 0;
+            }
+          unit = internal_victim_ ();
+        }
+      else
+        {
+          unit = internal_cold_unit_ ();
+          wear = true;
+        }
+
+      if (unit == no_unit)
+        {
+          return false;
+        }
+
+      for (std::size_t i = 0; i < unit_pages_ - 1; ++i)
+        {
+          blknum_t page = unit * unit_pages_ + i;
+          if (owner_[page] != no_block)
+            {
+              if (internal_relocate_page_ (page) < 0)
+                {
+                  return false;
+                }
+              if (wear && units_[unit].valid == 0)
+                {
+                  ++statistics_.wear_relocations;
+                }
+              return true;
+            }
+        }
+
+      return false;
+    }
+
+    /**
+     * The summaries are applied in the order they were written,
+     * so the newer copies of a block replace the older ones; the
+     * units without a summary are erased in the background.
+     */
+    int
+    block_device_flash_impl::internal_mount_ (void)
+    {
+      uint64_t* sequences = static_cast<uint64_t*> (mr_->allocate (
+          num_units_ * sizeof(uint64_t), alignof(uint64_t)));
+      if (sequences == nullptr)
+        {
+          errno = ENOMEM;
+          return -1;
+        }
+
+      summary_t summary;
+      for (std::size_t u = 0; u < num_units_; ++u)
+        {
+          units_[u] =
+            { 0, 0, 0, unit_state::dirty };
+          sequences[u] = 0;
+
+          if (parent_.read_block (summary_buffer_,
+                                  u * unit_pages_ + unit_pages_ - 1, 1) != 1)
+            {
+              continue;
+            }
+
+          std::memcpy (&summary, summary_buffer_, sizeof(summary));
+          if (summary.magic == summary_magic && summary.sequence != 0)
+            {
+              sequences[u] = summary.sequence;
+              units_[u].erase_count = summary.erase_count;
+              units_[u].next = static_cast<uint16_t> (unit_pages_ - 1);
+              units_[u].state = unit_state::full;
+            }
+        }
+
+      uint64_t last = 0;
+      for (;;)
+        {
+          std::size_t unit = no_unit;
+          for (std::size_t u = 0; u < num_units_; ++u)
+            {
+              if (sequences[u] > last
+                  && (unit == no_unit || sequences[u] < sequences[unit]))
+                {
+                  unit = u;
+                }
+            }
+          if (unit == no_unit)
+            {
+              break;
+            }
+          last = sequences[unit];
+
+          if (parent_.read_block (summary_buffer_,
+                                  unit * unit_pages_ + unit_pages_ - 1, 1)
+              != 1)
+            {
+              // Released below, the pages are not mapped.
+              continue;
+            }
+
+          const uint32_t* blocks =
+              reinterpret_cast<const uint32_t*> (summary_buffer_
+                  + sizeof(summary_t));
+          for (std::size_t i = 0; i < unit_pages_ - 1; ++i)
+            {
+              uint32_t blk = blocks[i];
+              if (blk >= num_blocks_)
+                {
+                  continue;
+                }
+
+              internal_invalidate_ (blk);
+
+              std::size_t page = unit * unit_pages_ + i;
+              map_[blk] = static_cast<uint32_t> (page);
+              owner_[page] = blk;
+              ++units_[unit].valid;
+            }
+        }
+      sequence_ = last;
+
+      mr_->deallocate (sequences, num_units_ * sizeof(uint64_t),
+                       alignof(uint64_t));
+
+      for (std::size_t u = 0; u < num_units_; ++u)
+        {
+          if (units_[u].valid == 0)
+            {
+              units_[u].state = unit_state::dirty;
+            }
+        }
+      active_ = no_unit;
+
+      return 0;
+    }
+
+    /**
+     * Consecutive blocks are written to consecutive pages of the
+     * active unit with a single parent request. The old copies are
+     * released only after the new ones are written.
+     */
+    ssize_t
+    block_device_flash_impl::internal_program_ (const void* buf,
+                                                blknum_t blknum,
+                                                std::size_t nblocks, bool gc)
+    {
+      const uint8_t* p = static_cast<const uint8_t*> (buf);
+      std::size_t bs = block_logical_size_bytes_;
+
+      std::size_t done = 0;
+      while (done < nblocks)
+        {
+          blknum_t page = internal_allocate_page_ (gc);
+          if (page == no_block)
+            {
+              break;
+            }
+
+          unit_t& un = units_[active_];
+          std::size_t count = 1;
+          while (done + count < nblocks && un.next < unit_pages_ - 1)
+            {
+              ++un.next;
+              ++count;
+            }
+
+          ssize_t ret = parent_.write_block (p, page, count);
+          if (ret <= 0)
+            {
+              break;
+            }
+
+          for (std::size_t k = 0; k < static_cast<std::size_t> (ret); ++k)
+            {
+              blknum_t blk = blknum + done + k;
+              internal_invalidate_ (blk);
+              map_[blk] = static_cast<uint32_t> (page + k);
+              owner_[page + k] = static_cast<uint32_t> (blk);
+              ++un.valid;
+            }
+
+          done += static_cast<std::size_t> (ret);
+          p += static_cast<std::size_t> (ret) * bs;
+
+          if (static_cast<std::size_t> (ret) < count)
+            {
+              break;
+            }
+        }
+
+      if (done == 0)
+        {
+          return -1;
+        }
+      return static_cast<ssize_t> (done);
+    }
+
+    /**
+     * Return the next free page of the active unit, taking a new
+     * erased unit when it is full. The last erased unit is kept for
+     * the garbage collection; when none is left, the writer erases
+     * a unit, or collects one, by itself.
+     */
+    block_device_flash_impl::blknum_t
+    block_device_flash_impl::internal_allocate_page_ (bool gc)
+    {
+      for (;;)
+        {
+          if (active_ != no_unit)
+            {
+              unit_t& un = units_[active_];
+              if (un.next < unit_pages_ - 1)
+                {
+                  return active_ * unit_pages_ + un.next++;
+                }
+              if (internal_close_active_ () < 0)
+                {
+                  return no_block;
+                }
+              continue;
+            }
+
+          std::size_t unit = internal_find_ (unit_state::erased);
+          if (unit != no_unit
+              && (gc || internal_count_ (unit_state::erased) > 1))
+            {
+              active_ = unit;
+              units_[unit].state = unit_state::active;
+              units_[unit].next = 0;
+              units_[unit].valid = 0;
+              continue;
+            }
+
+          std::size_t dirty = internal_find_ (unit_state::dirty);
+          if (dirty != no_unit)
+            {
+              ++statistics_.foreground_erases;
+              internal_erase_ (dirty);
+              continue;
+            }
+
+          if (internal_count_ (unit_state::retired) > 0)
+            {
+              // Nothing is active, all pages are summarised.
+              internal_close_active_ ();
+              continue;
+            }
+
+          if (!gc)
+            {
+              std::size_t victim = internal_victim_ ();
+              if (victim != no_unit)
+                {
+                  if (internal_relocate_unit_ (victim) < 0)
+                    {
+                      return no_block;
+                    }
+                  continue;
+                }
+            }
+
+          if (unit != no_unit)
+            {
+              // No garbage to collect, use the reserve.
+              gc = true;
+              continue;
+            }
+
+          errno = ENOSPC;
+          return no_block;
+        }
+    }
+
+    /**
+     * Write the summary of the active unit, then release the
+     * retired units, since the pages moved out of them are now
+     * summarised.
+     */
+    int
+    block_device_flash_impl::internal_close_active_ (void)
+    {
+      int ret = 0;
+      if (active_ != no_unit)
+        {
+          unit_t& un = units_[active_];
+          if (un.next == 0)
+            {
+              un.state = unit_state::erased;
+            }
+          else
+            {
+              std::size_t first = active_ * unit_pages_;
+
+              std::memset (summary_buffer_, 0xFF, block_logical_size_bytes_);
+              summary_t summary
+                { summary_magic, un.erase_count, ++sequence_ };
+              std::memcpy (summary_buffer_, &summary, sizeof(summary));
+              uint32_t* blocks =
+                  reinterpret_cast<uint32_t*> (summary_buffer_
+                      + sizeof(summary_t));
+              for (std::size_t i = 0; i < unit_pages_ - 1; ++i)
+                {
+                  blocks[i] = owner_[first + i];
+                }
+
+              un.next = static_cast<uint16_t> (unit_pages_ - 1);
+              un.state =
+                  (un.valid == 0) ? unit_state::retired : unit_state::full;
+
+              if (parent_.write_block (summary_buffer_,
+                                       first + unit_pages_ - 1, 1) != 1)
+                {
+                  // Keep the retired units, they may hold the
+                  // only summarised copies.
+                  active_ = no_unit;
+                  return -1;
+                }
+            }
+          active_ = no_unit;
+        }
+
+      for (std::size_t u = 0; u < num_units_; ++u)
+        {
+          if (units_[u].state == unit_state::retired)
+            {
+              units_[u].state = unit_state::dirty;
+              ret = 1;
+            }
+        }
+      if (ret != 0)
+        {
+          wakeup_.post ();
+        }
+
+      return 0;
+    }
+
+    void
+    block_device_flash_impl::internal_invalidate_ (blknum_t blknum)
+    {
+      uint32_t page = map_[blknum];
+      if (page == no_block)
+        {
+          return;
+        }
+
+      map_[blknum] = no_block;
+      owner_[page] = no_block;
+
+      unit_t& un = units_[page / unit_pages_];
+      --un.valid;
+      if (un.valid == 0 && un.state == unit_state::full)
+        {
+          un.state = unit_state::retired;
+        }
+    }
+
+    int
+    block_device_flash_impl::internal_relocate_page_ (blknum_t page)
+    {
+      if (parent_.read_block (copy_buffer_, page, 1) != 1)
+        {
+          return -1;
+        }
+
+      if (internal_program_ (copy_buffer_, owner_[page], 1, true) != 1)
+        {
+          return -1;
+        }
+
+      ++statistics_.relocations;
+      return 0;
+    }
+
+    int
+    block_device_flash_impl::internal_relocate_unit_ (std::size_t unit)
+    {
+      for (std::size_t i = 0; i < unit_pages_ - 1; ++i)
+        {
+          blknum_t page = unit * unit_pages_ + i;
+          if (owner_[page] != no_block)
+            {
+              if (internal_relocate_page_ (page) < 0)
+                {
+                  return -1;
+                }
+            }
+        }
+
+      return 0;
+    }
+
+    void
+    block_device_flash_impl::internal_erase_ (std::size_t unit)
+    {
+      units_[unit].state = unit_state::erasing;
+      internal_erased_ (unit,
+                        parent_.discard (unit * unit_pages_, unit_pages_));
+    }
+
+    void
+    block_device_flash_impl::internal_erased_ (std::size_t unit, int result)
+    {
+      unit_t& un = units_[unit];
+      if (result < 0)
+        {
+          // Never used again.
+          un.state = unit_state::bad;
+          ++statistics_.bad_units;
+          return;
+        }
+
+      ++un.erase_count;
+      un.valid = 0;
+      un.next = 0;
+      un.state = unit_state::erased;
+      ++statistics_.erases;
+    }
+
+    /**
+     * Return the unit in the given state with the lowest erase
+     * count, or `no_unit`.
+     */
+    std::size_t
+    block_device_flash_impl::internal_find_ (uint8_t state)
+    {
+      std::size_t unit = no_unit;
+      for (std::size_t u = 0; u < num_units_; ++u)
+        {
+          if (units_[u].state == state
+              && (unit == no_unit
+                  || units_[u].erase_count < units_[unit].erase_count))
+            {
+              unit = u;
+            }
+        }
+
+      return unit;
+    }
+
+    std::size_t
+    block_device_flash_impl::internal_count_ (uint8_t state)
+    {
+      std::size_t count = 0;
+      for (std::size_t u = 0; u < num_units_; ++u)
+        {
+          if (units_[u].state == state)
+            {
+              ++count;
+            }
+        }
+
+      return count;
+    }
+
+    /**
+     * Return the full unit with the fewest valid pages, if moving
+     * them frees at least one page.
+     */
+    std::size_t
+    block_device_flash_impl::internal_victim_ (void)
+    {
+      std::size_t unit = no_unit;
+      for (std::size_t u = 0; u < num_units_; ++u)
+        {
+          if (units_[u].state == unit_state::full
+              && units_[u].valid < unit_pages_ - 1
+              && (unit == no_unit || units_[u].valid < units_[unit].valid))
+            {
+              unit = u;
+            }
+        }
+
+      return unit;
+    }
+
+    /**
+     * Return the least erased full unit, if it lags more than
+     * `wear_threshold` erases behind the most erased unit.
+     */
+    std::size_t
+    block_device_flash_impl::internal_cold_unit_ (void)
+    {
+      std::size_t unit = internal_find_ (unit_state::full);
+      if (unit == no_unit)
+        {
+          return no_unit;
+        }
+
+      uint32_t max = 0;
+      for (std::size_t u = 0; u < num_units_; ++u)
+        {
+          if (units_[u].state != unit_state::bad)
+            {
+              max = std::max (max, units_[u].erase_count);
+            }
+        }
+
+      if (max - units_[unit].erase_count <= wear_threshold)
+        {
+          return no_unit;
+        }
+      return unit;
+    }
+
+    void
+    block_device_flash_impl::internal_free_ (void)
+    {
+      std::size_t bs = block_logical_size_bytes_;
+      if (map_ != nullptr)
+        {
+          mr_->deallocate (map_, num_blocks_ * sizeof(uint32_t),
+                           alignof(uint32_t));
+          map_ = nullptr;
+        }
+      if (owner_ != nullptr)
+        {
+          mr_->deallocate (owner_,
+                           num_units_ * unit_pages_ * sizeof(uint32_t),
+                           alignof(uint32_t));
+          owner_ = nullptr;
+        }
+      if (units_ != nullptr)
+        {
+          mr_->deallocate (units_, num_units_ * sizeof(unit_t),
+                           alignof(unit_t));
+          units_ = nullptr;
+        }
+      if (copy_buffer_ != nullptr)
+        {
+          mr_->deallocate (copy_buffer_, bs, alignof(uint64_t));
+          copy_buffer_ = nullptr;
+        }
+      if (summary_buffer_ != nullptr)
+        {
+          mr_->deallocate (summary_buffer_, bs, alignof(uint64_t));
+          summary_buffer_ = nullptr;
+        }
+
+      num_units_ = 0;
+      num_blocks_ = 0;
+    }
+
+    /**
+     * @endcond
+     */
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
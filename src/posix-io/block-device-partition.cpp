@@ -43,16 +43,18 @@ namespace os
           { impl, name }
     {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
-      trace::printf ("block_device_partition::%s(\"%s\")=@%p\n", __func__,
-                     name_, this);
+      OS_TRACE_PRINTF (posix_io_block_device,
+                       "block_device_partition::%s(\"%s\")=@%p\n", __func__,
+                       name_, this);
 #endif
     }
 
     block_device_partition::~block_device_partition ()
     {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
-      trace::printf ("block_device_partition::%s() @%p %s\n", __func__, this,
-                     name_);
+      OS_TRACE_PRINTF (posix_io_block_device,
+                       "block_device_partition::%s() @%p %s\n", __func__, this,
+                       name_);
 #endif
     }
 
@@ -62,8 +64,9 @@ namespace os
     block_device_partition::configure (blknum_t offset, blknum_t nblocks)
     {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
-      trace::printf ("block_device_partition::%s(%u,%u) @%p\n", __func__,
-                     offset, nblocks, this);
+      OS_TRACE_PRINTF (posix_io_block_device,
+                       "block_device_partition::%s(%u,%u) @%p\n", __func__,
+                       offset, nblocks, this);
 #endif
 
       impl ().configure (offset, nblocks);
@@ -76,14 +79,18 @@ namespace os
         parent_ (parent)
     {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
-      trace::printf ("block_device_partition_impl::%s()=@%p\n", __func__, this);
+      OS_TRACE_PRINTF (posix_io_block_device,
+                       "block_device_partition_impl::%s()=@%p\n", __func__,
+                       this);
 #endif
     }
 
     block_device_partition_impl::~block_device_partition_impl ()
     {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
-      trace::printf ("block_device_partition_impl::%s() @%p\n", __func__, this);
+      OS_TRACE_PRINTF (posix_io_block_device,
+                       "block_device_partition_impl::%s() @%p\n", __func__,
+                       this);
 #endif
     }
 
@@ -105,8 +112,9 @@ namespace os
     block_device_partition_impl::configure (blknum_t offset, blknum_t nblocks)
     {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
-      trace::printf ("block_device_partition_impl::%s(%u,%u) @%p\n", __func__,
-                     offset, nblocks, this);
+      OS_TRACE_PRINTF (posix_io_block_device,
+                       "block_device_partition_impl::%s(%u,%u) @%p\n", __func__,
+                       offset, nblocks, this);
 #endif
 
       partition_offset_blocks_ = offset;
@@ -123,8 +131,9 @@ namespace os
                                            std::va_list args)
     {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
-      trace::printf ("block_device_partition_impl::%s(%d) @%p\n", __func__,
-                     oflag, this);
+      OS_TRACE_PRINTF (posix_io_block_device,
+                       "block_device_partition_impl::%s(%d) @%p\n", __func__,
+                       oflag, this);
 #endif
 
       return parent_.vopen (path, oflag, args);
@@ -135,10 +144,14 @@ namespace os
                                                 std::size_t nblocks)
     {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
-      trace::printf ("block_device_partition_impl::%s(0x%X, %u, %u) @%p\n",
-                     __func__, buf, blknum, nblocks, this);
+      OS_TRACE_PRINTF (posix_io_block_device,
+                       "block_device_partition_impl::%s(0x%X, %u, %u) @%p\n",
+                       __func__, buf, blknum, nblocks, this);
 #endif
 
+      // Pass O_DIRECT to the parent, which may have a cache.
+      parent_.direct (direct_ || (status_flags () & O_DIRECT) != 0);
+
       return parent_.read_block (buf, blknum + partition_offset_blocks_,
                                  nblocks);
     }
@@ -149,19 +162,37 @@ namespace os
                                                  std::size_t nblocks)
     {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
-      trace::printf ("block_device_partition_impl::%s(0x%X, %u, %u) @%p\n",
-                     __func__, buf, blknum, nblocks, this);
+      OS_TRACE_PRINTF (posix_io_block_device,
+                       "block_device_partition_impl::%s(0x%X, %u, %u) @%p\n",
+                       __func__, buf, blknum, nblocks, this);
 #endif
 
+      parent_.direct (direct_ || (status_flags () & O_DIRECT) != 0);
+
       return parent_.write_block (buf, blknum + partition_offset_blocks_,
                                   nblocks);
     }
 
+    int
+    block_device_partition_impl::do_discard (blknum_t blknum,
+                                             std::size_t nblocks)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
+      OS_TRACE_PRINTF (posix_io_block_device,
+                       "block_device_partition_impl::%s(%u, %u) @%p\n",
+                       __func__, blknum, nblocks, this);
+#endif
+
+      return parent_.discard (blknum + partition_offset_blocks_, nblocks);
+    }
+
     void
     block_device_partition_impl::do_sync (void)
     {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
-      trace::printf ("block_device_partition_impl::%s() @%p\n", __func__, this);
+      OS_TRACE_PRINTF (posix_io_block_device,
+                       "block_device_partition_impl::%s() @%p\n", __func__,
+                       this);
 #endif
 
       return parent_.sync ();
@@ -171,7 +202,9 @@ namespace os
     block_device_partition_impl::do_close (void)
     {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
-      trace::printf ("block_device_partition_impl::%s() @%p\n", __func__, this);
+      OS_TRACE_PRINTF (posix_io_block_device,
+                       "block_device_partition_impl::%s() @%p\n", __func__,
+                       this);
 #endif
 
       return parent_.close ();
@@ -0,0 +1,344 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/posix-io/block-device-ram.h>
+#include <cmsis-plus/posix/sys/mman.h>
+
+#include <cmsis-plus/diag/trace.h>
+
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    /**
+     * @details
+     * Nothing is allocated here; the table of chunks is allocated
+     * when the device is first opened, and the chunks when written.
+     */
+    block_device_ram_impl::block_device_ram_impl (
+        std::size_t block_size_bytes, blknum_t nblocks,
+        std::size_t chunk_blocks, rtos::memory::memory_resource* mr) :
+        mr_ (mr != nullptr ? mr : rtos::memory::get_default_resource ()), //
+        chunk_blocks_ (
+            (chunk_blocks != 0 && chunk_blocks < nblocks) ?
+                chunk_blocks : nblocks), //
+        chunk_size_bytes_ (chunk_blocks_ * block_size_bytes), //
+        num_chunks_ ((nblocks + chunk_blocks_ - 1) / chunk_blocks_)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+      OS_TRACE_PRINTF (posix_io_block_device,
+                       "block_device_ram_impl::%s(%u, %u, %u)=@%p\n",
+                       __func__, block_size_bytes, nblocks, chunk_blocks_,
+                       this);
+#endif
+
+      block_logical_size_bytes_ = block_size_bytes;
+      block_physical_size_bytes_ = block_size_bytes;
+      num_blocks_ = nblocks;
+
+      // Reads only look up the chunks, allocation is done by writes.
+      concurrent_reads_ = true;
+    }
+
+    block_device_ram_impl::~block_device_ram_impl ()
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+      OS_TRACE_PRINTF (posix_io_block_device,
+                       "block_device_ram_impl::%s() @%p\n", __func__, this);
+#endif
+
+      internal_free_ ();
+    }
+
+    // ------------------------------------------------------------------------
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+    int
+    block_device_ram_impl::do_vioctl (int request, std::va_list args)
+    {
+      errno = ENOSYS;
+      return -1;
+    }
+
+    int
+    block_device_ram_impl::do_vopen (const char* path, int oflag,
+                                     std::va_list args)
+    {
+      if (chunks_ != nullptr)
+        {
+          return 0;
+        }
+
+      void* table = mr_->allocate (num_chunks_ * sizeof(uint8_t*),
+                                   alignof(uint8_t*));
+      if (table == nullptr)
+        {
+          errno = ENOMEM;
+          return -1;
+        }
+
+      chunks_ = static_cast<uint8_t**> (table);
+      std::fill (chunks_, chunks_ + num_chunks_, nullptr);
+      return 0;
+    }
+
+#pragma GCC diagnostic pop
+
+    /**
+     * @details
+     * The blocks of the chunks not yet allocated are filled
+     * with zeros.
+     */
+    ssize_t
+    block_device_ram_impl::do_read_block (void* buf, blknum_t blknum,
+                                          std::size_t nblocks)
+    {
+      uint8_t* p = static_cast<uint8_t*> (buf);
+      std::size_t bs = block_logical_size_bytes_;
+
+      std::size_t remaining = nblocks;
+      while (remaining > 0)
+        {
+          std::size_t first = blknum % chunk_blocks_;
+          std::size_t n = std::min (chunk_blocks_ - first, remaining);
+
+          uint8_t* chunk = internal_chunk_ (blknum / chunk_blocks_, false);
+          if (chunk == nullptr)
+            {
+              std::memset (p, 0, n * bs);
+            }
+          else
+            {
+              std::memcpy (p, chunk + first * bs, n * bs);
+            }
+
+          p += n * bs;
+          blknum += n;
+          remaining -= n;
+        }
+
+      return static_cast<ssize_t> (nblocks);
+    }
+
+    /**
+     * @details
+     * If a chunk cannot be allocated, the blocks already written
+     * are returned, or -1 with `errno` ENOSPC if none.
+     */
+    ssize_t
+    block_device_ram_impl::do_write_block (const void* buf, blknum_t blknum,
+                                           std::size_t nblocks)
+    {
+      const uint8_t* p = static_cast<const uint8_t*> (buf);
+      std::size_t bs = block_logical_size_bytes_;
+
+      std::size_t remaining = nblocks;
+      while (remaining > 0)
+        {
+          std::size_t first = blknum % chunk_blocks_;
+          std::size_t n = std::min (chunk_blocks_ - first, remaining);
+
+          uint8_t* chunk = internal_chunk_ (blknum / chunk_blocks_, true);
+          if (chunk == nullptr)
+            {
+              if (remaining == nblocks)
+                {
+                  errno = ENOSPC;
+                  return -1;
+                }
+              break;
+            }
+          std::memcpy (chunk + first * bs, p, n * bs);
+
+          p += n * bs;
+          blknum += n;
+          remaining -= n;
+        }
+
+      return static_cast<ssize_t> (nblocks - remaining);
+    }
+
+    /**
+     * @details
+     * The chunks with all blocks discarded are returned to the
+     * memory resource, so the mappings inside them are no longer
+     * valid; in the other chunks, the blocks are cleared.
+     */
+    int
+    block_device_ram_impl::do_discard (blknum_t blknum, std::size_t nblocks)
+    {
+      std::size_t bs = block_logical_size_bytes_;
+
+      std::size_t remaining = nblocks;
+      while (remaining > 0)
+        {
+          std::size_t index = blknum / chunk_blocks_;
+          std::size_t first = blknum % chunk_blocks_;
+          std::size_t n = std::min (chunk_blocks_ - first, remaining);
+          // The last chunk may be shorter.
+          std::size_t length = std::min (chunk_blocks_,
+                                         num_blocks_ - index * chunk_blocks_);
+
+          uint8_t* chunk = internal_chunk_ (index, false);
+          if (chunk != nullptr)
+            {
+              if (first == 0 && n == length)
+                {
+                  mr_->deallocate (chunk, chunk_size_bytes_);
+                  chunks_[index] = nullptr;
+                  --allocated_chunks_;
+                }
+              else
+                {
+                  std::memset (chunk + first * bs, 0, n * bs);
+                }
+            }
+
+          blknum += n;
+          remaining -= n;
+        }
+
+      return 0;
+    }
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+    /**
+     * @details
+     * The mapping points inside the chunk, which is allocated
+     * if needed; the range must not cross a chunk boundary,
+     * otherwise `errno` is EINVAL.
+     */
+    void*
+    block_device_ram_impl::do_mmap (std::size_t length, int prot, int flags,
+                                    off_t offset)
+    {
+      std::size_t size = num_blocks_ * block_logical_size_bytes_;
+      std::size_t start = static_cast<std::size_t> (offset);
+      if ((start > size) || (length > size - start))
+        {
+          errno = ENXIO;
+          return MAP_FAILED;
+        }
+
+      std::size_t first = start % chunk_size_bytes_;
+      if (length > chunk_size_bytes_ - first)
+        {
+          errno = EINVAL;
+          return MAP_FAILED;
+        }
+
+      uint8_t* chunk = internal_chunk_ (start / chunk_size_bytes_, true);
+      if (chunk == nullptr)
+        {
+          errno = ENOMEM;
+          return MAP_FAILED;
+        }
+
+      return chunk + first;
+    }
+
+#pragma GCC diagnostic pop
+
+    void
+    block_device_ram_impl::do_sync (void)
+    {
+      ;
+    }
+
+    /**
+     * @details
+     * The content is kept, for the next open.
+     */
+    int
+    block_device_ram_impl::do_close (void)
+    {
+      return 0;
+    }
+
+    // ------------------------------------------------------------------------
+
+    uint8_t*
+    block_device_ram_impl::internal_chunk_ (std::size_t index, bool allocate)
+    {
+      if (chunks_ == nullptr)
+        {
+          return nullptr;
+        }
+
+      if (chunks_[index] == nullptr && allocate)
+        {
+          void* chunk = mr_->allocate (chunk_size_bytes_);
+          if (chunk != nullptr)
+            {
+              std::memset (chunk, 0, chunk_size_bytes_);
+              chunks_[index] = static_cast<uint8_t*> (chunk);
+              ++allocated_chunks_;
+            }
+        }
+
+      return chunks_[index];
+    }
+
+    void
+    block_device_ram_impl::internal_free_ (void)
+    {
+      if (chunks_ == nullptr)
+        {
+          return;
+        }
+
+      for (std::size_t i = 0; i < num_chunks_; ++i)
+        {
+          if (chunks_[i] != nullptr)
+            {
+              mr_->deallocate (chunks_[i], chunk_size_bytes_);
+            }
+        }
+      mr_->deallocate (chunks_, num_chunks_ * sizeof(uint8_t*),
+                       alignof(uint8_t*));
+
+      chunks_ = nullptr;
+      allocated_chunks_ = 0;
+    }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
@@ -29,6 +29,11 @@
 #include <cmsis-plus/posix-io/device-registry.h>
 
 #include <cmsis-plus/posix/sys/ioctl.h>
+#include <cmsis-plus/posix/sys/uio.h>
+#include <cmsis-plus/posix/sys/mman.h>
+
+#include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/cortexm/cache.h>
 
 #include <cstring>
 #include <cassert>
@@ -37,6 +42,48 @@
 
 // ----------------------------------------------------------------------------
 
+/**
+ * @cond ignore
+ */
+
+namespace
+{
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+  void
+  post_semaphore (os::posix::block_device::request* req, void* arg)
+  {
+    static_cast<os::rtos::semaphore_binary*> (arg)->post ();
+  }
+
+#pragma GCC diagnostic pop
+
+  ssize_t
+  wait_request (os::posix::block_device::request& req,
+                os::rtos::semaphore_binary& sem)
+  {
+    // The callback may run before submit() returns,
+    // when the device is not asynchronous.
+    while (!req.done ())
+      {
+        sem.wait ();
+      }
+
+    if (req.result < 0)
+      {
+        errno = req.error;
+      }
+    return req.result;
+  }
+}
+
+/**
+ * @endcond
+ */
+
+// ----------------------------------------------------------------------------
+
 namespace os
 {
   namespace posix
@@ -48,7 +95,8 @@ namespace os
           { impl, type::block_device, name, }
     {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-      trace::printf ("block_device::%s(\"%s\")=@%p\n", __func__, name_, this);
+      OS_TRACE_PRINTF (posix_io_block_device, "block_device::%s(\"%s\")=@%p\n",
+                       __func__, name_, this);
 #endif
 
       device_registry<device>::link (this);
@@ -57,7 +105,8 @@ namespace os
     block_device::~block_device ()
     {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-      trace::printf ("block_device::%s() @%p %s\n", __func__, this, name_);
+      OS_TRACE_PRINTF (posix_io_block_device, "block_device::%s() @%p %s\n",
+                       __func__, this, name_);
 #endif
     }
 
@@ -67,8 +116,9 @@ namespace os
     block_device::read_block (void* buf, blknum_t blknum, std::size_t nblocks)
     {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-      trace::printf ("block_device::%s(%p, %u, %u) @%p\n", __func__, buf,
-                     blknum, nblocks, this);
+      OS_TRACE_PRINTF (posix_io_block_device,
+                       "block_device::%s(%p, %u, %u) @%p\n", __func__, buf,
+                       blknum, nblocks, this);
 #endif
 
       if (blknum + nblocks > impl ().num_blocks_)
@@ -83,7 +133,7 @@ namespace os
           return -1;
         }
 
-      return impl ().do_read_block (buf, blknum, nblocks);
+      return impl ().internal_io_ (buf, blknum, nblocks, false);
     }
 
     ssize_t
@@ -91,8 +141,42 @@ namespace os
                                std::size_t nblocks)
     {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-      trace::printf ("block_device::%s(%p, %u, %u) @%p\n", __func__, buf,
-                     blknum, nblocks, this);
+      OS_TRACE_PRINTF (posix_io_block_device,
+                       "block_device::%s(%p, %u, %u) @%p\n", __func__, buf,
+                       blknum, nblocks, this);
+#endif
+
+      if (blknum + nblocks > impl ().num_blocks_)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      if (!impl ().do_is_opened ())
+        {
+          errno = EBADF; // Not opened.
+          return -1;
+        }
+
+      return impl ().internal_io_ (const_cast<void*> (buf), blknum, nblocks,
+                                   true);
+    }
+
+    /**
+     * @details
+     * File systems call it for the freed blocks, so flash based
+     * devices can erase them in advance. Partitions forward it to
+     * the parent device, with the offset added.
+     *
+     * The caller must not have transfers in progress on the
+     * same blocks.
+     */
+    int
+    block_device::discard (blknum_t blknum, std::size_t nblocks)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+      OS_TRACE_PRINTF (posix_io_block_device, "block_device::%s(%u, %u) @%p\n",
+                       __func__, blknum, nblocks, this);
 #endif
 
       if (blknum + nblocks > impl ().num_blocks_)
@@ -107,14 +191,166 @@ namespace os
           return -1;
         }
 
-      return impl ().do_write_block (buf, blknum, nblocks);
+      if (nblocks == 0)
+        {
+          return 0;
+        }
+
+      return impl ().do_discard (blknum, nblocks);
+    }
+
+    /**
+     * @details
+     * The requests are queued in order, and the device works on
+     * the first one. Devices without asynchronous support perform
+     * the transfer in `submit()`, which invokes the callback
+     * before returning.
+     *
+     * The queue is protected by an interrupts critical section,
+     * so completions can be signalled from interrupts; requests
+     * can also be submitted from the callbacks.
+     */
+    int
+    block_device::submit (request& req)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+      OS_TRACE_PRINTF (posix_io_block_device, "block_device::%s(%p) @%p\n",
+                       __func__, &req, this);
+#endif
+
+      if (req.buffer == nullptr || req.nblocks == 0
+          || req.blknum + req.nblocks > impl ().num_blocks_)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      if (!impl ().do_is_opened ())
+        {
+          errno = EBADF; // Not opened.
+          return -1;
+        }
+
+      return impl ().internal_submit_ (req, true);
+    }
+
+    /**
+     * @details
+     * Requests still waiting in the queue are always cancelled;
+     * the active one only if the driver can abort it. In both cases
+     * the callback is invoked with `error` set to ECANCELED.
+     */
+    int
+    block_device::cancel (request& req)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+      OS_TRACE_PRINTF (posix_io_block_device, "block_device::%s(%p) @%p\n",
+                       __func__, &req, this);
+#endif
+
+      return impl ().internal_cancel_ (req);
+    }
+
+    /**
+     * @details
+     * The synchronous version of `submit()`; must not be called
+     * from interrupt service routines.
+     */
+    ssize_t
+    block_device::transfer (request& req)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+      OS_TRACE_PRINTF (posix_io_block_device, "block_device::%s(%p) @%p\n",
+                       __func__, &req, this);
+#endif
+
+      rtos::semaphore_binary sem
+        { 0 };
+
+      req.callback = post_semaphore;
+      req.arg = &sem;
+
+      if (submit (req) != 0)
+        {
+          return -1;
+        }
+
+      return wait_request (req, sem);
+    }
+
+    void
+    block_device::queue_size (std::size_t n)
+    {
+      impl ().queue_size_ = (n > 0) ? n : 1;
+    }
+
+    /**
+     * @details
+     * With the elevator, the synchronous `read_block()` and
+     * `write_block()` also go via the queue, and must be called
+     * from threads.
+     */
+    void
+    block_device::queue_policy (policy_t p)
+    {
+      impl ().policy_ = p;
+    }
+
+    /**
+     * @details
+     * The buffer must not be changed while requests are queued.
+     */
+    void
+    block_device::merge_buffer (void* buf, std::size_t size_bytes)
+    {
+      impl ().merge_buffer_ = static_cast<uint8_t*> (buf);
+      impl ().merge_size_bytes_ = (buf != nullptr) ? size_bytes : 0;
     }
 
+    /**
+     * @details
+     * The access pattern is only recorded here; the devices with a
+     * cache use it to tune the read-ahead.
+     */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+    int
+    block_device::fadvise (off_t offset, off_t len, int advice)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+      OS_TRACE_PRINTF (posix_io_block_device,
+                       "block_device::%s(%d, %d, %d) @%p\n", __func__, offset,
+                       len, advice, this);
+#endif
+
+      switch (advice)
+        {
+        case POSIX_FADV_NORMAL:
+        case POSIX_FADV_RANDOM:
+        case POSIX_FADV_SEQUENTIAL:
+          advice_ = advice;
+          return 0;
+
+        case POSIX_FADV_WILLNEED:
+        case POSIX_FADV_DONTNEED:
+        case POSIX_FADV_NOREUSE:
+          return 0;
+
+        default:
+          errno = EINVAL;
+          return -1;
+        }
+    }
+
+#pragma GCC diagnostic pop
+
     int
     block_device::vioctl (int request, std::va_list args)
     {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-      trace::printf ("block_device::%s(%d) @%p\n", __func__, request, this);
+      OS_TRACE_PRINTF (posix_io_block_device, "block_device::%s(%d) @%p\n",
+                       __func__, request, this);
 #endif
 
       if (!impl ().do_is_opened ())
@@ -170,6 +406,24 @@ namespace os
             return 0;
           }
 
+        case BLKDISCARD:
+          // Discard a range of bytes {start, length}, aligned to blocks.
+          {
+            uint64_t* range = va_arg(args, uint64_t*);
+            std::size_t bs = impl ().block_logical_size_bytes_;
+            if (range == nullptr || bs == 0 || (range[0] % bs) != 0
+                || (range[1] % bs) != 0)
+              {
+                errno = EINVAL;
+                return -1;
+              }
+
+            // Not virtual, the lockable devices are already locked.
+            return block_device::discard (
+                static_cast<blknum_t> (range[0] / bs),
+                static_cast<std::size_t> (range[1] / bs));
+          }
+
         default:
 
           // Execute the implementation specific code.
@@ -182,16 +436,20 @@ namespace os
     block_device_impl::block_device_impl (void)
     {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-      trace::printf ("block_device_impl::%s()=@%p\n", __func__, this);
+      OS_TRACE_PRINTF (posix_io_block_device, "block_device_impl::%s()=@%p\n",
+                       __func__, this);
 #endif
     }
 
     block_device_impl::~block_device_impl ()
     {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-      trace::printf ("block_device_impl::%s() @%p\n", __func__, this);
+      OS_TRACE_PRINTF (posix_io_block_device, "block_device_impl::%s() @%p\n",
+                       __func__, this);
 #endif
 
+      internal_free_bounce_buffer_ ();
+
       block_logical_size_bytes_ = 0;
       num_blocks_ = 0;
     }
@@ -202,8 +460,9 @@ namespace os
     block_device_impl::do_lseek (off_t offset, int whence)
     {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-      trace::printf ("block_device_impl::%s(%d, %d) @%p\n", __func__, offset,
-                     whence, this);
+      OS_TRACE_PRINTF (posix_io_block_device,
+                       "block_device_impl::%s(%d, %d) @%p\n", __func__, offset,
+                       whence, this);
 #endif
 
       errno = 0;
@@ -235,74 +494,818 @@ namespace os
 
     // ------------------------------------------------------------------------
 
+    /**
+     * @details
+     * The offset and the size do not need to be aligned to blocks;
+     * the partial blocks at the ends are read via a bounce buffer.
+     */
     ssize_t
     block_device_impl::do_read (void* buf, std::size_t nbyte)
     {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-      trace::printf ("block_device_impl::%s(%p, %u) @%p\n", __func__, buf,
-                     nbyte, this);
+      OS_TRACE_PRINTF (posix_io_block_device,
+                       "block_device_impl::%s(%p, %u) @%p\n", __func__, buf,
+                       nbyte, this);
 #endif
 
-      if ((block_logical_size_bytes_ == 0)
-          || ((nbyte % block_logical_size_bytes_) != 0)
-          || ((static_cast<std::size_t> (offset_) % block_logical_size_bytes_)
-              != 0))
+      return internal_transfer_bytes_ (buf, nbyte, offset_, false);
+    }
+
+    /**
+     * @details
+     * The offset and the size do not need to be aligned to blocks;
+     * the partial blocks at the ends are read, updated and
+     * written back via a bounce buffer.
+     */
+    ssize_t
+    block_device_impl::do_write (const void* buf, std::size_t nbyte)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+      OS_TRACE_PRINTF (posix_io_block_device,
+                       "block_device_impl::%s(%p, %u) @%p\n", __func__, buf,
+                       nbyte, this);
+#endif
+
+      return internal_transfer_bytes_ (const_cast<void*> (buf), nbyte, offset_,
+                                       true);
+    }
+
+    // ------------------------------------------------------------------------
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+    /**
+     * @details
+     * The default is for devices without asynchronous support,
+     * the request is performed synchronously.
+     */
+    int
+    block_device_impl::do_start_request (request& req)
+    {
+      errno = ENOTSUP;
+      return -1;
+    }
+
+    bool
+    block_device_impl::do_abort_request (request& req)
+    {
+      return false;
+    }
+
+    int
+    block_device_impl::do_discard (blknum_t blknum, std::size_t nblocks)
+    {
+      errno = ENOTSUP;
+      return -1;
+    }
+
+#pragma GCC diagnostic pop
+
+    /**
+     * @details
+     * Called by the asynchronous drivers, usually from the
+     * transfer complete interrupt. The callback is invoked, and
+     * the next request in the queue, if any, is started, in the
+     * same context.
+     */
+    void
+    block_device_impl::complete_request (ssize_t result, int error)
+    {
+      internal_finish_ (active_, result, error);
+      internal_dispatch_ ();
+    }
+
+    /**
+     * @details
+     * Asynchronous drivers must not call it from `do_start_request()`.
+     *
+     * These requests are not limited by the queue size, each one
+     * has a thread waiting for it.
+     */
+    ssize_t
+    block_device_impl::transfer_request (void* buf, blknum_t blknum,
+                                         std::size_t nblocks, bool is_write)
+    {
+      rtos::semaphore_binary sem
+        { 0 };
+
+      request req;
+      req.buffer = buf;
+      req.blknum = blknum;
+      req.nblocks = nblocks;
+      req.is_write = is_write;
+      req.callback = post_semaphore;
+      req.arg = &sem;
+
+      if (internal_submit_ (req, false) != 0)
         {
-          errno = EINVAL;
           return -1;
         }
 
-      std::size_t nblocks = nbyte / block_logical_size_bytes_;
-      blknum_t blknum = static_cast<std::size_t> (offset_)
-          / block_logical_size_bytes_;
+      return wait_request (req, sem);
+    }
 
-      if (blknum + nblocks > num_blocks_)
+    /**
+     * @details
+     * With the elevator, the synchronous transfers also go through
+     * the queue, so they can be ordered and merged with the requests
+     * of the other threads.
+     */
+    ssize_t
+    block_device_impl::internal_io_ (void* buf, blknum_t blknum,
+                                     std::size_t nblocks, bool is_write)
+    {
+      if (policy_ == block_device::policy::elevator
+          && !rtos::interrupts::in_handler_mode ())
         {
-          errno = EINVAL;
-          return -1;
+          return transfer_request (buf, blknum, nblocks, is_write);
         }
 
-      ssize_t ret = do_read_block (buf, blknum, nblocks);
-      if (ret >= 0)
+      internal_cache_before_ (buf, nblocks, is_write);
+
+      if (is_write)
         {
-          ret *= block_logical_size_bytes_;
+          return do_write_block (buf, blknum, nblocks);
         }
+      ssize_t ret = do_read_block (buf, blknum, nblocks);
+      internal_cache_after_ (buf, nblocks, is_write);
       return ret;
     }
 
+    int
+    block_device_impl::internal_submit_ (request& req, bool bounded)
+    {
+      if (req.state_ == request::state::queued
+          || req.state_ == request::state::active)
+        {
+          errno = EBUSY;
+          return -1;
+        }
+
+      req.result = 0;
+      req.error = 0;
+      req.next_ = nullptr;
+
+        {
+          // ----- Enter critical section -------------------------------------
+          rtos::interrupts::critical_section ics;
+
+          if (bounded && queued_ >= queue_size_)
+            {
+              errno = EAGAIN;
+              return -1;
+            }
+
+          if (pending_tail_ == nullptr)
+            {
+              pending_head_ = &req;
+            }
+          else
+            {
+              pending_tail_->next_ = &req;
+            }
+          pending_tail_ = &req;
+          ++queued_;
+
+          req.state_ = request::state::queued;
+          // ----- Exit critical section --------------------------------------
+        }
+
+      internal_dispatch_ ();
+      return 0;
+    }
+
+    /**
+     * @details
+     * Runs until the device is busy with an asynchronous transfer,
+     * or there are no more requests. Only one context dispatches
+     * at a time, the one which found the device idle.
+     */
+    void
+    block_device_impl::internal_dispatch_ (void)
+    {
+      request* req;
+      while ((req = internal_select_ ()) != nullptr)
+        {
+          if (req == &batch_ && req->is_write && req->buffer == merge_buffer_)
+            {
+              // Gather the data of the merged writes.
+              uint8_t* p = merge_buffer_;
+              for (request* r = batch_first_; r != nullptr; r = r->next_)
+                {
+                  std::size_t n = r->nblocks * block_logical_size_bytes_;
+                  std::memcpy (p, r->buffer, n);
+                  p += n;
+                }
+            }
+
+          internal_cache_before_ (req->buffer, req->nblocks, req->is_write);
+
+          if (do_start_request (*req) == 0)
+            {
+              return; // The driver will complete it.
+            }
+
+          ssize_t ret = -1;
+          int err = errno;
+          if (err == ENOTSUP)
+            {
+              if (req->is_write)
+                {
+                  ret = do_write_block (req->buffer, req->blknum,
+                                        req->nblocks);
+                }
+              else
+                {
+                  ret = do_read_block (req->buffer, req->blknum, req->nblocks);
+                }
+              err = (ret < 0) ? errno : 0;
+            }
+
+          internal_finish_ (req, ret, err);
+        }
+    }
+
+    /**
+     * @details
+     * With the FIFO policy, the oldest request is started. With
+     * the elevator, the request with the highest priority, and among
+     * them the first at or after the current position, in increasing
+     * block order (C-LOOK); then the following requests in the same
+     * direction and adjacent on the media are merged, if their buffers
+     * are adjacent in memory or they fit in the merge buffer.
+     */
+    block_device_impl::request*
+    block_device_impl::internal_select_ (void)
+    {
+      // ----- Enter critical section -----------------------------------------
+      rtos::interrupts::critical_section ics;
+
+      if (active_ != nullptr || pending_head_ == nullptr)
+        {
+          return nullptr;
+        }
+
+      request* first = pending_head_;
+      if (policy_ == block_device::policy::elevator)
+        {
+          for (request* r = pending_head_->next_; r != nullptr; r = r->next_)
+            {
+              if (internal_precedes_ (*r, *first))
+                {
+                  first = r;
+                }
+            }
+        }
+      internal_unlink_pending_ (*first);
+      first->state_ = request::state::active;
+
+      std::size_t bs = block_logical_size_bytes_;
+      std::size_t total = first->nblocks;
+      bool copy = false;
+      request* last = first;
+
+      while (policy_ == block_device::policy::elevator)
+        {
+          request* r = pending_head_;
+          while (r != nullptr
+              && (r->is_write != first->is_write
+                  || r->blknum != first->blknum + total))
+            {
+              r = r->next_;
+            }
+          if (r == nullptr)
+            {
+              break;
+            }
+
+          std::size_t bytes = (total + r->nblocks) * bs;
+          if (!copy
+              && r->buffer == static_cast<uint8_t*> (first->buffer) + total * bs)
+            {
+              // Adjacent in memory too, no copy needed.
+            }
+          else if (merge_buffer_ != nullptr && bytes <= merge_size_bytes_)
+            {
+              copy = true;
+            }
+          else
+            {
+              break;
+            }
+
+          internal_unlink_pending_ (*r);
+          r->state_ = request::state::active;
+          last->next_ = r;
+          last = r;
+          total += r->nblocks;
+        }
+
+      head_blknum_ = first->blknum + total;
+
+      if (last == first)
+        {
+          active_ = first;
+          return first;
+        }
+
+      batch_first_ = first;
+      batch_.buffer = copy ? merge_buffer_ : first->buffer;
+      batch_.blknum = first->blknum;
+      batch_.nblocks = total;
+      batch_.is_write = first->is_write;
+      batch_.priority = first->priority;
+      batch_.state_ = request::state::active;
+
+      active_ = &batch_;
+      return &batch_;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    bool
+    block_device_impl::internal_precedes_ (const request& a,
+                                           const request& b) const
+    {
+      if (a.priority != b.priority)
+        {
+          return a.priority > b.priority;
+        }
+
+      // The requests before the current position wait for the next sweep.
+      bool a_wraps = (a.blknum < head_blknum_);
+      bool b_wraps = (b.blknum < head_blknum_);
+      if (a_wraps != b_wraps)
+        {
+          return !a_wraps;
+        }
+      return a.blknum < b.blknum;
+    }
+
+    void
+    block_device_impl::internal_unlink_pending_ (request& req)
+    {
+      // Must be called in a critical section.
+      request* prev = nullptr;
+      for (request* r = pending_head_; r != &req; r = r->next_)
+        {
+          prev = r;
+        }
+
+      if (prev == nullptr)
+        {
+          pending_head_ = req.next_;
+        }
+      else
+        {
+          prev->next_ = req.next_;
+        }
+      if (pending_tail_ == &req)
+        {
+          pending_tail_ = prev;
+        }
+      req.next_ = nullptr;
+    }
+
+    /**
+     * @details
+     * For a batch, the result is distributed to the merged
+     * requests in block order, and the data read is scattered
+     * from the merge buffer. The callbacks are invoked in the
+     * same order.
+     */
+    void
+    block_device_impl::internal_finish_ (request* req, ssize_t result,
+                                         int error)
+    {
+      request* members;
+        {
+          // ----- Enter critical section -------------------------------------
+          rtos::interrupts::critical_section ics;
+
+          // Already completed or cancelled.
+          if (req == nullptr || req != active_)
+            {
+              return;
+            }
+
+          if (req == &batch_)
+            {
+              members = batch_first_;
+              batch_first_ = nullptr;
+              batch_.state_ = request::state::done;
+            }
+          else
+            {
+              members = req;
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+
+      internal_cache_after_ (req->buffer, req->nblocks, req->is_write);
+
+      std::size_t bs = block_logical_size_bytes_;
+      std::size_t left = (result > 0) ? static_cast<std::size_t> (result) : 0;
+      const uint8_t* p = static_cast<const uint8_t*> (req->buffer);
+      bool scatter = (req == &batch_) && !req->is_write
+          && (req->buffer == merge_buffer_);
+
+      request* r = members;
+      while (r != nullptr)
+        {
+          request* next = r->next_;
+
+          // Once done, the request may be reused, get the callback first.
+          request::callback_t callback = r->callback;
+          void* arg = r->arg;
+
+          std::size_t n = (left < r->nblocks) ? left : r->nblocks;
+          if (scatter && n > 0)
+            {
+              std::memcpy (r->buffer, p, n * bs);
+            }
+          p += r->nblocks * bs;
+          left -= n;
+
+          if (result < 0)
+            {
+              r->result = -1;
+              r->error = error;
+            }
+          else
+            {
+              r->result = static_cast<ssize_t> (n);
+              r->error = 0;
+            }
+
+            {
+              // ----- Enter critical section ---------------------------------
+              rtos::interrupts::critical_section ics;
+
+              r->next_ = nullptr;
+              --queued_;
+              r->state_ = request::state::done;
+              if (next == nullptr)
+                {
+                  active_ = nullptr;
+                }
+              // ----- Exit critical section ----------------------------------
+            }
+
+          if (callback != nullptr)
+            {
+              callback (r, arg);
+            }
+          r = next;
+        }
+    }
+
+    int
+    block_device_impl::internal_cancel_ (request& req)
+    {
+      bool removed = false;
+      bool active = false;
+      request::callback_t callback = nullptr;
+      void* arg = nullptr;
+        {
+          // ----- Enter critical section -------------------------------------
+          rtos::interrupts::critical_section ics;
+
+          if (req.state_ == request::state::queued)
+            {
+              internal_unlink_pending_ (req);
+              --queued_;
+
+              callback = req.callback;
+              arg = req.arg;
+
+              req.result = -1;
+              req.error = ECANCELED;
+              req.state_ = request::state::done;
+              removed = true;
+            }
+          else if (req.state_ == request::state::active)
+            {
+              active = true;
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+
+      if (removed)
+        {
+          if (callback != nullptr)
+            {
+              callback (&req, arg);
+            }
+          return 0;
+        }
+
+      if (active)
+        {
+          // If merged, the entire batch is aborted.
+          request* act = active_;
+          if (act != nullptr && do_abort_request (*act))
+            {
+              internal_finish_ (act, -1, ECANCELED);
+              internal_dispatch_ ();
+              return 0;
+            }
+          errno = EBUSY;
+          return -1;
+        }
+
+      errno = ENOENT;
+      return -1;
+    }
+
+    // ------------------------------------------------------------------------
+
     ssize_t
-    block_device_impl::do_write (const void* buf, std::size_t nbyte)
+    block_device_impl::do_readv (const struct iovec* iov, int iovcnt)
+    {
+      return internal_transfer_vector_ (iov, iovcnt, offset_, false);
+    }
+
+    ssize_t
+    block_device_impl::do_writev (const struct iovec* iov, int iovcnt)
+    {
+      return internal_transfer_vector_ (iov, iovcnt, offset_, true);
+    }
+
+    ssize_t
+    block_device_impl::do_preadv (const struct iovec* iov, int iovcnt,
+                                  off_t offset)
+    {
+      return internal_transfer_vector_ (iov, iovcnt, offset, false);
+    }
+
+    ssize_t
+    block_device_impl::do_pwritev (const struct iovec* iov, int iovcnt,
+                                   off_t offset)
+    {
+      return internal_transfer_vector_ (iov, iovcnt, offset, true);
+    }
+
+    /**
+     * @details
+     * Only devices that set `storage_` can be mapped; the mapping
+     * points directly inside the storage, which remains valid
+     * after `munmap()`. Private writable mappings of read-only
+     * storage, like XIP flash, are served by a copy.
+     */
+    void*
+    block_device_impl::do_mmap (std::size_t length, int prot, int flags,
+                                off_t offset)
+    {
+      if (storage_ == nullptr)
+        {
+          errno = ENODEV;
+          return MAP_FAILED;
+        }
+
+      std::size_t size = num_blocks_ * block_logical_size_bytes_;
+      if ((static_cast<std::size_t> (offset) > size)
+          || (length > size - static_cast<std::size_t> (offset)))
+        {
+          errno = ENXIO;
+          return MAP_FAILED;
+        }
+
+      if (((prot & PROT_WRITE) != 0) && !storage_writable_)
+        {
+          errno = ((flags & MAP_PRIVATE) != 0) ? ENODEV : EACCES;
+          return MAP_FAILED;
+        }
+
+      return static_cast<uint8_t*> (storage_) + offset;
+    }
+
+    /**
+     * @details
+     * Fragments adjacent in memory are merged and transferred
+     * together, so the aligned parts go to the device with a
+     * single multi-block call. The offset is not changed, the
+     * caller adjusts it.
+     */
+    ssize_t
+    block_device_impl::internal_transfer_vector_ (const struct iovec* iov,
+                                                  int iovcnt, off_t offset,
+                                                  bool is_write)
     {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-      trace::printf ("block_device_impl::%s(%p, %u) @%p\n", __func__, buf,
-                     nbyte, this);
+      OS_TRACE_PRINTF (posix_io_block_device,
+                       "block_device_impl::%s(%p, %d, %d, %d) @%p\n", __func__,
+                       iov, iovcnt, offset, is_write, this);
 #endif
 
-      if ((block_logical_size_bytes_ == 0)
-          || ((nbyte % block_logical_size_bytes_) != 0)
-          || ((static_cast<std::size_t> (offset_) % block_logical_size_bytes_)
-              != 0))
+      ssize_t total = 0;
+
+      int i = 0;
+      while (i < iovcnt)
+        {
+          uint8_t* base = static_cast<uint8_t*> (iov[i].iov_base);
+          std::size_t len = iov[i].iov_len;
+
+          // Extend the run over the following adjacent fragments.
+          for (++i;
+              (i < iovcnt) && (static_cast<uint8_t*> (iov[i].iov_base)
+                  == base + len); ++i)
+            {
+              len += iov[i].iov_len;
+            }
+
+          if (len == 0)
+            {
+              continue;
+            }
+
+          ssize_t ret = internal_transfer_bytes_ (base, len, offset + total,
+                                                  is_write);
+          if (ret < 0)
+            {
+              return (total > 0) ? total : -1;
+            }
+
+          total += ret;
+
+          if (static_cast<std::size_t> (ret) < len)
+            {
+              break; // Short transfer.
+            }
+        }
+
+      return total;
+    }
+
+    /**
+     * @details
+     * The partial head and tail blocks go through the bounce
+     * buffer, the aligned middle directly to the device, with
+     * a single multi-block call.
+     *
+     * If a part fails after some data was transferred, the partial
+     * count is returned, as for a short write.
+     */
+    ssize_t
+    block_device_impl::internal_transfer_bytes_ (void* buf, std::size_t nbyte,
+                                                 off_t offset, bool is_write)
+    {
+      std::size_t bs = block_logical_size_bytes_;
+      if ((bs == 0) || (offset < 0)
+          || (static_cast<std::size_t> (offset) + nbyte > num_blocks_ * bs))
         {
           errno = EINVAL;
           return -1;
         }
 
-      std::size_t nblocks = nbyte / block_logical_size_bytes_;
-      blknum_t blknum = static_cast<std::size_t> (offset_)
-          / block_logical_size_bytes_;
+      uint8_t* p = static_cast<uint8_t*> (buf);
+      std::size_t pos = static_cast<std::size_t> (offset);
+      std::size_t left = nbyte;
 
-      if (blknum + nblocks > num_blocks_)
+      while (left > 0)
+        {
+          blknum_t blknum = pos / bs;
+          std::size_t ofs = pos % bs;
+
+          std::size_t n;
+          if (ofs == 0 && left >= bs)
+            {
+              // The aligned middle.
+              std::size_t nblocks = left / bs;
+
+              ssize_t ret = internal_io_ (p, blknum, nblocks, is_write);
+
+              if (ret < 0)
+                {
+                  break;
+                }
+
+              n = static_cast<std::size_t> (ret) * bs;
+              if (static_cast<std::size_t> (ret) < nblocks)
+                {
+                  pos += n;
+                  left -= n;
+                  break; // Short transfer.
+                }
+            }
+          else
+            {
+              // A partial block, at the head or the tail.
+              n = bs - ofs;
+              if (n > left)
+                {
+                  n = left;
+                }
+
+              uint8_t* bounce = internal_bounce_buffer_ ();
+              if (bounce == nullptr)
+                {
+                  errno = ENOMEM;
+                  break;
+                }
+
+              if (internal_io_ (bounce, blknum, 1, false) != 1)
+                {
+                  break;
+                }
+
+              if (is_write)
+                {
+                  std::memcpy (bounce + ofs, p, n);
+                  if (internal_io_ (bounce, blknum, 1, true) != 1)
+                    {
+                      break;
+                    }
+                }
+              else
+                {
+                  std::memcpy (p, bounce + ofs, n);
+                }
+            }
+
+          p += n;
+          pos += n;
+          left -= n;
+        }
+
+      std::size_t done = nbyte - left;
+      if (left > 0 && done == 0)
         {
-          errno = EINVAL;
           return -1;
         }
+      return static_cast<ssize_t> (done);
+    }
 
-      ssize_t ret = do_write_block (buf, blknum, nblocks);
-      if (ret >= 0)
+    uint8_t*
+    block_device_impl::internal_bounce_buffer_ (void)
+    {
+      if (bounce_size_bytes_ != block_logical_size_bytes_)
         {
-          ret *= block_logical_size_bytes_;
+          // The block size is known only after open().
+          internal_free_bounce_buffer_ ();
+
+          // Aligned to the cache line, so DMA drivers can use it.
+          void* mem = cortexm::cache::allocate_dma_buffer (
+              block_logical_size_bytes_);
+          bounce_ = static_cast<uint8_t*> (mem);
+          if (bounce_ != nullptr)
+            {
+              bounce_size_bytes_ = block_logical_size_bytes_;
+            }
         }
-      return ret;
+      return bounce_;
+    }
+
+    void
+    block_device_impl::internal_free_bounce_buffer_ (void)
+    {
+      if (bounce_ != nullptr)
+        {
+          cortexm::cache::deallocate_dma_buffer (bounce_, bounce_size_bytes_);
+          bounce_ = nullptr;
+        }
+      bounce_size_bytes_ = 0;
+    }
+
+    /*
+     * Before a transfer with DMA, write back the data to be written;
+     * for reads, also discard the cached lines, so no dirty line is
+     * evicted over the data received.
+     */
+    void
+    block_device_impl::internal_cache_before_ (void* buf, std::size_t nblocks,
+                                               bool is_write)
+    {
+      if (!dma_)
+        {
+          return;
+        }
+
+      std::size_t nbyte = nblocks * block_logical_size_bytes_;
+      if (is_write)
+        {
+          cortexm::cache::clean (buf, nbyte);
+        }
+      else
+        {
+          cortexm::cache::clean_invalidate (buf, nbyte);
+        }
+    }
+
+    /*
+     * After a read with DMA, discard the lines the CPU may have
+     * loaded during the transfer.
+     */
+    void
+    block_device_impl::internal_cache_after_ (void* buf, std::size_t nblocks,
+                                              bool is_write)
+    {
+      if (!dma_ || is_write)
+        {
+          return;
+        }
+
+      cortexm::cache::invalidate (buf, nblocks * block_logical_size_bytes_);
     }
 
   // ==========================================================================
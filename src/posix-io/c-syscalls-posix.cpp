@@ -38,8 +38,11 @@
 #include <cmsis-plus/posix-io/directory.h>
 #include <cmsis-plus/posix-io/socket.h>
 #include <cmsis-plus/posix-io/net-stack.h>
+#include <cmsis-plus/posix-io/aio.h>
+#include <cmsis-plus/posix-io/pipe.h>
 
 #include <cmsis-plus/posix/sys/uio.h>
+#include <cmsis-plus/posix/sys/mman.h>
 
 #include <cmsis-plus/diag/trace.h>
 
@@ -118,6 +121,12 @@ __posix_close (int fildes)
   return io->close ();
 }
 
+int
+__posix_pipe (int fildes[2])
+{
+  return posix::pipe (fildes);
+}
+
 // ----------------------------------------------------------------------------
 
 ssize_t
@@ -166,6 +175,140 @@ __posix_writev (int fildes, const struct iovec* iov, int iovcnt)
   return io->writev (iov, iovcnt);
 }
 
+ssize_t
+__posix_readv (int fildes, const struct iovec* iov, int iovcnt)
+{
+  auto* const io = posix::file_descriptors_manager::io (fildes);
+  if (io == nullptr)
+    {
+      errno = EBADF;
+      return -1;
+    }
+  return io->readv (iov, iovcnt);
+}
+
+ssize_t
+__posix_pread (int fildes, void* buf, size_t nbyte, off_t offset)
+{
+  auto* const io = posix::file_descriptors_manager::io (fildes);
+  if (io == nullptr)
+    {
+      errno = EBADF;
+      return -1;
+    }
+  return io->pread (buf, nbyte, offset);
+}
+
+ssize_t
+__posix_pwrite (int fildes, const void* buf, size_t nbyte, off_t offset)
+{
+  auto* const io = posix::file_descriptors_manager::io (fildes);
+  if (io == nullptr)
+    {
+      errno = EBADF;
+      return -1;
+    }
+  return io->pwrite (buf, nbyte, offset);
+}
+
+ssize_t
+__posix_preadv (int fildes, const struct iovec* iov, int iovcnt, off_t offset)
+{
+  auto* const io = posix::file_descriptors_manager::io (fildes);
+  if (io == nullptr)
+    {
+      errno = EBADF;
+      return -1;
+    }
+  return io->preadv (iov, iovcnt, offset);
+}
+
+ssize_t
+__posix_pwritev (int fildes, const struct iovec* iov, int iovcnt,
+                 off_t offset)
+{
+  auto* const io = posix::file_descriptors_manager::io (fildes);
+  if (io == nullptr)
+    {
+      errno = EBADF;
+      return -1;
+    }
+  return io->pwritev (iov, iovcnt, offset);
+}
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+/**
+ * @details
+ * The address hint is ignored; fixed mappings are not supported.
+ */
+void*
+__posix_mmap (void* addr, size_t len, int prot, int flags, int fildes,
+              off_t off)
+{
+  if ((flags & MAP_FIXED) != 0)
+    {
+      errno = ENOTSUP;
+      return MAP_FAILED;
+    }
+
+  auto* const io = posix::file_descriptors_manager::io (fildes);
+  if (io == nullptr)
+    {
+      errno = EBADF;
+      return MAP_FAILED;
+    }
+  return io->mmap (len, prot, flags, off);
+}
+
+#pragma GCC diagnostic pop
+
+int
+__posix_munmap (void* addr, size_t len)
+{
+  return posix::munmap (addr, len);
+}
+
+// ----------------------------------------------------------------------------
+
+int
+__posix_aio_read (struct aiocb* aiocbp)
+{
+  return posix::aio_read (aiocbp);
+}
+
+int
+__posix_aio_write (struct aiocb* aiocbp)
+{
+  return posix::aio_write (aiocbp);
+}
+
+int
+__posix_aio_error (const struct aiocb* aiocbp)
+{
+  return posix::aio_error (aiocbp);
+}
+
+ssize_t
+__posix_aio_return (struct aiocb* aiocbp)
+{
+  return posix::aio_return (aiocbp);
+}
+
+int
+__posix_aio_suspend (const struct aiocb* const list[], int nent,
+                     const struct timespec* timeout)
+{
+  return posix::aio_suspend (list, nent, timeout);
+}
+
+int
+__posix_aio_cancel (int fildes, struct aiocb* aiocbp)
+{
+  return posix::aio_cancel (fildes, aiocbp);
+}
+
 int
 __posix_ioctl (int fildes, int request, ...)
 {
@@ -405,6 +548,37 @@ __posix_ftruncate (int fildes, off_t length)
   return (static_cast<posix::file*> (io))->ftruncate (length);
 }
 
+/**
+ * @details
+ * Unlike most functions, the error is returned, and `errno`
+ * is preserved.
+ */
+int
+__posix_posix_fallocate (int fildes, off_t offset, off_t len)
+{
+  auto* const io = posix::file_descriptors_manager::io (fildes);
+  if (io == nullptr)
+    {
+      return EBADF;
+    }
+
+  // Works only on files (Does not work on sockets, pipes or FIFOs...)
+  if ((io->get_type () & posix::io::type::file) == 0)
+    {
+      return ENODEV; // Not a file.
+    }
+
+  int saved = errno;
+  int ret = 0;
+  if ((static_cast<posix::file*> (io))->fallocate (offset, len) < 0)
+    {
+      ret = errno;
+    }
+  errno = saved;
+
+  return ret;
+}
+
 int
 __posix_fsync (int fildes)
 {
@@ -704,6 +878,19 @@ __posix_recvmsg (int socket, struct msghdr* message, int flags)
   return io->recvmsg (message, flags);
 }
 
+int
+__posix_recvmmsg (int socket, struct mmsghdr* vmessages, unsigned int vlen,
+                  int flags, struct timespec* timeout)
+{
+  auto* const io = posix::file_descriptors_manager::socket (socket);
+  if (io == nullptr)
+    {
+      errno = EBADF;
+      return -1;
+    }
+  return io->recvmmsg (vmessages, vlen, flags, timeout);
+}
+
 ssize_t
 __posix_send (int socket, const void* buffer, size_t length, int flags)
 {
@@ -728,6 +915,19 @@ __posix_sendmsg (int socket, const struct msghdr* message, int flags)
   return io->sendmsg (message, flags);
 }
 
+int
+__posix_sendmmsg (int socket, struct mmsghdr* vmessages, unsigned int vlen,
+                  int flags)
+{
+  auto* const io = posix::file_descriptors_manager::socket (socket);
+  if (io == nullptr)
+    {
+      errno = EBADF;
+      return -1;
+    }
+  return io->sendmmsg (vmessages, vlen, flags);
+}
+
 ssize_t
 __posix_sendto (int socket, const void* message, size_t length, int flags,
                 const struct sockaddr* dest_addr, socklen_t dest_len)
@@ -824,8 +1024,7 @@ int
 __posix_select (int nfds, fd_set* readfds, fd_set* writefds, fd_set* errorfds,
                 struct timeval* timeout)
 {
-  errno = ENOSYS; // Not implemented
-  return -1;
+  return posix::select (nfds, readfds, writefds, errorfds, timeout);
 }
 
 clock_t
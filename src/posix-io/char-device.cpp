@@ -45,7 +45,8 @@ namespace os
           { impl, type::char_device, name }
     {
 #if defined(OS_TRACE_POSIX_IO_CHAR_DEVICE)
-      trace::printf ("char_device::%s(\"%s\")=@%p\n", __func__, name_, this);
+      OS_TRACE_PRINTF (posix_io_char_device, "char_device::%s(\"%s\")=@%p\n",
+                       __func__, name_, this);
 #endif
 
       device_registry<device>::link (this);
@@ -54,10 +55,11 @@ namespace os
     char_device::~char_device ()
     {
 #if defined(OS_TRACE_POSIX_IO_CHAR_DEVICE)
-      trace::printf ("char_device::%s() @%p %s\n", __func__, this, name_);
+      OS_TRACE_PRINTF (posix_io_char_device, "char_device::%s() @%p %s\n",
+                       __func__, this, name_);
 #endif
 
-      registry_links_.unlink ();
+      device_registry<device>::unlink (this);
 
       name_ = nullptr;
     }
@@ -67,14 +69,16 @@ namespace os
     char_device_impl::char_device_impl (void)
     {
 #if defined(OS_TRACE_POSIX_IO_CHAR_DEVICE)
-      trace::printf ("char_device_impl::%s()=@%p\n", __func__, this);
+      OS_TRACE_PRINTF (posix_io_char_device, "char_device_impl::%s()=@%p\n",
+                       __func__, this);
 #endif
     }
 
     char_device_impl::~char_device_impl ()
     {
 #if defined(OS_TRACE_POSIX_IO_CHAR_DEVICE)
-      trace::printf ("char_device_impl::%s() @%p\n", __func__, this);
+      OS_TRACE_PRINTF (posix_io_char_device, "char_device_impl::%s() @%p\n",
+                       __func__, this);
 #endif
     }
 
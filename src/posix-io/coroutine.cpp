@@ -0,0 +1,143 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#include <cmsis-plus/posix-io/coroutine.h>
+
+#if defined(__cpp_impl_coroutine) && (__cplusplus >= 202002L)
+
+#include <cerrno>
+#include <cstring>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    namespace co
+    {
+      // ----------------------------------------------------------------------
+
+      io_awaiter::io_awaiter (int fildes, void* buf, std::size_t nbyte,
+                              off_t offset, bool is_write)
+      {
+        std::memset (&cb_, 0, sizeof(cb_));
+        cb_.aio_fildes = fildes;
+        cb_.aio_buf = buf;
+        cb_.aio_nbytes = nbyte;
+        cb_.aio_offset = offset;
+        cb_.aio_lio_opcode = is_write ? LIO_WRITE : LIO_READ;
+        cb_.aio_sigevent.sigev_notify = SIGEV_NONE;
+
+        list_ = internal_list_ (done_);
+      }
+
+      io_awaiter::~io_awaiter ()
+      {
+        if (!started_ || completed_)
+          {
+            return;
+          }
+
+        // The buffer and the control block must not be used
+        // after this.
+        if (posix::aio_cancel (cb_.aio_fildes, &cb_) == AIO_NOTCANCELED)
+          {
+            const struct aiocb* list[] =
+              { &cb_ };
+            while (posix::aio_error (&cb_) == EINPROGRESS)
+              {
+                posix::aio_suspend (list, 1, nullptr);
+              }
+          }
+        posix::aio_return (&cb_);
+      }
+
+      ssize_t
+      io_awaiter::await_resume (void) const noexcept
+      {
+        if (result_ < 0)
+          {
+            errno = error_;
+          }
+        return result_;
+      }
+
+      /**
+       * @details
+       * The first call, from `await_ready()`, starts the transfer;
+       * it is completed when the semaphore posted by the
+       * asynchronous I/O layer is taken.
+       */
+      bool
+      io_awaiter::do_try_complete (void)
+      {
+        if (!started_)
+          {
+            int ret = (cb_.aio_lio_opcode == LIO_WRITE) ?
+                posix::aio_write (&cb_) : posix::aio_read (&cb_);
+            if (ret < 0)
+              {
+                result_ = -1;
+                error_ = errno;
+                completed_ = true;
+                return true;
+              }
+            started_ = true;
+            posix::aio_notify (&cb_, &done_);
+          }
+
+        if (done_.try_wait () != rtos::result::ok)
+          {
+            return false;
+          }
+
+        error_ = posix::aio_error (&cb_);
+        result_ = posix::aio_return (&cb_);
+        completed_ = true;
+
+        return true;
+      }
+
+      bool
+      io_awaiter::do_ready (void)
+      {
+        return done_.value () > 0;
+      }
+
+    // ------------------------------------------------------------------------
+    } /* namespace co */
+  } /* namespace posix */
+} /* namespace os */
+
+#endif /* defined(__cpp_impl_coroutine) */
+
+// ----------------------------------------------------------------------------
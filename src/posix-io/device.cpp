@@ -26,6 +26,7 @@
  */
 
 #include <cmsis-plus/posix-io/device.h>
+#include <cmsis-plus/posix-io/device-registry.h>
 #include <cmsis-plus/posix/sys/ioctl.h>
 
 #include <cstring>
@@ -48,17 +49,18 @@ namespace os
         name_ (name)
     {
 #if defined(OS_TRACE_POSIX_IO_DEVICE)
-      trace::printf ("device::%s(\"%s\")=%p\n", __func__, name_, this);
+      OS_TRACE_PRINTF (posix_io_device, "device::%s(\"%s\")=%p\n", __func__,
+                       name_, this);
 #endif
     }
 
     device::~device ()
     {
 #if defined(OS_TRACE_POSIX_IO_DEVICE)
-      trace::printf ("device::%s() @%p\n", __func__, this);
+      OS_TRACE_PRINTF (posix_io_device, "device::%s() @%p\n", __func__, this);
 #endif
 
-      registry_links_.unlink ();
+      device_registry<device>::unlink (this);
 
       name_ = nullptr;
     }
@@ -81,8 +83,8 @@ namespace os
     device::vopen (const char* path, int oflag, std::va_list args)
     {
 #if defined(OS_TRACE_POSIX_IO_DEVICE)
-      trace::printf ("device::%s(\"%s\") @%p\n", __func__, path ? path : "",
-                     this);
+      OS_TRACE_PRINTF (posix_io_device, "device::%s(\"%s\") @%p\n", __func__,
+                       path ? path : "", this);
 #endif
 
       errno = 0;
@@ -90,6 +92,9 @@ namespace os
       int ret = 0;
       if (impl ().open_count_ == 0)
         {
+          // Set before do_vopen(), which may need to check O_NONBLOCK.
+          impl ().status_flags (oflag);
+
           // If so, use the implementation to open the device.
           ret = impl ().do_vopen (path, oflag, args);
           if (ret < 0)
@@ -108,8 +113,8 @@ namespace os
       ++(impl ().open_count_);
       ret = file_descriptor ();
 #if defined(OS_TRACE_POSIX_IO_DEVICE)
-      trace::printf ("device::%s(\"%s\")=%p fd=%d\n", __func__,
-                     path ? path : "", this, ret);
+      OS_TRACE_PRINTF (posix_io_device, "device::%s(\"%s\")=%p fd=%d\n",
+                       __func__, path ? path : "", this, ret);
 #endif
 
       return ret;
@@ -119,7 +124,7 @@ namespace os
     device::close (void)
     {
 #if defined(OS_TRACE_POSIX_IO_DEVICE)
-      trace::printf ("device::%s() @%p\n", __func__, this);
+      OS_TRACE_PRINTF (posix_io_device, "device::%s() @%p\n", __func__, this);
 #endif
 
       errno = 0;
@@ -155,7 +160,8 @@ namespace os
     device::vioctl (int request, std::va_list args)
     {
 #if defined(OS_TRACE_POSIX_IO_DEVICE)
-      trace::printf ("device::%s(%d) @%p\n", __func__, request, this);
+      OS_TRACE_PRINTF (posix_io_device, "device::%s(%d) @%p\n", __func__,
+                       request, this);
 #endif
 
       if (impl ().open_count_ == 0)
@@ -173,7 +179,7 @@ namespace os
     device::sync (void)
     {
 #if defined(OS_TRACE_POSIX_IO_DEVICE)
-      trace::printf ("device::%s() @%p\n", __func__, this);
+      OS_TRACE_PRINTF (posix_io_device, "device::%s() @%p\n", __func__, this);
 #endif
 
       if (impl ().open_count_ == 0)
@@ -201,14 +207,16 @@ namespace os
     device_impl::device_impl (void)
     {
 #if defined(OS_TRACE_POSIX_IO_DEVICE)
-      trace::printf ("device_impl::%s()=%p\n", __func__, this);
+      OS_TRACE_PRINTF (posix_io_device, "device_impl::%s()=%p\n", __func__,
+                       this);
 #endif
     }
 
     device_impl::~device_impl ()
     {
 #if defined(OS_TRACE_POSIX_IO_DEVICE)
-      trace::printf ("device_impl::%s() @%p\n", __func__, this);
+      OS_TRACE_PRINTF (posix_io_device, "device_impl::%s() @%p\n", __func__,
+                       this);
 #endif
     }
 
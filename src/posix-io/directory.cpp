@@ -33,6 +33,7 @@
 #include <cerrno>
 #include <cassert>
 #include <string.h>
+#include <sys/stat.h>
 
 // ----------------------------------------------------------------------------
 
@@ -46,14 +47,16 @@ namespace os
         impl_ (impl)
     {
 #if defined(OS_TRACE_POSIX_IO_DIRECTORY)
-      trace::printf ("directory::%s()=%p\n", __func__, this);
+      OS_TRACE_PRINTF (posix_io_directory, "directory::%s()=%p\n", __func__,
+                       this);
 #endif
     }
 
     directory::~directory ()
     {
 #if defined(OS_TRACE_POSIX_IO_DIRECTORY)
-      trace::printf ("directory::%s() @%p\n", __func__, this);
+      OS_TRACE_PRINTF (posix_io_directory, "directory::%s() @%p\n", __func__,
+                       this);
 #endif
     }
 
@@ -63,7 +66,8 @@ namespace os
     directory::read (void)
     {
 #if defined(OS_TRACE_POSIX_IO_DIRECTORY)
-      trace::printf ("directory::%s() @%p\n", __func__, this);
+      OS_TRACE_PRINTF (posix_io_directory, "directory::%s() @%p\n", __func__,
+                       this);
 #endif
 
       // assert(file_system_ != nullptr);
@@ -77,11 +81,52 @@ namespace os
       return impl ().do_read ();
     }
 
+    /**
+     * @details
+     * Read up to `n` entries in a single call, to avoid the
+     * per entry overhead of read() (for lockable directories,
+     * the lock is taken only once for the entire batch).
+     *
+     * If `st` is not null, it must point to an array of `n`
+     * elements, where the attributes of each entry are stored,
+     * similar to `getdents()` with attributes. Entries that cannot
+     * be stat()-ed are returned with a zeroed `struct stat`.
+     *
+     * @return The number of entries stored in `buf`, 0 at the end
+     *  of the directory, otherwise -1 and errno set.
+     */
+    ssize_t
+    directory::read_entries (struct dirent* buf, std::size_t n,
+                             struct stat* st)
+    {
+#if defined(OS_TRACE_POSIX_IO_DIRECTORY)
+      OS_TRACE_PRINTF (posix_io_directory, "directory::%s(%p, %u, %p) @%p\n",
+                       __func__, buf, n, st, this);
+#endif
+
+      if (buf == nullptr)
+        {
+          errno = EFAULT;
+          return -1;
+        }
+
+      errno = 0;
+
+      if (n == 0)
+        {
+          return 0;
+        }
+
+      // Execute the implementation specific code.
+      return impl ().do_read_entries (buf, n, st);
+    }
+
     void
     directory::rewind (void)
     {
 #if defined(OS_TRACE_POSIX_IO_DIRECTORY)
-      trace::printf ("directory::%s() @%p\n", __func__, this);
+      OS_TRACE_PRINTF (posix_io_directory, "directory::%s() @%p\n", __func__,
+                       this);
 #endif
 
       // assert(file_system_ != nullptr);
@@ -97,7 +142,8 @@ namespace os
     directory::close (void)
     {
 #if defined(OS_TRACE_POSIX_IO_DIRECTORY)
-      trace::printf ("directory::%s() @%p\n", __func__, this);
+      OS_TRACE_PRINTF (posix_io_directory, "directory::%s() @%p\n", __func__,
+                       this);
 #endif
 
       // assert(file_system_ != nullptr);
@@ -123,18 +169,112 @@ namespace os
         file_system_ (fs)
     {
 #if defined(OS_TRACE_POSIX_IO_DIRECTORY)
-      trace::printf ("directory_impl::%s()=%p\n", __func__, this);
+      OS_TRACE_PRINTF (posix_io_directory, "directory_impl::%s()=%p\n",
+                       __func__, this);
 #endif
       memset (&dir_entry_, 0, sizeof(struct dirent));
+      path_[0] = '\0';
     }
 
     directory_impl::~directory_impl ()
     {
 #if defined(OS_TRACE_POSIX_IO_DIRECTORY)
-      trace::printf ("directory_impl::%s() @%p\n", __func__, this);
+      OS_TRACE_PRINTF (posix_io_directory, "directory_impl::%s() @%p\n",
+                       __func__, this);
 #endif
     }
 
+    // ------------------------------------------------------------------------
+
+    /**
+     * @details
+     * The default implementation iterates `do_read()`; file systems
+     * able to return several entries in a single device pass should
+     * override it.
+     *
+     * An error after some entries were already stored is not
+     * reported, the count is returned and the error is expected
+     * to show again at the next call.
+     */
+    ssize_t
+    directory_impl::do_read_entries (struct dirent* buf, std::size_t n,
+                                     struct stat* st)
+    {
+      std::size_t count = 0;
+      while (count < n)
+        {
+          errno = 0;
+          struct dirent* entry = do_read ();
+          if (entry == nullptr)
+            {
+              if (errno != 0 && count == 0)
+                {
+                  return -1;
+                }
+              break;
+            }
+
+          if (st != nullptr)
+            {
+              if (do_stat_entry (entry, &st[count]) != 0)
+                {
+                  memset (&st[count], 0, sizeof(struct stat));
+                }
+            }
+
+          memcpy (&buf[count], entry, sizeof(struct dirent));
+          ++count;
+        }
+
+      errno = 0;
+      return static_cast<ssize_t> (count);
+    }
+
+    /**
+     * @details
+     * The default implementation builds the entry path from the
+     * directory path and calls the file system stat(), bypassing
+     * the file system lock, which is already held when called
+     * via a lockable directory.
+     */
+    int
+    directory_impl::do_stat_entry (const struct dirent* entry,
+                                   struct stat* buf)
+    {
+      if (path_[0] == '\0')
+        {
+          errno = ENAMETOOLONG;
+          return -1;
+        }
+
+      char full_path[OS_INTEGER_POSIX_IO_DIRECTORY_PATH_MAX
+          + sizeof(entry->d_name) + 1];
+
+      std::size_t len = strlen (path_);
+      memcpy (full_path, path_, len);
+      if (len > 0 && full_path[len - 1] != '/')
+        {
+          full_path[len++] = '/';
+        }
+      strncpy (&full_path[len], entry->d_name, sizeof(full_path) - len);
+      full_path[sizeof(full_path) - 1] = '\0';
+
+      return file_system ().file_system::stat (full_path, buf);
+    }
+
+    void
+    directory_impl::path (const char* dirpath)
+    {
+      std::size_t len = strlen (dirpath);
+      if (len >= sizeof(path_))
+        {
+          // Too long, stat-on-read will fail with ENAMETOOLONG.
+          path_[0] = '\0';
+          return;
+        }
+      memcpy (path_, dirpath, len + 1);
+    }
+
   // ========================================================================
 
   } /* namespace posix */
@@ -0,0 +1,167 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/posix-io/event-loop-poller.h>
+
+#include <cerrno>
+#include <cassert>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    /**
+     * @class event_loop_poller
+     * @details
+     * The descriptors must be watched and unwatched by the loop
+     * thread (from callbacks), or before the loop is created.
+     */
+
+    /**
+     * @details
+     * The callbacks are allocated once, from the default memory
+     * resource, like the `event_poll` entries.
+     */
+    event_loop_poller::event_loop_poller (std::size_t size) :
+        poll_
+          { size }
+    {
+      assert(size > 0);
+
+      watches_ = new watch_t[size];
+      size_ = size;
+
+      for (std::size_t i = 0; i < size_; ++i)
+        {
+          watches_[i].func = nullptr;
+          watches_[i].fd = -1;
+        }
+    }
+
+    event_loop_poller::~event_loop_poller ()
+    {
+      delete[] watches_;
+    }
+
+    int
+    event_loop_poller::watch (int fd, io::readiness_t events, func_t func,
+                              void* args, event_poll::trigger_t trig)
+    {
+      if (func == nullptr)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      watch_t* w = nullptr;
+      for (std::size_t i = 0; i < size_; ++i)
+        {
+          if (watches_[i].fd == fd)
+            {
+              errno = EEXIST;
+              return -1;
+            }
+          if (w == nullptr && watches_[i].fd < 0)
+            {
+              w = &watches_[i];
+            }
+        }
+      if (w == nullptr)
+        {
+          errno = ENOMEM;
+          return -1;
+        }
+
+      if (poll_.add (fd, events, w, trig) < 0)
+        {
+          return -1;
+        }
+
+      w->func = func;
+      w->args = args;
+      w->fd = fd;
+
+      return 0;
+    }
+
+    int
+    event_loop_poller::unwatch (int fd)
+    {
+      for (std::size_t i = 0; i < size_; ++i)
+        {
+          if (watches_[i].fd == fd)
+            {
+              watches_[i].fd = -1;
+              watches_[i].func = nullptr;
+              return poll_.remove (fd);
+            }
+        }
+
+      errno = ENOENT;
+      return -1;
+    }
+
+    /**
+     * @details
+     * A descriptor unwatched by a callback is skipped, even
+     * if already reported by the same wait.
+     */
+    void
+    event_loop_poller::wait (rtos::clock::duration_t timeout)
+    {
+      event_poll::event events[max_events];
+
+      int count = poll_.wait (
+          events, max_events,
+          (timeout == rtos::event_loop::forever) ?
+              event_poll::forever : timeout);
+
+      for (int i = 0; i < count; ++i)
+        {
+          watch_t* w = static_cast<watch_t*> (events[i].data);
+          if (w->fd == events[i].fd && w->func != nullptr)
+            {
+              w->func (events[i].fd, events[i].events, w->args);
+            }
+        }
+    }
+
+    void
+    event_loop_poller::wakeup (void)
+    {
+      poll_.wakeup ();
+    }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,468 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <cmsis-plus/posix-io/event-poll.h>
+#include <cmsis-plus/posix-io/file-descriptors-manager.h>
+
+#include <cmsis-plus/diag/trace.h>
+
+#include <cerrno>
+#include <cassert>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    /**
+     * @class event_poll
+     * @details
+     * Each watched descriptor has an entry linked in the list of
+     * its `io_impl`; a notification links the entry in the ready
+     * list, if not already there, and posts the semaphore of the
+     * waiting thread. The conditions are checked by `wait()`,
+     * with `io::ready()`, only for the entries in the ready list;
+     * level triggered entries still ready are linked again at the
+     * end of the list, to be checked by the next wait.
+     */
+
+    /**
+     * @details
+     * The entries are allocated once, from the default memory
+     * resource.
+     */
+    event_poll::event_poll (std::size_t size)
+    {
+#if defined(OS_TRACE_POSIX_IO_EVENT_POLL)
+      OS_TRACE_PRINTF (posix_io_event_poll, "event_poll::%s(%u)=%p\n", __func__,
+                       size, this);
+#endif
+
+      assert(size > 0);
+
+      entries_ = new event_poll_entry[size];
+      size_ = size;
+
+      for (std::size_t i = 0; i < size_; ++i)
+        {
+          event_poll_entry* e = &entries_[i];
+          e->target = nullptr;
+          e->queued = false;
+          e->ready_next = nullptr;
+          e->watch_next = free_list_;
+          free_list_ = e;
+        }
+    }
+
+    /**
+     * @details
+     * The remaining descriptors are removed from the interest list.
+     */
+    event_poll::~event_poll ()
+    {
+#if defined(OS_TRACE_POSIX_IO_EVENT_POLL)
+      OS_TRACE_PRINTF (posix_io_event_poll, "event_poll::%s() @%p\n", __func__,
+                       this);
+#endif
+
+      for (std::size_t i = 0; i < size_; ++i)
+        {
+          if (entries_[i].target != nullptr)
+            {
+              remove (entries_[i].fd);
+            }
+        }
+
+      delete[] entries_;
+    }
+
+    /**
+     * @details
+     * The descriptor is checked by the next `wait()`, so the
+     * conditions already present are reported, for both triggers.
+     */
+    int
+    event_poll::add (int fd, io::readiness_t events, void* data,
+                     trigger_t trig)
+    {
+#if defined(OS_TRACE_POSIX_IO_EVENT_POLL)
+      OS_TRACE_PRINTF (posix_io_event_poll, "event_poll::%s(%d, 0x%X) @%p\n",
+                       __func__, fd, events, this);
+#endif
+
+      auto* const target = file_descriptors_manager::io (fd);
+      if (target == nullptr)
+        {
+          errno = EBADF;
+          return -1;
+        }
+
+      if (internal_find_ (fd) != nullptr)
+        {
+          errno = EEXIST;
+          return -1;
+        }
+
+        {
+          // ----- Enter critical section -------------------------------------
+          rtos::interrupts::critical_section ics;
+
+          event_poll_entry* e = free_list_;
+          if (e == nullptr)
+            {
+              errno = ENOMEM;
+              return -1;
+            }
+          free_list_ = e->watch_next;
+
+          e->poll = this;
+          e->target = target;
+          e->data = data;
+          e->fd = fd;
+          e->events = events;
+          e->trigger = trig;
+
+          io_impl& impl = target->impl ();
+          e->watch_next = impl.watchers_;
+          impl.watchers_ = e;
+          ++used_;
+
+          internal_enqueue_ (e);
+          // ----- Exit critical section --------------------------------------
+        }
+
+      sem_.post ();
+      return 0;
+    }
+
+    int
+    event_poll::modify (int fd, io::readiness_t events, void* data)
+    {
+      event_poll_entry* e = internal_find_ (fd);
+      if (e == nullptr)
+        {
+          errno = ENOENT;
+          return -1;
+        }
+
+        {
+          // ----- Enter critical section -------------------------------------
+          rtos::interrupts::critical_section ics;
+
+          e->events = events;
+          e->data = data;
+          internal_enqueue_ (e);
+          // ----- Exit critical section --------------------------------------
+        }
+
+      sem_.post ();
+      return 0;
+    }
+
+    int
+    event_poll::remove (int fd)
+    {
+#if defined(OS_TRACE_POSIX_IO_EVENT_POLL)
+      OS_TRACE_PRINTF (posix_io_event_poll, "event_poll::%s(%d) @%p\n",
+                       __func__, fd, this);
+#endif
+
+      event_poll_entry* e = internal_find_ (fd);
+      if (e == nullptr)
+        {
+          errno = ENOENT;
+          return -1;
+        }
+
+      // ----- Enter critical section -----------------------------------------
+      rtos::interrupts::critical_section ics;
+
+      io_impl& impl = e->target->impl ();
+      for (event_poll_entry** p = &impl.watchers_; *p != nullptr;
+          p = &((*p)->watch_next))
+        {
+          if (*p == e)
+            {
+              *p = e->watch_next;
+              break;
+            }
+        }
+
+      internal_release_ (e);
+      return 0;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    /**
+     * @details
+     * The conditions are checked only for the descriptors in the
+     * ready list, at most once per call; the list is processed
+     * in the order of the notifications.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    int
+    event_poll::wait (event* events, int maxevents,
+                      rtos::clock::duration_t timeout)
+    {
+      if ((events == nullptr) || (maxevents <= 0))
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      if (rtos::interrupts::in_handler_mode ())
+        {
+          errno = EPERM;
+          return -1;
+        }
+
+      rtos::clock::timestamp_t deadline = rtos::sysclock.steady_now ()
+          + timeout;
+
+      for (;;)
+        {
+          int count = 0;
+
+          event_poll_entry* last;
+            {
+              // ----- Enter critical section ---------------------------------
+              rtos::interrupts::critical_section ics;
+
+              last = ready_tail_;
+              // ----- Exit critical section ----------------------------------
+            }
+
+          while ((last != nullptr) && (count < maxevents))
+            {
+              event_poll_entry* e;
+              io* target;
+                {
+                  // ----- Enter critical section -----------------------------
+                  rtos::interrupts::critical_section ics;
+
+                  e = ready_head_;
+                  ready_head_ = e->ready_next;
+                  if (ready_head_ == nullptr)
+                    {
+                      ready_tail_ = nullptr;
+                    }
+                  e->queued = false;
+
+                  target = e->target;
+                  if (target == nullptr)
+                    {
+                      // Removed while in the ready list.
+                      e->watch_next = free_list_;
+                      free_list_ = e;
+                    }
+                  // ----- Exit critical section ------------------------------
+                }
+
+              if (target != nullptr)
+                {
+                  // Errors are always reported.
+                  io::readiness_t r = target->ready ()
+                      & (e->events | io::readiness::except);
+                  if (r != 0)
+                    {
+                      events[count].fd = e->fd;
+                      events[count].events = r;
+                      events[count].data = e->data;
+                      ++count;
+
+                      if (e->trigger == trigger::level)
+                        {
+                          // ----- Enter critical section ---------------------
+                          rtos::interrupts::critical_section ics;
+
+                          internal_enqueue_ (e);
+                          // ----- Exit critical section ----------------------
+                        }
+                    }
+                }
+
+              if (e == last)
+                {
+                  break;
+                }
+            }
+
+          if (count > 0)
+            {
+              errno = 0;
+              return count;
+            }
+
+          if (timeout == 0)
+            {
+              return 0;
+            }
+
+          rtos::result_t res;
+          if (timeout == forever)
+            {
+              res = sem_.wait ();
+            }
+          else
+            {
+              rtos::clock::timestamp_t now = rtos::sysclock.steady_now ();
+              if (now >= deadline)
+                {
+                  return 0;
+                }
+              res = sem_.timed_wait (
+                  static_cast<rtos::clock::duration_t> (deadline - now));
+            }
+
+          if (res == EINTR)
+            {
+              errno = EINTR;
+              return -1;
+            }
+
+          bool woken;
+            {
+              // ----- Enter critical section ---------------------------------
+              rtos::interrupts::critical_section ics;
+
+              woken = woken_;
+              woken_ = false;
+              // ----- Exit critical section ----------------------------------
+            }
+          if (woken)
+            {
+              return 0;
+            }
+        }
+    }
+
+    /**
+     * @details
+     * The waiting thread returns 0, like after a timeout;
+     * without a waiting thread, the next `wait()` which blocks
+     * returns immediately.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    void
+    event_poll::wakeup (void)
+    {
+      woken_ = true;
+      sem_.post ();
+    }
+
+    /**
+     * @cond ignore
+     */
+
+    void
+    event_poll::internal_notify_ (event_poll_entry* entry)
+    {
+      internal_enqueue_ (entry);
+      sem_.post ();
+    }
+
+    void
+    event_poll::internal_forget_ (io_impl& impl)
+    {
+      // ----- Enter critical section -----------------------------------------
+      rtos::interrupts::critical_section ics;
+
+      event_poll_entry* e = impl.watchers_;
+      impl.watchers_ = nullptr;
+      while (e != nullptr)
+        {
+          event_poll_entry* next = e->watch_next;
+          e->poll->internal_release_ (e);
+          e = next;
+        }
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    event_poll_entry*
+    event_poll::internal_find_ (int fd)
+    {
+      for (std::size_t i = 0; i < size_; ++i)
+        {
+          if (entries_[i].target != nullptr && entries_[i].fd == fd)
+            {
+              return &entries_[i];
+            }
+        }
+      return nullptr;
+    }
+
+    void
+    event_poll::internal_enqueue_ (event_poll_entry* entry)
+    {
+      if (entry->queued)
+        {
+          return;
+        }
+
+      entry->queued = true;
+      entry->ready_next = nullptr;
+      if (ready_tail_ == nullptr)
+        {
+          ready_head_ = entry;
+        }
+      else
+        {
+          ready_tail_->ready_next = entry;
+        }
+      ready_tail_ = entry;
+    }
+
+    // The entry is already unlinked from the watchers list;
+    // if in the ready list, it is freed by wait().
+    void
+    event_poll::internal_release_ (event_poll_entry* entry)
+    {
+      entry->target = nullptr;
+      --used_;
+
+      if (!entry->queued)
+        {
+          entry->watch_next = free_list_;
+          free_list_ = entry;
+        }
+    }
+
+    /**
+     * @endcond
+     */
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
@@ -29,6 +29,7 @@
 #include <cmsis-plus/posix-io/io.h>
 #include <cmsis-plus/posix-io/socket.h>
 
+#include <cmsis-plus/rtos/os.h>
 #include <cmsis-plus/diag/trace.h>
 
 #include <cerrno>
@@ -51,11 +52,30 @@ namespace os
 
     io** file_descriptors_manager::descriptors_array__;
 
+    std::size_t* file_descriptors_manager::free_map__;
+
+    std::size_t* file_descriptors_manager::summary_map__;
+
+    std::size_t* file_descriptors_manager::socket_map__;
+
+    std::size_t file_descriptors_manager::words__;
+
+    std::size_t file_descriptors_manager::summary_words__;
+
+    std::size_t file_descriptors_manager::used__;
+
     /**
      * @endcond
      */
 
     // ========================================================================
+    /**
+     * @details
+     * Free descriptors are kept in a bitmap, with a second level
+     * bitmap of the words that have free bits, so the lowest free
+     * descriptor is found with a couple of count-trailing-zeros
+     * instructions, regardless of how many descriptors are in use.
+     */
     file_descriptors_manager::file_descriptors_manager (std::size_t size)
     {
       trace::printf ("file_descriptors_manager::%s(%d)=%p\n", __func__, size,
@@ -70,6 +90,26 @@ namespace os
         {
           descriptors_array__[i] = nullptr;
         }
+
+      words__ = (size__ + word_bits__ - 1) / word_bits__;
+      summary_words__ = (words__ + word_bits__ - 1) / word_bits__;
+
+      // A single allocation for all bitmaps.
+      free_map__ = new std::size_t[2 * words__ + summary_words__];
+      socket_map__ = free_map__ + words__;
+      summary_map__ = socket_map__ + words__;
+
+      for (std::size_t i = 0; i < 2 * words__ + summary_words__; ++i)
+        {
+          free_map__[i] = 0;
+        }
+
+      // The reserved descriptors are never allocated, only assigned.
+      for (std::size_t i = reserved__; i < size__; ++i)
+        {
+          mark_free (i);
+        }
+      used__ = 0;
     }
 
     file_descriptors_manager::~file_descriptors_manager ()
@@ -77,23 +117,12 @@ namespace os
       trace::printf ("file_descriptors_manager::%s(%) @%p\n", __func__, this);
 
       delete[] descriptors_array__;
+      delete[] free_map__;
       size__ = 0;
     }
 
     // ------------------------------------------------------------------------
 
-    io*
-    file_descriptors_manager::io (int fildes)
-    {
-      // Check if valid descriptor or buffer not yet initialised
-      if ((fildes < 0) || (static_cast<std::size_t> (fildes) >= size__)
-          || (descriptors_array__ == nullptr))
-        {
-          return nullptr;
-        }
-      return descriptors_array__[fildes];
-    }
-
     bool
     file_descriptors_manager::valid (int fildes)
     {
@@ -104,11 +133,16 @@ namespace os
       return true;
     }
 
+    /**
+     * @details
+     * Return the lowest numbered free descriptor, as required by POSIX.
+     */
     int
     file_descriptors_manager::allocate (class io* io)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_DESCRIPTORS_MANAGER)
-      trace::printf ("file_descriptors_manager::%s(%p)\n", __func__, io);
+      OS_TRACE_PRINTF (posix_io_io, "file_descriptors_manager::%s(%p)\n",
+                       __func__, io);
 #endif
 
       if (io->file_descriptor () >= 0)
@@ -118,23 +152,50 @@ namespace os
           return -1;
         }
 
-      for (std::size_t i = reserved__; i < size__; ++i)
+      std::size_t fildes = size__;
         {
-          if (descriptors_array__[i] == nullptr)
+          // ----- Enter critical section -------------------------------------
+          rtos::scheduler::critical_section scs;
+
+          for (std::size_t s = 0; s < summary_words__; ++s)
             {
-              descriptors_array__[i] = io;
-              io->file_descriptor (static_cast<int> (i));
-#if defined(OS_TRACE_POSIX_IO_FILE_DESCRIPTORS_MANAGER)
-              trace::printf ("file_descriptors_manager::%s(%p) fd=%d\n",
-                             __func__, io, i);
-#endif
-              return static_cast<int> (i);
+              if (summary_map__[s] != 0)
+                {
+                  std::size_t w = s * word_bits__
+                      + static_cast<std::size_t> (__builtin_ctzl (
+                          summary_map__[s]));
+                  fildes = w * word_bits__
+                      + static_cast<std::size_t> (__builtin_ctzl (
+                          free_map__[w]));
+                  break;
+                }
+            }
+
+          if (fildes < size__)
+            {
+              descriptors_array__[fildes] = io;
+              mark_used (fildes);
+              if (io->get_type () == io::type::socket)
+                {
+                  set_bit (socket_map__, fildes);
+                }
             }
+          // ----- Exit critical section --------------------------------------
+        }
+
+      if (fildes >= size__)
+        {
+          // Too many files open in system.
+          errno = ENFILE;
+          return -1;
         }
 
-      // Too many files open in system.
-      errno = ENFILE;
-      return -1;
+      io->file_descriptor (static_cast<int> (fildes));
+#if defined(OS_TRACE_POSIX_IO_FILE_DESCRIPTORS_MANAGER)
+      OS_TRACE_PRINTF (posix_io_io, "file_descriptors_manager::%s(%p) fd=%d\n",
+                       __func__, io, fildes);
+#endif
+      return static_cast<int> (fildes);
     }
 
     int
@@ -153,7 +214,27 @@ namespace os
           return -1;
         }
 
-      descriptors_array__[fildes] = io;
+      std::size_t n = static_cast<std::size_t> (fildes);
+        {
+          // ----- Enter critical section -------------------------------------
+          rtos::scheduler::critical_section scs;
+
+          if (descriptors_array__[n] == nullptr)
+            {
+              mark_used (n);
+            }
+          descriptors_array__[n] = io;
+          if (io->get_type () == io::type::socket)
+            {
+              set_bit (socket_map__, n);
+            }
+          else
+            {
+              clear_bit (socket_map__, n);
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+
       io->file_descriptor (fildes);
       return fildes;
     }
@@ -162,7 +243,8 @@ namespace os
     file_descriptors_manager::deallocate (int fildes)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_DESCRIPTORS_MANAGER)
-      trace::printf ("file_descriptors_manager::%s(%d)\n", __func__, fildes);
+      OS_TRACE_PRINTF (posix_io_io, "file_descriptors_manager::%s(%d)\n",
+                       __func__, fildes);
 #endif
 
       if ((fildes < 0) || (static_cast<std::size_t> (fildes) >= size__))
@@ -171,38 +253,115 @@ namespace os
           return -1;
         }
 
-      descriptors_array__[fildes]->clear_file_descriptor ();
-      descriptors_array__[fildes] = nullptr;
-      return 0;
-    }
+      std::size_t n = static_cast<std::size_t> (fildes);
+      class io* io;
+        {
+          // ----- Enter critical section -------------------------------------
+          rtos::scheduler::critical_section scs;
 
-    class socket*
-    file_descriptors_manager::socket (int fildes)
-    {
-      assert((fildes >= 0) && (static_cast<std::size_t> (fildes) < size__));
-      auto* const io = descriptors_array__[fildes];
-      if (io->get_type () != io::type::socket)
+          io = descriptors_array__[n];
+          if (io != nullptr)
+            {
+              descriptors_array__[n] = nullptr;
+              clear_bit (socket_map__, n);
+              mark_free (n);
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+
+      if (io == nullptr)
         {
-          return nullptr;
+          errno = EBADF;
+          return -1;
         }
-      return reinterpret_cast<class socket*> (io);
+
+      io->clear_file_descriptor ();
+      return 0;
     }
 
     size_t
     file_descriptors_manager::used (void)
     {
-      std::size_t count = reserved__;
-      for (std::size_t i = reserved__; i < file_descriptors_manager::size ();
-          ++i)
+      return reserved__ + used__;
+    }
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+
+    /**
+     * @details
+     * Only the descriptors in use are reported, in ascending order;
+     * each object is copied separately, so the snapshot is not
+     * atomic across descriptors.
+     */
+    std::size_t
+    file_descriptors_manager::statistics (descriptor_statistics_t* array,
+                                          std::size_t count)
+    {
+      std::size_t n = 0;
+      for (std::size_t i = 0; i < size__ && n < count; ++i)
         {
-          if (descriptors_array__[i] != nullptr)
+          class io* object = io (static_cast<int> (i));
+          if (object == nullptr)
             {
-              ++count;
+              continue;
             }
+
+          array[n].fildes = static_cast<file_descriptor_t> (i);
+          array[n].object = object;
+          object->statistics (&array[n].stats);
+          ++n;
+        }
+      return n;
+    }
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @cond ignore
+     */
+
+    // Must be called in a critical section, with a free descriptor.
+    void
+    file_descriptors_manager::mark_used (std::size_t fildes)
+    {
+      if (fildes < reserved__)
+        {
+          // Reserved descriptors are never in the free bitmap.
+          return;
+        }
+
+      clear_bit (free_map__, fildes);
+      std::size_t w = fildes / word_bits__;
+      if (free_map__[w] == 0)
+        {
+          clear_bit (summary_map__, w);
         }
-      return count;
+      ++used__;
     }
 
+    // Must be called in a critical section, with a used descriptor.
+    void
+    file_descriptors_manager::mark_free (std::size_t fildes)
+    {
+      if (fildes < reserved__)
+        {
+          return;
+        }
+
+      set_bit (free_map__, fildes);
+      set_bit (summary_map__, fildes / word_bits__);
+      if (used__ > 0)
+        {
+          --used__;
+        }
+    }
+
+    /**
+     * @endcond
+     */
+
   // ========================================================================
   } /* namespace posix */
 } /* namespace os */
@@ -28,10 +28,12 @@
 #include <cmsis-plus/posix-io/file-system.h>
 #include <cmsis-plus/posix-io/block-device.h>
 #include <cmsis-plus/posix-io/device-registry.h>
+#include <cmsis-plus/posix-io/path-cache.h>
 
 #include <cerrno>
 #include <cassert>
 #include <cstring>
+#include <fcntl.h>
 
 // ----------------------------------------------------------------------------
 
@@ -66,7 +68,8 @@ namespace os
     mkdir (const char* path, mode_t mode)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("%s(\"%s\", %u)\n", __func__, path, mode);
+      OS_TRACE_PRINTF (posix_io_file_system, "%s(\"%s\", %u)\n", __func__, path,
+                       mode);
 #endif
 
       if (path == nullptr)
@@ -98,7 +101,7 @@ namespace os
     rmdir (const char* path)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("%s(\"%s\")\n", __func__, path);
+      OS_TRACE_PRINTF (posix_io_file_system, "%s(\"%s\")\n", __func__, path);
 #endif
 
       if (path == nullptr)
@@ -130,7 +133,7 @@ namespace os
     sync (void)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("%s()\n", __func__);
+      OS_TRACE_PRINTF (posix_io_file_system, "%s()\n", __func__);
 #endif
 
       // Enumerate all mounted file systems and sync them.
@@ -153,7 +156,8 @@ namespace os
     chmod (const char* path, mode_t mode)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("%s(\"%s\", %u)\n", __func__, path, mode);
+      OS_TRACE_PRINTF (posix_io_file_system, "%s(\"%s\", %u)\n", __func__, path,
+                       mode);
 #endif
 
       if (path == nullptr)
@@ -184,7 +188,8 @@ namespace os
     stat (const char* path, struct stat* buf)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("%s(\"%s\", %p)\n", __func__, path, buf);
+      OS_TRACE_PRINTF (posix_io_file_system, "%s(\"%s\", %p)\n", __func__, path,
+                       buf);
 #endif
 
       if ((path == nullptr) || (buf == nullptr))
@@ -215,7 +220,8 @@ namespace os
     truncate (const char* path, off_t length)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("%s(\"%s\", %u)\n", __func__, path, length);
+      OS_TRACE_PRINTF (posix_io_file_system, "%s(\"%s\", %u)\n", __func__, path,
+                       length);
 #endif
 
       if (path == nullptr)
@@ -252,7 +258,8 @@ namespace os
     rename (const char* existing, const char* _new)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("%s(\"%s\",\"%s\")\n", __func__, existing, _new);
+      OS_TRACE_PRINTF (posix_io_file_system, "%s(\"%s\",\"%s\")\n", __func__,
+                       existing, _new);
 #endif
 
       if ((existing == nullptr) || (_new == nullptr))
@@ -285,7 +292,7 @@ namespace os
     unlink (const char* path)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("%s(\"%s\")\n", __func__, path);
+      OS_TRACE_PRINTF (posix_io_file_system, "%s(\"%s\")\n", __func__, path);
 #endif
 
       if (path == nullptr)
@@ -316,7 +323,8 @@ namespace os
     utime (const char* path, const struct utimbuf* times)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("%s(\"%s\", %p)\n", __func__, path, times);
+      OS_TRACE_PRINTF (posix_io_file_system, "%s(\"%s\", %p)\n", __func__, path,
+                       times);
 #endif
 
       if ((path == nullptr) || (times == nullptr))
@@ -347,7 +355,8 @@ namespace os
     statvfs (const char* path, struct statvfs* buf)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("%s(\"%s\", %p)\n", __func__, path, buf);
+      OS_TRACE_PRINTF (posix_io_file_system, "%s(\"%s\", %p)\n", __func__, path,
+                       buf);
 #endif
 
       if ((path == nullptr) || (buf == nullptr))
@@ -378,7 +387,7 @@ namespace os
     opendir (const char* dirpath)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("%s(\"%s\")\n", __func__, dirpath);
+      OS_TRACE_PRINTF (posix_io_file_system, "%s(\"%s\")\n", __func__, dirpath);
 #endif
 
       if (dirpath == nullptr)
@@ -436,7 +445,8 @@ namespace os
       // Return a valid pointer to an object derived from directory, or nullptr.
 
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("%s(\"%s\")=%p\n", __func__, dirpath, dir);
+      OS_TRACE_PRINTF (posix_io_file_system, "%s(\"%s\")=%p\n", __func__,
+                       dirpath, dir);
 #endif
       return dir;
     }
@@ -448,7 +458,8 @@ namespace os
         impl_ (impl)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("file_system::%s(\"%s\")=%p\n", __func__, name_, this);
+      OS_TRACE_PRINTF (posix_io_file_system, "file_system::%s(\"%s\")=%p\n",
+                       __func__, name_, this);
 #endif
       deferred_files_list_.clear ();
       deferred_directories_list_.clear ();
@@ -457,7 +468,8 @@ namespace os
     file_system::~file_system ()
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("file_system::%s() @%p %s\n", __func__, this, name_);
+      OS_TRACE_PRINTF (posix_io_file_system, "file_system::%s() @%p %s\n",
+                       __func__, this, name_);
 #endif
     }
 
@@ -479,7 +491,8 @@ namespace os
     file_system::vmkfs (int options, std::va_list args)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("file_system::%s(%u) @%p\n", __func__, options, this);
+      OS_TRACE_PRINTF (posix_io_file_system, "file_system::%s(%u) @%p\n",
+                       __func__, options, this);
 #endif
 
       if (mounted_path_ != nullptr)
@@ -514,8 +527,9 @@ namespace os
                          std::va_list args)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("file_system::%s(\"%s\", %u) @%p\n", __func__,
-                     path ? path : "nullptr", flags, this);
+      OS_TRACE_PRINTF (posix_io_file_system,
+                       "file_system::%s(\"%s\", %u) @%p\n", __func__,
+                       path ? path : "nullptr", flags, this);
 #endif
 
       if (mounted_path_ != nullptr)
@@ -567,6 +581,11 @@ namespace os
           mounted_list__.link (*this);
           mounted_path_ = path;
         }
+      mounted_path_size_ = std::strlen (mounted_path_);
+
+#if defined(OS_INCLUDE_POSIX_IO_PATH_CACHE)
+      path_cache::purge (*this);
+#endif
 
       return 0;
     }
@@ -580,11 +599,17 @@ namespace os
     file_system::umount (int unsigned flags)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("file_system::%s(%u) @%p\n", __func__, flags, this);
+      OS_TRACE_PRINTF (posix_io_file_system, "file_system::%s(%u) @%p\n",
+                       __func__, flags, this);
 #endif
 
       mount_manager_links_.unlink ();
       mounted_path_ = nullptr;
+      mounted_path_size_ = 0;
+
+#if defined(OS_INCLUDE_POSIX_IO_PATH_CACHE)
+      path_cache::purge (*this);
+#endif
 
       if (this == mounted_root__)
         {
@@ -614,31 +639,45 @@ namespace os
       assert(path1 != nullptr);
       assert(*path1 != nullptr);
 
+      // The longest mount point prefix wins, so nested mount points
+      // can be used; the first character and the precomputed length
+      // filter out most candidates before comparing the strings.
+      file_system* found = nullptr;
+      std::size_t found_len = 0;
       for (auto&& fs : mounted_list__)
         {
-          auto len = std::strlen (fs.mounted_path_);
+          auto len = fs.mounted_path_size_;
 
           // Check if path1 starts with the mounted path.
-          if (std::strncmp (fs.mounted_path_, *path1, len) == 0)
+          if (len > found_len && fs.mounted_path_[0] == (*path1)[0]
+              && std::strncmp (fs.mounted_path_, *path1, len) == 0)
             {
-              // If so, adjust paths to skip over prefix, but keep '/'.
-              *path1 = (*path1 + len - 1);
-              while ((*path1)[1] == '/')
-                {
-                  *path1 = (*path1 + 1);
-                }
+              found = &fs;
+              found_len = len;
+            }
+        }
+
+      if (found != nullptr)
+        {
+          auto len = found_len;
+
+          // If so, adjust paths to skip over prefix, but keep '/'.
+          *path1 = (*path1 + len - 1);
+          while ((*path1)[1] == '/')
+            {
+              *path1 = (*path1 + 1);
+            }
 
-              if ((path2 != nullptr) && (*path2 != nullptr))
+          if ((path2 != nullptr) && (*path2 != nullptr))
+            {
+              *path2 = (*path2 + len - 1);
+              while ((*path2)[1] == '/')
                 {
-                  *path2 = (*path2 + len - 1);
-                  while ((*path2)[1] == '/')
-                    {
-                      *path2 = (*path2 + 1);
-                    }
+                  *path2 = (*path2 + 1);
                 }
-
-              return &fs;
             }
+
+          return found;
         }
 
       // If root file system defined, return it.
@@ -669,7 +708,8 @@ namespace os
     file_system::vopen (const char* path, int oflag, std::va_list args)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("file_system::%s(\"%s\", %u)\n", __func__, path, oflag);
+      OS_TRACE_PRINTF (posix_io_file_system, "file_system::%s(\"%s\", %u)\n",
+                       __func__, path, oflag);
 #endif
 
       if (!device ().is_opened ())
@@ -680,15 +720,41 @@ namespace os
 
       errno = 0;
 
+#if defined(OS_INCLUDE_POSIX_IO_PATH_CACHE)
+      bool creates = ((oflag & O_CREAT) != 0);
+      if (!creates && path_cache::lookup (*this, path, nullptr) == 0)
+        {
+          errno = ENOENT;
+          return nullptr;
+        }
+      uint32_t generation = paths_generation ();
+#endif
+
       // Execute the file specific implementation code.
       // Allocation is done by the implementation, where
       // the size is known.
       file* fil = impl ().do_vopen (*this, path, oflag, args);
+
+#if defined(OS_INCLUDE_POSIX_IO_PATH_CACHE)
+      if (creates || (oflag & O_TRUNC) != 0)
+        {
+          invalidate_paths ();
+        }
+      else if (fil == nullptr && errno == ENOENT)
+        {
+          path_cache::insert (*this, path, nullptr, generation);
+        }
+#endif
+
       if (fil == nullptr)
         {
           return nullptr;
         }
 
+      // Keep O_APPEND, O_NONBLOCK and O_DIRECT, for fcntl(F_GETFL)
+      // and for the transfers.
+      fil->impl ().status_flags (oflag);
+
       // If successful, allocate a file descriptor.
       fil->alloc_file_descriptor ();
 
@@ -699,7 +765,8 @@ namespace os
     file_system::opendir (const char* dirpath)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("file_system::%s(\"%s\")\n", __func__, dirpath);
+      OS_TRACE_PRINTF (posix_io_file_system, "file_system::%s(\"%s\")\n",
+                       __func__, dirpath);
 #endif
 
       if (!device ().is_opened ())
@@ -713,12 +780,30 @@ namespace os
       // Execute the dir specific implementation code.
       // Allocation is done by the implementation, where
       // the size is known.
+#if defined(OS_INCLUDE_POSIX_IO_PATH_CACHE)
+      if (path_cache::lookup (*this, dirpath, nullptr) == 0)
+        {
+          errno = ENOENT;
+          return nullptr;
+        }
+      uint32_t generation = paths_generation ();
+#endif
+
       directory* dir = impl ().do_opendir (*this, dirpath);
       if (dir == nullptr)
         {
+#if defined(OS_INCLUDE_POSIX_IO_PATH_CACHE)
+          if (errno == ENOENT)
+            {
+              path_cache::insert (*this, dirpath, nullptr, generation);
+            }
+#endif
           return nullptr;
         }
 
+      // Remember the path, used to stat() entries in read_entries().
+      dir->impl ().path (dirpath);
+
       return dir;
     }
 
@@ -728,7 +813,8 @@ namespace os
     file_system::mkdir (const char* path, mode_t mode)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("file_system::%s(\"%s\", %u)\n", __func__, path, mode);
+      OS_TRACE_PRINTF (posix_io_file_system, "file_system::%s(\"%s\", %u)\n",
+                       __func__, path, mode);
 #endif
 
       if (path == nullptr)
@@ -751,14 +837,21 @@ namespace os
 
       errno = 0;
 
-      return impl ().do_mkdir (path, mode);
+      int ret = impl ().do_mkdir (path, mode);
+
+#if defined(OS_INCLUDE_POSIX_IO_PATH_CACHE)
+      // After the change, so concurrent lookups do not cache old results.
+      invalidate_paths ();
+#endif
+      return ret;
     }
 
     int
     file_system::rmdir (const char* path)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("file_system::%s(\"%s\")\n", __func__, path);
+      OS_TRACE_PRINTF (posix_io_file_system, "file_system::%s(\"%s\")\n",
+                       __func__, path);
 #endif
 
       if (path == nullptr)
@@ -781,14 +874,20 @@ namespace os
 
       errno = 0;
 
-      return impl ().do_rmdir (path);
+      int ret = impl ().do_rmdir (path);
+
+#if defined(OS_INCLUDE_POSIX_IO_PATH_CACHE)
+      invalidate_paths ();
+#endif
+      return ret;
     }
 
     void
     file_system::sync (void)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("file_system::%s() @%p\n", __func__, this);
+      OS_TRACE_PRINTF (posix_io_file_system, "file_system::%s() @%p\n",
+                       __func__, this);
 #endif
 
       if (!device ().is_opened ())
@@ -808,7 +907,8 @@ namespace os
     file_system::chmod (const char* path, mode_t mode)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("file_system::%s(\"%s\", %u)\n", __func__, path, mode);
+      OS_TRACE_PRINTF (posix_io_file_system, "file_system::%s(\"%s\", %u)\n",
+                       __func__, path, mode);
 #endif
 
       if (path == nullptr)
@@ -832,14 +932,20 @@ namespace os
       errno = 0;
 
       // Execute the implementation specific code.
-      return impl ().do_chmod (path, mode);
+      int ret = impl ().do_chmod (path, mode);
+
+#if defined(OS_INCLUDE_POSIX_IO_PATH_CACHE)
+      invalidate_paths ();
+#endif
+      return ret;
     }
 
     int
     file_system::stat (const char* path, struct stat* buf)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("file_system::%s(\"%s\", %p)\n", __func__, path, buf);
+      OS_TRACE_PRINTF (posix_io_file_system, "file_system::%s(\"%s\", %p)\n",
+                       __func__, path, buf);
 #endif
 
       if ((path == nullptr) || (buf == nullptr))
@@ -862,15 +968,42 @@ namespace os
 
       errno = 0;
 
+#if defined(OS_INCLUDE_POSIX_IO_PATH_CACHE)
+      int found = path_cache::lookup (*this, path, buf);
+      if (found == 0)
+        {
+          errno = ENOENT;
+          return -1;
+        }
+      else if (found > 0)
+        {
+          return 0;
+        }
+      uint32_t generation = paths_generation ();
+#endif
+
       // Execute the implementation specific code.
-      return impl ().do_stat (path, buf);
+      int ret = impl ().do_stat (path, buf);
+
+#if defined(OS_INCLUDE_POSIX_IO_PATH_CACHE)
+      if (ret == 0)
+        {
+          path_cache::insert (*this, path, buf, generation);
+        }
+      else if (errno == ENOENT)
+        {
+          path_cache::insert (*this, path, nullptr, generation);
+        }
+#endif
+      return ret;
     }
 
     int
     file_system::truncate (const char* path, off_t length)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("file_system::%s(\"%s\", %u)\n", __func__, path, length);
+      OS_TRACE_PRINTF (posix_io_file_system, "file_system::%s(\"%s\", %u)\n",
+                       __func__, path, length);
 #endif
 
       if (path == nullptr)
@@ -894,15 +1027,20 @@ namespace os
       errno = 0;
 
       // Execute the implementation specific code.
-      return impl ().do_truncate (path, length);
+      int ret = impl ().do_truncate (path, length);
+
+#if defined(OS_INCLUDE_POSIX_IO_PATH_CACHE)
+      invalidate_paths ();
+#endif
+      return ret;
     }
 
     int
     file_system::rename (const char* existing, const char* _new)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("file_system::%s(\"%s\",\"%s\")\n", __func__, existing,
-                     _new);
+      OS_TRACE_PRINTF (posix_io_file_system, "file_system::%s(\"%s\",\"%s\")\n",
+                       __func__, existing, _new);
 #endif
 
       if ((existing == nullptr) || (_new == nullptr))
@@ -926,14 +1064,20 @@ namespace os
       errno = 0;
 
       // Execute the implementation specific code.
-      return impl ().do_rename (existing, _new);
+      int ret = impl ().do_rename (existing, _new);
+
+#if defined(OS_INCLUDE_POSIX_IO_PATH_CACHE)
+      invalidate_paths ();
+#endif
+      return ret;
     }
 
     int
     file_system::unlink (const char* path)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("file_system::%s(\"%s\")\n", __func__, path);
+      OS_TRACE_PRINTF (posix_io_file_system, "file_system::%s(\"%s\")\n",
+                       __func__, path);
 #endif
 
       if (path == nullptr)
@@ -957,7 +1101,12 @@ namespace os
       errno = 0;
 
       // Execute the implementation specific code.
-      return impl ().do_unlink (path);
+      int ret = impl ().do_unlink (path);
+
+#if defined(OS_INCLUDE_POSIX_IO_PATH_CACHE)
+      invalidate_paths ();
+#endif
+      return ret;
     }
 
     // http://pubs.opengroup.org/onlinepubs/9699919799/functions/utime.html
@@ -965,7 +1114,8 @@ namespace os
     file_system::utime (const char* path, const struct utimbuf* times)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("file_system::%s(\"%s\", %p)\n", __func__, path, times);
+      OS_TRACE_PRINTF (posix_io_file_system, "file_system::%s(\"%s\", %p)\n",
+                       __func__, path, times);
 #endif
 
       if ((path == nullptr) || (times == nullptr))
@@ -988,6 +1138,7 @@ namespace os
 
       errno = 0;
 
+      int ret;
       struct utimbuf tmp;
       if (times == nullptr)
         {
@@ -995,13 +1146,18 @@ namespace os
           // of the file shall be set to the current time.
           tmp.actime = time (nullptr);
           tmp.modtime = tmp.actime;
-          return impl ().do_utime (path, &tmp);
+          ret = impl ().do_utime (path, &tmp);
         }
       else
         {
           // Execute the implementation specific code.
-          return impl ().do_utime (path, times);
+          ret = impl ().do_utime (path, times);
         }
+
+#if defined(OS_INCLUDE_POSIX_IO_PATH_CACHE)
+      invalidate_paths ();
+#endif
+      return ret;
     }
 
     // http://pubs.opengroup.org/onlinepubs/9699919799/functions/fstatvfs.html
@@ -1009,7 +1165,8 @@ namespace os
     file_system::statvfs (struct statvfs* buf)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("file_system::%s(%p)\n", __func__, buf);
+      OS_TRACE_PRINTF (posix_io_file_system, "file_system::%s(%p)\n", __func__,
+                       buf);
 #endif
 
       if (!device ().is_opened ())
@@ -1020,6 +1177,19 @@ namespace os
 
       return impl ().do_statvfs (buf);
     }
+
+    int
+    file_system::preallocation (std::size_t bytes)
+    {
+#if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
+      OS_TRACE_PRINTF (posix_io_file_system, "file_system::%s(%u)\n",
+                       __func__, bytes);
+#endif
+
+      errno = 0;
+
+      return impl ().do_preallocation (bytes);
+    }
     // TODO: check if the file system should keep a static current path for
     // relative paths.
 
@@ -1032,17 +1202,32 @@ namespace os
         device_ (device)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("file_system_impl::%s()=%p\n", __func__, this);
+      OS_TRACE_PRINTF (posix_io_file_system, "file_system_impl::%s()=%p\n",
+                       __func__, this);
 #endif
     }
 
     file_system_impl::~file_system_impl ()
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("file_system_impl::%s() @%p\n", __func__, this);
+      OS_TRACE_PRINTF (posix_io_file_system, "file_system_impl::%s() @%p\n",
+                       __func__, this);
 #endif
     }
 
+    /**
+     * @details
+     * The default only records the hint; the implementations
+     * may override it to round the size to their clusters, or
+     * to reject it.
+     */
+    int
+    file_system_impl::do_preallocation (std::size_t bytes)
+    {
+      preallocation_bytes_ = bytes;
+      return 0;
+    }
+
   // ==========================================================================
   } /* namespace posix */
 } /* namespace os */
@@ -27,10 +27,13 @@
 
 #include <cmsis-plus/posix-io/file.h>
 #include <cmsis-plus/posix-io/file-system.h>
+#include <cmsis-plus/posix-io/block-device.h>
 
 #include <cmsis-plus/diag/trace.h>
 
 #include <cerrno>
+#include <limits>
+#include <sys/stat.h>
 
 // ----------------------------------------------------------------------------
 
@@ -45,14 +48,14 @@ namespace os
           { impl, type::file }
     {
 #if defined(OS_TRACE_POSIX_IO_FILE)
-      trace::printf ("file::%s()=%p\n", __func__, this);
+      OS_TRACE_PRINTF (posix_io_file, "file::%s()=%p\n", __func__, this);
 #endif
     }
 
     file::~file ()
     {
 #if defined(OS_TRACE_POSIX_IO_FILE)
-      trace::printf ("file::%s() @%p\n", __func__, this);
+      OS_TRACE_PRINTF (posix_io_file, "file::%s() @%p\n", __func__, this);
 #endif
     }
 
@@ -62,7 +65,7 @@ namespace os
     file::close (void)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE)
-      trace::printf ("file::%s() @%p\n", __func__, this);
+      OS_TRACE_PRINTF (posix_io_file, "file::%s() @%p\n", __func__, this);
 #endif
 
       int ret = io::close ();
@@ -76,11 +79,97 @@ namespace os
       return ret;
     }
 
+    ssize_t
+    file::read (void* buf, std::size_t nbyte)
+    {
+      internal_device_mode_ ();
+
+      return io::read (buf, nbyte);
+    }
+
+    ssize_t
+    file::readv (const struct iovec* iov, int iovcnt)
+    {
+      internal_device_mode_ ();
+
+      return io::readv (iov, iovcnt);
+    }
+
+    ssize_t
+    file::preadv (const struct iovec* iov, int iovcnt, off_t offset)
+    {
+      internal_device_mode_ ();
+
+      return io::preadv (iov, iovcnt, offset);
+    }
+
+    ssize_t
+    file::write (const void* buf, std::size_t nbyte)
+    {
+      internal_device_mode_ ();
+
+      ssize_t ret = io::write (buf, nbyte);
+#if defined(OS_INCLUDE_POSIX_IO_PATH_CACHE)
+      file_system ().invalidate_paths ();
+#endif
+      return ret;
+    }
+
+    ssize_t
+    file::writev (const struct iovec* iov, int iovcnt)
+    {
+      internal_device_mode_ ();
+
+      ssize_t ret = io::writev (iov, iovcnt);
+#if defined(OS_INCLUDE_POSIX_IO_PATH_CACHE)
+      file_system ().invalidate_paths ();
+#endif
+      return ret;
+    }
+
+    ssize_t
+    file::pwritev (const struct iovec* iov, int iovcnt, off_t offset)
+    {
+      internal_device_mode_ ();
+
+      ssize_t ret = io::pwritev (iov, iovcnt, offset);
+#if defined(OS_INCLUDE_POSIX_IO_PATH_CACHE)
+      file_system ().invalidate_paths ();
+#endif
+      return ret;
+    }
+
+    /**
+     * @details
+     * The device is shared by all files of the file system, so
+     * the access pattern of the file, and whether it was
+     * opened with `O_DIRECT`, are passed to it before each
+     * transfer. With `O_DIRECT`, the aligned blocks the file
+     * system transfers with the user buffer do not go through
+     * the device cache.
+     */
+    void
+    file::internal_device_mode_ (void)
+    {
+      class block_device& dev = file_system ().device ();
+      if (dev.advice () != advice_)
+        {
+          dev.fadvise (0, 0, advice_);
+        }
+
+      bool direct = ((impl ().status_flags () & O_DIRECT) != 0);
+      if (dev.direct () != direct)
+        {
+          dev.direct (direct);
+        }
+    }
+
     int
     file::ftruncate (off_t length)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE)
-      trace::printf ("file::%s(%u) @%p\n", __func__, length, this);
+      OS_TRACE_PRINTF (posix_io_file, "file::%s(%u) @%p\n", __func__, length,
+                       this);
 #endif
 
       if (length < 0)
@@ -92,27 +181,170 @@ namespace os
       errno = 0;
 
       // Execute the implementation specific code.
-      return impl ().do_ftruncate (length);
+      int ret = impl ().do_ftruncate (length);
+
+#if defined(OS_INCLUDE_POSIX_IO_PATH_CACHE)
+      file_system ().invalidate_paths ();
+#endif
+      return ret;
     }
 
     int
     file::fsync (void)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE)
-      trace::printf ("file::%s() @%p\n", __func__, this);
+      OS_TRACE_PRINTF (posix_io_file, "file::%s() @%p\n", __func__, this);
 #endif
 
+#if defined(OS_INCLUDE_POSIX_IO_GROUP_COMMIT)
+      int ret = fsync_writeback ();
+      if (ret <= 0)
+        {
+          return ret;
+        }
+
+      return fsync_commit ();
+#else
       errno = 0;
 
       // Execute the implementation specific code.
       return impl ().do_fsync ();
+#endif /* defined(OS_INCLUDE_POSIX_IO_GROUP_COMMIT) */
+    }
+
+#if defined(OS_INCLUDE_POSIX_IO_GROUP_COMMIT)
+
+    /**
+     * @details
+     * If the implementation can write back the file without
+     * flushing the device, the flush is left to `fsync_commit()`;
+     * otherwise the entire synchronisation is done here, by
+     * `do_fsync()`, as without group commit.
+     */
+    int
+    file::fsync_writeback (void)
+    {
+      errno = 0;
+
+      // Execute the implementation specific code.
+      int ret = impl ().do_fsync_writeback ();
+      if (ret == 0)
+        {
+          return 1;
+        }
+
+      if (errno != ENOSYS)
+        {
+          return -1;
+        }
+
+      errno = 0;
+
+      return impl ().do_fsync ();
+    }
+
+    /**
+     * @details
+     * Flush the file system device through its group commit, so
+     * that several threads calling `fsync()` at about the same time
+     * share a single device flush. Each caller returns only after a
+     * flush started after its write back completed.
+     */
+    int
+    file::fsync_commit (void)
+    {
+      class file_system& fs = file_system ();
+
+      return fs.fsync_group ().commit (fs.device ());
+    }
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_GROUP_COMMIT) */
+
+    /**
+     * @details
+     * Like `posix_fallocate()`, the file is extended if shorter
+     * than `offset + len`, but never shrunk. The implementations
+     * able to allocate contiguous space reserve it in one step, so
+     * the later writes in the range do not allocate.
+     */
+    int
+    file::fallocate (off_t offset, off_t len)
+    {
+#if defined(OS_TRACE_POSIX_IO_FILE)
+      OS_TRACE_PRINTF (posix_io_file, "file::%s(%d, %d) @%p\n", __func__,
+                       offset, len, this);
+#endif
+
+      if (offset < 0 || len <= 0)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      if (offset > std::numeric_limits<off_t>::max () - len)
+        {
+          errno = EFBIG;
+          return -1;
+        }
+
+      errno = 0;
+
+      // Execute the implementation specific code.
+      int ret = impl ().do_fallocate (offset, len);
+
+#if defined(OS_INCLUDE_POSIX_IO_PATH_CACHE)
+      file_system ().invalidate_paths ();
+#endif
+      return ret;
+    }
+
+    /**
+     * @details
+     * The access pattern (`POSIX_FADV_NORMAL`, `POSIX_FADV_RANDOM`,
+     * `POSIX_FADV_SEQUENTIAL`) is used by the device read-ahead
+     * while this file is read; the file offsets do not map to
+     * device blocks, so `POSIX_FADV_WILLNEED`, `POSIX_FADV_DONTNEED`
+     * and `POSIX_FADV_NOREUSE` are accepted and ignored.
+     */
+    int
+    file::fadvise (off_t offset, off_t len, int advice)
+    {
+#if defined(OS_TRACE_POSIX_IO_FILE)
+      OS_TRACE_PRINTF (posix_io_file, "file::%s(%d, %d, %d) @%p\n", __func__,
+                       offset, len, advice, this);
+#endif
+
+      if (offset < 0 || len < 0)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      switch (advice)
+        {
+        case POSIX_FADV_NORMAL:
+        case POSIX_FADV_RANDOM:
+        case POSIX_FADV_SEQUENTIAL:
+          advice_ = advice;
+          return 0;
+
+        case POSIX_FADV_WILLNEED:
+        case POSIX_FADV_DONTNEED:
+        case POSIX_FADV_NOREUSE:
+          return 0;
+
+        default:
+          errno = EINVAL;
+          return -1;
+        }
     }
 
     int
     file::fstatvfs (struct statvfs *buf)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE)
-      trace::printf ("file::%s(%p) @%p\n", __func__, buf, this);
+      OS_TRACE_PRINTF (posix_io_file, "file::%s(%p) @%p\n", __func__, buf,
+                       this);
 #endif
 
       errno = 0;
@@ -127,14 +359,14 @@ namespace os
         file_system_ (fs)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE)
-      trace::printf ("file_impl::%s()=%p\n", __func__, this);
+      OS_TRACE_PRINTF (posix_io_file, "file_impl::%s()=%p\n", __func__, this);
 #endif
     }
 
     file_impl::~file_impl ()
     {
 #if defined(OS_TRACE_POSIX_IO_FILE)
-      trace::printf ("file_impl::%s() @%p\n", __func__, this);
+      OS_TRACE_PRINTF (posix_io_file, "file_impl::%s() @%p\n", __func__, this);
 #endif
     }
 
@@ -159,6 +391,47 @@ namespace os
       return -1;
     }
 
+#if defined(OS_INCLUDE_POSIX_IO_GROUP_COMMIT)
+
+    /**
+     * @details
+     * Implementations that can separate writing back the file
+     * buffers and the directory entry from the device flush should
+     * override it, to allow concurrent `fsync()` calls to be merged.
+     */
+    int
+    file_impl::do_fsync_writeback (void)
+    {
+      errno = ENOSYS; // Not implemented
+      return -1;
+    }
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_GROUP_COMMIT) */
+
+    /**
+     * @details
+     * The default extends the file with `do_ftruncate()`; the
+     * implementations that can reserve contiguous space (like
+     * FatFs `f_expand()`) should override it.
+     */
+    int
+    file_impl::do_fallocate (off_t offset, off_t len)
+    {
+      struct stat buf;
+      if (do_fstat (&buf) < 0)
+        {
+          return -1;
+        }
+
+      off_t end = offset + len;
+      if (end <= buf.st_size)
+        {
+          return 0;
+        }
+
+      return do_ftruncate (end);
+    }
+
   // ==========================================================================
   } /* namespace posix */
 } /* namespace os */
@@ -0,0 +1,165 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#if defined(OS_INCLUDE_POSIX_IO_GROUP_COMMIT)
+
+#include <cmsis-plus/posix-io/group-commit.h>
+#include <cmsis-plus/posix-io/block-device.h>
+
+#include <cerrno>
+#include <mutex>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    group_commit::group_commit (void)
+    {
+      ;
+    }
+
+    group_commit::~group_commit ()
+    {
+      ;
+    }
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @details
+     * The caller must have already written back its data (for
+     * example the file buffers and the directory entry), without
+     * holding locks that other committers need, otherwise they
+     * cannot join the group.
+     *
+     * Requests are only merged with a flush that starts after
+     * they were received, so the durability guarantee is the
+     * same as for a separate flush.
+     */
+    int
+    group_commit::commit (block_device& device)
+    {
+      uint32_t ticket;
+        {
+          std::lock_guard<rtos::mutex> lock
+            { mutex_ };
+
+          ticket = ++requested_;
+          ++statistics_.requests;
+
+          // Wait for the flush covering the request, or for the
+          // turn to become the leader.
+          while (busy_ && static_cast<int32_t> (completed_ - ticket) < 0)
+            {
+              done_.wait (mutex_);
+            }
+
+          if (static_cast<int32_t> (completed_ - ticket) >= 0)
+            {
+              if (error_ != 0)
+                {
+                  errno = error_;
+                  return -1;
+                }
+              return 0;
+            }
+
+          busy_ = true;
+        }
+
+      // Allow the concurrent callers to join.
+      if (window_ > 0)
+        {
+          rtos::sysclock.sleep_for (window_);
+        }
+
+      uint32_t batch;
+        {
+          std::lock_guard<rtos::mutex> lock
+            { mutex_ };
+
+          batch = requested_;
+        }
+
+      // The flush is done without the mutex, new requests
+      // are queued for the next one.
+      errno = 0;
+      device.sync ();
+      int error = errno;
+
+        {
+          std::lock_guard<rtos::mutex> lock
+            { mutex_ };
+
+          completed_ = batch;
+          error_ = error;
+          ++statistics_.flushes;
+          busy_ = false;
+        }
+      done_.broadcast ();
+
+      if (error != 0)
+        {
+          errno = error;
+          return -1;
+        }
+      return 0;
+    }
+
+    void
+    group_commit::window (rtos::clock::duration_t ticks)
+    {
+      std::lock_guard<rtos::mutex> lock
+        { mutex_ };
+
+      window_ = ticks;
+    }
+
+    group_commit::statistics_t
+    group_commit::statistics (void) const
+    {
+      std::lock_guard<rtos::mutex> lock
+        { mutex_ };
+
+      return statistics_;
+    }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_GROUP_COMMIT) */
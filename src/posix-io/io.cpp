@@ -27,17 +27,22 @@
 
 #include <cmsis-plus/posix-io/device.h>
 #include <cmsis-plus/posix/sys/uio.h>
+#include <cmsis-plus/posix/sys/mman.h>
 #include <cmsis-plus/posix-io/device-registry.h>
 #include <cmsis-plus/posix-io/file.h>
 #include <cmsis-plus/posix-io/file-descriptors-manager.h>
 #include <cmsis-plus/posix-io/file-system.h>
 #include <cmsis-plus/posix-io/io.h>
+#include <cmsis-plus/posix-io/event-poll.h>
 
+#include <cmsis-plus/rtos/os.h>
 #include <cmsis-plus/diag/trace.h>
 
 #include <cassert>
 #include <cerrno>
 #include <cstdarg>
+#include <cstring>
+#include <fcntl.h>
 
 // ----------------------------------------------------------------------------
 
@@ -45,6 +50,80 @@
 // va_list structure, then call implementation functions like doOpen()
 // doIoctl(), that use 'va_list args'.
 
+namespace
+{
+  // Header of a private copy, used to map content that cannot
+  // be mapped directly; the copies are linked in a list, to be
+  // identified by munmap().
+  struct mapping_copy
+  {
+    mapping_copy* next;
+    std::size_t length;
+  };
+
+  constexpr std::size_t mapping_header_size = (sizeof(mapping_copy)
+      + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+
+  mapping_copy* mapping_copies;
+
+  // A thread waiting in select(), with the semaphore posted by
+  // io_impl::notify_readiness(); the node lives on its stack.
+  struct selector
+  {
+    selector* next;
+    os::rtos::semaphore_binary* sem;
+  };
+
+  selector* selectors;
+
+  // Check the descriptors in the input sets; return the number of
+  // ready conditions, stored in the output sets, or -1 with errno
+  // set to EBADF.
+  int
+  select_scan (int nfds, const fd_set* readfds, const fd_set* writefds,
+               const fd_set* exceptfds, fd_set* rd, fd_set* wr, fd_set* ex)
+  {
+    using os::posix::io;
+
+    int count = 0;
+    for (int fd = 0; fd < nfds; ++fd)
+      {
+        bool want_rd = (readfds != nullptr) && FD_ISSET(fd, readfds);
+        bool want_wr = (writefds != nullptr) && FD_ISSET(fd, writefds);
+        bool want_ex = (exceptfds != nullptr) && FD_ISSET(fd, exceptfds);
+        if (!want_rd && !want_wr && !want_ex)
+          {
+            continue;
+          }
+
+        auto* const fio = os::posix::file_descriptors_manager::io (fd);
+        if (fio == nullptr)
+          {
+            errno = EBADF;
+            return -1;
+          }
+
+        io::readiness_t r = fio->ready ();
+        if (want_rd && (r & io::readiness::read) != 0)
+          {
+            FD_SET(fd, rd);
+            ++count;
+          }
+        if (want_wr && (r & io::readiness::write) != 0)
+          {
+            FD_SET(fd, wr);
+            ++count;
+          }
+        if (want_ex && (r & io::readiness::except) != 0)
+          {
+            FD_SET(fd, ex);
+            ++count;
+          }
+      }
+    return count;
+  }
+}
+
 namespace os
 {
   namespace posix
@@ -72,7 +151,8 @@ namespace os
     vopen (const char* path, int oflag, std::va_list args)
     {
 #if defined(OS_TRACE_POSIX_IO_IO)
-      trace::printf ("io::%s(\"%s\")\n", __func__, path ? path : "");
+      OS_TRACE_PRINTF (posix_io_io, "io::%s(\"%s\")\n", __func__,
+                       path ? path : "");
 #endif
 
       if (path == nullptr)
@@ -136,12 +216,345 @@ namespace os
       // Return a valid pointer to an object derived from io, or nullptr.
 
 #if defined(OS_TRACE_POSIX_IO_IO)
-      trace::printf ("io::%s(\"%s\")=%p fd=%d\n", __func__, path, io,
-                     io->file_descriptor ());
+      OS_TRACE_PRINTF (posix_io_io, "io::%s(\"%s\")=%p fd=%d\n", __func__, path,
+                       io, io->file_descriptor ());
 #endif
       return io;
     }
 
+    /**
+     * @details
+     * Mappings of storage that is addressed directly (XIP flash,
+     * RAM disks) need no action, the storage remains valid;
+     * private copies are returned to the memory resource.
+     */
+    int
+    munmap (void* addr, std::size_t length)
+    {
+#if defined(OS_TRACE_POSIX_IO_IO)
+      OS_TRACE_PRINTF (posix_io_io, "%s(%p, %u)\n", __func__, addr, length);
+#endif
+
+      if ((addr == nullptr) || (length == 0))
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      mapping_copy* copy = nullptr;
+        {
+          // ----- Enter critical section -------------------------------------
+          rtos::scheduler::critical_section scs;
+
+          for (mapping_copy** p = &mapping_copies; *p != nullptr;
+              p = &((*p)->next))
+            {
+              if (reinterpret_cast<char*> (*p) + mapping_header_size
+                  == static_cast<char*> (addr))
+                {
+                  copy = *p;
+                  *p = copy->next;
+                  break;
+                }
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+
+      if (copy != nullptr)
+        {
+          rtos::memory::get_default_resource ()->deallocate (
+              copy, mapping_header_size + copy->length);
+        }
+
+      errno = 0;
+      return 0;
+    }
+
+    /**
+     * @details
+     * The calling thread checks the descriptors and, if none is
+     * ready, blocks until an implementation calls
+     * `io_impl::notify_readiness()`, then checks them again; with
+     * a timeout, the wait uses the system clock timeouts list, so
+     * a single thread can serve all descriptors, without polling.
+     *
+     * Notifications are not specific to a descriptor, so a wake-up
+     * may find nothing ready and the thread waits again.
+     */
+    int
+    select (int nfds, fd_set* readfds, fd_set* writefds, fd_set* exceptfds,
+            struct timeval* timeout)
+    {
+#if defined(OS_TRACE_POSIX_IO_IO)
+      OS_TRACE_PRINTF (posix_io_io, "%s(%d, %p, %p, %p, %p)\n", __func__, nfds,
+                       readfds, writefds, exceptfds, timeout);
+#endif
+
+      if ((nfds < 0) || (nfds > FD_SETSIZE))
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      if (rtos::interrupts::in_handler_mode ())
+        {
+          errno = EPERM;
+          return -1;
+        }
+
+      rtos::clock::duration_t ticks = 0;
+      if (timeout != nullptr)
+        {
+          if ((timeout->tv_sec < 0) || (timeout->tv_usec < 0)
+              || (timeout->tv_usec >= 1000000))
+            {
+              errno = EINVAL;
+              return -1;
+            }
+          ticks = rtos::clock_systick::ticks_cast (
+              static_cast<uint64_t> (timeout->tv_sec) * 1000000u
+                  + static_cast<uint64_t> (timeout->tv_usec));
+        }
+      rtos::clock::timestamp_t deadline = rtos::sysclock.steady_now () + ticks;
+
+      fd_set rd;
+      fd_set wr;
+      fd_set ex;
+
+      rtos::semaphore_binary sem
+        { "select", 0 };
+      selector self
+        { nullptr, &sem };
+
+        {
+          // Link before the first check, to catch changes that
+          // happen before the wait.
+
+          // ----- Enter critical section -------------------------------------
+          rtos::interrupts::critical_section ics;
+
+          self.next = selectors;
+          selectors = &self;
+          // ----- Exit critical section --------------------------------------
+        }
+
+      int count;
+      for (;;)
+        {
+          FD_ZERO(&rd);
+          FD_ZERO(&wr);
+          FD_ZERO(&ex);
+
+          count = select_scan (nfds, readfds, writefds, exceptfds, &rd, &wr,
+                               &ex);
+          if (count != 0)
+            {
+              break;
+            }
+
+          rtos::result_t res;
+          if (timeout == nullptr)
+            {
+              res = sem.wait ();
+            }
+          else
+            {
+              rtos::clock::timestamp_t now = rtos::sysclock.steady_now ();
+              if (now >= deadline)
+                {
+                  break;
+                }
+              res = sem.timed_wait (
+                  static_cast<rtos::clock::duration_t> (deadline - now));
+            }
+
+          if (res == EINTR)
+            {
+              errno = EINTR;
+              count = -1;
+              break;
+            }
+        }
+
+        {
+          // ----- Enter critical section -------------------------------------
+          rtos::interrupts::critical_section ics;
+
+          for (selector** p = &selectors; *p != nullptr; p = &((*p)->next))
+            {
+              if (*p == &self)
+                {
+                  *p = self.next;
+                  break;
+                }
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+
+      if (count < 0)
+        {
+          return -1;
+        }
+
+      if (readfds != nullptr)
+        {
+          *readfds = rd;
+        }
+      if (writefds != nullptr)
+        {
+          *writefds = wr;
+        }
+      if (exceptfds != nullptr)
+        {
+          *exceptfds = ex;
+        }
+
+      errno = 0;
+      return count;
+    }
+
+    /**
+     * @details
+     * Copy up to _count_ bytes from _in_ to _out_, similar to
+     * the Linux `sendfile()`. If _offset_ is not `nullptr`, the
+     * read starts there and _offset_ is updated, without changing
+     * the offset of _in_; otherwise the offset of _in_ is used
+     * and updated.
+     *
+     * When _in_ exposes its content, via `io::peek()`, like the
+     * directly mapped devices and the cached block devices, the
+     * content is written to _out_ from there; otherwise it passes
+     * through an internal buffer of
+     * `OS_INTEGER_POSIX_IO_SENDFILE_BUFFER_SIZE` bytes,
+     * and the application needs no buffer.
+     *
+     * @return The number of bytes written, or -1 if nothing was
+     *  written and the variable errno is set to indicate the error.
+     */
+    ssize_t
+    sendfile (io& out, io& in, off_t* offset, std::size_t count)
+    {
+#if defined(OS_TRACE_POSIX_IO_IO)
+      OS_TRACE_PRINTF (posix_io_io, "%s(%p, %p, %p, %u)\n", __func__, &out, &in,
+                       offset, count);
+#endif
+
+      off_t pos;
+      bool seekable;
+      if (offset != nullptr)
+        {
+          if (*offset < 0)
+            {
+              errno = EINVAL;
+              return -1;
+            }
+          pos = *offset;
+          seekable = true;
+        }
+      else
+        {
+          pos = in.lseek (0, SEEK_CUR);
+          seekable = (pos >= 0);
+        }
+
+      bool peekable = seekable;
+      rtos::memory::memory_resource* mr = rtos::memory::get_default_resource ();
+      uint8_t* buffer = nullptr;
+      constexpr std::size_t buffer_size =
+          OS_INTEGER_POSIX_IO_SENDFILE_BUFFER_SIZE;
+
+      std::size_t total = 0;
+      int err = 0;
+      while (total < count)
+        {
+          const void* p = nullptr;
+          ssize_t n = -1;
+          if (peekable)
+            {
+              n = in.peek (&p, count - total, pos);
+              if (n <= 0)
+                {
+                  // Fall back to the buffer for the rest.
+                  peekable = false;
+                }
+            }
+
+          if (n <= 0)
+            {
+              if (buffer == nullptr)
+                {
+                  buffer = static_cast<uint8_t*> (mr->allocate (buffer_size));
+                  if (buffer == nullptr)
+                    {
+                      err = ENOMEM;
+                      break;
+                    }
+                }
+
+              std::size_t chunk = count - total;
+              if (chunk > buffer_size)
+                {
+                  chunk = buffer_size;
+                }
+              n = seekable ? in.pread (buffer, chunk, pos) :
+                             in.read (buffer, chunk);
+              if (n < 0)
+                {
+                  err = errno;
+                  break;
+                }
+              if (n == 0)
+                {
+                  break; // End of file.
+                }
+              p = buffer;
+            }
+
+          std::size_t done = 0;
+          while (done < static_cast<std::size_t> (n))
+            {
+              ssize_t w = out.write (static_cast<const uint8_t*> (p) + done,
+                                     static_cast<std::size_t> (n) - done);
+              if (w <= 0)
+                {
+                  err = (w < 0) ? errno : EIO;
+                  break;
+                }
+              done += static_cast<std::size_t> (w);
+            }
+
+          total += done;
+          pos += static_cast<off_t> (done);
+          if (done < static_cast<std::size_t> (n))
+            {
+              break;
+            }
+        }
+
+      if (buffer != nullptr)
+        {
+          mr->deallocate (buffer, buffer_size);
+        }
+
+      if (offset != nullptr)
+        {
+          *offset = pos;
+        }
+      else if (seekable)
+        {
+          in.lseek (pos, SEEK_SET);
+        }
+
+      if (total == 0 && err != 0)
+        {
+          errno = err;
+          return -1;
+        }
+
+      errno = 0;
+      return static_cast<ssize_t> (total);
+    }
+
     // ========================================================================
 
     io::io (io_impl& impl, type t) :
@@ -149,7 +562,7 @@ namespace os
         type_ (t)
     {
 #if defined(OS_TRACE_POSIX_IO_IO)
-      trace::printf ("io::%s()=%p\n", __func__, this);
+      OS_TRACE_PRINTF (posix_io_io, "io::%s()=%p\n", __func__, this);
 #endif
 
       file_descriptor_ = no_file_descriptor;
@@ -158,7 +571,7 @@ namespace os
     io::~io ()
     {
 #if defined(OS_TRACE_POSIX_IO_IO)
-      trace::printf ("io::%s() @%p\n", __func__, this);
+      OS_TRACE_PRINTF (posix_io_io, "io::%s() @%p\n", __func__, this);
 #endif
 
       file_descriptor_ = no_file_descriptor;
@@ -170,7 +583,7 @@ namespace os
     io::close (void)
     {
 #if defined(OS_TRACE_POSIX_IO_IO)
-      trace::printf ("io::%s() @%p\n", __func__, this);
+      OS_TRACE_PRINTF (posix_io_io, "io::%s() @%p\n", __func__, this);
 #endif
 
       if (!impl ().do_is_opened ())
@@ -184,6 +597,9 @@ namespace os
       // Execute the implementation specific code.
       int ret = impl ().do_close ();
 
+      // Remove it from the interest lists.
+      event_poll::internal_forget_ (impl ());
+
       // Remove this IO from the file descriptors registry.
       file_descriptors_manager::deallocate (file_descriptor_);
       file_descriptor_ = no_file_descriptor;
@@ -195,7 +611,7 @@ namespace os
     io::alloc_file_descriptor (void)
     {
 #if defined(OS_TRACE_POSIX_IO_IO)
-      trace::printf ("io::%s() @%p\n", __func__, this);
+      OS_TRACE_PRINTF (posix_io_io, "io::%s() @%p\n", __func__, this);
 #endif
 
       int fd = file_descriptors_manager::allocate (this);
@@ -208,7 +624,7 @@ namespace os
         }
 
 #if defined(OS_TRACE_POSIX_IO_IO)
-      trace::printf ("io::%s() @%p fd=%d\n", __func__, this, fd);
+      OS_TRACE_PRINTF (posix_io_io, "io::%s() @%p fd=%d\n", __func__, this, fd);
 #endif
 
       // Return a valid pointer to an object derived from `io`.
@@ -217,13 +633,76 @@ namespace os
 
     // ------------------------------------------------------------------------
 
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+
+    namespace
+    {
+      // Account one call, started at begin (hrclock cycles).
+      void
+      account (io::operation_statistics_t& op, ssize_t ret,
+               rtos::clock::timestamp_t begin)
+      {
+        uint64_t cycles = rtos::hrclock.now () - begin;
+
+        // ----- Enter critical section -------------------------------------
+        rtos::scheduler::critical_section scs;
+
+        ++op.calls;
+        if (ret < 0)
+          {
+            ++op.errors;
+          }
+        else
+          {
+            op.bytes += static_cast<uint64_t> (ret);
+          }
+        op.total_cycles += cycles;
+        if (cycles > op.max_cycles)
+          {
+            op.max_cycles = cycles;
+          }
+        // ----- Exit critical section --------------------------------------
+      }
+    } /* namespace */
+
+    /**
+     * @details
+     * Only the calls that reach the implementation are counted;
+     * the calls rejected by the checks in `io` are not.
+     */
+    void
+    io::statistics (statistics_t* stats) const
+    {
+      if (stats != nullptr)
+        {
+          // ----- Enter critical section -----------------------------------
+          rtos::scheduler::critical_section scs;
+
+          *stats = impl ().statistics_;
+          // ----- Exit critical section ------------------------------------
+        }
+    }
+
+    void
+    io::clear_statistics (void)
+    {
+      // ----- Enter critical section ---------------------------------------
+      rtos::scheduler::critical_section scs;
+
+      impl ().statistics_ = statistics_t ();
+      // ----- Exit critical section ----------------------------------------
+    }
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
     // All these wrappers are required to clear 'errno'.
 
     ssize_t
     io::read (void* buf, std::size_t nbyte)
     {
 #if defined(OS_TRACE_POSIX_IO_IO)
-      trace::printf ("io::%s(0x0%X, %u) @%p\n", __func__, buf, nbyte, this);
+      OS_TRACE_PRINTF (posix_io_io, "io::%s(0x0%X, %u) @%p\n", __func__, buf,
+                       nbyte, this);
 #endif
 
       if (buf == nullptr)
@@ -256,16 +735,23 @@ namespace os
           return 0; // Nothing to do.
         }
 
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      rtos::clock::timestamp_t begin = rtos::hrclock.now ();
+#endif
+
       // Execute the implementation specific code.
       ssize_t ret = impl ().do_read (buf, nbyte);
       if (ret >= 0)
         {
           impl ().offset_ += ret;
         }
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      account (impl ().statistics_.read, ret, begin);
+#endif
 
 #if defined(OS_TRACE_POSIX_IO_IO)
-      trace::printf ("io::%s(0x0%X, %u) @%p n=%d\n", __func__, buf, nbyte, this,
-                     ret);
+      OS_TRACE_PRINTF (posix_io_io, "io::%s(0x0%X, %u) @%p n=%d\n", __func__,
+                       buf, nbyte, this, ret);
 #endif
       return ret;
     }
@@ -274,7 +760,8 @@ namespace os
     io::write (const void* buf, std::size_t nbyte)
     {
 #if defined(OS_TRACE_POSIX_IO_IO)
-      trace::printf ("io::%s(0x0%X, %u) @%p\n", __func__, buf, nbyte, this);
+      OS_TRACE_PRINTF (posix_io_io, "io::%s(0x0%X, %u) @%p\n", __func__, buf,
+                       nbyte, this);
 #endif
 
       if (buf == nullptr)
@@ -309,16 +796,23 @@ namespace os
           return 0; // Nothing to do.
         }
 
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      rtos::clock::timestamp_t begin = rtos::hrclock.now ();
+#endif
+
       // Execute the implementation specific code.
       ssize_t ret = impl ().do_write (buf, nbyte);
       if (ret >= 0)
         {
           impl ().offset_ += ret;
         }
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      account (impl ().statistics_.write, ret, begin);
+#endif
 
 #if defined(OS_TRACE_POSIX_IO_IO)
-      trace::printf ("io::%s(0x0%X, %u) @%p n=%d\n", __func__, buf, nbyte, this,
-                     ret);
+      OS_TRACE_PRINTF (posix_io_io, "io::%s(0x0%X, %u) @%p n=%d\n", __func__,
+                       buf, nbyte, this, ret);
 #endif
       return ret;
     }
@@ -327,7 +821,8 @@ namespace os
     io::writev (const struct iovec* iov, int iovcnt)
     {
 #if defined(OS_TRACE_POSIX_IO_IO)
-      trace::printf ("io::%s(0x0%X, %d) @%p\n", __func__, iov, iovcnt, this);
+      OS_TRACE_PRINTF (posix_io_io, "io::%s(0x0%X, %d) @%p\n", __func__, iov,
+                       iovcnt, this);
 #endif
 
       if (iov == nullptr)
@@ -356,15 +851,293 @@ namespace os
 
       errno = 0;
 
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      rtos::clock::timestamp_t begin = rtos::hrclock.now ();
+#endif
+
       // Execute the implementation specific code.
       ssize_t ret = impl ().do_writev (iov, iovcnt);
       if (ret >= 0)
         {
           impl ().offset_ += ret;
         }
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      account (impl ().statistics_.write, ret, begin);
+#endif
+      return ret;
+    }
+
+    ssize_t
+    io::readv (const struct iovec* iov, int iovcnt)
+    {
+#if defined(OS_TRACE_POSIX_IO_IO)
+      OS_TRACE_PRINTF (posix_io_io, "io::%s(0x0%X, %d) @%p\n", __func__, iov,
+                       iovcnt, this);
+#endif
+
+      if (iov == nullptr)
+        {
+          errno = EFAULT;
+          return -1;
+        }
+
+      if (iovcnt <= 0)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      if (!impl ().do_is_opened ())
+        {
+          errno = EBADF; // Not opened.
+          return -1;
+        }
+
+      if (!impl ().do_is_connected ())
+        {
+          errno = EIO; // Not opened.
+          return -1;
+        }
+
+      errno = 0;
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      rtos::clock::timestamp_t begin = rtos::hrclock.now ();
+#endif
+
+      // Execute the implementation specific code.
+      ssize_t ret = impl ().do_readv (iov, iovcnt);
+      if (ret >= 0)
+        {
+          impl ().offset_ += ret;
+        }
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      account (impl ().statistics_.read, ret, begin);
+#endif
+      return ret;
+    }
+
+    // The positional functions do not change the file offset.
+
+    ssize_t
+    io::pread (void* buf, std::size_t nbyte, off_t offset)
+    {
+      if (buf == nullptr)
+        {
+          errno = EFAULT;
+          return -1;
+        }
+
+      if (nbyte == 0)
+        {
+          errno = 0;
+          return 0; // Nothing to do.
+        }
+
+      struct iovec iov;
+      iov.iov_base = buf;
+      iov.iov_len = nbyte;
+
+      return preadv (&iov, 1, offset);
+    }
+
+    ssize_t
+    io::pwrite (const void* buf, std::size_t nbyte, off_t offset)
+    {
+      if (buf == nullptr)
+        {
+          errno = EFAULT;
+          return -1;
+        }
+
+      if (nbyte == 0)
+        {
+          errno = 0;
+          return 0; // Nothing to do.
+        }
+
+      struct iovec iov;
+      iov.iov_base = const_cast<void*> (buf);
+      iov.iov_len = nbyte;
+
+      return pwritev (&iov, 1, offset);
+    }
+
+    ssize_t
+    io::preadv (const struct iovec* iov, int iovcnt, off_t offset)
+    {
+#if defined(OS_TRACE_POSIX_IO_IO)
+      OS_TRACE_PRINTF (posix_io_io, "io::%s(0x0%X, %d, %d) @%p\n", __func__,
+                       iov, iovcnt, offset, this);
+#endif
+
+      if (iov == nullptr)
+        {
+          errno = EFAULT;
+          return -1;
+        }
+
+      if ((iovcnt <= 0) || (offset < 0))
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      if (!impl ().do_is_opened ())
+        {
+          errno = EBADF; // Not opened.
+          return -1;
+        }
+
+      if (!impl ().do_is_connected ())
+        {
+          errno = EIO; // Not opened.
+          return -1;
+        }
+
+      errno = 0;
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      rtos::clock::timestamp_t begin = rtos::hrclock.now ();
+#endif
+
+      // Execute the implementation specific code.
+      ssize_t ret = impl ().do_preadv (iov, iovcnt, offset);
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      account (impl ().statistics_.read, ret, begin);
+#endif
+      return ret;
+    }
+
+    ssize_t
+    io::pwritev (const struct iovec* iov, int iovcnt, off_t offset)
+    {
+#if defined(OS_TRACE_POSIX_IO_IO)
+      OS_TRACE_PRINTF (posix_io_io, "io::%s(0x0%X, %d, %d) @%p\n", __func__,
+                       iov, iovcnt, offset, this);
+#endif
+
+      if (iov == nullptr)
+        {
+          errno = EFAULT;
+          return -1;
+        }
+
+      if ((iovcnt <= 0) || (offset < 0))
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      if (!impl ().do_is_opened ())
+        {
+          errno = EBADF; // Not opened.
+          return -1;
+        }
+
+      if (!impl ().do_is_connected ())
+        {
+          errno = EIO; // Not opened.
+          return -1;
+        }
+
+      errno = 0;
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      rtos::clock::timestamp_t begin = rtos::hrclock.now ();
+#endif
+
+      // Execute the implementation specific code.
+      ssize_t ret = impl ().do_pwritev (iov, iovcnt, offset);
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      account (impl ().statistics_.write, ret, begin);
+#endif
       return ret;
     }
 
+    /**
+     * @details
+     * Implementations able to address their storage directly
+     * return a pointer inside it, and reads are zero-copy.
+     *
+     * Otherwise, as a fallback, private mappings are served by a
+     * copy of the content, allocated from the default memory
+     * resource; as required by POSIX, changes to a private mapping
+     * are not carried to the storage. Shared mappings of such
+     * content fail with `ENODEV`, and the application should use
+     * `pread()`.
+     */
+    void*
+    io::mmap (std::size_t length, int prot, int flags, off_t offset)
+    {
+#if defined(OS_TRACE_POSIX_IO_IO)
+      OS_TRACE_PRINTF (posix_io_io, "io::%s(%u, %d, %d, %d) @%p\n", __func__,
+                       length, prot, flags, offset, this);
+#endif
+
+      int map_type = flags & (MAP_SHARED | MAP_PRIVATE);
+      if ((length == 0) || (offset < 0)
+          || ((map_type != MAP_SHARED) && (map_type != MAP_PRIVATE)))
+        {
+          errno = EINVAL;
+          return MAP_FAILED;
+        }
+
+      if (!impl ().do_is_opened ())
+        {
+          errno = EBADF; // Not opened.
+          return MAP_FAILED;
+        }
+
+      errno = 0;
+
+      // Execute the implementation specific code.
+      void* addr = impl ().do_mmap (length, prot, flags, offset);
+      if ((addr != MAP_FAILED) || (errno != ENODEV)
+          || (map_type != MAP_PRIVATE))
+        {
+          return addr;
+        }
+
+      void* block = rtos::memory::get_default_resource ()->allocate (
+          mapping_header_size + length);
+      if (block == nullptr)
+        {
+          errno = ENOMEM;
+          return MAP_FAILED;
+        }
+
+      char* data = static_cast<char*> (block) + mapping_header_size;
+      ssize_t ret = pread (data, length, offset);
+      if (ret < 0)
+        {
+          int err = errno;
+          rtos::memory::get_default_resource ()->deallocate (
+              block, mapping_header_size + length);
+          errno = err;
+          return MAP_FAILED;
+        }
+
+      // Beyond the end of the content, the mapping reads as zeros.
+      std::memset (data + ret, 0, length - static_cast<std::size_t> (ret));
+
+      mapping_copy* copy = static_cast<mapping_copy*> (block);
+      copy->length = length;
+        {
+          // ----- Enter critical section -------------------------------------
+          rtos::scheduler::critical_section scs;
+
+          copy->next = mapping_copies;
+          mapping_copies = copy;
+          // ----- Exit critical section --------------------------------------
+        }
+
+      errno = 0;
+      return data;
+    }
+
     int
     io::fcntl (int cmd, ...)
     {
@@ -381,7 +1154,7 @@ namespace os
     io::vfcntl (int cmd, std::va_list args)
     {
 #if defined(OS_TRACE_POSIX_IO_IO)
-      trace::printf ("io::%s(%d) @%p\n", __func__, cmd, this);
+      OS_TRACE_PRINTF (posix_io_io, "io::%s(%d) @%p\n", __func__, cmd, this);
 #endif
 
       if (!impl ().do_is_opened ())
@@ -398,6 +1171,18 @@ namespace os
 
       errno = 0;
 
+      // The file status flags are kept by the object, the
+      // implementations check them with io_impl::nonblocking().
+      if (cmd == F_GETFL)
+        {
+          return impl ().status_flags_;
+        }
+      else if (cmd == F_SETFL)
+        {
+          impl ().status_flags (va_arg(args, int));
+          return 0;
+        }
+
       // Execute the implementation specific code.
       return impl ().do_vfcntl (cmd, args);
     }
@@ -411,12 +1196,62 @@ namespace os
       return impl ().do_isatty ();
     }
 
+    /**
+     * @details
+     * By default, only content mapped directly by the
+     * implementation can be exposed.
+     */
+    ssize_t
+    io::peek (const void** buf, std::size_t nbyte, off_t offset)
+    {
+      if (buf == nullptr)
+        {
+          errno = EFAULT;
+          return -1;
+        }
+
+      if ((nbyte == 0) || (offset < 0))
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      if (!impl ().do_is_opened ())
+        {
+          errno = EBADF; // Not opened.
+          return -1;
+        }
+
+      errno = 0;
+
+      void* p = impl ().do_mmap (nbyte, PROT_READ, MAP_SHARED, offset);
+      if (p == MAP_FAILED)
+        {
+          return -1;
+        }
+
+      *buf = p;
+      return static_cast<ssize_t> (nbyte);
+    }
+
+    io::readiness_t
+    io::ready (void)
+    {
+      if (!impl ().do_is_opened ())
+        {
+          return readiness::except;
+        }
+
+      // Execute the implementation specific code.
+      return impl ().do_ready ();
+    }
+
     // fstat() on a socket returns a zero'd buffer.
     int
     io::fstat (struct stat* buf)
     {
 #if defined(OS_TRACE_POSIX_IO_IO)
-      trace::printf ("io::%s(%p) @%p\n", __func__, buf, this);
+      OS_TRACE_PRINTF (posix_io_io, "io::%s(%p) @%p\n", __func__, buf, this);
 #endif
 
       if (buf == nullptr)
@@ -447,7 +1282,8 @@ namespace os
     io::lseek (off_t offset, int whence)
     {
 #if defined(OS_TRACE_POSIX_IO_IO)
-      trace::printf ("io::%s(%d, %d) @%p\n", __func__, offset, whence, this);
+      OS_TRACE_PRINTF (posix_io_io, "io::%s(%d, %d) @%p\n", __func__, offset,
+                       whence, this);
 #endif
 
       if (!impl ().do_is_opened ())
@@ -467,14 +1303,14 @@ namespace os
     io_impl::io_impl (void)
     {
 #if defined(OS_TRACE_POSIX_IO_IO)
-      trace::printf ("io_impl::%s()=%p\n", __func__, this);
+      OS_TRACE_PRINTF (posix_io_io, "io_impl::%s()=%p\n", __func__, this);
 #endif
     }
 
     io_impl::~io_impl ()
     {
 #if defined(OS_TRACE_POSIX_IO_IO)
-      trace::printf ("io_impl::%s() @%p\n", __func__, this);
+      OS_TRACE_PRINTF (posix_io_io, "io_impl::%s() @%p\n", __func__, this);
 #endif
     }
 
@@ -490,6 +1326,65 @@ namespace os
       return true;
     }
 
+    /**
+     * @details
+     * As for regular files, by default reads and writes never block.
+     */
+    io::readiness_t
+    io_impl::do_ready (void)
+    {
+      return io::readiness::read | io::readiness::write;
+    }
+
+    /**
+     * @details
+     * Only `O_NONBLOCK`, `O_APPEND` and `O_DIRECT` are kept, the
+     * other bits are ignored.
+     */
+    void
+    io_impl::status_flags (int flags)
+    {
+      constexpr int settable = O_NONBLOCK | O_APPEND | O_DIRECT;
+      status_flags_ = (status_flags_ & ~settable) | (flags & settable);
+    }
+
+    /**
+     * @details
+     * With `O_NONBLOCK` set, operations that would block must
+     * fail with `EAGAIN` instead.
+     */
+    bool
+    io_impl::nonblocking (void) const
+    {
+      return (status_flags_ & O_NONBLOCK) != 0;
+    }
+
+    /**
+     * @details
+     * Resume all threads waiting in `select()`, which check again
+     * their descriptors, and push the object in the ready lists of
+     * the event polls watching it.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    void
+    io_impl::notify_readiness (void)
+    {
+      // ----- Enter critical section -----------------------------------------
+      rtos::interrupts::critical_section ics;
+
+      for (selector* p = selectors; p != nullptr; p = p->next)
+        {
+          p->sem->post ();
+        }
+
+      for (event_poll_entry* e = watchers_; e != nullptr; e = e->watch_next)
+        {
+          e->poll->internal_notify_ (e);
+        }
+      // ----- Exit critical section ------------------------------------------
+    }
+
     ssize_t
     io_impl::do_writev (const struct iovec* iov, int iovcnt)
     {
@@ -508,6 +1403,78 @@ namespace os
       return total;
     }
 
+    ssize_t
+    io_impl::do_readv (const struct iovec* iov, int iovcnt)
+    {
+      ssize_t total = 0;
+
+      const struct iovec* p = iov;
+      for (int i = 0; i < iovcnt; ++i, ++p)
+        {
+          ssize_t ret = do_read (p->iov_base, p->iov_len);
+          if (ret < 0)
+            {
+              return ret;
+            }
+          total += ret;
+          if (static_cast<std::size_t> (ret) < p->iov_len)
+            {
+              break; // Short read, do not continue with the next fragment.
+            }
+        }
+      return total;
+    }
+
+    // The default positional functions temporarily move the offset
+    // around the vectored call; implementations able to address
+    // the storage directly should override them.
+
+    ssize_t
+    io_impl::do_preadv (const struct iovec* iov, int iovcnt, off_t offset)
+    {
+      off_t saved = do_lseek (0, SEEK_CUR);
+      if (saved < 0)
+        {
+          return -1; // Usually ESPIPE, not seekable.
+        }
+
+      if (do_lseek (offset, SEEK_SET) < 0)
+        {
+          return -1;
+        }
+
+      ssize_t ret = do_readv (iov, iovcnt);
+
+      int err = errno;
+      do_lseek (saved, SEEK_SET);
+      errno = err;
+
+      return ret;
+    }
+
+    ssize_t
+    io_impl::do_pwritev (const struct iovec* iov, int iovcnt, off_t offset)
+    {
+      off_t saved = do_lseek (0, SEEK_CUR);
+      if (saved < 0)
+        {
+          return -1; // Usually ESPIPE, not seekable.
+        }
+
+      if (do_lseek (offset, SEEK_SET) < 0)
+        {
+          return -1;
+        }
+
+      ssize_t ret = do_writev (iov, iovcnt);
+
+      int err = errno;
+      do_lseek (saved, SEEK_SET);
+      errno = err;
+
+      return ret;
+    }
+
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-parameter"
 
@@ -532,6 +1499,13 @@ namespace os
       return -1;
     }
 
+    void*
+    io_impl::do_mmap (std::size_t length, int prot, int flags, off_t offset)
+    {
+      errno = ENODEV; // The storage cannot be mapped.
+      return MAP_FAILED;
+    }
+
 #pragma GCC diagnostic pop
 
   // ==========================================================================
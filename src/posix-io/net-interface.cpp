@@ -0,0 +1,183 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/posix-io/net-interface.h>
+#include <cmsis-plus/diag/trace.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    /**
+     * @details
+     * The receive interrupts remain disabled until the first
+     * call to `poll()` finds the interface idle.
+     */
+    net_interface::net_interface (net_interface_impl& impl, const char* name) :
+        name_ (name), //
+        impl_ (impl)
+    {
+#if defined(OS_TRACE_POSIX_IO_NET_INTERFACE)
+      OS_TRACE_PRINTF (posix_io_net_stack, "net_interface::%s(\"%s\")=%p\n",
+                       __func__, name_, this);
+#endif
+    }
+
+    net_interface::~net_interface ()
+    {
+#if defined(OS_TRACE_POSIX_IO_NET_INTERFACE)
+      OS_TRACE_PRINTF (posix_io_net_stack, "net_interface::%s(\"%s\") %p\n",
+                       __func__, name_, this);
+#endif
+    }
+
+    /**
+     * @details
+     * Mask the receive interrupts and wake up the network
+     * thread; the frames are left in the driver, to be
+     * picked by `poll()`.
+     *
+     * Under load, the interface stays in polling mode and
+     * there is a single interrupt per batch, instead of one
+     * per frame.
+     */
+    void
+    net_interface::rx_interrupt (void)
+    {
+      impl ().do_rx_interrupts (false);
+      rx_sem_.post ();
+    }
+
+    /**
+     * @details
+     * Get up to `budget` frames from the driver and pass them to
+     * the receive handler, or release them if there is none.
+     *
+     * When the driver has no more frames, the receive interrupts
+     * are enabled, then the driver is checked once more, to catch
+     * the frames received just before enabling them; if there
+     * are any, the interrupts are disabled again and the batch
+     * continues.
+     *
+     * If the budget was exhausted, the interrupts remain disabled
+     * and the caller is expected to call `poll()` again, after
+     * giving the other threads a chance to run.
+     */
+    std::size_t
+    net_interface::poll (std::size_t budget)
+    {
+      ++polls_;
+
+      std::size_t count = 0;
+      while (count < budget)
+        {
+          net_buffer* frame = impl ().do_receive ();
+          if (frame == nullptr)
+            {
+              impl ().do_rx_interrupts (true);
+
+              frame = impl ().do_receive ();
+              if (frame == nullptr)
+                {
+                  break;
+                }
+              impl ().do_rx_interrupts (false);
+            }
+
+          ++count;
+          if (rx_handler_ != nullptr)
+            {
+              rx_handler_ (frame, rx_handler_args_);
+            }
+          else
+            {
+              net_buffers_release (frame);
+            }
+        }
+
+      rx_frames_ += count;
+
+#if defined(OS_TRACE_POSIX_IO_NET_INTERFACE)
+      OS_TRACE_PRINTF (posix_io_net_stack, "net_interface::%s() %s %u/%u\n",
+                       __func__, name_, static_cast<unsigned int> (count),
+                       static_cast<unsigned int> (budget));
+#endif
+      return count;
+    }
+
+    /**
+     * @details
+     * To be run by the network thread; sleeps until the first
+     * receive interrupt, then polls until the interface is idle.
+     */
+    void
+    net_interface::run_rx (void)
+    {
+      for (;;)
+        {
+          rx_sem_.wait ();
+
+          while (poll () == OS_INTEGER_POSIX_IO_NET_POLL_BUDGET)
+            {
+              rtos::this_thread::yield ();
+            }
+        }
+    }
+
+    void*
+    net_interface::rx_thread (void* args)
+    {
+      static_cast<net_interface*> (args)->run_rx ();
+    }
+
+    // ========================================================================
+
+    net_interface_impl::net_interface_impl (void)
+    {
+#if defined(OS_TRACE_POSIX_IO_NET_INTERFACE)
+      OS_TRACE_PRINTF (posix_io_net_stack, "net_interface_impl::%s()=%p\n",
+                       __func__, this);
+#endif
+    }
+
+    net_interface_impl::~net_interface_impl ()
+    {
+#if defined(OS_TRACE_POSIX_IO_NET_INTERFACE)
+      OS_TRACE_PRINTF (posix_io_net_stack, "net_interface_impl::%s() @%p\n",
+                       __func__, this);
+#endif
+    }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
@@ -27,6 +27,9 @@
 
 #include <cmsis-plus/posix-io/net-stack.h>
 #include <cmsis-plus/posix-io/net-interface.h>
+#include <cmsis-plus/rtos/os.h>
+
+#include <cerrno>
 
 // ----------------------------------------------------------------------------
 
@@ -83,7 +86,8 @@ namespace os
         impl_ (impl)
     {
 #if defined(OS_TRACE_POSIX_IO_NET_STACK)
-      trace::printf ("net_stack::%s(\"%s\")=%p\n", __func__, name_, this);
+      OS_TRACE_PRINTF (posix_io_net_stack, "net_stack::%s(\"%s\")=%p\n",
+                       __func__, name_, this);
 #endif
       deferred_sockets_list_.clear ();
     }
@@ -91,7 +95,8 @@ namespace os
     net_stack::~net_stack ()
     {
 #if defined(OS_TRACE_POSIX_IO_NET_STACK)
-      trace::printf ("net_stack::%s(\"%s\") %p\n", __func__, name_, this);
+      OS_TRACE_PRINTF (posix_io_net_stack, "net_stack::%s(\"%s\") %p\n",
+                       __func__, name_, this);
 #endif
     }
 
@@ -103,23 +108,73 @@ namespace os
       return impl ().do_socket (domain, type, protocol);
     }
 
+    net_buffer*
+    net_stack::allocate_buffer (std::size_t size)
+    {
+      errno = 0;
+
+      return impl ().do_allocate_buffer (size);
+    }
+
     // ========================================================================
 
     net_stack_impl::net_stack_impl (net_interface& interface) :
         interface_ (interface)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("net_stack_impl::%s()=%p\n", __func__, this);
+      OS_TRACE_PRINTF (posix_io_file_system, "net_stack_impl::%s()=%p\n",
+                       __func__, this);
 #endif
     }
 
     net_stack_impl::~net_stack_impl ()
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
-      trace::printf ("net_stack_impl::%s() @%p\n", __func__, this);
+      OS_TRACE_PRINTF (posix_io_file_system, "net_stack_impl::%s() @%p\n",
+                       __func__, this);
 #endif
     }
 
+    namespace
+    {
+      // Free the buffers allocated by the default do_allocate_buffer().
+      void
+      release_default_buffer (net_buffer* buffer)
+      {
+        rtos::memory::get_default_resource ()->deallocate (
+            buffer, sizeof(net_buffer) + buffer->capacity,
+            alignof(net_buffer));
+      }
+    } /* namespace */
+
+    /**
+     * @details
+     * The default allocates the buffer and the payload in one block
+     * from the default memory resource. Stacks override it to return
+     * their own buffers, with room for the protocol headers.
+     */
+    net_buffer*
+    net_stack_impl::do_allocate_buffer (std::size_t size)
+    {
+      void* block = rtos::memory::get_default_resource ()->allocate (
+          sizeof(net_buffer) + size, alignof(net_buffer));
+      if (block == nullptr)
+        {
+          errno = ENOMEM;
+          return nullptr;
+        }
+
+      net_buffer* b = static_cast<net_buffer*> (block);
+      b->next = nullptr;
+      b->payload = b + 1;
+      b->length = 0;
+      b->capacity = size;
+      b->release = release_default_buffer;
+      b->owner = nullptr;
+
+      return b;
+    }
+
   // ==========================================================================
   } /* namespace posix */
 } /* namespace os */
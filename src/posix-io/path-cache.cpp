@@ -0,0 +1,225 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#if defined(OS_INCLUDE_POSIX_IO_PATH_CACHE)
+
+#include <cmsis-plus/posix-io/path-cache.h>
+#include <cmsis-plus/posix-io/file-system.h>
+
+#include <cmsis-plus/rtos/os.h>
+
+#include <cstring>
+
+// ----------------------------------------------------------------------------
+
+/**
+ * @cond ignore
+ */
+
+namespace
+{
+  static_assert(OS_INTEGER_POSIX_IO_PATH_CACHE_SIZE >= 1,
+      "OS_INTEGER_POSIX_IO_PATH_CACHE_SIZE must be at least 1");
+
+  constexpr std::size_t entries_size = OS_INTEGER_POSIX_IO_PATH_CACHE_SIZE;
+  constexpr std::size_t path_max = OS_INTEGER_POSIX_IO_PATH_CACHE_PATH_MAX;
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+  struct entry_t
+  {
+    // Null if the entry is free.
+    os::posix::file_system* fs;
+    uint32_t generation;
+    uint32_t hash;
+    bool exists;
+    struct stat st;
+    char path[path_max];
+  };
+
+#pragma GCC diagnostic pop
+
+  entry_t entries[entries_size];
+
+  // The next entry to be replaced, round robin.
+  std::size_t next_victim;
+
+  // FNV-1a, to avoid most string compares.
+  uint32_t
+  compute_hash (const char* path, std::size_t* len)
+  {
+    uint32_t h = 2166136261u;
+    const char* p = path;
+    for (; *p != '\0'; ++p)
+      {
+        h = (h ^ static_cast<uint8_t> (*p)) * 16777619u;
+      }
+    *len = static_cast<std::size_t> (p - path);
+    return h;
+  }
+
+  entry_t*
+  find (os::posix::file_system& fs, const char* path, uint32_t hash)
+  {
+    for (std::size_t i = 0; i < entries_size; ++i)
+      {
+        entry_t& en = entries[i];
+        if (en.fs == &fs && en.hash == hash
+            && std::strcmp (en.path, path) == 0)
+          {
+            return &en;
+          }
+      }
+    return nullptr;
+  }
+}
+
+/**
+ * @endcond
+ */
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ------------------------------------------------------------------------
+
+    namespace path_cache
+    {
+      /**
+       * @details
+       * The entries of an older generation of the file system
+       * are stale, and are not returned.
+       */
+      int
+      lookup (file_system& fs, const char* path, struct stat* buf)
+      {
+        std::size_t len;
+        uint32_t hash = compute_hash (path, &len);
+        if (len >= path_max)
+          {
+            return -1;
+          }
+
+        // ----- Enter critical section ---------------------------------------
+        rtos::scheduler::critical_section scs;
+
+        entry_t* en = find (fs, path, hash);
+        if (en == nullptr || en->generation != fs.paths_generation ())
+          {
+            return -1;
+          }
+
+        if (!en->exists)
+          {
+            return 0;
+          }
+
+        if (buf != nullptr)
+          {
+            *buf = en->st;
+          }
+        return 1;
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      /**
+       * @details
+       * Paths too long for the entries are not cached.
+       */
+      void
+      insert (file_system& fs, const char* path, const struct stat* buf,
+              uint32_t generation)
+      {
+        std::size_t len;
+        uint32_t hash = compute_hash (path, &len);
+        if (len >= path_max)
+          {
+            return;
+          }
+
+        // ----- Enter critical section ---------------------------------------
+        rtos::scheduler::critical_section scs;
+
+        entry_t* en = find (fs, path, hash);
+        if (en == nullptr)
+          {
+            en = &entries[next_victim];
+            next_victim = (next_victim + 1) % entries_size;
+
+            en->fs = &fs;
+            en->hash = hash;
+            std::memcpy (en->path, path, len + 1);
+          }
+
+        en->generation = generation;
+        en->exists = (buf != nullptr);
+        if (buf != nullptr)
+          {
+            en->st = *buf;
+          }
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      /**
+       * @details
+       * Called when the file system is mounted or unmounted, since
+       * the object may be reused for a different volume.
+       */
+      void
+      purge (file_system& fs)
+      {
+        // ----- Enter critical section ---------------------------------------
+        rtos::scheduler::critical_section scs;
+
+        for (std::size_t i = 0; i < entries_size; ++i)
+          {
+            if (entries[i].fs == &fs)
+              {
+                entries[i].fs = nullptr;
+              }
+          }
+        // ----- Exit critical section ----------------------------------------
+      }
+
+    } /* namespace path_cache */
+
+  // --------------------------------------------------------------------------
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_PATH_CACHE) */
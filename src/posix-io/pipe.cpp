@@ -0,0 +1,528 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/posix-io/pipe.h>
+
+#include <cmsis-plus/diag/trace.h>
+
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <mutex>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ------------------------------------------------------------------------
+
+    namespace
+    {
+      using deferred_pipes_list_t = utils::intrusive_list<class pipe,
+      utils::double_list_links, &pipe::deferred_links_>;
+
+      // Closed dynamic pipes, waiting for the ends to be
+      // forgotten by io::close().
+      deferred_pipes_list_t deferred_pipes;
+    } /* namespace */
+
+    /**
+     * @details
+     * The pipe and its ring buffer are allocated dynamically;
+     * both are released after the two ends are closed.
+     *
+     * The pipes closed since the previous call are destroyed
+     * first.
+     */
+    int
+    pipe (int fildes[2])
+    {
+      if (fildes == nullptr)
+        {
+          errno = EFAULT;
+          return -1;
+        }
+
+      // Destroy the pipes whose ends are no longer referred
+      // by descriptors.
+      for (;;)
+        {
+          class pipe* p = nullptr;
+            {
+              // ----- Enter critical section ---------------------------------
+              rtos::scheduler::critical_section scs;
+
+              for (auto it = deferred_pipes.begin ();
+                  it != deferred_pipes.end (); ++it)
+                {
+                  if (it->read_end ().file_descriptor () == no_file_descriptor
+                      && it->write_end ().file_descriptor ()
+                          == no_file_descriptor)
+                    {
+                      p = &(*it);
+                      p->deferred_links_.unlink ();
+                      break;
+                    }
+                }
+              // ----- Exit critical section ----------------------------------
+            }
+          if (p == nullptr)
+            {
+              break;
+            }
+          delete p;
+        }
+
+      class pipe* p = new class pipe ();
+      p->dynamic_ = true;
+
+      // On failure both ends are closed, and the pipe is
+      // destroyed later.
+      return p->open (fildes);
+    }
+
+    // ========================================================================
+
+    pipe_end_impl::pipe_end_impl (class pipe& p, bool writer) :
+        pipe_ (p), //
+        writer_ (writer)
+    {
+#if defined(OS_TRACE_POSIX_IO_PIPE)
+      OS_TRACE_PRINTF (posix_io_io, "pipe_end_impl::%s()=%p\n", __func__,
+                       this);
+#endif
+    }
+
+    pipe_end_impl::~pipe_end_impl ()
+    {
+#if defined(OS_TRACE_POSIX_IO_PIPE)
+      OS_TRACE_PRINTF (posix_io_io, "pipe_end_impl::%s() @%p\n", __func__,
+                       this);
+#endif
+    }
+
+    bool
+    pipe_end_impl::do_is_opened (void)
+    {
+      return writer_ ? pipe_.writer_open_ : pipe_.reader_open_;
+    }
+
+    ssize_t
+    pipe_end_impl::do_read (void* buf, std::size_t nbyte)
+    {
+      if (writer_)
+        {
+          errno = EBADF;
+          return -1;
+        }
+      return pipe_.internal_read_ (buf, nbyte, nonblocking ());
+    }
+
+    ssize_t
+    pipe_end_impl::do_write (const void* buf, std::size_t nbyte)
+    {
+      if (!writer_)
+        {
+          errno = EBADF;
+          return -1;
+        }
+      return pipe_.internal_write_ (buf, nbyte, nonblocking ());
+    }
+
+    io::readiness_t
+    pipe_end_impl::do_ready (void)
+    {
+      return pipe_.internal_ready_ (writer_);
+    }
+
+    off_t
+    pipe_end_impl::do_lseek (off_t offset __attribute__((unused)),
+                             int whence __attribute__((unused)))
+    {
+      errno = ESPIPE;
+      return -1;
+    }
+
+    int
+    pipe_end_impl::do_close (void)
+    {
+      pipe_.internal_close_ (writer_);
+      return 0;
+    }
+
+    // ========================================================================
+
+    pipe_end::pipe_end (pipe_end_impl& impl) :
+        io
+          { impl, type::pipe }
+    {
+#if defined(OS_TRACE_POSIX_IO_PIPE)
+      OS_TRACE_PRINTF (posix_io_io, "pipe_end::%s()=%p\n", __func__, this);
+#endif
+    }
+
+    pipe_end::~pipe_end ()
+    {
+#if defined(OS_TRACE_POSIX_IO_PIPE)
+      OS_TRACE_PRINTF (posix_io_io, "pipe_end::%s() @%p\n", __func__, this);
+#endif
+    }
+
+    // ========================================================================
+
+    /**
+     * @details
+     * The ring buffer is allocated by `open()`, and released
+     * when both ends are closed.
+     */
+    pipe::pipe (std::size_t size, rtos::memory::memory_resource* mr) :
+        mr_ (mr), //
+        size_ (size), //
+        read_impl_
+          { *this, false }, //
+        write_impl_
+          { *this, true }, //
+        read_end_
+          { read_impl_ }, //
+        write_end_
+          { write_impl_ }
+    {
+#if defined(OS_TRACE_POSIX_IO_PIPE)
+      OS_TRACE_PRINTF (posix_io_io, "pipe::%s(%u)=%p\n", __func__,
+                       static_cast<unsigned int> (size_), this);
+#endif
+    }
+
+    pipe::~pipe ()
+    {
+#if defined(OS_TRACE_POSIX_IO_PIPE)
+      OS_TRACE_PRINTF (posix_io_io, "pipe::%s() @%p\n", __func__, this);
+#endif
+
+      assert(!reader_open_ && !writer_open_);
+
+      if (buffer_ != nullptr)
+        {
+          mr_->deallocate (buffer_, size_, alignof(char));
+        }
+    }
+
+    int
+    pipe::open (int fildes[2])
+    {
+      if (fildes == nullptr)
+        {
+          errno = EFAULT;
+          return -1;
+        }
+
+      if (reader_open_ || writer_open_ || size_ == 0)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      if (buffer_ == nullptr)
+        {
+          buffer_ = static_cast<char*> (mr_->allocate (size_, alignof(char)));
+          if (buffer_ == nullptr)
+            {
+              errno = ENOMEM;
+              return -1;
+            }
+        }
+
+      head_ = 0;
+      count_ = 0;
+      reader_open_ = true;
+      writer_open_ = true;
+
+      // On failure, alloc_file_descriptor() closes the end.
+      if (read_end_.alloc_file_descriptor () == nullptr)
+        {
+          write_impl_.do_close ();
+          return -1;
+        }
+      if (write_end_.alloc_file_descriptor () == nullptr)
+        {
+          read_end_.close ();
+          errno = EMFILE;
+          return -1;
+        }
+
+      fildes[0] = read_end_.file_descriptor ();
+      fildes[1] = write_end_.file_descriptor ();
+
+      return 0;
+    }
+
+    /**
+     * @details
+     * Return the bytes available, possibly less than requested,
+     * without waiting for more. On an empty pipe, wait,
+     * offering the buffer to the writers for a direct copy;
+     * return 0 when there are no more writers.
+     */
+    ssize_t
+    pipe::internal_read_ (void* buf, std::size_t nbyte, bool nonblocking)
+    {
+      std::size_t n = 0;
+        {
+          std::lock_guard<rtos::mutex> lock
+            { mutex_ };
+
+          bool direct = false;
+          for (;;)
+            {
+              if (direct && direct_count_ > 0)
+                {
+                  n = direct_count_;
+                  break;
+                }
+              if (count_ > 0)
+                {
+                  n = internal_copy_out_ (static_cast<char*> (buf), nbyte);
+                  writable_.broadcast ();
+                  break;
+                }
+              if (!writer_open_)
+                {
+                  break;
+                }
+              if (nonblocking)
+                {
+                  errno = EAGAIN;
+                  return -1;
+                }
+
+              if (!direct && direct_buf_ == nullptr)
+                {
+                  direct_buf_ = static_cast<char*> (buf);
+                  direct_size_ = nbyte;
+                  direct_count_ = 0;
+                  direct = true;
+                }
+
+              rtos::result_t res = readable_.wait (mutex_);
+              if (res == EINTR && !(direct && direct_count_ > 0))
+                {
+                  if (direct)
+                    {
+                      direct_buf_ = nullptr;
+                    }
+                  errno = EINTR;
+                  return -1;
+                }
+            }
+
+          if (direct)
+            {
+              direct_buf_ = nullptr;
+            }
+        }
+
+      if (n > 0)
+        {
+          write_impl_.notify_readiness ();
+        }
+      return static_cast<ssize_t> (n);
+    }
+
+    /**
+     * @details
+     * Blocking writes return after all bytes are written; the
+     * non-blocking ones return the number of bytes that fit,
+     * or fail with `EAGAIN` if none.
+     *
+     * If a reader waits on an empty pipe, the bytes are copied
+     * directly to its buffer; the rest go to the ring buffer.
+     *
+     * Without readers the write fails with `EPIPE` (there are
+     * no signals).
+     */
+    ssize_t
+    pipe::internal_write_ (const void* buf, std::size_t nbyte,
+                           bool nonblocking)
+    {
+      const char* src = static_cast<const char*> (buf);
+      std::size_t total = 0;
+      int err = 0;
+        {
+          std::lock_guard<rtos::mutex> lock
+            { mutex_ };
+
+          while (total < nbyte)
+            {
+              if (!reader_open_)
+                {
+                  err = EPIPE;
+                  break;
+                }
+
+              if (direct_buf_ != nullptr && direct_count_ == 0 && count_ == 0)
+                {
+                  // Hand off to the waiting reader.
+                  std::size_t n = std::min (nbyte - total, direct_size_);
+                  std::memcpy (direct_buf_, src + total, n);
+                  direct_count_ = n;
+                  total += n;
+                  ++handoffs_;
+                  readable_.broadcast ();
+                  continue;
+                }
+
+              if (count_ < size_)
+                {
+                  total += internal_copy_in_ (src + total, nbyte - total);
+                  readable_.broadcast ();
+                  continue;
+                }
+
+              if (nonblocking)
+                {
+                  err = EAGAIN;
+                  break;
+                }
+
+              if (writable_.wait (mutex_) == EINTR)
+                {
+                  err = EINTR;
+                  break;
+                }
+            }
+        }
+
+      if (total > 0)
+        {
+          read_impl_.notify_readiness ();
+          return static_cast<ssize_t> (total);
+        }
+
+      errno = err;
+      return -1;
+    }
+
+    /**
+     * @details
+     * After the other end is closed, the remaining end is
+     * always ready, to let the reader get the end of file and
+     * the writer get `EPIPE`.
+     */
+    io::readiness_t
+    pipe::internal_ready_ (bool writer) const
+    {
+      if (writer)
+        {
+          return (count_ < size_ || !reader_open_) ?
+              io::readiness::write : io::readiness::none;
+        }
+      return (count_ > 0 || !writer_open_) ?
+          io::readiness::read : io::readiness::none;
+    }
+
+    void
+    pipe::internal_close_ (bool writer)
+    {
+      bool last;
+        {
+          std::lock_guard<rtos::mutex> lock
+            { mutex_ };
+
+          if (writer)
+            {
+              writer_open_ = false;
+            }
+          else
+            {
+              reader_open_ = false;
+            }
+          last = !reader_open_ && !writer_open_;
+
+          readable_.broadcast ();
+          writable_.broadcast ();
+        }
+
+      (writer ? read_impl_ : write_impl_).notify_readiness ();
+
+      if (!last)
+        {
+          return;
+        }
+
+      if (buffer_ != nullptr)
+        {
+          mr_->deallocate (buffer_, size_, alignof(char));
+          buffer_ = nullptr;
+        }
+
+      if (dynamic_)
+        {
+          // ----- Enter critical section -------------------------------------
+          rtos::scheduler::critical_section scs;
+
+          deferred_pipes.link (*this);
+          // ----- Exit critical section --------------------------------------
+        }
+    }
+
+    // Must be called with the mutex locked.
+    std::size_t
+    pipe::internal_copy_in_ (const char* buf, std::size_t nbyte)
+    {
+      std::size_t n = std::min (nbyte, size_ - count_);
+      std::size_t tail = (head_ + count_) % size_;
+      std::size_t first = std::min (n, size_ - tail);
+
+      std::memcpy (buffer_ + tail, buf, first);
+      std::memcpy (buffer_, buf + first, n - first);
+
+      count_ += n;
+      return n;
+    }
+
+    // Must be called with the mutex locked.
+    std::size_t
+    pipe::internal_copy_out_ (char* buf, std::size_t nbyte)
+    {
+      std::size_t n = std::min (nbyte, count_);
+      std::size_t first = std::min (n, size_ - head_);
+
+      std::memcpy (buf, buffer_ + head_, first);
+      std::memcpy (buf + first, buffer_, n - first);
+
+      head_ = (head_ + n) % size_;
+      count_ -= n;
+      return n;
+    }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
@@ -26,7 +26,12 @@
  */
 
 #include <cerrno>
+#include <cstring>
 #include <cmsis-plus/posix/sys/socket.h>
+#include <cmsis-plus/posix/sys/uio.h>
+#include <cmsis-plus/rtos/os.h>
+
+#include <fcntl.h>
 #include <cmsis-plus/posix-io/net-stack.h>
 
 #include <cmsis-plus/posix-io/socket.h>
@@ -45,14 +50,14 @@ namespace os
         net_stack_ (&ns)
     {
 #if defined(OS_TRACE_POSIX_IO_SOCKET)
-      trace::printf ("socket::%s()=@%p\n", __func__, this);
+      OS_TRACE_PRINTF (posix_io_socket, "socket::%s()=@%p\n", __func__, this);
 #endif
     }
 
     socket::~socket ()
     {
 #if defined(OS_TRACE_POSIX_IO_SOCKET)
-      trace::printf ("socket::%s() @%p\n", __func__, this);
+      OS_TRACE_PRINTF (posix_io_socket, "socket::%s() @%p\n", __func__, this);
 #endif
 
       net_stack_ = nullptr;
@@ -177,6 +182,37 @@ namespace os
       return impl ().do_sendmsg (message, flags);
     }
 
+    int
+    socket::recvmmsg (struct mmsghdr* vmessages, unsigned int vlen, int flags,
+                      struct timespec* timeout)
+    {
+      if (vmessages == nullptr)
+        {
+          errno = EFAULT;
+          return -1;
+        }
+
+      errno = 0;
+
+      // Execute the implementation specific code.
+      return impl ().do_recvmmsg (vmessages, vlen, flags, timeout);
+    }
+
+    int
+    socket::sendmmsg (struct mmsghdr* vmessages, unsigned int vlen, int flags)
+    {
+      if (vmessages == nullptr)
+        {
+          errno = EFAULT;
+          return -1;
+        }
+
+      errno = 0;
+
+      // Execute the implementation specific code.
+      return impl ().do_sendmmsg (vmessages, vlen, flags);
+    }
+
     ssize_t
     socket::sendto (const void* message, size_t length, int flags,
                     const struct sockaddr* dest_addr, socklen_t dest_len)
@@ -215,22 +251,247 @@ namespace os
       // Execute the implementation specific code.
       return impl ().do_sockatmark ();
     }
+
+    /**
+     * @details
+     * If the stack cannot take the buffers (`do_send_buffers()`
+     * fails with ENOTSUP), the chain is sent with a single
+     * `sendmsg()`, which copies the content, and is released.
+     */
+    ssize_t
+    socket::send_buffers (net_buffer* chain, int flags)
+    {
+      errno = 0;
+
+      // Execute the implementation specific code.
+      ssize_t ret = impl ().do_send_buffers (chain, flags);
+      if (ret >= 0 || errno != ENOTSUP)
+        {
+          return ret;
+        }
+
+      struct iovec iov[OS_INTEGER_POSIX_IO_SOCKET_SEND_IOV_MAX];
+      int cnt = 0;
+      for (net_buffer* b = chain; b != nullptr; b = b->next)
+        {
+          if (b->length == 0)
+            {
+              continue;
+            }
+          if (cnt == OS_INTEGER_POSIX_IO_SOCKET_SEND_IOV_MAX)
+            {
+              errno = EMSGSIZE;
+              return -1;
+            }
+          iov[cnt].iov_base = b->payload;
+          iov[cnt].iov_len = b->length;
+          ++cnt;
+        }
+
+      struct msghdr msg;
+      std::memset (&msg, 0, sizeof(msg));
+
+      ssize_t total = 0;
+      struct iovec* p = iov;
+      while (cnt > 0)
+        {
+          msg.msg_iov = p;
+          msg.msg_iovlen = cnt;
+
+          errno = 0;
+          ret = impl ().do_sendmsg (&msg, flags);
+          if (ret < 0)
+            {
+              // The chain is not released, it still belongs
+              // to the caller.
+              return -1;
+            }
+          total += ret;
+
+          // Skip what was sent, streams may take only a part.
+          std::size_t n = static_cast<std::size_t> (ret);
+          while (cnt > 0 && n >= p->iov_len)
+            {
+              n -= p->iov_len;
+              ++p;
+              --cnt;
+            }
+          if (cnt > 0)
+            {
+              p->iov_base = static_cast<char*> (p->iov_base) + n;
+              p->iov_len -= n;
+            }
+        }
+
+      net_buffers_release (chain);
+      return total;
+    }
+
+    /**
+     * @details
+     * If the stack cannot lend its buffers (`do_recv_borrow()`
+     * fails with ENOTSUP), a buffer is allocated from the stack
+     * and the content is received in it with `recv()`.
+     */
+    ssize_t
+    socket::recv_borrow (net_buffer** chain, std::size_t length, int flags)
+    {
+      if (chain == nullptr)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+      *chain = nullptr;
+
+      errno = 0;
+
+      // Execute the implementation specific code.
+      ssize_t ret = impl ().do_recv_borrow (chain, length, flags);
+      if (ret >= 0 || errno != ENOTSUP)
+        {
+          return ret;
+        }
+
+      net_buffer* b = net_stack_->allocate_buffer (length);
+      if (b == nullptr)
+        {
+          return -1;
+        }
+
+      errno = 0;
+      ret = impl ().do_recv (b->payload, length, flags);
+      if (ret <= 0)
+        {
+          net_buffers_release (b);
+          return ret;
+        }
+
+      b->length = static_cast<std::size_t> (ret);
+      *chain = b;
+      return ret;
+    }
     // ========================================================================
 
     socket_impl::socket_impl (void)
     {
 #if defined(OS_TRACE_POSIX_IO_SOCKET)
-      trace::printf ("socket_impl::%s()=%p\n", __func__, this);
+      OS_TRACE_PRINTF (posix_io_socket, "socket_impl::%s()=%p\n", __func__,
+                       this);
 #endif
     }
 
     socket_impl::~socket_impl ()
     {
 #if defined(OS_TRACE_POSIX_IO_SOCKET)
-      trace::printf ("socket_impl::%s() @%p\n", __func__, this);
+      OS_TRACE_PRINTF (posix_io_socket, "socket_impl::%s() @%p\n", __func__,
+                       this);
 #endif
     }
 
+    /**
+     * @details
+     * With `MSG_WAITFORONE`, the socket is non-blocking after the
+     * first message. The timeout is checked only after each message
+     * is received, like on Linux.
+     *
+     * If an error occurs after some messages were received, the
+     * count is returned, and the error is left to the next call.
+     */
+    int
+    socket_impl::do_recvmmsg (struct mmsghdr* vmessages, unsigned int vlen,
+                              int flags, struct timespec* timeout)
+    {
+      rtos::clock::timestamp_t deadline = 0;
+      if (timeout != nullptr)
+        {
+          if ((timeout->tv_sec < 0) || (timeout->tv_nsec < 0)
+              || (timeout->tv_nsec >= 1000000000))
+            {
+              errno = EINVAL;
+              return -1;
+            }
+          deadline = rtos::sysclock.steady_now ()
+              + rtos::clock_systick::ticks_cast (
+                  static_cast<uint64_t> (timeout->tv_sec) * 1000000u
+                      + static_cast<uint64_t> (timeout->tv_nsec) / 1000u);
+        }
+
+      int saved_flags = status_flags ();
+      int msg_flags = flags & ~MSG_WAITFORONE;
+
+      unsigned int count = 0;
+      while (count < vlen)
+        {
+          ssize_t ret = do_recvmsg (&vmessages[count].msg_hdr, msg_flags);
+          if (ret < 0)
+            {
+              break;
+            }
+          vmessages[count].msg_len = static_cast<unsigned int> (ret);
+          ++count;
+
+          if (count == 1 && (flags & MSG_WAITFORONE) != 0)
+            {
+              status_flags (saved_flags | O_NONBLOCK);
+            }
+          if (timeout != nullptr && rtos::sysclock.steady_now () >= deadline)
+            {
+              break;
+            }
+        }
+
+      status_flags (saved_flags);
+
+      if (count == 0 && vlen > 0)
+        {
+          return -1;
+        }
+      return static_cast<int> (count);
+    }
+
+    int
+    socket_impl::do_sendmmsg (struct mmsghdr* vmessages, unsigned int vlen,
+                              int flags)
+    {
+      unsigned int count = 0;
+      while (count < vlen)
+        {
+          ssize_t ret = do_sendmsg (&vmessages[count].msg_hdr, flags);
+          if (ret < 0)
+            {
+              break;
+            }
+          vmessages[count].msg_len = static_cast<unsigned int> (ret);
+          ++count;
+        }
+
+      if (count == 0 && vlen > 0)
+        {
+          return -1;
+        }
+      return static_cast<int> (count);
+    }
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+    ssize_t
+    socket_impl::do_send_buffers (net_buffer* chain, int flags)
+    {
+      errno = ENOTSUP;
+      return -1;
+    }
+
+    ssize_t
+    socket_impl::do_recv_borrow (net_buffer** chain, std::size_t length,
+                                 int flags)
+    {
+      errno = ENOTSUP;
+      return -1;
+    }
+
+#pragma GCC diagnostic pop
+
   // ==========================================================================
   } /* namespace posix */
 } /* namespace os */
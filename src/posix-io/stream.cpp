@@ -0,0 +1,632 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <cmsis-plus/posix-io/stream.h>
+
+#include <cmsis-plus/diag/trace.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    /**
+     * @details
+     * With `buffering::automatic`, terminals are line buffered and
+     * all other objects are fully buffered.
+     *
+     * If no buffer is passed, one is allocated from the default
+     * memory resource; its size is `st_blksize`, or
+     * `OS_INTEGER_POSIX_IO_STREAM_BUFFER_SIZE` if `fstat()` does
+     * not tell.
+     *
+     * If the allocation fails, the stream is not buffered.
+     */
+    stream::stream (class io& target, buffering_t mode, char* buf,
+                    std::size_t size) :
+        io_ (target), //
+        mode_ (mode)
+    {
+#if defined(OS_TRACE_POSIX_IO_STREAM)
+      OS_TRACE_PRINTF (posix_io_stream, "stream::%s(@%p, %u)=@%p\n", __func__,
+                       &target, mode, this);
+#endif
+
+      int saved_errno = errno;
+
+      if (mode_ == buffering::automatic)
+        {
+          mode_ = (io_.isatty () == 1) ? buffering::line : buffering::full;
+        }
+
+      rtos::memory::memory_resource* mr = rtos::memory::get_default_resource ();
+
+      if (mode_ != buffering::none)
+        {
+          if (buf != nullptr && size > 0)
+            {
+              buf_ = buf;
+              size_ = size;
+            }
+          else
+            {
+              if (size == 0)
+                {
+                  struct stat st;
+                  if (io_.fstat (&st) == 0 && st.st_blksize > 0)
+                    {
+                      size = static_cast<std::size_t> (st.st_blksize);
+                    }
+                  else
+                    {
+                      size = OS_INTEGER_POSIX_IO_STREAM_BUFFER_SIZE;
+                    }
+                }
+              buf_ = static_cast<char*> (mr->allocate (size));
+              if (buf_ != nullptr)
+                {
+                  size_ = size;
+                  allocated_ = true;
+                }
+            }
+        }
+
+#if OS_INTEGER_POSIX_IO_STREAM_THREAD_LINES > 0
+      if (mode_ == buffering::thread_line)
+        {
+          slots_ = static_cast<thread_line_slot*> (mr->allocate (
+              OS_INTEGER_POSIX_IO_STREAM_THREAD_LINES
+                  * sizeof(thread_line_slot),
+              alignof(thread_line_slot)));
+          if (slots_ != nullptr)
+            {
+              for (std::size_t i = 0;
+                  i < OS_INTEGER_POSIX_IO_STREAM_THREAD_LINES; ++i)
+                {
+                  slots_[i].owner = nullptr;
+                  slots_[i].count = 0;
+                }
+            }
+        }
+#endif
+
+      errno = saved_errno;
+    }
+
+    /**
+     * @details
+     * The partial lines of all threads are also written.
+     */
+    stream::~stream ()
+    {
+#if defined(OS_TRACE_POSIX_IO_STREAM)
+      OS_TRACE_PRINTF (posix_io_stream, "stream::%s() @%p\n", __func__, this);
+#endif
+
+      rtos::memory::memory_resource* mr = rtos::memory::get_default_resource ();
+
+        {
+          std::lock_guard<rtos::mutex_recursive> lock
+            { mutex_ };
+
+#if OS_INTEGER_POSIX_IO_STREAM_THREAD_LINES > 0
+          if (slots_ != nullptr)
+            {
+              for (std::size_t i = 0;
+                  i < OS_INTEGER_POSIX_IO_STREAM_THREAD_LINES; ++i)
+                {
+                  if (slots_[i].count > 0)
+                    {
+                      internal_flush_ (slots_[i].line, slots_[i].count);
+                    }
+                }
+              mr->deallocate (
+                  slots_,
+                  OS_INTEGER_POSIX_IO_STREAM_THREAD_LINES
+                      * sizeof(thread_line_slot),
+                  alignof(thread_line_slot));
+              slots_ = nullptr;
+            }
+#endif
+
+          if (count_ > 0)
+            {
+              internal_flush_ (nullptr, 0);
+            }
+        }
+
+      if (allocated_)
+        {
+          mr->deallocate (buf_, size_);
+        }
+      buf_ = nullptr;
+    }
+
+    /**
+     * @details
+     * If the bytes do not fit in the buffer, they are written
+     * together with the buffered content, with a single `writev()`.
+     */
+    ssize_t
+    stream::write (const void* buf, std::size_t nbyte)
+    {
+      if (slots_ != nullptr)
+        {
+          return internal_write_thread_line_ (static_cast<const char*> (buf),
+                                              nbyte);
+        }
+
+      std::lock_guard<rtos::mutex_recursive> lock
+        { mutex_ };
+
+      return internal_write_ (static_cast<const char*> (buf), nbyte);
+    }
+
+    int
+    stream::put (int c)
+    {
+      char ch = static_cast<char> (c);
+      if (write (&ch, 1) != 1)
+        {
+          return EOF;
+        }
+      return static_cast<unsigned char> (ch);
+    }
+
+    int
+    stream::puts (const char* s)
+    {
+      ssize_t ret = write (s, std::strlen (s));
+      if (ret < 0)
+        {
+          return EOF;
+        }
+      return static_cast<int> (ret);
+    }
+
+    int
+    stream::printf (const char* format, ...)
+    {
+      std::va_list args;
+      va_start(args, format);
+
+      int ret = vprintf (format, args);
+
+      va_end(args);
+      return ret;
+    }
+
+    /**
+     * @details
+     * The output is formatted in a local array of
+     * `OS_INTEGER_POSIX_IO_STREAM_PRINTF_TMP_ARRAY_SIZE` bytes;
+     * longer output is formatted again in a temporary buffer,
+     * allocated from the default memory resource.
+     */
+    int
+    stream::vprintf (const char* format, std::va_list args)
+    {
+      char tmp[OS_INTEGER_POSIX_IO_STREAM_PRINTF_TMP_ARRAY_SIZE];
+
+      std::va_list again;
+      va_copy(again, args);
+
+      int ret = std::vsnprintf (tmp, sizeof(tmp), format, args);
+      if (ret > 0)
+        {
+          std::size_t n = static_cast<std::size_t> (ret);
+          if (n < sizeof(tmp))
+            {
+              if (write (tmp, n) < 0)
+                {
+                  ret = -1;
+                }
+            }
+          else
+            {
+              rtos::memory::memory_resource* mr =
+                  rtos::memory::get_default_resource ();
+              char* p = static_cast<char*> (mr->allocate (n + 1));
+              if (p == nullptr)
+                {
+                  errno = ENOMEM;
+                  ret = -1;
+                }
+              else
+                {
+                  std::vsnprintf (p, n + 1, format, again);
+                  if (write (p, n) < 0)
+                    {
+                      ret = -1;
+                    }
+                  mr->deallocate (p, n + 1);
+                }
+            }
+        }
+
+      va_end(again);
+      return ret;
+    }
+
+    /**
+     * @details
+     * Buffered output is written first. Requests larger than the
+     * buffer go directly to `io::read()`.
+     */
+    ssize_t
+    stream::read (void* buf, std::size_t nbyte)
+    {
+      if (nbyte == 0)
+        {
+          return 0;
+        }
+
+      std::lock_guard<rtos::mutex_recursive> lock
+        { mutex_ };
+
+      if (count_ > 0)
+        {
+          if (internal_flush_ (nullptr, 0) != 0)
+            {
+              return -1;
+            }
+        }
+
+      ssize_t ret;
+      if (avail_ == 0 && nbyte < size_)
+        {
+          ret = io_.read (buf_, size_);
+          if (ret > 0)
+            {
+              pos_ = 0;
+              avail_ = static_cast<std::size_t> (ret);
+            }
+        }
+      else if (avail_ == 0)
+        {
+          ret = io_.read (buf, nbyte);
+        }
+      else
+        {
+          ret = 1;
+        }
+
+      if (ret > 0 && avail_ > 0)
+        {
+          std::size_t n = (nbyte < avail_) ? nbyte : avail_;
+          std::memcpy (buf, buf_ + pos_, n);
+          pos_ += n;
+          avail_ -= n;
+          ret = static_cast<ssize_t> (n);
+        }
+      else if (ret == 0)
+        {
+          eof_ = true;
+        }
+      else if (ret < 0)
+        {
+          error_ = true;
+        }
+
+      return ret;
+    }
+
+    int
+    stream::get (void)
+    {
+      unsigned char c;
+      if (read (&c, 1) != 1)
+        {
+          return EOF;
+        }
+      return c;
+    }
+
+    int
+    stream::flush (void)
+    {
+      thread_line_slot* slot = internal_thread_slot_ (false);
+
+      std::lock_guard<rtos::mutex_recursive> lock
+        { mutex_ };
+
+      int ret = 0;
+      if (slot != nullptr && slot->count > 0)
+        {
+          ret = internal_flush_ (slot->line, slot->count);
+          slot->count = 0;
+          slot->owner = nullptr;
+        }
+      else if (count_ > 0)
+        {
+          ret = internal_flush_ (nullptr, 0);
+        }
+      else if (avail_ > 0)
+        {
+          ret = internal_end_read_ ();
+        }
+
+      return ret;
+    }
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @cond ignore
+     */
+
+    ssize_t
+    stream::internal_write_ (const char* buf, std::size_t nbyte)
+    {
+      if (avail_ > 0)
+        {
+          internal_end_read_ ();
+        }
+
+      if (nbyte >= size_ - count_)
+        {
+          // Does not fit, write both the buffer and the new bytes.
+          if (internal_flush_ (buf, nbyte) != 0)
+            {
+              return -1;
+            }
+          return static_cast<ssize_t> (nbyte);
+        }
+
+      std::memcpy (buf_ + count_, buf, nbyte);
+      count_ += nbyte;
+
+      if (mode_ != buffering::full
+          && std::memchr (buf, '\n', nbyte) != nullptr)
+        {
+          if (internal_flush_ (nullptr, 0) != 0)
+            {
+              return -1;
+            }
+        }
+
+      return static_cast<ssize_t> (nbyte);
+    }
+
+    // Collect the bytes in the line of the calling thread, and lock
+    // the stream only to write complete (or full) lines.
+    ssize_t
+    stream::internal_write_thread_line_ (const char* buf, std::size_t nbyte)
+    {
+      thread_line_slot* slot = internal_thread_slot_ (true);
+      if (slot == nullptr)
+        {
+          // No free slot (or called from an interrupt), use the
+          // shared buffer instead.
+          std::lock_guard<rtos::mutex_recursive> lock
+            { mutex_ };
+
+          return internal_write_ (buf, nbyte);
+        }
+
+      std::size_t done = 0;
+      while (done < nbyte)
+        {
+          std::size_t n = nbyte - done;
+          if (n > sizeof(slot->line) - slot->count)
+            {
+              n = sizeof(slot->line) - slot->count;
+            }
+
+          const char* nl = static_cast<const char*> (std::memchr (buf + done,
+                                                                  '\n', n));
+          if (nl != nullptr)
+            {
+              n = static_cast<std::size_t> (nl - (buf + done)) + 1;
+            }
+
+          std::memcpy (slot->line + slot->count, buf + done, n);
+          slot->count += n;
+          done += n;
+
+          if (nl != nullptr || slot->count == sizeof(slot->line))
+            {
+              int ret;
+                {
+                  std::lock_guard<rtos::mutex_recursive> lock
+                    { mutex_ };
+
+                  ret = internal_flush_ (slot->line, slot->count);
+                }
+              slot->count = 0;
+              if (ret != 0)
+                {
+                  slot->owner = nullptr;
+                  return -1;
+                }
+            }
+        }
+
+      if (slot->count == 0)
+        {
+          // Only the owner changes a claimed slot.
+          slot->owner = nullptr;
+        }
+
+      return static_cast<ssize_t> (nbyte);
+    }
+
+    // Write the buffered bytes followed by the given ones.
+    int
+    stream::internal_flush_ (const char* buf, std::size_t nbyte)
+    {
+      if (avail_ > 0)
+        {
+          internal_end_read_ ();
+        }
+
+      struct iovec iov[2];
+      iov[0].iov_base = buf_;
+      iov[0].iov_len = count_;
+      iov[1].iov_base = const_cast<char*> (buf);
+      iov[1].iov_len = nbyte;
+
+      count_ = 0;
+
+      struct iovec* p = iov;
+      int cnt = 2;
+      while (cnt > 0)
+        {
+          if (p->iov_len == 0)
+            {
+              ++p;
+              --cnt;
+              continue;
+            }
+
+          ssize_t ret = io_.writev (p, cnt);
+          if (ret < 0 && errno == EINTR)
+            {
+              continue;
+            }
+          if (ret <= 0)
+            {
+              if (ret == 0)
+                {
+                  errno = EIO;
+                }
+              error_ = true;
+              return EOF;
+            }
+
+          std::size_t n = static_cast<std::size_t> (ret);
+          while (cnt > 0 && n >= p->iov_len)
+            {
+              n -= p->iov_len;
+              ++p;
+              --cnt;
+            }
+          if (cnt > 0)
+            {
+              p->iov_base = static_cast<char*> (p->iov_base) + n;
+              p->iov_len -= n;
+            }
+        }
+
+      return 0;
+    }
+
+    // Drop the bytes read ahead; for seekable objects, move
+    // back the position to the first unconsumed byte.
+    int
+    stream::internal_end_read_ (void)
+    {
+      off_t back = static_cast<off_t> (avail_);
+      pos_ = 0;
+      avail_ = 0;
+
+      int saved_errno = errno;
+      if (io_.lseek (-back, SEEK_CUR) < 0 && errno != ESPIPE
+          && errno != ENOSYS)
+        {
+          error_ = true;
+          return EOF;
+        }
+      errno = saved_errno;
+
+      return 0;
+    }
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+    // Find the slot of the calling thread; if not found and claim is
+    // true, take a free one.
+    stream::thread_line_slot*
+    stream::internal_thread_slot_ (bool claim)
+    {
+#if OS_INTEGER_POSIX_IO_STREAM_THREAD_LINES > 0
+      if (slots_ == nullptr || rtos::interrupts::in_handler_mode ())
+        {
+          return nullptr;
+        }
+
+      rtos::thread* self = &rtos::this_thread::thread ();
+      thread_line_slot* free_slot = nullptr;
+
+        {
+          // ----- Enter critical section -------------------------------------
+          rtos::scheduler::critical_section scs;
+
+          for (std::size_t i = 0; i < OS_INTEGER_POSIX_IO_STREAM_THREAD_LINES;
+              ++i)
+            {
+              if (slots_[i].owner == self)
+                {
+                  return &slots_[i];
+                }
+              if (free_slot == nullptr && slots_[i].owner == nullptr)
+                {
+                  free_slot = &slots_[i];
+                }
+            }
+
+          if (!claim)
+            {
+              return nullptr;
+            }
+          if (free_slot != nullptr)
+            {
+              free_slot->owner = self;
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+
+      return free_slot;
+#else
+      return nullptr;
+#endif
+    }
+
+#pragma GCC diagnostic pop
+
+    /**
+     * @endcond
+     */
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
@@ -29,6 +29,17 @@
 
 #include <cmsis-plus/diag/trace.h>
 
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+
+// ----------------------------------------------------------------------------
+
+#if !defined(TCSASOFT)
+// Not defined by all libraries; without it, always configure.
+#define TCSASOFT 0
+#endif
+
 // ----------------------------------------------------------------------------
 
 namespace os
@@ -43,14 +54,16 @@ namespace os
     {
       type_ |= type::tty;
 #if defined(OS_TRACE_POSIX_IO_TTY)
-      trace::printf ("tty::%s(\"%s\")=@%p\n", __func__, name_, this);
+      OS_TRACE_PRINTF (posix_io_tty, "tty::%s(\"%s\")=@%p\n", __func__, name_,
+                       this);
 #endif
     }
 
     tty::~tty () noexcept
     {
 #if defined(OS_TRACE_POSIX_IO_TTY)
-      trace::printf ("tty::%s() @%p %s\n", __func__, this, name_);
+      OS_TRACE_PRINTF (posix_io_tty, "tty::%s() @%p %s\n", __func__, this,
+                       name_);
 #endif
     }
 
@@ -91,14 +104,14 @@ namespace os
     tty_impl::tty_impl (void)
     {
 #if defined(OS_TRACE_POSIX_IO_TTY)
-      trace::printf ("tty_impl::%s()=@%p\n", __func__, this);
+      OS_TRACE_PRINTF (posix_io_tty, "tty_impl::%s()=@%p\n", __func__, this);
 #endif
     }
 
     tty_impl::~tty_impl ()
     {
 #if defined(OS_TRACE_POSIX_IO_TTY)
-      trace::printf ("tty_impl::%s() @%p\n", __func__, this);
+      OS_TRACE_PRINTF (posix_io_tty, "tty_impl::%s() @%p\n", __func__, this);
 #endif
     }
 
@@ -108,6 +121,580 @@ namespace os
       return 1; // Yes!
     }
 
+    // ========================================================================
+
+    /**
+     * @details
+     * The attributes start as a canonical terminal with echo,
+     * 8 data bits and `CR` mapped to `NL`.
+     *
+     * The buffer keeps the partial line being edited and the
+     * complete lines not yet read; one line longer than the
+     * buffer is cut.
+     */
+    tty_line_discipline_impl::tty_line_discipline_impl (char* buf,
+                                                        std::size_t size) :
+        buf_ (buf), //
+        size_ (size)
+    {
+#if defined(OS_TRACE_POSIX_IO_TTY)
+      OS_TRACE_PRINTF (posix_io_tty,
+                       "tty_line_discipline_impl::%s(%p,%u)=@%p\n", __func__,
+                       buf, size, this);
+#endif
+
+      assert (buf != nullptr);
+      assert (size > 1);
+
+      std::memset (&termios_, 0, sizeof(termios_));
+      termios_.c_iflag = ICRNL;
+      termios_.c_cflag = CS8 | CREAD | CLOCAL;
+      termios_.c_lflag = ICANON | ECHO | ECHOE | ECHOK;
+
+      std::memset (termios_.c_cc, _POSIX_VDISABLE, sizeof(termios_.c_cc));
+      termios_.c_cc[VEOF] = 0x04; // ^D
+      termios_.c_cc[VERASE] = 0x7F; // DEL
+#if defined(VERASE2)
+      termios_.c_cc[VERASE2] = 0x08; // ^H
+#endif
+      termios_.c_cc[VKILL] = 0x15; // ^U
+      termios_.c_cc[VMIN] = 1;
+      termios_.c_cc[VTIME] = 0;
+#if defined(VTIME_MS)
+      termios_.c_cc[VTIME_MS] = 0;
+#endif
+
+      termios_.c_ispeed = termios_.c_ospeed = B115200;
+    }
+
+    tty_line_discipline_impl::~tty_line_discipline_impl ()
+    {
+#if defined(OS_TRACE_POSIX_IO_TTY)
+      OS_TRACE_PRINTF (posix_io_tty, "tty_line_discipline_impl::%s() @%p\n",
+                       __func__, this);
+#endif
+    }
+
+    // ------------------------------------------------------------------------
+
+    inline bool
+    tty_line_discipline_impl::is_char_ (char c, int index) const
+    {
+      cc_t cc = termios_.c_cc[index];
+      return (cc != _POSIX_VDISABLE) && (static_cast<cc_t> (c) == cc);
+    }
+
+    bool
+    tty_line_discipline_impl::is_delimiter_ (char c) const
+    {
+      return (c == '\n') || is_char_ (c, VEOL)
+#if defined(VEOL2)
+          || is_char_ (c, VEOL2)
+#endif
+      ;
+    }
+
+    /**
+     * @details
+     * Apply the input modes (`ISTRIP`, `IGNCR`, `ICRNL`, `INLCR`);
+     * then, in canonical mode, process the erase (`VERASE`), kill
+     * (`VKILL`) and end of file (`VEOF`) characters, and release
+     * the line at `NL`, `VEOL` or `VEOF`. The characters are echoed
+     * as required by `ECHO`, `ECHOE`, `ECHOK`, `ECHOKE` and `ECHONL`.
+     *
+     * The waiting reader is woken only when a line is complete,
+     * or, when not canonical, when `VMIN` characters are
+     * available or an inter-character timer is running.
+     *
+     * Signals (`ISIG`) are not generated, the characters are
+     * kept as any other.
+     *
+     * @note Can be invoked from Interrupt Service Routines, if
+     * `do_echo()` does not block.
+     */
+    std::size_t
+    tty_line_discipline_impl::input (const char* buf, std::size_t nbyte)
+    {
+      assert (buf != nullptr);
+
+      std::size_t kept = 0;
+      bool wake = false;
+
+      for (std::size_t i = 0; i < nbyte; ++i)
+        {
+          char c = buf[i];
+          tcflag_t iflag = termios_.c_iflag;
+          tcflag_t lflag = termios_.c_lflag;
+
+          if ((iflag & ISTRIP) != 0)
+            {
+              c = static_cast<char> (c & 0x7F);
+            }
+          if (c == '\r')
+            {
+              if ((iflag & IGNCR) != 0)
+                {
+                  ++kept;
+                  continue;
+                }
+              if ((iflag & ICRNL) != 0)
+                {
+                  c = '\n';
+                }
+            }
+          else if ((c == '\n') && ((iflag & INLCR) != 0))
+            {
+              c = '\r';
+            }
+
+          const char* echo = nullptr;
+          std::size_t echo_count = 0;
+          std::size_t erased = 0;
+          bool stored = true;
+
+            {
+              // ----- Enter critical section ---------------------------------
+              rtos::interrupts::critical_section ics;
+
+              if ((lflag & ICANON) == 0)
+                {
+                  if (count_ < size_)
+                    {
+                      buf_[count_++] = c;
+                      ready_ = count_;
+                    }
+                  else
+                    {
+                      stored = false;
+                    }
+                }
+              else if (is_char_ (c, VERASE)
+#if defined(VERASE2)
+                  || is_char_ (c, VERASE2)
+#endif
+                  )
+                {
+                  if (count_ > ready_)
+                    {
+                      --count_;
+                      erased = 1;
+                    }
+                }
+              else if (is_char_ (c, VKILL))
+                {
+                  erased = count_ - ready_;
+                  count_ = ready_;
+                }
+              else if (is_char_ (c, VEOF))
+                {
+                  if (count_ == ready_)
+                    {
+                      eof_ = true;
+                    }
+                  // Release the partial line, without the character.
+                  ready_ = count_;
+                  wake = true;
+                }
+              else if (is_delimiter_ (c) ? (count_ < size_) :
+                       (count_ + 1 < size_))
+                {
+                  // Keep the last place for the delimiter.
+                  buf_[count_++] = c;
+                  if (is_delimiter_ (c))
+                    {
+                      ready_ = count_;
+                      wake = true;
+                    }
+                }
+              else
+                {
+                  stored = false;
+                }
+              // ----- Exit critical section ----------------------------------
+            }
+
+          if (!stored)
+            {
+              continue;
+            }
+          ++kept;
+
+          if ((lflag & ICANON) != 0 && is_char_ (c, VKILL))
+            {
+              if ((lflag & (ECHO | ECHOKE)) == (ECHO | ECHOKE))
+                {
+                  for (; erased > 0; --erased)
+                    {
+                      do_echo ("\b \b", 3);
+                    }
+                }
+              else if ((lflag & (ECHO | ECHOK)) == (ECHO | ECHOK))
+                {
+                  do_echo ("\n", 1);
+                }
+              continue;
+            }
+
+          if ((lflag & ICANON) != 0
+              && (is_char_ (c, VERASE)
+#if defined(VERASE2)
+                  || is_char_ (c, VERASE2)
+#endif
+                  ))
+            {
+              if (erased > 0 && ((lflag & (ECHO | ECHOE)) == (ECHO | ECHOE)))
+                {
+                  echo = "\b \b";
+                  echo_count = 3;
+                }
+            }
+          else if ((lflag & ICANON) != 0 && is_char_ (c, VEOF))
+            {
+              // Not echoed.
+            }
+          else if ((lflag & ECHO) != 0
+              || (c == '\n'
+                  && ((lflag & (ICANON | ECHONL)) == (ICANON | ECHONL))))
+            {
+              echo = &buf[i];
+              echo_count = 1;
+              if (c != buf[i])
+                {
+                  // Mapped by the input modes, echo the new one.
+                  echo = (c == '\n') ? "\n" : "\r";
+                }
+            }
+
+          if (echo_count > 0)
+            {
+              do_echo (echo, echo_count);
+            }
+        }
+
+      if ((termios_.c_lflag & ICANON) == 0 && kept > 0)
+        {
+          cc_t vmin = termios_.c_cc[VMIN];
+          if ((ready_ >= vmin) || (internal_vtime_ () != 0))
+            {
+              wake = true;
+            }
+        }
+
+      if (wake)
+        {
+          input_sem_.post ();
+          notify_readiness ();
+        }
+
+      return kept;
+    }
+
+    void
+    tty_line_discipline_impl::flush_input (void)
+    {
+        {
+          // ----- Enter critical section -------------------------------------
+          rtos::interrupts::critical_section ics;
+
+          count_ = ready_ = 0;
+          eof_ = false;
+          // ----- Exit critical section --------------------------------------
+        }
+    }
+
+    // Must be called in a critical section.
+    std::size_t
+    tty_line_discipline_impl::internal_consume_ (char* buf, std::size_t nbyte,
+                                                 bool line)
+    {
+      std::size_t n = ready_;
+      if (line)
+        {
+          // One line at a time.
+          for (std::size_t i = 0; i < ready_; ++i)
+            {
+              if (is_delimiter_ (buf_[i]))
+                {
+                  n = i + 1;
+                  break;
+                }
+            }
+        }
+      if (n > nbyte)
+        {
+          n = nbyte;
+        }
+      if (n == 0)
+        {
+          return 0;
+        }
+
+      std::memcpy (buf, buf_, n);
+      std::memmove (buf_, buf_ + n, count_ - n);
+      count_ -= n;
+      ready_ -= n;
+
+      return n;
+    }
+
+    rtos::clock::duration_t
+    tty_line_discipline_impl::internal_vtime_ (void) const
+    {
+      uint32_t ms = 0;
+#if defined(VTIME_MS)
+      // VTIME_MS, when set, is more precise than VTIME (1/10 s).
+      ms = termios_.c_cc[VTIME_MS];
+#endif
+      if (ms == 0)
+        {
+          ms = static_cast<uint32_t> (termios_.c_cc[VTIME]) * 100u;
+        }
+      return rtos::clock_systick::ticks_cast (ms * 1000u);
+    }
+
+    /**
+     * @details
+     * In canonical mode return at most one line, waiting until
+     * one is complete; an end of file on an empty line returns 0.
+     *
+     * Otherwise, as defined by POSIX for `VMIN` and `VTIME`
+     * (or `VTIME_MS`):
+     * - both 0: return what is available, possibly nothing;
+     * - only `VMIN`: wait for `VMIN` characters;
+     * - only `VTIME`: wait for one character, up to `VTIME`;
+     * - both: after the first character, wait for `VMIN`, but
+     *   return earlier if the line is idle for `VTIME`.
+     */
+    ssize_t
+    tty_line_discipline_impl::do_read (void* buf, std::size_t nbyte)
+    {
+      char* p = static_cast<char*> (buf);
+
+      if ((termios_.c_lflag & ICANON) != 0)
+        {
+          for (;;)
+            {
+                {
+                  // ----- Enter critical section -----------------------------
+                  rtos::interrupts::critical_section ics;
+
+                  std::size_t n = internal_consume_ (p, nbyte, true);
+                  if (n > 0)
+                    {
+                      return static_cast<ssize_t> (n);
+                    }
+                  if (eof_)
+                    {
+                      eof_ = false;
+                      return 0;
+                    }
+                  // ----- Exit critical section ------------------------------
+                }
+
+              if (nonblocking ())
+                {
+                  errno = EAGAIN;
+                  return -1;
+                }
+              if (input_sem_.wait () == EINTR)
+                {
+                  errno = EINTR;
+                  return -1;
+                }
+            }
+        }
+
+      std::size_t vmin = termios_.c_cc[VMIN];
+      if (vmin > nbyte)
+        {
+          vmin = nbyte;
+        }
+      rtos::clock::duration_t vtime = internal_vtime_ ();
+
+      std::size_t total = 0;
+      for (;;)
+        {
+            {
+              // ----- Enter critical section ---------------------------------
+              rtos::interrupts::critical_section ics;
+
+              total += internal_consume_ (p + total, nbyte - total, false);
+              // ----- Exit critical section ----------------------------------
+            }
+
+          if (total >= nbyte || (total > 0 && total >= vmin))
+            {
+              break;
+            }
+          if (vmin == 0 && vtime == 0)
+            {
+              break;
+            }
+          if (nonblocking ())
+            {
+              if (total > 0)
+                {
+                  break;
+                }
+              errno = EAGAIN;
+              return -1;
+            }
+
+          rtos::result_t res;
+          if (vtime != 0 && (vmin == 0 || total > 0))
+            {
+              // Inter-character timer, restarted by each wake-up.
+              res = input_sem_.timed_wait (vtime);
+              if (res == ETIMEDOUT)
+                {
+                    {
+                      // ----- Enter critical section -------------------------
+                      rtos::interrupts::critical_section ics;
+
+                      total += internal_consume_ (p + total, nbyte - total,
+                                                  false);
+                      // ----- Exit critical section --------------------------
+                    }
+                  break;
+                }
+            }
+          else
+            {
+              res = input_sem_.wait ();
+            }
+          if (res == EINTR)
+            {
+              if (total > 0)
+                {
+                  break;
+                }
+              errno = EINTR;
+              return -1;
+            }
+        }
+
+      return static_cast<ssize_t> (total);
+    }
+
+    /**
+     * @details
+     * Readable when a line is complete (or, when not canonical,
+     * when any character was received) or at end of file.
+     */
+    io::readiness_t
+    tty_line_discipline_impl::do_ready (void)
+    {
+      io::readiness_t r = io::readiness::write;
+      if (ready_ > 0 || eof_)
+        {
+          r |= io::readiness::read;
+        }
+      return r;
+    }
+
+    int
+    tty_line_discipline_impl::do_tcgetattr (struct termios *ptio)
+    {
+      if (ptio == nullptr)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+        {
+          // ----- Enter critical section -------------------------------------
+          rtos::interrupts::critical_section ics;
+
+          *ptio = termios_;
+          // ----- Exit critical section --------------------------------------
+        }
+      return 0;
+    }
+
+    /**
+     * @details
+     * With `TCSADRAIN` and `TCSAFLUSH` wait for the output to be
+     * sent, with `TCSAFLUSH` also discard the input, then apply
+     * the new attributes to the hardware with `do_configure()`.
+     *
+     * When leaving the canonical mode, the partial line becomes
+     * readable.
+     */
+    int
+    tty_line_discipline_impl::do_tcsetattr (int options,
+                                            const struct termios *ptio)
+    {
+      if (ptio == nullptr)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      int action = options & ~TCSASOFT;
+      if (action != TCSANOW && action != TCSADRAIN && action != TCSAFLUSH)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      if (action != TCSANOW)
+        {
+          int ret = do_tcdrain ();
+          if (ret < 0)
+            {
+              return ret;
+            }
+        }
+      if (action == TCSAFLUSH)
+        {
+          flush_input ();
+        }
+
+      if ((options & TCSASOFT) == 0)
+        {
+          int ret = do_configure (ptio);
+          if (ret < 0)
+            {
+              return ret;
+            }
+        }
+
+        {
+          // ----- Enter critical section -------------------------------------
+          rtos::interrupts::critical_section ics;
+
+          termios_ = *ptio;
+          if ((termios_.c_lflag & ICANON) == 0)
+            {
+              ready_ = count_;
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+
+      // Let a waiting reader check the new conditions.
+      input_sem_.post ();
+      notify_readiness ();
+
+      return 0;
+    }
+
+    void
+    tty_line_discipline_impl::do_echo (const char* buf, std::size_t nbyte)
+    {
+      do_write (buf, nbyte);
+    }
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+    int
+    tty_line_discipline_impl::do_configure (const struct termios *ptio)
+    {
+      return 0;
+    }
+
+#pragma GCC diagnostic pop
+
   // ==========================================================================
   } /* namespace posix */
 } /* namespace os */
@@ -35,6 +35,57 @@ namespace os
   {
     namespace internal
     {
+      /**
+       * @cond ignore
+       */
+
+      namespace
+      {
+        // Check if a node whose thread priority changed is still
+        // in order with its neighbours, so it need not be moved.
+        // The neighbours between `first` and `last` are list heads;
+        // only `own` is the head of the list where the node belongs.
+        bool
+        stays_in_place (waiting_thread_node& node,
+                        const utils::static_double_list_links* own,
+                        const void* first, const void* last)
+        {
+          thread::priority_t prio = node.thread_->priority ();
+
+          const utils::static_double_list_links* prev = node.prev ();
+          if (prev != own)
+            {
+              uintptr_t addr = reinterpret_cast<uintptr_t> (prev);
+              if ((addr >= reinterpret_cast<uintptr_t> (first)
+                  && addr < reinterpret_cast<uintptr_t> (last))
+                  || static_cast<const waiting_thread_node*> (prev)->thread_->priority ()
+                      < prio)
+                {
+                  return false;
+                }
+            }
+
+          const utils::static_double_list_links* next = node.next ();
+          if (next != own)
+            {
+              uintptr_t addr = reinterpret_cast<uintptr_t> (next);
+              if ((addr >= reinterpret_cast<uintptr_t> (first)
+                  && addr < reinterpret_cast<uintptr_t> (last))
+                  || static_cast<const waiting_thread_node*> (next)->thread_->priority ()
+                      > prio)
+                {
+                  return false;
+                }
+            }
+
+          return true;
+        }
+      }
+
+      /**
+       * @endcond
+       */
+
       // ======================================================================
 
       void
@@ -47,7 +98,267 @@ namespace os
 
       // ======================================================================
 
+#if defined(OS_USE_RTOS_READY_LIST_BITMAP)
+
+      /**
+       * @class ready_threads_list
+       * @details
+       * Instead of a single list ordered by priorities, each
+       * priority level has its own FIFO list and a bit in a
+       * bitmap, set when the list is not empty.
+       *
+       * Both `link()` and `unlink_head()` are constant time,
+       * regardless of the number of ready threads, at the
+       * expense of 256 list heads and 9 words of RAM.
+       */
+
+      /**
+       * @details
+       * The node is added at the end of the list of threads
+       * with the same priority, thus threads with the same
+       * priority are scheduled in FIFO order.
+       *
+       * Must be called in a critical section.
+       */
       void
+      OS_RTOS_HOT
+      ready_threads_list::link (waiting_thread_node& node)
+      {
+        thread::priority_t prio = node.thread_->priority ();
+
+#if defined(OS_TRACE_RTOS_LISTS)
+        OS_TRACE_PRINTF (rtos_lists, "ready %s() +%u\n", __func__, prio);
+#endif
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
+        if (node.thread_->edf_relative_ != 0)
+          {
+            buckets_[prio].link_deadline (node);
+          }
+        else
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_EDF) */
+          {
+            buckets_[prio].link_tail (node);
+          }
+
+        std::size_t word = prio / bitmap_bits;
+        bitmap_[word] |= (static_cast<bitmap_t> (1) << (prio % bitmap_bits));
+        summary_ |= (static_cast<bitmap_t> (1) << word);
+
+        node.thread_->state_ = thread::state::ready;
+      }
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING)
+
+      /**
+       * @details
+       * Used for a running thread preempted before the end of its
+       * time slice, so that it resumes before the other threads
+       * of the same priority. EDF threads keep the deadline order.
+       *
+       * Must be called in a critical section.
+       */
+      void
+      OS_RTOS_HOT
+      ready_threads_list::link_head (waiting_thread_node& node)
+      {
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
+        if (node.thread_->edf_relative_ != 0)
+          {
+            link (node);
+            return;
+          }
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_EDF) */
+
+        thread::priority_t prio = node.thread_->priority ();
+
+#if defined(OS_TRACE_RTOS_LISTS)
+        OS_TRACE_PRINTF (rtos_lists, "ready %s() +%u\n", __func__, prio);
+#endif
+
+        buckets_[prio].link_head (node);
+
+        std::size_t word = prio / bitmap_bits;
+        bitmap_[word] |= (static_cast<bitmap_t> (1) << (prio % bitmap_bits));
+        summary_ |= (static_cast<bitmap_t> (1) << word);
+
+        node.thread_->state_ = thread::state::ready;
+      }
+
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING) */
+
+      /**
+       * @details
+       * Must be called in a critical section.
+       */
+      thread*
+      OS_RTOS_HOT
+      ready_threads_list::unlink_head (void)
+      {
+        assert (!empty ());
+
+        std::size_t prio;
+        for (;;)
+          {
+            prio = top_priority_ ();
+            if (!buckets_[prio].empty ())
+              {
+                break;
+              }
+
+            // The last node was unlinked directly from the list,
+            // without going through `unlink()`; fix the bitmap
+            // and retry.
+            clear_priority_ (prio);
+            assert (!empty ());
+          }
+
+        waiting_thread_node* node =
+            static_cast<waiting_thread_node*> (const_cast<utils::static_double_list_links *> (buckets_[prio].head ()));
+        thread* th = node->thread_;
+
+#if defined(OS_TRACE_RTOS_LISTS)
+        OS_TRACE_PRINTF (rtos_lists, "ready %s() %p %s\n", __func__, th,
+                         th->name ());
+#endif
+
+        node->unlink ();
+        if (buckets_[prio].empty ())
+          {
+            clear_priority_ (prio);
+          }
+
+        assert (th != nullptr);
+
+        // Unlinking is immediately followed by a context switch,
+        // so in order to guarantee that the thread is marked as
+        // running, it is saver to do it here.
+
+        th->state_ = thread::state::running;
+        return th;
+      }
+
+      /**
+       * @details
+       * The node may be linked to any list (in practice to the
+       * terminated threads list), but the bitmap is updated
+       * only if the node is the last one in one of the
+       * priority lists.
+       *
+       * The priority level is not computed from the thread
+       * priority, which might have already been changed, but
+       * from the address of the list head, which, if the node is
+       * the only one in the list, is both the next and the previous
+       * node.
+       *
+       * Must be called in a critical section.
+       */
+      void
+      OS_RTOS_HOT
+      ready_threads_list::unlink (waiting_thread_node& node)
+      {
+        utils::static_double_list_links* neighbour = node.next ();
+        if ((neighbour != nullptr) && (neighbour == node.prev ()))
+          {
+            uintptr_t addr = reinterpret_cast<uintptr_t> (neighbour);
+            uintptr_t first = reinterpret_cast<uintptr_t> (&buckets_[0]);
+            if ((addr >= first)
+                && (addr < reinterpret_cast<uintptr_t> (&buckets_[priorities])))
+              {
+                // The list head is the only member of the bucket,
+                // so its address is the bucket address.
+                clear_priority_ ((addr - first) / sizeof(bucket));
+              }
+          }
+
+        node.unlink ();
+      }
+
+      /**
+       * @details
+       * Each level has its own list, so the node is moved to the
+       * end of the list of the new priority, in constant time.
+       *
+       * Must be called in a critical section.
+       */
+      void
+      ready_threads_list::relink (waiting_thread_node& node)
+      {
+        unlink (node);
+        link (node);
+      }
+
+      /**
+       * @details
+       * Only the levels with the bit set are walked.
+       *
+       * Must be called in a critical section.
+       */
+      std::size_t
+      ready_threads_list::length (void) const
+      {
+        std::size_t count = 0;
+        for (std::size_t word = 0; word < priorities / bitmap_bits; ++word)
+          {
+            bitmap_t bits = bitmap_[word];
+            while (bits != 0)
+              {
+                std::size_t bit = static_cast<std::size_t> (__builtin_ctz (
+                    bits));
+                bits &= bits - 1;
+                count += buckets_[word * bitmap_bits + bit].length ();
+              }
+          }
+        return count;
+      }
+
+      void
+      ready_threads_list::clear_priority_ (std::size_t prio)
+      {
+        std::size_t word = prio / bitmap_bits;
+        bitmap_[word] &= ~(static_cast<bitmap_t> (1) << (prio % bitmap_bits));
+        if (bitmap_[word] == 0)
+          {
+            summary_ &= ~(static_cast<bitmap_t> (1) << word);
+          }
+      }
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
+
+      /**
+       * @details
+       * Walk back from the tail, over the threads that must run
+       * after this one; the EDF threads remain ahead of the
+       * others, ordered by deadline, and equal deadlines keep
+       * the FIFO order.
+       */
+      void
+      ready_threads_list::bucket::link_deadline (waiting_thread_node& node)
+      {
+        if (uninitialized ())
+          {
+            // If this is the first time, initialise the list to empty.
+            clear ();
+          }
+
+        utils::static_double_list_links* after =
+            const_cast<utils::static_double_list_links*> (tail ());
+        while (after != &head_
+            && node.thread_->internal_edf_precedes_ (
+                *static_cast<waiting_thread_node*> (after)->thread_))
+          {
+            after = after->prev ();
+          }
+
+        insert_after (node, after);
+      }
+
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_EDF) */
+
+#else
+
+      void
+      OS_RTOS_HOT
       ready_threads_list::link (waiting_thread_node& node)
       {
         if (head_.prev () == nullptr)
@@ -65,15 +376,16 @@ namespace os
           {
             // Insert at the end of the list.
 #if defined(OS_TRACE_RTOS_LISTS)
-            trace::printf ("ready %s() empty +%u\n", __func__, prio);
+            OS_TRACE_PRINTF (rtos_lists, "ready %s() empty +%u\n", __func__,
+                             prio);
 #endif
           }
         else if (prio <= after->thread_->priority ())
           {
             // Insert at the end of the list.
 #if defined(OS_TRACE_RTOS_LISTS)
-            trace::printf ("ready %s() back %u +%u \n", __func__,
-                           after->thread_->priority (), prio);
+            OS_TRACE_PRINTF (rtos_lists, "ready %s() back %u +%u \n", __func__,
+                             after->thread_->priority (), prio);
 #endif
           }
         else if (prio > head ()->thread_->priority ())
@@ -82,8 +394,8 @@ namespace os
             after =
                 static_cast<waiting_thread_node*> (const_cast<utils::static_double_list_links *> (&head_));
 #if defined(OS_TRACE_RTOS_LISTS)
-            trace::printf ("ready %s() front +%u %u \n", __func__, prio,
-                           head ()->thread_->priority ());
+            OS_TRACE_PRINTF (rtos_lists, "ready %s() front +%u %u \n", __func__,
+                             prio, head ()->thread_->priority ());
 #endif
           }
         else
@@ -97,9 +409,70 @@ namespace os
                     static_cast<waiting_thread_node*> (const_cast<utils::static_double_list_links *> (after->prev ()));
               }
 #if defined(OS_TRACE_RTOS_LISTS)
-            trace::printf ("ready %s() middle %u +%u \n", __func__,
-                           after->thread_->priority (), prio);
+            OS_TRACE_PRINTF (rtos_lists, "ready %s() middle %u +%u \n",
+                             __func__, after->thread_->priority (), prio);
+#endif
+          }
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
+        // Among the threads with the same priority, the EDF
+        // threads go first, ordered by deadline.
+        while (after != &head_ && after->thread_->priority () == prio
+            && node.thread_->internal_edf_precedes_ (*after->thread_))
+          {
+            after =
+                static_cast<waiting_thread_node*> (const_cast<utils::static_double_list_links *> (after->prev ()));
+          }
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_EDF) */
+
+        insert_after (node, after);
+
+        node.thread_->state_ = thread::state::ready;
+      }
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING)
+
+      /**
+       * @details
+       * Used for a running thread preempted before the end of its
+       * time slice, so that it resumes before the other threads
+       * of the same priority. EDF threads keep the deadline order.
+       *
+       * The list is traversed from the head, the preempted thread
+       * has usually a high priority.
+       *
+       * Must be called in a critical section.
+       */
+      void
+      OS_RTOS_HOT
+      ready_threads_list::link_head (waiting_thread_node& node)
+      {
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
+        if (node.thread_->edf_relative_ != 0)
+          {
+            link (node);
+            return;
+          }
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_EDF) */
+
+        if (head_.prev () == nullptr)
+          {
+            // If this is the first time, initialise the list to empty.
+            clear ();
+          }
+
+        thread::priority_t prio = node.thread_->priority ();
+
+#if defined(OS_TRACE_RTOS_LISTS)
+        OS_TRACE_PRINTF (rtos_lists, "ready %s() +%u\n", __func__, prio);
 #endif
+
+        utils::static_double_list_links* after = &head_;
+        while (after->next () != &head_
+            && static_cast<waiting_thread_node*> (after->next ())->thread_->priority ()
+                > prio)
+          {
+            after = after->next ();
           }
 
         insert_after (node, after);
@@ -107,11 +480,14 @@ namespace os
         node.thread_->state_ = thread::state::ready;
       }
 
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING) */
+
       /**
        * @details
        * Must be called in a critical section.
        */
       thread*
+      OS_RTOS_HOT
       ready_threads_list::unlink_head (void)
       {
         assert (!empty ());
@@ -119,7 +495,8 @@ namespace os
         thread* th = head ()->thread_;
 
 #if defined(OS_TRACE_RTOS_LISTS)
-        trace::printf ("ready %s() %p %s\n", __func__, th, th->name ());
+        OS_TRACE_PRINTF (rtos_lists, "ready %s() %p %s\n", __func__, th,
+                         th->name ());
 #endif
 
         const_cast<waiting_thread_node*> (head ())->unlink ();
@@ -134,6 +511,34 @@ namespace os
         return th;
       }
 
+      /**
+       * @details
+       * If the node is still in order, it is left in place,
+       * in constant time; otherwise it is linked again. EDF
+       * threads are always linked again, they are also ordered
+       * by deadline.
+       *
+       * Must be called in a critical section.
+       */
+      void
+      ready_threads_list::relink (waiting_thread_node& node)
+      {
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
+        if (node.thread_->edf_relative_ == 0)
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_EDF) */
+          {
+            if (stays_in_place (node, &head_, &head_, &head_ + 1))
+              {
+                return;
+              }
+          }
+
+        node.unlink ();
+        link (node);
+      }
+
+#endif /* defined(OS_USE_RTOS_READY_LIST_BITMAP) */
+
       // ======================================================================
 
       /**
@@ -166,6 +571,264 @@ namespace os
        * improving the response time, and is thus preferred.
        */
 
+#if defined(OS_USE_RTOS_WAITING_LIST_BUCKETS)
+
+      static_assert(waiting_threads_list::buckets == ((thread::priority::error + 1) >> thread::priority::range),
+          "adjust waiting_threads_list::buckets");
+
+      /**
+       * @details
+       * Based on priority, the node is inserted
+       * - at the end of the list,
+       * - at the beginning of the list,
+       * - in the middle of the list, which
+       * requires a partial list traversal (done from the end).
+       *
+       * To satisfy the circular double linked list requirements,
+       * an empty list still contains the head node with references
+       * to itself.
+       */
+      void
+      waiting_threads_list::bucket::link (waiting_thread_node& node)
+      {
+        thread::priority_t prio = node.thread_->priority ();
+
+        waiting_thread_node* after =
+            static_cast<waiting_thread_node*> (const_cast<utils::static_double_list_links *> (tail ()));
+        waiting_thread_node* first =
+            static_cast<waiting_thread_node*> (const_cast<utils::static_double_list_links *> (head ()));
+
+        if (empty ())
+          {
+            // Insert at the end of the list.
+#if defined(OS_TRACE_RTOS_LISTS)
+            OS_TRACE_PRINTF (rtos_lists, "wait %s() empty +%u\n", __func__,
+                             prio);
+#endif
+          }
+        else if (prio <= after->thread_->priority ())
+          {
+            // Insert at the end of the list.
+#if defined(OS_TRACE_RTOS_LISTS)
+            OS_TRACE_PRINTF (rtos_lists, "wait %s() back %u +%u \n", __func__,
+                             after->thread_->priority (), prio);
+#endif
+          }
+        else if (prio > first->thread_->priority ())
+          {
+            // Insert at the beginning of the list.
+            after =
+                static_cast<waiting_thread_node*> (const_cast<utils::static_double_list_links *> (&head_));
+#if defined(OS_TRACE_RTOS_LISTS)
+            OS_TRACE_PRINTF (rtos_lists, "wait %s() front +%u %u \n", __func__,
+                             prio, first->thread_->priority ());
+#endif
+          }
+        else
+          {
+            // Insert in the middle of the list.
+            // The loop is guaranteed to terminate, and not hit the head.
+            // The weight is relatively small, priority() is not heavy.
+            while (prio > after->thread_->priority ())
+              {
+                after =
+                    static_cast<waiting_thread_node*> (const_cast<utils::static_double_list_links *> (after->prev ()));
+              }
+#if defined(OS_TRACE_RTOS_LISTS)
+            OS_TRACE_PRINTF (rtos_lists, "wait %s() middle %u +%u \n", __func__,
+                             after->thread_->priority (), prio);
+#endif
+          }
+
+        insert_after (node, after);
+      }
+
+      /**
+       * @details
+       * With `OS_USE_RTOS_WAITING_LIST_BUCKETS`, the list is split
+       * into 16 priority ordered lists, one for each group of
+       * priorities with the same upper 4 bits, plus a bitmap
+       * with the non-empty buckets.
+       *
+       * Threads with the standard priorities (like
+       * `thread::priority::normal`) have a bucket
+       * of their own, so within a bucket they are all equal, and
+       * the new node is always added at the end, in constant time.
+       * Only intermediate priorities in the same group require
+       * a partial traversal of the bucket.
+       *
+       * Retrieving the top node requires a _count leading zeros_
+       * on the bitmap, regardless of the number of waiting threads.
+       *
+       * Link the node to the bucket selected by the upper bits
+       * of the priority, and mark the bucket as non-empty.
+       */
+      void
+      OS_RTOS_HOT
+      waiting_threads_list::link (waiting_thread_node& node)
+      {
+        std::size_t index = node.thread_->priority () >> bucket_shift;
+
+        // ----- Enter critical section ---------------------------------------
+        interrupts::critical_section ics;
+
+        buckets_[index].link (node);
+        bitmap_ |= (static_cast<bitmap_t> (1) << index);
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      /**
+       * @details
+       * Skip stale bits, left by nodes unlinked directly,
+       * without clearing them, since this function may be
+       * called outside a critical section.
+       */
+      std::size_t
+      waiting_threads_list::top_bucket_ (void) const
+      {
+        bitmap_t bitmap = bitmap_;
+        while (bitmap != 0)
+          {
+            std::size_t index = (sizeof(bitmap_t) * 8 - 1)
+                - static_cast<std::size_t> (__builtin_clz (bitmap));
+            if (!buckets_[index].empty ())
+              {
+                return index;
+              }
+            bitmap &= ~(static_cast<bitmap_t> (1) << index);
+          }
+        return buckets;
+      }
+
+      waiting_threads_list::iterator::iterator (const waiting_threads_list* list,
+                                                std::size_t index,
+                                                iterator_pointer node) :
+          list_ (list), //
+          index_ (index), //
+          node_ (node)
+      {
+        ;
+      }
+
+      /**
+       * @details
+       * When the end of a bucket is reached, continue with the
+       * first node in the next lower non-empty bucket, if any.
+       */
+      void
+      waiting_threads_list::iterator::skip_empty_ (void)
+      {
+        while (node_ == list_->buckets_[index_].sentinel ())
+          {
+            if (index_ == 0)
+              {
+                node_ = nullptr;
+                return;
+              }
+            --index_;
+            node_ =
+                static_cast<iterator_pointer> (const_cast<utils::static_double_list_links*> (list_->buckets_[index_].sentinel ())->next ());
+          }
+      }
+
+      /**
+       * @details
+       * Atomically get the top thread from the list, remove the node
+       * and wake-up the thread.
+       */
+      bool
+      OS_RTOS_HOT
+      waiting_threads_list::resume_one (void)
+      {
+        thread* th;
+          {
+            // ----- Enter critical section -----------------------------------
+            interrupts::critical_section ics;
+
+            std::size_t index;
+            for (;;)
+              {
+                // If the list is empty, silently return.
+                if (bitmap_ == 0)
+                  {
+                    return false;
+                  }
+
+                index = (sizeof(bitmap_t) * 8 - 1)
+                    - static_cast<std::size_t> (__builtin_clz (bitmap_));
+                if (!buckets_[index].empty ())
+                  {
+                    break;
+                  }
+
+                // All nodes were unlinked directly; clear the stale bit.
+                bitmap_ &= ~(static_cast<bitmap_t> (1) << index);
+              }
+
+            // The top priority is to remove the entry from the list
+            // so that subsequent wakeups to address different threads.
+            waiting_thread_node* node =
+                static_cast<waiting_thread_node*> (const_cast<utils::static_double_list_links*> (buckets_[index].head ()));
+            th = node->thread_;
+            node->unlink ();
+
+            if (buckets_[index].empty ())
+              {
+                bitmap_ &= ~(static_cast<bitmap_t> (1) << index);
+              }
+            // ----- Exit critical section ------------------------------------
+          }
+        assert (th != nullptr);
+
+        thread::state_t state = th->state ();
+        if (state != thread::state::destroyed)
+          {
+            th->resume ();
+          }
+        else
+          {
+#if defined(OS_TRACE_RTOS_LISTS)
+            OS_TRACE_PRINTF (rtos_lists, "%s() gone \n", __func__);
+#endif
+          }
+
+        return true;
+      }
+
+      void
+      waiting_threads_list::resume_all (void)
+      {
+        while (resume_one ())
+          ;
+      }
+
+      /**
+       * @details
+       * If the node is still in order in the bucket of the new
+       * priority, it is left in place, in constant time; otherwise
+       * it is linked again, possibly to another bucket.
+       */
+      void
+      waiting_threads_list::relink (waiting_thread_node& node)
+      {
+        std::size_t index = node.thread_->priority () >> bucket_shift;
+
+        // ----- Enter critical section ---------------------------------------
+        interrupts::critical_section ics;
+
+        if (stays_in_place (node, buckets_[index].sentinel (), &buckets_[0],
+                            &buckets_[buckets]))
+          {
+            return;
+          }
+
+        node.unlink ();
+        link (node);
+        // ----- Exit critical section ----------------------------------------
+      }
+
+#else
+
       /**
        * @details
        * Based on priority, the node is inserted
@@ -179,6 +842,7 @@ namespace os
        * to itself.
        */
       void
+      OS_RTOS_HOT
       waiting_threads_list::link (waiting_thread_node& node)
       {
         thread::priority_t prio = node.thread_->priority ();
@@ -190,15 +854,16 @@ namespace os
           {
             // Insert at the end of the list.
 #if defined(OS_TRACE_RTOS_LISTS)
-            trace::printf ("wait %s() empty +%u\n", __func__, prio);
+            OS_TRACE_PRINTF (rtos_lists, "wait %s() empty +%u\n", __func__,
+                             prio);
 #endif
           }
         else if (prio <= after->thread_->priority ())
           {
             // Insert at the end of the list.
 #if defined(OS_TRACE_RTOS_LISTS)
-            trace::printf ("wait %s() back %u +%u \n", __func__,
-                           after->thread_->priority (), prio);
+            OS_TRACE_PRINTF (rtos_lists, "wait %s() back %u +%u \n", __func__,
+                             after->thread_->priority (), prio);
 #endif
           }
         else if (prio > head ()->thread_->priority ())
@@ -207,8 +872,8 @@ namespace os
             after =
                 static_cast<waiting_thread_node*> (const_cast<utils::static_double_list_links *> (&head_));
 #if defined(OS_TRACE_RTOS_LISTS)
-            trace::printf ("wait %s() front +%u %u \n", __func__, prio,
-                           head ()->thread_->priority ());
+            OS_TRACE_PRINTF (rtos_lists, "wait %s() front +%u %u \n", __func__,
+                             prio, head ()->thread_->priority ());
 #endif
           }
         else
@@ -222,8 +887,8 @@ namespace os
                     static_cast<waiting_thread_node*> (const_cast<utils::static_double_list_links *> (after->prev ()));
               }
 #if defined(OS_TRACE_RTOS_LISTS)
-            trace::printf ("wait %s() middle %u +%u \n", __func__,
-                           after->thread_->priority (), prio);
+            OS_TRACE_PRINTF (rtos_lists, "wait %s() middle %u +%u \n", __func__,
+                             after->thread_->priority (), prio);
 #endif
           }
 
@@ -236,6 +901,7 @@ namespace os
        * and wake-up the thread.
        */
       bool
+      OS_RTOS_HOT
       waiting_threads_list::resume_one (void)
       {
         thread* th;
@@ -265,7 +931,7 @@ namespace os
         else
           {
 #if defined(OS_TRACE_RTOS_LISTS)
-            trace::printf ("%s() gone \n", __func__);
+            OS_TRACE_PRINTF (rtos_lists, "%s() gone \n", __func__);
 #endif
           }
 
@@ -279,20 +945,95 @@ namespace os
           ;
       }
 
+      /**
+       * @details
+       * If the node is still in order, it is left in place,
+       * in constant time; otherwise it is linked again.
+       */
+      void
+      waiting_threads_list::relink (waiting_thread_node& node)
+      {
+        // ----- Enter critical section ---------------------------------------
+        interrupts::critical_section ics;
+
+        if (stays_in_place (node, &head_, &head_, &head_ + 1))
+          {
+            return;
+          }
+
+        node.unlink ();
+        link (node);
+        // ----- Exit critical section ----------------------------------------
+      }
+
+#endif /* defined(OS_USE_RTOS_WAITING_LIST_BUCKETS) */
+
+      /**
+       * @details
+       * The list is scanned inside a critical section; the first
+       * node accepted by `check()` is removed and its thread is
+       * resumed outside the critical section, like in `resume_one()`,
+       * then the scan restarts, since the list may have changed
+       * meanwhile.
+       *
+       * The threads not accepted remain in the list, without
+       * being woken up.
+       */
+      std::size_t
+      waiting_threads_list::resume_if (bool
+                                       (*check) (waiting_thread_node& node,
+                                                 void* args),
+                                       void* args)
+      {
+        std::size_t count = 0;
+        for (;;)
+          {
+            thread* th = nullptr;
+              {
+                // ----- Enter critical section -------------------------------
+                interrupts::critical_section ics;
+
+                for (iterator it = begin (); it != end (); ++it)
+                  {
+                    waiting_thread_node* node =
+                        const_cast<waiting_thread_node*> (it.get_iterator_pointer ());
+                    if (check (*node, args))
+                      {
+                        th = node->thread_;
+                        node->unlink ();
+                        break;
+                      }
+                  }
+                // ----- Exit critical section --------------------------------
+              }
+
+            if (th == nullptr)
+              {
+                return count;
+              }
+
+            if (th->state () != thread::state::destroyed)
+              {
+                th->resume ();
+              }
+            ++count;
+          }
+      }
+
       // ======================================================================
 
       timestamp_node::timestamp_node (clock::timestamp_t ts) :
           timestamp (ts)
       {
 #if defined(OS_TRACE_RTOS_LISTS_CONSTRUCT)
-        trace::printf ("%s() %p \n", __func__, this);
+        OS_TRACE_PRINTF (rtos_lists, "%s() %p \n", __func__, this);
 #endif
       }
 
       timestamp_node::~timestamp_node ()
       {
 #if defined(OS_TRACE_RTOS_LISTS_CONSTRUCT)
-        trace::printf ("%s() %p \n", __func__, this);
+        OS_TRACE_PRINTF (rtos_lists, "%s() %p \n", __func__, this);
 #endif
       }
 
@@ -304,28 +1045,39 @@ namespace os
             { ts }, //
           thread (th)
       {
+#if defined(OS_INCLUDE_RTOS_TIMER_SLACK)
+        slack = th.timer_slack ();
+#endif /* defined(OS_INCLUDE_RTOS_TIMER_SLACK) */
 #if defined(OS_TRACE_RTOS_LISTS_CONSTRUCT)
-        trace::printf ("%s() %p \n", __func__, this);
+        OS_TRACE_PRINTF (rtos_lists, "%s() %p \n", __func__, this);
 #endif
       }
 
       timeout_thread_node::~timeout_thread_node ()
       {
 #if defined(OS_TRACE_RTOS_LISTS_CONSTRUCT)
-        trace::printf ("%s() %p \n", __func__, this);
+        OS_TRACE_PRINTF (rtos_lists, "%s() %p \n", __func__, this);
 #endif
       }
 
       // Must be called in a critical section.
       void
+      OS_RTOS_HOT
       timeout_thread_node::action (void)
       {
         rtos::thread* th = &this->thread;
         this->unlink ();
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK_LATENCY)
+        statistics::internal_record_expiry_ (timestamp);
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK_LATENCY) */
+
         thread::state_t state = th->state ();
         if (state != thread::state::destroyed)
           {
+#if defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK_LATENCY)
+            statistics::internal_record_woken_ (*th);
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK_LATENCY) */
             th->resume ();
           }
       }
@@ -340,14 +1092,14 @@ namespace os
           tmr (tm)
       {
 #if defined(OS_TRACE_RTOS_LISTS_CONSTRUCT)
-        trace::printf ("%s() %p \n", __func__, this);
+        OS_TRACE_PRINTF (rtos_lists, "%s() %p \n", __func__, this);
 #endif
       }
 
       timer_node::~timer_node ()
       {
 #if defined(OS_TRACE_RTOS_LISTS_CONSTRUCT)
-        trace::printf ("%s() %p \n", __func__, this);
+        OS_TRACE_PRINTF (rtos_lists, "%s() %p \n", __func__, this);
 #endif
       }
 
@@ -356,9 +1108,13 @@ namespace os
        * Remove the node from the list and perform the timer actions.
        */
       void
+      OS_RTOS_HOT
       timer_node::action (void)
       {
         this->unlink ();
+#if defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK_LATENCY)
+        statistics::internal_record_expiry_ (timestamp);
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK_LATENCY) */
         tmr.internal_interrupt_service_routine ();
       }
 
@@ -374,15 +1130,49 @@ namespace os
        * - at the end of the list,
        * - at the beginning of the list,
        * - in the middle of the list, which
-       * requires a partial list traversal (done from the end).
+       * requires a partial list traversal, done from the end
+       * nearer in time (usually the end, since most time stamps
+       * are in order, or the beginning, for the short timeouts
+       * mixed with long ones).
+       *
+       * The cached head time stamp is lowered if the node
+       * becomes the new head.
        *
        * To satisfy the circular double linked list requirements,
        * an empty list still contains the head node with references
        * to itself.
        */
       void
+      OS_RTOS_HOT
       clock_timestamps_list::link (timestamp_node& node)
       {
+#if defined(OS_INCLUDE_RTOS_TIMER_SLACK)
+        // Stretch the time stamp up to a multiple of the largest
+        // power of 2 that fits in the slack, so that unrelated
+        // timeouts with similar slacks meet on the same tick.
+        clock::duration_t granularity = 0;
+        if (node.slack != 0)
+          {
+            granularity = static_cast<clock::duration_t> (1u
+                << (31 - __builtin_clz (node.slack)));
+          }
+#endif /* defined(OS_INCLUDE_RTOS_TIMER_SLACK) */
+
+#if defined(OS_USE_RTOS_CLOCK_TIMER_WHEEL)
+        if (wheel_ != nullptr)
+          {
+#if defined(OS_INCLUDE_RTOS_TIMER_SLACK)
+            if (granularity > 1)
+              {
+                node.timestamp = (node.timestamp + granularity - 1)
+                    & ~static_cast<clock::timestamp_t> (granularity - 1);
+              }
+#endif /* defined(OS_INCLUDE_RTOS_TIMER_SLACK) */
+            wheel_->link (node);
+            return;
+          }
+#endif /* defined(OS_USE_RTOS_CLOCK_TIMER_WHEEL) */
+
         clock::timestamp_t timestamp = node.timestamp;
 
         timeout_thread_node* after =
@@ -392,17 +1182,17 @@ namespace os
           {
             // Insert at the end of the list.
 #if defined(OS_TRACE_RTOS_LISTS_CLOCKS)
-            trace::printf ("clock %s() empty +%u\n", __func__,
-                static_cast<uint32_t> (timestamp));
+            OS_TRACE_PRINTF (rtos_lists, "clock %s() empty +%u\n", __func__,
+                             static_cast<uint32_t> (timestamp));
 #endif
           }
         else if (timestamp >= after->timestamp)
           {
             // Insert at the end of the list.
 #if defined(OS_TRACE_RTOS_LISTS_CLOCKS)
-            trace::printf ("clock %s() back %u +%u\n", __func__,
-                static_cast<uint32_t> (after->timestamp),
-                static_cast<uint32_t> (timestamp));
+            OS_TRACE_PRINTF (rtos_lists, "clock %s() back %u +%u\n", __func__,
+                             static_cast<uint32_t> (after->timestamp),
+                             static_cast<uint32_t> (timestamp));
 #endif
           }
         else if (timestamp < head ()->timestamp)
@@ -412,9 +1202,32 @@ namespace os
             after =
                 static_cast<timeout_thread_node*> (const_cast<utils::static_double_list_links *> (&head_));
 #if defined(OS_TRACE_RTOS_LISTS_CLOCKS)
-            trace::printf ("clock %s() front +%u %u\n", __func__,
-                static_cast<uint32_t> (timestamp),
-                static_cast<uint32_t> (head ()->timestamp));
+            OS_TRACE_PRINTF (rtos_lists, "clock %s() front +%u %u\n", __func__,
+                             static_cast<uint32_t> (timestamp),
+                             static_cast<uint32_t> (head ()->timestamp));
+#endif
+          }
+        else if (timestamp - head ()->timestamp < after->timestamp - timestamp)
+          {
+            // Insert in the middle of the list, nearer to the head.
+            // The head is due before, so the loop starts after it.
+            after =
+                static_cast<timeout_thread_node*> (const_cast<timestamp_node*> (head ()));
+            for (;;)
+              {
+                utils::static_double_list_links* next = after->next ();
+                if (next == &head_
+                    || static_cast<timestamp_node*> (next)->timestamp
+                        > timestamp)
+                  {
+                    break;
+                  }
+                after = static_cast<timeout_thread_node*> (next);
+              }
+#if defined(OS_TRACE_RTOS_LISTS_CLOCKS)
+            OS_TRACE_PRINTF (rtos_lists, "clock %s() middle %u +%u\n", __func__,
+                             static_cast<uint32_t> (after->timestamp),
+                             static_cast<uint32_t> (timestamp));
 #endif
           }
         else
@@ -427,23 +1240,194 @@ namespace os
                     static_cast<timeout_thread_node*> (const_cast<utils::static_double_list_links *> (after->prev ()));
               }
 #if defined(OS_TRACE_RTOS_LISTS_CLOCKS)
-            trace::printf ("clock %s() middle %u +%u\n", __func__,
-                static_cast<uint32_t> (after->timestamp),
-                static_cast<uint32_t> (timestamp));
+            OS_TRACE_PRINTF (rtos_lists, "clock %s() middle %u +%u\n", __func__,
+                             static_cast<uint32_t> (after->timestamp),
+                             static_cast<uint32_t> (timestamp));
+#endif
+          }
+
+#if defined(OS_INCLUDE_RTOS_TIMER_SLACK)
+        if (node.slack != 0
+            && (after == &head_
+                || static_cast<timestamp_node*> (after)->timestamp
+                    != timestamp))
+          {
+            // The first node due after the time stamp, if any.
+            timestamp_node* next =
+                static_cast<timestamp_node*> (after->next ());
+
+            if (next != static_cast<timestamp_node*> (&head_)
+                && next->timestamp <= timestamp + node.slack)
+              {
+                // Share the wakeup of the existing node; insert
+                // after all nodes with the same time stamp,
+                // to keep them in order.
+                node.timestamp = next->timestamp;
+                do
+                  {
+                    after = static_cast<timeout_thread_node*> (next);
+                    next = static_cast<timestamp_node*> (after->next ());
+                  }
+                while (next != static_cast<timestamp_node*> (&head_)
+                    && next->timestamp == node.timestamp);
+              }
+            else if (granularity > 1)
+              {
+                // No later node is within the slack, so rounding up
+                // does not change the position.
+                node.timestamp = (timestamp + granularity - 1)
+                    & ~static_cast<clock::timestamp_t> (granularity - 1);
+              }
+#if defined(OS_TRACE_RTOS_LISTS_CLOCKS)
+            OS_TRACE_PRINTF (rtos_lists, "clock %s() slack %u +%u\n", __func__,
+                             static_cast<uint32_t> (node.slack),
+                             static_cast<uint32_t> (node.timestamp));
 #endif
           }
+#endif /* defined(OS_INCLUDE_RTOS_TIMER_SLACK) */
 
         insert_after (node, after);
+
+        if (node.timestamp < head_timestamp_)
+          {
+            head_timestamp_ = node.timestamp;
+          }
+
+#if defined(OS_USE_RTOS_HIGHRES_COMPARE_MATCH)
+        if (compare_match_ && head () == &node)
+          {
+            // A new earliest deadline, maybe before the next tick.
+            hrclock.internal_arm_compare ();
+          }
+#endif /* defined(OS_USE_RTOS_HIGHRES_COMPARE_MATCH) */
+      }
+
+      /**
+       * @details
+       * Both lists are sorted, so a single pass from the head is
+       * enough to insert all nodes; each node is inserted after
+       * the existing nodes with the same time stamp, as by `link()`.
+       *
+       * Nodes that need more than a sorted insert, like the timer
+       * wheel or the slack, are passed to `link()`.
+       *
+       * Must be called from a critical section.
+       */
+      void
+      clock_timestamps_list::merge (clock_timestamps_list& batch)
+      {
+        utils::static_double_list_links* after = &head_;
+
+        while (!batch.double_list::empty ())
+          {
+            timestamp_node* node =
+                static_cast<timestamp_node*> (const_cast<utils::static_double_list_links *> (batch.double_list::head ()));
+            node->unlink ();
+
+#if defined(OS_USE_RTOS_CLOCK_TIMER_WHEEL)
+            if (wheel_ != nullptr)
+              {
+                link (*node);
+                continue;
+              }
+#endif /* defined(OS_USE_RTOS_CLOCK_TIMER_WHEEL) */
+
+#if defined(OS_INCLUDE_RTOS_TIMER_SLACK)
+            if (node->slack != 0)
+              {
+                link (*node);
+                continue;
+              }
+#endif /* defined(OS_INCLUDE_RTOS_TIMER_SLACK) */
+
+            // Skip the nodes due before or at the same time.
+            for (;;)
+              {
+                utils::static_double_list_links* next = after->next ();
+                if (next == &head_
+                    || static_cast<timestamp_node*> (next)->timestamp
+                        > node->timestamp)
+                  {
+                    break;
+                  }
+                after = next;
+              }
+
+            insert_after (*node, after);
+            after = node;
+
+            if (node->timestamp < head_timestamp_)
+              {
+                head_timestamp_ = node->timestamp;
+              }
+          }
+
+#if defined(OS_USE_RTOS_HIGHRES_COMPARE_MATCH)
+        if (compare_match_)
+          {
+            // The head may have changed.
+            hrclock.internal_arm_compare ();
+          }
+#endif /* defined(OS_USE_RTOS_HIGHRES_COMPARE_MATCH) */
       }
 
+#if defined(OS_USE_RTOS_CLOCK_RETIMING)
+
+      /**
+       * @details
+       * The time stamps already reached are not changed; for the
+       * others, the time left is multiplied by
+       * `numerator / denominator`. The function is monotonic, so
+       * the list remains sorted.
+       *
+       * The timer wheel is not used by the high resolution clock,
+       * the only clock that counts cycles.
+       *
+       * Must be called from a critical section.
+       */
+      void
+      clock_timestamps_list::rescale (clock::timestamp_t now,
+                                      uint32_t numerator,
+                                      uint32_t denominator)
+      {
+        for (utils::static_double_list_links* it = head_.next (); it != &head_;
+            it = it->next ())
+          {
+            timestamp_node* node = static_cast<timestamp_node*> (it);
+            if (node->timestamp <= now)
+              {
+                continue;
+              }
+
+            // Split the product, to avoid the overflow.
+            clock::timestamp_t left = node->timestamp - now;
+            clock::timestamp_t q = left / denominator;
+            clock::timestamp_t r = left % denominator;
+            node->timestamp = now + q * numerator
+                + (r * numerator) / denominator;
+          }
+
+        // The head may be due earlier; recomputed by the next check.
+        head_timestamp_ = 0;
+      }
+
+#endif /* defined(OS_USE_RTOS_CLOCK_RETIMING) */
+
       /**
        * @details
        * With the list ordered, check if the list head time stamp was
        * reached and run the node action.
        *
        * Repeat for all nodes that have overdue time stamps.
+       *
+       * In the common case, when nothing is due, only the cached
+       * head time stamp is compared, without accessing the list.
+       * The cache is never later than the head: it is lowered
+       * when nodes are linked, and a node removed from the head
+       * only makes the head later, so the next check refreshes it.
        */
       void
+      OS_RTOS_HOT
       clock_timestamps_list::check_timestamp (clock::timestamp_t now)
       {
         if (head_.next () == nullptr)
@@ -452,6 +1436,14 @@ namespace os
             return;
           }
 
+#if defined(OS_USE_RTOS_CLOCK_TIMER_WHEEL)
+        if (wheel_ != nullptr)
+          {
+            wheel_->check_timestamp (now);
+            return;
+          }
+#endif /* defined(OS_USE_RTOS_CLOCK_TIMER_WHEEL) */
+
         // Multiple threads can wait for the same time stamp, so
         // iterate until a node with future time stamp is identified.
         for (;;)
@@ -459,27 +1451,318 @@ namespace os
             // ----- Enter critical section -----------------------------------
             interrupts::critical_section ics;
 
+            if (now < head_timestamp_)
+              {
+                // Nothing due yet.
+                break;
+              }
             if (empty ())
               {
+                head_timestamp_ = ~static_cast<clock::timestamp_t> (0);
                 break;
               }
             clock::timestamp_t head_ts = head ()->timestamp;
             if (now >= head_ts)
               {
 #if defined(OS_TRACE_RTOS_LISTS_CLOCKS)
-                trace::printf ("%s() %u \n", __func__,
-                    static_cast<uint32_t> (sysclock.now ()));
+                OS_TRACE_PRINTF (rtos_lists, "%s() %u \n", __func__,
+                                 static_cast<uint32_t> (sysclock.now ()));
 #endif
                 const_cast<timestamp_node*> (head ())->action ();
               }
             else
+              {
+                head_timestamp_ = head_ts;
+                break;
+              }
+            // ----- Exit critical section ------------------------------------
+          }
+      }
+
+#if defined(OS_USE_RTOS_CLOCK_TIMER_WHEEL)
+
+      // ======================================================================
+
+      static_assert(clock_timestamps_wheel::levels * clock_timestamps_wheel::slot_bits
+          < sizeof(port::clock::timestamp_t) * 8,
+          "OS_INTEGER_RTOS_CLOCK_TIMER_WHEEL_SLOT_BITS too large");
+
+      void
+      clock_timestamps_wheel::slot::link_tail (timestamp_node& node)
+      {
+        insert_after (node,
+                      const_cast<utils::static_double_list_links *> (tail ()));
+      }
+
+      /**
+       * @details
+       * The nodes in a slot are not ordered, so all of them
+       * must be checked.
+       */
+      timestamp_node*
+      clock_timestamps_wheel::slot::earliest (void) const
+      {
+        timestamp_node* found = nullptr;
+        for (utils::static_double_list_links* p = head_.next (); p != &head_;
+            p = p->next ())
+          {
+            timestamp_node* n = static_cast<timestamp_node*> (p);
+            if (found == nullptr || n->timestamp < found->timestamp)
+              {
+                found = n;
+              }
+          }
+        return found;
+      }
+
+      /**
+       * @details
+       * Nodes with time stamps not in the future are kept in a
+       * separate ordered list.
+       *
+       * The node is added to the lowest level whose window
+       * (the range covered by all its slots) also includes the
+       * wheel time; the nodes beyond the highest window are
+       * added to the highest level, and are moved back when
+       * their slot is cascaded.
+       *
+       * The node is added at the end of its slot; since nodes
+       * with the same time stamp always end up in the same slot,
+       * they are processed in the order they were linked.
+       *
+       * Must be called from a critical section.
+       */
+      void
+      OS_RTOS_HOT
+      clock_timestamps_wheel::link (timestamp_node& node)
+      {
+        port::clock::timestamp_t timestamp = node.timestamp;
+
+        if (timestamp <= time_)
+          {
+            expired_.link (node);
+            return;
+          }
+
+        std::size_t level = 0;
+        for (; level < levels - 1; ++level)
+          {
+            std::size_t shift = (level + 1) * slot_bits;
+            if ((timestamp >> shift) == (time_ >> shift))
+              {
+                break;
+              }
+          }
+
+#if defined(OS_TRACE_RTOS_LISTS_CLOCKS)
+        OS_TRACE_PRINTF (rtos_lists, "wheel %s() %u +%u l%u s%u\n", __func__,
+                         static_cast<uint32_t> (time_),
+                         static_cast<uint32_t> (timestamp), level,
+                         index_ (timestamp, level));
+#endif
+
+        slots_[level][index_ (timestamp, level)].link_tail (node);
+      }
+
+      /**
+       * @details
+       * Within a level, the slots following the current one are
+       * ordered, and all time stamps in a level are earlier than
+       * those in the higher levels, except for the highest level,
+       * which may also hold nodes beyond its window.
+       */
+      volatile timestamp_node*
+      clock_timestamps_wheel::head (void) const
+      {
+        if (!expired_.empty ())
+          {
+            return expired_.head ();
+          }
+
+        for (std::size_t level = 0; level < levels; ++level)
+          {
+            bool top = (level == levels - 1);
+            timestamp_node* found = nullptr;
+
+            for (std::size_t i = top ? 0 : index_ (time_, level) + 1;
+                i < slots; ++i)
+              {
+                timestamp_node* n = slots_[level][i].earliest ();
+                if (n != nullptr
+                    && (found == nullptr || n->timestamp < found->timestamp))
+                  {
+                    found = n;
+                    if (!top)
+                      {
+                        break;
+                      }
+                  }
+              }
+
+            if (found != nullptr)
+              {
+                return found;
+              }
+          }
+
+        return nullptr;
+      }
+
+      bool
+      clock_timestamps_wheel::empty (void) const
+      {
+        if (!expired_.empty ())
+          {
+            return false;
+          }
+
+        for (std::size_t level = 0; level < levels; ++level)
+          {
+            for (std::size_t i = 0; i < slots; ++i)
+              {
+                if (!slots_[level][i].empty ())
+                  {
+                    return false;
+                  }
+              }
+          }
+
+        return true;
+      }
+
+      /**
+       * @details
+       * Advance the wheel time one tick at a time, up to the
+       * current time stamp; when a window ends, cascade the
+       * next slot of the higher levels, then run the actions
+       * of the nodes in the slot of the new time stamp.
+       *
+       * Larger jumps (for example after a low power sleep) are
+       * handled by moving all nodes to match the new time.
+       */
+      void
+      OS_RTOS_HOT
+      clock_timestamps_wheel::check_timestamp (port::clock::timestamp_t now)
+      {
+        if (now > time_ && (now - time_) > slots)
+          {
+            rebuild_ (now);
+          }
+
+        while (time_ < now)
+          {
+            // Nodes linked since the previous tick, already due.
+            expired_.check_timestamp (time_);
+
+            {
+              // ----- Enter critical section -------------------------------
+              interrupts::critical_section ics;
+
+              ++time_;
+
+              // Start with the highest level, the cascaded nodes may
+              // end up in slots of the lower levels, cascaded next.
+              for (std::size_t level = levels - 1; level > 0; --level)
+                {
+                  port::clock::timestamp_t mask =
+                      (static_cast<port::clock::timestamp_t> (1)
+                          << (level * slot_bits)) - 1;
+                  if ((time_ & mask) == 0)
+                    {
+                      cascade_ (level);
+                    }
+                }
+              // ----- Exit critical section --------------------------------
+            }
+
+            fire_ (slots_[0][index_ (time_, 0)]);
+          }
+
+        expired_.check_timestamp (time_);
+      }
+
+      void
+      OS_RTOS_HOT
+      clock_timestamps_wheel::fire_ (slot& slt)
+      {
+        for (;;)
+          {
+            // ----- Enter critical section -----------------------------------
+            interrupts::critical_section ics;
+
+            if (slt.empty ())
               {
                 break;
               }
+
+#if defined(OS_TRACE_RTOS_LISTS_CLOCKS)
+            OS_TRACE_PRINTF (rtos_lists, "wheel %s() %u \n", __func__,
+                             static_cast<uint32_t> (time_));
+#endif
+            // The action is expected to unlink the node.
+            static_cast<timestamp_node*> (const_cast<utils::static_double_list_links *> (slt.head ()))->action ();
             // ----- Exit critical section ------------------------------------
           }
       }
 
+      /**
+       * @details
+       * Must be called from a critical section, after the
+       * wheel time was advanced to the first time stamp of
+       * the new window.
+       */
+      void
+      OS_RTOS_HOT
+      clock_timestamps_wheel::cascade_ (std::size_t level)
+      {
+        slot tmp;
+        tmp.splice_all (slots_[level][index_ (time_, level)]);
+
+        while (!tmp.empty ())
+          {
+            timestamp_node* n =
+                static_cast<timestamp_node*> (const_cast<utils::static_double_list_links *> (tmp.head ()));
+            n->unlink ();
+            link (*n);
+          }
+      }
+
+      /**
+       * @details
+       * Collect the nodes of all slots, preserving the order
+       * within each slot, and link them again relative to
+       * the new wheel time; those already due are moved to the
+       * ordered list of expired nodes.
+       */
+      void
+      clock_timestamps_wheel::rebuild_ (port::clock::timestamp_t now)
+      {
+        // ----- Enter critical section ---------------------------------------
+        interrupts::critical_section ics;
+
+        slot tmp;
+        for (std::size_t level = 0; level < levels; ++level)
+          {
+            for (std::size_t i = 0; i < slots; ++i)
+              {
+                tmp.splice_all (slots_[level][i]);
+              }
+          }
+
+        time_ = now;
+
+        while (!tmp.empty ())
+          {
+            timestamp_node* n =
+                static_cast<timestamp_node*> (const_cast<utils::static_double_list_links *> (tmp.head ()));
+            n->unlink ();
+            link (*n);
+          }
+        // ----- Exit critical section ----------------------------------------
+      }
+
+#endif /* defined(OS_USE_RTOS_CLOCK_TIMER_WHEEL) */
+
       // ======================================================================
 
       void
@@ -495,8 +1778,8 @@ namespace os
             static_cast<waiting_thread_node*> (const_cast<utils::static_double_list_links *> (tail ()));
 
 #if defined(OS_TRACE_RTOS_THREAD)
-        trace::printf ("terminated %s() %p %s\n", __func__, &node.thread_,
-                       node.thread_->name ());
+        OS_TRACE_PRINTF (rtos_thread, "terminated %s() %p %s\n", __func__,
+                         &node.thread_, node.thread_->name ());
 #endif
 
         node.thread_->state_ = thread::state::terminated;
@@ -0,0 +1,138 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/rtos/internal/os-lock-free.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    namespace internal
+    {
+      // ----------------------------------------------------------------------
+
+      /**
+       * @details
+       * Each free block stores in its first word the index of the
+       * next free block plus one, or 0 for the last block.
+       */
+      void
+      lock_free_block_list::init (void* addr, std::size_t blocks,
+                                  std::size_t block_size_bytes) noexcept
+      {
+        assert(blocks < index_mask);
+        assert(block_size_bytes >= sizeof(std::size_t));
+
+        addr_ = static_cast<char*> (addr);
+        block_size_bytes_ = block_size_bytes;
+
+        char* p = addr_;
+        for (std::size_t i = 1; i < blocks; ++i)
+          {
+            // Link to the next block.
+            *reinterpret_cast<std::size_t*> (p) = i + 1;
+            p += block_size_bytes_;
+          }
+
+        if (blocks > 0)
+          {
+            // Mark end of list.
+            *reinterpret_cast<std::size_t*> (p) = 0;
+          }
+
+        // Keep the tag, a pop in progress must fail.
+        std::size_t tag = __atomic_load_n (&head_, __ATOMIC_RELAXED)
+            & ~index_mask;
+        __atomic_store_n (&head_, tag + tag_one + (blocks > 0 ? 1 : 0),
+                          __ATOMIC_RELEASE);
+      }
+
+      /**
+       * @details
+       * The link of the first block may be read after the block
+       * was removed and reused by another context, but then the
+       * tag changed and the compare and swap fails.
+       *
+       * @note Can be invoked from Interrupt Service Routines
+       *  of any priority.
+       */
+      void*
+      lock_free_block_list::pop (void) noexcept
+      {
+        std::size_t head = __atomic_load_n (&head_, __ATOMIC_ACQUIRE);
+        void* block;
+        std::size_t next;
+
+        do
+          {
+            std::size_t index = head & index_mask;
+            if (index == 0)
+              {
+                return nullptr;
+              }
+
+            block = addr_ + (index - 1) * block_size_bytes_;
+            next = *static_cast<std::size_t volatile*> (block);
+          }
+        while (!__atomic_compare_exchange_n (
+            &head_, &head, ((head & ~index_mask) + tag_one) | next, true,
+            __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE));
+
+        return block;
+      }
+
+      /**
+       * @details
+       *
+       * @note Can be invoked from Interrupt Service Routines
+       *  of any priority.
+       */
+      void
+      lock_free_block_list::push (void* block) noexcept
+      {
+        std::size_t index = static_cast<std::size_t> (static_cast<char*> (block)
+            - addr_) / block_size_bytes_ + 1;
+
+        std::size_t head = __atomic_load_n (&head_, __ATOMIC_RELAXED);
+        do
+          {
+            // Link to the current first block.
+            *static_cast<std::size_t volatile*> (block) = head & index_mask;
+          }
+        while (!__atomic_compare_exchange_n (
+            &head_, &head, ((head & ~index_mask) + tag_one) | index, true,
+            __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+      }
+
+    // ------------------------------------------------------------------------
+    } /* namespace internal */
+  } /* namespace rtos */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,436 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/rtos/os.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    // ------------------------------------------------------------------------
+
+    namespace
+    {
+      // Check if the waiting thread can leave.
+      typedef bool
+      (*ready_func_t) (const void* object, std::size_t token);
+
+      bool
+      latch_ready (const void* object,
+                   std::size_t token __attribute__((unused)))
+      {
+        return static_cast<const latch*> (object)->try_wait ();
+      }
+
+      bool
+      barrier_ready (const void* object, std::size_t token)
+      {
+        return static_cast<const barrier*> (object)->phase () != token;
+      }
+
+      /*
+       * Park the current thread on the list, until the object is
+       * ready; the releasing side resumes all threads in the list
+       * inside a scheduler critical section, so they are all made
+       * ready before the single context switch.
+       */
+      result_t
+      wait_ready (internal::waiting_threads_list& list, ready_func_t ready,
+                  const void* object, std::size_t token,
+                  clock::timestamp_t timestamp, bool timed)
+      {
+        // Don't call this from interrupt handlers.
+        os_assert_err(!interrupts::in_handler_mode (), EPERM);
+        // Don't call this from critical regions.
+        os_assert_err(!scheduler::locked (), EPERM);
+
+        thread& crt_thread = this_thread::thread ();
+
+        // Prepare a list node pointing to the current thread.
+        // Do not worry for being on stack, it is temporarily linked to the
+        // list and guaranteed to be removed before this function returns.
+        internal::waiting_thread_node node
+          { crt_thread };
+
+        internal::clock_timestamps_list& clock_list = sysclock.steady_list ();
+
+        // Prepare a timeout node pointing to the current thread.
+        internal::timeout_thread_node timeout_node
+          { timestamp, crt_thread };
+
+        for (;;)
+          {
+              {
+                // ----- Enter critical section -------------------------------
+                interrupts::critical_section ics;
+
+                if (ready (object, token))
+                  {
+                    return result::ok;
+                  }
+
+                if (timed && sysclock.steady_now () >= timestamp)
+                  {
+                    return ETIMEDOUT;
+                  }
+
+                if (timed)
+                  {
+                    scheduler::internal_link_node (list, node, clock_list,
+                                                   timeout_node);
+                  }
+                else
+                  {
+                    scheduler::internal_link_node (list, node);
+                  }
+                // state::suspended set in above link().
+                // ----- Exit critical section --------------------------------
+              }
+
+            port::scheduler::reschedule ();
+
+            // Remove the thread from the waiting list, if not already
+            // removed by the releasing side, and from the clock timeout
+            // list, if not already removed by the timer.
+            if (timed)
+              {
+                scheduler::internal_unlink_node (node, timeout_node);
+              }
+            else
+              {
+                scheduler::internal_unlink_node (node);
+              }
+
+            if (crt_thread.interrupted ())
+              {
+                return EINTR;
+              }
+          }
+
+        /* NOTREACHED */
+        return ENOTRECOVERABLE;
+      }
+
+      // Resume all waiting threads, with a single context switch.
+      void
+      release_all (internal::waiting_threads_list& list)
+      {
+        if (interrupts::in_handler_mode ())
+          {
+            // The context switch is done when the handler returns.
+            list.resume_all ();
+          }
+        else
+          {
+            // ----- Enter critical section -----------------------------------
+            scheduler::critical_section scs;
+
+            list.resume_all ();
+            // ----- Exit critical section ------------------------------------
+          }
+      }
+    } /* namespace */
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @class latch
+     * @details
+     * Usually a controlling thread waits for a number of other
+     * threads or interrupts to complete their part of the work,
+     * each one calling `count_down()`.
+     *
+     * @par Example
+     *
+     * @code{.cpp}
+     * latch ready { "ready", 3 };
+     *
+     * void*
+     * worker(void* args)
+     * {
+     *   // Initialise the part of this worker.
+     *   ready.count_down();
+     *   // ...
+     * }
+     *
+     * void
+     * controller(void)
+     * {
+     *   // Wait for all 3 workers to be ready.
+     *   ready.wait();
+     * }
+     * @endcode
+     *
+     * @par POSIX compatibility
+     *  No POSIX similar functionality identified, but inspired by
+     *  `std::latch`, from ISO/IEC 14882:2020.
+     */
+
+    /**
+     * @details
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    latch::latch (const char* name, std::ptrdiff_t expected) :
+        object_named_system
+          { name }, //
+        count_ (expected)
+    {
+      assert(expected >= 0);
+    }
+
+    /**
+     * @details
+     * There must be no threads waiting on the latch.
+     */
+    latch::~latch ()
+    {
+      assert(list_.empty ());
+    }
+
+    /**
+     * @details
+     * When the counter reaches zero, all waiting threads are
+     * released in one pass.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    result_t
+    latch::count_down (std::ptrdiff_t n)
+    {
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          if ((n < 0) || (n > count_))
+            {
+              return EINVAL;
+            }
+
+          count_ = count_ - n;
+          if ((count_ != 0) || (n == 0))
+            {
+              return result::ok;
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+
+      release_all (list_);
+      return result::ok;
+    }
+
+    /**
+     * @details
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    latch::wait (void)
+    {
+      return wait_ready (list_, latch_ready, this, 0, 0, false);
+    }
+
+    /**
+     * @details
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    latch::timed_wait (clock::duration_t timeout)
+    {
+      return wait_ready (list_, latch_ready, this, 0,
+                         sysclock.steady_now () + timeout, true);
+    }
+
+    /**
+     * @details
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    latch::arrive_and_wait (std::ptrdiff_t n)
+    {
+      result_t res = count_down (n);
+      if (res != result::ok)
+        {
+          return res;
+        }
+      return wait ();
+    }
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @class barrier
+     * @details
+     * The last thread arriving in a phase calls the completion
+     * function, then starts the next phase and resumes all the
+     * waiting threads, in a single scheduler critical section,
+     * so there is only one context switch, to the highest
+     * priority thread, instead of one for each waiting thread.
+     *
+     * A thread which leaves the group calls `arrive_and_drop()`,
+     * and the next phases expect one thread less.
+     *
+     * @par Example
+     *
+     * @code{.cpp}
+     * barrier step { "step", 4 };
+     *
+     * void*
+     * stage(void* args)
+     * {
+     *   for (;;)
+     *     {
+     *       // Process this part of the step.
+     *       step.arrive_and_wait();
+     *     }
+     * }
+     * @endcode
+     *
+     * @par POSIX compatibility
+     *  Inspired by [`pthread_barrier_t`](http://pubs.opengroup.org/onlinepubs/9699919799/basedefs/pthread.h.html)
+     *  from [`<pthread.h>`](http://pubs.opengroup.org/onlinepubs/9699919799/basedefs/pthread.h.html)
+     *  ([IEEE Std 1003.1, 2013 Edition](http://pubs.opengroup.org/onlinepubs/9699919799/nframe.html))
+     *  and by `std::barrier`, from ISO/IEC 14882:2020.
+     */
+
+    /**
+     * @details
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    barrier::barrier (const char* name, std::ptrdiff_t expected, func_t func,
+                      func_args_t args) :
+        object_named_system
+          { name }, //
+        func_ (func), //
+        func_args_ (args), //
+        expected_ (expected), //
+        pending_ (expected)
+    {
+      assert(expected > 0);
+    }
+
+    /**
+     * @details
+     * There must be no threads waiting on the barrier.
+     */
+    barrier::~barrier ()
+    {
+      assert(list_.empty ());
+    }
+
+    /**
+     * @details
+     * The arrival counts even when the wait is interrupted
+     * or times out.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    barrier::wait (arrival_token token)
+    {
+      return wait_ready (list_, barrier_ready, this, token, 0, false);
+    }
+
+    /**
+     * @details
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    barrier::timed_wait (arrival_token token, clock::duration_t timeout)
+    {
+      return wait_ready (list_, barrier_ready, this, token,
+                         sysclock.steady_now () + timeout, true);
+    }
+
+    /**
+     * @cond ignore
+     */
+
+    /*
+     * Internal function.
+     * The completion function is called by the last thread,
+     * outside any critical section, before the phase ends;
+     * the threads released in the previous phase cannot arrive
+     * again before the next phase is started.
+     */
+    barrier::arrival_token
+    barrier::internal_arrive_ (std::ptrdiff_t n, bool drop)
+    {
+      arrival_token token;
+
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          assert((n > 0) && (n <= pending_));
+
+          token = phase_;
+          if (drop)
+            {
+              expected_ = expected_ - n;
+            }
+          pending_ = pending_ - n;
+          if (pending_ != 0)
+            {
+              return token;
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+
+      if (func_ != nullptr)
+        {
+          func_ (func_args_);
+        }
+
+        {
+          // ----- Enter critical section -------------------------------------
+          scheduler::critical_section scs;
+
+            {
+              // ----- Enter critical section ---------------------------------
+              interrupts::critical_section ics;
+
+              pending_ = expected_;
+              phase_ = phase_ + 1;
+              // ----- Exit critical section ----------------------------------
+            }
+
+          list_.resume_all ();
+          // ----- Exit critical section --------------------------------------
+        }
+
+      return token;
+    }
+
+    /**
+     * @endcond
+     */
+
+  // --------------------------------------------------------------------------
+
+  } /* namespace rtos */
+} /* namespace os */
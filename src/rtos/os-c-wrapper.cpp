@@ -185,6 +185,24 @@ static_assert(sizeof(rtos::thread::attributes) == sizeof(os_thread_attr_t), "adj
 static_assert(offsetof(rtos::thread::attributes, th_stack_address) == offsetof(os_thread_attr_t, th_stack_address), "adjust os_thread_attr_t members");
 static_assert(offsetof(rtos::thread::attributes, th_stack_size_bytes) == offsetof(os_thread_attr_t, th_stack_size_bytes), "adjust os_thread_attr_t members");
 static_assert(offsetof(rtos::thread::attributes, th_priority) == offsetof(os_thread_attr_t, th_priority), "adjust os_thread_attr_t members");
+#if defined(OS_INCLUDE_RTOS_THREAD_STACK_POOL)
+static_assert(offsetof(rtos::thread::attributes, th_stack_pool) == offsetof(os_thread_attr_t, th_stack_pool), "adjust os_thread_attr_t members");
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_STACK_POOL) */
+#if defined(OS_INCLUDE_RTOS_SMP)
+static_assert(offsetof(rtos::thread::attributes, th_core) == offsetof(os_thread_attr_t, th_core), "adjust os_thread_attr_t members");
+static_assert(offsetof(rtos::thread::attributes, th_affinity) == offsetof(os_thread_attr_t, th_affinity), "adjust os_thread_attr_t members");
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
+static_assert(offsetof(rtos::thread::attributes, th_deadline) == offsetof(os_thread_attr_t, th_deadline), "adjust os_thread_attr_t members");
+static_assert(offsetof(rtos::thread::attributes, th_period) == offsetof(os_thread_attr_t, th_period), "adjust os_thread_attr_t members");
+static_assert(offsetof(rtos::thread::attributes, th_budget) == offsetof(os_thread_attr_t, th_budget), "adjust os_thread_attr_t members");
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_EDF) */
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING)
+static_assert(offsetof(rtos::thread::attributes, th_quantum) == offsetof(os_thread_attr_t, th_quantum), "adjust os_thread_attr_t members");
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING) */
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_PREEMPTION_THRESHOLD)
+static_assert(offsetof(rtos::thread::attributes, th_preemption_threshold) == offsetof(os_thread_attr_t, th_preemption_threshold), "adjust os_thread_attr_t members");
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_PREEMPTION_THRESHOLD) */
 
 static_assert(sizeof(rtos::timer) == sizeof(os_timer_t), "adjust size of os_timer_t");
 static_assert(sizeof(rtos::timer::attributes) == sizeof(os_timer_attr_t), "adjust size of os_timer_attr_t");
@@ -197,6 +215,9 @@ static_assert(offsetof(rtos::mutex::attributes, mx_protocol) == offsetof(os_mute
 static_assert(offsetof(rtos::mutex::attributes, mx_robustness) == offsetof(os_mutex_attr_t, mx_robustness), "adjust os_mutex_attr_t members");
 static_assert(offsetof(rtos::mutex::attributes, mx_type) == offsetof(os_mutex_attr_t, mx_type), "adjust os_mutex_attr_t members");
 static_assert(offsetof(rtos::mutex::attributes, mx_max_count) == offsetof(os_mutex_attr_t, mx_max_count), "adjust os_mutex_attr_t members");
+#if defined(OS_INCLUDE_RTOS_SMP)
+static_assert(offsetof(rtos::mutex::attributes, mx_spin_cycles) == offsetof(os_mutex_attr_t, mx_spin_cycles), "adjust os_mutex_attr_t members");
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
 
 static_assert(sizeof(rtos::condition_variable) == sizeof(os_condvar_t), "adjust size of os_condvar_t");
 static_assert(sizeof(rtos::condition_variable::attributes) == sizeof(os_condvar_attr_t), "adjust size of os_condvar_attr_t");
@@ -210,11 +231,13 @@ static_assert(sizeof(rtos::memory_pool) == sizeof(os_mempool_t), "adjust size of
 static_assert(sizeof(rtos::memory_pool::attributes) == sizeof(os_mempool_attr_t), "adjust size of os_mempool_attr_t");
 static_assert(offsetof(rtos::memory_pool::attributes, mp_pool_address) == offsetof(os_mempool_attr_t, mp_pool_address), "adjust os_mempool_attr_t members");
 static_assert(offsetof(rtos::memory_pool::attributes, mp_pool_size_bytes) == offsetof(os_mempool_attr_t, mp_pool_size_bytes), "adjust os_mempool_attr_t members");
+static_assert(offsetof(rtos::memory_pool::attributes, mp_lock_free) == offsetof(os_mempool_attr_t, mp_lock_free), "adjust os_mempool_attr_t members");
 
 static_assert(sizeof(rtos::message_queue) == sizeof(os_mqueue_t), "adjust size of os_mqueue_t");
 static_assert(sizeof(rtos::message_queue::attributes) == sizeof(os_mqueue_attr_t), "adjust size of os_mqueue_attr_t");
 static_assert(offsetof(rtos::message_queue::attributes, mq_queue_address) == offsetof(os_mqueue_attr_t, mq_queue_addr), "adjust os_mqueue_attr_t members");
 static_assert(offsetof(rtos::message_queue::attributes, mq_queue_size_bytes) == offsetof(os_mqueue_attr_t, mq_queue_size_bytes), "adjust os_mqueue_attr_t members");
+static_assert(offsetof(rtos::message_queue::attributes, mq_priority_levels) == offsetof(os_mqueue_attr_t, mq_priority_levels), "adjust os_mqueue_attr_t members");
 
 static_assert(sizeof(rtos::event_flags) == sizeof(os_evflags_t), "adjust size of os_evflags_t");
 static_assert(sizeof(rtos::event_flags::attributes) == sizeof(os_evflags_attr_t), "adjust size of os_evflags_attr_t");
@@ -227,6 +250,10 @@ static_assert(sizeof(class thread::context) == sizeof(os_thread_context_t), "adj
 static_assert(sizeof(class thread::statistics) == sizeof(os_thread_statistics_t), "adjust size of os_thread_statistics_t");
 #endif
 
+#if defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE)
+static_assert(sizeof(memory::allocation_cache) == sizeof(os_thread_allocation_cache_t), "adjust size of os_thread_allocation_cache_t");
+#endif
+
 static_assert(sizeof(internal::timer_node) == sizeof(os_internal_clock_timer_node_t), "adjust size of os_internal_clock_timer_node_t");
 
 #pragma GCC diagnostic pop
@@ -983,6 +1010,25 @@ os_thread_stack_get_available (os_thread_stack_t* stack)
   return (reinterpret_cast<class rtos::thread::stack&> (*stack)).available ();
 }
 
+#if defined(OS_INCLUDE_RTOS_THREAD_STACK_SCAN)
+
+/**
+ * @details
+ *
+ * @note Can be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::thread::stack::high_water_mark()
+ */
+size_t
+os_thread_stack_get_high_water_mark (os_thread_stack_t* stack)
+{
+  assert (stack != nullptr);
+  return (reinterpret_cast<class rtos::thread::stack&> (*stack)).high_water_mark ();
+}
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_STACK_SCAN) */
+
 /**
  * @details
  *
@@ -3347,6 +3393,22 @@ os_memory_deallocate (os_memory_t* memory, void* addr, size_t bytes,
       addr, bytes, alignment);
 }
 
+/**
+ * @details
+ *
+ * @note Can be invoked from Interrupt Service Routines.
+ *
+ * @par For the complete definition, see
+ *  @ref os::rtos::memory::memory_resource::deallocate_deferred()
+ */
+void
+os_memory_deallocate_deferred (os_memory_t* memory, void* addr)
+{
+  assert (memory != nullptr);
+  (reinterpret_cast<rtos::memory::memory_resource&> (*memory)).deallocate_deferred (
+      addr);
+}
+
 /**
  * @details
  *
@@ -4611,6 +4673,290 @@ osPoolFree (osPoolId pool_id, void* block)
 
 #endif /* Memory Pool Management available */
 
+// ----------------------------------------------------------------------------
+
+#if ((defined (osFeature_MessageQ)  &&  (osFeature_MessageQ != 0)) \
+  || (defined (osFeature_MailQ)  &&  (osFeature_MailQ != 0)))
+
+namespace
+{
+  /*
+   * Bounded FIFO of words, used by the legacy message queues and,
+   * to pass the block pointers, by the legacy mail queues.
+   *
+   * Compared to the generic `message_queue`, there are no
+   * priorities and no copies, a message is just a word stored
+   * in a circular buffer.
+   *
+   * The layout must match `os_message_queue_t`.
+   */
+  class word_fifo
+  {
+  public:
+
+    word_fifo (const char* name, std::size_t items, std::uintptr_t* buffer);
+
+    word_fifo (const word_fifo&) = delete;
+    word_fifo (word_fifo&&) = delete;
+    word_fifo&
+    operator= (const word_fifo&) = delete;
+    word_fifo&
+    operator= (word_fifo&&) = delete;
+
+    ~word_fifo () = default;
+
+    result_t
+    put (std::uintptr_t word, uint32_t millisec);
+
+    result_t
+    get (std::uintptr_t* word, uint32_t millisec);
+
+  protected:
+
+    using try_func_t = bool (word_fifo::*) (std::uintptr_t* word);
+
+    bool
+    internal_try_put_ (std::uintptr_t* word);
+
+    bool
+    internal_try_get_ (std::uintptr_t* word);
+
+    result_t
+    internal_wait_ (internal::waiting_threads_list& list, try_func_t func,
+                    std::uintptr_t* word, uint32_t millisec);
+
+  protected:
+
+    internal::waiting_threads_list put_list_;
+    internal::waiting_threads_list get_list_;
+    const char* name_;
+    std::uintptr_t* buffer_;
+    std::size_t items_;
+    std::size_t head_;
+    std::size_t count_;
+  };
+
+  word_fifo::word_fifo (const char* name, std::size_t items,
+                        std::uintptr_t* buffer) :
+      name_ (name), //
+      buffer_ (buffer), //
+      items_ (items), //
+      head_ (0), //
+      count_ (0)
+  {
+    assert(buffer != nullptr);
+    assert(items > 0);
+  }
+
+  /*
+   * Should be called from an interrupts critical section.
+   */
+  bool
+  word_fifo::internal_try_put_ (std::uintptr_t* word)
+  {
+    if (count_ >= items_)
+      {
+        return false;
+      }
+
+    std::size_t ix = head_ + count_;
+    if (ix >= items_)
+      {
+        ix -= items_;
+      }
+    buffer_[ix] = *word;
+    ++count_;
+
+    return true;
+  }
+
+  /*
+   * Should be called from an interrupts critical section.
+   */
+  bool
+  word_fifo::internal_try_get_ (std::uintptr_t* word)
+  {
+    if (count_ == 0)
+      {
+        return false;
+      }
+
+    *word = buffer_[head_];
+    if (++head_ >= items_)
+      {
+        head_ = 0;
+      }
+    --count_;
+
+    return true;
+  }
+
+  /*
+   * Try the operation; if it fails, and millisec is not 0,
+   * wait on the list until it succeeds, forever or up to the
+   * timeout, in sysclock ticks.
+   */
+  result_t
+  word_fifo::internal_wait_ (internal::waiting_threads_list& list,
+                             try_func_t func, std::uintptr_t* word,
+                             uint32_t millisec)
+  {
+    // Extra test before entering the loop, with its inherent weight.
+    // Trade size for speed.
+      {
+        // ----- Enter critical section ---------------------------------------
+        interrupts::critical_section ics;
+
+        if ((this->*func) (word))
+          {
+            return result::ok;
+          }
+        // ----- Exit critical section ----------------------------------------
+      }
+
+    if (millisec == 0)
+      {
+        return EWOULDBLOCK;
+      }
+
+    bool forever = (millisec == osWaitForever);
+
+    thread& crt_thread = this_thread::thread ();
+
+    // Prepare a list node pointing to the current thread.
+    // Do not worry for being on stack, it is temporarily linked to the
+    // list and guaranteed to be removed before this function returns.
+    internal::waiting_thread_node node
+      { crt_thread };
+
+    internal::clock_timestamps_list& clock_list = sysclock.steady_list ();
+    clock::timestamp_t timeout_timestamp =
+        forever ?
+            0 :
+            sysclock.steady_now ()
+                + clock_systick::ticks_cast ((uint64_t) (millisec * 1000u));
+
+    // Prepare a timeout node pointing to the current thread.
+    internal::timeout_thread_node timeout_node
+      { timeout_timestamp, crt_thread };
+
+    for (;;)
+      {
+          {
+            // ----- Enter critical section -----------------------------------
+            interrupts::critical_section ics;
+
+            if ((this->*func) (word))
+              {
+                return result::ok;
+              }
+
+            // Add this thread to the waiting list, and, if needed,
+            // to the clock timeout list.
+            if (forever)
+              {
+                scheduler::internal_link_node (list, node);
+              }
+            else
+              {
+                scheduler::internal_link_node (list, node, clock_list,
+                                               timeout_node);
+              }
+            // state::suspended set in above link().
+            // ----- Exit critical section ------------------------------------
+          }
+
+        port::scheduler::reschedule ();
+
+        // Remove the thread from the waiting list, if not already
+        // removed by the other side, and from the clock timeout list,
+        // if not already removed by the timer.
+        if (forever)
+          {
+            scheduler::internal_unlink_node (node);
+          }
+        else
+          {
+            scheduler::internal_unlink_node (node, timeout_node);
+          }
+
+        if (crt_thread.interrupted ())
+          {
+            return EINTR;
+          }
+
+        if (!forever && (sysclock.steady_now () >= timeout_timestamp))
+          {
+            return ETIMEDOUT;
+          }
+      }
+
+    /* NOTREACHED */
+    return ENOTRECOVERABLE;
+  }
+
+  result_t
+  word_fifo::put (std::uintptr_t word, uint32_t millisec)
+  {
+    result_t res = internal_wait_ (put_list_, &word_fifo::internal_try_put_,
+                                   &word, millisec);
+    if (res == result::ok)
+      {
+        // Wake-up one consumer, if any.
+        get_list_.resume_one ();
+      }
+    return res;
+  }
+
+  result_t
+  word_fifo::get (std::uintptr_t* word, uint32_t millisec)
+  {
+    result_t res = internal_wait_ (get_list_, &word_fifo::internal_try_get_,
+                                   word, millisec);
+    if (res == result::ok)
+      {
+        // Wake-up one producer, if any.
+        put_list_.resume_one ();
+      }
+    return res;
+  }
+
+  /*
+   * The layout must match `os_mail_queue_t`.
+   */
+  struct mail_queue
+  {
+    memory_pool pool;
+    word_fifo queue;
+  };
+
+  static_assert(sizeof(osMessageQ) == sizeof(word_fifo), "adjust size of osMessageQ");
+  static_assert(alignof(osMessageQ) == alignof(word_fifo), "adjust align of osMessageQ");
+
+  static_assert(sizeof(osMailQ) == sizeof(mail_queue), "adjust size of osMailQ");
+  static_assert(alignof(osMailQ) == alignof(mail_queue), "adjust align of osMailQ");
+
+  /*
+   * Get the storage for the queue words, either from the
+   * definition or dynamically allocated.
+   */
+  std::uintptr_t*
+  fifo_buffer (void* queue, std::size_t queue_sz __attribute__((unused)),
+               std::size_t items)
+  {
+    if (queue != nullptr)
+      {
+        assert(queue_sz >= items * sizeof(std::uintptr_t));
+        return static_cast<std::uintptr_t*> (queue);
+      }
+
+    // Legacy queues are never destroyed.
+    return memory::allocator<std::uintptr_t> ().allocate (items);
+  }
+}
+
+#endif /* Message or Mail Queues available */
+
 // ----------------------------------------------------------------------------
 //  ==== Message Queue Management Functions ====
 
@@ -4636,14 +4982,10 @@ osMessageCreate (const osMessageQDef_t* queue_def,
       return nullptr;
     }
 
-  message_queue::attributes attr;
-  attr.mq_queue_address = queue_def->queue;
-  attr.mq_queue_size_bytes = queue_def->queue_sz;
-
-  new ((void*) queue_def->data) message_queue (queue_def->name,
-                                               (std::size_t) queue_def->items,
-                                               (std::size_t) queue_def->item_sz,
-                                               attr);
+  new ((void*) queue_def->data) word_fifo (
+      queue_def->name, (std::size_t) queue_def->items,
+      fifo_buffer (queue_def->queue, (std::size_t) queue_def->queue_sz,
+                   (std::size_t) queue_def->items));
 
   return reinterpret_cast<osMessageQId> (queue_def->data);
 }
@@ -4677,35 +5019,15 @@ osMessagePut (osMessageQId queue_id, uint32_t info, uint32_t millisec)
       return osErrorParameter;
     }
 
-  result_t res;
-  if (millisec == osWaitForever)
+  if ((millisec != 0) && interrupts::in_handler_mode ())
     {
-      if (interrupts::in_handler_mode ())
-        {
-          return osErrorParameter;
-        }
-      res = (reinterpret_cast<message_queue&> (*queue_id)).send (
-          (const char*) &info, sizeof(uint32_t), 0);
-      // osOK, osErrorResource, osErrorParameter
-    }
-  else if (millisec == 0)
-    {
-      res = (reinterpret_cast<message_queue&> (*queue_id)).try_send (
-          (const char*) &info, sizeof(uint32_t), 0);
-      // osOK, osErrorResource, osErrorParameter
-    }
-  else
-    {
-      if (interrupts::in_handler_mode ())
-        {
-          return osErrorParameter;
-        }
-      res = (reinterpret_cast<message_queue&> (*queue_id)).timed_send (
-          (const char*) &info, sizeof(uint32_t),
-          clock_systick::ticks_cast ((uint64_t) (millisec * 1000u)), 0);
-      // osOK, osErrorTimeoutResource, osErrorParameter
+      return osErrorParameter;
     }
 
+  // osOK, osErrorResource, osErrorTimeoutResource
+  result_t res = (reinterpret_cast<word_fifo&> (*queue_id)).put (info,
+                                                                 millisec);
+
   if (res == result::ok)
     {
       // The message was put into the queue.
@@ -4767,38 +5089,16 @@ osMessageGet (osMessageQId queue_id, uint32_t millisec)
       return event;
     }
 
-  if (millisec == osWaitForever)
-    {
-      if (interrupts::in_handler_mode ())
-        {
-          event.status = osErrorParameter;
-          return event;
-        }
-      res = (reinterpret_cast<message_queue&> (*queue_id)).receive (
-          (char*) &event.value.v, sizeof(uint32_t), nullptr);
-      // result::event_message;
-    }
-  else if (millisec == 0)
+  if ((millisec != 0) && interrupts::in_handler_mode ())
     {
-      res = (reinterpret_cast<message_queue&> (*queue_id)).try_receive (
-          (char*) &event.value.v, sizeof(uint32_t), nullptr);
-      // result::event_message when message;
-      // result::ok when no meessage
-    }
-  else
-    {
-      if (interrupts::in_handler_mode ())
-        {
-          event.status = osErrorParameter;
-          return event;
-        }
-      res = (reinterpret_cast<message_queue&> (*queue_id)).timed_receive (
-          (char*) &event.value.v, sizeof(uint32_t),
-          clock_systick::ticks_cast ((uint64_t) (millisec * 1000u)), nullptr);
-      // result::event_message when message;
-      // result::event_timeout when timeout;
+      event.status = osErrorParameter;
+      return event;
     }
 
+  std::uintptr_t word = 0;
+  res = (reinterpret_cast<word_fifo&> (*queue_id)).get (&word, millisec);
+  event.value.v = (uint32_t) word;
+
   if (res == result::ok)
     {
       // Message received, value.p contains the pointer to message.
@@ -4863,12 +5163,11 @@ osMailCreate (const osMailQDef_t* mail_def,
       mail_def->name, (std::size_t) mail_def->items,
       (std::size_t) mail_def->pool_item_sz, pool_attr);
 
-  message_queue::attributes queue_attr;
-  queue_attr.mq_queue_address = mail_def->queue;
-  queue_attr.mq_queue_size_bytes = mail_def->queue_sz;
-  new ((void*) &mail_def->data->queue) message_queue (
+  // The queue has room for all pool blocks, thus putting never fails.
+  new ((void*) &mail_def->data->queue) word_fifo (
       mail_def->name, (std::size_t) mail_def->items,
-      (std::size_t) mail_def->queue_item_sz, queue_attr);
+      fifo_buffer (mail_def->queue, (std::size_t) mail_def->queue_sz,
+                   (std::size_t) mail_def->items));
 
   return (osMailQId) (mail_def->data);
 }
@@ -5002,8 +5301,8 @@ osMailPut (osMailQId mail_id, void* mail)
   result_t res;
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wstrict-aliasing"
-  res = (reinterpret_cast<message_queue&> (mail_id->queue)).try_send (
-      (const char*) &mail, sizeof(void*), 0);
+  res = (reinterpret_cast<word_fifo&> (mail_id->queue)).put (
+      (std::uintptr_t) mail, 0);
 #pragma GCC diagnostic pop
   if (res == result::ok)
     {
@@ -5049,36 +5348,17 @@ osMailGet (osMailQId mail_id, uint32_t millisec)
       return event;
     }
 
-  if (millisec == osWaitForever)
+  if ((millisec != 0) && interrupts::in_handler_mode ())
     {
-      if (interrupts::in_handler_mode ())
-        {
-          event.status = osErrorParameter;
-          return event;
-        }
-      res = (reinterpret_cast<message_queue&> ((mail_id->queue))).receive (
-          (char*) &event.value.p, sizeof(void*), nullptr);
-      // osEventMail for ok,
-    }
-  else if (millisec == 0)
-    {
-      res = (reinterpret_cast<message_queue&> (mail_id->queue)).try_receive (
-          (char*) &event.value.p, sizeof(void*), nullptr);
-      // osEventMail for ok,
-    }
-  else
-    {
-      if (interrupts::in_handler_mode ())
-        {
-          event.status = osErrorParameter;
-          return event;
-        }
-      res = (reinterpret_cast<message_queue&> (mail_id->queue)).timed_receive (
-          (char*) &event.value.p, sizeof(void*),
-          clock_systick::ticks_cast ((uint64_t) (millisec * 1000u)), nullptr);
-      // osEventMail for ok, osEventTimeout
+      event.status = osErrorParameter;
+      return event;
     }
 
+  // osEventMail for ok, osEventTimeout
+  std::uintptr_t word = 0;
+  res = (reinterpret_cast<word_fifo&> (mail_id->queue)).get (&word, millisec);
+  event.value.p = (void*) word;
+
   if (res == result::ok)
     {
       // Mail received, value.p contains the pointer to mail content.
@@ -0,0 +1,296 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <cmsis-plus/rtos/os.h>
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_INCLUDE_RTOS_CALLOUTS)
+
+using namespace os;
+using namespace os::rtos;
+
+// ----------------------------------------------------------------------------
+
+/**
+ * @cond ignore
+ */
+
+namespace
+{
+  static_assert(OS_INTEGER_RTOS_CALLOUTS_SIZE >= 1,
+      "OS_INTEGER_RTOS_CALLOUTS_SIZE must be at least 1");
+
+  constexpr std::size_t entries_size = OS_INTEGER_RTOS_CALLOUTS_SIZE;
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+  struct entry_t
+  {
+    clock::timestamp_t timestamp;
+    callout::func_t func;
+    void* args;
+    callout::id_t id;
+  };
+
+#pragma GCC diagnostic pop
+
+  // Sorted by decreasing time stamps, so the earliest callout
+  // is the last one and is removed without moving the others;
+  // entries with equal time stamps are called in order.
+  entry_t entries[entries_size];
+  std::size_t entries_count;
+
+  callout::id_t last_id;
+
+  // Must be called from a critical section.
+  void
+  arm (clock::timestamp_t now)
+  {
+    if (entries_count == 0)
+      {
+        port::callout_timer::disarm ();
+        return;
+      }
+
+    clock::timestamp_t ts = entries[entries_count - 1].timestamp;
+    clock::timestamp_t delta = (ts > now) ? (ts - now) : 1;
+    if (delta > 0xFFFFFFFF)
+      {
+        // Far away; the handler will re-arm for the remaining time.
+        delta = 0xFFFFFFFF;
+      }
+    port::callout_timer::arm (static_cast<uint32_t> (delta));
+  }
+}
+
+/**
+ * @endcond
+ */
+
+/**
+ * @details
+ * Must be called from the interrupt handler of the timer armed
+ * by `port::callout_timer::arm()`.
+ *
+ * The callouts are removed from the array with the interrupts
+ * masked, but called with the interrupts restored, one at a time;
+ * they may schedule other callouts.
+ */
+void
+os_callout_handler (void)
+{
+  for (;;)
+    {
+      callout::func_t func;
+      void* args;
+
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          clock::timestamp_t now = hrclock.internal_now_unlocked ();
+          if (entries_count == 0
+              || entries[entries_count - 1].timestamp > now)
+            {
+              arm (now);
+              break;
+            }
+
+          --entries_count;
+          func = entries[entries_count].func;
+          args = entries[entries_count].args;
+          // ----- Exit critical section --------------------------------------
+        }
+
+      func (args);
+    }
+
+#if !defined(OS_USE_RTOS_PORT_SCHEDULER)
+  rtos::port::scheduler::reschedule ();
+#endif /* !defined(OS_USE_RTOS_PORT_SCHEDULER) */
+}
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    namespace callout
+    {
+      /**
+       * @details
+       * The function is called from the callouts timer interrupt;
+       * it must be short and may only use the functions allowed
+       * in Interrupt Service Routines.
+       *
+       * A delay of 0 calls the function from the next timer
+       * interrupt, as soon as possible.
+       *
+       * @note Can be invoked from Interrupt Service Routines.
+       */
+      result_t
+      schedule (clock::duration_t cycles, func_t func, void* args, id_t* id)
+      {
+        return schedule_at (hrclock.now () + cycles, func, args, id);
+      }
+
+      /**
+       * @details
+       * Time stamps already in the past call the function from
+       * the next timer interrupt.
+       *
+       * @note Can be invoked from Interrupt Service Routines.
+       */
+      result_t
+      schedule_at (clock::timestamp_t timestamp, func_t func, void* args,
+                   id_t* id)
+      {
+        os_assert_err(func != nullptr, EINVAL);
+
+        // ----- Enter critical section ---------------------------------------
+        interrupts::critical_section ics;
+
+        if (entries_count >= entries_size)
+          {
+            return EWOULDBLOCK;
+          }
+
+        // Skip the later entries; the new one goes after the
+        // entries with the same time stamp, so it is called last.
+        std::size_t i = entries_count;
+        while (i > 0 && entries[i - 1].timestamp <= timestamp)
+          {
+            entries[i] = entries[i - 1];
+            --i;
+          }
+
+        if (++last_id == 0)
+          {
+            last_id = 1;
+          }
+
+        entries[i] =
+          { timestamp, func, args, last_id };
+        ++entries_count;
+
+        if (id != nullptr)
+          {
+            *id = last_id;
+          }
+
+        if (i == entries_count - 1)
+          {
+            // New earliest callout.
+            arm (hrclock.internal_now_unlocked ());
+          }
+
+        return result::ok;
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      /**
+       * @details
+       * If this was the earliest callout, the timer is reprogrammed
+       * for the next one.
+       *
+       * @note Can be invoked from Interrupt Service Routines.
+       */
+      result_t
+      cancel (id_t id)
+      {
+        // ----- Enter critical section ---------------------------------------
+        interrupts::critical_section ics;
+
+        for (std::size_t i = 0; i < entries_count; ++i)
+          {
+            if (entries[i].id == id && id != 0)
+              {
+                bool earliest = (i == entries_count - 1);
+                for (; i + 1 < entries_count; ++i)
+                  {
+                    entries[i] = entries[i + 1];
+                  }
+                --entries_count;
+
+                if (earliest)
+                  {
+                    arm (hrclock.internal_now_unlocked ());
+                  }
+                return result::ok;
+              }
+          }
+
+        return ENOENT;
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      /**
+       * @details
+       * The result is rounded down.
+       *
+       * @note Can be invoked from Interrupt Service Routines.
+       */
+      clock::duration_t
+      cycles_from_us (uint32_t microsec)
+      {
+        return static_cast<clock::duration_t> ((static_cast<uint64_t> (microsec)
+            * hrclock.input_clock_frequency_hz ()) / 1000000u);
+      }
+
+      /**
+       * @details
+       *
+       * @note Can be invoked from Interrupt Service Routines.
+       */
+      std::size_t
+      pending (void)
+      {
+        return entries_count;
+      }
+
+      /**
+       * @details
+       *
+       * @note Can be invoked from Interrupt Service Routines.
+       */
+      std::size_t
+      capacity (void)
+      {
+        return entries_size;
+      }
+
+    } /* namespace callout */
+  } /* namespace rtos */
+} /* namespace os */
+
+#endif /* defined(OS_INCLUDE_RTOS_CALLOUTS) */
+
+// ----------------------------------------------------------------------------
@@ -39,10 +39,15 @@ using namespace os::rtos;
  * Must be called from the physical interrupt handler.
  */
 void
+OS_RTOS_HOT
 os_systick_handler (void)
 {
   using namespace os::rtos;
 
+#if defined(OS_INCLUDE_RTOS_TRACE_EVENTS)
+  os_rtos_trace_isr_enter ();
+#endif /* defined(OS_INCLUDE_RTOS_TRACE_EVENTS) */
+
 #if defined(OS_USE_RTOS_PORT_SCHEDULER)
   // Prevent scheduler actions before starting it.
   if (scheduler::started ())
@@ -51,6 +56,12 @@ os_systick_handler (void)
     }
 #endif
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_CRITICAL_SECTIONS)
+  // The SysTick counter restarted when the interrupt was raised.
+  interrupts::statistics::internal_record_latency_ (
+      port::clock_highres::cycles_since_tick ());
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_CRITICAL_SECTIONS) */
+
 #if defined(OS_TRACE_RTOS_SYSCLOCK_TICK)
   trace::putchar ('.');
 #endif
@@ -66,6 +77,33 @@ os_systick_handler (void)
   sysclock.internal_check_timestamps ();
   hrclock.internal_check_timestamps ();
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_CPU_LOAD)
+  scheduler::statistics::internal_sample_load_ ();
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_CPU_LOAD) */
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_EVENTS)
+  // The DWT counters are narrow, sample them more often
+  // than the context switches.
+  scheduler::statistics::internal_sample_events_ ();
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_EVENTS) */
+
+#if defined(OS_INCLUDE_RTOS_ZERO_LATENCY_INTERRUPTS)
+  // Deliver the signals not yet drained, if the application
+  // did not set a drain interrupt.
+  zero_latency::internal_drain_ ();
+#endif /* defined(OS_INCLUDE_RTOS_ZERO_LATENCY_INTERRUPTS) */
+
+#if defined(OS_USE_RTOS_HIGHRES_COMPARE_MATCH)
+    {
+      // ----- Enter critical section -----------------------------------------
+      interrupts::critical_section ics;
+
+      // The next deadline may fall before the next tick.
+      hrclock.internal_arm_compare ();
+      // ----- Exit critical section ------------------------------------------
+    }
+#endif /* defined(OS_USE_RTOS_HIGHRES_COMPARE_MATCH) */
+
 #if !defined(OS_INCLUDE_RTOS_REALTIME_CLOCK_DRIVER)
 
   // Simulate an RTC driver.
@@ -82,6 +120,20 @@ os_systick_handler (void)
 
 #if !defined(OS_USE_RTOS_PORT_SCHEDULER)
 
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING)
+  scheduler::internal_consume_slice_ ();
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING) */
+
+#if defined(OS_INCLUDE_RTOS_THREAD_BUDGET)
+  scheduler::internal_check_budget_ ();
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_BUDGET) */
+
+#if defined(OS_INCLUDE_RTOS_ISR_RESCHEDULE_COALESCING)
+  // The requests of the handlers preempted by the tick are
+  // served below.
+  interrupts::reschedule_pending_ = false;
+#endif /* defined(OS_INCLUDE_RTOS_ISR_RESCHEDULE_COALESCING) */
+
   port::scheduler::reschedule ();
 
 #endif /* !defined(OS_USE_RTOS_PORT_SCHEDULER) */
@@ -89,6 +141,10 @@ os_systick_handler (void)
 #if defined(OS_TRACE_RTOS_SYSCLOCK_TICK)
   trace::putchar (',');
 #endif
+
+#if defined(OS_INCLUDE_RTOS_TRACE_EVENTS)
+  os_rtos_trace_isr_exit ();
+#endif /* defined(OS_INCLUDE_RTOS_TRACE_EVENTS) */
 }
 
 /**
@@ -122,6 +178,31 @@ os_rtc_handler (void)
   rtclock.internal_check_timestamps ();
 }
 
+#if defined(OS_USE_RTOS_HIGHRES_COMPARE_MATCH)
+
+/**
+ * @details
+ * Must be called from the interrupt handler of the compare match
+ * armed by `port::clock_highres::arm_compare()`.
+ */
+void
+os_highres_compare_handler (void)
+{
+  using namespace os::rtos;
+
+#if defined(OS_TRACE_RTOS_SYSCLOCK_TICK)
+  trace::putchar ('\'');
+#endif
+
+  hrclock.internal_compare_match ();
+
+#if !defined(OS_USE_RTOS_PORT_SCHEDULER)
+  port::scheduler::reschedule ();
+#endif /* !defined(OS_USE_RTOS_PORT_SCHEDULER) */
+}
+
+#endif /* defined(OS_USE_RTOS_HIGHRES_COMPARE_MATCH) */
+
 // ----------------------------------------------------------------------------
 
 namespace os
@@ -201,9 +282,9 @@ namespace os
     clock::sleep_for (duration_t duration)
     {
 #if defined(OS_TRACE_RTOS_CLOCKS)
-      trace::printf ("%s(%u) %p %s\n", __func__,
-                     static_cast<unsigned int> (duration),
-                     &this_thread::thread (), this_thread::thread ().name ());
+      OS_TRACE_PRINTF (rtos_clocks, "%s(%u) %p %s\n", __func__,
+                       static_cast<unsigned int> (duration),
+                       &this_thread::thread (), this_thread::thread ().name ());
 #endif
 
       // Don't call this from interrupt handlers.
@@ -245,7 +326,7 @@ namespace os
     clock::sleep_until (timestamp_t timestamp)
     {
 #if defined(OS_TRACE_RTOS_CLOCKS)
-      trace::printf ("%s()\n", __func__);
+      OS_TRACE_PRINTF (rtos_clocks, "%s()\n", __func__);
 #endif
 
       // Don't call this from interrupt handlers.
@@ -286,7 +367,8 @@ namespace os
     clock::wait_for (duration_t timeout)
     {
 #if defined(OS_TRACE_RTOS_CLOCKS)
-      trace::printf ("%s(%u)\n", __func__, static_cast<unsigned int> (timeout));
+      OS_TRACE_PRINTF (rtos_clocks, "%s(%u)\n", __func__,
+                       static_cast<unsigned int> (timeout));
 #endif
 
       // Don't call this from interrupt handlers.
@@ -376,6 +458,10 @@ namespace os
           list.link (node);
           crt_thread.clock_node_ = &node;
           crt_thread.state_ = thread::state::suspended;
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_PROFILE)
+          crt_thread.statistics_.internal_waiting_for_ (&list);
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_PROFILE) */
           // ----- Exit critical section --------------------------------------
         }
 
@@ -438,7 +524,7 @@ namespace os
     adjustable_clock::sleep_until (timestamp_t timestamp)
     {
 #if defined(OS_TRACE_RTOS_CLOCKS)
-      trace::printf ("%s()\n", __func__);
+      OS_TRACE_PRINTF (rtos_clocks, "%s()\n", __func__);
 #endif
 
       // Don't call this from interrupt handlers.
@@ -562,7 +648,9 @@ namespace os
         clock
           { "sysclock" }
     {
-      ;
+#if defined(OS_USE_RTOS_CLOCK_TIMER_WHEEL)
+      steady_list_.wheel (&wheel_);
+#endif /* defined(OS_USE_RTOS_CLOCK_TIMER_WHEEL) */
     }
 
     /**
@@ -584,7 +672,7 @@ namespace os
     clock_systick::start (void)
     {
 #if defined(OS_TRACE_RTOS_CLOCKS)
-      trace::printf ("clock_systick::%s()\n", __func__);
+      OS_TRACE_PRINTF (rtos_clocks, "clock_systick::%s()\n", __func__);
 #endif
       port::clock_systick::start ();
     }
@@ -671,7 +759,9 @@ namespace os
         adjustable_clock
           { "rtclock" }
     {
-      ;
+#if defined(OS_USE_RTOS_CLOCK_TIMER_WHEEL)
+      steady_list_.wheel (&wheel_);
+#endif /* defined(OS_USE_RTOS_CLOCK_TIMER_WHEEL) */
     }
 
     /**
@@ -696,7 +786,7 @@ namespace os
     clock_rtc::start (void)
     {
 #if defined(OS_TRACE_RTOS_CLOCKS)
-      trace::printf ("clock_rtc::%s()\n", __func__);
+      OS_TRACE_PRINTF (rtos_clocks, "clock_rtc::%s()\n", __func__);
 #endif
       // Don't call this from interrupt handlers.
       assert (!interrupts::in_handler_mode ());
@@ -728,7 +818,9 @@ namespace os
         clock
           { "hrclock" }
     {
-      ;
+#if defined(OS_USE_RTOS_HIGHRES_COMPARE_MATCH)
+      steady_list_.compare_match ();
+#endif /* defined(OS_USE_RTOS_HIGHRES_COMPARE_MATCH) */
     }
 
     /**
@@ -750,12 +842,82 @@ namespace os
     clock_highres::start (void)
     {
 #if defined(OS_TRACE_RTOS_CLOCKS)
-      trace::printf ("clock_highres::%s()\n", __func__);
+      OS_TRACE_PRINTF (rtos_clocks, "clock_highres::%s()\n", __func__);
 #endif
 
       port::clock_highres::start ();
+
+#if defined(OS_USE_RTOS_HIGHRES_FREE_RUNNING_COUNTER)
+      // The count starts from the current value.
+      last_cycles_ = port::clock_highres::free_running_cycles ();
+#endif /* defined(OS_USE_RTOS_HIGHRES_FREE_RUNNING_COUNTER) */
+    }
+
+#if defined(OS_USE_RTOS_HIGHRES_FREE_RUNNING_COUNTER)
+
+    /**
+     * @details
+     * The 64-bit count at the last tick and the counter value
+     * at that moment are read under a sequence lock, without
+     * masking the interrupts; if the tick interrupt updated them
+     * meanwhile, they are read again. The cycles elapsed since
+     * then are the unsigned difference to the current counter
+     * value, correct across a counter wrap.
+     *
+     * The writer runs with the interrupts masked, so a reader
+     * never interrupts it and never spins.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    clock::timestamp_t
+    clock_highres::now (void)
+    {
+      timestamp_t count;
+      uint32_t last;
+      uint32_t seq;
+
+      do
+        {
+          seq = __atomic_load_n (&sequence_, __ATOMIC_ACQUIRE);
+          count = steady_count_;
+          last = last_cycles_;
+          __atomic_thread_fence (__ATOMIC_ACQUIRE);
+        }
+      while (((seq & 1) != 0)
+          || (seq != __atomic_load_n (&sequence_, __ATOMIC_RELAXED)));
+
+      return count
+          + static_cast<uint32_t> (port::clock_highres::free_running_cycles ()
+              - last);
+    }
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+    /**
+     * @details
+     * The counter keeps counting during sleep, so the clock only
+     * needs to catch up with it.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    clock::timestamp_t
+    clock_highres::update_for_slept_time (duration_t duration)
+    {
+      // ----- Enter critical section -----------------------------------------
+      interrupts::critical_section ics;
+
+      internal_increment_count ();
+
+      internal_check_timestamps ();
+      return steady_count_;
+      // ----- Exit critical section ------------------------------------------
     }
 
+#pragma GCC diagnostic pop
+
+#else
+
     clock::timestamp_t
     clock_highres::now (void)
     {
@@ -766,6 +928,156 @@ namespace os
       // ----- Exit critical section ------------------------------------------
     }
 
+#endif /* defined(OS_USE_RTOS_HIGHRES_FREE_RUNNING_COUNTER) */
+
+#if defined(OS_USE_RTOS_CLOCK_RETIMING)
+
+    /**
+     * @details
+     * Must be called right after the frequency of the SysTick input
+     * clock was changed, before the next tick.
+     *
+     * The SysTick is reprogrammed by the port to keep the tick
+     * rate, so the `sysclock` and `rtclock` time stamps are not
+     * affected; the current tick is restarted, so `sysclock` may
+     * lag by less than a tick for each call.
+     *
+     * The `hrclock` count continues from its current value, at
+     * the new rate; the pending `hrclock` time stamps are rescaled,
+     * so the sleeps, timeouts and timers expire after the same
+     * time in seconds. The durations already given in cycles, like
+     * the periods of the `hrclock` timers, the thread budgets and
+     * the statistics, keep their cycle values.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    result_t
+    clock_highres::retime (uint32_t input_frequency_hz)
+    {
+#if defined(OS_TRACE_RTOS_CLOCKS)
+      OS_TRACE_PRINTF (rtos_clocks, "%s(%u)\n", __func__,
+                       static_cast<unsigned int> (input_frequency_hz));
+#endif
+
+      os_assert_err(input_frequency_hz != 0, EINVAL);
+
+      // ----- Enter critical section -----------------------------------------
+      interrupts::critical_section ics;
+
+      uint32_t old_hz = port::clock_highres::input_clock_frequency_hz ();
+      if (old_hz == input_frequency_hz)
+        {
+          return result::ok;
+        }
+
+#if defined(OS_USE_RTOS_HIGHRES_FREE_RUNNING_COUNTER)
+      // Account the cycles counted at the old rate; the counter
+      // continues, at the new rate.
+      internal_increment_count ();
+      timestamp_t nw = steady_count_;
+
+      port::clock_systick::retime (input_frequency_hz);
+#else
+      timestamp_t nw = internal_now_unlocked ();
+
+      port::clock_systick::retime (input_frequency_hz);
+
+      // The tick period restarted, count from now.
+      steady_count_ = nw;
+#endif /* defined(OS_USE_RTOS_HIGHRES_FREE_RUNNING_COUNTER) */
+
+      steady_list_.rescale (nw, input_frequency_hz, old_hz);
+
+#if defined(OS_USE_RTOS_HIGHRES_COMPARE_MATCH)
+      internal_arm_compare ();
+#endif /* defined(OS_USE_RTOS_HIGHRES_COMPARE_MATCH) */
+
+      return result::ok;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+#endif /* defined(OS_USE_RTOS_CLOCK_RETIMING) */
+
+#if defined(OS_USE_RTOS_HIGHRES_COMPARE_MATCH)
+
+    /**
+     * @details
+     * Deadlines at or after the next tick are left to the SysTick
+     * interrupt, which calls this function again after checking
+     * the time stamps; only the earliest deadline before the next
+     * tick arms the compare match. A deadline already reached
+     * raises the interrupt on the next cycle.
+     *
+     * A spurious interrupt, after the earliest node was removed,
+     * only checks the list and re-arms.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    void
+    clock_highres::internal_arm_compare (void)
+    {
+      if (steady_list_.empty ())
+        {
+          port::clock_highres::disarm_compare ();
+          return;
+        }
+
+      timestamp_t deadline = steady_list_.head ()->timestamp;
+      timestamp_t nw = internal_now_unlocked ();
+
+      if (deadline <= nw)
+        {
+          port::clock_highres::arm_compare (1);
+          return;
+        }
+
+      uint32_t to_tick = port::clock_highres::cycles_per_tick ()
+          - port::clock_highres::cycles_since_tick ();
+
+      if (deadline - nw < to_tick)
+        {
+          port::clock_highres::arm_compare (
+              static_cast<uint32_t> (deadline - nw));
+        }
+      else
+        {
+          port::clock_highres::disarm_compare ();
+        }
+    }
+
+    /**
+     * @details
+     * Unlike the SysTick interrupt, which compares the time stamps
+     * with the count at the tick, the compare match uses the
+     * current time, with cycle resolution.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    void
+    clock_highres::internal_compare_match (void)
+    {
+      timestamp_t nw = now ();
+
+        {
+#if defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK_LATENCY)
+          statistics::dispatch_scope ds
+            { *this, nw };
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK_LATENCY) */
+
+          steady_list_.check_timestamp (nw);
+        }
+
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          internal_arm_compare ();
+          // ----- Exit critical section --------------------------------------
+        }
+    }
+
+#endif /* defined(OS_USE_RTOS_HIGHRES_COMPARE_MATCH) */
+
   // --------------------------------------------------------------------------
 
   } /* namespace rtos */
@@ -263,11 +263,16 @@ namespace os
           { name }
     {
 #if defined(OS_TRACE_RTOS_CONDVAR)
-      trace::printf ("%s() @%p %s\n", __func__, this, this->name ());
+      OS_TRACE_PRINTF (rtos_condvar, "%s() @%p %s\n", __func__, this,
+                       this->name ());
 #endif
 
       // Don't call this from interrupt handlers.
       os_assert_throw(!interrupts::in_handler_mode (), EPERM);
+
+#if defined(OS_INCLUDE_RTOS_OBJECT_REGISTRY)
+      registry::internal_insert (this, registry::type::condition_variable);
+#endif /* defined(OS_INCLUDE_RTOS_OBJECT_REGISTRY) */
     }
 
     /**
@@ -291,9 +296,13 @@ namespace os
     condition_variable::~condition_variable ()
     {
 #if defined(OS_TRACE_RTOS_CONDVAR)
-      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+      OS_TRACE_PRINTF (rtos_condvar, "%s() @%p %s\n", __func__, this, name ());
 #endif
 
+#if defined(OS_INCLUDE_RTOS_OBJECT_REGISTRY)
+      registry::internal_erase (this, registry::type::condition_variable);
+#endif /* defined(OS_INCLUDE_RTOS_OBJECT_REGISTRY) */
+
       // There must be no threads waiting for this condition.
       assert(list_.empty ());
     }
@@ -336,7 +345,7 @@ namespace os
     condition_variable::signal ()
     {
 #if defined(OS_TRACE_RTOS_CONDVAR)
-      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+      OS_TRACE_PRINTF (rtos_condvar, "%s() @%p %s\n", __func__, this, name ());
 #endif
 
       // Don't call this from interrupt handlers.
@@ -378,6 +387,11 @@ namespace os
      * have no effect if there are no threads currently
      * blocked on this condition variable.
      *
+     * Only the top priority thread is resumed; for mutexes without
+     * a priority protocol, the other threads are moved to the mutex
+     * waiting list (wait morphing) and are resumed one at a time,
+     * as the mutex is unlocked.
+     *
      * @par Application usage
      * The `broadcast()` function is used whenever
      * the shared-variable state has been changed in a way that more
@@ -406,17 +420,71 @@ namespace os
     condition_variable::broadcast ()
     {
 #if defined(OS_TRACE_RTOS_CONDVAR)
-      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+      OS_TRACE_PRINTF (rtos_condvar, "%s() @%p %s\n", __func__, this, name ());
 #endif
 
       // Don't call this from interrupt handlers.
       os_assert_err(!interrupts::in_handler_mode (), EPERM);
 
+#if !defined(OS_USE_RTOS_PORT_MUTEX)
+
+        {
+          // ----- Enter critical section -------------------------------------
+          scheduler::critical_section scs;
+
+          // Wake-up the top priority thread, if any; it will run after
+          // the scheduler is unlocked, and compete for the mutex.
+          if (!list_.resume_one ())
+            {
+              return result::ok;
+            }
+
+          // Requeue the other threads directly on the mutex waiting list,
+          // instead of waking all of them just to block again on the mutex;
+          // each unlock resumes the next one. Priority inheritance and
+          // protection must see the threads as they link, so these
+          // mutexes keep the classic wake-up.
+          mutex* mx = mutex_;
+          if ((mx != nullptr) && (mx->protocol_ == mutex::protocol::none))
+            {
+              // ----- Enter critical section ---------------------------------
+              interrupts::critical_section ics;
+
+              if (!list_.empty ())
+                {
+                  do
+                    {
+                      internal::waiting_thread_node* node =
+                          const_cast<internal::waiting_thread_node*> (list_.head ());
+                      node->unlink ();
+                      mx->list_.link (*node);
+                    }
+                  while (!list_.empty ());
+
+                  // Keep the current owner, if any, on the slow unlock
+                  // path, to resume the requeued threads.
+                  __atomic_fetch_or (&mx->owner_, mutex::owner_contended,
+                                     __ATOMIC_RELAXED);
+                }
+              return result::ok;
+              // ----- Exit critical section ----------------------------------
+            }
+
+          // Wake-up all other threads; the context switches are
+          // delayed until the end of the critical section.
+          list_.resume_all ();
+          // ----- Exit critical section --------------------------------------
+        }
+
+#else
+
       // Wake-up all threads, if any.
       // Need not be inside the critical section,
       // the list is protected by inner `resume_one()`.
       list_.resume_all ();
 
+#endif
+
       return result::ok;
     }
 
@@ -506,7 +574,7 @@ namespace os
     condition_variable::wait (mutex& mutex)
     {
 #if defined(OS_TRACE_RTOS_CONDVAR)
-      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+      OS_TRACE_PRINTF (rtos_condvar, "%s() @%p %s\n", __func__, this, name ());
 #endif
 
       // Don't call this from interrupt handlers.
@@ -514,38 +582,7 @@ namespace os
       // Don't call this from critical regions.
       os_assert_err(!scheduler::locked (), EPERM);
 
-      thread& crt_thread = this_thread::thread ();
-
-      // Prepare a list node pointing to the current thread.
-      // Do not worry for being on stack, it is temporarily linked to the
-      // list and guaranteed to be removed before this function returns.
-      internal::waiting_thread_node node
-        { crt_thread };
-
-      // TODO: validate
-
-      result_t res;
-      res = mutex.unlock ();
-
-      if (res != result::ok)
-        {
-          return res;
-        }
-
-        {
-          // Add this thread to the condition variable waiting list.
-          list_.link (node);
-          node.thread_->waiting_node_ = &node;
-
-          res = mutex.lock ();
-
-          // Remove the thread from the node waiting list,
-          // if not already removed.
-          node.thread_->waiting_node_ = nullptr;
-          node.unlink ();
-        }
-
-      return res;
+      return internal_wait_ (mutex, 0, false);
     }
 
     /**
@@ -651,8 +688,8 @@ namespace os
     condition_variable::timed_wait (mutex& mutex, clock::duration_t timeout)
     {
 #if defined(OS_TRACE_RTOS_CONDVAR)
-      trace::printf ("%s(%u) @%p %s\n", __func__,
-                     static_cast<unsigned int> (timeout), this, name ());
+      OS_TRACE_PRINTF (rtos_condvar, "%s(%u) @%p %s\n", __func__,
+                       static_cast<unsigned int> (timeout), this, name ());
 #endif
 
       // Don't call this from interrupt handlers.
@@ -660,6 +697,17 @@ namespace os
       // Don't call this from critical regions.
       os_assert_err(!scheduler::locked (), EPERM);
 
+      return internal_wait_ (mutex, timeout, true);
+    }
+
+    /**
+     * @cond ignore
+     */
+
+    result_t
+    condition_variable::internal_wait_ (mutex& mutex,
+                                        clock::duration_t timeout, bool timed)
+    {
       thread& crt_thread = this_thread::thread ();
 
       // Prepare a list node pointing to the current thread.
@@ -668,32 +716,85 @@ namespace os
       internal::waiting_thread_node node
         { crt_thread };
 
-      // TODO: validate
+      internal::clock_timestamps_list& clock_list = sysclock.steady_list ();
+      clock::timestamp_t timeout_timestamp = sysclock.steady_now () + timeout;
+
+      // Prepare a timeout node pointing to the current thread.
+      internal::timeout_thread_node timeout_node
+        { timeout_timestamp, crt_thread };
 
       result_t res;
-      res = mutex.unlock ();
 
-      if (res != result::ok)
         {
-          return res;
+          // ----- Enter critical section -------------------------------------
+          // Keep the scheduler locked until the thread is linked, so that
+          // a notification issued after the mutex is released is not lost.
+          scheduler::critical_section scs;
+
+          res = mutex.unlock ();
+          if (res != result::ok)
+            {
+              return res;
+            }
+
+            {
+              // ----- Enter critical section ---------------------------------
+              interrupts::critical_section ics;
+
+              mutex_ = &mutex;
+
+              // Add this thread to the condition variable waiting list,
+              // and possibly to the clock timeout list.
+              if (timed)
+                {
+                  scheduler::internal_link_node (list_, node, clock_list,
+                                                 timeout_node);
+                }
+              else
+                {
+                  scheduler::internal_link_node (list_, node);
+                }
+              // state::suspended set in above link().
+              // ----- Exit critical section ----------------------------------
+            }
+          // ----- Exit critical section --------------------------------------
         }
 
+      port::scheduler::reschedule ();
+
+      // Remove the thread from the condition variable waiting list,
+      // or from the mutex list where `broadcast()` moved it, if not
+      // already removed, and from the clock timeout list, if not
+      // already removed by the timer.
+      if (timed)
         {
-          // Add this thread to the condition variable waiting list.
-          list_.link (node);
-          node.thread_->waiting_node_ = &node;
+          scheduler::internal_unlink_node (node, timeout_node);
+        }
+      else
+        {
+          scheduler::internal_unlink_node (node);
+        }
 
-          res = mutex.timed_lock (timeout);
+      bool timed_out = timed && (sysclock.steady_now () >= timeout_timestamp);
 
-          // Remove the thread from the node waiting list,
-          // if not already removed.
-          node.thread_->waiting_node_ = nullptr;
-          node.unlink ();
+      // The mutex must be re-acquired, even after a timeout.
+      res = mutex.lock ();
+      if ((res == result::ok) && timed_out)
+        {
+#if defined(OS_TRACE_RTOS_CONDVAR)
+          OS_TRACE_PRINTF (rtos_condvar, "%s() ETIMEDOUT @%p %s\n", __func__,
+                           this, name ());
+#endif
+          return ETIMEDOUT;
         }
 
       return res;
     }
 
+    /**
+     * @endcond
+     */
+
   // --------------------------------------------------------------------------
 
   } /* namespace rtos */
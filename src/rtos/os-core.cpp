@@ -27,6 +27,10 @@
 
 #include <cmsis-plus/rtos/os.h>
 
+#if defined(OS_INCLUDE_RTOS_THREAD_NEWLIB_REENT)
+#include <reent.h>
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_NEWLIB_REENT) */
+
 // ----------------------------------------------------------------------------
 
 namespace
@@ -67,14 +71,22 @@ namespace os
        */
       bool is_started_ = false;
 
-#if 0
+#if defined(OS_USE_RTOS_SCHEDULER_LOCK_NESTING)
       /**
        * @details
        * Modified by `lock()`/`unlock()` and restored to the previous value
-       * by `locked(state_t)`.
+       * by `locked(state_t)`; nested sections keep the previous values
+       * on their stacks, so only the outermost one unlocks.
        */
-      state_t lock_state_ = state::init;
-#endif
+      state_t volatile lock_state_;
+
+      /**
+       * @details
+       * Set by the context switch handler when it found the scheduler
+       * locked; the outermost unlock requests the context switch again.
+       */
+      bool volatile lock_reschedule_pending_;
+#endif /* defined(OS_USE_RTOS_SCHEDULER_LOCK_NESTING) */
 
 #pragma GCC diagnostic push
 #if defined(__clang__)
@@ -102,7 +114,9 @@ namespace os
       // the first real thread is created.
       typedef struct {
         void* vtbl;
+#if !defined(OS_EXCLUDE_RTOS_OBJECT_NAMES)
         void* name_;
+#endif /* !defined(OS_EXCLUDE_RTOS_OBJECT_NAMES) */
         // errno is the first thread member, so right after the name.
         int errno_;
       } tiny_thread_t;
@@ -122,6 +136,23 @@ namespace os
       tiny_thread_t tiny_thread;
 #pragma GCC diagnostic pop
 
+#if defined(OS_INCLUDE_RTOS_SMP)
+
+      // The secondary cores do not run any code before their
+      // threads are created, so they need no temporary errno.
+      thread* volatile current_threads_[OS_INTEGER_RTOS_SMP_CORES] =
+        { reinterpret_cast<thread*>(&tiny_thread) };
+
+#pragma GCC diagnostic push
+#if defined(__clang__)
+#pragma clang diagnostic ignored "-Wglobal-constructors"
+#pragma clang diagnostic ignored "-Wexit-time-destructors"
+#endif
+      internal::ready_threads_list ready_threads_lists_[OS_INTEGER_RTOS_SMP_CORES];
+#pragma GCC diagnostic pop
+
+#else
+
       thread* volatile current_thread_ = reinterpret_cast<thread*>(&tiny_thread);
 
 #pragma GCC diagnostic push
@@ -131,8 +162,24 @@ namespace os
 #endif
       internal::ready_threads_list ready_threads_list_;
 #pragma GCC diagnostic pop
+
+#if defined(OS_INCLUDE_RTOS_THREAD_LOCAL_SLOTS)
+
+      // Used before the first context switch, until the scheduler
+      // is started.
+      static void* initial_local_slots_[OS_INTEGER_RTOS_THREAD_LOCAL_SLOTS];
+
+      void** local_slots_ = initial_local_slots_;
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_LOCAL_SLOTS) */
+
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
 #endif
 
+#if defined(OS_INCLUDE_RTOS_SMP)
+      internal::kernel_lock kernel_lock_;
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+
 #pragma GCC diagnostic push
 #if defined(__clang__)
 #pragma clang diagnostic ignored "-Wglobal-constructors"
@@ -157,12 +204,16 @@ namespace os
       initialize (void)
       {
 #if defined(OS_TRACE_RTOS_SCHEDULER)
-        trace::printf ("scheduler::%s() \n", __func__);
+        OS_TRACE_PRINTF (rtos_scheduler, "scheduler::%s() \n", __func__);
 #endif
 
         // Don't call this from interrupt handlers.
         os_assert_err(!interrupts::in_handler_mode (), EPERM);
 
+#if defined(OS_INCLUDE_RTOS_TRACE_EVENTS)
+        os_rtos_trace_initialize ();
+#endif /* defined(OS_INCLUDE_RTOS_TRACE_EVENTS) */
+
 #if defined(OS_USE_RTOS_PORT_SCHEDULER)
 
         return port::scheduler::initialize ();
@@ -206,6 +257,10 @@ namespace os
         scheduler::statistics::cpu_cycles_ = 0;
         scheduler::statistics::switch_timestamp_ = hrclock.now ();
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_EVENTS)
+        scheduler::statistics::internal_start_events_ ();
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_EVENTS) */
+
 #endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES) */
 
 #if !defined(OS_USE_RTOS_PORT_SCHEDULER)
@@ -214,6 +269,15 @@ namespace os
 
         is_started_ = true;
 
+#if defined(OS_INCLUDE_RTOS_SMP)
+        // Each secondary core enters port::scheduler::start() and
+        // runs the threads created for it, at least its idle thread.
+        for (std::size_t core = 1; core < OS_INTEGER_RTOS_SMP_CORES; ++core)
+          {
+            port::core::start (core);
+          }
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+
         port::scheduler::start ();
       }
 
@@ -226,7 +290,8 @@ namespace os
       preemptive (bool state)
       {
 #if defined(OS_TRACE_RTOS_SCHEDULER)
-        trace::printf ("scheduler::%s(%d) \n", __func__, state);
+        OS_TRACE_PRINTF (rtos_scheduler, "scheduler::%s(%d) \n", __func__,
+                         state);
 #endif
         // Don't call this from interrupt handlers.
         os_assert_throw(!interrupts::in_handler_mode (), EPERM);
@@ -339,6 +404,10 @@ namespace os
         list.link (node);
         node.thread_->waiting_node_ = &node;
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_PROFILE)
+        node.thread_->statistics_.internal_waiting_for_ (&list);
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_PROFILE) */
+
         node.thread_->state_ = thread::state::suspended;
       }
 
@@ -370,6 +439,10 @@ namespace os
         list.link (node);
         node.thread_->waiting_node_ = &node;
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_PROFILE)
+        node.thread_->statistics_.internal_waiting_for_ (&list);
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_PROFILE) */
+
         node.thread_->state_ = thread::state::suspended;
 
         // Add this thread to the clock timeout list.
@@ -396,13 +469,85 @@ namespace os
         // ----- Exit critical section ----------------------------------------
       }
 
+      /**
+       * @details
+       * Called by the idle thread, or by the reaper thread, and,
+       * when stack pools are used, by the threads that need the
+       * resources held by the terminated threads.
+       *
+       * The whole list is detached in a single short critical
+       * section, then the threads are destroyed one after the
+       * other, without yielding; the threads terminated meanwhile
+       * are left for the next call.
+       *
+       * With multiple cores, a thread that just terminated may still
+       * be saving its context on another core; it is put back
+       * in the list, for a later call.
+       */
+      std::size_t
+      internal_reap_terminated_ (void)
+      {
+        internal::terminated_threads_list batch;
+        batch.clear ();
+          {
+            // ----- Enter critical section -----------------------------------
+            interrupts::critical_section ics;
+
+            batch.splice_all (terminated_threads_list_);
+            // ----- Exit critical section ------------------------------------
+          }
+
+        std::size_t count = 0;
+        while (!batch.empty ())
+          {
+            internal::waiting_thread_node* node =
+                const_cast<internal::waiting_thread_node*> (batch.head ());
+
+            // The batch is local, no other thread can access it.
+            node->unlink ();
+
+#if defined(OS_INCLUDE_RTOS_SMP)
+            if (current_threads_[node->thread_->core_] == node->thread_)
+              {
+                  {
+                    // ----- Enter critical section ---------------------------
+                    interrupts::critical_section ics;
+
+                    terminated_threads_list_.link (*node);
+                    // ----- Exit critical section ----------------------------
+                  }
+                continue;
+              }
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+
+            node->thread_->internal_destroy_ ();
+            ++count;
+          }
+
+        return count;
+      }
+
       // ----------------------------------------------------------------------
 
 #if !defined(OS_USE_RTOS_PORT_SCHEDULER)
 
       void
+      OS_RTOS_HOT
       internal_switch_threads (void)
       {
+#if defined(OS_INCLUDE_RTOS_SMP)
+        // The ready lists are shared with the other cores.
+        // ----- Enter critical section ---------------------------------------
+        interrupts::critical_section ics;
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+
+        // With SMP, it runs on each core, for the thread running there.
+        thread* volatile& current_thread = internal_current_thread_ ();
+
+#if defined(OS_INCLUDE_RTOS_TRACE_EVENTS)
+        thread* previous_thread = current_thread;
+#endif /* defined(OS_INCLUDE_RTOS_TRACE_EVENTS) */
+
 #if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES)
 
         // Get the high resolution timestamp.
@@ -418,23 +563,69 @@ namespace os
         scheduler::statistics::cpu_cycles_ += delta;
 
         // Accumulate durations to old thread.
-        scheduler::current_thread_->statistics_.cpu_cycles_ += delta;
+        current_thread->statistics_.cpu_cycles_ += delta;
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_EVENTS)
+        // Accumulate the hardware events to old thread.
+        scheduler::statistics::internal_sample_events_ ();
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_EVENTS) */
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_PROFILE)
+        // Accumulate durations to the current running slice.
+        current_thread->statistics_.slice_cycles_ += delta;
+
+        thread* old_thread = current_thread;
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_PROFILE) */
 
         // Remember the timestamp for the next context switch.
         scheduler::statistics::switch_timestamp_ = now;
 
+#if defined(OS_INCLUDE_RTOS_THREAD_BUDGET)
+        // Catch the overruns between ticks, before the old thread
+        // leaves; the handler runs as from an interrupt.
+        current_thread->internal_check_budget_ (0);
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_BUDGET) */
+
 #endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES) */
 
+#if defined(OS_USE_RTOS_SCHEDULER_LOCK_NESTING)
+        if (locked ())
+          {
+            // Retried by the outermost unlock.
+            lock_reschedule_pending_ = true;
+          }
+#endif /* defined(OS_USE_RTOS_SCHEDULER_LOCK_NESTING) */
+
         // The very core of the scheduler, if not locked, re-link the
         // current thread and return the top priority thread.
-        if (!locked ())
+        if (!locked ()
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_PREEMPTION_THRESHOLD)
+            && !current_thread->internal_above_threshold_ ()
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_PREEMPTION_THRESHOLD) */
+            )
           {
-            // Normally the old running thread must be re-linked to ready.
-            scheduler::current_thread_->internal_relink_running_ ();
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_HANDOFF)
+            thread* target = current_thread->internal_handoff_target_ ();
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_HANDOFF) */
 
-            // The top of the ready list gives the next thread to run.
-            scheduler::current_thread_ =
-                scheduler::ready_threads_list_.unlink_head ();
+            // Normally the old running thread must be re-linked to ready.
+            current_thread->internal_relink_running_ ();
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_HANDOFF)
+            if (target != nullptr)
+              {
+                // Directed switch, take the target out of its place.
+                target->internal_ready_list_ ().unlink (target->ready_node_);
+                target->state_ = thread::state::running;
+                current_thread = target;
+              }
+            else
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_HANDOFF) */
+              {
+                // The top of the ready list gives the next thread to run.
+                current_thread =
+                    current_thread->internal_ready_list_ ().unlink_head ();
+              }
           }
 
         // ***** Pointer switched to new thread! *****
@@ -450,12 +641,272 @@ namespace os
         scheduler::statistics::context_switches_++;
 
         // Increment new thread context switches.
-        scheduler::current_thread_->statistics_.context_switches_++;
+        current_thread->statistics_.context_switches_++;
 
 #endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CONTEXT_SWITCHES) */
 
+#if defined(OS_INCLUDE_RTOS_THREAD_NEWLIB_REENT)
+        // Only the threads that used the C library have their own
+        // structure, the others share the global one.
+        struct _reent* reent = current_thread->newlib_reent_;
+        _impure_ptr = (reent != nullptr) ? reent : _GLOBAL_REENT;
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_NEWLIB_REENT) */
+
+#if defined(OS_INCLUDE_RTOS_THREAD_LOCAL_SLOTS)
+        scheduler::local_slots_ = current_thread->local_slots_;
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_LOCAL_SLOTS) */
+
+#if defined(OS_INCLUDE_RTOS_TRACE_EVENTS)
+        if (current_thread != previous_thread)
+          {
+            os_rtos_trace_thread_run (current_thread);
+          }
+#endif /* defined(OS_INCLUDE_RTOS_TRACE_EVENTS) */
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_PROFILE)
+
+        if (current_thread != old_thread)
+          {
+            old_thread->statistics_.internal_switch_out_ (now,
+                                                          old_thread->state_);
+            current_thread->statistics_.internal_switch_in_ (now);
+          }
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_PROFILE) */
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK_LATENCY)
+        if (current_thread->latency_slot_ != nullptr)
+          {
+            rtos::statistics::internal_record_running_ (*current_thread);
+          }
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK_LATENCY) */
+
+#if defined(OS_INCLUDE_RTOS_SMP)
+        // ----- Exit critical section ----------------------------------------
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+      }
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING)
+
+      namespace
+      {
+        // One quantum for each priority class; 0 means the default.
+        clock::duration_t quantums_[1u << (8 - thread::priority::range)];
+      }
+
+      /**
+       * @details
+       * The priority classes are the groups of priorities
+       * with the same most significant bits, like
+       * `thread::priority::normal` and the priorities above it,
+       * up to `thread::priority::above_normal`.
+       *
+       * @note Can be invoked from Interrupt Service Routines.
+       */
+      clock::duration_t
+      quantum (thread::priority_t prio)
+      {
+        clock::duration_t ticks = quantums_[prio >> thread::priority::range];
+        if (ticks == 0)
+          {
+            ticks = OS_INTEGER_RTOS_SCHEDULER_QUANTUM_TICKS;
+          }
+        return ticks;
+      }
+
+      /**
+       * @details
+       * The new quantum is used by the threads of the class without
+       * their own quantum, from their next time slice.
+       *
+       * @note Can be invoked from Interrupt Service Routines.
+       */
+      clock::duration_t
+      quantum (thread::priority_t prio, clock::duration_t ticks)
+      {
+        clock::duration_t previous = quantum (prio);
+        quantums_[prio >> thread::priority::range] = ticks;
+        return previous;
+      }
+
+      /**
+       * @details
+       * Called from the clock interrupt, before the scheduler
+       * runs. The running thread consumes its slice only if another
+       * thread of the same priority is ready; since the running
+       * thread has the highest priority, it is enough to check
+       * the top of the ready list.
+       *
+       * When the slice expires, the next context switch puts the
+       * thread behind its peers, with a new slice.
+       */
+      void
+      internal_consume_slice_ (void)
+      {
+        if (!started ())
+          {
+            return;
+          }
+
+        // ----- Enter critical section ---------------------------------------
+        interrupts::critical_section ics;
+
+        thread* th = internal_current_thread_ ();
+        if (th->state_ != thread::state::running)
+          {
+            return;
+          }
+
+        internal::ready_threads_list& list = th->internal_ready_list_ ();
+        if (list.empty ()
+            || list.head ()->thread_->priority () != th->priority ())
+          {
+            // Alone at its priority, there is no one to rotate with.
+            return;
+          }
+
+        if (th->slice_left_ > 1)
+          {
+            th->slice_left_ = th->slice_left_ - 1;
+          }
+        else
+          {
+            th->slice_left_ = 0;
+          }
+        // ----- Exit critical section ----------------------------------------
+      }
+
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING) */
+
+#if defined(OS_INCLUDE_RTOS_THREAD_BUDGET)
+
+      /**
+       * @details
+       * Called from the clock interrupt, to catch the threads
+       * running past their budget without being switched out;
+       * the cycles used since the last context switch are
+       * not yet accounted to the thread.
+       */
+      void
+      internal_check_budget_ (void)
+      {
+        if (!started ())
+          {
+            return;
+          }
+
+        // ----- Enter critical section ---------------------------------------
+        interrupts::critical_section ics;
+
+        thread* th = internal_current_thread_ ();
+        if (th->budget_cycles_ == 0 || th->budget_fired_)
+          {
+            return;
+          }
+
+        th->internal_check_budget_ (
+            static_cast<rtos::statistics::duration_t> (
+                hrclock.internal_now_unlocked ()
+                    - scheduler::statistics::switch_timestamp_));
+        // ----- Exit critical section ----------------------------------------
+      }
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_BUDGET) */
+
+#if defined(OS_INCLUDE_RTOS_SMP) \
+  && defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES)
+
+      namespace
+      {
+        // Only one idle thread balances at a time.
+        internal::spinlock balance_lock;
+
+        clock::timestamp_t balance_timestamp;
       }
 
+      /**
+       * @details
+       * Called by the idle threads; at most once every
+       * `OS_INTEGER_RTOS_SMP_BALANCE_PERIOD_TICKS`, it computes
+       * the CPU cycles used on each core since the previous call,
+       * from the thread statistics, without counting the idle threads.
+       *
+       * If the difference between the busiest and the least busy
+       * cores is significant (more than 1/8 of the busiest load),
+       * the busiest thread allowed on both cores, whose load is
+       * less than the difference, so that moving it reduces the
+       * imbalance, is moved to the least busy core.
+       *
+       * At most one thread is moved each time, to avoid
+       * oscillations.
+       */
+      void
+      internal_balance_ (void)
+      {
+        clock::timestamp_t now = sysclock.now ();
+        if (now - balance_timestamp < OS_INTEGER_RTOS_SMP_BALANCE_PERIOD_TICKS)
+          {
+            return;
+          }
+
+        if (!balance_lock.try_lock ())
+          {
+            return;
+          }
+        balance_timestamp = now;
+
+        rtos::statistics::duration_t loads[OS_INTEGER_RTOS_SMP_CORES] =
+          { };
+
+          {
+            // Keep the threads from being created or destroyed.
+            // ----- Enter critical section -----------------------------------
+            interrupts::critical_section ics;
+
+            thread::internal_balance_measure_ (nullptr, loads);
+
+            std::size_t busiest = 0;
+            std::size_t idlest = 0;
+            for (std::size_t core = 1; core < OS_INTEGER_RTOS_SMP_CORES;
+                ++core)
+              {
+                if (loads[core] > loads[busiest])
+                  {
+                    busiest = core;
+                  }
+                if (loads[core] < loads[idlest])
+                  {
+                    idlest = core;
+                  }
+              }
+
+            rtos::statistics::duration_t diff = loads[busiest] - loads[idlest];
+            if (diff != 0 && diff > (loads[busiest] >> 3))
+              {
+                thread* th = thread::internal_balance_pick_ (
+                    nullptr, static_cast<thread::core_t> (busiest),
+                    static_cast<thread::core_t> (idlest), diff, nullptr);
+                if (th != nullptr)
+                  {
+#if defined(OS_TRACE_RTOS_SCHEDULER)
+                    OS_TRACE_PRINTF (rtos_scheduler,
+                                     "scheduler::%s() %s %u->%u\n", __func__,
+                                     th->name (),
+                                     static_cast<unsigned int> (busiest),
+                                     static_cast<unsigned int> (idlest));
+#endif
+                    th->internal_migrate_ (
+                        static_cast<thread::core_t> (idlest));
+                  }
+              }
+            // ----- Exit critical section ------------------------------------
+          }
+
+        balance_lock.unlock ();
+      }
+
+#endif
+
 #endif /* !defined(OS_USE_RTOS_PORT_SCHEDULER) */
 
       namespace statistics
@@ -473,8 +924,126 @@ namespace os
 
 #endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES) */
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_PROFILE)
+
+        /**
+         * @cond ignore
+         */
+
+        static std::size_t
+        _threads_profile (thread* parent, thread::statistics::profile* buf,
+                          std::size_t count, std::size_t index)
+        {
+          for (auto&& th : children_threads (parent))
+            {
+              if (index < count)
+                {
+                  thread::statistics::profile& out = buf[index];
+                  th.statistics ().snapshot (out);
+                  out.th = &th;
+                  out.name = th.name ();
+                  out.state = th.state ();
+                }
+              index = _threads_profile (&th, buf, count, index + 1);
+            }
+          return index;
+        }
+
+        /**
+         * @endcond
+         */
+
+        /**
+         * @details
+         * Walk the threads tree with the scheduler locked, so that
+         * the list of threads does not change; each thread is
+         * copied atomically (see `thread::statistics::snapshot()`).
+         *
+         * If the array is too small, only the first `count` threads
+         * are copied, but the total number of threads is still
+         * returned, so the caller may retry with a larger array.
+         *
+         * @note This function is available only when
+         * @ref OS_INCLUDE_RTOS_STATISTICS_THREAD_PROFILE
+         * is defined.
+         *
+         * @warning Cannot be invoked from Interrupt Service Routines.
+         */
+        std::size_t
+        threads_profile (thread::statistics::profile* buf, std::size_t count)
+        {
+          // ----- Enter critical section -------------------------------------
+          scheduler::critical_section scs;
+
+          return _threads_profile (nullptr, buf, count, 0);
+          // ----- Exit critical section --------------------------------------
+        }
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_PROFILE) */
+
       } /* namespace statistics */
 
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
+
+      namespace edf
+      {
+        utilization_t utilization_;
+        rtos::statistics::counter_t deadline_misses_;
+
+        /**
+         * @details
+         * The density of a job is its budget divided by the
+         * shorter of its deadline and its period; for threads
+         * with deadlines equal to periods this is the classic
+         * utilisation.
+         *
+         * A zero deadline returns `full`, such a thread
+         * is not admissible.
+         *
+         * @note Can be invoked from Interrupt Service Routines.
+         */
+        utilization_t
+        density (clock::duration_t budget, clock::duration_t deadline,
+                 clock::duration_t period)
+        {
+          clock::duration_t window = deadline;
+          if (period != 0 && period < window)
+            {
+              window = period;
+            }
+          if (window == 0)
+            {
+              return full;
+            }
+
+          return static_cast<utilization_t> ((static_cast<uint64_t> (budget)
+              * full) / window);
+        }
+
+        /**
+         * @details
+         * With EDF on a single core, all deadlines are met as long
+         * as the sum of the densities does not exceed 1; the
+         * test is sufficient, and also necessary when the
+         * deadlines are equal to the periods.
+         *
+         * The check does not reserve anything; the new thread is
+         * accounted for only when it is created.
+         *
+         * @note Can be invoked from Interrupt Service Routines.
+         */
+        bool
+        admissible (clock::duration_t budget, clock::duration_t deadline,
+                    clock::duration_t period)
+        {
+          return (static_cast<uint64_t> (utilization_)
+              + density (budget, deadline, period)) <= full;
+        }
+
+      } /* namespace edf */
+
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_EDF) */
+
     /**
      * @endcond
      */
@@ -566,6 +1135,38 @@ namespace os
 
 #endif /* defined(OS_HAS_INTERRUPTS_STACK) */
 
+#if defined(OS_INCLUDE_RTOS_ISR_RESCHEDULE_COALESCING)
+
+      /**
+       * @class handler_scope
+       * @details
+       * Instantiate it at the beginning of the interrupt handlers
+       * that may post to several objects, or that fire in bursts.
+       * The threads made ready inside the scope are only linked
+       * to the ready list, and a single context switch is
+       * requested when the outermost handler exits.
+       *
+       * @par Example
+       *
+       * @code{.cpp}
+       * void
+       * UART_IRQHandler (void)
+       * {
+       *   interrupts::handler_scope ihs;
+       *
+       *   while (uart_has_data ())
+       *     {
+       *       mq.try_send (uart_read ());
+       *     }
+       * } // The context switch is requested here.
+       * @endcode
+       */
+
+      std::size_t volatile handler_nesting_;
+      bool volatile reschedule_pending_;
+
+#endif /* defined(OS_INCLUDE_RTOS_ISR_RESCHEDULE_COALESCING) */
+
       ;
     // Avoid formatter bug.
     }
@@ -594,31 +1195,6 @@ namespace os
        * string (stored in flash) is preferred.
        */
 
-      /**
-       *
-       */
-      object_named::object_named ()
-      {
-        ;
-      }
-
-      /**
-       * @details
-       * Prefer the given name, otherwise
-       * default to '-'.
-       *
-       * To save space, instead of copying the null terminated string
-       * locally, the pointer to the string
-       * is copied, so the caller must ensure that the pointer
-       * life cycle is at least as long as the object life cycle.
-       * A constant string (stored in flash) is preferred.
-       */
-      object_named::object_named (const char* name) :
-          name_ (name != nullptr ? name : "-")
-      {
-        ;
-      }
-
     } /* namespace internal */
 
   // ==========================================================================
@@ -651,3 +1227,112 @@ __errno (void)
 /**
  * @}
  */
+
+#if defined(OS_INCLUDE_RTOS_THREAD_NEWLIB_REENT) && defined(__DYNAMIC_REENT__)
+
+/**
+ * @brief Per-thread newlib reentrancy support.
+ * @ingroup cmsis-plus-rtos-c
+ * @details
+ * Newlib builds with `__DYNAMIC_REENT__` get the reentrancy
+ * structure via this function, so it is allocated on the
+ * first libc call that needs it. Interrupts and the code
+ * running before the scheduler use the current `_impure_ptr`.
+ * @return Pointer to the reentrancy structure of the current thread.
+ */
+struct _reent*
+__getreent (void)
+{
+  if (os::rtos::interrupts::in_handler_mode ()
+      || !os::rtos::scheduler::started ())
+    {
+      return _impure_ptr;
+    }
+  return os::rtos::this_thread::thread ().newlib_reent ();
+}
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_NEWLIB_REENT) && defined(__DYNAMIC_REENT__) */
+
+#if defined(OS_INCLUDE_RTOS_TRACE_EVENTS)
+
+/**
+ * @name RTOS event tracing default hooks
+ * @{
+ */
+
+// Weak empty definitions, when no tracing backend is linked;
+// the real ones are in the trace backends, like
+// `trace-segger-systemview.cpp`.
+
+void
+__attribute__((weak))
+os_rtos_trace_initialize (void)
+{
+}
+
+void
+__attribute__((weak))
+os_rtos_trace_thread_create (void* th __attribute__((unused)))
+{
+}
+
+void
+__attribute__((weak))
+os_rtos_trace_thread_terminate (void* th __attribute__((unused)))
+{
+}
+
+void
+__attribute__((weak))
+os_rtos_trace_thread_ready (void* th __attribute__((unused)))
+{
+}
+
+void
+__attribute__((weak))
+os_rtos_trace_thread_suspend (void* th __attribute__((unused)))
+{
+}
+
+void
+__attribute__((weak))
+os_rtos_trace_thread_run (void* th __attribute__((unused)))
+{
+}
+
+void
+__attribute__((weak))
+os_rtos_trace_isr_enter (void)
+{
+}
+
+void
+__attribute__((weak))
+os_rtos_trace_isr_exit (void)
+{
+}
+
+void
+__attribute__((weak))
+os_rtos_trace_timer_enter (void* tm __attribute__((unused)))
+{
+}
+
+void
+__attribute__((weak))
+os_rtos_trace_timer_exit (void)
+{
+}
+
+void
+__attribute__((weak))
+os_rtos_trace_object (os_rtos_trace_event_t event __attribute__((unused)),
+                      void* object __attribute__((unused)))
+{
+}
+
+/**
+ * @}
+ */
+
+#endif /* defined(OS_INCLUDE_RTOS_TRACE_EVENTS) */
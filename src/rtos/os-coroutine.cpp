@@ -0,0 +1,752 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/rtos/os-coroutine.h>
+
+#if defined(__cpp_impl_coroutine) && (__cplusplus >= 202002L)
+
+#include <cstdlib>
+#include <new>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    namespace co
+    {
+      // ----------------------------------------------------------------------
+
+      /**
+       * @cond ignore
+       */
+
+      namespace
+      {
+        memory::memory_resource* frames_resource = nullptr;
+
+        // The frame is preceded by the resource it came from.
+        constexpr std::size_t frame_header =
+            memory::memory_resource::max_align;
+      }
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @details
+       * Only the frames allocated later are affected; each frame
+       * is returned to the resource it was allocated from.
+       *
+       * With a `memory::block_pool`, the block size must be large
+       * enough for the largest coroutine frame, plus
+       * `alignof(std::max_align_t)` bytes.
+       */
+      memory::memory_resource*
+      frame_resource (memory::memory_resource* mr) noexcept
+      {
+        memory::memory_resource* old = frames_resource;
+        frames_resource = mr;
+
+        return old;
+      }
+
+      // ======================================================================
+
+      /**
+       * @class awaiter
+       * @details
+       * The derived classes implement `do_try_complete()` with the
+       * non blocking function of the RTOS object (`try_wait()`,
+       * `try_receive()`), and `do_ready()` with a check that does
+       * not consume anything.
+       *
+       * The objects implemented by the port have no waiting list;
+       * they are checked at each clock tick.
+       */
+
+      /**
+       * @cond ignore
+       */
+
+      internal::waiting_threads_list*
+      awaiter::internal_list_ (semaphore& sem)
+      {
+#if defined(OS_USE_RTOS_PORT_SEMAPHORE)
+        (void) sem;
+        return nullptr;
+#else
+        return &sem.list_;
+#endif
+      }
+
+      internal::waiting_threads_list*
+      awaiter::internal_list_ (message_queue& mq)
+      {
+#if defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+        (void) mq;
+        return nullptr;
+#else
+        return &mq.receive_list_;
+#endif
+      }
+
+      internal::waiting_threads_list*
+      awaiter::internal_list_ (event_flags& evf)
+      {
+#if defined(OS_USE_RTOS_PORT_EVENT_FLAGS)
+        (void) evf;
+        return nullptr;
+#else
+        return &evf.list_;
+#endif
+      }
+
+      bool
+      awaiter::internal_raised_ (event_flags& evf, flags::mask_t mask,
+                                 flags::mode_t mode)
+      {
+#if defined(OS_USE_RTOS_PORT_EVENT_FLAGS)
+        (void) evf;
+        (void) mask;
+        (void) mode;
+        return false;
+#else
+        return evf.event_flags_.check_raised (mask, nullptr, mode);
+#endif
+      }
+
+      /**
+       * @endcond
+       */
+
+      // ----------------------------------------------------------------------
+
+      bool
+      yield_awaiter::do_try_complete (void)
+      {
+        return true;
+      }
+
+      bool
+      yield_awaiter::do_ready (void)
+      {
+        return true;
+      }
+
+      // ======================================================================
+
+      std::coroutine_handle<>
+      promise::final_awaiter::await_suspend (
+          std::coroutine_handle<promise> h) noexcept
+      {
+        promise& p = h.promise ();
+        if (p.continuation_)
+          {
+            // Awaited by another coroutine, resume it.
+            return p.continuation_;
+          }
+
+        // The scheduler destroys the frame.
+        p.scheduler_->internal_done_ (p);
+        return std::noop_coroutine ();
+      }
+
+      task
+      promise::get_return_object (void) noexcept
+      {
+        return task
+          { std::coroutine_handle<promise>::from_promise (*this) };
+      }
+
+      task
+      promise::get_return_object_on_allocation_failure (void) noexcept
+      {
+        return task
+          {};
+      }
+
+      void
+      promise::unhandled_exception (void) noexcept
+      {
+        abort ();
+      }
+
+      void*
+      promise::operator new (std::size_t bytes) noexcept
+      {
+        memory::memory_resource* mr = frames_resource;
+        if (mr == nullptr)
+          {
+            mr = memory::get_default_resource ();
+          }
+
+        void* p = mr->allocate (bytes + frame_header);
+        if (p == nullptr)
+          {
+            return nullptr;
+          }
+
+        *static_cast<memory::memory_resource**> (p) = mr;
+        return static_cast<char*> (p) + frame_header;
+      }
+
+      void
+      promise::operator delete (void* ptr, std::size_t bytes) noexcept
+      {
+        char* p = static_cast<char*> (ptr) - frame_header;
+        memory::memory_resource* mr =
+            *reinterpret_cast<memory::memory_resource**> (p);
+
+        mr->deallocate (p, bytes + frame_header);
+      }
+
+      // ======================================================================
+
+      task&
+      task::operator= (task&& other) noexcept
+      {
+        if (this != &other)
+          {
+            if (handle_)
+              {
+                handle_.destroy ();
+              }
+            handle_ = other.handle_;
+            other.handle_ = nullptr;
+          }
+        return *this;
+      }
+
+      /**
+       * @details
+       * The tasks passed to `scheduler::spawn()` are no longer
+       * owned, the scheduler destroys them when completed.
+       */
+      task::~task ()
+      {
+        if (handle_)
+          {
+            handle_.destroy ();
+          }
+      }
+
+      /**
+       * @details
+       * The task runs in the same scheduler as the caller, which
+       * is resumed when the task completes.
+       */
+      std::coroutine_handle<>
+      task::await_suspend (std::coroutine_handle<promise> caller) noexcept
+      {
+        promise& p = handle_.promise ();
+        p.scheduler_ = caller.promise ().scheduler_;
+        p.continuation_ = caller;
+
+        return handle_;
+      }
+
+      // ======================================================================
+
+      /**
+       * @details
+       * The scheduler has no tasks after construction.
+       */
+      scheduler::scheduler (const char* name) :
+          object_named_system
+            { name }
+      {
+      }
+
+      /**
+       * @details
+       * The frames of the tasks not completed are destroyed, with
+       * the tasks they awaited.
+       */
+      scheduler::~scheduler ()
+      {
+        promise* lists[] =
+          { tasks_, done_ };
+        for (promise* p : lists)
+          {
+            while (p != nullptr)
+              {
+                promise* next = p->next_;
+                std::coroutine_handle<promise>::from_promise (*p).destroy ();
+                p = next;
+              }
+          }
+      }
+
+      /**
+       * @details
+       * The task starts at the next iteration of `run()`.
+       *
+       * @note Can be invoked from other threads, or from the
+       *  tasks of the scheduler.
+       */
+      result_t
+      scheduler::spawn (task&& t)
+      {
+        if (!t.handle_)
+          {
+            return ENOMEM;
+          }
+
+        promise& p = t.handle_.promise ();
+        if (p.scheduler_ != nullptr || t.handle_.done ())
+          {
+            return EINVAL;
+          }
+
+        p.scheduler_ = this;
+        p.start_.handle_ = t.handle_;
+        t.handle_ = nullptr;
+
+          {
+            // ----- Enter critical section -----------------------------------
+            interrupts::critical_section ics;
+
+            p.prev_ = nullptr;
+            p.next_ = tasks_;
+            if (tasks_ != nullptr)
+              {
+                tasks_->prev_ = &p;
+              }
+            tasks_ = &p;
+            ++size_;
+            // ----- Exit critical section ------------------------------------
+          }
+
+        internal_ready_ (p.start_);
+        return result::ok;
+      }
+
+      /**
+       * @details
+       * The calling thread resumes the ready tasks, one after
+       * the other; when none is ready, it is linked to the waiting
+       * lists of all awaited objects and suspended, until one of them
+       * is posted, sent or raised, the nearest sleep expires, or
+       * a task is spawned.
+       *
+       * @warning Cannot be invoked from Interrupt Service Routines.
+       */
+      result_t
+      scheduler::run (void)
+      {
+        // Don't call this from interrupt handlers.
+        os_assert_err(!interrupts::in_handler_mode (), EPERM);
+        // Don't call this from critical regions.
+        os_assert_err(!rtos::scheduler::locked (), EPERM);
+
+        thread& crt_thread = this_thread::thread ();
+
+          {
+            // ----- Enter critical section -----------------------------------
+            interrupts::critical_section ics;
+
+            if (thread_ != nullptr)
+              {
+                return EBUSY;
+              }
+            thread_ = &crt_thread;
+            // ----- Exit critical section ------------------------------------
+          }
+
+        result_t res = result::ok;
+        for (;;)
+          {
+            awaiter* a;
+            promise* done;
+              {
+                // ----- Enter critical section -------------------------------
+                interrupts::critical_section ics;
+
+                a = ready_head_;
+                ready_head_ = nullptr;
+                ready_tail_ = nullptr;
+                // ----- Exit critical section --------------------------------
+              }
+
+            while (a != nullptr)
+              {
+                // The awaiter is gone after resume().
+                awaiter* next = a->next_;
+                a->handle_.resume ();
+                a = next;
+              }
+
+              {
+                // ----- Enter critical section -------------------------------
+                interrupts::critical_section ics;
+
+                done = done_;
+                done_ = nullptr;
+                // ----- Exit critical section --------------------------------
+              }
+
+            while (done != nullptr)
+              {
+                promise* next = done->next_;
+                std::coroutine_handle<promise>::from_promise (*done).destroy ();
+                done = next;
+              }
+
+            if (size_ == 0)
+              {
+                break;
+              }
+
+            if (internal_poll_ ())
+              {
+                continue;
+              }
+
+            res = internal_block_ (crt_thread);
+            if (res != result::ok)
+              {
+                break;
+              }
+          }
+
+        thread_ = nullptr;
+        return res;
+      }
+
+      /**
+       * @cond ignore
+       */
+
+      void
+      scheduler::internal_ready_ (awaiter& a)
+      {
+          {
+            // ----- Enter critical section -----------------------------------
+            interrupts::critical_section ics;
+
+            a.next_ = nullptr;
+            if (ready_tail_ != nullptr)
+              {
+                ready_tail_->next_ = &a;
+              }
+            else
+              {
+                ready_head_ = &a;
+              }
+            ready_tail_ = &a;
+            // ----- Exit critical section ------------------------------------
+          }
+
+        // If the scheduler thread is idle, wake it up.
+        wake_list_.resume_one ();
+      }
+
+      // Only called by the scheduler thread.
+      void
+      scheduler::internal_wait_ (awaiter& a)
+      {
+        a.next_ = waiting_;
+        waiting_ = &a;
+      }
+
+      void
+      scheduler::internal_done_ (promise& p)
+      {
+        // ----- Enter critical section ---------------------------------------
+        interrupts::critical_section ics;
+
+        if (p.prev_ != nullptr)
+          {
+            p.prev_->next_ = p.next_;
+          }
+        else
+          {
+            tasks_ = p.next_;
+          }
+        if (p.next_ != nullptr)
+          {
+            p.next_->prev_ = p.prev_;
+          }
+
+        p.prev_ = nullptr;
+        p.next_ = done_;
+        done_ = &p;
+        --size_;
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      // Move the awaiters that can be completed to the ready list.
+      bool
+      scheduler::internal_poll_ (void)
+      {
+        bool moved = false;
+
+        awaiter** link = &waiting_;
+        while (*link != nullptr)
+          {
+            awaiter* a = *link;
+            if (a->do_try_complete ())
+              {
+                *link = a->next_;
+                internal_ready_ (*a);
+                moved = true;
+              }
+            else
+              {
+                link = &a->next_;
+              }
+          }
+
+        return moved;
+      }
+
+      result_t
+      scheduler::internal_block_ (thread& th)
+      {
+        // The nearest time stamp when an awaiter may be ready.
+        bool timed = false;
+        clock::timestamp_t timestamp = 0;
+
+        clock::timestamp_t now = sysclock.steady_now ();
+        for (awaiter* a = waiting_; a != nullptr; a = a->next_)
+          {
+            clock::timestamp_t ts;
+            if (a->timed_)
+              {
+                ts = a->deadline_;
+              }
+            else if (a->list_ == nullptr)
+              {
+                // Checked at each tick.
+                ts = now + 1;
+              }
+            else
+              {
+                continue;
+              }
+
+            if (!timed || ts < timestamp)
+              {
+                timestamp = ts;
+                timed = true;
+              }
+          }
+
+        internal::waiting_thread_node node
+          { th };
+
+        internal::clock_timestamps_list& clock_list = sysclock.steady_list ();
+        internal::timeout_thread_node timeout_node
+          { timestamp, th };
+
+          {
+            // ----- Enter critical section -----------------------------------
+            interrupts::critical_section ics;
+
+            // A task spawned or an object posted meanwhile.
+            if (ready_head_ != nullptr)
+              {
+                return result::ok;
+              }
+            for (awaiter* a = waiting_; a != nullptr; a = a->next_)
+              {
+                if (a->do_ready ())
+                  {
+                    return result::ok;
+                  }
+              }
+
+            if (timed)
+              {
+                rtos::scheduler::internal_link_node (wake_list_, node,
+                                                     clock_list, timeout_node);
+              }
+            else
+              {
+                rtos::scheduler::internal_link_node (wake_list_, node);
+              }
+            // state::suspended set in above link().
+
+            for (awaiter* a = waiting_; a != nullptr; a = a->next_)
+              {
+                if (a->list_ != nullptr)
+                  {
+                    internal::waiting_thread_node* n =
+                        new (&a->node_) internal::waiting_thread_node
+                          { th };
+                    a->list_->link (*n);
+                  }
+              }
+            // ----- Exit critical section ------------------------------------
+          }
+
+        port::scheduler::reschedule ();
+
+          {
+            // ----- Enter critical section -----------------------------------
+            interrupts::critical_section ics;
+
+            // Remove the thread from the waiting lists, if not
+            // already removed by the object that resumed it.
+            for (awaiter* a = waiting_; a != nullptr; a = a->next_)
+              {
+                if (a->list_ != nullptr)
+                  {
+                    internal::waiting_thread_node* n =
+                        reinterpret_cast<internal::waiting_thread_node*> (a->node_);
+                    n->unlink ();
+                    n->~waiting_thread_node ();
+                  }
+              }
+            // ----- Exit critical section ------------------------------------
+          }
+
+        if (timed)
+          {
+            rtos::scheduler::internal_unlink_node (node, timeout_node);
+          }
+        else
+          {
+            rtos::scheduler::internal_unlink_node (node);
+          }
+
+        if (th.interrupted ())
+          {
+            return EINTR;
+          }
+
+        return result::ok;
+      }
+
+      /**
+       * @endcond
+       */
+
+      // ======================================================================
+
+      semaphore_awaiter::semaphore_awaiter (semaphore& sem) :
+          sem_ (sem)
+      {
+        list_ = internal_list_ (sem);
+      }
+
+      bool
+      semaphore_awaiter::do_try_complete (void)
+      {
+        res_ = sem_.try_wait ();
+        return res_ != EWOULDBLOCK;
+      }
+
+      bool
+      semaphore_awaiter::do_ready (void)
+      {
+        return sem_.value () > 0;
+      }
+
+      // ----------------------------------------------------------------------
+
+      receive_awaiter::receive_awaiter (message_queue& mq, void* msg,
+                                        std::size_t nbytes,
+                                        message_queue::priority_t* mprio) :
+          mq_ (mq), //
+          msg_ (msg), //
+          nbytes_ (nbytes), //
+          mprio_ (mprio)
+      {
+        list_ = internal_list_ (mq);
+      }
+
+      bool
+      receive_awaiter::do_try_complete (void)
+      {
+        res_ = mq_.try_receive (msg_, nbytes_, mprio_);
+        return res_ != EWOULDBLOCK;
+      }
+
+      bool
+      receive_awaiter::do_ready (void)
+      {
+        return !mq_.empty ();
+      }
+
+      // ----------------------------------------------------------------------
+
+      flags_awaiter::flags_awaiter (event_flags& evf, flags::mask_t mask,
+                                    flags::mask_t* oflags,
+                                    flags::mode_t mode) :
+          evf_ (evf), //
+          mask_ (mask), //
+          oflags_ (oflags), //
+          mode_ (mode)
+      {
+        list_ = internal_list_ (evf);
+      }
+
+      bool
+      flags_awaiter::do_try_complete (void)
+      {
+        res_ = evf_.try_wait (mask_, oflags_, mode_);
+        return res_ != EWOULDBLOCK;
+      }
+
+      bool
+      flags_awaiter::do_ready (void)
+      {
+        return internal_raised_ (evf_, mask_, mode_ & ~flags::mode::clear);
+      }
+
+      // ----------------------------------------------------------------------
+
+      sleep_awaiter::sleep_awaiter (clock::timestamp_t timestamp)
+      {
+        deadline_ = timestamp;
+        timed_ = true;
+      }
+
+      bool
+      sleep_awaiter::do_try_complete (void)
+      {
+        return sysclock.steady_now () >= deadline_;
+      }
+
+      bool
+      sleep_awaiter::do_ready (void)
+      {
+        return sysclock.steady_now () >= deadline_;
+      }
+
+    // ------------------------------------------------------------------------
+    } /* namespace co */
+  } /* namespace rtos */
+} /* namespace os */
+
+#endif /* defined(__cpp_impl_coroutine) */
+
+// ----------------------------------------------------------------------------
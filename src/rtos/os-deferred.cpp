@@ -0,0 +1,382 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/rtos/os.h>
+
+#include <memory>
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_INCLUDE_RTOS_DEFERRED)
+
+using namespace os;
+using namespace os::rtos;
+
+// ----------------------------------------------------------------------------
+
+void*
+os_deferred (thread::func_args_t args);
+
+/**
+ * @cond ignore
+ */
+
+namespace
+{
+  static_assert((OS_INTEGER_RTOS_DEFERRED_QUEUE_SIZE >= 2)
+      && ((OS_INTEGER_RTOS_DEFERRED_QUEUE_SIZE
+          & (OS_INTEGER_RTOS_DEFERRED_QUEUE_SIZE - 1)) == 0),
+      "OS_INTEGER_RTOS_DEFERRED_QUEUE_SIZE must be a power of 2");
+
+  constexpr std::size_t queue_mask = OS_INTEGER_RTOS_DEFERRED_QUEUE_SIZE - 1;
+
+  // The thread flag used to wake-up the worker.
+  constexpr flags::mask_t wakeup_flag = 1;
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+  // Bounded multi-producer queue, with a sequence number in each
+  // cell (D. Vyukov). With `lap` the position rounded down to
+  // the queue size, a cell is free for the producer that reserves
+  // position `pos` when `seq == lap`, and ready for the consumer
+  // when `seq == lap + 1`; so the zero initialised cells are all
+  // free, and `post()` may be used before the worker is created.
+  struct cell_t
+  {
+    std::size_t seq;
+    deferred::func_t func;
+    void* args;
+    clock::timestamp_t stamp;
+  };
+
+#pragma GCC diagnostic pop
+
+  cell_t cells[OS_INTEGER_RTOS_DEFERRED_QUEUE_SIZE];
+
+  // Written by producers (with CAS) and by the worker, respectively.
+  std::size_t enqueue_pos;
+  std::size_t dequeue_pos;
+
+  // Set by the worker before the last check and waiting for the flag.
+  bool worker_waiting;
+
+  thread* worker_thread;
+
+  deferred::statistics_t stats;
+
+  // Atomically raise `*dest` to `value`, ISRs may be nested.
+  void
+  update_max (uint32_t* dest, uint32_t value)
+  {
+    uint32_t old = __atomic_load_n (dest, __ATOMIC_RELAXED);
+    while (value > old
+        && !__atomic_compare_exchange_n (dest, &old, value, true,
+                                         __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+      ;
+  }
+
+  bool
+  queue_ready (void)
+  {
+    std::size_t pos = dequeue_pos;
+    return __atomic_load_n (&cells[pos & queue_mask].seq, __ATOMIC_ACQUIRE)
+        == (pos & ~queue_mask) + 1;
+  }
+
+  // Only called by the worker thread.
+  std::size_t
+  drain (void)
+  {
+    std::size_t count = 0;
+    for (;;)
+      {
+        std::size_t pos = dequeue_pos;
+        std::size_t lap = pos & ~queue_mask;
+        cell_t* cell = &cells[pos & queue_mask];
+        if (__atomic_load_n (&cell->seq, __ATOMIC_ACQUIRE) != lap + 1)
+          {
+            // Empty, or the next producer did not finish yet; it will
+            // raise the flag after publishing.
+            break;
+          }
+
+        deferred::func_t func = cell->func;
+        void* args = cell->args;
+        clock::timestamp_t stamp = cell->stamp;
+
+        // Give the cell back to the producers, one lap later.
+        __atomic_store_n (&cell->seq, lap + queue_mask + 1, __ATOMIC_RELEASE);
+        __atomic_store_n (&dequeue_pos, pos + 1, __ATOMIC_RELEASE);
+
+        // These counters are written only by the worker.
+        uint32_t latency = static_cast<uint32_t> (hrclock.now () - stamp);
+        if (latency > stats.max_latency)
+          {
+            stats.max_latency = latency;
+          }
+        stats.total_latency += latency;
+
+        func (args);
+
+        ++stats.executed;
+        ++count;
+      }
+    return count;
+  }
+}
+
+/**
+ * @endcond
+ */
+
+namespace os
+{
+  namespace rtos
+  {
+    namespace deferred
+    {
+      /**
+       * @details
+       * The call is stored in a lock-free queue, reserved with a
+       * compare and swap, so `post()` does not disable interrupts
+       * and may be nested in higher priority handlers.
+       *
+       * The worker thread is woken up only if it is waiting;
+       * while it drains the queue, posting costs no scheduler
+       * interaction.
+       *
+       * @note Can be invoked from Interrupt Service Routines.
+       */
+      result_t
+      post (func_t func, void* args)
+      {
+        os_assert_err(func != nullptr, EINVAL);
+
+        clock::timestamp_t stamp = hrclock.now ();
+
+        cell_t* cell;
+        std::size_t pos = __atomic_load_n (&enqueue_pos, __ATOMIC_RELAXED);
+        for (;;)
+          {
+            cell = &cells[pos & queue_mask];
+            std::size_t seq = __atomic_load_n (&cell->seq, __ATOMIC_ACQUIRE);
+            std::ptrdiff_t dif = static_cast<std::ptrdiff_t> (seq
+                - (pos & ~queue_mask));
+            if (dif == 0)
+              {
+                if (__atomic_compare_exchange_n (&enqueue_pos, &pos, pos + 1,
+                                                 true, __ATOMIC_RELAXED,
+                                                 __ATOMIC_RELAXED))
+                  {
+                    break;
+                  }
+                // pos was reloaded by the failed compare.
+              }
+            else if (dif < 0)
+              {
+                // The cell was not yet released by the worker.
+                __atomic_fetch_add (&stats.overflows, 1, __ATOMIC_RELAXED);
+                return EWOULDBLOCK;
+              }
+            else
+              {
+                pos = __atomic_load_n (&enqueue_pos, __ATOMIC_RELAXED);
+              }
+          }
+
+        cell->func = func;
+        cell->args = args;
+        cell->stamp = stamp;
+        __atomic_store_n (&cell->seq, (pos & ~queue_mask) + 1,
+                          __ATOMIC_RELEASE);
+
+        __atomic_fetch_add (&stats.posted, 1, __ATOMIC_RELAXED);
+        update_max (
+            &stats.max_depth,
+            static_cast<uint32_t> (pos + 1
+                - __atomic_load_n (&dequeue_pos, __ATOMIC_RELAXED)));
+
+        // Order the publication before reading the flag; matches
+        // the fence in the worker.
+        __atomic_thread_fence (__ATOMIC_SEQ_CST);
+        if (__atomic_exchange_n (&worker_waiting, false, __ATOMIC_ACQ_REL))
+          {
+            worker_thread->flags_raise (wakeup_flag);
+          }
+
+        return result::ok;
+      }
+
+      std::size_t
+      depth (void)
+      {
+        return __atomic_load_n (&enqueue_pos, __ATOMIC_ACQUIRE)
+            - __atomic_load_n (&dequeue_pos, __ATOMIC_ACQUIRE);
+      }
+
+      std::size_t
+      capacity (void)
+      {
+        return OS_INTEGER_RTOS_DEFERRED_QUEUE_SIZE;
+      }
+
+      thread*
+      worker (void)
+      {
+        return worker_thread;
+      }
+
+      /**
+       * @details
+       * The structure is copied inside an interrupts critical
+       * section, so the counters are consistent with each other.
+       */
+      void
+      statistics (statistics_t* out)
+      {
+        assert(out != nullptr);
+
+        // ----- Enter critical section ---------------------------------------
+        interrupts::critical_section ics;
+
+        *out = stats;
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      void
+      clear_statistics (void)
+      {
+        // ----- Enter critical section ---------------------------------------
+        interrupts::critical_section ics;
+
+        stats = statistics_t ();
+        // ----- Exit critical section ----------------------------------------
+      }
+
+    } /* namespace deferred */
+  } /* namespace rtos */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+/**
+ * @cond ignore
+ */
+
+#pragma GCC diagnostic push
+#if defined(__clang__)
+#pragma clang diagnostic ignored "-Wexit-time-destructors"
+#pragma clang diagnostic ignored "-Wglobal-constructors"
+#pragma clang diagnostic ignored "-Wmissing-variable-declarations"
+#endif
+
+#if defined(OS_EXCLUDE_DYNAMIC_MEMORY_ALLOCATIONS)
+
+static thread_inclusive<OS_INTEGER_RTOS_DEFERRED_STACK_SIZE_BYTES> os_deferred_thread_
+  { "deferred", os_deferred, nullptr};
+
+#else
+
+static std::unique_ptr<thread> os_deferred_thread_;
+
+#endif /* defined(OS_EXCLUDE_DYNAMIC_MEMORY_ALLOCATIONS) */
+
+#pragma GCC diagnostic pop
+
+/**
+ * @endcond
+ */
+
+void
+__attribute__((weak))
+os_startup_create_thread_deferred (void)
+{
+#if defined(OS_EXCLUDE_DYNAMIC_MEMORY_ALLOCATIONS)
+
+  // The thread object instance was created by the static constructors.
+  worker_thread = &os_deferred_thread_;
+
+#else
+
+  thread::attributes attr = thread::initializer;
+  attr.th_stack_size_bytes = OS_INTEGER_RTOS_DEFERRED_STACK_SIZE_BYTES;
+  attr.th_priority = OS_INTEGER_RTOS_DEFERRED_PRIORITY;
+
+  // No need for an explicit delete, it is deallocated by the unique_ptr.
+  os_deferred_thread_ = std::unique_ptr<thread> (
+      new thread ("deferred", os_deferred, nullptr, attr));
+
+  worker_thread = os_deferred_thread_.get ();
+
+#endif /* defined(OS_EXCLUDE_DYNAMIC_MEMORY_ALLOCATIONS) */
+}
+
+/**
+ * @details
+ * Drain the queue, then wait for the wake-up flag; when there
+ * is nothing to do, the worker is suspended and costs nothing.
+ */
+void*
+os_deferred (thread::func_args_t args __attribute__((unused)))
+{
+  // The static instance is created with the default priority.
+  this_thread::thread ().priority (OS_INTEGER_RTOS_DEFERRED_PRIORITY);
+
+  for (;;)
+    {
+      std::size_t count = drain ();
+      if (count != 0)
+        {
+          ++stats.batches;
+          if (count > stats.max_batch)
+            {
+              stats.max_batch = static_cast<uint32_t> (count);
+            }
+        }
+
+      __atomic_store_n (&worker_waiting, true, __ATOMIC_RELAXED);
+      __atomic_thread_fence (__ATOMIC_SEQ_CST);
+
+      if (queue_ready ())
+        {
+          __atomic_store_n (&worker_waiting, false, __ATOMIC_RELAXED);
+          continue;
+        }
+
+      // A flag raised after the check above is not lost, it
+      // makes the wait return immediately.
+      this_thread::flags_wait (wakeup_flag);
+    }
+
+  /* NOTREACHED */
+  return nullptr;
+}
+
+#endif /* defined(OS_INCLUDE_RTOS_DEFERRED) */
+
+// ----------------------------------------------------------------------------
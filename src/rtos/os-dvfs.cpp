@@ -0,0 +1,335 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/rtos/os.h>
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_INCLUDE_RTOS_DVFS)
+
+/**
+ * @details
+ * The default does not change the frequency, so the governor
+ * remains at the initial operating point.
+ */
+uint32_t
+__attribute__((weak))
+os_rtos_dvfs_set_frequency_hook (std::size_t level __attribute__((unused)),
+                                 uint32_t frequency_hz __attribute__((unused)))
+{
+  return 0;
+}
+
+namespace os
+{
+  namespace rtos
+  {
+    namespace dvfs
+    {
+      // ----------------------------------------------------------------------
+
+      /**
+       * @cond ignore
+       */
+
+      namespace
+      {
+        const uint32_t* table;
+        std::size_t table_levels;
+        governor* volatile current_governor;
+
+        volatile std::size_t current_level;
+
+        // The lower operating point left to the idle thread,
+        // or `table_levels` if none.
+        volatile std::size_t pending_level;
+
+        rtos::statistics::counter_t last_misses;
+
+        // Must be called with interrupts disabled.
+        bool
+        apply (std::size_t lvl)
+        {
+          uint32_t input_hz = os_rtos_dvfs_set_frequency_hook (lvl,
+                                                               table[lvl]);
+          if (input_hz == 0)
+            {
+              return false;
+            }
+
+          // The tick rate and the pending deadlines must be kept.
+          hrclock.retime (input_hz);
+          current_level = lvl;
+
+          return true;
+        }
+
+        std::size_t
+        ready_threads (void)
+        {
+#if defined(OS_INCLUDE_RTOS_SMP)
+          std::size_t count = 0;
+          for (auto&& list : scheduler::ready_threads_lists_)
+            {
+              count += list.length ();
+            }
+          return count;
+#else
+          return scheduler::ready_threads_list_.length ();
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+        }
+      }
+
+      /**
+       * @endcond
+       */
+
+      // ----------------------------------------------------------------------
+
+      ondemand_governor::ondemand_governor (uint32_t up_load,
+                                            uint32_t down_load,
+                                            std::size_t max_ready,
+                                            uint32_t hold_samples) :
+          up_load_ (up_load), //
+          down_load_ (down_load), //
+          max_ready_ (max_ready), //
+          hold_samples_ (hold_samples)
+      {
+        assert(down_load_ < up_load_);
+      }
+
+      /**
+       * @details
+       * Going straight to the highest frequency limits the time
+       * spent late; going down slowly avoids oscillations on
+       * bursty loads.
+       */
+      std::size_t
+      ondemand_governor::select (const sample_t& s, std::size_t level,
+                                 std::size_t levels)
+      {
+        if (s.load >= up_load_ || s.ready > max_ready_
+            || s.deadline_misses != 0)
+          {
+            low_samples_ = 0;
+            return levels - 1;
+          }
+
+        if (s.load_1s < down_load_)
+          {
+            if (++low_samples_ >= hold_samples_ && level > 0)
+              {
+                low_samples_ = 0;
+                return level - 1;
+              }
+          }
+        else
+          {
+            low_samples_ = 0;
+          }
+
+        return level;
+      }
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @details
+       * The hook is not called; `initial` must be the operating
+       * point set by the startup code.
+       *
+       * @warning Cannot be invoked from Interrupt Service Routines.
+       */
+      result_t
+      start (const uint32_t* frequencies_hz, std::size_t levels,
+             governor& gov, std::size_t initial)
+      {
+        os_assert_err(!interrupts::in_handler_mode (), EPERM);
+        os_assert_err(frequencies_hz != nullptr && levels > 0, EINVAL);
+        os_assert_err(initial < levels, EINVAL);
+
+        // ----- Enter critical section ---------------------------------------
+        interrupts::critical_section ics;
+
+        table = frequencies_hz;
+        table_levels = levels;
+        current_level = initial;
+        pending_level = levels;
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
+        last_misses = scheduler::edf::deadline_misses ();
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_EDF) */
+        current_governor = &gov;
+
+        return result::ok;
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      void
+      stop (void)
+      {
+        // ----- Enter critical section ---------------------------------------
+        interrupts::critical_section ics;
+
+        current_governor = nullptr;
+        pending_level = table_levels;
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      std::size_t
+      level (void)
+      {
+        return current_level;
+      }
+
+      /**
+       * @warning Cannot be invoked from Interrupt Service Routines.
+       */
+      result_t
+      level (std::size_t lvl)
+      {
+        os_assert_err(!interrupts::in_handler_mode (), EPERM);
+
+        // ----- Enter critical section ---------------------------------------
+        interrupts::critical_section ics;
+
+        if (table == nullptr)
+          {
+            return EAGAIN;
+          }
+        if (lvl >= table_levels)
+          {
+            return EINVAL;
+          }
+
+        pending_level = table_levels;
+        if (lvl != current_level && !apply (lvl))
+          {
+            return EIO;
+          }
+
+        return result::ok;
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      uint32_t
+      frequency (void)
+      {
+        // ----- Enter critical section ---------------------------------------
+        interrupts::critical_section ics;
+
+        if (table == nullptr)
+          {
+            return 0;
+          }
+        return table[current_level];
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      /**
+       * @cond ignore
+       */
+
+      // Called from the system tick, after each CPU load sample.
+      void
+      internal_sample_ (void)
+      {
+        governor* gov = current_governor;
+        if (gov == nullptr)
+          {
+            return;
+          }
+
+        sample_t s;
+        s.load = scheduler::statistics::cpu_load (
+            scheduler::statistics::load_window::ms_100);
+        s.load_1s = scheduler::statistics::cpu_load (
+            scheduler::statistics::load_window::s_1);
+        s.deadline_misses = 0;
+
+        // ----- Enter critical section ---------------------------------------
+        interrupts::critical_section ics;
+
+        s.ready = ready_threads ();
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
+        rtos::statistics::counter_t misses = scheduler::edf::deadline_misses ();
+        s.deadline_misses = static_cast<uint32_t> (misses - last_misses);
+        last_misses = misses;
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_EDF) */
+
+        std::size_t lvl = gov->select (s, current_level, table_levels);
+        assert(lvl < table_levels);
+
+        if (lvl > current_level)
+          {
+            // Faster at once.
+            pending_level = table_levels;
+            apply (lvl);
+          }
+        else if (lvl < current_level)
+          {
+            // Slower when idle.
+            pending_level = lvl;
+          }
+        else
+          {
+            pending_level = table_levels;
+          }
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      // Called by the idle thread, before sleeping.
+      void
+      internal_idle_ (void)
+      {
+        if (pending_level >= table_levels)
+          {
+            return;
+          }
+
+        // ----- Enter critical section ---------------------------------------
+        interrupts::critical_section ics;
+
+        std::size_t lvl = pending_level;
+        if (lvl < table_levels)
+          {
+            pending_level = table_levels;
+            apply (lvl);
+          }
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      /**
+       * @endcond
+       */
+
+    } /* namespace dvfs */
+  } /* namespace rtos */
+} /* namespace os */
+
+#endif /* defined(OS_INCLUDE_RTOS_DVFS) */
+
+// ----------------------------------------------------------------------------
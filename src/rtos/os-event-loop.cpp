@@ -0,0 +1,515 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/rtos/os-event-loop.h>
+
+#include <new>
+
+// ----------------------------------------------------------------------------
+
+/**
+ * @cond ignore
+ */
+
+namespace
+{
+  // The thread flag used to wake-up the loop, without a poller.
+  constexpr os::rtos::flags::mask_t wakeup_flag = 1;
+}
+
+/**
+ * @endcond
+ */
+
+namespace os
+{
+  namespace rtos
+  {
+    // ------------------------------------------------------------------------
+
+    /**
+     * @class event_loop
+     * @details
+     * The loop thread repeatedly drains the posted calls, runs
+     * the expired timers and checks the poller, without blocking;
+     * when there is nothing left, it waits until the nearest
+     * timer deadline, a new post, or an event of the poller.
+     *
+     * The calls are stored in a lock-free queue, with a sequence
+     * number in each cell (D. Vyukov), as the deferred calls, so
+     * `post()` does not disable interrupts; the loop is woken up
+     * only if it is waiting.
+     *
+     * The timers are kept in a binary min-heap, ordered by deadline,
+     * so starting, stopping and expiring a timer take a time
+     * proportional to the logarithm of the number of timers.
+     */
+
+    /**
+     * @details
+     * The periodic timers which missed a period, because the loop
+     * was busy, are not run twice; the next deadline is
+     * one period after the current time.
+     *
+     * @note The timer must be stopped before it is destroyed;
+     *  if stopped by another thread while the loop runs it,
+     *  its function may still be called once.
+     */
+    event_loop::timer::timer (func_t func, void* args) :
+        func_ (func), //
+        args_ (args)
+    {
+    }
+
+    // ------------------------------------------------------------------------
+
+    event_loop::event_loop (const char* name) :
+        object_named_system
+          { name }
+    {
+    }
+
+    /**
+     * @details
+     * The function is called by the loop thread, in the
+     * order the calls were posted.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    result_t
+    event_loop::post (func_t func, void* args)
+    {
+      os_assert_err(func != nullptr, EINVAL);
+
+      cell_t* cell;
+      std::size_t pos = __atomic_load_n (&enqueue_pos_, __ATOMIC_RELAXED);
+      for (;;)
+        {
+          cell = &cells_[pos & mask_];
+          std::size_t seq = __atomic_load_n (&cell->seq, __ATOMIC_ACQUIRE);
+          std::ptrdiff_t dif = static_cast<std::ptrdiff_t> (seq
+              - (pos & ~mask_));
+          if (dif == 0)
+            {
+              if (__atomic_compare_exchange_n (&enqueue_pos_, &pos, pos + 1,
+                                               true, __ATOMIC_RELAXED,
+                                               __ATOMIC_RELAXED))
+                {
+                  break;
+                }
+              // pos was reloaded by the failed compare.
+            }
+          else if (dif < 0)
+            {
+              // The cell was not yet released by the loop.
+              return EWOULDBLOCK;
+            }
+          else
+            {
+              pos = __atomic_load_n (&enqueue_pos_, __ATOMIC_RELAXED);
+            }
+        }
+
+      cell->func = func;
+      cell->args = args;
+      __atomic_store_n (&cell->seq, (pos & ~mask_) + 1, __ATOMIC_RELEASE);
+
+      // Order the publication before reading the flag; matches
+      // the fence in the loop.
+      __atomic_thread_fence (__ATOMIC_SEQ_CST);
+      if (__atomic_exchange_n (&waiting_, false, __ATOMIC_ACQ_REL))
+        {
+          internal_wakeup_ ();
+        }
+
+      return result::ok;
+    }
+
+    /**
+     * @details
+     * The deadline is computed from the current time of the
+     * system clock. A started timer is restarted with the new values.
+     *
+     * Timers can be started by any thread, including from the
+     * callbacks of the loop; from interrupts, post a call that
+     * starts the timer.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    event_loop::start (timer& t, clock::duration_t delay,
+                       clock::duration_t period)
+    {
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+
+      bool nearest;
+        {
+          // ----- Enter critical section -------------------------------------
+          scheduler::critical_section scs;
+
+          if (t.index_ != timer::not_queued)
+            {
+              internal_heap_remove_ (&t);
+            }
+          else if (heap_count_ >= heap_size_)
+            {
+              return ENOMEM;
+            }
+
+          t.deadline_ = sysclock.steady_now () + delay;
+          t.period_ = period;
+          internal_heap_insert_ (&t);
+
+          nearest = (t.index_ == 0);
+          // ----- Exit critical section --------------------------------------
+        }
+
+      // The waiting loop must compute the timeout again.
+      if (nearest && __atomic_exchange_n (&waiting_, false, __ATOMIC_ACQ_REL))
+        {
+          internal_wakeup_ ();
+        }
+
+      return result::ok;
+    }
+
+    /**
+     * @details
+     * The loop is not woken up; at worst it wakes at the
+     * old deadline and finds nothing to do.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    event_loop::stop (timer& t)
+    {
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+
+      // ----- Enter critical section -----------------------------------------
+      scheduler::critical_section scs;
+
+      if (t.index_ == timer::not_queued)
+        {
+          return EAGAIN;
+        }
+
+      internal_heap_remove_ (&t);
+      return result::ok;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    /**
+     * @cond ignore
+     */
+
+    void
+    event_loop::internal_construct_ (cell_t* cells, std::size_t cells_count,
+                                     timer** heap, std::size_t heap_size,
+                                     poller* p, void* stack,
+                                     std::size_t stack_size_bytes,
+                                     thread::priority_t prio)
+    {
+      // With `lap` the position rounded down to the queue size,
+      // a cell is free for the producer that reserves position
+      // `pos` when `seq == lap`, so all cells start free.
+      for (std::size_t i = 0; i < cells_count; ++i)
+        {
+          cells[i].seq = 0;
+        }
+      cells_ = cells;
+      mask_ = cells_count - 1;
+
+      heap_ = heap;
+      heap_size_ = heap_size;
+
+      poller_ = p;
+
+      thread::attributes attr;
+      attr.th_priority = prio;
+      attr.th_stack_address = stack;
+      attr.th_stack_size_bytes = stack_size_bytes;
+
+      thread_ = new (&thread_storage_) thread
+        { name (), internal_run_, this, attr };
+    }
+
+    void
+    event_loop::internal_destruct_ (void)
+    {
+      stopping_ = true;
+      internal_wakeup_ ();
+
+      thread_->join ();
+      thread_->~thread ();
+      thread_ = nullptr;
+    }
+
+    void
+    event_loop::internal_wakeup_ (void)
+    {
+      if (poller_ != nullptr)
+        {
+          poller_->wakeup ();
+        }
+      else
+        {
+          thread_->flags_raise (wakeup_flag);
+        }
+    }
+
+    bool
+    event_loop::internal_queue_ready_ (void)
+    {
+      std::size_t pos = dequeue_pos_;
+      return __atomic_load_n (&cells_[pos & mask_].seq, __ATOMIC_ACQUIRE)
+          == (pos & ~mask_) + 1;
+    }
+
+    // Only called by the loop thread.
+    std::size_t
+    event_loop::internal_drain_ (void)
+    {
+      std::size_t count = 0;
+      for (;;)
+        {
+          std::size_t pos = dequeue_pos_;
+          std::size_t lap = pos & ~mask_;
+          cell_t* cell = &cells_[pos & mask_];
+          if (__atomic_load_n (&cell->seq, __ATOMIC_ACQUIRE) != lap + 1)
+            {
+              // Empty, or the next producer did not finish yet; it
+              // will wake the loop after publishing.
+              break;
+            }
+
+          func_t func = cell->func;
+          void* args = cell->args;
+
+          // Give the cell back to the producers, one lap later.
+          __atomic_store_n (&cell->seq, lap + mask_ + 1, __ATOMIC_RELEASE);
+          __atomic_store_n (&dequeue_pos_, pos + 1, __ATOMIC_RELEASE);
+
+          func (args);
+          ++count;
+        }
+      return count;
+    }
+
+    // Run the first timer, if expired.
+    bool
+    event_loop::internal_fire_timer_ (clock::timestamp_t now)
+    {
+      timer* t;
+        {
+          // ----- Enter critical section -------------------------------------
+          scheduler::critical_section scs;
+
+          if (heap_count_ == 0 || heap_[0]->deadline_ > now)
+            {
+              return false;
+            }
+
+          t = heap_[0];
+          internal_heap_remove_ (t);
+
+          if (t->period_ != 0)
+            {
+              // Skip the missed periods, if any.
+              t->deadline_ += t->period_;
+              if (t->deadline_ <= now)
+                {
+                  t->deadline_ = now + t->period_;
+                }
+              internal_heap_insert_ (t);
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+
+      t->func_ (t->args_);
+      return true;
+    }
+
+    void
+    event_loop::internal_heap_place_ (timer* t, std::size_t index)
+    {
+      heap_[index] = t;
+      t->index_ = index;
+    }
+
+    void
+    event_loop::internal_heap_insert_ (timer* t)
+    {
+      std::size_t i = heap_count_++;
+      while (i > 0)
+        {
+          std::size_t parent = (i - 1) / 2;
+          if (heap_[parent]->deadline_ <= t->deadline_)
+            {
+              break;
+            }
+          internal_heap_place_ (heap_[parent], i);
+          i = parent;
+        }
+      internal_heap_place_ (t, i);
+    }
+
+    void
+    event_loop::internal_heap_remove_ (timer* t)
+    {
+      std::size_t i = t->index_;
+      t->index_ = timer::not_queued;
+
+      --heap_count_;
+      if (i == heap_count_)
+        {
+          return;
+        }
+
+      // Move the last timer in the hole, up or down.
+      timer* last = heap_[heap_count_];
+      while (i > 0)
+        {
+          std::size_t parent = (i - 1) / 2;
+          if (heap_[parent]->deadline_ <= last->deadline_)
+            {
+              break;
+            }
+          internal_heap_place_ (heap_[parent], i);
+          i = parent;
+        }
+      for (;;)
+        {
+          std::size_t child = 2 * i + 1;
+          if (child >= heap_count_)
+            {
+              break;
+            }
+          if ((child + 1 < heap_count_)
+              && (heap_[child + 1]->deadline_ < heap_[child]->deadline_))
+            {
+              ++child;
+            }
+          if (last->deadline_ <= heap_[child]->deadline_)
+            {
+              break;
+            }
+          internal_heap_place_ (heap_[child], i);
+          i = child;
+        }
+      internal_heap_place_ (last, i);
+    }
+
+    void*
+    event_loop::internal_run_ (void* args)
+    {
+      event_loop* self = static_cast<event_loop*> (args);
+
+      while (!self->stopping_)
+        {
+          self->internal_drain_ ();
+
+          clock::timestamp_t now = sysclock.steady_now ();
+          while (self->internal_fire_timer_ (now))
+            {
+              ;
+            }
+
+          if (self->poller_ != nullptr)
+            {
+              // The ready descriptors, without blocking.
+              self->poller_->wait (0);
+            }
+
+          __atomic_store_n (&self->waiting_, true, __ATOMIC_RELAXED);
+          __atomic_thread_fence (__ATOMIC_SEQ_CST);
+
+          // Computed after the flag is set, a timer started
+          // meanwhile wakes the loop.
+          clock::duration_t timeout = forever;
+            {
+              // ----- Enter critical section ---------------------------------
+              scheduler::critical_section scs;
+
+              if (self->heap_count_ != 0)
+                {
+                  clock::timestamp_t deadline = self->heap_[0]->deadline_;
+                  now = sysclock.steady_now ();
+                  if (deadline <= now)
+                    {
+                      timeout = 0;
+                    }
+                  else if (deadline - now < forever)
+                    {
+                      timeout = static_cast<clock::duration_t> (deadline - now);
+                    }
+                  else
+                    {
+                      timeout = forever - 1;
+                    }
+                }
+              // ----- Exit critical section ----------------------------------
+            }
+
+          if (timeout == 0 || self->internal_queue_ready_ ()
+              || self->stopping_)
+            {
+              __atomic_store_n (&self->waiting_, false, __ATOMIC_RELAXED);
+              continue;
+            }
+
+          // A wakeup after the checks above is not lost, it
+          // makes the wait return immediately.
+          if (self->poller_ != nullptr)
+            {
+              self->poller_->wait (timeout);
+            }
+          else if (timeout == forever)
+            {
+              this_thread::flags_wait (wakeup_flag);
+            }
+          else
+            {
+              this_thread::flags_timed_wait (wakeup_flag, timeout);
+            }
+
+          __atomic_store_n (&self->waiting_, false, __ATOMIC_RELAXED);
+        }
+
+      return nullptr;
+    }
+
+    /**
+     * @endcond
+     */
+
+  // --------------------------------------------------------------------------
+  } /* namespace rtos */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
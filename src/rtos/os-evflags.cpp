@@ -33,6 +33,65 @@ namespace os
 {
   namespace rtos
   {
+#if defined(OS_INCLUDE_RTOS_EVENT_FLAGS_MASKED_WAKEUP) \
+  && !defined(OS_USE_RTOS_PORT_EVENT_FLAGS)
+
+    /**
+     * @cond ignore
+     */
+
+    namespace
+    {
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+      // A waiting node that also remembers what the thread waits for,
+      // so that `raise()` can skip the threads it does not satisfy.
+      class flags_waiting_node : public internal::waiting_thread_node
+      {
+      public:
+
+        flags_waiting_node (thread& th, flags::mask_t mask,
+                            flags::mode_t mode) :
+            internal::waiting_thread_node
+              { th }, //
+            mask_ (mask), //
+            mode_ (mode)
+        {
+          ;
+        }
+
+        flags::mask_t mask_;
+        flags::mode_t mode_;
+      };
+
+#pragma GCC diagnostic pop
+
+      // Same conditions as `internal::event_flags::check_raised()`,
+      // without consuming the flags.
+      bool
+      is_satisfied (internal::waiting_thread_node& node, void* args)
+      {
+        flags_waiting_node& fn = static_cast<flags_waiting_node&> (node);
+        flags::mask_t current = *static_cast<flags::mask_t*> (args);
+
+        if (fn.mask_ == flags::any)
+          {
+            return current != 0;
+          }
+        return (((fn.mode_ & flags::mode::all) != 0)
+            && ((current & fn.mask_) == fn.mask_))
+            || (((fn.mode_ & flags::mode::any) != 0)
+                && ((current & fn.mask_) != 0));
+      }
+    }
+
+    /**
+     * @endcond
+     */
+
+#endif /* defined(OS_INCLUDE_RTOS_EVENT_FLAGS_MASKED_WAKEUP) */
+
     // ------------------------------------------------------------------------
 
     /**
@@ -158,7 +217,8 @@ namespace os
           { name }
     {
 #if defined(OS_TRACE_RTOS_EVFLAGS)
-      trace::printf ("%s() @%p %s\n", __func__, this, this->name ());
+      OS_TRACE_PRINTF (rtos_evflags, "%s() @%p %s\n", __func__, this,
+                       this->name ());
 #endif
 
       // Don't call this from interrupt handlers.
@@ -176,6 +236,9 @@ namespace os
 
 #endif
 
+#if defined(OS_INCLUDE_RTOS_OBJECT_REGISTRY)
+      registry::internal_insert (this, registry::type::event_flags);
+#endif /* defined(OS_INCLUDE_RTOS_OBJECT_REGISTRY) */
     }
 
 #pragma GCC diagnostic pop
@@ -196,9 +259,13 @@ namespace os
     event_flags::~event_flags ()
     {
 #if defined(OS_TRACE_RTOS_EVFLAGS)
-      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+      OS_TRACE_PRINTF (rtos_evflags, "%s() @%p %s\n", __func__, this, name ());
 #endif
 
+#if defined(OS_INCLUDE_RTOS_OBJECT_REGISTRY)
+      registry::internal_erase (this, registry::type::event_flags);
+#endif /* defined(OS_INCLUDE_RTOS_OBJECT_REGISTRY) */
+
 #if defined(OS_USE_RTOS_PORT_EVENT_FLAGS)
 
       port::event_flags::destroy (this);
@@ -207,6 +274,9 @@ namespace os
 
       // There must be no threads waiting for these flags.
       assert(list_.empty ());
+#if defined(OS_INCLUDE_RTOS_EVENT_FLAGS_MASKED_WAKEUP)
+      assert(masked_list_.empty ());
+#endif /* defined(OS_INCLUDE_RTOS_EVENT_FLAGS_MASKED_WAKEUP) */
 
 #endif
     }
@@ -236,9 +306,13 @@ namespace os
     event_flags::wait (flags::mask_t mask, flags::mask_t* oflags,
                        flags::mode_t mode)
     {
+#if defined(OS_INCLUDE_RTOS_TRACE_EVENTS)
+      os_rtos_trace_object (os_rtos_trace_evflags_wait, this);
+#endif /* defined(OS_INCLUDE_RTOS_TRACE_EVENTS) */
+
 #if defined(OS_TRACE_RTOS_EVFLAGS)
-      trace::printf ("%s(0x%X,%u) @%p %s <0x%X\n", __func__, mask, mode, this,
-                     name (), event_flags_.mask ());
+      OS_TRACE_PRINTF (rtos_evflags, "%s(0x%X,%u) @%p %s <0x%X\n", __func__,
+                       mask, mode, this, name (), event_flags_.mask ());
 #endif
 
       // Don't call this from interrupt handlers.
@@ -259,8 +333,9 @@ namespace os
           if (event_flags_.check_raised (mask, oflags, mode))
             {
 #if defined(OS_TRACE_RTOS_EVFLAGS)
-              trace::printf ("%s(0x%X,%u) @%p %s >0x%X\n", __func__, mask, mode,
-                             this, name (), event_flags_.mask ());
+              OS_TRACE_PRINTF (rtos_evflags, "%s(0x%X,%u) @%p %s >0x%X\n",
+                               __func__, mask, mode, this, name (),
+                               event_flags_.mask ());
 #endif
               return result::ok;
             }
@@ -272,8 +347,15 @@ namespace os
       // Prepare a list node pointing to the current thread.
       // Do not worry for being on stack, it is temporarily linked to the
       // list and guaranteed to be removed before this function returns.
+#if defined(OS_INCLUDE_RTOS_EVENT_FLAGS_MASKED_WAKEUP)
+      flags_waiting_node node
+        { crt_thread, mask, mode };
+      internal::waiting_threads_list& wait_list = masked_list_;
+#else
       internal::waiting_thread_node node
         { crt_thread };
+      internal::waiting_threads_list& wait_list = list_;
+#endif /* defined(OS_INCLUDE_RTOS_EVENT_FLAGS_MASKED_WAKEUP) */
 
       for (;;)
         {
@@ -284,14 +366,15 @@ namespace os
               if (event_flags_.check_raised (mask, oflags, mode))
                 {
 #if defined(OS_TRACE_RTOS_EVFLAGS)
-                  trace::printf ("%s(0x%X,%u) @%p %s >0x%X\n", __func__, mask,
-                                 mode, this, name (), event_flags_.mask ());
+                  OS_TRACE_PRINTF (rtos_evflags, "%s(0x%X,%u) @%p %s >0x%X\n",
+                                   __func__, mask, mode, this, name (),
+                                   event_flags_.mask ());
 #endif
                   return result::ok;
                 }
 
               // Add this thread to the event flags waiting list.
-              scheduler::internal_link_node (list_, node);
+              scheduler::internal_link_node (wait_list, node);
               // state::suspended set in above link().
               // ----- Exit critical section ----------------------------------
             }
@@ -311,8 +394,8 @@ namespace os
           if (crt_thread.interrupted ())
             {
 #if defined(OS_TRACE_RTOS_EVFLAGS)
-              trace::printf ("%s(0x%X,%u) EINTR @%p %s\n", __func__, mask, mode,
-                             this, name ());
+              OS_TRACE_PRINTF (rtos_evflags, "%s(0x%X,%u) EINTR @%p %s\n",
+                               __func__, mask, mode, this, name ());
 #endif
               return EINTR;
             }
@@ -339,9 +422,13 @@ namespace os
     event_flags::try_wait (flags::mask_t mask, flags::mask_t* oflags,
                            flags::mode_t mode)
     {
+#if defined(OS_INCLUDE_RTOS_TRACE_EVENTS)
+      os_rtos_trace_object (os_rtos_trace_evflags_wait, this);
+#endif /* defined(OS_INCLUDE_RTOS_TRACE_EVENTS) */
+
 #if defined(OS_TRACE_RTOS_EVFLAGS)
-      trace::printf ("%s(0x%X,%u) @%p %s <0x%X\n", __func__, mask, mode, this,
-                     name (), event_flags_.mask ());
+      OS_TRACE_PRINTF (rtos_evflags, "%s(0x%X,%u) @%p %s <0x%X\n", __func__,
+                       mask, mode, this, name (), event_flags_.mask ());
 #endif
 
 #if defined(OS_USE_RTOS_PORT_EVENT_FLAGS)
@@ -360,16 +447,18 @@ namespace os
           if (event_flags_.check_raised (mask, oflags, mode))
             {
 #if defined(OS_TRACE_RTOS_EVFLAGS)
-              trace::printf ("%s(0x%X,%u) @%p %s >0x%X\n", __func__, mask, mode,
-                             this, name (), event_flags_.mask ());
+              OS_TRACE_PRINTF (rtos_evflags, "%s(0x%X,%u) @%p %s >0x%X\n",
+                               __func__, mask, mode, this, name (),
+                               event_flags_.mask ());
 #endif
               return result::ok;
             }
           else
             {
 #if defined(OS_TRACE_RTOS_EVFLAGS)
-              trace::printf ("%s(0x%X,%u) EWOULDBLOCK @%p %s \n", __func__,
-                             mask, mode, this, name ());
+              OS_TRACE_PRINTF (rtos_evflags,
+                               "%s(0x%X,%u) EWOULDBLOCK @%p %s \n", __func__,
+                               mask, mode, this, name ());
 #endif
               return EWOULDBLOCK;
             }
@@ -421,9 +510,14 @@ namespace os
     event_flags::timed_wait (flags::mask_t mask, clock::duration_t timeout,
                              flags::mask_t* oflags, flags::mode_t mode)
     {
+#if defined(OS_INCLUDE_RTOS_TRACE_EVENTS)
+      os_rtos_trace_object (os_rtos_trace_evflags_wait, this);
+#endif /* defined(OS_INCLUDE_RTOS_TRACE_EVENTS) */
+
 #if defined(OS_TRACE_RTOS_EVFLAGS)
-      trace::printf ("%s(0x%X,%u,%u) @%p %s <0x%X\n", __func__, mask, timeout,
-                     mode, this, name (), event_flags_.mask ());
+      OS_TRACE_PRINTF (rtos_evflags, "%s(0x%X,%u,%u) @%p %s <0x%X\n", __func__,
+                       mask, timeout, mode, this, name (),
+                       event_flags_.mask ());
 #endif
 
       // Don't call this from interrupt handlers.
@@ -446,9 +540,78 @@ namespace os
           if (event_flags_.check_raised (mask, oflags, mode))
             {
 #if defined(OS_TRACE_RTOS_EVFLAGS)
-              trace::printf ("%s(0x%X,%u,%u) @%p %s >0x%X\n", __func__, mask,
-                             timeout, mode, this, name (),
-                             event_flags_.mask ());
+              OS_TRACE_PRINTF (rtos_evflags, "%s(0x%X,%u,%u) @%p %s >0x%X\n",
+                               __func__, mask, timeout, mode, this, name (),
+                               event_flags_.mask ());
+#endif
+              return result::ok;
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+
+      return timed_wait_until (mask, clock_->steady_now () + timeout, oflags,
+                               mode);
+
+#endif
+    }
+
+    /**
+     * @details
+     * Like `timed_wait()`, but the timeout expires when the
+     * steady time of the event flags clock reaches the absolute
+     * `timestamp`. The time stamp is linked as is in the clock
+     * list, so retry loops that keep the same deadline do not
+     * accumulate the time spent between the calls.
+     *
+     * If the time stamp is in the past, the condition is still
+     * tried once, and the function returns `ETIMEDOUT` only if
+     * the flags are not already raised.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    event_flags::timed_wait_until (flags::mask_t mask,
+                                   clock::timestamp_t timestamp,
+                                   flags::mask_t* oflags, flags::mode_t mode)
+    {
+#if defined(OS_INCLUDE_RTOS_TRACE_EVENTS)
+      os_rtos_trace_object (os_rtos_trace_evflags_wait, this);
+#endif /* defined(OS_INCLUDE_RTOS_TRACE_EVENTS) */
+
+#if defined(OS_TRACE_RTOS_EVFLAGS)
+      OS_TRACE_PRINTF (rtos_evflags, "%s(0x%X,%u,%u) @%p %s <0x%X\n", __func__,
+                       mask, static_cast<unsigned int> (timestamp), mode, this,
+                       name (), event_flags_.mask ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_throw(!interrupts::in_handler_mode (), EPERM);
+      // Don't call this from critical regions.
+      os_assert_throw(!scheduler::locked (), EPERM);
+
+#if defined(OS_USE_RTOS_PORT_EVENT_FLAGS)
+
+      clock::timestamp_t nw = clock_->steady_now ();
+      return port::event_flags::timed_wait (
+          this, mask,
+          (timestamp > nw) ? static_cast<clock::duration_t> (timestamp - nw) : 0,
+          oflags, mode);
+
+#else
+
+      // Extra test before entering the loop, with its inherent weight.
+      // Trade size for speed.
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          if (event_flags_.check_raised (mask, oflags, mode))
+            {
+#if defined(OS_TRACE_RTOS_EVFLAGS)
+              OS_TRACE_PRINTF (rtos_evflags, "%s(0x%X,%u,%u) @%p %s >0x%X\n",
+                               __func__, mask,
+                               static_cast<unsigned int> (timestamp), mode,
+                               this, name (), event_flags_.mask ());
 #endif
               return result::ok;
             }
@@ -457,14 +620,27 @@ namespace os
 
       thread& crt_thread = this_thread::thread ();
 
+      if (clock_->steady_now () > timestamp)
+        {
+          // The deadline already passed, do not wait for the next tick.
+          return ETIMEDOUT;
+        }
+
       // Prepare a list node pointing to the current thread.
       // Do not worry for being on stack, it is temporarily linked to the
       // list and guaranteed to be removed before this function returns.
+#if defined(OS_INCLUDE_RTOS_EVENT_FLAGS_MASKED_WAKEUP)
+      flags_waiting_node node
+        { crt_thread, mask, mode };
+      internal::waiting_threads_list& wait_list = masked_list_;
+#else
       internal::waiting_thread_node node
         { crt_thread };
+      internal::waiting_threads_list& wait_list = list_;
+#endif /* defined(OS_INCLUDE_RTOS_EVENT_FLAGS_MASKED_WAKEUP) */
 
       internal::clock_timestamps_list& clock_list = clock_->steady_list ();
-      clock::timestamp_t timeout_timestamp = clock_->steady_now () + timeout;
+      clock::timestamp_t timeout_timestamp = timestamp;
 
       // Prepare a timeout node pointing to the current thread.
       internal::timeout_thread_node timeout_node
@@ -479,16 +655,17 @@ namespace os
               if (event_flags_.check_raised (mask, oflags, mode))
                 {
 #if defined(OS_TRACE_RTOS_EVFLAGS)
-                  trace::printf ("%s(0x%X,%u,%u) @%p %s >0x%X\n", __func__,
-                                 mask, timeout, mode, this, name (),
-                                 event_flags_.mask ());
+                  OS_TRACE_PRINTF (rtos_evflags,
+                                   "%s(0x%X,%u,%u) @%p %s >0x%X\n", __func__,
+                                   mask, static_cast<unsigned int> (timestamp),
+                                   mode, this, name (), event_flags_.mask ());
 #endif
                   return result::ok;
                 }
 
               // Add this thread to the event flags waiting list,
               // and the clock timeout list.
-              scheduler::internal_link_node (list_, node, clock_list,
+              scheduler::internal_link_node (wait_list, node, clock_list,
                                              timeout_node);
               // state::suspended set in above link().
               // ----- Exit critical section ----------------------------------
@@ -504,8 +681,10 @@ namespace os
           if (crt_thread.interrupted ())
             {
 #if defined(OS_TRACE_RTOS_EVFLAGS)
-              trace::printf ("%s(0x%X,%u,%u) EINTR @%p %s 0x%X \n", __func__,
-                             mask, timeout, mode, this, name ());
+              OS_TRACE_PRINTF (rtos_evflags,
+                               "%s(0x%X,%u,%u) EINTR @%p %s 0x%X \n", __func__,
+                               mask, static_cast<unsigned int> (timestamp),
+                               mode, this, name ());
 #endif
               return EINTR;
             }
@@ -513,8 +692,11 @@ namespace os
           if (clock_->steady_now () >= timeout_timestamp)
             {
 #if defined(OS_TRACE_RTOS_EVFLAGS)
-              trace::printf ("%s(0x%X,%u,%u) ETIMEDOUT @%p %s 0x%X \n",
-                             __func__, mask, timeout, mode, this, name ());
+              OS_TRACE_PRINTF (rtos_evflags,
+                               "%s(0x%X,%u,%u) ETIMEDOUT @%p %s 0x%X \n",
+                               __func__, mask,
+                               static_cast<unsigned int> (timestamp), mode,
+                               this, name ());
 #endif
               return ETIMEDOUT;
             }
@@ -537,9 +719,13 @@ namespace os
     result_t
     event_flags::raise (flags::mask_t mask, flags::mask_t* oflags)
     {
+#if defined(OS_INCLUDE_RTOS_TRACE_EVENTS)
+      os_rtos_trace_object (os_rtos_trace_evflags_raise, this);
+#endif /* defined(OS_INCLUDE_RTOS_TRACE_EVENTS) */
+
 #if defined(OS_TRACE_RTOS_EVFLAGS)
-      trace::printf ("%s(0x%X) @%p %s <0x%X \n", __func__, mask, this, name (),
-                     event_flags_.mask ());
+      OS_TRACE_PRINTF (rtos_evflags, "%s(0x%X) @%p %s <0x%X \n", __func__, mask,
+                       this, name (), event_flags_.mask ());
 #endif
 
 #if defined(OS_USE_RTOS_PORT_EVENT_FLAGS)
@@ -557,9 +743,17 @@ namespace os
       // the list is protected by inner `resume_one()`.
       list_.resume_all ();
 
+#if defined(OS_INCLUDE_RTOS_EVENT_FLAGS_MASKED_WAKEUP)
+      // Wake-up only the threads whose condition is now met;
+      // with `flags::mode::clear` the first of them may still
+      // consume the flags, and the others will wait again.
+      flags::mask_t current = event_flags_.mask ();
+      masked_list_.resume_if (is_satisfied, &current);
+#endif /* defined(OS_INCLUDE_RTOS_EVENT_FLAGS_MASKED_WAKEUP) */
+
 #if defined(OS_TRACE_RTOS_EVFLAGS)
-      trace::printf ("%s(0x%X) @%p %s >0x%X\n", __func__, mask, this, name (),
-                     event_flags_.mask ());
+      OS_TRACE_PRINTF (rtos_evflags, "%s(0x%X) @%p %s >0x%X\n", __func__, mask,
+                       this, name (), event_flags_.mask ());
 #endif
       return res;
 
@@ -575,8 +769,8 @@ namespace os
     event_flags::clear (flags::mask_t mask, flags::mask_t* oflags)
     {
 #if defined(OS_TRACE_RTOS_EVFLAGS)
-      trace::printf ("%s(0x%X) @%p %s <0x%X \n", __func__, mask, this, name (),
-                     event_flags_.mask ());
+      OS_TRACE_PRINTF (rtos_evflags, "%s(0x%X) @%p %s <0x%X \n", __func__, mask,
+                       this, name (), event_flags_.mask ());
 #endif
 
 #if defined(OS_USE_RTOS_PORT_EVENT_FLAGS)
@@ -590,8 +784,8 @@ namespace os
       result_t res = event_flags_.clear (mask, oflags);
 
 #if defined(OS_TRACE_RTOS_EVFLAGS)
-      trace::printf ("%s(0x%X) @%p %s >0x%X\n", __func__, mask, this, name (),
-                     event_flags_.mask ());
+      OS_TRACE_PRINTF (rtos_evflags, "%s(0x%X) @%p %s >0x%X\n", __func__, mask,
+                       this, name (), event_flags_.mask ());
 #endif
 
       return res;
@@ -614,7 +808,8 @@ namespace os
     event_flags::get (flags::mask_t mask, flags::mode_t mode)
     {
 #if defined(OS_TRACE_RTOS_EVFLAGS)
-      trace::printf ("%s(0x%X) @%p %s  \n", __func__, mask, this, name ());
+      OS_TRACE_PRINTF (rtos_evflags, "%s(0x%X) @%p %s  \n", __func__, mask,
+                       this, name ());
 #endif
 
 #if defined(OS_USE_RTOS_PORT_EVENT_FLAGS)
@@ -626,8 +821,8 @@ namespace os
       flags::mask_t ret = event_flags_.get (mask, mode);
 
 #if defined(OS_TRACE_RTOS_EVFLAGS)
-      trace::printf ("%s(0x%X)=0x%X @%p %s \n", __func__, mask,
-                     event_flags_.mask (), this, name ());
+      OS_TRACE_PRINTF (rtos_evflags, "%s(0x%X)=0x%X @%p %s \n", __func__, mask,
+                       event_flags_.mask (), this, name ());
 #endif
       // Return the selected flags.
       return ret;
@@ -644,7 +839,7 @@ namespace os
     event_flags::waiting (void)
     {
 #if defined(OS_TRACE_RTOS_EVFLAGS)
-      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+      OS_TRACE_PRINTF (rtos_evflags, "%s() @%p %s\n", __func__, this, name ());
 #endif
 
 #if defined(OS_USE_RTOS_PORT_EVENT_FLAGS)
@@ -660,7 +855,11 @@ namespace os
           // ----- Enter critical section -------------------------------------
           interrupts::critical_section ics;
 
+#if defined(OS_INCLUDE_RTOS_EVENT_FLAGS_MASKED_WAKEUP)
+          return !list_.empty () || !masked_list_.empty ();
+#else
           return !list_.empty ();
+#endif /* defined(OS_INCLUDE_RTOS_EVENT_FLAGS_MASKED_WAKEUP) */
           // ----- Exit critical section --------------------------------------
         }
 
@@ -0,0 +1,567 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <cmsis-plus/rtos/os-executor.h>
+
+#include <new>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    // ------------------------------------------------------------------------
+
+    /**
+     * @cond ignore
+     */
+
+    namespace
+    {
+      // The state of a `parallel_for()`, shared with the helper jobs;
+      // it lives on the caller stack until all helpers are done.
+      typedef struct range_s
+      {
+        executor::index_func_t func;
+        void* args;
+        std::size_t next;
+        std::size_t end;
+        std::size_t grain;
+        std::size_t helpers;
+        semaphore_binary* done;
+      } range_t;
+
+      // Claim chunks of indices and process them, until the
+      // range is exhausted.
+      void
+      run_range (range_t* r)
+      {
+        for (;;)
+          {
+            std::size_t first = __atomic_fetch_add (&r->next, r->grain,
+                                                    __ATOMIC_RELAXED);
+            if (first >= r->end)
+              {
+                break;
+              }
+
+            std::size_t last = first + r->grain;
+            if (last > r->end)
+              {
+                last = r->end;
+              }
+
+            for (std::size_t i = first; i < last; ++i)
+              {
+                r->func (i, r->args);
+              }
+          }
+      }
+    } /* namespace */
+
+    /**
+     * @endcond
+     */
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @class executor::handle
+     * @details
+     * The handle is passed to `submit()` and is signalled after
+     * the job function returns; a handle can be reused only
+     * after the previous job was completed.
+     */
+
+    /**
+     * @details
+     * The handle is not valid until used in `submit()`.
+     */
+    executor::handle::handle () :
+        done_
+          { nullptr, 0 }
+    {
+      ;
+    }
+
+    /**
+     * @details
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    executor::handle::wait (void)
+    {
+      if (!valid_)
+        {
+          return EINVAL;
+        }
+
+      while (!ready_)
+        {
+          result_t res = done_.wait ();
+          if (res != result::ok)
+            {
+              return res;
+            }
+        }
+      return result::ok;
+    }
+
+    /**
+     * @details
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    executor::handle::timed_wait (clock::duration_t timeout)
+    {
+      if (!valid_)
+        {
+          return EINVAL;
+        }
+
+      while (!ready_)
+        {
+          result_t res = done_.timed_wait (timeout);
+          if (res != result::ok)
+            {
+              return res;
+            }
+        }
+      return result::ok;
+    }
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @class executor
+     * @details
+     * Each worker has a deque of jobs; a worker takes jobs from
+     * the bottom of its own deque (the most recent, still warm in
+     * the caches) and, when empty, steals from the top of the
+     * other deques (the oldest), so long jobs do not delay the
+     * jobs queued behind them.
+     *
+     * Jobs submitted by a worker go to its own deque, the others
+     * are distributed in turn. A counting semaphore keeps one count
+     * for each queued job, so idle workers sleep and each wake-up
+     * is guaranteed to find a job.
+     *
+     * The deques are protected by short interrupts critical
+     * sections, the jobs run with interrupts enabled.
+     */
+
+    /**
+     * @details
+     * The workers are created later, by the derived class.
+     */
+    executor::executor (const char* name) :
+        object_named_system
+          { name }, //
+        work_
+          { name, semaphore::max_count_value, 0 }
+    {
+#if defined(OS_TRACE_RTOS_EXECUTOR)
+      OS_TRACE_PRINTF (rtos_executor, "%s() @%p %s\n", __func__, this,
+                       this->name ());
+#endif
+    }
+
+    /**
+     * @details
+     * The workers must have been already stopped by the derived class.
+     */
+    executor::~executor ()
+    {
+#if defined(OS_TRACE_RTOS_EXECUTOR)
+      OS_TRACE_PRINTF (rtos_executor, "%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      assert(workers_count_ == 0);
+    }
+
+    /**
+     * @details
+     * The job is allocated from the pool and queued; the function
+     * returns without waiting, use the handle to wait for the
+     * job to complete.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    result_t
+    executor::submit (func_t func, void* args, handle* hnd)
+    {
+#if defined(OS_TRACE_RTOS_EXECUTOR)
+      OS_TRACE_PRINTF (rtos_executor, "%s(%p, %p) @%p %s\n", __func__,
+                       reinterpret_cast<void*> (func), args, this, name ());
+#endif
+
+      if (func == nullptr)
+        {
+          return EINVAL;
+        }
+
+      if (stopping_)
+        {
+          return EAGAIN;
+        }
+
+      job_t* job = static_cast<job_t*> (pool_->allocate (sizeof(job_t),
+                                                         alignof(job_t)));
+      if (job == nullptr)
+        {
+          return ENOMEM;
+        }
+
+      job->func = func;
+      job->args = args;
+      job->hnd = hnd;
+
+      if (hnd != nullptr)
+        {
+          hnd->ready_ = false;
+          hnd->valid_ = true;
+        }
+
+      worker_t* w = internal_current_worker_ ();
+
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          if (w == nullptr)
+            {
+              w = &workers_[next_];
+              next_ = (next_ + 1) % workers_count_;
+            }
+
+          w->deque[w->bottom % capacity_] = job;
+          ++(w->bottom);
+          // ----- Exit critical section --------------------------------------
+        }
+
+      return work_.post ();
+    }
+
+    /**
+     * @details
+     * The range is split in chunks of _grain_ indices; up to one
+     * helper job for each worker claims chunks, and so does the
+     * calling thread, until all indices are processed.
+     *
+     * When invoked from a worker, while waiting for the helpers
+     * the calling thread runs queued jobs, so nested calls
+     * cannot starve the pool.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    executor::parallel_for (std::size_t begin, std::size_t end,
+                            index_func_t func, void* args, std::size_t grain)
+    {
+#if defined(OS_TRACE_RTOS_EXECUTOR)
+      OS_TRACE_PRINTF (rtos_executor, "%s(%u, %u) @%p %s\n", __func__,
+                       static_cast<unsigned int> (begin),
+                       static_cast<unsigned int> (end), this, name ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+
+      if (func == nullptr)
+        {
+          return EINVAL;
+        }
+
+      if (begin >= end)
+        {
+          return result::ok;
+        }
+
+      if (grain == 0)
+        {
+          grain = 1;
+        }
+
+      semaphore_binary done
+        { nullptr, 0 };
+
+      range_t range;
+      range.func = func;
+      range.args = args;
+      range.next = begin;
+      range.end = end;
+      range.grain = grain;
+      range.helpers = 0;
+      range.done = &done;
+
+      // No more helpers than remaining chunks; the caller takes one.
+      std::size_t chunks = (end - begin + grain - 1) / grain;
+      std::size_t helpers = chunks - 1;
+      if (helpers > workers_count_)
+        {
+          helpers = workers_count_;
+        }
+
+      for (std::size_t i = 0; i < helpers; ++i)
+        {
+          __atomic_add_fetch (&range.helpers, 1, __ATOMIC_RELAXED);
+          if (submit (internal_range_job_, &range) != result::ok)
+            {
+              // Out of jobs; the caller will do the rest.
+              __atomic_sub_fetch (&range.helpers, 1, __ATOMIC_RELAXED);
+              break;
+            }
+        }
+
+      run_range (&range);
+
+      // The range is on this stack, wait for all helpers to leave it.
+      worker_t* w = internal_current_worker_ ();
+      while (__atomic_load_n (&range.helpers, __ATOMIC_ACQUIRE) != 0)
+        {
+          // Help other jobs, possibly the own helpers; if no job is
+          // left unclaimed, the helpers are already running.
+          if (work_.try_wait () == result::ok)
+            {
+              job_t* job = internal_take_ (w);
+              if (job != nullptr)
+                {
+                  internal_run_ (job);
+                }
+              continue;
+            }
+
+          done.wait ();
+        }
+
+      return result::ok;
+    }
+
+    /**
+     * @details
+     * The number is only indicative, the workers may take
+     * jobs at any time.
+     */
+    std::size_t
+    executor::pending (void) const
+    {
+      std::size_t count = 0;
+
+      // ----- Enter critical section -----------------------------------------
+      interrupts::critical_section ics;
+
+      for (std::size_t i = 0; i < workers_count_; ++i)
+        {
+          count += workers_[i].bottom - workers_[i].top;
+        }
+      return count;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    /**
+     * @cond ignore
+     */
+
+    void
+    executor::internal_construct_ (worker_t* workers,
+                                   std::size_t workers_count, job_t** deques,
+                                   os::memory::block_pool* pool, std::size_t jobs,
+                                   void* stacks, std::size_t stack_size_bytes,
+                                   thread::priority_t prio)
+    {
+      workers_ = workers;
+      capacity_ = jobs;
+      pool_ = pool;
+
+      thread::attributes attr;
+      attr.th_priority = prio;
+      attr.th_stack_size_bytes = stack_size_bytes;
+
+      for (std::size_t i = 0; i < workers_count; ++i)
+        {
+          worker_t* w = &workers_[i];
+          w->owner = this;
+          w->deque = &deques[i * jobs];
+          w->top = 0;
+          w->bottom = 0;
+
+          attr.th_stack_address = static_cast<char*> (stacks)
+              + i * stack_size_bytes;
+
+          w->th = new (&w->thread_storage) thread
+            { name (), internal_worker_, w, attr };
+        }
+
+      workers_count_ = workers_count;
+    }
+
+    void
+    executor::internal_destruct_ (void)
+    {
+      stopping_ = true;
+
+      // Wake-up all workers; they exit when no more jobs are queued.
+      for (std::size_t i = 0; i < workers_count_; ++i)
+        {
+          work_.post ();
+        }
+
+      for (std::size_t i = 0; i < workers_count_; ++i)
+        {
+          workers_[i].th->join ();
+          workers_[i].th->~thread ();
+        }
+
+      workers_count_ = 0;
+    }
+
+    executor::job_t*
+    executor::internal_take_ (worker_t* w)
+    {
+      // ----- Enter critical section -----------------------------------------
+      interrupts::critical_section ics;
+
+      // The most recent job of the current worker.
+      if ((w != nullptr) && (w->bottom != w->top))
+        {
+          --(w->bottom);
+          return w->deque[w->bottom % capacity_];
+        }
+
+      // The oldest job of one of the other workers, starting
+      // with the next one, to spread the steals.
+      std::size_t start = (w != nullptr) ? (w - workers_) + 1 : 0;
+      for (std::size_t n = 0; n < workers_count_; ++n)
+        {
+          worker_t* v = &workers_[(start + n) % workers_count_];
+          if (v->bottom != v->top)
+            {
+              job_t* job = v->deque[v->top % capacity_];
+              ++(v->top);
+              return job;
+            }
+        }
+
+      return nullptr;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    void
+    executor::internal_run_ (job_t* job)
+    {
+      func_t func = job->func;
+      void* args = job->args;
+      handle* hnd = job->hnd;
+
+      // Free the job before running it, so that it can be
+      // immediately reused by nested submits.
+      pool_->deallocate (job, sizeof(job_t), alignof(job_t));
+
+      func (args);
+
+      if (hnd != nullptr)
+        {
+          hnd->ready_ = true;
+          hnd->done_.post ();
+        }
+    }
+
+    executor::worker_t*
+    executor::internal_current_worker_ (void)
+    {
+      if (interrupts::in_handler_mode ())
+        {
+          return nullptr;
+        }
+
+      thread* crt = &this_thread::thread ();
+      for (std::size_t i = 0; i < workers_count_; ++i)
+        {
+          if (workers_[i].th == crt)
+            {
+              return &workers_[i];
+            }
+        }
+      return nullptr;
+    }
+
+    void*
+    executor::internal_worker_ (void* args)
+    {
+      worker_t* w = static_cast<worker_t*> (args);
+      executor* ex = w->owner;
+
+      for (;;)
+        {
+          if (ex->work_.wait () != result::ok)
+            {
+              continue;
+            }
+
+          job_t* job = ex->internal_take_ (w);
+          if (job == nullptr)
+            {
+              // Only the wake-ups posted when stopping have no job.
+              if (ex->stopping_)
+                {
+                  break;
+                }
+              continue;
+            }
+
+          ex->internal_run_ (job);
+        }
+
+      return nullptr;
+    }
+
+    void
+    executor::internal_range_job_ (void* args)
+    {
+      range_t* r = static_cast<range_t*> (args);
+
+      run_range (r);
+
+      // The last helper wakes up the caller; after this, the
+      // range must not be accessed any more.
+      semaphore_binary* done = r->done;
+      if (__atomic_sub_fetch (&r->helpers, 1, __ATOMIC_ACQ_REL) == 0)
+        {
+          done->post ();
+        }
+    }
+
+    /**
+     * @endcond
+     */
+
+  // --------------------------------------------------------------------------
+
+  } /* namespace rtos */
+} /* namespace os */
@@ -27,6 +27,8 @@
 
 #include <cmsis-plus/rtos/os.h>
 
+#include <cmsis-plus/estd/memory_resource>
+
 // ----------------------------------------------------------------------------
 
 using namespace os;
@@ -37,6 +39,16 @@ using namespace os::rtos;
 void*
 os_idle (thread::func_args_t args);
 
+#if defined(OS_INCLUDE_RTOS_SMP)
+void*
+os_idle_secondary (thread::func_args_t args);
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+
+#if defined(OS_INCLUDE_RTOS_THREAD_REAPER)
+void*
+os_reaper (thread::func_args_t args);
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_REAPER) */
+
 void
 os_rtos_idle_actions (void);
 
@@ -65,25 +77,252 @@ os_rtos_idle_enter_power_saving_mode_hook (void)
   return false;
 }
 
+#if defined(OS_USE_RTOS_TICKLESS_IDLE)
+
+/**
+ * @details
+ * The hook must stop the system tick, program a low power timer
+ * to wake the device after the given number of ticks,
+ * enter the sleep mode and, after wake-up (by the timer or by
+ * any other interrupt), restart the system tick and return the
+ * number of full ticks slept, used to update the
+ * clocks counters.
+ *
+ * It is called with interrupts disabled, and the sleep instruction
+ * must wake up even without entering the interrupt handlers; they
+ * are executed after the clocks are updated.
+ *
+ * If the hardware cannot sleep for the requested duration, the
+ * hook may decide to sleep less; any value up to `ticks` is valid.
+ *
+ * If the hook decides not to sleep, it must return 0, which will
+ * make the idle thread proceed as usual, by entering a shallow
+ * sleep waiting for the next tick.
+ */
+uint32_t
+__attribute__((weak))
+os_rtos_idle_tickless_sleep_hook (uint32_t ticks __attribute__((unused)))
+{
+  return 0;
+}
+
+namespace
+{
+  /**
+   * @brief Get the number of ticks until the earliest deadline.
+   * @par Parameters
+   *  None.
+   * @return The number of ticks, 0 if already due.
+   * @details
+   * Both the system clock and the high resolution clock lists are
+   * checked, since both are driven by the system tick; the
+   * real time clock has its own interrupt.
+   *
+   * Must be called from a critical section.
+   */
+  clock::duration_t
+  idle_ticks_to_deadline (void)
+  {
+    clock::duration_t ticks = static_cast<clock::duration_t> (~0u);
+
+    internal::clock_timestamps_list& sys_list = sysclock.steady_list ();
+    if (!sys_list.empty ())
+      {
+        clock::timestamp_t ts = sys_list.head ()->timestamp;
+        clock::timestamp_t nw = sysclock.steady_now ();
+        if (ts <= nw)
+          {
+            return 0;
+          }
+        if (ts - nw < ticks)
+          {
+            ticks = static_cast<clock::duration_t> (ts - nw);
+          }
+      }
+
+    internal::clock_timestamps_list& hr_list = hrclock.steady_list ();
+    if (!hr_list.empty ())
+      {
+        clock::timestamp_t ts = hr_list.head ()->timestamp;
+        clock::timestamp_t nw = hrclock.steady_now ();
+        if (ts <= nw)
+          {
+            return 0;
+          }
+        // The highres clock is incremented only on ticks, so round down.
+        clock::timestamp_t hr_ticks = (ts - nw)
+            / port::clock_highres::cycles_per_tick ();
+        if (hr_ticks < ticks)
+          {
+            ticks = static_cast<clock::duration_t> (hr_ticks);
+          }
+      }
+
+    return ticks;
+  }
+
+  /**
+   * @brief Sleep until the earliest deadline.
+   * @par Parameters
+   *  None.
+   * @retval true The device entered the tickless sleep.
+   * @retval false The sleep was not possible.
+   */
+  bool
+  idle_tickless_sleep (void)
+  {
+    // ----- Enter critical section -------------------------------------------
+    interrupts::critical_section ics;
+
+    clock::duration_t ticks = idle_ticks_to_deadline ();
+    if (ticks < OS_INTEGER_RTOS_TICKLESS_IDLE_MIN_TICKS)
+      {
+        return false;
+      }
+
+    clock::duration_t slept = os_rtos_idle_tickless_sleep_hook (ticks);
+    if (slept == 0)
+      {
+        return false;
+      }
+    if (slept > ticks)
+      {
+        slept = ticks;
+      }
+
+#if defined(OS_TRACE_RTOS_CLOCKS)
+    OS_TRACE_PRINTF (rtos_clocks, "%s() %u/%u\n", __func__, slept, ticks);
+#endif
+
+    // Catch up the clocks and process the due time stamps.
+    sysclock.update_for_slept_time (slept);
+    hrclock.update_for_slept_time (
+        slept * port::clock_highres::cycles_per_tick ());
+
+    return true;
+    // ----- Exit critical section --------------------------------------------
+  }
+}
+
+#endif /* defined(OS_USE_RTOS_TICKLESS_IDLE) */
+
+#if defined(OS_INCLUDE_STARTUP_DEFERRED_INIT_ARRAY) && defined(__ARM_EABI__)
+
+/**
+ * @cond ignore
+ */
+
+#pragma GCC diagnostic push
+#if defined(__clang__)
+#pragma clang diagnostic ignored "-Wexit-time-destructors"
+#pragma clang diagnostic ignored "-Wglobal-constructors"
+#endif
+
+// Serialise the idle thread and the application; with priority
+// inheritance, a thread waiting for the constructor interrupted
+// in the idle thread raises the idle priority.
+static mutex deferred_init_mutex
+  { "deferred-init" };
+
+#pragma GCC diagnostic pop
+
+/**
+ * @endcond
+ */
+
+/**
+ * @details
+ * To be called by the application before the first use of
+ * an object marked with `OS_STARTUP_DEFERRED_INIT()`, if
+ * this may happen before the idle thread constructed it;
+ * when it returns, all the deferred objects are constructed.
+ *
+ * @warning Cannot be invoked from Interrupt Service Routines.
+ */
+void
+os_startup_complete_deferred_init (void)
+{
+  deferred_init_mutex.lock ();
+  while (os_startup_run_deferred_init ())
+    ;
+  deferred_init_mutex.unlock ();
+}
+
+#endif /* defined(OS_INCLUDE_STARTUP_DEFERRED_INIT_ARRAY) && defined(__ARM_EABI__) */
+
+#if defined(OS_INCLUDE_RTOS_THREAD_STACK_SCAN)
+
+/**
+ * @details
+ * Called by the idle thread when the stack scan finds a new
+ * maximum usage for a thread, and the remaining stack is below
+ * `OS_INTEGER_RTOS_THREAD_STACK_WARNING_PERCENT`; the default
+ * implementation only prints a trace message.
+ *
+ * It runs with the scheduler unlocked, but on the idle thread
+ * stack, so it must be short.
+ */
+void
+__attribute__((weak))
+os_rtos_stack_warning_hook (void* th, size_t available)
+{
+  trace::printf ("Thread '%s' stack low, %u bytes left\n",
+                 static_cast<thread*> (th)->name (),
+                 static_cast<unsigned int> (available));
+}
+
+namespace
+{
+  // Position, in the threads tree, of the thread being scanned.
+  std::size_t stack_scan_index;
+
+  /**
+   * @brief Find a thread by its position in the threads tree.
+   * @param [in] parent Parent thread, `nullptr` for the top threads.
+   * @param [in,out] index Position, decremented for each thread passed.
+   * @return Pointer to the thread, or `nullptr` if not found.
+   */
+  thread*
+  stack_scan_find (thread* parent, std::size_t& index)
+  {
+    for (auto&& th : scheduler::children_threads (parent))
+      {
+        if (index == 0)
+          {
+            return &th;
+          }
+        --index;
+
+        thread* found = stack_scan_find (&th, index);
+        if (found != nullptr)
+          {
+            return found;
+          }
+      }
+    return nullptr;
+  }
+}
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_STACK_SCAN) */
+
 void
 __attribute__((weak))
 os_rtos_idle_actions (void)
 {
-  while (!scheduler::terminated_threads_list_.empty ())
+#if !defined(OS_INCLUDE_RTOS_THREAD_REAPER)
+  // All at once; the idle thread yields after the actions.
+  scheduler::internal_reap_terminated_ ();
+#endif /* !defined(OS_INCLUDE_RTOS_THREAD_REAPER) */
+
+#if defined(OS_INCLUDE_STARTUP_DEFERRED_INIT_ARRAY) && defined(__ARM_EABI__)
+  // One deferred constructor on each iteration; the idle thread
+  // must not wait, if the application runs them, skip.
+  if (deferred_init_mutex.try_lock () == result::ok)
     {
-      internal::waiting_thread_node* node;
-        {
-          // ----- Enter critical section ---------------------------------
-          interrupts::critical_section ics;
-          node =
-              const_cast<internal::waiting_thread_node*> (scheduler::terminated_threads_list_.head ());
-          node->unlink ();
-          // ----- Exit critical section ----------------------------------
-        }
-      node->thread_->internal_destroy_ ();
-
-      this_thread::yield ();
+      os_startup_run_deferred_init ();
+      deferred_init_mutex.unlock ();
     }
+#endif /* defined(OS_INCLUDE_STARTUP_DEFERRED_INIT_ARRAY) && defined(__ARM_EABI__) */
 
 #if defined(OS_HAS_INTERRUPTS_STACK)
   // Simple test to verify that the interrupts
@@ -91,8 +330,109 @@ os_rtos_idle_actions (void)
   assert(rtos::interrupts::stack ()->check_bottom_magic ());
 #endif
 
+#if defined(OS_INCLUDE_RTOS_THREAD_STACK_SCAN)
+  // Check a few words of one stack; the threads are taken in turn,
+  // each one when the pass over the previous stack is complete.
+  thread* warn_thread = nullptr;
+  std::size_t warn_available = 0;
+    {
+      // ----- Enter critical section -----------------------------------------
+      scheduler::critical_section scs;
+
+      std::size_t index = stack_scan_index;
+      thread* th = stack_scan_find (nullptr, index);
+      if (th == nullptr)
+        {
+          // Past the last thread, restart with the first.
+          stack_scan_index = 0;
+        }
+      else
+        {
+          class thread::stack& st = th->stack ();
+          std::size_t used = st.high_water_mark ();
+          if (st.internal_scan_ (OS_INTEGER_RTOS_THREAD_STACK_SCAN_WORDS))
+            {
+              ++stack_scan_index;
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_STACK_SITES)
+              scheduler::statistics::internal_record_stack_ (
+                  reinterpret_cast<const void*> (th->func_), th->name (),
+                  st.size (), st.high_water_mark ());
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_STACK_SITES) */
+
+              std::size_t available = st.size () - st.high_water_mark ();
+              if (st.high_water_mark () > used
+                  && available
+                      < (st.size ()
+                          * OS_INTEGER_RTOS_THREAD_STACK_WARNING_PERCENT)
+                          / 100)
+                {
+                  warn_thread = th;
+                  warn_available = available;
+                }
+            }
+        }
+      // ----- Exit critical section ------------------------------------------
+    }
+
+  if (warn_thread != nullptr)
+    {
+      os_rtos_stack_warning_hook (warn_thread, warn_available);
+    }
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_STACK_SCAN) */
+
+    {
+      // Release the blocks freed by interrupt handlers.
+      estd::pmr::memory_resource* app = estd::pmr::get_default_resource ();
+      rtos::memory::memory_resource* sys = rtos::memory::get_default_resource ();
+
+      // Same lock as malloc().
+      // ----- Enter critical section -----------------------------------------
+      scheduler::critical_section scs;
+
+      app->drain_deferred ();
+      if (sys != app)
+        {
+          sys->drain_deferred ();
+        }
+      // ----- Exit critical section ------------------------------------------
+    }
+
+#if defined(OS_INCLUDE_RTOS_IDLE_ZERO_FREE_MEMORY)
+    {
+      // Same lock as malloc().
+      // ----- Enter critical section -----------------------------------------
+      scheduler::critical_section scs;
+
+      estd::pmr::get_default_resource ()->zero_free (
+          OS_INTEGER_RTOS_IDLE_ZERO_FREE_BYTES);
+      // ----- Exit critical section ------------------------------------------
+    }
+#endif /* defined(OS_INCLUDE_RTOS_IDLE_ZERO_FREE_MEMORY) */
+
+#if defined(TRACE) && defined(OS_USE_TRACE_SEMIHOSTING_BUFFERED)
+  // Send the buffered trace messages while there is nothing else to do.
+  trace::flush ();
+#endif /* defined(TRACE) && defined(OS_USE_TRACE_SEMIHOSTING_BUFFERED) */
+
+#if defined(OS_INCLUDE_RTOS_DVFS)
+  // Lower the frequency, if the governor decided so.
+  dvfs::internal_idle_ ();
+#endif /* defined(OS_INCLUDE_RTOS_DVFS) */
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_CPU_LOAD)
+  // Account the time until the next interrupt as sleep.
+  scheduler::statistics::sleep_scope ss;
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_CPU_LOAD) */
+
   if (!os_rtos_idle_enter_power_saving_mode_hook ())
     {
+#if defined(OS_USE_RTOS_TICKLESS_IDLE)
+      if (idle_tickless_sleep ())
+        {
+          return;
+        }
+#endif /* defined(OS_USE_RTOS_TICKLESS_IDLE) */
       port::scheduler::wait_for_interrupt ();
     }
 }
@@ -124,6 +464,18 @@ static std::unique_ptr<thread> os_idle_thread_;
 
 #endif /* defined(OS_EXCLUDE_DYNAMIC_MEMORY_ALLOCATIONS) */
 
+#if defined(OS_INCLUDE_RTOS_SMP)
+
+using idle_thread_t = thread_inclusive<OS_INTEGER_RTOS_IDLE_STACK_SIZE_BYTES>;
+
+// Storage for the idle threads of the secondary cores, constructed
+// in place at startup and never destroyed.
+static typename std::aligned_storage<sizeof(idle_thread_t),
+    alignof(idle_thread_t)>::type os_idle_secondary_threads_[OS_INTEGER_RTOS_SMP_CORES
+    - 1];
+
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+
 #pragma GCC diagnostic pop
 
 void
@@ -147,6 +499,21 @@ os_startup_create_thread_idle (void)
   os_idle_thread = os_idle_thread_.get ();
 
 #endif /* defined(OS_EXCLUDE_DYNAMIC_MEMORY_ALLOCATIONS) */
+
+#if defined(OS_INCLUDE_RTOS_SMP)
+
+  // Each core needs a thread to run when its ready list is empty.
+  for (std::size_t core = 1; core < OS_INTEGER_RTOS_SMP_CORES; ++core)
+    {
+      thread::attributes sattr = thread::initializer;
+      sattr.th_core = static_cast<thread::core_t> (core);
+      sattr.th_affinity = static_cast<thread::affinity_t> (1u << core);
+
+      new (&os_idle_secondary_threads_[core - 1]) idle_thread_t
+        { "idle", os_idle_secondary, nullptr, sattr };
+    }
+
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
 }
 
 void*
@@ -167,6 +534,11 @@ os_idle (thread::func_args_t args __attribute__((unused)))
 
   while (true)
     {
+#if defined(OS_INCLUDE_RTOS_SMP) \
+  && defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES)
+      scheduler::internal_balance_ ();
+#endif
+
       os_rtos_idle_actions ();
 
       // Possibly switch to threads that were resumed during sleep.
@@ -174,6 +546,148 @@ os_idle (thread::func_args_t args __attribute__((unused)))
     }
 }
 
+#if defined(OS_INCLUDE_RTOS_SMP)
+
+/**
+ * @details
+ * The terminated threads and the tickless sleep are handled
+ * by the idle thread of the boot core; the secondary cores
+ * only wait for interrupts, including the reschedule requests
+ * from the other cores.
+ */
+void*
+os_idle_secondary (thread::func_args_t args __attribute__((unused)))
+{
+#if defined(OS_BOOL_RTOS_THREAD_IDLE_PRIORITY_BELOW_IDLE)
+  this_thread::thread ().priority (thread::priority::idle - 1);
+#else
+  this_thread::thread ().priority (thread::priority::idle);
+#endif
+
+  while (true)
+    {
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES)
+      scheduler::internal_balance_ ();
+#endif
+
+      if (!os_rtos_idle_enter_power_saving_mode_hook ())
+        {
+          port::scheduler::wait_for_interrupt ();
+        }
+
+      this_thread::yield ();
+    }
+}
+
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+
+#if defined(OS_INCLUDE_RTOS_THREAD_REAPER)
+
+namespace
+{
+  // The flag raised by the exiting threads.
+  constexpr flags::mask_t reaper_flag = 1;
+
+  thread* reaper_thread;
+}
+
+#pragma GCC diagnostic push
+#if defined(__clang__)
+#pragma clang diagnostic ignored "-Wexit-time-destructors"
+#pragma clang diagnostic ignored "-Wglobal-constructors"
+#pragma clang diagnostic ignored "-Wmissing-variable-declarations"
+#endif
+
+#if defined(OS_EXCLUDE_DYNAMIC_MEMORY_ALLOCATIONS)
+
+static thread_inclusive<OS_INTEGER_RTOS_THREAD_REAPER_STACK_SIZE_BYTES> os_reaper_thread_
+  { "reaper", os_reaper, nullptr};
+
+#else
+
+static std::unique_ptr<thread> os_reaper_thread_;
+
+#endif /* defined(OS_EXCLUDE_DYNAMIC_MEMORY_ALLOCATIONS) */
+
+#pragma GCC diagnostic pop
+
+void
+__attribute__((weak))
+os_startup_create_thread_reaper (void)
+{
+#if defined(OS_EXCLUDE_DYNAMIC_MEMORY_ALLOCATIONS)
+
+  // The thread object instance was created by the static constructors.
+  reaper_thread = &os_reaper_thread_;
+
+#else
+
+  thread::attributes attr = thread::initializer;
+  attr.th_stack_size_bytes = OS_INTEGER_RTOS_THREAD_REAPER_STACK_SIZE_BYTES;
+  attr.th_priority = OS_INTEGER_RTOS_THREAD_REAPER_PRIORITY;
+
+  // No need for an explicit delete, it is deallocated by the unique_ptr.
+  os_reaper_thread_ = std::unique_ptr<thread> (
+      new thread ("reaper", os_reaper, nullptr, attr));
+
+  reaper_thread = os_reaper_thread_.get ();
+
+#endif /* defined(OS_EXCLUDE_DYNAMIC_MEMORY_ALLOCATIONS) */
+}
+
+namespace os
+{
+  namespace rtos
+  {
+    namespace scheduler
+    {
+      /**
+       * @details
+       * Called by the exiting threads, after they are linked to
+       * the list of terminated threads.
+       */
+      void
+      internal_wake_reaper_ (void)
+      {
+        if (reaper_thread != nullptr)
+          {
+            reaper_thread->flags_raise (reaper_flag);
+          }
+      }
+    } /* namespace scheduler */
+  } /* namespace rtos */
+} /* namespace os */
+
+/**
+ * @details
+ * Destroy the terminated threads in batches, then wait for
+ * the next thread exit; when no threads terminate, the reaper
+ * is suspended and costs nothing.
+ */
+void*
+os_reaper (thread::func_args_t args __attribute__((unused)))
+{
+  // The static instance is created with the default priority.
+  this_thread::thread ().priority (OS_INTEGER_RTOS_THREAD_REAPER_PRIORITY);
+
+  for (;;)
+    {
+      scheduler::internal_reap_terminated_ ();
+
+      if (scheduler::terminated_threads_list_.empty ())
+        {
+          this_thread::flags_wait (reaper_flag);
+        }
+      else
+        {
+          // Some threads are still switching out on other cores.
+          this_thread::yield ();
+        }
+    }
+}
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_REAPER) */
+
 /**
  * @endcond
  */
@@ -68,6 +68,11 @@ namespace
   [[noreturn]] static void
   _main_trampoline (void)
   {
+#if defined(OS_INCLUDE_STARTUP_DEFERRED_BSS) && defined(__ARM_EABI__)
+    // The large regions not needed before the scheduler starts.
+    os_startup_initialize_deferred_bss ();
+#endif /* defined(OS_INCLUDE_STARTUP_DEFERRED_BSS) && defined(__ARM_EABI__) */
+
     trace::puts ("");
     trace::dump_args (main_args.argc, main_args.argv);
 
@@ -172,6 +177,18 @@ main (int argc, char* argv[])
   os_startup_create_thread_idle ();
 #endif /* !defined(OS_USE_RTOS_PORT_SCHEDULER) */
 
+#if defined(OS_INCLUDE_RTOS_DEFERRED)
+  os_startup_create_thread_deferred ();
+#endif /* defined(OS_INCLUDE_RTOS_DEFERRED) */
+
+#if defined(OS_INCLUDE_RTOS_THREAD_REAPER)
+  os_startup_create_thread_reaper ();
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_REAPER) */
+
+#if defined(OS_INCLUDE_RTOS_TIMER_DAEMON) && !defined(OS_USE_RTOS_PORT_TIMER)
+  os_startup_create_thread_timer_daemon ();
+#endif /* defined(OS_INCLUDE_RTOS_TIMER_DAEMON) */
+
   // Execution will proceed to first registered thread, possibly
   // "idle", which will immediately lower its priority,
   // and at a certain moment will reach os_main().
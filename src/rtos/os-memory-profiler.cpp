@@ -0,0 +1,378 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <cmsis-plus/rtos/os.h>
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_INCLUDE_RTOS_MEMORY_PROFILER)
+
+namespace os
+{
+  namespace rtos
+  {
+    namespace memory
+    {
+      namespace profiler
+      {
+        // --------------------------------------------------------------------
+
+        /**
+         * @cond ignore
+         */
+
+        namespace
+        {
+          static_assert((OS_INTEGER_RTOS_MEMORY_PROFILER_SITES
+              & (OS_INTEGER_RTOS_MEMORY_PROFILER_SITES - 1)) == 0,
+              "OS_INTEGER_RTOS_MEMORY_PROFILER_SITES must be a power of 2.");
+          static_assert((OS_INTEGER_RTOS_MEMORY_PROFILER_BLOCKS
+              & (OS_INTEGER_RTOS_MEMORY_PROFILER_BLOCKS - 1)) == 0,
+              "OS_INTEGER_RTOS_MEMORY_PROFILER_BLOCKS must be a power of 2.");
+          static_assert(OS_INTEGER_RTOS_MEMORY_PROFILER_SAMPLE_RATE > 0,
+              "OS_INTEGER_RTOS_MEMORY_PROFILER_SAMPLE_RATE must be > 0.");
+
+          constexpr std::size_t blocks_size =
+              OS_INTEGER_RTOS_MEMORY_PROFILER_BLOCKS;
+
+          // A sampled block, tracked until deallocated.
+          typedef struct block_s
+          {
+            const void* addr;
+            port::clock::timestamp_t timestamp;
+            std::size_t site;
+          } block_t;
+
+          // Both tables are open addressing hash tables,
+          // with linear probing.
+          site_t sites[sites_size];
+          block_t blocks[blocks_size];
+
+          std::size_t calls;
+          std::size_t tracked;
+          std::size_t dropped;
+
+          inline std::size_t
+          hash (const void* addr, std::size_t size)
+          {
+            uintptr_t n = reinterpret_cast<uintptr_t> (addr);
+            // Ignore the alignment bits and mix in the upper ones.
+            n = (n >> 2) ^ (n >> 11);
+            return static_cast<std::size_t> (n) & (size - 1);
+          }
+
+          // Return the index of the entry, or sites_size if full.
+          std::size_t
+          find_site (const void* caller)
+          {
+            std::size_t i = hash (caller, sites_size);
+            for (std::size_t n = 0; n < sites_size; ++n)
+              {
+                if (sites[i].caller == caller)
+                  {
+                    return i;
+                  }
+                if (sites[i].caller == nullptr)
+                  {
+                    sites[i].caller = caller;
+                    return i;
+                  }
+                i = (i + 1) & (sites_size - 1);
+              }
+            return sites_size;
+          }
+
+          // Return the index of the block, or blocks_size if not found.
+          std::size_t
+          find_block (const void* addr)
+          {
+            std::size_t i = hash (addr, blocks_size);
+            for (std::size_t n = 0; n < blocks_size; ++n)
+              {
+                if (blocks[i].addr == addr)
+                  {
+                    return i;
+                  }
+                if (blocks[i].addr == nullptr)
+                  {
+                    break;
+                  }
+                i = (i + 1) & (blocks_size - 1);
+              }
+            return blocks_size;
+          }
+
+          // Remove an entry, moving back the following entries
+          // of the probe sequence, so no tombstones are needed.
+          void
+          remove_block (std::size_t i)
+          {
+            std::size_t j = i;
+            while (true)
+              {
+                j = (j + 1) & (blocks_size - 1);
+                if (blocks[j].addr == nullptr)
+                  {
+                    break;
+                  }
+
+                std::size_t k = hash (blocks[j].addr, blocks_size);
+                // Skip it if its home slot is cyclically in (i,j].
+                if ((i <= j) ? ((i < k) && (k <= j)) : ((i < k) || (k <= j)))
+                  {
+                    continue;
+                  }
+
+                blocks[i] = blocks[j];
+                i = j;
+              }
+            blocks[i].addr = nullptr;
+          }
+        } /* namespace */
+
+        /**
+         * @endcond
+         */
+
+        // --------------------------------------------------------------------
+
+        /**
+         * @details
+         * Only one call in `OS_INTEGER_RTOS_MEMORY_PROFILER_SAMPLE_RATE`
+         * is recorded. The sampled block is also kept in a table
+         * of live blocks, to measure its lifetime when deallocated.
+         *
+         * Uses only static storage, so it can be called from
+         * the allocation functions.
+         *
+         * @warning Cannot be invoked from Interrupt Service Routines.
+         */
+        void
+        record_allocation (const void* caller, const void* addr,
+                           std::size_t bytes) noexcept
+        {
+          if (addr == nullptr)
+            {
+              return;
+            }
+
+          // ----- Enter critical section -------------------------------------
+          scheduler::critical_section scs;
+
+          if (++calls < OS_INTEGER_RTOS_MEMORY_PROFILER_SAMPLE_RATE)
+            {
+              return;
+            }
+          calls = 0;
+
+          std::size_t s = find_site (caller);
+          if (s == sites_size)
+            {
+              ++dropped;
+              return;
+            }
+
+          site_t& site = sites[s];
+          ++site.allocations;
+          site.bytes += bytes;
+
+          std::size_t i = find_block (addr);
+          if (i != blocks_size)
+            {
+              // The block was released without being recorded,
+              // for example by a failed realloc(); forget it.
+              --sites[blocks[i].site].live;
+              remove_block (i);
+              --tracked;
+            }
+
+          // Keep at least one free entry to terminate the searches.
+          if (tracked < blocks_size - 1)
+            {
+              i = hash (addr, blocks_size);
+              while (blocks[i].addr != nullptr)
+                {
+                  i = (i + 1) & (blocks_size - 1);
+                }
+              blocks[i].addr = addr;
+              blocks[i].timestamp = hrclock.now ();
+              blocks[i].site = s;
+              ++tracked;
+
+              ++site.live;
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+
+        /**
+         * @details
+         * If the block was sampled, its lifetime is added to the site.
+         * When no blocks are tracked, it returns immediately.
+         *
+         * @warning Cannot be invoked from Interrupt Service Routines.
+         */
+        void
+        record_deallocation (const void* addr) noexcept
+        {
+          if (addr == nullptr)
+            {
+              return;
+            }
+
+          // ----- Enter critical section -------------------------------------
+          scheduler::critical_section scs;
+
+          if (tracked == 0)
+            {
+              return;
+            }
+
+          std::size_t i = find_block (addr);
+          if (i == blocks_size)
+            {
+              return;
+            }
+
+          port::clock::timestamp_t lifetime = hrclock.now ()
+              - blocks[i].timestamp;
+
+          site_t& site = sites[blocks[i].site];
+          --site.live;
+          ++site.freed;
+          site.lifetime_cycles += lifetime;
+          if (lifetime > site.max_lifetime_cycles)
+            {
+              site.max_lifetime_cycles = lifetime;
+            }
+
+          remove_block (i);
+          --tracked;
+          // ----- Exit critical section --------------------------------------
+        }
+
+        const site_t&
+        site (std::size_t index) noexcept
+        {
+          assert(index < sites_size);
+          return sites[index];
+        }
+
+        /**
+         * @details
+         * The blocks allocated before this call no longer count as live.
+         */
+        void
+        clear (void) noexcept
+        {
+          // ----- Enter critical section -------------------------------------
+          scheduler::critical_section scs;
+
+          for (std::size_t i = 0; i < sites_size; ++i)
+            {
+              sites[i] = site_t
+                { };
+            }
+          for (std::size_t i = 0; i < blocks_size; ++i)
+            {
+              blocks[i].addr = nullptr;
+            }
+          calls = 0;
+          tracked = 0;
+          dropped = 0;
+          // ----- Exit critical section --------------------------------------
+        }
+
+        /**
+         * @details
+         * The sites are printed in decreasing order of the
+         * allocated bytes, without sorting the table (which would
+         * require extra storage), by repeatedly selecting the next
+         * one; the cost is quadratic, but this is a debug function.
+         *
+         * The totals are for the sampled allocations.
+         */
+        void
+        trace_print (void)
+        {
+#if defined(TRACE)
+          trace::printf ("Allocation sites, 1 in %u sampled, %u dropped:\n",
+                         OS_INTEGER_RTOS_MEMORY_PROFILER_SAMPLE_RATE, dropped);
+
+          // The previous site printed.
+          std::size_t prev = sites_size;
+          while (true)
+            {
+              std::size_t next = sites_size;
+              for (std::size_t i = 0; i < sites_size; ++i)
+                {
+                  const site_t& s = sites[i];
+                  if (s.caller == nullptr)
+                    {
+                      continue;
+                    }
+                  // Only sites after the previous one, in the order
+                  // (bytes descending, index ascending).
+                  if (prev != sites_size
+                      && (s.bytes > sites[prev].bytes
+                          || (s.bytes == sites[prev].bytes && i <= prev)))
+                    {
+                      continue;
+                    }
+                  if (next == sites_size || s.bytes > sites[next].bytes)
+                    {
+                      next = i;
+                    }
+                }
+              if (next == sites_size)
+                {
+                  break;
+                }
+
+              const site_t& s = sites[next];
+              trace::printf (
+                  "%p: %u allocs, %u bytes, %u live, "
+                  "lifetime avg %u max %u cycles\n",
+                  s.caller, s.allocations, s.bytes, s.live,
+                  static_cast<unsigned int> (
+                      s.freed ? (s.lifetime_cycles / s.freed) : 0),
+                  static_cast<unsigned int> (s.max_lifetime_cycles));
+
+              prev = next;
+            }
+#endif /* defined(TRACE) */
+        }
+
+      // ----------------------------------------------------------------------
+      } /* namespace profiler */
+    } /* namespace memory */
+  } /* namespace rtos */
+} /* namespace os */
+
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_PROFILER) */
+
+// ----------------------------------------------------------------------------
@@ -38,6 +38,12 @@
 #include <cmsis-plus/memory/malloc.h>
 #include <cmsis-plus/memory/null.h>
 
+#include <cstring>
+
+#if defined(OS_INCLUDE_RTOS_MEMORY_TRACE_EVENTS)
+#include <cmsis-plus/diag/trace-binary.h>
+#endif
+
 // ----------------------------------------------------------------------------
 
 using namespace os;
@@ -371,6 +377,197 @@ namespace os
         ;
       }
 
+#if defined(OS_INCLUDE_RTOS_MEMORY_RECLAIM)
+
+      /**
+       * @class shrinker
+       * @details
+       * The reclaim functions are called in the context of the
+       * allocation that needs memory, possibly with the memory
+       * resource lock taken (like the out of memory handler),
+       * so they may deallocate to the same resource, but they
+       * must not block.
+       *
+       * @par Example
+       *
+       * @code{.cpp}
+       * std::size_t
+       * shrink_cache (std::size_t bytes, void* args)
+       * {
+       *   return static_cast<my_cache*> (args)->evict (bytes);
+       * }
+       *
+       * memory::shrinker cache_shrinker { shrink_cache, &cache };
+       *
+       * memory::get_default_resource ()->register_shrinker (cache_shrinker);
+       * @endcode
+       */
+
+      shrinker::shrinker (func_t func, void* args) :
+          func_ (func), //
+          args_ (args)
+      {
+        assert(func != nullptr);
+      }
+
+      /**
+       * @details
+       * The shrinkers are called in the order they were registered,
+       * the most recent last.
+       */
+      void
+      memory_resource::register_shrinker (shrinker& s) noexcept
+      {
+        // ----- Enter critical section ---------------------------------------
+        scheduler::critical_section scs;
+
+        s.next_ = nullptr;
+        shrinker** p = &shrinkers_;
+        while (*p != nullptr)
+          {
+            p = &(*p)->next_;
+          }
+        *p = &s;
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      void
+      memory_resource::unregister_shrinker (shrinker& s) noexcept
+      {
+        // ----- Enter critical section ---------------------------------------
+        scheduler::critical_section scs;
+
+        for (shrinker** p = &shrinkers_; *p != nullptr; p = &(*p)->next_)
+          {
+            if (*p == &s)
+              {
+                *p = s.next_;
+                s.next_ = nullptr;
+                break;
+              }
+          }
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      std::size_t
+      memory_resource::low_water_mark (std::size_t bytes) noexcept
+      {
+        std::size_t old = low_water_mark_;
+        low_water_mark_ = bytes;
+        return old;
+      }
+
+      std::size_t
+      memory_resource::low_water_mark (void) const noexcept
+      {
+        return low_water_mark_;
+      }
+
+      /**
+       * @details
+       * Call the shrinkers in turn, until they released at least
+       * the requested number of bytes, or all were called.
+       *
+       * Called by the allocators when an allocation fails,
+       * before the out of memory handler, and by `allocate()`,
+       * when free memory is below the low water mark.
+       */
+      std::size_t
+      memory_resource::reclaim (std::size_t bytes) noexcept
+      {
+        if (reclaiming_)
+          {
+            return 0;
+          }
+        reclaiming_ = true;
+
+        std::size_t released = 0;
+        for (shrinker* s = shrinkers_; s != nullptr && released < bytes;
+            s = s->next_)
+          {
+            released += s->func_ (bytes - released, s->args_);
+          }
+
+        reclaiming_ = false;
+
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+        trace::printf ("%s(%u)=%u @%p %s\n", __func__, bytes, released, this,
+                       name ());
+#endif
+
+        return released;
+      }
+
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_RECLAIM) */
+
+#if defined(OS_INCLUDE_RTOS_MEMORY_RESOURCE_LOCKING)
+
+      /**
+       * @details
+       * By default the synchronized allocators lock the scheduler
+       * while using the memory resource, so all threads are
+       * delayed, even those that never touch it.
+       *
+       * With a mutex set, the allocators lock only the mutex, and
+       * the threads that do not use this memory resource are
+       * not delayed. To avoid priority inversions, the mutex should
+       * use the priority inheritance protocol.
+       *
+       * The mutex is not used before the scheduler is started,
+       * when there is a single thread.
+       *
+       * @warning With a mutex set, the allocators can be
+       *  used only from threads, with the scheduler unlocked.
+       */
+      class mutex*
+      memory_resource::locker (class mutex* mx) noexcept
+      {
+        class mutex* old = locker_;
+        locker_ = mx;
+        return old;
+      }
+
+      /**
+       * @class resource_lockable
+       * @details
+       * The mutex is read when locking and remembered, so it is
+       * always the same mutex that is unlocked.
+       */
+
+      void
+      resource_lockable::lock (void)
+      {
+        class mutex* mx = res_->locker ();
+        if (mx != nullptr && scheduler::started ())
+          {
+            assert(!interrupts::in_handler_mode ());
+            assert(!scheduler::locked ());
+
+            mx->lock ();
+            mutex_ = mx;
+          }
+        else
+          {
+            state_ = scheduler::lock ();
+            mutex_ = nullptr;
+          }
+      }
+
+      void
+      resource_lockable::unlock (void)
+      {
+        if (mutex_ != nullptr)
+          {
+            mutex_->unlock ();
+          }
+        else
+          {
+            scheduler::locked (state_);
+          }
+      }
+
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_RESOURCE_LOCKING) */
+
       /**
        * @fn memory_resource::do_allocate()
        * @details
@@ -440,6 +637,165 @@ namespace os
         return 0;
       }
 
+      /**
+       * @details
+       * The default implementation of this virtual function
+       * allocates a block and fills it with zeros.
+       *
+       * Override this function if the memory manager knows
+       * which blocks are already zero.
+       *
+       * @par Standard compliance
+       *   Extension to standard.
+       */
+      void*
+      memory_resource::do_allocate_zeroed (std::size_t bytes,
+                                           std::size_t alignment)
+      {
+        void* mem = do_allocate (bytes, alignment);
+        if (mem != nullptr)
+          {
+            std::memset (mem, 0, bytes);
+          }
+        return mem;
+      }
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+      /**
+       * @details
+       * The default implementation of this virtual function returns
+       * 0, meaning nothing was done.
+       *
+       * Override this function together with `do_allocate_zeroed()`.
+       *
+       * @par Standard compliance
+       *   Extension to standard.
+       */
+      std::size_t
+      memory_resource::do_zero_free (std::size_t bytes) noexcept
+      {
+        return 0;
+      }
+
+#pragma GCC diagnostic pop
+
+      /**
+       * @details
+       * Freeing memory from an interrupt handler is not possible,
+       * since the memory managers are protected by scheduler
+       * critical sections.
+       *
+       * Instead, the block is pushed onto a lock-free list, using
+       * its first word as link, and it is deallocated later, in
+       * a batch, by `drain_deferred()`, called by the next
+       * `allocate()`, or by the idle thread for the default
+       * memory resources.
+       *
+       * The block must have been allocated with `allocate()` from
+       * this memory resource, and be at least as large as a pointer;
+       * it is deallocated with unknown size, like with `free()`.
+       *
+       * @note Can be invoked from Interrupt Service Routines.
+       *
+       * @par Standard compliance
+       *   Extension to standard.
+       */
+      void
+      memory_resource::deallocate_deferred (void* addr) noexcept
+      {
+        if (addr == nullptr)
+          {
+            return;
+          }
+
+        void** link = static_cast<void**> (addr);
+        void* head = __atomic_load_n (&deferred_, __ATOMIC_RELAXED);
+        do
+          {
+            *link = head;
+          }
+        while (!__atomic_compare_exchange_n (&deferred_, &head, addr, true,
+                                             __ATOMIC_RELEASE,
+                                             __ATOMIC_RELAXED));
+      }
+
+      /**
+       * @details
+       * The entire list is detached with a single atomic exchange,
+       * so interrupt handlers may continue to add blocks meanwhile.
+       *
+       * Must be called with the same lock as `deallocate()`.
+       *
+       * @warning Cannot be invoked from Interrupt Service Routines.
+       *
+       * @par Standard compliance
+       *   Extension to standard.
+       */
+      std::size_t
+      memory_resource::drain_deferred (void) noexcept
+      {
+        void* block = __atomic_exchange_n (&deferred_, nullptr,
+                                           __ATOMIC_ACQUIRE);
+
+        std::size_t count = 0;
+        while (block != nullptr)
+          {
+            void* next = *static_cast<void**> (block);
+
+            // The size is not known, pass 0.
+            deallocate (block, 0);
+
+            block = next;
+            ++count;
+          }
+
+#if defined(OS_TRACE_LIBCPP_MEMORY_RESOURCE)
+        if (count != 0)
+          {
+            trace::printf ("%s()=%u @%p %s\n", __func__, count, this,
+                           name ());
+          }
+#endif
+
+        return count;
+      }
+
+      /**
+       * @details
+       * The default implementation of this virtual function
+       * allocates a new block, copies the content and deallocates
+       * the old block. If the old size is not known, _new_bytes_
+       * are copied, as the traditional `realloc()` implementations do.
+       *
+       * A null _addr_ is equivalent to `allocate()`.
+       *
+       * Override this function to resize the block in place, when
+       * possible, and call this implementation otherwise.
+       *
+       * @par Standard compliance
+       *   Extension to standard.
+       */
+      void*
+      memory_resource::do_reallocate (void* addr, std::size_t old_bytes,
+                                      std::size_t new_bytes,
+                                      std::size_t alignment)
+      {
+        void* mem = allocate (new_bytes, alignment);
+        if (mem != nullptr && addr != nullptr)
+          {
+            std::size_t bytes = new_bytes;
+            if (old_bytes != 0 && old_bytes < new_bytes)
+              {
+                bytes = old_bytes;
+              }
+            std::memcpy (mem, addr, bytes);
+            deallocate (addr, old_bytes, alignment);
+          }
+        return mem;
+      }
+
       /**
        * @details
        * The default implementation of this virtual function
@@ -472,9 +828,165 @@ namespace os
         return false;
       }
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY)
+
+      /**
+       * @details
+       * The default implementation of this virtual function returns
+       * 0, meaning the size is not known.
+       *
+       * Override this function to walk the free lists.
+       *
+       * @par Standard compliance
+       *   Extension to standard.
+       */
+      std::size_t
+      memory_resource::do_largest_free_chunk (void) const noexcept
+      {
+        return 0;
+      }
+
+      /**
+       * @details
+       * The index is computed as `1000 - largest * 1000 / free`; 0 means
+       * all free memory is in a single chunk, values close to 1000 mean
+       * the free memory is split in many small chunks, and large requests
+       * may fail even if the total free memory seems enough.
+       *
+       * If the largest free chunk is not known, or there is no free
+       * memory, the result is 0.
+       *
+       * @par Standard compliance
+       *   Extension to standard.
+       */
+      std::size_t
+      memory_resource::fragmentation (void) const noexcept
+      {
+        std::size_t largest = do_largest_free_chunk ();
+        if (largest == 0 || free_bytes_ == 0 || largest >= free_bytes_)
+          {
+            return 0;
+          }
+
+        // Compute in 64-bits, to avoid overflows on large arenas.
+        return 1000
+            - static_cast<std::size_t> (static_cast<uint64_t> (largest) * 1000
+                / free_bytes_);
+      }
+
+      /**
+       * @details
+       * Copy all counters to the caller structure, together with the
+       * values computed now, like the largest free chunk and the
+       * fragmentation index.
+       *
+       * To get a consistent snapshot, call it with the same locking
+       * as used around `allocate()` and `deallocate()`.
+       *
+       * @par Standard compliance
+       *   Extension to standard.
+       */
+      void
+      memory_resource::snapshot (usage_t& out) const noexcept
+      {
+        out.total_bytes = total_bytes_;
+        out.allocated_bytes = allocated_bytes_;
+        out.free_bytes = free_bytes_;
+        out.allocated_chunks = allocated_chunks_;
+        out.free_chunks = free_chunks_;
+        out.max_allocated_bytes = max_allocated_bytes_;
+        out.max_allocated_chunks = max_allocated_chunks_;
+        out.min_free_bytes =
+            (min_free_bytes_ < free_bytes_) ? min_free_bytes_ : free_bytes_;
+        out.largest_free_chunk = do_largest_free_chunk ();
+        out.fragmentation = fragmentation ();
+        out.allocations = allocations_;
+        out.deallocations = deallocations_;
+        out.failures = failures_;
+        out.largest_failed_bytes = largest_failed_bytes_;
+        for (std::size_t i = 0; i < histogram_buckets; ++i)
+          {
+            out.histogram[i] = histogram_[i];
+          }
+      }
+
+      void
+      memory_resource::internal_record_request_ (std::size_t bytes,
+                                                 void* addr) noexcept
+      {
+        // Bucket i holds 2^i..2^(i+1)-1 bytes.
+        std::size_t i = 0;
+        for (std::size_t b = bytes; b > 1 && i < histogram_buckets - 1;
+            b >>= 1)
+          {
+            ++i;
+          }
+        ++histogram_[i];
+
+        if (addr == nullptr)
+          {
+            ++failures_;
+            if (bytes > largest_failed_bytes_)
+              {
+                largest_failed_bytes_ = bytes;
+              }
+          }
+      }
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY) */
+
+#if defined(OS_INCLUDE_RTOS_MEMORY_TRACE_EVENTS)
+
+      constexpr std::size_t memory_resource::trace_allocation;
+      constexpr std::size_t memory_resource::trace_deallocation;
+
+      /**
+       * @details
+       * The records have four arguments: the memory resource,
+       * the block address, the number of bytes and the call site;
+       * the binary trace adds the timestamp. Failed allocations
+       * are recorded with a null address, and a reallocation as a
+       * deallocation followed by an allocation, so the host tools
+       * can replay the sequence with other allocators.
+       */
+      void
+      memory_resource::internal_trace_event_ (std::size_t event, void* addr,
+                                              std::size_t bytes) noexcept
+      {
+        // Persistent formats, also used by the host tools
+        // to identify the records.
+        static const char* const formats[] =
+          { "heap alloc %p %p %u %p\n", "heap free %p %p %u %p\n" };
+
+        const trace::binary::word_t args[] =
+          { trace::binary::to_word (this), trace::binary::to_word (addr),
+              trace::binary::to_word (bytes),
+              trace::binary::to_word (__builtin_return_address (0)) };
+
+        trace::binary::record (formats[event], args,
+                               sizeof(args) / sizeof(args[0]));
+      }
+
+#endif /* defined(OS_INCLUDE_RTOS_MEMORY_TRACE_EVENTS) */
+
       void
       memory_resource::internal_increase_allocated_statistics (
           std::size_t bytes) noexcept
+      {
+        ++allocated_chunks_;
+        --free_chunks_;
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY)
+        if (allocated_chunks_ > max_allocated_chunks_)
+          {
+            max_allocated_chunks_ = allocated_chunks_;
+          }
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY) */
+
+        internal_grow_allocated_statistics (bytes);
+      }
+
+      void
+      memory_resource::internal_grow_allocated_statistics (std::size_t bytes) noexcept
       {
         // Update statistics.
         // What is subtracted from free is added to allocated.
@@ -484,8 +996,12 @@ namespace os
             max_allocated_bytes_ = allocated_bytes_;
           }
         free_bytes_ -= bytes;
-        ++allocated_chunks_;
-        --free_chunks_;
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY)
+        if (free_bytes_ < min_free_bytes_)
+          {
+            min_free_bytes_ = free_bytes_;
+          }
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY) */
       }
 
       void
@@ -501,6 +1017,361 @@ namespace os
 
       }
 
+#if defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE)
+
+      // ======================================================================
+
+      /**
+       * @details
+       * If the scheduler was started, the block is allocated via
+       * the current thread cache, otherwise directly from the
+       * application default memory resource.
+       *
+       * All blocks have a header, which tells if the block
+       * belongs to a cache size class; it must be deallocated
+       * only with `deallocate_cached()`.
+       *
+       * @warning Cannot be invoked from Interrupt Service Routines.
+       */
+      void*
+      allocate_cached (std::size_t bytes)
+      {
+        assert(!interrupts::in_handler_mode ());
+
+        if (scheduler::started ())
+          {
+            return this_thread::thread ().allocation_cache ().allocate (bytes);
+          }
+
+        return allocation_cache::internal_allocate_direct_ (bytes);
+      }
+
+      /**
+       * @details
+       * Blocks with the default alignment are allocated as
+       * usual; over-aligned blocks do not belong to any cache
+       * size class and are allocated directly from the
+       * application default memory resource, with the
+       * alignment passed along.
+       *
+       * @warning Cannot be invoked from Interrupt Service Routines.
+       */
+      void*
+      allocate_cached (std::size_t bytes, std::size_t alignment)
+      {
+        if (alignment <= allocation_cache::header_bytes)
+          {
+            return allocate_cached (bytes);
+          }
+
+        assert(!interrupts::in_handler_mode ());
+
+        return allocation_cache::internal_allocate_direct_ (bytes, alignment);
+      }
+
+      /**
+       * @details
+       * The block is added to the current thread cache,
+       * regardless of the thread that allocated it.
+       *
+       * @warning Cannot be invoked from Interrupt Service Routines.
+       */
+      void
+      deallocate_cached (void* addr) noexcept
+      {
+        assert(!interrupts::in_handler_mode ());
+
+        if (scheduler::started ())
+          {
+            this_thread::thread ().allocation_cache ().deallocate (addr);
+            return;
+          }
+
+        allocation_cache::internal_deallocate_direct_ (addr);
+      }
+
+      /**
+       * @cond ignore
+       */
+
+      namespace
+      {
+        // The header of the blocks not in the cache size classes.
+        constexpr std::size_t direct_tag = 0;
+
+        inline std::size_t&
+        block_tag (void* block)
+        {
+          return *static_cast<std::size_t*> (block);
+        }
+
+        inline std::size_t
+        class_block_bytes (std::size_t cls)
+        {
+          return allocation_cache::header_bytes
+              + (allocation_cache::min_bytes << cls);
+        }
+      } /* namespace */
+
+      /**
+       * @endcond
+       */
+
+      /**
+       * @details
+       * The cached blocks are returned to the memory resource.
+       */
+      allocation_cache::~allocation_cache ()
+      {
+        flush ();
+      }
+
+      /**
+       * @details
+       * Blocks up to the size of the largest class are taken from
+       * the list of the smallest class that fits, without locking
+       * the scheduler; only when the list is empty, it is refilled
+       * with a batch of blocks, in a single critical section.
+       *
+       * Larger blocks are allocated directly from the memory resource.
+       */
+      void*
+      allocation_cache::allocate (std::size_t bytes)
+      {
+        if (bytes > (min_bytes << (classes - 1)))
+          {
+            return internal_allocate_direct_ (bytes);
+          }
+
+        std::size_t cls = 0;
+        while ((min_bytes << cls) < bytes)
+          {
+            ++cls;
+          }
+
+        if (lists_[cls] == nullptr)
+          {
+            if (!internal_refill_ (cls))
+              {
+                return nullptr;
+              }
+          }
+
+        block_t* block = lists_[cls];
+        lists_[cls] = block->next;
+        --counts_[cls];
+        cached_bytes_ -= class_block_bytes (cls);
+
+        block_tag (block) = cls + 1;
+        return reinterpret_cast<char*> (block) + header_bytes;
+      }
+
+      /**
+       * @details
+       * Blocks of a cache size class are added to the list, and
+       * if the list becomes too long, a batch of blocks is
+       * returned to the memory resource, in a single critical section.
+       */
+      void
+      allocation_cache::deallocate (void* addr) noexcept
+      {
+        void* block = static_cast<char*> (addr) - header_bytes;
+        std::size_t tag = block_tag (block);
+        if (tag == direct_tag || tag > classes)
+          {
+            internal_deallocate_direct_ (addr);
+            return;
+          }
+
+        std::size_t cls = tag - 1;
+        assert(cls < classes);
+
+        block_t* b = static_cast<block_t*> (block);
+        b->next = lists_[cls];
+        lists_[cls] = b;
+        ++counts_[cls];
+        cached_bytes_ += class_block_bytes (cls);
+
+        if (counts_[cls] > 2 * batch)
+          {
+            internal_release_ (cls, batch);
+          }
+      }
+
+      /**
+       * @details
+       * Called when the thread is destroyed.
+       */
+      void
+      allocation_cache::flush (void) noexcept
+      {
+        for (std::size_t cls = 0; cls < classes; ++cls)
+          {
+            if (counts_[cls] != 0)
+              {
+                internal_release_ (cls, counts_[cls]);
+              }
+          }
+      }
+
+      /**
+       * @details
+       * The blocks allocated by the other threads, but
+       * deallocated by this thread, are also included.
+       */
+      std::size_t
+      allocation_cache::cached_bytes (void)
+      {
+        return cached_bytes_;
+      }
+
+      /**
+       * @details
+       * The blocks are accounted in the `cached_bytes()` statistics
+       * of the memory resource, while they belong to a cache.
+       */
+      bool
+      allocation_cache::internal_refill_ (std::size_t cls)
+      {
+        memory_resource* res = estd::pmr::get_default_resource ();
+        std::size_t bytes = class_block_bytes (cls);
+
+        std::size_t count = 0;
+          {
+            // ----- Enter critical section -----------------------------------
+            scheduler::critical_section scs;
+
+            for (; count < batch; ++count)
+              {
+                block_t* block = static_cast<block_t*> (res->allocate (bytes));
+                if (block == nullptr)
+                  {
+                    break;
+                  }
+                block->next = lists_[cls];
+                lists_[cls] = block;
+              }
+            res->cached_bytes_ += count * bytes;
+            // ----- Exit critical section ------------------------------------
+          }
+
+        counts_[cls] += count;
+        cached_bytes_ += count * bytes;
+
+        return count != 0;
+      }
+
+      /**
+       * @details
+       */
+      void
+      allocation_cache::internal_release_ (std::size_t cls, std::size_t count) noexcept
+      {
+        memory_resource* res = estd::pmr::get_default_resource ();
+        std::size_t bytes = class_block_bytes (cls);
+
+          {
+            // ----- Enter critical section -----------------------------------
+            scheduler::critical_section scs;
+
+            for (std::size_t i = 0; i < count; ++i)
+              {
+                block_t* block = lists_[cls];
+                lists_[cls] = block->next;
+                res->deallocate (block, bytes);
+              }
+            res->cached_bytes_ -= count * bytes;
+            // ----- Exit critical section ------------------------------------
+          }
+
+        counts_[cls] -= count;
+        cached_bytes_ -= count * bytes;
+      }
+
+      /**
+       * @details
+       * The block is allocated from the memory resource,
+       * with a header that tells it does not belong to a cache.
+       *
+       * For over-aligned blocks the header is as large as the
+       * alignment, and the tag, stored right before the payload,
+       * is the header size, always larger than the number of
+       * size classes.
+       */
+      void*
+      allocation_cache::internal_allocate_direct_ (std::size_t bytes,
+                                                   std::size_t alignment)
+      {
+        std::size_t prefix = max (alignment, header_bytes);
+        if (bytes > (static_cast<std::size_t> (-1) - prefix))
+          {
+            return nullptr;
+          }
+
+        void* block;
+          {
+            // ----- Enter critical section -----------------------------------
+            scheduler::critical_section scs;
+
+            block = estd::pmr::get_default_resource ()->allocate (
+                bytes + prefix, max (alignment, memory_resource::max_align));
+            // ----- Exit critical section ------------------------------------
+          }
+
+        if (block == nullptr)
+          {
+            return nullptr;
+          }
+
+        char* payload = static_cast<char*> (block) + prefix;
+        if (prefix == header_bytes)
+          {
+            block_tag (block) = direct_tag;
+          }
+        else
+          {
+            assert(prefix > classes);
+            block_tag (payload - header_bytes) = prefix;
+          }
+        return payload;
+      }
+
+      /**
+       * @details
+       * Used when there is no current thread; blocks of a cache
+       * size class are also returned to the memory resource.
+       */
+      void
+      allocation_cache::internal_deallocate_direct_ (void* addr) noexcept
+      {
+        void* block = static_cast<char*> (addr) - header_bytes;
+        std::size_t tag = block_tag (block);
+
+        memory_resource* res = estd::pmr::get_default_resource ();
+
+        // ----- Enter critical section ---------------------------------------
+        scheduler::critical_section scs;
+
+        if (tag == direct_tag)
+          {
+            // The unknown size is passed as 0.
+            res->deallocate (block, 0);
+          }
+        else if (tag > classes)
+          {
+            // Over-aligned block, the tag is the header size.
+            res->deallocate (static_cast<char*> (addr) - tag, 0, tag);
+          }
+        else
+          {
+            res->deallocate (block, class_block_bytes (tag - 1));
+            res->cached_bytes_ -= class_block_bytes (tag - 1);
+          }
+        // ----- Exit critical section ----------------------------------------
+      }
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE) */
+
     // ------------------------------------------------------------------------
 
     } /* namespace memory */
@@ -183,7 +183,8 @@ namespace os
     memory_pool::memory_pool ()
     {
 #if defined(OS_TRACE_RTOS_MEMPOOL)
-      trace::printf ("%s() @%p %s\n", __func__, this, this->name ());
+      OS_TRACE_PRINTF (rtos_mempool, "%s() @%p %s\n", __func__, this,
+                       this->name ());
 #endif
     }
 
@@ -192,7 +193,8 @@ namespace os
           { name }
     {
 #if defined(OS_TRACE_RTOS_MEMPOOL)
-      trace::printf ("%s() @%p %s\n", __func__, this, this->name ());
+      OS_TRACE_PRINTF (rtos_mempool, "%s() @%p %s\n", __func__, this,
+                       this->name ());
 #endif
     }
 
@@ -267,8 +269,8 @@ namespace os
           { name }
     {
 #if defined(OS_TRACE_RTOS_MEMPOOL)
-      trace::printf ("%s() @%p %s %u %u\n", __func__, this, this->name (),
-                     blocks, block_size_bytes);
+      OS_TRACE_PRINTF (rtos_mempool, "%s() @%p %s %u %u\n", __func__, this,
+                       this->name (), blocks, block_size_bytes);
 #endif
 
       if (attr.mp_pool_address != nullptr)
@@ -353,8 +355,9 @@ namespace os
                                                    p, sz));
 
 #if defined(OS_TRACE_RTOS_MEMPOOL)
-      trace::printf ("%s() @%p %s %u %u %p %u\n", __func__, this, name (),
-                     blocks_, block_size_bytes_, pool_addr_, pool_size_bytes_);
+      OS_TRACE_PRINTF (rtos_mempool, "%s() @%p %s %u %u %p %u\n", __func__,
+                       this, name (), blocks_, block_size_bytes_, pool_addr_,
+                       pool_size_bytes_);
 #endif
 
       std::size_t storage_size = compute_allocated_size_bytes<void*> (
@@ -371,8 +374,14 @@ namespace os
       // The pool must have a real address.
       os_assert_throw(pool_addr_ != nullptr, ENOMEM);
 
+      lock_free_ = attr.mp_lock_free;
+
       internal_init_ ();
 
+#if defined(OS_INCLUDE_RTOS_OBJECT_REGISTRY)
+      registry::internal_insert (this, registry::type::memory_pool);
+#endif /* defined(OS_INCLUDE_RTOS_OBJECT_REGISTRY) */
+
     }
 
     /**
@@ -398,9 +407,13 @@ namespace os
     memory_pool::~memory_pool ()
     {
 #if defined(OS_TRACE_RTOS_MEMPOOL)
-      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+      OS_TRACE_PRINTF (rtos_mempool, "%s() @%p %s\n", __func__, this, name ());
 #endif
 
+#if defined(OS_INCLUDE_RTOS_OBJECT_REGISTRY)
+      registry::internal_erase (this, registry::type::memory_pool);
+#endif /* defined(OS_INCLUDE_RTOS_OBJECT_REGISTRY) */
+
       // There must be no threads waiting for this pool.
       assert(list_.empty ());
 
@@ -425,24 +438,27 @@ namespace os
     void
     memory_pool::internal_init_ (void)
     {
-      // Construct a linked list of blocks. Store the pointer at
+      if (lock_free_)
+        {
+          lock_free_list_.init (pool_addr_, blocks_, block_size_bytes_);
+          first_ = nullptr;
+
+          count_ = 0; // No allocated blocks.
+          return;
+        }
+
+      // Construct a linked list of blocks. Store the link at
       // the beginning of each block. Each block
-      // will hold the address of the next free block, or nullptr at the end.
+      // will point to the next adjacent one, and the last one
+      // to the pool end, which means nullptr.
       char* p = static_cast<char*> (pool_addr_);
-      for (std::size_t i = 1; i < blocks_; ++i)
+      for (std::size_t i = 0; i < blocks_; ++i)
         {
-          // Compute the address of the next block;
-          char* pn = p + block_size_bytes_;
-
-          // Make this block point to the next one.
-          *(static_cast<void**> (static_cast<void*> (p))) = pn;
+          internal_link_free_ (p, p + block_size_bytes_);
           // Advance pointer
-          p = pn;
+          p += block_size_bytes_;
         }
 
-      // Mark end of list.
-      *(static_cast<void**> (static_cast<void*> (p))) = nullptr;
-
       first_ = pool_addr_; // Pointer to first block.
 
       count_ = 0; // No allocated blocks.
@@ -451,15 +467,26 @@ namespace os
     /*
      * Internal function used to return the first block in the
      * free list.
-     * Should be called from an interrupts critical section.
+     * Should be called from an interrupts critical section,
+     * unless the pool is lock-free.
      */
     void*
     memory_pool::internal_try_first_ (void)
     {
+      if (lock_free_)
+        {
+          void* p = lock_free_list_.pop ();
+          if (p != nullptr)
+            {
+              __atomic_add_fetch (&count_, 1, __ATOMIC_RELAXED);
+            }
+          return p;
+        }
+
       if (first_ != nullptr)
         {
           void* p = static_cast<void*> (first_);
-          first_ = *(static_cast<void**> (first_));
+          first_ = internal_next_free_ (p);
           ++count_;
           return p;
         }
@@ -467,6 +494,70 @@ namespace os
       return nullptr;
     }
 
+    /*
+     * Internal function used to detach up to n blocks from the
+     * beginning of the free list, and count them once.
+     * Should be called from an interrupts critical section,
+     * unless the pool is lock-free.
+     */
+    std::size_t
+    memory_pool::internal_try_first_n_ (void** blocks, std::size_t n)
+    {
+      std::size_t i = 0;
+      if (lock_free_)
+        {
+          for (; i < n; ++i)
+            {
+              blocks[i] = lock_free_list_.pop ();
+              if (blocks[i] == nullptr)
+                {
+                  break;
+                }
+            }
+          __atomic_add_fetch (&count_, i, __ATOMIC_RELAXED);
+          return i;
+        }
+
+      void* p = first_;
+      for (; i < n && p != nullptr; ++i)
+        {
+          blocks[i] = p;
+          p = internal_next_free_ (p);
+        }
+      first_ = p;
+      count_ += static_cast<memory_pool::size_t> (i);
+
+      return i;
+    }
+
+    /*
+     * The link stored in a free block is the offset of the next
+     * free block from the adjacent block, and the pool end means
+     * the end of the list; thus a zero filled pool is already
+     * a list of all blocks, and the constant initialised pools
+     * need no run-time construction.
+     */
+    void*
+    memory_pool::internal_next_free_ (void* block) const
+    {
+      char* adjacent = static_cast<char*> (block) + block_size_bytes_;
+      char* next = adjacent + *(static_cast<std::ptrdiff_t*> (block));
+      if (next == static_cast<char*> (pool_addr_) + blocks_ * block_size_bytes_)
+        {
+          return nullptr;
+        }
+      return next;
+    }
+
+    void
+    memory_pool::internal_link_free_ (void* block, void* next)
+    {
+      char* adjacent = static_cast<char*> (block) + block_size_bytes_;
+      char* end = static_cast<char*> (pool_addr_) + blocks_ * block_size_bytes_;
+      *(static_cast<std::ptrdiff_t*> (block)) = (
+          next != nullptr ? static_cast<char*> (next) : end) - adjacent;
+    }
+
     /**
      * @endcond
      */
@@ -494,7 +585,7 @@ namespace os
     memory_pool::alloc (void)
     {
 #if defined(OS_TRACE_RTOS_MEMPOOL)
-      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+      OS_TRACE_PRINTF (rtos_mempool, "%s() @%p %s\n", __func__, this, name ());
 #endif
 
       // Don't call this from interrupt handlers.
@@ -514,7 +605,8 @@ namespace os
           if (p != nullptr)
             {
 #if defined(OS_TRACE_RTOS_MEMPOOL)
-              trace::printf ("%s()=%p @%p %s\n", __func__, p, this, name ());
+              OS_TRACE_PRINTF (rtos_mempool, "%s()=%p @%p %s\n", __func__, p,
+                               this, name ());
 #endif
               return p;
             }
@@ -539,8 +631,8 @@ namespace os
               if (p != nullptr)
                 {
 #if defined(OS_TRACE_RTOS_MEMPOOL)
-                  trace::printf ("%s()=%p @%p %s\n", __func__, p, this,
-                                 name ());
+                  OS_TRACE_PRINTF (rtos_mempool, "%s()=%p @%p %s\n", __func__,
+                                   p, this, name ());
 #endif
                   return p;
                 }
@@ -560,7 +652,8 @@ namespace os
           if (this_thread::thread ().interrupted ())
             {
 #if defined(OS_TRACE_RTOS_MEMPOOL)
-              trace::printf ("%s() INTR @%p %s\n", __func__, this, name ());
+              OS_TRACE_PRINTF (rtos_mempool, "%s() INTR @%p %s\n", __func__,
+                               this, name ());
 #endif
               return nullptr;
             }
@@ -584,19 +677,27 @@ namespace os
      * This function uses a critical section to protect against simultaneous
      * access from other threads or interrupts.
      *
+     * For lock-free pools, no critical section is used, and the
+     * function can be invoked from interrupts of any priority.
+     *
      * @note Can be invoked from Interrupt Service Routines.
      */
     void*
     memory_pool::try_alloc (void)
     {
 #if defined(OS_TRACE_RTOS_MEMPOOL)
-      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+      OS_TRACE_PRINTF (rtos_mempool, "%s() @%p %s\n", __func__, this, name ());
 #endif
 
       // Don't call this from high priority interrupts.
-      assert(port::interrupts::is_priority_valid ());
+      assert(lock_free_ || port::interrupts::is_priority_valid ());
 
       void* p;
+      if (lock_free_)
+        {
+          p = internal_try_first_ ();
+        }
+      else
         {
           // ----- Enter critical section -------------------------------------
           interrupts::critical_section ics;
@@ -606,7 +707,8 @@ namespace os
         }
 
 #if defined(OS_TRACE_RTOS_MEMPOOL)
-      trace::printf ("%s()=%p @%p %s\n", __func__, p, this, name ());
+      OS_TRACE_PRINTF (rtos_mempool, "%s()=%p @%p %s\n", __func__, p, this,
+                       name ());
 #endif
       return p;
     }
@@ -656,8 +758,8 @@ namespace os
     memory_pool::timed_alloc (clock::duration_t timeout)
     {
 #if defined(OS_TRACE_RTOS_MEMPOOL)
-      trace::printf ("%s(%u) @%p %s\n", __func__,
-                     static_cast<unsigned int> (timeout), this, name ());
+      OS_TRACE_PRINTF (rtos_mempool, "%s(%u) @%p %s\n", __func__,
+                       static_cast<unsigned int> (timeout), this, name ());
 #endif
 
       // Don't call this from interrupt handlers.
@@ -677,7 +779,8 @@ namespace os
           if (p != nullptr)
             {
 #if defined(OS_TRACE_RTOS_MEMPOOL)
-              trace::printf ("%s()=%p @%p %s\n", __func__, p, this, name ());
+              OS_TRACE_PRINTF (rtos_mempool, "%s()=%p @%p %s\n", __func__, p,
+                               this, name ());
 #endif
               return p;
             }
@@ -709,8 +812,8 @@ namespace os
               if (p != nullptr)
                 {
 #if defined(OS_TRACE_RTOS_MEMPOOL)
-                  trace::printf ("%s()=%p @%p %s\n", __func__, p, this,
-                                 name ());
+                  OS_TRACE_PRINTF (rtos_mempool, "%s()=%p @%p %s\n", __func__,
+                                   p, this, name ());
 #endif
                   return p;
                 }
@@ -733,7 +836,8 @@ namespace os
           if (this_thread::thread ().interrupted ())
             {
 #if defined(OS_TRACE_RTOS_MEMPOOL)
-              trace::printf ("%s() INTR @%p %s\n", __func__, this, name ());
+              OS_TRACE_PRINTF (rtos_mempool, "%s() INTR @%p %s\n", __func__,
+                               this, name ());
 #endif
               return nullptr;
             }
@@ -741,7 +845,8 @@ namespace os
           if (clock_->steady_now () >= timeout_timestamp)
             {
 #if defined(OS_TRACE_RTOS_MEMPOOL)
-              trace::printf ("%s() TMO @%p %s\n", __func__, this, name ());
+              OS_TRACE_PRINTF (rtos_mempool, "%s() TMO @%p %s\n", __func__,
+                               this, name ());
 #endif
               return nullptr;
             }
@@ -764,11 +869,12 @@ namespace os
     memory_pool::free (void* block)
     {
 #if defined(OS_TRACE_RTOS_MEMPOOL)
-      trace::printf ("%s(%p) @%p %s\n", __func__, block, this, name ());
+      OS_TRACE_PRINTF (rtos_mempool, "%s(%p) @%p %s\n", __func__, block, this,
+                       name ());
 #endif
 
       // Don't call this from high priority interrupts.
-      assert(port::interrupts::is_priority_valid ());
+      assert(lock_free_ || port::interrupts::is_priority_valid ());
 
       // Validate pointer.
       if ((block < pool_addr_)
@@ -776,12 +882,25 @@ namespace os
               >= (static_cast<char*> (pool_addr_) + blocks_ * block_size_bytes_)))
         {
 #if defined(OS_TRACE_RTOS_MEMPOOL)
-          trace::printf ("%s(%p) EINVAL @%p %s\n", __func__, block, this,
-                         name ());
+          OS_TRACE_PRINTF (rtos_mempool, "%s(%p) EINVAL @%p %s\n", __func__,
+                           block, this, name ());
 #endif
           return EINVAL;
         }
 
+      if (lock_free_)
+        {
+          lock_free_list_.push (block);
+          __atomic_sub_fetch (&count_, 1, __ATOMIC_RELAXED);
+
+          if (!port::interrupts::is_priority_valid ())
+            {
+              // Threads cannot be resumed from high priority interrupts;
+              // they get the block when another one is freed.
+              return result::ok;
+            }
+        }
+      else
         {
           // ----- Enter critical section -------------------------------------
           interrupts::critical_section ics;
@@ -791,7 +910,7 @@ namespace os
 
           // Link previous list to this block; may be null, but it does
           // not matter.
-          *(static_cast<void**> (block)) = first_;
+          internal_link_free_ (block, first_);
 
           // Now this block is the first one.
           first_ = block;
@@ -806,6 +925,239 @@ namespace os
       return result::ok;
     }
 
+    /**
+     * @details
+     * The `alloc_n()` function shall allocate up to `n` blocks
+     * from the memory pool, with a single critical section.
+     *
+     * If the memory pool is empty, `alloc_n()` shall block,
+     * like `alloc()`, until at least one block is freed or until
+     * it is cancelled/interrupted; then it takes as many blocks as are
+     * available, up to `n`. Waiting for all `n` blocks while
+     * keeping some of them might deadlock the threads
+     * allocating in batches, so the caller must check the number
+     * of blocks returned.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    std::size_t
+    memory_pool::alloc_n (void** blocks, std::size_t n)
+    {
+#if defined(OS_TRACE_RTOS_MEMPOOL)
+      OS_TRACE_PRINTF (rtos_mempool, "%s(%u) @%p %s\n", __func__, n, this,
+                       name ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_throw(!interrupts::in_handler_mode (), EPERM);
+      // Don't call this from critical regions.
+      os_assert_throw(!scheduler::locked (), EPERM);
+
+      if (n == 0)
+        {
+          return 0;
+        }
+
+      std::size_t count;
+
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          count = internal_try_first_n_ (blocks, n);
+          if (count != 0)
+            {
+#if defined(OS_TRACE_RTOS_MEMPOOL)
+              OS_TRACE_PRINTF (rtos_mempool, "%s()=%u @%p %s\n", __func__,
+                               count, this, name ());
+#endif
+              return count;
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+
+      thread& crt_thread = this_thread::thread ();
+
+      // Prepare a list node pointing to the current thread.
+      // Do not worry for being on stack, it is temporarily linked to the
+      // list and guaranteed to be removed before this function returns.
+      internal::waiting_thread_node node
+        { crt_thread };
+
+      for (;;)
+        {
+            {
+              // ----- Enter critical section ---------------------------------
+              interrupts::critical_section ics;
+
+              count = internal_try_first_n_ (blocks, n);
+              if (count != 0)
+                {
+#if defined(OS_TRACE_RTOS_MEMPOOL)
+                  OS_TRACE_PRINTF (rtos_mempool, "%s()=%u @%p %s\n",
+                                   __func__, count, this, name ());
+#endif
+                  return count;
+                }
+
+              // Add this thread to the memory pool waiting list.
+              scheduler::internal_link_node (list_, node);
+              // state::suspended set in above link().
+              // ----- Exit critical section ----------------------------------
+            }
+
+          port::scheduler::reschedule ();
+
+          // Remove the thread from the memory pool waiting list,
+          // if not already removed by free().
+          scheduler::internal_unlink_node (node);
+
+          if (this_thread::thread ().interrupted ())
+            {
+#if defined(OS_TRACE_RTOS_MEMPOOL)
+              OS_TRACE_PRINTF (rtos_mempool, "%s() INTR @%p %s\n", __func__,
+                               this, name ());
+#endif
+              return 0;
+            }
+        }
+
+      /* NOTREACHED */
+    }
+
+    /**
+     * @details
+     * Take as many blocks as are available, up to `n`, from the
+     * beginning of the free list, in a single critical section.
+     *
+     * For lock-free pools, no critical section is used, and the
+     * blocks are popped one by one.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    std::size_t
+    memory_pool::try_alloc_n (void** blocks, std::size_t n)
+    {
+#if defined(OS_TRACE_RTOS_MEMPOOL)
+      OS_TRACE_PRINTF (rtos_mempool, "%s(%u) @%p %s\n", __func__, n, this,
+                       name ());
+#endif
+
+      // Don't call this from high priority interrupts.
+      assert(lock_free_ || port::interrupts::is_priority_valid ());
+
+      std::size_t count;
+      if (lock_free_)
+        {
+          count = internal_try_first_n_ (blocks, n);
+        }
+      else
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          count = internal_try_first_n_ (blocks, n);
+          // ----- Exit critical section --------------------------------------
+        }
+
+#if defined(OS_TRACE_RTOS_MEMPOOL)
+      OS_TRACE_PRINTF (rtos_mempool, "%s()=%u @%p %s\n", __func__, count,
+                       this, name ());
+#endif
+      return count;
+    }
+
+    /**
+     * @details
+     * Return `n` memory blocks previously allocated back to the
+     * memory pool. All pointers are validated first, and
+     * if one of them does not belong to the pool, none
+     * is released.
+     *
+     * The blocks are chained together and attached to the
+     * free list in a single critical section; then at most `n`
+     * waiting threads are resumed.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    result_t
+    memory_pool::free_n (void* const * blocks, std::size_t n)
+    {
+#if defined(OS_TRACE_RTOS_MEMPOOL)
+      OS_TRACE_PRINTF (rtos_mempool, "%s(%u) @%p %s\n", __func__, n, this,
+                       name ());
+#endif
+
+      // Don't call this from high priority interrupts.
+      assert(lock_free_ || port::interrupts::is_priority_valid ());
+
+      char* end = static_cast<char*> (pool_addr_) + blocks_ * block_size_bytes_;
+      for (std::size_t i = 0; i < n; ++i)
+        {
+          // Validate pointer.
+          if ((blocks[i] < pool_addr_) || (blocks[i] >= end))
+            {
+#if defined(OS_TRACE_RTOS_MEMPOOL)
+              OS_TRACE_PRINTF (rtos_mempool, "%s(%p) EINVAL @%p %s\n",
+                               __func__, blocks[i], this, name ());
+#endif
+              return EINVAL;
+            }
+        }
+
+      if (n == 0)
+        {
+          return result::ok;
+        }
+
+      if (lock_free_)
+        {
+          for (std::size_t i = 0; i < n; ++i)
+            {
+              lock_free_list_.push (blocks[i]);
+            }
+          __atomic_sub_fetch (&count_, n, __ATOMIC_RELAXED);
+
+          if (!port::interrupts::is_priority_valid ())
+            {
+              // Threads cannot be resumed from high priority interrupts;
+              // they get the blocks when another one is freed.
+              return result::ok;
+            }
+        }
+      else
+        {
+          // Chain the blocks outside the critical section; they are
+          // owned by the caller until attached to the free list.
+          for (std::size_t i = 0; i + 1 < n; ++i)
+            {
+              internal_link_free_ (blocks[i], blocks[i + 1]);
+            }
+
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          // Attach the chain at the beginning of the list.
+          internal_link_free_ (blocks[n - 1], first_);
+          first_ = blocks[0];
+
+          count_ -= static_cast<memory_pool::size_t> (n);
+          // ----- Exit critical section --------------------------------------
+        }
+
+      // Wake-up at most one thread per block; each one
+      // of them may take more blocks, and the others wait again.
+      for (std::size_t i = 0; i < n; ++i)
+        {
+          if (!list_.resume_one ())
+            {
+              break;
+            }
+        }
+
+      return result::ok;
+    }
+
     /**
      * @details
      * Reset the memory pool to the initial state, with all blocks free.
@@ -816,7 +1168,7 @@ namespace os
     memory_pool::reset (void)
     {
 #if defined(OS_TRACE_RTOS_MEMPOOL)
-      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+      OS_TRACE_PRINTF (rtos_mempool, "%s() @%p %s\n", __func__, this, name ());
 #endif
 
       // Don't call this from interrupt handlers.
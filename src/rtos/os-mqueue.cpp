@@ -73,6 +73,29 @@ namespace os
      * checked, but it is recommended to leave it zero.
      */
 
+    /**
+     * @var bool message_queue::attributes::mq_priority_levels
+     * @details
+     * By default, a new message is inserted in the ordered list
+     * by walking back from the tail up to the first message with a
+     * priority not lower than its own, which is fast when all
+     * messages have the same priority, but costs a walk through all
+     * lower priority messages otherwise.
+     *
+     * Set this variable to `true` for long queues with mixed
+     * priorities; the queue keeps the index of the last message
+     * of each priority level, and a map of the used levels, so the
+     * insertion point is found in a time bounded by the number of
+     * map words, regardless of the number of messages, while
+     * receiving remains constant time. The order is the same,
+     * messages with the same priority are delivered in FIFO order.
+     *
+     * The cost is a table of `(max_priority + 1)` indices and
+     * a 256 bits map, added to the queue storage (see
+     * `compute_allocated_size_bytes()`); user provided storage
+     * must include it, and it is not available for the inclusive queues.
+     */
+
     /**
      * @details
      * This variable is used by the default constructor.
@@ -336,7 +359,8 @@ namespace os
     message_queue::message_queue ()
     {
 #if defined(OS_TRACE_RTOS_MQUEUE)
-      trace::printf ("%s() @%p %s\n", __func__, this, this->name ());
+      OS_TRACE_PRINTF (rtos_mqueue, "%s() @%p %s\n", __func__, this,
+                       this->name ());
 #endif
     }
 
@@ -345,7 +369,8 @@ namespace os
           { name }
     {
 #if defined(OS_TRACE_RTOS_MQUEUE)
-      trace::printf ("%s() @%p %s\n", __func__, this, this->name ());
+      OS_TRACE_PRINTF (rtos_mqueue, "%s() @%p %s\n", __func__, this,
+                       this->name ());
 #endif
     }
 
@@ -422,8 +447,8 @@ namespace os
           { name }
     {
 #if defined(OS_TRACE_RTOS_MQUEUE)
-      trace::printf ("%s() @%p %s %u %u\n", __func__, this, this->name (), msgs,
-                     msg_size_bytes);
+      OS_TRACE_PRINTF (rtos_mqueue, "%s() @%p %s %u %u\n", __func__, this,
+                       this->name (), msgs, msg_size_bytes);
 #endif
 
       if (attr.mq_queue_address != nullptr)
@@ -438,7 +463,8 @@ namespace os
           // If no user storage was provided via attributes,
           // allocate it dynamically via the allocator.
           allocated_queue_size_elements_ = (compute_allocated_size_bytes<
-              typename allocator_type::value_type> (msgs, msg_size_bytes)
+              typename allocator_type::value_type> (msgs, msg_size_bytes,
+                                                    attr.mq_priority_levels)
               + sizeof(typename allocator_type::value_type) - 1)
               / sizeof(typename allocator_type::value_type);
 
@@ -473,9 +499,13 @@ namespace os
     message_queue::~message_queue ()
     {
 #if defined(OS_TRACE_RTOS_MQUEUE)
-      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+      OS_TRACE_PRINTF (rtos_mqueue, "%s() @%p %s\n", __func__, this, name ());
 #endif
 
+#if defined(OS_INCLUDE_RTOS_OBJECT_REGISTRY)
+      registry::internal_erase (this, registry::type::message_queue);
+#endif /* defined(OS_INCLUDE_RTOS_OBJECT_REGISTRY) */
+
 #if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
 
       // There must be no threads waiting for this queue.
@@ -545,13 +575,14 @@ namespace os
         }
 
 #if defined(OS_TRACE_RTOS_MQUEUE)
-      trace::printf ("%s() @%p %s %u %u %p %u\n", __func__, this, name (),
-                     msgs_, msg_size_bytes_, queue_addr_, queue_size_bytes_);
+      OS_TRACE_PRINTF (rtos_mqueue, "%s() @%p %s %u %u %p %u\n", __func__, this,
+                       name (), msgs_, msg_size_bytes_, queue_addr_,
+                       queue_size_bytes_);
 #endif
 
 #if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
       std::size_t storage_size = compute_allocated_size_bytes<void*> (
-          msgs, msg_size_bytes);
+          msgs, msg_size_bytes, attr.mq_priority_levels);
 #endif
       if (queue_addr_ != nullptr)
         {
@@ -594,10 +625,30 @@ namespace os
           reinterpret_cast<priority_t*> (reinterpret_cast<char*> (const_cast<index_t*> (next_array_))
               + msgs * sizeof(index_t));
 
+      if (attr.mq_priority_levels)
+        {
+          // The levels map follows the aligned priority array, and
+          // the array of tails follows immediately the map.
+          levels_map_ =
+              reinterpret_cast<uint32_t*> (reinterpret_cast<char*> (const_cast<priority_t*> (prio_array_))
+                  + ((msgs * sizeof(priority_t) + (sizeof(void*) - 1))
+                      & ~(sizeof(void*) - 1)));
+        }
+      else
+        {
+          levels_map_ = nullptr;
+        }
+
 #if !defined(NDEBUG)
       char* p =
           reinterpret_cast<char*> (reinterpret_cast<char*> (const_cast<priority_t*> (prio_array_))
               + msgs * sizeof(priority_t));
+      if (levels_map_ != nullptr)
+        {
+          p =
+              reinterpret_cast<char*> (const_cast<uint32_t*> (levels_map_ + levels_map_words))
+                  + (max_priority + 1) * sizeof(index_t);
+        }
 
       assert(
           p - static_cast<char*> (queue_addr_)
@@ -606,6 +657,10 @@ namespace os
 
       internal_init_ ();
 #endif
+
+#if defined(OS_INCLUDE_RTOS_OBJECT_REGISTRY)
+      registry::internal_insert (this, registry::type::message_queue);
+#endif /* defined(OS_INCLUDE_RTOS_OBJECT_REGISTRY) */
     }
 
     void
@@ -615,29 +670,33 @@ namespace os
 
 #if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
 
-      // Construct a linked list of blocks. Store the pointer at
-      // the beginning of each block. Each block
-      // will hold the address of the next free block,
-      // or `nullptr` at the end.
+      // Construct a linked list of blocks. Store the link at
+      // the beginning of each block. Each block will point
+      // to the next adjacent one, with a zero offset (see
+      // `internal_next_free_()`), and the last one to the
+      // queue end, which means `nullptr`.
       char* p = static_cast<char*> (queue_addr_);
-      for (std::size_t i = 1; i < msgs_; ++i)
+      for (std::size_t i = 0; i < msgs_; ++i)
         {
-          // Compute the address of the next block;
-          char* pn = p + msg_size_bytes_;
-
-          // Make this block point to the next one.
-          *(static_cast<void**> (static_cast<void*> (p))) = pn;
+          *(static_cast<std::ptrdiff_t*> (static_cast<void*> (p))) = 0;
           // Advance pointer
-          p = pn;
+          p += msg_size_bytes_;
         }
 
-      // Mark end of list.
-      *(static_cast<void**> (static_cast<void*> (p))) = nullptr;
-
       first_free_ = queue_addr_; // Pointer to first block.
 
       head_ = no_index;
 
+      if (levels_map_ != nullptr)
+        {
+          // All priority levels are empty; the tails are valid
+          // only for the used levels, and need no initialisation.
+          for (std::size_t i = 0; i < levels_map_words; ++i)
+            {
+              levels_map_[i] = 0;
+            }
+        }
+
       // Need not be inside the critical section,
       // the lists are protected by inner `resume_one()`.
 
@@ -651,49 +710,51 @@ namespace os
 
 #if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
 
+    /*
+     * Internal function.
+     * Out of line, since the port inlines are not yet visible
+     * where the typed templates are defined.
+     */
+    void
+    message_queue::internal_assert_priority_ (void)
+    {
+      assert(port::interrupts::is_priority_valid ());
+    }
+
     /*
      * Internal function.
      * Should be called from an interrupts critical section.
      */
-    bool
-    message_queue::internal_try_send_ (const void* msg, std::size_t nbytes,
-                                       priority_t mprio)
+    void*
+    message_queue::internal_try_reserve_ (void)
     {
       if (first_free_ == nullptr)
         {
           // No available space to send the message.
-          return false;
+          return nullptr;
         }
 
-      // The first step is to remove the free block from the list,
-      // so another concurrent call will not get it too.
+      // Remove the free block from the list, so another
+      // concurrent call will not get it too.
 
-      // Get the address where the message will be copied.
       // This is the first free memory block.
-      char* dest = static_cast<char*> (first_free_);
-
-      // Update to next free, if any (the last one has nullptr).
-      first_free_ = *(static_cast<void**> (first_free_));
-
-      // The second step is to copy the message from the user buffer.
-        {
-          // ----- Enter uncritical section -----------------------------------
-          // interrupts::uncritical_section iucs;
+      void* buf = first_free_;
 
-          // Copy message from user buffer to queue storage.
-          std::memcpy (dest, msg, nbytes);
-          if (nbytes < msg_size_bytes_)
-            {
-              // Fill in the remaining space with 0x00.
-              std::memset (dest + nbytes, 0x00, msg_size_bytes_ - nbytes);
-            }
-          // ----- Exit uncritical section ------------------------------------
-        }
+      // Update to next free, if any.
+      first_free_ = internal_next_free_ (buf);
 
-      // The third step is to link the buffer to the list.
+      return buf;
+    }
 
+    /*
+     * Internal function.
+     * Should be called from an interrupts critical section.
+     */
+    void
+    message_queue::internal_commit_ (void* buf, priority_t mprio)
+    {
       // Using the address, compute the index in the array.
-      std::size_t msg_ix = (static_cast<std::size_t> (dest
+      std::size_t msg_ix = (static_cast<std::size_t> (static_cast<char*> (buf)
           - static_cast<char*> (queue_addr_)) / msg_size_bytes_);
       prio_array_[msg_ix] = mprio;
 
@@ -705,6 +766,31 @@ namespace os
           prev_array_[msg_ix] = static_cast<index_t> (msg_ix);
           next_array_[msg_ix] = static_cast<index_t> (msg_ix);
         }
+      else if (levels_map_ != nullptr)
+        {
+          std::size_t ix;
+          std::size_t level = internal_find_level_ (mprio);
+          if (level <= max_priority)
+            {
+              // Insert after the last message with the same or the
+              // nearest higher level; no need to walk the list.
+              ix = internal_levels_tail_array_ ()[level];
+            }
+          else
+            {
+              // Higher than all others, the new message becomes
+              // the new head, inserted after the tail.
+              ix = prev_array_[head_];
+              head_ = static_cast<index_t> (msg_ix);
+            }
+          prev_array_[msg_ix] = static_cast<index_t> (ix);
+          next_array_[msg_ix] = next_array_[ix];
+
+          // Break the chain and insert the new index.
+          std::size_t tmp_ix = next_array_[ix];
+          next_array_[ix] = static_cast<index_t> (msg_ix);
+          prev_array_[tmp_ix] = static_cast<index_t> (msg_ix);
+        }
       else
         {
           std::size_t ix;
@@ -735,41 +821,68 @@ namespace os
           prev_array_[tmp_ix] = static_cast<index_t> (msg_ix);
         }
 
+      if (levels_map_ != nullptr)
+        {
+          // The new message is the last one of its level.
+          internal_levels_tail_array_ ()[mprio] = static_cast<index_t> (msg_ix);
+          levels_map_[mprio / 32] |= (1u << (mprio % 32));
+        }
+
       // One more message added to the queue.
       ++count_;
-
-      // Wake-up one thread, if any.
-      receive_list_.resume_one ();
-
-      return true;
     }
 
-#endif /* !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE) */
-
-#if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
-
     /*
      * Internal function.
      * Should be called from an interrupts critical section.
+     * The map has a bit for each priority level, set when the level
+     * has messages; the search is bounded by the number of words.
      */
-    bool
-    message_queue::internal_try_receive_ (void* msg, std::size_t nbytes,
-                                          priority_t* mprio)
+    std::size_t
+    message_queue::internal_find_level_ (priority_t mprio) const
     {
+      std::size_t w = mprio / 32;
+      uint32_t bits = levels_map_[w] & (~0u << (mprio % 32));
+      while (bits == 0)
+        {
+          if (++w == levels_map_words)
+            {
+              return max_priority + 1;
+            }
+          bits = levels_map_[w];
+        }
+      return w * 32 + static_cast<std::size_t> (__builtin_ctz (bits));
+    }
 
+    /*
+     * Internal function.
+     * Should be called from an interrupts critical section.
+     */
+    void*
+    message_queue::internal_try_borrow_ (priority_t* mprio)
+    {
       if (head_ == no_index)
         {
-          return false;
+          return nullptr;
         }
 
-      // Compute the message source address.
-      char* src = static_cast<char*> (queue_addr_) + head_ * msg_size_bytes_;
-      priority_t prio = prio_array_[head_];
+      // Compute the message address.
+      void* buf = static_cast<char*> (queue_addr_) + head_ * msg_size_bytes_;
+      if (mprio != nullptr)
+        {
+          *mprio = prio_array_[head_];
+        }
 
-#if defined(OS_TRACE_RTOS_MQUEUE_)
-      trace::printf ("%s(%p,%u) @%p %s src %p %p\n", __func__, msg, nbytes,
-          this, name (), src, first_free_);
-#endif
+      if (levels_map_ != nullptr)
+        {
+          // The head is the first message of the highest level;
+          // if it is also the last one, the level becomes empty.
+          priority_t level = prio_array_[head_];
+          if (internal_levels_tail_array_ ()[level] == head_)
+            {
+              levels_map_[level / 32] &= ~(1u << (level % 32));
+            }
+        }
 
       // Unlink it from the list, so another concurrent call will
       // not get it too.
@@ -790,6 +903,137 @@ namespace os
 
       --count_;
 
+      return buf;
+    }
+
+    /*
+     * Internal function.
+     * Should be called from an interrupts critical section.
+     */
+    void
+    message_queue::internal_release_ (void* buf)
+    {
+      // Perform a push_front() on the single linked LIFO list,
+      // i.e. add the block to the beginning of the list.
+
+      // Link previous list to this block, as the offset from
+      // the adjacent block; null is stored as the queue end.
+      char* adjacent = static_cast<char*> (buf) + msg_size_bytes_;
+      char* end = static_cast<char*> (queue_addr_) + msgs_ * msg_size_bytes_;
+      *(static_cast<std::ptrdiff_t*> (buf)) = (
+          first_free_ != nullptr ? static_cast<char*> (first_free_) : end)
+          - adjacent;
+
+      // Now this block is the first one.
+      first_free_ = buf;
+    }
+
+    /*
+     * Internal function.
+     * The link stored in a free slot is the offset of the next
+     * free slot from the adjacent slot, and the queue end means
+     * the end of the list; thus a zero filled queue is already
+     * a list of all slots, and the constant initialised queues
+     * need no run-time construction.
+     */
+    void*
+    message_queue::internal_next_free_ (void* buf) const
+    {
+      char* adjacent = static_cast<char*> (buf) + msg_size_bytes_;
+      char* next = adjacent + *(static_cast<std::ptrdiff_t*> (buf));
+      if (next == static_cast<char*> (queue_addr_) + msgs_ * msg_size_bytes_)
+        {
+          return nullptr;
+        }
+      return next;
+    }
+
+    /*
+     * Internal function.
+     * Check if the address is the beginning of a message slot.
+     */
+    bool
+    message_queue::internal_is_slot_ (const void* buf) const
+    {
+      const char* p = static_cast<const char*> (buf);
+      const char* base = static_cast<const char*> (queue_addr_);
+      if (p < base || p >= base + msgs_ * msg_size_bytes_)
+        {
+          return false;
+        }
+      return (static_cast<std::size_t> (p - base) % msg_size_bytes_) == 0;
+    }
+
+    /*
+     * Internal function.
+     * Should be called from an interrupts critical section.
+     */
+    bool
+    message_queue::internal_try_send_ (const void* msg, std::size_t nbytes,
+                                       priority_t mprio)
+    {
+      // The first step is to remove the free block from the list,
+      // so another concurrent call will not get it too.
+
+      // Get the address where the message will be copied.
+      char* dest = static_cast<char*> (internal_try_reserve_ ());
+      if (dest == nullptr)
+        {
+          // No available space to send the message.
+          return false;
+        }
+
+      // The second step is to copy the message from the user buffer.
+        {
+          // ----- Enter uncritical section -----------------------------------
+          // interrupts::uncritical_section iucs;
+
+          // Copy message from user buffer to queue storage.
+          std::memcpy (dest, msg, nbytes);
+          if (nbytes < msg_size_bytes_)
+            {
+              // Fill in the remaining space with 0x00.
+              std::memset (dest + nbytes, 0x00, msg_size_bytes_ - nbytes);
+            }
+          // ----- Exit uncritical section ------------------------------------
+        }
+
+      // The third step is to link the buffer to the list.
+      internal_commit_ (dest, mprio);
+
+      // Wake-up one thread, if any.
+      receive_list_.resume_one ();
+
+      return true;
+    }
+
+#endif /* !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE) */
+
+#if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+
+    /*
+     * Internal function.
+     * Should be called from an interrupts critical section.
+     */
+    bool
+    message_queue::internal_try_receive_ (void* msg, std::size_t nbytes,
+                                          priority_t* mprio)
+    {
+      priority_t prio;
+
+      // Unlink the head message from the list, so another concurrent
+      // call will not get it too.
+      char* src = static_cast<char*> (internal_try_borrow_ (&prio));
+      if (src == nullptr)
+        {
+          return false;
+        }
+
+#if defined(OS_TRACE_RTOS_MQUEUE_)
+      trace::printf ("%s(%p,%u) @%p %s src %p %p\n", __func__, msg, nbytes,
+          this, name (), src, first_free_);
+#endif
+
       // Copy to destination
         {
           // ----- Enter uncritical section -----------------------------------
@@ -805,16 +1049,7 @@ namespace os
         }
 
       // After the message was copied, the block can be released.
-
-      // Perform a push_front() on the single linked LIFO list,
-      // i.e. add the block to the beginning of the list.
-
-      // Link previous list to this block; may be null, but it does
-      // not matter.
-      *(static_cast<void**> (static_cast<void*> (src))) = first_free_;
-
-      // Now this block is the first one.
-      first_free_ = src;
+      internal_release_ (src);
 
       // Wake-up one thread, if any.
       send_list_.resume_one ();
@@ -824,54 +1059,152 @@ namespace os
 
 #endif /* !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE) */
 
-    /**
-     * @endcond
-     */
+#if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
 
-    /**
-     * @details
-     * The `send()` function shall add the message
-     * pointed to by the argument
-     * _msg_ to the message queue. The _nbytes_ argument specifies the length
-     * of the message, in bytes, pointed to by _msg_. The value of _nbytes_
-     * shall be less than or equal to the _msg_size_bytes_ parameter of the
-     * message queue object, or `send()` shall fail.
-     *
-     * If the specified message queue is not full, `send()`
-     * shall behave
-     * as if the message is inserted into the message queue at the
-     * position indicated by the _mprio_ argument. A message with a
-     * larger numeric value of _mprio_ shall be inserted before messages
-     * with lower values of _mprio_. A message shall be inserted after
-     * other messages in the queue, if any, with equal _mprio_. The
-     * value of _mprio_ shall be less than `message_queue::max_priority`.
-     *
-     * If the specified message queue is full, `send()`
-     * shall block
-     * until space becomes available to enqueue the message, or
-     * until `send()` is cancelled/interrupted.
-     * If more than one
-     * thread is waiting to send when space becomes available
-     * in the message queue and the Priority Scheduling option is
-     * supported, then the thread of the highest priority that has
-     * been waiting the longest shall be unblocked to send its
-     * message. Otherwise, it is unspecified which waiting thread
-     * is unblocked.
-     *
-     * @par POSIX compatibility
-     *  Inspired by [`mq_send()`](http://pubs.opengroup.org/onlinepubs/9699919799/functions/mq_send.html)
-     *  with `O_NONBLOCK` not set,
-     *  from [<mqueue.h>](http://pubs.opengroup.org/onlinepubs/9699919799/basedefs/mqueue.h.html)
-     *  ([IEEE Std 1003.1, 2013 Edition](http://pubs.opengroup.org/onlinepubs/9699919799/nframe.html)).
+    /*
+     * Internal function.
+     * Should be called from an interrupts critical section.
      *
-     * @warning Cannot be invoked from Interrupt Service Routines.
+     * Enqueue as many messages as fit, then wake-up at most
+     * one receiver for each message; with no waiting receivers
+     * this costs a single check, regardless of the batch size.
+     */
+    std::size_t
+    message_queue::internal_try_send_n_ (const void* msgs, std::size_t nbytes,
+                                         std::size_t count, priority_t mprio)
+    {
+      const char* src = static_cast<const char*> (msgs);
+      std::size_t n;
+      for (n = 0; n < count; ++n, src += nbytes)
+        {
+          char* dest = static_cast<char*> (internal_try_reserve_ ());
+          if (dest == nullptr)
+            {
+              break;
+            }
+
+          std::memcpy (dest, src, nbytes);
+          if (nbytes < msg_size_bytes_)
+            {
+              // Fill in the remaining space with 0x00.
+              std::memset (dest + nbytes, 0x00, msg_size_bytes_ - nbytes);
+            }
+
+          internal_commit_ (dest, mprio);
+        }
+
+      for (std::size_t i = 0; i < n; ++i)
+        {
+          if (!receive_list_.resume_one ())
+            {
+              break;
+            }
+        }
+
+      return n;
+    }
+
+    /*
+     * Internal function.
+     * Should be called from an interrupts critical section.
+     */
+    std::size_t
+    message_queue::internal_try_receive_n_ (void* msgs, std::size_t nbytes,
+                                            std::size_t count,
+                                            priority_t* mprios)
+    {
+      char* dest = static_cast<char*> (msgs);
+      std::size_t n;
+      for (n = 0; n < count; ++n, dest += nbytes)
+        {
+          priority_t prio;
+          char* src = static_cast<char*> (internal_try_borrow_ (&prio));
+          if (src == nullptr)
+            {
+              break;
+            }
+
+            {
+              // ----- Enter uncritical section -------------------------------
+              interrupts::uncritical_section iucs;
+
+              // Copy message from queue to user buffer.
+              memcpy (dest, src, nbytes);
+              if (mprios != nullptr)
+                {
+                  mprios[n] = prio;
+                }
+              // ----- Exit uncritical section --------------------------------
+            }
+
+          internal_release_ (src);
+        }
+
+      for (std::size_t i = 0; i < n; ++i)
+        {
+          if (!send_list_.resume_one ())
+            {
+              break;
+            }
+        }
+
+      return n;
+    }
+
+#endif /* !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE) */
+
+    /**
+     * @endcond
+     */
+
+    /**
+     * @details
+     * The `send()` function shall add the message
+     * pointed to by the argument
+     * _msg_ to the message queue. The _nbytes_ argument specifies the length
+     * of the message, in bytes, pointed to by _msg_. The value of _nbytes_
+     * shall be less than or equal to the _msg_size_bytes_ parameter of the
+     * message queue object, or `send()` shall fail.
+     *
+     * If the specified message queue is not full, `send()`
+     * shall behave
+     * as if the message is inserted into the message queue at the
+     * position indicated by the _mprio_ argument. A message with a
+     * larger numeric value of _mprio_ shall be inserted before messages
+     * with lower values of _mprio_. A message shall be inserted after
+     * other messages in the queue, if any, with equal _mprio_. The
+     * value of _mprio_ shall be less than `message_queue::max_priority`.
+     *
+     * If the specified message queue is full, `send()`
+     * shall block
+     * until space becomes available to enqueue the message, or
+     * until `send()` is cancelled/interrupted.
+     * If more than one
+     * thread is waiting to send when space becomes available
+     * in the message queue and the Priority Scheduling option is
+     * supported, then the thread of the highest priority that has
+     * been waiting the longest shall be unblocked to send its
+     * message. Otherwise, it is unspecified which waiting thread
+     * is unblocked.
+     *
+     * @par POSIX compatibility
+     *  Inspired by [`mq_send()`](http://pubs.opengroup.org/onlinepubs/9699919799/functions/mq_send.html)
+     *  with `O_NONBLOCK` not set,
+     *  from [<mqueue.h>](http://pubs.opengroup.org/onlinepubs/9699919799/basedefs/mqueue.h.html)
+     *  ([IEEE Std 1003.1, 2013 Edition](http://pubs.opengroup.org/onlinepubs/9699919799/nframe.html)).
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
      */
     result_t
     message_queue::send (const void* msg, std::size_t nbytes, priority_t mprio)
     {
+#if defined(OS_INCLUDE_RTOS_TRACE_EVENTS)
+      os_rtos_trace_object (os_rtos_trace_mqueue_send, this);
+#endif /* defined(OS_INCLUDE_RTOS_TRACE_EVENTS) */
+
 #if defined(OS_TRACE_RTOS_MQUEUE)
-      trace::printf ("%s(%p,%d,%d) @%p %s\n", __func__, msg, nbytes, mprio,
-                     this, name ());
+      OS_TRACE_PRINTF (rtos_mqueue, "%s(%p,%d,%d) @%p %s\n", __func__, msg,
+                       nbytes, mprio, this, name ());
 #endif
 
       // Don't call this from interrupt handlers.
@@ -933,8 +1266,8 @@ namespace os
           if (crt_thread.interrupted ())
             {
 #if defined(OS_TRACE_RTOS_MQUEUE)
-              trace::printf ("%s(%p,%d,%d) EINTR @%p %s\n", __func__, msg,
-                             nbytes, mprio, this, name ());
+              OS_TRACE_PRINTF (rtos_mqueue, "%s(%p,%d,%d) EINTR @%p %s\n",
+                               __func__, msg, nbytes, mprio, this, name ());
 #endif
               return EINTR;
             }
@@ -981,9 +1314,13 @@ namespace os
     message_queue::try_send (const void* msg, std::size_t nbytes,
                              priority_t mprio)
     {
+#if defined(OS_INCLUDE_RTOS_TRACE_EVENTS)
+      os_rtos_trace_object (os_rtos_trace_mqueue_send, this);
+#endif /* defined(OS_INCLUDE_RTOS_TRACE_EVENTS) */
+
 #if defined(OS_TRACE_RTOS_MQUEUE)
-      trace::printf ("%s(%p,%u,%u) @%p %s\n", __func__, msg, nbytes, mprio,
-                     this, name ());
+      OS_TRACE_PRINTF (rtos_mqueue, "%s(%p,%u,%u) @%p %s\n", __func__, msg,
+                       nbytes, mprio, this, name ());
 #endif
 
       os_assert_err(msg != nullptr, EINVAL);
@@ -1065,9 +1402,13 @@ namespace os
     message_queue::timed_send (const void* msg, std::size_t nbytes,
                                clock::duration_t timeout, priority_t mprio)
     {
+#if defined(OS_INCLUDE_RTOS_TRACE_EVENTS)
+      os_rtos_trace_object (os_rtos_trace_mqueue_send, this);
+#endif /* defined(OS_INCLUDE_RTOS_TRACE_EVENTS) */
+
 #if defined(OS_TRACE_RTOS_MQUEUE)
-      trace::printf ("%s(%p,%u,%u,%u) @%p %s\n", __func__, msg, nbytes, mprio,
-                     timeout, this, name ());
+      OS_TRACE_PRINTF (rtos_mqueue, "%s(%p,%u,%u,%u) @%p %s\n", __func__, msg,
+                       nbytes, mprio, timeout, this, name ());
 #endif
 
       // Don't call this from interrupt handlers.
@@ -1142,8 +1483,9 @@ namespace os
           if (crt_thread.interrupted ())
             {
 #if defined(OS_TRACE_RTOS_MQUEUE)
-              trace::printf ("%s(%p,%u,%u,%u) EINTR @%p %s\n", __func__, msg,
-                             nbytes, mprio, timeout, this, name ());
+              OS_TRACE_PRINTF (rtos_mqueue, "%s(%p,%u,%u,%u) EINTR @%p %s\n",
+                               __func__, msg, nbytes, mprio, timeout, this,
+                               name ());
 #endif
               return EINTR;
             }
@@ -1151,8 +1493,9 @@ namespace os
           if (clock_->steady_now () >= timeout_timestamp)
             {
 #if defined(OS_TRACE_RTOS_MQUEUE)
-              trace::printf ("%s(%p,%u,%u,%u) ETIMEDOUT @%p %s\n", __func__,
-                             msg, nbytes, mprio, timeout, this, name ());
+              OS_TRACE_PRINTF (rtos_mqueue,
+                               "%s(%p,%u,%u,%u) ETIMEDOUT @%p %s\n", __func__,
+                               msg, nbytes, mprio, timeout, this, name ());
 #endif
               return ETIMEDOUT;
             }
@@ -1201,9 +1544,13 @@ namespace os
     result_t
     message_queue::receive (void* msg, std::size_t nbytes, priority_t* mprio)
     {
+#if defined(OS_INCLUDE_RTOS_TRACE_EVENTS)
+      os_rtos_trace_object (os_rtos_trace_mqueue_receive, this);
+#endif /* defined(OS_INCLUDE_RTOS_TRACE_EVENTS) */
+
 #if defined(OS_TRACE_RTOS_MQUEUE)
-      trace::printf ("%s(%p,%u) @%p %s\n", __func__, msg, nbytes, this,
-                     name ());
+      OS_TRACE_PRINTF (rtos_mqueue, "%s(%p,%u) @%p %s\n", __func__, msg, nbytes,
+                       this, name ());
 #endif
 
       // Don't call this from interrupt handlers.
@@ -1267,8 +1614,8 @@ namespace os
           if (crt_thread.interrupted ())
             {
 #if defined(OS_TRACE_RTOS_MQUEUE)
-              trace::printf ("%s(%p,%u) EINTR @%p %s\n", __func__, msg, nbytes,
-                             this, name ());
+              OS_TRACE_PRINTF (rtos_mqueue, "%s(%p,%u) EINTR @%p %s\n",
+                               __func__, msg, nbytes, this, name ());
 #endif
               return EINTR;
             }
@@ -1314,9 +1661,13 @@ namespace os
     message_queue::try_receive (void* msg, std::size_t nbytes,
                                 priority_t* mprio)
     {
+#if defined(OS_INCLUDE_RTOS_TRACE_EVENTS)
+      os_rtos_trace_object (os_rtos_trace_mqueue_receive, this);
+#endif /* defined(OS_INCLUDE_RTOS_TRACE_EVENTS) */
+
 #if defined(OS_TRACE_RTOS_MQUEUE)
-      trace::printf ("%s(%p,%u) @%p %s\n", __func__, msg, nbytes, this,
-                     name ());
+      OS_TRACE_PRINTF (rtos_mqueue, "%s(%p,%u) @%p %s\n", __func__, msg, nbytes,
+                       this, name ());
 #endif
 
       os_assert_err(msg != nullptr, EINVAL);
@@ -1412,9 +1763,13 @@ namespace os
     message_queue::timed_receive (void* msg, std::size_t nbytes,
                                   clock::duration_t timeout, priority_t* mprio)
     {
+#if defined(OS_INCLUDE_RTOS_TRACE_EVENTS)
+      os_rtos_trace_object (os_rtos_trace_mqueue_receive, this);
+#endif /* defined(OS_INCLUDE_RTOS_TRACE_EVENTS) */
+
 #if defined(OS_TRACE_RTOS_MQUEUE)
-      trace::printf ("%s(%p,%u,%u) @%p %s\n", __func__, msg, nbytes, timeout,
-                     this, name ());
+      OS_TRACE_PRINTF (rtos_mqueue, "%s(%p,%u,%u) @%p %s\n", __func__, msg,
+                       nbytes, timeout, this, name ());
 #endif
 
       // Don't call this from interrupt handlers.
@@ -1430,6 +1785,72 @@ namespace os
       return port::message_queue::timed_receive (this, msg, nbytes,
           timeout, mprio);
 
+#else
+
+      // Extra test before entering the loop, with its inherent weight.
+      // Trade size for speed.
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          if (internal_try_receive_ (msg, nbytes, mprio))
+            {
+              return result::ok;
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+
+      return timed_receive_until (msg, nbytes, clock_->steady_now () + timeout,
+                                  mprio);
+
+#endif
+    }
+
+    /**
+     * @details
+     * Like `timed_receive()`, but the timeout expires when the
+     * steady time of the queue clock reaches the absolute
+     * `timestamp`. The time stamp is linked as is in the clock
+     * list, so retry loops that keep the same deadline do not
+     * accumulate the time spent between the calls.
+     *
+     * If the time stamp is in the past, the queue is still
+     * tried once, and the function returns `ETIMEDOUT` only if
+     * no message can be received immediately.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    message_queue::timed_receive_until (void* msg, std::size_t nbytes,
+                                        clock::timestamp_t timestamp,
+                                        priority_t* mprio)
+    {
+#if defined(OS_INCLUDE_RTOS_TRACE_EVENTS)
+      os_rtos_trace_object (os_rtos_trace_mqueue_receive, this);
+#endif /* defined(OS_INCLUDE_RTOS_TRACE_EVENTS) */
+
+#if defined(OS_TRACE_RTOS_MQUEUE)
+      OS_TRACE_PRINTF (rtos_mqueue, "%s(%p,%u,%u) @%p %s\n", __func__, msg,
+                       nbytes, static_cast<unsigned int> (timestamp), this,
+                       name ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      // Don't call this from critical regions.
+      os_assert_err(!scheduler::locked (), EPERM);
+
+      os_assert_err(msg != nullptr, EINVAL);
+      os_assert_err(nbytes <= msg_size_bytes_, EMSGSIZE);
+
+#if defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+
+      clock::timestamp_t nw = clock_->steady_now ();
+      return port::message_queue::timed_receive (
+          this, msg, nbytes,
+          (timestamp > nw) ? static_cast<clock::duration_t> (timestamp - nw) : 0,
+          mprio);
+
 #else
 
       // Extra test before entering the loop, with its inherent weight.
@@ -1447,6 +1868,12 @@ namespace os
 
       thread& crt_thread = this_thread::thread ();
 
+      if (clock_->steady_now () > timestamp)
+        {
+          // The deadline already passed, do not wait for the next tick.
+          return ETIMEDOUT;
+        }
+
       // Prepare a list node pointing to the current thread.
       // Do not worry for being on stack, it is temporarily linked to the
       // list and guaranteed to be removed before this function returns.
@@ -1454,7 +1881,7 @@ namespace os
         { crt_thread };
 
       internal::clock_timestamps_list& clock_list = clock_->steady_list ();
-      clock::timestamp_t timeout_timestamp = clock_->steady_now () + timeout;
+      clock::timestamp_t timeout_timestamp = timestamp;
 
       // Prepare a timeout node pointing to the current thread.
       internal::timeout_thread_node timeout_node
@@ -1489,8 +1916,10 @@ namespace os
           if (crt_thread.interrupted ())
             {
 #if defined(OS_TRACE_RTOS_MQUEUE)
-              trace::printf ("%s(%p,%u,%u) EINTR @%p %s\n", __func__, msg,
-                             nbytes, timeout, this, name ());
+              OS_TRACE_PRINTF (rtos_mqueue, "%s(%p,%u,%u) EINTR @%p %s\n",
+                               __func__, msg, nbytes,
+                               static_cast<unsigned int> (timestamp), this,
+                               name ());
 #endif
               return EINTR;
             }
@@ -1498,8 +1927,10 @@ namespace os
           if (clock_->steady_now () >= timeout_timestamp)
             {
 #if defined(OS_TRACE_RTOS_MQUEUE)
-              trace::printf ("%s(%p,%u,%u) ETIMEDOUT @%p %s\n", __func__, msg,
-                             nbytes, timeout, this, name ());
+              OS_TRACE_PRINTF (rtos_mqueue, "%s(%p,%u,%u) ETIMEDOUT @%p %s\n",
+                               __func__, msg, nbytes,
+                               static_cast<unsigned int> (timestamp), this,
+                               name ());
 #endif
               return ETIMEDOUT;
             }
@@ -1511,10 +1942,679 @@ namespace os
 #endif
     }
 
+#if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+
     /**
      * @details
-     * Clear both send and receive counter and return the queue to the
-     * initial state.
+     * The `reserve()` function shall remove a free message slot
+     * from the queue storage and store its address in the location
+     * referenced by _buf_. The caller may then build the message
+     * directly in the slot, and pass it to `commit()`, which links
+     * it in the queue without any copy.
+     *
+     * If there are no free slots, `reserve()` shall block until
+     * a slot becomes available, or until `reserve()` is
+     * cancelled/interrupted. The waiting threads are the same
+     * as for `send()`.
+     *
+     * The slot size is `msg_size()`; the content of a freshly
+     * reserved slot is undefined.
+     *
+     * Reserved slots are not counted by `length()`; while a slot
+     * is reserved, `full()` may return false even if `try_send()`
+     * would fail.
+     *
+     * @par POSIX compatibility
+     *  Extension to standard, no POSIX similar functionality identified.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    message_queue::reserve (void** buf)
+    {
+#if defined(OS_TRACE_RTOS_MQUEUE)
+      OS_TRACE_PRINTF (rtos_mqueue, "%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      // Don't call this from critical regions.
+      os_assert_err(!scheduler::locked (), EPERM);
+
+      os_assert_err(buf != nullptr, EINVAL);
+
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          *buf = internal_try_reserve_ ();
+          if (*buf != nullptr)
+            {
+              return result::ok;
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+
+      thread& crt_thread = this_thread::thread ();
+
+      // Prepare a list node pointing to the current thread.
+      // Do not worry for being on stack, it is temporarily linked to the
+      // list and guaranteed to be removed before this function returns.
+      internal::waiting_thread_node node
+        { crt_thread };
+
+      for (;;)
+        {
+            {
+              // ----- Enter critical section ---------------------------------
+              interrupts::critical_section ics;
+
+              *buf = internal_try_reserve_ ();
+              if (*buf != nullptr)
+                {
+                  return result::ok;
+                }
+
+              // Add this thread to the message queue send waiting list.
+              scheduler::internal_link_node (send_list_, node);
+              // state::suspended set in above link().
+              // ----- Exit critical section ----------------------------------
+            }
+
+          port::scheduler::reschedule ();
+
+          // Remove the thread from the message queue send waiting list,
+          // if not already removed by receive().
+          scheduler::internal_unlink_node (node);
+
+          if (crt_thread.interrupted ())
+            {
+#if defined(OS_TRACE_RTOS_MQUEUE)
+              OS_TRACE_PRINTF (rtos_mqueue, "%s() EINTR @%p %s\n", __func__,
+                               this, name ());
+#endif
+              return EINTR;
+            }
+        }
+
+      /* NOTREACHED */
+      return ENOTRECOVERABLE;
+    }
+
+    /**
+     * @details
+     * The `try_reserve()` function shall try to remove a free message
+     * slot from the queue storage, as described for `reserve()`.
+     *
+     * If there are no free slots, `try_reserve()` shall return
+     * an error, and the location referenced by _buf_ shall be
+     * set to `nullptr`.
+     *
+     * @par POSIX compatibility
+     *  Extension to standard, no POSIX similar functionality identified.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    result_t
+    message_queue::try_reserve (void** buf)
+    {
+#if defined(OS_TRACE_RTOS_MQUEUE)
+      OS_TRACE_PRINTF (rtos_mqueue, "%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      os_assert_err(buf != nullptr, EINVAL);
+
+      // Don't call this from high priority interrupts.
+      assert(port::interrupts::is_priority_valid ());
+
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          *buf = internal_try_reserve_ ();
+          if (*buf != nullptr)
+            {
+              return result::ok;
+            }
+          else
+            {
+              return EWOULDBLOCK;
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+    }
+
+    /**
+     * @details
+     * The `commit()` function shall link the message slot
+     * pointed to by _buf_, previously obtained with `reserve()` or
+     * `try_reserve()`, in the queue, at the position indicated by
+     * the _mprio_ argument, exactly as `send()` does after copying
+     * the message, and wake up a thread waiting to receive.
+     *
+     * After `commit()`, the slot belongs to the queue and the caller
+     * shall no longer access it.
+     *
+     * @par POSIX compatibility
+     *  Extension to standard, no POSIX similar functionality identified.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    result_t
+    message_queue::commit (void* buf, priority_t mprio)
+    {
+#if defined(OS_TRACE_RTOS_MQUEUE)
+      OS_TRACE_PRINTF (rtos_mqueue, "%s(%p,%u) @%p %s\n", __func__, buf, mprio,
+                       this, name ());
+#endif
+
+      os_assert_err(internal_is_slot_ (buf), EINVAL);
+
+      // Don't call this from high priority interrupts.
+      assert(port::interrupts::is_priority_valid ());
+
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          internal_commit_ (buf, mprio);
+
+          // Wake-up one thread, if any.
+          receive_list_.resume_one ();
+          // ----- Exit critical section --------------------------------------
+        }
+
+      return result::ok;
+    }
+
+    /**
+     * @details
+     * The `borrow()` function shall remove the oldest of the highest
+     * priority message(s) from the queue, as `receive()` does, but
+     * instead of copying it to a user buffer, shall store the address
+     * of the message slot in the location referenced by _buf_. The
+     * caller may process the message in place, and must return the
+     * slot to the queue with `release()`.
+     *
+     * If the argument _mprio_ is not nullptr, the priority of the selected
+     * message shall be stored in the location referenced by _mprio_.
+     *
+     * If the message queue is empty, `borrow()` shall block
+     * until a message is enqueued on the message queue or until
+     * `borrow()` is cancelled/interrupted. The waiting threads are
+     * the same as for `receive()`.
+     *
+     * Borrowed slots are not counted by `length()`, and cannot be used
+     * by senders until released.
+     *
+     * @par POSIX compatibility
+     *  Extension to standard, no POSIX similar functionality identified.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    message_queue::borrow (void** buf, priority_t* mprio)
+    {
+#if defined(OS_TRACE_RTOS_MQUEUE)
+      OS_TRACE_PRINTF (rtos_mqueue, "%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      // Don't call this from critical regions.
+      os_assert_err(!scheduler::locked (), EPERM);
+
+      os_assert_err(buf != nullptr, EINVAL);
+
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          *buf = internal_try_borrow_ (mprio);
+          if (*buf != nullptr)
+            {
+              return result::ok;
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+
+      thread& crt_thread = this_thread::thread ();
+
+      // Prepare a list node pointing to the current thread.
+      // Do not worry for being on stack, it is temporarily linked to the
+      // list and guaranteed to be removed before this function returns.
+      internal::waiting_thread_node node
+        { crt_thread };
+
+      for (;;)
+        {
+            {
+              // ----- Enter critical section ---------------------------------
+              interrupts::critical_section ics;
+
+              *buf = internal_try_borrow_ (mprio);
+              if (*buf != nullptr)
+                {
+                  return result::ok;
+                }
+
+              // Add this thread to the message queue receive waiting list.
+              scheduler::internal_link_node (receive_list_, node);
+              // state::suspended set in above link().
+              // ----- Exit critical section ----------------------------------
+            }
+
+          port::scheduler::reschedule ();
+
+          // Remove the thread from the message queue receive waiting list,
+          // if not already removed by send().
+          scheduler::internal_unlink_node (node);
+
+          if (crt_thread.interrupted ())
+            {
+#if defined(OS_TRACE_RTOS_MQUEUE)
+              OS_TRACE_PRINTF (rtos_mqueue, "%s() EINTR @%p %s\n", __func__,
+                               this, name ());
+#endif
+              return EINTR;
+            }
+        }
+
+      /* NOTREACHED */
+      return ENOTRECOVERABLE;
+    }
+
+    /**
+     * @details
+     * The `try_borrow()` function shall try to remove the oldest of
+     * the highest priority message(s) from the queue, as described
+     * for `borrow()`.
+     *
+     * If the message queue is empty, `try_borrow()` shall return
+     * an error, and the location referenced by _buf_ shall be
+     * set to `nullptr`.
+     *
+     * @par POSIX compatibility
+     *  Extension to standard, no POSIX similar functionality identified.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    result_t
+    message_queue::try_borrow (void** buf, priority_t* mprio)
+    {
+#if defined(OS_TRACE_RTOS_MQUEUE)
+      OS_TRACE_PRINTF (rtos_mqueue, "%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      os_assert_err(buf != nullptr, EINVAL);
+
+      // Don't call this from high priority interrupts.
+      assert(port::interrupts::is_priority_valid ());
+
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          *buf = internal_try_borrow_ (mprio);
+          if (*buf != nullptr)
+            {
+              return result::ok;
+            }
+          else
+            {
+              return EWOULDBLOCK;
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+    }
+
+    /**
+     * @details
+     * The `release()` function shall return the message slot
+     * pointed to by _buf_ to the queue free storage, and wake up
+     * a thread waiting to send.
+     *
+     * The slot may have been obtained either with `borrow()`/`try_borrow()`,
+     * after the message was processed, or with `reserve()`/`try_reserve()`,
+     * to abandon a message without sending it.
+     *
+     * @par POSIX compatibility
+     *  Extension to standard, no POSIX similar functionality identified.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    result_t
+    message_queue::release (void* buf)
+    {
+#if defined(OS_TRACE_RTOS_MQUEUE)
+      OS_TRACE_PRINTF (rtos_mqueue, "%s(%p) @%p %s\n", __func__, buf, this,
+                       name ());
+#endif
+
+      os_assert_err(internal_is_slot_ (buf), EINVAL);
+
+      // Don't call this from high priority interrupts.
+      assert(port::interrupts::is_priority_valid ());
+
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          internal_release_ (buf);
+
+          // Wake-up one thread, if any.
+          send_list_.resume_one ();
+          // ----- Exit critical section --------------------------------------
+        }
+
+      return result::ok;
+    }
+
+#endif /* !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE) */
+
+#if !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+
+    /**
+     * @details
+     * The `send_n()` function shall add the _count_ messages
+     * stored contiguously in the array pointed to by _msgs_, each
+     * _nbytes_ long, to the message queue, all with the priority
+     * _mprio_, in the array order.
+     *
+     * As many messages as fit are moved under a single critical
+     * section, and waiting receivers are woken up once per batch,
+     * not once per message.
+     *
+     * If the queue becomes full before all messages were added,
+     * `send_n()` shall block until space becomes available, as
+     * `send()` does, and continue with the remaining messages.
+     *
+     * If _sent_ is not nullptr, the number of messages actually
+     * added to the queue shall be stored there, also when the
+     * call is interrupted.
+     *
+     * @par POSIX compatibility
+     *  Extension to standard, no POSIX similar functionality identified.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    message_queue::send_n (const void* msgs, std::size_t nbytes,
+                           std::size_t count, priority_t mprio,
+                           std::size_t* sent)
+    {
+#if defined(OS_TRACE_RTOS_MQUEUE)
+      OS_TRACE_PRINTF (rtos_mqueue, "%s(%p,%u,%u,%u) @%p %s\n", __func__, msgs,
+                       nbytes, count, mprio, this, name ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      // Don't call this from critical regions.
+      os_assert_err(!scheduler::locked (), EPERM);
+
+      os_assert_err(msgs != nullptr, EINVAL);
+      os_assert_err(nbytes <= msg_size_bytes_, EMSGSIZE);
+
+      const char* p = static_cast<const char*> (msgs);
+      std::size_t done = 0;
+
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          done += internal_try_send_n_ (p, nbytes, count, mprio);
+          // ----- Exit critical section --------------------------------------
+        }
+
+      if (done == count)
+        {
+          if (sent != nullptr)
+            {
+              *sent = done;
+            }
+          return result::ok;
+        }
+
+      thread& crt_thread = this_thread::thread ();
+
+      // Prepare a list node pointing to the current thread.
+      // Do not worry for being on stack, it is temporarily linked to the
+      // list and guaranteed to be removed before this function returns.
+      internal::waiting_thread_node node
+        { crt_thread };
+
+      for (;;)
+        {
+            {
+              // ----- Enter critical section ---------------------------------
+              interrupts::critical_section ics;
+
+              done += internal_try_send_n_ (p + done * nbytes, nbytes,
+                                            count - done, mprio);
+              if (done == count)
+                {
+                  if (sent != nullptr)
+                    {
+                      *sent = done;
+                    }
+                  return result::ok;
+                }
+
+              // Add this thread to the message queue send waiting list.
+              scheduler::internal_link_node (send_list_, node);
+              // state::suspended set in above link().
+              // ----- Exit critical section ----------------------------------
+            }
+
+          port::scheduler::reschedule ();
+
+          // Remove the thread from the message queue send waiting list,
+          // if not already removed by receive().
+          scheduler::internal_unlink_node (node);
+
+          if (crt_thread.interrupted ())
+            {
+#if defined(OS_TRACE_RTOS_MQUEUE)
+              OS_TRACE_PRINTF (rtos_mqueue, "%s(%p,%u,%u,%u) EINTR @%p %s\n",
+                               __func__, msgs, nbytes, count, mprio, this,
+                               name ());
+#endif
+              if (sent != nullptr)
+                {
+                  *sent = done;
+                }
+              return EINTR;
+            }
+        }
+
+      /* NOTREACHED */
+      return ENOTRECOVERABLE;
+    }
+
+    /**
+     * @details
+     * The `try_receive_n()` function shall remove up to _count_
+     * messages from the queue, in the same order as successive
+     * calls to `receive()` would, and copy them to the array pointed
+     * to by _msgs_, with a stride of _nbytes_.
+     *
+     * All available messages are moved under a single critical
+     * section, and waiting senders are woken up once per batch,
+     * not once per message.
+     *
+     * The number of messages actually received shall be stored in
+     * the location referenced by _received_. If _mprios_ is not
+     * nullptr, it must point to an array of _count_ elements, where
+     * the priorities of the received messages shall be stored.
+     *
+     * If the message queue is empty, no message shall be removed
+     * from the queue, and `try_receive_n()` shall return an error.
+     *
+     * @par POSIX compatibility
+     *  Extension to standard, no POSIX similar functionality identified.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    result_t
+    message_queue::try_receive_n (void* msgs, std::size_t nbytes,
+                                  std::size_t count, std::size_t* received,
+                                  priority_t* mprios)
+    {
+#if defined(OS_TRACE_RTOS_MQUEUE)
+      OS_TRACE_PRINTF (rtos_mqueue, "%s(%p,%u,%u) @%p %s\n", __func__, msgs,
+                       nbytes, count, this, name ());
+#endif
+
+      os_assert_err(msgs != nullptr, EINVAL);
+      os_assert_err(received != nullptr, EINVAL);
+      os_assert_err(nbytes <= msg_size_bytes_, EMSGSIZE);
+
+      // Don't call this from high priority interrupts.
+      assert(port::interrupts::is_priority_valid ());
+
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          *received = internal_try_receive_n_ (msgs, nbytes, count, mprios);
+          // ----- Exit critical section --------------------------------------
+        }
+
+      if (*received == 0 && count != 0)
+        {
+          return EWOULDBLOCK;
+        }
+      return result::ok;
+    }
+
+    /**
+     * @details
+     * The `timed_receive_n()` function shall remove up to _count_
+     * messages from the queue, as described for `try_receive_n()`.
+     *
+     * If the message queue is empty, `timed_receive_n()` shall block
+     * until at least one message is enqueued or until it is
+     * cancelled/interrupted, as `timed_receive()` does; it then
+     * returns with all the messages available at that moment,
+     * up to _count_, without waiting for the array to be filled.
+     *
+     * @par POSIX compatibility
+     *  Extension to standard, no POSIX similar functionality identified.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    message_queue::timed_receive_n (void* msgs, std::size_t nbytes,
+                                    std::size_t count,
+                                    clock::duration_t timeout,
+                                    std::size_t* received, priority_t* mprios)
+    {
+#if defined(OS_TRACE_RTOS_MQUEUE)
+      OS_TRACE_PRINTF (rtos_mqueue, "%s(%p,%u,%u,%u) @%p %s\n", __func__, msgs,
+                       nbytes, count, timeout, this, name ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      // Don't call this from critical regions.
+      os_assert_err(!scheduler::locked (), EPERM);
+
+      os_assert_err(msgs != nullptr, EINVAL);
+      os_assert_err(received != nullptr, EINVAL);
+      os_assert_err(nbytes <= msg_size_bytes_, EMSGSIZE);
+
+      // Extra test before entering the loop, with its inherent weight.
+      // Trade size for speed.
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          *received = internal_try_receive_n_ (msgs, nbytes, count, mprios);
+          if (*received != 0 || count == 0)
+            {
+              return result::ok;
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+
+      thread& crt_thread = this_thread::thread ();
+
+      // Prepare a list node pointing to the current thread.
+      // Do not worry for being on stack, it is temporarily linked to the
+      // list and guaranteed to be removed before this function returns.
+      internal::waiting_thread_node node
+        { crt_thread };
+
+      internal::clock_timestamps_list& clock_list = clock_->steady_list ();
+      clock::timestamp_t timeout_timestamp = clock_->steady_now () + timeout;
+
+      // Prepare a timeout node pointing to the current thread.
+      internal::timeout_thread_node timeout_node
+        { timeout_timestamp, crt_thread };
+
+      for (;;)
+        {
+            {
+              // ----- Enter critical section ---------------------------------
+              interrupts::critical_section ics;
+
+              *received = internal_try_receive_n_ (msgs, nbytes, count,
+                                                   mprios);
+              if (*received != 0)
+                {
+                  return result::ok;
+                }
+
+              // Add this thread to the message queue receive waiting list,
+              // and the clock timeout list.
+              scheduler::internal_link_node (receive_list_, node, clock_list,
+                                             timeout_node);
+              // state::suspended set in above link().
+              // ----- Exit critical section ----------------------------------
+            }
+
+          port::scheduler::reschedule ();
+
+          // Remove the thread from the message queue waiting list,
+          // if not already removed by send() and from the clock
+          // timeout list, if not already removed by the timer.
+          scheduler::internal_unlink_node (node, timeout_node);
+
+          if (crt_thread.interrupted ())
+            {
+#if defined(OS_TRACE_RTOS_MQUEUE)
+              OS_TRACE_PRINTF (rtos_mqueue, "%s(%p,%u,%u,%u) EINTR @%p %s\n",
+                               __func__, msgs, nbytes, count, timeout, this,
+                               name ());
+#endif
+              return EINTR;
+            }
+
+          if (clock_->steady_now () >= timeout_timestamp)
+            {
+#if defined(OS_TRACE_RTOS_MQUEUE)
+              OS_TRACE_PRINTF (rtos_mqueue,
+                               "%s(%p,%u,%u,%u) ETIMEDOUT @%p %s\n", __func__,
+                               msgs, nbytes, count, timeout, this, name ());
+#endif
+              return ETIMEDOUT;
+            }
+        }
+
+      /* NOTREACHED */
+      return ENOTRECOVERABLE;
+    }
+
+#endif /* !defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE) */
+
+    /**
+     * @details
+     * Clear both send and receive counter and return the queue to the
+     * initial state.
+     *
+     * Slots obtained with `reserve()` or `borrow()` and not yet
+     * committed or released are reclaimed, and must no longer be used.
      *
      * @par POSIX compatibility
      *  Extension to standard, no POSIX similar functionality identified.
@@ -1525,7 +2625,7 @@ namespace os
     message_queue::reset (void)
     {
 #if defined(OS_TRACE_RTOS_MQUEUE)
-      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+      OS_TRACE_PRINTF (rtos_mqueue, "%s() @%p %s\n", __func__, this, name ());
 #endif
 
       // Don't call this from interrupt handlers.
@@ -299,6 +299,38 @@ namespace os
 
     // ------------------------------------------------------------------------
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MUTEX_INHERIT)
+
+    std::size_t mutex::inherit_max_depth_;
+    rtos::statistics::counter_t mutex::inherit_capped_;
+
+    /**
+     * @details
+     * The depth counts the owners boosted by a single lock,
+     * for all inheritance mutexes.
+     */
+    std::size_t
+    mutex::inherit_max_depth (void)
+    {
+      return inherit_max_depth_;
+    }
+
+    /**
+     * @details
+     * A non zero value means the lock hierarchy is deeper than
+     * @ref OS_INTEGER_RTOS_MUTEX_INHERIT_MAX_DEPTH, and the owners
+     * past the limit were not boosted.
+     */
+    rtos::statistics::counter_t
+    mutex::inherit_capped (void)
+    {
+      return inherit_capped_;
+    }
+
+    // ------------------------------------------------------------------------
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_MUTEX_INHERIT) */
+
     /**
      * @class mutex
      * @details
@@ -469,9 +501,14 @@ namespace os
         protocol_ (attr.mx_protocol), //
         robustness_ (attr.mx_robustness), //
         max_count_ ((attr.mx_type == type::recursive) ? attr.mx_max_count : 1)
+#if defined(OS_INCLUDE_RTOS_SMP)
+            , //
+        spin_cycles_ (attr.mx_spin_cycles)
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
     {
 #if defined(OS_TRACE_RTOS_MUTEX)
-      trace::printf ("%s() @%p %s\n", __func__, this, this->name ());
+      OS_TRACE_PRINTF (rtos_mutex, "%s() @%p %s\n", __func__, this,
+                       this->name ());
 #endif
 
       // Don't call this from interrupt handlers.
@@ -481,6 +518,16 @@ namespace os
       os_assert_throw(protocol_ <= protocol::max_, EINVAL);
       os_assert_throw(robustness_ <= robustness::max_, EINVAL);
 
+      // Features excluded from the kernel profile.
+      os_assert_throw(features::mutex_recursive || type_ != type::recursive,
+                      ENOTSUP);
+      os_assert_throw(
+          features::mutex_robust || robustness_ != robustness::robust,
+          ENOTSUP);
+      os_assert_throw(
+          features::mutex_priority_ceiling || protocol_ != protocol::protect,
+          ENOTSUP);
+
 #if !defined(OS_USE_RTOS_PORT_MUTEX)
       clock_ = attr.clock != nullptr ? attr.clock : &sysclock;
 #endif
@@ -490,8 +537,10 @@ namespace os
       os_assert_throw(attr.mx_priority_ceiling <= thread::priority::highest,
                       EINVAL);
 
+#if !defined(OS_EXCLUDE_RTOS_MUTEX_PRIORITY_CEILING)
       initial_prio_ceiling_ = attr.mx_priority_ceiling;
       prio_ceiling_ = attr.mx_priority_ceiling;
+#endif /* !defined(OS_EXCLUDE_RTOS_MUTEX_PRIORITY_CEILING) */
 
 #if defined(OS_USE_RTOS_PORT_MUTEX)
 
@@ -503,6 +552,10 @@ namespace os
       internal_init_ ();
 
 #endif
+
+#if defined(OS_INCLUDE_RTOS_OBJECT_REGISTRY)
+      registry::internal_insert (this, registry::type::mutex);
+#endif /* defined(OS_INCLUDE_RTOS_OBJECT_REGISTRY) */
     }
 
     /**
@@ -525,9 +578,13 @@ namespace os
     mutex::~mutex ()
     {
 #if defined(OS_TRACE_RTOS_MUTEX)
-      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+      OS_TRACE_PRINTF (rtos_mutex, "%s() @%p %s\n", __func__, this, name ());
 #endif
 
+#if defined(OS_INCLUDE_RTOS_OBJECT_REGISTRY)
+      registry::internal_erase (this, registry::type::mutex);
+#endif /* defined(OS_INCLUDE_RTOS_OBJECT_REGISTRY) */
+
 #if defined(OS_USE_RTOS_PORT_MUTEX)
 
       port::mutex::destroy (this);
@@ -535,13 +592,78 @@ namespace os
 #else
 
       // The mutex must have no owner (must have been unlocked).
-      assert(owner_ == nullptr);
+      assert(internal_owner_ () == nullptr);
       // There must be no threads waiting for this mutex.
       assert(list_.empty ());
 
 #endif
     }
 
+#if defined(OS_INCLUDE_RTOS_SMP)
+
+    /**
+     * @details
+     * Spin only while the owner is running on another core, and
+     * may soon release the mutex; if the owner is preempted or
+     * blocked, or runs on this core, spinning is useless and the
+     * contender blocks at once.
+     *
+     * The mutex word is polled at exponentially increasing
+     * intervals, to reduce the traffic on the owner cache line,
+     * until the limit set by `mx_spin_cycles` expires.
+     *
+     * Positive results are hints, the caller must still lock
+     * the mutex, which may be taken again meanwhile.
+     */
+    bool
+    mutex::internal_spin_ (void)
+    {
+      if (spin_cycles_ == 0)
+        {
+          return false;
+        }
+
+      constexpr uint32_t max_backoff = 1024;
+
+      clock::timestamp_t begin = hrclock.now ();
+      uint32_t backoff = 1;
+      for (;;)
+        {
+          thread* owner = internal_owner_ ();
+          if (owner == nullptr)
+            {
+              return true;
+            }
+
+          if (owner->state () != thread::state::running
+              || owner->core_ == port::core::id ())
+            {
+              return false;
+            }
+
+          if (static_cast<uint32_t> (hrclock.now () - begin) >= spin_cycles_)
+            {
+              return false;
+            }
+
+          for (uint32_t i = 0; i < backoff; ++i)
+            {
+              // Read-only polling, the line stays shared.
+              if (__atomic_load_n (&owner_, __ATOMIC_RELAXED) == 0)
+                {
+                  break;
+                }
+            }
+
+          if (backoff < max_backoff)
+            {
+              backoff <<= 1;
+            }
+        }
+    }
+
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+
     /**
      * @cond ignore
      */
@@ -549,14 +671,18 @@ namespace os
     void
     mutex::internal_init_ (void)
     {
-      owner_ = nullptr;
+      owner_ = 0;
       owner_links_.unlink ();
       count_ = 0;
+#if !defined(OS_EXCLUDE_RTOS_MUTEX_PRIORITY_CEILING)
       prio_ceiling_ = initial_prio_ceiling_;
+#endif /* !defined(OS_EXCLUDE_RTOS_MUTEX_PRIORITY_CEILING) */
       boosted_prio_ = thread::priority::none;
+#if !defined(OS_EXCLUDE_RTOS_MUTEX_ROBUST)
       owner_dead_ = false;
       consistent_ = true;
       recoverable_ = true;
+#endif /* !defined(OS_EXCLUDE_RTOS_MUTEX_ROBUST) */
 
 #if !defined(OS_USE_RTOS_PORT_MUTEX)
 
@@ -576,31 +702,45 @@ namespace os
     mutex::internal_try_lock_ (class thread* th)
     {
       // Save the initial owner for later protocol tests.
-      thread* saved_owner = owner_;
+      thread* saved_owner = internal_owner_ ();
 
       // First lock.
-      if (owner_ == nullptr)
+      if (saved_owner == nullptr)
         {
-          // If the mutex has no owner, own it.
-          owner_ = th;
+          // If the mutex has no owner, own it; if other threads
+          // are still waiting, keep the unlock on the slow path,
+          // to wake them up.
+          __atomic_store_n (
+              &owner_,
+              reinterpret_cast<std::uintptr_t> (th)
+                  | (list_.empty () ? 0 : owner_contended),
+              __ATOMIC_RELEASE);
 
           // For recursive mutexes, initialise counter.
           count_ = 1;
 
+          // The threads still waiting keep boosting the new owner;
+          // the list is ordered, the first one has the top priority.
+          if ((protocol_ == protocol::inherit) && !list_.empty ())
+            {
+              boosted_prio_ = list_.head ()->thread_->priority ();
+            }
+
           // Add mutex to the thread list.
-          mutexes_list* th_list =
-              reinterpret_cast<mutexes_list*> (&owner_->mutexes_);
-          th_list->link (*this);
+          internal_relink_owned_ (th);
 
           // Count the number of mutexes acquired by the thread.
-          ++(owner_->acquired_mutexes_);
+          ++(th->acquired_mutexes_);
 
+#if !defined(OS_EXCLUDE_RTOS_MUTEX_PRIORITY_CEILING)
           if (protocol_ == protocol::protect)
             {
               if (th->priority () > prio_ceiling_)
                 {
                   // No need to keep the lock.
-                  owner_ = nullptr;
+                  __atomic_store_n (
+                      &owner_, (list_.empty () ? 0 : owner_contended),
+                      __ATOMIC_RELEASE);
 
                   // Prio ceiling must be at least the priority of the
                   // highest priority thread.
@@ -617,29 +757,39 @@ namespace os
 
               // Boost priority.
               boosted_prio_ = prio_ceiling_;
-              if (boosted_prio_ > owner_->priority_inherited ())
+              internal_relink_owned_ (th);
+              if (boosted_prio_ > th->priority_inherited ())
                 {
                   // ----- Enter uncritical section ---------------------------
                   scheduler::uncritical_section sucs;
 
-                  owner_->priority_inherited (boosted_prio_);
+                  th->priority_inherited (boosted_prio_);
                   // ----- Exit uncritical section ----------------------------
                 }
             }
+          else
+#endif /* !defined(OS_EXCLUDE_RTOS_MUTEX_PRIORITY_CEILING) */
+          if (boosted_prio_ > th->priority_inherited ())
+            {
+              // Delayed until end of critical section.
+              th->priority_inherited (boosted_prio_);
+            }
 
 #if defined(OS_TRACE_RTOS_MUTEX)
-          trace::printf ("%s() @%p %s by %p %s LCK\n", __func__, this, name (),
-                         th, th->name ());
+          OS_TRACE_PRINTF (rtos_mutex, "%s() @%p %s by %p %s LCK\n", __func__,
+                           this, name (), th, th->name ());
 #endif
           // If the owning thread of a robust mutex terminates while
           // holding the mutex lock, the next thread that acquires the
           // mutex may be notified about the termination by the return
           // value EOWNERDEAD.
+#if !defined(OS_EXCLUDE_RTOS_MUTEX_ROBUST)
           if (owner_dead_)
             {
               // TODO: decide if the lock must be preserved.
               return EOWNERDEAD;
             }
+#endif /* !defined(OS_EXCLUDE_RTOS_MUTEX_ROBUST) */
           return result::ok;
         }
 
@@ -647,14 +797,14 @@ namespace os
       if (saved_owner == th)
         {
           // The mutex was requested again by the same thread.
-          if (type_ == type::recursive)
+          if (features::mutex_recursive && type_ == type::recursive)
             {
               if (count_ >= max_count_)
                 {
                   // The recursive mutex reached its limit.
 #if defined(OS_TRACE_RTOS_MUTEX)
-                  trace::printf ("%s() @%p %s EAGAIN\n", __func__, this,
-                                 name ());
+                  OS_TRACE_PRINTF (rtos_mutex, "%s() @%p %s EAGAIN\n", __func__,
+                                   this, name ());
 #endif
                   return EAGAIN;
                 }
@@ -663,8 +813,9 @@ namespace os
               ++count_;
 
 #if defined(OS_TRACE_RTOS_MUTEX)
-              trace::printf ("%s() @%p %s by %p %s >%u\n", __func__, this,
-                             name (), th, th->name (), count_);
+              OS_TRACE_PRINTF (rtos_mutex, "%s() @%p %s by %p %s >%u\n",
+                               __func__, this, name (), th, th->name (),
+                               count_);
 #endif
               return result::ok;
             }
@@ -672,14 +823,16 @@ namespace os
             {
               // Errorcheck mutexes do not block, but return an error.
 #if defined(OS_TRACE_RTOS_MUTEX)
-              trace::printf ("%s() @%p %s EDEADLK\n", __func__, this, name ());
+              OS_TRACE_PRINTF (rtos_mutex, "%s() @%p %s EDEADLK\n", __func__,
+                               this, name ());
 #endif
               return EDEADLK;
             }
           else if (type_ == type::normal)
             {
 #if defined(OS_TRACE_RTOS_MUTEX)
-              trace::printf ("%s() @%p %s deadlock\n", __func__, this, name ());
+              OS_TRACE_PRINTF (rtos_mutex, "%s() @%p %s deadlock\n", __func__,
+                               this, name ());
 #endif
               return EWOULDBLOCK;
             }
@@ -690,6 +843,10 @@ namespace os
         {
           // Try to lock when not owner (another thread requested the mutex).
 
+          // From now on the owner must unlock on the slow path,
+          // to wake-up this thread and to restore its priority.
+          __atomic_fetch_or (&owner_, owner_contended, __ATOMIC_ACQ_REL);
+
           // POSIX: When a thread makes a call to mutex::lock(), the mutex was
           // initialised with the protocol attribute having the value
           // mutex::protocol::inherit, when the calling thread is blocked
@@ -705,29 +862,14 @@ namespace os
           // manner.
           if (protocol_ == protocol::inherit)
             {
-              thread::priority_t prio = th->priority ();
-              boosted_prio_ = prio;
-
-              if (owner_links_.unlinked ())
-                {
-                  mutexes_list* th_list =
-                      reinterpret_cast<mutexes_list*> (&owner_->mutexes_);
-                  th_list->link (*this);
-                }
-
-              // Boost owner priority.
-              if ((boosted_prio_ > owner_->priority_inherited ()))
-                {
-                  // ----- Enter uncritical section ---------------------------
-                  scheduler::uncritical_section sucs;
-
-                  owner_->priority_inherited (boosted_prio_);
-                  // ----- Exit uncritical section ----------------------------
-                }
+              // Boost the owner and, transitively, the owners of the
+              // mutexes it is blocked on.
+              internal_boost_chain_ (th->priority ());
 
 #if defined(OS_TRACE_RTOS_MUTEX)
-              trace::printf ("%s() @%p %s boost %u by %p %s \n", __func__, this,
-                             name (), boosted_prio_, th, th->name ());
+              OS_TRACE_PRINTF (rtos_mutex, "%s() @%p %s boost %u by %p %s \n",
+                               __func__, this, name (), boosted_prio_, th,
+                               th->name ());
 #endif
 
               return EWOULDBLOCK;
@@ -741,29 +883,32 @@ namespace os
     result_t
     mutex::internal_unlock_ (thread* th)
     {
+#if !defined(OS_EXCLUDE_RTOS_MUTEX_ROBUST)
       if (!recoverable_)
         {
           return ENOTRECOVERABLE;
         }
+#endif /* !defined(OS_EXCLUDE_RTOS_MUTEX_ROBUST) */
 
         {
           // ----- Enter critical section -------------------------------------
           scheduler::critical_section scs;
 
           // Is the rightful owner?
-          if (owner_ == th)
+          if (internal_owner_ () == th)
             {
-              if ((type_ == type::recursive) && (count_ > 1))
+              if (features::mutex_recursive && (type_ == type::recursive)
+                  && (count_ > 1))
                 {
                   --count_;
 #if defined(OS_TRACE_RTOS_MUTEX)
-                  trace::printf ("%s() @%p %s >%u\n", __func__, this, name (),
-                                 count_);
+                  OS_TRACE_PRINTF (rtos_mutex, "%s() @%p %s >%u\n", __func__,
+                                   this, name (), count_);
 #endif
                   return result::ok;
                 }
 
-              --(owner_->acquired_mutexes_);
+              --(th->acquired_mutexes_);
 
               // Remove this mutex from the thread list; ineffective if
               // not linked.
@@ -771,43 +916,31 @@ namespace os
 
               if (boosted_prio_ != thread::priority::none)
                 {
-                  mutexes_list* thread_mutexes =
-                      reinterpret_cast<mutexes_list*> (&owner_->mutexes_);
-
-                  if (thread_mutexes->empty ())
-                    {
-                      // If the owner thread has no more mutexes,
-                      // clear the inherited priority,
-                      // and the assigned priority will take precedence.
-                      boosted_prio_ = thread::priority::none;
-                    }
-                  else
-                    {
-                      // If the owner thread acquired other mutexes too,
-                      // compute the maximum boosted priority.
-                      thread::priority_t max_prio = 0;
-                      for (auto&& mx : *thread_mutexes)
-                        {
-                          if (mx.boosted_prio_ > max_prio)
-                            {
-                              max_prio = mx.boosted_prio_;
-                            }
-                        }
-                      boosted_prio_ = max_prio;
-                    }
+                  // The next owner is boosted again by the threads
+                  // still waiting, when it locks the mutex.
+                  boosted_prio_ = thread::priority::none;
+
+                  // The owned mutexes are ordered by their boosted
+                  // priority, so there is no need to walk them; if
+                  // there are none, the assigned priority will take
+                  // precedence.
                   // Delayed until end of critical section.
-                  owner_->priority_inherited (boosted_prio_);
+                  th->priority_inherited (internal_inherited_ (th));
                 }
 
               // Delayed until end of critical section.
               list_.resume_one ();
 
-              // Finally release the mutex.
-              owner_ = nullptr;
+              // Finally release the mutex; if more threads are waiting,
+              // the next owner must also unlock on the slow path.
               count_ = 0;
+              __atomic_store_n (&owner_,
+                                (list_.empty () ? 0 : owner_contended),
+                                __ATOMIC_RELEASE);
 
 #if defined(OS_TRACE_RTOS_MUTEX)
-              trace::printf ("%s() @%p %s ULCK\n", __func__, this, name ());
+              OS_TRACE_PRINTF (rtos_mutex, "%s() @%p %s ULCK\n", __func__, this,
+                               name ());
 #endif
 
               // POSIX: If a robust mutex whose owner died is unlocked without
@@ -815,6 +948,7 @@ namespace os
               // unusable state and all attempts to lock the mutex
               // shall fail with the error ENOTRECOVERABLE.
 
+#if !defined(OS_EXCLUDE_RTOS_MUTEX_ROBUST)
               if (owner_dead_)
                 {
                   owner_dead_ = false;
@@ -825,6 +959,7 @@ namespace os
                       return ENOTRECOVERABLE;
                     }
                 }
+#endif /* !defined(OS_EXCLUDE_RTOS_MUTEX_ROBUST) */
 
               return result::ok;
             }
@@ -834,7 +969,8 @@ namespace os
               || robustness_ == robustness::robust)
             {
 #if defined(OS_TRACE_RTOS_MUTEX)
-              trace::printf ("%s() EPERM @%p %s \n", __func__, this, name ());
+              OS_TRACE_PRINTF (rtos_mutex, "%s() EPERM @%p %s \n", __func__,
+                               this, name ());
 #endif
               return EPERM;
             }
@@ -843,14 +979,243 @@ namespace os
           // undefined behaviour.
 
 #if defined(OS_TRACE_RTOS_MUTEX)
-          trace::printf ("%s() ENOTRECOVERABLE @%p %s \n", __func__, this,
-                         name ());
+          OS_TRACE_PRINTF (rtos_mutex, "%s() ENOTRECOVERABLE @%p %s \n",
+                           __func__, this, name ());
 #endif
           return ENOTRECOVERABLE;
           // ----- Exit critical section --------------------------------------
         }
     }
 
+    /*
+     * Internal function.
+     * Lock a free, uncontended, mutex without entering the scheduler
+     * critical section. Only normal and errorcheck mutexes, not
+     * robust and not using the priority protect protocol, qualify;
+     * all other cases, including relocks, return false and are
+     * handled by `internal_try_lock_()`.
+     */
+    bool
+    mutex::internal_try_lock_fast_ (thread* th)
+    {
+      if ((features::mutex_recursive && type_ == type::recursive)
+          || (features::mutex_robust && robustness_ != robustness::stalled)
+          || (features::mutex_priority_ceiling
+              && protocol_ == protocol::protect))
+        {
+          return false;
+        }
+
+      std::uintptr_t expected = 0;
+      if (!__atomic_compare_exchange_n (&owner_, &expected,
+                                        reinterpret_cast<std::uintptr_t> (th),
+                                        false, __ATOMIC_ACQUIRE,
+                                        __ATOMIC_RELAXED))
+        {
+          return false;
+        }
+
+      count_ = 1;
+
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          // The thread list is also updated by contenders boosting the
+          // owner priority, which may have linked it already.
+          if (owner_links_.unlinked ())
+            {
+              mutexes_list* th_list =
+                  reinterpret_cast<mutexes_list*> (&th->mutexes_);
+              th_list->link (*this);
+            }
+
+          // Count the number of mutexes acquired by the thread.
+          ++(th->acquired_mutexes_);
+          // ----- Exit critical section --------------------------------------
+        }
+
+#if defined(OS_TRACE_RTOS_MUTEX)
+      OS_TRACE_PRINTF (rtos_mutex, "%s() @%p %s by %p %s LCK\n", __func__, this,
+                       name (), th, th->name ());
+#endif
+      return true;
+    }
+
+    /*
+     * Internal function.
+     * Unlock a mutex owned by the thread, if nobody waited for it
+     * while owned; otherwise the contended bit is set and the
+     * slow path in `internal_unlock_()` must resume the waiters
+     * and restore the priorities.
+     */
+    bool
+    mutex::internal_try_unlock_fast_ (thread* th)
+    {
+      if ((features::mutex_recursive && type_ == type::recursive)
+          || (features::mutex_robust && robustness_ != robustness::stalled)
+          || (features::mutex_priority_ceiling
+              && protocol_ == protocol::protect))
+        {
+          return false;
+        }
+
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          if (__atomic_load_n (&owner_, __ATOMIC_RELAXED)
+              != reinterpret_cast<std::uintptr_t> (th))
+            {
+              return false;
+            }
+
+          // Remove this mutex from the thread list while still owned,
+          // the next owner will link it to its own list.
+          owner_links_.unlink ();
+          --(th->acquired_mutexes_);
+          count_ = 0;
+
+          std::uintptr_t expected = reinterpret_cast<std::uintptr_t> (th);
+          __atomic_compare_exchange_n (&owner_, &expected, 0, false,
+                                       __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+          // ----- Exit critical section --------------------------------------
+        }
+
+#if defined(OS_TRACE_RTOS_MUTEX)
+      OS_TRACE_PRINTF (rtos_mutex, "%s() @%p %s ULCK\n", __func__, this,
+                       name ());
+#endif
+      return true;
+    }
+
+    /*
+     * Internal function.
+     * Keep the mutexes owned by a thread ordered by decreasing
+     * boosted priority, so that the priority to inherit is given
+     * by the first one; the cost is paid only when a boost changes.
+     */
+    void
+    mutex::internal_relink_owned_ (thread* th)
+    {
+      // ----- Enter critical section -----------------------------------------
+      interrupts::critical_section ics;
+
+      // Ineffective if not linked.
+      owner_links_.unlink ();
+
+      // Insert before the first mutex with a lower boosted priority,
+      // or at the end.
+      utils::static_double_list_links* after =
+          const_cast<utils::static_double_list_links*> (th->mutexes_.tail ());
+
+      mutexes_list* th_list = reinterpret_cast<mutexes_list*> (&th->mutexes_);
+      for (auto&& mx : *th_list)
+        {
+          if (mx.boosted_prio_ < boosted_prio_)
+            {
+              after = mx.owner_links_.prev ();
+              break;
+            }
+        }
+
+      owner_links_.prev (after);
+      owner_links_.next (after->next ());
+      after->next ()->prev (&owner_links_);
+      after->next (&owner_links_);
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    thread::priority_t
+    mutex::internal_inherited_ (thread* th)
+    {
+      if (th->mutexes_.empty ())
+        {
+          return thread::priority::none;
+        }
+
+      mutexes_list* th_list = reinterpret_cast<mutexes_list*> (&th->mutexes_);
+      return th_list->begin ()->boosted_prio_;
+    }
+
+    /*
+     * Internal function.
+     * Called in a scheduler critical section, by a thread about
+     * to block on this mutex. Boost the owner and follow the chain
+     * of owners blocked on other inheritance mutexes, up to
+     * OS_INTEGER_RTOS_MUTEX_INHERIT_MAX_DEPTH owners; the walk
+     * stops early where the chain is already boosted enough.
+     */
+    void
+    mutex::internal_boost_chain_ (thread::priority_t prio)
+    {
+      mutex* mx = this;
+      std::size_t depth = 0;
+
+      for (;;)
+        {
+          thread* owner = mx->internal_owner_ ();
+          if ((owner == nullptr) || (prio <= mx->boosted_prio_))
+            {
+              break;
+            }
+
+          mx->boosted_prio_ = prio;
+          mx->internal_relink_owned_ (owner);
+          ++depth;
+
+          // Boost owner priority.
+          if (prio > owner->priority_inherited ())
+            {
+              // ----- Enter uncritical section -------------------------------
+              scheduler::uncritical_section sucs;
+
+              owner->priority_inherited (prio);
+              // ----- Exit uncritical section --------------------------------
+            }
+
+#if defined(OS_TRACE_RTOS_MUTEX)
+          OS_TRACE_PRINTF (rtos_mutex, "%s() @%p %s boost %u %p %s\n", __func__,
+                           mx, mx->name (), prio, owner, owner->name ());
+#endif
+
+          mutex* next = owner->blocking_mutex_;
+          if ((next == nullptr) || (next->protocol_ != protocol::inherit))
+            {
+              break;
+            }
+
+            {
+              // ----- Enter critical section ---------------------------------
+              interrupts::critical_section ics;
+
+              // Move the owner to its new place in the waiting list.
+              internal::waiting_thread_node* node = owner->waiting_node_;
+              if ((node != nullptr) && !node->unlinked ())
+                {
+                  next->list_.relink (*node);
+                }
+              // ----- Exit critical section ----------------------------------
+            }
+
+          if (depth >= OS_INTEGER_RTOS_MUTEX_INHERIT_MAX_DEPTH)
+            {
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MUTEX_INHERIT)
+              ++inherit_capped_;
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_MUTEX_INHERIT) */
+              break;
+            }
+          mx = next;
+        }
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MUTEX_INHERIT)
+      if (depth > inherit_max_depth_)
+        {
+          inherit_max_depth_ = depth;
+        }
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_MUTEX_INHERIT) */
+    }
+
     // Called from thread termination, in a critical section.
     void
     mutex::internal_mark_owner_dead_ (void)
@@ -858,6 +1223,7 @@ namespace os
       // May return error if not the rightful owner.
       trace::printf ("%s() @%p %s\n", __func__, this, name ());
 
+#if !defined(OS_EXCLUDE_RTOS_MUTEX_ROBUST)
       if (robustness_ == mutex::robustness::robust)
         {
           // If the owning thread of a robust mutex terminates
@@ -867,6 +1233,7 @@ namespace os
           owner_dead_ = true;
           consistent_ = false;
         }
+#endif /* !defined(OS_EXCLUDE_RTOS_MUTEX_ROBUST) */
     }
 
     /**
@@ -917,9 +1284,14 @@ namespace os
     result_t
     mutex::lock (void)
     {
+#if defined(OS_INCLUDE_RTOS_TRACE_EVENTS)
+      os_rtos_trace_object (os_rtos_trace_mutex_lock, this);
+#endif /* defined(OS_INCLUDE_RTOS_TRACE_EVENTS) */
+
 #if defined(OS_TRACE_RTOS_MUTEX)
-      trace::printf ("%s() @%p %s by %p %s\n", __func__, this, name (),
-                     &this_thread::thread (), this_thread::thread ().name ());
+      OS_TRACE_PRINTF (rtos_mutex, "%s() @%p %s by %p %s\n", __func__, this,
+                       name (), &this_thread::thread (),
+                       this_thread::thread ().name ());
 #endif
 
       // Don't call this from interrupt handlers.
@@ -927,10 +1299,12 @@ namespace os
       // Don't try to lock a non-recursive mutex again.
       os_assert_err(!scheduler::locked (), EPERM);
 
+#if !defined(OS_EXCLUDE_RTOS_MUTEX_ROBUST)
       if (!recoverable_)
         {
           return ENOTRECOVERABLE;
         }
+#endif /* !defined(OS_EXCLUDE_RTOS_MUTEX_ROBUST) */
 
 #if defined(OS_USE_RTOS_PORT_MUTEX)
 
@@ -940,6 +1314,18 @@ namespace os
 
       thread& crt_thread = this_thread::thread ();
 
+      if (internal_try_lock_fast_ (&crt_thread))
+        {
+          return result::ok;
+        }
+
+#if defined(OS_INCLUDE_RTOS_SMP)
+      if (internal_spin_ () && internal_try_lock_fast_ (&crt_thread))
+        {
+          return result::ok;
+        }
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+
       result_t res;
         {
           // ----- Enter critical section -------------------------------------
@@ -978,6 +1364,7 @@ namespace os
                   // Add this thread to the mutex waiting list.
                   scheduler::internal_link_node (list_, node);
                   // state::suspended set in above link().
+                  crt_thread.blocking_mutex_ = this;
                   // ----- Exit critical section ------------------------------
                 }
               // ----- Exit critical section ----------------------------------
@@ -988,11 +1375,13 @@ namespace os
           // Remove the thread from the semaphore waiting list,
           // if not already removed by unlock().
           scheduler::internal_unlink_node (node);
+          crt_thread.blocking_mutex_ = nullptr;
 
           if (crt_thread.interrupted ())
             {
 #if defined(OS_TRACE_RTOS_MUTEX)
-              trace::printf ("%s() EINTR @%p %s\n", __func__, this, name ());
+              OS_TRACE_PRINTF (rtos_mutex, "%s() EINTR @%p %s\n", __func__,
+                               this, name ());
 #endif
               return EINTR;
             }
@@ -1038,18 +1427,25 @@ namespace os
     result_t
     mutex::try_lock (void)
     {
+#if defined(OS_INCLUDE_RTOS_TRACE_EVENTS)
+      os_rtos_trace_object (os_rtos_trace_mutex_lock, this);
+#endif /* defined(OS_INCLUDE_RTOS_TRACE_EVENTS) */
+
 #if defined(OS_TRACE_RTOS_MUTEX)
-      trace::printf ("%s() @%p %s by %p %s\n", __func__, this, name (),
-                     &this_thread::thread (), this_thread::thread ().name ());
+      OS_TRACE_PRINTF (rtos_mutex, "%s() @%p %s by %p %s\n", __func__, this,
+                       name (), &this_thread::thread (),
+                       this_thread::thread ().name ());
 #endif
 
       // Don't call this from interrupt handlers.
       os_assert_err(!interrupts::in_handler_mode (), EPERM);
 
+#if !defined(OS_EXCLUDE_RTOS_MUTEX_ROBUST)
       if (!recoverable_)
         {
           return ENOTRECOVERABLE;
         }
+#endif /* !defined(OS_EXCLUDE_RTOS_MUTEX_ROBUST) */
 
 #if defined(OS_USE_RTOS_PORT_MUTEX)
 
@@ -1059,6 +1455,11 @@ namespace os
 
       thread& crt_thread = this_thread::thread ();
 
+      if (internal_try_lock_fast_ (&crt_thread))
+        {
+          return result::ok;
+        }
+
         {
           // ----- Enter critical section -------------------------------------
           scheduler::critical_section scs;
@@ -1114,10 +1515,14 @@ namespace os
     result_t
     mutex::timed_lock (clock::duration_t timeout)
     {
+#if defined(OS_INCLUDE_RTOS_TRACE_EVENTS)
+      os_rtos_trace_object (os_rtos_trace_mutex_lock, this);
+#endif /* defined(OS_INCLUDE_RTOS_TRACE_EVENTS) */
+
 #if defined(OS_TRACE_RTOS_MUTEX)
-      trace::printf ("%s(%u) @%p %s by %p %s\n", __func__,
-                     static_cast<unsigned int> (timeout), this, name (),
-                     &this_thread::thread (), this_thread::thread ().name ());
+      OS_TRACE_PRINTF (rtos_mutex, "%s(%u) @%p %s by %p %s\n", __func__,
+                       static_cast<unsigned int> (timeout), this, name (),
+                       &this_thread::thread (), this_thread::thread ().name ());
 #endif
 
       // Don't call this from interrupt handlers.
@@ -1125,19 +1530,91 @@ namespace os
       // Don't try to lock a non-recursive mutex again.
       os_assert_err(!scheduler::locked (), EPERM);
 
+#if !defined(OS_EXCLUDE_RTOS_MUTEX_ROBUST)
       if (!recoverable_)
         {
           return ENOTRECOVERABLE;
         }
+#endif /* !defined(OS_EXCLUDE_RTOS_MUTEX_ROBUST) */
 
 #if defined(OS_USE_RTOS_PORT_MUTEX)
 
       return port::mutex::timed_lock (this, timeout);
 
+#else
+
+      if (internal_try_lock_fast_ (&this_thread::thread ()))
+        {
+          return result::ok;
+        }
+
+      return timed_lock_until (clock_->steady_now () + timeout);
+
+#endif
+    }
+
+    /**
+     * @details
+     * Like `timed_lock()`, but the timeout expires when the
+     * steady time of the mutex clock reaches the absolute
+     * `timestamp`. The time stamp is linked as is in the clock
+     * list, so retry loops that keep the same deadline do not
+     * accumulate the time spent between the calls.
+     *
+     * If the time stamp is in the past, the mutex is still
+     * tried once, and the function returns `ETIMEDOUT` only if
+     * it cannot be locked immediately.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    mutex::timed_lock_until (clock::timestamp_t timestamp)
+    {
+#if defined(OS_INCLUDE_RTOS_TRACE_EVENTS)
+      os_rtos_trace_object (os_rtos_trace_mutex_lock, this);
+#endif /* defined(OS_INCLUDE_RTOS_TRACE_EVENTS) */
+
+#if defined(OS_TRACE_RTOS_MUTEX)
+      OS_TRACE_PRINTF (rtos_mutex, "%s(%u) @%p %s by %p %s\n", __func__,
+                       static_cast<unsigned int> (timestamp), this, name (),
+                       &this_thread::thread (), this_thread::thread ().name ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      // Don't try to lock a non-recursive mutex again.
+      os_assert_err(!scheduler::locked (), EPERM);
+
+#if !defined(OS_EXCLUDE_RTOS_MUTEX_ROBUST)
+      if (!recoverable_)
+        {
+          return ENOTRECOVERABLE;
+        }
+#endif /* !defined(OS_EXCLUDE_RTOS_MUTEX_ROBUST) */
+
+#if defined(OS_USE_RTOS_PORT_MUTEX)
+
+      clock::timestamp_t nw = clock_->steady_now ();
+      return port::mutex::timed_lock (
+          this,
+          (timestamp > nw) ? static_cast<clock::duration_t> (timestamp - nw) : 0);
+
 #else
 
       thread& crt_thread = this_thread::thread ();
 
+      if (internal_try_lock_fast_ (&crt_thread))
+        {
+          return result::ok;
+        }
+
+#if defined(OS_INCLUDE_RTOS_SMP)
+      if (internal_spin_ () && internal_try_lock_fast_ (&crt_thread))
+        {
+          return result::ok;
+        }
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+
       result_t res;
 
       // Extra test before entering the loop, with its inherent weight.
@@ -1154,6 +1631,12 @@ namespace os
           // ----- Exit critical section --------------------------------------
         }
 
+      if (clock_->steady_now () > timestamp)
+        {
+          // The deadline already passed, do not wait for the next tick.
+          return ETIMEDOUT;
+        }
+
       // Prepare a list node pointing to the current thread.
       // Do not worry for being on stack, it is temporarily linked to the
       // list and guaranteed to be removed before this function returns.
@@ -1161,7 +1644,7 @@ namespace os
         { crt_thread };
 
       internal::clock_timestamps_list& clock_list = clock_->steady_list ();
-      clock::timestamp_t timeout_timestamp = clock_->steady_now () + timeout;
+      clock::timestamp_t timeout_timestamp = timestamp;
 
       // Prepare a timeout node pointing to the current thread.
       internal::timeout_thread_node timeout_node
@@ -1188,6 +1671,7 @@ namespace os
                   scheduler::internal_link_node (list_, node, clock_list,
                                                  timeout_node);
                   // state::suspended set in above link().
+                  crt_thread.blocking_mutex_ = this;
                   // ----- Exit critical section ------------------------------
                 }
               // ----- Exit critical section ----------------------------------
@@ -1199,47 +1683,51 @@ namespace os
           // if not already removed by unlock() and from the clock
           // timeout list, if not already removed by the timer.
           scheduler::internal_unlink_node (node, timeout_node);
+          crt_thread.blocking_mutex_ = nullptr;
 
           res = result::ok;
 
           if (crt_thread.interrupted ())
             {
 #if defined(OS_TRACE_RTOS_MUTEX)
-              trace::printf ("%s() EINTR @%p %s \n", __func__, this, name ());
+              OS_TRACE_PRINTF (rtos_mutex, "%s() EINTR @%p %s \n", __func__,
+                               this, name ());
 #endif
               res = EINTR;
             }
           else if (clock_->steady_now () >= timeout_timestamp)
             {
 #if defined(OS_TRACE_RTOS_MUTEX)
-              trace::printf ("%s() ETIMEDOUT @%p %s \n", __func__, this,
-                             name ());
+              OS_TRACE_PRINTF (rtos_mutex, "%s() ETIMEDOUT @%p %s \n", __func__,
+                               this, name ());
 #endif
               res = ETIMEDOUT;
             }
           if (res != result::ok)
             {
-              if (boosted_prio_ != thread::priority::none)
+              if (protocol_ == protocol::inherit)
                 {
-                  // If the priority was boosted, it must be restored
-                  // to the highest priority of the waiting threads, if any.
-
-                  thread::priority_t max_prio = thread::priority::none;
+                  // ----- Enter critical section -----------------------------
+                  scheduler::critical_section scs;
 
-                  for (auto&& th : list_)
+                  thread* owner = internal_owner_ ();
+                  if ((boosted_prio_ != thread::priority::none)
+                      && (owner != nullptr))
                     {
-                      thread::priority_t prio = th.priority ();
-                      if (prio > max_prio)
+                      // If the priority was boosted, it must be restored
+                      // to the highest priority of the waiting threads,
+                      // if any; the list is ordered, no need to walk it.
+                      boosted_prio_ = thread::priority::none;
+                      if (!list_.empty ())
                         {
-                          max_prio = prio;
+                          boosted_prio_ = list_.head ()->thread_->priority ();
                         }
-                    }
+                      internal_relink_owned_ (owner);
 
-                  if (max_prio != thread::priority::none)
-                    {
-                      boosted_prio_ = max_prio;
-                      owner_->priority (boosted_prio_);
+                      // Delayed until end of critical section.
+                      owner->priority_inherited (internal_inherited_ (owner));
                     }
+                  // ----- Exit critical section ------------------------------
                 }
               return res;
             }
@@ -1274,9 +1762,14 @@ namespace os
     result_t
     mutex::unlock (void)
     {
+#if defined(OS_INCLUDE_RTOS_TRACE_EVENTS)
+      os_rtos_trace_object (os_rtos_trace_mutex_unlock, this);
+#endif /* defined(OS_INCLUDE_RTOS_TRACE_EVENTS) */
+
 #if defined(OS_TRACE_RTOS_MUTEX)
-      trace::printf ("%s() @%p %s by %p %s\n", __func__, this, name (),
-                     &this_thread::thread (), this_thread::thread ().name ());
+      OS_TRACE_PRINTF (rtos_mutex, "%s() @%p %s by %p %s\n", __func__, this,
+                       name (), &this_thread::thread (),
+                       this_thread::thread ().name ());
 #endif
 
       // Don't call this from interrupt handlers.
@@ -1290,6 +1783,11 @@ namespace os
 
       thread* crt_thread = &this_thread::thread ();
 
+      if (internal_try_unlock_fast_ (crt_thread))
+        {
+          return result::ok;
+        }
+
       return internal_unlock_ (crt_thread);
 
 #endif
@@ -1310,7 +1808,7 @@ namespace os
     mutex::prio_ceiling (void) const
     {
 #if defined(OS_TRACE_RTOS_MUTEX)
-      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+      OS_TRACE_PRINTF (rtos_mutex, "%s() @%p %s\n", __func__, this, name ());
 #endif
 
       // Don't call this from interrupt handlers.
@@ -1320,6 +1818,10 @@ namespace os
 
       return port::mutex::prio_ceiling (this);
 
+#elif defined(OS_EXCLUDE_RTOS_MUTEX_PRIORITY_CEILING)
+
+      return thread::priority::highest;
+
 #else
 
       return prio_ceiling_;
@@ -1352,7 +1854,7 @@ namespace os
                          thread::priority_t* old_prio_ceiling)
     {
 #if defined(OS_TRACE_RTOS_MUTEX)
-      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+      OS_TRACE_PRINTF (rtos_mutex, "%s() @%p %s\n", __func__, this, name ());
 #endif
 
       // Don't call this from interrupt handlers.
@@ -1362,6 +1864,13 @@ namespace os
 
       return port::mutex::prio_ceiling (this, prio_ceiling, old_prio_ceiling);
 
+#elif defined(OS_EXCLUDE_RTOS_MUTEX_PRIORITY_CEILING)
+
+      (void) prio_ceiling;
+      (void) old_prio_ceiling;
+
+      return ENOTSUP;
+
 #else
 
       // TODO: lock() must not adhere to the priority protocol.
@@ -1417,11 +1926,18 @@ namespace os
     mutex::consistent (void)
     {
 #if defined(OS_TRACE_RTOS_MUTEX)
-      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+      OS_TRACE_PRINTF (rtos_mutex, "%s() @%p %s\n", __func__, this, name ());
 #endif
 
       // Don't call this from interrupt handlers.
       os_assert_err(!interrupts::in_handler_mode (), EPERM);
+
+#if defined(OS_EXCLUDE_RTOS_MUTEX_ROBUST)
+
+      return ENOTSUP;
+
+#else
+
       // Don't call this for non-robust mutexes.
       os_assert_err(robustness_ == robustness::robust, EINVAL);
       // Don't call it if already consistent.
@@ -1438,6 +1954,8 @@ namespace os
       return result::ok;
 
 #endif
+
+#endif /* defined(OS_EXCLUDE_RTOS_MUTEX_ROBUST) */
     }
 
     /**
@@ -1454,7 +1972,7 @@ namespace os
     mutex::reset (void)
     {
 #if defined(OS_TRACE_RTOS_MUTEX)
-      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+      OS_TRACE_PRINTF (rtos_mutex, "%s() @%p %s\n", __func__, this, name ());
 #endif
 
       // Don't call this from interrupt handlers.
@@ -0,0 +1,257 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <cmsis-plus/rtos/os.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    // ------------------------------------------------------------------------
+
+    /**
+     * @class periodic
+     * @details
+     * The release times are multiples of the period from the
+     * moment of `start()`, independent of when the loop body
+     * completes, so the activations do not drift.
+     *
+     * If the loop body runs past one or more release times,
+     * these releases are counted as missed and skipped, and the
+     * thread waits for the next release on the same grid,
+     * keeping the phase.
+     *
+     * At each wakeup, the `hrclock` time is compared with the time
+     * expected from the first wakeup and the number of periods
+     * since; the minimum, the maximum and the mean of the
+     * differences measure the release jitter, in CPU cycles.
+     *
+     * With `sysclock` the period is in ticks, and the jitter
+     * includes the tick interrupt latency; with `hrclock`
+     * the period is in CPU cycles.
+     *
+     * @par Example
+     *
+     * @code{.cpp}
+     * void*
+     * control (void* args)
+     * {
+     *   periodic loop { "control", 5 };
+     *
+     *   loop.start ();
+     *   for (;;)
+     *     {
+     *       loop.wait_next_period ();
+     *       update ();
+     *     }
+     * }
+     * @endcode
+     */
+
+    /**
+     * @details
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    periodic::periodic (clock::duration_t period, clock& clk) :
+        periodic
+          { nullptr, period, clk }
+    {
+      ;
+    }
+
+    /**
+     * @details
+     * If the period is 0, it is automatically adjusted to 1.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    periodic::periodic (const char* name, clock::duration_t period,
+                        clock& clk) :
+        object_named
+          { name }, //
+        clock_ (&clk), //
+        period_ (period != 0 ? period : 1)
+    {
+#if defined(OS_TRACE_RTOS_CLOCKS)
+      OS_TRACE_PRINTF (rtos_clocks, "%s(%u) @%p %s\n", __func__,
+                       static_cast<unsigned int> (period), this, this->name ());
+#endif
+
+      if (clock_ == &hrclock)
+        {
+          cycles_per_unit_ = 1;
+        }
+      else if (clock_ == &sysclock)
+        {
+          cycles_per_unit_ = port::clock_highres::cycles_per_tick ();
+        }
+      else
+        {
+          // Clocks counting seconds, like rtclock.
+          cycles_per_unit_ = hrclock.input_clock_frequency_hz ();
+        }
+    }
+
+    /**
+     * @details
+     * The first release is one period after the current time.
+     * The counters and the jitter statistics are cleared.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    void
+    periodic::start (void)
+    {
+      release_ = clock_->now ();
+      clear_statistics ();
+    }
+
+    /**
+     * @details
+     * Advance the release time by one period and sleep until then.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    periodic::wait_next_period (void)
+    {
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+
+      release_ += period_;
+
+      result_t missed = result::ok;
+      clock::timestamp_t nw = clock_->now ();
+      if (nw >= release_)
+        {
+          // Skip all releases already passed, keeping the phase.
+          clock::timestamp_t skipped = (nw - release_) / period_ + 1;
+          misses_ += skipped;
+          release_ += skipped * period_;
+          missed = ETIMEDOUT;
+#if defined(OS_TRACE_RTOS_CLOCKS)
+          OS_TRACE_PRINTF (rtos_clocks, "%s() @%p %s missed %u\n", __func__,
+                           this, name (), static_cast<unsigned int> (skipped));
+#endif
+        }
+
+      result_t res = clock_->sleep_until (release_);
+      if (res != ETIMEDOUT)
+        {
+          return res;
+        }
+
+#if defined(OS_INCLUDE_RTOS_THREAD_BUDGET)
+      // A new activation of the calling thread.
+      this_thread::thread ().budget_restart ();
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_BUDGET) */
+
+      internal_record_jitter_ ();
+      ++activations_;
+
+      return missed;
+    }
+
+    /**
+     * @details
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    void
+    periodic::clear_statistics (void)
+    {
+      has_origin_ = false;
+      activations_ = 0;
+      misses_ = 0;
+      jitter_min_ = 0;
+      jitter_max_ = 0;
+      jitter_sum_ = 0;
+      jitter_count_ = 0;
+    }
+
+    /**
+     * @cond ignore
+     */
+
+    void
+    periodic::internal_record_jitter_ (void)
+    {
+      clock::timestamp_t cycles = hrclock.now ();
+
+      if (!has_origin_)
+        {
+          // The first wakeup is the reference for all the others.
+          origin_release_ = release_;
+          origin_cycles_ = cycles;
+          has_origin_ = true;
+          return;
+        }
+
+      clock::timestamp_t expected = origin_cycles_
+          + (release_ - origin_release_) * cycles_per_unit_;
+
+      int64_t diff = static_cast<int64_t> (cycles - expected);
+      jitter_t jitter;
+      if (diff > INT32_MAX)
+        {
+          jitter = INT32_MAX;
+        }
+      else if (diff < INT32_MIN)
+        {
+          jitter = INT32_MIN;
+        }
+      else
+        {
+          jitter = static_cast<jitter_t> (diff);
+        }
+
+      if (jitter_count_ == 0 || jitter < jitter_min_)
+        {
+          jitter_min_ = jitter;
+        }
+      if (jitter_count_ == 0 || jitter > jitter_max_)
+        {
+          jitter_max_ = jitter;
+        }
+      jitter_sum_ += jitter;
+      ++jitter_count_;
+    }
+
+    /**
+     * @endcond
+     */
+
+  // --------------------------------------------------------------------------
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,245 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <cmsis-plus/rtos/os.h>
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_INCLUDE_RTOS_PROFILER)
+
+#if defined(__ARM_EABI__) \
+  && (defined(__ARM_ARCH_6M__) || defined(__ARM_ARCH_7M__) \
+      || defined(__ARM_ARCH_7EM__))
+#define OS_HAS_RTOS_PROFILER_SAMPLE_ISR
+#endif
+
+extern "C"
+{
+  void
+  os_rtos_profiler_sample_frame (const uint32_t* frame);
+}
+
+namespace os
+{
+  namespace rtos
+  {
+    namespace profiler
+    {
+      // ----------------------------------------------------------------------
+
+      /**
+       * @cond ignore
+       */
+
+      namespace
+      {
+        static_assert((samples_size & (samples_size - 1)) == 0,
+            "OS_INTEGER_RTOS_PROFILER_SAMPLES must be a power of 2.");
+
+        sample_t samples[samples_size];
+
+        // Free running counters; only the interrupt handler
+        // writes the head, only the consumer writes the tail.
+        volatile std::size_t head;
+        volatile std::size_t tail;
+
+        volatile std::size_t lost;
+        volatile bool enabled;
+      }
+
+      /**
+       * @endcond
+       */
+
+      // ----------------------------------------------------------------------
+
+      void
+      start (void) noexcept
+      {
+        enabled = true;
+      }
+
+      void
+      stop (void) noexcept
+      {
+        enabled = false;
+      }
+
+      /**
+       * @details
+       * Single producer; when the ring is full the sample is
+       * dropped and counted, the recorded ones are preserved.
+       */
+      void
+      sample (const void* pc) noexcept
+      {
+        if (!enabled)
+          {
+            return;
+          }
+
+        std::size_t h = head;
+        if (h - __atomic_load_n (&tail, __ATOMIC_ACQUIRE) >= samples_size)
+          {
+            lost = lost + 1;
+            return;
+          }
+
+        sample_t& s = samples[h & (samples_size - 1)];
+        s.pc = pc;
+        s.th = scheduler::started () ? scheduler::current_thread_ : nullptr;
+
+        __atomic_store_n (&head, h + 1, __ATOMIC_RELEASE);
+      }
+
+      std::size_t
+      drain (sample_t* out, std::size_t count) noexcept
+      {
+        std::size_t t = tail;
+        std::size_t h = __atomic_load_n (&head, __ATOMIC_ACQUIRE);
+
+        std::size_t n = 0;
+        for (; n < count && t != h; ++n, ++t)
+          {
+            out[n] = samples[t & (samples_size - 1)];
+          }
+
+        __atomic_store_n (&tail, t, __ATOMIC_RELEASE);
+        return n;
+      }
+
+      std::size_t
+      dropped (void) noexcept
+      {
+        return lost;
+      }
+
+#pragma GCC diagnostic push
+#if !defined(TRACE)
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#endif
+
+      /**
+       * @details
+       * The lines have the format `prof <pc> <thread> <name>`,
+       * to be easily filtered and aggregated on the host.
+       */
+      std::size_t
+      trace_print (std::size_t max_samples) noexcept
+      {
+        std::size_t total = 0;
+#if defined(TRACE)
+        sample_t batch[16];
+        while (total < max_samples)
+          {
+            std::size_t count = max_samples - total;
+            if (count > sizeof(batch) / sizeof(batch[0]))
+              {
+                count = sizeof(batch) / sizeof(batch[0]);
+              }
+
+            std::size_t n = drain (batch, count);
+            if (n == 0)
+              {
+                break;
+              }
+
+            for (std::size_t i = 0; i < n; ++i)
+              {
+                trace::printf ("prof %p %p %s\n", batch[i].pc, batch[i].th,
+                               (batch[i].th != nullptr) ?
+                                   batch[i].th->name () : "-");
+              }
+            total += n;
+          }
+#endif /* defined(TRACE) */
+        return total;
+      }
+
+#pragma GCC diagnostic pop
+
+    // ------------------------------------------------------------------------
+
+    } /* namespace profiler */
+  } /* namespace rtos */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+void
+__attribute__((weak))
+os_rtos_profiler_acknowledge_hook (void)
+{
+}
+
+/**
+ * @details
+ * The basic exception frame is R0-R3, R12, LR, PC, xPSR;
+ * the PC is the 7th word, also with the extended FPU frame.
+ */
+void
+os_rtos_profiler_sample_frame (const uint32_t* frame)
+{
+  os::rtos::profiler::sample (reinterpret_cast<const void*> (frame[6]));
+
+  os_rtos_profiler_acknowledge_hook ();
+}
+
+#if defined(OS_HAS_RTOS_PROFILER_SAMPLE_ISR)
+
+/**
+ * @details
+ * Bit 2 of `EXC_RETURN` tells which stack holds the exception
+ * frame of the interrupted context. Only ARMv6-M instructions are
+ * used, and the return goes through the `EXC_RETURN` popped in PC.
+ */
+void
+__attribute__((naked))
+os_rtos_profiler_sample_isr (void)
+{
+  asm volatile (
+      " movs r0, #4 \n"
+      " mov r1, lr \n"
+      " tst r0, r1 \n"
+      " beq 1f \n"
+      " mrs r0, psp \n"
+      " b 2f \n"
+      "1: \n"
+      " mrs r0, msp \n"
+      "2: \n"
+      " push {r3, lr} \n"
+      " bl os_rtos_profiler_sample_frame \n"
+      " pop {r3, pc} \n"
+  );
+}
+
+#endif /* defined(OS_HAS_RTOS_PROFILER_SAMPLE_ISR) */
+
+#endif /* defined(OS_INCLUDE_RTOS_PROFILER) */
+
+// ----------------------------------------------------------------------------
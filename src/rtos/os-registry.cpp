@@ -0,0 +1,236 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2015 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/rtos/os.h>
+
+#include <cstring>
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_INCLUDE_RTOS_OBJECT_REGISTRY)
+
+namespace os
+{
+  namespace rtos
+  {
+    namespace registry
+    {
+      // ----------------------------------------------------------------------
+
+      /**
+       * @cond ignore
+       */
+
+      namespace
+      {
+        static_assert((table_size & (table_size - 1)) == 0,
+            "OS_INTEGER_RTOS_OBJECT_REGISTRY_SIZE must be a power of 2.");
+
+        // Slot states, stored in place of the type.
+        constexpr uint8_t slot_empty = 0;
+        constexpr uint8_t slot_erased = 0xFF;
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+        typedef struct slot_s
+        {
+          internal::object_named* obj;
+          uint32_t hash;
+          uint8_t type;
+        } slot_t;
+
+#pragma GCC diagnostic pop
+
+        slot_t slots[table_size];
+
+        std::size_t count;
+
+        // FNV-1a over the name, seeded with the type, so
+        // objects of different types with the same name
+        // do not share the same probe sequence.
+        uint32_t
+        compute_hash (const char* name, type t)
+        {
+          uint32_t h = 2166136261u ^ static_cast<uint32_t> (t);
+          for (const char* p = name; *p != '\0'; ++p)
+            {
+              h ^= static_cast<uint8_t> (*p);
+              h *= 16777619u;
+            }
+          return h;
+        }
+
+        inline std::size_t
+        next (std::size_t i)
+        {
+          return (i + 1) & (table_size - 1);
+        }
+      }
+
+      /**
+       * @endcond
+       */
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @details
+       * The table uses open addressing with linear probing;
+       * the name is hashed before entering the critical section,
+       * and the names are compared only for the entries with
+       * the same hash and type.
+       *
+       * The returned object is not protected from destruction;
+       * the caller must know it is still alive when used.
+       */
+      internal::object_named*
+      find (const char* name, type t)
+      {
+        if (name == nullptr)
+          {
+            return nullptr;
+          }
+
+        uint32_t h = compute_hash (name, t);
+        uint8_t ty = static_cast<uint8_t> (t);
+
+        // ----- Enter critical section -------------------------------------
+        scheduler::critical_section scs;
+
+        std::size_t i = h & (table_size - 1);
+        for (std::size_t n = 0; n < table_size; ++n, i = next (i))
+          {
+            slot_t& s = slots[i];
+            if (s.type == slot_empty)
+              {
+                break;
+              }
+            if (s.type == ty && s.hash == h
+                && std::strcmp (s.obj->name (), name) == 0)
+              {
+                return s.obj;
+              }
+          }
+
+        return nullptr;
+        // ----- Exit critical section --------------------------------------
+      }
+
+      std::size_t
+      size (void)
+      {
+        return count;
+      }
+
+      /**
+       * @cond ignore
+       */
+
+      bool
+      internal_insert (internal::object_named* obj, type t)
+      {
+        const char* name = obj->name ();
+        if (std::strcmp (name, "-") == 0)
+          {
+            return false;
+          }
+
+        uint32_t h = compute_hash (name, t);
+
+        // ----- Enter critical section -------------------------------------
+        scheduler::critical_section scs;
+
+        std::size_t i = h & (table_size - 1);
+        for (std::size_t n = 0; n < table_size; ++n, i = next (i))
+          {
+            slot_t& s = slots[i];
+            if (s.type == slot_empty || s.type == slot_erased)
+              {
+                s.obj = obj;
+                s.hash = h;
+                s.type = static_cast<uint8_t> (t);
+                ++count;
+                return true;
+              }
+          }
+
+        return false;
+        // ----- Exit critical section --------------------------------------
+      }
+
+      void
+      internal_erase (internal::object_named* obj, type t)
+      {
+        uint32_t h = compute_hash (obj->name (), t);
+
+        // ----- Enter critical section -------------------------------------
+        scheduler::critical_section scs;
+
+        std::size_t i = h & (table_size - 1);
+        for (std::size_t n = 0; n < table_size; ++n, i = next (i))
+          {
+            slot_t& s = slots[i];
+            if (s.type == slot_empty)
+              {
+                // Not registered.
+                return;
+              }
+            if (s.obj == obj && s.type != slot_erased)
+              {
+                s.obj = nullptr;
+                s.type = slot_erased;
+                --count;
+
+                // If this is the end of a probe sequence, turn
+                // the erased slots before it into empty ones,
+                // to keep the lookups of missing names short.
+                if (slots[next (i)].type == slot_empty)
+                  {
+                    while (slots[i].type == slot_erased)
+                      {
+                        slots[i].type = slot_empty;
+                        i = (i - 1) & (table_size - 1);
+                      }
+                  }
+                return;
+              }
+          }
+        // ----- Exit critical section --------------------------------------
+      }
+
+      /**
+       * @endcond
+       */
+
+    } /* namespace registry */
+  } /* namespace rtos */
+} /* namespace os */
+
+#endif /* defined(OS_INCLUDE_RTOS_OBJECT_REGISTRY) */
+
+// ----------------------------------------------------------------------------
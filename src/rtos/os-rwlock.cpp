@@ -0,0 +1,468 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/rtos/os.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    // ------------------------------------------------------------------------
+
+    /**
+     * @class rwlock
+     * @details
+     * The lock keeps the number of readers holding it, and the
+     * number of writers holding or waiting for it. Readers enter
+     * only when there are no writers at all; writers first lock
+     * the inner mutex, which orders them by priority and lets the
+     * waiting writers boost the current owner, and then wait for
+     * the readers already inside to leave.
+     *
+     * Readers do not inherit priorities; a writer waiting for
+     * the readers to leave is not able to boost them.
+     *
+     * @warning A thread holding the lock in shared mode must not
+     * lock it again; if a writer arrived in the meantime, the
+     * second lock waits for the writer, which waits for the first
+     * lock to be released.
+     *
+     * @par Example
+     *
+     * @code{.cpp}
+     * rwlock table_lock { "table" };
+     *
+     * void
+     * reader(void)
+     * {
+     *   table_lock.lock_shared();
+     *   // Look up the table.
+     *   table_lock.unlock_shared();
+     * }
+     *
+     * void
+     * writer(void)
+     * {
+     *   table_lock.lock();
+     *   // Update the table.
+     *   table_lock.unlock();
+     * }
+     * @endcode
+     *
+     * @par POSIX compatibility
+     *  Inspired by [`pthread_rwlock_t`](http://pubs.opengroup.org/onlinepubs/9699919799/basedefs/pthread.h.html)
+     *  from [`<pthread.h>`](http://pubs.opengroup.org/onlinepubs/9699919799/basedefs/pthread.h.html)
+     *  ([IEEE Std 1003.1, 2013 Edition](http://pubs.opengroup.org/onlinepubs/9699919799/nframe.html)).
+     */
+
+    /**
+     * @details
+     * The inner mutex is named as the lock.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    rwlock::rwlock (const char* name) :
+        object_named_system
+          { name }, //
+        writers_mutex_
+          { name }
+    {
+      ;
+    }
+
+    /**
+     * @details
+     * The lock must be free, with no threads waiting for it.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    rwlock::~rwlock ()
+    {
+      assert(readers_ == 0);
+      assert(writers_ == 0);
+      assert(readers_list_.empty ());
+      assert(writer_list_.empty ());
+    }
+
+    /**
+     * @details
+     * New readers are blocked from the moment the call is made,
+     * then the writer waits for the other writers, and finally
+     * for the readers already holding the lock.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    rwlock::lock (void)
+    {
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      // Don't call this from critical regions.
+      os_assert_err(!scheduler::locked (), EPERM);
+
+      thread* th = &this_thread::thread ();
+      if (writer_ == th)
+        {
+          return EDEADLK;
+        }
+
+        {
+          // ----- Enter critical section -------------------------------------
+          scheduler::critical_section scs;
+
+          ++writers_;
+          // ----- Exit critical section --------------------------------------
+        }
+
+      result_t res = writers_mutex_.lock ();
+      if (res == result::ok)
+        {
+          res = internal_wait_ (false, 0, false);
+          if (res == result::ok)
+            {
+              writer_ = th;
+              return result::ok;
+            }
+          writers_mutex_.unlock ();
+        }
+
+      internal_cancel_writer_ ();
+      return res;
+    }
+
+    /**
+     * @details
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    rwlock::try_lock (void)
+    {
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+
+        {
+          // ----- Enter critical section -------------------------------------
+          scheduler::critical_section scs;
+
+          if ((writers_ > 0) || (readers_ > 0))
+            {
+              return EWOULDBLOCK;
+            }
+
+          ++writers_;
+          // ----- Exit critical section --------------------------------------
+        }
+
+      // Another writer may have got the mutex in the meantime.
+      result_t res = writers_mutex_.try_lock ();
+      if (res == result::ok)
+        {
+          writer_ = &this_thread::thread ();
+          return result::ok;
+        }
+
+      internal_cancel_writer_ ();
+      return res;
+    }
+
+    /**
+     * @details
+     * The timeout covers both waiting for the other writers and
+     * for the readers.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    rwlock::timed_lock (clock::duration_t timeout)
+    {
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      // Don't call this from critical regions.
+      os_assert_err(!scheduler::locked (), EPERM);
+
+      thread* th = &this_thread::thread ();
+      if (writer_ == th)
+        {
+          return EDEADLK;
+        }
+
+      clock::timestamp_t timestamp = sysclock.steady_now () + timeout;
+
+        {
+          // ----- Enter critical section -------------------------------------
+          scheduler::critical_section scs;
+
+          ++writers_;
+          // ----- Exit critical section --------------------------------------
+        }
+
+      result_t res = writers_mutex_.timed_lock (timeout);
+      if (res == result::ok)
+        {
+          res = internal_wait_ (false, timestamp, true);
+          if (res == result::ok)
+            {
+              writer_ = th;
+              return result::ok;
+            }
+          writers_mutex_.unlock ();
+        }
+
+      internal_cancel_writer_ ();
+      return res;
+    }
+
+    /**
+     * @details
+     * When the last writer leaves, all waiting readers are resumed.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    rwlock::unlock (void)
+    {
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+
+      if (writer_ != &this_thread::thread ())
+        {
+          return EPERM;
+        }
+
+      writer_ = nullptr;
+      writers_mutex_.unlock ();
+
+      internal_cancel_writer_ ();
+      return result::ok;
+    }
+
+    /**
+     * @details
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    rwlock::lock_shared (void)
+    {
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      // Don't call this from critical regions.
+      os_assert_err(!scheduler::locked (), EPERM);
+
+      return internal_wait_ (true, 0, false);
+    }
+
+    /**
+     * @details
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    rwlock::try_lock_shared (void)
+    {
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+
+      // ----- Enter critical section -----------------------------------------
+      scheduler::critical_section scs;
+
+      if (writers_ > 0)
+        {
+          return EWOULDBLOCK;
+        }
+
+      ++readers_;
+      return result::ok;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    /**
+     * @details
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    rwlock::timed_lock_shared (clock::duration_t timeout)
+    {
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      // Don't call this from critical regions.
+      os_assert_err(!scheduler::locked (), EPERM);
+
+      return internal_wait_ (true, sysclock.steady_now () + timeout, true);
+    }
+
+    /**
+     * @details
+     * When the last reader leaves, the writer waiting for the
+     * readers, if any, is resumed.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    rwlock::unlock_shared (void)
+    {
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+
+      // ----- Enter critical section -----------------------------------------
+      scheduler::critical_section scs;
+
+      if (readers_ == 0)
+        {
+          return EPERM;
+        }
+
+      if (--readers_ == 0)
+        {
+          // Delayed until end of critical section.
+          writer_list_.resume_one ();
+        }
+      return result::ok;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    /**
+     * @cond ignore
+     */
+
+    /*
+     * Internal function.
+     * Park the current thread on the readers or on the writer list,
+     * until the lock can be taken. A reader takes its share inside
+     * the critical section; the writer already owns the inner mutex,
+     * so it only waits for the readers count to drop to zero.
+     */
+    result_t
+    rwlock::internal_wait_ (bool shared, clock::timestamp_t timestamp,
+                            bool timed)
+    {
+      internal::waiting_threads_list& list =
+          shared ? readers_list_ : writer_list_;
+
+      thread& crt_thread = this_thread::thread ();
+
+      // Prepare a list node pointing to the current thread.
+      // Do not worry for being on stack, it is temporarily linked to the
+      // list and guaranteed to be removed before this function returns.
+      internal::waiting_thread_node node
+        { crt_thread };
+
+      internal::clock_timestamps_list& clock_list = sysclock.steady_list ();
+
+      // Prepare a timeout node pointing to the current thread.
+      internal::timeout_thread_node timeout_node
+        { timestamp, crt_thread };
+
+      for (;;)
+        {
+            {
+              // ----- Enter critical section ---------------------------------
+              scheduler::critical_section scs;
+
+              if (shared ? (writers_ == 0) : (readers_ == 0))
+                {
+                  if (shared)
+                    {
+                      ++readers_;
+                    }
+                  return result::ok;
+                }
+
+              if (timed && sysclock.steady_now () >= timestamp)
+                {
+                  return ETIMEDOUT;
+                }
+
+                {
+                  // ----- Enter critical section -----------------------------
+                  interrupts::critical_section ics;
+
+                  if (timed)
+                    {
+                      scheduler::internal_link_node (list, node, clock_list,
+                                                     timeout_node);
+                    }
+                  else
+                    {
+                      scheduler::internal_link_node (list, node);
+                    }
+                  // state::suspended set in above link().
+                  // ----- Exit critical section ------------------------------
+                }
+              // ----- Exit critical section ----------------------------------
+            }
+
+          port::scheduler::reschedule ();
+
+          // Remove the thread from the waiting list, if not already
+          // removed by the other side, and from the clock timeout list,
+          // if not already removed by the timer.
+          if (timed)
+            {
+              scheduler::internal_unlink_node (node, timeout_node);
+            }
+          else
+            {
+              scheduler::internal_unlink_node (node);
+            }
+
+          if (crt_thread.interrupted ())
+            {
+              return EINTR;
+            }
+        }
+
+      /* NOTREACHED */
+      return ENOTRECOVERABLE;
+    }
+
+    /*
+     * Internal function.
+     * Called by a writer which released, or failed to get, the lock.
+     */
+    void
+    rwlock::internal_cancel_writer_ (void)
+    {
+      // ----- Enter critical section -----------------------------------------
+      scheduler::critical_section scs;
+
+      if (--writers_ == 0)
+        {
+          // Delayed until end of critical section.
+          readers_list_.resume_all ();
+        }
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    /**
+     * @endcond
+     */
+
+  // --------------------------------------------------------------------------
+
+  } /* namespace rtos */
+} /* namespace os */
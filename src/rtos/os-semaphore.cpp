@@ -169,8 +169,8 @@ namespace os
         initial_value_ (initial_value)
     {
 #if defined(OS_TRACE_RTOS_SEMAPHORE)
-      trace::printf ("%s() @%p %s %u %u\n", __func__, this, this->name (),
-                     initial_value, max_value_);
+      OS_TRACE_PRINTF (rtos_semaphore, "%s() @%p %s %u %u\n", __func__, this,
+                       this->name (), initial_value, max_value_);
 #endif
 
       // Don't call this from interrupt handlers.
@@ -197,6 +197,10 @@ namespace os
       internal_init_ ();
 
 #endif
+
+#if defined(OS_INCLUDE_RTOS_OBJECT_REGISTRY)
+      registry::internal_insert (this, registry::type::semaphore);
+#endif /* defined(OS_INCLUDE_RTOS_OBJECT_REGISTRY) */
     }
 
     /**
@@ -224,9 +228,14 @@ namespace os
     semaphore::~semaphore ()
     {
 #if defined(OS_TRACE_RTOS_SEMAPHORE)
-      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+      OS_TRACE_PRINTF (rtos_semaphore, "%s() @%p %s\n", __func__, this,
+                       name ());
 #endif
 
+#if defined(OS_INCLUDE_RTOS_OBJECT_REGISTRY)
+      registry::internal_erase (this, registry::type::semaphore);
+#endif /* defined(OS_INCLUDE_RTOS_OBJECT_REGISTRY) */
+
 #if defined(OS_USE_RTOS_PORT_SEMAPHORE)
 
       port::semaphore::destroy (this);
@@ -270,14 +279,16 @@ namespace os
         {
           --count_;
 #if defined(OS_TRACE_RTOS_SEMAPHORE)
-          trace::printf ("%s() @%p %s >%u\n", __func__, this, name (), count_);
+          OS_TRACE_PRINTF (rtos_semaphore, "%s() @%p %s >%u\n", __func__, this,
+                           name (), count_);
 #endif
           return true;
         }
 
       // Count may be 0.
 #if defined(OS_TRACE_RTOS_SEMAPHORE)
-      trace::printf ("%s() @%p %s false\n", __func__, this, name ());
+      OS_TRACE_PRINTF (rtos_semaphore, "%s() @%p %s false\n", __func__, this,
+                       name ());
 #endif
       return false;
     }
@@ -326,11 +337,15 @@ namespace os
     result_t
     semaphore::post (void)
     {
+#if defined(OS_INCLUDE_RTOS_TRACE_EVENTS)
+      os_rtos_trace_object (os_rtos_trace_semaphore_post, this);
+#endif /* defined(OS_INCLUDE_RTOS_TRACE_EVENTS) */
 
 #if defined(OS_USE_RTOS_PORT_SEMAPHORE)
 
 #if defined(OS_TRACE_RTOS_SEMAPHORE)
-      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+      OS_TRACE_PRINTF (rtos_semaphore, "%s() @%p %s\n", __func__, this,
+                       name ());
 #endif
 
       return port::semaphore::post (this);
@@ -347,15 +362,16 @@ namespace os
           if (count_ >= this->max_value_)
             {
 #if defined(OS_TRACE_RTOS_SEMAPHORE)
-              trace::printf ("%s() @%p %s EAGAIN\n", __func__, this, name ());
+              OS_TRACE_PRINTF (rtos_semaphore, "%s() @%p %s EAGAIN\n", __func__,
+                               this, name ());
 #endif
               return EAGAIN;
             }
 
           ++count_;
 #if defined(OS_TRACE_RTOS_SEMAPHORE)
-          trace::printf ("%s() @%p %s count %u\n", __func__, this, name (),
-                         count_);
+          OS_TRACE_PRINTF (rtos_semaphore, "%s() @%p %s count %u\n", __func__,
+                           this, name (), count_);
 #endif
           // ----- Exit critical section --------------------------------------
         }
@@ -399,8 +415,13 @@ namespace os
     result_t
     semaphore::wait ()
     {
+#if defined(OS_INCLUDE_RTOS_TRACE_EVENTS)
+      os_rtos_trace_object (os_rtos_trace_semaphore_wait, this);
+#endif /* defined(OS_INCLUDE_RTOS_TRACE_EVENTS) */
+
 #if defined(OS_TRACE_RTOS_SEMAPHORE)
-      trace::printf ("%s() @%p %s <%u\n", __func__, this, name (), count_);
+      OS_TRACE_PRINTF (rtos_semaphore, "%s() @%p %s <%u\n", __func__, this,
+                       name (), count_);
 #endif
 
       // Don't call this from interrupt handlers.
@@ -461,7 +482,8 @@ namespace os
           if (crt_thread.interrupted ())
             {
 #if defined(OS_TRACE_RTOS_SEMAPHORE)
-              trace::printf ("%s() EINTR @%p %s\n", __func__, this, name ());
+              OS_TRACE_PRINTF (rtos_semaphore, "%s() EINTR @%p %s\n", __func__,
+                               this, name ());
 #endif
               return EINTR;
             }
@@ -496,8 +518,13 @@ namespace os
     result_t
     semaphore::try_wait ()
     {
+#if defined(OS_INCLUDE_RTOS_TRACE_EVENTS)
+      os_rtos_trace_object (os_rtos_trace_semaphore_wait, this);
+#endif /* defined(OS_INCLUDE_RTOS_TRACE_EVENTS) */
+
 #if defined(OS_TRACE_RTOS_SEMAPHORE)
-      trace::printf ("%s() @%p %s <%u\n", __func__, this, name (), count_);
+      OS_TRACE_PRINTF (rtos_semaphore, "%s() @%p %s <%u\n", __func__, this,
+                       name (), count_);
 #endif
 
       // Don't call this from high priority interrupts.
@@ -566,10 +593,14 @@ namespace os
     result_t
     semaphore::timed_wait (clock::duration_t timeout)
     {
+#if defined(OS_INCLUDE_RTOS_TRACE_EVENTS)
+      os_rtos_trace_object (os_rtos_trace_semaphore_wait, this);
+#endif /* defined(OS_INCLUDE_RTOS_TRACE_EVENTS) */
+
 #if defined(OS_TRACE_RTOS_SEMAPHORE)
-      trace::printf ("%s(%u) @%p %s <%u\n", __func__,
-                     static_cast<unsigned int> (timeout), this, name (),
-                     count_);
+      OS_TRACE_PRINTF (rtos_semaphore, "%s(%u) @%p %s <%u\n", __func__,
+                       static_cast<unsigned int> (timeout), this, name (),
+                       count_);
 #endif
 
       // Don't call this from interrupt handlers.
@@ -581,6 +612,65 @@ namespace os
 
       return port::semaphore::timed_wait (this, timeout);
 
+#else
+
+      // Extra test before entering the loop, with its inherent weight.
+      // Trade size for speed.
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          if (internal_try_wait_ ())
+            {
+              return result::ok;
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+
+      return timed_wait_until (clock_->steady_now () + timeout);
+
+#endif
+    }
+
+    /**
+     * @details
+     * Like `timed_wait()`, but the timeout expires when the
+     * steady time of the semaphore clock reaches the absolute
+     * `timestamp`. The time stamp is linked as is in the clock
+     * list, so retry loops that keep the same deadline do not
+     * accumulate the time spent between the calls.
+     *
+     * If the time stamp is in the past, the semaphore is still
+     * tried once, and the function returns `ETIMEDOUT` only if
+     * it cannot be locked immediately.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    semaphore::timed_wait_until (clock::timestamp_t timestamp)
+    {
+#if defined(OS_INCLUDE_RTOS_TRACE_EVENTS)
+      os_rtos_trace_object (os_rtos_trace_semaphore_wait, this);
+#endif /* defined(OS_INCLUDE_RTOS_TRACE_EVENTS) */
+
+#if defined(OS_TRACE_RTOS_SEMAPHORE)
+      OS_TRACE_PRINTF (rtos_semaphore, "%s(%u) @%p %s <%u\n", __func__,
+                       static_cast<unsigned int> (timestamp), this, name (),
+                       count_);
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      // Don't call this from critical regions.
+      os_assert_err(!scheduler::locked (), EPERM);
+
+#if defined(OS_USE_RTOS_PORT_SEMAPHORE)
+
+      clock::timestamp_t nw = clock_->steady_now ();
+      return port::semaphore::timed_wait (
+          this,
+          (timestamp > nw) ? static_cast<clock::duration_t> (timestamp - nw) : 0);
+
 #else
 
       // Extra test before entering the loop, with its inherent weight.
@@ -598,6 +688,12 @@ namespace os
 
       thread& crt_thread = this_thread::thread ();
 
+      if (clock_->steady_now () > timestamp)
+        {
+          // The deadline already passed, do not wait for the next tick.
+          return ETIMEDOUT;
+        }
+
       // Prepare a list node pointing to the current thread.
       // Do not worry for being on stack, it is temporarily linked to the
       // list and guaranteed to be removed before this function returns.
@@ -605,7 +701,7 @@ namespace os
         { crt_thread };
 
       internal::clock_timestamps_list& clock_list = clock_->steady_list ();
-      clock::timestamp_t timeout_timestamp = clock_->steady_now () + timeout;
+      clock::timestamp_t timeout_timestamp = timestamp;
 
       // Prepare a timeout node pointing to the current thread.
       internal::timeout_thread_node timeout_node
@@ -640,9 +736,9 @@ namespace os
           if (crt_thread.interrupted ())
             {
 #if defined(OS_TRACE_RTOS_SEMAPHORE)
-              trace::printf ("%s(%u) EINTR @%p %s\n", __func__,
-                             static_cast<unsigned int> (timeout), this,
-                             name ());
+              OS_TRACE_PRINTF (rtos_semaphore, "%s(%u) EINTR @%p %s\n",
+                               __func__, static_cast<unsigned int> (timestamp),
+                               this, name ());
 #endif
               return EINTR;
             }
@@ -650,9 +746,9 @@ namespace os
           if (clock_->steady_now () >= timeout_timestamp)
             {
 #if defined(OS_TRACE_RTOS_SEMAPHORE)
-              trace::printf ("%s(%u) ETIMEDOUT @%p %s\n", __func__,
-                             static_cast<unsigned int> (timeout), this,
-                             name ());
+              OS_TRACE_PRINTF (rtos_semaphore, "%s(%u) ETIMEDOUT @%p %s\n",
+                               __func__, static_cast<unsigned int> (timestamp),
+                               this, name ());
 #endif
               return ETIMEDOUT;
             }
@@ -708,7 +804,8 @@ namespace os
     semaphore::reset (void)
     {
 #if defined(OS_TRACE_RTOS_SEMAPHORE)
-      trace::printf ("%s() @%p %s <%u\n", __func__, this, name (), count_);
+      OS_TRACE_PRINTF (rtos_semaphore, "%s() @%p %s <%u\n", __func__, this,
+                       name (), count_);
 #endif
 
       // Don't call this from interrupt handlers.
@@ -0,0 +1,202 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/rtos/os.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    // ------------------------------------------------------------------------
+
+    /**
+     * @class spsc_channel_base
+     * @details
+     * The producer owns `head_` and the consumer owns `tail_`;
+     * each side only reads the other's index, so no locks are
+     * needed to move the elements.
+     *
+     * A side that must block raises its `*_waiting_` flag, checks
+     * the ring again and only then parks on its list; the other
+     * side consumes the flag after each operation and resumes the
+     * waiter, so only the blocking paths enter critical sections.
+     */
+
+    /**
+     * @details
+     * The channel is usable immediately after construction.
+     */
+    spsc_channel_base::spsc_channel_base (const char* name,
+                                          std::size_t capacity) :
+        object_named_system
+          { name }, //
+        mask_ (capacity - 1)
+    {
+#if defined(OS_TRACE_RTOS_SPSC)
+      OS_TRACE_PRINTF (rtos_spsc, "%s() @%p %s %u\n", __func__, this,
+                       this->name (), capacity);
+#endif
+
+      assert(capacity >= 2 && (capacity & (capacity - 1)) == 0);
+    }
+
+    /**
+     * @details
+     * There must be no threads waiting on the channel.
+     */
+    spsc_channel_base::~spsc_channel_base ()
+    {
+#if defined(OS_TRACE_RTOS_SPSC)
+      OS_TRACE_PRINTF (rtos_spsc, "%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      assert(producer_list_.empty ());
+      assert(consumer_list_.empty ());
+    }
+
+    /**
+     * @cond ignore
+     */
+
+    /*
+     * Park the current thread on the side list, until the ring is
+     * ready for it. The flag is raised inside the critical section,
+     * before the last check, so a notification from the other side
+     * cannot be lost between the check and the link.
+     */
+    result_t
+    spsc_channel_base::internal_wait_ (bool consumer,
+                                       clock::duration_t timeout, bool timed)
+    {
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      // Don't call this from critical regions.
+      os_assert_err(!scheduler::locked (), EPERM);
+
+      internal::waiting_threads_list& list =
+          consumer ? consumer_list_ : producer_list_;
+      bool* waiting = consumer ? &consumer_waiting_ : &producer_waiting_;
+
+      thread& crt_thread = this_thread::thread ();
+
+      // Prepare a list node pointing to the current thread.
+      // Do not worry for being on stack, it is temporarily linked to the
+      // list and guaranteed to be removed before this function returns.
+      internal::waiting_thread_node node
+        { crt_thread };
+
+      internal::clock_timestamps_list& clock_list = sysclock.steady_list ();
+      clock::timestamp_t timeout_timestamp = sysclock.steady_now () + timeout;
+
+      // Prepare a timeout node pointing to the current thread.
+      internal::timeout_thread_node timeout_node
+        { timeout_timestamp, crt_thread };
+
+      for (;;)
+        {
+            {
+              // ----- Enter critical section ---------------------------------
+              interrupts::critical_section ics;
+
+              __atomic_store_n (waiting, true, __ATOMIC_RELAXED);
+              __atomic_thread_fence (__ATOMIC_SEQ_CST);
+
+              if (consumer ? !empty () : !full ())
+                {
+                  __atomic_store_n (waiting, false, __ATOMIC_RELAXED);
+                  return result::ok;
+                }
+
+              if (timed)
+                {
+                  scheduler::internal_link_node (list, node, clock_list,
+                                                 timeout_node);
+                }
+              else
+                {
+                  scheduler::internal_link_node (list, node);
+                }
+              // state::suspended set in above link().
+              // ----- Exit critical section ----------------------------------
+            }
+
+          port::scheduler::reschedule ();
+
+          // Remove the thread from the waiting list, if not already
+          // removed by the other side, and from the clock timeout list,
+          // if not already removed by the timer.
+          if (timed)
+            {
+              scheduler::internal_unlink_node (node, timeout_node);
+            }
+          else
+            {
+              scheduler::internal_unlink_node (node);
+            }
+
+          __atomic_store_n (waiting, false, __ATOMIC_RELAXED);
+
+          if (consumer ? !empty () : !full ())
+            {
+              return result::ok;
+            }
+
+          if (crt_thread.interrupted ())
+            {
+#if defined(OS_TRACE_RTOS_SPSC)
+              OS_TRACE_PRINTF (rtos_spsc, "%s() EINTR @%p %s\n", __func__, this,
+                               name ());
+#endif
+              return EINTR;
+            }
+
+          if (timed && sysclock.steady_now () >= timeout_timestamp)
+            {
+#if defined(OS_TRACE_RTOS_SPSC)
+              OS_TRACE_PRINTF (rtos_spsc, "%s() ETIMEDOUT @%p %s\n", __func__,
+                               this, name ());
+#endif
+              return ETIMEDOUT;
+            }
+        }
+
+      /* NOTREACHED */
+      return ENOTRECOVERABLE;
+    }
+
+    /**
+     * @endcond
+     */
+
+  // --------------------------------------------------------------------------
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
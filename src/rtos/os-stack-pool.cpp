@@ -0,0 +1,294 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <cmsis-plus/rtos/os.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    // ------------------------------------------------------------------------
+
+    /**
+     * @class stack_pool
+     * @details
+     * The free stacks are kept in a LIFO list, linked by the
+     * first word of each block, so the most recently used stack,
+     * likely still in the cache, is reused first. The words used
+     * for the link are restored to the magic word when the stack
+     * is taken from the pool.
+     *
+     * Since the stacks grow down, when a stack is returned only
+     * the words above the first changed one need to be filled
+     * again; the cost of the fill is proportional to the stack
+     * usage, not to the stack size.
+     *
+     * @par Example
+     *
+     * @code{.cpp}
+     * stack_pool_inclusive<8, 2048> pool { "conn" };
+     *
+     * void
+     * accept (int fd)
+     * {
+     *   thread::attributes attr;
+     *   attr.th_stack_pool = &pool;
+     *
+     *   new thread { "conn", serve, reinterpret_cast<void*> (fd), attr };
+     * }
+     * @endcode
+     */
+
+    /**
+     * @cond ignore
+     */
+
+    // Number of stack words used by the free list link.
+    static constexpr std::size_t link_words = (sizeof(void*)
+        + sizeof(thread::stack::element_t) - 1)
+        / sizeof(thread::stack::element_t);
+
+    stack_pool::stack_pool (const char* name) :
+        object_named_system
+          { name }
+    {
+#if defined(OS_TRACE_RTOS_STACK_POOL)
+      OS_TRACE_PRINTF (rtos_stack_pool, "%s() @%p %s\n", __func__, this,
+                       this->name ());
+#endif
+    }
+
+    /**
+     * @endcond
+     */
+
+    /**
+     * @details
+     * The arena is aligned to `allocation_element_t` and all
+     * stacks are filled with the magic word.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    stack_pool::stack_pool (std::size_t stacks, std::size_t stack_size_bytes,
+                            void* arena_address,
+                            std::size_t arena_size_bytes) :
+        stack_pool
+          { nullptr, stacks, stack_size_bytes, arena_address,
+              arena_size_bytes }
+    {
+      ;
+    }
+
+    /**
+     * @details
+     * The arena is aligned to `allocation_element_t` and all
+     * stacks are filled with the magic word.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    stack_pool::stack_pool (const char* name, std::size_t stacks,
+                            std::size_t stack_size_bytes, void* arena_address,
+                            std::size_t arena_size_bytes) :
+        object_named_system
+          { name }
+    {
+#if defined(OS_TRACE_RTOS_STACK_POOL)
+      OS_TRACE_PRINTF (rtos_stack_pool, "%s() @%p %s\n", __func__, this,
+                       this->name ());
+#endif
+
+      internal_construct_ (stacks, stack_size_bytes, arena_address,
+                           arena_size_bytes);
+    }
+
+    /**
+     * @cond ignore
+     */
+
+    void
+    stack_pool::internal_construct_ (std::size_t stacks,
+                                     std::size_t stack_size_bytes,
+                                     void* arena_address,
+                                     std::size_t arena_size_bytes)
+    {
+      // Don't call this from interrupt handlers.
+      os_assert_throw(!interrupts::in_handler_mode (), EPERM);
+
+      assert(stacks > 0);
+      assert(arena_address != nullptr);
+
+      block_size_bytes_ = compute_block_size_bytes (stack_size_bytes);
+      assert(block_size_bytes_ > thread::stack::min_size ());
+
+      void* p = arena_address;
+      p = std::align (sizeof(allocation_element_t),
+                      compute_allocated_size_bytes (stacks, stack_size_bytes),
+                      p, arena_size_bytes);
+
+      // The arena must be large enough for all stacks.
+      os_assert_throw(p != nullptr, ENOMEM);
+
+      capacity_ = stacks;
+
+      // Build the list of free stacks, from the top of the arena,
+      // so the first stack is at the list head.
+      first_ = nullptr;
+      char* block = static_cast<char*> (p) + stacks * block_size_bytes_;
+      for (std::size_t i = 0; i < stacks; ++i)
+        {
+          block -= block_size_bytes_;
+
+          element_t* q = reinterpret_cast<element_t*> (block);
+          element_t* qend = reinterpret_cast<element_t*> (block
+              + block_size_bytes_);
+          for (; q < qend; ++q)
+            {
+              *q = thread::stack::magic;
+            }
+
+          *reinterpret_cast<void**> (block) = first_;
+          first_ = block;
+        }
+      count_ = stacks;
+
+#if defined(OS_TRACE_RTOS_STACK_POOL)
+      OS_TRACE_PRINTF (rtos_stack_pool, "%s() @%p %s %u*%u\n", __func__, this,
+                       name (), stacks, block_size_bytes_);
+#endif
+    }
+
+    /**
+     * @endcond
+     */
+
+    /**
+     * @details
+     * All stacks must have been returned to the pool.
+     */
+    stack_pool::~stack_pool ()
+    {
+#if defined(OS_TRACE_RTOS_STACK_POOL)
+      OS_TRACE_PRINTF (rtos_stack_pool, "%s() @%p %s\n", __func__, this,
+                       name ());
+#endif
+
+      assert(count_ == capacity_);
+    }
+
+    /**
+     * @details
+     * The stack is ready to use, with all words set to the
+     * magic word; no further initialisation is needed.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    void*
+    stack_pool::try_acquire (void)
+    {
+      void* block;
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          block = first_;
+          if (block == nullptr)
+            {
+              return nullptr;
+            }
+          first_ = *static_cast<void**> (block);
+          --count_;
+          // ----- Exit critical section --------------------------------------
+        }
+
+      // Restore the words used by the link.
+      element_t* q = static_cast<element_t*> (block);
+      for (std::size_t i = 0; i < link_words; ++i)
+        {
+          q[i] = thread::stack::magic;
+        }
+
+#if defined(OS_TRACE_RTOS_STACK_POOL)
+      OS_TRACE_PRINTF (rtos_stack_pool, "%s() @%p %s %p\n", __func__, this,
+                       name (), block);
+#endif
+
+      return block;
+    }
+
+    /**
+     * @details
+     * The words above the lowest one that lost the magic word
+     * are filled again, then the stack is linked to the list.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    void
+    stack_pool::release (void* stack)
+    {
+#if defined(OS_TRACE_RTOS_STACK_POOL)
+      OS_TRACE_PRINTF (rtos_stack_pool, "%s() @%p %s %p\n", __func__, this,
+                       name (), stack);
+#endif
+
+      assert(stack != nullptr);
+
+      element_t* q = static_cast<element_t*> (stack);
+      element_t* qend = reinterpret_cast<element_t*> (static_cast<char*> (stack)
+          + block_size_bytes_);
+
+      // Skip the part never used.
+      while (q < qend && *q == thread::stack::magic)
+        {
+          ++q;
+        }
+      for (; q < qend; ++q)
+        {
+          *q = thread::stack::magic;
+        }
+
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          assert(count_ < capacity_);
+
+          *static_cast<void**> (stack) = first_;
+          first_ = stack;
+          ++count_;
+          // ----- Exit critical section --------------------------------------
+        }
+    }
+
+  // --------------------------------------------------------------------------
+
+  } /* namespace rtos */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
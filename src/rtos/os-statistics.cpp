@@ -0,0 +1,1306 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <cmsis-plus/rtos/os.h>
+
+#include <cstring>
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_CRITICAL_SECTIONS)
+
+namespace os
+{
+  namespace rtos
+  {
+    // ------------------------------------------------------------------------
+
+    namespace
+    {
+      // The sites entering critical sections, in a small hash table.
+      struct sites_table
+      {
+        statistics::site sites[OS_INTEGER_RTOS_STATISTICS_CRITICAL_SITES];
+
+        // The measurements of the sites that did not fit.
+        statistics::counter_t dropped;
+      };
+
+      // The outermost section currently open on a core.
+      struct open_section
+      {
+        std::size_t nesting;
+        std::size_t paused_nesting;
+        const void* address;
+        clock::timestamp_t begin;
+      };
+
+#if defined(OS_INCLUDE_RTOS_SMP)
+      constexpr std::size_t cores = OS_INTEGER_RTOS_SMP_CORES;
+#else
+      constexpr std::size_t cores = 1;
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+
+      sites_table interrupts_table;
+      sites_table scheduler_table;
+
+      open_section interrupts_open[cores];
+      open_section scheduler_open[cores];
+
+      statistics::site latency_site;
+
+      inline std::size_t
+      core_index (void)
+      {
+#if defined(OS_INCLUDE_RTOS_SMP)
+        return port::core::id ();
+#else
+        return 0;
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+      }
+
+      // A critical section not measured itself, for accessing the
+      // tables from the threads.
+      class raw_critical_section
+      {
+      public:
+
+        raw_critical_section () :
+            state_ (port::interrupts::critical_section::enter ())
+        {
+#if defined(OS_INCLUDE_RTOS_SMP)
+          scheduler::kernel_lock_.lock ();
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+        }
+
+        ~raw_critical_section ()
+        {
+#if defined(OS_INCLUDE_RTOS_SMP)
+          scheduler::kernel_lock_.unlock ();
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+          port::interrupts::critical_section::exit (state_);
+        }
+
+        raw_critical_section (const raw_critical_section&) = delete;
+        raw_critical_section (raw_critical_section&&) = delete;
+        raw_critical_section&
+        operator= (const raw_critical_section&) = delete;
+        raw_critical_section&
+        operator= (raw_critical_section&&) = delete;
+
+      protected:
+
+        const interrupts::state_t state_;
+      };
+
+      /*
+       * With the interrupts masked, the count of the high resolution
+       * clock is not updated by a pending tick, while the SysTick
+       * counter already restarted; the missing tick is added back.
+       */
+      statistics::duration_t
+      elapsed (clock::timestamp_t begin, clock::timestamp_t end)
+      {
+        if (end < begin)
+          {
+            end += port::clock_highres::cycles_per_tick ();
+          }
+        return end - begin;
+      }
+
+      void
+      record (statistics::site& st, statistics::duration_t cycles)
+      {
+        st.histogram[statistics::internal_histogram_bucket_ (cycles)]++;
+        st.count++;
+        if (cycles > st.max_cycles)
+          {
+            st.max_cycles = cycles;
+          }
+      }
+
+      // Must be called from a critical section.
+      void
+      record_site (sites_table& table, const void* address,
+                   statistics::duration_t cycles)
+      {
+        constexpr std::size_t size = OS_INTEGER_RTOS_STATISTICS_CRITICAL_SITES;
+
+        std::size_t h = (reinterpret_cast<std::uintptr_t> (address) >> 1)
+            % size;
+        for (std::size_t n = 0; n < size; ++n)
+          {
+            statistics::site& st = table.sites[h];
+            if (st.address == address)
+              {
+                record (st, cycles);
+                return;
+              }
+            if (st.address == nullptr)
+              {
+                st.address = address;
+                record (st, cycles);
+                return;
+              }
+            h = (h + 1) % size;
+          }
+        table.dropped++;
+      }
+
+      std::size_t
+      copy_sites (const sites_table& table, statistics::site* out,
+                  std::size_t count)
+      {
+        raw_critical_section rcs;
+
+        std::size_t n = 0;
+        for (const statistics::site& st : table.sites)
+          {
+            if (st.address != nullptr && n < count)
+              {
+                out[n++] = st;
+              }
+          }
+        return n;
+      }
+
+      void
+      dump_site (const statistics::site& st)
+      {
+        trace::printf ("%p %lu max %lu:", st.address,
+                       static_cast<unsigned long> (st.count),
+                       static_cast<unsigned long> (st.max_cycles));
+        for (statistics::counter_t c : st.histogram)
+          {
+            trace::printf (" %lu", static_cast<unsigned long> (c));
+          }
+        trace::printf ("\n");
+      }
+
+      void
+      dump_table (const char* title, const sites_table& table)
+      {
+        statistics::site copy[OS_INTEGER_RTOS_STATISTICS_CRITICAL_SITES];
+        std::size_t n = copy_sites (table, copy,
+                                    OS_INTEGER_RTOS_STATISTICS_CRITICAL_SITES);
+
+        trace::printf ("%s critical sections, %u sites, %lu dropped\n", title,
+                       n, static_cast<unsigned long> (table.dropped));
+        for (std::size_t i = 0; i < n; ++i)
+          {
+            dump_site (copy[i]);
+          }
+      }
+
+      void
+      reset_table (sites_table& table)
+      {
+        raw_critical_section rcs;
+
+        table = sites_table ();
+      }
+    }
+
+    namespace interrupts
+    {
+      namespace statistics
+      {
+        /**
+         * @details
+         * Only the sites with measured sections are copied.
+         *
+         * @note Can be invoked from Interrupt Service Routines.
+         */
+        std::size_t
+        critical_sections (rtos::statistics::site* out, std::size_t count)
+        {
+          return copy_sites (interrupts_table, out, count);
+        }
+
+        /**
+         * @details
+         * The latency is measured from the moment the SysTick
+         * counter restarts to the entry in `os_systick_handler()`,
+         * and includes the time the interrupts were masked.
+         *
+         * @note Can be invoked from Interrupt Service Routines.
+         */
+        void
+        latency (rtos::statistics::site& out)
+        {
+          raw_critical_section rcs;
+
+          out = latency_site;
+        }
+
+        /**
+         * @details
+         * One line for each site, with the return address, the
+         * count, the maximum and the histogram.
+         */
+        void
+        dump_critical_sections (void)
+        {
+          dump_table ("interrupts", interrupts_table);
+
+          rtos::statistics::site st;
+          latency (st);
+          trace::printf ("tick latency ");
+          dump_site (st);
+        }
+
+        void
+        reset_critical_sections (void)
+        {
+          reset_table (interrupts_table);
+
+          raw_critical_section rcs;
+          latency_site = rtos::statistics::site ();
+        }
+
+        /**
+         * @cond ignore
+         */
+
+        /*
+         * Not inlined, so the return address points into the
+         * function that entered the critical section.
+         * Called with the interrupts masked.
+         */
+        void
+        __attribute__((noinline))
+        internal_enter_ (void)
+        {
+          open_section& sec = interrupts_open[core_index ()];
+          if (sec.nesting++ == 0)
+            {
+              sec.address = __builtin_return_address (0);
+              sec.begin = hrclock.internal_now_unlocked ();
+            }
+        }
+
+        // Called with the interrupts still masked.
+        void
+        internal_exit_ (void)
+        {
+          open_section& sec = interrupts_open[core_index ()];
+          if (sec.nesting == 0)
+            {
+              // Entered before the instrumentation, e.g. by the port.
+              return;
+            }
+          if (--sec.nesting == 0)
+            {
+              record_site (
+                  interrupts_table, sec.address,
+                  elapsed (sec.begin, hrclock.internal_now_unlocked ()));
+            }
+        }
+
+        // Close the measurement before unmasking the interrupts.
+        void
+        internal_pause_ (void)
+        {
+          open_section& sec = interrupts_open[core_index ()];
+          sec.paused_nesting = sec.nesting;
+          if (sec.nesting != 0)
+            {
+              record_site (
+                  interrupts_table, sec.address,
+                  elapsed (sec.begin, hrclock.internal_now_unlocked ()));
+              sec.nesting = 0;
+            }
+        }
+
+        // Start a new measurement after masking the interrupts again.
+        void
+        internal_resume_ (void)
+        {
+          open_section& sec = interrupts_open[core_index ()];
+          sec.nesting = sec.paused_nesting;
+          if (sec.nesting != 0)
+            {
+              sec.begin = hrclock.internal_now_unlocked ();
+            }
+        }
+
+        void
+        internal_record_latency_ (uint32_t cycles)
+        {
+          raw_critical_section rcs;
+
+          record (latency_site, cycles);
+        }
+
+        /**
+         * @endcond
+         */
+
+      } /* namespace statistics */
+    } /* namespace interrupts */
+
+    namespace scheduler
+    {
+      namespace statistics
+      {
+        /**
+         * @details
+         * Only the sites with measured sections are copied.
+         *
+         * @note Can be invoked from Interrupt Service Routines.
+         */
+        std::size_t
+        critical_sections (rtos::statistics::site* out, std::size_t count)
+        {
+          return copy_sites (scheduler_table, out, count);
+        }
+
+        /**
+         * @details
+         * One line for each site, with the return address, the
+         * count, the maximum and the histogram.
+         */
+        void
+        dump_critical_sections (void)
+        {
+          dump_table ("scheduler", scheduler_table);
+        }
+
+        void
+        reset_critical_sections (void)
+        {
+          reset_table (scheduler_table);
+        }
+
+        /**
+         * @cond ignore
+         */
+
+        /*
+         * Not inlined, so the return address points into the
+         * function that locked the scheduler.
+         */
+        void
+        __attribute__((noinline))
+        internal_lock_enter_ (void)
+        {
+          const void* address = __builtin_return_address (0);
+
+          raw_critical_section rcs;
+
+          open_section& sec = scheduler_open[core_index ()];
+          sec.address = address;
+          sec.begin = hrclock.internal_now_unlocked ();
+        }
+
+        void
+        internal_lock_exit_ (void)
+        {
+          raw_critical_section rcs;
+
+          open_section& sec = scheduler_open[core_index ()];
+          record_site (scheduler_table, sec.address,
+                       elapsed (sec.begin, hrclock.internal_now_unlocked ()));
+        }
+
+        /**
+         * @endcond
+         */
+
+      } /* namespace statistics */
+    } /* namespace scheduler */
+
+  // --------------------------------------------------------------------------
+
+  } /* namespace rtos */
+} /* namespace os */
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_CRITICAL_SECTIONS) */
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK_LATENCY)
+
+namespace os
+{
+  namespace rtos
+  {
+    // ------------------------------------------------------------------------
+
+    namespace
+    {
+      // The latencies of the timeouts dispatched by one clock.
+      struct clock_slot
+      {
+        const clock* clk;
+        statistics::latency expiry;
+        statistics::latency wakeup;
+      };
+
+      // The system clock, the high resolution clock, the real
+      // time clock and one more.
+      constexpr std::size_t clock_slots = 4;
+
+      clock_slot slots[clock_slots];
+
+      // The clock currently dispatching, saved by nested interrupts.
+      clock_slot* current_slot;
+      clock::timestamp_t current_now;
+
+      // Must be called from a critical section.
+      clock_slot*
+      find_slot (const clock* clk, bool create)
+      {
+        for (clock_slot& sl : slots)
+          {
+            if (sl.clk == clk)
+              {
+                return &sl;
+              }
+            if (sl.clk == nullptr)
+              {
+                if (!create)
+                  {
+                    return nullptr;
+                  }
+                sl.clk = clk;
+                return &sl;
+              }
+          }
+        return nullptr;
+      }
+
+      void
+      record_latency (statistics::latency& lt, statistics::duration_t cycles)
+      {
+        lt.histogram[statistics::internal_histogram_bucket_ (cycles)]++;
+        lt.count++;
+        lt.total_cycles += cycles;
+        if (cycles > lt.max_cycles)
+          {
+            lt.max_cycles = cycles;
+          }
+      }
+
+      /*
+       * Convert the lateness to CPU cycles. The system clock ticks
+       * are completed with the cycles elapsed since the last tick;
+       * for other clocks only the whole periods are accounted.
+       */
+      statistics::duration_t
+      lateness_cycles (const clock* clk, clock::timestamp_t now,
+                       clock::timestamp_t timestamp)
+      {
+        if (clk == &hrclock)
+          {
+            clock::timestamp_t nw = hrclock.internal_now_unlocked ();
+            return (nw > timestamp) ? (nw - timestamp) : 0;
+          }
+
+        clock::timestamp_t late = (now > timestamp) ? (now - timestamp) : 0;
+        if (clk == &sysclock)
+          {
+            return late * port::clock_highres::cycles_per_tick ()
+                + port::clock_highres::cycles_since_tick ();
+          }
+        return late * port::clock_highres::input_clock_frequency_hz ();
+      }
+
+      void
+      dump_latency (const char* title, const statistics::latency& lt)
+      {
+        trace::printf (
+            "  %s %lu mean %lu max %lu:", title,
+            static_cast<unsigned long> (lt.count),
+            static_cast<unsigned long> (
+                (lt.count != 0) ? (lt.total_cycles / lt.count) : 0),
+            static_cast<unsigned long> (lt.max_cycles));
+        for (statistics::counter_t c : lt.histogram)
+          {
+            trace::printf (" %lu", static_cast<unsigned long> (c));
+          }
+        trace::printf ("\n");
+      }
+    }
+
+    /**
+     * @details
+     * The expiry latency is the time from the node time stamp
+     * to its dispatch by the clock; the wakeup latency is the time
+     * from the dispatch to the moment the woken thread is switched
+     * in. Both are measured in CPU cycles, with the high resolution
+     * clock.
+     *
+     * The timers run by the timer daemon thread are dispatched
+     * only once the daemon runs; this additional delay is
+     * not accounted.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    void
+    clock::latency_statistics (statistics::latency* expiry,
+                               statistics::latency* wakeup)
+    {
+      // ----- Enter critical section -----------------------------------------
+      interrupts::critical_section ics;
+
+      clock_slot* sl = find_slot (this, false);
+      if (expiry != nullptr)
+        {
+          *expiry = (sl != nullptr) ? sl->expiry : statistics::latency ();
+        }
+      if (wakeup != nullptr)
+        {
+          *wakeup = (sl != nullptr) ? sl->wakeup : statistics::latency ();
+        }
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    /**
+     * @details
+     * One line for each latency, with the count, the mean, the
+     * maximum and the histogram.
+     */
+    void
+    clock::dump_latency_statistics (void)
+    {
+      statistics::latency expiry;
+      statistics::latency wakeup;
+      latency_statistics (&expiry, &wakeup);
+
+      trace::printf ("%s latency\n", name ());
+      dump_latency ("expiry", expiry);
+      dump_latency ("wakeup", wakeup);
+    }
+
+    /**
+     * @details
+     * The threads already woken and still waiting to run
+     * are not accounted.
+     */
+    void
+    clock::reset_latency_statistics (void)
+    {
+      // ----- Enter critical section -----------------------------------------
+      interrupts::critical_section ics;
+
+      clock_slot* sl = find_slot (this, false);
+      if (sl != nullptr)
+        {
+          sl->expiry = statistics::latency ();
+          sl->wakeup = statistics::latency ();
+        }
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    namespace statistics
+    {
+      /**
+       * @cond ignore
+       */
+
+      dispatch_scope::dispatch_scope (clock& clk,
+                                      port::clock::timestamp_t now) :
+          previous_ (current_slot), //
+          previous_now_ (current_now)
+      {
+        // ----- Enter critical section ---------------------------------------
+        interrupts::critical_section ics;
+
+        current_slot = find_slot (&clk, true);
+        current_now = now;
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      dispatch_scope::~dispatch_scope ()
+      {
+        // ----- Enter critical section ---------------------------------------
+        interrupts::critical_section ics;
+
+        current_slot = static_cast<clock_slot*> (previous_);
+        current_now = previous_now_;
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      // Called from the node actions, inside the clock dispatch.
+      void
+      internal_record_expiry_ (port::clock::timestamp_t timestamp)
+      {
+        // ----- Enter critical section ---------------------------------------
+        interrupts::critical_section ics;
+
+        clock_slot* sl = current_slot;
+        if (sl != nullptr)
+          {
+            record_latency (sl->expiry,
+                            lateness_cycles (sl->clk, current_now, timestamp));
+          }
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      void
+      internal_record_woken_ (thread& th)
+      {
+        // ----- Enter critical section ---------------------------------------
+        interrupts::critical_section ics;
+
+        th.latency_slot_ = current_slot;
+        th.latency_woken_ = hrclock.internal_now_unlocked ();
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      // Called when switching to a thread woken by a timeout.
+      void
+      internal_record_running_ (thread& th)
+      {
+        // ----- Enter critical section ---------------------------------------
+        interrupts::critical_section ics;
+
+        clock::timestamp_t nw = hrclock.internal_now_unlocked ();
+        clock_slot* sl = static_cast<clock_slot*> (th.latency_slot_);
+        record_latency (sl->wakeup,
+                        (nw > th.latency_woken_) ? (nw - th.latency_woken_) : 0);
+        th.latency_slot_ = nullptr;
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      /**
+       * @endcond
+       */
+
+    } /* namespace statistics */
+
+  // --------------------------------------------------------------------------
+
+  } /* namespace rtos */
+} /* namespace os */
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_CLOCK_LATENCY) */
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_CPU_LOAD)
+
+/**
+ * @cond ignore
+ */
+extern os::rtos::thread* os_idle_thread;
+/**
+ * @endcond
+ */
+
+namespace os
+{
+  namespace rtos
+  {
+    // ------------------------------------------------------------------------
+
+    namespace
+    {
+      // The ticks in one 100 ms sample.
+      constexpr uint32_t load_sample_ticks =
+          (clock_systick::frequency_hz + 5) / 10;
+
+      // The averages are kept in per mille, with 8 fractional bits.
+      constexpr uint32_t load_shift = 8;
+
+      uint32_t load_ticks = load_sample_ticks;
+
+      rtos::statistics::duration_t load_total;
+      rtos::statistics::duration_t load_idle;
+
+      volatile uint32_t load_averages[3];
+
+      rtos::statistics::duration_t idle_sleep_cycles;
+
+      // Must be called from a critical section.
+      rtos::statistics::duration_t
+      running_idle_cycles (clock::timestamp_t now)
+      {
+        rtos::statistics::duration_t cycles =
+            os_idle_thread->statistics ().cpu_cycles ();
+        if (&this_thread::thread () == os_idle_thread)
+          {
+            // Not yet accumulated by a context switch.
+            cycles += static_cast<rtos::statistics::duration_t> (now
+                - scheduler::statistics::switch_timestamp_);
+          }
+        return cycles;
+      }
+    }
+
+    namespace scheduler
+    {
+      namespace statistics
+      {
+        /**
+         * @details
+         * The load is the part of the time not spent in the idle
+         * thread, sampled every 100 ms from the system tick; the
+         * 1 s and 10 s figures are exponential moving averages of
+         * the samples, the 100 ms figure is the last sample.
+         *
+         * The interrupts serviced while the idle thread runs
+         * are counted as idle time; with SMP, only the boot core
+         * is accounted.
+         *
+         * @note Can be invoked from Interrupt Service Routines.
+         */
+        uint32_t
+        cpu_load (load_window w)
+        {
+          uint32_t index = static_cast<uint32_t> (w);
+          assert(index < 3);
+
+          return (load_averages[index] + (1u << (load_shift - 1)))
+              >> load_shift;
+        }
+
+        /**
+         * @warning Cannot be invoked from Interrupt Service Routines.
+         */
+        rtos::statistics::duration_t
+        idle_cycles (void)
+        {
+          if (os_idle_thread == nullptr)
+            {
+              return 0;
+            }
+
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          return running_idle_cycles (hrclock.now ());
+          // ----- Exit critical section --------------------------------------
+        }
+
+        /**
+         * @details
+         * The time the idle thread waited for interrupts, including
+         * the tickless sleeps and the power saving modes entered
+         * by `os_rtos_idle_enter_power_saving_mode_hook()`.
+         *
+         * @warning Cannot be invoked from Interrupt Service Routines.
+         */
+        rtos::statistics::duration_t
+        sleep_cycles (void)
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          return idle_sleep_cycles;
+          // ----- Exit critical section --------------------------------------
+        }
+
+        /**
+         * @details
+         * One line with the three averages, in percents, and
+         * the idle and sleep cycles.
+         */
+        void
+        dump_cpu_load (void)
+        {
+          uint32_t l0 = cpu_load (load_window::ms_100);
+          uint32_t l1 = cpu_load (load_window::s_1);
+          uint32_t l2 = cpu_load (load_window::s_10);
+
+          trace::printf ("cpu load %u.%u%% %u.%u%% %u.%u%%, idle %lu, "
+                         "sleep %lu\n",
+                         l0 / 10, l0 % 10, l1 / 10, l1 % 10, l2 / 10, l2 % 10,
+                         static_cast<unsigned long> (idle_cycles ()),
+                         static_cast<unsigned long> (sleep_cycles ()));
+        }
+
+        /**
+         * @cond ignore
+         */
+
+        /*
+         * When the sleep is interrupted by a context switch, the
+         * cycles accumulated to the idle thread since the switch
+         * before the sleep include the sleep up to the switch.
+         */
+        sleep_scope::sleep_scope ()
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          begin_ = hrclock.now ();
+          switched_ = switch_timestamp_;
+          idle_ = os_idle_thread->statistics ().cpu_cycles ();
+          // ----- Exit critical section --------------------------------------
+        }
+
+        sleep_scope::~sleep_scope ()
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          rtos::statistics::duration_t idle =
+              os_idle_thread->statistics ().cpu_cycles ();
+          if (idle == idle_)
+            {
+              idle_sleep_cycles +=
+                  static_cast<rtos::statistics::duration_t> (hrclock.now ()
+                      - begin_);
+            }
+          else
+            {
+              idle_sleep_cycles += (idle - idle_)
+                  - static_cast<rtos::statistics::duration_t> (begin_
+                      - switched_);
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+
+        // Called from the system tick interrupt.
+        void
+        internal_sample_load_ (void)
+        {
+          if (--load_ticks != 0)
+            {
+              return;
+            }
+          load_ticks = load_sample_ticks;
+
+          if (os_idle_thread == nullptr || !scheduler::started ())
+            {
+              return;
+            }
+
+            {
+              // ----- Enter critical section ---------------------------------
+              interrupts::critical_section ics;
+
+              clock::timestamp_t now = hrclock.now ();
+              rtos::statistics::duration_t total = cpu_cycles_
+                  + static_cast<rtos::statistics::duration_t> (now
+                      - switch_timestamp_);
+              rtos::statistics::duration_t idle = running_idle_cycles (now);
+
+              rtos::statistics::duration_t dt = total - load_total;
+              rtos::statistics::duration_t di = idle - load_idle;
+              load_total = total;
+              load_idle = idle;
+
+              if (dt == 0)
+                {
+                  return;
+                }
+              if (di > dt)
+                {
+                  di = dt;
+                }
+
+              int32_t sample = static_cast<int32_t> ((1000
+                  - static_cast<uint32_t> ((di * 1000) / dt)) << load_shift);
+
+              // Samples every 100 ms, windows of 1 s and 10 s.
+              load_averages[0] = static_cast<uint32_t> (sample);
+              int32_t a1 = static_cast<int32_t> (load_averages[1]);
+              load_averages[1] = static_cast<uint32_t> (a1
+                  + (sample - a1) / 10);
+              int32_t a2 = static_cast<int32_t> (load_averages[2]);
+              load_averages[2] = static_cast<uint32_t> (a2
+                  + (sample - a2) / 100);
+              // ----- Exit critical section ----------------------------------
+            }
+
+#if defined(OS_INCLUDE_RTOS_DVFS)
+          dvfs::internal_sample_ ();
+#endif /* defined(OS_INCLUDE_RTOS_DVFS) */
+        }
+
+        /**
+         * @endcond
+         */
+
+      } /* namespace statistics */
+    } /* namespace scheduler */
+
+  // --------------------------------------------------------------------------
+
+  } /* namespace rtos */
+} /* namespace os */
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_CPU_LOAD) */
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_STACK_SITES)
+
+namespace os
+{
+  namespace rtos
+  {
+    // ------------------------------------------------------------------------
+
+    namespace
+    {
+      struct stack_sites_table
+      {
+        statistics::stack_site sites[OS_INTEGER_RTOS_STATISTICS_STACK_SITES];
+        statistics::counter_t dropped;
+      };
+
+      stack_sites_table stack_table;
+
+      std::size_t
+      recommended_stack_bytes (std::size_t peak_bytes)
+      {
+        std::size_t bytes = peak_bytes
+            + (peak_bytes * OS_INTEGER_RTOS_STATISTICS_STACK_MARGIN_PERCENT)
+                / 100;
+        bytes = (bytes + 7) & ~static_cast<std::size_t> (7);
+        if (bytes < thread::stack::min_size ())
+          {
+            bytes = thread::stack::min_size ();
+          }
+        return bytes;
+      }
+    }
+
+    namespace scheduler
+    {
+      namespace statistics
+      {
+        /**
+         * @details
+         * The threads are grouped by function and name; for each
+         * group, the largest stack and the largest usage seen are
+         * kept after the threads are destroyed. The recommended
+         * size is the usage plus
+         * `OS_INTEGER_RTOS_STATISTICS_STACK_MARGIN_PERCENT`,
+         * rounded up to 8 bytes.
+         *
+         * The usage is measured by the idle thread scan, so the
+         * threads must run long enough, on the worst case paths,
+         * for the figures to be meaningful.
+         *
+         * @warning Cannot be invoked from Interrupt Service Routines.
+         */
+        std::size_t
+        stack_sites (rtos::statistics::stack_site* out, std::size_t count)
+        {
+          // ----- Enter critical section -------------------------------------
+          scheduler::critical_section scs;
+
+          std::size_t n = 0;
+          for (const auto& st : stack_table.sites)
+            {
+              if (n >= count)
+                {
+                  break;
+                }
+              if (st.function == nullptr)
+                {
+                  break;
+                }
+              out[n] = st;
+              out[n].recommended_bytes = recommended_stack_bytes (
+                  st.peak_bytes);
+              ++n;
+            }
+          return n;
+          // ----- Exit critical section --------------------------------------
+        }
+
+        /**
+         * @details
+         * One line for each site, with the thread function, the
+         * name, the stack size, the peak usage and the recommended
+         * size, which can be used for `th_stack_size_bytes`.
+         */
+        void
+        dump_stack_sites (void)
+        {
+          rtos::statistics::stack_site copy[OS_INTEGER_RTOS_STATISTICS_STACK_SITES];
+          std::size_t n = stack_sites (copy,
+                                       OS_INTEGER_RTOS_STATISTICS_STACK_SITES);
+
+          trace::printf ("stacks, %u sites, %lu dropped\n", n,
+                         static_cast<unsigned long> (stack_table.dropped));
+          for (std::size_t i = 0; i < n; ++i)
+            {
+              trace::printf ("%p '%s' size %u, peak %u, recommended %u\n",
+                             copy[i].function, copy[i].name,
+                             copy[i].size_bytes, copy[i].peak_bytes,
+                             copy[i].recommended_bytes);
+            }
+        }
+
+        void
+        reset_stack_sites (void)
+        {
+          // ----- Enter critical section -------------------------------------
+          scheduler::critical_section scs;
+
+          stack_table = stack_sites_table ();
+          // ----- Exit critical section --------------------------------------
+        }
+
+        /**
+         * @cond ignore
+         */
+
+        /*
+         * Called by the idle thread after each scan pass, and when
+         * the thread is destroyed, with the peak usage known
+         * so far.
+         */
+        void
+        internal_record_stack_ (const void* function, const char* name,
+                                std::size_t size_bytes,
+                                std::size_t peak_bytes)
+        {
+          // ----- Enter critical section -------------------------------------
+          scheduler::critical_section scs;
+
+          for (auto& st : stack_table.sites)
+            {
+              if (st.function == nullptr)
+                {
+                  // First use of this slot.
+                  st.function = function;
+                  std::strncpy (st.name, name, sizeof(st.name) - 1);
+                }
+              else if (st.function != function
+                  || std::strncmp (st.name, name, sizeof(st.name) - 1) != 0)
+                {
+                  continue;
+                }
+
+              if (size_bytes > st.size_bytes)
+                {
+                  st.size_bytes = size_bytes;
+                }
+              if (peak_bytes > st.peak_bytes)
+                {
+                  st.peak_bytes = peak_bytes;
+                }
+              return;
+            }
+
+          ++stack_table.dropped;
+          // ----- Exit critical section --------------------------------------
+        }
+
+        /**
+         * @endcond
+         */
+
+      } /* namespace statistics */
+    } /* namespace scheduler */
+
+  // --------------------------------------------------------------------------
+
+  } /* namespace rtos */
+} /* namespace os */
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_STACK_SITES) */
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_EVENTS)
+
+#if defined(__ARM_EABI__) \
+  && (defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) \
+      || defined(__ARM_ARCH_8M_MAIN__) || defined(__ARM_ARCH_8_1M_MAIN__))
+#include <cmsis_device.h>
+#define OS_RTOS_STATISTICS_DWT_EVENTS
+#endif
+
+namespace os
+{
+  namespace rtos
+  {
+    // ------------------------------------------------------------------------
+
+    namespace
+    {
+      constexpr std::size_t event_types = thread::statistics::event_types;
+
+      // The hardware counters wrap; the DWT ones have 8 bits,
+      // the PMU ones 16 bits.
+      constexpr uint32_t event_masks[event_types] =
+        { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFFFF };
+
+      // The hardware counts at the previous sample.
+      uint32_t last_counts[event_types];
+
+      bool events_available;
+
+      void
+      read_counts (uint32_t* counts)
+      {
+#if defined(OS_RTOS_STATISTICS_DWT_EVENTS)
+        counts[0] = DWT->CPICNT;
+        counts[1] = DWT->EXCCNT;
+        counts[2] = DWT->SLEEPCNT;
+        counts[3] = DWT->LSUCNT;
+        counts[4] = DWT->FOLDCNT;
+#if defined(__ARM_ARCH_8_1M_MAIN__) && defined(__PMU_PRESENT) \
+  && (__PMU_PRESENT == 1)
+        counts[5] = ARM_PMU_Get_EVCNTR (0);
+#else
+        counts[5] = 0;
+#endif
+#else
+        for (std::size_t i = 0; i < event_types; ++i)
+          {
+            counts[i] = 0;
+          }
+#endif /* defined(OS_RTOS_STATISTICS_DWT_EVENTS) */
+      }
+    }
+
+    namespace scheduler
+    {
+      namespace statistics
+      {
+        /**
+         * @cond ignore
+         */
+
+        /**
+         * @details
+         * Enable the DWT profiling counters and, on Armv8.1-M,
+         * the PMU data cache read misses counter.
+         *
+         * Called once, when the scheduler starts.
+         */
+        void
+        internal_start_events_ (void)
+        {
+#if defined(OS_RTOS_STATISTICS_DWT_EVENTS)
+          CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+
+          // The profiling counters are optional.
+          if ((DWT->CTRL & DWT_CTRL_NOPRFCNT_Msk) == 0)
+            {
+              DWT->CTRL |= DWT_CTRL_CPIEVTENA_Msk | DWT_CTRL_EXCEVTENA_Msk
+                  | DWT_CTRL_SLEEPEVTENA_Msk | DWT_CTRL_LSUEVTENA_Msk
+                  | DWT_CTRL_FOLDEVTENA_Msk;
+              events_available = true;
+            }
+
+#if defined(__ARM_ARCH_8_1M_MAIN__) && defined(__PMU_PRESENT) \
+  && (__PMU_PRESENT == 1)
+          ARM_PMU_Set_EVTYPER (0, ARM_PMU_L1D_CACHE_MISS_RD);
+          ARM_PMU_CNTR_Enable (PMU_CNTENSET_CNT0_ENABLE_Msk);
+          ARM_PMU_Enable ();
+          events_available = true;
+#endif
+#endif /* defined(OS_RTOS_STATISTICS_DWT_EVENTS) */
+
+          read_counts (last_counts);
+        }
+
+        /**
+         * @details
+         * Add the events counted since the previous sample to the
+         * running thread. Instead of saving and restoring the
+         * hardware counters, the differences are accumulated,
+         * so the counters are only read.
+         *
+         * Called on each context switch, before the running thread
+         * is switched out, and from the system tick.
+         */
+        void
+        OS_RTOS_HOT
+        internal_sample_events_ (void)
+        {
+          if (!events_available || !scheduler::started ())
+            {
+              return;
+            }
+
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          thread* th = internal_current_thread_ ();
+
+          uint32_t counts[event_types];
+          read_counts (counts);
+
+          for (std::size_t i = 0; i < event_types; ++i)
+            {
+              th->statistics ().events_[i] += ((counts[i] - last_counts[i])
+                  & event_masks[i]);
+              last_counts[i] = counts[i];
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+
+        /**
+         * @endcond
+         */
+
+      } /* namespace statistics */
+    } /* namespace scheduler */
+
+    // ========================================================================
+
+    /**
+     * @details
+     * The DWT counters have only 8 bits and are sampled on each
+     * context switch and on each system tick; if more than 255
+     * events occur between samples, the extra events are lost,
+     * so the values are lower bounds, mostly useful to compare
+     * the threads.
+     *
+     * The events of the running thread since the last sample
+     * are not included.
+     *
+     * @note This function is available only when
+     * @ref OS_INCLUDE_RTOS_STATISTICS_THREAD_EVENTS
+     * is defined.
+     */
+    void
+    thread::statistics::snapshot (event_counters& out)
+    {
+      // ----- Enter critical section -----------------------------------------
+      interrupts::critical_section ics;
+
+      out.cpi = events_[0];
+      out.exception = events_[1];
+      out.sleep = events_[2];
+      out.lsu = events_[3];
+      out.fold = events_[4];
+      out.cache_misses = events_[5];
+      // ----- Exit critical section ------------------------------------------
+    }
+
+  // --------------------------------------------------------------------------
+
+  } /* namespace rtos */
+} /* namespace os */
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_EVENTS) */
+
+// ----------------------------------------------------------------------------
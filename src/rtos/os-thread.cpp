@@ -30,6 +30,10 @@
 #include <memory>
 #include <stdexcept>
 
+#if defined(OS_INCLUDE_RTOS_THREAD_NEWLIB_REENT)
+#include <reent.h>
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_NEWLIB_REENT) */
+
 // ----------------------------------------------------------------------------
 
 namespace os
@@ -55,6 +59,28 @@ namespace os
     using mutexes_list = utils::intrusive_list<
     mutex, utils::double_list_links, &mutex::owner_links_>;
 
+#if defined(OS_INCLUDE_RTOS_THREAD_NEWLIB_REENT)
+
+    namespace
+    {
+      // Constant initialised, usable before the static constructors.
+      memory_pool_inclusive<struct _reent,
+          OS_INTEGER_RTOS_THREAD_NEWLIB_REENT_POOL_SIZE> newlib_reent_pool_
+        { constant_init, "newlib-reent" };
+    }
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_NEWLIB_REENT) */
+
+#if defined(OS_INCLUDE_RTOS_THREAD_LOCAL_SLOTS)
+
+    namespace
+    {
+      // One bit for each allocated key.
+      uint32_t local_keys_map_;
+    }
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_LOCAL_SLOTS) */
+
     // ========================================================================
     /**
      * @class thread::attributes
@@ -175,8 +201,36 @@ namespace os
       // Compute the actual size. The -1 is to leave space for the magic.
       size_bytes_ = ((static_cast<std::size_t> (p - bottom_address_) - 1)
           * sizeof(element_t));
+
+#if defined(OS_INCLUDE_RTOS_THREAD_STACK_SCAN)
+      // Nothing used yet.
+      scan_address_ = nullptr;
+      peak_address_ = top ();
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_STACK_SCAN) */
+    }
+
+#if defined(OS_INCLUDE_RTOS_THREAD_STACK_POOL)
+
+    void
+    thread::stack::internal_adopt_ (void)
+    {
+      // The pool blocks are aligned and filled with the magic word.
+      assert(
+          (reinterpret_cast<std::uintptr_t> (bottom_address_)
+              & (sizeof(stack::allocation_element_t) - 1)) == 0);
+
+      // The same size as computed by initialize().
+      size_bytes_ -= sizeof(element_t);
+
+#if defined(OS_INCLUDE_RTOS_THREAD_STACK_SCAN)
+      // Nothing used yet.
+      scan_address_ = nullptr;
+      peak_address_ = top ();
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_STACK_SCAN) */
     }
 
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_STACK_POOL) */
+
     /**
      * @endcond
      */
@@ -200,9 +254,80 @@ namespace os
           ++p;
         }
 
+#if defined(OS_INCLUDE_RTOS_THREAD_STACK_SCAN)
+      if (peak_address_ != nullptr && p < peak_address_)
+        {
+          // Keep the cached value in sync.
+          peak_address_ = p;
+        }
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_STACK_SCAN) */
+
       return count;
     }
 
+#if defined(OS_INCLUDE_RTOS_THREAD_STACK_SCAN)
+
+    /**
+     * @cond ignore
+     */
+
+    /**
+     * @details
+     * Each pass checks the words from the bottom of the stack
+     * up to the lowest word known to be used; since the stack
+     * grows down, the first word found without the magic is the
+     * new peak, and the pass ends there.
+     *
+     * Must be called with the scheduler locked, so that the stack
+     * is not released in the middle of the scan.
+     */
+    bool
+    thread::stack::internal_scan_ (std::size_t words)
+    {
+      if (peak_address_ == nullptr)
+        {
+          // Not initialised by this library, nothing to scan.
+          return true;
+        }
+
+      element_t* p = scan_address_;
+      if (p == nullptr)
+        {
+          p = bottom_address_;
+        }
+
+      element_t* pend = peak_address_;
+      if (static_cast<std::size_t> (pend - p) > words)
+        {
+          pend = p + words;
+        }
+
+      for (; p < pend; ++p)
+        {
+          if (*p != magic)
+            {
+              peak_address_ = p;
+              scan_address_ = nullptr;
+              return true;
+            }
+        }
+
+      if (p >= peak_address_)
+        {
+          scan_address_ = nullptr;
+          return true;
+        }
+
+      scan_address_ = p;
+      return false;
+    }
+
+    /**
+     * @endcond
+     */
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_STACK_SCAN) */
+
     /**
      * @cond ignore
      */
@@ -219,7 +344,8 @@ namespace os
     thread::internal_invoke_with_exit_ (thread* thread)
     {
 #if defined(OS_TRACE_RTOS_THREAD)
-      trace::printf ("%s() @%p %s\n", __func__, thread, thread->name ());
+      OS_TRACE_PRINTF (rtos_thread, "%s() @%p %s\n", __func__, thread,
+                       thread->name ());
 #endif
 
       void* exit_ptr;
@@ -249,7 +375,8 @@ namespace os
     thread::thread ()
     {
 #if defined(OS_TRACE_RTOS_THREAD)
-      trace::printf ("%s() @%p %s\n", __func__, this, this->name ());
+      OS_TRACE_PRINTF (rtos_thread, "%s() @%p %s\n", __func__, this,
+                       this->name ());
 #endif
     }
 
@@ -258,7 +385,8 @@ namespace os
           { name }
     {
 #if defined(OS_TRACE_RTOS_THREAD)
-      trace::printf ("%s() @%p %s\n", __func__, this, this->name ());
+      OS_TRACE_PRINTF (rtos_thread, "%s() @%p %s\n", __func__, this,
+                       this->name ());
 #endif
     }
 
@@ -300,6 +428,10 @@ namespace os
      * the stack is dynamically allocated using the RTOS specific allocator
      * (`rtos::memory::allocator`).
      *
+     * With `OS_INCLUDE_RTOS_THREAD_STACK_POOL`, if the attributes
+     * define a stack pool (via `th_stack_pool`), the stack is
+     * taken from the pool instead.
+     *
      * @par POSIX compatibility
      *  Inspired by [`pthread_create()`](http://pubs.opengroup.org/onlinepubs/9699919799/functions/pthread_create.html)
      *  from [`<pthread.h>`](http://pubs.opengroup.org/onlinepubs/9699919799/basedefs/pthread.h.html)
@@ -349,6 +481,10 @@ namespace os
      * the stack is dynamically allocated using the RTOS specific allocator
      * (`rtos::memory::allocator`).
      *
+     * With `OS_INCLUDE_RTOS_THREAD_STACK_POOL`, if the attributes
+     * define a stack pool (via `th_stack_pool`), the stack is
+     * taken from the pool instead.
+     *
      * @par POSIX compatibility
      *  Inspired by [`pthread_create()`](http://pubs.opengroup.org/onlinepubs/9699919799/functions/pthread_create.html)
      *  from [`<pthread.h>`](http://pubs.opengroup.org/onlinepubs/9699919799/basedefs/pthread.h.html)
@@ -362,7 +498,8 @@ namespace os
           { name }
     {
 #if defined(OS_TRACE_RTOS_THREAD)
-      trace::printf ("%s() @%p %s\n", __func__, this, this->name ());
+      OS_TRACE_PRINTF (rtos_thread, "%s() @%p %s\n", __func__, this,
+                       this->name ());
 #endif
 
       allocator_ = &allocator;
@@ -372,6 +509,12 @@ namespace os
         {
           internal_construct_ (function, args, attr, nullptr, 0);
         }
+#if defined(OS_INCLUDE_RTOS_THREAD_STACK_POOL)
+      else if (attr.th_stack_pool != nullptr)
+        {
+          internal_construct_pooled_ (function, args, attr);
+        }
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_STACK_POOL) */
       else
         {
           using allocator_type2 = memory::allocator<stack::allocation_element_t>;
@@ -425,6 +568,28 @@ namespace os
 
       clock_ = attr.clock != nullptr ? attr.clock : &sysclock;
 
+#if defined(OS_INCLUDE_RTOS_SMP)
+      affinity_ = attr.th_affinity;
+      affinity_t allowed = internal_allowed_cores_ (affinity_);
+      os_assert_throw(allowed != 0, EINVAL);
+
+      if (attr.th_core == current_core)
+        {
+          core_ = static_cast<core_t> (port::core::id ());
+          if ((allowed & (1u << core_)) == 0)
+            {
+              // Start on the first allowed core.
+              core_ = static_cast<core_t> (__builtin_ctz (allowed));
+            }
+        }
+      else
+        {
+          os_assert_throw(attr.th_core < OS_INTEGER_RTOS_SMP_CORES, EINVAL);
+          os_assert_throw((allowed & (1u << attr.th_core)) != 0, EINVAL);
+          core_ = attr.th_core;
+        }
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+
       if (stack_address != nullptr)
         {
           // The attributes should not define any storage in this case.
@@ -444,9 +609,9 @@ namespace os
         }
 
 #if defined(OS_TRACE_RTOS_THREAD)
-      trace::printf ("%s() @%p %s p%u stack{%p,%u}\n", __func__, this, name (),
-                     attr.th_priority, stack ().bottom_address_,
-                     stack ().size_bytes_);
+      OS_TRACE_PRINTF (rtos_thread, "%s() @%p %s p%u stack{%p,%u}\n", __func__,
+                       this, name (), attr.th_priority,
+                       stack ().bottom_address_, stack ().size_bytes_);
 #endif
 
         {
@@ -457,6 +622,34 @@ namespace os
           // Get attributes from user structure.
           prio_assigned_ = attr.th_priority;
 
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
+          edf_relative_ = attr.th_deadline;
+          if (edf_relative_ != 0)
+            {
+              // All EDF threads share one priority level.
+              prio_assigned_ = OS_INTEGER_RTOS_SCHEDULER_EDF_PRIORITY;
+
+              edf_period_ = attr.th_period;
+              edf_budget_ = attr.th_budget;
+              edf_release_ = clock_->now ();
+              edf_deadline_ = edf_release_ + edf_relative_;
+
+              scheduler::edf::utilization_ += scheduler::edf::density (
+                  edf_budget_, edf_relative_, edf_period_);
+            }
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_EDF) */
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING)
+          quantum_ = attr.th_quantum;
+          slice_left_ = internal_quantum_ ();
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING) */
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_PREEMPTION_THRESHOLD)
+          os_assert_throw(attr.th_preemption_threshold < priority::error,
+                          EINVAL);
+          threshold_ = attr.th_preemption_threshold;
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_PREEMPTION_THRESHOLD) */
+
           func_ = function;
           func_args_ = args;
 
@@ -470,13 +663,31 @@ namespace os
               scheduler::top_threads_list_.link (*this);
             }
 
-          stack ().initialize ();
+#if defined(OS_INCLUDE_RTOS_OBJECT_REGISTRY)
+          registry::internal_insert (this, registry::type::thread);
+#endif /* defined(OS_INCLUDE_RTOS_OBJECT_REGISTRY) */
+
+#if defined(OS_INCLUDE_RTOS_THREAD_STACK_POOL)
+          if (stack_pool_ != nullptr)
+            {
+              // Already filled by the pool.
+              stack ().internal_adopt_ ();
+            }
+          else
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_STACK_POOL) */
+            {
+              stack ().initialize ();
+            }
 
 #if defined(OS_USE_RTOS_PORT_SCHEDULER)
 
           port::thread::create (this);
           state_ = state::ready;
 
+#if defined(OS_INCLUDE_RTOS_TRACE_EVENTS)
+          os_rtos_trace_thread_create (this);
+#endif /* defined(OS_INCLUDE_RTOS_TRACE_EVENTS) */
+
 #else
 
           // Create the context.
@@ -486,9 +697,17 @@ namespace os
 
           if (!scheduler::started ())
             {
+#if defined(OS_INCLUDE_RTOS_SMP)
+              scheduler::current_threads_[core_] = this;
+#else
               scheduler::current_thread_ = this;
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
             }
 
+#if defined(OS_INCLUDE_RTOS_TRACE_EVENTS)
+          os_rtos_trace_thread_create (this);
+#endif /* defined(OS_INCLUDE_RTOS_TRACE_EVENTS) */
+
           // Add to ready list, but do not yield yet.
           resume ();
 
@@ -520,7 +739,7 @@ namespace os
     thread::~thread ()
     {
 #if defined(OS_TRACE_RTOS_THREAD)
-      trace::printf ("%s() @%p %s \n", __func__, this, name ());
+      OS_TRACE_PRINTF (rtos_thread, "%s() @%p %s \n", __func__, this, name ());
 #endif
 
       // Prevent the main thread to destroy itself while running
@@ -532,8 +751,9 @@ namespace os
       else
         {
 #if defined(OS_TRACE_RTOS_THREAD)
-          trace::printf ("%s() @%p %s nop, cannot commit suicide\n", __func__,
-                         this, name ());
+          OS_TRACE_PRINTF (rtos_thread,
+                           "%s() @%p %s nop, cannot commit suicide\n", __func__,
+                           this, name ());
 #endif
         }
     }
@@ -548,11 +768,12 @@ namespace os
      * @note Can be invoked from Interrupt Service Routines.
      */
     void
+    OS_RTOS_HOT
     thread::resume (void)
     {
 #if defined(OS_TRACE_RTOS_THREAD_CONTEXT)
-      trace::printf ("%s() @%p %s %u\n", __func__, this, name (),
-                     prio_assigned_);
+      OS_TRACE_PRINTF (rtos_thread_context, "%s() @%p %s %u\n", __func__, this,
+                       name (), prio_assigned_);
 #endif
 
 #if defined(OS_USE_RTOS_PORT_SCHEDULER)
@@ -578,13 +799,41 @@ namespace os
           // If the thread is not already in the ready list, enqueue it.
           if (ready_node_.next () == nullptr)
             {
-              scheduler::ready_threads_list_.link (ready_node_);
+              internal_ready_list_ ().link (ready_node_);
               // state::ready set in above link().
+
+#if defined(OS_INCLUDE_RTOS_TRACE_EVENTS)
+              os_rtos_trace_thread_ready (this);
+#endif /* defined(OS_INCLUDE_RTOS_TRACE_EVENTS) */
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_PROFILE)
+              statistics_.internal_ready_ (hrclock.now ());
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_PROFILE) */
             }
           // ----- Exit critical section --------------------------------------
         }
 
+#if defined(OS_INCLUDE_RTOS_SMP)
+      if (core_ != port::core::id ())
+        {
+          // The other core picks the thread from its ready list at
+          // the next switch; interrupt it only if the thread should
+          // preempt the one running there.
+          thread* crt = scheduler::current_threads_[core_];
+          if (scheduler::started ()
+              && (crt == nullptr || priority () > crt->priority ()))
+            {
+              port::core::reschedule (core_);
+            }
+          return;
+        }
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+
+#if defined(OS_INCLUDE_RTOS_ISR_RESCHEDULE_COALESCING)
+      interrupts::internal_request_reschedule_ ();
+#else
       port::scheduler::reschedule ();
+#endif /* defined(OS_INCLUDE_RTOS_ISR_RESCHEDULE_COALESCING) */
 
 #endif
 
@@ -658,7 +907,8 @@ namespace os
     thread::priority (priority_t prio)
     {
 #if defined(OS_TRACE_RTOS_THREAD)
-      trace::printf ("%s(%u) @%p %s\n", __func__, prio, this, name ());
+      OS_TRACE_PRINTF (rtos_thread, "%s(%u) @%p %s\n", __func__, prio, this,
+                       name ());
 #endif
 
       // Don't call this from interrupt handlers.
@@ -673,8 +923,15 @@ namespace os
           return result::ok;
         }
 
+      priority_t old_prio = priority ();
       prio_assigned_ = prio;
 
+      if (priority () == old_prio)
+        {
+          // Optimise, the inherited priority prevails.
+          return result::ok;
+        }
+
       result_t res = result::ok;
 
 #if defined(OS_USE_RTOS_PORT_SCHEDULER)
@@ -684,21 +941,7 @@ namespace os
 
 #else
 
-      if (state_ == state::ready)
-        {
-          // ----- Enter critical section -------------------------------------
-          interrupts::critical_section ics;
-
-          // Remove from initial location and reinsert according
-          // to new priority.
-          ready_node_.unlink ();
-          scheduler::ready_threads_list_.link (ready_node_);
-          // ----- Exit critical section --------------------------------------
-        }
-
-      // Mandatory, the priority might have been raised, the
-      // task must be scheduled to run.
-      this_thread::yield ();
+      internal_priority_changed_ (old_prio);
 
 #endif
 
@@ -726,7 +969,8 @@ namespace os
     thread::priority_inherited (priority_t prio)
     {
 #if defined(OS_TRACE_RTOS_THREAD)
-      trace::printf ("%s(%u) @%p %s\n", __func__, prio, this, name ());
+      OS_TRACE_PRINTF (rtos_thread, "%s(%u) @%p %s\n", __func__, prio, this,
+                       name ());
 #endif
 
       // Don't call this from interrupt handlers.
@@ -744,11 +988,12 @@ namespace os
           return result::ok;
         }
 
+      priority_t old_prio = priority ();
       prio_inherited_ = prio;
 
-      if (prio_inherited_ < prio_assigned_)
+      if (priority () == old_prio)
         {
-          // Optimise, no need to reschedule.
+          // Optimise, the assigned priority prevails.
           return result::ok;
         }
 
@@ -761,26 +1006,77 @@ namespace os
 
 #else
 
-      if (state_ == state::ready)
+      internal_priority_changed_ (old_prio);
+
+#endif
+
+      return res;
+    }
+
+#if !defined(OS_USE_RTOS_PORT_SCHEDULER)
+
+    /**
+     * @cond ignore
+     */
+
+    /**
+     * @details
+     * A ready thread is moved in the ready list, in constant time
+     * when it remains in order, and the scheduler is invoked only
+     * if the change may allow another thread to run: the running
+     * thread was lowered, or a ready thread was raised above the
+     * running one.
+     */
+    void
+    thread::internal_priority_changed_ (priority_t old_prio)
+    {
+      bool must_reschedule = false;
         {
           // ----- Enter critical section -------------------------------------
           interrupts::critical_section ics;
 
-          // Remove from initial location and reinsert according
-          // to new priority.
-          ready_node_.unlink ();
-          scheduler::ready_threads_list_.link (ready_node_);
+          if (state_ == state::ready)
+            {
+              internal_ready_list_ ().relink (ready_node_);
+
+#if defined(OS_INCLUDE_RTOS_SMP)
+              if (core_ != port::core::id ())
+                {
+                  // The thread may now preempt the one running on its core.
+                  port::core::reschedule (core_);
+                  return;
+                }
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+
+              must_reschedule = (priority ()
+                  > this_thread::thread ().priority ());
+            }
+          else if (state_ == state::running && priority () < old_prio)
+            {
+#if defined(OS_INCLUDE_RTOS_SMP)
+              if (core_ != port::core::id ())
+                {
+                  port::core::reschedule (core_);
+                  return;
+                }
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+
+              must_reschedule = true;
+            }
           // ----- Exit critical section --------------------------------------
         }
 
-      // Mandatory, the priority might have been raised, the
-      // task must be scheduled to run.
-      this_thread::yield ();
+      if (must_reschedule)
+        {
+          this_thread::yield ();
+        }
+    }
 
-#endif
+    /**
+     * @endcond
+     */
 
-      return res;
-    }
+#endif /* !defined(OS_USE_RTOS_PORT_SCHEDULER) */
 
     /**
      * @details
@@ -804,7 +1100,7 @@ namespace os
     thread::detach (void)
     {
 #if defined(OS_TRACE_RTOS_THREAD)
-      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+      OS_TRACE_PRINTF (rtos_thread, "%s() @%p %s\n", __func__, this, name ());
 #endif
 
       // Don't call this from interrupt handlers.
@@ -859,7 +1155,7 @@ namespace os
     thread::join (void** exit_ptr)
     {
 #if defined(OS_TRACE_RTOS_THREAD)
-      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+      OS_TRACE_PRINTF (rtos_thread, "%s() @%p %s\n", __func__, this, name ());
 #endif
 
       // Don't call this from interrupt handlers.
@@ -877,7 +1173,8 @@ namespace os
         }
 
 #if defined(OS_TRACE_RTOS_THREAD)
-      trace::printf ("%s() @%p %s joined\n", __func__, this, name ());
+      OS_TRACE_PRINTF (rtos_thread, "%s() @%p %s joined\n", __func__, this,
+                       name ());
 #endif
 
       if (exit_ptr != nullptr)
@@ -911,7 +1208,7 @@ namespace os
     thread::cancel (void)
     {
 #if defined(OS_TRACE_RTOS_THREAD)
-      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+      OS_TRACE_PRINTF (rtos_thread, "%s() @%p %s\n", __func__, this, name ());
 #endif
 
       // Don't call this from interrupt handlers.
@@ -921,109 +1218,594 @@ namespace os
       return result::ok;
     }
 
+#if defined(OS_INCLUDE_RTOS_SMP)
+
     /**
      * @details
-     * If the interrupt flag is true, threads waiting for
-     * an event are notified immediately (actually as
-     * soon as the thread priority allows it to run).
-     *
-     * After the thread detects the interrupted condition, it
-     * must clear the interrupted flag.
+     * If the thread runs on a core not allowed by the new mask,
+     * it is moved to the first allowed core; if it is the
+     * running thread, it continues there after the next
+     * context switch.
      *
      * @warning Cannot be invoked from Interrupt Service Routines.
      */
-    bool
-    thread::interrupt (bool interrupt)
+    result_t
+    thread::affinity (affinity_t mask)
     {
 #if defined(OS_TRACE_RTOS_THREAD)
-      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+      OS_TRACE_PRINTF (rtos_thread, "%s(0x%X) @%p %s\n", __func__,
+                       static_cast<unsigned int> (mask), this, name ());
 #endif
 
-      bool tmp = interrupted_;
-      interrupted_ = interrupt;
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
 
-      resume ();
-      return tmp;
+      affinity_t allowed = internal_allowed_cores_ (mask);
+      os_assert_err(allowed != 0, EINVAL);
+
+      affinity_ = mask;
+      if ((allowed & (1u << core_)) == 0)
+        {
+          internal_migrate_ (static_cast<core_t> (__builtin_ctz (allowed)));
+        }
+
+      return result::ok;
     }
 
-    /**
-     * @cond ignore
-     */
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
 
     /**
      * @details
+     * Start a new job now, with the given relative deadline;
+     * for aperiodic EDF threads this is the way to tell the
+     * scheduler the urgency of the next piece of work.
      *
-     * @par POSIX compatibility
-     *  Extension to standard, no POSIX similar functionality identified.
+     * If the thread is ready, it is moved to its new place
+     * in the ready list.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
      */
-    void
-    thread::internal_suspend_ (void)
+    result_t
+    thread::deadline (clock::duration_t relative)
     {
 #if defined(OS_TRACE_RTOS_THREAD)
-      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+      OS_TRACE_PRINTF (rtos_thread, "%s(%u) @%p %s\n", __func__,
+                       static_cast<unsigned int> (relative), this, name ());
 #endif
 
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      os_assert_err(edf_relative_ != 0, EINVAL);
+      os_assert_err(relative != 0, EINVAL);
+
         {
           // ----- Enter critical section -------------------------------------
           interrupts::critical_section ics;
 
-          // Remove this thread from the ready list, if there.
-          port::this_thread::prepare_suspend ();
+          edf_release_ = clock_->now ();
+          edf_deadline_ = edf_release_ + relative;
 
-          state_ = state::suspended;
+          if (state_ == state::ready)
+            {
+              internal_ready_list_ ().unlink (ready_node_);
+              internal_ready_list_ ().link (ready_node_);
+            }
           // ----- Exit critical section --------------------------------------
         }
 
-      port::scheduler::reschedule ();
+      // The thread might now precede the running one.
+      this_thread::yield ();
+
+      return result::ok;
     }
 
-    void
-    thread::internal_exit_ (void* exit_ptr)
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_EDF) */
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING)
+
+    /**
+     * @details
+     * The current slice is not changed, the new quantum is used
+     * when the slice expires.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    thread::quantum (clock::duration_t ticks)
     {
 #if defined(OS_TRACE_RTOS_THREAD)
-      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+      OS_TRACE_PRINTF (rtos_thread, "%s(%u) @%p %s\n", __func__,
+                       static_cast<unsigned int> (ticks), this, name ());
 #endif
 
       // Don't call this from interrupt handlers.
-      assert(!interrupts::in_handler_mode ());
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+
+      quantum_ = ticks;
+
+      return result::ok;
+    }
+
+    /**
+     * @cond ignore
+     */
 
+    clock::duration_t
+    thread::internal_quantum_ (void)
+    {
+      if (quantum_ != 0)
         {
-          // ----- Enter critical section -------------------------------------
-          scheduler::critical_section scs;
+          return quantum_;
+        }
+      return scheduler::quantum (prio_assigned_);
+    }
 
-            {
-              // ----- Enter critical section ---------------------------------
-              interrupts::critical_section ics;
+    /**
+     * @endcond
+     */
 
-              ready_node_.unlink ();
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING) */
 
-              child_links_.unlink ();
-              // ----- Exit critical section ----------------------------------
-            }
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_PREEMPTION_THRESHOLD)
 
-          // There must be no children threads still alive.
-          assert(children_.empty ());
-          parent_ = nullptr;
+    /**
+     * @details
+     * While the thread runs, the ready threads with priorities
+     * up to the threshold wait until it blocks, yields or lowers
+     * the threshold; threads with priorities above the threshold
+     * preempt it as usual. Once preempted, the thread competes
+     * again with its own priority.
+     *
+     * Threads that share a threshold do not preempt each other,
+     * so they can share data without mutexes, and at most one of
+     * them is in the middle of its work at any time.
+     *
+     * Lowering the threshold of the running thread lets the
+     * waiting threads run immediately.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    thread::preemption_threshold (priority_t prio)
+    {
+#if defined(OS_TRACE_RTOS_THREAD)
+      OS_TRACE_PRINTF (rtos_thread, "%s(%u) @%p %s\n", __func__, prio, this,
+                       name ());
+#endif
 
-          // There must be no more mutexes locked by this thread.
-          assert(mutexes_.empty ());
-          assert(acquired_mutexes_ == 0);
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      // Check the priority, it is not in the allowed range.
+      os_assert_err(prio < priority::error, EINVAL);
 
-          func_result_ = exit_ptr;
-          // ----- Exit critical section --------------------------------------
-        }
+      threshold_ = prio;
 
+      if (state_ == state::running)
         {
-          // ----- Enter critical section -------------------------------------
-          interrupts::critical_section ics;
-
-          // Add to a list of threads to be destroyed by the idle thread.
-          // Also set state::terminated.
-          scheduler::terminated_threads_list_.link (ready_node_);
-          // ----- Exit critical section --------------------------------------
+          port::scheduler::reschedule ();
         }
 
-#if defined(OS_USE_RTOS_PORT_SCHEDULER)
+      return result::ok;
+    }
+
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_PREEMPTION_THRESHOLD) */
+
+#if defined(OS_INCLUDE_RTOS_TIMER_SLACK)
+
+    /**
+     * @details
+     * The slack applies to all further `sleep_for()`, `sleep_until()`
+     * and `timed_*()` calls of the thread: each timeout may expire
+     * up to `slack` units of the clock it waits on later than
+     * requested, so that it shares the wakeup with timeouts already
+     * scheduled in that window, or lands on a round time stamp
+     * where other slack timeouts gather.
+     *
+     * A zero slack, the default, keeps the exact timeouts.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    thread::timer_slack (clock::duration_t slack)
+    {
+#if defined(OS_TRACE_RTOS_THREAD)
+      OS_TRACE_PRINTF (rtos_thread, "%s(%u) @%p %s\n", __func__,
+                       static_cast<unsigned int> (slack), this, name ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+
+      timer_slack_ = slack;
+
+      return result::ok;
+    }
+
+#endif /* defined(OS_INCLUDE_RTOS_TIMER_SLACK) */
+
+#if defined(OS_INCLUDE_RTOS_THREAD_BUDGET)
+
+    /**
+     * @details
+     * Each activation of the thread is expected to use at most
+     * `cycles` CPU cycles. When it uses more, the overruns counter
+     * is incremented and, if not `nullptr`, `func` is called with
+     * the thread and `args`, once for each activation.
+     *
+     * The handler is called from the clock interrupt or from the
+     * context switch, so it must be short and may only use the
+     * functions allowed in Interrupt Service Routines, like
+     * `event_flags::raise()` or `semaphore::post()`.
+     *
+     * A new activation starts now.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    thread::budget (rtos::statistics::duration_t cycles, budget_func_t func,
+                    void* args)
+    {
+#if defined(OS_TRACE_RTOS_THREAD)
+      OS_TRACE_PRINTF (rtos_thread, "%s(%u) @%p %s\n", __func__,
+                       static_cast<unsigned int> (cycles), this, name ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          budget_cycles_ = cycles;
+          budget_func_ = func;
+          budget_args_ = args;
+          // ----- Exit critical section --------------------------------------
+        }
+
+      budget_restart ();
+
+      return result::ok;
+    }
+
+    /**
+     * @details
+     * Called at the beginning of each activation, for example after
+     * waiting for the next event; the periodic waits call it
+     * automatically.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    void
+    thread::budget_restart (void)
+    {
+      // ----- Enter critical section -----------------------------------------
+      interrupts::critical_section ics;
+
+      budget_base_ = statistics_.cpu_cycles ();
+      if (this == scheduler::internal_current_thread_ ())
+        {
+          // The cycles used since the last context switch are
+          // not accounted yet, they belong to the old activation.
+          budget_base_ += static_cast<rtos::statistics::duration_t> (
+              hrclock.internal_now_unlocked ()
+                  - scheduler::statistics::switch_timestamp_);
+        }
+      budget_fired_ = false;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    /**
+     * @details
+     * For the running thread, the cycles used since the last
+     * context switch are included.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    rtos::statistics::duration_t
+    thread::budget_used (void)
+    {
+      // ----- Enter critical section -----------------------------------------
+      interrupts::critical_section ics;
+
+      rtos::statistics::duration_t used = statistics_.cpu_cycles ()
+          - budget_base_;
+      if (this == scheduler::internal_current_thread_ ())
+        {
+          used += static_cast<rtos::statistics::duration_t> (
+              hrclock.internal_now_unlocked ()
+                  - scheduler::statistics::switch_timestamp_);
+        }
+      return used;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    /**
+     * @cond ignore
+     */
+
+    // Called from a critical section, or from the context switch.
+    void
+    thread::internal_check_budget_ (rtos::statistics::duration_t running)
+    {
+      if (budget_cycles_ == 0 || budget_fired_)
+        {
+          return;
+        }
+
+      if (statistics_.cpu_cycles () + running - budget_base_ <= budget_cycles_)
+        {
+          return;
+        }
+
+      budget_fired_ = true;
+      ++budget_overruns_;
+
+#if defined(OS_TRACE_RTOS_THREAD)
+      OS_TRACE_PRINTF (rtos_thread, "%s() @%p %s overrun\n", __func__, this,
+                       name ());
+#endif
+
+      if (budget_func_ != nullptr)
+        {
+          budget_func_ (this, budget_args_);
+        }
+    }
+
+    /**
+     * @endcond
+     */
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_BUDGET) */
+
+#if defined(OS_INCLUDE_RTOS_SMP)
+
+    /**
+     * @cond ignore
+     */
+
+    /**
+     * @details
+     * A ready thread is moved to the ready list of the new core.
+     * A running thread keeps running until its core switches
+     * contexts, then it is re-linked to the new core; so the old
+     * core is asked to reschedule. A suspended thread is simply
+     * resumed on the new core.
+     */
+    void
+    thread::internal_migrate_ (core_t core)
+    {
+      core_t old_core;
+      bool ready_moved = false;
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          old_core = core_;
+          if (old_core == core)
+            {
+              return;
+            }
+
+          if (state_ == state::ready && ready_node_.next () != nullptr)
+            {
+              internal_ready_list_ ().unlink (ready_node_);
+              core_ = core;
+              internal_ready_list_ ().link (ready_node_);
+              ready_moved = true;
+            }
+          else
+            {
+              core_ = core;
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+
+      if (!scheduler::started ())
+        {
+          return;
+        }
+
+      if (ready_moved)
+        {
+          // Let the new core decide if the thread preempts its current one.
+          scheduler::internal_reschedule_core_ (core);
+        }
+      else if (state_ == state::running)
+        {
+          scheduler::internal_reschedule_core_ (old_core);
+        }
+    }
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES)
+
+    /**
+     * @details
+     * Must be called with interrupts disabled.
+     */
+    void
+    thread::internal_balance_measure_ (thread* parent,
+                                       rtos::statistics::duration_t* loads)
+    {
+      for (auto&& th : scheduler::children_threads (parent))
+        {
+          rtos::statistics::duration_t cycles = th.statistics_.cpu_cycles ();
+          th.balance_load_ = cycles - th.balance_cycles_;
+          th.balance_cycles_ = cycles;
+
+          // The idle threads do not count as load.
+          if (th.priority () > priority::idle)
+            {
+              loads[th.core_] += th.balance_load_;
+            }
+
+          internal_balance_measure_ (&th, loads);
+        }
+    }
+
+    /**
+     * @details
+     * Must be called with interrupts disabled.
+     */
+    thread*
+    thread::internal_balance_pick_ (thread* parent, core_t from, core_t to,
+                                    rtos::statistics::duration_t limit,
+                                    thread* best)
+    {
+      for (auto&& th : scheduler::children_threads (parent))
+        {
+          if (th.core_ == from && th.priority () > priority::idle
+              && (th.state_ == state::ready || th.state_ == state::running
+                  || th.state_ == state::suspended)
+              && th.balance_load_ != 0 && th.balance_load_ < limit
+              && (internal_allowed_cores_ (th.affinity_) & (1u << to)) != 0
+              && (best == nullptr || th.balance_load_ > best->balance_load_))
+            {
+              best = &th;
+            }
+
+          best = internal_balance_pick_ (&th, from, to, limit, best);
+        }
+      return best;
+    }
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES) */
+
+    /**
+     * @endcond
+     */
+
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+
+    /**
+     * @details
+     * If the interrupt flag is true, threads waiting for
+     * an event are notified immediately (actually as
+     * soon as the thread priority allows it to run).
+     *
+     * After the thread detects the interrupted condition, it
+     * must clear the interrupted flag.
+     *
+     * With `OS_EXCLUDE_RTOS_THREAD_CANCELLATION` the waits cannot
+     * be interrupted, and the function does nothing.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    bool
+    thread::interrupt (bool interrupt __attribute__((unused)))
+    {
+#if defined(OS_TRACE_RTOS_THREAD)
+      OS_TRACE_PRINTF (rtos_thread, "%s() @%p %s\n", __func__, this, name ());
+#endif
+
+#if !defined(OS_EXCLUDE_RTOS_THREAD_CANCELLATION)
+      bool tmp = interrupted_;
+      interrupted_ = interrupt;
+
+      resume ();
+      return tmp;
+#else
+      return false;
+#endif /* !defined(OS_EXCLUDE_RTOS_THREAD_CANCELLATION) */
+    }
+
+    /**
+     * @cond ignore
+     */
+
+    /**
+     * @details
+     *
+     * @par POSIX compatibility
+     *  Extension to standard, no POSIX similar functionality identified.
+     */
+    void
+    thread::internal_suspend_ (void)
+    {
+#if defined(OS_TRACE_RTOS_THREAD)
+      OS_TRACE_PRINTF (rtos_thread, "%s() @%p %s\n", __func__, this, name ());
+#endif
+
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          // Remove this thread from the ready list, if there.
+          port::this_thread::prepare_suspend ();
+
+          state_ = state::suspended;
+
+#if defined(OS_INCLUDE_RTOS_TRACE_EVENTS)
+          os_rtos_trace_thread_suspend (this);
+#endif /* defined(OS_INCLUDE_RTOS_TRACE_EVENTS) */
+          // ----- Exit critical section --------------------------------------
+        }
+
+      port::scheduler::reschedule ();
+    }
+
+    void
+    thread::internal_exit_ (void* exit_ptr)
+    {
+#if defined(OS_TRACE_RTOS_THREAD)
+      OS_TRACE_PRINTF (rtos_thread, "%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      assert(!interrupts::in_handler_mode ());
+
+        {
+          // ----- Enter critical section -------------------------------------
+          scheduler::critical_section scs;
+
+            {
+              // ----- Enter critical section ---------------------------------
+              interrupts::critical_section ics;
+
+#if !defined(OS_USE_RTOS_PORT_SCHEDULER)
+              internal_ready_list_ ().unlink (ready_node_);
+#else
+              ready_node_.unlink ();
+#endif
+
+              child_links_.unlink ();
+              // ----- Exit critical section ----------------------------------
+            }
+
+          // There must be no children threads still alive.
+          assert(children_.empty ());
+          parent_ = nullptr;
+
+          // There must be no more mutexes locked by this thread.
+          assert(mutexes_.empty ());
+          assert(acquired_mutexes_ == 0);
+
+          func_result_ = exit_ptr;
+          // ----- Exit critical section --------------------------------------
+        }
+
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          // Add to a list of threads to be destroyed by the idle thread.
+          // Also set state::terminated.
+          scheduler::terminated_threads_list_.link (ready_node_);
+
+#if defined(OS_INCLUDE_RTOS_TRACE_EVENTS)
+          os_rtos_trace_thread_terminate (this);
+#endif /* defined(OS_INCLUDE_RTOS_TRACE_EVENTS) */
+          // ----- Exit critical section --------------------------------------
+        }
+
+#if defined(OS_INCLUDE_RTOS_THREAD_REAPER)
+      // The thread is destroyed after it is switched out.
+      scheduler::internal_wake_reaper_ ();
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_REAPER) */
+
+#if defined(OS_USE_RTOS_PORT_SCHEDULER)
 
       port::thread::destroy_this (this);
       // Does not return if the current thread.
@@ -1052,27 +1834,89 @@ namespace os
           assert(stack ().check_top_magic ());
 
 #if defined(OS_TRACE_RTOS_THREAD)
-          trace::printf ("%s() @%p %s stack: %u/%u bytes used\n", __func__,
-                         this, name (),
-                         stack ().size () - stack ().available (),
-                         stack ().size ());
+          OS_TRACE_PRINTF (rtos_thread, "%s() @%p %s stack: %u/%u bytes used\n",
+                           __func__, this, name (),
+                           stack ().size () - stack ().available (),
+                           stack ().size ());
 #endif
 
-          // Clear stack to avoid further checks
-          stack ().clear ();
+          // Clear stack to avoid further checks
+          stack ().clear ();
+        }
+    }
+
+#if defined(OS_INCLUDE_RTOS_THREAD_STACK_POOL)
+
+    /*
+     * Instead of failing when all stacks are in use, first destroy
+     * the terminated threads not yet processed by the idle thread,
+     * which may hold stacks from the same pool.
+     */
+    void
+    thread::internal_construct_pooled_ (func_t function, func_args_t args,
+                                        const attributes& attr)
+    {
+      // Don't call this from interrupt handlers.
+      os_assert_throw(!interrupts::in_handler_mode (), EPERM);
+
+      stack_pool& pool = *attr.th_stack_pool;
+
+      void* pooled_stack = pool.try_acquire ();
+      if (pooled_stack == nullptr && scheduler::internal_reap_terminated_ () > 0)
+        {
+          pooled_stack = pool.try_acquire ();
         }
+
+      // All stacks in the pool are in use.
+      os_assert_throw(pooled_stack != nullptr, ENOMEM);
+
+      stack_pool_ = &pool;
+      internal_construct_ (function, args, attr, pooled_stack,
+                           pool.stack_size ());
     }
 
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_STACK_POOL) */
+
     // Called from kill() and from idle thread.
     void
     thread::internal_destroy_ (void)
     {
 #if defined(OS_TRACE_RTOS_THREAD)
-      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+      OS_TRACE_PRINTF (rtos_thread, "%s() @%p %s\n", __func__, this, name ());
 #endif
 
+#if defined(OS_INCLUDE_RTOS_THREAD_STACK_POOL)
+      // Remember the stack, it is cleared by the check.
+      void* pooled_stack = nullptr;
+      if (stack_pool_ != nullptr)
+        {
+          pooled_stack = stack ().bottom ();
+        }
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_STACK_POOL) */
+
+#if defined(OS_INCLUDE_RTOS_STATISTICS_STACK_SITES)
+      if (stack ().size () > 0)
+        {
+          // Complete the scan pass, to also account the latest usage.
+          stack ().internal_scan_ (
+              stack ().size () / sizeof(stack::element_t));
+          scheduler::statistics::internal_record_stack_ (
+              reinterpret_cast<const void*> (func_), name (), stack ().size (),
+              stack ().high_water_mark ());
+        }
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_STACK_SITES) */
+
       internal_check_stack_ ();
 
+#if defined(OS_INCLUDE_RTOS_THREAD_STACK_POOL)
+      if (pooled_stack != nullptr)
+        {
+          // Back to the pool at once, not to the memory resource.
+          stack_pool_->release (pooled_stack);
+          stack_pool_ = nullptr;
+        }
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_STACK_POOL) */
+
       if (allocated_stack_address_ != nullptr)
         {
           typedef typename std::allocator_traits<allocator_type>::pointer pointer;
@@ -1084,6 +1928,34 @@ namespace os
           allocated_stack_address_ = nullptr;
         }
 
+#if defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE)
+      // Return the cached blocks to the memory resource.
+      allocation_cache_.flush ();
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_ALLOCATION_CACHE) */
+
+#if defined(OS_INCLUDE_RTOS_THREAD_NEWLIB_REENT)
+      struct _reent* reent = newlib_reent_;
+      if (reent != nullptr)
+        {
+            {
+              // ----- Enter critical section ---------------------------------
+              interrupts::critical_section ics;
+
+              newlib_reent_ = nullptr;
+              // Possible only when the thread kills itself.
+              if (_impure_ptr == reent)
+                {
+                  _impure_ptr = _GLOBAL_REENT;
+                }
+              // ----- Exit critical section ----------------------------------
+            }
+
+          // Free the stdio buffers and the other allocated members.
+          _reclaim_reent (reent);
+          newlib_reent_pool_.free (reent);
+        }
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_NEWLIB_REENT) */
+
         {
           // ----- Enter critical section -------------------------------------
           scheduler::critical_section scs;
@@ -1098,6 +1970,15 @@ namespace os
               // Unlock the mutex as owned by the thread itself.
               mx->internal_unlock_ (this);
             }
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
+          if (edf_relative_ != 0)
+            {
+              scheduler::edf::utilization_ -= scheduler::edf::density (
+                  edf_budget_, edf_relative_, edf_period_);
+              edf_relative_ = 0;
+            }
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_EDF) */
           // ----- Exit critical section --------------------------------------
         }
 
@@ -1127,7 +2008,7 @@ namespace os
     thread::kill (void)
     {
 #if defined(OS_TRACE_RTOS_THREAD)
-      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+      OS_TRACE_PRINTF (rtos_thread, "%s() @%p %s\n", __func__, this, name ());
 #endif
 
       // Don't call this from interrupt handlers.
@@ -1140,8 +2021,8 @@ namespace os
           if (state_ == state::destroyed)
             {
 #if defined(OS_TRACE_RTOS_THREAD)
-              trace::printf ("%s() @%p %s already gone\n", __func__, this,
-                             name ());
+              OS_TRACE_PRINTF (rtos_thread, "%s() @%p %s already gone\n",
+                               __func__, this, name ());
 #endif
               return result::ok; // Already exited itself
             }
@@ -1150,8 +2031,13 @@ namespace os
               // ----- Enter critical section ---------------------------------
               interrupts::critical_section ics;
 
-              // Remove thread from the funeral list and kill it here.
+              // Remove thread from the ready or the funeral list
+              // and kill it here.
+#if !defined(OS_USE_RTOS_PORT_SCHEDULER)
+              internal_ready_list_ ().unlink (ready_node_);
+#else
               ready_node_.unlink ();
+#endif
 
               // If the thread is waiting on an event, remove it from the list.
               if (waiting_node_ != nullptr)
@@ -1173,6 +2059,10 @@ namespace os
           assert(children_.empty ());
           parent_ = nullptr;
 
+#if defined(OS_INCLUDE_RTOS_OBJECT_REGISTRY)
+          registry::internal_erase (this, registry::type::thread);
+#endif /* defined(OS_INCLUDE_RTOS_OBJECT_REGISTRY) */
+
 #if defined(OS_USE_RTOS_PORT_SCHEDULER)
 
           port::thread::destroy_other (this);
@@ -1206,8 +2096,8 @@ namespace os
     thread::flags_raise (flags::mask_t mask, flags::mask_t* oflags)
     {
 #if defined(OS_TRACE_RTOS_THREAD_FLAGS)
-      trace::printf ("%s(0x%X) @%p %s <0x%X\n", __func__, mask, this, name (),
-                     event_flags_.mask ());
+      OS_TRACE_PRINTF (rtos_thread_flags, "%s(0x%X) @%p %s <0x%X\n", __func__,
+                       mask, this, name (), event_flags_.mask ());
 #endif
 
       result_t res = event_flags_.raise (mask, oflags);
@@ -1215,8 +2105,8 @@ namespace os
       this->resume ();
 
 #if defined(OS_TRACE_RTOS_THREAD_FLAGS)
-      trace::printf ("%s(0x%X) @%p %s >0x%X\n", __func__, mask, this, name (),
-                     event_flags_.mask ());
+      OS_TRACE_PRINTF (rtos_thread_flags, "%s(0x%X) @%p %s >0x%X\n", __func__,
+                       mask, this, name (), event_flags_.mask ());
 #endif
 
       return res;
@@ -1231,8 +2121,9 @@ namespace os
                                   flags::mode_t mode)
     {
 #if defined(OS_TRACE_RTOS_THREAD_FLAGS)
-      trace::printf ("%s(0x%X,%u) @%p %s <0x%X\n", __func__, mask, mode, this,
-                     name (), event_flags_.mask ());
+      OS_TRACE_PRINTF (rtos_thread_flags, "%s(0x%X,%u) @%p %s <0x%X\n",
+                       __func__, mask, mode, this, name (),
+                       event_flags_.mask ());
 #endif
 
       // Don't call this from interrupt handlers.
@@ -1247,8 +2138,9 @@ namespace os
           if (event_flags_.check_raised (mask, oflags, mode))
             {
 #if defined(OS_TRACE_RTOS_THREAD_FLAGS)
-              trace::printf ("%s(0x%X,%u) @%p %s >0x%X\n", __func__, mask, mode,
-                             this, name (), event_flags_.mask ());
+              OS_TRACE_PRINTF (rtos_thread_flags, "%s(0x%X,%u) @%p %s >0x%X\n",
+                               __func__, mask, mode, this, name (),
+                               event_flags_.mask ());
 #endif
               return result::ok;
             }
@@ -1270,12 +2162,321 @@ namespace os
                   clock::duration_t slept_ticks =
                       static_cast<clock::duration_t> (clock_->now ()
                           - begin_timestamp);
-                  trace::printf ("%s(0x%X,%u) in %d @%p %s >0x%X\n", __func__,
-                                 mask, mode, slept_ticks, this, name (),
-                                 event_flags_.mask ());
+                  OS_TRACE_PRINTF (rtos_thread_flags,
+                                   "%s(0x%X,%u) in %d @%p %s >0x%X\n", __func__,
+                                   mask, mode, slept_ticks, this, name (),
+                                   event_flags_.mask ());
+#endif
+                  return result::ok;
+                }
+              // ----- Exit critical section ----------------------------------
+            }
+
+          internal_suspend_ ();
+
+          if (interrupted ())
+            {
+#if defined(OS_TRACE_RTOS_THREAD_FLAGS)
+              OS_TRACE_PRINTF (rtos_thread_flags, "%s(0x%X,%u) EINTR @%p %s\n",
+                               __func__, mask, mode, this, name ());
+#endif
+              return EINTR;
+            }
+        }
+
+      /* NOTREACHED */
+      return ENOTRECOVERABLE;
+    }
+
+    result_t
+    thread::internal_flags_try_wait_ (flags::mask_t mask, flags::mask_t* oflags,
+                                      flags::mode_t mode)
+    {
+#if defined(OS_TRACE_RTOS_THREAD_FLAGS)
+      OS_TRACE_PRINTF (rtos_thread_flags, "%s(0x%X,%u) @%p %s <0x%X\n",
+                       __func__, mask, mode, this, name (),
+                       event_flags_.mask ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          if (event_flags_.check_raised (mask, oflags, mode))
+            {
+#if defined(OS_TRACE_RTOS_THREAD_FLAGS)
+              OS_TRACE_PRINTF (rtos_thread_flags, "%s(0x%X,%u) @%p %s >0x%X\n",
+                               __func__, mask, mode, this, name (),
+                               event_flags_.mask ());
+#endif
+              return result::ok;
+            }
+          else
+            {
+#if defined(OS_TRACE_RTOS_THREAD_FLAGS)
+              OS_TRACE_PRINTF (rtos_thread_flags,
+                               "%s(0x%X,%u) EWOULDBLOCK @%p %s \n", __func__,
+                               mask, mode, this, name ());
+#endif
+              return EWOULDBLOCK;
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+    }
+
+    result_t
+    thread::internal_flags_timed_wait_ (flags::mask_t mask,
+                                        clock::duration_t timeout,
+                                        flags::mask_t* oflags,
+                                        flags::mode_t mode)
+    {
+#if defined(OS_TRACE_RTOS_THREAD_FLAGS)
+      OS_TRACE_PRINTF (rtos_thread_flags, "%s(0x%X,%u,%u) @%p %s <0x%X\n",
+                       __func__, mask, timeout, mode, this, name (),
+                       event_flags_.mask ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      // Don't call this from critical regions.
+      os_assert_err(!scheduler::locked (), EPERM);
+
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          if (event_flags_.check_raised (mask, oflags, mode))
+            {
+#if defined(OS_TRACE_RTOS_THREAD_FLAGS)
+              OS_TRACE_PRINTF (rtos_thread_flags,
+                               "%s(0x%X,%u,%u) @%p %s >0x%X\n", __func__, mask,
+                               timeout, mode, this, name (),
+                               event_flags_.mask ());
+#endif
+              return result::ok;
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+
+      internal::clock_timestamps_list& clock_list = clock_->steady_list ();
+      clock::timestamp_t timeout_timestamp = clock_->steady_now () + timeout;
+
+#if defined(OS_TRACE_RTOS_THREAD_FLAGS)
+      clock::timestamp_t begin_timestamp = clock_->steady_now ();
+#endif
+
+      // Prepare a timeout node pointing to the current thread.
+      internal::timeout_thread_node timeout_node
+        { timeout_timestamp, *this };
+
+      for (;;)
+        {
+            {
+              // ----- Enter critical section ---------------------------------
+              interrupts::critical_section ics;
+
+              if (event_flags_.check_raised (mask, oflags, mode))
+                {
+#if defined(OS_TRACE_RTOS_THREAD_FLAGS)
+                  clock::duration_t slept_ticks =
+                      static_cast<clock::duration_t> (clock_->steady_now ()
+                          - begin_timestamp);
+                  OS_TRACE_PRINTF (rtos_thread_flags,
+                                   "%s(0x%X,%u,%u) in %u @%p %s >0x%X\n",
+                                   __func__, mask, timeout, mode,
+                                   static_cast<unsigned int> (slept_ticks),
+                                   this, name (), event_flags_.mask ());
+#endif
+                  return result::ok;
+                }
+
+              // Remove this thread from the ready list, if there.
+              port::this_thread::prepare_suspend ();
+
+              // Add this thread to the clock timeout list.
+              clock_list.link (timeout_node);
+              timeout_node.thread.clock_node_ = &timeout_node;
+
+              state_ = state::suspended;
+              // ----- Exit critical section ----------------------------------
+            }
+
+          port::scheduler::reschedule ();
+
+            {
+              // ----- Enter critical section ---------------------------------
+              interrupts::critical_section ics;
+
+              // Remove the thread from the clock timeout list,
+              // if not already removed by the timer.
+              timeout_node.thread.clock_node_ = nullptr;
+              timeout_node.unlink ();
+              // ----- Exit critical section ----------------------------------
+            }
+
+          if (interrupted ())
+            {
+#if defined(OS_TRACE_RTOS_THREAD_FLAGS)
+              OS_TRACE_PRINTF (rtos_thread_flags,
+                               "%s(0x%X,%u,%u) EINTR @%p %s\n", __func__, mask,
+                               timeout, mode, this, name ());
+#endif
+              return EINTR;
+            }
+
+          if (clock_->steady_now () >= timeout_timestamp)
+            {
+#if defined(OS_TRACE_RTOS_THREAD_FLAGS)
+              OS_TRACE_PRINTF (rtos_thread_flags,
+                               "%s(0x%X,%u,%u) ETIMEDOUT @%p %s\n", __func__,
+                               mask, timeout, mode, this, name ());
+#endif
+              return ETIMEDOUT;
+            }
+        }
+
+      return ENOTRECOVERABLE;
+    }
+
+#if defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS)
+
+    /**
+     * @cond ignore
+     */
+
+    namespace
+    {
+      enum
+        : uint8_t
+          {
+            notify_none = 0, //
+            notify_pending, //
+            notify_waiting
+      };
+    }
+
+    /**
+     * @endcond
+     */
+
+    /**
+     * @details
+     * Update the notification value as selected by the action,
+     * and mark the notification as pending. The thread is resumed
+     * only if it waits for a notification, so notifying a busy
+     * thread costs just a short critical section.
+     *
+     * Unlike semaphores, the notifications need no separate object,
+     * but only the thread itself can wait for them.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    result_t
+    thread::notify (notify::value_t value, notify::action act,
+                    notify::value_t* oprevious)
+    {
+#if defined(OS_TRACE_RTOS_THREAD_FLAGS)
+      OS_TRACE_PRINTF (rtos_thread_flags, "%s(0x%X,%u) @%p %s\n", __func__,
+                       value, static_cast<unsigned int> (act), this, name ());
+#endif
+
+      bool waiting;
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          if (oprevious != nullptr)
+            {
+              *oprevious = notify_value_;
+            }
+
+          switch (act)
+            {
+            case notify::action::set_bits:
+              notify_value_ = notify_value_ | value;
+              break;
+
+            case notify::action::increment:
+              notify_value_ = notify_value_ + 1;
+              break;
+
+            case notify::action::no_overwrite:
+              if (notify_state_ == notify_pending)
+                {
+                  return EAGAIN;
+                }
+              notify_value_ = value;
+              break;
+
+            default:
+              notify_value_ = value;
+              break;
+            }
+
+          waiting = (notify_state_ == notify_waiting);
+          notify_state_ = notify_pending;
+          // ----- Exit critical section --------------------------------------
+        }
+
+      if (waiting)
+        {
+          this->resume ();
+        }
+
+      return result::ok;
+    }
+
+    /**
+     * @cond ignore
+     */
+
+    bool
+    thread::internal_notify_take_ (notify::value_t* ovalue,
+                                   notify::value_t clear)
+    {
+      if (notify_state_ != notify_pending)
+        {
+          return false;
+        }
+
+      if (ovalue != nullptr)
+        {
+          *ovalue = notify_value_;
+        }
+      notify_value_ = notify_value_ & ~clear;
+      notify_state_ = notify_none;
+
+      return true;
+    }
+
+    result_t
+    thread::internal_notify_wait_ (notify::value_t* ovalue,
+                                   notify::value_t clear)
+    {
+#if defined(OS_TRACE_RTOS_THREAD_FLAGS)
+      OS_TRACE_PRINTF (rtos_thread_flags, "%s(0x%X) @%p %s\n", __func__, clear,
+                       this, name ());
 #endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      // Don't call this from critical regions.
+      os_assert_err(!scheduler::locked (), EPERM);
+
+      for (;;)
+        {
+            {
+              // ----- Enter critical section ---------------------------------
+              interrupts::critical_section ics;
+
+              if (internal_notify_take_ (ovalue, clear))
+                {
                   return result::ok;
                 }
+              notify_state_ = notify_waiting;
               // ----- Exit critical section ----------------------------------
             }
 
@@ -1283,9 +2484,20 @@ namespace os
 
           if (interrupted ())
             {
+                {
+                  // ----- Enter critical section -----------------------------
+                  interrupts::critical_section ics;
+
+                  if (notify_state_ == notify_waiting)
+                    {
+                      notify_state_ = notify_none;
+                    }
+                  // ----- Exit critical section ------------------------------
+                }
+
 #if defined(OS_TRACE_RTOS_THREAD_FLAGS)
-              trace::printf ("%s(0x%X,%u) EINTR @%p %s\n", __func__, mask, mode,
-                             this, name ());
+              OS_TRACE_PRINTF (rtos_thread_flags, "%s() EINTR @%p %s\n",
+                               __func__, this, name ());
 #endif
               return EINTR;
             }
@@ -1296,50 +2508,32 @@ namespace os
     }
 
     result_t
-    thread::internal_flags_try_wait_ (flags::mask_t mask, flags::mask_t* oflags,
-                                      flags::mode_t mode)
+    thread::internal_notify_try_wait_ (notify::value_t* ovalue,
+                                       notify::value_t clear)
     {
-#if defined(OS_TRACE_RTOS_THREAD_FLAGS)
-      trace::printf ("%s(0x%X,%u) @%p %s <0x%X\n", __func__, mask, mode, this,
-                     name (), event_flags_.mask ());
-#endif
-
       // Don't call this from interrupt handlers.
       os_assert_err(!interrupts::in_handler_mode (), EPERM);
 
-        {
-          // ----- Enter critical section -------------------------------------
-          interrupts::critical_section ics;
+      // ----- Enter critical section -----------------------------------------
+      interrupts::critical_section ics;
 
-          if (event_flags_.check_raised (mask, oflags, mode))
-            {
-#if defined(OS_TRACE_RTOS_THREAD_FLAGS)
-              trace::printf ("%s(0x%X,%u) @%p %s >0x%X\n", __func__, mask, mode,
-                             this, name (), event_flags_.mask ());
-#endif
-              return result::ok;
-            }
-          else
-            {
-#if defined(OS_TRACE_RTOS_THREAD_FLAGS)
-              trace::printf ("%s(0x%X,%u) EWOULDBLOCK @%p %s \n", __func__,
-                             mask, mode, this, name ());
-#endif
-              return EWOULDBLOCK;
-            }
-          // ----- Exit critical section --------------------------------------
+      if (internal_notify_take_ (ovalue, clear))
+        {
+          return result::ok;
         }
+      return EWOULDBLOCK;
+      // ----- Exit critical section ------------------------------------------
     }
 
     result_t
-    thread::internal_flags_timed_wait_ (flags::mask_t mask,
-                                        clock::duration_t timeout,
-                                        flags::mask_t* oflags,
-                                        flags::mode_t mode)
+    thread::internal_notify_timed_wait_ (clock::duration_t timeout,
+                                         notify::value_t* ovalue,
+                                         notify::value_t clear)
     {
 #if defined(OS_TRACE_RTOS_THREAD_FLAGS)
-      trace::printf ("%s(0x%X,%u,%u) @%p %s <0x%X\n", __func__, mask, timeout,
-                     mode, this, name (), event_flags_.mask ());
+      OS_TRACE_PRINTF (rtos_thread_flags, "%s(%u,0x%X) @%p %s\n", __func__,
+                       static_cast<unsigned int> (timeout), clear, this,
+                       name ());
 #endif
 
       // Don't call this from interrupt handlers.
@@ -1351,13 +2545,8 @@ namespace os
           // ----- Enter critical section -------------------------------------
           interrupts::critical_section ics;
 
-          if (event_flags_.check_raised (mask, oflags, mode))
+          if (internal_notify_take_ (ovalue, clear))
             {
-#if defined(OS_TRACE_RTOS_THREAD_FLAGS)
-              trace::printf ("%s(0x%X,%u,%u) @%p %s >0x%X\n", __func__, mask,
-                             timeout, mode, this, name (),
-                             event_flags_.mask ());
-#endif
               return result::ok;
             }
           // ----- Exit critical section --------------------------------------
@@ -1366,33 +2555,22 @@ namespace os
       internal::clock_timestamps_list& clock_list = clock_->steady_list ();
       clock::timestamp_t timeout_timestamp = clock_->steady_now () + timeout;
 
-#if defined(OS_TRACE_RTOS_THREAD_FLAGS)
-      clock::timestamp_t begin_timestamp = clock_->steady_now ();
-#endif
-
       // Prepare a timeout node pointing to the current thread.
       internal::timeout_thread_node timeout_node
         { timeout_timestamp, *this };
 
+      result_t res = ENOTRECOVERABLE;
       for (;;)
         {
             {
               // ----- Enter critical section ---------------------------------
               interrupts::critical_section ics;
 
-              if (event_flags_.check_raised (mask, oflags, mode))
+              if (internal_notify_take_ (ovalue, clear))
                 {
-#if defined(OS_TRACE_RTOS_THREAD_FLAGS)
-                  clock::duration_t slept_ticks =
-                      static_cast<clock::duration_t> (clock_->steady_now ()
-                          - begin_timestamp);
-                  trace::printf ("%s(0x%X,%u,%u) in %u @%p %s >0x%X\n",
-                                 __func__, mask, timeout, mode,
-                                 static_cast<unsigned int> (slept_ticks), this,
-                                 name (), event_flags_.mask ());
-#endif
                   return result::ok;
                 }
+              notify_state_ = notify_waiting;
 
               // Remove this thread from the ready list, if there.
               port::this_thread::prepare_suspend ();
@@ -1420,26 +2598,44 @@ namespace os
 
           if (interrupted ())
             {
-#if defined(OS_TRACE_RTOS_THREAD_FLAGS)
-              trace::printf ("%s(0x%X,%u,%u) EINTR @%p %s\n", __func__, mask,
-                             timeout, mode, this, name ());
-#endif
-              return EINTR;
+              res = EINTR;
+              break;
             }
 
           if (clock_->steady_now () >= timeout_timestamp)
             {
-#if defined(OS_TRACE_RTOS_THREAD_FLAGS)
-              trace::printf ("%s(0x%X,%u,%u) ETIMEDOUT @%p %s\n", __func__,
-                             mask, timeout, mode, this, name ());
-#endif
-              return ETIMEDOUT;
+              res = ETIMEDOUT;
+              break;
             }
         }
 
-      return ENOTRECOVERABLE;
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          // A notification that arrived together with the
+          // timeout is not lost.
+          if (internal_notify_take_ (ovalue, clear))
+            {
+              return result::ok;
+            }
+          notify_state_ = notify_none;
+          // ----- Exit critical section --------------------------------------
+        }
+
+#if defined(OS_TRACE_RTOS_THREAD_FLAGS)
+      OS_TRACE_PRINTF (rtos_thread_flags, "%s() %s @%p %s\n", __func__,
+                       (res == EINTR) ? "EINTR" : "ETIMEDOUT", this, name ());
+#endif
+      return res;
     }
 
+    /**
+     * @endcond
+     */
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_NOTIFICATIONS) */
+
     /**
      * @details
      * Select the requested bits from the thread current flags mask
@@ -1455,7 +2651,8 @@ namespace os
     thread::internal_flags_get_ (flags::mask_t mask, flags::mode_t mode)
     {
 #if defined(OS_TRACE_RTOS_THREAD_FLAGS)
-      trace::printf ("%s(0x%X) @%p %s\n", __func__, mask, this, name ());
+      OS_TRACE_PRINTF (rtos_thread_flags, "%s(0x%X) @%p %s\n", __func__, mask,
+                       this, name ());
 #endif
 
       // Don't call this from interrupt handlers.
@@ -1464,8 +2661,8 @@ namespace os
       flags::mask_t ret = event_flags_.get (mask, mode);
 
 #if defined(OS_TRACE_RTOS_THREAD_FLAGS)
-      trace::printf ("%s(0x%X)=0x%X @%p %s\n", __func__, mask,
-                     event_flags_.mask (), this, name ());
+      OS_TRACE_PRINTF (rtos_thread_flags, "%s(0x%X)=0x%X @%p %s\n", __func__,
+                       mask, event_flags_.mask (), this, name ());
 #endif
       // Return the selected bits.
       return ret;
@@ -1480,8 +2677,8 @@ namespace os
     thread::internal_flags_clear_ (flags::mask_t mask, flags::mask_t* oflags)
     {
 #if defined(OS_TRACE_RTOS_THREAD_FLAGS)
-      trace::printf ("%s(0x%X) @%p %s <0x%X\n", __func__, mask, this, name (),
-                     event_flags_.mask ());
+      OS_TRACE_PRINTF (rtos_thread_flags, "%s(0x%X) @%p %s <0x%X\n", __func__,
+                       mask, this, name (), event_flags_.mask ());
 #endif
 
       // Don't call this from interrupt handlers.
@@ -1490,8 +2687,8 @@ namespace os
       result_t res = event_flags_.clear (mask, oflags);
 
 #if defined(OS_TRACE_RTOS_THREAD_FLAGS)
-      trace::printf ("%s(0x%X) @%p %s >0x%X\n", __func__, mask, this, name (),
-                     event_flags_.mask ());
+      OS_TRACE_PRINTF (rtos_thread_flags, "%s(0x%X) @%p %s >0x%X\n", __func__,
+                       mask, this, name (), event_flags_.mask ());
 #endif
       return res;
     }
@@ -1500,6 +2697,213 @@ namespace os
      * @endcond
      */
 
+#if defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_PROFILE)
+
+    // ========================================================================
+
+    /**
+     * @details
+     * The values are copied in a critical section, so they are
+     * consistent with each other, even if the thread is running
+     * or is resumed by an interrupt.
+     *
+     * The thread pointer, name and state are not part of the
+     * statistics and are left for the caller to fill in;
+     * `scheduler::statistics::threads_profile()` does this for
+     * all threads.
+     *
+     * @note This function is available only when
+     * @ref OS_INCLUDE_RTOS_STATISTICS_THREAD_PROFILE
+     * is defined.
+     */
+    void
+    thread::statistics::snapshot (profile& out)
+    {
+      // ----- Enter critical section -----------------------------------------
+      interrupts::critical_section ics;
+
+      out.context_switches = context_switches_;
+      out.cpu_cycles = cpu_cycles_;
+      out.preemptions = preemptions_;
+      out.max_latency = max_latency_;
+      out.blocked_cycles = blocked_cycles_;
+      for (std::size_t i = 0; i < histogram_buckets; ++i)
+        {
+          out.histogram[i] = histogram_[i];
+        }
+      for (std::size_t i = 0; i < blocked_objects; ++i)
+        {
+          out.objects[i] = objects_[i];
+        }
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    /**
+     * @cond ignore
+     */
+
+    /**
+     * @details
+     * Remember the object the thread is about to wait for;
+     * the blocked time is accounted when the thread is resumed.
+     *
+     * Must be called from a critical section.
+     */
+    void
+    thread::statistics::internal_waiting_for_ (const void* object)
+    {
+      block_object_ = object;
+    }
+
+    /**
+     * @details
+     * Called when the thread is linked to the ready list.
+     * If the thread was blocked, the duration is accumulated to the
+     * total and to the entry of the waited object; if all entries
+     * are used by other objects, only the total is updated.
+     *
+     * Must be called from a critical section.
+     */
+    void
+    thread::statistics::internal_ready_ (clock::timestamp_t now)
+    {
+      if (blocked_)
+        {
+          rtos::statistics::duration_t delta =
+              static_cast<rtos::statistics::duration_t> (now
+                  - block_timestamp_);
+          blocked_cycles_ += delta;
+
+          for (std::size_t i = 0; i < blocked_objects; ++i)
+            {
+              if (objects_[i].count == 0 || objects_[i].object == block_object_)
+                {
+                  objects_[i].object = block_object_;
+                  objects_[i].count++;
+                  objects_[i].cycles += delta;
+                  break;
+                }
+            }
+          blocked_ = false;
+        }
+
+      block_object_ = nullptr;
+      ready_timestamp_ = now;
+      ready_ = true;
+    }
+
+    /**
+     * @details
+     * Called by the scheduler when the thread is replaced by
+     * another one. The running slice is added to the histogram
+     * and, depending on the new thread state, the preemption is
+     * counted or the blocked time starts.
+     *
+     * Must be called from a critical section.
+     */
+    void
+    thread::statistics::internal_switch_out_ (clock::timestamp_t now,
+                                              state_t state)
+    {
+      histogram_[rtos::statistics::internal_histogram_bucket_ (slice_cycles_)]++;
+      slice_cycles_ = 0;
+
+      if (state == state::ready)
+        {
+          preemptions_++;
+          ready_timestamp_ = now;
+          ready_ = true;
+        }
+      else if (state == state::suspended)
+        {
+          block_timestamp_ = now;
+          blocked_ = true;
+        }
+    }
+
+    /**
+     * @details
+     * Called by the scheduler when the thread starts running;
+     * update the worst-case latency since it became ready.
+     *
+     * Must be called from a critical section.
+     */
+    void
+    thread::statistics::internal_switch_in_ (clock::timestamp_t now)
+    {
+      if (ready_)
+        {
+          rtos::statistics::duration_t latency =
+              static_cast<rtos::statistics::duration_t> (now
+                  - ready_timestamp_);
+          if (latency > max_latency_)
+            {
+              max_latency_ = latency;
+            }
+          ready_ = false;
+        }
+    }
+
+    /**
+     * @endcond
+     */
+
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_THREAD_PROFILE) */
+
+#if defined(OS_INCLUDE_RTOS_THREAD_NEWLIB_REENT)
+
+    /**
+     * @details
+     * The structure is allocated from the pool and initialised on
+     * the first call; until then, and if the pool is exhausted,
+     * the thread uses the global structure. If the thread is the
+     * current one, `_impure_ptr` is updated immediately, otherwise
+     * at the next context switch.
+     *
+     * Should be called by the thread itself, before the first
+     * use of the stdio functions.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    struct _reent*
+    thread::newlib_reent (void)
+    {
+      struct _reent* reent = newlib_reent_;
+      if (reent != nullptr)
+        {
+          return reent;
+        }
+
+      reent = static_cast<struct _reent*> (newlib_reent_pool_.try_alloc ());
+      if (reent == nullptr)
+        {
+          return _GLOBAL_REENT;
+        }
+      _REENT_INIT_PTR (reent);
+
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          if (newlib_reent_ != nullptr)
+            {
+              // Allocated meanwhile, by a call from another thread.
+              newlib_reent_pool_.free (reent);
+              return newlib_reent_;
+            }
+          newlib_reent_ = reent;
+          if (this == &this_thread::thread ())
+            {
+              _impure_ptr = reent;
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+
+      return reent;
+    }
+
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_NEWLIB_REENT) */
+
     // ------------------------------------------------------------------------
     /**
      * @details
@@ -1524,7 +2928,7 @@ namespace os
 
 #else
 
-        th = scheduler::current_thread_;
+        th = scheduler::internal_current_thread_ ();
 
 #endif
         return th;
@@ -1569,13 +2973,15 @@ namespace os
         if (!scheduler::started ())
           {
 #if defined(OS_TRACE_RTOS_THREAD_CONTEXT)
-            trace::printf ("%s() nop %s \n", __func__, _thread ()->name ());
+            OS_TRACE_PRINTF (rtos_thread_context, "%s() nop %s \n", __func__,
+                             _thread ()->name ());
 #endif
             return;
           }
 
 #if defined(OS_TRACE_RTOS_THREAD_CONTEXT)
-        trace::printf ("%s() from %s\n", __func__, _thread ()->name ());
+        OS_TRACE_PRINTF (rtos_thread_context, "%s() from %s\n", __func__,
+                         _thread ()->name ());
 #endif
 
 #if defined(OS_USE_RTOS_PORT_SCHEDULER)
@@ -1584,15 +2990,252 @@ namespace os
 
 #else
 
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING)
+        // Giving up the turn ends the slice.
+        _thread ()->slice_left_ = 0;
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING) */
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_PREEMPTION_THRESHOLD)
+        // Yielding is voluntary, the threshold does not apply;
+        // it is restored when the thread runs again.
+        rtos::thread* th = _thread ();
+        rtos::thread::priority_t threshold = th->threshold_;
+        th->threshold_ = rtos::thread::priority::none;
+
+        port::scheduler::reschedule ();
+
+        th->threshold_ = threshold;
+#else
         port::scheduler::reschedule ();
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_PREEMPTION_THRESHOLD) */
+
+#endif
 
+#if defined(OS_TRACE_RTOS_THREAD_CONTEXT)
+        OS_TRACE_PRINTF (rtos_thread_context, "%s() to %s\n", __func__,
+                         _thread ()->name ());
 #endif
+      }
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_HANDOFF)
+
+      /**
+       * @details
+       * A directed yield: the current thread remains ready, but the
+       * CPU goes directly to the target thread, instead of the top of
+       * the ready list, even if the target has a lower priority than
+       * the current thread. This is useful for synchronous requests,
+       * where the current thread posts a request to a server thread
+       * and waits for the reply, since the server can start working
+       * immediately.
+       *
+       * With time slicing, the rest of the current slice is
+       * donated to the target.
+       *
+       * Threads with higher priorities than the target are not
+       * delayed; if one is ready at the time of the switch, it
+       * runs first, as after a plain `yield()`.
+       *
+       * @warning Cannot be invoked from Interrupt Service Routines.
+       */
+      result_t
+      handoff (rtos::thread& th)
+      {
+        // Don't call this from interrupt handlers.
+        os_assert_err(!interrupts::in_handler_mode (), EPERM);
+
+        rtos::thread* crt = _thread ();
+        os_assert_err(&th != crt, EINVAL);
 
 #if defined(OS_TRACE_RTOS_THREAD_CONTEXT)
-        trace::printf ("%s() to %s\n", __func__, _thread ()->name ());
+        OS_TRACE_PRINTF (rtos_thread_context, "%s(%s) from %s\n", __func__,
+                         th.name (), crt->name ());
+#endif
+
+          {
+            // ----- Enter critical section ---------------------------------
+            interrupts::critical_section ics;
+
+#if defined(OS_INCLUDE_RTOS_SMP)
+            if (th.core_ != crt->core_)
+              {
+                return EINVAL;
+              }
+#endif /* defined(OS_INCLUDE_RTOS_SMP) */
+
+            if (th.state_ != rtos::thread::state::ready)
+              {
+                return EAGAIN;
+              }
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING)
+            if (crt->slice_left_ != 0)
+              {
+                th.slice_left_ = crt->slice_left_;
+              }
+            // The current thread gave up its turn.
+            crt->slice_left_ = 0;
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_TIME_SLICING) */
+
+            crt->handoff_ = &th;
+            // ----- Exit critical section ----------------------------------
+          }
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_PREEMPTION_THRESHOLD)
+        // As for yield(), the threshold does not apply.
+        rtos::thread::priority_t threshold = crt->threshold_;
+        crt->threshold_ = rtos::thread::priority::none;
+
+        port::scheduler::reschedule ();
+
+        crt->threshold_ = threshold;
+#else
+        port::scheduler::reschedule ();
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_PREEMPTION_THRESHOLD) */
+
+        // If the scheduler was locked, forget the request.
+        crt->handoff_ = nullptr;
+
+        return result::ok;
+      }
+
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_HANDOFF) */
+
+#if defined(OS_INCLUDE_RTOS_SCHEDULER_EDF)
+
+      /**
+       * @details
+       * Called by periodic EDF threads at the end of each job.
+       * If the job ended after its deadline, the thread miss
+       * counter is incremented.
+       *
+       * The next release is one period after the previous one,
+       * so the phase does not drift; a thread late by more than
+       * a period skips the releases already passed, each of them
+       * counted as a miss. The deadline of the new job is
+       * computed from its release, and the thread sleeps until
+       * the release.
+       *
+       * @warning Cannot be invoked from Interrupt Service Routines.
+       */
+      result_t
+      wait_next_period (void)
+      {
+        // Don't call this from interrupt handlers.
+        os_assert_err(!interrupts::in_handler_mode (), EPERM);
+
+        rtos::thread& th = thread ();
+        os_assert_err(th.edf_period_ != 0, EINVAL);
+
+        clock::timestamp_t now = th.clock_->now ();
+        if (now > th.edf_deadline_)
+          {
+            ++th.deadline_misses_;
+            ++scheduler::edf::deadline_misses_;
+          }
+
+        th.edf_release_ += th.edf_period_;
+        while (th.edf_release_ + th.edf_relative_ < now)
+          {
+            // Skip the jobs that cannot be done in time anyway.
+            th.edf_release_ += th.edf_period_;
+            ++th.deadline_misses_;
+            ++scheduler::edf::deadline_misses_;
+          }
+        th.edf_deadline_ = th.edf_release_ + th.edf_relative_;
+
+#if defined(OS_TRACE_RTOS_THREAD)
+        OS_TRACE_PRINTF (rtos_thread, "%s() %s release %u\n", __func__,
+                         th.name (),
+                         static_cast<unsigned int> (th.edf_release_));
 #endif
+
+        // Not ready while sleeping, the new deadline is used
+        // when the thread is linked again.
+#if defined(OS_INCLUDE_RTOS_THREAD_BUDGET)
+        result_t res = th.clock_->sleep_until (th.edf_release_);
+        th.budget_restart ();
+        return res;
+#else
+        return th.clock_->sleep_until (th.edf_release_);
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_BUDGET) */
+      }
+
+#endif /* defined(OS_INCLUDE_RTOS_SCHEDULER_EDF) */
+
+#if defined(OS_INCLUDE_RTOS_THREAD_LOCAL_SLOTS)
+
+      /**
+       * @details
+       * The key is valid for all threads, existing and future ones;
+       * the slots of the new key are `nullptr` in all threads only
+       * if the previous owner of the key cleared them, see
+       * `local_key_delete()`.
+       *
+       * @warning Cannot be invoked from Interrupt Service Routines.
+       */
+      result_t
+      local_key_create (local_key_t* key)
+      {
+        os_assert_err(!interrupts::in_handler_mode (), EPERM);
+        os_assert_err(key != nullptr, EINVAL);
+
+        constexpr uint32_t all_keys =
+            (OS_INTEGER_RTOS_THREAD_LOCAL_SLOTS == 32) ?
+                0xFFFFFFFFu : ((1u << OS_INTEGER_RTOS_THREAD_LOCAL_SLOTS) - 1);
+
+          {
+            // ----- Enter critical section -----------------------------------
+            interrupts::critical_section ics;
+
+            uint32_t free_keys = ~local_keys_map_ & all_keys;
+            if (free_keys == 0)
+              {
+                return EAGAIN;
+              }
+
+            local_key_t k =
+                static_cast<local_key_t> (__builtin_ctz (free_keys));
+            local_keys_map_ |= (1u << k);
+            *key = k;
+            // ----- Exit critical section ------------------------------------
+          }
+
+        return result::ok;
+      }
+
+      /**
+       * @details
+       * The values stored by the threads are not changed; they
+       * should be released, and the slots cleared, by each thread
+       * before the key is released, otherwise they are seen by
+       * the next owner of the key.
+       *
+       * @warning Cannot be invoked from Interrupt Service Routines.
+       */
+      result_t
+      local_key_delete (local_key_t key)
+      {
+        os_assert_err(!interrupts::in_handler_mode (), EPERM);
+        os_assert_err(key < OS_INTEGER_RTOS_THREAD_LOCAL_SLOTS, EINVAL);
+
+          {
+            // ----- Enter critical section -----------------------------------
+            interrupts::critical_section ics;
+
+            if ((local_keys_map_ & (1u << key)) == 0)
+              {
+                return EINVAL;
+              }
+            local_keys_map_ &= ~(1u << key);
+            // ----- Exit critical section ------------------------------------
+          }
+
+        return result::ok;
       }
 
+#endif /* defined(OS_INCLUDE_RTOS_THREAD_LOCAL_SLOTS) */
+
     } /* namespace this_thread */
 
   // --------------------------------------------------------------------------
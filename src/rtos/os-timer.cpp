@@ -27,6 +27,31 @@
 
 #include <cmsis-plus/rtos/os.h>
 
+#include <memory>
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_INCLUDE_RTOS_TIMER_DAEMON) && !defined(OS_USE_RTOS_PORT_TIMER)
+
+void*
+os_timer_daemon (os::rtos::thread::func_args_t args);
+
+namespace
+{
+  // The thread flag used to wake-up the daemon.
+  constexpr os::rtos::flags::mask_t wakeup_flag = 1;
+
+  // The timers waiting for the daemon, in expiry order; accessed
+  // from the clock interrupt and, with interrupts disabled,
+  // from threads.
+  os::rtos::timer* pending_head;
+  os::rtos::timer* pending_tail;
+
+  os::rtos::thread* daemon_thread;
+}
+
+#endif
+
 // ----------------------------------------------------------------------------
 
 namespace os
@@ -171,7 +196,8 @@ namespace os
           { name }
     {
 #if defined(OS_TRACE_RTOS_TIMER)
-      trace::printf ("%s() @%p %s\n", __func__, this, this->name ());
+      OS_TRACE_PRINTF (rtos_timer, "%s() @%p %s\n", __func__, this,
+                       this->name ());
 #endif
 
       // Don't call this from interrupt handlers.
@@ -197,6 +223,10 @@ namespace os
 
 #endif
       state_ = state::initialized;
+
+#if defined(OS_INCLUDE_RTOS_OBJECT_REGISTRY)
+      registry::internal_insert (this, registry::type::timer);
+#endif /* defined(OS_INCLUDE_RTOS_OBJECT_REGISTRY) */
     }
 
     /**
@@ -212,9 +242,13 @@ namespace os
     timer::~timer ()
     {
 #if defined(OS_TRACE_RTOS_TIMER)
-      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+      OS_TRACE_PRINTF (rtos_timer, "%s() @%p %s\n", __func__, this, name ());
 #endif
 
+#if defined(OS_INCLUDE_RTOS_OBJECT_REGISTRY)
+      registry::internal_erase (this, registry::type::timer);
+#endif /* defined(OS_INCLUDE_RTOS_OBJECT_REGISTRY) */
+
 #if defined(OS_USE_RTOS_PORT_TIMER)
 
       port::timer::destroy (this);
@@ -229,6 +263,9 @@ namespace os
             {
               timer_node_.unlink ();
             }
+#if defined(OS_INCLUDE_RTOS_TIMER_DAEMON)
+          internal_unlink_pending_ ();
+#endif
           // ----- Exit critical section --------------------------------------
         }
 
@@ -240,14 +277,26 @@ namespace os
      * @details
      * If the period is 0, it is automatically adjusted to 1.
      *
+     * With `OS_INCLUDE_RTOS_TIMER_SLACK`, each expiration may be
+     * delayed by up to `slack` clock units, so that it shares the
+     * wakeup with other timeouts already scheduled in that window,
+     * or lands on a round time stamp where other slack timeouts
+     * gather. Periodic timers are re-armed from the nominal
+     * expiration time, so the slack does not accumulate.
+     * Without this option, or with `OS_USE_RTOS_PORT_TIMER`, the
+     * slack is ignored.
+     *
      * @warning Cannot be invoked from Interrupt Service Routines.
      */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
     result_t
-    timer::start (clock::duration_t period)
+    timer::start (clock::duration_t period, clock::duration_t slack)
     {
 #if defined(OS_TRACE_RTOS_TIMER)
-      trace::printf ("%s(%u) @%p %s\n", __func__,
-                     static_cast<unsigned int> (period), this, name ());
+      OS_TRACE_PRINTF (rtos_timer, "%s(%u,%u) @%p %s\n", __func__,
+                       static_cast<unsigned int> (period),
+                       static_cast<unsigned int> (slack), this, name ());
 #endif
 
       // Don't call this from interrupt handlers.
@@ -269,6 +318,10 @@ namespace os
       period_ = period;
 
       timer_node_.timestamp = clock_->steady_now () + period;
+#if defined(OS_INCLUDE_RTOS_TIMER_SLACK)
+      nominal_ = timer_node_.timestamp;
+      timer_node_.slack = slack;
+#endif /* defined(OS_INCLUDE_RTOS_TIMER_SLACK) */
 
         {
           // ----- Enter critical section -------------------------------------
@@ -276,6 +329,10 @@ namespace os
 
           // If started, stop.
           timer_node_.unlink ();
+#if defined(OS_INCLUDE_RTOS_TIMER_DAEMON)
+          internal_unlink_pending_ ();
+          overruns_ = 0;
+#endif
 
           clock_->steady_list ().link (timer_node_);
           // ----- Exit critical section --------------------------------------
@@ -290,6 +347,7 @@ namespace os
         }
       return res;
     }
+#pragma GCC diagnostic pop
 
     /**
      * @details
@@ -304,7 +362,7 @@ namespace os
     timer::stop (void)
     {
 #if defined(OS_TRACE_RTOS_TIMER)
-      trace::printf ("%s() @%p %s\n", __func__, this, name ());
+      OS_TRACE_PRINTF (rtos_timer, "%s() @%p %s\n", __func__, this, name ());
 #endif
 
       // Don't call this from interrupt handlers.
@@ -328,6 +386,9 @@ namespace os
           interrupts::critical_section ics;
 
           timer_node_.unlink ();
+#if defined(OS_INCLUDE_RTOS_TIMER_DAEMON)
+          internal_unlink_pending_ ();
+#endif
           // ----- Exit critical section --------------------------------------
         }
       res = result::ok;
@@ -338,6 +399,179 @@ namespace os
       return res;
     }
 
+    /**
+     * @details
+     * Equivalent to calling `start()` for each timer, but all
+     * timers are armed in a single critical section. The timers
+     * are first sorted among themselves, in a local list, then
+     * merged in a single pass through the clock list, instead of
+     * one sorted insert for each.
+     *
+     * All timers of the same clock as the first one are merged
+     * together; the others are linked one by one.
+     *
+     * The batch ignores the timer slack.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    timer::start_n (timer* const timers[], std::size_t count,
+                    const clock::duration_t periods[])
+    {
+#if defined(OS_TRACE_RTOS_TIMER)
+      OS_TRACE_PRINTF (rtos_timer, "%s(%p,%u)\n", __func__, timers,
+                       static_cast<unsigned int> (count));
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      os_assert_err(timers != nullptr, EINVAL);
+
+      if (count == 0)
+        {
+          return result::ok;
+        }
+
+#if defined(OS_USE_RTOS_PORT_TIMER)
+
+      // The port keeps the periods.
+      os_assert_err(periods != nullptr, EINVAL);
+
+      result_t res = result::ok;
+      for (std::size_t i = 0; i < count; ++i)
+        {
+          result_t r = timers[i]->start (periods[i]);
+          if (r != result::ok)
+            {
+              res = r;
+            }
+        }
+      return res;
+
+#else
+
+      clock* clk = timers[0]->clock_;
+      clock::timestamp_t nw = clk->steady_now ();
+
+      internal::clock_timestamps_list batch;
+
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          for (std::size_t i = 0; i < count; ++i)
+            {
+              timer* tm = timers[i];
+              assert(tm != nullptr);
+
+              clock::duration_t period =
+                  (periods != nullptr) ? periods[i] : tm->period_;
+              if (period == 0)
+                {
+                  period = 1;
+                }
+              tm->period_ = period;
+
+              // If started, stop.
+              tm->timer_node_.unlink ();
+#if defined(OS_INCLUDE_RTOS_TIMER_DAEMON)
+              tm->internal_unlink_pending_ ();
+              tm->overruns_ = 0;
+#endif
+
+              if (tm->clock_ == clk)
+                {
+                  tm->timer_node_.timestamp = nw + period;
+                }
+              else
+                {
+                  tm->timer_node_.timestamp = tm->clock_->steady_now ()
+                      + period;
+                }
+#if defined(OS_INCLUDE_RTOS_TIMER_SLACK)
+              tm->nominal_ = tm->timer_node_.timestamp;
+              tm->timer_node_.slack = 0;
+#endif /* defined(OS_INCLUDE_RTOS_TIMER_SLACK) */
+
+              if (tm->clock_ == clk)
+                {
+                  // Sort among the batch; with equal periods each
+                  // node goes to the tail, in constant time.
+                  batch.link (tm->timer_node_);
+                }
+              else
+                {
+                  tm->clock_->steady_list ().link (tm->timer_node_);
+                }
+              tm->state_ = state::running;
+            }
+
+          clk->steady_list ().merge (batch);
+          // ----- Exit critical section --------------------------------------
+        }
+
+      return result::ok;
+
+#endif
+    }
+
+    /**
+     * @details
+     * Equivalent to calling `stop()` for each timer, but all
+     * timers are cancelled in a single critical section.
+     * Timers not running are skipped.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    timer::stop_n (timer* const timers[], std::size_t count)
+    {
+#if defined(OS_TRACE_RTOS_TIMER)
+      OS_TRACE_PRINTF (rtos_timer, "%s(%p,%u)\n", __func__, timers,
+                       static_cast<unsigned int> (count));
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      os_assert_err(timers != nullptr, EINVAL);
+
+#if defined(OS_USE_RTOS_PORT_TIMER)
+
+      for (std::size_t i = 0; i < count; ++i)
+        {
+          timers[i]->stop ();
+        }
+
+#else
+
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          for (std::size_t i = 0; i < count; ++i)
+            {
+              timer* tm = timers[i];
+              assert(tm != nullptr);
+
+              if (tm->state_ != state::running)
+                {
+                  continue;
+                }
+
+              tm->timer_node_.unlink ();
+#if defined(OS_INCLUDE_RTOS_TIMER_DAEMON)
+              tm->internal_unlink_pending_ ();
+#endif
+              tm->state_ = state::stopped;
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+
+#endif
+
+      return result::ok;
+    }
+
 #if !defined(OS_USE_RTOS_PORT_TIMER)
 
     /**
@@ -351,7 +585,12 @@ namespace os
       if (type_ == run::periodic)
         {
           // Re-arm the timer for the next period.
+#if defined(OS_INCLUDE_RTOS_TIMER_SLACK)
+          nominal_ += period_;
+          timer_node_.timestamp = nominal_;
+#else
           timer_node_.timestamp += period_;
+#endif /* defined(OS_INCLUDE_RTOS_TIMER_SLACK) */
 
           // No need for critical section in ISR.
           clock_->steady_list ().link (timer_node_);
@@ -365,10 +604,163 @@ namespace os
       trace::puts (name ());
 #endif
 
+#if defined(OS_INCLUDE_RTOS_TIMER_DAEMON)
+
+      if (pending_)
+        {
+          // The previous callback did not run yet, do not queue
+          // it twice, but count the missed period.
+          ++overruns_;
+          return;
+        }
+
+      // Append to the pending list; no need for critical section in ISR.
+      pending_ = true;
+      pending_next_ = nullptr;
+      if (pending_tail != nullptr)
+        {
+          pending_tail->pending_next_ = this;
+          pending_tail = this;
+        }
+      else
+        {
+          pending_head = pending_tail = this;
+
+          // The daemon runs the list until empty, so it must be
+          // woken up only for the first timer.
+          if (daemon_thread != nullptr)
+            {
+              daemon_thread->flags_raise (wakeup_flag);
+            }
+        }
+
+#else
+
+#if defined(OS_INCLUDE_RTOS_TRACE_EVENTS)
+      os_rtos_trace_timer_enter (this);
+#endif /* defined(OS_INCLUDE_RTOS_TRACE_EVENTS) */
+
       // Call the user function.
       func_ (func_args_);
+
+#if defined(OS_INCLUDE_RTOS_TRACE_EVENTS)
+      os_rtos_trace_timer_exit ();
+#endif /* defined(OS_INCLUDE_RTOS_TRACE_EVENTS) */
+
+#endif
+    }
+
+#if defined(OS_INCLUDE_RTOS_TIMER_DAEMON)
+
+    /**
+     * @details
+     * Must be called with interrupts disabled.
+     */
+    void
+    timer::internal_unlink_pending_ (void)
+    {
+      if (!pending_)
+        {
+          return;
+        }
+
+      timer* prev = nullptr;
+      for (timer* tm = pending_head; tm != nullptr; tm = tm->pending_next_)
+        {
+          if (tm == this)
+            {
+              if (prev != nullptr)
+                {
+                  prev->pending_next_ = pending_next_;
+                }
+              else
+                {
+                  pending_head = pending_next_;
+                }
+              if (pending_tail == this)
+                {
+                  pending_tail = prev;
+                }
+              break;
+            }
+          prev = tm;
+        }
+
+      pending_next_ = nullptr;
+      pending_ = false;
     }
 
+    /**
+     * @details
+     * Call the callbacks of all pending timers, in the order they
+     * expired; timers that expire meanwhile are also processed.
+     *
+     * Each timer is removed from the list with interrupts disabled,
+     * so it can be stopped or destroyed at any time; the callbacks
+     * themselves run with interrupts enabled.
+     */
+    std::size_t
+    timer::internal_dispatch_pending_ (void)
+    {
+      std::size_t count = 0;
+      for (;;)
+        {
+          func_t func;
+          func_args_t args;
+#if defined(OS_INCLUDE_RTOS_TRACE_EVENTS)
+          timer* traced;
+#endif /* defined(OS_INCLUDE_RTOS_TRACE_EVENTS) */
+
+            {
+              // ----- Enter critical section ---------------------------------
+              interrupts::critical_section ics;
+
+              timer* tm = pending_head;
+              if (tm == nullptr)
+                {
+                  break;
+                }
+
+              pending_head = tm->pending_next_;
+              if (pending_head == nullptr)
+                {
+                  pending_tail = nullptr;
+                }
+              tm->pending_next_ = nullptr;
+              tm->pending_ = false;
+
+              func = tm->func_;
+              args = tm->func_args_;
+#if defined(OS_INCLUDE_RTOS_TRACE_EVENTS)
+              traced = tm;
+#endif /* defined(OS_INCLUDE_RTOS_TRACE_EVENTS) */
+              // ----- Exit critical section ----------------------------------
+            }
+
+#if defined(OS_INCLUDE_RTOS_TRACE_EVENTS)
+          os_rtos_trace_timer_enter (traced);
+#endif /* defined(OS_INCLUDE_RTOS_TRACE_EVENTS) */
+
+          // Call the user function.
+          func (args);
+
+#if defined(OS_INCLUDE_RTOS_TRACE_EVENTS)
+          os_rtos_trace_timer_exit ();
+#endif /* defined(OS_INCLUDE_RTOS_TRACE_EVENTS) */
+
+          ++count;
+        }
+      return count;
+    }
+
+    thread*
+    timer::daemon (void)
+    {
+      return daemon_thread;
+    }
+
+#endif
+
   /**
    * @endcond
    */
@@ -379,3 +771,87 @@ namespace os
 
   } /* namespace rtos */
 } /* namespace os */
+
+#if defined(OS_INCLUDE_RTOS_TIMER_DAEMON) && !defined(OS_USE_RTOS_PORT_TIMER)
+
+using namespace os;
+using namespace os::rtos;
+
+/**
+ * @cond ignore
+ */
+
+#pragma GCC diagnostic push
+#if defined(__clang__)
+#pragma clang diagnostic ignored "-Wexit-time-destructors"
+#pragma clang diagnostic ignored "-Wglobal-constructors"
+#pragma clang diagnostic ignored "-Wmissing-variable-declarations"
+#endif
+
+#if defined(OS_EXCLUDE_DYNAMIC_MEMORY_ALLOCATIONS)
+
+static thread_inclusive<OS_INTEGER_RTOS_TIMER_DAEMON_STACK_SIZE_BYTES> os_timer_daemon_thread_
+  { "timer", os_timer_daemon, nullptr};
+
+#else
+
+static std::unique_ptr<thread> os_timer_daemon_thread_;
+
+#endif /* defined(OS_EXCLUDE_DYNAMIC_MEMORY_ALLOCATIONS) */
+
+#pragma GCC diagnostic pop
+
+/**
+ * @endcond
+ */
+
+void
+__attribute__((weak))
+os_startup_create_thread_timer_daemon (void)
+{
+#if defined(OS_EXCLUDE_DYNAMIC_MEMORY_ALLOCATIONS)
+
+  // The thread object instance was created by the static constructors.
+  daemon_thread = &os_timer_daemon_thread_;
+
+#else
+
+  thread::attributes attr = thread::initializer;
+  attr.th_stack_size_bytes = OS_INTEGER_RTOS_TIMER_DAEMON_STACK_SIZE_BYTES;
+  attr.th_priority = OS_INTEGER_RTOS_TIMER_DAEMON_PRIORITY;
+
+  // No need for an explicit delete, it is deallocated by the unique_ptr.
+  os_timer_daemon_thread_ = std::unique_ptr<thread> (
+      new thread ("timer", os_timer_daemon, nullptr, attr));
+
+  daemon_thread = os_timer_daemon_thread_.get ();
+
+#endif /* defined(OS_EXCLUDE_DYNAMIC_MEMORY_ALLOCATIONS) */
+}
+
+/**
+ * @details
+ * Run the pending timer callbacks, then wait for the wake-up flag,
+ * raised by the clock interrupt when the first timer is added
+ * to an empty pending list.
+ */
+void*
+os_timer_daemon (thread::func_args_t args __attribute__((unused)))
+{
+  // The static instance is created with the default priority.
+  this_thread::thread ().priority (OS_INTEGER_RTOS_TIMER_DAEMON_PRIORITY);
+
+  for (;;)
+    {
+      timer::internal_dispatch_pending_ ();
+
+      // A flag raised after the list was found empty is not lost,
+      // it makes the wait return immediately.
+      this_thread::flags_wait (wakeup_flag);
+    }
+
+  /* NOTREACHED */
+  return nullptr;
+}
+
+#endif /* defined(OS_INCLUDE_RTOS_TIMER_DAEMON) */
@@ -0,0 +1,310 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/rtos/os.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    // ------------------------------------------------------------------------
+
+    /**
+     * @class topic
+     * @details
+     * Each frame is a memory pool block, with a reference count
+     * in the first word and the payload after it. The publisher
+     * owns one reference from `alloc()` up to `publish()`, and
+     * each subscriber owns one reference from the moment the
+     * frame pointer is queued up to its `release()`; the last
+     * release returns the block to the pool.
+     *
+     * Only pointers are copied, so the RAM and the time spent
+     * copying do not grow with the number of subscribers.
+     *
+     * @par Example
+     *
+     * @code{.cpp}
+     * memory_pool_inclusive<topic_frame<frame_t>, 8> pool;
+     * topic frames { "frames", pool };
+     *
+     * void
+     * producer(void)
+     * {
+     *   frame_t* frame = static_cast<frame_t*>(frames.alloc());
+     *   // Fill in the frame.
+     *   frames.publish(frame);
+     * }
+     *
+     * topic_subscriber<4> sub { frames };
+     *
+     * void
+     * consumer(void)
+     * {
+     *   void* frame;
+     *   sub.receive(&frame);
+     *   // Process the frame.
+     *   sub.release(frame);
+     * }
+     * @endcode
+     */
+
+    /**
+     * @details
+     * The pool blocks must be larger than the frame header.
+     */
+    topic::topic (const char* name, memory_pool& pool) :
+        object_named_system
+          { name }, //
+        pool_ (pool)
+    {
+      assert(pool_.block_size () > header_size_bytes);
+    }
+
+    /**
+     * @details
+     * There must be no subscribers linked to the topic.
+     */
+    topic::~topic ()
+    {
+      assert(subscribers_list_ == nullptr);
+    }
+
+    /**
+     * @cond ignore
+     */
+
+    void*
+    topic::internal_frame_ (void* block)
+    {
+      if (block == nullptr)
+        {
+          return nullptr;
+        }
+
+      // The publisher reference.
+      *static_cast<std::size_t*> (block) = 1;
+
+      return static_cast<char*> (block) + header_size_bytes;
+    }
+
+    /**
+     * @endcond
+     */
+
+    /**
+     * @details
+     * The frame pointer is sent to all subscribers; those with
+     * a full queue do not get a reference, and count the frame
+     * as dropped. Then the publisher reference is released, so
+     * with no subscribers the frame returns to the pool at once.
+     *
+     * After publishing, the frame content must not be changed.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    result_t
+    topic::publish (void* payload)
+    {
+      os_assert_err(payload != nullptr, EINVAL);
+
+      std::size_t* refs = internal_refs_ (payload);
+
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          for (topic_subscriber_base* sub = subscribers_list_; sub != nullptr;
+              sub = sub->next_)
+            {
+              if (sub->queue_.try_send (&payload, sizeof(void*))
+                  == result::ok)
+                {
+                  ++(*refs);
+                }
+              else
+                {
+                  ++(sub->dropped_);
+                }
+            }
+          // ----- Exit critical section --------------------------------------
+        }
+
+      return release (payload);
+    }
+
+    /**
+     * @details
+     * When the last reference is released, the block is
+     * returned to the pool.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    result_t
+    topic::release (void* payload)
+    {
+      os_assert_err(payload != nullptr, EINVAL);
+
+      std::size_t* refs = internal_refs_ (payload);
+      std::size_t left;
+
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          assert(*refs > 0);
+          left = --(*refs);
+          // ----- Exit critical section --------------------------------------
+        }
+
+      if (left == 0)
+        {
+          return pool_.free (refs);
+        }
+      return result::ok;
+    }
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @details
+     * The derived class links the subscriber to the topic, after
+     * the queue is constructed.
+     */
+    topic_subscriber_base::topic_subscriber_base (topic& tpc,
+                                                  message_queue& queue) :
+        topic_ (tpc), //
+        queue_ (queue)
+    {
+      ;
+    }
+
+    /**
+     * @details
+     * The derived class unlinks the subscriber, before the queue
+     * is destroyed.
+     */
+    topic_subscriber_base::~topic_subscriber_base ()
+    {
+      assert(!subscribed_);
+    }
+
+    /**
+     * @details
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    topic_subscriber_base::receive (void** payload)
+    {
+      os_assert_err(payload != nullptr, EINVAL);
+
+      return queue_.receive (payload, sizeof(void*));
+    }
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    result_t
+    topic_subscriber_base::try_receive (void** payload)
+    {
+      os_assert_err(payload != nullptr, EINVAL);
+
+      return queue_.try_receive (payload, sizeof(void*));
+    }
+
+    /**
+     * @details
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    topic_subscriber_base::timed_receive (void** payload,
+                                          clock::duration_t timeout)
+    {
+      os_assert_err(payload != nullptr, EINVAL);
+
+      return queue_.timed_receive (payload, sizeof(void*), timeout);
+    }
+
+    /**
+     * @cond ignore
+     */
+
+    /*
+     * New subscribers are added at the list head; the order
+     * in which they get the frames is not relevant.
+     */
+    void
+    topic_subscriber_base::internal_subscribe_ (void)
+    {
+      // ----- Enter critical section -----------------------------------------
+      interrupts::critical_section ics;
+
+      next_ = topic_.subscribers_list_;
+      topic_.subscribers_list_ = this;
+      ++(topic_.subscribers_count_);
+      subscribed_ = true;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    void
+    topic_subscriber_base::internal_unsubscribe_ (void)
+    {
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          topic_subscriber_base** link = &topic_.subscribers_list_;
+          while (*link != this)
+            {
+              assert(*link != nullptr);
+              link = &((*link)->next_);
+            }
+          *link = next_;
+          --(topic_.subscribers_count_);
+          subscribed_ = false;
+          // ----- Exit critical section --------------------------------------
+        }
+
+      // No new frames can arrive; release the pending ones.
+      void* payload;
+      while (queue_.try_receive (&payload, sizeof(void*)) == result::ok)
+        {
+          topic_.release (payload);
+        }
+    }
+
+    /**
+     * @endcond
+     */
+
+  // --------------------------------------------------------------------------
+
+  } /* namespace rtos */
+} /* namespace os */
@@ -0,0 +1,268 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/rtos/os.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    // ------------------------------------------------------------------------
+
+    static_assert((OS_INTEGER_RTOS_WAIT_ADDRESS_BUCKETS & (OS_INTEGER_RTOS_WAIT_ADDRESS_BUCKETS - 1)) == 0,
+        "OS_INTEGER_RTOS_WAIT_ADDRESS_BUCKETS must be a power of 2");
+
+    namespace
+    {
+      // The waiting node, with the address the thread waits on;
+      // the lists are shared by several addresses.
+      class address_node : public internal::waiting_thread_node
+      {
+      public:
+
+        address_node (thread& th, const volatile std::uint32_t* addr) :
+            waiting_thread_node (th), //
+            address (addr)
+        {
+          ;
+        }
+
+        const volatile std::uint32_t* address;
+      };
+
+      internal::waiting_threads_list address_lists[OS_INTEGER_RTOS_WAIT_ADDRESS_BUCKETS];
+
+      internal::waiting_threads_list&
+      address_list (const volatile std::uint32_t* addr)
+      {
+        // Words are aligned, skip the low bits.
+        std::uintptr_t h = reinterpret_cast<std::uintptr_t> (addr) >> 2;
+        return address_lists[(h ^ (h >> 5))
+            & (OS_INTEGER_RTOS_WAIT_ADDRESS_BUCKETS - 1)];
+      }
+
+      result_t
+      wait_address (const volatile std::uint32_t* addr, std::uint32_t expected,
+                    clock::timestamp_t timestamp, bool timed)
+      {
+        // Don't call this from interrupt handlers.
+        os_assert_err(!interrupts::in_handler_mode (), EPERM);
+        // Don't call this from critical regions.
+        os_assert_err(!scheduler::locked (), EPERM);
+
+        os_assert_err(addr != nullptr, EINVAL);
+
+        internal::waiting_threads_list& list = address_list (addr);
+
+        thread& crt_thread = this_thread::thread ();
+
+        // Prepare a list node pointing to the current thread.
+        // Do not worry for being on stack, it is temporarily linked to the
+        // list and guaranteed to be removed before this function returns.
+        address_node node
+          { crt_thread, addr };
+
+        internal::clock_timestamps_list& clock_list = sysclock.steady_list ();
+
+        // Prepare a timeout node pointing to the current thread.
+        internal::timeout_thread_node timeout_node
+          { timestamp, crt_thread };
+
+          {
+            // ----- Enter critical section -----------------------------------
+            interrupts::critical_section ics;
+
+            // Checked with the interrupts disabled; a change followed
+            // by a wake-up cannot be lost between the test and the link.
+            if (*addr != expected)
+              {
+                return EAGAIN;
+              }
+
+            if (timed)
+              {
+                scheduler::internal_link_node (list, node, clock_list,
+                                               timeout_node);
+              }
+            else
+              {
+                scheduler::internal_link_node (list, node);
+              }
+            // state::suspended set in above link().
+            // ----- Exit critical section ------------------------------------
+          }
+
+        port::scheduler::reschedule ();
+
+        // Remove the thread from the waiting list, if not already
+        // removed by the wake-up, and from the clock timeout list,
+        // if not already removed by the timer.
+        if (timed)
+          {
+            scheduler::internal_unlink_node (node, timeout_node);
+          }
+        else
+          {
+            scheduler::internal_unlink_node (node);
+          }
+
+        if (crt_thread.interrupted ())
+          {
+            return EINTR;
+          }
+
+        if (timed && (sysclock.steady_now () >= timestamp))
+          {
+            return ETIMEDOUT;
+          }
+
+        return result::ok;
+      }
+    } /* namespace */
+
+    /**
+     * @details
+     * If the word still has the expected value, the thread is
+     * suspended until another thread or an interrupt handler calls
+     * `wake_address()` for the same address; the test and the
+     * suspend are atomic, so an update of the word followed by a
+     * wake-up is never lost.
+     *
+     * This is the equivalent of the Linux `FUTEX_WAIT`, and can be
+     * used to build lock-free structures which sleep when they need
+     * to wait, without the overhead of a separate synchronisation
+     * object; there is no state other than the word itself.
+     *
+     * The thread may be woken up for other reasons, so the caller
+     * must check the word again, usually in a loop.
+     *
+     * @par Example
+     *
+     * @code{.cpp}
+     * std::uint32_t volatile ready;
+     *
+     * void
+     * consumer(void)
+     * {
+     *   while (__atomic_load_n (&ready, __ATOMIC_ACQUIRE) == 0)
+     *     {
+     *       wait_on_address (&ready, 0);
+     *     }
+     * }
+     *
+     * void
+     * producer(void)
+     * {
+     *   __atomic_store_n (&ready, 1, __ATOMIC_RELEASE);
+     *   wake_address_all (&ready);
+     * }
+     * @endcode
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    wait_on_address (const volatile std::uint32_t* addr,
+                     std::uint32_t expected)
+    {
+      return wait_address (addr, expected, 0, false);
+    }
+
+    /**
+     * @details
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    timed_wait_on_address (const volatile std::uint32_t* addr,
+                           std::uint32_t expected, clock::duration_t timeout)
+    {
+      return wait_address (addr, expected, sysclock.steady_now () + timeout,
+                           true);
+    }
+
+    /**
+     * @details
+     * Only the threads waiting on the given address are woken
+     * up, in the order of their priorities, even if other
+     * addresses share the same list.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    std::size_t
+    wake_address (const volatile std::uint32_t* addr, std::size_t n)
+    {
+      internal::waiting_threads_list& list = address_list (addr);
+
+      std::size_t count = 0;
+      while (count < n)
+        {
+          thread* th = nullptr;
+            {
+              // ----- Enter critical section ---------------------------------
+              interrupts::critical_section ics;
+
+              for (auto it = list.begin (); it != list.end (); ++it)
+                {
+                  address_node* node =
+                      static_cast<address_node*> (it.get_iterator_pointer ());
+                  if (node->address == addr)
+                    {
+                      th = node->thread_;
+                      node->unlink ();
+                      break;
+                    }
+                }
+              // ----- Exit critical section ----------------------------------
+            }
+
+          if (th == nullptr)
+            {
+              break;
+            }
+
+          th->resume ();
+          ++count;
+        }
+
+      return count;
+    }
+
+    /**
+     * @details
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    std::size_t
+    wake_address_all (const volatile std::uint32_t* addr)
+    {
+      return wake_address (addr, static_cast<std::size_t> (-1));
+    }
+
+  // --------------------------------------------------------------------------
+
+  } /* namespace rtos */
+} /* namespace os */
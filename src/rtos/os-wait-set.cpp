@@ -0,0 +1,493 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <cmsis-plus/rtos/os.h>
+
+#include <new>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace rtos
+  {
+    // ------------------------------------------------------------------------
+
+    /**
+     * @class wait_set
+     * @details
+     * The waiting thread links one node in the waiting list of
+     * each member, so any post, send or raise resumes it; after
+     * wake-up all nodes are unlinked and the members are checked
+     * again, in the order they were added.
+     *
+     * Members implemented by the port (like `OS_USE_RTOS_PORT_SEMAPHORE`)
+     * have no waiting list and cannot be added.
+     *
+     * @warning A semaphore or a message queue resumes only one
+     *  waiting thread; if the set is woken up but the caller does
+     *  not consume the ready member, other threads waiting on it
+     *  are resumed only by the next post or send.
+     */
+
+    /**
+     * @details
+     * The set is empty after construction.
+     */
+    wait_set::wait_set (const char* name) :
+        object_named_system
+          { name }
+    {
+#if defined(OS_TRACE_RTOS_WAIT_SET)
+      OS_TRACE_PRINTF (rtos_wait_set, "%s() @%p %s\n", __func__, this,
+                       this->name ());
+#endif
+    }
+
+    /**
+     * @details
+     * If the waiting thread was killed, the nodes it left
+     * in the members lists are removed here.
+     */
+    wait_set::~wait_set ()
+    {
+#if defined(OS_TRACE_RTOS_WAIT_SET)
+      OS_TRACE_PRINTF (rtos_wait_set, "%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      if (waiting_ != nullptr)
+        {
+          internal_unlink_nodes_ ();
+        }
+    }
+
+    /**
+     * @details
+     * The semaphore is ready when its value is positive.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    wait_set::add (semaphore& sem, std::size_t* index)
+    {
+#if defined(OS_TRACE_RTOS_WAIT_SET)
+      OS_TRACE_PRINTF (rtos_wait_set, "%s(%p) @%p %s\n", __func__, &sem, this,
+                       name ());
+#endif
+
+#if defined(OS_USE_RTOS_PORT_SEMAPHORE)
+      (void) sem;
+      (void) index;
+      return ENOTSUP;
+#else
+      return internal_add_ (kind::semaphore, &sem, &sem.list_, 0, 0, index);
+#endif
+    }
+
+    /**
+     * @details
+     * The message queue is ready when it has at least one message.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    wait_set::add (message_queue& mq, std::size_t* index)
+    {
+#if defined(OS_TRACE_RTOS_WAIT_SET)
+      OS_TRACE_PRINTF (rtos_wait_set, "%s(%p) @%p %s\n", __func__, &mq, this,
+                       name ());
+#endif
+
+#if defined(OS_USE_RTOS_PORT_MESSAGE_QUEUE)
+      (void) mq;
+      (void) index;
+      return ENOTSUP;
+#else
+      return internal_add_ (kind::message_queue, &mq, &mq.receive_list_, 0, 0,
+                            index);
+#endif
+    }
+
+    /**
+     * @details
+     * The event flags are ready when the flags in the mask are
+     * raised, as `event_flags::try_wait()` would find them;
+     * the flags are not cleared by the set.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    wait_set::add (event_flags& evf, flags::mask_t mask, flags::mode_t mode,
+                   std::size_t* index)
+    {
+#if defined(OS_TRACE_RTOS_WAIT_SET)
+      OS_TRACE_PRINTF (rtos_wait_set, "%s(%p, 0x%X) @%p %s\n", __func__, &evf,
+                       mask, this, name ());
+#endif
+
+#if defined(OS_USE_RTOS_PORT_EVENT_FLAGS)
+      (void) evf;
+      (void) mask;
+      (void) mode;
+      (void) index;
+      return ENOTSUP;
+#else
+      return internal_add_ (kind::event_flags, &evf, &evf.list_, mask,
+                            mode & ~flags::mode::clear, index);
+#endif
+    }
+
+    /**
+     * @details
+     * Members cannot be removed while a thread waits on the set.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+    result_t
+    wait_set::clear (void)
+    {
+#if defined(OS_TRACE_RTOS_WAIT_SET)
+      OS_TRACE_PRINTF (rtos_wait_set, "%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      // ----- Enter critical section -----------------------------------------
+      interrupts::critical_section ics;
+
+      if (waiting_ != nullptr)
+        {
+          return EBUSY;
+        }
+
+      size_ = 0;
+      return result::ok;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    /**
+     * @details
+     * Inspect the members without blocking and without consuming
+     * anything; the index of the first ready member is returned.
+     *
+     * @note Can be invoked from Interrupt Service Routines.
+     */
+    result_t
+    wait_set::try_wait (std::size_t* index)
+    {
+#if defined(OS_TRACE_RTOS_WAIT_SET)
+      OS_TRACE_PRINTF (rtos_wait_set, "%s() @%p %s\n", __func__, this, name ());
+#endif
+
+      if (size_ == 0)
+        {
+          return EINVAL;
+        }
+
+      // ----- Enter critical section -----------------------------------------
+      interrupts::critical_section ics;
+
+      if (internal_check_ (index))
+        {
+          return result::ok;
+        }
+
+      return EWOULDBLOCK;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    /**
+     * @fn result_t wait_set::wait (std::size_t* index)
+     * @details
+     * If no member is ready, the calling thread is linked to the
+     * waiting lists of all members and suspended, until one of them
+     * is posted, sent or raised, or the thread is interrupted.
+     *
+     * Only one thread at a time may wait on a set.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+
+    /**
+     * @fn result_t wait_set::timed_wait (clock::duration_t timeout, std::size_t* index)
+     * @details
+     * Similar to `wait()`, but the thread is also linked to the
+     * system clock timeout list; the timeout is expressed in
+     * system clock ticks, regardless of the clocks used by the members.
+     *
+     * @warning Cannot be invoked from Interrupt Service Routines.
+     */
+
+    /**
+     * @cond ignore
+     */
+
+    result_t
+    wait_set::internal_add_ (kind type, void* object,
+                             internal::waiting_threads_list* list,
+                             flags::mask_t mask, flags::mode_t mode,
+                             std::size_t* index)
+    {
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+
+      // ----- Enter critical section -----------------------------------------
+      interrupts::critical_section ics;
+
+      if (waiting_ != nullptr)
+        {
+          return EBUSY;
+        }
+
+      if (size_ >= max_size)
+        {
+          return ENOMEM;
+        }
+
+      member_t* m = &members_[size_];
+      m->object = object;
+      m->list = list;
+      m->mask = mask;
+      m->mode = mode;
+      m->type = type;
+
+      if (index != nullptr)
+        {
+          *index = size_;
+        }
+      ++size_;
+
+      return result::ok;
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    // Must be called in a critical section.
+    bool
+    wait_set::internal_check_ (std::size_t* index)
+    {
+      for (std::size_t i = 0; i < size_; ++i)
+        {
+          member_t* m = &members_[i];
+          bool ready = false;
+
+          switch (m->type)
+            {
+            case kind::semaphore:
+              ready = (static_cast<semaphore*> (m->object)->value () > 0);
+              break;
+
+            case kind::message_queue:
+              ready = !static_cast<message_queue*> (m->object)->empty ();
+              break;
+
+            case kind::event_flags:
+#if !defined(OS_USE_RTOS_PORT_EVENT_FLAGS)
+              ready =
+                  static_cast<event_flags*> (m->object)->event_flags_.check_raised (
+                      m->mask, nullptr, m->mode);
+#endif
+              break;
+            }
+
+          if (ready)
+            {
+              if (index != nullptr)
+                {
+                  *index = i;
+                }
+              return true;
+            }
+        }
+      return false;
+    }
+
+    void
+    wait_set::internal_unlink_nodes_ (void)
+    {
+      internal::waiting_thread_node* nodes =
+          reinterpret_cast<internal::waiting_thread_node*> (nodes_);
+
+      // ----- Enter critical section -----------------------------------------
+      interrupts::critical_section ics;
+
+      for (std::size_t i = 0; i < size_; ++i)
+        {
+          nodes[i].unlink ();
+        }
+      // ----- Exit critical section ------------------------------------------
+    }
+
+    result_t
+    wait_set::internal_wait_ (clock::duration_t timeout, bool timed,
+                              std::size_t* index)
+    {
+#if defined(OS_TRACE_RTOS_WAIT_SET)
+      OS_TRACE_PRINTF (rtos_wait_set, "%s(%u) @%p %s\n", __func__,
+                       static_cast<unsigned int> (timeout), this, name ());
+#endif
+
+      // Don't call this from interrupt handlers.
+      os_assert_err(!interrupts::in_handler_mode (), EPERM);
+      // Don't call this from critical regions.
+      os_assert_err(!scheduler::locked (), EPERM);
+
+      if (size_ == 0)
+        {
+          return EINVAL;
+        }
+
+      thread& crt_thread = this_thread::thread ();
+
+        {
+          // ----- Enter critical section -------------------------------------
+          interrupts::critical_section ics;
+
+          if (internal_check_ (index))
+            {
+              return result::ok;
+            }
+
+          if (waiting_ != nullptr)
+            {
+              return EBUSY;
+            }
+          waiting_ = &crt_thread;
+          // ----- Exit critical section --------------------------------------
+        }
+
+      // Prepare one node for each member; they live in the set,
+      // and the list of the first member also owns the thread
+      // `waiting_node_`.
+      internal::waiting_thread_node* nodes =
+          reinterpret_cast<internal::waiting_thread_node*> (nodes_);
+      for (std::size_t i = 0; i < size_; ++i)
+        {
+          new (&nodes[i]) internal::waiting_thread_node
+            { crt_thread };
+        }
+
+      internal::clock_timestamps_list& clock_list = sysclock.steady_list ();
+      clock::timestamp_t timeout_timestamp = sysclock.steady_now () + timeout;
+
+      // Prepare a timeout node pointing to the current thread.
+      internal::timeout_thread_node timeout_node
+        { timeout_timestamp, crt_thread };
+
+      result_t res;
+      for (;;)
+        {
+            {
+              // ----- Enter critical section ---------------------------------
+              interrupts::critical_section ics;
+
+              if (internal_check_ (index))
+                {
+                  res = result::ok;
+                  break;
+                }
+
+              if (timed)
+                {
+                  scheduler::internal_link_node (*members_[0].list, nodes[0],
+                                                 clock_list, timeout_node);
+                }
+              else
+                {
+                  scheduler::internal_link_node (*members_[0].list, nodes[0]);
+                }
+              // state::suspended set in above link().
+
+              for (std::size_t i = 1; i < size_; ++i)
+                {
+                  members_[i].list->link (nodes[i]);
+                }
+              // ----- Exit critical section ----------------------------------
+            }
+
+          port::scheduler::reschedule ();
+
+          // Remove the thread from all waiting lists, if not already
+          // removed by the member that resumed it, and from the clock
+          // timeout list, if not already removed by the timer.
+          internal_unlink_nodes_ ();
+          if (timed)
+            {
+              scheduler::internal_unlink_node (nodes[0], timeout_node);
+            }
+          else
+            {
+              scheduler::internal_unlink_node (nodes[0]);
+            }
+
+          if (crt_thread.interrupted ())
+            {
+#if defined(OS_TRACE_RTOS_WAIT_SET)
+              OS_TRACE_PRINTF (rtos_wait_set, "%s() EINTR @%p %s\n", __func__,
+                               this, name ());
+#endif
+              res = EINTR;
+              break;
+            }
+
+          if (timed && sysclock.steady_now () >= timeout_timestamp)
+            {
+              // ----- Enter critical section ---------------------------------
+              interrupts::critical_section ics;
+
+              // A member may have become ready at the same time.
+              if (internal_check_ (index))
+                {
+                  res = result::ok;
+                  break;
+                }
+
+#if defined(OS_TRACE_RTOS_WAIT_SET)
+              OS_TRACE_PRINTF (rtos_wait_set, "%s() ETIMEDOUT @%p %s\n",
+                               __func__, this, name ());
+#endif
+              res = ETIMEDOUT;
+              break;
+              // ----- Exit critical section ----------------------------------
+            }
+        }
+
+      for (std::size_t i = 0; i < size_; ++i)
+        {
+          nodes[i].~waiting_thread_node ();
+        }
+      waiting_ = nullptr;
+
+      return res;
+    }
+
+    /**
+     * @endcond
+     */
+
+  // --------------------------------------------------------------------------
+
+  } /* namespace rtos */
+} /* namespace os */
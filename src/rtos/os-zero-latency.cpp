@@ -0,0 +1,264 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/rtos/os.h>
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_INCLUDE_RTOS_ZERO_LATENCY_INTERRUPTS)
+
+using namespace os;
+using namespace os::rtos;
+
+// ----------------------------------------------------------------------------
+
+/**
+ * @details
+ * The default does nothing, the pending signals are delivered
+ * by the system tick.
+ */
+void
+__attribute__((weak))
+os_rtos_zero_latency_pend_hook (void)
+{
+}
+
+/**
+ * @details
+ * Call it from the handler of the kernel aware interrupt
+ * requested by `os_rtos_zero_latency_pend_hook()`.
+ */
+void
+os_rtos_zero_latency_drain_handler (void)
+{
+  zero_latency::internal_drain_ ();
+}
+
+/**
+ * @cond ignore
+ */
+
+namespace
+{
+  enum class kind_t : uint8_t
+  {
+    none = 0, //
+    semaphore, //
+    event_flags, //
+    thread_flags, //
+    function
+  };
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+  struct binding_t
+  {
+    void* object;
+    void* args;
+    flags::mask_t mask;
+    kind_t kind;
+  };
+
+#pragma GCC diagnostic pop
+
+  binding_t bindings[zero_latency::signals];
+
+  result_t
+  bind (zero_latency::signal_t sig, kind_t kind, void* object,
+        flags::mask_t mask, void* args)
+  {
+    os_assert_err(!interrupts::in_handler_mode (), EPERM);
+    os_assert_err(sig < zero_latency::signals, EINVAL);
+
+    // ----- Enter critical section -------------------------------------------
+    interrupts::critical_section ics;
+
+    binding_t* b = &bindings[sig];
+    b->object = object;
+    b->args = args;
+    b->mask = mask;
+    b->kind = kind;
+
+    return result::ok;
+    // ----- Exit critical section --------------------------------------------
+  }
+}
+
+/**
+ * @endcond
+ */
+
+namespace os
+{
+  namespace rtos
+  {
+    namespace zero_latency
+    {
+      /**
+       * @cond ignore
+       */
+
+      uint32_t volatile pending_;
+      uint32_t merged_;
+
+      /**
+       * @endcond
+       */
+
+      result_t
+      bind (signal_t sig, semaphore& sem)
+      {
+        return ::bind (sig, kind_t::semaphore, &sem, 0, nullptr);
+      }
+
+      result_t
+      bind (signal_t sig, event_flags& evf, flags::mask_t mask)
+      {
+        os_assert_err(mask != 0, EINVAL);
+
+        return ::bind (sig, kind_t::event_flags, &evf, mask, nullptr);
+      }
+
+      result_t
+      bind (signal_t sig, thread& th, flags::mask_t mask)
+      {
+        os_assert_err(mask != 0, EINVAL);
+
+        return ::bind (sig, kind_t::thread_flags, &th, mask, nullptr);
+      }
+
+      result_t
+      bind (signal_t sig, func_t func, void* args)
+      {
+        os_assert_err(func != nullptr, EINVAL);
+
+        return ::bind (sig, kind_t::function, reinterpret_cast<void*> (func),
+                       0, args);
+      }
+
+      /**
+       * @details
+       * The bit is also cleared from the pending word, so an
+       * object about to be destroyed is not signalled later.
+       */
+      result_t
+      unbind (signal_t sig)
+      {
+        os_assert_err(!interrupts::in_handler_mode (), EPERM);
+        os_assert_err(sig < signals, EINVAL);
+
+        // ----- Enter critical section ---------------------------------------
+        interrupts::critical_section ics;
+
+        __atomic_fetch_and (&pending_, ~(static_cast<uint32_t> (1) << sig),
+                            __ATOMIC_RELAXED);
+        bindings[sig].kind = kind_t::none;
+
+        return result::ok;
+        // ----- Exit critical section ----------------------------------------
+      }
+
+      /**
+       * @details
+       * Since the pending word holds a single bit per signal,
+       * a raise while the signal is still pending is merged with
+       * the previous one; the count helps dimensioning the drain
+       * interrupt priority.
+       */
+      uint32_t
+      merged (void)
+      {
+        return __atomic_load_n (&merged_, __ATOMIC_RELAXED);
+      }
+
+      /**
+       * @cond ignore
+       */
+
+      /**
+       * @details
+       * The pending word is taken at once with an atomic exchange,
+       * so the zero latency interrupts may continue to raise signals,
+       * for the next drain. The bindings are read inside a kernel
+       * critical section, which does not mask the signalling
+       * interrupts.
+       */
+      void
+      internal_drain_ (void)
+      {
+        uint32_t pending = __atomic_exchange_n (&pending_, 0,
+                                                __ATOMIC_ACQUIRE);
+        while (pending != 0)
+          {
+            signal_t sig = static_cast<signal_t> (__builtin_ctz (pending));
+            pending &= pending - 1;
+
+            binding_t b;
+              {
+                // ----- Enter critical section -------------------------------
+                interrupts::critical_section ics;
+
+                b = bindings[sig];
+                // ----- Exit critical section --------------------------------
+              }
+
+            switch (b.kind)
+              {
+              case kind_t::semaphore:
+                static_cast<semaphore*> (b.object)->post ();
+                break;
+
+              case kind_t::event_flags:
+                static_cast<event_flags*> (b.object)->raise (b.mask);
+                break;
+
+              case kind_t::thread_flags:
+                static_cast<thread*> (b.object)->flags_raise (b.mask);
+                break;
+
+              case kind_t::function:
+                reinterpret_cast<func_t> (b.object) (b.args);
+                break;
+
+              default:
+                break;
+              }
+          }
+      }
+
+      /**
+       * @endcond
+       */
+
+    } /* namespace zero_latency */
+  } /* namespace rtos */
+} /* namespace os */
+
+#endif /* defined(OS_INCLUDE_RTOS_ZERO_LATENCY_INTERRUPTS) */
+
+// ----------------------------------------------------------------------------
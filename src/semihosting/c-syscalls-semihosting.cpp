@@ -41,6 +41,7 @@
 
 #include <cmsis-plus/posix/dirent.h>
 #include <cmsis-plus/posix/sys/socket.h>
+#include <cmsis-plus/posix/sys/uio.h>
 
 #include "cmsis_device.h"
 
@@ -81,14 +82,45 @@
 
 // ----------------------------------------------------------------------------
 
+#if defined(OS_USE_SEMIHOSTING_SYSCALLS_BUFFERED)
+
+// Each semihosting call halts the core, so, for host files, small
+// writes are collected in a per file buffer and small reads are
+// served from a read-ahead in the same buffer; the terminal is
+// not buffered.
+
+#if !defined(OS_INTEGER_SEMIHOSTING_BUFFER_SIZE)
+#define OS_INTEGER_SEMIHOSTING_BUFFER_SIZE (256)
+#endif
+
+static_assert(OS_INTEGER_SEMIHOSTING_BUFFER_SIZE > 0,
+    "The buffer is too small");
+
+#endif /* defined(OS_USE_SEMIHOSTING_SYSCALLS_BUFFERED) */
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
 // Struct used to keep track of the file position, just so we
 // can implement fseek(fh,x,SEEK_CUR).
 struct fdent
 {
   int handle;
+  // The position seen by the application.
   int pos;
+#if defined(OS_USE_SEMIHOSTING_SYSCALLS_BUFFERED)
+  // Bytes in the buffer and, for read-ahead, bytes already consumed.
+  int len;
+  int off;
+  bool tty;
+  // The buffer holds read-ahead bytes, otherwise pending writes.
+  bool reading;
+  char buffer[OS_INTEGER_SEMIHOSTING_BUFFER_SIZE];
+#endif /* defined(OS_USE_SEMIHOSTING_SYSCALLS_BUFFERED) */
 };
 
+#pragma GCC diagnostic pop
+
 /*
  *  User file descriptors (fd) are integer indexes into
  * the openfiles[] array. Error checking is done by using
@@ -158,6 +190,21 @@ __semihosting_newslot (void)
   return i;
 }
 
+// Initialise the entry; the host handle must be already set.
+static void
+__semihosting_initslot (struct fdent* pfd, bool tty)
+{
+  pfd->pos = 0;
+#if defined(OS_USE_SEMIHOSTING_SYSCALLS_BUFFERED)
+  pfd->len = 0;
+  pfd->off = 0;
+  pfd->tty = tty;
+  pfd->reading = false;
+#else
+  (void) tty;
+#endif /* defined(OS_USE_SEMIHOSTING_SYSCALLS_BUFFERED) */
+}
+
 static int
 __semihosting_get_errno (void)
 {
@@ -184,6 +231,186 @@ __semihosting_checkerror (int result)
   return result;
 }
 
+// Single SYS_READ or SYS_WRITE call.
+// Translates the return into bytes transferred, or -1.
+static int
+__semihosting_transfer (int reason, int handle, const void* buf,
+                        size_t nbyte)
+{
+  int block[3];
+  block[0] = handle;
+  block[1] = (int) buf;
+  block[2] = nbyte;
+
+  // Returns the number of bytes *not* transferred.
+  int res;
+  res = __semihosting_checkerror (call_host (reason, block));
+  if (res < 0)
+    {
+      return -1;
+    }
+
+  return nbyte - res;
+}
+
+#if defined(OS_USE_SEMIHOSTING_SYSCALLS_BUFFERED)
+
+// Send the pending writes, or drop the read-ahead and bring the
+// host position back to the one seen by the application.
+// Errors of the deferred writes are reported here.
+static int
+__semihosting_flush (struct fdent* pfd)
+{
+  int len = pfd->len;
+  int off = pfd->off;
+
+  pfd->len = 0;
+  pfd->off = 0;
+
+  if (pfd->reading)
+    {
+      pfd->reading = false;
+      if (off < len)
+        {
+          int block[2];
+          block[0] = pfd->handle;
+          block[1] = pfd->pos;
+          if (__semihosting_checkerror (
+              call_host (SEMIHOSTING_SYS_SEEK, block)) < 0)
+            {
+              return -1;
+            }
+        }
+      return 0;
+    }
+
+  if (len == 0)
+    {
+      return 0;
+    }
+
+  int res = __semihosting_transfer (SEMIHOSTING_SYS_WRITE, pfd->handle,
+                                    pfd->buffer, len);
+  if (res < 0)
+    {
+      return -1;
+    }
+  else if (res != len)
+    {
+      // The application was told that the bytes were written.
+      errno = ENOSPC;
+      return -1;
+    }
+
+  return 0;
+}
+
+static void
+__semihosting_flush_all (void)
+{
+  for (int i = 0; i < OS_INTEGER_SEMIHOSTING_MAX_OPEN_FILES; i++)
+    {
+      if (openfiles[i].handle != -1)
+        {
+          __semihosting_flush (&openfiles[i]);
+        }
+    }
+}
+
+// Serve the request from the read-ahead; refill it with a single
+// host call, or, for large requests, read directly in the
+// user buffer. May return less than requested.
+static ssize_t
+__semihosting_buffered_read (struct fdent* pfd, void* buf, size_t nbyte)
+{
+  if (!pfd->reading && pfd->len > 0)
+    {
+      if (__semihosting_flush (pfd) < 0)
+        {
+          return -1;
+        }
+    }
+
+  if (!pfd->reading || pfd->off == pfd->len)
+    {
+      pfd->reading = false;
+      pfd->len = 0;
+      pfd->off = 0;
+
+      if (nbyte >= OS_INTEGER_SEMIHOSTING_BUFFER_SIZE)
+        {
+          int res = __semihosting_transfer (SEMIHOSTING_SYS_READ,
+                                            pfd->handle, buf, nbyte);
+          if (res < 0)
+            {
+              return -1;
+            }
+          pfd->pos += res;
+          return res;
+        }
+
+      int res = __semihosting_transfer (SEMIHOSTING_SYS_READ, pfd->handle,
+                                        pfd->buffer,
+                                        sizeof(pfd->buffer));
+      if (res < 0)
+        {
+          return -1;
+        }
+      pfd->reading = true;
+      pfd->len = res;
+    }
+
+  size_t n = pfd->len - pfd->off;
+  if (n > nbyte)
+    {
+      n = nbyte;
+    }
+  std::memcpy (buf, pfd->buffer + pfd->off, n);
+  pfd->off += n;
+  pfd->pos += n;
+
+  return n;
+}
+
+// Collect small writes in the buffer; send large ones directly,
+// after the pending bytes.
+static ssize_t
+__semihosting_buffered_write (struct fdent* pfd, const void* buf,
+                              size_t nbyte)
+{
+  if (pfd->reading || (pfd->len + nbyte > sizeof(pfd->buffer)))
+    {
+      if (__semihosting_flush (pfd) < 0)
+        {
+          return -1;
+        }
+    }
+
+  if (nbyte >= sizeof(pfd->buffer))
+    {
+      int res = __semihosting_transfer (SEMIHOSTING_SYS_WRITE, pfd->handle,
+                                        buf, nbyte);
+      if (res < 0)
+        {
+          return -1;
+        }
+      pfd->pos += res;
+      if (res == 0)
+        {
+          return __semihosting_error (0);
+        }
+      return res;
+    }
+
+  std::memcpy (pfd->buffer + pfd->len, buf, nbyte);
+  pfd->len += nbyte;
+  pfd->pos += nbyte;
+
+  return nbyte;
+}
+
+#endif /* defined(OS_USE_SEMIHOSTING_SYSCALLS_BUFFERED) */
+
 /* fd, is a user file descriptor. */
 static int
 __semihosting_lseek (int fd, int ptr, int dir)
@@ -205,6 +432,19 @@ __semihosting_lseek (int fd, int ptr, int dir)
       return -1;
     }
 
+  /* ftell() does not need the host. */
+  if ((dir == SEEK_CUR) && (ptr == 0))
+    {
+      return pfd->pos;
+    }
+
+#if defined(OS_USE_SEMIHOSTING_SYSCALLS_BUFFERED)
+  if (__semihosting_flush (pfd) < 0)
+    {
+      return -1;
+    }
+#endif /* defined(OS_USE_SEMIHOSTING_SYSCALLS_BUFFERED) */
+
   /* Convert SEEK_CUR to SEEK_SET */
   if (dir == SEEK_CUR)
     {
@@ -269,6 +509,14 @@ __semihosting_stat (int fd, struct stat* st)
   st->st_mode |= S_IFCHR;
   st->st_blksize = 1024;
 
+#if defined(OS_USE_SEMIHOSTING_SYSCALLS_BUFFERED)
+  // The pending writes may extend the file.
+  if (__semihosting_flush (pfd) < 0)
+    {
+      return -1;
+    }
+#endif /* defined(OS_USE_SEMIHOSTING_SYSCALLS_BUFFERED) */
+
   int res;
   res = __semihosting_checkerror (
       call_host (SEMIHOSTING_SYS_FLEN, &pfd->handle));
@@ -358,7 +606,11 @@ __posix_open (const char* path, int oflag, ...)
   if (fh >= 0)
     {
       openfiles[fd].handle = fh;
-      openfiles[fd].pos = 0;
+      bool tty = false;
+#if defined(OS_USE_SEMIHOSTING_SYSCALLS_BUFFERED)
+      tty = (call_host (SEMIHOSTING_SYS_ISTTY, &fh) == 1);
+#endif /* defined(OS_USE_SEMIHOSTING_SYSCALLS_BUFFERED) */
+      __semihosting_initslot (&openfiles[fd], tty);
       return fd;
     }
   else
@@ -386,6 +638,11 @@ __posix_close (int fildes)
       return 0;
     }
 
+  int flushed = 0;
+#if defined(OS_USE_SEMIHOSTING_SYSCALLS_BUFFERED)
+  flushed = __semihosting_flush (pfd);
+#endif /* defined(OS_USE_SEMIHOSTING_SYSCALLS_BUFFERED) */
+
   int block[1];
   block[0] = pfd->handle;
 
@@ -399,6 +656,10 @@ __posix_close (int fildes)
       pfd->handle = -1;
     }
 
+  if (flushed < 0)
+    {
+      return -1;
+    }
   return res;
 }
 
@@ -419,24 +680,26 @@ __posix_read (int fildes, void* buf, size_t nbyte)
       return -1;
     }
 
-  int block[3];
-  block[0] = pfd->handle;
-  block[1] = (int) buf;
-  block[2] = nbyte;
+#if defined(OS_USE_SEMIHOSTING_SYSCALLS_BUFFERED)
+  if (!pfd->tty)
+    {
+      return __semihosting_buffered_read (pfd, buf, nbyte);
+    }
+#endif /* defined(OS_USE_SEMIHOSTING_SYSCALLS_BUFFERED) */
 
   int res;
-  // Returns the number of bytes *not* written.
-  res = __semihosting_checkerror (call_host (SEMIHOSTING_SYS_READ, block));
+  res = __semihosting_transfer (SEMIHOSTING_SYS_READ, pfd->handle, buf,
+                                nbyte);
   if (res == -1)
     {
       return res;
     }
 
-  pfd->pos += nbyte - res;
+  pfd->pos += res;
 
-  /* res == nbyte is not an error,
+  /* res == 0 is not an error,
    at least if we want feof() to work.  */
-  return nbyte - res;
+  return res;
 }
 
 ssize_t
@@ -450,31 +713,104 @@ __posix_write (int fildes, const void* buf, size_t nbyte)
       return -1;
     }
 
-  int block[3];
-
-  block[0] = pfd->handle;
-  block[1] = (int) buf;
-  block[2] = nbyte;
+#if defined(OS_USE_SEMIHOSTING_SYSCALLS_BUFFERED)
+  if (!pfd->tty)
+    {
+      return __semihosting_buffered_write (pfd, buf, nbyte);
+    }
+#endif /* defined(OS_USE_SEMIHOSTING_SYSCALLS_BUFFERED) */
 
-  // Returns the number of bytes *not* written.
   int res;
-  res = __semihosting_checkerror (call_host (SEMIHOSTING_SYS_WRITE, block));
+  res = __semihosting_transfer (SEMIHOSTING_SYS_WRITE, pfd->handle, buf,
+                                nbyte);
   /* Clearly an error. */
   if (res < 0)
     {
       return -1;
     }
 
-  pfd->pos += nbyte - res;
+  pfd->pos += res;
 
   // Did we write 0 bytes?
   // Retrieve errno for just in case.
-  if ((nbyte - res) == 0)
+  if (res == 0)
     {
       return __semihosting_error (0);
     }
 
-  return (nbyte - res);
+  return res;
+}
+
+/**
+ * @details
+ * With @ref OS_USE_SEMIHOSTING_SYSCALLS_BUFFERED, the small
+ * elements are merged in the file buffer, and sent with a
+ * single host call.
+ */
+ssize_t
+__posix_writev (int fildes, const struct iovec* iov, int iovcnt)
+{
+  if (iov == nullptr)
+    {
+      errno = EFAULT;
+      return -1;
+    }
+
+  if (iovcnt <= 0)
+    {
+      errno = EINVAL;
+      return -1;
+    }
+
+  ssize_t total = 0;
+  for (int i = 0; i < iovcnt; ++i)
+    {
+      ssize_t res = __posix_write (fildes, iov[i].iov_base, iov[i].iov_len);
+      if (res < 0)
+        {
+          return (total > 0) ? total : -1;
+        }
+      total += res;
+      if (static_cast<size_t> (res) < iov[i].iov_len)
+        {
+          break;
+        }
+    }
+
+  return total;
+}
+
+ssize_t
+__posix_readv (int fildes, const struct iovec* iov, int iovcnt)
+{
+  if (iov == nullptr)
+    {
+      errno = EFAULT;
+      return -1;
+    }
+
+  if (iovcnt <= 0)
+    {
+      errno = EINVAL;
+      return -1;
+    }
+
+  ssize_t total = 0;
+  for (int i = 0; i < iovcnt; ++i)
+    {
+      ssize_t res = __posix_read (fildes, iov[i].iov_base, iov[i].iov_len);
+      if (res < 0)
+        {
+          return (total > 0) ? total : -1;
+        }
+      total += res;
+      if (static_cast<size_t> (res) < iov[i].iov_len)
+        {
+          break;
+        }
+    }
+
+  return total;
 }
 
 off_t
@@ -829,6 +1165,14 @@ __posix_recvmsg (int socket, struct msghdr* message, int flags)
   return -1;
 }
 
+int
+__posix_recvmmsg (int socket, struct mmsghdr* vmessages, unsigned int vlen,
+                  int flags, struct timespec* timeout)
+{
+  errno = ENOSYS; // Not implemented
+  return -1;
+}
+
 ssize_t
 __posix_send (int socket, const void* buffer, size_t length, int flags)
 {
@@ -843,6 +1187,14 @@ __posix_sendmsg (int socket, const struct msghdr* message, int flags)
   return -1;
 }
 
+int
+__posix_sendmmsg (int socket, struct mmsghdr* vmessages, unsigned int vlen,
+                  int flags)
+{
+  errno = ENOSYS; // Not implemented
+  return -1;
+}
+
 ssize_t
 __posix_sendto (int socket, const void* message, size_t length, int flags,
                 const struct sockaddr* dest_addr, socklen_t dest_len)
@@ -925,7 +1277,87 @@ __posix_chdir (const char* path)
 // Not available via semihosting.
 
 ssize_t
-__posix_writev (int fildes, const struct iovec* iov, int iovcnt)
+__posix_pread (int fildes, void* buf, size_t nbyte, off_t offset)
+{
+  errno = ENOSYS; // Not implemented
+  return -1;
+}
+
+ssize_t
+__posix_pwrite (int fildes, const void* buf, size_t nbyte, off_t offset)
+{
+  errno = ENOSYS; // Not implemented
+  return -1;
+}
+
+ssize_t
+__posix_preadv (int fildes, const struct iovec* iov, int iovcnt, off_t offset)
+{
+  errno = ENOSYS; // Not implemented
+  return -1;
+}
+
+ssize_t
+__posix_pwritev (int fildes, const struct iovec* iov, int iovcnt,
+                 off_t offset)
+{
+  errno = ENOSYS; // Not implemented
+  return -1;
+}
+
+void*
+__posix_mmap (void* addr, size_t len, int prot, int flags, int fildes,
+              off_t off)
+{
+  errno = ENOSYS; // Not implemented
+  return reinterpret_cast<void*> (-1); // MAP_FAILED
+}
+
+int
+__posix_munmap (void* addr, size_t len)
+{
+  errno = ENOSYS; // Not implemented
+  return -1;
+}
+
+int
+__posix_aio_read (struct aiocb* aiocbp)
+{
+  errno = ENOSYS; // Not implemented
+  return -1;
+}
+
+int
+__posix_aio_write (struct aiocb* aiocbp)
+{
+  errno = ENOSYS; // Not implemented
+  return -1;
+}
+
+int
+__posix_aio_error (const struct aiocb* aiocbp)
+{
+  errno = ENOSYS; // Not implemented
+  return -1;
+}
+
+ssize_t
+__posix_aio_return (struct aiocb* aiocbp)
+{
+  errno = ENOSYS; // Not implemented
+  return -1;
+}
+
+int
+__posix_aio_suspend (const struct aiocb* const list[], int nent,
+                     const struct timespec* timeout)
+{
+  errno = ENOSYS; // Not implemented
+  return -1;
+}
+
+int
+__posix_aio_cancel (int fildes, struct aiocb* aiocbp)
 {
   errno = ENOSYS; // Not implemented
   return -1;
@@ -952,11 +1384,30 @@ __posix_ftruncate (int fildes, off_t length)
   return -1;
 }
 
+int
+__posix_posix_fallocate (int fildes, off_t offset, off_t len)
+{
+  return ENOSYS; // Not implemented
+}
+
 int
 __posix_fsync (int fildes)
 {
+#if defined(OS_USE_SEMIHOSTING_SYSCALLS_BUFFERED)
+  struct fdent *pfd;
+  pfd = __semihosting_findslot (fildes);
+  if (pfd == NULL)
+    {
+      errno = EBADF;
+      return -1;
+    }
+
+  // The host has no sync, only send the pending writes.
+  return __semihosting_flush (pfd);
+#else
   errno = ENOSYS; // Not implemented
   return -1;
+#endif /* defined(OS_USE_SEMIHOSTING_SYSCALLS_BUFFERED) */
 }
 
 int
@@ -1123,6 +1574,10 @@ os_terminate (int code __attribute__((unused)))
    signum, so that the SWI handler can distinguish the two calls.
    Note: The RDI implementation of _kill throws away both its
    arguments.  */
+#if defined(OS_USE_SEMIHOSTING_SYSCALLS_BUFFERED)
+  __semihosting_flush_all ();
+#endif /* defined(OS_USE_SEMIHOSTING_SYSCALLS_BUFFERED) */
+
   report_exception (
       code == 0 ? ADP_Stopped_ApplicationExit : ADP_Stopped_RunTimeError);
   /* NOTREACHED */
@@ -1283,11 +1738,11 @@ initialise_monitor_handles (void)
     }
 
   openfiles[0].handle = monitor_stdin;
-  openfiles[0].pos = 0;
+  __semihosting_initslot (&openfiles[0], true);
   openfiles[1].handle = monitor_stdout;
-  openfiles[1].pos = 0;
+  __semihosting_initslot (&openfiles[1], true);
   openfiles[2].handle = monitor_stderr;
-  openfiles[2].pos = 0;
+  __semihosting_initslot (&openfiles[2], true);
 }
 
 // ----------------------------------------------------------------------------
@@ -31,6 +31,8 @@
 
 #include <cmsis-plus/rtos/os-hooks.h>
 #include <cmsis-plus/memory/first-fit-top.h>
+#include <cmsis-plus/memory/segregated-fit.h>
+#include <cmsis-plus/memory/tlsf.h>
 #include <cmsis-plus/memory/lifo.h>
 #include <cmsis-plus/memory/block-pool.h>
 #include <cmsis-plus/estd/memory_resource>
@@ -101,6 +101,24 @@ extern unsigned int __bss_regions_array_start;
 extern unsigned int __bss_regions_array_end;
 #endif
 
+#if defined(OS_INCLUDE_STARTUP_COMPRESSED_DATA)
+// Triplets of compressed image address, region begin and end
+// addresses; defined in the linker script, weak, since they are
+// optional.
+extern unsigned int __data_compressed_regions_array_start
+__attribute__((weak));
+extern unsigned int __data_compressed_regions_array_end
+__attribute__((weak));
+#endif /* defined(OS_INCLUDE_STARTUP_COMPRESSED_DATA) */
+
+#if defined(OS_INCLUDE_STARTUP_DEFERRED_BSS)
+// Pairs of begin/end addresses of the BSS regions cleared only
+// after the scheduler starts; defined in the linker script, weak,
+// since they are optional.
+extern unsigned int __bss_deferred_regions_array_start __attribute__((weak));
+extern unsigned int __bss_deferred_regions_array_end __attribute__((weak));
+#endif /* defined(OS_INCLUDE_STARTUP_DEFERRED_BSS) */
+
 extern unsigned int _Heap_Begin;
 extern unsigned long int _Heap_Limit;
 extern unsigned long int __stack;
@@ -134,14 +152,46 @@ os_run_fini_array (void);
 
 // ----------------------------------------------------------------------------
 
+// The large regions are copied and cleared in bursts, with multiple
+// register load/store instructions; ARMv7-M moves 8 words at a time,
+// ARMv6-M, limited to the low registers, 4 words.
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+#define OS_STARTUP_BURST_WORDS (8)
+#define OS_STARTUP_BURST_REGS "{r3, r4, r5, r6, r8, r9, r10, r11}"
+#define OS_STARTUP_BURST_CLOBBERS \
+  "r3", "r4", "r5", "r6", "r8", "r9", "r10", "r11"
+#elif defined(__ARM_ARCH_6M__)
+#define OS_STARTUP_BURST_WORDS (4)
+#define OS_STARTUP_BURST_REGS "{r3, r4, r5, r6}"
+#define OS_STARTUP_BURST_CLOBBERS "r3", "r4", "r5", "r6"
+#endif
+
 inline __attribute__((always_inline))
 void
 os_initialize_data (unsigned int* from, unsigned int* region_begin,
                     unsigned int* region_end)
 {
-  // Iterate and copy word by word.
   // It is assumed that the pointers are word aligned.
   unsigned int *p = region_begin;
+
+#if defined(OS_STARTUP_BURST_WORDS)
+  if (region_end - p >= OS_STARTUP_BURST_WORDS)
+    {
+      // The last address where a full burst fits.
+      unsigned int* last = region_end - OS_STARTUP_BURST_WORDS;
+      asm volatile (
+          "1: \n"
+          " ldmia %[from]!, " OS_STARTUP_BURST_REGS " \n"
+          " stmia %[to]!, " OS_STARTUP_BURST_REGS " \n"
+          " cmp %[to], %[last] \n"
+          " bls 1b \n"
+          : [from] "+l" (from), [to] "+l" (p)
+          : [last] "l" (last)
+          : OS_STARTUP_BURST_CLOBBERS, "cc", "memory");
+    }
+#endif /* defined(OS_STARTUP_BURST_WORDS) */
+
+  // Iterate and copy word by word the rest.
   while (p < region_end)
     {
       *p++ = *from++;
@@ -152,15 +202,128 @@ inline __attribute__((always_inline))
 void
 os_initialize_bss (unsigned int* region_begin, unsigned int* region_end)
 {
-  // Iterate and clear word by word.
   // It is assumed that the pointers are word aligned.
   unsigned int *p = region_begin;
+
+#if defined(OS_STARTUP_BURST_WORDS)
+  if (region_end - p >= OS_STARTUP_BURST_WORDS)
+    {
+      // The last address where a full burst fits.
+      unsigned int* last = region_end - OS_STARTUP_BURST_WORDS;
+      asm volatile (
+          " movs r3, #0 \n"
+          " movs r4, #0 \n"
+          " movs r5, #0 \n"
+          " movs r6, #0 \n"
+#if OS_STARTUP_BURST_WORDS == 8
+          " mov r8, r3 \n"
+          " mov r9, r3 \n"
+          " mov r10, r3 \n"
+          " mov r11, r3 \n"
+#endif
+          "1: \n"
+          " stmia %[to]!, " OS_STARTUP_BURST_REGS " \n"
+          " cmp %[to], %[last] \n"
+          " bls 1b \n"
+          : [to] "+l" (p)
+          : [last] "l" (last)
+          : OS_STARTUP_BURST_CLOBBERS, "cc", "memory");
+    }
+#endif /* defined(OS_STARTUP_BURST_WORDS) */
+
+  // Iterate and clear word by word the rest.
   while (p < region_end)
     {
       *p++ = 0;
     }
 }
 
+#if defined(OS_INCLUDE_STARTUP_COMPRESSED_DATA)
+
+// Decompress a raw LZ4 block (no frame, no size header) directly
+// into the region; the image ends when the region is full. The
+// image is trusted, it is produced by the post-link tool
+// (`scripts/lz4-data-image.py`) from the linked `.data` content.
+inline __attribute__((always_inline))
+void
+os_initialize_data_lz4 (const unsigned char* from, unsigned char* region_begin,
+                        unsigned char* region_end)
+{
+  const unsigned char* ip = from;
+  unsigned char* op = region_begin;
+
+  while (op < region_end)
+    {
+      unsigned int token = *ip++;
+
+      // Literals.
+      unsigned int len = token >> 4;
+      if (len == 15)
+        {
+          unsigned int b;
+          do
+            {
+              b = *ip++;
+              len += b;
+            }
+          while (b == 255);
+        }
+      for (; len > 0 && op < region_end; --len)
+        {
+          *op++ = *ip++;
+        }
+      if (op >= region_end)
+        {
+          break;
+        }
+
+      // Match, from the already decompressed output.
+      unsigned int offset = ip[0] | (ip[1] << 8);
+      ip += 2;
+      const unsigned char* match = op - offset;
+
+      len = token & 15;
+      if (len == 15)
+        {
+          unsigned int b;
+          do
+            {
+              b = *ip++;
+              len += b;
+            }
+          while (b == 255);
+        }
+      for (len += 4; len > 0 && op < region_end; --len)
+        {
+          *op++ = *match++;
+        }
+    }
+}
+
+#endif /* defined(OS_INCLUDE_STARTUP_COMPRESSED_DATA) */
+
+#if defined(OS_INCLUDE_STARTUP_DEFERRED_BSS)
+
+/**
+ * @details
+ * Called from the main thread, before `os_main()`; the regions
+ * must not be used by the static constructors or by the
+ * interrupt handlers enabled before.
+ */
+void
+os_startup_initialize_deferred_bss (void)
+{
+  for (unsigned int* p = &__bss_deferred_regions_array_start;
+      p < &__bss_deferred_regions_array_end;)
+    {
+      unsigned int* region_begin = (unsigned int*) (*p++);
+      unsigned int* region_end = (unsigned int*) (*p++);
+      os_initialize_bss (region_begin, region_end);
+    }
+}
+
+#endif /* defined(OS_INCLUDE_STARTUP_DEFERRED_BSS) */
+
 // These magic symbols are provided by the linker.
 extern void
 (*__preinit_array_start[]) (void) __attribute__((weak));
@@ -175,6 +338,15 @@ extern void
 extern void
 (*__fini_array_end[]) (void) __attribute__((weak));
 
+#if defined(OS_INCLUDE_STARTUP_DEFERRED_INIT_ARRAY)
+// The constructors with priorities from OS_STARTUP_DEFERRED_INIT_PRIORITY
+// up, collected by the linker script before the regular init array.
+extern void
+(*__init_array_deferred_start[]) (void) __attribute__((weak));
+extern void
+(*__init_array_deferred_end[]) (void) __attribute__((weak));
+#endif /* defined(OS_INCLUDE_STARTUP_DEFERRED_INIT_ARRAY) */
+
 // Iterate over all the preinit/init routines (mainly static constructors).
 inline __attribute__((always_inline))
 void
@@ -200,6 +372,35 @@ os_run_init_array (void)
     }
 }
 
+#if defined(OS_INCLUDE_STARTUP_DEFERRED_INIT_ARRAY)
+
+/**
+ * @details
+ * The deferred constructors are executed in the order set
+ * by their priorities, one on each call; by default, the idle
+ * thread calls this function on each iteration.
+ *
+ * Not reentrant; the RTOS calls it only from
+ * `os_startup_complete_deferred_init()` or from the idle thread,
+ * serialised by a mutex.
+ */
+bool
+os_startup_run_deferred_init (void)
+{
+  static int index;
+
+  int count = __init_array_deferred_end - __init_array_deferred_start;
+  if (index >= count)
+    {
+      return false;
+    }
+
+  __init_array_deferred_start[index++] ();
+  return true;
+}
+
+#endif /* defined(OS_INCLUDE_STARTUP_DEFERRED_INIT_ARRAY) */
+
 // Run all the cleanup routines (mainly static destructors).
 void
 os_run_fini_array (void)
@@ -303,6 +504,21 @@ _start (void)
 
 #endif
 
+#if defined(OS_INCLUDE_STARTUP_COMPRESSED_DATA)
+
+  // Decompress the data sections stored as LZ4 images.
+  for (unsigned int* p = &__data_compressed_regions_array_start;
+      p < &__data_compressed_regions_array_end;)
+    {
+      const unsigned char* from = (const unsigned char*) (*p++);
+      unsigned char* region_begin = (unsigned char*) (*p++);
+      unsigned char* region_end = (unsigned char*) (*p++);
+
+      os_initialize_data_lz4 (from, region_begin, region_end);
+    }
+
+#endif /* defined(OS_INCLUDE_STARTUP_COMPRESSED_DATA) */
+
 #if defined(DEBUG) && (OS_BOOL_STARTUP_GUARD_CHECKS)
 
   if ((__data_begin_guard != DATA_BEGIN_GUARD_VALUE)
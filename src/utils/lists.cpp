@@ -26,6 +26,7 @@
  */
 
 #include <cmsis-plus/utils/lists.h>
+#include <cmsis-plus/rtos/os-decls.h>
 
 #include <cmsis-plus/diag/trace.h>
 
@@ -57,12 +58,13 @@ namespace os
      * the links in the removed node are nullified.
      */
     void
+    OS_RTOS_HOT
     static_double_list_links::unlink (void)
     {
       // Check if not already unlinked.
       if (unlinked ())
         {
-          assert(prev_ == nullptr);
+          assert(prev () == nullptr);
 #if defined(OS_TRACE_UTILS_LISTS)
           trace::printf ("%s() %p nop\n", __func__, this);
 #endif
@@ -74,12 +76,14 @@ namespace os
 #endif
 
       // Make neighbours point to each other.
-      prev_->next_ = next_;
-      next_->prev_ = prev_;
+      static_double_list_links* p = prev ();
+      static_double_list_links* n = next ();
+      p->next (n);
+      n->prev (p);
 
       // Nullify both pointers in the unlinked node.
-      prev_ = nullptr;
-      next_ = nullptr;
+      prev (nullptr);
+      next (nullptr);
     }
 
     // ========================================================================
@@ -111,7 +115,30 @@ namespace os
       head_.prev (const_cast<static_double_list_links*> (&head_));
     }
 
+    /**
+     * @details
+     * Walk the list, in a time proportional to its length;
+     * must be called in a critical section.
+     */
+    std::size_t
+    static_double_list::length (void) const
+    {
+      if (empty ())
+        {
+          return 0;
+        }
+
+      std::size_t count = 0;
+      for (const static_double_list_links* p = head_.next (); p != &head_;
+          p = p->next ())
+        {
+          ++count;
+        }
+      return count;
+    }
+
     void
+    OS_RTOS_HOT
     static_double_list::insert_after (static_double_list_links& node,
                                       static_double_list_links* after)
     {
@@ -138,6 +165,79 @@ namespace os
       after->next (&node);
     }
 
+    /**
+     * @details
+     * The nodes are moved by relinking the ends of the two lists,
+     * preserving their order, in constant time; the other list
+     * is left empty.
+     *
+     * Must be called in a critical section, if the lists are
+     * shared with other threads or interrupts.
+     */
+    void
+    OS_RTOS_HOT
+    static_double_list::splice_all (static_double_list& other)
+    {
+      if (other.empty ())
+        {
+          return;
+        }
+
+      if (uninitialized ())
+        {
+          // If this is the first time, initialise the list to empty.
+          clear ();
+        }
+
+#if defined(OS_TRACE_UTILS_LISTS)
+      trace::printf ("%s() %p from %p\n", __func__, this, &other);
+#endif
+
+      splice_after (const_cast<static_double_list_links*> (tail ()),
+                    *other.head_.next (), *other.head_.prev ());
+    }
+
+    /**
+     * @details
+     * The range `[first, last]` must be linked in a list, with
+     * `first` before or equal to `last`; it is unlinked and
+     * linked again after `after`, in constant time, regardless
+     * of its length. `after` must be linked and not in the range.
+     *
+     * When the range is a whole list, its head is left linked
+     * to itself, as after `clear()`.
+     */
+    void
+    OS_RTOS_HOT
+    static_double_list::splice_after (static_double_list_links* after,
+                                      static_double_list_links& first,
+                                      static_double_list_links& last)
+    {
+#if defined(OS_TRACE_UTILS_LISTS)
+      trace::printf ("%s() %p-%p after %p\n", __func__, &first, &last,
+                     after);
+#endif
+
+      assert(after->next () != nullptr);
+      assert(first.prev () != nullptr);
+      assert(last.next () != nullptr);
+
+      // Make the range neighbours point to each other.
+      static_double_list_links* before = first.prev ();
+      static_double_list_links* beyond = last.next ();
+      before->next (beyond);
+      beyond->prev (before);
+
+      // Make the range point to its new neighbours.
+      static_double_list_links* next = after->next ();
+      first.prev (after);
+      last.next (next);
+
+      // Make the new neighbours point to the range.
+      next->prev (&last);
+      after->next (&first);
+    }
+
     // ========================================================================
 
     /**
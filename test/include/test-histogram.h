@@ -0,0 +1,70 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef TEST_HISTOGRAM_H_
+#define TEST_HISTOGRAM_H_
+
+#include <cstdint>
+
+// Log-linear histogram buckets, shared by the benchmarks.
+//
+// Values below 8 have their own bucket; above, each power of two
+// is split in 8 buckets, so the value reported for a bucket
+// (its lower bound) is within 12.5% of the actual value.
+
+namespace test_histogram
+{
+  constexpr unsigned int sub_buckets = 8;
+  constexpr unsigned int buckets = (32 - 2) * sub_buckets;
+
+  inline unsigned int
+  bucket_index (uint32_t cycles)
+  {
+    if (cycles < sub_buckets)
+      {
+        return cycles;
+      }
+    unsigned int msb = 31u - static_cast<unsigned int> (__builtin_clz (cycles));
+    unsigned int sub = (cycles >> (msb - 3)) & (sub_buckets - 1);
+    return (msb - 2) * sub_buckets + sub;
+  }
+
+  inline uint32_t
+  bucket_value (unsigned int index)
+  {
+    if (index < sub_buckets)
+      {
+        return index;
+      }
+    unsigned int msb = index / sub_buckets + 2;
+    unsigned int sub = index % sub_buckets;
+    return (sub_buckets + sub) << (msb - 3);
+  }
+} /* namespace test_histogram */
+
+#endif /* TEST_HISTOGRAM_H_ */
@@ -0,0 +1,295 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef TEST_LOCK_BENCH_H_
+#define TEST_LOCK_BENCH_H_
+
+// Lock throughput and latency benchmark, shared by the stress tests.
+//
+// A number of threads, with one or more priorities, acquire the same
+// synchronisation object, keep it for the given time, release it and
+// do the same amount of work outside. Each configuration runs for a
+// number of seconds and reports the operations per second and the
+// acquire latency (from the acquire call to its return) percentiles,
+// in high resolution clock cycles.
+//
+// The object is defined by the `Ops` class, with the static members:
+//
+//   static const char* label (void);
+//   static os::rtos::result_t acquire (os::rtos::clock::duration_t timeout);
+//   static void release (void);
+//
+// where a zero timeout means a blocking acquire.
+
+#include <cmsis-plus/rtos/os.h>
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+
+#include <test-histogram.h>
+
+namespace test_bench
+{
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+  template<typename Ops>
+    class lock_bench
+    {
+    public:
+
+      int
+      run (unsigned int seconds);
+
+    private:
+
+      struct config
+      {
+        unsigned int threads;
+        unsigned int priorities;
+        unsigned int hold_micros;
+        os::rtos::clock::duration_t timeout;
+      };
+
+      static void
+      busy_wait (unsigned int micros);
+
+      static void*
+      worker (void* args);
+
+      void
+      record (uint32_t cycles, bool timed_out);
+
+      uint32_t
+      percentile (unsigned int percent);
+
+      void
+      run_config (unsigned int seconds);
+
+      static constexpr unsigned int max_threads = 64;
+      static constexpr std::size_t stack_size_bytes = 1024;
+
+      config config_;
+      volatile bool stop_;
+
+      // Updated in interrupts critical sections, by all threads.
+      uint32_t histogram_[test_histogram::buckets];
+      uint32_t ops_;
+      uint32_t timeouts_count_;
+      uint32_t max_latency_;
+    };
+
+#pragma GCC diagnostic pop
+
+  // --------------------------------------------------------------------------
+
+  template<typename Ops>
+    void
+    lock_bench<Ops>::busy_wait (unsigned int micros)
+    {
+      using namespace os::rtos;
+
+      clock::timestamp_t until_cycles = hrclock.now ()
+          + hrclock.input_clock_frequency_hz () * micros / 1000000;
+
+      while (hrclock.now () < until_cycles)
+        {
+          ;
+        }
+    }
+
+  template<typename Ops>
+    void
+    lock_bench<Ops>::record (uint32_t cycles, bool timed_out)
+    {
+      using namespace os::rtos;
+
+      // ----- Enter critical section -----------------------------------------
+      interrupts::critical_section ics;
+
+      if (timed_out)
+        {
+          ++timeouts_count_;
+          return;
+        }
+      ++histogram_[test_histogram::bucket_index (cycles)];
+      ++ops_;
+      if (cycles > max_latency_)
+        {
+          max_latency_ = cycles;
+        }
+      // ----- Exit critical section ------------------------------------------
+    }
+
+  template<typename Ops>
+    uint32_t
+    lock_bench<Ops>::percentile (unsigned int percent)
+    {
+      uint32_t target = static_cast<uint32_t> ((static_cast<uint64_t> (ops_)
+          * percent + 99) / 100);
+      uint32_t sum = 0;
+      for (unsigned int i = 0; i < test_histogram::buckets; ++i)
+        {
+          sum += histogram_[i];
+          if (sum >= target)
+            {
+              return test_histogram::bucket_value (i);
+            }
+        }
+      return max_latency_;
+    }
+
+  template<typename Ops>
+    void*
+    lock_bench<Ops>::worker (void* args)
+    {
+      using namespace os::rtos;
+
+      lock_bench* self = static_cast<lock_bench*> (args);
+
+      while (!self->stop_)
+        {
+          clock::timestamp_t begin = hrclock.now ();
+          result_t res = Ops::acquire (self->config_.timeout);
+          uint32_t latency = static_cast<uint32_t> (hrclock.now () - begin);
+
+          if (res == result::ok)
+            {
+              // simulate the work done while holding the object
+              busy_wait (self->config_.hold_micros);
+              Ops::release ();
+            }
+          self->record (latency, res != result::ok);
+
+          // the same work outside, then let the other threads
+          // with the same priority run
+          busy_wait (self->config_.hold_micros);
+          this_thread::yield ();
+        }
+      return nullptr;
+    }
+
+  template<typename Ops>
+    void
+    lock_bench<Ops>::run_config (unsigned int seconds)
+    {
+      using namespace os::rtos;
+
+      memset (histogram_, 0, sizeof(histogram_));
+      ops_ = 0;
+      timeouts_count_ = 0;
+      max_latency_ = 0;
+      stop_ = false;
+
+      thread* threads[max_threads];
+
+      // Start all threads at once, after the main thread sleeps.
+      thread::priority_t prio = this_thread::thread ().priority ();
+      this_thread::thread ().priority (thread::priority::high);
+
+      for (unsigned int i = 0; i < config_.threads; ++i)
+        {
+          thread::attributes attr;
+          attr.th_stack_size_bytes = stack_size_bytes;
+          attr.th_priority = static_cast<thread::priority_t> (
+              thread::priority::normal + (i % config_.priorities));
+          threads[i] = new thread
+            { "bench", worker, this, attr };
+        }
+
+      sysclock.sleep_for (seconds * clock_systick::frequency_hz);
+      stop_ = true;
+
+      for (unsigned int i = 0; i < config_.threads; ++i)
+        {
+          threads[i]->join ();
+          delete threads[i];
+        }
+
+      this_thread::thread ().priority (prio);
+
+      printf ("%s threads=%u prios=%u hold=%uus timeout=%u: "
+              "%u ops/s, %u timeouts, "
+              "latency p50=%u p90=%u p99=%u max=%u cycles\n",
+              Ops::label (), config_.threads, config_.priorities,
+              config_.hold_micros,
+              static_cast<unsigned int> (config_.timeout),
+              static_cast<unsigned int> (ops_ / seconds),
+              static_cast<unsigned int> (timeouts_count_),
+              static_cast<unsigned int> (percentile (50)),
+              static_cast<unsigned int> (percentile (90)),
+              static_cast<unsigned int> (percentile (99)),
+              static_cast<unsigned int> (max_latency_));
+    }
+
+  template<typename Ops>
+    int
+    lock_bench<Ops>::run (unsigned int seconds)
+    {
+      using namespace os::rtos;
+
+      static constexpr unsigned int thread_counts[] =
+        { 4, 8, 16, 32, 64 };
+      static constexpr unsigned int priority_mixes[] =
+        { 1, 4 };
+      static constexpr unsigned int hold_micros[] =
+        { 10, 100 };
+      // 0 for a blocking acquire, otherwise the timeout, in ticks.
+      static constexpr clock::duration_t timeouts[] =
+        { 0, 100 };
+
+      printf ("Clock %u Hz\n",
+              static_cast<unsigned int> (hrclock.input_clock_frequency_hz ()));
+
+      for (unsigned int threads : thread_counts)
+        {
+          for (unsigned int priorities : priority_mixes)
+            {
+              for (unsigned int hold : hold_micros)
+                {
+                  for (clock::duration_t timeout : timeouts)
+                    {
+                      config_.threads = threads;
+                      config_.priorities = priorities;
+                      config_.hold_micros = hold;
+                      config_.timeout = timeout;
+
+                      run_config (seconds);
+                    }
+                }
+            }
+        }
+
+      puts ("Done.");
+      return 0;
+    }
+
+} /* namespace test_bench */
+
+#endif /* TEST_LOCK_BENCH_H_ */
@@ -0,0 +1,198 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+// Compare the os_libc_ memory functions, from src/libc/string,
+// with the toolchain ones (newlib-nano).
+// Build without OS_INCLUDE_LIBC_OPTIMISED_MEMORY_FUNCTIONS,
+// otherwise memcpy() & co. are the same functions.
+
+#include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/diag/trace.h>
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+
+using namespace os;
+using namespace os::rtos;
+
+#if defined(__ARM_EABI__)
+
+extern "C"
+{
+  void*
+  os_libc_memcpy (void* dst, const void* src, std::size_t n);
+
+  void*
+  os_libc_memmove (void* dst, const void* src, std::size_t n);
+
+  void*
+  os_libc_memset (void* dst, int c, std::size_t n);
+}
+
+namespace
+{
+  constexpr std::size_t sizes[] =
+    { 4, 16, 64, 256, 1024 };
+
+  constexpr unsigned int iterations = 100;
+
+  // Room for the largest size and the misalignment.
+  alignas(8) uint8_t src_buf[1024 + 8];
+  alignas(8) uint8_t dst_buf[1024 + 8];
+
+  // Through volatile pointers, to prevent the compiler from
+  // inlining the calls for the known sizes.
+  typedef void*
+  (*copy_func_t) (void* dst, const void* src, std::size_t n);
+
+  typedef void*
+  (*set_func_t) (void* dst, int c, std::size_t n);
+
+  copy_func_t volatile lib_memcpy = &memcpy;
+  copy_func_t volatile os_memcpy = &os_libc_memcpy;
+  copy_func_t volatile lib_memmove = &memmove;
+  copy_func_t volatile os_memmove = &os_libc_memmove;
+  set_func_t volatile lib_memset = &memset;
+  set_func_t volatile os_memset = &os_libc_memset;
+
+  // Return the average cycles of a copy.
+  uint32_t
+  measure_copy (copy_func_t func, std::size_t dst_offset,
+                std::size_t src_offset, std::size_t n)
+  {
+    // Prevent the other threads from running during the measurement.
+    scheduler::critical_section scs;
+
+    clock::timestamp_t begin = hrclock.now ();
+    for (unsigned int i = 0; i < iterations; ++i)
+      {
+        func (dst_buf + dst_offset, src_buf + src_offset, n);
+      }
+    return static_cast<uint32_t> ((hrclock.now () - begin) / iterations);
+  }
+
+  uint32_t
+  measure_set (set_func_t func, std::size_t dst_offset, std::size_t n)
+  {
+    // Prevent the other threads from running during the measurement.
+    scheduler::critical_section scs;
+
+    clock::timestamp_t begin = hrclock.now ();
+    for (unsigned int i = 0; i < iterations; ++i)
+      {
+        func (dst_buf + dst_offset, 0x5A, n);
+      }
+    return static_cast<uint32_t> ((hrclock.now () - begin) / iterations);
+  }
+
+  void
+  compare_copy (const char* name, copy_func_t lib, copy_func_t os,
+                std::size_t dst_offset, std::size_t src_offset)
+  {
+    for (std::size_t n : sizes)
+      {
+        uint32_t lib_cycles = measure_copy (lib, dst_offset, src_offset, n);
+        uint32_t os_cycles = measure_copy (os, dst_offset, src_offset, n);
+
+        // Also check the result.
+        std::memset (dst_buf, 0, sizeof(dst_buf));
+        os (dst_buf + dst_offset, src_buf + src_offset, n);
+        bool ok = std::memcmp (dst_buf + dst_offset, src_buf + src_offset, n)
+            == 0;
+
+        printf ("%-8s dst+%u src+%u %5u bytes: lib %6u, os %6u cycles%s\n",
+                name, static_cast<unsigned int> (dst_offset),
+                static_cast<unsigned int> (src_offset),
+                static_cast<unsigned int> (n),
+                static_cast<unsigned int> (lib_cycles),
+                static_cast<unsigned int> (os_cycles), ok ? "" : " FAILED");
+      }
+  }
+
+  void
+  compare_set (std::size_t dst_offset)
+  {
+    for (std::size_t n : sizes)
+      {
+        uint32_t lib_cycles = measure_set (lib_memset, dst_offset, n);
+        uint32_t os_cycles = measure_set (os_memset, dst_offset, n);
+
+        printf ("%-8s dst+%u       %5u bytes: lib %6u, os %6u cycles\n",
+                "memset", static_cast<unsigned int> (dst_offset),
+                static_cast<unsigned int> (n),
+                static_cast<unsigned int> (lib_cycles),
+                static_cast<unsigned int> (os_cycles));
+      }
+  }
+}
+
+int
+os_main (int argc __attribute__((unused)),
+         char* argv[] __attribute__((unused)))
+{
+  printf ("\nMemory functions benchmark.\n");
+#if defined(__clang__)
+  printf ("Built with clang " __VERSION__ ".\n");
+#else
+  printf ("Built with GCC " __VERSION__ ".\n");
+#endif
+#if defined(__ARM_FEATURE_MVE)
+  printf ("Helium (MVE) loops.\n");
+#else
+  printf ("Word and LDRD/STRD loops.\n");
+#endif
+
+  for (std::size_t i = 0; i < sizeof(src_buf); ++i)
+    {
+      src_buf[i] = static_cast<uint8_t> (i * 7 + 1);
+    }
+
+  // The results include the interrupts, if any.
+  compare_copy ("memcpy", lib_memcpy, os_memcpy, 0, 0);
+  compare_copy ("memcpy", lib_memcpy, os_memcpy, 1, 0);
+  compare_copy ("memcpy", lib_memcpy, os_memcpy, 0, 1);
+  compare_copy ("memmove", lib_memmove, os_memmove, 0, 0);
+  compare_copy ("memmove", lib_memmove, os_memmove, 0, 3);
+
+  compare_set (0);
+  compare_set (1);
+
+  return 0;
+}
+
+#else
+
+int
+os_main (int argc __attribute__((unused)),
+         char* argv[] __attribute__((unused)))
+{
+  printf ("\nThe memory functions benchmark runs only on Arm.\n");
+  return 0;
+}
+
+#endif /* defined(__ARM_EABI__) */
@@ -33,6 +33,9 @@
 int
 run_tests (unsigned int seconds);
 
+int
+run_bench (unsigned int seconds);
+
 void
 busy_wait (unsigned int micros);
 
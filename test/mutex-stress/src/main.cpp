@@ -31,6 +31,7 @@
 #include <cstdio>
 #include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <sys/time.h>
 
 #include <test.h>
@@ -80,6 +81,20 @@ busy_wait (unsigned int micros)
 int
 os_main (int argc, char* argv[])
 {
+  // With `--bench [seconds]`, run the throughput benchmark, with
+  // the given duration for each configuration.
+  if (argc > 1 && strcmp (argv[1], "--bench") == 0)
+    {
+      unsigned int seconds = 1;
+      if (argc > 2)
+        {
+          seconds = static_cast<unsigned int> (atoi (argv[2]));
+        }
+
+      printf ("\nMutex throughput benchmark.\n");
+      return run_bench (seconds);
+    }
+
   unsigned int seconds = 30;
   if (argc > 1)
     {
@@ -36,6 +36,9 @@
 #include <test-chan-fatfs.h>
 
 #include <test-cpp-mem.h>
+#include <test-rtos-bench.h>
+#include <test-posix-io-bench.h>
+#include <test-allocator-bench.h>
 
 int
 os_main (int argc __attribute__((unused)), char* argv[] __attribute__((unused)))
@@ -104,6 +107,33 @@ os_main (int argc __attribute__((unused)), char* argv[] __attribute__((unused)))
     }
 #endif
 
+#if 1
+  if (ret == 0)
+    {
+      ret = test_rtos_bench ();
+      printf ("errno=%d\n", errno);
+      errno = 0;
+    }
+#endif
+
+#if 1
+  if (ret == 0)
+    {
+      ret = test_posix_io_bench ();
+      printf ("errno=%d\n", errno);
+      errno = 0;
+    }
+#endif
+
+#if 1
+  if (ret == 0)
+    {
+      ret = test_allocator_bench ();
+      printf ("errno=%d\n", errno);
+      errno = 0;
+    }
+#endif
+
   return ret;
 }
 
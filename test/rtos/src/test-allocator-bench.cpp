@@ -0,0 +1,562 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+// Compare the memory resources by replaying the same allocation
+// traces on each of them.
+//
+// A trace is a sequence of allocation and deallocation events,
+// either recorded from an application, as an array of
+// `alloc_event`, or generated from a size mix and a lifetime
+// range, with a private pseudo-random generator, so all resources
+// see exactly the same events.
+//
+// The results are sent over trace, one line for each resource
+// and trace:
+//
+//   bench-alloc,<resource>,<trace>,<allocs>,<failed>,
+//     <alloc-median>,<alloc-max>,<free-median>,<free-max>,
+//     <peak-bytes>,<fragmentation>
+//
+// with the times in high resolution clock cycles and the
+// fragmentation index in per mille, and, periodically during
+// the replay:
+//
+//   bench-frag,<resource>,<trace>,<event>,<allocated-bytes>,
+//     <fragmentation>
+//
+// The fragmentation is available only with
+// OS_INCLUDE_RTOS_STATISTICS_MEMORY, otherwise it is 0.
+
+#include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/diag/trace.h>
+
+#include <cmsis-plus/memory/first-fit-top.h>
+#include <cmsis-plus/memory/lifo.h>
+#include <cmsis-plus/memory/tlsf.h>
+#include <cmsis-plus/memory/segregated-fit.h>
+#include <cmsis-plus/memory/block-pool.h>
+#include <cmsis-plus/memory/malloc.h>
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+
+#include <test-allocator-bench.h>
+#include <test-histogram.h>
+
+using namespace os;
+using namespace os::rtos;
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+  // One trace entry; `slot` identifies the block between its
+  // allocation and deallocation.
+  struct alloc_event
+  {
+    uint16_t slot;
+    // 0 for deallocations.
+    uint16_t size;
+    uint16_t alignment;
+  };
+
+#pragma GCC diagnostic pop
+
+  constexpr std::size_t max_slots = 64;
+  constexpr std::size_t arena_size = 16 * 1024;
+  constexpr unsigned int frag_interval = 256;
+
+  // Shared by all resources, one at a time.
+  alignas(16) uint8_t arena[arena_size];
+
+  // --------------------------------------------------------------------------
+
+  class trace_source
+  {
+  public:
+
+    virtual
+    ~trace_source () = default;
+
+    virtual const char*
+    name (void) const = 0;
+
+    // Start again from the first event.
+    virtual void
+    rewind (void) = 0;
+
+    // Return false after the last event.
+    virtual bool
+    next (alloc_event& ev) = 0;
+  };
+
+  class recorded_trace : public trace_source
+  {
+  public:
+
+    recorded_trace (const char* name, const alloc_event* events,
+                    std::size_t count) :
+        name_ (name), //
+        events_ (events), //
+        count_ (count)
+    {
+    }
+
+    const char*
+    name (void) const override
+    {
+      return name_;
+    }
+
+    void
+    rewind (void) override
+    {
+      index_ = 0;
+    }
+
+    bool
+    next (alloc_event& ev) override
+    {
+      if (index_ >= count_)
+        {
+          return false;
+        }
+      ev = events_[index_++];
+      return true;
+    }
+
+  private:
+
+    const char* name_;
+    const alloc_event* events_;
+    std::size_t count_;
+    std::size_t index_ = 0;
+  };
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+  // A number of allocations with sizes between `min_size` and
+  // `max_size`, with the small ones more frequent, each freed after
+  // a random number of the following allocations, up to
+  // `max_lifetime`; occasionally with a 16 or 32 bytes alignment.
+  class synthetic_trace : public trace_source
+  {
+  public:
+
+    synthetic_trace (const char* name, uint32_t seed, unsigned int allocs,
+                     uint16_t min_size, uint16_t max_size,
+                     unsigned int max_lifetime) :
+        name_ (name), //
+        seed_ (seed), //
+        allocs_ (allocs), //
+        min_size_ (min_size), //
+        max_size_ (max_size), //
+        max_lifetime_ (max_lifetime)
+    {
+      rewind ();
+    }
+
+    const char*
+    name (void) const override
+    {
+      return name_;
+    }
+
+    void
+    rewind (void) override
+    {
+      state_ = seed_;
+      step_ = 0;
+      for (std::size_t i = 0; i < max_slots; ++i)
+        {
+          expiry_[i] = free_slot;
+        }
+    }
+
+    bool
+    next (alloc_event& ev) override
+    {
+      // First the blocks that expired, or all of them at the end.
+      for (std::size_t i = 0; i < max_slots; ++i)
+        {
+          if (expiry_[i] != free_slot
+              && (expiry_[i] <= step_ || step_ >= allocs_))
+            {
+              return release (i, ev);
+            }
+        }
+
+      if (step_ >= allocs_)
+        {
+          return false;
+        }
+
+      std::size_t slot = max_slots;
+      std::size_t oldest = 0;
+      for (std::size_t i = 0; i < max_slots; ++i)
+        {
+          if (expiry_[i] == free_slot)
+            {
+              slot = i;
+              break;
+            }
+          if (expiry_[i] < expiry_[oldest])
+            {
+              oldest = i;
+            }
+        }
+      if (slot == max_slots)
+        {
+          // All slots in use, free the one that expires first.
+          return release (oldest, ev);
+        }
+
+      // The square favours the small sizes.
+      uint32_t r = random () % 1024;
+      uint32_t span = static_cast<uint32_t> (max_size_ - min_size_);
+      ev.slot = static_cast<uint16_t> (slot);
+      ev.size = static_cast<uint16_t> (min_size_
+          + span * r * r / (1024 * 1024));
+      uint32_t a = random () % 16;
+      ev.alignment = static_cast<uint16_t> ((a == 0) ? 32 : (a == 1) ? 16 : 8);
+
+      ++step_;
+      expiry_[slot] = step_ + random () % max_lifetime_;
+      return true;
+    }
+
+  private:
+
+    bool
+    release (std::size_t slot, alloc_event& ev)
+    {
+      expiry_[slot] = free_slot;
+      ev.slot = static_cast<uint16_t> (slot);
+      ev.size = 0;
+      ev.alignment = 0;
+      return true;
+    }
+
+    // xorshift32
+    uint32_t
+    random (void)
+    {
+      state_ ^= state_ << 13;
+      state_ ^= state_ >> 17;
+      state_ ^= state_ << 5;
+      return state_;
+    }
+
+    static constexpr unsigned int free_slot = ~0u;
+
+    const char* name_;
+    uint32_t seed_;
+    unsigned int allocs_;
+    uint16_t min_size_;
+    uint16_t max_size_;
+    unsigned int max_lifetime_;
+
+    uint32_t state_ = 0;
+    unsigned int step_ = 0;
+    unsigned int expiry_[max_slots];
+  };
+
+#pragma GCC diagnostic pop
+
+  // --------------------------------------------------------------------------
+
+  // Median and maximum, over the shared log-linear buckets, so the
+  // median is within 12.5% of the actual value.
+  class histogram
+  {
+  public:
+
+    void
+    reset (void)
+    {
+      memset (counts_, 0, sizeof(counts_));
+      total_ = 0;
+      max_ = 0;
+    }
+
+    void
+    add (uint32_t cycles)
+    {
+      ++counts_[test_histogram::bucket_index (cycles)];
+      ++total_;
+      if (cycles > max_)
+        {
+          max_ = cycles;
+        }
+    }
+
+    uint32_t
+    median (void) const
+    {
+      uint32_t sum = 0;
+      for (unsigned int i = 0; i < test_histogram::buckets; ++i)
+        {
+          sum += counts_[i];
+          if (sum * 2 >= total_ && sum != 0)
+            {
+              return test_histogram::bucket_value (i);
+            }
+        }
+      return 0;
+    }
+
+    uint32_t
+    max (void) const
+    {
+      return max_;
+    }
+
+  private:
+
+    uint32_t counts_[test_histogram::buckets] =
+      { };
+    uint32_t total_ = 0;
+    uint32_t max_ = 0;
+  };
+
+  std::size_t
+  fragmentation (rtos::memory::memory_resource& mr __attribute__((unused)))
+  {
+#if defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY)
+    return mr.fragmentation ();
+#else
+    return 0;
+#endif /* defined(OS_INCLUDE_RTOS_STATISTICS_MEMORY) */
+  }
+
+  // The cost of reading the clock, subtracted from the measurements.
+  uint32_t clock_overhead;
+
+  uint32_t
+  measure_clock_overhead (void)
+  {
+    uint32_t min = UINT32_MAX;
+    for (unsigned int i = 0; i < 16; ++i)
+      {
+        clock::timestamp_t begin = hrclock.now ();
+        uint32_t c = static_cast<uint32_t> (hrclock.now () - begin);
+        if (c < min)
+          {
+            min = c;
+          }
+      }
+    return min;
+  }
+
+  uint32_t
+  elapsed (clock::timestamp_t begin)
+  {
+    uint32_t c = static_cast<uint32_t> (hrclock.now () - begin);
+    return (c > clock_overhead) ? (c - clock_overhead) : 0;
+  }
+
+  // Separate, they are too large for the thread stack.
+  histogram alloc_hist;
+  histogram free_hist;
+
+  void
+  replay (rtos::memory::memory_resource& mr, const char* resource,
+          trace_source& trace)
+  {
+    void* addrs[max_slots] =
+      { };
+    std::size_t sizes[max_slots] =
+      { };
+
+    alloc_hist.reset ();
+    free_hist.reset ();
+
+    unsigned int allocs = 0;
+    unsigned int failed = 0;
+    unsigned int events = 0;
+
+    trace.rewind ();
+
+    alloc_event ev;
+    while (trace.next (ev))
+      {
+        if (ev.size != 0)
+          {
+            ++allocs;
+
+            // Prevent the other threads from running during the
+            // measurement.
+            scheduler::critical_section scs;
+
+            clock::timestamp_t begin = hrclock.now ();
+            void* addr = mr.allocate (ev.size, ev.alignment);
+            uint32_t c = elapsed (begin);
+
+            if (addr == nullptr)
+              {
+                ++failed;
+              }
+            else
+              {
+                alloc_hist.add (c);
+              }
+            addrs[ev.slot] = addr;
+            sizes[ev.slot] = ev.size;
+          }
+        else if (addrs[ev.slot] != nullptr)
+          {
+            scheduler::critical_section scs;
+
+            clock::timestamp_t begin = hrclock.now ();
+            mr.deallocate (addrs[ev.slot], sizes[ev.slot]);
+            free_hist.add (elapsed (begin));
+
+            addrs[ev.slot] = nullptr;
+          }
+
+        if (++events % frag_interval == 0)
+          {
+            trace::printf ("bench-frag,%s,%s,%u,%u,%u\n", resource,
+                           trace.name (), events,
+                           static_cast<unsigned int> (mr.allocated_bytes ()),
+                           static_cast<unsigned int> (fragmentation (mr)));
+          }
+      }
+
+    trace::printf ("bench-alloc,%s,%s,%u,%u,%u,%u,%u,%u,%u,%u\n", resource,
+                   trace.name (), allocs, failed,
+                   static_cast<unsigned int> (alloc_hist.median ()),
+                   static_cast<unsigned int> (alloc_hist.max ()),
+                   static_cast<unsigned int> (free_hist.median ()),
+                   static_cast<unsigned int> (free_hist.max ()),
+                   static_cast<unsigned int> (mr.max_allocated_bytes ()),
+                   static_cast<unsigned int> (fragmentation (mr)));
+  }
+
+  // --------------------------------------------------------------------------
+
+  // A hand-written example of the recorded format: a few buffers
+  // allocated at startup and kept, and a request/response pattern.
+  const alloc_event example_trace[] =
+    {
+      { 0, 512, 8 },
+      { 1, 128, 8 },
+      { 2, 64, 8 },
+      { 3, 40, 8 },
+      { 4, 200, 8 },
+      { 3, 0, 0 },
+      { 3, 40, 8 },
+      { 5, 256, 32 },
+      { 4, 0, 0 },
+      { 5, 0, 0 },
+      { 3, 0, 0 },
+      { 2, 0, 0 },
+      { 1, 0, 0 },
+      { 0, 0, 0 } };
+
+  void
+  run_trace (trace_source& trace)
+  {
+      {
+        os::memory::first_fit_top mr
+          { "first-fit", arena, sizeof(arena) };
+        replay (mr, "first_fit_top", trace);
+      }
+
+      {
+        os::memory::lifo mr
+          { "lifo", arena, sizeof(arena) };
+        replay (mr, "lifo", trace);
+      }
+
+      {
+        os::memory::tlsf mr
+          { "tlsf", arena, sizeof(arena) };
+        replay (mr, "tlsf", trace);
+      }
+
+      {
+        os::memory::segregated_fit mr
+          { "seg-fit", arena, sizeof(arena) };
+        replay (mr, "segregated_fit", trace);
+      }
+
+      {
+        // Fixed size blocks, the larger requests fail.
+        os::memory::block_pool mr
+          { "pool", arena_size / 256, 256, arena, sizeof(arena) };
+        replay (mr, "block_pool", trace);
+      }
+
+      {
+        os::memory::malloc_memory_resource mr
+          { "malloc" };
+        replay (mr, "malloc", trace);
+      }
+  }
+}
+
+// ----------------------------------------------------------------------------
+
+int
+test_allocator_bench (void)
+{
+  printf ("\nAllocator benchmark.\n");
+
+  clock_overhead = measure_clock_overhead ();
+
+  uint32_t hz = hrclock.input_clock_frequency_hz ();
+  trace::printf ("bench-clock,%u\n", static_cast<unsigned int> (hz));
+  trace::printf ("bench-alloc,resource,trace,allocs,failed,alloc-median,"
+                 "alloc-max,free-median,free-max,peak-bytes,fragmentation\n");
+  trace::printf ("bench-frag,resource,trace,event,allocated-bytes,"
+                 "fragmentation\n");
+
+  recorded_trace example
+    { "example", example_trace, sizeof(example_trace)
+        / sizeof(example_trace[0]) };
+  run_trace (example);
+
+  // Mostly small objects, short lived.
+  synthetic_trace small
+    { "small-short", 0x12345678, 4000, 8, 128, 16 };
+  run_trace (small);
+
+  // A wider size range, with long lived blocks.
+  synthetic_trace mixed
+    { "mixed-long", 0x9E3779B9, 4000, 16, 1024, 48 };
+  run_trace (mixed);
+
+  return 0;
+}
+
+// ----------------------------------------------------------------------------
@@ -512,6 +512,31 @@ test_fs (posix::file_system& fs, uint8_t* buff, std::size_t buff_size)
           res = d->close ();
           assert(res == 0);
 
+          // Batched read, with the entries attributes.
+          d = fs.opendir (DIR1_NAME);
+          assert(d != nullptr);
+
+          struct dirent entries[4];
+          struct stat entries_st[4];
+          while (true)
+            {
+              sres = d->read_entries (entries, 4, entries_st);
+              assert(sres >= 0);
+
+              if (sres == 0)
+                {
+                  break;
+                }
+              for (ssize_t i = 0; i < sres; ++i)
+                {
+                  printf ("\"%s\" %u\n", entries[i].d_name,
+                          static_cast<unsigned int> (entries_st[i].st_size));
+                }
+            };
+
+          res = d->close ();
+          assert(res == 0);
+
         }
 
       // Similar to the above, but using static functions.
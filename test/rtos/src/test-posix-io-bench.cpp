@@ -0,0 +1,357 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+// Measure the POSIX I/O layer with a FAT file system on a RAM disk,
+// first directly on the block device, then through the block
+// device cache, on the sparse RAM disk device, and finally on the
+// flash translation layer, over a RAM disk used as raw flash.
+//
+// The results are sent over trace, one line for each measurement:
+//
+//   bench,<name>,<device>,<param>,<count>,<cycles>,<rate>
+//
+// where <cycles> is the total for the <count> operations and <rate>
+// is in operations or bytes per second, as named in the header line.
+
+#include <test-posix-io-bench.h>
+#include <test-posix-io-api.h>
+
+#include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/diag/trace.h>
+
+#include <cmsis-plus/posix-io/chan-fatfs-file-system.h>
+#include <cmsis-plus/posix-io/block-device-cached.h>
+#include <cmsis-plus/posix-io/block-device-ram.h>
+#include <cmsis-plus/posix-io/block-device-flash.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace os;
+using namespace os::rtos;
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+  // 256 KB, FAT12.
+  constexpr std::size_t block_size = 512;
+  constexpr std::size_t disk_blocks = 512;
+  constexpr std::size_t cached_blocks = 16;
+
+  // 40 units of 16 pages, 570 logical blocks.
+  constexpr std::size_t flash_unit_pages = 16;
+  constexpr std::size_t flash_pages = 40 * flash_unit_pages;
+
+  constexpr std::size_t file_size = 32 * 1024;
+  constexpr std::size_t transfer_sizes[] =
+    { 16, 128, 512, 4096 };
+  constexpr std::size_t max_transfer_size = 4096;
+
+  constexpr unsigned int open_iterations = 100;
+  constexpr unsigned int random_transfers = 64;
+  constexpr unsigned int directory_files = 32;
+  constexpr unsigned int churn_files = 8;
+  constexpr unsigned int churn_iterations = 16;
+
+  const char* file_path = "/bench.bin";
+  const char* dir_path = "/bench-dir";
+
+  uint8_t* buff;
+
+  // Added to the flags of the sequential transfers (O_DIRECT).
+  int stream_flags = 0;
+
+  void
+  report (const char* name, const char* device, std::size_t param,
+          unsigned int count, clock::timestamp_t cycles, uint64_t amount)
+  {
+    uint64_t hz = hrclock.input_clock_frequency_hz ();
+    uint64_t rate = (cycles != 0) ? (amount * hz / cycles) : 0;
+    trace::printf ("bench,%s,%s,%u,%u,%u,%u\n", name, device,
+                   static_cast<unsigned int> (param), count,
+                   static_cast<unsigned int> (cycles),
+                   static_cast<unsigned int> (rate));
+  }
+
+  // --------------------------------------------------------------------------
+
+  void
+  bench_open_close (const char* device)
+  {
+    posix::io* f = posix::open (file_path, O_WRONLY | O_CREAT);
+    assert(f != nullptr);
+    f->close ();
+
+    clock::timestamp_t begin = hrclock.now ();
+    for (unsigned int i = 0; i < open_iterations; ++i)
+      {
+        f = posix::open (file_path, O_RDONLY);
+        assert(f != nullptr);
+        f->close ();
+      }
+    clock::timestamp_t cycles = hrclock.now () - begin;
+
+    report ("open-close", device, 0, open_iterations, cycles,
+            open_iterations);
+  }
+
+  void
+  bench_sequential (const char* device, std::size_t size)
+  {
+    unsigned int count = static_cast<unsigned int> (file_size / size);
+
+    posix::io* f = posix::open (file_path,
+                                O_WRONLY | O_CREAT | O_TRUNC | stream_flags);
+    assert(f != nullptr);
+
+    clock::timestamp_t begin = hrclock.now ();
+    for (unsigned int i = 0; i < count; ++i)
+      {
+        ssize_t sres = f->write (buff, size);
+        assert(sres == static_cast<ssize_t> (size));
+      }
+    // The cached blocks are written to the device on close.
+    f->close ();
+    clock::timestamp_t cycles = hrclock.now () - begin;
+    report ("seq-write", device, size, count, cycles, file_size);
+
+    f = posix::open (file_path, O_RDONLY | stream_flags);
+    assert(f != nullptr);
+
+    begin = hrclock.now ();
+    for (unsigned int i = 0; i < count; ++i)
+      {
+        ssize_t sres = f->read (buff, size);
+        assert(sres == static_cast<ssize_t> (size));
+      }
+    cycles = hrclock.now () - begin;
+    f->close ();
+    report ("seq-read", device, size, count, cycles, file_size);
+  }
+
+  // The file written by the sequential test is accessed at
+  // random, transfer aligned, offsets.
+  void
+  bench_random (const char* device, std::size_t size)
+  {
+    std::size_t slots = file_size / size;
+
+    posix::io* f = posix::open (file_path, O_RDWR);
+    assert(f != nullptr);
+
+    clock::timestamp_t begin = hrclock.now ();
+    for (unsigned int i = 0; i < random_transfers; ++i)
+      {
+        off_t offset = static_cast<off_t> ((static_cast<std::size_t> (rand ())
+            % slots) * size);
+        f->lseek (offset, SEEK_SET);
+        ssize_t sres = f->write (buff, size);
+        assert(sres == static_cast<ssize_t> (size));
+      }
+    clock::timestamp_t cycles = hrclock.now () - begin;
+    report ("rand-write", device, size, random_transfers, cycles,
+            random_transfers * size);
+
+    begin = hrclock.now ();
+    for (unsigned int i = 0; i < random_transfers; ++i)
+      {
+        off_t offset = static_cast<off_t> ((static_cast<std::size_t> (rand ())
+            % slots) * size);
+        f->lseek (offset, SEEK_SET);
+        ssize_t sres = f->read (buff, size);
+        assert(sres == static_cast<ssize_t> (size));
+      }
+    cycles = hrclock.now () - begin;
+    f->close ();
+    report ("rand-read", device, size, random_transfers, cycles,
+            random_transfers * size);
+  }
+
+  void
+  bench_directory (const char* device)
+  {
+    char path[32];
+
+    posix::mkdir (dir_path, 0);
+    for (unsigned int i = 0; i < directory_files; ++i)
+      {
+        snprintf (path, sizeof(path), "%s/f%u.txt", dir_path, i);
+        posix::io* f = posix::open (path, O_WRONLY | O_CREAT);
+        assert(f != nullptr);
+        f->close ();
+      }
+
+    unsigned int entries = 0;
+    clock::timestamp_t begin = hrclock.now ();
+    posix::directory* d = posix::opendir (dir_path);
+    assert(d != nullptr);
+    while (d->read () != nullptr)
+      {
+        ++entries;
+      }
+    d->close ();
+    clock::timestamp_t cycles = hrclock.now () - begin;
+    report ("readdir", device, directory_files, entries, cycles, entries);
+
+    for (unsigned int i = 0; i < directory_files; ++i)
+      {
+        snprintf (path, sizeof(path), "%s/f%u.txt", dir_path, i);
+        posix::unlink (path);
+      }
+    posix::rmdir (dir_path);
+  }
+
+  // Several files kept open, closed in an order different from
+  // the open order, so the descriptors are not freed LIFO.
+  void
+  bench_descriptor_churn (const char* device)
+  {
+    posix::io* files[churn_files];
+
+    clock::timestamp_t begin = hrclock.now ();
+    for (unsigned int i = 0; i < churn_iterations; ++i)
+      {
+        for (unsigned int j = 0; j < churn_files; ++j)
+          {
+            files[j] = posix::open (file_path, O_RDONLY);
+            assert(files[j] != nullptr);
+          }
+        for (unsigned int j = 0; j < churn_files; j += 2)
+          {
+            files[j]->close ();
+          }
+        for (unsigned int j = 1; j < churn_files; j += 2)
+          {
+            files[j]->close ();
+          }
+      }
+    clock::timestamp_t cycles = hrclock.now () - begin;
+
+    unsigned int count = churn_iterations * churn_files;
+    report ("fd-churn", device, churn_files, count, cycles, count);
+  }
+
+  // --------------------------------------------------------------------------
+
+  void
+  run_suite (posix::block_device& dev, const char* device)
+  {
+    posix::chan_fatfs_file_system fs
+      { "bench-fat", dev };
+
+    int res = fs.device ().open ();
+    assert(res != -1);
+    res = fs.mkfs (FM_FAT | FM_SFD, 0, 0, buff, max_transfer_size);
+    assert(res == 0);
+    res = fs.device ().close ();
+    assert(res == 0);
+
+    // Mount as root file system.
+    res = fs.mount ();
+    assert(res == 0);
+
+    bench_open_close (device);
+    for (std::size_t size : transfer_sizes)
+      {
+        bench_sequential (device, size);
+        bench_random (device, size);
+      }
+    bench_directory (device);
+    bench_descriptor_churn (device);
+
+    posix::unlink (file_path);
+
+    res = fs.umount ();
+    assert(res == 0);
+  }
+}
+
+// ----------------------------------------------------------------------------
+
+int
+test_posix_io_bench (void)
+{
+  printf ("\nPOSIX I/O benchmark.\n");
+
+  uint32_t hz = hrclock.input_clock_frequency_hz ();
+  trace::printf ("bench-clock,%u\n", static_cast<unsigned int> (hz));
+  trace::printf ("bench,name,device,param,count,cycles,rate\n");
+
+  buff = new uint8_t[max_transfer_size];
+  memset (buff, 0x5A, max_transfer_size);
+
+    {
+      posix::block_device_implementable<my_block_impl> dev
+        { "bench-raw", block_size, block_size, disk_blocks };
+      run_suite (dev, "raw");
+    }
+
+    {
+      posix::block_device_cached<my_block_impl> dev
+        { "bench-cached", cached_blocks, nullptr, block_size, block_size,
+            disk_blocks };
+      run_suite (dev, "cached");
+    }
+
+    {
+      // The streaming transfers bypass the cache.
+      posix::block_device_cached<my_block_impl> dev
+        { "bench-direct", cached_blocks, nullptr, block_size, block_size,
+            disk_blocks };
+      stream_flags = O_DIRECT;
+      run_suite (dev, "cached-direct");
+      stream_flags = 0;
+    }
+
+    {
+      // Sparse, allocated from the default resource.
+      posix::block_device_ram dev
+        { "bench-ram", block_size, disk_blocks, 8u };
+      run_suite (dev, "ram");
+    }
+
+    {
+      // The flash layer accesses the parent from two threads.
+      rtos::mutex mx
+        { "bench-nor" };
+      posix::block_device_lockable<posix::block_device_ram_impl,
+          rtos::mutex> nor
+        { "bench-nor", mx, block_size, flash_pages, flash_unit_pages };
+      posix::block_device_flash dev
+        { "bench-flash", nor, flash_unit_pages };
+      run_suite (dev, "flash");
+    }
+
+  delete[] buff;
+  return 0;
+}
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,495 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+// Measure the RTOS primitives with the high resolution clock.
+//
+// The results are sent over trace, one line for each measurement:
+//
+//   bench,<name>,<param>,<count>,<min>,<avg>,<max>
+//
+// with the values in high resolution clock cycles; the clock
+// frequency is in the `bench-clock,<hz>` line, before the results.
+// The interrupts are not disabled, so the maximum values may
+// include the interrupt handlers.
+
+#include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/diag/trace.h>
+
+#include <cstdint>
+#include <cstring>
+
+#include <test-rtos-bench.h>
+
+// ----------------------------------------------------------------------------
+
+using namespace os;
+using namespace os::rtos;
+
+namespace
+{
+  constexpr unsigned int iterations = 100;
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+  class samples
+  {
+  public:
+
+    void
+    add (clock::timestamp_t cycles);
+
+    void
+    report (const char* name, unsigned int param = 0);
+
+  private:
+
+    uint64_t sum_ = 0;
+    uint32_t min_ = UINT32_MAX;
+    uint32_t max_ = 0;
+    uint32_t count_ = 0;
+  };
+
+#pragma GCC diagnostic pop
+
+  void
+  samples::add (clock::timestamp_t cycles)
+  {
+    uint32_t c = static_cast<uint32_t> (cycles);
+    sum_ += c;
+    if (c < min_)
+      {
+        min_ = c;
+      }
+    if (c > max_)
+      {
+        max_ = c;
+      }
+    ++count_;
+  }
+
+  void
+  samples::report (const char* name, unsigned int param)
+  {
+    uint32_t avg = (count_ != 0) ? static_cast<uint32_t> (sum_ / count_) : 0;
+    trace::printf ("bench,%s,%u,%u,%u,%u,%u\n", name, param,
+                   static_cast<unsigned int> (count_),
+                   static_cast<unsigned int> ((count_ != 0) ? min_ : 0),
+                   static_cast<unsigned int> (avg),
+                   static_cast<unsigned int> (max_));
+  }
+
+  // Shared with the peer threads.
+  volatile clock::timestamp_t begin_ts;
+  volatile clock::timestamp_t end_ts;
+  volatile bool done;
+
+  // Higher than the main thread, so the peer runs as soon as
+  // it is ready.
+  thread::priority_t
+  higher_priority (void)
+  {
+    return static_cast<thread::priority_t> (this_thread::thread ().priority ()
+        + 1);
+  }
+
+  // --------------------------------------------------------------------------
+
+  void*
+  yield_peer (void* args __attribute__((unused)))
+  {
+    while (!done)
+      {
+        this_thread::yield ();
+      }
+    return nullptr;
+  }
+
+  // Two threads with the same priority; each yield of the main
+  // thread switches to the peer and back.
+  void
+  bench_context_switch (void)
+  {
+    samples s;
+    done = false;
+
+    thread::attributes attr;
+    attr.th_priority = this_thread::thread ().priority ();
+    thread_inclusive<> peer
+      { "bench-yield", yield_peer, nullptr, attr };
+
+    for (unsigned int i = 0; i < iterations; ++i)
+      {
+        clock::timestamp_t begin = hrclock.now ();
+        this_thread::yield ();
+        s.add ((hrclock.now () - begin) / 2);
+      }
+
+    done = true;
+    peer.join ();
+    s.report ("context-switch");
+  }
+
+  // --------------------------------------------------------------------------
+
+  semaphore_binary* ping_sem;
+  semaphore_binary* pong_sem;
+
+  void*
+  semaphore_peer (void* args __attribute__((unused)))
+  {
+    while (true)
+      {
+        ping_sem->wait ();
+        if (done)
+          {
+            break;
+          }
+        pong_sem->post ();
+      }
+    return nullptr;
+  }
+
+  // The round trip: post to the waiting peer, which posts back.
+  void
+  bench_semaphore_ping_pong (void)
+  {
+    samples s;
+    done = false;
+
+    semaphore_binary ping
+      { "bench-ping", 0 };
+    semaphore_binary pong
+      { "bench-pong", 0 };
+    ping_sem = &ping;
+    pong_sem = &pong;
+
+    thread::attributes attr;
+    attr.th_priority = higher_priority ();
+    thread_inclusive<> peer
+      { "bench-sem", semaphore_peer, nullptr, attr };
+
+    for (unsigned int i = 0; i < iterations; ++i)
+      {
+        clock::timestamp_t begin = hrclock.now ();
+        ping.post ();
+        pong.wait ();
+        s.add (hrclock.now () - begin);
+      }
+
+    done = true;
+    ping.post ();
+    peer.join ();
+    s.report ("semaphore-ping-pong");
+  }
+
+  // --------------------------------------------------------------------------
+
+  mutex* bench_mutex;
+
+  void*
+  mutex_peer (void* args __attribute__((unused)))
+  {
+    while (true)
+      {
+        this_thread::flags_wait (1);
+        if (done)
+          {
+            break;
+          }
+        // Blocks, the main thread owns the mutex.
+        bench_mutex->lock ();
+        end_ts = hrclock.now ();
+        bench_mutex->unlock ();
+      }
+    return nullptr;
+  }
+
+  void
+  bench_mutex_uncontended (void)
+  {
+    samples s;
+    mutex mx
+      { "bench-mx" };
+
+    for (unsigned int i = 0; i < iterations; ++i)
+      {
+        clock::timestamp_t begin = hrclock.now ();
+        mx.lock ();
+        mx.unlock ();
+        s.add (hrclock.now () - begin);
+      }
+
+    s.report ("mutex-uncontended");
+  }
+
+  // From the unlock by the owner to the return of lock() in the
+  // higher priority waiter.
+  void
+  bench_mutex_contended (void)
+  {
+    samples s;
+    done = false;
+
+    mutex mx
+      { "bench-mx" };
+    bench_mutex = &mx;
+
+    thread::attributes attr;
+    attr.th_priority = higher_priority ();
+    thread_inclusive<> peer
+      { "bench-mx", mutex_peer, nullptr, attr };
+
+    for (unsigned int i = 0; i < iterations; ++i)
+      {
+        mx.lock ();
+        // The peer runs and blocks on the mutex.
+        peer.flags_raise (1);
+
+        begin_ts = hrclock.now ();
+        mx.unlock ();
+        s.add (end_ts - begin_ts);
+      }
+
+    done = true;
+    peer.flags_raise (1);
+    peer.join ();
+    s.report ("mutex-contended");
+  }
+
+  // --------------------------------------------------------------------------
+
+  constexpr std::size_t msg_sizes[] =
+    { 4, 16, 64, 256 };
+
+  constexpr std::size_t max_msg_size = 256;
+
+  message_queue* bench_queue;
+  volatile std::size_t msg_size;
+
+  void*
+  queue_peer (void* args __attribute__((unused)))
+  {
+    uint8_t buf[max_msg_size];
+    while (true)
+      {
+        bench_queue->receive (buf, msg_size);
+        end_ts = hrclock.now ();
+        if (done)
+          {
+            break;
+          }
+      }
+    return nullptr;
+  }
+
+  // From the send() call to the return of receive() in the
+  // higher priority waiter, for each message size.
+  void
+  bench_message_queue (void)
+  {
+    static uint8_t buf[max_msg_size];
+
+    for (std::size_t size : msg_sizes)
+      {
+        samples s;
+        done = false;
+        msg_size = size;
+
+        message_queue mq
+          { "bench-mq", 2, size };
+        bench_queue = &mq;
+
+        thread::attributes attr;
+        attr.th_priority = higher_priority ();
+        thread_inclusive<> peer
+          { "bench-mq", queue_peer, nullptr, attr };
+
+        for (unsigned int i = 0; i < iterations; ++i)
+          {
+            clock::timestamp_t begin = hrclock.now ();
+            mq.send (buf, size);
+            s.add (end_ts - begin);
+          }
+
+        done = true;
+        mq.send (buf, size);
+        peer.join ();
+        s.report ("message-queue", static_cast<unsigned int> (size));
+      }
+  }
+
+  // --------------------------------------------------------------------------
+
+  event_flags* bench_flags;
+
+  void*
+  flags_peer (void* args __attribute__((unused)))
+  {
+    while (true)
+      {
+        bench_flags->wait (1, nullptr);
+        end_ts = hrclock.now ();
+        if (done)
+          {
+            break;
+          }
+      }
+    return nullptr;
+  }
+
+  // From raise() to the return of wait() in the higher
+  // priority waiter.
+  void
+  bench_event_flags (void)
+  {
+    samples s;
+    done = false;
+
+    event_flags ef
+      { "bench-ef" };
+    bench_flags = &ef;
+
+    thread::attributes attr;
+    attr.th_priority = higher_priority ();
+    thread_inclusive<> peer
+      { "bench-ef", flags_peer, nullptr, attr };
+
+    for (unsigned int i = 0; i < iterations; ++i)
+      {
+        clock::timestamp_t begin = hrclock.now ();
+        ef.raise (1);
+        s.add (end_ts - begin);
+      }
+
+    done = true;
+    ef.raise (1);
+    peer.join ();
+    s.report ("event-flags-wakeup");
+  }
+
+  // --------------------------------------------------------------------------
+
+  semaphore_binary* timer_sem;
+
+  void
+  timer_callback (void* args __attribute__((unused)))
+  {
+    end_ts = hrclock.now ();
+    timer_sem->post ();
+  }
+
+  // From the tick that expired the timer to the callback; the
+  // high resolution clock counts the SysTick input cycles,
+  // so the position in the tick is the remainder of the
+  // division by the cycles per tick.
+  void
+  bench_timer (void)
+  {
+    samples s;
+
+    semaphore_binary sem
+      { "bench-tm", 0 };
+    timer_sem = &sem;
+
+    timer tm
+      { "bench-tm", timer_callback, nullptr };
+
+    clock::timestamp_t cycles_per_tick = hrclock.input_clock_frequency_hz ()
+        / clock_systick::frequency_hz;
+
+    for (unsigned int i = 0; i < iterations; ++i)
+      {
+        tm.start (1);
+        sem.wait ();
+        s.add (end_ts % cycles_per_tick);
+      }
+
+    s.report ("timer-dispatch");
+  }
+
+  // --------------------------------------------------------------------------
+
+  void*
+  empty_func (void* args __attribute__((unused)))
+  {
+    return nullptr;
+  }
+
+  // The constructor of a lower priority thread, which does not
+  // run, and the destructor after join().
+  void
+  bench_thread_create (void)
+  {
+    samples sc;
+    samples sd;
+
+    thread::attributes attr;
+    attr.th_priority = static_cast<thread::priority_t> (
+        this_thread::thread ().priority () - 1);
+
+    for (unsigned int i = 0; i < iterations; ++i)
+      {
+        clock::timestamp_t begin = hrclock.now ();
+        thread* th = new thread
+          { "bench-th", empty_func, nullptr, attr };
+        sc.add (hrclock.now () - begin);
+
+        th->join ();
+
+        begin = hrclock.now ();
+        delete th;
+        sd.add (hrclock.now () - begin);
+      }
+
+    sc.report ("thread-create");
+    sd.report ("thread-destroy");
+  }
+}
+
+// ----------------------------------------------------------------------------
+
+int
+test_rtos_bench (void)
+{
+  uint32_t hz = hrclock.input_clock_frequency_hz ();
+  trace::printf ("bench-clock,%u\n", static_cast<unsigned int> (hz));
+  trace::printf ("bench,name,param,count,min,avg,max\n");
+
+  bench_context_switch ();
+  bench_semaphore_ping_pong ();
+  bench_mutex_uncontended ();
+  bench_mutex_contended ();
+  bench_message_queue ();
+  bench_event_flags ();
+  bench_timer ();
+  bench_thread_create ();
+
+  return 0;
+}
+
+// ----------------------------------------------------------------------------
@@ -52,6 +52,9 @@ extern Hw_timer tmr;
 int
 run_tests ();
 
+int
+run_bench (unsigned int seconds);
+
 extern void
 (*tim_callback) (void);
 
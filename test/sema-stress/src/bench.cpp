@@ -0,0 +1,101 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2016 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+// Semaphore throughput and latency benchmark.
+//
+// The threads share a pool of resources guarded by a counting
+// semaphore, with wait() or timed_wait() and post(); the harness
+// is in <test-lock-bench.h>.
+
+#include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/diag/trace.h>
+
+#include <cmsis_device.h>
+
+#include <test.h>
+#include <test-lock-bench.h>
+
+using namespace os;
+using namespace os::rtos;
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+  // Fewer than the threads, so they contend.
+  constexpr semaphore::count_t resources = 2;
+
+#pragma GCC diagnostic push
+#if defined(__clang__)
+#pragma clang diagnostic ignored "-Wexit-time-destructors"
+#pragma clang diagnostic ignored "-Wglobal-constructors"
+#endif
+
+  semaphore_counting bench_sem
+    { "bench-sem", resources, resources };
+
+#pragma GCC diagnostic pop
+
+  class semaphore_ops
+  {
+  public:
+
+    static const char*
+    label (void)
+    {
+      return "semaphore";
+    }
+
+    static result_t
+    acquire (clock::duration_t timeout)
+    {
+      if (timeout == 0)
+        {
+          return bench_sem.wait ();
+        }
+      return bench_sem.timed_wait (timeout);
+    }
+
+    static void
+    release (void)
+    {
+      bench_sem.post ();
+    }
+  };
+
+  test_bench::lock_bench<semaphore_ops> bench;
+}
+
+// ----------------------------------------------------------------------------
+
+int
+run_bench (unsigned int seconds)
+{
+  return bench.run (seconds);
+}
+
+// ----------------------------------------------------------------------------
@@ -27,6 +27,9 @@
 
 #include <stm32f4xx_hal.h>
 
+#include <cstdlib>
+#include <cstring>
+
 #include <cmsis-plus/rtos/os.h>
 #include <cmsis-plus/diag/trace.h>
 
@@ -37,8 +40,22 @@ using namespace os;
 RNG_HandleTypeDef hrng;
 
 int
-os_main (int argc __attribute__((unused)), char* argv[] __attribute__((unused)))
+os_main (int argc, char* argv[])
 {
+  // With `--bench [seconds]`, run the throughput benchmark, with
+  // the given duration for each configuration.
+  if (argc > 1 && strcmp (argv[1], "--bench") == 0)
+    {
+      unsigned int seconds = 1;
+      if (argc > 2)
+        {
+          seconds = static_cast<unsigned int> (atoi (argv[2]));
+        }
+
+      printf ("\nSemaphore throughput benchmark.\n");
+      return run_bench (seconds);
+    }
+
   printf ("\nSemaphore stress test.\n");
 #if defined(__clang__)
   printf ("Built with clang " __VERSION__ ".\n");